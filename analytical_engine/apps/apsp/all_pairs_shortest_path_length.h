@@ -18,8 +18,10 @@ limitations under the License.
 
 #ifdef NETWORKX
 
+#include <algorithm>
 #include <limits>
 #include <map>
+#include <memory>
 #include <queue>
 #include <tuple>
 #include <utility>
@@ -28,6 +30,7 @@ limitations under the License.
 #include "grape/grape.h"
 
 #include "apps/apsp/all_pairs_shortest_path_length_context.h"
+#include "apps/bfs/multi_source_bfs.h"
 #include "core/utils/trait_utils.h"
 
 namespace gs {
@@ -57,6 +60,11 @@ class AllPairsShortestPathLength
              message_manager_t& messages) {
     auto inner_vertices = frag.InnerVertices();
     auto vertices = frag.Vertices();
+    if (std::is_same<edata_t, grape::EmptyType>::value) {
+      // unweighted graph, use batched bfs.
+      batchedBFS(frag, ctx);
+      return;
+    }
     ForEach(inner_vertices,
             [&frag, &ctx, &vertices, this](int tid, vertex_t v) {
               ctx.length[v].Init(vertices, std::numeric_limits<double>::max());
@@ -116,6 +124,38 @@ class AllPairsShortestPathLength
     }
   }
 
+  // bfs from 64 sources at a time.
+  void batchedBFS(const fragment_t& frag, context_t& ctx) {
+    using bfs_t = MultiSourceBFS<fragment_t>;
+    auto vertices = frag.Vertices();
+    std::vector<vertex_t> sources;
+    for (auto v : frag.InnerVertices()) {
+      sources.push_back(v);
+    }
+    std::vector<std::unique_ptr<bfs_t>> bfs(thread_num());
+    for (auto& unit : bfs) {
+      unit.reset(new bfs_t(frag));
+    }
+    vid_t batch_num = (sources.size() + bfs_t::kBatchSize - 1) /
+                      bfs_t::kBatchSize;
+
+    ForEach(
+        grape::VertexRange<vid_t>(0, batch_num),
+        [&](int tid, vertex_t batch) {
+          auto begin = sources.begin() + batch.GetValue() * bfs_t::kBatchSize;
+          auto end = std::min(begin + bfs_t::kBatchSize, sources.end());
+          std::vector<vertex_t> batch_sources(begin, end);
+          for (auto s : batch_sources) {
+            ctx.length[s].Init(vertices, std::numeric_limits<double>::max());
+          }
+          bfs[tid]->Run(batch_sources, false,
+                        [&](size_t i, vertex_t v, int depth) {
+                          ctx.length[batch_sources[i]][v] = depth;
+                        });
+        },
+        1);
+  }
+
   void bfs(const fragment_t& frag, vertex_t& s, context_t& ctx) {
     std::queue<vertex_t> que;
     ctx.length[s][s] = 0;
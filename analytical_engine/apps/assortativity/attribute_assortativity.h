@@ -18,7 +18,9 @@ Author: Ning Xin
 #ifndef ANALYTICAL_ENGINE_APPS_ASSORTATIVITY_ATTRIBUTE_ASSORTATIVITY_H_
 #define ANALYTICAL_ENGINE_APPS_ASSORTATIVITY_ATTRIBUTE_ASSORTATIVITY_H_
 
+#include <cmath>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -28,7 +30,6 @@ Author: Ning Xin
 #include "apps/assortativity/utils.h"
 #include "core/app/app_base.h"
 #include "core/utils/trait_utils.h"
-#include "core/worker/default_worker.h"
 
 namespace gs {
 /**
@@ -37,15 +38,25 @@ namespace gs {
  * If numeric is true, it is numeric assortativity app, else attribute
  * assortativity app. Assortativity measures the similarity of connections in
  * the graph with respect to the attribute.
+ *
+ * The attributes are numbered by a dictionary shared by all fragments, and
+ * each edge is counted by the threads of the fragment of its source into
+ * per-attribute counters of their own. Both assortativities only depend on
+ * the sums of the rows and columns of the mixing matrix, its trace and, for
+ * the numeric one, the sum of x * y over the edges, so the matrix itself is
+ * never built, and the counters of all fragments are summed by a single
+ * all-reduce.
  * @tparam FRAG_T
  */
 template <typename FRAG_T>
 class AttributeAssortativity
-    : public AppBase<FRAG_T, AttributeAssortativityContext<FRAG_T>>,
+    : public grape::ParallelAppBase<FRAG_T,
+                                    AttributeAssortativityContext<FRAG_T>>,
+      public grape::ParallelEngine,
       public grape::Communicator {
  public:
-  INSTALL_DEFAULT_WORKER(AttributeAssortativity<FRAG_T>,
-                         AttributeAssortativityContext<FRAG_T>, FRAG_T)
+  INSTALL_PARALLEL_WORKER(AttributeAssortativity<FRAG_T>,
+                          AttributeAssortativityContext<FRAG_T>, FRAG_T)
   static constexpr grape::MessageStrategy message_strategy =
       grape::MessageStrategy::kAlongEdgeToOuterVertex;
   static constexpr grape::LoadStrategy load_strategy =
@@ -58,264 +69,175 @@ class AttributeAssortativity
   void PEval(const fragment_t& frag, context_t& ctx,
              message_manager_t& messages) {
     auto inner_vertices = frag.InnerVertices();
-    for (auto v : inner_vertices) {
-      ProcessVertex<vdata_t>(v, frag, ctx, messages);
-    }
+    messages.InitChannels(thread_num());
+    buildAttributeIndex(frag, ctx);
+    // the mirrors of a vertex learn the index of its attribute once, rather
+    // than by a message for each edge to it
+    ForEach(inner_vertices, [&frag, &ctx, &messages](int tid, vertex_t v) {
+      messages.SendMsgThroughEdges<fragment_t, int>(frag, v, ctx.attr_id[v],
+                                                    tid);
+    });
     messages.ForceContinue();
   }
 
   void IncEval(const fragment_t& frag, context_t& ctx,
                message_manager_t& messages) {
-    if (!ctx.merge_stage) {
-      UpdateAttributeMixingMap<vertex_t, vdata_t>(frag, ctx, messages);
-    } else {
-      // merge in worker 0
-      if (frag.fid() == 0) {
-        MergeAttributeMixingMap<vdata_t>(ctx, messages);
-        std::vector<std::vector<double>> attribute_mixing_matrix;
-        // numeric assortativity app
-        if (ctx.numeric) {
-          std::unordered_map<int, double> map;
-          getNumericMixingMatrix(ctx, attribute_mixing_matrix, map);
-          // compute numeric assortativity
-          ctx.attribute_assortativity =
-              ProcessMatrix(attribute_mixing_matrix, map);
-        } else {  // attribute assortativity app
-          getAttributeMixingMatrix(ctx, attribute_mixing_matrix);
-          // compute attribute assortativity
-          ctx.attribute_assortativity =
-              computeAssortativity(attribute_mixing_matrix);
-        }
-        // write result to ctx
-        std::vector<size_t> shape{1};
-        ctx.set_shape(shape);
-        ctx.assign(ctx.attribute_assortativity);
-        VLOG(0) << "attribute assortatity: " << ctx.attribute_assortativity
-                << std::endl;
+    messages.ParallelProcess<fragment_t, int>(
+        thread_num(), frag,
+        [&ctx](int tid, vertex_t u, int msg) { ctx.attr_id[u] = msg; });
+
+    size_t n = ctx.attr_values.size();
+    std::vector<double> numbers;
+    if (ctx.numeric) {
+      numbers.resize(n, 1.0);
+      for (size_t i = 0; i < n; ++i) {
+        vdata_t vdata = ctx.attr_values[i];
+        // convert vdata_t to double in compile-time
+        vineyard::static_if<Conversion<double, vdata_t>::exists>(
+            [&](auto& data, auto& vdata) {
+              data = static_cast<double>(vdata);
+            })(numbers[i], vdata);
       }
     }
-  }
-  /**
-   * @brief count the attribute-attribute pairs
-   *
-   * @param source_data the data of source node
-   * @param target_data the data of target node
-   * @param ctx
-   */
-  template <typename vdata_t, typename context_t>
-  inline void AttributeMixingCount(vdata_t source_data, vdata_t target_data,
-                                   context_t& ctx) {
-    if (ctx.attribute_mixing_map.count(source_data) == 0 ||
-        ctx.attribute_mixing_map[source_data].count(target_data) == 0) {
-      ctx.attribute_mixing_map[source_data][target_data] = 1;
-    } else {
-      ctx.attribute_mixing_map[source_data][target_data] += 1;
-    }
-  }
 
-  /**
-   * @brief traverse the outgoing neighbors of vertex v and update the
-   * attribute-attribute pairs.
-   *
-   * @param v
-   * @param frag
-   * @param ctx
-   * @param messages
-   */
-  template <typename vdata_t, typename vertex_t, typename fragment_t,
-            typename context_t, typename message_manager_t>
-  void ProcessVertex(const vertex_t& v, const fragment_t& frag, context_t& ctx,
-                     message_manager_t& messages) {
-    vdata_t source_data = frag.GetData(v);
-    // get all neighbors of vertex v
-    auto oes = frag.GetOutgoingAdjList(v);
-    for (auto& e : oes) {
-      vertex_t neighbor = e.get_neighbor();
-      if (frag.IsOuterVertex(neighbor)) {
-        messages.SyncStateOnOuterVertex(frag, neighbor, source_data);
+    // the counters of a thread: the sources of the edges by attribute, the
+    // targets by attribute, the edges between equal attributes, and the sum
+    // of x * y
+    size_t size = 2 * n + 2;
+    std::vector<std::vector<double>> partials(thread_num(),
+                                              std::vector<double>(size, 0.0));
+    ForEach(frag.InnerVertices(),
+            [&frag, &ctx, &partials, &numbers, n](int tid, vertex_t v) {
+              auto& partial = partials[tid];
+              int source = ctx.attr_id[v];
+              for (auto& e : frag.GetOutgoingAdjList(v)) {
+                int target = ctx.attr_id[e.get_neighbor()];
+                partial[source] += 1;
+                partial[n + target] += 1;
+                if (source == target) {
+                  partial[2 * n] += 1;
+                }
+                if (!numbers.empty()) {
+                  partial[2 * n + 1] += numbers[source] * numbers[target];
+                }
+              }
+            });
+    std::vector<double> local(size, 0.0), mixing;
+    for (auto& partial : partials) {
+      for (size_t i = 0; i < size; ++i) {
+        local[i] += partial[i];
+      }
+    }
+    AllReduce(local, mixing,
+              [](std::vector<double>& lhs, const std::vector<double>& rhs) {
+                for (size_t i = 0; i < lhs.size(); ++i) {
+                  lhs[i] += rhs[i];
+                }
+              });
+
+    if (frag.fid() == 0) {
+      if (ctx.numeric) {
+        ctx.attribute_assortativity =
+            computeNumericAssortativity(mixing, numbers);
       } else {
-        vdata_t target_data = frag.GetData(neighbor);
-        AttributeMixingCount(source_data, target_data, ctx);
+        ctx.attribute_assortativity = computeAssortativity(mixing, n);
       }
+      // write result to ctx
+      std::vector<size_t> shape{1};
+      ctx.set_shape(shape);
+      ctx.assign(ctx.attribute_assortativity);
+      VLOG(0) << "attribute assortatity: " << ctx.attribute_assortativity
+              << std::endl;
     }
   }
+
+ private:
   /**
-   * @brief update the attribute-attribute pairs from the outer vertex.
+   * @brief Number the distinct attributes of all fragments, and set the index
+   * of the attribute of each inner vertex.
    *
    * @param frag
    * @param ctx
-   * @param messages
    */
-  template <typename vertex_t, typename vdata_t, typename fragment_t,
-            typename context_t, typename message_manager_t>
-  void UpdateAttributeMixingMap(const fragment_t& frag, context_t& ctx,
-                                message_manager_t& messages) {
-    vdata_t source_data;
-    vertex_t u;
-    // update attribute mixing map
-    while (messages.GetMessage(frag, u, source_data)) {
-      vdata_t target_data = frag.GetData(u);
-      AttributeMixingCount(source_data, target_data, ctx);
-    }
-    ctx.merge_stage = true;
-    // send message to worker 0
-    if (frag.fid() != 0) {
-      messages.SendToFragment(0, ctx.attribute_mixing_map);
+  void buildAttributeIndex(const fragment_t& frag, context_t& ctx) {
+    auto inner_vertices = frag.InnerVertices();
+    std::vector<std::unordered_set<vdata_t>> thread_values(thread_num());
+    ForEach(inner_vertices, [&frag, &thread_values](int tid, vertex_t v) {
+      thread_values[tid].insert(frag.GetData(v));
+    });
+    std::unordered_set<vdata_t> values;
+    for (auto& set : thread_values) {
+      values.insert(set.begin(), set.end());
     }
-    messages.ForceContinue();
-  }
-
-  /**
-   * @brief merge attribute mixing map of all workers in worker 0 and the result
-   * is saved in the contxt of worker 0.
-   *
-   * @param ctx
-   * @param messages
-   *
-   */
-  template <typename vdata_t, typename context_t, typename message_manager_t>
-  void MergeAttributeMixingMap(context_t& ctx, message_manager_t& messages) {
-    std::unordered_map<vdata_t, std::unordered_map<vdata_t, int>> msg;
-    while (messages.GetMessage(msg)) {
-      for (auto& pair1 : msg) {
-        for (auto& pair2 : pair1.second) {
-          // merge
-          if (ctx.attribute_mixing_map.count(pair1.first) == 0 ||
-              ctx.attribute_mixing_map[pair1.first].count(pair2.first) == 0) {
-            ctx.attribute_mixing_map[pair1.first][pair2.first] = pair2.second;
-          } else {
-            ctx.attribute_mixing_map[pair1.first][pair2.first] += pair2.second;
-          }
+    std::vector<vdata_t> local_values(values.begin(), values.end());
+    std::vector<std::vector<vdata_t>> all_values;
+    AllGather(local_values, all_values);
+
+    // all fragments walk the same lists in the same order, so they agree on
+    // the indices
+    std::unordered_map<vdata_t, int> index;
+    ctx.attr_values.clear();
+    for (auto& frag_values : all_values) {
+      for (auto& value : frag_values) {
+        if (index.emplace(value, ctx.attr_values.size()).second) {
+          ctx.attr_values.push_back(value);
         }
       }
     }
+    ForEach(inner_vertices, [&frag, &ctx, &index](int tid, vertex_t v) {
+      ctx.attr_id[v] = index.at(frag.GetData(v));
+    });
   }
 
- private:
   /**
-   * @brief Compute assortativity for attribute matrix attribute_mixing_matrix
+   * @brief Compute attribute assortativity, (sum(e_ii) - sum(a_i * b_i)) /
+   * (1 - sum(a_i * b_i)), where a and b are the sums of the rows and columns
+   * of the normalized mixing matrix e.
    *
-   * @param attribute_mixing_matrix n x n matrix
+   * @param mixing the counters of all fragments
+   * @param n the number of distinct attributes
    * @return attribute assortativity
    */
-  double computeAssortativity(
-      std::vector<std::vector<double>>& attribute_mixing_matrix) {
-    int n = attribute_mixing_matrix.size();
-    std::vector<double> a;
-    // sum of column
-    for (auto& row : attribute_mixing_matrix) {
-      a.emplace_back(accumulate(row.begin(), row.end(), 0.0));
-    }
-    std::vector<double> b;
-    // sum of row
-    for (int i = 0; i < n; i++) {
-      double sum = 0.0;
-      for (int j = 0; j < n; j++) {
-        sum += attribute_mixing_matrix[j][i];
-      }
-      b.emplace_back(sum);
+  double computeAssortativity(const std::vector<double>& mixing, size_t n) {
+    double total_edge_num = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+      total_edge_num += mixing[i];
     }
-    double sum_eii = 0.0, sum_ai_bi = 0.0;
-    for (int i = 0; i < n; i++) {
-      sum_eii += attribute_mixing_matrix[i][i];
-      sum_ai_bi += a[i] * b[i];
+    double sum_eii = mixing[2 * n] / total_edge_num, sum_ai_bi = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+      sum_ai_bi += (mixing[i] / total_edge_num) *
+                   (mixing[n + i] / total_edge_num);
     }
     return (sum_eii - sum_ai_bi) / (1 - sum_ai_bi);
   }
 
   /**
-   * @brief get attribute mixing matrix by attribute mixing map
-   *
-   * @param ctx
-   * @param[out] attribute_mixing_matrix
-   */
-  void getAttributeMixingMatrix(
-      context_t& ctx,
-      std::vector<std::vector<double>>& attribute_mixing_matrix) {
-    int total_edge_num = 0;
-    // <data, index> pair, index:{0, 1, ..., n}
-    std::unordered_map<vdata_t, int> index_map;
-    int count = 0;
-    for (auto& pair1 : ctx.attribute_mixing_map) {
-      for (auto& pair2 : pair1.second) {
-        if (index_map.count(pair1.first) == 0) {
-          index_map[pair1.first] = count;
-          count++;
-        }
-        if (index_map.count(pair2.first) == 0) {
-          index_map[pair2.first] = count;
-          count++;
-        }
-        total_edge_num += pair2.second;
-      }
-    }
-    int n = index_map.size();
-    std::vector<std::vector<double>> tmp(n, std::vector<double>(n, 0.0));
-    attribute_mixing_matrix.swap(tmp);
-    for (auto& pair1 : ctx.attribute_mixing_map) {
-      for (auto& pair2 : pair1.second) {
-        int row = index_map[pair1.first];
-        int column = index_map[pair2.first];
-        attribute_mixing_matrix[row][column] =
-            pair2.second / static_cast<double>(total_edge_num);
-      }
-    }
-  }
-
-  /**
-   * @brief get numeric mixing matrix by attribute mixing map
+   * @brief Compute numeric assortativity, i.e., the Pearson correlation of
+   * the attributes of the two ends of the edges.
    *
-   * @param ctx
-   * @param[out] attribute_mixing_matrix
-   * @param[out] map index -> data of a node
+   * @param mixing the counters of all fragments
+   * @param numbers the attributes as double
+   * @return numeric assortativity
    */
-  void getNumericMixingMatrix(
-      context_t& ctx, std::vector<std::vector<double>>& attribute_mixing_matrix,
-      std::unordered_map<int, double>& map) {
-    int total_edge_num = 0;
-    // <data, index> pair, index:{0, 1, ..., n}
-    std::unordered_map<vdata_t, int> index_map;
-    int count = 0;
-    for (auto& pair1 : ctx.attribute_mixing_map) {
-      for (auto& pair2 : pair1.second) {
-        if (index_map.count(pair1.first) == 0) {
-          index_map[pair1.first] = count;
-          vdata_t vdata = pair1.first;
-          double data = 1.0;
-          // convert vdata_t to double in compile-time
-          vineyard::static_if<Conversion<double, vdata_t>::exists>(
-              [&](auto& data, auto& vdata) {
-                data = static_cast<double>(vdata);
-              })(data, vdata);
-          map[count] = data;
-          count++;
-        }
-        if (index_map.count(pair2.first) == 0) {
-          index_map[pair2.first] = count;
-          vdata_t vdata = pair2.first;
-          double data = 1.0;
-          // convert vdata_t to double in compile-time
-          vineyard::static_if<Conversion<double, vdata_t>::exists>(
-              [&](auto& data, auto& vdata) {
-                data = static_cast<double>(vdata);
-              })(data, vdata);
-          map[count] = data;
-          count++;
-        }
-        total_edge_num += pair2.second;
-      }
+  double computeNumericAssortativity(const std::vector<double>& mixing,
+                                     const std::vector<double>& numbers) {
+    size_t n = numbers.size();
+    double total_edge_num = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+      total_edge_num += mixing[i];
     }
-    int n = index_map.size();
-    std::vector<std::vector<double>> tmp(n, std::vector<double>(n, 0.0));
-    attribute_mixing_matrix.swap(tmp);
-    for (auto& pair1 : ctx.attribute_mixing_map) {
-      for (auto& pair2 : pair1.second) {
-        int row = index_map[pair1.first];
-        int column = index_map[pair2.first];
-        attribute_mixing_matrix[row][column] =
-            pair2.second / static_cast<double>(total_edge_num);
-      }
+    double mean_a = 0.0, mean_b = 0.0, square_a = 0.0, square_b = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+      double a = mixing[i] / total_edge_num;
+      double b = mixing[n + i] / total_edge_num;
+      mean_a += numbers[i] * a;
+      mean_b += numbers[i] * b;
+      square_a += numbers[i] * numbers[i] * a;
+      square_b += numbers[i] * numbers[i] * b;
     }
+    double cov = mixing[2 * n + 1] / total_edge_num - mean_a * mean_b;
+    return cov / (sqrt(square_a - mean_a * mean_a) *
+                  sqrt(square_b - mean_b * mean_b));
   }
 };
 }  // namespace gs
@@ -20,8 +20,8 @@
 
 #include <limits>
 #include <string>
-#include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "grape/grape.h"
 
@@ -36,8 +36,9 @@ class AttributeAssortativityContext : public TensorContext<FRAG_T, double> {
   explicit AttributeAssortativityContext(const FRAG_T& fragment)
       : TensorContext<FRAG_T, double>(fragment) {}
 
-  void Init(grape::DefaultMessageManager& messages, bool numeric) {
-    merge_stage = false;
+  void Init(grape::ParallelMessageManager& messages, bool numeric) {
+    auto& frag = this->fragment();
+    attr_id.Init(frag.Vertices(), -1);
     this->numeric = numeric;
   }
 
@@ -47,10 +48,11 @@ class AttributeAssortativityContext : public TensorContext<FRAG_T, double> {
       os << attribute_assortativity << std::endl;
     }
   }
-  std::unordered_map<vdata_t, std::unordered_map<vdata_t, int>>
-      attribute_mixing_map;
+  // the distinct attributes of all fragments, in the same order on every
+  // fragment, and the index of the attribute of each vertex in it
+  std::vector<vdata_t> attr_values;
+  typename FRAG_T::template vertex_array_t<int> attr_id;
   double attribute_assortativity;
-  bool merge_stage;
   // if true, it is numeric assortativity app else attribute assortativity app
   bool numeric;
 };
@@ -0,0 +1,119 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANALYTICAL_ENGINE_APPS_BFS_MULTI_SOURCE_BFS_H_
+#define ANALYTICAL_ENGINE_APPS_BFS_MULTI_SOURCE_BFS_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "grape/grape.h"
+
+namespace gs {
+
+/**
+ * @brief Bit-parallel BFS from a batch of up to 64 sources on an unweighted
+ * fragment, in the way of MS-BFS: each vertex keeps a word of the sources that
+ * have reached it, so that one scan of the adjacency of a vertex serves all
+ * the sources of the batch.
+ *
+ * A MultiSourceBFS is used by a single thread, and is reused across batches.
+ */
+template <typename FRAG_T>
+class MultiSourceBFS {
+  using vertex_t = typename FRAG_T::vertex_t;
+
+ public:
+  static constexpr size_t kBatchSize = 64;
+
+  explicit MultiSourceBFS(const FRAG_T& frag) : frag_(frag) {
+    auto vertices = frag.Vertices();
+    seen_.Init(vertices, 0);
+    visit_.Init(vertices, 0);
+    next_.Init(vertices, 0);
+  }
+
+  /**
+   * @brief Traverse from sources, func(i, v, depth) is called on the first
+   * visit of v from sources[i], including the sources themselves at depth 0.
+   *
+   * @param incoming Traverse along the incoming edges rather than the outgoing
+   * ones.
+   */
+  template <typename FUNC_T>
+  void Run(const std::vector<vertex_t>& sources, bool incoming,
+           const FUNC_T& func) {
+    frontier_.clear();
+    touched_.clear();
+    for (size_t i = 0; i < sources.size() && i < kBatchSize; ++i) {
+      auto s = sources[i];
+      if (seen_[s] == 0) {
+        frontier_.push_back(s);
+        touched_.push_back(s);
+      }
+      seen_[s] |= uint64_t(1) << i;
+      visit_[s] |= uint64_t(1) << i;
+      func(i, s, 0);
+    }
+
+    for (int depth = 1; !frontier_.empty(); ++depth) {
+      next_frontier_.clear();
+      for (auto u : frontier_) {
+        uint64_t bits = visit_[u];
+        auto es = incoming ? frag_.GetIncomingAdjList(u)
+                           : frag_.GetOutgoingAdjList(u);
+        for (auto& e : es) {
+          vertex_t v = e.get_neighbor();
+          uint64_t reached = bits & ~seen_[v];
+          if (reached != 0) {
+            if (next_[v] == 0) {
+              next_frontier_.push_back(v);
+            }
+            next_[v] |= reached;
+            seen_[v] |= reached;
+          }
+        }
+        visit_[u] = 0;
+      }
+      for (auto v : next_frontier_) {
+        uint64_t bits = next_[v];
+        next_[v] = 0;
+        visit_[v] = bits;
+        for (; bits != 0; bits &= bits - 1) {
+          func(__builtin_ctzll(bits), v, depth);
+        }
+        touched_.push_back(v);
+      }
+      frontier_.swap(next_frontier_);
+    }
+
+    for (auto v : touched_) {
+      seen_[v] = 0;
+    }
+  }
+
+ private:
+  const FRAG_T& frag_;
+  typename FRAG_T::template vertex_array_t<uint64_t> seen_;
+  typename FRAG_T::template vertex_array_t<uint64_t> visit_;
+  typename FRAG_T::template vertex_array_t<uint64_t> next_;
+  std::vector<vertex_t> frontier_;
+  std::vector<vertex_t> next_frontier_;
+  std::vector<vertex_t> touched_;
+};
+
+}  // namespace gs
+
+#endif  // ANALYTICAL_ENGINE_APPS_BFS_MULTI_SOURCE_BFS_H_
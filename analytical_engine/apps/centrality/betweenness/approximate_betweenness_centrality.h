@@ -0,0 +1,329 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef ANALYTICAL_ENGINE_APPS_CENTRALITY_BETWEENNESS_APPROXIMATE_BETWEENNESS_CENTRALITY_H_
+#define ANALYTICAL_ENGINE_APPS_CENTRALITY_BETWEENNESS_APPROXIMATE_BETWEENNESS_CENTRALITY_H_
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <queue>
+#include <random>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "grape/grape.h"
+
+#include "apps/centrality/betweenness/approximate_betweenness_centrality_context.h"
+
+#include "core/utils/trait_utils.h"
+
+namespace gs {
+
+/**
+ * @brief Approximate the betweenness centrality of vertices by sampling
+ * shortest paths with adaptive stopping, in the way of KADABRA: each sample
+ * is a uniformly random shortest path between a random pair of vertices, and
+ * the betweenness of v is estimated by the fraction of paths passing through
+ * v.
+ *
+ * Sampling stops once the empirical Bernstein bound of every vertex is within
+ * epsilon, or at the Riondato-Kornaropoulos bound on the number of samples,
+ * so that all the estimates are within epsilon of the betweenness normalized
+ * by n(n-1) with probability at least 1 - delta.
+ * */
+template <typename FRAG_T>
+class ApproximateBetweennessCentrality
+    : public grape::ParallelAppBase<
+          FRAG_T, ApproximateBetweennessCentralityContext<FRAG_T>>,
+      public grape::ParallelEngine {
+ public:
+  INSTALL_PARALLEL_WORKER(ApproximateBetweennessCentrality<FRAG_T>,
+                          ApproximateBetweennessCentralityContext<FRAG_T>,
+                          FRAG_T)
+  static constexpr grape::MessageStrategy message_strategy =
+      grape::MessageStrategy::kSyncOnOuterVertex;
+  static constexpr grape::LoadStrategy load_strategy =
+      grape::LoadStrategy::kBothOutIn;
+  using vertex_t = typename fragment_t::vertex_t;
+  using vid_t = typename fragment_t::vid_t;
+  using edata_t = typename fragment_t::edata_t;
+
+  void PEval(const fragment_t& frag, context_t& ctx,
+             message_manager_t& messages) {
+    auto inner_vertices = frag.InnerVertices();
+    auto vertices = frag.Vertices();
+    candidates_.clear();
+    for (auto v : inner_vertices) {
+      candidates_.push_back(v);
+    }
+    size_t n = candidates_.size();
+    if (n < 3) {
+      return;
+    }
+
+    // half of delta bounds the total samples, the other half is shared by the
+    // two-sided checks of all vertices at every round.
+    double eps = ctx.epsilon;
+    double delta = ctx.failure_probability;
+    double vd = vertexDiameterBound(frag);
+    size_t omega = static_cast<size_t>(
+        std::ceil(0.5 / (eps * eps) *
+                  (std::floor(std::log2(std::max(vd - 2, 1.0))) + 1 +
+                   std::log(2.0 / delta))));
+    size_t first_round = std::min<size_t>(omega, 64 * thread_num());
+    int check_num = 1;
+    for (size_t tau = first_round; tau < omega; tau *= 2) {
+      ++check_num;
+    }
+    double log_term = std::log(8.0 * n * check_num / delta);
+
+    counts_.resize(thread_num());
+    dist_.resize(thread_num());
+    sigma_.resize(thread_num());
+    touched_.resize(thread_num());
+    gens_.clear();
+    for (int tid = 0; tid < thread_num(); ++tid) {
+      counts_[tid].Init(vertices, 0);
+      dist_[tid].Init(vertices, std::numeric_limits<double>::max());
+      sigma_[tid].Init(vertices, 0.0);
+      gens_.emplace_back(tid);
+    }
+
+    size_t tau = 0;
+    size_t target = first_round;
+    while (true) {
+      ForEach(grape::VertexRange<vid_t>(0, target - tau),
+              [&frag, this](int tid, vertex_t) { this->sample(frag, tid); },
+              16);
+      tau = target;
+
+      double max_error = 0.0;
+      for (auto v : inner_vertices) {
+        size_t count = 0;
+        for (int tid = 0; tid < thread_num(); ++tid) {
+          count += counts_[tid][v];
+        }
+        double b = static_cast<double>(count) / tau;
+        double var = tau > 1 ? b * (1 - b) * tau / (tau - 1) : 0.25;
+        double error = std::sqrt(2 * var * log_term / tau) +
+                       7 * log_term / (3 * std::max<size_t>(tau - 1, 1));
+        max_error = std::max(max_error, error);
+        ctx.centrality[v] = b * ctx.norm;
+      }
+      if (max_error <= eps || tau >= omega) {
+        break;
+      }
+      target = std::min(omega, tau * 2);
+    }
+
+    ctx.sample_num = tau;
+    LOG(INFO) << "Approximate betweenness centrality with epsilon = " << eps
+              << ", delta = " << delta << ": " << tau << " samples, at most "
+              << omega;
+
+    candidates_.clear();
+    counts_.clear();
+    dist_.clear();
+    sigma_.clear();
+    touched_.clear();
+  }
+
+  void IncEval(const fragment_t& frag, context_t& ctx,
+               message_manager_t& messages) {
+    return;
+  }
+
+ private:
+  // An upper bound of the number of vertices on a shortest path. For
+  // undirected unweighted graphs twice the eccentricity of any vertex plus one
+  // suffices, otherwise it is n.
+  double vertexDiameterBound(const fragment_t& frag) {
+    double n = candidates_.size();
+    if (frag.directed() || !std::is_same<edata_t, grape::EmptyType>::value) {
+      return n;
+    }
+    typename FRAG_T::template vertex_array_t<int> depth(frag.Vertices(), -1);
+    double bound = 0;
+    // eccentricity within each connected component
+    for (auto s : candidates_) {
+      if (depth[s] >= 0) {
+        continue;
+      }
+      std::queue<vertex_t> queue;
+      depth[s] = 0;
+      queue.push(s);
+      int ecc = 0;
+      while (!queue.empty()) {
+        vertex_t u = queue.front();
+        queue.pop();
+        ecc = depth[u];
+        for (auto& e : frag.GetOutgoingAdjList(u)) {
+          vertex_t v = e.get_neighbor();
+          if (depth[v] < 0) {
+            depth[v] = depth[u] + 1;
+            queue.push(v);
+          }
+        }
+      }
+      bound = std::max(bound, 2.0 * ecc + 1);
+    }
+    return std::min(bound, n);
+  }
+
+  // sample a random shortest path between a random pair of vertices, and count
+  // its inner vertices.
+  void sample(const fragment_t& frag, int tid) {
+    auto& gen = gens_[tid];
+    std::uniform_int_distribution<size_t> pick(0, candidates_.size() - 1);
+    vertex_t s = candidates_[pick(gen)];
+    vertex_t t = candidates_[pick(gen)];
+    while (t == s) {
+      t = candidates_[pick(gen)];
+    }
+
+    auto& dist = dist_[tid];
+    auto& sigma = sigma_[tid];
+    auto& touched = touched_[tid];
+    if (std::is_same<edata_t, grape::EmptyType>::value) {
+      bfs(frag, s, t, tid);
+    } else {
+      dijkstra(frag, s, t, tid);
+    }
+
+    if (dist[t] < std::numeric_limits<double>::max()) {
+      // walk back from t, choosing each predecessor u of v with probability
+      // sigma[u] / sigma[v].
+      vertex_t v = t;
+      while (true) {
+        std::uniform_real_distribution<double> coin(0.0, sigma[v]);
+        double r = coin(gen);
+        vertex_t pred = s;
+        auto es = frag.directed() ? frag.GetIncomingAdjList(v)
+                                  : frag.GetOutgoingAdjList(v);
+        for (auto& e : es) {
+          vertex_t u = e.get_neighbor();
+          if (dist[u] < dist[v] && dist[u] + weight(e) == dist[v]) {
+            pred = u;
+            r -= sigma[u];
+            if (r < 0) {
+              break;
+            }
+          }
+        }
+        if (pred == s) {
+          break;
+        }
+        ++counts_[tid][pred];
+        v = pred;
+      }
+    }
+
+    for (auto v : touched) {
+      dist[v] = std::numeric_limits<double>::max();
+      sigma[v] = 0.0;
+    }
+    touched.clear();
+  }
+
+  // bfs from s, stops once t is settled.
+  void bfs(const fragment_t& frag, vertex_t s, vertex_t t, int tid) {
+    auto& dist = dist_[tid];
+    auto& sigma = sigma_[tid];
+    auto& touched = touched_[tid];
+    std::queue<vertex_t> queue;
+    dist[s] = 0.0;
+    sigma[s] = 1.0;
+    touched.push_back(s);
+    queue.push(s);
+    while (!queue.empty()) {
+      vertex_t u = queue.front();
+      queue.pop();
+      if (u == t) {
+        return;
+      }
+      for (auto& e : frag.GetOutgoingAdjList(u)) {
+        vertex_t v = e.get_neighbor();
+        if (dist[v] == std::numeric_limits<double>::max()) {
+          dist[v] = dist[u] + 1;
+          touched.push_back(v);
+          queue.push(v);
+        }
+        if (dist[v] == dist[u] + 1) {
+          sigma[v] += sigma[u];
+        }
+      }
+    }
+  }
+
+  // Dijkstra from s, stops once t is settled.
+  void dijkstra(const fragment_t& frag, vertex_t s, vertex_t t, int tid) {
+    auto& dist = dist_[tid];
+    auto& sigma = sigma_[tid];
+    auto& touched = touched_[tid];
+    std::priority_queue<std::pair<double, vertex_t>> heap;
+    dist[s] = 0.0;
+    sigma[s] = 1.0;
+    touched.push_back(s);
+    heap.emplace(0, s);
+    while (!heap.empty()) {
+      vertex_t u = heap.top().second;
+      double distu = -heap.top().first;
+      heap.pop();
+      if (distu > dist[u]) {
+        continue;
+      }
+      if (u == t) {
+        return;
+      }
+      for (auto& e : frag.GetOutgoingAdjList(u)) {
+        vertex_t v = e.get_neighbor();
+        double ndistv = distu + weight(e);
+        if (dist[v] == std::numeric_limits<double>::max()) {
+          touched.push_back(v);
+        }
+        if (ndistv < dist[v]) {
+          dist[v] = ndistv;
+          sigma[v] = sigma[u];
+          heap.emplace(-ndistv, v);
+        } else if (ndistv == dist[v]) {
+          sigma[v] += sigma[u];
+        }
+      }
+    }
+  }
+
+  template <typename EDGE_T>
+  static double weight(const EDGE_T& e) {
+    double edata = 1.0;
+    vineyard::static_if<!std::is_same<edata_t, grape::EmptyType>{}>(
+        [&](auto& e, auto& data) {
+          data = static_cast<double>(e.get_data());
+        })(e, edata);
+    return edata;
+  }
+
+  std::vector<vertex_t> candidates_;
+  std::vector<typename FRAG_T::template vertex_array_t<int>> counts_;
+  std::vector<typename FRAG_T::template vertex_array_t<double>> dist_;
+  std::vector<typename FRAG_T::template vertex_array_t<double>> sigma_;
+  std::vector<std::vector<vertex_t>> touched_;
+  std::vector<std::mt19937> gens_;
+};
+
+}  // namespace gs
+
+#endif  // ANALYTICAL_ENGINE_APPS_CENTRALITY_BETWEENNESS_APPROXIMATE_BETWEENNESS_CENTRALITY_H_
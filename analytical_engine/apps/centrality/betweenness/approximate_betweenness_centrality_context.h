@@ -0,0 +1,72 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef ANALYTICAL_ENGINE_APPS_CENTRALITY_BETWEENNESS_APPROXIMATE_BETWEENNESS_CENTRALITY_CONTEXT_H_
+#define ANALYTICAL_ENGINE_APPS_CENTRALITY_BETWEENNESS_APPROXIMATE_BETWEENNESS_CENTRALITY_CONTEXT_H_
+
+#include <vector>
+
+#include "grape/grape.h"
+
+namespace gs {
+
+template <typename FRAG_T>
+class ApproximateBetweennessCentralityContext
+    : public grape::VertexDataContext<FRAG_T, double> {
+ public:
+  using oid_t = typename FRAG_T::oid_t;
+  using vid_t = typename FRAG_T::vid_t;
+  using vertex_t = typename FRAG_T::vertex_t;
+
+  explicit ApproximateBetweennessCentralityContext(const FRAG_T& fragment)
+      : grape::VertexDataContext<FRAG_T, double>(fragment),
+        centrality(this->data()) {}
+
+  void Init(grape::ParallelMessageManager& messages, double eps, double delta,
+            bool normalized = true) {
+    auto& frag = this->fragment();
+    CHECK_GT(eps, 0.0);
+    CHECK(delta > 0.0 && delta < 1.0);
+    epsilon = eps;
+    failure_probability = delta;
+    sample_num = 0;
+    // the samples estimate the betweenness normalized by n(n-1)
+    double n = frag.GetTotalVerticesNum();
+    if (normalized) {
+      norm = n > 2 ? n / (n - 2) : 1.0;
+    } else {
+      norm = n * (n - 1) * (frag.directed() ? 1.0 : 0.5);
+    }
+    centrality.SetValue(0.0);
+  }
+
+  void Output(std::ostream& os) override {
+    auto& frag = this->fragment();
+    auto inner_vertices = frag.InnerVertices();
+
+    for (auto& u : inner_vertices) {
+      os << frag.GetId(u) << "\t" << centrality[u] << std::endl;
+    }
+  }
+
+  double epsilon;
+  double failure_probability;  // delta
+  double norm;
+  size_t sample_num;
+  typename FRAG_T::template vertex_array_t<double>& centrality;
+};
+}  // namespace gs
+
+#endif  // ANALYTICAL_ENGINE_APPS_CENTRALITY_BETWEENNESS_APPROXIMATE_BETWEENNESS_CENTRALITY_CONTEXT_H_
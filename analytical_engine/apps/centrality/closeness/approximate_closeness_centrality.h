@@ -0,0 +1,230 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef ANALYTICAL_ENGINE_APPS_CENTRALITY_CLOSENESS_APPROXIMATE_CLOSENESS_CENTRALITY_H_
+#define ANALYTICAL_ENGINE_APPS_CENTRALITY_CLOSENESS_APPROXIMATE_CLOSENESS_CENTRALITY_H_
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <queue>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "grape/grape.h"
+
+#include "apps/bfs/multi_source_bfs.h"
+#include "apps/centrality/closeness/approximate_closeness_centrality_context.h"
+
+#include "core/utils/trait_utils.h"
+
+namespace gs {
+
+/**
+ * @brief Approximate the closeness centrality of vertices by pivot sampling,
+ * in the way of Eppstein and Wang: the distances to a vertex are averaged over
+ * the shortest paths from k randomly chosen pivots rather than from every
+ * vertex.
+ *
+ * With k = ln(2n / delta) / (2 * epsilon^2) pivots, the estimated average
+ * distance to every vertex is within epsilon times the diameter of the exact
+ * one with probability at least 1 - delta. All vertices are used as pivots
+ * when k >= n, where the result is exact.
+ * */
+template <typename FRAG_T>
+class ApproximateClosenessCentrality
+    : public grape::ParallelAppBase<
+          FRAG_T, ApproximateClosenessCentralityContext<FRAG_T>>,
+      public grape::ParallelEngine {
+ public:
+  INSTALL_PARALLEL_WORKER(ApproximateClosenessCentrality<FRAG_T>,
+                          ApproximateClosenessCentralityContext<FRAG_T>,
+                          FRAG_T)
+  static constexpr grape::MessageStrategy message_strategy =
+      grape::MessageStrategy::kSyncOnOuterVertex;
+  static constexpr grape::LoadStrategy load_strategy =
+      grape::LoadStrategy::kBothOutIn;
+  using vertex_t = typename fragment_t::vertex_t;
+  using vid_t = typename fragment_t::vid_t;
+  using edata_t = typename fragment_t::edata_t;
+
+  void PEval(const fragment_t& frag, context_t& ctx,
+             message_manager_t& messages) {
+    auto inner_vertices = frag.InnerVertices();
+    auto vertices = frag.Vertices();
+    size_t total_node_num = vertices.size();
+    std::vector<vertex_t> pivots = samplePivots(frag, ctx);
+    LOG(INFO) << "Approximate closeness centrality with epsilon = "
+              << ctx.epsilon << ", delta = " << ctx.failure_probability
+              << ": " << pivots.size() << " pivots of " << total_node_num
+              << " vertices";
+    if (pivots.empty()) {
+      return;
+    }
+
+    tot_sp_.resize(thread_num());
+    connected_.resize(thread_num());
+    for (int tid = 0; tid < thread_num(); ++tid) {
+      tot_sp_[tid].Init(vertices, 0.0);
+      connected_[tid].Init(vertices, 0);
+    }
+
+    if (std::is_same<edata_t, grape::EmptyType>::value) {
+      batchedBFS(frag, pivots);
+    } else {
+      std::vector<typename FRAG_T::template vertex_array_t<double>> length(
+          thread_num());
+      for (auto& unit : length) {
+        unit.Init(vertices, std::numeric_limits<double>::max());
+      }
+      ForEach(pivots.begin(), pivots.end(),
+              [&frag, &length, this](int tid, vertex_t s) {
+                this->dijkstra(frag, s, length[tid], tid);
+              },
+              1);
+    }
+
+    double scale = static_cast<double>(total_node_num) / pivots.size();
+    ForEach(inner_vertices, [&ctx, total_node_num, scale, this](int tid,
+                                                                vertex_t u) {
+      double tot_sp = 0.0;
+      double connected = 0.0;
+      for (int i = 0; i < this->thread_num(); ++i) {
+        tot_sp += this->tot_sp_[i][u];
+        connected += this->connected_[i][u];
+      }
+      // the number of vertices reaching u and the sum of their distances to u
+      tot_sp *= scale;
+      connected = std::max(connected * scale, 1.0);
+      double closeness_centrality = 0.0;
+      if (tot_sp > 0 && total_node_num > 1) {
+        closeness_centrality = (connected - 1.0) / tot_sp;
+        if (ctx.wf_improve) {
+          closeness_centrality *= ((connected - 1.0) / (total_node_num - 1));
+        }
+      }
+      ctx.centrality[u] = closeness_centrality;
+    });
+
+    tot_sp_.clear();
+    connected_.clear();
+  }
+
+  void IncEval(const fragment_t& frag, context_t& ctx,
+               message_manager_t& messages) {
+    return;
+  }
+
+ private:
+  // the pivots are drawn with a fixed seed, so that runs are reproducible.
+  std::vector<vertex_t> samplePivots(const fragment_t& frag, context_t& ctx) {
+    std::vector<vertex_t> candidates;
+    for (auto v : frag.InnerVertices()) {
+      candidates.push_back(v);
+    }
+    size_t n = frag.Vertices().size();
+    double k = std::ceil(std::log(2.0 * n / ctx.failure_probability) /
+                         (2.0 * ctx.epsilon * ctx.epsilon));
+    size_t pivot_num = candidates.size();
+    if (k < static_cast<double>(pivot_num)) {
+      pivot_num = static_cast<size_t>(k);
+      std::mt19937 gen(0);
+      for (size_t i = 0; i < pivot_num; ++i) {
+        std::uniform_int_distribution<size_t> dist(i, candidates.size() - 1);
+        std::swap(candidates[i], candidates[dist(gen)]);
+      }
+      candidates.resize(pivot_num);
+    }
+    ctx.pivot_num = pivot_num;
+    return candidates;
+  }
+
+  // forward bfs from 64 pivots at a time.
+  void batchedBFS(const fragment_t& frag, const std::vector<vertex_t>& pivots) {
+    using bfs_t = MultiSourceBFS<fragment_t>;
+    std::vector<std::unique_ptr<bfs_t>> bfs(thread_num());
+    for (auto& unit : bfs) {
+      unit.reset(new bfs_t(frag));
+    }
+    vid_t batch_num =
+        (pivots.size() + bfs_t::kBatchSize - 1) / bfs_t::kBatchSize;
+
+    ForEach(
+        grape::VertexRange<vid_t>(0, batch_num),
+        [&](int tid, vertex_t batch) {
+          auto begin = pivots.begin() + batch.GetValue() * bfs_t::kBatchSize;
+          auto end = std::min(begin + bfs_t::kBatchSize, pivots.end());
+          std::vector<vertex_t> batch_pivots(begin, end);
+          auto& tot_sp = tot_sp_[tid];
+          auto& connected = connected_[tid];
+          bfs[tid]->Run(batch_pivots, false,
+                        [&](size_t i, vertex_t v, int depth) {
+                          tot_sp[v] += depth;
+                          ++connected[v];
+                        });
+        },
+        1);
+  }
+
+  // sequential single source Dijkstra from a pivot, length is left with all
+  // entries at max afterwards.
+  void dijkstra(const fragment_t& frag, vertex_t s,
+                typename FRAG_T::template vertex_array_t<double>& length,
+                int tid) {
+    std::priority_queue<std::pair<double, vertex_t>> heap;
+    std::vector<vertex_t> settled;
+    length[s] = 0.0;
+    heap.emplace(0, s);
+
+    while (!heap.empty()) {
+      vertex_t u = heap.top().second;
+      double distu = -heap.top().first;
+      heap.pop();
+      if (distu > length[u]) {
+        continue;
+      }
+      settled.push_back(u);
+      tot_sp_[tid][u] += distu;
+      ++connected_[tid][u];
+
+      for (auto& e : frag.GetOutgoingAdjList(u)) {
+        vertex_t v = e.get_neighbor();
+        double edata = 1.0;
+        vineyard::static_if<!std::is_same<edata_t, grape::EmptyType>{}>(
+            [&](auto& e, auto& data) {
+              data = static_cast<double>(e.get_data());
+            })(e, edata);
+        double ndistv = distu + edata;
+        if (length[v] > ndistv) {
+          length[v] = ndistv;
+          heap.emplace(-ndistv, v);
+        }
+      }
+    }
+
+    for (auto v : settled) {
+      length[v] = std::numeric_limits<double>::max();
+    }
+  }
+
+  std::vector<typename FRAG_T::template vertex_array_t<double>> tot_sp_;
+  std::vector<typename FRAG_T::template vertex_array_t<int>> connected_;
+};
+
+}  // namespace gs
+
+#endif  // ANALYTICAL_ENGINE_APPS_CENTRALITY_CLOSENESS_APPROXIMATE_CLOSENESS_CENTRALITY_H_
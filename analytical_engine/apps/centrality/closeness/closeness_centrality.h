@@ -16,14 +16,17 @@ limitations under the License.
 #ifndef ANALYTICAL_ENGINE_APPS_CENTRALITY_CLOSENESS_CLOSENESS_CENTRALITY_H_
 #define ANALYTICAL_ENGINE_APPS_CENTRALITY_CLOSENESS_CLOSENESS_CENTRALITY_H_
 
+#include <algorithm>
 #include <limits>
 #include <map>
+#include <memory>
 #include <queue>
 #include <utility>
 #include <vector>
 
 #include "grape/grape.h"
 
+#include "apps/bfs/multi_source_bfs.h"
 #include "apps/centrality/closeness/closeness_centrality_context.h"
 
 #include "core/utils/trait_utils.h"
@@ -52,18 +55,26 @@ class ClosenessCentrality
 
   void PEval(const fragment_t& frag, context_t& ctx,
              message_manager_t& messages) {
-    auto inner_vertices = frag.InnerVertices();
+    if (std::is_same<edata_t, grape::EmptyType>::value) {
+      // unweighted graph, use batched bfs.
+      batchedBFSLength(frag, ctx);
+      return;
+    }
+
     auto vertices = frag.Vertices();
     ctx.length.resize(thread_num());
+    ctx.reached.resize(thread_num());
     for (auto& unit : ctx.length) {
-      unit.Init(vertices);
+      unit.Init(vertices, std::numeric_limits<double>::max());
     }
 
-    ForEach(inner_vertices, [&frag, &ctx, this](int tid, vertex_t v) {
-      ctx.length[tid].SetValue(std::numeric_limits<double>::max());
-      this->reversedDijkstraLength(frag, v, ctx, tid);
-      this->compute(frag, v, ctx, tid);
-    });
+    ForEach(
+        ctx.sources.begin(), ctx.sources.end(),
+        [&frag, &ctx, this](int tid, vertex_t v) {
+          this->reversedDijkstraLength(frag, v, ctx, tid);
+          this->compute(frag, v, ctx, tid);
+        },
+        1);
   }
 
   void IncEval(const fragment_t& frag, context_t& ctx,
@@ -72,61 +83,104 @@ class ClosenessCentrality
   }
 
  private:
-  // sequential single source Dijkstra length algorithm.
+  // sequential single source Dijkstra length algorithm, the reached vertices
+  // are recorded so that the search costs only as much as it reaches.
   void reversedDijkstraLength(const fragment_t& frag, vertex_t& s,
                               context_t& ctx, int tid) {
-    {
-      auto vertices = frag.Vertices();
-      std::priority_queue<std::pair<double, vertex_t>> heap;
-      typename FRAG_T::template vertex_array_t<bool> modified(vertices, false);
-      ctx.length[tid][s] = 0.0;
-      heap.emplace(0, s);
-
-      double distu, distv, ndistv;
-      vertex_t v, u;
-      while (!heap.empty()) {
-        u = heap.top().second;
-        distu = -heap.top().first;
-        heap.pop();
-
-        if (modified[u]) {
-          continue;
-        }
-        modified[u] = true;
-
-        auto es = frag.directed() ? frag.GetIncomingAdjList(u)
-                                  : frag.GetOutgoingAdjList(u);
-        for (auto& e : es) {
-          v = e.get_neighbor();
-          distv = ctx.length[tid][v];
-          double edata = 1.0;
-          vineyard::static_if<!std::is_same<edata_t, grape::EmptyType>{}>(
-              [&](auto& e, auto& data) {
-                data = static_cast<double>(e.get_data());
-              })(e, edata);
-          ndistv = distu + edata;
-          if (distv > ndistv) {
-            ctx.length[tid][v] = ndistv;
-            heap.emplace(-ndistv, v);
+    auto& length = ctx.length[tid];
+    auto& reached = ctx.reached[tid];
+    std::priority_queue<std::pair<double, vertex_t>> heap;
+    length[s] = 0.0;
+    reached.push_back(s);
+    heap.emplace(0, s);
+
+    double distu, distv, ndistv;
+    vertex_t v, u;
+    while (!heap.empty()) {
+      u = heap.top().second;
+      distu = -heap.top().first;
+      heap.pop();
+
+      // settled by a shorter path already
+      if (distu > length[u]) {
+        continue;
+      }
+
+      auto es = frag.directed() ? frag.GetIncomingAdjList(u)
+                                : frag.GetOutgoingAdjList(u);
+      for (auto& e : es) {
+        v = e.get_neighbor();
+        distv = length[v];
+        double edata = 1.0;
+        vineyard::static_if<!std::is_same<edata_t, grape::EmptyType>{}>(
+            [&](auto& e, auto& data) {
+              data = static_cast<double>(e.get_data());
+            })(e, edata);
+        ndistv = distu + edata;
+        if (distv > ndistv) {
+          if (distv == std::numeric_limits<double>::max()) {
+            reached.push_back(v);
           }
+          length[v] = ndistv;
+          heap.emplace(-ndistv, v);
         }
       }
     }
   }
 
+  // reversed bfs length from 64 sources at a time, accumulated at once.
+  void batchedBFSLength(const fragment_t& frag, context_t& ctx) {
+    using bfs_t = MultiSourceBFS<fragment_t>;
+    auto& sources = ctx.sources;
+    std::vector<std::unique_ptr<bfs_t>> bfs(thread_num());
+    for (auto& unit : bfs) {
+      unit.reset(new bfs_t(frag));
+    }
+    int total_node_num = frag.Vertices().size();
+    vid_t batch_num = (sources.size() + bfs_t::kBatchSize - 1) /
+                      bfs_t::kBatchSize;
+
+    ForEach(
+        grape::VertexRange<vid_t>(0, batch_num),
+        [&](int tid, vertex_t batch) {
+          auto begin = sources.begin() + batch.GetValue() * bfs_t::kBatchSize;
+          auto end = std::min(begin + bfs_t::kBatchSize, sources.end());
+          std::vector<vertex_t> batch_sources(begin, end);
+          std::vector<double> tot_sp(batch_sources.size(), 0.0);
+          std::vector<int> connected_nodes_num(batch_sources.size(), 0);
+          bfs[tid]->Run(batch_sources, frag.directed(),
+                        [&](size_t i, vertex_t v, int depth) {
+                          tot_sp[i] += depth;
+                          ++connected_nodes_num[i];
+                        });
+          for (size_t i = 0; i < batch_sources.size(); ++i) {
+            double closeness_centrality = 0.0;
+            if (tot_sp[i] > 0 && total_node_num > 1) {
+              closeness_centrality = (connected_nodes_num[i] - 1.0) / tot_sp[i];
+              if (ctx.wf_improve) {
+                closeness_centrality *=
+                    ((connected_nodes_num[i] - 1.0) / (total_node_num - 1));
+              }
+            }
+            ctx.centrality[batch_sources[i]] = closeness_centrality;
+          }
+        },
+        1);
+  }
+
+  // computes from the lengths of the last search, and resets them.
   void compute(const fragment_t& frag, vertex_t& u, context_t& ctx, int tid) {
+    auto& length = ctx.length[tid];
+    auto& reached = ctx.reached[tid];
     double tot_sp = 0.0;
-    int connected_nodes_num = 0;
-    int total_node_num = 0;
-    auto vertices = frag.Vertices();
+    int connected_nodes_num = reached.size();
+    int total_node_num = frag.Vertices().size();
     double closeness_centrality = 0.0;
-    for (auto& v : vertices) {
-      if (ctx.length[tid][v] < std::numeric_limits<double>::max()) {
-        tot_sp += ctx.length[tid][v];
-        ++connected_nodes_num;
-      }
-      ++total_node_num;
+    for (auto& v : reached) {
+      tot_sp += length[v];
+      length[v] = std::numeric_limits<double>::max();
     }
+    reached.clear();
     if (tot_sp > 0 && total_node_num > 1) {
       closeness_centrality = (connected_nodes_num - 1.0) / tot_sp;
       if (ctx.wf_improve) {
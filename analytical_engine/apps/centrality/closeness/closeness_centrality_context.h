@@ -19,11 +19,14 @@ limitations under the License.
 #include <limits>
 #include <map>
 #include <queue>
+#include <string>
 #include <utility>
 #include <vector>
 
 #include "grape/grape.h"
 
+#include "apps/boundary/utils.h"
+
 namespace gs {
 
 template <typename FRAG_T>
@@ -38,11 +41,31 @@ class ClosenessCentralityContext
       : grape::VertexDataContext<FRAG_T, double>(fragment),
         centrality(this->data()) {}
 
-  void Init(grape::ParallelMessageManager& messages, bool wf) {
+  /**
+   * @param nbunch A JSON array of the vertices to compute, or empty for all
+   * vertices.
+   */
+  void Init(grape::ParallelMessageManager& messages, bool wf,
+            const std::string& nbunch) {
     auto& frag = this->fragment();
-    auto vertices = frag.Vertices();
     wf_improve = wf;
     centrality.SetValue(0.0);
+
+    sources.clear();
+    if (nbunch.empty()) {
+      for (auto v : frag.InnerVertices()) {
+        sources.push_back(v);
+      }
+    } else {
+      dynamic::Value node_array;
+      dynamic::Parse(nbunch, node_array);
+      vertex_t v;
+      for (auto& node : node_array) {
+        if (frag.GetInnerVertex(dynamic_to_oid<oid_t>(node), v)) {
+          sources.push_back(v);
+        }
+      }
+    }
   }
 
   void Output(std::ostream& os) override {
@@ -55,7 +78,11 @@ class ClosenessCentralityContext
   }
 
   bool wf_improve;  // use Wasserman-Faust improved formula.
+  // the inner vertices to compute
+  std::vector<vertex_t> sources;
   std::vector<typename FRAG_T::template vertex_array_t<double>> length;
+  // the vertices reached by the last search of each thread
+  std::vector<std::vector<vertex_t>> reached;
   typename FRAG_T::template vertex_array_t<double>& centrality;
 };
 }  // namespace gs
@@ -51,33 +51,25 @@ class EigenvectorCentrality
   using edata_t = typename fragment_t::edata_t;
   using vid_t = typename FRAG_T::vid_t;
 
-  bool NormAndCheckTerm(const fragment_t& frag, context_t& ctx, int thrd_num) {
+  bool NormAndCheckTerm(const fragment_t& frag, context_t& ctx) {
     auto inner_vertices = frag.InnerVertices();
-    std::vector<double> thread_local_sum(thrd_num, 0.0);
-    double local_sum = 0.0, global_sum = 0;
+    auto& reducer = ctx.reducer;
     ForEach(inner_vertices.begin(), inner_vertices.end(),
-            [&thread_local_sum, &ctx](int tid, vertex_t v) {
-              thread_local_sum[tid] += ctx.x[v] * ctx.x[v];
+            [&reducer, &ctx](int tid, vertex_t v) {
+              reducer.Add(tid, 0, ctx.x[v] * ctx.x[v]);
             });
-    for (int tid = 0; tid < thrd_num; tid++) {
-      local_sum += thread_local_sum[tid];
-    }
-    Sum(local_sum, global_sum);
+    reducer.Sum(*this);
 
-    double norm = sqrt(global_sum);
+    double norm = sqrt(reducer[0]);
     CHECK_GT(norm, 0);
 
-    std::vector<double> thread_local_delta_sum(thrd_num, 0.0);
-    double local_delta_sum = 0, global_delta_sum = 0;
     ForEach(inner_vertices.begin(), inner_vertices.end(),
-            [&thread_local_delta_sum, &ctx, &norm](int tid, vertex_t v) {
+            [&reducer, &ctx, &norm](int tid, vertex_t v) {
               ctx.x[v] /= norm;
-              thread_local_delta_sum[tid] += std::abs(ctx.x[v] - ctx.x_last[v]);
+              reducer.Add(tid, 0, std::abs(ctx.x[v] - ctx.x_last[v]));
             });
-    for (int tid = 0; tid < thrd_num; tid++) {
-      local_delta_sum += thread_local_delta_sum[tid];
-    }
-    Sum(local_delta_sum, global_delta_sum);
+    reducer.Sum(*this);
+    double global_delta_sum = reducer[0];
     VLOG(1) << "[step - " << ctx.curr_round << " ] Diff: " << global_delta_sum;
     if (global_delta_sum < frag.GetTotalVerticesNum() * ctx.tolerance ||
         ctx.curr_round >= ctx.max_round) {
@@ -90,53 +82,29 @@ class EigenvectorCentrality
 
   void Pull(const fragment_t& frag, context_t& ctx,
             message_manager_t& messages) {
-    auto inner_vertices = frag.InnerVertices();
     auto& x = ctx.x;
     auto& x_last = ctx.x_last;
 
-    if (frag.directed()) {
-      ForEach(
-          inner_vertices.begin(), inner_vertices.end(),
-          [&x, &x_last, &frag](int tid, vertex_t v) {
-            auto es = frag.GetIncomingAdjList(v);
-            x[v] = x_last[v];
-            for (auto& e : es) {
-              double edata = 1.0;
-              vineyard::static_if<!std::is_same<edata_t, grape::EmptyType>{}>(
-                  [&](auto& e, auto& data) {
-                    data = static_cast<double>(e.get_data());
-                  })(e, edata);
-              x[v] += x_last[e.get_neighbor()] * edata;
-            }
-          });
-    } else {
-      ForEach(
-          inner_vertices.begin(), inner_vertices.end(),
-          [&x, &x_last, &frag](int tid, vertex_t v) {
-            auto es = frag.GetOutgoingAdjList(v);
-            x[v] = x_last[v];
-            for (auto& e : es) {
-              double edata = 1.0;
-              vineyard::static_if<!std::is_same<edata_t, grape::EmptyType>{}>(
-                  [&](auto& e, auto& data) {
-                    data = static_cast<double>(e.get_data());
-                  })(e, edata);
-              x[v] += x_last[e.get_neighbor()] * edata;
-            }
-          });
-    }
+    ctx.spmv.Multiply(*this, x_last,
+                      [&x, &x_last](int tid, vertex_t v, double sum) {
+                        x[v] = x_last[v] + sum;
+                      });
   }
 
   void PEval(const fragment_t& frag, context_t& ctx,
              message_manager_t& messages) {
-    int thrd_num = thread_num();
     messages.InitChannels(thread_num());
+    ctx.reducer.Init(thread_num(), 1);
+    ctx.spmv.Init(frag,
+                  frag.directed() ? SpMVDirection::kIncoming
+                                  : SpMVDirection::kOutgoing,
+                  true, thread_num());
     Pull(frag, ctx, messages);
     auto inner_vertices = frag.InnerVertices();
 
     // call NormAndCheckTerm before send. because we normalize the vector 'x' in
     // the function.
-    if (NormAndCheckTerm(frag, ctx, thrd_num))
+    if (NormAndCheckTerm(frag, ctx))
       return;
 
     if (frag.fnum() == 1) {
@@ -165,7 +133,7 @@ class EigenvectorCentrality
 
     Pull(frag, ctx, messages);
 
-    if (NormAndCheckTerm(frag, ctx, thrd_num))
+    if (NormAndCheckTerm(frag, ctx))
       return;
 
     if (frag.fnum() == 1) {
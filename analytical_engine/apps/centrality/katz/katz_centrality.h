@@ -48,28 +48,18 @@ class KatzCentrality
   using edata_t = typename fragment_t::edata_t;
   using vid_t = typename FRAG_T::vid_t;
 
-  bool CheckTerm(const fragment_t& frag, context_t& ctx, int thrd_num) {
+  bool CheckTerm(const fragment_t& frag, context_t& ctx) {
     auto inner_vertices = frag.InnerVertices();
-    std::vector<double> thread_local_sum(thrd_num, 0.0);
-    std::vector<double> thread_local_delta_sum(thrd_num, 0.0);
-    double local_sum = 0.0, local_delta_sum = 0.0;
-    double global_sum = 0, global_delta_sum = 0;
+    auto& reducer = ctx.reducer;
 
     ForEach(inner_vertices.begin(), inner_vertices.end(),
-            [&thread_local_sum, &thread_local_delta_sum, &ctx](int tid,
-                                                               vertex_t v) {
-              thread_local_sum[tid] += ctx.x[v] * ctx.x[v];
-              thread_local_delta_sum[tid] +=
-                  std::fabs(ctx.x[v] - ctx.x_last[v]);
+            [&reducer, &ctx](int tid, vertex_t v) {
+              reducer.Add(tid, 0, ctx.x[v] * ctx.x[v]);
+              reducer.Add(tid, 1, std::fabs(ctx.x[v] - ctx.x_last[v]));
             });
-
-    for (int tid = 0; tid < thrd_num; tid++) {
-      local_sum += thread_local_sum[tid];
-      local_delta_sum += thread_local_delta_sum[tid];
-    }
-
-    Sum(local_sum, global_sum);
-    Sum(local_delta_sum, global_delta_sum);
+    // the norm and the delta in a single all-reduce
+    reducer.Sum(*this);
+    double global_sum = reducer[0], global_delta_sum = reducer[1];
 
     VLOG(1) << "[step - " << ctx.curr_round << " ] Diff: " << global_delta_sum;
     if (global_delta_sum < frag.GetTotalVerticesNum() * ctx.tolerance ||
@@ -84,53 +74,25 @@ class KatzCentrality
 
   void pullAndSend(const fragment_t& frag, context_t& ctx,
                    message_manager_t& messages) {
-    auto inner_vertices = frag.InnerVertices();
-    if (frag.directed()) {
-      ForEach(
-          inner_vertices.begin(), inner_vertices.end(),
-          [this, &ctx, &frag, &messages](int tid, vertex_t v) {
-            if (!filterByDegree(frag, ctx, v)) {
-              auto es = frag.GetIncomingAdjList(v);
-              ctx.x[v] = 0;
-              for (auto& e : es) {
-                // do the multiplication y^T = Alpha * x^T A - Beta
-                double edata = 1.0;
-                vineyard::static_if<!std::is_same<edata_t, grape::EmptyType>{}>(
-                    [&](auto& e, auto& data) {
-                      data = static_cast<double>(e.get_data());
-                    })(e, edata);
-                ctx.x[v] += ctx.x_last[e.get_neighbor()] * edata;
-              }
-              ctx.x[v] = ctx.x[v] * ctx.alpha + ctx.beta;
-              messages.Channels()[tid].SendMsgThroughOEdges(frag, v, ctx.x[v]);
-            }
-          });
-    } else {
-      ForEach(
-          inner_vertices.begin(), inner_vertices.end(),
-          [this, &ctx, &frag, &messages](int tid, vertex_t v) {
-            if (!filterByDegree(frag, ctx, v)) {
-              auto es = frag.GetOutgoingAdjList(v);
-              ctx.x[v] = 0;
-              for (auto& e : es) {
-                // do the multiplication y^T = Alpha * x^T A - Beta
-                double edata = 1.0;
-                vineyard::static_if<!std::is_same<edata_t, grape::EmptyType>{}>(
-                    [&](auto& e, auto& data) {
-                      data = static_cast<double>(e.get_data());
-                    })(e, edata);
-                ctx.x[v] += ctx.x_last[e.get_neighbor()] * edata;
-              }
-              ctx.x[v] = ctx.x[v] * ctx.alpha + ctx.beta;
-              messages.Channels()[tid].SendMsgThroughOEdges(frag, v, ctx.x[v]);
-            }
-          });
-    }
+    // do the multiplication y^T = Alpha * x^T A - Beta
+    ctx.spmv.Multiply(
+        *this, ctx.x_last,
+        [this, &ctx, &frag, &messages](int tid, vertex_t v, double sum) {
+          if (!filterByDegree(frag, ctx, v)) {
+            ctx.x[v] = sum * ctx.alpha + ctx.beta;
+            messages.Channels()[tid].SendMsgThroughOEdges(frag, v, ctx.x[v]);
+          }
+        });
   }
 
   void PEval(const fragment_t& frag, context_t& ctx,
              message_manager_t& messages) {
     messages.InitChannels(thread_num());
+    ctx.reducer.Init(thread_num(), 2);
+    ctx.spmv.Init(frag,
+                  frag.directed() ? SpMVDirection::kIncoming
+                                  : SpMVDirection::kOutgoing,
+                  true, thread_num());
     pullAndSend(frag, ctx, messages);
 
     if (frag.fnum() == 1) {
@@ -146,7 +108,7 @@ class KatzCentrality
     auto& x_last = ctx.x_last;
 
     // we only sum inner vertices, so put CheckTerm before GetMessage is fine
-    if (CheckTerm(frag, ctx, thrd_num)) {
+    if (CheckTerm(frag, ctx)) {
       auto global_sum = ctx.global_sum;
 
       CHECK_GT(global_sum, 0);
@@ -21,6 +21,8 @@
 #include "grape/grape.h"
 
 #include "core/app/app_base.h"
+#include "core/parallel/round_reducer.h"
+#include "core/parallel/segmented_spmv.h"
 
 namespace gs {
 template <typename FRAG_T>
@@ -61,6 +63,9 @@ class KatzCentralityContext : public grape::VertexDataContext<FRAG_T, double> {
 
   typename FRAG_T::template vertex_array_t<double>& x;
   typename FRAG_T::template vertex_array_t<double> x_last;
+  // the adjacency pulled along, built in PEval
+  SegmentedSpMV<FRAG_T> spmv;
+  RoundReducer reducer;
 
   double alpha;
   double beta;
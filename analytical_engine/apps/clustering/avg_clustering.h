@@ -61,7 +61,6 @@ class AvgClustering
   void IncEval(const fragment_t& frag, context_t& ctx,
                message_manager_t& messages) {
     using vid_t = typename context_t::vid_t;
-    auto vertices = frag.Vertices();
     auto inner_vertices = frag.InnerVertices();
     auto outer_vertices = frag.OuterVertices();
     if (ctx.stage == 0) {
@@ -179,27 +178,17 @@ class AvgClustering
                 }
               });
 
-      typename FRAG_T::template vertex_array_t<uint32_t> v0_nbr_set(vertices,
-                                                                    0);
-      for (auto v : inner_vertices) {
-        auto& v0_nbr_vec = ctx.complete_neighbor[v];
-        for (auto u : v0_nbr_vec) {
-          v0_nbr_set[u.first] = u.second;
-        }
-        for (auto u : v0_nbr_vec) {
-          auto& v1_nbr_vec = ctx.complete_neighbor[u.first];
-          for (auto w : v1_nbr_vec) {
-            if (v0_nbr_set[w.first] != 0) {
-              ctx.tricnt[u.first] += v0_nbr_set[w.first] * u.second * w.second;
-              ctx.tricnt[v] += v0_nbr_set[w.first] * u.second * w.second;
-              ctx.tricnt[w.first] += v0_nbr_set[w.first] * u.second * w.second;
-            }
-          }
-        }
-        for (auto u : v0_nbr_vec) {
-          v0_nbr_set[u.first] = 0;
-        }
-      }
+      ctx.adjacency.Build(frag, *this, ctx.complete_neighbor);
+      ForEach(inner_vertices, [&ctx](int tid, vertex_t v) {
+        ctx.adjacency.ForEachTriangle(v, [&ctx, v](vertex_t u, vertex_t w,
+                                                   uint32_t vu, uint32_t vw,
+                                                   uint32_t uw) {
+          int count = vu * vw * uw;
+          grape::atomic_add(ctx.tricnt[u], count);
+          grape::atomic_add(ctx.tricnt[v], count);
+          grape::atomic_add(ctx.tricnt[w], count);
+        });
+      });
 
       ForEach(outer_vertices, [&messages, &frag, &ctx](int tid, vertex_t v) {
         if (ctx.tricnt[v] != 0) {
@@ -23,6 +23,8 @@
 
 #include "grape/grape.h"
 
+#include "apps/clustering/oriented_adjacency.h"
+
 #include "core/context/tensor_context.h"
 
 namespace gs {
@@ -68,6 +70,7 @@ class AvgClusteringContext : public TensorContext<FRAG_T, float> {
   typename FRAG_T::template vertex_array_t<
       std::vector<std::pair<vertex_t, uint32_t>>>
       complete_neighbor;
+  OrientedAdjacency<FRAG_T> adjacency;
   typename FRAG_T::template vertex_array_t<int> tricnt;
   int degree_threshold = 0;
   float total_clustering = 0.0;
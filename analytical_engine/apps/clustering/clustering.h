@@ -189,42 +189,19 @@ class Clustering
                 }
               });
 
-      std::vector<typename FRAG_T::template vertex_array_t<uint32_t>>
-          vertexsets(thread_num());
-      ForEach(
-          inner_vertices,
-          [&vertexsets, &frag](int tid) {
-            auto& ns = vertexsets[tid];
-            ns.Init(frag.Vertices(), 0);
-          },
-          [&vertexsets, &ctx](int tid, vertex_t v) {
-            if (ctx.global_degree[v] > 1) {
-              auto& v0_nbr_set = vertexsets[tid];
-              auto& v0_nbr_vec = ctx.complete_neighbor[v];
-              for (auto u : v0_nbr_vec) {
-                v0_nbr_set[u.first] = u.second;
-              }
-              for (auto u : v0_nbr_vec) {
-                auto& v1_nbr_vec = ctx.complete_neighbor[u.first];
-                for (auto w : v1_nbr_vec) {
-                  if (v0_nbr_set[w.first] != 0) {
-                    grape::atomic_add(
-                        ctx.tricnt[u.first],
-                        v0_nbr_set[w.first] * u.second * w.second);
-                    grape::atomic_add(ctx.tricnt[v], v0_nbr_set[w.first] *
-                                                         u.second * w.second);
-                    grape::atomic_add(
-                        ctx.tricnt[w.first],
-                        v0_nbr_set[w.first] * u.second * w.second);
-                  }
-                }
-              }
-              for (auto u : v0_nbr_vec) {
-                v0_nbr_set[u.first] = 0;
-              }
-            }
-          },
-          [](int tid) {});
+      ctx.adjacency.Build(frag, *this, ctx.complete_neighbor);
+      ForEach(inner_vertices, [&ctx](int tid, vertex_t v) {
+        if (ctx.global_degree[v] > 1) {
+          ctx.adjacency.ForEachTriangle(v, [&ctx, v](vertex_t u, vertex_t w,
+                                                     uint32_t vu, uint32_t vw,
+                                                     uint32_t uw) {
+            uint32_t count = vu * vw * uw;
+            grape::atomic_add(ctx.tricnt[u], count);
+            grape::atomic_add(ctx.tricnt[v], count);
+            grape::atomic_add(ctx.tricnt[w], count);
+          });
+        }
+      });
 
       ForEach(outer_vertices, [&messages, &frag, &ctx](int tid, vertex_t v) {
         if (ctx.tricnt[v] != 0) {
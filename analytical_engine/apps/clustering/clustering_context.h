@@ -23,6 +23,8 @@ limitations under the License.
 
 #include "grape/grape.h"
 
+#include "apps/clustering/oriented_adjacency.h"
+
 namespace gs {
 /**
  * @brief Context for clustering.
@@ -74,6 +76,7 @@ class ClusteringContext : public grape::VertexDataContext<FRAG_T, double> {
   typename FRAG_T::template vertex_array_t<
       std::vector<std::pair<vertex_t, uint32_t>>>
       complete_neighbor;
+  OrientedAdjacency<FRAG_T> adjacency;
   typename FRAG_T::template vertex_array_t<uint32_t> tricnt;
   int degree_threshold = 0;
 
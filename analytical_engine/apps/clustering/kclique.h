@@ -0,0 +1,343 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANALYTICAL_ENGINE_APPS_CLUSTERING_KCLIQUE_H_
+#define ANALYTICAL_ENGINE_APPS_CLUSTERING_KCLIQUE_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "grape/grape.h"
+
+#include "apps/clustering/kclique_context.h"
+
+namespace gs {
+
+/**
+ * @brief Count the k-cliques of the graph, taking directed edges as
+ * undirected ones.
+ *
+ * The edges are oriented by an approximate degeneracy order: in each round,
+ * the unranked vertices with at most (1 + epsilon) times the average degree
+ * among unranked vertices are ranked by the round, as in the ranking rounds
+ * of the Flash degeneracy ordering, so that a vertex keeps at most
+ * 2 (1 + epsilon) times the degeneracy of neighbors after it, in a logarithmic
+ * number of rounds. A clique is then counted once, by its first vertex, among
+ * the oriented neighbors of that vertex, whose own oriented neighbors are
+ * sent by their owners as in triangle counting.
+ *
+ * The neighbors of a root are indexed, and the cliques among them are counted
+ * on a bit matrix of their adjacency, by intersecting the candidates of a
+ * level with the row of the chosen one, or on sorted index lists for roots
+ * with too many neighbors. Roots are taken one by one by the threads from the
+ * largest, which keeps the threads busy to the end.
+ * @tparam FRAG_T
+ */
+template <typename FRAG_T>
+class KClique : public grape::ParallelAppBase<FRAG_T, KCliqueContext<FRAG_T>>,
+                public grape::ParallelEngine,
+                public grape::Communicator {
+ public:
+  INSTALL_PARALLEL_WORKER(KClique<FRAG_T>, KCliqueContext<FRAG_T>, FRAG_T)
+  static constexpr grape::MessageStrategy message_strategy =
+      grape::MessageStrategy::kAlongEdgeToOuterVertex;
+  static constexpr grape::LoadStrategy load_strategy =
+      grape::LoadStrategy::kBothOutIn;
+  using vertex_t = typename fragment_t::vertex_t;
+  using vid_t = typename fragment_t::vid_t;
+
+  void PEval(const fragment_t& frag, context_t& ctx,
+             message_manager_t& messages) {
+    messages.InitChannels(thread_num());
+    ctx.workspaces.resize(thread_num());
+    peel(frag, ctx, messages);
+  }
+
+  void IncEval(const fragment_t& frag, context_t& ctx,
+               message_manager_t& messages) {
+    if (ctx.stage == 0) {
+      messages.ParallelProcess<fragment_t, int>(
+          thread_num(), frag,
+          [&ctx](int tid, vertex_t u, int msg) { ctx.rank[u] = msg; });
+      peel(frag, ctx, messages);
+    } else {
+      messages.ParallelProcess<fragment_t, std::vector<vid_t>>(
+          thread_num(), frag,
+          [&frag, &ctx](int tid, vertex_t u, const std::vector<vid_t>& msg) {
+            auto& nbr_vec = ctx.complete_neighbor[u];
+            for (auto gid : msg) {
+              vertex_t v;
+              if (frag.Gid2Vertex(gid, v)) {
+                nbr_vec.push_back(v);
+              }
+            }
+          });
+      count(frag, ctx);
+    }
+  }
+
+ private:
+  template <typename FUNC_T>
+  void forEachNeighbor(const fragment_t& frag, vertex_t v,
+                       const FUNC_T& func) const {
+    for (auto& e : frag.GetOutgoingAdjList(v)) {
+      func(e.get_neighbor());
+    }
+    if (frag.directed()) {
+      for (auto& e : frag.GetIncomingAdjList(v)) {
+        func(e.get_neighbor());
+      }
+    }
+  }
+
+  // Rank the unranked inner vertices of low degrees by the round, or orient
+  // the edges once all vertices are ranked.
+  void peel(const fragment_t& frag, context_t& ctx,
+            message_manager_t& messages) {
+    auto inner_vertices = frag.InnerVertices();
+    std::vector<size_t> degree_sums(thread_num(), 0);
+    std::vector<size_t> unranked_nums(thread_num(), 0);
+    ForEach(inner_vertices, [&frag, &ctx, &degree_sums, &unranked_nums, this](
+                                int tid, vertex_t v) {
+      if (ctx.rank[v] >= 0) {
+        return;
+      }
+      int degree = 0;
+      forEachNeighbor(frag, v, [&ctx, &degree, v](vertex_t u) {
+        if (u != v && ctx.rank[u] < 0) {
+          ++degree;
+        }
+      });
+      ctx.degrees[v] = degree;
+      degree_sums[tid] += degree;
+      unranked_nums[tid] += 1;
+    });
+
+    size_t degree_sum = 0, unranked_num = 0;
+    for (int tid = 0; tid < thread_num(); ++tid) {
+      degree_sum += degree_sums[tid];
+      unranked_num += unranked_nums[tid];
+    }
+    size_t total_degree_sum = 0, total_unranked_num = 0;
+    Sum(degree_sum, total_degree_sum);
+    Sum(unranked_num, total_unranked_num);
+    if (total_unranked_num == 0) {
+      orient(frag, ctx, messages);
+      return;
+    }
+
+    double threshold = (1 + context_t::kEpsilon) * total_degree_sum /
+                       total_unranked_num;
+    int round = ctx.round++;
+    ForEach(inner_vertices, [&frag, &ctx, &messages, threshold, round](
+                                int tid, vertex_t v) {
+      if (ctx.rank[v] < 0 && ctx.degrees[v] <= threshold) {
+        ctx.rank[v] = round;
+        messages.SendMsgThroughEdges<fragment_t, int>(frag, v, round, tid);
+      }
+    });
+    messages.ForceContinue();
+  }
+
+  static bool isBefore(const context_t& ctx, vertex_t v, vid_t v_gid,
+                       vertex_t u, vid_t u_gid) {
+    return ctx.rank[v] < ctx.rank[u] ||
+           (ctx.rank[v] == ctx.rank[u] && v_gid < u_gid);
+  }
+
+  // Keep the neighbors after each inner vertex, and send them to the
+  // fragments of its mirrors.
+  void orient(const fragment_t& frag, context_t& ctx,
+              message_manager_t& messages) {
+    LOG(INFO) << "Ordered the vertices in " << ctx.round << " rounds";
+    ctx.stage = 1;
+    ForEach(frag.InnerVertices(),
+            [&frag, &ctx, &messages, this](int tid, vertex_t v) {
+              auto& nbr_vec = ctx.complete_neighbor[v];
+              vid_t v_gid = frag.GetInnerVertexGid(v);
+              forEachNeighbor(frag, v, [&frag, &ctx, &nbr_vec, v,
+                                        v_gid](vertex_t u) {
+                if (u != v && isBefore(ctx, v, v_gid, u, frag.Vertex2Gid(u))) {
+                  nbr_vec.push_back(u);
+                }
+              });
+              std::sort(nbr_vec.begin(), nbr_vec.end(),
+                        [](vertex_t lhs, vertex_t rhs) {
+                          return lhs.GetValue() < rhs.GetValue();
+                        });
+              nbr_vec.erase(std::unique(nbr_vec.begin(), nbr_vec.end()),
+                            nbr_vec.end());
+              std::vector<vid_t> msg_vec;
+              msg_vec.reserve(nbr_vec.size());
+              for (auto u : nbr_vec) {
+                msg_vec.push_back(frag.Vertex2Gid(u));
+              }
+              messages.SendMsgThroughEdges<fragment_t, std::vector<vid_t>>(
+                  frag, v, msg_vec, tid);
+            });
+    messages.ForceContinue();
+  }
+
+  void count(const fragment_t& frag, context_t& ctx) {
+    ctx.adjacency.Build(frag, *this, ctx.complete_neighbor);
+
+    std::vector<vertex_t> roots;
+    roots.reserve(frag.GetInnerVerticesNum());
+    for (auto v : frag.InnerVertices()) {
+      roots.push_back(v);
+    }
+    std::sort(roots.begin(), roots.end(), [&ctx](vertex_t lhs, vertex_t rhs) {
+      return ctx.adjacency.Neighbors(lhs).second >
+             ctx.adjacency.Neighbors(rhs).second;
+    });
+    for (auto& workspace : ctx.workspaces) {
+      workspace.count = 0;
+    }
+    ForEach(
+        roots.begin(), roots.end(),
+        [&ctx, this](int tid, vertex_t v) {
+          countRoot(ctx, v, ctx.workspaces[tid]);
+        },
+        1);
+
+    int64_t local_count = 0;
+    for (auto& workspace : ctx.workspaces) {
+      local_count += workspace.count;
+    }
+    Sum(local_count, ctx.total_count);
+    LOG(INFO) << "Number of " << ctx.k << "-cliques: " << ctx.total_count;
+    if (frag.fid() == 0) {
+      std::vector<size_t> shape{1};
+      ctx.set_shape(shape);
+      ctx.assign(ctx.total_count);
+    }
+  }
+
+  // Count the cliques whose first vertex is v.
+  void countRoot(const context_t& ctx, vertex_t v,
+                 KCliqueWorkspace& ws) const {
+    int k = ctx.k;
+    if (k <= 1) {
+      ws.count += k == 1;
+      return;
+    }
+    auto nbrs = ctx.adjacency.Neighbors(v);
+    const vid_t* a = nbrs.first;
+    size_t d = nbrs.second;
+    if (d + 1 < static_cast<size_t>(k)) {
+      return;
+    }
+    if (k == 2) {
+      ws.count += d;
+      return;
+    }
+
+    ws.offsets.assign(1, 0);
+    ws.targets.clear();
+    for (size_t i = 0; i < d; ++i) {
+      auto u_nbrs = ctx.adjacency.Neighbors(vertex_t(a[i]));
+      oriented_adjacency_impl::intersect(
+          a, d, u_nbrs.first, u_nbrs.second,
+          [&ws](size_t x, size_t) { ws.targets.push_back(x); });
+      ws.offsets.push_back(ws.targets.size());
+    }
+
+    if (d <= context_t::kDenseDegree) {
+      size_t words = (d + 63) / 64;
+      ws.rows.assign(d * words, 0);
+      for (size_t i = 0; i < d; ++i) {
+        uint64_t* row = ws.rows.data() + i * words;
+        for (size_t p = ws.offsets[i]; p < ws.offsets[i + 1]; ++p) {
+          row[ws.targets[p] / 64] |= 1ULL << (ws.targets[p] % 64);
+        }
+      }
+      ws.candidates.assign(k * words, 0);
+      for (size_t i = 0; i < d; ++i) {
+        ws.candidates[i / 64] |= 1ULL << (i % 64);
+      }
+      ws.count += countDense(ws, words, ws.candidates.data(), k - 1);
+    } else {
+      ws.lists.resize(k);
+      ws.lists[0].resize(d);
+      for (size_t i = 0; i < d; ++i) {
+        ws.lists[0][i] = i;
+      }
+      ws.count += countSparse(ws, 0, k - 1);
+    }
+  }
+
+  // The number of level-cliques among the candidates, as bits.
+  static uint64_t countDense(KCliqueWorkspace& ws, size_t words,
+                             uint64_t* cand, int level) {
+    uint64_t total = 0;
+    if (level == 1) {
+      for (size_t x = 0; x < words; ++x) {
+        total += __builtin_popcountll(cand[x]);
+      }
+      return total;
+    }
+    uint64_t* next = cand + words;
+    for (size_t w = 0; w < words; ++w) {
+      for (uint64_t bits = cand[w]; bits != 0; bits &= bits - 1) {
+        size_t i = w * 64 + __builtin_ctzll(bits);
+        const uint64_t* row = ws.rows.data() + i * words;
+        if (level == 2) {
+          for (size_t x = 0; x < words; ++x) {
+            total += __builtin_popcountll(cand[x] & row[x]);
+          }
+          continue;
+        }
+        size_t next_num = 0;
+        for (size_t x = 0; x < words; ++x) {
+          next[x] = cand[x] & row[x];
+          next_num += __builtin_popcountll(next[x]);
+        }
+        if (next_num + 1 >= static_cast<size_t>(level)) {
+          total += countDense(ws, words, next, level - 1);
+        }
+      }
+    }
+    return total;
+  }
+
+  // The number of level-cliques among the candidates, as the sorted indices
+  // of lists[depth].
+  static uint64_t countSparse(KCliqueWorkspace& ws, int depth, int level) {
+    auto& cand = ws.lists[depth];
+    if (level == 1) {
+      return cand.size();
+    }
+    uint64_t total = 0;
+    auto& next = ws.lists[depth + 1];
+    for (auto i : cand) {
+      next.clear();
+      oriented_adjacency_impl::intersect(
+          cand.data(), cand.size(), ws.targets.data() + ws.offsets[i],
+          ws.offsets[i + 1] - ws.offsets[i],
+          [&cand, &next](size_t x, size_t) { next.push_back(cand[x]); });
+      if (level == 2) {
+        total += next.size();
+      } else if (next.size() + 1 >= static_cast<size_t>(level)) {
+        total += countSparse(ws, depth + 1, level - 1);
+      }
+    }
+    return total;
+  }
+};
+
+}  // namespace gs
+
+#endif  // ANALYTICAL_ENGINE_APPS_CLUSTERING_KCLIQUE_H_
@@ -0,0 +1,111 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANALYTICAL_ENGINE_APPS_CLUSTERING_KCLIQUE_CONTEXT_H_
+#define ANALYTICAL_ENGINE_APPS_CLUSTERING_KCLIQUE_CONTEXT_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "grape/grape.h"
+
+#include "apps/clustering/oriented_adjacency.h"
+
+#include "core/context/tensor_context.h"
+
+namespace gs {
+
+/**
+ * @brief The buffers of a thread to count the cliques of a root, reused
+ * across roots.
+ */
+struct KCliqueWorkspace {
+  // the oriented adjacency among the neighbors of the root, by their indices
+  std::vector<size_t> offsets;
+  std::vector<uint32_t> targets;
+  // the adjacency as a bit matrix, and the candidates of each level
+  std::vector<uint64_t> rows;
+  std::vector<uint64_t> candidates;
+  // the candidates of each level as index lists, when too many for bits
+  std::vector<std::vector<uint32_t>> lists;
+  uint64_t count = 0;
+};
+
+/**
+ * @brief Context for k-clique counting.
+ *
+ * @tparam FRAG_T
+ */
+template <typename FRAG_T>
+class KCliqueContext : public TensorContext<FRAG_T, int64_t> {
+ public:
+  using oid_t = typename FRAG_T::oid_t;
+  using vid_t = typename FRAG_T::vid_t;
+  using vertex_t = typename FRAG_T::vertex_t;
+
+  // the slack of the peeling threshold over the average remaining degree
+  static constexpr double kEpsilon = 0.5;
+  // roots with more neighbors recurse on index lists instead of bitsets
+  static constexpr size_t kDenseDegree = 4096;
+
+  explicit KCliqueContext(const FRAG_T& fragment)
+      : TensorContext<FRAG_T, int64_t>(fragment) {}
+
+  void Init(grape::ParallelMessageManager& messages, int k) {
+    auto& frag = this->fragment();
+    auto vertices = frag.Vertices();
+
+    this->k = k;
+    stage = 0;
+    round = 0;
+    total_count = 0;
+    rank.Init(vertices, -1);
+    degrees.Init(frag.InnerVertices(), 0);
+    complete_neighbor.Init(vertices);
+  }
+
+  void Output(std::ostream& os) override {
+    auto& frag = this->fragment();
+
+    if (frag.fid() == 0) {
+      os << total_count << std::endl;
+    }
+  }
+
+  int k;
+  int stage;
+  // the peeling round, which ranks the vertices removed in it
+  int round;
+  int64_t total_count;
+
+  // the round a vertex is peeled in, -1 until then; edges are oriented from
+  // the smaller (rank, gid) to the larger one
+  typename FRAG_T::template vertex_array_t<int> rank;
+  // degrees of the unranked inner vertices among unranked vertices
+  typename FRAG_T::template inner_vertex_array_t<int> degrees;
+  typename FRAG_T::template vertex_array_t<std::vector<vertex_t>>
+      complete_neighbor;
+  OrientedAdjacency<FRAG_T> adjacency;
+  std::vector<KCliqueWorkspace> workspaces;
+};
+
+template <typename FRAG_T>
+constexpr double KCliqueContext<FRAG_T>::kEpsilon;
+template <typename FRAG_T>
+constexpr size_t KCliqueContext<FRAG_T>::kDenseDegree;
+
+}  // namespace gs
+
+#endif  // ANALYTICAL_ENGINE_APPS_CLUSTERING_KCLIQUE_CONTEXT_H_
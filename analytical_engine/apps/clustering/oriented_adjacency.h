@@ -0,0 +1,255 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANALYTICAL_ENGINE_APPS_CLUSTERING_ORIENTED_ADJACENCY_H_
+#define ANALYTICAL_ENGINE_APPS_CLUSTERING_ORIENTED_ADJACENCY_H_
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+#include <algorithm>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "grape/grape.h"
+
+namespace gs {
+
+namespace oriented_adjacency_impl {
+
+// Arrays shorter than this fraction of the other one are searched in it.
+static constexpr size_t kGallopRatio = 32;
+
+template <typename T, typename FUNC_T>
+inline void gallop(const T* a, size_t na, const T* b, size_t nb,
+                   const FUNC_T& func) {
+  size_t lo = 0;
+  for (size_t i = 0; i < na && lo < nb; ++i) {
+    T x = a[i];
+    size_t hi = lo, step = 1;
+    while (hi < nb && b[hi] < x) {
+      lo = hi + 1;
+      hi += step;
+      step <<= 1;
+    }
+    lo = std::lower_bound(b + lo, b + std::min(hi, nb), x) - b;
+    if (lo < nb && b[lo] == x) {
+      func(i, lo);
+      ++lo;
+    }
+  }
+}
+
+template <typename T, typename FUNC_T>
+inline void merge_tail(const T* a, size_t na, const T* b, size_t nb, size_t i,
+                       size_t j, const FUNC_T& func) {
+  while (i < na && j < nb) {
+    T x = a[i], y = b[j];
+    if (x == y) {
+      func(i, j);
+    }
+    i += x <= y;
+    j += y <= x;
+  }
+}
+
+template <typename T, typename FUNC_T>
+inline void merge(const T* a, size_t na, const T* b, size_t nb,
+                  const FUNC_T& func, std::false_type) {
+  merge_tail(a, na, b, nb, 0, 0, func);
+}
+
+// Compares blocks of 4 against all rotations of each other, and advances the
+// block with the smaller last element.
+template <typename T, typename FUNC_T>
+inline void merge(const T* a, size_t na, const T* b, size_t nb,
+                  const FUNC_T& func, std::true_type) {
+  size_t i = 0, j = 0;
+#ifdef __AVX2__
+  while (i + 4 <= na && j + 4 <= nb) {
+    __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+    __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + j));
+    __m256i eq = _mm256_cmpeq_epi64(va, vb);
+    eq = _mm256_or_si256(
+        eq, _mm256_cmpeq_epi64(
+                va, _mm256_permute4x64_epi64(vb, _MM_SHUFFLE(0, 3, 2, 1))));
+    eq = _mm256_or_si256(
+        eq, _mm256_cmpeq_epi64(
+                va, _mm256_permute4x64_epi64(vb, _MM_SHUFFLE(1, 0, 3, 2))));
+    eq = _mm256_or_si256(
+        eq, _mm256_cmpeq_epi64(
+                va, _mm256_permute4x64_epi64(vb, _MM_SHUFFLE(2, 1, 0, 3))));
+    int mask = _mm256_movemask_pd(_mm256_castsi256_pd(eq));
+    for (; mask != 0; mask &= mask - 1) {
+      size_t k = i + __builtin_ctz(mask);
+      size_t l = j;
+      while (b[l] != a[k]) {
+        ++l;
+      }
+      func(k, l);
+    }
+    T a_last = a[i + 3], b_last = b[j + 3];
+    i += a_last <= b_last ? 4 : 0;
+    j += b_last <= a_last ? 4 : 0;
+  }
+#endif
+  merge_tail(a, na, b, nb, i, j, func);
+}
+
+/**
+ * @brief Call func(i, j) for each a[i] == b[j] of the sorted arrays a and b of
+ * distinct values.
+ */
+template <typename T, typename FUNC_T>
+inline void intersect(const T* a, size_t na, const T* b, size_t nb,
+                      const FUNC_T& func) {
+  if (na * kGallopRatio < nb) {
+    gallop(a, na, b, nb, func);
+  } else if (nb * kGallopRatio < na) {
+    gallop(b, nb, a, na, [&func](size_t j, size_t i) { func(i, j); });
+  } else {
+    merge(a, na, b, nb, func,
+          std::integral_constant<bool, std::is_integral<T>::value &&
+                                           sizeof(T) == 8>{});
+  }
+}
+
+}  // namespace oriented_adjacency_impl
+
+/**
+ * @brief The degree-oriented adjacency shared by triangle counting and the
+ * clustering apps.
+ *
+ * Each edge is kept by the end of the larger (degree, gid) only, and the
+ * neighbors of a vertex are sorted by local id in a CSR built once per
+ * fragment. A triangle is then found by a single end, by intersecting the
+ * neighbors of that end with the neighbors of one of its neighbors, with a
+ * galloping search for the neighbors of hubs.
+ *
+ * The neighbors of a vertex may carry a weight, i.e., the number of directed
+ * edges an undirected one stands for. The adjacency also serves as a sorted
+ * neighbor set when built from plain, unoriented neighbors.
+ */
+template <typename FRAG_T>
+class OrientedAdjacency {
+ public:
+  using vertex_t = typename FRAG_T::vertex_t;
+  using vid_t = typename FRAG_T::vid_t;
+
+  /**
+   * @brief Build from the oriented neighbors of vertices, in vectors of
+   * vertex_t or of pairs of vertex_t and the weight, which are released.
+   */
+  template <typename ENGINE_T, typename LISTS_T>
+  void Build(const FRAG_T& frag, ENGINE_T& engine, LISTS_T& lists) {
+    auto inner_vertices = frag.InnerVertices();
+    auto outer_vertices = frag.OuterVertices();
+    ranges_.Init(frag.Vertices());
+    size_t size = 0;
+    for (auto v : inner_vertices) {
+      ranges_[v] = std::make_pair(size, size + lists[v].size());
+      size += lists[v].size();
+    }
+    for (auto v : outer_vertices) {
+      ranges_[v] = std::make_pair(size, size + lists[v].size());
+      size += lists[v].size();
+    }
+    using entry_t = typename std::decay<decltype(lists[vertex_t()])>::type::
+        value_type;
+    weighted_ = !std::is_same<entry_t, vertex_t>::value;
+    neighbors_.resize(size);
+    weights_.resize(weighted_ ? size : 0);
+
+    auto func = [this, &lists](int tid, vertex_t v) {
+      auto& list = lists[v];
+      std::sort(list.begin(), list.end(),
+                [](const entry_t& lhs, const entry_t& rhs) {
+                  return vertexOf(lhs).GetValue() < vertexOf(rhs).GetValue();
+                });
+      size_t pos = ranges_[v].first;
+      for (auto& entry : list) {
+        neighbors_[pos] = vertexOf(entry).GetValue();
+        if (weighted_) {
+          weights_[pos] = weightOf(entry);
+        }
+        ++pos;
+      }
+      std::vector<entry_t>().swap(list);
+    };
+    engine.ForEach(inner_vertices, func);
+    engine.ForEach(outer_vertices, func);
+  }
+
+  /**
+   * @brief Call func(u, w, vu, vw, uw) for each triangle (v, u, w) found by v,
+   * where u and w are neighbors of v, w is a neighbor of u, and the rest are
+   * the weights of the edges.
+   */
+  template <typename FUNC_T>
+  void ForEachTriangle(vertex_t v, const FUNC_T& func) const {
+    auto range = ranges_[v];
+    const vid_t* a = neighbors_.data() + range.first;
+    size_t na = range.second - range.first;
+    for (size_t k = 0; k < na; ++k) {
+      vertex_t u(a[k]);
+      auto u_range = ranges_[u];
+      uint32_t vu = weight(range.first + k);
+      oriented_adjacency_impl::intersect(
+          a, na, neighbors_.data() + u_range.first,
+          u_range.second - u_range.first, [&](size_t i, size_t j) {
+            func(u, vertex_t(a[i]), vu, weight(range.first + i),
+                 weight(u_range.first + j));
+          });
+    }
+  }
+
+  // The local ids of the neighbors of v, in ascending order.
+  std::pair<const vid_t*, size_t> Neighbors(vertex_t v) const {
+    auto range = ranges_[v];
+    return std::make_pair(neighbors_.data() + range.first,
+                          range.second - range.first);
+  }
+
+  // Whether u is a neighbor of v.
+  bool Contains(vertex_t v, vertex_t u) const {
+    auto range = ranges_[v];
+    return std::binary_search(neighbors_.data() + range.first,
+                              neighbors_.data() + range.second, u.GetValue());
+  }
+
+ private:
+  static vertex_t vertexOf(const vertex_t& entry) { return entry; }
+  static vertex_t vertexOf(const std::pair<vertex_t, uint32_t>& entry) {
+    return entry.first;
+  }
+  static uint32_t weightOf(const vertex_t& entry) { return 1; }
+  static uint32_t weightOf(const std::pair<vertex_t, uint32_t>& entry) {
+    return entry.second;
+  }
+
+  uint32_t weight(size_t pos) const { return weighted_ ? weights_[pos] : 1; }
+
+  typename FRAG_T::template vertex_array_t<std::pair<size_t, size_t>> ranges_;
+  std::vector<vid_t> neighbors_;
+  std::vector<uint32_t> weights_;
+  bool weighted_ = false;
+};
+
+}  // namespace gs
+
+#endif  // ANALYTICAL_ENGINE_APPS_CLUSTERING_ORIENTED_ADJACENCY_H_
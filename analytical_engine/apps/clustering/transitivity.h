@@ -61,7 +61,6 @@ class Transitivity
   void IncEval(const fragment_t& frag, context_t& ctx,
                message_manager_t& messages) {
     using vid_t = typename context_t::vid_t;
-    auto vertices = frag.Vertices();
     auto inner_vertices = frag.InnerVertices();
     auto outer_vertices = frag.OuterVertices();
     if (ctx.stage == 0) {
@@ -202,66 +201,25 @@ class Transitivity
             }
           });
 
-      typename FRAG_T::template vertex_array_t<uint32_t> v0_nbr_set(vertices,
-                                                                    0);
-      for (auto v : inner_vertices) {
-        auto& v0_nbr_vec = ctx.complete_neighbor[v];
-        for (auto u : v0_nbr_vec) {
-          v0_nbr_set[u.first] = u.second;
-        }
-        for (auto u : v0_nbr_vec) {
-          auto& v1_nbr_vec = ctx.complete_neighbor[u.first];
-          for (auto w : v1_nbr_vec) {
-            if (v0_nbr_set[w.first] != 0) {
-              int flag = 0;
-              for (size_t i = 0; i < ctx.complete_outer_neighbor[v].size();
-                   i++) {
-                if (ctx.complete_outer_neighbor[v][i] == u.first ||
-                    ctx.complete_outer_neighbor[v][i] == w.first) {
-                  flag++;
-                }
-                if (flag == 2) {
-                  break;
-                }
-              }
-              if (flag == 2) {
-                ctx.tricnt[v] += w.second;
-              }
-              flag = 0;
-              for (size_t i = 0;
-                   i < ctx.complete_outer_neighbor[u.first].size(); i++) {
-                if (ctx.complete_outer_neighbor[u.first][i] == v ||
-                    ctx.complete_outer_neighbor[u.first][i] == w.first) {
-                  flag++;
-                }
-                if (flag == 2) {
-                  break;
-                }
-              }
-              if (flag == 2) {
-                ctx.tricnt[u.first] += v0_nbr_set[w.first];
-              }
-              flag = 0;
-              for (size_t i = 0;
-                   i < ctx.complete_outer_neighbor[w.first].size(); i++) {
-                if (ctx.complete_outer_neighbor[w.first][i] == v ||
-                    ctx.complete_outer_neighbor[w.first][i] == u.first) {
-                  flag++;
-                }
-                if (flag == 2) {
-                  break;
-                }
-              }
-              if (flag == 2) {
-                ctx.tricnt[w.first] += v0_nbr_set[u.first];
-              }
-            }
+      ctx.adjacency.Build(frag, *this, ctx.complete_neighbor);
+      ctx.out_adjacency.Build(frag, *this, ctx.complete_outer_neighbor);
+      ForEach(inner_vertices, [&ctx](int tid, vertex_t v) {
+        auto& out = ctx.out_adjacency;
+        ctx.adjacency.ForEachTriangle(v, [&ctx, &out, v](
+                                             vertex_t u, vertex_t w,
+                                             uint32_t vu, uint32_t vw,
+                                             uint32_t uw) {
+          if (out.Contains(v, u) && out.Contains(v, w)) {
+            grape::atomic_add(ctx.tricnt[v], static_cast<int>(uw));
           }
-        }
-        for (auto u : v0_nbr_vec) {
-          v0_nbr_set[u.first] = 0;
-        }
-      }
+          if (out.Contains(u, v) && out.Contains(u, w)) {
+            grape::atomic_add(ctx.tricnt[u], static_cast<int>(vw));
+          }
+          if (out.Contains(w, v) && out.Contains(w, u)) {
+            grape::atomic_add(ctx.tricnt[w], static_cast<int>(vu));
+          }
+        });
+      });
 
       ForEach(outer_vertices, [&messages, &frag, &ctx](int tid, vertex_t v) {
         if (ctx.tricnt[v] != 0) {
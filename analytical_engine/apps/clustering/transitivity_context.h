@@ -23,6 +23,8 @@
 
 #include "grape/grape.h"
 
+#include "apps/clustering/oriented_adjacency.h"
+
 #include "core/context/tensor_context.h"
 
 namespace gs {
@@ -67,8 +69,10 @@ class TransitivityContext : public TensorContext<FRAG_T, double> {
   typename FRAG_T::template vertex_array_t<
       std::vector<std::pair<vertex_t, uint32_t>>>
       complete_neighbor;
+  OrientedAdjacency<FRAG_T> adjacency;
   typename FRAG_T::template vertex_array_t<std::vector<vertex_t>>
       complete_outer_neighbor;
+  OrientedAdjacency<FRAG_T> out_adjacency;
   typename FRAG_T::template vertex_array_t<int> tricnt;
   int total_triangles = 0;
   int total_trids = 0;
@@ -22,6 +22,8 @@
 
 #include "grape/grape.h"
 
+#include "apps/clustering/oriented_adjacency.h"
+
 namespace gs {
 /**
  * @brief Context for triangles.
@@ -60,6 +62,7 @@ class TrianglesContext : public grape::VertexDataContext<FRAG_T, int> {
   typename FRAG_T::template vertex_array_t<int> global_degree;
   typename FRAG_T::template vertex_array_t<std::vector<vertex_t>>
       complete_neighbor;
+  OrientedAdjacency<FRAG_T> adjacency;
   typename FRAG_T::template vertex_array_t<int>& tricnt;
 
   int stage = 0;
@@ -116,7 +116,7 @@ VSet vertexMapFunction(const fragment_t& graph, const std::shared_ptr<fw_t> fw,
               });
   VSet res;
   fw->Barrier();
-  fw->GetActiveVerticesAndSetStates(res.s);
+  fw->GetActiveVerticesAndSetStates(U.s, res.s);
   return res;
 }
 
@@ -134,7 +134,7 @@ VSet vertexMapSeqFunction(const fragment_t& graph,
   }
   VSet res;
   fw->Barrier();
-  fw->GetActiveVerticesAndSetStates(res.s);
+  fw->GetActiveVerticesAndSetStates(U.s, res.s);
   return res;
 }
 
@@ -355,13 +355,45 @@ inline VSet edgeMapSparseFunction(const fragment_t& graph,
   fw->ResetAggFunc();
 }
 
+/**
+ * @brief Whether an edge map along the edges of the graph runs dense (pull),
+ * following the rule of Ligra: the frontier and the edges to visit from it
+ * take more than 1/20 of the edges.
+ */
+template <typename fragment_t, typename fw_t, typename value_t>
+bool isDenseEdgeMapFunction(const fragment_t& graph,
+                            const std::shared_ptr<fw_t> fw, VSet& U, int h) {
+  using vid_t = typename fragment_t::vid_t;
+  if ((&U) == (&All))
+    return true;
+  int64_t local_work = U.size(), work = 0;
+  for (auto& vid : U.s) {
+    vid_t lid = fw->Key2Lid(vid);
+    if (h == EU || h == ED)
+      local_work += getOutDegree<fragment_t, vid_t>(graph, lid);
+    if (h == EU || h == ER)
+      local_work += getInDegree<fragment_t, vid_t>(graph, lid);
+  }
+  int64_t local_edge_num = graph.GetEdgeNum(), edge_num = 0;
+  fw->Sum(local_work, work);
+  fw->Sum(local_edge_num, edge_num);
+  return work > edge_num / 20;
+}
+
+// The edges given by a function cannot be counted ahead, decide by vertices.
+template <typename fragment_t, typename fw_t, typename value_t, class H>
+bool isDenseEdgeMapFunction(const fragment_t& graph,
+                            const std::shared_ptr<fw_t> fw, VSet& U, H& h) {
+  int len = VSize(U);
+  return len > THRESHOLD;
+}
+
 template <typename fragment_t, typename fw_t, typename value_t, class F,
           class M, class C, class H>
 inline VSet edgeMapFunction(const fragment_t& graph,
                             const std::shared_ptr<fw_t> fw, VSet& U, H h, F& f,
                             M& m, C& c) {
-  int len = VSize(U);
-  if (len > THRESHOLD)
+  if (isDenseEdgeMapFunction(graph, fw, U, h))
     return edgeMapDenseFunction(graph, fw, U, h, f, m, c);
   else
     return edgeMapSparseFunction(graph, fw, U, h, f, m, c);
@@ -372,8 +404,7 @@ template <typename fragment_t, typename fw_t, typename value_t, class F,
 inline VSet edgeMapFunction(const fragment_t& graph,
                             const std::shared_ptr<fw_t> fw, VSet& U, H h, F& f,
                             M& m, C& c, const R& r) {
-  int len = VSize(U);
-  if (len > THRESHOLD)
+  if (isDenseEdgeMapFunction(graph, fw, U, h))
     return edgeMapDenseFunction(graph, fw, U, h, f, m, c);
   else
     return edgeMapSparseFunction(graph, fw, U, h, f, m, c, r);
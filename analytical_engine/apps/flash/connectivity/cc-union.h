@@ -43,10 +43,11 @@ class CCUnionFlash : public FlashAppBase<FRAG_T, CC_TYPE> {
     LOG(INFO) << "Run CC-union with Flash, total vertices: " << n_vertex
               << std::endl;
 
-    union_find f(n_vertex), cc;
-    DefineMapV(local) { for_out(union_f(f, id, nb_id);); };
+    concurrent_union_find f(n_vertex);
+    union_find cc;
+    DefineMapV(local) { for_out(f.unite(id, nb_id);); };
 
-    VertexMapSeq(All, CTrueV, local, false);
+    VertexMap(All, CTrueV, local, false);
 
     Reduce(f, cc, for_i(union_f(cc, f[i], i)), true);
 
@@ -271,6 +271,52 @@ class union_find : public std::vector<int> {
   union_find() {}
 };
 
+/**
+ * @brief A union_find that threads may find and unite on concurrently
+ * without locks: a root is linked below the smaller root by a
+ * compare-and-swap, and paths are halved while being walked. It is still a
+ * union_find, to be reduced across workers or walked by get_f.
+ */
+class concurrent_union_find : public union_find {
+ public:
+  explicit concurrent_union_find(int n) : union_find(n) {}
+
+  concurrent_union_find() {}
+
+  int find(int v) {
+    int* f = data();
+    while (true) {
+      int p = __atomic_load_n(&f[v], __ATOMIC_RELAXED);
+      if (p == v) {
+        return v;
+      }
+      int gp = __atomic_load_n(&f[p], __ATOMIC_RELAXED);
+      if (gp != p) {
+        __sync_bool_compare_and_swap(&f[v], p, gp);
+      }
+      v = gp;
+    }
+  }
+
+  // Whether a and b were in different sets.
+  bool unite(int a, int b) {
+    int* f = data();
+    while (true) {
+      a = find(a);
+      b = find(b);
+      if (a == b) {
+        return false;
+      }
+      if (a < b) {
+        std::swap(a, b);
+      }
+      if (__sync_bool_compare_and_swap(&f[a], a, b)) {
+        return true;
+      }
+    }
+  }
+};
+
 int get_f(int* f, int v) {
   if (f[v] != v)
     f[v] = get_f(f, f[v]);
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef ANALYTICAL_ENGINE_APPS_FLASH_FLASH_WARE_H_
 #define ANALYTICAL_ENGINE_APPS_FLASH_FLASH_WARE_H_
 
+#include <limits>
 #include <memory>
 #include <utility>
 #include <vector>
@@ -68,6 +69,8 @@ class FlashWare : public grape::Communicator, public grape::ParallelEngine {
   void GetActiveVerticesAndSetStates(std::vector<vid_t>& result);
   void GetActiveVerticesAndSetStates(std::vector<vid_t>& result,
                                      FlashBitset& d);
+  void GetActiveVerticesAndSetStates(const std::vector<vid_t>& candidates,
+                                     std::vector<vid_t>& result);
   void SyncBitset(FlashBitset& tmp, FlashBitset& d);
   void SyncBitset(FlashBitset& b);
 
@@ -133,6 +136,7 @@ class FlashWare : public grape::Communicator, public grape::ParallelEngine {
   inline void processMirrorMessage(const vid_t& key, const value_t& value);
   inline void processAllMessages(const bool& is_master,
                                  const bool& is_parallel);
+  bool syncSparseBitset(FlashBitset& local, FlashBitset& res, bool in_place);
 
  public:
   vset_t all_;
@@ -284,21 +288,94 @@ void FlashWare<fragment_t, value_t>::GetActiveVerticesAndSetStates(
   GetActiveVerticesAndSetStates(result);
 }
 
+/**
+ * @brief Gets the active vertices among the candidates, when no other master
+ * can be active, e.g., after a VertexMap on them, which saves a pass over all
+ * masters.
+ */
+template <typename fragment_t, class value_t>
+void FlashWare<fragment_t, value_t>::GetActiveVerticesAndSetStates(
+    const std::vector<vid_t>& candidates, std::vector<vid_t>& result) {
+  result.clear();
+  for (auto& u : candidates) {
+    if (IsActive(u)) {
+      SetStates(u);
+      result.push_back(u);
+      ResetActive(u);
+    }
+  }
+}
+
 template <typename fragment_t, class value_t>
 void FlashWare<fragment_t, value_t>::SyncBitset(FlashBitset& tmp,
                                                 FlashBitset& res) {
   if (res.get_size() != tmp.get_size())
     res.init(tmp.get_size());
+  if (syncSparseBitset(tmp, res, false))
+    return;
   MPI_Allreduce(tmp.get_data(), res.get_data(), res.get_size_in_words(),
                 MPI_UINT64_T, MPI_BOR, comm_spec_.comm());
 }
 
 template <typename fragment_t, class value_t>
 void FlashWare<fragment_t, value_t>::SyncBitset(FlashBitset& b) {
+  if (syncSparseBitset(b, b, true))
+    return;
   MPI_Allreduce(MPI_IN_PLACE, b.get_data(), b.get_size_in_words(), MPI_UINT64_T,
                 MPI_BOR, comm_spec_.comm());
 }
 
+/**
+ * @brief Gathers the nonzero words of the bitsets as (index, word) pairs
+ * when there are few of them, e.g., in the late rounds of a traversal, rather
+ * than reducing the bitsets of all vertices. Returns false if the bitsets are
+ * too dense, which is decided by all workers together.
+ */
+template <typename fragment_t, class value_t>
+bool FlashWare<fragment_t, value_t>::syncSparseBitset(FlashBitset& local,
+                                                      FlashBitset& res,
+                                                      bool in_place) {
+  // the pairs of all workers take at most 1/kSparseSyncRatio of a bitset
+  const size_t kSparseSyncRatio = 8;
+  size_t words = local.get_size_in_words();
+  const uint64_t* data = local.get_data();
+  std::vector<uint64_t> pairs;
+  for (size_t i = 0; i < words; ++i) {
+    if (data[i] != 0) {
+      pairs.push_back(i);
+      pairs.push_back(data[i]);
+    }
+  }
+  uint64_t local_num = pairs.size(), total_num = 0;
+  MPI_Allreduce(&local_num, &total_num, 1, MPI_UINT64_T, MPI_SUM,
+                comm_spec_.comm());
+  if (total_num * kSparseSyncRatio > words ||
+      total_num > static_cast<uint64_t>(std::numeric_limits<int>::max())) {
+    return false;
+  }
+
+  int worker_num = comm_spec_.worker_num();
+  int count = static_cast<int>(local_num);
+  std::vector<int> counts(worker_num), displs(worker_num, 0);
+  MPI_Allgather(&count, 1, MPI_INT, counts.data(), 1, MPI_INT,
+                comm_spec_.comm());
+  for (int i = 1; i < worker_num; ++i) {
+    displs[i] = displs[i - 1] + counts[i - 1];
+  }
+  std::vector<uint64_t> all_pairs(total_num);
+  MPI_Allgatherv(pairs.data(), count, MPI_UINT64_T, all_pairs.data(),
+                 counts.data(), displs.data(), MPI_UINT64_T,
+                 comm_spec_.comm());
+
+  if (!in_place)
+    res.clear();
+  uint64_t* res_data = res.get_data();
+  for (size_t i = 0; i < all_pairs.size(); i += 2) {
+    res_data[all_pairs[i]] |= all_pairs[i + 1];
+  }
+  return true;
+}
+
 template <typename fragment_t, class value_t>
 inline value_t* FlashWare<fragment_t, value_t>::Get(const vid_t& key) {
   return &states_[key];
@@ -24,6 +24,7 @@ limitations under the License.
 #include "apps/flash/flash_app_base.h"
 #include "apps/flash/flash_context.h"
 #include "apps/flash/flash_worker.h"
+#include "apps/flash/remaining_set.h"
 #include "apps/flash/value_type.h"
 
 namespace gs {
@@ -49,13 +50,18 @@ class MinCoverGreedyFlash : public FlashAppBase<FRAG_T, MIN_COVER_TYPE> {
       v.d = Deg(id);
       v.tmp = 0;
     };
-    vset_t A = VertexMap(All, CTrueV, init);
+    VertexMap(All, CTrueV, init);
+
+    RemainingSet<fragment_t, value_t> A;
+    A.Init(fw);
 
     for (int i = 0, len = VSize(A); len > 0; ++i, len = VSize(A)) {
       LOG(INFO) << "Round " << i << ": size=" << len << std::endl;
 
+      // ties of degrees are broken by a random order rather than the ids
       DefineFV(filter1) {
-        for_nb(if (!nb.c && (nb.d > v.d || (nb.d == v.d && nb_id > id))) {
+        for_nb(if (!nb.c && nb_id != id &&
+                   (nb.d > v.d || (nb.d == v.d && vertexBefore(nb_id, id)))) {
           return false;
         });
         return true;
@@ -77,12 +83,12 @@ class MinCoverGreedyFlash : public FlashAppBase<FRAG_T, MIN_COVER_TYPE> {
       VertexMap(B, CTrueV, local2);
 
       DefineFV(filter2) { return !v.c && v.d > 0; };
-      A = VertexMap(A, filter2);
+      A.Keep(fw, filter2);
     }
 
     DefineFV(filter) { return v.c; };
-    A = VertexMap(All, filter);
-    n_mc = VSize(A);
+    vset_t C = VertexMap(All, filter);
+    n_mc = VSize(C);
     LOG(INFO) << "size of vertex-cover = " << n_mc << std::endl;
   }
 };
@@ -24,6 +24,7 @@ limitations under the License.
 #include "apps/flash/flash_app_base.h"
 #include "apps/flash/flash_context.h"
 #include "apps/flash/flash_worker.h"
+#include "apps/flash/remaining_set.h"
 #include "apps/flash/value_type.h"
 
 namespace gs {
@@ -53,11 +54,16 @@ class MinDominatingSetFlash
       v.b = false;
       v.max_id = id;
     };
-    vset_t A = VertexMap(All, CTrueV, init);
+    VertexMap(All, CTrueV, init);
 
+    RemainingSet<fragment_t, value_t> A;
+    A.Init(fw);
+
+    // ties of counts are broken by a random order rather than the ids
     DefineMapV(local) {
       for_nb(if (!nb.d && (nb.max_cnt > v.max_cnt ||
-                           (nb.max_cnt == v.max_cnt && nb.max_id > v.max_id))) {
+                           (nb.max_cnt == v.max_cnt &&
+                            vertexBefore<vid_t>(nb.max_id, v.max_id)))) {
         v.max_cnt = nb.max_cnt;
         v.max_id = nb.max_id;
       })
@@ -87,12 +93,13 @@ class MinDominatingSetFlash
         v.max_cnt = 0;
         for_nb(if (!nb.d) { ++v.max_cnt; });
       };
-      A = VertexMap(A, filter2, local2);
+      A.Keep(fw, filter2);
+      VertexMap(A, CTrueV, local2);
     }
 
     DefineFV(filter) { return v.b; };
-    A = VertexMap(All, filter);
-    n_mc = VSize(A);
+    vset_t C = VertexMap(All, filter);
+    n_mc = VSize(C);
     LOG(INFO) << "size of min dominating set = " << n_mc << std::endl;
   }
 };
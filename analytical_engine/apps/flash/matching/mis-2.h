@@ -24,6 +24,7 @@ limitations under the License.
 #include "apps/flash/flash_app_base.h"
 #include "apps/flash/flash_context.h"
 #include "apps/flash/flash_worker.h"
+#include "apps/flash/remaining_set.h"
 #include "apps/flash/value_type.h"
 
 namespace gs {
@@ -44,39 +45,43 @@ class MIS2Flash : public FlashAppBase<FRAG_T, MIS_2_TYPE> {
     LOG(INFO) << "Run MIS with Flash, total vertices: " << n_vertex
               << std::endl;
 
-    DefineMapV(init) { v.d = false; };
-
-    vset_t A = VertexMap(All, CTrueV, init);
-
-    DefineMapV(local) { v.b = true; };
-
-    DefineFE(check) { return !s.d && sid > did; };
-    DefineMapE(update) { d.b = false; };
-    DefineFV(filter) { return v.b; };
-
-    DefineMapE(update2){};
-    DefineFV(cond) { return !v.d; };
-    DefineMapE(reduce) { d.d = true; };
-
-    DefineFV(filter2) { return !v.b; };
-
-    for (int i = 0, len = VSize(A); len > 0; ++i) {
-      A = VertexMap(A, CTrueV, local);
-      EdgeMapDense(All, EjoinV(EU, A), check, update, filter);
-
-      vset_t B = VertexMap(A, filter);
-      vset_t C = EdgeMapSparse(B, EU, CTrueE, update2, cond, reduce);
-      A = A.Minus(C);
-      A = VertexMap(A, filter2);
+    DefineMapV(init) {
+      v.d = false;
+      v.b = false;
+    };
+    VertexMap(All, CTrueV, init);
+
+    RemainingSet<fragment_t, value_t> A;
+    A.Init(fw);
+
+    // the greedy MIS in a random order: a vertex is selected once it goes
+    // before its remaining neighbors
+    DefineFV(filter) {
+      for_nb(if (A.IsIn(nb_id) && nb_id != id && vertexBefore(nb_id, id)) {
+        return false;
+      });
+      return true;
+    };
+
+    n_mis = 0;
+    for (int i = 0, len = VSize(A); len > 0; ++i, len = VSize(A)) {
+      vset_t B = A.Filter(fw, filter);
+      ToDense(B);
+
+      DefineFV(filter2) {
+        if (B.IsIn(id))
+          return false;
+        for_nb(if (B.IsIn(nb_id)) { return false; });
+        return true;
+      };
+      A.Keep(fw, filter2);
 
       int num = VSize(B);
-      len = VSize(A);
+      n_mis += num;
       LOG(INFO) << "Round " << i << ": size=" << len << ", selected=" << num
                 << std::endl;
     }
 
-    A = VertexMap(All, filter);
-    n_mis = VSize(A);
     LOG(INFO) << "size of max independent set = " << n_mis << std::endl;
   }
 };
@@ -24,6 +24,7 @@ limitations under the License.
 #include "apps/flash/flash_app_base.h"
 #include "apps/flash/flash_context.h"
 #include "apps/flash/flash_worker.h"
+#include "apps/flash/remaining_set.h"
 #include "apps/flash/value_type.h"
 
 namespace gs {
@@ -46,39 +47,43 @@ class MISFlash : public FlashAppBase<FRAG_T, MIS_TYPE> {
 
     DefineMapV(init) {
       v.d = false;
-      v.r = Deg(id) * n_vertex + id;
+      v.b = false;
+      v.r = Deg(id);
+    };
+    VertexMap(All, CTrueV, init);
+
+    RemainingSet<fragment_t, value_t> A;
+    A.Init(fw);
+
+    // a vertex is selected once it goes before its remaining neighbors, by
+    // the degree and then by a random order rather than the ids
+    DefineFV(filter) {
+      for_nb(if (A.IsIn(nb_id) && nb_id != id &&
+                 (nb.r < v.r || (nb.r == v.r && vertexBefore(nb_id, id)))) {
+        return false;
+      });
+      return true;
     };
-    vset_t A = VertexMap(All, CTrueV, init);
-
-    DefineMapV(local) { v.b = true; };
-
-    DefineFE(check) { return !s.d && s.r < d.r; };
-    DefineMapE(update) { d.b = false; };
-    DefineFV(filter) { return v.b; };
-
-    DefineMapE(update2){};
-    DefineFV(cond) { return !v.d; };
-    DefineMapE(reduce) { d.d = true; };
-
-    DefineFV(filter2) { return !v.b; };
 
-    for (int i = 0, len = VSize(A); len > 0; ++i) {
-      A = VertexMap(A, CTrueV, local);
-      EdgeMapDense(All, EjoinV(EU, A), check, update, filter);
+    n_mis = 0;
+    for (int i = 0, len = VSize(A); len > 0; ++i, len = VSize(A)) {
+      vset_t B = A.Filter(fw, filter);
+      ToDense(B);
 
-      vset_t B = VertexMap(A, filter);
-      vset_t C = EdgeMapSparse(B, EU, CTrueE, update2, cond, reduce);
-      A = A.Minus(C);
-      A = VertexMap(A, filter2);
+      DefineFV(filter2) {
+        if (B.IsIn(id))
+          return false;
+        for_nb(if (B.IsIn(nb_id)) { return false; });
+        return true;
+      };
+      A.Keep(fw, filter2);
 
       int num = VSize(B);
-      len = VSize(A);
+      n_mis += num;
       LOG(INFO) << "Round " << i << ": size=" << len << ", selected=" << num
                 << std::endl;
     }
 
-    A = VertexMap(All, filter);
-    n_mis = VSize(A);
     LOG(INFO) << "size of max independent set = " << n_mis << std::endl;
   }
 };
@@ -25,6 +25,7 @@ limitations under the License.
 #include "apps/flash/flash_app_base.h"
 #include "apps/flash/flash_context.h"
 #include "apps/flash/flash_worker.h"
+#include "apps/flash/remaining_set.h"
 #include "apps/flash/value_type.h"
 
 namespace gs {
@@ -52,7 +53,13 @@ class MMOptFlash : public FlashAppBase<FRAG_T, MM_TYPE> {
     vset_t A = VertexMap(All, CTrueV, init);
 
     DefineFE(check1) { return s.s == -1; };
-    DefineMapE(update1) { d.p = std::max(d.p, static_cast<int>(sid)); };
+    // points to the first edge in a random order rather than to the largest
+    // id, which may take a round per vertex along a path of increasing ids
+    DefineMapE(update1) {
+      if (d.p == -1 || edgeBefore<vid_t>(sid, did, d.p, did)) {
+        d.p = static_cast<int>(sid);
+      }
+    };
     DefineFV(cond) { return v.s == -1; };
 
     DefineOutEdges(edges) { VjoinP(p); };
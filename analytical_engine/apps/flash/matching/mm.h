@@ -25,6 +25,7 @@ limitations under the License.
 #include "apps/flash/flash_app_base.h"
 #include "apps/flash/flash_context.h"
 #include "apps/flash/flash_worker.h"
+#include "apps/flash/remaining_set.h"
 #include "apps/flash/value_type.h"
 
 namespace gs {
@@ -49,29 +50,37 @@ class MMFlash : public FlashAppBase<FRAG_T, MM_TYPE> {
       v.s = -1;
       v.p = -1;
     };
+    VertexMap(All, CTrueV, init);
 
-    vset_t A = VertexMap(All, CTrueV, init);
+    RemainingSet<fragment_t, value_t> A;
+    A.Init(fw);
 
-    DefineMapV(local) { v.p = -1; };
-
-    DefineFV(cond) { return v.s == -1; };
-    DefineMapE(update1) { d.p = std::max(d.p, static_cast<int>(sid)); };
-
-    DefineFE(check2) { return s.p == did && d.p == sid; };
-    DefineMapE(update2) { d.s = sid; };
+    // each remaining vertex points to its first remaining edge in a random
+    // order of the edges, and the edges pointed to by both ends are matched
+    DefineMapV(local) {
+      v.p = -1;
+      for_nb(if (A.IsIn(nb_id) && nb_id != id &&
+                 (v.p == -1 || edgeBefore<vid_t>(id, nb_id, id, v.p))) {
+        v.p = static_cast<int>(nb_id);
+      });
+    };
+    DefineFV(matched) {
+      return v.p != -1 && GetV(v.p)->p == static_cast<int>(id);
+    };
+    DefineFV(filter) {
+      return v.p != -1 && GetV(v.p)->p != static_cast<int>(id);
+    };
 
+    n_match = 0;
     for (int i = 0, len = VSize(A); len > 0; ++i, len = VSize(A)) {
       LOG(INFO) << "Round " << i << ": size=" << len << std::endl;
 
-      A = EdgeMapDense(A, EjoinV(EU, A), CTrueE, update1, cond);
-      EdgeMapDense(A, EjoinV(EU, A), check2, update2, cond);
-
-      A = VertexMap(A, cond, local);
+      VertexMap(A, CTrueV, local);
+      vset_t B = A.Filter(fw, matched);
+      n_match += VSize(B) / 2;
+      A.Keep(fw, filter);
     }
 
-    DefineFV(filter) { return v.s >= 0; };
-    A = VertexMap(All, filter);
-    n_match = VSize(A) / 2;
     LOG(INFO) << "number of matching pairs = " << n_match << std::endl;
   }
 };
@@ -0,0 +1,223 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef ANALYTICAL_ENGINE_APPS_FLASH_MEASUREMENT_MSF_BORUVKA_H_
+#define ANALYTICAL_ENGINE_APPS_FLASH_MEASUREMENT_MSF_BORUVKA_H_
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "grape/grape.h"
+
+#include "apps/flash/api.h"
+#include "apps/flash/flash_app_base.h"
+#include "apps/flash/flash_context.h"
+#include "apps/flash/flash_worker.h"
+#include "apps/flash/value_type.h"
+
+namespace gs {
+
+/**
+ * @brief MSF by a parallel filter-Kruskal over the local edges of each
+ * worker, whose forests are merged by the Kruskal reduction of MSFFlash.
+ *
+ * Edges are split at a weight sampled from them; the forest of the light
+ * ones is built first, and the heavy ones within a tree of it are filtered
+ * out before building on the rest. Small sets of edges are built on by
+ * Boruvka rounds: each component picks its lightest edge by an atomic min,
+ * the picked edges are united in a concurrent_union_find, as in
+ * CCUnionFlash, and the edges within a component are dropped. Ties of
+ * weights are broken by the position of the edge, so that the picked edges
+ * never close a cycle.
+ */
+template <typename FRAG_T>
+class MSFBoruvkaFlash : public FlashAppBase<FRAG_T, EMPTY_TYPE> {
+ public:
+  INSTALL_FLASH_WORKER(MSFBoruvkaFlash<FRAG_T>, EMPTY_TYPE, FRAG_T)
+  using context_t = FlashGlobalDataContext<FRAG_T, EMPTY_TYPE, double>;
+  using E = std::pair<edata_t, std::pair<vid_t, vid_t>>;
+
+  // edge sets no larger than this are built on by Boruvka rounds
+  static constexpr size_t kBaseSize = 1 << 16;
+  static constexpr size_t kSampleSize = 1024;
+
+  bool sync_all_ = false;
+  double wt = 0;
+
+  double GlobalRes() { return wt; }
+
+  void Run(const fragment_t& graph, const std::shared_ptr<fw_t> fw) {
+    int n_vertex = graph.GetTotalVerticesNum();
+    LOG(INFO) << "Run MSF-Boruvka with Flash, total vertices: " << n_vertex
+              << std::endl;
+
+    std::vector<E> edges, mst0, mst;
+    TraverseLocal(for_out(edges.push_back(
+        std::make_pair(weight, std::make_pair(id, nb_id)));););
+
+    concurrent_union_find f(n_vertex);
+    std::vector<size_t> live(edges.size());
+    for (size_t i = 0; i < live.size(); ++i) {
+      live[i] = i;
+    }
+    best_.assign(n_vertex, -1);
+    keep_.assign(edges.size(), 0);
+    roots_.assign(fw->thread_num(), std::vector<int>());
+    forests_.assign(fw->thread_num(), std::vector<E>());
+    filterKruskal(fw, edges, f, live);
+    for (auto& forest : forests_) {
+      mst0.insert(mst0.end(), forest.begin(), forest.end());
+    }
+    // padded with self-loops of vertex 0, which kruskal skips
+    mst0.resize(n_vertex - 1);
+
+    Reduce(mst0, mst, std::vector<E> edges; edges.assign(mst0, mst0 + len);
+           edges.insert(edges.end(), mst, mst + len);
+           kruskal<E>(edges, mst, len + 1));
+
+    for (auto& e : mst)
+      wt += e.first;
+    LOG(INFO) << "mst weight " << wt << std::endl;
+  }
+
+ private:
+  static bool lighter(const std::vector<E>& edges, int64_t a, int64_t b) {
+    return edges[a].first < edges[b].first ||
+           (!(edges[b].first < edges[a].first) && a < b);
+  }
+
+  // Drop the edges within a component.
+  void filter(const std::shared_ptr<fw_t> fw, const std::vector<E>& edges,
+              concurrent_union_find& f, std::vector<size_t>& live) {
+    auto& keep = keep_;
+    fw->ForEach(live.begin(), live.end(),
+                [&edges, &f, &keep](int tid, size_t e) {
+                  keep[e] = f.find(edges[e].second.first) !=
+                            f.find(edges[e].second.second);
+                });
+    size_t len = 0;
+    for (auto e : live) {
+      if (keep[e]) {
+        live[len++] = e;
+      }
+    }
+    live.resize(len);
+  }
+
+  void filterKruskal(const std::shared_ptr<fw_t> fw,
+                     const std::vector<E>& edges, concurrent_union_find& f,
+                     std::vector<size_t>& live) {
+    if (live.size() <= kBaseSize) {
+      boruvka(fw, edges, f, live);
+      return;
+    }
+    std::vector<edata_t> sample;
+    size_t stride = live.size() / kSampleSize;
+    for (size_t i = 0; i < live.size(); i += stride) {
+      sample.push_back(edges[live[i]].first);
+    }
+    std::nth_element(sample.begin(), sample.begin() + sample.size() / 2,
+                     sample.end());
+    edata_t pivot = sample[sample.size() / 2];
+
+    std::vector<size_t> light, heavy;
+    for (auto e : live) {
+      if (pivot < edges[e].first) {
+        heavy.push_back(e);
+      } else {
+        light.push_back(e);
+      }
+    }
+    std::vector<size_t>().swap(live);
+    if (heavy.empty()) {
+      // most of the weights are equal, no split would shrink the set
+      boruvka(fw, edges, f, light);
+      return;
+    }
+    filterKruskal(fw, edges, f, light);
+    filter(fw, edges, f, heavy);
+    filterKruskal(fw, edges, f, heavy);
+  }
+
+  void boruvka(const std::shared_ptr<fw_t> fw, const std::vector<E>& edges,
+               concurrent_union_find& f, std::vector<size_t>& live) {
+    auto& best = best_;
+    auto& roots = roots_;
+    auto& forests = forests_;
+    filter(fw, edges, f, live);
+    while (!live.empty()) {
+      fw->ForEach(live.begin(), live.end(),
+                  [&edges, &f, &best, &roots](int tid, size_t e) {
+                    for (auto v : {edges[e].second.first,
+                                   edges[e].second.second}) {
+                      int r = f.find(v);
+                      if (propose(edges, best, r, e)) {
+                        roots[tid].push_back(r);
+                      }
+                    }
+                  });
+      std::vector<int> picked;
+      for (auto& list : roots) {
+        picked.insert(picked.end(), list.begin(), list.end());
+        list.clear();
+      }
+      fw->ForEach(picked.begin(), picked.end(),
+                  [&edges, &f, &best, &forests](int tid, int r) {
+                    auto& edge = edges[best[r]];
+                    if (f.unite(edge.second.first, edge.second.second)) {
+                      forests[tid].push_back(edge);
+                    }
+                  });
+      for (auto r : picked) {
+        best[r] = -1;
+      }
+      filter(fw, edges, f, live);
+    }
+  }
+
+  // Keep e in best[r] if lighter than the edge there, returns whether r had
+  // none.
+  static bool propose(const std::vector<E>& edges, std::vector<int64_t>& best,
+                      int r, int64_t e) {
+    int64_t cur = __atomic_load_n(&best[r], __ATOMIC_RELAXED);
+    while (cur < 0 || lighter(edges, e, cur)) {
+      if (__atomic_compare_exchange_n(&best[r], &cur, e, false,
+                                      __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+        return cur < 0;
+      }
+    }
+    return false;
+  }
+
+  // the lightest edge picked by each root in a Boruvka round, or -1
+  std::vector<int64_t> best_;
+  // whether an edge joins two components, by position
+  std::vector<char> keep_;
+  // the roots with a picked edge, by thread
+  std::vector<std::vector<int>> roots_;
+  // the edges of the local forest, by thread
+  std::vector<std::vector<E>> forests_;
+};
+
+template <typename FRAG_T>
+constexpr size_t MSFBoruvkaFlash<FRAG_T>::kBaseSize;
+template <typename FRAG_T>
+constexpr size_t MSFBoruvkaFlash<FRAG_T>::kSampleSize;
+
+}  // namespace gs
+
+#endif  // ANALYTICAL_ENGINE_APPS_FLASH_MEASUREMENT_MSF_BORUVKA_H_
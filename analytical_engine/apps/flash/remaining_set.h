@@ -0,0 +1,186 @@
+/** Copyright 2022 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef ANALYTICAL_ENGINE_APPS_FLASH_REMAINING_SET_H_
+#define ANALYTICAL_ENGINE_APPS_FLASH_REMAINING_SET_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "flash/flash_bitset.h"
+#include "flash/vertex_subset.h"
+
+namespace gs {
+
+/**
+ * @brief A random but fixed priority of a vertex, by the finalizer of
+ * splitmix64, to order the vertices in a parallel greedy algorithm. Unlike
+ * the ids, which may be ordered along a path, random priorities let the
+ * greedy algorithm finish in O(log n) rounds w.h.p.
+ */
+inline uint64_t randomPriority(uint64_t key) {
+  uint64_t z = key + 0x9e3779b97f4a7c15ULL;
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+/**
+ * @brief Whether vertex a goes before b in a random order of the vertices.
+ */
+template <typename VID_T>
+inline bool vertexBefore(VID_T a, VID_T b) {
+  uint64_t x = randomPriority(a), y = randomPriority(b);
+  return x < y || (x == y && a < b);
+}
+
+/**
+ * @brief Whether the edge (a, b) goes before (c, d) in a random order of the
+ * undirected edges, which both ends of an edge agree on.
+ */
+template <typename VID_T>
+inline bool edgeBefore(VID_T a, VID_T b, VID_T c, VID_T d) {
+  if (b < a)
+    std::swap(a, b);
+  if (d < c)
+    std::swap(c, d);
+  uint64_t x = randomPriority(randomPriority(a) ^ b);
+  uint64_t y = randomPriority(randomPriority(c) ^ d);
+  return std::tie(x, a, b) < std::tie(y, c, d);
+}
+
+/**
+ * @brief The vertices remaining in a parallel greedy algorithm, e.g., those
+ * neither selected nor removed by the selected ones, which only shrinks
+ * round by round.
+ *
+ * It is a dense VertexSubset: s has the remaining master vertices of this
+ * worker in order, and d has the remaining vertices of all workers, so that
+ * whether a neighbor remains is a bit test. Keep() compacts s in parallel
+ * and removes the dropped vertices from d by a sync of only their bits, so a
+ * round takes work on the remaining vertices rather than on all of them.
+ *
+ * It is passed to VertexMap and EdgeMap as a VertexSubset, but must not be
+ * assigned one, which drops the bitset of all workers.
+ */
+template <typename FRAG_T, class VALUE_T>
+class RemainingSet : public VertexSubset<FRAG_T, VALUE_T> {
+ public:
+  using vid_t = typename FRAG_T::vid_t;
+  using value_t = VALUE_T;
+  using vset_t = VertexSubset<FRAG_T, VALUE_T>;
+
+  RemainingSet() = default;
+  RemainingSet(const RemainingSet&) = delete;
+  RemainingSet& operator=(const RemainingSet&) = delete;
+
+  /**
+   * @brief All vertices remain.
+   */
+  template <typename FW_T>
+  void Init(const std::shared_ptr<FW_T> fw) {
+    size_t size = fw->GetSize();
+    this->s = fw->all_.s;
+    this->d.init(size);
+    uint64_t* data = this->d.get_data();
+    for (size_t i = 0; i < this->d.get_size_in_words(); ++i) {
+      data[i] = ~0ul;
+    }
+    if (BIT_OFFSET(size) != 0) {
+      data[WORD_INDEX(size)] = (1ul << BIT_OFFSET(size)) - 1;
+    }
+    this->is_dense = true;
+    removed_.init(size);
+  }
+
+  /**
+   * @brief The remaining vertices of this worker on which f holds, in order,
+   * evaluated in parallel.
+   */
+  template <typename FW_T, class F>
+  vset_t Filter(const std::shared_ptr<FW_T> fw, const F& f) {
+    vset_t res;
+    filter(fw, f, res.s, false);
+    return res;
+  }
+
+  /**
+   * @brief Keeps the vertices on which f holds, and drops the others on all
+   * workers. It is a collective call, f is evaluated on the values before
+   * any vertex is dropped.
+   */
+  template <typename FW_T, class F>
+  void Keep(const std::shared_ptr<FW_T> fw, const F& f) {
+    std::vector<vid_t> kept;
+    filter(fw, f, kept, true);
+    this->s.swap(kept);
+
+    fw->SyncBitset(removed_);
+    uint64_t* data = this->d.get_data();
+    uint64_t* removed = removed_.get_data();
+    for (size_t i = 0; i < removed_.get_size_in_words(); ++i) {
+      data[i] &= ~removed[i];
+      removed[i] = 0;
+    }
+  }
+
+ private:
+  // Splits s into chunks filtered by the threads, whose results are
+  // concatenated in order.
+  template <typename FW_T, class F>
+  void filter(const std::shared_ptr<FW_T> fw, const F& f,
+              std::vector<vid_t>& res, bool remove) {
+    auto& s = this->s;
+    auto& thread_pool = fw->GetThreadPool();
+    uint32_t thread_num = thread_pool.GetThreadNum();
+    size_t chunk_size =
+        std::max(1024ul, (s.size() + thread_num - 1) / thread_num);
+    size_t chunk_num = (s.size() + chunk_size - 1) / chunk_size;
+    std::vector<std::vector<vid_t>> chunks(chunk_num);
+    std::vector<std::future<void>> results(chunk_num);
+    for (size_t i = 0; i < chunk_num; ++i) {
+      results[i] = thread_pool.enqueue([this, &fw, &f, &s, &chunks, i,
+                                        chunk_size, remove]() {
+        size_t end = std::min(s.size(), (i + 1) * chunk_size);
+        for (size_t j = i * chunk_size; j < end; ++j) {
+          vid_t key = s[j];
+          if (f(key, *(fw->Get(key)))) {
+            chunks[i].push_back(key);
+          } else if (remove) {
+            removed_.set_bit(key);
+          }
+        }
+      });
+    }
+    thread_pool.WaitEnd(results);
+
+    res.clear();
+    for (auto& chunk : chunks) {
+      res.insert(res.end(), chunk.begin(), chunk.end());
+    }
+  }
+
+  // the vertices dropped by the last Keep(), of this worker and then of all
+  FlashBitset removed_;
+};
+
+}  // namespace gs
+
+#endif  // ANALYTICAL_ENGINE_APPS_FLASH_REMAINING_SET_H_
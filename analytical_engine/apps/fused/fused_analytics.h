@@ -0,0 +1,288 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef ANALYTICAL_ENGINE_APPS_FUSED_FUSED_ANALYTICS_H_
+#define ANALYTICAL_ENGINE_APPS_FUSED_FUSED_ANALYTICS_H_
+
+#include <algorithm>
+#include <vector>
+
+#include "grape/grape.h"
+
+#include "apps/fused/fused_analytics_context.h"
+#include "core/app/app_base.h"
+
+namespace gs {
+
+/**
+ * @brief Runs degree centrality, PageRank, WCC and k-core, or some of them,
+ * in the same supersteps over a single traversal of the fragment, instead
+ * of one app after another each walking all the edges.
+ *
+ * In a round, the edges of every inner vertex are read once, for all the
+ * apps still running, and the states of the vertex in all of them are sent
+ * to the fragments holding it as an outer vertex in a single message.
+ * Each app keeps its own state, and drops out of the rounds once it ends:
+ * PageRank after max_round rounds, WCC and k-core once no vertex changes.
+ *
+ * Degree centrality is normalized by the number of other vertices. WCC
+ * labels a component by the smallest gid in it. k-core is the coreness,
+ * computed as the fixed point of the h-index of the neighbors, which
+ * counts an edge per direction on directed graphs.
+ *
+ * @tparam FRAG_T
+ */
+template <typename FRAG_T>
+class FusedAnalytics
+    : public grape::ParallelAppBase<FRAG_T, FusedAnalyticsContext<FRAG_T>>,
+      public grape::ParallelEngine,
+      public grape::Communicator {
+ public:
+  INSTALL_PARALLEL_WORKER(FusedAnalytics<FRAG_T>, FusedAnalyticsContext<FRAG_T>,
+                          FRAG_T)
+  static constexpr grape::MessageStrategy message_strategy =
+      grape::MessageStrategy::kSyncOnOuterVertex;
+  static constexpr grape::LoadStrategy load_strategy =
+      grape::LoadStrategy::kBothOutIn;
+  using vertex_t = typename fragment_t::vertex_t;
+  using vid_t = typename fragment_t::vid_t;
+  using message_t = FusedAnalyticsMessage<vid_t>;
+
+  void PEval(const fragment_t& frag, context_t& ctx,
+             message_manager_t& messages) {
+    messages.InitChannels(thread_num());
+    ctx.reducer.Init(thread_num(), 3);
+    core_counts_.resize(thread_num());
+    auto inner_vertices = frag.InnerVertices();
+    double total_num = static_cast<double>(frag.GetTotalVerticesNum());
+
+    if (ctx.run_degree) {
+      auto idx = ctx.add_column("degree", ContextDataType::kDouble);
+      auto column = ctx.template get_typed_column<double>(idx);
+      double max_degree = std::max(total_num - 1, 1.0);
+      ForEach(inner_vertices,
+              [this, &frag, &column, max_degree](int tid, vertex_t v) {
+                column->at(v) = static_cast<double>(degree(frag, v)) /
+                                max_degree;
+              });
+    }
+
+    ctx.pagerank_active = ctx.run_pagerank && ctx.max_round > 0;
+    ctx.wcc_active = ctx.run_wcc;
+    ctx.kcore_active = ctx.run_kcore;
+    auto& reducer = ctx.reducer;
+    ForEach(inner_vertices, [&](int tid, vertex_t v) {
+      if (ctx.run_pagerank) {
+        ctx.rank[v] = 1.0 / total_num;
+        updateContribution(frag, ctx, tid, v);
+      }
+      if (ctx.run_wcc) {
+        ctx.component[v] = frag.Vertex2Gid(v);
+      }
+      if (ctx.run_kcore) {
+        ctx.core[v] = degree(frag, v);
+      }
+    });
+    reducer.Sum(*this);
+    ctx.dangling_sum = reducer[0];
+
+    if (!active(ctx)) {
+      finish(frag, ctx);
+      return;
+    }
+    sync(frag, ctx, messages);
+  }
+
+  void IncEval(const fragment_t& frag, context_t& ctx,
+               message_manager_t& messages) {
+    messages.ParallelProcess<fragment_t, message_t>(
+        thread_num(), frag, [&ctx](int tid, vertex_t v, const message_t& msg) {
+          if (ctx.run_pagerank) {
+            ctx.contribution[v] = msg.contribution;
+          }
+          if (ctx.run_wcc) {
+            ctx.component[v] = msg.component;
+          }
+          if (ctx.run_kcore) {
+            ctx.core[v] = msg.core;
+          }
+        });
+
+    auto inner_vertices = frag.InnerVertices();
+    double total_num = static_cast<double>(frag.GetTotalVerticesNum());
+    double base = (1.0 - ctx.delta + ctx.delta * ctx.dangling_sum) / total_num;
+    auto& reducer = ctx.reducer;
+    ForEach(inner_vertices, [&](int tid, vertex_t v) {
+      double sum = 0;
+      vid_t component = ctx.run_wcc ? ctx.component[v] : 0;
+      int64_t core = ctx.run_kcore ? ctx.core[v] : 0;
+      auto& counts = core_counts_[tid];
+      if (ctx.kcore_active) {
+        counts.assign(core + 1, 0);
+      }
+      // a single pass over the edges for all the apps
+      auto visit = [&](const vertex_t& u, bool incoming) {
+        if (ctx.pagerank_active && incoming) {
+          sum += ctx.contribution[u];
+        }
+        if (ctx.wcc_active) {
+          component = std::min(component, ctx.component[u]);
+        }
+        if (ctx.kcore_active) {
+          ++counts[std::min(ctx.core[u], core)];
+        }
+      };
+      if (frag.directed()) {
+        for (auto& e : frag.GetIncomingAdjList(v)) {
+          visit(e.get_neighbor(), true);
+        }
+        for (auto& e : frag.GetOutgoingAdjList(v)) {
+          visit(e.get_neighbor(), false);
+        }
+      } else {
+        for (auto& e : frag.GetOutgoingAdjList(v)) {
+          visit(e.get_neighbor(), true);
+        }
+      }
+
+      if (ctx.pagerank_active) {
+        ctx.rank[v] = base + ctx.delta * sum;
+      }
+      if (ctx.wcc_active) {
+        ctx.next_component[v] = component;
+        if (component != ctx.component[v]) {
+          reducer.Add(tid, 1, 1);
+        }
+      }
+      if (ctx.kcore_active) {
+        // the largest h with at least h neighbors of cores not below h
+        int64_t h = core, num = 0;
+        for (; h > 0; --h) {
+          num += counts[h];
+          if (num >= h) {
+            break;
+          }
+        }
+        ctx.next_core[v] = h;
+        if (h != core) {
+          reducer.Add(tid, 2, 1);
+        }
+      }
+    });
+
+    // the states of the round are visible to the next one only
+    ForEach(inner_vertices, [&](int tid, vertex_t v) {
+      if (ctx.pagerank_active) {
+        updateContribution(frag, ctx, tid, v);
+      }
+      if (ctx.wcc_active) {
+        ctx.component[v] = ctx.next_component[v];
+      }
+      if (ctx.kcore_active) {
+        ctx.core[v] = ctx.next_core[v];
+      }
+    });
+    reducer.Sum(*this);
+
+    ++ctx.round;
+    ctx.dangling_sum = reducer[0];
+    if (ctx.pagerank_active && ctx.round >= ctx.max_round) {
+      ctx.pagerank_active = false;
+    }
+    if (ctx.wcc_active && reducer[1] == 0) {
+      ctx.wcc_active = false;
+    }
+    if (ctx.kcore_active && reducer[2] == 0) {
+      ctx.kcore_active = false;
+    }
+    if (!active(ctx)) {
+      VLOG(1) << "Fused apps end after " << ctx.round << " rounds";
+      finish(frag, ctx);
+      return;
+    }
+    sync(frag, ctx, messages);
+  }
+
+ private:
+  int64_t degree(const fragment_t& frag, const vertex_t& v) const {
+    return frag.directed()
+               ? frag.GetLocalInDegree(v) + frag.GetLocalOutDegree(v)
+               : frag.GetLocalOutDegree(v);
+  }
+
+  // the share of its rank a vertex passes along each out edge, dangling
+  // vertices pass theirs to all vertices
+  void updateContribution(const fragment_t& frag, context_t& ctx, int tid,
+                          const vertex_t& v) {
+    int out_degree = frag.GetLocalOutDegree(v);
+    if (out_degree == 0) {
+      ctx.contribution[v] = 0;
+      ctx.reducer.Add(tid, 0, ctx.rank[v]);
+    } else {
+      ctx.contribution[v] = ctx.rank[v] / out_degree;
+    }
+  }
+
+  bool active(const context_t& ctx) const {
+    return ctx.pagerank_active || ctx.wcc_active || ctx.kcore_active;
+  }
+
+  // a message per inner vertex for all the apps
+  void sync(const fragment_t& frag, context_t& ctx,
+            message_manager_t& messages) {
+    auto& channels = messages.Channels();
+    ForEach(frag.InnerVertices(), [&](int tid, vertex_t v) {
+      message_t msg;
+      msg.contribution = ctx.run_pagerank ? ctx.contribution[v] : 0;
+      msg.component = ctx.run_wcc ? ctx.component[v] : 0;
+      msg.core = ctx.run_kcore ? ctx.core[v] : 0;
+      channels[tid].template SyncStateOnOuterVertex<fragment_t, message_t>(
+          frag, v, msg);
+    });
+    messages.ForceContinue();
+  }
+
+  void finish(const fragment_t& frag, context_t& ctx) {
+    auto inner_vertices = frag.InnerVertices();
+    if (ctx.run_pagerank) {
+      auto idx = ctx.add_column("pagerank", ContextDataType::kDouble);
+      auto column = ctx.template get_typed_column<double>(idx);
+      for (auto v : inner_vertices) {
+        column->at(v) = ctx.rank[v];
+      }
+    }
+    if (ctx.run_wcc) {
+      auto idx = ctx.add_column("wcc", ContextDataType::kInt64);
+      auto column = ctx.template get_typed_column<int64_t>(idx);
+      for (auto v : inner_vertices) {
+        column->at(v) = static_cast<int64_t>(ctx.component[v]);
+      }
+    }
+    if (ctx.run_kcore) {
+      auto idx = ctx.add_column("kcore", ContextDataType::kInt64);
+      auto column = ctx.template get_typed_column<int64_t>(idx);
+      for (auto v : inner_vertices) {
+        column->at(v) = ctx.core[v];
+      }
+    }
+  }
+
+  // counts of the cores of the neighbors, by thread
+  std::vector<std::vector<int64_t>> core_counts_;
+};
+
+}  // namespace gs
+
+#endif  // ANALYTICAL_ENGINE_APPS_FUSED_FUSED_ANALYTICS_H_
@@ -0,0 +1,126 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef ANALYTICAL_ENGINE_APPS_FUSED_FUSED_ANALYTICS_CONTEXT_H_
+#define ANALYTICAL_ENGINE_APPS_FUSED_FUSED_ANALYTICS_CONTEXT_H_
+
+#include <sstream>
+#include <string>
+
+#include "grape/grape.h"
+
+#include "core/context/vertex_property_context.h"
+#include "core/parallel/round_reducer.h"
+
+namespace gs {
+
+/**
+ * @brief The state of a vertex seen by the fragments holding it as an outer
+ * vertex, for all the fused apps at once.
+ */
+template <typename VID_T>
+struct FusedAnalyticsMessage {
+  // rank over out degree, for PageRank
+  double contribution;
+  // smallest gid of the component, for WCC
+  VID_T component;
+  // upper bound of the coreness, for k-core
+  int64_t core;
+};
+
+/**
+ * @brief Context of FusedAnalytics, with the state of each of the fused
+ * apps, of which those in apps are run.
+ *
+ * @tparam FRAG_T
+ */
+template <typename FRAG_T>
+class FusedAnalyticsContext : public VertexPropertyContext<FRAG_T> {
+  using vid_t = typename FRAG_T::vid_t;
+
+ public:
+  explicit FusedAnalyticsContext(const FRAG_T& fragment)
+      : VertexPropertyContext<FRAG_T>(fragment) {}
+
+  /**
+   * @param apps The apps to run, separated by commas, of degree, pagerank,
+   * wcc and kcore.
+   */
+  void Init(grape::ParallelMessageManager& messages, const std::string& apps,
+            double delta, int max_round) {
+    std::stringstream ss(apps);
+    std::string app;
+    while (std::getline(ss, app, ',')) {
+      if (app == "degree") {
+        run_degree = true;
+      } else if (app == "pagerank") {
+        run_pagerank = true;
+      } else if (app == "wcc") {
+        run_wcc = true;
+      } else if (app == "kcore") {
+        run_kcore = true;
+      } else if (!app.empty()) {
+        LOG(FATAL) << "Unknown app to fuse: " << app;
+      }
+    }
+    this->delta = delta;
+    this->max_round = max_round;
+
+    auto vertices = this->fragment().Vertices();
+    auto inner_vertices = this->fragment().InnerVertices();
+    if (run_pagerank) {
+      rank.Init(inner_vertices, 0);
+      contribution.Init(vertices, 0);
+    }
+    if (run_wcc) {
+      component.Init(vertices, 0);
+      next_component.Init(inner_vertices, 0);
+    }
+    if (run_kcore) {
+      core.Init(vertices, 0);
+      next_core.Init(inner_vertices, 0);
+    }
+  }
+
+  bool run_degree = false;
+  bool run_pagerank = false;
+  bool run_wcc = false;
+  bool run_kcore = false;
+  double delta = 0;
+  int max_round = 0;
+
+  int round = 0;
+  // apps not converged yet, degree needs no round
+  bool pagerank_active = false;
+  bool wcc_active = false;
+  bool kcore_active = false;
+
+  typename FRAG_T::template inner_vertex_array_t<double> rank;
+  typename FRAG_T::template vertex_array_t<double> contribution;
+  double dangling_sum = 0;
+
+  typename FRAG_T::template vertex_array_t<vid_t> component;
+  typename FRAG_T::template inner_vertex_array_t<vid_t> next_component;
+
+  typename FRAG_T::template vertex_array_t<int64_t> core;
+  typename FRAG_T::template inner_vertex_array_t<int64_t> next_core;
+
+  // the dangling sum of PageRank, and the vertices changed by WCC and k-core
+  RoundReducer reducer;
+};
+
+}  // namespace gs
+
+#endif  // ANALYTICAL_ENGINE_APPS_FUSED_FUSED_ANALYTICS_CONTEXT_H_
@@ -46,21 +46,13 @@ class HITS : public grape::ParallelAppBase<FRAG_T, HitsContext<FRAG_T>>,
   void PEval(const fragment_t& frag, context_t& ctx,
              message_manager_t& messages) {
     messages.InitChannels(thread_num());
-    auto& channel_0 = messages.Channels()[0];
-    auto inner_vertices = frag.InnerVertices();
-    auto& auth = ctx.auth;
+    ctx.reducer.Init(thread_num(), 2);
+    ctx.auth_spmv.Init(frag, SpMVDirection::kIncoming, false, thread_num());
+    ctx.hub_spmv.Init(frag, SpMVDirection::kOutgoing, false, thread_num());
     auto& hub_last = ctx.hub_last;
-    auto& hub = ctx.hub;
 
-    hub_last.Swap(hub);
-
-    for (auto u : inner_vertices) {
-      auth[u] = 0.0;
-      for (auto& nbr : frag.GetIncomingAdjList(u)) {
-        auth[u] += hub_last[nbr.get_neighbor()];
-      }
-      channel_0.SendMsgThroughEdges<fragment_t, double>(frag, u, auth[u]);
-    }
+    hub_last.Swap(ctx.hub);
+    pullAuth(frag, ctx, messages);
 
     if (frag.fnum() == 1) {
       messages.ForceContinue();
@@ -81,17 +73,7 @@ class HITS : public grape::ParallelAppBase<FRAG_T, HitsContext<FRAG_T>>,
 
     if (ctx.stage == AuthIteration) {
       hub_last.Swap(hub);
-
-      ForEach(
-          inner_vertices.begin(), inner_vertices.end(),
-          [&auth, &hub_last, &frag, &messages](int tid, vertex_t u) {
-            auth[u] = 0.0;
-            for (auto& nbr : frag.GetIncomingAdjList(u)) {
-              auth[u] += hub_last[nbr.get_neighbor()];
-            }
-            messages.Channels()[tid].SendMsgThroughEdges<fragment_t, double>(
-                frag, u, auth[u]);
-          });
+      pullAuth(frag, ctx, messages);
 
       ctx.stage = HubIteration;
       if (frag.fnum() == 1) {
@@ -103,14 +85,10 @@ class HITS : public grape::ParallelAppBase<FRAG_T, HitsContext<FRAG_T>>,
             auth[v] = auth_val;
           });
 
-      ForEach(
-          inner_vertices.begin(), inner_vertices.end(),
-          [&hub, &auth, &frag, &messages](int tid, vertex_t u) {
-            hub[u] = 0.0;
-            for (auto& nbr : frag.GetOutgoingAdjList(u)) {
-              hub[u] += auth[nbr.get_neighbor()];
-            }
-
+      ctx.hub_spmv.Multiply(
+          *this, auth,
+          [&hub, &frag, &messages](int tid, vertex_t u, double sum) {
+            hub[u] = sum;
             messages.Channels()[tid].SendMsgThroughEdges<fragment_t, double>(
                 frag, u, hub[u]);
           });
@@ -124,29 +102,25 @@ class HITS : public grape::ParallelAppBase<FRAG_T, HitsContext<FRAG_T>>,
           thrd_num, frag,
           [&hub](int tid, vertex_t v, double hub_val) { hub[v] = hub_val; });
 
-      double local_max_h = -std::numeric_limits<double>::max();
-      double local_max_a = -std::numeric_limits<double>::max();
-
-      for (auto& u : inner_vertices) {
-        local_max_h = std::max(local_max_h, hub[u]);
-        local_max_a = std::max(local_max_a, auth[u]);
-      }
+      // the maxima of hubs and authorities in a single all-reduce, both are
+      // sums of non-negative scores
+      auto& reducer = ctx.reducer;
+      ForEach(inner_vertices.begin(), inner_vertices.end(),
+              [&hub, &auth, &reducer](int tid, vertex_t u) {
+                reducer.Max(tid, 0, hub[u]);
+                reducer.Max(tid, 1, auth[u]);
+              });
+      reducer.Max(*this);
 
       {
-        double global_max = -std::numeric_limits<double>::max();
-        Max(local_max_h, global_max);
-
-        double s = 1.0 / global_max;
+        double s = 1.0 / reducer[0];
         for (auto& u : vertices) {
           hub[u] *= s;
         }
       }
 
       {
-        double global_max = -std::numeric_limits<double>::max();
-        Max(local_max_a, global_max);
-
-        double s = 1.0 / global_max;
+        double s = 1.0 / reducer[1];
         for (auto& u : vertices) {
           auth[u] *= s;
         }
@@ -199,6 +173,19 @@ class HITS : public grape::ParallelAppBase<FRAG_T, HitsContext<FRAG_T>>,
       messages.ForceContinue();
     }
   }
+
+ private:
+  void pullAuth(const fragment_t& frag, context_t& ctx,
+                message_manager_t& messages) {
+    auto& auth = ctx.auth;
+    ctx.auth_spmv.Multiply(
+        *this, ctx.hub_last,
+        [&auth, &frag, &messages](int tid, vertex_t u, double sum) {
+          auth[u] = sum;
+          messages.Channels()[tid].SendMsgThroughEdges<fragment_t, double>(
+              frag, u, auth[u]);
+        });
+  }
 };
 };  // namespace gs
 
@@ -22,6 +22,8 @@
 #include "grape/grape.h"
 
 #include "core/context/vertex_property_context.h"
+#include "core/parallel/round_reducer.h"
+#include "core/parallel/segmented_spmv.h"
 
 namespace gs {
 enum { AuthIteration = 0, HubIteration = 1, Normalize = 2 };
@@ -70,6 +72,10 @@ class HitsContext : public VertexPropertyContext<FRAG_T> {
   int step;
   double sum_a;
   double sum_h;
+  RoundReducer reducer;
+  // authorities are pulled along incoming edges, hubs along outgoing ones
+  SegmentedSpMV<FRAG_T> auth_spmv;
+  SegmentedSpMV<FRAG_T> hub_spmv;
 };
 }  // namespace gs
 
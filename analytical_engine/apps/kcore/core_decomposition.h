@@ -0,0 +1,261 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANALYTICAL_ENGINE_APPS_KCORE_CORE_DECOMPOSITION_H_
+#define ANALYTICAL_ENGINE_APPS_KCORE_CORE_DECOMPOSITION_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "grape/grape.h"
+
+#include "apps/kcore/core_decomposition_context.h"
+
+namespace gs {
+
+/**
+ * @brief Compute the coreness of every vertex by bucketed peeling.
+ *
+ * Unpeeled vertices are kept in buckets by their degrees among unpeeled
+ * vertices, and the buckets are peeled in order: a level k takes the vertices
+ * of degree k, and keeps peeling the neighbors whose degrees drop to k within
+ * the fragment, while the decrements of outer vertices are sent to their
+ * owners once per round. Only the vertices whose degrees changed are moved
+ * across buckets, and the next level is the smallest non-empty bucket among
+ * fragments, so that the number of rounds follows the number of distinct
+ * core values rather than the number of vertices removed one by one.
+ *
+ * Buckets are lazy: a vertex is pushed again when its degree drops, and stale
+ * entries are dropped once reached. Only a window of degrees has its own
+ * buckets, vertices beyond it are kept together and redistributed when the
+ * window moves, as in Julienne. The degree of a vertex in a directed graph is
+ * the sum of its in and out degrees.
+ * @tparam FRAG_T
+ */
+template <typename FRAG_T>
+class CoreDecomposition
+    : public grape::ParallelAppBase<FRAG_T, CoreDecompositionContext<FRAG_T>>,
+      public grape::ParallelEngine,
+      public grape::Communicator {
+ public:
+  INSTALL_PARALLEL_WORKER(CoreDecomposition<FRAG_T>,
+                          CoreDecompositionContext<FRAG_T>, FRAG_T)
+  static constexpr grape::MessageStrategy message_strategy =
+      grape::MessageStrategy::kSyncOnOuterVertex;
+  static constexpr grape::LoadStrategy load_strategy =
+      grape::LoadStrategy::kBothOutIn;
+  using vertex_t = typename fragment_t::vertex_t;
+  using bucket_list_t = std::vector<std::vector<vertex_t>>;
+
+  void PEval(const fragment_t& frag, context_t& ctx,
+             message_manager_t& messages) {
+    messages.InitChannels(thread_num());
+
+    ctx.buckets.assign(thread_num(), bucket_list_t(context_t::kBucketNum + 1));
+    ForEach(frag.InnerVertices(), [&frag, &ctx, this](int tid, vertex_t v) {
+      int degree = 0;
+      forEachNeighbor(frag, v, [&degree, v](vertex_t u) {
+        if (u != v) {
+          ++degree;
+        }
+      });
+      ctx.degrees[v] = degree;
+      ctx.buckets[tid][bucketOf(ctx, degree)].push_back(v);
+    });
+    messages.ForceContinue();
+  }
+
+  void IncEval(const fragment_t& frag, context_t& ctx,
+               message_manager_t& messages) {
+    messages.ParallelProcess<fragment_t, int>(
+        thread_num(), frag, [&ctx](int tid, vertex_t v, int msg) {
+          if (ctx.core[v] < 0) {
+            int degree = __sync_sub_and_fetch(&ctx.degrees[v], msg);
+            if (degree <= ctx.curr_k) {
+              ctx.frontier.Insert(v);
+            } else {
+              ctx.changed.Insert(v);
+            }
+          }
+        });
+
+    if (ctx.next_level) {
+      int64_t local_min = localMinDegree(ctx);
+      int64_t global_min = local_min;
+      Min(local_min, global_min);
+      if (global_min == std::numeric_limits<int64_t>::max()) {
+        LOG(INFO) << "Core decomposition finished after " << ctx.level_num
+                  << " levels, the degeneracy is " << ctx.curr_k;
+        return;
+      }
+      ctx.curr_k = static_cast<int>(global_min);
+      ctx.next_level = false;
+      ++ctx.level_num;
+      takeBucket(ctx);
+    }
+
+    // peel the vertices of the current level until none is left locally.
+    while (!ctx.frontier.Empty()) {
+      ForEach(ctx.frontier, [&frag, &ctx, this](int tid, vertex_t v) {
+        ctx.core[v] = ctx.curr_k;
+        forEachNeighbor(frag, v, [&frag, &ctx, v](vertex_t u) {
+          if (u == v) {
+            return;
+          }
+          if (!frag.IsInnerVertex(u)) {
+            __sync_fetch_and_add(&ctx.degrees[u], 1);
+            ctx.updated.Insert(u);
+          } else if (ctx.core[u] < 0 && !ctx.frontier.Exist(u)) {
+            int degree = __sync_sub_and_fetch(&ctx.degrees[u], 1);
+            if (degree == ctx.curr_k) {
+              ctx.next_frontier.Insert(u);
+            } else if (degree > ctx.curr_k) {
+              ctx.changed.Insert(u);
+            }
+          }
+        });
+      });
+      ctx.frontier.Clear();
+      ctx.frontier.Swap(ctx.next_frontier);
+    }
+
+    ForEach(ctx.changed, [&ctx](int tid, vertex_t v) {
+      if (ctx.core[v] < 0) {
+        ctx.buckets[tid][bucketOf(ctx, ctx.degrees[v])].push_back(v);
+      }
+    });
+    ctx.changed.Clear();
+
+    auto& channels = messages.Channels();
+    size_t updated_num = ctx.updated.Count();
+    ForEach(ctx.updated, frag.OuterVertices(),
+            [&channels, &frag, &ctx](int tid, vertex_t v) {
+              channels[tid].SyncStateOnOuterVertex<fragment_t, int>(
+                  frag, v, ctx.degrees[v]);
+              ctx.degrees[v] = 0;
+            });
+    ctx.updated.Clear();
+    size_t total_updated_num = 0;
+    Sum(updated_num, total_updated_num);
+    if (total_updated_num == 0) {
+      // no decrement is in flight, the level is done in all fragments.
+      ctx.next_level = true;
+    }
+    messages.ForceContinue();
+  }
+
+ private:
+  template <typename FUNC_T>
+  void forEachNeighbor(const fragment_t& frag, vertex_t v,
+                       const FUNC_T& func) const {
+    for (auto& e : frag.GetOutgoingAdjList(v)) {
+      func(e.get_neighbor());
+    }
+    if (frag.directed()) {
+      for (auto& e : frag.GetIncomingAdjList(v)) {
+        func(e.get_neighbor());
+      }
+    }
+  }
+
+  static int bucketOf(const context_t& ctx, int degree) {
+    return std::min(degree - ctx.window_begin, context_t::kBucketNum);
+  }
+
+  static bool isStale(const context_t& ctx, vertex_t v, int bucket) {
+    return ctx.core[v] >= 0 || bucketOf(ctx, ctx.degrees[v]) != bucket;
+  }
+
+  // The smallest degree of the unpeeled inner vertices, with stale entries of
+  // the buckets below it dropped.
+  int64_t localMinDegree(context_t& ctx) {
+    for (int i = std::max(ctx.curr_k - ctx.window_begin, 0);
+         i < context_t::kBucketNum; ++i) {
+      bool found = false;
+      for (auto& lists : ctx.buckets) {
+        auto& list = lists[i];
+        auto iter =
+            std::find_if(list.begin(), list.end(), [&ctx, i](vertex_t v) {
+              return !isStale(ctx, v, i);
+            });
+        list.erase(list.begin(), iter);
+        found = found || !list.empty();
+      }
+      if (found) {
+        return ctx.window_begin + i;
+      }
+    }
+
+    // the window is drained, keep the live vertices beyond it.
+    int64_t min_degree = std::numeric_limits<int64_t>::max();
+    ForEach(ctx.buckets.begin(), ctx.buckets.end(),
+            [&ctx](int tid, bucket_list_t& lists) {
+              auto& list = lists[context_t::kBucketNum];
+              list.erase(std::remove_if(list.begin(), list.end(),
+                                        [&ctx](vertex_t v) {
+                                          return isStale(
+                                              ctx, v, context_t::kBucketNum);
+                                        }),
+                         list.end());
+            },
+            1);
+    for (auto& lists : ctx.buckets) {
+      for (auto v : lists[context_t::kBucketNum]) {
+        min_degree = std::min(min_degree, int64_t(ctx.degrees[v]));
+      }
+    }
+    return min_degree;
+  }
+
+  // Move vertices to the frontier from the bucket of curr_k, after moving the
+  // window to it if beyond.
+  void takeBucket(context_t& ctx) {
+    if (ctx.curr_k >= ctx.window_begin + context_t::kBucketNum) {
+      ctx.window_begin = ctx.curr_k;
+      ForEach(ctx.buckets.begin(), ctx.buckets.end(),
+              [&ctx](int tid, bucket_list_t& lists) {
+                auto& overflow = lists[context_t::kBucketNum];
+                auto iter = std::partition(
+                    overflow.begin(), overflow.end(), [&ctx](vertex_t v) {
+                      return bucketOf(ctx, ctx.degrees[v]) ==
+                             context_t::kBucketNum;
+                    });
+                for (auto it = iter; it != overflow.end(); ++it) {
+                  lists[bucketOf(ctx, ctx.degrees[*it])].push_back(*it);
+                }
+                overflow.erase(iter, overflow.end());
+              },
+              1);
+    }
+
+    int bucket = ctx.curr_k - ctx.window_begin;
+    ForEach(ctx.buckets.begin(), ctx.buckets.end(),
+            [&ctx, bucket](int tid, bucket_list_t& lists) {
+              for (auto v : lists[bucket]) {
+                if (!isStale(ctx, v, bucket)) {
+                  ctx.frontier.Insert(v);
+                }
+              }
+              lists[bucket].clear();
+            },
+            1);
+  }
+};
+
+}  // namespace gs
+
+#endif  // ANALYTICAL_ENGINE_APPS_KCORE_CORE_DECOMPOSITION_H_
@@ -0,0 +1,96 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANALYTICAL_ENGINE_APPS_KCORE_CORE_DECOMPOSITION_CONTEXT_H_
+#define ANALYTICAL_ENGINE_APPS_KCORE_CORE_DECOMPOSITION_CONTEXT_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "grape/grape.h"
+
+namespace gs {
+
+template <typename FRAG_T>
+class CoreDecompositionContext : public grape::VertexDataContext<FRAG_T, int> {
+ public:
+  using oid_t = typename FRAG_T::oid_t;
+  using vid_t = typename FRAG_T::vid_t;
+  using vertex_t = typename FRAG_T::vertex_t;
+
+  // open buckets in the window, the last bucket holds vertices beyond it
+  static constexpr int kBucketNum = 128;
+
+  explicit CoreDecompositionContext(const FRAG_T& fragment)
+      : grape::VertexDataContext<FRAG_T, int>(fragment, true),
+        core(this->data()) {}
+
+  void Init(grape::ParallelMessageManager& messages) {
+    auto& frag = this->fragment();
+    auto inner_vertices = frag.InnerVertices();
+
+    curr_k = 0;
+    level_num = 0;
+    window_begin = 0;
+    next_level = true;
+    core.SetValue(-1);
+    degrees.Init(frag.Vertices(), 0);
+
+    frontier.Init(inner_vertices);
+    next_frontier.Init(inner_vertices);
+    changed.Init(inner_vertices);
+    updated.Init(frag.Vertices());
+  }
+
+  void Output(std::ostream& os) override {
+    auto& frag = this->fragment();
+    auto inner_vertices = frag.InnerVertices();
+
+    for (auto v : inner_vertices) {
+      os << frag.GetId(v) << "\t" << core[v] << std::endl;
+    }
+  }
+
+  int curr_k;
+  int level_num;
+  // the degree of the first open bucket
+  int window_begin;
+  // whether the current level is done, and the next one is to be chosen.
+  bool next_level;
+
+  // the coreness, -1 until the vertex is peeled
+  typename FRAG_T::template vertex_array_t<int>& core;
+  // degrees of the unpeeled inner vertices among unpeeled vertices, and the
+  // decrements not sent yet of outer vertices
+  typename FRAG_T::template vertex_array_t<int> degrees;
+  // buckets[tid][i] holds vertices of degree window_begin + i pushed by
+  // thread tid, some of which are stale since their degrees dropped later
+  std::vector<std::vector<std::vector<vertex_t>>> buckets;
+
+  // inner vertices to be peeled at curr_k
+  grape::DenseVertexSet<typename FRAG_T::inner_vertices_t> frontier;
+  grape::DenseVertexSet<typename FRAG_T::inner_vertices_t> next_frontier;
+  // inner vertices whose degrees dropped but still exceed curr_k
+  grape::DenseVertexSet<typename FRAG_T::inner_vertices_t> changed;
+  // outer vertices with decrements to send
+  grape::DenseVertexSet<typename FRAG_T::vertices_t> updated;
+};
+
+template <typename FRAG_T>
+constexpr int CoreDecompositionContext<FRAG_T>::kBucketNum;
+
+}  // namespace gs
+
+#endif  // ANALYTICAL_ENGINE_APPS_KCORE_CORE_DECOMPOSITION_CONTEXT_H_
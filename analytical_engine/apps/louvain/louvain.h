@@ -0,0 +1,544 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANALYTICAL_ENGINE_APPS_LOUVAIN_LOUVAIN_H_
+#define ANALYTICAL_ENGINE_APPS_LOUVAIN_LOUVAIN_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "grape/grape.h"
+
+#include "apps/louvain/louvain_context.h"
+#include "apps/louvain/louvain_level.h"
+
+#include "core/utils/trait_utils.h"
+
+namespace gs {
+
+/**
+ * @brief Multi-level Louvain on undirected graphs, in PIE rather than as a
+ * Pregel program.
+ *
+ * Each level is a graph held in CSR by the fragments, and is refined by
+ * sweeps of local moving. In a sweep, every fragment learns the total degree
+ * of the remote communities it references, and then all threads move the
+ * owned vertices with thread-local community tables. Only the new labels of
+ * moved vertices go to the fragments holding them as ghosts, and the changes
+ * of total degrees go to the owners of the communities. Moves alternate
+ * their directions between sweeps, so that neighbors do not swap their
+ * communities forever.
+ *
+ * Once the local moving of a level halts, every community is coarsened into
+ * a vertex of the next level on the fragment of its hub, with the edges
+ * between communities aggregated by the fragments before they are sent.
+ * Levels stop when one moves no vertex or does not improve the modularity.
+ *
+ * Compared to the Pregel louvain, a sweep takes three rounds whose messages
+ * are bounded by the boundary of fragments, and coarse levels shrink the
+ * graph rather than keep every vertex alive.
+ * @tparam FRAG_T
+ */
+template <typename FRAG_T>
+class Louvain : public grape::ParallelAppBase<FRAG_T, LouvainContext<FRAG_T>>,
+                public grape::ParallelEngine,
+                public grape::Communicator {
+ public:
+  INSTALL_PARALLEL_WORKER(Louvain<FRAG_T>, LouvainContext<FRAG_T>, FRAG_T)
+  static constexpr grape::MessageStrategy message_strategy =
+      grape::MessageStrategy::kSyncOnOuterVertex;
+  static constexpr grape::LoadStrategy load_strategy =
+      grape::LoadStrategy::kOnlyOut;
+  using vertex_t = typename fragment_t::vertex_t;
+  using vid_t = typename fragment_t::vid_t;
+  using edata_t = typename fragment_t::edata_t;
+  using message_t = LouvainMessage<vid_t>;
+  using kind_t = LouvainMessageKind;
+  using step_t = typename context_t::Step;
+
+  void PEval(const fragment_t& frag, context_t& ctx,
+             message_manager_t& messages) {
+    messages.InitChannels(thread_num());
+    parser_.Init(frag.fnum(), 1);
+    tables_.resize(thread_num());
+
+    buildFirstLevel(frag, ctx);
+    for (auto v : frag.InnerVertices()) {
+      ctx.membership[v] = frag.Vertex2Gid(v);
+    }
+    double local_weight = std::accumulate(ctx.graph.degrees.begin(),
+                                          ctx.graph.degrees.end(), 0.0);
+    Sum(local_weight, ctx.total_weight);
+    if (ctx.total_weight <= 0) {
+      finish(frag, ctx);
+      return;
+    }
+    ctx.quality = modularity(ctx);
+
+    query(frag, ctx, messages);
+    ctx.step = step_t::kReply;
+    messages.ForceContinue();
+  }
+
+  void IncEval(const fragment_t& frag, context_t& ctx,
+               message_manager_t& messages) {
+    auto& graph = ctx.graph;
+    std::vector<std::vector<message_t>> buffers(thread_num());
+    messages.ParallelProcess<message_t>(
+        thread_num(), [&graph, &buffers](int tid, const message_t& msg) {
+          switch (msg.kind) {
+          case kind_t::kLabel:
+            graph.communities[graph.slots.at(msg.first)] = msg.second;
+            break;
+          case kind_t::kDelta:
+            grape::atomic_add(graph.sigma[graph.slots.at(msg.first)],
+                              msg.weight);
+            break;
+          default:
+            buffers[tid].push_back(msg);
+          }
+        });
+    answer(frag, ctx, messages, buffers);
+
+    switch (ctx.step) {
+    case step_t::kReply:
+      ctx.step = step_t::kMove;
+      break;
+    case step_t::kMove:
+      ctx.remote_sigma.clear();
+      for (auto& buffer : buffers) {
+        for (auto& msg : buffer) {
+          if (msg.kind == kind_t::kSigma) {
+            ctx.remote_sigma[msg.first] = msg.weight;
+          }
+        }
+      }
+      move(frag, ctx, messages);
+      ctx.step = step_t::kQuery;
+      break;
+    case step_t::kQuery:
+      if (ctx.level_done) {
+        if (!finishLevel(frag, ctx, messages)) {
+          return;
+        }
+        ctx.step = step_t::kBuild;
+      } else {
+        query(frag, ctx, messages);
+        ctx.step = step_t::kReply;
+      }
+      break;
+    case step_t::kBuild:
+      buildNextLevel(ctx, buffers);
+      query(frag, ctx, messages);
+      ctx.step = step_t::kReply;
+      break;
+    }
+    messages.ForceContinue();
+  }
+
+ private:
+  void buildFirstLevel(const fragment_t& frag, context_t& ctx) {
+    auto& graph = ctx.graph;
+    auto inner_vertices = frag.InnerVertices();
+    typename FRAG_T::template vertex_array_t<vid_t> slot;
+    slot.Init(frag.Vertices());
+
+    graph.gids.clear();
+    graph.slots.clear();
+    for (auto v : inner_vertices) {
+      slot[v] = graph.gids.size();
+      graph.gids.push_back(frag.Vertex2Gid(v));
+    }
+    graph.owned_num = graph.gids.size();
+    for (auto v : frag.OuterVertices()) {
+      slot[v] = graph.gids.size();
+      graph.gids.push_back(frag.Vertex2Gid(v));
+    }
+    for (size_t s = 0; s < graph.gids.size(); ++s) {
+      graph.slots.emplace(graph.gids[s], s);
+    }
+
+    graph.offsets.assign(graph.owned_num + 1, 0);
+    for (auto v : inner_vertices) {
+      size_t degree = 0;
+      for (auto& e : frag.GetOutgoingAdjList(v)) {
+        degree += e.get_neighbor() != v;
+      }
+      graph.offsets[slot[v] + 1] = degree;
+    }
+    for (vid_t i = 0; i < graph.owned_num; ++i) {
+      graph.offsets[i + 1] += graph.offsets[i];
+    }
+    graph.neighbors.resize(graph.offsets[graph.owned_num]);
+    graph.weights.resize(graph.offsets[graph.owned_num]);
+    graph.self_weights.assign(graph.owned_num, 0.0);
+    ForEach(inner_vertices, [&frag, &graph, &slot](int tid, vertex_t v) {
+      vid_t i = slot[v];
+      size_t pos = graph.offsets[i];
+      for (auto& e : frag.GetOutgoingAdjList(v)) {
+        auto u = e.get_neighbor();
+        if (u == v) {
+          graph.self_weights[i] += weight(e);
+        } else {
+          graph.neighbors[pos] = slot[u];
+          graph.weights[pos] = weight(e);
+          ++pos;
+        }
+      }
+    });
+    graph.Init(parser_);
+  }
+
+  void buildNextLevel(context_t& ctx,
+                      std::vector<std::vector<message_t>>& buffers) {
+    std::vector<std::tuple<vid_t, vid_t, double>> edges;
+    for (auto& buffer : buffers) {
+      for (auto& msg : buffer) {
+        if (msg.kind == kind_t::kEdge) {
+          edges.emplace_back(msg.first, msg.second, msg.weight);
+        }
+      }
+      std::vector<message_t>().swap(buffer);
+    }
+    ctx.graph.BuildFromEdges(edges, parser_);
+    ++ctx.level;
+    ctx.history.clear();
+    ctx.level_moves = 0;
+    ctx.level_done = false;
+
+    size_t vertex_num = ctx.graph.owned_num, total_vertex_num = 0;
+    Sum(vertex_num, total_vertex_num);
+    VLOG(1) << "Louvain level " << ctx.level << " has " << total_vertex_num
+            << " vertices";
+  }
+
+  // Ask the owners of remote communities referenced by the fragment for their
+  // total degrees.
+  void query(const fragment_t& frag, context_t& ctx,
+             message_manager_t& messages) {
+    std::vector<vid_t> remote;
+    for (auto c : ctx.graph.communities) {
+      if (parser_.GetFid(c) != frag.fid()) {
+        remote.push_back(c);
+      }
+    }
+    std::sort(remote.begin(), remote.end());
+    remote.erase(std::unique(remote.begin(), remote.end()), remote.end());
+    auto& channel = messages.Channels()[0];
+    for (auto c : remote) {
+      channel.SendToFragment(
+          parser_.GetFid(c),
+          message_t{kind_t::kQuery, c, static_cast<vid_t>(frag.fid()), 0.0});
+    }
+  }
+
+  // Answer the queries of total degrees and of communities of the last level,
+  // and take the answers of the latter.
+  void answer(const fragment_t& frag, context_t& ctx,
+              message_manager_t& messages,
+              const std::vector<std::vector<message_t>>& buffers) {
+    auto& graph = ctx.graph;
+    std::unordered_map<vid_t, vid_t> resolved;
+    for (int tid = 0; tid < thread_num(); ++tid) {
+      auto& channel = messages.Channels()[tid];
+      for (auto& msg : buffers[tid]) {
+        if (msg.kind == kind_t::kQuery) {
+          channel.SendToFragment(
+              msg.second, message_t{kind_t::kSigma, msg.first, 0,
+                                    graph.sigma[graph.slots.at(msg.first)]});
+        } else if (msg.kind == kind_t::kResolve) {
+          channel.SendToFragment(
+              msg.second,
+              message_t{kind_t::kResolved, msg.first,
+                        graph.communities[graph.slots.at(msg.first)], 0.0});
+        } else if (msg.kind == kind_t::kResolved) {
+          resolved.emplace(msg.first, msg.second);
+        }
+      }
+    }
+    if (!resolved.empty()) {
+      ForEach(ctx.unresolved, [&ctx, &resolved](int tid, vertex_t v) {
+        ctx.membership[v] = resolved.at(ctx.membership[v]);
+      });
+      ctx.unresolved.Clear();
+    }
+  }
+
+  void move(const fragment_t& frag, context_t& ctx,
+            message_manager_t& messages) {
+    auto& graph = ctx.graph;
+    grape::VertexRange<vid_t> owned(0, graph.owned_num);
+    bool odd = ctx.history.size() % 2 == 1;
+    ctx.next.resize(graph.owned_num);
+    ForEach(owned, [&frag, &ctx, odd, this](int tid, vertex_t v) {
+      ctx.next[v.GetValue()] =
+          bestCommunity(frag, ctx, tables_[tid], v.GetValue(), odd);
+    });
+
+    std::vector<std::unordered_map<vid_t, double>> deltas(thread_num());
+    std::vector<int64_t> moved(thread_num(), 0);
+    ForEach(owned, [&frag, &messages, &graph, &ctx, &deltas, &moved, this](
+                       int tid, vertex_t v) {
+      vid_t i = v.GetValue();
+      vid_t from = graph.communities[i], to = ctx.next[i];
+      if (from == to) {
+        return;
+      }
+      graph.communities[i] = to;
+      ++moved[tid];
+      for (auto c : {from, to}) {
+        double delta = c == to ? graph.degrees[i] : -graph.degrees[i];
+        if (parser_.GetFid(c) == frag.fid()) {
+          grape::atomic_add(graph.sigma[graph.slots.at(c)], delta);
+        } else {
+          deltas[tid][c] += delta;
+        }
+      }
+      auto& channel = messages.Channels()[tid];
+      for (size_t k = graph.mirror_offsets[i]; k < graph.mirror_offsets[i + 1];
+           ++k) {
+        channel.SendToFragment(
+            graph.mirrors[k],
+            message_t{kind_t::kLabel, graph.gids[i], to, 0.0});
+      }
+    });
+    for (int tid = 0; tid < thread_num(); ++tid) {
+      auto& channel = messages.Channels()[tid];
+      for (auto& pair : deltas[tid]) {
+        channel.SendToFragment(
+            parser_.GetFid(pair.first),
+            message_t{kind_t::kDelta, pair.first, 0, pair.second});
+      }
+    }
+
+    int64_t local_moved =
+        std::accumulate(moved.begin(), moved.end(), int64_t{0});
+    int64_t total_moved = 0;
+    Sum(local_moved, total_moved);
+    ctx.history.push_back(total_moved);
+    ctx.level_moves += total_moved;
+    ctx.level_done = stalled(ctx);
+    VLOG(1) << "Louvain level " << ctx.level << " sweep "
+            << ctx.history.size() << " moved " << total_moved << " vertices";
+  }
+
+  vid_t bestCommunity(const fragment_t& frag, const context_t& ctx,
+                      CommunityWeightTable<vid_t>& table, vid_t i,
+                      bool odd) const {
+    auto& graph = ctx.graph;
+    vid_t current = graph.communities[i];
+    size_t begin = graph.offsets[i], end = graph.offsets[i + 1];
+    if (begin == end) {
+      return current;
+    }
+    table.Reset(end - begin);
+    for (size_t e = begin; e < end; ++e) {
+      table.Add(graph.communities[graph.neighbors[e]], graph.weights[e]);
+    }
+
+    // the gain in modularity is scaled by half of total_weight, and the terms
+    // common to all communities are dropped
+    double k = graph.degrees[i], scale = k / ctx.total_weight;
+    vid_t best = current;
+    double best_gain =
+        table.Get(current) - (sigmaOf(frag, ctx, current) - k) * scale;
+    table.ForEach([&](vid_t c, double weight) {
+      if (c == current || (odd ? c > current : c < current)) {
+        return;
+      }
+      double gain = weight - sigmaOf(frag, ctx, c) * scale;
+      if (gain > best_gain || (gain == best_gain && best != current &&
+                               c < best)) {
+        best = c;
+        best_gain = gain;
+      }
+    });
+    return best;
+  }
+
+  double sigmaOf(const fragment_t& frag, const context_t& ctx,
+                 vid_t c) const {
+    if (parser_.GetFid(c) == frag.fid()) {
+      return ctx.graph.sigma[ctx.graph.slots.at(c)];
+    }
+    auto iter = ctx.remote_sigma.find(c);
+    return iter == ctx.remote_sigma.end() ? 0.0 : iter->second;
+  }
+
+  // The local moving of a level halts once a sweep moves no vertex, or the
+  // number of moved vertices fails to drop by more than min_progress in more
+  // than progress_tries sweeps, in the way of the Pregel louvain.
+  static bool stalled(const context_t& ctx) {
+    if (ctx.history.back() == 0) {
+      return true;
+    }
+    int count = 0;
+    int64_t previous = ctx.history.front();
+    for (auto moved : ctx.history) {
+      if (previous - moved <= ctx.min_progress) {
+        ++count;
+      }
+      previous = moved;
+    }
+    return count > ctx.progress_tries;
+  }
+
+  double modularity(const context_t& ctx) {
+    auto& graph = ctx.graph;
+    double local_inner = 0.0, local_square = 0.0;
+    for (vid_t i = 0; i < graph.owned_num; ++i) {
+      local_inner += graph.self_weights[i];
+      for (size_t e = graph.offsets[i]; e < graph.offsets[i + 1]; ++e) {
+        if (graph.communities[graph.neighbors[e]] == graph.communities[i]) {
+          local_inner += graph.weights[e];
+        }
+      }
+      local_square += graph.sigma[i] * graph.sigma[i];
+    }
+    double inner = 0.0, square = 0.0;
+    Sum(local_inner, inner);
+    Sum(local_square, square);
+    return inner / ctx.total_weight -
+           square / (ctx.total_weight * ctx.total_weight);
+  }
+
+  /**
+   * @brief Coarsen the communities of the level if it improves the
+   * modularity, otherwise the membership of the previous level is the result.
+   * Returns false if Louvain terminates.
+   */
+  bool finishLevel(const fragment_t& frag, context_t& ctx,
+                   message_manager_t& messages) {
+    double quality = modularity(ctx);
+    LOG(INFO) << "Louvain level " << ctx.level << " moved " << ctx.level_moves
+              << " vertices in " << ctx.history.size()
+              << " sweeps, modularity " << ctx.quality << " -> " << quality;
+    if (ctx.level_moves == 0 || quality <= ctx.quality) {
+      finish(frag, ctx);
+      return false;
+    }
+    ctx.quality = quality;
+    coarsen(frag, ctx, messages);
+    resolve(frag, ctx, messages);
+    return true;
+  }
+
+  // Send the edges between communities to the owners of them.
+  void coarsen(const fragment_t& frag, context_t& ctx,
+               message_manager_t& messages) {
+    auto& graph = ctx.graph;
+    std::vector<vid_t> order(graph.owned_num);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&graph](vid_t a, vid_t b) {
+      return graph.communities[a] < graph.communities[b];
+    });
+    std::vector<vid_t> groups;
+    for (vid_t k = 0; k < graph.owned_num; ++k) {
+      if (k == 0 || graph.communities[order[k]] !=
+                        graph.communities[order[k - 1]]) {
+        groups.push_back(k);
+      }
+    }
+    groups.push_back(graph.owned_num);
+
+    ForEach(grape::VertexRange<vid_t>(0, groups.size() - 1),
+            [&messages, &graph, &order, &groups, this](int tid, vertex_t g) {
+              auto& channel = messages.Channels()[tid];
+              coarsenCommunity(graph, order.data() + groups[g.GetValue()],
+                               order.data() + groups[g.GetValue() + 1],
+                               tables_[tid], channel);
+            },
+            1);
+  }
+
+  template <typename CHANNEL_T>
+  void coarsenCommunity(const LouvainLevel<vid_t>& graph, const vid_t* begin,
+                        const vid_t* end, CommunityWeightTable<vid_t>& table,
+                        CHANNEL_T& channel) {
+    vid_t c = graph.communities[*begin];
+    size_t edge_num = 0;
+    for (auto iter = begin; iter != end; ++iter) {
+      edge_num += graph.offsets[*iter + 1] - graph.offsets[*iter];
+    }
+    table.Reset(edge_num + 1);
+    double self_weight = 0.0;
+    for (auto iter = begin; iter != end; ++iter) {
+      vid_t i = *iter;
+      self_weight += graph.self_weights[i];
+      for (size_t e = graph.offsets[i]; e < graph.offsets[i + 1]; ++e) {
+        table.Add(graph.communities[graph.neighbors[e]], graph.weights[e]);
+      }
+    }
+    // also makes the community a vertex of the next level
+    table.Add(c, self_weight);
+    auto fid = parser_.GetFid(c);
+    table.ForEach([&](vid_t d, double weight) {
+      channel.SendToFragment(fid, message_t{kind_t::kEdge, c, d, weight});
+    });
+  }
+
+  // Move the membership of inner vertices to the communities of the level,
+  // the remote ones are answered in the next round.
+  void resolve(const fragment_t& frag, context_t& ctx,
+               message_manager_t& messages) {
+    auto& graph = ctx.graph;
+    std::vector<vid_t> remote;
+    for (auto v : frag.InnerVertices()) {
+      vid_t g = ctx.membership[v];
+      if (parser_.GetFid(g) == frag.fid()) {
+        ctx.membership[v] = graph.communities[graph.slots.at(g)];
+      } else {
+        ctx.unresolved.Insert(v);
+        remote.push_back(g);
+      }
+    }
+    std::sort(remote.begin(), remote.end());
+    remote.erase(std::unique(remote.begin(), remote.end()), remote.end());
+    auto& channel = messages.Channels()[0];
+    for (auto g : remote) {
+      channel.SendToFragment(
+          parser_.GetFid(g),
+          message_t{kind_t::kResolve, g, static_cast<vid_t>(frag.fid()), 0.0});
+    }
+  }
+
+  void finish(const fragment_t& frag, context_t& ctx) {
+    ForEach(frag.InnerVertices(), [&frag, &ctx](int tid, vertex_t v) {
+      ctx.community[v] = frag.Gid2Oid(ctx.membership[v]);
+    });
+  }
+
+  template <typename EDGE_T>
+  static double weight(const EDGE_T& e) {
+    double edata = 1.0;
+    vineyard::static_if<!std::is_same<edata_t, grape::EmptyType>{}>(
+        [&](auto& e, auto& data) {
+          data = static_cast<double>(e.get_data());
+        })(e, edata);
+    return edata;
+  }
+
+  vineyard::IdParser<vid_t> parser_;
+  std::vector<CommunityWeightTable<vid_t>> tables_;
+};
+
+}  // namespace gs
+
+#endif  // ANALYTICAL_ENGINE_APPS_LOUVAIN_LOUVAIN_H_
@@ -0,0 +1,103 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANALYTICAL_ENGINE_APPS_LOUVAIN_LOUVAIN_CONTEXT_H_
+#define ANALYTICAL_ENGINE_APPS_LOUVAIN_LOUVAIN_CONTEXT_H_
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "grape/grape.h"
+
+#include "apps/louvain/louvain_level.h"
+
+namespace gs {
+
+template <typename FRAG_T>
+class LouvainContext
+    : public grape::VertexDataContext<FRAG_T, typename FRAG_T::oid_t> {
+ public:
+  using oid_t = typename FRAG_T::oid_t;
+  using vid_t = typename FRAG_T::vid_t;
+  using vertex_t = typename FRAG_T::vertex_t;
+
+  // The step of a sweep of local moving, or of coarsening, run by IncEval.
+  enum class Step { kQuery, kReply, kMove, kBuild };
+
+  explicit LouvainContext(const FRAG_T& fragment)
+      : grape::VertexDataContext<FRAG_T, oid_t>(fragment),
+        community(this->data()) {}
+
+  /**
+   * @param min_progress_ The local moving of a level halts once the number of
+   * moved vertices fails to drop by more than min_progress_ in more than
+   * progress_tries_ sweeps.
+   */
+  void Init(grape::ParallelMessageManager& messages, int min_progress_ = 1000,
+            int progress_tries_ = 1) {
+    auto& frag = this->fragment();
+
+    min_progress = min_progress_;
+    progress_tries = progress_tries_;
+    step = Step::kReply;
+    level = 0;
+    level_moves = 0;
+    level_done = false;
+    total_weight = 0.0;
+    quality = 0.0;
+    membership.Init(frag.InnerVertices());
+    unresolved.Init(frag.InnerVertices());
+  }
+
+  void Output(std::ostream& os) override {
+    auto& frag = this->fragment();
+    auto inner_vertices = frag.InnerVertices();
+
+    for (auto v : inner_vertices) {
+      os << frag.GetId(v) << " " << community[v] << std::endl;
+    }
+  }
+
+  int min_progress;
+  int progress_tries;
+
+  Step step;
+  int level;
+  // moved vertices of each sweep of the level
+  std::vector<int64_t> history;
+  int64_t level_moves;
+  bool level_done;
+  // twice the total edge weight
+  double total_weight;
+  // modularity at the start of the level
+  double quality;
+
+  LouvainLevel<vid_t> graph;
+  // total degree of the remote communities referenced by the fragment
+  std::unordered_map<vid_t, double> remote_sigma;
+  // the community chosen by each owned vertex in the sweep
+  std::vector<vid_t> next;
+  // the vertex of the current level an inner vertex belongs to
+  typename FRAG_T::template inner_vertex_array_t<vid_t> membership;
+  // inner vertices whose membership waits for a remote owner
+  grape::DenseVertexSet<typename FRAG_T::inner_vertices_t> unresolved;
+
+  typename FRAG_T::template vertex_array_t<oid_t>& community;
+};
+
+}  // namespace gs
+
+#endif  // ANALYTICAL_ENGINE_APPS_LOUVAIN_LOUVAIN_CONTEXT_H_
@@ -0,0 +1,244 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANALYTICAL_ENGINE_APPS_LOUVAIN_LOUVAIN_LEVEL_H_
+#define ANALYTICAL_ENGINE_APPS_LOUVAIN_LOUVAIN_LEVEL_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+#include "grape/grape.h"
+#include "vineyard/graph/fragment/property_graph_utils.h"
+
+namespace gs {
+
+enum class LouvainMessageKind : uint8_t {
+  kLabel,     // (vertex, community), to the mirrors of a moved vertex
+  kDelta,     // (community, -, weight), to the owner of the community
+  kQuery,     // (community, fid), to the owner of the community
+  kSigma,     // (community, -, sigma), back to the querying fragment
+  kEdge,      // (community, community, weight), to the owner of the first
+  kResolve,   // (vertex, fid), to the owner of a vertex of the last level
+  kResolved,  // (vertex, community), back to the resolving fragment
+};
+
+template <typename VID_T>
+struct LouvainMessage {
+  LouvainMessageKind kind;
+  VID_T first;
+  VID_T second;
+  double weight;
+};
+
+/**
+ * @brief The part of a level of Louvain held by a fragment.
+ *
+ * A vertex of level 0 is an inner vertex of the fragment. A vertex of a
+ * coarser level is a community of the previous level, named by the gid of its
+ * hub and owned by the fragment of the hub. Owned vertices and their remote
+ * neighbors (ghosts) are numbered by slots, the owned ones first, so that the
+ * adjacency is scanned without hashing.
+ *
+ * A community is named by the gid of a vertex of the level as well, and its
+ * total degree is kept by the owner of that vertex.
+ */
+template <typename VID_T>
+struct LouvainLevel {
+  /**
+   * @brief Build a coarse level from the edges between communities of the
+   * previous level, the first end of each edge is owned. The weight of the
+   * edges within a community is on the edge to itself, and every community
+   * has such an edge.
+   */
+  void BuildFromEdges(std::vector<std::tuple<VID_T, VID_T, double>>& edges,
+                      const vineyard::IdParser<VID_T>& parser) {
+    std::sort(edges.begin(), edges.end());
+    gids.clear();
+    slots.clear();
+    neighbors.clear();
+    weights.clear();
+    for (auto& e : edges) {
+      if (gids.empty() || gids.back() != std::get<0>(e)) {
+        gids.push_back(std::get<0>(e));
+      }
+    }
+    owned_num = gids.size();
+    for (VID_T i = 0; i < owned_num; ++i) {
+      slots.emplace(gids[i], i);
+    }
+    offsets.assign(owned_num + 1, 0);
+    self_weights.assign(owned_num, 0.0);
+
+    // edges of the same pair come from several fragments
+    for (size_t k = 0; k < edges.size();) {
+      VID_T src = std::get<0>(edges[k]), dst = std::get<1>(edges[k]);
+      double weight = 0.0;
+      for (; k < edges.size() && std::get<0>(edges[k]) == src &&
+             std::get<1>(edges[k]) == dst;
+           ++k) {
+        weight += std::get<2>(edges[k]);
+      }
+      VID_T i = slots.at(src);
+      if (src == dst) {
+        self_weights[i] += weight;
+        continue;
+      }
+      auto iter = slots.find(dst);
+      if (iter == slots.end()) {
+        iter = slots.emplace(dst, static_cast<VID_T>(gids.size())).first;
+        gids.push_back(dst);
+      }
+      neighbors.push_back(iter->second);
+      weights.push_back(weight);
+      ++offsets[i + 1];
+    }
+    for (VID_T i = 0; i < owned_num; ++i) {
+      offsets[i + 1] += offsets[i];
+    }
+    edges.clear();
+    edges.shrink_to_fit();
+    Init(parser);
+  }
+
+  /**
+   * @brief Put every vertex into its own community, once slots and the
+   * adjacency are built.
+   */
+  void Init(const vineyard::IdParser<VID_T>& parser) {
+    degrees.assign(owned_num, 0.0);
+    for (VID_T i = 0; i < owned_num; ++i) {
+      double degree = self_weights[i];
+      for (size_t e = offsets[i]; e < offsets[i + 1]; ++e) {
+        degree += weights[e];
+      }
+      degrees[i] = degree;
+    }
+    communities = gids;
+    sigma = degrees;
+
+    // the graph is undirected, a fragment holds a vertex as a ghost iff it
+    // owns some neighbor of it
+    mirror_offsets.assign(owned_num + 1, 0);
+    mirrors.clear();
+    std::vector<grape::fid_t> fids;
+    for (VID_T i = 0; i < owned_num; ++i) {
+      fids.clear();
+      for (size_t e = offsets[i]; e < offsets[i + 1]; ++e) {
+        if (neighbors[e] >= owned_num) {
+          fids.push_back(parser.GetFid(gids[neighbors[e]]));
+        }
+      }
+      std::sort(fids.begin(), fids.end());
+      fids.erase(std::unique(fids.begin(), fids.end()), fids.end());
+      mirrors.insert(mirrors.end(), fids.begin(), fids.end());
+      mirror_offsets[i + 1] = mirrors.size();
+    }
+  }
+
+  VID_T owned_num = 0;
+  // gids of slots
+  std::vector<VID_T> gids;
+  std::unordered_map<VID_T, VID_T> slots;
+  // adjacency of owned vertices, by slots
+  std::vector<size_t> offsets;
+  std::vector<VID_T> neighbors;
+  std::vector<double> weights;
+  // weight of the edges within an owned vertex, counted in both directions
+  std::vector<double> self_weights;
+  std::vector<double> degrees;
+  // communities of slots
+  std::vector<VID_T> communities;
+  // total degree of the community named by an owned vertex
+  std::vector<double> sigma;
+  // fragments holding an owned vertex as a ghost
+  std::vector<size_t> mirror_offsets;
+  std::vector<grape::fid_t> mirrors;
+};
+
+/**
+ * @brief Weights from a vertex to the communities of its neighbors, an open
+ * addressing table reused by a thread across vertices.
+ */
+template <typename VID_T>
+class CommunityWeightTable {
+ public:
+  void Reset(size_t n) {
+    for (auto pos : touched_) {
+      used_[pos] = 0;
+    }
+    touched_.clear();
+    size_t capacity = 16;
+    while (capacity < 2 * n) {
+      capacity <<= 1;
+    }
+    if (capacity > keys_.size()) {
+      keys_.resize(capacity);
+      weights_.resize(capacity);
+      used_.resize(capacity, 0);
+    }
+    mask_ = capacity - 1;
+  }
+
+  void Add(VID_T key, double weight) {
+    size_t pos = hash(key) & mask_;
+    while (used_[pos] && keys_[pos] != key) {
+      pos = (pos + 1) & mask_;
+    }
+    if (!used_[pos]) {
+      used_[pos] = 1;
+      keys_[pos] = key;
+      weights_[pos] = 0.0;
+      touched_.push_back(pos);
+    }
+    weights_[pos] += weight;
+  }
+
+  double Get(VID_T key) const {
+    size_t pos = hash(key) & mask_;
+    while (used_[pos]) {
+      if (keys_[pos] == key) {
+        return weights_[pos];
+      }
+      pos = (pos + 1) & mask_;
+    }
+    return 0.0;
+  }
+
+  template <typename FUNC_T>
+  void ForEach(const FUNC_T& func) const {
+    for (auto pos : touched_) {
+      func(keys_[pos], weights_[pos]);
+    }
+  }
+
+ private:
+  static size_t hash(VID_T key) {
+    uint64_t h = static_cast<uint64_t>(key) * 0x9E3779B97F4A7C15ULL;
+    return static_cast<size_t>(h ^ (h >> 32));
+  }
+
+  std::vector<VID_T> keys_;
+  std::vector<double> weights_;
+  std::vector<uint8_t> used_;
+  std::vector<size_t> touched_;
+  size_t mask_ = 0;
+};
+
+}  // namespace gs
+
+#endif  // ANALYTICAL_ENGINE_APPS_LOUVAIN_LOUVAIN_LEVEL_H_
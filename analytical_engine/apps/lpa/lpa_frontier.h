@@ -0,0 +1,186 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANALYTICAL_ENGINE_APPS_LPA_LPA_FRONTIER_H_
+#define ANALYTICAL_ENGINE_APPS_LPA_LPA_FRONTIER_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "grape/grape.h"
+
+#include "apps/lpa/lpa_frontier_context.h"
+
+namespace gs {
+
+/**
+ * @brief Community detection by synchronous label propagation, which only
+ * re-evaluates the vertices with a neighbor whose label changed in the last
+ * round. The others would pick the same label again.
+ *
+ * A label is the gid of the vertex it starts from, so the initial labels of
+ * outer vertices are known without communication. Each round, the active
+ * vertices count the labels of their neighbors, in and out ones for directed
+ * graphs, in counters of their threads and take the most frequent one, the
+ * smallest on ties. Only changed labels are sent to the mirrors, and the
+ * fragment that receives one activates the inner neighbors of the outer
+ * vertex by an index built in PEval. It stops after max_round rounds, or once
+ * at most stable_ratio of all vertices changed in a round, and reports the
+ * oid of the vertex each label starts from.
+ * @tparam FRAG_T
+ */
+template <typename FRAG_T>
+class LPAFrontier
+    : public grape::ParallelAppBase<FRAG_T, LPAFrontierContext<FRAG_T>>,
+      public grape::ParallelEngine,
+      public grape::Communicator {
+ public:
+  INSTALL_PARALLEL_WORKER(LPAFrontier<FRAG_T>, LPAFrontierContext<FRAG_T>,
+                          FRAG_T)
+  static constexpr grape::MessageStrategy message_strategy =
+      grape::MessageStrategy::kAlongEdgeToOuterVertex;
+  static constexpr grape::LoadStrategy load_strategy =
+      grape::LoadStrategy::kBothOutIn;
+  using vertex_t = typename fragment_t::vertex_t;
+  using vid_t = typename fragment_t::vid_t;
+
+  void PEval(const fragment_t& frag, context_t& ctx,
+             message_manager_t& messages) {
+    auto inner_vertices = frag.InnerVertices();
+    messages.InitChannels(thread_num());
+    ctx.counters.resize(thread_num());
+
+    ForEach(frag.Vertices(), [&frag, &ctx](int tid, vertex_t v) {
+      ctx.labels[v] = frag.Vertex2Gid(v);
+    });
+    buildOuterNeighbors(frag, ctx);
+    ForEach(inner_vertices,
+            [&ctx](int tid, vertex_t v) { ctx.active.Insert(v); });
+    propagate(frag, ctx, messages);
+  }
+
+  void IncEval(const fragment_t& frag, context_t& ctx,
+               message_manager_t& messages) {
+    messages.ParallelProcess<fragment_t, vid_t>(
+        thread_num(), frag, [&ctx](int tid, vertex_t u, vid_t msg) {
+          ctx.labels[u] = msg;
+          for (size_t i = ctx.outer_nbr_begin[u]; i < ctx.outer_nbr_end[u];
+               ++i) {
+            ctx.active.Insert(ctx.outer_nbrs[i]);
+          }
+        });
+    propagate(frag, ctx, messages);
+  }
+
+ private:
+  template <typename FUNC_T>
+  void forEachNeighbor(const fragment_t& frag, vertex_t v,
+                       const FUNC_T& func) const {
+    for (auto& e : frag.GetOutgoingAdjList(v)) {
+      func(e.get_neighbor());
+    }
+    if (frag.directed()) {
+      for (auto& e : frag.GetIncomingAdjList(v)) {
+        func(e.get_neighbor());
+      }
+    }
+  }
+
+  // Index the inner neighbors of each outer vertex, to activate them when the
+  // label of the outer vertex changes.
+  void buildOuterNeighbors(const fragment_t& frag, context_t& ctx) {
+    auto inner_vertices = frag.InnerVertices();
+    ForEach(inner_vertices, [&frag, &ctx, this](int tid, vertex_t v) {
+      forEachNeighbor(frag, v, [&frag, &ctx](vertex_t u) {
+        if (frag.IsOuterVertex(u)) {
+          __sync_fetch_and_add(&ctx.outer_nbr_end[u], 1);
+        }
+      });
+    });
+    size_t offset = 0;
+    for (auto u : frag.OuterVertices()) {
+      ctx.outer_nbr_begin[u] = offset;
+      offset += ctx.outer_nbr_end[u];
+      ctx.outer_nbr_end[u] = ctx.outer_nbr_begin[u];
+    }
+    ctx.outer_nbrs.resize(offset);
+    ForEach(inner_vertices, [&frag, &ctx, this](int tid, vertex_t v) {
+      forEachNeighbor(frag, v, [&frag, &ctx, v](vertex_t u) {
+        if (frag.IsOuterVertex(u)) {
+          ctx.outer_nbrs[__sync_fetch_and_add(&ctx.outer_nbr_end[u], 1)] = v;
+        }
+      });
+    });
+  }
+
+  void propagate(const fragment_t& frag, context_t& ctx,
+                 message_manager_t& messages) {
+    ++ctx.step;
+    ForEach(ctx.active, [&frag, &ctx, this](int tid, vertex_t v) {
+      auto& counter = ctx.counters[tid];
+      size_t degree = frag.GetLocalOutDegree(v);
+      if (frag.directed()) {
+        degree += frag.GetLocalInDegree(v);
+      }
+      counter.Reset(degree);
+      forEachNeighbor(frag, v, [&ctx, &counter](vertex_t u) {
+        counter.Add(ctx.labels[u]);
+      });
+      if (!counter.Empty()) {
+        vid_t label = counter.Top();
+        if (label != ctx.labels[v]) {
+          ctx.next_labels[v] = label;
+          ctx.changed.Insert(v);
+        }
+      }
+    });
+    ctx.active.Clear();
+
+    size_t changed_num = ctx.changed.Count(), total_changed_num = 0;
+    Sum(changed_num, total_changed_num);
+    bool stable = total_changed_num <=
+                  ctx.stable_ratio * frag.GetTotalVerticesNum();
+    if (stable || ctx.step >= ctx.max_round) {
+      ForEach(ctx.changed, [&ctx](int tid, vertex_t v) {
+        ctx.labels[v] = ctx.next_labels[v];
+      });
+      ctx.changed.Clear();
+      ForEach(frag.InnerVertices(), [&frag, &ctx](int tid, vertex_t v) {
+        ctx.result[v] = frag.Gid2Oid(ctx.labels[v]);
+      });
+      LOG(INFO) << "LPA finished after " << ctx.step << " rounds, "
+                << total_changed_num << " vertices changed in the last one";
+      return;
+    }
+
+    ForEach(ctx.changed,
+            [&frag, &ctx, &messages, this](int tid, vertex_t v) {
+              ctx.labels[v] = ctx.next_labels[v];
+              messages.SendMsgThroughEdges<fragment_t, vid_t>(
+                  frag, v, ctx.labels[v], tid);
+              forEachNeighbor(frag, v, [&frag, &ctx](vertex_t u) {
+                if (frag.IsInnerVertex(u)) {
+                  ctx.active.Insert(u);
+                }
+              });
+            });
+    ctx.changed.Clear();
+    messages.ForceContinue();
+  }
+};
+
+}  // namespace gs
+
+#endif  // ANALYTICAL_ENGINE_APPS_LPA_LPA_FRONTIER_H_
@@ -0,0 +1,191 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANALYTICAL_ENGINE_APPS_LPA_LPA_FRONTIER_CONTEXT_H_
+#define ANALYTICAL_ENGINE_APPS_LPA_LPA_FRONTIER_CONTEXT_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "grape/grape.h"
+
+namespace gs {
+
+/**
+ * @brief Counts the labels of the neighbors of a vertex. The labels of a
+ * vertex of a small degree are kept in a small array and scanned, the others
+ * in an open-addressing table, which is reset by the slots used rather than
+ * cleared as a whole.
+ */
+template <typename LABEL_T>
+class LabelCounter {
+ public:
+  static constexpr size_t kSmallDegree = 16;
+
+  void Reset(size_t degree) {
+    small_ = degree <= kSmallDegree;
+    if (small_) {
+      small_num_ = 0;
+      return;
+    }
+    for (auto slot : used_) {
+      counts_[slot] = 0;
+    }
+    used_.clear();
+    size_t capacity = 1;
+    while (capacity < 2 * degree) {
+      capacity <<= 1;
+    }
+    if (counts_.size() < capacity) {
+      keys_.resize(capacity);
+      counts_.resize(capacity, 0);
+    }
+    mask_ = capacity - 1;
+  }
+
+  void Add(LABEL_T label) {
+    if (small_) {
+      for (size_t i = 0; i < small_num_; ++i) {
+        if (small_keys_[i] == label) {
+          ++small_counts_[i];
+          return;
+        }
+      }
+      small_keys_[small_num_] = label;
+      small_counts_[small_num_++] = 1;
+      return;
+    }
+    size_t slot = hash(label) & mask_;
+    while (counts_[slot] != 0 && keys_[slot] != label) {
+      slot = (slot + 1) & mask_;
+    }
+    if (counts_[slot] == 0) {
+      keys_[slot] = label;
+      used_.push_back(slot);
+    }
+    ++counts_[slot];
+  }
+
+  bool Empty() const { return small_ ? small_num_ == 0 : used_.empty(); }
+
+  /**
+   * @brief The most frequent label, and the smallest one on ties.
+   */
+  LABEL_T Top() const {
+    LABEL_T top{};
+    uint32_t top_count = 0;
+    auto visit = [&top, &top_count](LABEL_T label, uint32_t count) {
+      if (count > top_count || (count == top_count && label < top)) {
+        top = label;
+        top_count = count;
+      }
+    };
+    if (small_) {
+      for (size_t i = 0; i < small_num_; ++i) {
+        visit(small_keys_[i], small_counts_[i]);
+      }
+    } else {
+      for (auto slot : used_) {
+        visit(keys_[slot], counts_[slot]);
+      }
+    }
+    return top;
+  }
+
+ private:
+  static size_t hash(LABEL_T label) {
+    uint64_t x = static_cast<uint64_t>(label);
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    return static_cast<size_t>(x);
+  }
+
+  bool small_ = true;
+  size_t small_num_ = 0;
+  LABEL_T small_keys_[kSmallDegree];
+  uint32_t small_counts_[kSmallDegree];
+
+  size_t mask_ = 0;
+  std::vector<LABEL_T> keys_;
+  std::vector<uint32_t> counts_;
+  std::vector<size_t> used_;
+};
+
+template <typename FRAG_T>
+class LPAFrontierContext
+    : public grape::VertexDataContext<FRAG_T, typename FRAG_T::oid_t> {
+ public:
+  using oid_t = typename FRAG_T::oid_t;
+  using vid_t = typename FRAG_T::vid_t;
+  using vertex_t = typename FRAG_T::vertex_t;
+
+  explicit LPAFrontierContext(const FRAG_T& fragment)
+      : grape::VertexDataContext<FRAG_T, oid_t>(fragment, true),
+        result(this->data()) {}
+
+  void Init(grape::ParallelMessageManager& messages, int max_round = 10,
+            double stable_ratio = 0.0) {
+    auto& frag = this->fragment();
+    auto inner_vertices = frag.InnerVertices();
+
+    this->max_round = max_round;
+    this->stable_ratio = stable_ratio;
+    step = 0;
+    labels.Init(frag.Vertices());
+    next_labels.Init(inner_vertices);
+    outer_nbr_begin.Init(frag.Vertices(), 0);
+    outer_nbr_end.Init(frag.Vertices(), 0);
+    active.Init(inner_vertices);
+    changed.Init(inner_vertices);
+  }
+
+  void Output(std::ostream& os) override {
+    auto& frag = this->fragment();
+    auto inner_vertices = frag.InnerVertices();
+
+    for (auto v : inner_vertices) {
+      os << frag.GetId(v) << " " << result[v] << std::endl;
+    }
+  }
+
+  int step;
+  int max_round;
+  // stops once at most this ratio of the vertices changed their labels
+  double stable_ratio;
+
+  typename FRAG_T::template vertex_array_t<oid_t>& result;
+  // the gid of the vertex a label starts from, for inner and outer vertices
+  typename FRAG_T::template vertex_array_t<vid_t> labels;
+  typename FRAG_T::template inner_vertex_array_t<vid_t> next_labels;
+  // the inner neighbors of an outer vertex are
+  // outer_nbrs[outer_nbr_begin[u], outer_nbr_end[u])
+  typename FRAG_T::template vertex_array_t<size_t> outer_nbr_begin;
+  typename FRAG_T::template vertex_array_t<size_t> outer_nbr_end;
+  std::vector<vertex_t> outer_nbrs;
+  std::vector<LabelCounter<vid_t>> counters;
+
+  // inner vertices with a neighbor whose label changed in the last round
+  grape::DenseVertexSet<typename FRAG_T::inner_vertices_t> active;
+  // inner vertices whose labels change in this round
+  grape::DenseVertexSet<typename FRAG_T::inner_vertices_t> changed;
+};
+
+template <typename LABEL_T>
+constexpr size_t LabelCounter<LABEL_T>::kSmallDegree;
+
+}  // namespace gs
+
+#endif  // ANALYTICAL_ENGINE_APPS_LPA_LPA_FRONTIER_CONTEXT_H_
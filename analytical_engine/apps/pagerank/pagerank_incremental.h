@@ -0,0 +1,179 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef ANALYTICAL_ENGINE_APPS_PAGERANK_PAGERANK_INCREMENTAL_H_
+#define ANALYTICAL_ENGINE_APPS_PAGERANK_PAGERANK_INCREMENTAL_H_
+
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "grape/grape.h"
+
+#include "apps/pagerank/pagerank_incremental_context.h"
+
+namespace gs {
+
+/**
+ * @brief PageRank of the Networkx version, which is repaired from the ranks
+ * of the last run on the same graph instead of computed from scratch.
+ *
+ * Ranks start from the result kept by the last run, or 1/n for the vertices
+ * added since then. Vertices push the change of rank / degree to their
+ * out-neighbors instead of sending the whole rank at every round, and only
+ * when the change since the last push exceeds the tolerance. The first round
+ * pushes every vertex once, which accounts for the edges modified since the
+ * last run, after that only the vertices around the modifications keep
+ * pushing.
+ *
+ * The result is kept in the DynamicFragment for the next run.
+ *
+ * @tparam FRAG_T
+ */
+template <typename FRAG_T>
+class PageRankIncremental
+    : public grape::ParallelAppBase<FRAG_T, PageRankIncrementalContext<FRAG_T>>,
+      public grape::Communicator,
+      public grape::ParallelEngine {
+ public:
+  static constexpr grape::MessageStrategy message_strategy =
+      grape::MessageStrategy::kAlongOutgoingEdgeToOuterVertex;
+  static constexpr grape::LoadStrategy load_strategy =
+      grape::LoadStrategy::kBothOutIn;
+
+  INSTALL_PARALLEL_WORKER(PageRankIncremental<FRAG_T>,
+                          PageRankIncrementalContext<FRAG_T>, FRAG_T)
+
+  using vertex_t = typename fragment_t::vertex_t;
+  using vid_t = typename fragment_t::vid_t;
+
+  static constexpr const char* kResultKey = "pagerank";
+
+  void PEval(const fragment_t& frag, context_t& ctx,
+             message_manager_t& messages) {
+    auto inner_vertices = frag.InnerVertices();
+    size_t graph_vnum = frag.GetTotalVerticesNum();
+    messages.InitChannels(thread_num());
+    ctx.reducer.Init(thread_num(), 2);
+
+    uint64_t version;
+    auto kept = frag.GetDelta().template GetResult<double>(kResultKey, version);
+    int local_warm = kept != nullptr, warm = 0;
+    Min(local_warm, warm);
+    ctx.warm_start = warm != 0;
+
+    double p = 1.0 / graph_vnum;
+    double local_sum = 0.0;
+    for (auto u : inner_vertices) {
+      vid_t lid = u.GetValue();
+      ctx.result[u] = ctx.warm_start && lid < kept->size() ? (*kept)[lid] : p;
+      ctx.degree[u] = static_cast<double>(frag.GetOutgoingAdjList(u).Size());
+      local_sum += ctx.result[u];
+    }
+    // vertices added or removed since the last run break the sum of ranks
+    double sum = 0.0;
+    Sum(local_sum, sum);
+    double scale = sum > 0 ? 1.0 / sum : 1.0;
+    double dangling_sum = 0.0;
+    for (auto u : inner_vertices) {
+      ctx.result[u] *= scale;
+      if (ctx.degree[u] == 0.0) {
+        dangling_sum += ctx.result[u];
+      }
+    }
+    Sum(dangling_sum, ctx.dangling_sum);
+
+    ForEach(inner_vertices.begin(), inner_vertices.end(),
+            [&frag, &ctx, &messages](int tid, vertex_t u) {
+              push(frag, ctx, messages, tid, u);
+            });
+
+    messages.ForceContinue();
+  }
+
+  void IncEval(const fragment_t& frag, context_t& ctx,
+               message_manager_t& messages) {
+    auto inner_vertices = frag.InnerVertices();
+    size_t graph_vnum = frag.GetTotalVerticesNum();
+
+    ++ctx.step;
+    // the changes pushed by outer vertices go to their local out-neighbors
+    messages.ParallelProcess<fragment_t, double>(
+        thread_num(), frag, [&frag, &ctx](int tid, vertex_t u, double msg) {
+          for (auto& e : frag.GetOutgoingAdjList(u)) {
+            vertex_t v = e.get_neighbor();
+            if (frag.IsInnerVertex(v)) {
+              grape::atomic_add(ctx.in_sum[v], msg);
+            }
+          }
+        });
+
+    double base =
+        (1.0 - ctx.alpha) / graph_vnum + ctx.alpha * ctx.dangling_sum / graph_vnum;
+    auto& reducer = ctx.reducer;
+    ForEach(inner_vertices.begin(), inner_vertices.end(),
+            [&ctx, &reducer, base](int tid, vertex_t u) {
+              double rank = ctx.alpha * ctx.in_sum[u] + base;
+              reducer.Add(tid, 0, std::fabs(rank - ctx.result[u]));
+              ctx.result[u] = rank;
+              if (ctx.degree[u] == 0.0) {
+                reducer.Add(tid, 1, rank);
+              }
+            });
+    reducer.Sum(*this);
+    double total_eps = reducer[0];
+    ctx.dangling_sum = reducer[1];
+    if (total_eps < ctx.tolerance * graph_vnum || ctx.step > ctx.max_round) {
+      std::vector<double> ranks(inner_vertices.size());
+      for (auto u : inner_vertices) {
+        ranks[u.GetValue()] = ctx.result[u];
+      }
+      frag.GetDelta().KeepResult(kResultKey, std::move(ranks));
+      VLOG(1) << "Incremental PageRank finished after " << ctx.step
+              << " rounds, warm start: " << ctx.warm_start;
+      return;
+    }
+
+    ForEach(inner_vertices.begin(), inner_vertices.end(),
+            [&frag, &ctx, &messages](int tid, vertex_t u) {
+              if (std::fabs(ctx.result[u] - ctx.pushed[u]) > ctx.tolerance) {
+                push(frag, ctx, messages, tid, u);
+              }
+            });
+
+    messages.ForceContinue();
+  }
+
+ private:
+  // push the change of rank / degree since the last push.
+  static void push(const fragment_t& frag, context_t& ctx,
+                   message_manager_t& messages, int tid, vertex_t u) {
+    if (ctx.degree[u] == 0.0) {
+      return;
+    }
+    double delta = (ctx.result[u] - ctx.pushed[u]) / ctx.degree[u];
+    ctx.pushed[u] = ctx.result[u];
+    for (auto& e : frag.GetOutgoingAdjList(u)) {
+      vertex_t v = e.get_neighbor();
+      if (frag.IsInnerVertex(v)) {
+        grape::atomic_add(ctx.in_sum[v], delta);
+      }
+    }
+    messages.SendMsgThroughOEdges<fragment_t, double>(frag, u, delta, tid);
+  }
+};
+
+}  // namespace gs
+#endif  // ANALYTICAL_ENGINE_APPS_PAGERANK_PAGERANK_INCREMENTAL_H_
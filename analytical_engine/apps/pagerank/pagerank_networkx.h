@@ -57,6 +57,11 @@ class PageRankNetworkX
 
     size_t graph_vnum = frag.GetTotalVerticesNum();
     messages.InitChannels(thread_num());
+    ctx.reducer.Init(thread_num(), 2);
+    ctx.spmv.Init(frag,
+                  frag.directed() ? SpMVDirection::kIncoming
+                                  : SpMVDirection::kOutgoing,
+                  false, thread_num());
 
     ctx.step = 0;
     double p = 1.0 / graph_vnum;
@@ -115,35 +120,22 @@ class PageRankNetworkX
             });
 
     double base = (1.0 - ctx.alpha) / graph_vnum + dangling_sum / graph_vnum;
-    ForEach(inner_vertices.begin(), inner_vertices.end(),
-            [&ctx, base, &frag](int tid, vertex_t u) {
-              double cur = 0;
-              if (frag.directed()) {
-                auto es = frag.GetIncomingAdjList(u);
-                for (auto& e : es) {
-                  cur += ctx.pre_result[e.get_neighbor()];
-                }
-              } else {
-                auto es = frag.GetOutgoingAdjList(u);
-                for (auto& e : es) {
-                  cur += ctx.pre_result[e.get_neighbor()];
-                }
-              }
-              ctx.result[u] = cur * ctx.alpha + base;
-            });
-
-    double eps = 0.0;
-    ctx.dangling_sum = 0.0;
-    for (auto& v : inner_vertices) {
-      if (ctx.degree[v] > 0.0) {
-        eps += fabs(ctx.result[v] - ctx.pre_result[v] * ctx.degree[v]);
+    // the delta and the dangling sum of the next round are accumulated in the
+    // same pass, and reduced in a single all-reduce
+    auto& reducer = ctx.reducer;
+    auto update = [&ctx, &reducer, base](int tid, vertex_t u, double cur) {
+      double prev = ctx.pre_result[u];
+      ctx.result[u] = cur * ctx.alpha + base;
+      if (ctx.degree[u] > 0.0) {
+        reducer.Add(tid, 0, fabs(ctx.result[u] - prev * ctx.degree[u]));
       } else {
-        eps += fabs(ctx.result[v] - ctx.pre_result[v]);
-        ctx.dangling_sum += ctx.result[v];
+        reducer.Add(tid, 0, fabs(ctx.result[u] - prev));
+        reducer.Add(tid, 1, ctx.result[u]);
       }
-    }
-    double total_eps = 0.0;
-    Sum(eps, total_eps);
+    };
+    ctx.spmv.Multiply(*this, ctx.pre_result, update);
+    reducer.Sum(*this);
+    double total_eps = reducer[0];
     if (total_eps < ctx.tolerance * graph_vnum || ctx.step > ctx.max_round) {
       return;
     }
@@ -156,8 +148,7 @@ class PageRankNetworkX
               }
             });
 
-    double new_dangling = ctx.alpha * static_cast<double>(ctx.dangling_sum);
-    Sum(new_dangling, ctx.dangling_sum);
+    ctx.dangling_sum = ctx.alpha * reducer[1];
 
     messages.ForceContinue();
   }
@@ -20,6 +20,9 @@ limitations under the License.
 
 #include "grape/grape.h"
 
+#include "core/parallel/round_reducer.h"
+#include "core/parallel/segmented_spmv.h"
+
 namespace gs {
 /**
  * @brief Context for the Networkx version of PageRank.
@@ -73,6 +76,9 @@ class PageRankNetworkXContext
   double tolerance;
 
   double dangling_sum = 0.0;
+  RoundReducer reducer;
+  // the adjacency pulled along, built in PEval
+  SegmentedSpMV<FRAG_T> spmv;
 };
 }  // namespace gs
 
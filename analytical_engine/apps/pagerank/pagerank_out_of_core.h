@@ -0,0 +1,150 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANALYTICAL_ENGINE_APPS_PAGERANK_PAGERANK_OUT_OF_CORE_H_
+#define ANALYTICAL_ENGINE_APPS_PAGERANK_PAGERANK_OUT_OF_CORE_H_
+
+#include "grape/grape.h"
+
+#include "apps/pagerank/pagerank_out_of_core_context.h"
+#include "core/fragment/edge_block_store.h"
+
+namespace gs {
+
+/**
+ * @brief PageRank pulling the ranks along edges streamed from an edge block
+ * store on disk, so that a round only keeps the vertex states and the
+ * buffer pool of the store in memory.
+ *
+ * The edges reaching the inner vertices are spilled to the store in
+ * spill_dir in PEval, then each round streams its columns, one per thread,
+ * in the order of their blocks.
+ *
+ * @tparam FRAG_T
+ */
+template <typename FRAG_T>
+class PageRankOutOfCore
+    : public grape::ParallelAppBase<FRAG_T, PageRankOutOfCoreContext<FRAG_T>>,
+      public grape::Communicator,
+      public grape::ParallelEngine {
+ public:
+  static constexpr grape::MessageStrategy message_strategy =
+      grape::MessageStrategy::kAlongOutgoingEdgeToOuterVertex;
+  static constexpr grape::LoadStrategy load_strategy =
+      grape::LoadStrategy::kBothOutIn;
+  // vertices per chunk of the store, keeping the ranks read by a block and
+  // those written by a column in the cache
+  static constexpr size_t kChunkSize = 1 << 18;
+
+  INSTALL_PARALLEL_WORKER(PageRankOutOfCore<FRAG_T>,
+                          PageRankOutOfCoreContext<FRAG_T>, FRAG_T)
+
+  using vertex_t = typename fragment_t::vertex_t;
+  using vid_t = typename fragment_t::vid_t;
+  using edge_t = BlockEdge<vid_t>;
+
+  void PEval(const fragment_t& frag, context_t& ctx,
+             message_manager_t& messages) {
+    auto inner_vertices = frag.InnerVertices();
+    size_t graph_vnum = frag.GetTotalVerticesNum();
+    messages.InitChannels(thread_num());
+
+    SpillEdgeBlocks(frag, ctx.spill_dir, kChunkSize);
+    ctx.edges.Open(ctx.spill_dir, ctx.pool_bytes);
+
+    ctx.step = 0;
+    double p = 1.0 / graph_vnum;
+    ForEach(inner_vertices.begin(), inner_vertices.end(),
+            [&ctx, &frag, p](int tid, vertex_t u) {
+              ctx.result[u] = p;
+              ctx.degree[u] = frag.GetOutgoingAdjList(u).Size();
+            });
+
+    double dangling_sum = 0.0;
+    for (auto u : inner_vertices) {
+      if (ctx.degree[u] == 0) {
+        dangling_sum += p;
+      }
+    }
+    Sum(dangling_sum, ctx.dangling_sum);
+
+    if (ctx.max_round <= 0) {
+      return;
+    }
+    sendRanks(frag, ctx, messages);
+    messages.ForceContinue();
+  }
+
+  void IncEval(const fragment_t& frag, context_t& ctx,
+               message_manager_t& messages) {
+    auto inner_vertices = frag.InnerVertices();
+    size_t graph_vnum = frag.GetTotalVerticesNum();
+    ++ctx.step;
+
+    messages.ParallelProcess<fragment_t, double>(
+        thread_num(), frag, [&ctx](int tid, vertex_t u, const double& msg) {
+          ctx.pre_result[u] = msg;
+        });
+
+    ctx.next_result.SetValue(0.0);
+    ctx.edges.ForEachColumn(
+        thread_num(), [&ctx](int tid, const edge_t* begin, const edge_t* end) {
+          for (auto e = begin; e != end; ++e) {
+            ctx.next_result[vertex_t(e->dst)] +=
+                ctx.pre_result[vertex_t(e->src)];
+          }
+        });
+
+    double base = (1.0 - ctx.delta) / graph_vnum +
+                  ctx.delta * ctx.dangling_sum / graph_vnum;
+    ForEach(inner_vertices.begin(), inner_vertices.end(),
+            [&ctx, base](int tid, vertex_t u) {
+              ctx.result[u] = base + ctx.delta * ctx.next_result[u];
+            });
+
+    double dangling_sum = 0.0;
+    for (auto u : inner_vertices) {
+      if (ctx.degree[u] == 0) {
+        dangling_sum += ctx.result[u];
+      }
+    }
+    Sum(dangling_sum, ctx.dangling_sum);
+
+    if (ctx.step == ctx.max_round) {
+      return;
+    }
+    sendRanks(frag, ctx, messages);
+    messages.ForceContinue();
+  }
+
+ private:
+  void sendRanks(const fragment_t& frag, context_t& ctx,
+                 message_manager_t& messages) {
+    auto inner_vertices = frag.InnerVertices();
+    ForEach(inner_vertices.begin(), inner_vertices.end(),
+            [&ctx, &frag, &messages](int tid, vertex_t u) {
+              if (ctx.degree[u] == 0) {
+                ctx.pre_result[u] = 0;
+                return;
+              }
+              ctx.pre_result[u] = ctx.result[u] / ctx.degree[u];
+              messages.SendMsgThroughOEdges<fragment_t, double>(
+                  frag, u, ctx.pre_result[u], tid);
+            });
+  }
+};
+
+}  // namespace gs
+#endif  // ANALYTICAL_ENGINE_APPS_PAGERANK_PAGERANK_OUT_OF_CORE_H_
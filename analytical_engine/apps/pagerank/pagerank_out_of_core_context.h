@@ -0,0 +1,83 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANALYTICAL_ENGINE_APPS_PAGERANK_PAGERANK_OUT_OF_CORE_CONTEXT_H_
+#define ANALYTICAL_ENGINE_APPS_PAGERANK_PAGERANK_OUT_OF_CORE_CONTEXT_H_
+
+#include <iomanip>
+#include <string>
+
+#include "grape/grape.h"
+
+#include "core/fragment/edge_block_store.h"
+
+namespace gs {
+/**
+ * @brief Context for PageRank over edges streamed from disk.
+ *
+ * @tparam FRAG_T
+ */
+template <typename FRAG_T>
+class PageRankOutOfCoreContext
+    : public grape::VertexDataContext<FRAG_T, double> {
+  using vid_t = typename FRAG_T::vid_t;
+
+ public:
+  explicit PageRankOutOfCoreContext(const FRAG_T& fragment)
+      : grape::VertexDataContext<FRAG_T, double>(fragment, true),
+        result(this->data()) {}
+
+  void Init(grape::ParallelMessageManager& messages, double delta,
+            int max_round, const std::string& spill_dir, int64_t pool_mb) {
+    auto& frag = this->fragment();
+
+    this->delta = delta;
+    this->max_round = max_round;
+    this->spill_dir = spill_dir + "/frag_" + std::to_string(frag.fid());
+    this->pool_bytes = static_cast<size_t>(pool_mb) << 20;
+    degree.Init(frag.InnerVertices(), 0);
+    next_result.Init(frag.InnerVertices(), 0.0);
+    result.SetValue(0.0);
+    pre_result.Init(frag.Vertices(), 0.0);
+    step = 0;
+  }
+
+  void Output(std::ostream& os) override {
+    auto& frag = this->fragment();
+    auto inner_vertices = frag.InnerVertices();
+    for (auto v : inner_vertices) {
+      os << frag.GetId(v) << " " << std::scientific << std::setprecision(15)
+         << result[v] << std::endl;
+    }
+  }
+
+  typename FRAG_T::template inner_vertex_array_t<int> degree;
+  typename FRAG_T::template vertex_array_t<double>& result;
+  // ranks of the vertices divided by their out degrees, read by the edges
+  typename FRAG_T::template vertex_array_t<double> pre_result;
+  typename FRAG_T::template inner_vertex_array_t<double> next_result;
+
+  EdgeBlockStore<vid_t> edges;
+  std::string spill_dir;
+  size_t pool_bytes = 0;
+
+  int step = 0;
+  int max_round = 0;
+  double delta = 0;
+  double dangling_sum = 0.0;
+};
+}  // namespace gs
+
+#endif  // ANALYTICAL_ENGINE_APPS_PAGERANK_PAGERANK_OUT_OF_CORE_CONTEXT_H_
@@ -0,0 +1,84 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANALYTICAL_ENGINE_APPS_PAGERANK_PAGERANK_VERTEX_CUT_H_
+#define ANALYTICAL_ENGINE_APPS_PAGERANK_PAGERANK_VERTEX_CUT_H_
+
+#include "grape/grape.h"
+
+#include "apps/pagerank/pagerank_vertex_cut_context.h"
+#include "core/app/gather_apply/gather_apply_app_base.h"
+
+namespace gs {
+
+/**
+ * @brief PageRank as a gather-apply program over a vertex cut, for graphs of
+ * skewed degrees.
+ *
+ * The value of a vertex is its rank divided by its out degree, i.e. what it
+ * passes along each edge, or its rank if it is dangling. The ranks of the
+ * dangling vertices are spread over all vertices, as in PageRank.
+ *
+ * @tparam FRAG_T
+ */
+template <typename FRAG_T>
+class PageRankVertexCut
+    : public GatherApplyAppBase<PageRankVertexCut<FRAG_T>, FRAG_T,
+                                PageRankVertexCutContext<FRAG_T>> {
+ public:
+  INSTALL_PARALLEL_WORKER(PageRankVertexCut<FRAG_T>,
+                          PageRankVertexCutContext<FRAG_T>, FRAG_T)
+
+  using vertex_t = typename fragment_t::vertex_t;
+
+  double InitValue(const fragment_t& frag, context_t& ctx, vertex_t v) {
+    ctx.degree[v] = frag.GetOutgoingAdjList(v).Size();
+    return share(ctx, v, 1.0 / frag.GetTotalVerticesNum());
+  }
+
+  double Identity() const { return 0.0; }
+
+  void Merge(double& gathered, const double& value) const {
+    gathered += value;
+  }
+
+  double Aggregate(const fragment_t& frag, const context_t& ctx, vertex_t v,
+                   const double& value) const {
+    return ctx.degree[v] == 0 ? value : 0.0;
+  }
+
+  bool Apply(const fragment_t& frag, context_t& ctx, vertex_t v,
+             const double& gathered, double aggregated, double& value) {
+    double graph_vnum = frag.GetTotalVerticesNum();
+    double rank = (1.0 - ctx.delta) / graph_vnum +
+                  ctx.delta * (gathered + aggregated / graph_vnum);
+    value = share(ctx, v, rank);
+    return true;
+  }
+
+  double Result(const fragment_t& frag, const context_t& ctx, vertex_t v,
+                const double& value) const {
+    return ctx.degree[v] == 0 ? value : value * ctx.degree[v];
+  }
+
+ private:
+  double share(const context_t& ctx, vertex_t v, double rank) const {
+    return ctx.degree[v] == 0 ? rank : rank / ctx.degree[v];
+  }
+};
+
+}  // namespace gs
+
+#endif  // ANALYTICAL_ENGINE_APPS_PAGERANK_PAGERANK_VERTEX_CUT_H_
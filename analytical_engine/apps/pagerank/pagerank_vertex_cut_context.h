@@ -0,0 +1,49 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANALYTICAL_ENGINE_APPS_PAGERANK_PAGERANK_VERTEX_CUT_CONTEXT_H_
+#define ANALYTICAL_ENGINE_APPS_PAGERANK_PAGERANK_VERTEX_CUT_CONTEXT_H_
+
+#include <string>
+
+#include "grape/grape.h"
+
+#include "core/app/gather_apply/gather_apply_context.h"
+
+namespace gs {
+/**
+ * @brief Context for PageRank over a vertex cut.
+ *
+ * @tparam FRAG_T
+ */
+template <typename FRAG_T>
+class PageRankVertexCutContext : public GatherApplyContext<FRAG_T, double> {
+ public:
+  explicit PageRankVertexCutContext(const FRAG_T& fragment)
+      : GatherApplyContext<FRAG_T, double>(fragment) {}
+
+  void Init(grape::ParallelMessageManager& messages, double delta,
+            int max_round, const std::string& cut, int64_t hybrid_threshold) {
+    this->InitGatherApply(max_round, cut, hybrid_threshold);
+    this->delta = delta;
+    degree.Init(this->fragment().InnerVertices(), 0);
+  }
+
+  typename FRAG_T::template inner_vertex_array_t<int> degree;
+  double delta = 0;
+};
+}  // namespace gs
+
+#endif  // ANALYTICAL_ENGINE_APPS_PAGERANK_PAGERANK_VERTEX_CUT_CONTEXT_H_
@@ -25,6 +25,7 @@ limitations under the License.
 #include "grape/utils/iterator_pair.h"
 
 #include "core/app/app_base.h"
+#include "core/app/pregel/aggregators/aggregator_sync.h"
 #include "core/app/pregel/pregel_compute_context.h"
 
 #include "apps/pregel/louvain/auxiliary.h"
@@ -119,16 +120,7 @@ class LouvainAppBase
                                       ctx.GetLocalEdgeWeightSum());
       ctx.compute_context().aggregate(actual_quality_aggregator,
                                       ctx.GetLocalQualitySum());
-      for (auto& pair : ctx.compute_context().aggregators()) {
-        grape::InArchive iarc;
-        std::vector<grape::InArchive> oarcs;
-        std::string name = pair.first;
-        pair.second->Serialize(iarc);
-        pair.second->Reset();
-        AllGather(std::move(iarc), oarcs);
-        pair.second->DeserializeAndAggregate(oarcs);
-        pair.second->StartNewRound();
-      }
+      aggregator_sync_.Sync(ctx.compute_context().aggregators());
       ctx.ClearLocalAggregateValues(thrd_num);
     }
 
@@ -283,16 +275,7 @@ class LouvainAppBase
                                       ctx.GetLocalEdgeWeightSum());
       ctx.compute_context().aggregate(actual_quality_aggregator,
                                       ctx.GetLocalQualitySum());
-      for (auto& pair : ctx.compute_context().aggregators()) {
-        grape::InArchive iarc;
-        std::vector<grape::InArchive> oarcs;
-        std::string name = pair.first;
-        pair.second->Serialize(iarc);
-        pair.second->Reset();
-        AllGather(std::move(iarc), oarcs);
-        pair.second->DeserializeAndAggregate(oarcs);
-        pair.second->StartNewRound();
-      }
+      aggregator_sync_.Sync(ctx.compute_context().aggregators());
       ctx.ClearLocalAggregateValues(thrd_num);
     }
 
@@ -333,6 +316,7 @@ class LouvainAppBase
 
  private:
   vertex_program_t program_;
+  AggregatorSync aggregator_sync_;
 };
 }  // namespace gs
 
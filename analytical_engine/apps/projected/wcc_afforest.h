@@ -0,0 +1,309 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANALYTICAL_ENGINE_APPS_PROJECTED_WCC_AFFOREST_H_
+#define ANALYTICAL_ENGINE_APPS_PROJECTED_WCC_AFFOREST_H_
+
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "grape/grape.h"
+
+#include "core/app/app_base.h"
+
+namespace gs {
+
+template <typename FRAG_T>
+class WCCAfforestContext
+    : public grape::VertexDataContext<FRAG_T, typename FRAG_T::vid_t> {
+  using vid_t = typename FRAG_T::vid_t;
+
+ public:
+  explicit WCCAfforestContext(const FRAG_T& fragment)
+      : grape::VertexDataContext<FRAG_T, typename FRAG_T::vid_t>(fragment,
+                                                                 true),
+        comp_id(this->data()) {}
+
+  void Init(grape::ParallelMessageManager& messages) {
+    auto& frag = this->fragment();
+    auto vertices = frag.Vertices();
+
+    parent.Init(vertices);
+    label.Init(vertices, std::numeric_limits<vid_t>::max());
+  }
+
+  void Output(std::ostream& os) override {
+    auto& frag = this->fragment();
+    auto iv = frag.InnerVertices();
+
+    for (auto v : iv) {
+      os << frag.GetId(v) << " " << comp_id[v] << std::endl;
+    }
+  }
+
+  typename FRAG_T::template vertex_array_t<vid_t>& comp_id;
+  // the forest over the lids of all vertices, inner and outer
+  typename FRAG_T::template vertex_array_t<vid_t> parent;
+  // the smallest gid in the local component of a root
+  typename FRAG_T::template vertex_array_t<vid_t> label;
+};
+
+/**
+ * @brief WCC in the way of Afforest, which labels a component by the
+ * smallest gid in it, like wcc_projected, in two supersteps instead of a
+ * superstep per hop of the diameter.
+ *
+ * The local components are found by a concurrent union-find over all
+ * vertices of the fragment. The first kNeighborRounds neighbors of every
+ * inner vertex are linked, which is enough to join most of the giant
+ * component, whose root is then guessed from kSampleNum sampled vertices.
+ * Only the vertices outside it link their remaining neighbors, while those
+ * inside it only link their outer neighbors, as the edges to the other
+ * fragments are needed by the union across fragments.
+ *
+ * Every outer vertex then sends the label of its local component to its
+ * owner, which pairs it with the label of the local component of the
+ * inner vertex. These pairs, a few per pair of components touching over
+ * the boundary, are gathered by all fragments, and joined by a union-find
+ * over labels.
+ *
+ * @tparam FRAG_T
+ */
+template <typename FRAG_T>
+class WCCAfforest
+    : public grape::ParallelAppBase<FRAG_T, WCCAfforestContext<FRAG_T>>,
+      public grape::ParallelEngine,
+      public grape::Communicator {
+ public:
+  INSTALL_PARALLEL_WORKER(WCCAfforest<FRAG_T>, WCCAfforestContext<FRAG_T>,
+                          FRAG_T)
+  static constexpr grape::MessageStrategy message_strategy =
+      grape::MessageStrategy::kSyncOnOuterVertex;
+  static constexpr grape::LoadStrategy load_strategy =
+      grape::LoadStrategy::kBothOutIn;
+  using vertex_t = typename fragment_t::vertex_t;
+  using vid_t = typename fragment_t::vid_t;
+
+  static constexpr size_t kNeighborRounds = 2;
+  static constexpr size_t kSampleNum = 1024;
+
+  void PEval(const fragment_t& frag, context_t& ctx,
+             message_manager_t& messages) {
+    messages.InitChannels(thread_num());
+    auto inner_vertices = frag.InnerVertices();
+    auto vertices = frag.Vertices();
+
+    ForEach(vertices,
+            [&ctx](int tid, vertex_t v) { ctx.parent[v] = v.GetValue(); });
+
+    for (size_t r = 0; r < kNeighborRounds; ++r) {
+      ForEach(inner_vertices, [&frag, &ctx, r](int tid, vertex_t v) {
+        forEachNeighbor(frag, v, [&ctx, v, r](size_t k, vertex_t u) {
+          if (k == r) {
+            link(ctx, v.GetValue(), u.GetValue());
+          }
+          return k < r;
+        });
+      });
+      compress(ctx, vertices);
+    }
+
+    vid_t giant = 0;
+    bool has_giant = sampleGiant(frag, ctx, giant);
+    bool local_only = frag.fnum() == 1;
+    ForEach(inner_vertices, [&](int tid, vertex_t v) {
+      bool in_giant = has_giant && find(ctx, v.GetValue()) == giant;
+      if (in_giant && local_only) {
+        return;
+      }
+      forEachNeighbor(frag, v, [&](size_t k, vertex_t u) {
+        if (k >= kNeighborRounds && (!in_giant || frag.IsOuterVertex(u))) {
+          link(ctx, v.GetValue(), u.GetValue());
+        }
+        return true;
+      });
+    });
+    compress(ctx, vertices);
+
+    ForEach(vertices, [&frag, &ctx](int tid, vertex_t v) {
+      grape::atomic_min(ctx.label[vertex_t(ctx.parent[v])],
+                        frag.Vertex2Gid(v));
+    });
+    ForEach(inner_vertices, [&ctx](int tid, vertex_t v) {
+      ctx.comp_id[v] = ctx.label[vertex_t(ctx.parent[v])];
+    });
+    if (local_only) {
+      return;
+    }
+
+    // every fragment joins the union in IncEval, even without outer vertices
+    auto& channels = messages.Channels();
+    ForEach(frag.OuterVertices(), [&](int tid, vertex_t v) {
+      channels[tid].SyncStateOnOuterVertex(
+          frag, v, ctx.label[vertex_t(ctx.parent[v])]);
+    });
+    messages.ForceContinue();
+  }
+
+  void IncEval(const fragment_t& frag, context_t& ctx,
+               message_manager_t& messages) {
+    std::vector<std::vector<std::pair<vid_t, vid_t>>> buffers(thread_num());
+    messages.ParallelProcess<fragment_t, vid_t>(
+        thread_num(), frag,
+        [&ctx, &buffers](int tid, vertex_t v, vid_t remote) {
+          buffers[tid].emplace_back(ctx.comp_id[v], remote);
+        });
+    std::vector<std::pair<vid_t, vid_t>> joins;
+    for (auto& buffer : buffers) {
+      joins.insert(joins.end(), buffer.begin(), buffer.end());
+    }
+    std::sort(joins.begin(), joins.end());
+    joins.erase(std::unique(joins.begin(), joins.end()), joins.end());
+
+    std::vector<std::vector<std::pair<vid_t, vid_t>>> all_joins;
+    AllGather(joins, all_joins);
+
+    std::unordered_map<vid_t, vid_t> parent;
+    for (auto& part : all_joins) {
+      for (auto& join : part) {
+        vid_t a = find(parent, join.first), b = find(parent, join.second);
+        if (a != b) {
+          parent[std::max(a, b)] = std::min(a, b);
+        }
+      }
+    }
+    // lookups only, so the threads may share the map
+    for (auto& pair : parent) {
+      pair.second = find(parent, pair.first);
+    }
+    ForEach(frag.InnerVertices(), [&ctx, &parent](int tid, vertex_t v) {
+      auto iter = parent.find(ctx.comp_id[v]);
+      if (iter != parent.end()) {
+        ctx.comp_id[v] = iter->second;
+      }
+    });
+  }
+
+ private:
+  // calls func(k, u) on the k-th neighbor u of v, counting the outgoing
+  // edges, then the incoming ones of directed fragments, while it is true.
+  template <typename FUNC_T>
+  static void forEachNeighbor(const fragment_t& frag, vertex_t v,
+                              const FUNC_T& func) {
+    size_t k = 0;
+    for (auto& e : frag.GetOutgoingAdjList(v)) {
+      if (!func(k++, e.get_neighbor())) {
+        return;
+      }
+    }
+    if (frag.directed()) {
+      for (auto& e : frag.GetIncomingAdjList(v)) {
+        if (!func(k++, e.get_neighbor())) {
+          return;
+        }
+      }
+    }
+  }
+
+  static vid_t load(context_t& ctx, vid_t x) {
+    return __atomic_load_n(&ctx.parent[vertex_t(x)], __ATOMIC_RELAXED);
+  }
+
+  // hooks the higher root under the lower one, so a root is the smallest
+  // lid in its tree.
+  static void link(context_t& ctx, vid_t u, vid_t v) {
+    vid_t p1 = load(ctx, u), p2 = load(ctx, v);
+    while (p1 != p2) {
+      vid_t high = std::max(p1, p2), low = std::min(p1, p2);
+      vid_t p_high = load(ctx, high);
+      if (p_high == low ||
+          (p_high == high &&
+           __sync_bool_compare_and_swap(&ctx.parent[vertex_t(high)], high,
+                                        low))) {
+        return;
+      }
+      p1 = load(ctx, load(ctx, high));
+      p2 = load(ctx, low);
+    }
+  }
+
+  static vid_t find(context_t& ctx, vid_t x) {
+    vid_t p = load(ctx, x);
+    while (p != x) {
+      x = p;
+      p = load(ctx, x);
+    }
+    return x;
+  }
+
+  template <typename RANGE_T>
+  void compress(context_t& ctx, const RANGE_T& vertices) {
+    ForEach(vertices, [&ctx](int tid, vertex_t v) {
+      vid_t p = load(ctx, v.GetValue());
+      while (p != load(ctx, p)) {
+        p = load(ctx, p);
+      }
+      __atomic_store_n(&ctx.parent[v], p, __ATOMIC_RELAXED);
+    });
+  }
+
+  // the most frequent root among kSampleNum inner vertices.
+  bool sampleGiant(const fragment_t& frag, context_t& ctx, vid_t& giant) {
+    auto inner_vertices = frag.InnerVertices();
+    if (inner_vertices.size() == 0) {
+      return false;
+    }
+    std::mt19937 rng(frag.fid());
+    std::uniform_int_distribution<size_t> dist(0, inner_vertices.size() - 1);
+    std::unordered_map<vid_t, size_t> counts;
+    for (size_t i = 0; i < kSampleNum; ++i) {
+      vid_t lid = inner_vertices.begin_value() + dist(rng);
+      ++counts[find(ctx, lid)];
+    }
+    size_t most = 0;
+    for (auto& pair : counts) {
+      if (pair.second > most) {
+        most = pair.second;
+        giant = pair.first;
+      }
+    }
+    return true;
+  }
+
+  // the root of x, which is the minimum in its set.
+  static vid_t find(std::unordered_map<vid_t, vid_t>& parent, vid_t x) {
+    vid_t root = x;
+    auto iter = parent.find(root);
+    while (iter != parent.end() && iter->second != root) {
+      root = iter->second;
+      iter = parent.find(root);
+    }
+    // path compression
+    while (x != root) {
+      auto& p = parent[x];
+      x = p;
+      p = root;
+    }
+    return root;
+  }
+};
+
+}  // namespace gs
+
+#endif  // ANALYTICAL_ENGINE_APPS_PROJECTED_WCC_AFFOREST_H_
@@ -0,0 +1,263 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANALYTICAL_ENGINE_APPS_PROJECTED_WCC_INCREMENTAL_H_
+#define ANALYTICAL_ENGINE_APPS_PROJECTED_WCC_INCREMENTAL_H_
+
+#include <algorithm>
+#include <memory>
+#include <queue>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "grape/grape.h"
+
+#include "core/app/app_base.h"
+
+namespace gs {
+
+template <typename FRAG_T>
+class WCCIncrementalContext
+    : public grape::VertexDataContext<FRAG_T, typename FRAG_T::vid_t> {
+  using vid_t = typename FRAG_T::vid_t;
+
+ public:
+  explicit WCCIncrementalContext(const FRAG_T& fragment)
+      : grape::VertexDataContext<FRAG_T, typename FRAG_T::vid_t>(fragment,
+                                                                 true),
+        comp_id(this->data()) {}
+
+  void Init(grape::DefaultMessageManager& messages) {
+    auto& frag = this->fragment();
+    auto vertices = frag.Vertices();
+
+    modified.Init(vertices, false);
+  }
+
+  void Output(std::ostream& os) override {
+    auto& frag = this->fragment();
+    auto iv = frag.InnerVertices();
+
+    for (auto v : iv) {
+      os << frag.GetId(v) << " " << comp_id[v] << std::endl;
+    }
+  }
+
+  typename FRAG_T::template vertex_array_t<vid_t>& comp_id;
+  // outer vertices whose component id is to be sent
+  typename FRAG_T::template vertex_array_t<bool> modified;
+  bool repaired = false;
+};
+
+/**
+ * @brief Weakly connected components, labeled by the minimum gid in the
+ * component as WCCProjected, which are repaired from the components of the
+ * last run on the same graph instead of computed from scratch.
+ *
+ * When only edges or vertices are added since the last run, the added edges
+ * merge the components they connect: every fragment contributes the added
+ * edges and the kept labels of their inner endpoints, which are small, and
+ * the same union-find over them in all fragments maps the old labels to the
+ * new ones, without touching any other edge.
+ *
+ * Otherwise, e.g., some edge is removed, the components are computed from
+ * scratch, by label propagation that runs to the local fixpoint in each round.
+ * The result is kept in the DynamicFragment for the next run either way.
+ */
+template <typename FRAG_T>
+class WCCIncremental : public AppBase<FRAG_T, WCCIncrementalContext<FRAG_T>>,
+                       public grape::Communicator {
+ public:
+  INSTALL_DEFAULT_WORKER(WCCIncremental<FRAG_T>, WCCIncrementalContext<FRAG_T>,
+                         FRAG_T)
+  static constexpr grape::LoadStrategy load_strategy =
+      grape::LoadStrategy::kBothOutIn;
+  using vertex_t = typename fragment_t::vertex_t;
+  using vid_t = typename fragment_t::vid_t;
+
+  static constexpr const char* kResultKey = "wcc";
+
+  void PEval(const fragment_t& frag, context_t& ctx,
+             message_manager_t& messages) {
+    uint64_t version;
+    std::vector<std::pair<vid_t, vid_t>> added_edges;
+    auto kept = frag.GetDelta().template GetResult<vid_t>(kResultKey, version);
+    int local_repairable =
+        kept != nullptr && frag.GetDelta().AddedEdgesSince(version, added_edges);
+    int repairable = 0;
+    Min(local_repairable, repairable);
+    ctx.repaired = repairable != 0;
+
+    if (ctx.repaired) {
+      repair(frag, ctx, *kept, added_edges);
+      keepResult(frag, ctx);
+      return;
+    }
+
+    auto inner_vertices = frag.InnerVertices();
+    std::queue<vertex_t> queue;
+    for (auto v : inner_vertices) {
+      ctx.comp_id[v] = frag.GetInnerVertexGid(v);
+      queue.push(v);
+    }
+    for (auto v : frag.OuterVertices()) {
+      ctx.comp_id[v] = frag.GetOuterVertexGid(v);
+    }
+    propagate(frag, ctx, queue);
+    if (syncOuterVertices(frag, ctx, messages)) {
+      messages.ForceContinue();
+    } else {
+      keepResult(frag, ctx);
+    }
+  }
+
+  void IncEval(const fragment_t& frag, context_t& ctx,
+               message_manager_t& messages) {
+    std::queue<vertex_t> queue;
+    {
+      vertex_t v(0);
+      vid_t val;
+      while (messages.GetMessage<fragment_t, vid_t>(frag, v, val)) {
+        if (ctx.comp_id[v] > val) {
+          ctx.comp_id[v] = val;
+          queue.push(v);
+        }
+      }
+    }
+    propagate(frag, ctx, queue);
+    if (syncOuterVertices(frag, ctx, messages)) {
+      messages.ForceContinue();
+    } else {
+      keepResult(frag, ctx);
+    }
+  }
+
+ private:
+  void repair(const fragment_t& frag, context_t& ctx,
+              const std::vector<vid_t>& kept,
+              const std::vector<std::pair<vid_t, vid_t>>& added_edges) {
+    auto label = [&frag, &kept](vertex_t v) {
+      vid_t lid = v.GetValue();
+      return lid < kept.size() ? kept[lid] : frag.GetInnerVertexGid(v);
+    };
+
+    // an added edge joins its endpoints, and an inner endpoint joins its
+    // component.
+    std::vector<std::pair<vid_t, vid_t>> joins;
+    for (auto& e : added_edges) {
+      joins.push_back(e);
+      vertex_t v;
+      if (frag.InnerVertexGid2Vertex(e.first, v)) {
+        joins.emplace_back(label(v), e.first);
+      }
+      if (frag.InnerVertexGid2Vertex(e.second, v)) {
+        joins.emplace_back(label(v), e.second);
+      }
+    }
+    std::vector<std::vector<std::pair<vid_t, vid_t>>> all_joins;
+    AllGather(joins, all_joins);
+
+    std::unordered_map<vid_t, vid_t> parent;
+    for (auto& part : all_joins) {
+      for (auto& join : part) {
+        vid_t a = find(parent, join.first), b = find(parent, join.second);
+        if (a != b) {
+          parent[std::max(a, b)] = std::min(a, b);
+        }
+      }
+    }
+
+    for (auto v : frag.InnerVertices()) {
+      vid_t cid = label(v);
+      ctx.comp_id[v] = parent.count(cid) ? find(parent, cid) : cid;
+    }
+  }
+
+  // the root of x, which is the minimum in its set.
+  static vid_t find(std::unordered_map<vid_t, vid_t>& parent, vid_t x) {
+    vid_t root = x;
+    auto iter = parent.find(root);
+    while (iter != parent.end() && iter->second != root) {
+      root = iter->second;
+      iter = parent.find(root);
+    }
+    // path compression
+    while (x != root) {
+      auto& p = parent[x];
+      x = p;
+      p = root;
+    }
+    return root;
+  }
+
+  // propagate the minimum component ids from queue to the local fixpoint.
+  void propagate(const fragment_t& frag, context_t& ctx,
+                 std::queue<vertex_t>& queue) {
+    auto update = [&frag, &ctx, &queue](vertex_t u, vid_t cid) {
+      if (ctx.comp_id[u] > cid) {
+        ctx.comp_id[u] = cid;
+        if (frag.IsInnerVertex(u)) {
+          queue.push(u);
+        } else {
+          ctx.modified[u] = true;
+        }
+      }
+    };
+    while (!queue.empty()) {
+      vertex_t v = queue.front();
+      queue.pop();
+      auto cid = ctx.comp_id[v];
+      for (auto& e : frag.GetOutgoingAdjList(v)) {
+        update(e.get_neighbor(), cid);
+      }
+      if (frag.directed()) {
+        for (auto& e : frag.GetIncomingAdjList(v)) {
+          update(e.get_neighbor(), cid);
+        }
+      }
+    }
+  }
+
+  // returns whether any fragment sends component ids.
+  bool syncOuterVertices(const fragment_t& frag, context_t& ctx,
+                         message_manager_t& messages) {
+    size_t sent = 0;
+    for (auto v : frag.OuterVertices()) {
+      if (ctx.modified[v]) {
+        messages.SyncStateOnOuterVertex<fragment_t, vid_t>(frag, v,
+                                                           ctx.comp_id[v]);
+        ctx.modified[v] = false;
+        ++sent;
+      }
+    }
+    size_t total_sent = 0;
+    Sum(sent, total_sent);
+    return total_sent != 0;
+  }
+
+  void keepResult(const fragment_t& frag, context_t& ctx) {
+    auto inner_vertices = frag.InnerVertices();
+    std::vector<vid_t> labels(inner_vertices.size());
+    for (auto v : inner_vertices) {
+      labels[v.GetValue()] = ctx.comp_id[v];
+    }
+    frag.GetDelta().KeepResult(kResultKey, std::move(labels));
+    VLOG(1) << "Incremental WCC finished, repaired: " << ctx.repaired;
+  }
+};
+
+}  // namespace gs
+#endif  // ANALYTICAL_ENGINE_APPS_PROJECTED_WCC_INCREMENTAL_H_
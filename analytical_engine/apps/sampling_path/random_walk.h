@@ -0,0 +1,370 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef ANALYTICAL_ENGINE_APPS_SAMPLING_PATH_RANDOM_WALK_H_
+#define ANALYTICAL_ENGINE_APPS_SAMPLING_PATH_RANDOM_WALK_H_
+
+#include <algorithm>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "grape/grape.h"
+
+#include "apps/sampling_path/random_walk_context.h"
+
+#include "core/utils/trait_utils.h"
+
+namespace gs {
+
+/**
+ * @brief Random walks from every inner vertex, for DeepWalk or node2vec,
+ * output as a tensor with a walk of walk_length steps in each row.
+ *
+ * A step picks an out neighbor uniformly, or by the edge weights with an
+ * alias table built once per vertex. Walks of node2vec, i.e., p or q is not 1,
+ * sample a candidate the same way and accept it with its bias over the
+ * largest one, so that the second order needs no table per edge. Whether the
+ * candidate is a neighbor of the previous vertex is looked up in the sorted
+ * neighbors of either of them if it is an inner vertex, and asked of the
+ * fragment of the previous vertex otherwise, unless the draw is accepted or
+ * rejected by both answers.
+ *
+ * A walker keeps walking within a fragment, and is sent to the fragment of
+ * the next vertex once it leaves, so that the walkers crossing fragments in
+ * a round are batched by the message channels. Each fragment records the
+ * vertices walked through in it, and sends them to the fragment of the first
+ * vertex once all walks are done. A walk stopped by a vertex without out
+ * neighbors is padded with its last vertex.
+ * @tparam FRAG_T
+ */
+template <typename FRAG_T>
+class RandomWalk
+    : public grape::ParallelAppBase<FRAG_T, RandomWalkContext<FRAG_T>>,
+      public grape::ParallelEngine,
+      public grape::Communicator {
+ public:
+  INSTALL_PARALLEL_WORKER(RandomWalk<FRAG_T>, RandomWalkContext<FRAG_T>,
+                          FRAG_T)
+  static constexpr grape::MessageStrategy message_strategy =
+      grape::MessageStrategy::kSyncOnOuterVertex;
+  static constexpr grape::LoadStrategy load_strategy =
+      grape::LoadStrategy::kBothOutIn;
+  using vertex_t = typename fragment_t::vertex_t;
+  using vid_t = typename fragment_t::vid_t;
+  using oid_t = typename fragment_t::oid_t;
+  using edata_t = typename fragment_t::edata_t;
+  using walker_t = typename context_t::walker_t;
+  using channel_t = grape::ThreadLocalMessageBuffer<message_manager_t>;
+
+  void PEval(const fragment_t& frag, context_t& ctx,
+             message_manager_t& messages) {
+    auto inner_vertices = frag.InnerVertices();
+    messages.InitChannels(thread_num());
+    ctx.rngs.resize(thread_num());
+    for (int tid = 0; tid < thread_num(); ++tid) {
+      ctx.rngs[tid].state = static_cast<uint64_t>(ctx.seed) +
+                            frag.fid() * thread_num() + tid;
+      // skip the correlated first outputs of nearby seeds
+      ctx.rngs[tid].Next();
+    }
+    ctx.records.resize(thread_num());
+    ctx.sent_nums.assign(thread_num(), 0);
+    buildNeighbors(frag, ctx);
+
+    for (auto v : inner_vertices) {
+      ctx.first_row[v] = ctx.row_num;
+      ctx.row_num += ctx.walks_per_vertex;
+    }
+    ctx.paths.assign(ctx.row_num * (ctx.walk_length + 1),
+                     context_t::kNoVertex);
+
+    auto& channels = messages.Channels();
+    ForEach(inner_vertices,
+            [&frag, &ctx, &channels, this](int tid, vertex_t v) {
+              for (int i = 0; i < ctx.walks_per_vertex; ++i) {
+                walker_t w{};
+                w.row = ctx.first_row[v] + i;
+                w.prev = w.cur = frag.GetInnerVertexGid(v);
+                w.cand = context_t::kNoVertex;
+                w.step = 0;
+                w.home = frag.fid();
+                w.kind = walker_t::kWalk;
+                record(frag, ctx, tid, w);
+                walk(frag, ctx, channels[tid], tid, w, v);
+              }
+            });
+    finishRound(frag, ctx, messages);
+  }
+
+  void IncEval(const fragment_t& frag, context_t& ctx,
+               message_manager_t& messages) {
+    if (ctx.collecting) {
+      messages.ParallelProcess<walker_t>(
+          thread_num(), [&ctx](int tid, const walker_t& w) {
+            ctx.paths[w.row * (ctx.walk_length + 1) + w.step] = w.cur;
+          });
+      output(frag, ctx);
+      return;
+    }
+
+    auto& channels = messages.Channels();
+    messages.ParallelProcess<walker_t>(
+        thread_num(),
+        [&frag, &ctx, &channels, this](int tid, const walker_t& msg) {
+          walker_t w = msg;
+          vertex_t v;
+          if (w.kind == walker_t::kWalk) {
+            CHECK(frag.Gid2Vertex(w.cur, v));
+            record(frag, ctx, tid, w);
+            walk(frag, ctx, channels[tid], tid, w, v);
+          } else if (w.kind == walker_t::kQuery) {
+            vertex_t t, x;
+            CHECK(frag.Gid2Vertex(w.prev, t));
+            bool adjacent =
+                frag.Gid2Vertex(w.cand, x) && isNeighbor(ctx, t, x);
+            // between 1 / q and 1, the draw is accepted by a neighbor iff
+            // q > 1
+            w.accepted = adjacent == (ctx.q > 1);
+            w.kind = walker_t::kAnswer;
+            send(ctx, channels[tid], tid, w.src, w);
+          } else {
+            CHECK(frag.Gid2Vertex(w.cur, v));
+            w.kind = walker_t::kWalk;
+            if (w.accepted) {
+              vertex_t x;
+              CHECK(frag.Gid2Vertex(w.cand, x));
+              if (!moveTo(frag, ctx, channels[tid], tid, w, x)) {
+                return;
+              }
+              v = x;
+            }
+            walk(frag, ctx, channels[tid], tid, w, v);
+          }
+        });
+    finishRound(frag, ctx, messages);
+  }
+
+ private:
+  // Copy the out neighbors of inner vertices sorted, and build their alias
+  // tables of weights.
+  void buildNeighbors(const fragment_t& frag, context_t& ctx) {
+    auto inner_vertices = frag.InnerVertices();
+    size_t size = 0;
+    for (auto v : inner_vertices) {
+      ctx.nbr_begin[v] = size;
+      size += frag.GetLocalOutDegree(v);
+      ctx.nbr_end[v] = size;
+    }
+    ctx.nbrs.resize(size);
+    if (ctx.weighted) {
+      ctx.probs.resize(size);
+      ctx.aliases.resize(size);
+    }
+
+    ForEach(inner_vertices, [&frag, &ctx](int tid, vertex_t v) {
+      std::vector<std::pair<vid_t, double>> list;
+      list.reserve(ctx.nbr_end[v] - ctx.nbr_begin[v]);
+      for (auto& e : frag.GetOutgoingAdjList(v)) {
+        double weight = 1.0;
+        vineyard::static_if<!std::is_same<edata_t, grape::EmptyType>{}>(
+            [&](auto& e, auto& data) {
+              data = static_cast<double>(e.get_data());
+            })(e, weight);
+        list.emplace_back(e.get_neighbor().GetValue(), weight);
+      }
+      std::sort(list.begin(), list.end());
+      size_t begin = ctx.nbr_begin[v];
+      for (size_t i = 0; i < list.size(); ++i) {
+        ctx.nbrs[begin + i] = list[i].first;
+      }
+      if (ctx.weighted) {
+        buildAlias(list, ctx.probs.data() + begin,
+                   ctx.aliases.data() + begin);
+      }
+    });
+  }
+
+  // Vose's alias method.
+  static void buildAlias(const std::vector<std::pair<vid_t, double>>& list,
+                         float* probs, uint32_t* aliases) {
+    size_t degree = list.size();
+    double sum = 0;
+    for (auto& pair : list) {
+      sum += std::max(pair.second, 0.0);
+    }
+    std::vector<double> scaled(degree);
+    std::vector<uint32_t> small, large;
+    for (size_t i = 0; i < degree; ++i) {
+      scaled[i] = sum > 0 ? std::max(list[i].second, 0.0) * degree / sum : 1;
+      aliases[i] = i;
+      (scaled[i] < 1 ? small : large).push_back(i);
+    }
+    while (!small.empty() && !large.empty()) {
+      uint32_t s = small.back(), l = large.back();
+      small.pop_back();
+      probs[s] = scaled[s];
+      aliases[s] = l;
+      scaled[l] -= 1 - scaled[s];
+      if (scaled[l] < 1) {
+        large.pop_back();
+        small.push_back(l);
+      }
+    }
+    for (auto i : small) {
+      probs[i] = 1;
+    }
+    for (auto i : large) {
+      probs[i] = 1;
+    }
+  }
+
+  // Whether x is an out neighbor of the inner vertex t.
+  static bool isNeighbor(const context_t& ctx, vertex_t t, vertex_t x) {
+    return std::binary_search(ctx.nbrs.begin() + ctx.nbr_begin[t],
+                              ctx.nbrs.begin() + ctx.nbr_end[t], x.GetValue());
+  }
+
+  // An out neighbor of the inner vertex v by the first order.
+  static vertex_t sample(context_t& ctx, int tid, vertex_t v) {
+    auto& rng = ctx.rngs[tid];
+    size_t begin = ctx.nbr_begin[v];
+    size_t k = begin + rng.Below(ctx.nbr_end[v] - begin);
+    if (ctx.weighted && rng.Uniform() >= ctx.probs[k]) {
+      k = begin + ctx.aliases[k];
+    }
+    return vertex_t(ctx.nbrs[k]);
+  }
+
+  static void record(const fragment_t& frag, context_t& ctx, int tid,
+                     const walker_t& w) {
+    if (w.home == frag.fid()) {
+      ctx.paths[w.row * (ctx.walk_length + 1) + w.step] = w.cur;
+    } else {
+      walker_t rec = w;
+      rec.kind = walker_t::kRecord;
+      ctx.records[tid].push_back(rec);
+    }
+  }
+
+  static void send(context_t& ctx, channel_t& channel, int tid,
+                   grape::fid_t fid, const walker_t& w) {
+    channel.SendToFragment(fid, w);
+    ++ctx.sent_nums[tid];
+  }
+
+  // Step from the current vertex to its neighbor x, returns whether x is an
+  // inner vertex to keep walking from.
+  static bool moveTo(const fragment_t& frag, context_t& ctx,
+                     channel_t& channel, int tid, walker_t& w, vertex_t x) {
+    w.prev = w.cur;
+    w.cur = frag.Vertex2Gid(x);
+    ++w.step;
+    if (frag.IsOuterVertex(x)) {
+      send(ctx, channel, tid, frag.GetFragId(x), w);
+      return false;
+    }
+    record(frag, ctx, tid, w);
+    return true;
+  }
+
+  // Walk from the inner vertex v, which w has been recorded at, until the
+  // walk ends, leaves the fragment or waits for a query.
+  void walk(const fragment_t& frag, context_t& ctx, channel_t& channel,
+            int tid, walker_t& w, vertex_t v) {
+    auto& rng = ctx.rngs[tid];
+    while (w.step < static_cast<uint32_t>(ctx.walk_length) &&
+           ctx.nbr_end[v] != ctx.nbr_begin[v]) {
+      vertex_t x = sample(ctx, tid, v);
+      if (ctx.second_order && w.step > 0) {
+        double r = rng.Uniform() * ctx.max_bias;
+        vid_t x_gid = frag.Vertex2Gid(x);
+        if (x_gid == w.prev) {
+          if (r >= 1 / ctx.p) {
+            continue;
+          }
+        } else if (r >= std::max(1.0, 1 / ctx.q)) {
+          continue;
+        } else if (r >= std::min(1.0, 1 / ctx.q)) {
+          vertex_t t;
+          bool local = frag.Gid2Vertex(w.prev, t);
+          bool adjacent;
+          if (local && frag.IsInnerVertex(t)) {
+            adjacent = isNeighbor(ctx, t, x);
+          } else if (!frag.directed() && frag.IsInnerVertex(x)) {
+            adjacent = local && isNeighbor(ctx, x, t);
+          } else {
+            // the previous vertex is a neighbor by an incoming edge
+            CHECK(local);
+            w.cand = x_gid;
+            w.src = frag.fid();
+            w.kind = walker_t::kQuery;
+            send(ctx, channel, tid, frag.GetFragId(t), w);
+            return;
+          }
+          if (adjacent != (ctx.q > 1)) {
+            continue;
+          }
+        }
+      }
+      if (!moveTo(frag, ctx, channel, tid, w, x)) {
+        return;
+      }
+      v = x;
+    }
+  }
+
+  // Keep walking while any walker is on its way, then send the recorded
+  // vertices to the fragments of the walks.
+  void finishRound(const fragment_t& frag, context_t& ctx,
+                   message_manager_t& messages) {
+    size_t sent_num = 0, total_sent_num = 0;
+    for (auto& num : ctx.sent_nums) {
+      sent_num += num;
+      num = 0;
+    }
+    Sum(sent_num, total_sent_num);
+    if (total_sent_num == 0) {
+      ctx.collecting = true;
+      auto& channels = messages.Channels();
+      ForEach(
+          ctx.records.begin(), ctx.records.end(),
+          [&channels](int tid, std::vector<walker_t>& records) {
+            for (auto& rec : records) {
+              channels[tid].SendToFragment(rec.home, rec);
+            }
+            std::vector<walker_t>().swap(records);
+          },
+          1);
+    }
+    messages.ForceContinue();
+  }
+
+  void output(const fragment_t& frag, context_t& ctx) {
+    size_t width = ctx.walk_length + 1;
+    std::vector<oid_t> data(ctx.paths.size());
+    for (size_t i = 0; i < ctx.paths.size(); ++i) {
+      if (ctx.paths[i] == context_t::kNoVertex) {
+        ctx.paths[i] = ctx.paths[i - 1];
+      }
+      data[i] = frag.Gid2Oid(ctx.paths[i]);
+    }
+    ctx.assign(data, {static_cast<size_t>(ctx.row_num), width});
+  }
+};
+
+}  // namespace gs
+
+#endif  // ANALYTICAL_ENGINE_APPS_SAMPLING_PATH_RANDOM_WALK_H_
@@ -0,0 +1,165 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef ANALYTICAL_ENGINE_APPS_SAMPLING_PATH_RANDOM_WALK_CONTEXT_H_
+#define ANALYTICAL_ENGINE_APPS_SAMPLING_PATH_RANDOM_WALK_CONTEXT_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "grape/grape.h"
+
+#include "core/context/tensor_context.h"
+
+namespace gs {
+
+/**
+ * @brief A walker on its way, or a query or answer about one, or a vertex of
+ * a walk sent to the fragment of its first vertex.
+ */
+template <typename VID_T>
+struct RandomWalker {
+  enum Kind : uint8_t { kWalk, kQuery, kAnswer, kRecord };
+
+  // the row of the walk in the fragment of its first vertex
+  uint64_t row;
+  // gids of the previous and the current vertex, and of the candidate to be
+  // decided by a query
+  VID_T prev;
+  VID_T cur;
+  VID_T cand;
+  uint32_t step;
+  grape::fid_t home;
+  // the fragment of the current vertex, to answer a query
+  grape::fid_t src;
+  uint8_t kind;
+  uint8_t accepted;
+};
+
+// splitmix64, cheap enough to draw a few numbers per step
+struct WalkRng {
+  uint64_t state;
+
+  uint64_t Next() {
+    uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+  }
+
+  // in [0, n)
+  uint64_t Below(uint64_t n) {
+    return static_cast<uint64_t>(
+        (static_cast<unsigned __int128>(Next()) * n) >> 64);
+  }
+
+  // in [0, 1)
+  double Uniform() { return (Next() >> 11) * (1.0 / (1ULL << 53)); }
+};
+
+/**
+ * @brief Context for random walks, with the walks starting from the inner
+ * vertices as rows of a tensor.
+ *
+ * @tparam FRAG_T
+ */
+template <typename FRAG_T>
+class RandomWalkContext
+    : public TensorContext<FRAG_T, typename FRAG_T::oid_t> {
+ public:
+  using oid_t = typename FRAG_T::oid_t;
+  using vid_t = typename FRAG_T::vid_t;
+  using vertex_t = typename FRAG_T::vertex_t;
+  using walker_t = RandomWalker<vid_t>;
+
+  static constexpr vid_t kNoVertex = std::numeric_limits<vid_t>::max();
+
+  explicit RandomWalkContext(const FRAG_T& fragment)
+      : TensorContext<FRAG_T, oid_t>(fragment) {}
+
+  void Init(grape::ParallelMessageManager& messages, int walk_length,
+            int walks_per_vertex = 1, double p = 1.0, double q = 1.0,
+            bool weighted = false, int64_t seed = 0) {
+    auto& frag = this->fragment();
+    auto inner_vertices = frag.InnerVertices();
+
+    CHECK_GE(walk_length, 0);
+    CHECK_GT(walks_per_vertex, 0);
+    CHECK_GT(p, 0);
+    CHECK_GT(q, 0);
+    this->walk_length = walk_length;
+    this->walks_per_vertex = walks_per_vertex;
+    this->p = p;
+    this->q = q;
+    this->weighted = weighted;
+    this->seed = seed;
+    second_order = p != 1.0 || q != 1.0;
+    max_bias = std::max({1.0 / p, 1.0, 1.0 / q});
+    collecting = false;
+
+    nbr_begin.Init(inner_vertices, 0);
+    nbr_end.Init(inner_vertices, 0);
+    first_row.Init(inner_vertices, 0);
+  }
+
+  void Output(std::ostream& os) override {
+    auto& frag = this->fragment();
+    size_t width = walk_length + 1;
+
+    for (size_t i = 0; i < paths.size(); ++i) {
+      os << frag.Gid2Oid(paths[i]) << ((i + 1) % width == 0 ? '\n' : ' ');
+    }
+  }
+
+  int walk_length;
+  int walks_per_vertex;
+  // the return and in-out parameters of node2vec, which walks by the first
+  // order when both are 1
+  double p;
+  double q;
+  bool weighted;
+  int64_t seed;
+  bool second_order;
+  double max_bias;
+  // whether the walks are done, and their vertices are being collected
+  bool collecting;
+
+  // the out neighbors of an inner vertex, sorted by local id, are
+  // nbrs[nbr_begin[v], nbr_end[v]), with an alias table of their weights
+  typename FRAG_T::template inner_vertex_array_t<size_t> nbr_begin;
+  typename FRAG_T::template inner_vertex_array_t<size_t> nbr_end;
+  std::vector<vid_t> nbrs;
+  std::vector<float> probs;
+  std::vector<uint32_t> aliases;
+
+  // the row of the first walk from an inner vertex
+  typename FRAG_T::template inner_vertex_array_t<uint64_t> first_row;
+  uint64_t row_num = 0;
+  // gids of the walks from the inner vertices, by row and step
+  std::vector<vid_t> paths;
+  // vertices of walks from other fragments, by thread
+  std::vector<std::vector<walker_t>> records;
+  std::vector<WalkRng> rngs;
+  std::vector<size_t> sent_nums;
+};
+
+template <typename FRAG_T>
+constexpr typename FRAG_T::vid_t RandomWalkContext<FRAG_T>::kNoVertex;
+
+}  // namespace gs
+
+#endif  // ANALYTICAL_ENGINE_APPS_SAMPLING_PATH_RANDOM_WALK_CONTEXT_H_
@@ -16,7 +16,13 @@
 #ifndef ANALYTICAL_ENGINE_APPS_SIMPLE_PATH_ALL_SIMPLE_PATHS_H_
 #define ANALYTICAL_ENGINE_APPS_SIMPLE_PATH_ALL_SIMPLE_PATHS_H_
 
-#include <set>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
 #include <tuple>
 #include <utility>
 #include <vector>
@@ -30,7 +36,8 @@ namespace gs {
 
 template <typename FRAG_T>
 class AllSimplePaths : public AppBase<FRAG_T, AllSimplePathsContext<FRAG_T>>,
-                       public grape::Communicator {
+                       public grape::Communicator,
+                       public grape::ParallelEngine {
  public:
   INSTALL_DEFAULT_WORKER(AllSimplePaths<FRAG_T>, AllSimplePathsContext<FRAG_T>,
                          FRAG_T)
@@ -43,6 +50,8 @@ class AllSimplePaths : public AppBase<FRAG_T, AllSimplePathsContext<FRAG_T>>,
   using vertex_t = typename fragment_t::vertex_t;
   using vid_t = typename fragment_t::vid_t;
   using msg_t = typename std::tuple<enum MsgType, vid_t, vid_t>;
+  // entries of the buffer of found paths a thread flushes at a time
+  static constexpr size_t kChunkSize = size_t(1) << 16;
 
   void PEval(const fragment_t& frag, context_t& ctx,
              message_manager_t& messages) {
@@ -136,14 +145,13 @@ class AllSimplePaths : public AppBase<FRAG_T, AllSimplePathsContext<FRAG_T>>,
   bool bfs(vertex_t v, const fragment_t& frag, context_t& ctx,
            message_manager_t& messages, int depth) {
     bool ret = false;
-    std::set<vid_t> vertex_visit;
     vid_t gid = frag.Vertex2Gid(v);
     auto oes = frag.GetOutgoingAdjList(v);
     for (auto& e : oes) {
       vertex_t u = e.get_neighbor();
       vid_t u_gid = frag.Vertex2Gid(u);
-      if (vertex_visit.count(u_gid) == 0) {
-        vertex_visit.insert(u_gid);
+      if (ctx.seen_by[u] != v.GetValue()) {
+        ctx.seen_by[u] = v.GetValue();
         if (ctx.native_source == false) {
           MsgType msg_type = edge_map_msg;
           msg_t msg = std::make_tuple(msg_type, gid, u_gid);
@@ -172,17 +180,16 @@ class AllSimplePaths : public AppBase<FRAG_T, AllSimplePathsContext<FRAG_T>>,
   }
 
   void writeToCtx(const fragment_t& frag, context_t& ctx) {
-    std::vector<typename fragment_t::oid_t> data;
-    std::vector<bool> vertex_visited;
-    std::vector<vid_t> path;
-    vid_t source_gid;
-    vertex_visited.resize(frag.GetTotalVerticesNum());
-    frag.Oid2Gid(ctx.source_id, source_gid);
-    vid_t source_index = ctx.Gid2GlobalIndex(source_gid);
-    vertex_visited[source_index] = true;
-    path.push_back(source_gid);
-    generatePath(source_index, 0, path, vertex_visited, data, frag, ctx);
-    std::vector<size_t> shape{static_cast<size_t>(ctx.path_num),
+    enumeratePaths(frag, ctx);
+    std::vector<oid_t> data;
+    data.reserve(ctx.path_num * (ctx.cutoff + 1));
+    for (auto& chunk : ctx.path_chunks) {
+      for (auto gid : chunk) {
+        data.push_back(gid == context_t::kNoVertex ? oid_t(-1)
+                                                   : frag.Gid2Oid(gid));
+      }
+    }
+    std::vector<size_t> shape{ctx.path_num,
                               static_cast<size_t>(ctx.cutoff + 1)};
     if (ctx.path_num == 0) {
       data.push_back(oid_t(1));
@@ -192,80 +199,191 @@ class AllSimplePaths : public AppBase<FRAG_T, AllSimplePathsContext<FRAG_T>>,
     ctx.assign(data, shape);
   }
 
+  // A subtree of the search, the paths extending path by the out edges
+  // [begin, end) of its last vertex.
+  struct SearchTask {
+    std::vector<vid_t> path;
+    size_t begin;
+    size_t end;
+  };
+
   /**
-   * @brief generate all the path from edge_map
+   * @brief Enumerate the paths from the edge map in parallel, until the limit
+   * of paths is reached.
    *
-   * @param from
-   * @param depth dfs depth
-   * @param path vector contain current path
-   * @param path set to record whether the vertex is accessed
-   * @param data storage all paths
-   * @param frag
-   * @param ctx
+   * Each thread runs a DFS with an explicit stack and a bitset of the visited
+   * vertices. A thread donates the unexplored siblings of the shallowest
+   * vertex on its stack whenever some thread is idle, so that the search tree
+   * is split on demand. Found paths are buffered by threads and flushed into
+   * the context in chunks.
    */
-  void generatePath(int from, int depth, std::vector<vid_t>& path,
-                    std::vector<bool>& vertex_visited,
-                    std::vector<typename fragment_t::oid_t>& data,
-                    const fragment_t& frag, context_t& ctx) {
-    // if depth == cutoff-1, just check set::targets.
-    if (depth == (ctx.cutoff - 1)) {
-      typename std::set<vid_t>::iterator it;
-      for (it = ctx.targets.begin(); it != ctx.targets.end(); it++) {
-        auto t = *it;
-        vid_t to = ctx.Gid2GlobalIndex(t);
-        if (vertex_visited[to]) {
-          continue;
+  void enumeratePaths(const fragment_t& frag, context_t& ctx) {
+    vid_t n = ctx.simple_paths_edge_map.size();
+    std::vector<size_t> offsets(n + 1, 0);
+    for (vid_t i = 0; i < n; ++i) {
+      offsets[i + 1] = offsets[i] + ctx.simple_paths_edge_map[i].size();
+    }
+    std::vector<vid_t> neighbors(offsets[n]);
+    std::vector<vid_t> gids(n);
+    for (vid_t i = 0; i < n; ++i) {
+      auto& list = ctx.simple_paths_edge_map[i];
+      std::copy(list.begin(), list.end(), neighbors.begin() + offsets[i]);
+      std::vector<vid_t>().swap(list);
+      gids[i] = ctx.GlobalIndex2Gid(i);
+    }
+    size_t words = (static_cast<size_t>(n) + 63) / 64;
+    std::vector<uint64_t> targets(words, 0);
+    for (auto gid : ctx.targets) {
+      setBit(targets, ctx.Gid2GlobalIndex(gid));
+    }
+
+    vid_t source_gid;
+    frag.Oid2Gid(ctx.source_id, source_gid);
+    vid_t source = ctx.Gid2GlobalIndex(source_gid);
+    std::deque<SearchTask> pending;
+    pending.push_back(SearchTask{std::vector<vid_t>{source}, offsets[source],
+                                 offsets[source + 1]});
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::atomic<int> idle(0);
+    std::atomic<size_t> found(0);
+    std::atomic<bool> stop(false);
+    size_t width = ctx.cutoff + 1;
+    int thrd_num = thread_num();
+
+    auto next_task = [&](SearchTask& task) {
+      std::unique_lock<std::mutex> lock(mutex);
+      ++idle;
+      cv.wait(lock, [&]() {
+        return stop || !pending.empty() || idle == thrd_num;
+      });
+      if (stop || pending.empty()) {
+        // all threads are idle, no more tasks to come
+        cv.notify_all();
+        return false;
+      }
+      task = std::move(pending.front());
+      pending.pop_front();
+      --idle;
+      return true;
+    };
+
+    auto flush = [&](std::vector<vid_t>& buffer) {
+      if (!buffer.empty()) {
+        std::lock_guard<std::mutex> lock(mutex);
+        ctx.path_chunks.push_back(std::move(buffer));
+      }
+      buffer = std::vector<vid_t>();
+      buffer.reserve(std::max(kChunkSize, width));
+    };
+
+    auto emit = [&](std::vector<vid_t>& buffer, const std::vector<vid_t>& path,
+                    vid_t to) {
+      if (found.fetch_add(1) >= ctx.limit) {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+        cv.notify_all();
+        return;
+      }
+      for (auto v : path) {
+        buffer.push_back(gids[v]);
+      }
+      buffer.push_back(gids[to]);
+      buffer.resize(buffer.size() + width - path.size() - 1,
+                    context_t::kNoVertex);
+      if (buffer.size() >= kChunkSize) {
+        flush(buffer);
+      }
+    };
+
+    auto search = [&]() {
+      std::vector<uint64_t> visited(words, 0);
+      std::vector<vid_t> buffer;
+      buffer.reserve(std::max(kChunkSize, width));
+      // the unexplored out edges of path[base + k] are frames[k]
+      std::vector<std::pair<size_t, size_t>> frames;
+      SearchTask task;
+      while (next_task(task)) {
+        auto& path = task.path;
+        size_t base = path.size() - 1;
+        for (auto v : path) {
+          setBit(visited, v);
         }
-        if (std::find(ctx.simple_paths_edge_map[from].begin(),
-                      ctx.simple_paths_edge_map[from].end(),
-                      to) != ctx.simple_paths_edge_map[from].end()) {
-          int len_counter = 0;
-          for (auto gid : path) {
-            data.push_back(frag.Gid2Oid(gid));
-            len_counter++;
+        frames.assign(1, std::make_pair(task.begin, task.end));
+        while (!frames.empty() && !stop.load(std::memory_order_relaxed)) {
+          auto& frame = frames.back();
+          if (frame.first == frame.second) {
+            clearBit(visited, path.back());
+            path.pop_back();
+            frames.pop_back();
+            continue;
+          }
+          vid_t to = neighbors[frame.first++];
+          if (testBit(visited, to)) {
+            continue;
+          }
+          if (testBit(targets, to)) {
+            emit(buffer, path, to);
           }
-          data.push_back(frag.Gid2Oid(t));
-          len_counter++;
-          // fill path to cutoff with -1
-          while (len_counter != ctx.cutoff + 1) {
-            data.push_back(oid_t(-1));
-            len_counter++;
+          if (path.size() < static_cast<size_t>(ctx.cutoff)) {
+            setBit(visited, to);
+            path.push_back(to);
+            frames.emplace_back(offsets[to], offsets[to + 1]);
           }
-          ctx.path_num++;
+          if (idle.load(std::memory_order_relaxed) > 0) {
+            donate(path, base, frames, pending, mutex, cv);
+          }
+        }
+        for (auto v : path) {
+          clearBit(visited, v);
         }
       }
-      return;
+      flush(buffer);
+    };
+
+    std::vector<std::thread> threads;
+    for (int tid = 0; tid < thrd_num; ++tid) {
+      threads.emplace_back(search);
+    }
+    for (auto& thrd : threads) {
+      thrd.join();
     }
+    ctx.path_num = std::min(found.load(), ctx.limit);
+  }
 
-    for (uint64_t t = 0; t < ctx.simple_paths_edge_map[from].size(); t++) {
-      vid_t to = ctx.simple_paths_edge_map[from][t];
-      vid_t gid = ctx.GlobalIndex2Gid(to);
-      if (vertex_visited[to]) {
-        continue;
+  // Give the unexplored out edges of the shallowest vertex on the stack to
+  // the idle threads.
+  void donate(const std::vector<vid_t>& path, size_t base,
+              std::vector<std::pair<size_t, size_t>>& frames,
+              std::deque<SearchTask>& pending, std::mutex& mutex,
+              std::condition_variable& cv) {
+    for (size_t k = 0; k < frames.size(); ++k) {
+      auto& frame = frames[k];
+      if (frame.first < frame.second) {
+        SearchTask task{std::vector<vid_t>(path.begin(),
+                                           path.begin() + base + k + 1),
+                        frame.first, frame.second};
+        frame.second = frame.first;
+        std::lock_guard<std::mutex> lock(mutex);
+        pending.push_back(std::move(task));
+        cv.notify_one();
+        return;
       }
-      vertex_visited[to] = true;
-      if (ctx.targets.count(gid)) {
-        int len_counter = 0;
-        for (auto v : path) {
-          data.push_back(frag.Gid2Oid(v));
-          len_counter++;
-        }
-        data.push_back(frag.Gid2Oid(gid));
-        len_counter++;
-        // fill path length to cutoff with -1
-        while (len_counter != ctx.cutoff + 1) {
-          data.push_back(oid_t(-1));
-          len_counter++;
-        }
-        ctx.path_num++;
-      }
-      path.push_back(gid);
-      generatePath(to, depth + 1, path, vertex_visited, data, frag, ctx);
-      path.pop_back();
-      vertex_visited[to] = false;
     }
   }
 
+  static void setBit(std::vector<uint64_t>& bits, vid_t i) {
+    bits[i >> 6] |= uint64_t(1) << (i & 63);
+  }
+
+  static void clearBit(std::vector<uint64_t>& bits, vid_t i) {
+    bits[i >> 6] &= ~(uint64_t(1) << (i & 63));
+  }
+
+  static bool testBit(const std::vector<uint64_t>& bits, vid_t i) {
+    return (bits[i >> 6] >> (i & 63)) & 1;
+  }
+
   void reloadFragVertexNum(std::vector<vid_t>& frag_vertex_num) {
     vid_t sum = 0;
     for (vid_t i = 0; i < frag_vertex_num.size(); i++) {
@@ -274,6 +392,9 @@ class AllSimplePaths : public AppBase<FRAG_T, AllSimplePathsContext<FRAG_T>>,
     }
   }
 };
+
+template <typename FRAG_T>
+constexpr size_t AllSimplePaths<FRAG_T>::kChunkSize;
 }  // namespace gs
 
 #endif  // ANALYTICAL_ENGINE_APPS_SIMPLE_PATH_ALL_SIMPLE_PATHS_H_
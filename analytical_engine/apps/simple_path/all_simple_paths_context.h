@@ -17,6 +17,7 @@
 #define ANALYTICAL_ENGINE_APPS_SIMPLE_PATH_ALL_SIMPLE_PATHS_CONTEXT_H_
 
 #include <unistd.h>
+#include <cstdint>
 #include <limits>
 #include <queue>
 #include <set>
@@ -43,12 +44,18 @@ class AllSimplePathsContext
   explicit AllSimplePathsContext(const FRAG_T& fragment)
       : TensorContext<FRAG_T, typename FRAG_T::oid_t>(fragment) {}
 
+  /**
+   * @param limit The enumeration stops once limit paths are found, a negative
+   * limit means no limit.
+   */
   void Init(grape::DefaultMessageManager& messages, oid_t source_id,
             const std::string& targets_json,
-            int cutoff = std::numeric_limits<int>::max()) {
+            int cutoff = std::numeric_limits<int>::max(), int64_t limit = -1) {
     auto& frag = this->fragment();
     auto vertices = frag.Vertices();
     this->source_id = source_id;
+    this->limit = limit < 0 ? std::numeric_limits<size_t>::max()
+                            : static_cast<size_t>(limit);
     this->id_mask = frag.id_mask();
     this->fid_offset = frag.fid_offset();
 
@@ -68,6 +75,7 @@ class AllSimplePathsContext
     }
 
     visited.Init(vertices, false);
+    seen_by.Init(vertices, kNoVertex);
     vertex_t source;
     native_source = frag.GetInnerVertex(source_id, source);
     if (native_source) {
@@ -78,15 +86,14 @@ class AllSimplePathsContext
 
   void Output(std::ostream& os) override {
     auto& frag = this->fragment();
-    vertex_t source;
-    std::vector<vid_t> path;
-    if (native_source) {
-      std::vector<bool> vertex_visited;
-      vid_t source_gid = frag.Vertex2Gid(source);
-      path.push_back(source_gid);
-      vid_t source_index = Gid2GlobalIndex(source_gid);
-      vertex_visited[source_index] = true;
-      printResult(source_index, 0, path, vertex_visited, os);
+    size_t width = cutoff + 1;
+    for (auto& chunk : path_chunks) {
+      for (size_t i = 0; i < chunk.size(); i += width) {
+        for (size_t j = i; j < i + width && chunk[j] != kNoVertex; ++j) {
+          os << frag.Gid2Oid(chunk[j]) << " ";
+        }
+        os << std::endl;
+      }
     }
   }
 
@@ -124,64 +131,33 @@ class AllSimplePathsContext
     return (i << fid_offset) | lid;
   }
 
+  // pads a path to cutoff + 1 vertices
+  static constexpr vid_t kNoVertex = std::numeric_limits<vid_t>::max();
+
   oid_t source_id;
   std::queue<std::pair<vid_t, int>> curr_level_inner, next_level_inner;
   typename FRAG_T::template vertex_array_t<bool> visited;
+  // the last vertex reaching a vertex by an out edge, to skip parallel edges
+  typename FRAG_T::template vertex_array_t<vid_t> seen_by;
   std::set<vid_t> targets;
   std::vector<vid_t> frag_vertex_num;
   int cutoff;
+  size_t limit;
   bool native_source = false;
   fid_t source_fid;
   vid_t id_mask;
   int fid_offset;
   std::vector<std::vector<vid_t>> simple_paths_edge_map;
   int frag_finish_counter = 0;
-  int path_num = 0;
-
- private:
-  void printResult(int from, int depth, std::vector<vid_t>& path,
-                   std::vector<bool>& vertex_visited, std::ostream& os) {
-    auto& frag = this->fragment();
-    if (depth == (this->cutoff - 1)) {
-      typename std::set<vid_t>::iterator it;
-      for (it = targets.begin(); it != targets.end(); it++) {
-        auto t = *it;
-        vid_t to = Gid2GlobalIndex(t);
-        if (vertex_visited[to]) {
-          continue;
-        }
-        if (std::find(simple_paths_edge_map[from].begin(),
-                      simple_paths_edge_map[from].end(),
-                      to) != simple_paths_edge_map[from].end()) {
-          for (auto gid : path) {
-            os << frag.Gid2Oid(gid) << " ";
-          }
-          os << frag.Gid2Oid(t) << " " << std::endl;
-        }
-      }
-      return;
-    }
-
-    for (uint64_t t = 0; t < simple_paths_edge_map[from].size(); t++) {
-      vid_t to = simple_paths_edge_map[from][t];
-      vid_t gid = GlobalIndex2Gid(to);
-      if (vertex_visited[to]) {
-        continue;
-      }
-      vertex_visited[to] = true;
-      if (targets.count(gid)) {
-        for (auto v : path) {
-          os << frag.Gid2Oid(v) << " ";
-        }
-        os << frag.Gid2Oid(gid) << " " << std::endl;
-      }
-      path.push_back(gid);
-      printResult(to, depth + 1, path, vertex_visited, os);
-      path.pop_back();
-      vertex_visited[to] = false;
-    }
-  }
+  // gids of the found paths, cutoff + 1 per path, flushed by the enumerating
+  // threads in chunks
+  std::vector<std::vector<vid_t>> path_chunks;
+  size_t path_num = 0;
 };
+
+template <typename FRAG_T>
+constexpr typename AllSimplePathsContext<FRAG_T>::vid_t
+    AllSimplePathsContext<FRAG_T>::kNoVertex;
 }  // namespace gs
 
 #endif  // ANALYTICAL_ENGINE_APPS_SIMPLE_PATH_ALL_SIMPLE_PATHS_CONTEXT_H_
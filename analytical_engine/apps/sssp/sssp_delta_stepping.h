@@ -0,0 +1,204 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef ANALYTICAL_ENGINE_APPS_SSSP_SSSP_DELTA_STEPPING_H_
+#define ANALYTICAL_ENGINE_APPS_SSSP_SSSP_DELTA_STEPPING_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+#include "grape/grape.h"
+
+#include "apps/sssp/sssp_delta_stepping_context.h"
+
+#include "core/utils/trait_utils.h"
+
+namespace gs {
+
+/**
+ * @brief Delta-stepping single source shortest path.
+ *
+ * Vertices are kept in buckets of width delta by their distance, and buckets
+ * are settled in order. Within the current bucket, light edges (weight <=
+ * delta) are relaxed by all threads until no vertex of the fragment falls
+ * into the bucket, and the updates of outer vertices are synchronized at the
+ * end of each round. Once no fragment has updated any vertex, heavy edges of
+ * the vertices settled in the bucket are relaxed once, and all fragments agree
+ * on the next non-empty bucket.
+ *
+ * Compared to the Bellman-Ford style rounds of sssp_projected, a round only
+ * covers a bucket, so that graphs with large diameters, e.g., road networks,
+ * converge in far fewer rounds.
+ * @tparam FRAG_T
+ */
+template <typename FRAG_T>
+class SSSPDeltaStepping
+    : public grape::ParallelAppBase<FRAG_T, SSSPDeltaSteppingContext<FRAG_T>>,
+      public grape::ParallelEngine,
+      public grape::Communicator {
+ public:
+  INSTALL_PARALLEL_WORKER(SSSPDeltaStepping<FRAG_T>,
+                          SSSPDeltaSteppingContext<FRAG_T>, FRAG_T)
+  static constexpr grape::MessageStrategy message_strategy =
+      grape::MessageStrategy::kSyncOnOuterVertex;
+  static constexpr grape::LoadStrategy load_strategy =
+      grape::LoadStrategy::kOnlyOut;
+  using vertex_t = typename fragment_t::vertex_t;
+  using edata_t = typename fragment_t::edata_t;
+
+  void PEval(const fragment_t& frag, context_t& ctx,
+             message_manager_t& messages) {
+    messages.InitChannels(thread_num());
+
+    if (ctx.delta <= 0) {
+      double weight_sum = 0, edge_num = 0;
+      for (auto v : frag.InnerVertices()) {
+        for (auto& e : frag.GetOutgoingAdjList(v)) {
+          weight_sum += weight(e);
+          edge_num += 1;
+        }
+      }
+      double total_weight_sum = 0, total_edge_num = 0;
+      Sum(weight_sum, total_weight_sum);
+      Sum(edge_num, total_edge_num);
+      ctx.delta = total_edge_num > 0 && total_weight_sum > 0
+                      ? 2 * total_weight_sum / total_edge_num
+                      : 1.0;
+    }
+
+    vertex_t source;
+    if (frag.GetInnerVertex(ctx.source_id, source)) {
+      ctx.partial_result[source] = 0.0;
+      ctx.active.Insert(source);
+    }
+    messages.ForceContinue();
+  }
+
+  void IncEval(const fragment_t& frag, context_t& ctx,
+               message_manager_t& messages) {
+    messages.ParallelProcess<fragment_t, double>(
+        thread_num(), frag, [&ctx](int tid, vertex_t u, double msg) {
+          if (msg < ctx.partial_result[u]) {
+            grape::atomic_min(ctx.partial_result[u], msg);
+            ctx.active.Insert(u);
+          }
+        });
+
+    if (ctx.next_bucket) {
+      int64_t local_min = std::numeric_limits<int64_t>::max();
+      for (auto v : frag.InnerVertices()) {
+        if (ctx.active.Exist(v)) {
+          local_min = std::min(local_min, bucketOf(ctx, v));
+        }
+      }
+      int64_t global_min = local_min;
+      Min(local_min, global_min);
+      if (global_min == std::numeric_limits<int64_t>::max()) {
+        LOG(INFO) << "Delta-stepping SSSP with delta = " << ctx.delta
+                  << " finished after " << ctx.bucket_num << " buckets";
+        return;
+      }
+      ctx.curr_bucket = global_min;
+      ctx.next_bucket = false;
+      ++ctx.bucket_num;
+    }
+
+    // relax light edges of the current bucket until it is empty locally.
+    while (true) {
+      ctx.frontier.Clear();
+      ForEach(ctx.active, [&ctx, this](int tid, vertex_t v) {
+        if (bucketOf(ctx, v) == ctx.curr_bucket) {
+          ctx.active.Erase(v);
+          ctx.frontier.Insert(v);
+        }
+      });
+      if (ctx.frontier.Empty()) {
+        break;
+      }
+      ForEach(ctx.frontier, [&frag, &ctx, this](int tid, vertex_t v) {
+        ctx.settled.Insert(v);
+        relax(frag, ctx, v, true);
+      });
+    }
+
+    size_t updated_num = syncOuterVertices(frag, ctx, messages);
+    size_t total_updated_num = 0;
+    Sum(updated_num, total_updated_num);
+    if (total_updated_num == 0) {
+      // the bucket is done in all fragments, relax the heavy edges once.
+      ForEach(ctx.settled, [&frag, &ctx, this](int tid, vertex_t v) {
+        relax(frag, ctx, v, false);
+      });
+      ctx.settled.Clear();
+      syncOuterVertices(frag, ctx, messages);
+      ctx.next_bucket = true;
+    }
+    messages.ForceContinue();
+  }
+
+ private:
+  int64_t bucketOf(const context_t& ctx, vertex_t v) const {
+    return static_cast<int64_t>(ctx.partial_result[v] / ctx.delta);
+  }
+
+  void relax(const fragment_t& frag, context_t& ctx, vertex_t v, bool light) {
+    double distv = ctx.partial_result[v];
+    for (auto& e : frag.GetOutgoingAdjList(v)) {
+      double w = weight(e);
+      if ((w <= ctx.delta) != light) {
+        continue;
+      }
+      vertex_t u = e.get_neighbor();
+      double ndistu = distv + w;
+      if (ndistu < ctx.partial_result[u]) {
+        grape::atomic_min(ctx.partial_result[u], ndistu);
+        if (frag.IsInnerVertex(u)) {
+          ctx.active.Insert(u);
+        } else {
+          ctx.updated.Insert(u);
+        }
+      }
+    }
+  }
+
+  size_t syncOuterVertices(const fragment_t& frag, context_t& ctx,
+                           message_manager_t& messages) {
+    auto& channels = messages.Channels();
+    size_t updated_num = ctx.updated.Count();
+    ForEach(ctx.updated, frag.OuterVertices(),
+            [&channels, &frag, &ctx](int tid, vertex_t v) {
+              channels[tid].SyncStateOnOuterVertex<fragment_t, double>(
+                  frag, v, ctx.partial_result[v]);
+            });
+    ctx.updated.Clear();
+    return updated_num;
+  }
+
+  template <typename EDGE_T>
+  static double weight(const EDGE_T& e) {
+    double edata = 1.0;
+    vineyard::static_if<!std::is_same<edata_t, grape::EmptyType>{}>(
+        [&](auto& e, auto& data) {
+          data = static_cast<double>(e.get_data());
+        })(e, edata);
+    return edata;
+  }
+};
+
+}  // namespace gs
+
+#endif  // ANALYTICAL_ENGINE_APPS_SSSP_SSSP_DELTA_STEPPING_H_
@@ -0,0 +1,90 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef ANALYTICAL_ENGINE_APPS_SSSP_SSSP_DELTA_STEPPING_CONTEXT_H_
+#define ANALYTICAL_ENGINE_APPS_SSSP_SSSP_DELTA_STEPPING_CONTEXT_H_
+
+#include <cstdint>
+#include <limits>
+
+#include "grape/grape.h"
+
+namespace gs {
+
+template <typename FRAG_T>
+class SSSPDeltaSteppingContext
+    : public grape::VertexDataContext<FRAG_T, double> {
+ public:
+  using oid_t = typename FRAG_T::oid_t;
+  using vid_t = typename FRAG_T::vid_t;
+  using vertex_t = typename FRAG_T::vertex_t;
+
+  explicit SSSPDeltaSteppingContext(const FRAG_T& fragment)
+      : grape::VertexDataContext<FRAG_T, double>(fragment, true),
+        partial_result(this->data()) {}
+
+  /**
+   * @param delta_ The width of buckets, a non-positive value picks twice the
+   * average edge weight.
+   */
+  void Init(grape::ParallelMessageManager& messages, oid_t source_id_,
+            double delta_ = 0) {
+    auto& frag = this->fragment();
+    auto inner_vertices = frag.InnerVertices();
+
+    source_id = source_id_;
+    delta = delta_;
+    curr_bucket = 0;
+    bucket_num = 0;
+    next_bucket = true;
+    partial_result.SetValue(std::numeric_limits<double>::max());
+
+    active.Init(inner_vertices);
+    frontier.Init(inner_vertices);
+    settled.Init(inner_vertices);
+    updated.Init(frag.Vertices());
+  }
+
+  void Output(std::ostream& os) override {
+    auto& frag = this->fragment();
+    auto inner_vertices = frag.InnerVertices();
+
+    for (auto v : inner_vertices) {
+      os << frag.GetId(v) << "\t" << partial_result[v] << std::endl;
+    }
+  }
+
+  oid_t source_id;
+  double delta;
+  int64_t curr_bucket;
+  int64_t bucket_num;
+  // whether the current bucket is done, and the next one is to be chosen.
+  bool next_bucket;
+
+  typename FRAG_T::template vertex_array_t<double>& partial_result;
+  // inner vertices whose distance is not relaxed yet
+  grape::DenseVertexSet<typename FRAG_T::inner_vertices_t> active;
+  grape::DenseVertexSet<typename FRAG_T::inner_vertices_t> frontier;
+  // inner vertices removed from the current bucket, whose heavy edges are
+  // relaxed once the bucket is done
+  grape::DenseVertexSet<typename FRAG_T::inner_vertices_t> settled;
+  // vertices updated since the last synchronization, only the outer ones are
+  // sent
+  grape::DenseVertexSet<typename FRAG_T::vertices_t> updated;
+};
+
+}  // namespace gs
+
+#endif  // ANALYTICAL_ENGINE_APPS_SSSP_SSSP_DELTA_STEPPING_CONTEXT_H_
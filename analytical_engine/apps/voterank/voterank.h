@@ -34,6 +34,12 @@ namespace gs {
  * parallel with the evaluation process. This strategy improves performance by
  * overlapping the communication time and the evaluation time.
  *
+ * Each fragment keeps the scores of its unranked vertices in a lazy max-heap.
+ * A round only recomputes the scores of the vertices next to a weakened one
+ * and pushes them, leaving the old entries to be dropped when they surface,
+ * so picking a spreader no longer scans all vertices. The tops of the
+ * fragments are then reduced to the global one.
+ *
  * @tparam FRAG_T
  */
 
@@ -75,6 +81,7 @@ class VoteRank : public grape::ParallelAppBase<FRAG_T, VoteRankContext<FRAG_T>>,
               ctx.rank[u] = 0;
               ctx.weight[u] = 1.0;
               ctx.scores[u] = 0.0;
+              ctx.id_hash[u] = std::hash<oid_t>()(frag.GetId(u));
               ctx.update.Insert(u);
               messages.SendMsgThroughIEdges<fragment_t, double>(
                   frag, u, ctx.weight[u], tid);
@@ -102,7 +109,6 @@ class VoteRank : public grape::ParallelAppBase<FRAG_T, VoteRankContext<FRAG_T>>,
 
   void IncEval(const fragment_t& frag, context_t& ctx,
                message_manager_t& messages) {
-    auto inner_vertices = frag.InnerVertices();
     ++ctx.step;
     if (ctx.step > ctx.num_of_nodes) {
       return;
@@ -146,32 +152,29 @@ class VoteRank : public grape::ParallelAppBase<FRAG_T, VoteRankContext<FRAG_T>>,
     };
 
     //  pull weights from neighbors and compute new scores
-    std::vector<std::tuple<double, size_t, vid_t>> max_scores(thread_num(),
-                                                              {0, 0, {}});
-    ForEach(inner_vertices,
-            [&ctx, compare, &max_scores, &frag](int tid, vertex_t u) {
-              if (ctx.update.Exist(u) && ctx.rank[u] == 0) {
-                double cur = 0;
-                auto es = frag.GetOutgoingAdjList(u);
-                for (auto& e : es) {
-                  cur += ctx.weight[e.get_neighbor()];
-                }
-                ctx.scores[u] = cur;
-              }
-              compare(max_scores[tid],
-                      {ctx.scores[u], std::hash<oid_t>()(frag.GetId(u)),
-                       frag.Vertex2Gid(u)});
-            });
+    std::vector<std::vector<heap_entry_t>> pushed(thread_num());
+    ForEach(ctx.update, [&ctx, &pushed, &frag](int tid, vertex_t u) {
+      if (ctx.rank[u] != 0) {
+        return;
+      }
+      double cur = 0;
+      auto es = frag.GetOutgoingAdjList(u);
+      for (auto& e : es) {
+        cur += ctx.weight[e.get_neighbor()];
+      }
+      ctx.scores[u] = cur;
+      pushed[tid].push_back({cur, ctx.id_hash[u], frag.Vertex2Gid(u), u,
+                             ++ctx.version[u]});
+    });
 
     ctx.update.Clear();
+    pushHeap(frag, ctx, pushed);
+    compare(ctx.max_score, heapTop(ctx, compare));
 
 #ifdef PROFILING
     ctx.exec_time += GetCurrentTime();
     ctx.postprocess_time -= GetCurrentTime();
 #endif
-    for (auto& a : max_scores) {
-      compare(ctx.max_score, a);
-    }
     auto max_score = ctx.max_score;
     // select top node
     AllReduce(max_score, ctx.max_score, compare);
@@ -224,6 +227,81 @@ class VoteRank : public grape::ParallelAppBase<FRAG_T, VoteRankContext<FRAG_T>>,
 #endif
     messages.ForceContinue();
   }
+
+ private:
+  using heap_entry_t = typename context_t::HeapEntry;
+
+  bool isStale(const context_t& ctx, const heap_entry_t& entry) const {
+    return ctx.rank[entry.v] != 0 || ctx.version[entry.v] != entry.version;
+  }
+
+  void pushHeap(const fragment_t& frag, context_t& ctx,
+                std::vector<std::vector<heap_entry_t>>& pushed) {
+    auto& heap = ctx.heap;
+    size_t pushed_num = 0;
+    for (auto& entries : pushed) {
+      pushed_num += entries.size();
+    }
+    // rebuilding is linear, cheaper than pushing one by one when most of the
+    // heap is new, e.g., in the first round
+    bool rebuild = pushed_num > heap.size() / 4;
+    for (auto& entries : pushed) {
+      for (auto& entry : entries) {
+        heap.push_back(entry);
+        if (!rebuild) {
+          std::push_heap(heap.begin(), heap.end());
+        }
+      }
+    }
+    // drop the stale entries once they outnumber the vertices
+    if (heap.size() > 2 * static_cast<size_t>(frag.GetInnerVerticesNum())) {
+      heap.erase(std::remove_if(heap.begin(), heap.end(),
+                                [&ctx, this](const heap_entry_t& entry) {
+                                  return isStale(ctx, entry);
+                                }),
+                 heap.end());
+      rebuild = true;
+    }
+    if (rebuild) {
+      std::make_heap(heap.begin(), heap.end());
+    }
+  }
+
+  /**
+   * @brief The best unranked vertex of this fragment by the comparison across
+   * fragments, which takes scores within EPS as equal and prefers the smaller
+   * hash among them. The heap orders exactly, so the entries within EPS of
+   * the top are popped to compare them and pushed back.
+   */
+  template <typename COMPARE_T>
+  std::tuple<double, size_t, vid_t> heapTop(context_t& ctx,
+                                            const COMPARE_T& compare) {
+    const double EPS = 1e-8;
+    auto& heap = ctx.heap;
+    std::tuple<double, size_t, vid_t> top{0.0, 0, {}};
+    std::vector<heap_entry_t> candidates;
+    while (!heap.empty()) {
+      std::pop_heap(heap.begin(), heap.end());
+      auto entry = heap.back();
+      heap.pop_back();
+      if (isStale(ctx, entry)) {
+        continue;
+      }
+      if (!candidates.empty() &&
+          entry.score <= candidates.front().score - EPS) {
+        heap.push_back(entry);
+        std::push_heap(heap.begin(), heap.end());
+        break;
+      }
+      candidates.push_back(entry);
+    }
+    for (auto& entry : candidates) {
+      compare(top, std::make_tuple(entry.score, entry.id_hash, entry.gid));
+      heap.push_back(entry);
+      std::push_heap(heap.begin(), heap.end());
+    }
+    return top;
+  }
 };
 
 }  // namespace gs
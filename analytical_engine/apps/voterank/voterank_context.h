@@ -18,6 +18,7 @@ limitations under the License.
 
 #include <iomanip>
 #include <tuple>
+#include <vector>
 
 #include "grape/grape.h"
 
@@ -30,8 +31,32 @@ namespace gs {
 template <typename FRAG_T>
 class VoteRankContext : public grape::VertexDataContext<FRAG_T, int> {
   using vid_t = typename FRAG_T::vid_t;
+  using vertex_t = typename FRAG_T::vertex_t;
 
  public:
+  /**
+   * @brief An entry of the score heap. It is stale once the vertex is ranked
+   * or its score recomputed, i.e., its version is not the vertex's.
+   */
+  struct HeapEntry {
+    double score;
+    size_t id_hash;
+    vid_t gid;
+    vertex_t v;
+    uint32_t version;
+
+    // orders the heap by descending score and ascending hash
+    bool operator<(const HeapEntry& rhs) const {
+      if (score != rhs.score) {
+        return score < rhs.score;
+      }
+      if (id_hash != rhs.id_hash) {
+        return id_hash > rhs.id_hash;
+      }
+      return gid > rhs.gid;
+    }
+  };
+
   explicit VoteRankContext(const FRAG_T& fragment)
       : grape::VertexDataContext<FRAG_T, int32_t>(fragment),
         rank(this->data()) {}
@@ -46,7 +71,10 @@ class VoteRankContext : public grape::VertexDataContext<FRAG_T, int> {
     }
     weight.Init(vertices);
     scores.Init(vertices);
+    id_hash.Init(inner_vertices);
+    version.Init(inner_vertices, 0);
     update.Init(inner_vertices);
+    heap.clear();
     step = 0;
     avg_degree = 0;
 
@@ -73,7 +101,11 @@ class VoteRankContext : public grape::VertexDataContext<FRAG_T, int> {
   typename FRAG_T::template vertex_array_t<int>& rank;
   typename FRAG_T::template vertex_array_t<double> weight;
   typename FRAG_T::template vertex_array_t<double> scores;
+  typename FRAG_T::template inner_vertex_array_t<size_t> id_hash;
+  typename FRAG_T::template inner_vertex_array_t<uint32_t> version;
   grape::DenseVertexSet<typename FRAG_T::inner_vertices_t> update;
+  // a lazy max-heap of the scores of the unranked inner vertices
+  std::vector<HeapEntry> heap;
 
 #ifdef PROFILING
   double preprocess_time = 0;
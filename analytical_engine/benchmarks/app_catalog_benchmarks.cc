@@ -0,0 +1,420 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <sys/stat.h>
+
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gflags/gflags.h"
+#include "glog/logging.h"
+
+#include "grape/grape.h"
+#include "grape/util.h"
+#include "vineyard/client/client.h"
+#include "vineyard/common/util/json.h"
+#include "vineyard/graph/fragment/arrow_fragment.h"
+
+#include "bfs/bfs.h"
+#include "cdlp/cdlp.h"
+#include "lcc/lcc.h"
+#include "pagerank/pagerank.h"
+#include "sssp/sssp.h"
+#include "wcc/wcc.h"
+
+#include "apps/centrality/closeness/closeness_centrality.h"
+#include "apps/centrality/degree/degree_centrality.h"
+#include "apps/centrality/eigenvector/eigenvector_centrality.h"
+#include "apps/centrality/katz/katz_centrality.h"
+#include "apps/clustering/avg_clustering.h"
+#include "apps/clustering/clustering.h"
+#include "apps/clustering/transitivity.h"
+#include "apps/clustering/triangles.h"
+#include "apps/flash/clustering/lpa.h"
+#include "apps/flash/connectivity/cc.h"
+#include "apps/flash/core/core.h"
+#include "apps/flash/ranking/pagerank.h"
+#include "apps/hits/hits.h"
+#include "apps/kcore/kcore.h"
+#include "apps/kshell/kshell.h"
+#include "apps/louvain/louvain.h"
+#include "apps/pagerank/pagerank_networkx.h"
+#include "apps/property/sssp_property.h"
+#include "apps/property/wcc_property.h"
+#include "core/fragment/arrow_projected_fragment.h"
+#include "core/loader/arrow_fragment_loader.h"
+
+DEFINE_string(ipc_socket, "/tmp/vineyard.sock", "vineyard IPC socket");
+DEFINE_string(dataset, "", "name of the dataset, recorded with the results");
+DEFINE_string(efile, "",
+              "edge file, e.g., the .e file of an LDBC Graphalytics dataset");
+DEFINE_string(vfile, "",
+              "vertex file, e.g., the .v file of an LDBC Graphalytics dataset");
+DEFINE_string(delimiter, " ", "delimiter of the vertex and edge files");
+DEFINE_bool(header_row, false, "whether the files start with a header row");
+DEFINE_bool(directed, true, "whether the graph is directed");
+DEFINE_bool(weighted, false,
+            "whether edges carry a double weight as their first property, "
+            "apps that need weights are skipped otherwise");
+DEFINE_string(apps, "", "comma separated apps to run, all apps if empty");
+DEFINE_int64(source, 0, "source vertex of traversals");
+DEFINE_int32(max_round, 10, "number of rounds of iterative apps");
+DEFINE_int32(k, 3, "k of kcore and kshell");
+DEFINE_int32(repeat, 1, "number of runs of each app");
+DEFINE_string(out_prefix, "",
+              "directory to export the results of apps to, no export if empty");
+DEFINE_string(result_file, "",
+              "file to append the timings to as JSON lines, stdout if empty");
+
+namespace bl = boost::leaf;
+
+using oid_t = vineyard::property_graph_types::OID_TYPE;
+using vid_t = vineyard::property_graph_types::VID_TYPE;
+
+using PropertyGraphType = vineyard::ArrowFragment<oid_t, vid_t>;
+using ProjectedGraphType =
+    gs::ArrowProjectedFragment<oid_t, vid_t, grape::EmptyType,
+                               grape::EmptyType>;
+using WeightedGraphType =
+    gs::ArrowProjectedFragment<oid_t, vid_t, grape::EmptyType, double>;
+
+/**
+ * @brief The timings of the phases of a benchmark, as one JSON line per
+ * phase. A phase is timed between barriers, i.e., by its slowest worker.
+ */
+class BenchmarkReport {
+ public:
+  explicit BenchmarkReport(const grape::CommSpec& comm_spec)
+      : comm_spec_(comm_spec),
+        thread_num_(grape::DefaultParallelEngineSpec().thread_num) {}
+
+  template <typename FUNC_T>
+  void Time(const std::string& app, const std::string& fragment,
+            const std::string& phase, const FUNC_T& func) {
+    MPI_Barrier(comm_spec_.comm());
+    double begin = grape::GetCurrentTime();
+    func();
+    MPI_Barrier(comm_spec_.comm());
+    double time = grape::GetCurrentTime() - begin;
+
+    if (comm_spec_.worker_id() != grape::kCoordinatorRank) {
+      return;
+    }
+    vineyard::json record = {{"dataset", FLAGS_dataset},
+                             {"app", app},
+                             {"fragment", fragment},
+                             {"phase", phase},
+                             {"time", time},
+                             {"workers", comm_spec_.worker_num()},
+                             {"threads", thread_num_}};
+    LOG(INFO) << app << " " << fragment << " " << phase << ": " << time << "s";
+    if (FLAGS_result_file.empty()) {
+      std::cout << record.dump() << std::endl;
+    } else {
+      std::ofstream ofs(FLAGS_result_file, std::ios::app);
+      ofs << record.dump() << std::endl;
+    }
+  }
+
+ private:
+  const grape::CommSpec& comm_spec_;
+  uint32_t thread_num_;
+};
+
+template <typename APP_T, typename FRAG_T, typename... Args>
+void RunApp(BenchmarkReport& report, const std::string& name,
+            const std::string& frag_name, std::shared_ptr<FRAG_T> fragment,
+            const grape::CommSpec& comm_spec, Args... args) {
+  auto app = std::make_shared<APP_T>();
+  auto worker = APP_T::CreateWorker(app, fragment);
+  worker->Init(comm_spec, grape::DefaultParallelEngineSpec());
+  for (int i = 0; i < FLAGS_repeat; ++i) {
+    report.Time(name, frag_name, "run", [&]() { worker->Query(args...); });
+  }
+
+  if (!FLAGS_out_prefix.empty()) {
+    report.Time(name, frag_name, "export", [&]() {
+      std::string prefix = FLAGS_out_prefix + "/" + name;
+      mkdir(FLAGS_out_prefix.c_str(), 0777);
+      mkdir(prefix.c_str(), 0777);
+      std::ofstream ostream(grape::GetResultFilename(prefix, fragment->fid()));
+      worker->GetContext()->Output(ostream);
+    });
+  }
+  worker->Finalize();
+}
+
+std::vector<std::string> SplitApps(const std::string& apps) {
+  std::vector<std::string> names;
+  std::stringstream ss(apps);
+  std::string name;
+  while (std::getline(ss, name, ',')) {
+    if (!name.empty()) {
+      names.push_back(name);
+    }
+  }
+  return names;
+}
+
+void Run(const grape::CommSpec& comm_spec, vineyard::Client& client) {
+  BenchmarkReport report(comm_spec);
+
+  std::string options = "#header_row=" +
+                        std::string(FLAGS_header_row ? "true" : "false") +
+                        "&delimiter=" + FLAGS_delimiter;
+  std::vector<std::string> efiles{FLAGS_efile + options};
+  std::vector<std::string> vfiles;
+  if (!FLAGS_vfile.empty()) {
+    vfiles.push_back(FLAGS_vfile + options);
+  }
+
+  vineyard::ObjectID fragment_id = vineyard::InvalidObjectID();
+  report.Time("", "property", "load", [&]() {
+    auto loader =
+        std::make_unique<gs::ArrowFragmentLoader<oid_t, vid_t>>(
+            client, comm_spec, efiles, vfiles, FLAGS_directed);
+    fragment_id =
+        bl::try_handle_all([&loader]() { return loader->LoadFragment(); },
+                           [](const vineyard::GSError& e) {
+                             LOG(FATAL) << e.error_msg;
+                             return 0;
+                           },
+                           [](const bl::error_info& unmatched) {
+                             LOG(FATAL) << "Unmatched error " << unmatched;
+                             return 0;
+                           });
+  });
+  auto fragment = std::dynamic_pointer_cast<PropertyGraphType>(
+      client.GetObject(fragment_id));
+
+  std::shared_ptr<ProjectedGraphType> projected;
+  report.Time("", "projected", "project", [&]() {
+    projected = ProjectedGraphType::Project(fragment, 0, -1, 0, -1);
+  });
+  std::shared_ptr<WeightedGraphType> weighted;
+  if (FLAGS_weighted) {
+    report.Time("", "weighted", "project", [&]() {
+      weighted = WeightedGraphType::Project(fragment, 0, -1, 0, 0);
+    });
+  }
+
+  oid_t source = FLAGS_source;
+  int max_round = FLAGS_max_round;
+  // apps that take weights run on the weighted projection only
+  std::map<std::string, std::function<void()>> apps{
+      // LDBC Graphalytics
+      {"bfs",
+       [&]() {
+         RunApp<grape::BFS<ProjectedGraphType>>(report, "bfs", "projected",
+                                                projected, comm_spec, source);
+       }},
+      {"sssp",
+       [&]() {
+         RunApp<grape::SSSP<WeightedGraphType>>(report, "sssp", "weighted",
+                                                weighted, comm_spec, source);
+       }},
+      {"wcc",
+       [&]() {
+         RunApp<grape::WCC<ProjectedGraphType>>(report, "wcc", "projected",
+                                                projected, comm_spec);
+       }},
+      {"pagerank",
+       [&]() {
+         RunApp<grape::PageRank<ProjectedGraphType>>(
+             report, "pagerank", "projected", projected, comm_spec, 0.85,
+             max_round);
+       }},
+      {"cdlp",
+       [&]() {
+         RunApp<grape::CDLP<ProjectedGraphType>>(
+             report, "cdlp", "projected", projected, comm_spec, max_round);
+       }},
+      {"lcc",
+       [&]() {
+         RunApp<grape::LCC<ProjectedGraphType>>(report, "lcc", "projected",
+                                                projected, comm_spec);
+       }},
+      // centralities
+      {"degree_centrality",
+       [&]() {
+         RunApp<gs::DegreeCentrality<ProjectedGraphType>>(
+             report, "degree_centrality", "projected", projected, comm_spec,
+             std::string("both"));
+       }},
+      {"closeness_centrality",
+       [&]() {
+         RunApp<gs::ClosenessCentrality<ProjectedGraphType>>(
+             report, "closeness_centrality", "projected", projected, comm_spec,
+             true, std::string());
+       }},
+      {"eigenvector_centrality",
+       [&]() {
+         RunApp<gs::EigenvectorCentrality<ProjectedGraphType>>(
+             report, "eigenvector_centrality", "projected", projected,
+             comm_spec, 1e-6, max_round);
+       }},
+      {"katz_centrality",
+       [&]() {
+         RunApp<gs::KatzCentrality<ProjectedGraphType>>(
+             report, "katz_centrality", "projected", projected, comm_spec, 0.1,
+             1.0, 1e-6, max_round, true);
+       }},
+      {"hits",
+       [&]() {
+         RunApp<gs::HITS<ProjectedGraphType>>(report, "hits", "projected",
+                                              projected, comm_spec, 1e-6,
+                                              max_round, true);
+       }},
+      {"pagerank_nx",
+       [&]() {
+         RunApp<gs::PageRankNetworkX<ProjectedGraphType>>(
+             report, "pagerank_nx", "projected", projected, comm_spec, 0.85,
+             max_round, 1e-6);
+       }},
+      // clustering and cores
+      {"triangles",
+       [&]() {
+         RunApp<gs::Triangles<ProjectedGraphType>>(
+             report, "triangles", "projected", projected, comm_spec);
+       }},
+      {"clustering",
+       [&]() {
+         RunApp<gs::Clustering<ProjectedGraphType>>(
+             report, "clustering", "projected", projected, comm_spec);
+       }},
+      {"avg_clustering",
+       [&]() {
+         RunApp<gs::AvgClustering<ProjectedGraphType>>(
+             report, "avg_clustering", "projected", projected, comm_spec);
+       }},
+      {"transitivity",
+       [&]() {
+         RunApp<gs::Transitivity<ProjectedGraphType>>(
+             report, "transitivity", "projected", projected, comm_spec);
+       }},
+      {"kcore",
+       [&]() {
+         RunApp<gs::KCore<ProjectedGraphType>>(report, "kcore", "projected",
+                                               projected, comm_spec, FLAGS_k);
+       }},
+      {"kshell",
+       [&]() {
+         RunApp<gs::KShell<ProjectedGraphType>>(
+             report, "kshell", "projected", projected, comm_spec, FLAGS_k);
+       }},
+      {"louvain",
+       [&]() {
+         RunApp<gs::Louvain<WeightedGraphType>>(report, "louvain", "weighted",
+                                                weighted, comm_spec);
+       }},
+      // Flash
+      {"cc_flash",
+       [&]() {
+         RunApp<gs::CCFlash<ProjectedGraphType>>(report, "cc_flash",
+                                                 "projected", projected,
+                                                 comm_spec);
+       }},
+      {"pagerank_flash",
+       [&]() {
+         RunApp<gs::PRFlash<ProjectedGraphType>>(report, "pagerank_flash",
+                                                 "projected", projected,
+                                                 comm_spec, max_round);
+       }},
+      {"lpa_flash",
+       [&]() {
+         RunApp<gs::LPAFlash<ProjectedGraphType>>(report, "lpa_flash",
+                                                  "projected", projected,
+                                                  comm_spec);
+       }},
+      {"core_flash",
+       [&]() {
+         RunApp<gs::CoreFlash<ProjectedGraphType>>(report, "core_flash",
+                                                   "projected", projected,
+                                                   comm_spec);
+       }},
+      // property graph
+      {"wcc_property",
+       [&]() {
+         RunApp<gs::WCCProperty<PropertyGraphType>>(
+             report, "wcc_property", "property", fragment, comm_spec);
+       }},
+      {"sssp_property",
+       [&]() {
+         RunApp<gs::SSSPProperty<PropertyGraphType>>(
+             report, "sssp_property", "property", fragment, comm_spec, source);
+       }},
+  };
+  std::set<std::string> weighted_apps{"sssp", "louvain", "sssp_property"};
+
+  std::vector<std::string> names = SplitApps(FLAGS_apps);
+  if (names.empty()) {
+    for (auto& pair : apps) {
+      names.push_back(pair.first);
+    }
+  }
+  for (auto& name : names) {
+    auto iter = apps.find(name);
+    if (iter == apps.end()) {
+      LOG(FATAL) << "No available application named [" << name << "].";
+    }
+    if (!FLAGS_weighted && weighted_apps.count(name)) {
+      LOG(INFO) << "Skipped " << name << " on an unweighted graph";
+      continue;
+    }
+    if (name == "louvain" && FLAGS_directed) {
+      LOG(INFO) << "Skipped " << name << " on a directed graph";
+      continue;
+    }
+    iter->second();
+  }
+}
+
+int main(int argc, char** argv) {
+  grape::gflags::SetUsageMessage(
+      "Usage: mpiexec [mpi_opts] ./app_catalog_benchmarks -efile <efile> "
+      "[-vfile <vfile>] [-apps <app,...>] [-result_file <results.jsonl>]");
+  if (argc == 1) {
+    grape::gflags::ShowUsageWithFlagsRestrict(argv[0],
+                                              "app_catalog_benchmarks");
+    return 1;
+  }
+  grape::gflags::ParseCommandLineFlags(&argc, &argv, true);
+  grape::gflags::ShutDownCommandLineFlags();
+  google::InitGoogleLogging("app_catalog_benchmarks");
+
+  grape::InitMPIComm();
+  {
+    grape::CommSpec comm_spec;
+    comm_spec.Init(MPI_COMM_WORLD);
+
+    vineyard::Client client;
+    VINEYARD_CHECK_OK(client.Connect(FLAGS_ipc_socket));
+    LOG(INFO) << "Connected to IPCServer: " << FLAGS_ipc_socket;
+
+    Run(comm_spec, client);
+  }
+  grape::FinalizeMPIComm();
+
+  google::ShutdownGoogleLogging();
+  return 0;
+}
@@ -0,0 +1,282 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANALYTICAL_ENGINE_CORE_APP_GATHER_APPLY_GATHER_APPLY_APP_BASE_H_
+#define ANALYTICAL_ENGINE_CORE_APP_GATHER_APPLY_GATHER_APPLY_APP_BASE_H_
+
+#include <utility>
+#include <vector>
+
+#include "grape/grape.h"
+
+#include "core/app/gather_apply/gather_apply_context.h"
+#include "core/fragment/vertex_cut_fragment.h"
+
+namespace gs {
+
+/**
+ * @brief Runs gather-apply programs in PIE over a vertex cut of the edge-cut
+ * fragment, so the edges of a vertex of a huge degree are spread over the
+ * fragments instead of stalling its owner in every round.
+ *
+ * The edges reaching the inner vertices are sent to the fragments chosen by
+ * the vertex cut in PEval, then the mirrors are registered on their masters.
+ * A round takes two supersteps: the values of the masters are scattered to
+ * their mirrors, and every fragment gathers along the edges it holds, then
+ * the mirrors send their partial gathers to their masters, which apply them.
+ * The rounds end once no master changes, or after max_round rounds.
+ *
+ * APP_T defines the program, with:
+ *
+ * - value_t InitValue(frag, ctx, v), the value of the master v;
+ * - value_t Identity(), the identity of Merge;
+ * - void Merge(value_t& gathered, const value_t& value), gathering the
+ *   value of the source of an edge, or a partial gather of a mirror;
+ * - double Aggregate(frag, ctx, v, value), summed over the masters before
+ *   they are applied;
+ * - bool Apply(frag, ctx, v, gathered, aggregated, value), updating the
+ *   value of the master v, and returning whether it changed;
+ * - RESULT_T Result(frag, ctx, v, value).
+ *
+ * @tparam APP_T
+ * @tparam FRAG_T
+ * @tparam CONTEXT_T A GatherApplyContext.
+ */
+template <typename APP_T, typename FRAG_T, typename CONTEXT_T>
+class GatherApplyAppBase : public grape::ParallelAppBase<FRAG_T, CONTEXT_T>,
+                           public grape::ParallelEngine,
+                           public grape::Communicator {
+  using vertex_t = typename FRAG_T::vertex_t;
+  using vid_t = typename FRAG_T::vid_t;
+  using value_t = typename CONTEXT_T::value_t;
+  using message_t = GatherApplyMessage<vid_t, value_t>;
+  using kind_t = GatherApplyMessageKind;
+  using phase_t = typename CONTEXT_T::Phase;
+
+ public:
+  static constexpr grape::MessageStrategy message_strategy =
+      grape::MessageStrategy::kSyncOnOuterVertex;
+  static constexpr grape::LoadStrategy load_strategy =
+      grape::LoadStrategy::kBothOutIn;
+
+  void PEval(const FRAG_T& frag, CONTEXT_T& ctx,
+             grape::ParallelMessageManager& messages) {
+    messages.InitChannels(thread_num());
+    ctx.parser.Init(frag.fnum(), 1);
+    VertexCutPlacement<vid_t> placement;
+    placement.Init(frag.fnum(), ctx.cut, ctx.hybrid_threshold, ctx.parser);
+
+    auto inner_vertices = frag.InnerVertices();
+    ctx.masters.clear();
+    for (auto v : inner_vertices) {
+      ctx.masters.push_back(v);
+    }
+    edges_.clear();
+    edges_.resize(thread_num());
+    auto fid = frag.fid();
+    auto& channels = messages.Channels();
+    ForEach(inner_vertices, [&](int tid, vertex_t u) {
+      vid_t dst = frag.Vertex2Gid(u);
+      auto es = frag.directed() ? frag.GetIncomingAdjList(u)
+                                : frag.GetOutgoingAdjList(u);
+      size_t degree = es.Size();
+      for (auto& e : es) {
+        vid_t src = frag.Vertex2Gid(e.get_neighbor());
+        auto to = placement.EdgeFid(src, dst, degree);
+        if (to == fid) {
+          edges_[tid].emplace_back(src, dst);
+        } else {
+          channels[tid].SendToFragment(
+              to, message_t{kind_t::kEdge, src, dst, value_t()});
+        }
+      }
+    });
+    ctx.phase = phase_t::kBuild;
+    messages.ForceContinue();
+  }
+
+  void IncEval(const FRAG_T& frag, CONTEXT_T& ctx,
+               grape::ParallelMessageManager& messages) {
+    switch (ctx.phase) {
+    case phase_t::kBuild:
+      build(frag, ctx, messages);
+      break;
+    case phase_t::kRegister:
+      registerMirrors(frag, ctx, messages);
+      break;
+    case phase_t::kGather:
+      gather(frag, ctx, messages);
+      break;
+    case phase_t::kApply:
+      apply(frag, ctx, messages);
+      break;
+    }
+  }
+
+ private:
+  APP_T& app() { return *static_cast<APP_T*>(this); }
+
+  void build(const FRAG_T& frag, CONTEXT_T& ctx,
+             grape::ParallelMessageManager& messages) {
+    messages.ParallelProcess<message_t>(
+        thread_num(), [this](int tid, const message_t& msg) {
+          edges_[tid].emplace_back(msg.first, msg.second);
+        });
+    std::vector<std::pair<vid_t, vid_t>> edges;
+    for (auto& buffer : edges_) {
+      edges.insert(edges.end(), buffer.begin(), buffer.end());
+      std::vector<std::pair<vid_t, vid_t>>().swap(buffer);
+    }
+    std::vector<vid_t> master_gids;
+    master_gids.reserve(ctx.masters.size());
+    for (auto v : ctx.masters) {
+      master_gids.push_back(frag.Vertex2Gid(v));
+    }
+    auto& graph = ctx.graph;
+    graph.Build(master_gids, edges);
+
+    auto& channel = messages.Channels()[0];
+    for (size_t slot = graph.MasterNum(); slot < graph.VertexNum(); ++slot) {
+      vid_t gid = graph.Gid(slot);
+      channel.SendToFragment(
+          ctx.parser.GetFid(gid),
+          message_t{kind_t::kMirror, gid, static_cast<vid_t>(frag.fid()),
+                    value_t()});
+    }
+    VLOG(1) << "Fragment " << frag.fid() << " holds " << graph.EdgeNum()
+            << " edges of the vertex cut, with "
+            << graph.VertexNum() - graph.MasterNum() << " mirrors";
+    ctx.phase = phase_t::kRegister;
+    messages.ForceContinue();
+  }
+
+  void registerMirrors(const FRAG_T& frag, CONTEXT_T& ctx,
+                       grape::ParallelMessageManager& messages) {
+    std::vector<std::pair<vid_t, grape::fid_t>> pairs;
+    messages.ParallelProcess<message_t>(
+        1, [&pairs](int tid, const message_t& msg) {
+          pairs.emplace_back(msg.first, static_cast<grape::fid_t>(msg.second));
+        });
+    ctx.graph.SetMirrors(pairs);
+
+    ctx.values.resize(ctx.graph.VertexNum(), app().Identity());
+    ctx.gathered.resize(ctx.graph.VertexNum(), app().Identity());
+    forEachMaster(ctx, [this, &frag, &ctx](int tid, size_t slot) {
+      ctx.values[slot] = app().InitValue(frag, ctx, ctx.masters[slot]);
+    });
+    scatter(ctx, messages);
+    ctx.phase = phase_t::kGather;
+    messages.ForceContinue();
+  }
+
+  void gather(const FRAG_T& frag, CONTEXT_T& ctx,
+              grape::ParallelMessageManager& messages) {
+    auto& graph = ctx.graph;
+    // a mirror receives a single value per round
+    messages.ParallelProcess<message_t>(
+        thread_num(), [&ctx](int tid, const message_t& msg) {
+          ctx.values[ctx.graph.Slot(msg.first)] = msg.value;
+        });
+
+    auto& channels = messages.Channels();
+    grape::VertexRange<size_t> slots(0, graph.VertexNum());
+    ForEach(slots, [&](int tid, grape::Vertex<size_t> v) {
+      size_t slot = v.GetValue();
+      auto sources = graph.Sources(slot);
+      value_t gathered = app().Identity();
+      for (auto src : sources) {
+        app().Merge(gathered, ctx.values[src]);
+      }
+      ctx.gathered[slot] = gathered;
+      if (!graph.IsMaster(slot) && sources.begin() != sources.end()) {
+        vid_t gid = graph.Gid(slot);
+        channels[tid].SendToFragment(
+            ctx.parser.GetFid(gid),
+            message_t{kind_t::kPartial, gid, 0, gathered});
+      }
+    });
+    ctx.phase = phase_t::kApply;
+    messages.ForceContinue();
+  }
+
+  void apply(const FRAG_T& frag, CONTEXT_T& ctx,
+             grape::ParallelMessageManager& messages) {
+    // partials of a master come from several fragments
+    messages.ParallelProcess<message_t>(
+        1, [this, &ctx](int tid, const message_t& msg) {
+          app().Merge(ctx.gathered[ctx.graph.Slot(msg.first)], msg.value);
+        });
+
+    double local_aggregated = 0.0, aggregated = 0.0;
+    for (size_t slot = 0; slot < ctx.graph.MasterNum(); ++slot) {
+      local_aggregated +=
+          app().Aggregate(frag, ctx, ctx.masters[slot], ctx.values[slot]);
+    }
+    Sum(local_aggregated, aggregated);
+
+    std::vector<size_t> changed(thread_num(), 0);
+    forEachMaster(ctx, [&](int tid, size_t slot) {
+      if (app().Apply(frag, ctx, ctx.masters[slot], ctx.gathered[slot],
+                      aggregated, ctx.values[slot])) {
+        ++changed[tid];
+      }
+    });
+    size_t local_changed = 0, total_changed = 0;
+    for (auto num : changed) {
+      local_changed += num;
+    }
+    Sum(local_changed, total_changed);
+
+    ++ctx.round;
+    if (total_changed == 0 ||
+        (ctx.max_round > 0 && ctx.round >= ctx.max_round)) {
+      forEachMaster(ctx, [this, &frag, &ctx](int tid, size_t slot) {
+        auto v = ctx.masters[slot];
+        ctx.result[v] = app().Result(frag, ctx, v, ctx.values[slot]);
+      });
+      return;
+    }
+    scatter(ctx, messages);
+    ctx.phase = phase_t::kGather;
+    messages.ForceContinue();
+  }
+
+  // send the values of the masters to their mirrors
+  void scatter(CONTEXT_T& ctx, grape::ParallelMessageManager& messages) {
+    auto& channels = messages.Channels();
+    forEachMaster(ctx, [&ctx, &channels](int tid, size_t slot) {
+      vid_t gid = ctx.graph.Gid(slot);
+      for (auto fid : ctx.graph.MirrorFids(slot)) {
+        channels[tid].SendToFragment(
+            fid, message_t{kind_t::kValue, gid, 0, ctx.values[slot]});
+      }
+    });
+  }
+
+  template <typename FUNC_T>
+  void forEachMaster(CONTEXT_T& ctx, const FUNC_T& func) {
+    grape::VertexRange<size_t> slots(0, ctx.graph.MasterNum());
+    ForEach(slots, [&func](int tid, grape::Vertex<size_t> v) {
+      func(tid, v.GetValue());
+    });
+  }
+
+  // edges held by the fragment, by the threads receiving them
+  std::vector<std::vector<std::pair<vid_t, vid_t>>> edges_;
+};
+
+}  // namespace gs
+
+#endif  // ANALYTICAL_ENGINE_CORE_APP_GATHER_APPLY_GATHER_APPLY_APP_BASE_H_
@@ -0,0 +1,116 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANALYTICAL_ENGINE_CORE_APP_GATHER_APPLY_GATHER_APPLY_CONTEXT_H_
+#define ANALYTICAL_ENGINE_CORE_APP_GATHER_APPLY_GATHER_APPLY_CONTEXT_H_
+
+#include <string>
+#include <vector>
+
+#include "grape/grape.h"
+#include "vineyard/graph/fragment/property_graph_utils.h"
+
+#include "core/fragment/vertex_cut_fragment.h"
+
+namespace gs {
+
+enum class GatherApplyMessageKind : uint8_t {
+  kEdge,     // (src, dst), to the fragment holding the edge
+  kMirror,   // (vertex, fid), to the master of a mirror
+  kValue,    // (vertex, -, value), from a master to its mirrors
+  kPartial,  // (vertex, -, gathered), from a mirror to its master
+};
+
+template <typename VID_T, typename VALUE_T>
+struct GatherApplyMessage {
+  GatherApplyMessageKind kind;
+  VID_T first;
+  VID_T second;
+  VALUE_T value;
+};
+
+/**
+ * @brief Context of apps run by GatherApplyAppBase, holding the vertex cut
+ * part of the fragment and the values of its masters and mirrors.
+ *
+ * Contexts of such apps derive from it, and call InitGatherApply in their
+ * Init with the options of the vertex cut.
+ *
+ * @tparam FRAG_T
+ * @tparam VALUE_T The value of a vertex seen by its edges, which is also the
+ * type of the gathered values.
+ * @tparam RESULT_T
+ */
+template <typename FRAG_T, typename VALUE_T, typename RESULT_T = double>
+class GatherApplyContext : public grape::VertexDataContext<FRAG_T, RESULT_T> {
+  using vid_t = typename FRAG_T::vid_t;
+  using vertex_t = typename FRAG_T::vertex_t;
+
+ public:
+  using value_t = VALUE_T;
+
+  enum class Phase {
+    kBuild,     // edges are received
+    kRegister,  // mirrors are registered on their masters
+    kGather,    // values of mirrors are received, and edges gathered
+    kApply,     // partials are received, and masters applied
+  };
+
+  explicit GatherApplyContext(const FRAG_T& fragment)
+      : grape::VertexDataContext<FRAG_T, RESULT_T>(fragment, true),
+        result(this->data()) {}
+
+  /**
+   * @brief Run at most max_round rounds, on a vertex cut named by cut, i.e.
+   * "grid" or "hybrid", where vertices of an in degree higher than
+   * hybrid_threshold are cut in the latter.
+   */
+  void InitGatherApply(int max_round, const std::string& cut,
+                       int64_t hybrid_threshold) {
+    CHECK(ParseVertexCutKind(cut, this->cut)) << "Unknown vertex cut " << cut;
+    this->max_round = max_round;
+    this->hybrid_threshold = hybrid_threshold;
+    phase = Phase::kBuild;
+    round = 0;
+  }
+
+  void Output(std::ostream& os) override {
+    auto& frag = this->fragment();
+    auto inner_vertices = frag.InnerVertices();
+    for (auto v : inner_vertices) {
+      os << frag.GetId(v) << " " << result[v] << std::endl;
+    }
+  }
+
+  typename FRAG_T::template vertex_array_t<RESULT_T>& result;
+
+  VertexCutKind cut = VertexCutKind::kGrid;
+  size_t hybrid_threshold = 0;
+  vineyard::IdParser<vid_t> parser;
+  VertexCutFragment<vid_t> graph;
+  // the inner vertex of the master in each slot
+  std::vector<vertex_t> masters;
+  // by slots
+  std::vector<value_t> values;
+  std::vector<value_t> gathered;
+
+  Phase phase = Phase::kBuild;
+  int round = 0;
+  int max_round = 0;
+};
+
+}  // namespace gs
+
+#endif  // ANALYTICAL_ENGINE_CORE_APP_GATHER_APPLY_GATHER_APPLY_CONTEXT_H_
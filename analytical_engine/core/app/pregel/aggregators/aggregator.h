@@ -43,6 +43,45 @@ enum PregelAggregatorType {
   kEmptyAggregator = 100,
 };
 
+inline bool pack_slot_value(AggregatorSlot& slot, int64_t value) {
+  slot.type = AggregatorSlotType::kInt64;
+  slot.i = value;
+  return true;
+}
+
+inline bool pack_slot_value(AggregatorSlot& slot, bool value) {
+  slot.type = AggregatorSlotType::kInt64;
+  slot.i = value;
+  return true;
+}
+
+inline bool pack_slot_value(AggregatorSlot& slot, double value) {
+  slot.type = AggregatorSlotType::kDouble;
+  slot.f = value;
+  return true;
+}
+
+// other types are reduced by their archives
+template <typename T>
+bool pack_slot_value(AggregatorSlot& slot, const T& value) {
+  return false;
+}
+
+inline void unpack_slot_value(const AggregatorSlot& slot, int64_t& value) {
+  value = slot.i;
+}
+
+inline void unpack_slot_value(const AggregatorSlot& slot, bool& value) {
+  value = slot.i != 0;
+}
+
+inline void unpack_slot_value(const AggregatorSlot& slot, double& value) {
+  value = slot.f;
+}
+
+template <typename T>
+void unpack_slot_value(const AggregatorSlot& slot, T& value) {}
+
 /**
  * @brief Aggregator is a base class for pregel program
  * @tparam AGGR_TYPE
@@ -84,6 +123,27 @@ class Aggregator : public IAggregator {
     Reset();
   }
 
+  // kCustom if values are reduced by Aggregate
+  virtual AggregatorReduceOp ReduceOp() const {
+    return AggregatorReduceOp::kCustom;
+  }
+
+  bool PackSlot(AggregatorSlot& slot) override {
+    slot.op = ReduceOp();
+    return slot.op != AggregatorReduceOp::kCustom &&
+           pack_slot_value(slot, curr_value_);
+  }
+
+  void UnpackSlot(const AggregatorSlot& slot) override {
+    unpack_slot_value(slot, curr_value_);
+  }
+
+  void SaveAggregated(grape::InArchive& arc) override { arc << last_value_; }
+
+  void RestoreAggregated(grape::OutArchive& arc) override {
+    arc >> last_value_;
+  }
+
   std::shared_ptr<IAggregator> clone() override { return nullptr; }
 
   std::string ToString() override { return std::to_string(curr_value_); }
@@ -135,6 +195,12 @@ class Aggregator<std::string> : public IAggregator {
     Reset();
   }
 
+  void SaveAggregated(grape::InArchive& arc) override { arc << last_value_; }
+
+  void RestoreAggregated(grape::OutArchive& arc) override {
+    arc >> last_value_;
+  }
+
   std::shared_ptr<IAggregator> clone() override { return nullptr; }
 
   std::string ToString() override { return curr_value_; }
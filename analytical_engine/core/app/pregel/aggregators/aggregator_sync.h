@@ -0,0 +1,225 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANALYTICAL_ENGINE_CORE_APP_PREGEL_AGGREGATORS_AGGREGATOR_SYNC_H_
+#define ANALYTICAL_ENGINE_CORE_APP_PREGEL_AGGREGATORS_AGGREGATOR_SYNC_H_
+
+#include <mpi.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "grape/communication/sync_comm.h"
+#include "grape/serialization/in_archive.h"
+#include "grape/serialization/out_archive.h"
+
+#include "core/app/pregel/i_vertex_program.h"
+
+namespace gs {
+
+namespace aggregator_sync_impl {
+
+template <typename T>
+T reduce_slot_value(AggregatorReduceOp op, T lhs, T rhs) {
+  switch (op) {
+  case AggregatorReduceOp::kSum:
+    return lhs + rhs;
+  case AggregatorReduceOp::kProduct:
+    return lhs * rhs;
+  case AggregatorReduceOp::kMin:
+    return std::min(lhs, rhs);
+  case AggregatorReduceOp::kMax:
+    return std::max(lhs, rhs);
+  case AggregatorReduceOp::kAnd:
+    return lhs && rhs;
+  case AggregatorReduceOp::kOr:
+    return lhs || rhs;
+  default:
+    return rhs;
+  }
+}
+
+// The MPI op over slots. It is not commutative, and lhs holds the values of
+// lower ranks, so an overwrite keeps the value of the last worker.
+inline void reduce_slots(void* lhs, void* rhs, int* len, MPI_Datatype*) {
+  auto* in = static_cast<const AggregatorSlot*>(lhs);
+  auto* inout = static_cast<AggregatorSlot*>(rhs);
+  for (int k = 0; k < *len; ++k) {
+    auto op = inout[k].op;
+    if (inout[k].type == AggregatorSlotType::kDouble) {
+      inout[k].f = reduce_slot_value(op, in[k].f, inout[k].f);
+    } else {
+      inout[k].i = reduce_slot_value(op, in[k].i, inout[k].i);
+    }
+  }
+}
+
+inline void pack_archives(const std::vector<IAggregator*>& aggregators,
+                          grape::InArchive& arc) {
+  for (auto aggregator : aggregators) {
+    grape::InArchive value;
+    aggregator->Serialize(value);
+    arc << value.GetSize();
+    arc.AddBytes(value.GetBuffer(), value.GetSize());
+  }
+}
+
+inline void aggregate_archives(const std::vector<IAggregator*>& aggregators,
+                               grape::OutArchive& arc) {
+  for (auto aggregator : aggregators) {
+    size_t size;
+    arc >> size;
+    grape::OutArchive value;
+    value.SetSlice(static_cast<char*>(arc.GetBytes(size)), size);
+    aggregator->DeserializeAndAggregate(value);
+  }
+}
+
+}  // namespace aggregator_sync_impl
+
+/**
+ * @brief Reduces the aggregators of a pregel program over all workers at the
+ * end of a superstep.
+ *
+ * Fixed-size aggregators, i.e. the numeric and bool ones, are reduced
+ * together in a single all-reduce of their slots. Others, e.g. text ones,
+ * are reduced together along a binomial tree of their archives, keeping
+ * the order of the workers, and the result is broadcast, rather than
+ * every worker gathering the archives of all others.
+ */
+class AggregatorSync {
+ public:
+  static constexpr int kTreeTag = 0x41;
+
+  AggregatorSync() = default;
+
+  ~AggregatorSync() {
+    int finalized = 0;
+    MPI_Finalized(&finalized);
+    if (comm_ != MPI_COMM_NULL && !finalized) {
+      MPI_Op_free(&op_);
+      MPI_Type_free(&slot_type_);
+      MPI_Comm_free(&comm_);
+    }
+  }
+
+  AggregatorSync(const AggregatorSync&) = delete;
+  AggregatorSync& operator=(const AggregatorSync&) = delete;
+
+  /**
+   * @brief Reduce the current values of the aggregators, and start new rounds
+   * of them. All workers must have the same aggregators.
+   */
+  void Sync(std::unordered_map<std::string, std::shared_ptr<IAggregator>>&
+                aggregators) {
+    if (aggregators.empty()) {
+      return;
+    }
+    init();
+    // the same order on all workers
+    std::vector<std::pair<std::string, IAggregator*>> sorted;
+    for (auto& pair : aggregators) {
+      sorted.emplace_back(pair.first, pair.second.get());
+    }
+    std::sort(sorted.begin(), sorted.end());
+
+    std::vector<IAggregator*> fixed, custom;
+    std::vector<AggregatorSlot> slots;
+    for (auto& pair : sorted) {
+      AggregatorSlot slot;
+      if (pair.second->PackSlot(slot)) {
+        fixed.push_back(pair.second);
+        slots.push_back(slot);
+      } else {
+        custom.push_back(pair.second);
+      }
+    }
+    if (!slots.empty()) {
+      MPI_Allreduce(MPI_IN_PLACE, slots.data(), static_cast<int>(slots.size()),
+                    slot_type_, op_, comm_);
+      for (size_t i = 0; i < fixed.size(); ++i) {
+        fixed[i]->UnpackSlot(slots[i]);
+      }
+    }
+    if (!custom.empty()) {
+      reduceTree(custom);
+    }
+    for (auto& pair : sorted) {
+      pair.second->StartNewRound();
+    }
+  }
+
+ private:
+  void init() {
+    if (comm_ != MPI_COMM_NULL) {
+      return;
+    }
+    // the workers of the engine span MPI_COMM_WORLD
+    MPI_Comm_dup(MPI_COMM_WORLD, &comm_);
+    MPI_Comm_rank(comm_, &rank_);
+    MPI_Comm_size(comm_, &size_);
+    MPI_Type_contiguous(sizeof(AggregatorSlot), MPI_BYTE, &slot_type_);
+    MPI_Type_commit(&slot_type_);
+    MPI_Op_create(&aggregator_sync_impl::reduce_slots, 0, &op_);
+  }
+
+  void reduceTree(const std::vector<IAggregator*>& aggregators) {
+    // a worker combines its subtree, on its left, with the one of the worker
+    // step after it, then passes the result to the worker step before it
+    for (int step = 1; step < size_; step <<= 1) {
+      if (rank_ % (step << 1) != 0) {
+        grape::InArchive arc;
+        aggregator_sync_impl::pack_archives(aggregators, arc);
+        grape::sync_comm::Send(arc, rank_ - step, kTreeTag, comm_);
+        break;
+      }
+      if (rank_ + step < size_) {
+        grape::OutArchive arc;
+        grape::sync_comm::Recv(arc, rank_ + step, kTreeTag, comm_);
+        aggregator_sync_impl::aggregate_archives(aggregators, arc);
+      }
+    }
+
+    std::string result;
+    if (rank_ == 0) {
+      grape::InArchive arc;
+      aggregator_sync_impl::pack_archives(aggregators, arc);
+      result.assign(arc.GetBuffer(), arc.GetSize());
+    }
+    grape::sync_comm::Bcast(result, 0, comm_);
+    if (rank_ != 0) {
+      grape::OutArchive arc;
+      arc.SetSlice(&result[0], result.size());
+      for (auto aggregator : aggregators) {
+        aggregator->Reset();
+      }
+      aggregator_sync_impl::aggregate_archives(aggregators, arc);
+    }
+  }
+
+  MPI_Comm comm_ = MPI_COMM_NULL;
+  MPI_Datatype slot_type_ = MPI_DATATYPE_NULL;
+  MPI_Op op_ = MPI_OP_NULL;
+  int rank_ = 0;
+  int size_ = 1;
+};
+
+}  // namespace gs
+
+#endif  // ANALYTICAL_ENGINE_CORE_APP_PREGEL_AGGREGATORS_AGGREGATOR_SYNC_H_
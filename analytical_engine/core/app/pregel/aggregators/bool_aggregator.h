@@ -28,6 +28,10 @@ namespace gs {
  */
 class BoolAndAggregator : public Aggregator<bool> {
  public:
+  AggregatorReduceOp ReduceOp() const override {
+    return AggregatorReduceOp::kAnd;
+  }
+
   void Aggregate(bool value) override {
     Aggregator<bool>::SetCurrentValue(Aggregator<bool>::GetCurrentValue() &&
                                       value);
@@ -44,6 +48,10 @@ class BoolAndAggregator : public Aggregator<bool> {
  */
 class BoolOrAggregator : public Aggregator<bool> {
  public:
+  AggregatorReduceOp ReduceOp() const override {
+    return AggregatorReduceOp::kOr;
+  }
+
   void Aggregate(bool value) override {
     Aggregator<bool>::SetCurrentValue(Aggregator<bool>::GetCurrentValue() ||
                                       value);
@@ -59,6 +67,10 @@ class BoolOrAggregator : public Aggregator<bool> {
  */
 class BoolOverwriteAggregator : public Aggregator<bool> {
  public:
+  AggregatorReduceOp ReduceOp() const override {
+    return AggregatorReduceOp::kOverwrite;
+  }
+
   void Aggregate(bool value) override {
     Aggregator<bool>::SetCurrentValue(value);
   }
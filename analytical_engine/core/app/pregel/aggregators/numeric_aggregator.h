@@ -31,6 +31,10 @@ namespace gs {
 template <typename AGGR_TYPE>
 class NumericMinAggregator : public Aggregator<AGGR_TYPE> {
  public:
+  AggregatorReduceOp ReduceOp() const override {
+    return AggregatorReduceOp::kMin;
+  }
+
   void Aggregate(AGGR_TYPE value) override {
     Aggregator<AGGR_TYPE>::SetCurrentValue(
         std::min(Aggregator<AGGR_TYPE>::GetCurrentValue(), value));
@@ -54,6 +58,10 @@ class NumericMinAggregator : public Aggregator<AGGR_TYPE> {
 template <typename AGGR_TYPE>
 class NumericMaxAggregator : public Aggregator<AGGR_TYPE> {
  public:
+  AggregatorReduceOp ReduceOp() const override {
+    return AggregatorReduceOp::kMax;
+  }
+
   void Aggregate(AGGR_TYPE value) override {
     Aggregator<AGGR_TYPE>::SetCurrentValue(
         std::max(Aggregator<AGGR_TYPE>::GetCurrentValue(), value));
@@ -61,12 +69,12 @@ class NumericMaxAggregator : public Aggregator<AGGR_TYPE> {
 
   void Init() override {
     Aggregator<AGGR_TYPE>::SetCurrentValue(
-        std::numeric_limits<AGGR_TYPE>::min());
+        std::numeric_limits<AGGR_TYPE>::lowest());
   }
 
   void Reset() override {
     Aggregator<AGGR_TYPE>::SetCurrentValue(
-        std::numeric_limits<AGGR_TYPE>::min());
+        std::numeric_limits<AGGR_TYPE>::lowest());
   }
 };
 /**
@@ -77,6 +85,10 @@ class NumericMaxAggregator : public Aggregator<AGGR_TYPE> {
 template <typename AGGR_TYPE>
 class NumericSumAggregator : public Aggregator<AGGR_TYPE> {
  public:
+  AggregatorReduceOp ReduceOp() const override {
+    return AggregatorReduceOp::kSum;
+  }
+
   void Aggregate(AGGR_TYPE value) override {
     Aggregator<AGGR_TYPE>::SetCurrentValue(
         Aggregator<AGGR_TYPE>::GetCurrentValue() + value);
@@ -94,6 +106,10 @@ class NumericSumAggregator : public Aggregator<AGGR_TYPE> {
 template <typename AGGR_TYPE>
 class NumericProductAggregator : public Aggregator<AGGR_TYPE> {
  public:
+  AggregatorReduceOp ReduceOp() const override {
+    return AggregatorReduceOp::kProduct;
+  }
+
   void Aggregate(AGGR_TYPE value) override {
     Aggregator<AGGR_TYPE>::SetCurrentValue(
         Aggregator<AGGR_TYPE>::GetCurrentValue() * value);
@@ -111,6 +127,10 @@ class NumericProductAggregator : public Aggregator<AGGR_TYPE> {
 template <typename AGGR_TYPE>
 class NumericOverwriteAggregator : public Aggregator<AGGR_TYPE> {
  public:
+  AggregatorReduceOp ReduceOp() const override {
+    return AggregatorReduceOp::kOverwrite;
+  }
+
   void Aggregate(AGGR_TYPE value) override {
     Aggregator<AGGR_TYPE>::SetCurrentValue(value);
   }
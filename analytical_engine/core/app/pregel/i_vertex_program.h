@@ -16,6 +16,7 @@
 #ifndef ANALYTICAL_ENGINE_CORE_APP_PREGEL_I_VERTEX_PROGRAM_H_
 #define ANALYTICAL_ENGINE_CORE_APP_PREGEL_I_VERTEX_PROGRAM_H_
 
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <vector>
@@ -66,6 +67,34 @@ class ICombinator {
   virtual MD_T CombineMessages(MessageIterator<MD_T> messages) = 0;
 };
 
+enum class AggregatorReduceOp : uint8_t {
+  kCustom,
+  kSum,
+  kProduct,
+  kMin,
+  kMax,
+  kAnd,
+  kOr,
+  kOverwrite,  // by the value of the last worker
+};
+
+enum class AggregatorSlotType : uint8_t {
+  kInt64,  // bool as well
+  kDouble,
+};
+
+/**
+ * @brief The value of a fixed-size aggregator, with how it is reduced.
+ */
+struct AggregatorSlot {
+  AggregatorReduceOp op;
+  AggregatorSlotType type;
+  union {
+    int64_t i;
+    double f;
+  };
+};
+
 /**
  * @brief Aggregator interface for pregel program
  */
@@ -85,6 +114,17 @@ class IAggregator {
 
   virtual void StartNewRound() = 0;
 
+  // Aggregators of a fixed size pack their current values in slots, which
+  // are reduced together, the others are reduced by their archives.
+  virtual bool PackSlot(AggregatorSlot& slot) { return false; }
+
+  virtual void UnpackSlot(const AggregatorSlot& slot) {}
+
+  // the aggregated value of the last round, kept by checkpoints
+  virtual void SaveAggregated(grape::InArchive& arc) = 0;
+
+  virtual void RestoreAggregated(grape::OutArchive& arc) = 0;
+
   virtual std::shared_ptr<IAggregator> clone() = 0;
 
   virtual std::string ToString() { return ""; }
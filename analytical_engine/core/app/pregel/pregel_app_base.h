@@ -24,6 +24,8 @@ limitations under the License.
 #include "grape/utils/iterator_pair.h"
 
 #include "core/app/app_base.h"
+#include "core/app/pregel/aggregators/aggregator_sync.h"
+#include "core/app/pregel/pregel_checkpoint.h"
 #include "core/app/pregel/pregel_compute_context.h"
 #include "core/app/pregel/pregel_context.h"
 
@@ -65,7 +67,7 @@ class PregelAppBase
   void PEval(const fragment_t& frag, pregel_context_t& ctx,
              message_manager_t& messages) {
     // superstep is 0 in PEval
-    ctx.compute_context_.enable_combine();
+    ctx.compute_context_.enable_combine(combinator_);
 
     PregelVertex<fragment_t, vd_t, md_t> pregel_vertex;
     pregel_vertex.set_fragment(&frag);
@@ -79,6 +81,11 @@ class PregelAppBase
       program_.Init(pregel_vertex, ctx.compute_context_);
     }
 
+    if (LoadPregelCheckpoint(*this, frag, ctx.compute_context_)) {
+      computeStep(frag, ctx, messages);
+      return;
+    }
+
     for (auto v : inner_vertices) {
       pregel_vertex.set_vertex(v);
       program_.Compute(null_messages, pregel_vertex, ctx.compute_context_);
@@ -97,19 +104,7 @@ class PregelAppBase
       }
     }
 
-    {
-      // Sync Aggregator
-      for (auto& pair : ctx.compute_context_.aggregators()) {
-        grape::InArchive iarc;
-        std::vector<grape::InArchive> oarcs;
-        std::string name = pair.first;
-        pair.second->Serialize(iarc);
-        pair.second->Reset();
-        AllGather(std::move(iarc), oarcs);
-        pair.second->DeserializeAndAggregate(oarcs);
-        pair.second->StartNewRound();
-      }
-    }
+    aggregator_sync_.Sync(ctx.compute_context_.aggregators());
 
     ctx.compute_context_.clear_for_next_round();
     if (!ctx.compute_context_.all_halted()) {
@@ -130,6 +125,14 @@ class PregelAppBase
       }
     }
 
+    SavePregelCheckpoint(frag, ctx.compute_context_);
+    computeStep(frag, ctx, messages);
+  }
+
+ private:
+  // compute the superstep whose messages are received
+  void computeStep(const fragment_t& frag, pregel_context_t& ctx,
+                   message_manager_t& messages) {
     PregelVertex<fragment_t, vd_t, md_t> pregel_vertex;
     pregel_vertex.set_fragment(&frag);
     pregel_vertex.set_compute_context(&ctx.compute_context_);
@@ -160,19 +163,7 @@ class PregelAppBase
       }
     }
 
-    {
-      // Sync Aggregator
-      for (auto& pair : ctx.compute_context_.aggregators()) {
-        grape::InArchive iarc;
-        std::vector<grape::InArchive> oarcs;
-        std::string name = pair.first;
-        pair.second->Serialize(iarc);
-        pair.second->Reset();
-        AllGather(std::move(iarc), oarcs);
-        pair.second->DeserializeAndAggregate(oarcs);
-        pair.second->StartNewRound();
-      }
-    }
+    aggregator_sync_.Sync(ctx.compute_context_.aggregators());
 
     ctx.compute_context_.clear_for_next_round();
     if (!ctx.compute_context_.all_halted()) {
@@ -180,8 +171,8 @@ class PregelAppBase
     }
   }
 
- private:
   VERTEX_PROGRAM_T program_;
+  AggregatorSync aggregator_sync_;
   COMBINATOR_T combinator_;
 };
 /**
@@ -230,24 +221,17 @@ class PregelAppBase<FRAG_T, VERTEX_PROGRAM_T, void>
       program_.Init(pregel_vertex, ctx.compute_context_);
     }
 
+    if (LoadPregelCheckpoint(*this, frag, ctx.compute_context_)) {
+      computeStep(frag, ctx, messages);
+      return;
+    }
+
     for (auto v : inner_vertices) {
       pregel_vertex.set_vertex(v);
       program_.Compute(null_messages, pregel_vertex, ctx.compute_context_);
     }
 
-    {
-      // Sync Aggregator
-      for (auto& pair : ctx.compute_context_.aggregators()) {
-        grape::InArchive iarc;
-        std::vector<grape::InArchive> oarcs;
-        std::string name = pair.first;
-        pair.second->Serialize(iarc);
-        pair.second->Reset();
-        AllGather(std::move(iarc), oarcs);
-        pair.second->DeserializeAndAggregate(oarcs);
-        pair.second->StartNewRound();
-      }
-    }
+    aggregator_sync_.Sync(ctx.compute_context_.aggregators());
 
     ctx.compute_context_.clear_for_next_round();
 
@@ -269,6 +253,14 @@ class PregelAppBase<FRAG_T, VERTEX_PROGRAM_T, void>
       }
     }
 
+    SavePregelCheckpoint(frag, ctx.compute_context_);
+    computeStep(frag, ctx, messages);
+  }
+
+ private:
+  // compute the superstep whose messages are received
+  void computeStep(const fragment_t& frag, pregel_context_t& ctx,
+                   message_manager_t& messages) {
     PregelVertex<fragment_t, vd_t, md_t> pregel_vertex;
     pregel_vertex.set_fragment(&frag);
     pregel_vertex.set_compute_context(&ctx.compute_context_);
@@ -286,19 +278,7 @@ class PregelAppBase<FRAG_T, VERTEX_PROGRAM_T, void>
       }
     }
 
-    {
-      // Sync Aggregator
-      for (auto& pair : ctx.compute_context_.aggregators()) {
-        grape::InArchive iarc;
-        std::vector<grape::InArchive> oarcs;
-        std::string name = pair.first;
-        pair.second->Serialize(iarc);
-        pair.second->Reset();
-        AllGather(std::move(iarc), oarcs);
-        pair.second->DeserializeAndAggregate(oarcs);
-        pair.second->StartNewRound();
-      }
-    }
+    aggregator_sync_.Sync(ctx.compute_context_.aggregators());
 
     ctx.compute_context_.clear_for_next_round();
 
@@ -307,8 +287,8 @@ class PregelAppBase<FRAG_T, VERTEX_PROGRAM_T, void>
     }
   }
 
- private:
   VERTEX_PROGRAM_T program_;
+  AggregatorSync aggregator_sync_;
 };
 
 }  // namespace gs
@@ -0,0 +1,143 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef ANALYTICAL_ENGINE_CORE_APP_PREGEL_PREGEL_CHECKPOINT_H_
+#define ANALYTICAL_ENGINE_CORE_APP_PREGEL_PREGEL_CHECKPOINT_H_
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "grape/communication/communicator.h"
+#include "grape/serialization/in_archive.h"
+#include "grape/serialization/out_archive.h"
+
+namespace gs {
+
+/**
+ * Checkpoints of pregel queries.
+ *
+ * A query with "checkpoint_dir" and "checkpoint_interval" in its arguments
+ * saves the state of every fragment at the start of each checkpoint_interval
+ * supersteps, once the messages of the superstep are received, so that no
+ * message is in flight. Running the same query again on the same graph
+ * resumes from the checkpoint if every fragment has one of the same superstep.
+ */
+namespace pregel_checkpoint_impl {
+
+template <typename COMPUTE_CONTEXT_T>
+std::string checkpoint_path(COMPUTE_CONTEXT_T& compute_context,
+                            grape::fid_t fid) {
+  std::string dir = compute_context.get_config("checkpoint_dir");
+  if (dir.empty()) {
+    return dir;
+  }
+  return dir + "/pregel_checkpoint_" + std::to_string(fid);
+}
+
+}  // namespace pregel_checkpoint_impl
+
+/**
+ * @brief Save the state of the superstep about to be computed, if it is due.
+ */
+template <typename FRAG_T, typename COMPUTE_CONTEXT_T>
+void SavePregelCheckpoint(const FRAG_T& frag,
+                          COMPUTE_CONTEXT_T& compute_context) {
+  std::string interval = compute_context.get_config("checkpoint_interval");
+  std::string path =
+      pregel_checkpoint_impl::checkpoint_path(compute_context, frag.fid());
+  if (path.empty() || interval.empty() || std::stoi(interval) <= 0 ||
+      compute_context.superstep() % std::stoi(interval) != 0) {
+    return;
+  }
+
+  grape::InArchive arc;
+  arc << frag.fid();
+  compute_context.Checkpoint(arc);
+
+  // written aside and renamed, a failure in writing keeps the last checkpoint
+  std::string tmp_path = path + ".tmp";
+  {
+    std::ofstream ofs(tmp_path, std::ios::binary | std::ios::trunc);
+    ofs.write(arc.GetBuffer(), arc.GetSize());
+    if (!ofs) {
+      LOG(WARNING) << "Failed to write the pregel checkpoint to " << tmp_path;
+      return;
+    }
+  }
+  if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+    LOG(WARNING) << "Failed to write the pregel checkpoint to " << path;
+    return;
+  }
+  VLOG(1) << "[frag-" << frag.fid() << "] Saved the pregel checkpoint of step "
+          << compute_context.superstep() << " to " << path;
+}
+
+/**
+ * @brief Restore the state of a superstep from the checkpoints, must be
+ * called by all fragments. Returns false and keeps the state if some fragment
+ * has no checkpoint, or the checkpoints are of different supersteps.
+ */
+template <typename FRAG_T, typename COMPUTE_CONTEXT_T>
+bool LoadPregelCheckpoint(grape::Communicator& comm, const FRAG_T& frag,
+                          COMPUTE_CONTEXT_T& compute_context) {
+  std::string path =
+      pregel_checkpoint_impl::checkpoint_path(compute_context, frag.fid());
+  // every fragment reaches the collectives below, checkpoint or not
+  std::vector<char> buffer;
+  if (!path.empty()) {
+    std::ifstream ifs(path, std::ios::binary);
+    if (ifs) {
+      buffer.assign(std::istreambuf_iterator<char>(ifs),
+                    std::istreambuf_iterator<char>());
+    }
+  }
+
+  grape::InArchive iarc;
+  iarc.AddBytes(buffer.data(), buffer.size());
+  grape::OutArchive arc(std::move(iarc));
+  int step = -1;
+  if (!arc.Empty()) {
+    grape::fid_t fid;
+    arc >> fid;
+    if (fid == frag.fid()) {
+      arc >> step;
+    }
+  }
+
+  int min_step = 0, max_step = 0;
+  comm.Min(step, min_step);
+  comm.Max(step, max_step);
+  if (min_step <= 0 || min_step != max_step) {
+    return false;
+  }
+
+  int restored = compute_context.Restore(arc, step) ? 1 : 0;
+  int all_restored = 0;
+  comm.Min(restored, all_restored);
+  // the state of some fragments is overwritten already
+  CHECK_EQ(all_restored, 1) << "The pregel checkpoint in " << path
+                            << " does not match the fragment";
+  VLOG(1) << "[frag-" << frag.fid() << "] Resumed from the pregel checkpoint "
+          << "of step " << step;
+  return true;
+}
+
+}  // namespace gs
+
+#endif  // ANALYTICAL_ENGINE_CORE_APP_PREGEL_PREGEL_CHECKPOINT_H_
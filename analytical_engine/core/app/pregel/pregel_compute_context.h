@@ -18,6 +18,7 @@ limitations under the License.
 
 #include <stdint.h>
 
+#include <functional>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -92,7 +93,7 @@ class PregelComputeContext {
 
   void send_message(const vertex_t& v, const MD_T& value) {
     if (enable_combine_) {
-      messages_out_[v].emplace_back(value);
+      push_message(messages_out_[v], MD_T(value));
     } else {
       if (fragment_->IsOuterVertex(v)) {
         message_manager_->SyncStateOnOuterVertex<fragment_t, MD_T>(*fragment_,
@@ -105,7 +106,7 @@ class PregelComputeContext {
 
   void send_message(const vertex_t& v, MD_T&& value) {
     if (enable_combine_) {
-      messages_out_[v].emplace_back(std::move(value));
+      push_message(messages_out_[v], MD_T(std::move(value)));
     } else {
       if (fragment_->IsOuterVertex(v)) {
         message_manager_->SyncStateOnOuterVertex<fragment_t, MD_T>(*fragment_,
@@ -131,7 +132,7 @@ class PregelComputeContext {
     auto vertices = fragment_->Vertices();
     for (auto v : vertices) {
       auto& msgs = messages_out_[v];
-      if (!msgs.empty()) {
+      if (msgs.size() > 1) {
         MD_T ret = cb.CombineMessages(grape::IteratorPair<MD_T*>(
             &msgs[0], &msgs[0] + static_cast<ptrdiff_t>(msgs.size())));
         msgs.clear();
@@ -199,7 +200,18 @@ class PregelComputeContext {
     }
   }
 
-  void enable_combine() { enable_combine_ = true; }
+  /**
+   * @brief Combine the messages to a vertex as they are sent, so that a vertex
+   * holds one pending message at most.
+   */
+  template <typename COMBINATOR_T>
+  void enable_combine(COMBINATOR_T& cb) {
+    enable_combine_ = true;
+    combine_ = [&cb](grape::IteratorPair<MD_T*> messages) {
+      return cb.CombineMessages(messages);
+    };
+  }
+
   void set_fragment(const fragment_t* fragment) { fragment_ = fragment; }
   void set_message_manager(grape::DefaultMessageManager* message_manager) {
     message_manager_ = message_manager;
@@ -253,7 +265,70 @@ class PregelComputeContext {
         ->GetAggregatedValue();
   }
 
+  /**
+   * @brief Save the state of the superstep about to be computed, i.e., the
+   * values, halted flags and received messages of inner vertices, and the
+   * aggregated values.
+   */
+  void Checkpoint(grape::InArchive& arc) {
+    auto inner_vertices = fragment_->InnerVertices();
+    arc << step_ << static_cast<size_t>(inner_vertices.size());
+    for (auto v : inner_vertices) {
+      arc << vertex_data_[v] << static_cast<bool>(halted_[v])
+          << messages_in_[v];
+    }
+    arc << aggregators_.size();
+    for (auto& pair : aggregators_) {
+      arc << pair.first;
+      pair.second->SaveAggregated(arc);
+    }
+  }
+
+  /**
+   * @brief Restore the state saved by Checkpoint, after the step of it. The
+   * aggregators are registered by Init of the vertex program.
+   */
+  bool Restore(grape::OutArchive& arc, int step) {
+    auto inner_vertices = fragment_->InnerVertices();
+    size_t inner_vertex_num;
+    arc >> inner_vertex_num;
+    if (inner_vertex_num != inner_vertices.size()) {
+      return false;
+    }
+    for (auto v : inner_vertices) {
+      bool halted;
+      arc >> vertex_data_[v] >> halted >> messages_in_[v];
+      halted_[v] = halted;
+    }
+    // messages sent by Init are stale
+    for (auto v : fragment_->Vertices()) {
+      messages_out_[v].clear();
+    }
+    size_t aggregator_num;
+    arc >> aggregator_num;
+    for (size_t i = 0; i < aggregator_num; ++i) {
+      std::string name;
+      arc >> name;
+      auto iter = aggregators_.find(name);
+      if (iter == aggregators_.end()) {
+        return false;
+      }
+      iter->second->RestoreAggregated(arc);
+    }
+    step_ = step;
+    return true;
+  }
+
  private:
+  void push_message(std::vector<MD_T>& msgs, MD_T&& value) {
+    if (msgs.empty() || !combine_) {
+      msgs.emplace_back(std::move(value));
+    } else {
+      MD_T pair[2] = {std::move(msgs[0]), std::move(value)};
+      msgs[0] = combine_(grape::IteratorPair<MD_T*>(pair, pair + 2));
+    }
+  }
+
   const fragment_t* fragment_;
   grape::DefaultMessageManager* message_manager_;
   grape::ParallelMessageManager* parallel_message_manager_;
@@ -270,6 +345,7 @@ class PregelComputeContext {
   size_t total_vertex_num_;
 
   bool enable_combine_;
+  std::function<MD_T(grape::IteratorPair<MD_T*>)> combine_;
 
   int step_;
   std::unordered_map<std::string, std::string> config_;
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef ANALYTICAL_ENGINE_CORE_APP_PREGEL_PREGEL_PROPERTY_APP_BASE_H_
 #define ANALYTICAL_ENGINE_CORE_APP_PREGEL_PREGEL_PROPERTY_APP_BASE_H_
 
+#include <algorithm>
 #include <string>
 #include <utility>
 #include <vector>
@@ -23,11 +24,70 @@ limitations under the License.
 #include "grape/grape.h"
 #include "grape/utils/iterator_pair.h"
 
+#include "core/app/pregel/aggregators/aggregator_sync.h"
+#include "core/app/pregel/pregel_checkpoint.h"
 #include "core/app/pregel/pregel_context.h"
 #include "core/app/pregel/pregel_property_vertex.h"
 #include "core/app/property_app_base.h"
 
 namespace gs {
+
+namespace pregel_property_app_impl {
+
+/**
+ * @brief The number of threads to run Init and Compute of vertices, which is
+ * 1 unless the query asks for more by "thread_num". Cython programs are
+ * compiled without the GIL, so their vertices are computed in parallel.
+ */
+template <typename COMPUTE_CONTEXT_T>
+int compute_thread_num(grape::ParallelEngine& engine,
+                       COMPUTE_CONTEXT_T& compute_context) {
+  std::string value = compute_context.get_config("thread_num");
+  int thread_num = value.empty() ? 1 : std::stoi(value);
+  return std::max(
+      1, std::min(thread_num, static_cast<int>(engine.thread_num())));
+}
+
+/**
+ * @brief Call func(pregel_vertex) for each inner vertex of label v_label, on
+ * thread_num threads.
+ */
+template <typename VD_T, typename MD_T, typename FRAG_T, typename FUNC_T>
+void for_each_inner_vertex(
+    grape::ParallelEngine& engine, int thread_num, const FRAG_T& frag,
+    PregelPropertyComputeContext<FRAG_T, VD_T, MD_T>& compute_context,
+    typename FRAG_T::label_id_t v_label, const FUNC_T& func) {
+  using pregel_vertex_t = PregelPropertyVertex<FRAG_T, VD_T, MD_T>;
+  auto inner_vertices = frag.InnerVertices(v_label);
+
+  std::vector<pregel_vertex_t> pregel_vertices(thread_num);
+  for (int tid = 0; tid < thread_num; ++tid) {
+    pregel_vertices[tid].set_fragment(&frag);
+    pregel_vertices[tid].set_compute_context(&compute_context);
+    pregel_vertices[tid].set_label_id(v_label);
+    pregel_vertices[tid].set_thread_id(tid);
+  }
+
+  if (thread_num == 1) {
+    for (auto v : inner_vertices) {
+      pregel_vertices[0].set_vertex(v);
+      func(pregel_vertices[0]);
+    }
+    return;
+  }
+
+  compute_context.begin_parallel(thread_num);
+  engine.ForEach(inner_vertices,
+                 [&pregel_vertices, &func](int tid,
+                                           typename FRAG_T::vertex_t v) {
+                   pregel_vertices[tid].set_vertex(v);
+                   func(pregel_vertices[tid]);
+                 });
+  compute_context.end_parallel();
+}
+
+}  // namespace pregel_property_app_impl
+
 /**
  * @brief PregelPropertyAppBase is implemented with PIE programming model. The
  * pregel program is driven by the PIE functions. Compared with PregelAppBase,
@@ -44,11 +104,13 @@ class PregelPropertyAppBase
           PregelContext<FRAG_T, PregelPropertyComputeContext<
                                     FRAG_T, typename VERTEX_PROGRAM_T::vd_t,
                                     typename VERTEX_PROGRAM_T::md_t>>>,
-      public grape::Communicator {
+      public grape::Communicator,
+      public grape::ParallelEngine {
   using vd_t = typename VERTEX_PROGRAM_T::vd_t;
   using md_t = typename VERTEX_PROGRAM_T::md_t;
   using pregel_compute_context_t =
       PregelPropertyComputeContext<FRAG_T, vd_t, md_t>;
+  using pregel_vertex_t = PregelPropertyVertex<FRAG_T, vd_t, md_t>;
 
   using app_t = PregelPropertyAppBase<FRAG_T, VERTEX_PROGRAM_T, COMBINATOR_T>;
   using pregel_context_t = PregelContext<FRAG_T, pregel_compute_context_t>;
@@ -68,29 +130,33 @@ class PregelPropertyAppBase
   void PEval(const fragment_t& frag, pregel_context_t& ctx,
              message_manager_t& messages) {
     // superstep is 0 in PEval
-    ctx.compute_context_.enable_combine();
+    ctx.compute_context_.enable_combine(combinator_);
     label_id_t v_label_num = frag.vertex_label_num();
-
-    PregelPropertyVertex<fragment_t, vd_t, md_t> pregel_vertex;
-    pregel_vertex.set_fragment(&frag);
-    pregel_vertex.set_compute_context(&ctx.compute_context_);
+    int thread_num = pregel_property_app_impl::compute_thread_num(
+        *this, ctx.compute_context_);
 
     grape::IteratorPair<md_t*> null_messages(nullptr, nullptr);
 
     for (label_id_t i = 0; i < v_label_num; ++i) {
-      auto inner_vertices = frag.InnerVertices(i);
+      pregel_property_app_impl::for_each_inner_vertex(
+          *this, thread_num, frag, ctx.compute_context_, i,
+          [this, &ctx](pregel_vertex_t& pregel_vertex) {
+            program_.Init(pregel_vertex, ctx.compute_context_);
+          });
+    }
 
-      for (auto v : inner_vertices) {
-        pregel_vertex.set_vertex(v);
-        pregel_vertex.set_label_id(i);
-        program_.Init(pregel_vertex, ctx.compute_context_);
-      }
+    if (LoadPregelCheckpoint(*this, frag, ctx.compute_context_)) {
+      computeStep(frag, ctx, messages);
+      return;
+    }
 
-      for (auto v : inner_vertices) {
-        pregel_vertex.set_vertex(v);
-        pregel_vertex.set_label_id(i);
-        program_.Compute(null_messages, pregel_vertex, ctx.compute_context_);
-      }
+    for (label_id_t i = 0; i < v_label_num; ++i) {
+      pregel_property_app_impl::for_each_inner_vertex(
+          *this, thread_num, frag, ctx.compute_context_, i,
+          [this, &ctx, &null_messages](pregel_vertex_t& pregel_vertex) {
+            program_.Compute(null_messages, pregel_vertex,
+                             ctx.compute_context_);
+          });
     }
 
     ctx.compute_context_.apply_combine(combinator_);
@@ -108,19 +174,7 @@ class PregelPropertyAppBase
       }
     }
 
-    {
-      // Sync Aggregator
-      for (auto& pair : ctx.compute_context_.aggregators()) {
-        grape::InArchive iarc;
-        std::vector<grape::InArchive> oarcs;
-        std::string name = pair.first;
-        pair.second->Serialize(iarc);
-        pair.second->Reset();
-        AllGather(std::move(iarc), oarcs);
-        pair.second->DeserializeAndAggregate(oarcs);
-        pair.second->StartNewRound();
-      }
-    }
+    aggregator_sync_.Sync(ctx.compute_context_.aggregators());
 
     ctx.compute_context_.clear_for_next_round();
 
@@ -145,26 +199,33 @@ class PregelPropertyAppBase
       }
     }
 
-    label_id_t v_label_num = frag.vertex_label_num();
+    SavePregelCheckpoint(frag, ctx.compute_context_);
+    computeStep(frag, ctx, messages);
+  }
 
-    PregelPropertyVertex<fragment_t, vd_t, md_t> pregel_vertex;
-    pregel_vertex.set_fragment(&frag);
-    pregel_vertex.set_compute_context(&ctx.compute_context_);
+ private:
+  // compute the superstep whose messages are received
+  void computeStep(const fragment_t& frag, pregel_context_t& ctx,
+                   message_manager_t& messages) {
+    label_id_t v_label_num = frag.vertex_label_num();
+    int thread_num = pregel_property_app_impl::compute_thread_num(
+        *this, ctx.compute_context_);
 
     for (label_id_t i = 0; i < v_label_num; ++i) {
-      auto inner_vertices = frag.InnerVertices(i);
-      for (auto v : inner_vertices) {
-        if (ctx.compute_context_.active(v)) {
-          pregel_vertex.set_vertex(v);
-          pregel_vertex.set_label_id(i);
-          auto& cur_msgs = (ctx.compute_context_.messages_in(i))[v];
-          program_.Compute(
-              grape::IteratorPair<md_t*>(
-                  &cur_msgs[0],
-                  &cur_msgs[0] + static_cast<ptrdiff_t>(cur_msgs.size())),
-              pregel_vertex, ctx.compute_context_);
-        }
-      }
+      auto& messages_in = ctx.compute_context_.messages_in(i);
+      pregel_property_app_impl::for_each_inner_vertex(
+          *this, thread_num, frag, ctx.compute_context_, i,
+          [this, &ctx, &messages_in](pregel_vertex_t& pregel_vertex) {
+            vertex_t v = pregel_vertex.vertex();
+            if (ctx.compute_context_.active(v)) {
+              auto& cur_msgs = messages_in[v];
+              program_.Compute(
+                  grape::IteratorPair<md_t*>(
+                      &cur_msgs[0],
+                      &cur_msgs[0] + static_cast<ptrdiff_t>(cur_msgs.size())),
+                  pregel_vertex, ctx.compute_context_);
+            }
+          });
     }
 
     ctx.compute_context_.apply_combine(combinator_);
@@ -182,19 +243,7 @@ class PregelPropertyAppBase
       }
     }
 
-    {
-      // Sync Aggregator
-      for (auto& pair : ctx.compute_context_.aggregators()) {
-        grape::InArchive iarc;
-        std::vector<grape::InArchive> oarcs;
-        std::string name = pair.first;
-        pair.second->Serialize(iarc);
-        pair.second->Reset();
-        AllGather(std::move(iarc), oarcs);
-        pair.second->DeserializeAndAggregate(oarcs);
-        pair.second->StartNewRound();
-      }
-    }
+    aggregator_sync_.Sync(ctx.compute_context_.aggregators());
 
     ctx.compute_context_.clear_for_next_round();
 
@@ -203,8 +252,8 @@ class PregelPropertyAppBase
     }
   }
 
- private:
   VERTEX_PROGRAM_T program_;
+  AggregatorSync aggregator_sync_;
   COMBINATOR_T combinator_;
 };
 
@@ -220,12 +269,14 @@ class PregelPropertyAppBase<FRAG_T, VERTEX_PROGRAM_T, void>
           PregelContext<FRAG_T, PregelPropertyComputeContext<
                                     FRAG_T, typename VERTEX_PROGRAM_T::vd_t,
                                     typename VERTEX_PROGRAM_T::md_t>>>,
-      public grape::Communicator {
+      public grape::Communicator,
+      public grape::ParallelEngine {
   using vd_t = typename VERTEX_PROGRAM_T::vd_t;
   using md_t = typename VERTEX_PROGRAM_T::md_t;
   using app_t = PregelPropertyAppBase<FRAG_T, VERTEX_PROGRAM_T>;
   using pregel_compute_context_t =
       PregelPropertyComputeContext<FRAG_T, vd_t, md_t>;
+  using pregel_vertex_t = PregelPropertyVertex<FRAG_T, vd_t, md_t>;
   using pregel_context_t = PregelContext<FRAG_T, pregel_compute_context_t>;
 
   INSTALL_DEFAULT_PROPERTY_WORKER(app_t, pregel_context_t, FRAG_T)
@@ -244,43 +295,35 @@ class PregelPropertyAppBase<FRAG_T, VERTEX_PROGRAM_T, void>
              message_manager_t& messages) {
     // superstep is 0 in PEval
     label_id_t v_label_num = frag.vertex_label_num();
-
-    PregelPropertyVertex<fragment_t, vd_t, md_t> pregel_vertex;
-    pregel_vertex.set_fragment(&frag);
-    pregel_vertex.set_compute_context(&ctx.compute_context_);
+    int thread_num = pregel_property_app_impl::compute_thread_num(
+        *this, ctx.compute_context_);
 
     grape::IteratorPair<md_t*> null_messages(nullptr, nullptr);
 
     for (label_id_t i = 0; i < v_label_num; ++i) {
-      auto inner_vertices = frag.InnerVertices(i);
-
-      for (auto v : inner_vertices) {
-        pregel_vertex.set_vertex(v);
-        pregel_vertex.set_label_id(i);
-        program_.Init(pregel_vertex, ctx.compute_context_);
-      }
+      pregel_property_app_impl::for_each_inner_vertex(
+          *this, thread_num, frag, ctx.compute_context_, i,
+          [this, &ctx](pregel_vertex_t& pregel_vertex) {
+            program_.Init(pregel_vertex, ctx.compute_context_);
+          });
+    }
 
-      for (auto v : inner_vertices) {
-        pregel_vertex.set_vertex(v);
-        pregel_vertex.set_label_id(i);
-        program_.Compute(null_messages, pregel_vertex, ctx.compute_context_);
-      }
+    if (LoadPregelCheckpoint(*this, frag, ctx.compute_context_)) {
+      computeStep(frag, ctx, messages);
+      return;
     }
 
-    {
-      // Sync Aggregator
-      for (auto& pair : ctx.compute_context_.aggregators()) {
-        grape::InArchive iarc;
-        std::vector<grape::InArchive> oarcs;
-        std::string name = pair.first;
-        pair.second->Serialize(iarc);
-        pair.second->Reset();
-        AllGather(std::move(iarc), oarcs);
-        pair.second->DeserializeAndAggregate(oarcs);
-        pair.second->StartNewRound();
-      }
+    for (label_id_t i = 0; i < v_label_num; ++i) {
+      pregel_property_app_impl::for_each_inner_vertex(
+          *this, thread_num, frag, ctx.compute_context_, i,
+          [this, &ctx, &null_messages](pregel_vertex_t& pregel_vertex) {
+            program_.Compute(null_messages, pregel_vertex,
+                             ctx.compute_context_);
+          });
     }
 
+    aggregator_sync_.Sync(ctx.compute_context_.aggregators());
+
     ctx.compute_context_.clear_for_next_round();
 
     if (!ctx.compute_context_.all_halted()) {
@@ -304,41 +347,36 @@ class PregelPropertyAppBase<FRAG_T, VERTEX_PROGRAM_T, void>
       }
     }
 
-    label_id_t v_label_num = frag.vertex_label_num();
+    SavePregelCheckpoint(frag, ctx.compute_context_);
+    computeStep(frag, ctx, messages);
+  }
 
-    PregelPropertyVertex<fragment_t, vd_t, md_t> pregel_vertex;
-    pregel_vertex.set_fragment(&frag);
-    pregel_vertex.set_compute_context(&ctx.compute_context_);
+ private:
+  // compute the superstep whose messages are received
+  void computeStep(const fragment_t& frag, pregel_context_t& ctx,
+                   message_manager_t& messages) {
+    label_id_t v_label_num = frag.vertex_label_num();
+    int thread_num = pregel_property_app_impl::compute_thread_num(
+        *this, ctx.compute_context_);
 
     for (label_id_t i = 0; i < v_label_num; ++i) {
-      auto inner_vertices = frag.InnerVertices(i);
-      for (auto v : inner_vertices) {
-        if (ctx.compute_context_.active(v)) {
-          pregel_vertex.set_vertex(v);
-          pregel_vertex.set_label_id(i);
-          auto& cur_msgs = (ctx.compute_context_.messages_in(i))[v];
-          program_.Compute(
-              grape::IteratorPair<md_t*>(
-                  &cur_msgs[0],
-                  &cur_msgs[0] + static_cast<ptrdiff_t>(cur_msgs.size())),
-              pregel_vertex, ctx.compute_context_);
-        }
-      }
+      auto& messages_in = ctx.compute_context_.messages_in(i);
+      pregel_property_app_impl::for_each_inner_vertex(
+          *this, thread_num, frag, ctx.compute_context_, i,
+          [this, &ctx, &messages_in](pregel_vertex_t& pregel_vertex) {
+            vertex_t v = pregel_vertex.vertex();
+            if (ctx.compute_context_.active(v)) {
+              auto& cur_msgs = messages_in[v];
+              program_.Compute(
+                  grape::IteratorPair<md_t*>(
+                      &cur_msgs[0],
+                      &cur_msgs[0] + static_cast<ptrdiff_t>(cur_msgs.size())),
+                  pregel_vertex, ctx.compute_context_);
+            }
+          });
     }
 
-    {
-      // Sync Aggregator
-      for (auto& pair : ctx.compute_context_.aggregators()) {
-        grape::InArchive iarc;
-        std::vector<grape::InArchive> oarcs;
-        std::string name = pair.first;
-        pair.second->Serialize(iarc);
-        pair.second->Reset();
-        AllGather(std::move(iarc), oarcs);
-        pair.second->DeserializeAndAggregate(oarcs);
-        pair.second->StartNewRound();
-      }
-    }
+    aggregator_sync_.Sync(ctx.compute_context_.aggregators());
 
     ctx.compute_context_.clear_for_next_round();
 
@@ -347,8 +385,8 @@ class PregelPropertyAppBase<FRAG_T, VERTEX_PROGRAM_T, void>
     }
   }
 
- private:
   VERTEX_PROGRAM_T program_;
+  AggregatorSync aggregator_sync_;
 };
 
 }  // namespace gs
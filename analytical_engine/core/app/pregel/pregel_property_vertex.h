@@ -16,7 +16,10 @@
 #ifndef ANALYTICAL_ENGINE_CORE_APP_PREGEL_PREGEL_PROPERTY_VERTEX_H_
 #define ANALYTICAL_ENGINE_CORE_APP_PREGEL_PREGEL_PROPERTY_VERTEX_H_
 
+#include <atomic>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <utility>
@@ -153,11 +156,11 @@ class PregelPropertyVertex {
   }
 
   void send(const PregelPropertyVertex& v, const MD_T& value) {
-    compute_context_->send_message(v.vertex(), value);
+    compute_context_->send_message(v.vertex(), value, thread_id_);
   }
 
   void send(const PregelPropertyVertex& v, MD_T&& value) {
-    compute_context_->send_message(v.vertex(), std::move(value));
+    compute_context_->send_message(v.vertex(), std::move(value), thread_id_);
   }
 
   void vote_to_halt() { compute_context_->vote_to_halt(*this); }
@@ -173,12 +176,16 @@ class PregelPropertyVertex {
 
   void set_label_id(label_id_t label_id) { label_id_ = label_id; }
 
+  void set_thread_id(int thread_id) { thread_id_ = thread_id; }
+
  private:
   const fragment_t* fragment_;
   PregelPropertyComputeContext<fragment_t, VD_T, MD_T>* compute_context_;
 
   vertex_t vertex_;
   label_id_t label_id_;
+  // the thread computing the vertex, when vertices are computed in parallel
+  int thread_id_ = 0;
 };
 
 /**
@@ -508,10 +515,16 @@ class PregelPropertyComputeContext {
     return schema_->GetEdgePropertyName(e_label_id, e_prop_id);
   }
 
-  void send_message(const vertex_t& v, const MD_T& value) {
-    if (enable_combine_) {
+  /**
+   * @brief Send a message to v. Between begin_parallel and end_parallel, the
+   * message is buffered by the sending thread and delivered in end_parallel.
+   */
+  void send_message(const vertex_t& v, const MD_T& value, int tid = 0) {
+    if (parallel_) {
+      outboxes_[tid].emplace_back(v, value);
+    } else if (enable_combine_) {
       label_id_t label = fragment_->vertex_label(v);
-      messages_out_[label][v].emplace_back(value);
+      push_message(messages_out_[label][v], MD_T(value));
     } else {
       if (fragment_->IsOuterVertex(v)) {
         message_manager_->SyncStateOnOuterVertex<fragment_t, MD_T>(*fragment_,
@@ -523,10 +536,12 @@ class PregelPropertyComputeContext {
     }
   }
 
-  void send_message(const vertex_t& v, MD_T&& value) {
-    if (enable_combine_) {
+  void send_message(const vertex_t& v, MD_T&& value, int tid = 0) {
+    if (parallel_) {
+      outboxes_[tid].emplace_back(v, std::move(value));
+    } else if (enable_combine_) {
       label_id_t label = fragment_->vertex_label(v);
-      messages_out_[label][v].emplace_back(std::move(value));
+      push_message(messages_out_[label][v], MD_T(std::move(value)));
     } else {
       if (fragment_->IsOuterVertex(v)) {
         message_manager_->SyncStateOnOuterVertex<fragment_t, MD_T>(*fragment_,
@@ -538,13 +553,37 @@ class PregelPropertyComputeContext {
     }
   }
 
+  /**
+   * @brief Let thread_num threads run Init or Compute of distinct vertices
+   * until end_parallel. The messages are sent through the vertices, and a
+   * vertex only sets its own value.
+   */
+  void begin_parallel(int thread_num) {
+    outboxes_.resize(thread_num);
+    parallel_ = true;
+  }
+
+  /**
+   * @brief Deliver the messages buffered since begin_parallel, in the order of
+   * the sending threads.
+   */
+  void end_parallel() {
+    parallel_ = false;
+    for (auto& outbox : outboxes_) {
+      for (auto& pair : outbox) {
+        send_message(pair.first, std::move(pair.second));
+      }
+      outbox.clear();
+    }
+  }
+
   template <typename COMBINATOR_T>
   void apply_combine(COMBINATOR_T& cb) {
     for (int label_id = 0; label_id < vertex_label_num_; ++label_id) {
       auto vertices = fragment_->Vertices(label_id);
       for (auto v : vertices) {
         auto& msgs = messages_out_[label_id][v];
-        if (!msgs.empty()) {
+        if (msgs.size() > 1) {
           MD_T ret = cb.CombineMessages(grape::IteratorPair<MD_T*>(
               &msgs[0], &msgs[0] + static_cast<ptrdiff_t>(msgs.size())));
           msgs.clear();
@@ -618,7 +657,18 @@ class PregelPropertyComputeContext {
     }
   }
 
-  void enable_combine() { enable_combine_ = true; }
+  /**
+   * @brief Combine the messages to a vertex as they are sent, so that a vertex
+   * holds one pending message at most.
+   */
+  template <typename COMBINATOR_T>
+  void enable_combine(COMBINATOR_T& cb) {
+    enable_combine_ = true;
+    combine_ = [&cb](grape::IteratorPair<MD_T*> messages) {
+      return cb.CombineMessages(messages);
+    };
+  }
+
   void set_fragment(const fragment_t* fragment) { fragment_ = fragment; }
   void set_message_manager(grape::DefaultMessageManager* message_manager) {
     message_manager_ = message_manager;
@@ -660,6 +710,10 @@ class PregelPropertyComputeContext {
 
   template <typename AGGR_TYPE>
   void aggregate(const std::string& name, AGGR_TYPE value) {
+    std::unique_lock<std::mutex> lock(aggregate_mutex_, std::defer_lock);
+    if (parallel_) {
+      lock.lock();
+    }
     if (aggregators_.find(name) != aggregators_.end()) {
       std::dynamic_pointer_cast<Aggregator<AGGR_TYPE>>(aggregators_.at(name))
           ->Aggregate(value);
@@ -673,6 +727,73 @@ class PregelPropertyComputeContext {
         ->GetAggregatedValue();
   }
 
+  /**
+   * @brief Save the state of the superstep about to be computed, i.e., the
+   * values, halted flags and received messages of inner vertices, and the
+   * aggregated values.
+   */
+  void Checkpoint(grape::InArchive& arc) {
+    arc << step_ << vertex_label_num_;
+    for (label_id_t i = 0; i < vertex_label_num_; ++i) {
+      auto inner_vertices = fragment_->InnerVertices(i);
+      arc << static_cast<size_t>(inner_vertices.size());
+      for (auto v : inner_vertices) {
+        arc << vertex_data_[i][v] << static_cast<bool>(halted_[i][v])
+            << messages_in_[i][v];
+      }
+    }
+    arc << aggregators_.size();
+    for (auto& pair : aggregators_) {
+      arc << pair.first;
+      pair.second->SaveAggregated(arc);
+    }
+  }
+
+  /**
+   * @brief Restore the state saved by Checkpoint, after the step of it. The
+   * aggregators are registered by Init of the vertex program.
+   */
+  bool Restore(grape::OutArchive& arc, int step) {
+    label_id_t v_label_num;
+    arc >> v_label_num;
+    if (v_label_num != vertex_label_num_) {
+      return false;
+    }
+    size_t halted_num = 0;
+    for (label_id_t i = 0; i < vertex_label_num_; ++i) {
+      auto inner_vertices = fragment_->InnerVertices(i);
+      size_t inner_vertex_num;
+      arc >> inner_vertex_num;
+      if (inner_vertex_num != inner_vertices.size()) {
+        return false;
+      }
+      for (auto v : inner_vertices) {
+        bool halted;
+        arc >> vertex_data_[i][v] >> halted >> messages_in_[i][v];
+        halted_[i][v] = halted;
+        halted_num += halted ? 1 : 0;
+      }
+      // messages sent by Init are stale
+      for (auto v : fragment_->Vertices(i)) {
+        messages_out_[i][v].clear();
+      }
+    }
+    voted_to_halt_num_ = halted_num;
+    size_t aggregator_num;
+    arc >> aggregator_num;
+    for (size_t i = 0; i < aggregator_num; ++i) {
+      std::string name;
+      arc >> name;
+      auto iter = aggregators_.find(name);
+      if (iter == aggregators_.end()) {
+        return false;
+      }
+      iter->second->RestoreAggregated(arc);
+    }
+    step_ = step;
+    return true;
+  }
+
   size_t get_total_vertices_num() { return fragment_->GetTotalNodesNum(); }
 
   vineyard::ObjectID vertex_map_id() { return fragment_->vertex_map_id(); }
@@ -680,6 +801,15 @@ class PregelPropertyComputeContext {
   const vineyard::PropertyGraphSchema* schema() const { return schema_; }
 
  private:
+  void push_message(std::vector<MD_T>& msgs, MD_T&& value) {
+    if (msgs.empty() || !combine_) {
+      msgs.emplace_back(std::move(value));
+    } else {
+      MD_T pair[2] = {std::move(msgs[0]), std::move(value)};
+      msgs[0] = combine_(grape::IteratorPair<MD_T*>(pair, pair + 2));
+    }
+  }
+
   const fragment_t* fragment_;
   grape::DefaultMessageManager* message_manager_;
 
@@ -688,7 +818,7 @@ class PregelPropertyComputeContext {
 
   std::vector<typename FRAG_T::template vertex_array_t<VD_T>>& vertex_data_;
 
-  size_t voted_to_halt_num_;
+  std::atomic<size_t> voted_to_halt_num_;
   std::vector<typename FRAG_T::template vertex_array_t<bool>> halted_;
 
   std::vector<typename FRAG_T::template vertex_array_t<std::vector<MD_T>>>
@@ -701,6 +831,12 @@ class PregelPropertyComputeContext {
   label_id_t edge_label_num_;
 
   bool enable_combine_;
+  std::function<MD_T(grape::IteratorPair<MD_T*>)> combine_;
+
+  bool parallel_ = false;
+  // messages sent by each thread in parallel
+  std::vector<std::vector<std::pair<vertex_t, MD_T>>> outboxes_;
+  std::mutex aggregate_mutex_;
 
   int step_;
   std::unordered_map<std::string, std::string> config_;
@@ -16,6 +16,7 @@
 #define ANALYTICAL_ENGINE_CORE_COMMUNICATION_SHUFFLE_H_
 
 #include <string>
+#include <vector>
 
 #include "grape/communication/shuffle.h"  // IWYU pragma: export
 #include "vineyard/graph/utils/string_collection.h"
@@ -25,51 +26,87 @@ namespace grape {
  * @brief ShuffleUnit wraps a vector, for data shuffling between workers.
  * The templated ShuffleUnit is defined in libgrape-lite. This is the
  * specialized ShuffleUnit for string data type to achieve high performance.
+ *
+ * A buffer is sent with non-blocking sends, and the unit fills another buffer
+ * in the meantime, so that packing the next batch of strings overlaps with
+ * sending the last one. The buffer is sent in chunks, as the bytes of a
+ * fragment may exceed the int count of MPI.
  */
 template <>
 class ShuffleUnit<std::string> {
  public:
-  ShuffleUnit() {}
-  ~ShuffleUnit() {}
+  ShuffleUnit() : current_(0) {}
+  ~ShuffleUnit() { waitSending(); }
   using BufferT = RSVector;
   using ValueT = RefString;
 
-  void emplace(const ValueT& v) { buffer_.emplace(v); }
-  void clear() { buffer_.clear(); }
-  size_t size() const { return buffer_.size(); }
-  BufferT& data() { return buffer_; }
-  const BufferT& data() const { return buffer_; }
+  void emplace(const ValueT& v) { buffers_[current_].emplace(v); }
+  void clear() { buffers_[current_].clear(); }
+  size_t size() const { return buffers_[current_].size(); }
+  BufferT& data() { return buffers_[current_]; }
+  const BufferT& data() const { return buffers_[current_]; }
 
   void SendTo(int dst_worker_id, int tag, MPI_Comm comm) {
-    rsv_header header(buffer_.size_in_bytes(), buffer_.size());
-    MPI_Send(&header, static_cast<int>(sizeof(rsv_header)), MPI_CHAR,
-             dst_worker_id, tag, comm);
-    if (header.size) {
-      MPI_Send(buffer_.data(), static_cast<int>(header.size), MPI_CHAR,
-               dst_worker_id, tag, comm);
+    // at most one buffer of the unit is in flight
+    waitSending();
+    auto& buffer = buffers_[current_];
+    header_ = rsv_header(buffer.size_in_bytes(), buffer.size());
+    requests_.emplace_back();
+    MPI_Isend(&header_, static_cast<int>(sizeof(rsv_header)), MPI_CHAR,
+              dst_worker_id, tag, comm, &requests_.back());
+    for (size_t offset = 0; offset < header_.size; offset += kChunkSize) {
+      requests_.emplace_back();
+      MPI_Isend(buffer.data() + offset, chunkAt(header_.size, offset),
+                MPI_CHAR, dst_worker_id, tag, comm, &requests_.back());
     }
+    current_ ^= 1;
+    buffers_[current_].clear();
   }
 
   void RecvFrom(int src_worker_id, int tag, MPI_Comm comm) {
-    size_t old_size = buffer_.size_in_bytes();
+    auto& buffer = buffers_[current_];
+    size_t old_size = buffer.size_in_bytes();
     rsv_header header;
     MPI_Recv(&header, static_cast<int>(sizeof(rsv_header)), MPI_CHAR,
              src_worker_id, tag, comm, MPI_STATUS_IGNORE);
     if (header.size) {
-      buffer_.resize(header.size + old_size, header.count + buffer_.size());
-      MPI_Recv(buffer_.data() + old_size, static_cast<int>(header.size),
-               MPI_CHAR, src_worker_id, tag, comm, MPI_STATUS_IGNORE);
+      buffer.resize(header.size + old_size, header.count + buffer.size());
+      for (size_t offset = 0; offset < header.size; offset += kChunkSize) {
+        MPI_Recv(buffer.data() + old_size + offset,
+                 chunkAt(header.size, offset), MPI_CHAR, src_worker_id, tag,
+                 comm, MPI_STATUS_IGNORE);
+      }
     }
   }
 
  private:
+  static constexpr size_t kChunkSize = size_t(1) << 30;
+
   struct rsv_header {
     rsv_header() {}
     rsv_header(size_t s, size_t c) : size(s), count(c) {}
     size_t size;
     size_t count;
   };
-  BufferT buffer_;
+
+  static int chunkAt(size_t size, size_t offset) {
+    return static_cast<int>(size - offset < kChunkSize ? size - offset
+                                                       : kChunkSize);
+  }
+
+  void waitSending() {
+    if (!requests_.empty()) {
+      MPI_Waitall(static_cast<int>(requests_.size()), requests_.data(),
+                  MPI_STATUSES_IGNORE);
+      requests_.clear();
+    }
+  }
+
+  // the buffer being filled, and the one in flight
+  BufferT buffers_[2];
+  int current_;
+  rsv_header header_;
+  std::vector<MPI_Request> requests_;
 };
 
 }  // namespace grape
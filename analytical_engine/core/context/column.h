@@ -80,6 +80,7 @@ class Column : public IColumn {
     typename vineyard::ConvertToArrowType<DATA_T>::BuilderType builder;
     std::shared_ptr<typename vineyard::ConvertToArrowType<DATA_T>::ArrayType>
         ret;
+    CHECK_ARROW_ERROR(builder.Reserve(range.size()));
     for (auto v : range) {
       CHECK_ARROW_ERROR(builder.Append(data_[v]));
     }
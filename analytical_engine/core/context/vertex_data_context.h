@@ -103,8 +103,32 @@ class VertexDataContext<FRAG_T, gs::dynamic::Value> : public ContextBase {
 namespace gs {
 class IFragmentWrapper;
 
+/**
+ * @brief Fixed width results of the contiguous inner vertices are appended to
+ * the builder as a whole.
+ */
+template <typename FRAG_T, typename DATA_T>
+typename std::enable_if<std::is_arithmetic<DATA_T>::value &&
+                            !std::is_same<DATA_T, bool>::value,
+                        bl::result<std::shared_ptr<arrow::Array>>>::type
+context_data_to_arrow_array(
+    const typename FRAG_T::vertex_range_t& vertices,
+    const typename FRAG_T::template vertex_array_t<DATA_T>& data) {
+  typename vineyard::ConvertToArrowType<DATA_T>::BuilderType builder;
+  std::shared_ptr<typename vineyard::ConvertToArrowType<DATA_T>::ArrayType> arr;
+
+  if (vertices.size() > 0) {
+    ARROW_OK_OR_RAISE(
+        builder.AppendValues(&data[*vertices.begin()], vertices.size()));
+  }
+  CHECK_ARROW_ERROR(builder.Finish(&arr));
+  return std::dynamic_pointer_cast<arrow::Array>(arr);
+}
+
 template <typename FRAG_T, typename DATA_T>
-typename std::enable_if<!is_dynamic<DATA_T>::value,
+typename std::enable_if<!is_dynamic<DATA_T>::value &&
+                            !(std::is_arithmetic<DATA_T>::value &&
+                              !std::is_same<DATA_T, bool>::value),
                         bl::result<std::shared_ptr<arrow::Array>>>::type
 context_data_to_arrow_array(
     const typename FRAG_T::vertex_range_t& vertices,
@@ -112,6 +136,7 @@ context_data_to_arrow_array(
   typename vineyard::ConvertToArrowType<DATA_T>::BuilderType builder;
   std::shared_ptr<typename vineyard::ConvertToArrowType<DATA_T>::ArrayType> arr;
 
+  ARROW_OK_OR_RAISE(builder.Reserve(vertices.size()));
   for (auto v : vertices) {
     ARROW_OK_OR_RAISE(builder.Append(data[v]));
   }
@@ -270,9 +295,9 @@ class VertexDataContextWrapper : public IVertexDataContextWrapper {
         *arc << total_num;
       }
       old_size = arc->GetSize();
-      for (auto v : vertices) {
-        *arc << data[v];
-      }
+      serialize_column(*arc, vertices.size(), [&](size_t i) -> decltype(auto) {
+        return data[vertices[i]];
+      });
       break;
     }
     default:
@@ -349,9 +374,10 @@ class VertexDataContextWrapper : public IVertexDataContextWrapper {
           *arc << static_cast<int>(vineyard::TypeToInt<data_t>::value);
         }
         old_size = arc->GetSize();
-        for (auto v : vertices) {
-          *arc << data[v];
-        }
+        serialize_column(*arc, vertices.size(),
+                         [&](size_t i) -> decltype(auto) {
+                           return data[vertices[i]];
+                         });
         break;
       }
       default:
@@ -985,9 +1011,9 @@ class LabeledVertexDataContextWrapper
     auto& ctx_data = ctx_->data();
     auto& labeled_data = ctx_data[label_id];
 
-    for (auto v : vertices) {
-      arc << labeled_data[v];
-    }
+    serialize_column(arc, vertices.size(), [&](size_t i) -> decltype(auto) {
+      return labeled_data[vertices[i]];
+    });
   }
 
   std::shared_ptr<IFragmentWrapper> frag_wrapper_;
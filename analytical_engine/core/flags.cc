@@ -29,3 +29,10 @@ DEFINE_string(etcd_endpoint, "http://127.0.0.1:2379",
               "Etcd endpoint that will be used to launch vineyardd");
 
 DEFINE_string(dag_file, "", "Engine reads serialized dag proto from dag_file.");
+
+DEFINE_int32(projection_cache_size, 4,
+             "Number of unused projected graphs kept for reuse, 0 disables");
+
+DEFINE_bool(numa_interleave, false,
+            "Interleave memory across NUMA nodes, for workers running threads "
+            "on more than one socket");
@@ -23,6 +23,10 @@ DECLARE_int32(port);
 
 DECLARE_string(dag_file);
 
+DECLARE_int32(projection_cache_size);
+
+DECLARE_bool(numa_interleave);
+
 // vineyard
 DECLARE_string(vineyard_socket);
 DECLARE_string(vineyard_shared_mem);
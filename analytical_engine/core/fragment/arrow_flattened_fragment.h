@@ -16,10 +16,12 @@
 #ifndef ANALYTICAL_ENGINE_CORE_FRAGMENT_ARROW_FLATTENED_FRAGMENT_H_
 #define ANALYTICAL_ENGINE_CORE_FRAGMENT_ARROW_FLATTENED_FRAGMENT_H_
 
+#include <algorithm>
 #include <cstddef>
 #include <memory>
 #include <set>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -40,6 +42,11 @@ namespace gs {
 
 namespace arrow_flattened_fragment_impl {
 
+/**
+ * @brief Translates between the lids of the ArrowFragment and the continuous
+ * lids of the flattened fragment. The lid of each continuous lid is
+ * materialized once in Init, so that both directions are O(1).
+ */
 template <typename ID_TYPE>
 class UnionIdParser {
   using fid_t = unsigned;
@@ -62,21 +69,29 @@ class UnionIdParser {
     for (auto n : ivnums_) {
       ivnum_ += n;
     }
+
+    ID_TYPE tvnum = vertex_range_offset_.empty() ? 0
+                                                 : vertex_range_offset_.back();
+    lids_.resize(tvnum);
+    vineyard::parallel_for(
+        static_cast<ID_TYPE>(0), tvnum,
+        [this](ID_TYPE v) {
+          size_t index = getVertexRangeOffsetIndex(v);
+          LabelIDT label_id = (index - 1) % vertex_label_num_;
+          int64_t offset = v - vertex_range_offset_[index - 1];
+          if (v >= ivnum_) {
+            offset += ivnums_[label_id];
+          }
+          lids_[v] = vid_parser_.GenerateId(0, label_id, offset);
+        },
+        std::thread::hardware_concurrency(), 1024);
   }
 
   LabelIDT GetLabelId(ID_TYPE v) const {
-    return (getVertexRangeOffsetIndex(v) - 1) % vertex_label_num_;
+    return vid_parser_.GetLabelId(lids_[v]);
   }
 
-  int64_t GetOffset(ID_TYPE v) const {
-    size_t index = getVertexRangeOffsetIndex(v);
-    if (v < ivnum_) {
-      // inner vertex
-      return v - vertex_range_offset_[index - 1];
-    } else {
-      return v - vertex_range_offset_[index - 1] + ivnums_[GetLabelId(v)];
-    }
-  }
+  int64_t GetOffset(ID_TYPE v) const { return vid_parser_.GetOffset(lids_[v]); }
 
   ID_TYPE GenerateContinuousLid(ID_TYPE lid) const {
     LabelIDT label_id = vid_parser_.GetLabelId(lid);
@@ -91,18 +106,14 @@ class UnionIdParser {
   }
 
   ID_TYPE ParseContinuousLid(ID_TYPE cont_lid) const {
-    return vid_parser_.GenerateId(0, GetLabelId(cont_lid), GetOffset(cont_lid));
+    return lids_[cont_lid];
   }
 
  private:
   size_t getVertexRangeOffsetIndex(ID_TYPE v) const {
-    size_t index = 0;
-    for (size_t i = 0; i < vertex_range_offset_.size(); ++i) {
-      if (vertex_range_offset_[i] > v) {
-        index = i;
-        break;
-      }
-    }
+    size_t index = std::upper_bound(vertex_range_offset_.begin(),
+                                    vertex_range_offset_.end(), v) -
+                   vertex_range_offset_.begin();
     CHECK_NE(index, 0);
     return index;
   }
@@ -115,6 +126,8 @@ class UnionIdParser {
   std::vector<ID_TYPE> ivnums_;
   std::vector<ID_TYPE> ovnums_;
   vineyard::IdParser<ID_TYPE> vid_parser_;
+  // lids in the ArrowFragment, indexed by continuous lids
+  std::vector<ID_TYPE> lids_;
 };
 
 /**
@@ -134,9 +147,9 @@ struct NbrDefault {
  public:
   explicit NbrDefault(const prop_id_t& default_prop_id,
                       const UnionIdParser<VID_T>& union_id_parser)
-      : default_prop_id_(default_prop_id), union_id_parser_(union_id_parser) {}
+      : default_prop_id_(default_prop_id), union_id_parser_(&union_id_parser) {}
   NbrDefault(const nbr_t& nbr, const prop_id_t& default_prop_id,
-             const UnionIdParser<VID_T>& union_id_parser)
+             const UnionIdParser<VID_T>* union_id_parser)
       : nbr_(nbr),
         default_prop_id_(default_prop_id),
         union_id_parser_(union_id_parser) {}
@@ -159,7 +172,7 @@ struct NbrDefault {
   NbrDefault& operator=(NbrDefault&& rhs) {
     nbr_ = std::move(rhs.nbr_);
     default_prop_id_ = rhs.default_prop_id_;
-    union_id_parser_ = std::move(rhs.union_id_parser_);
+    union_id_parser_ = rhs.union_id_parser_;
     return *this;
   }
 
@@ -175,12 +188,13 @@ struct NbrDefault {
 
   grape::Vertex<VID_T> neighbor() const {
     return grape::Vertex<VID_T>(
-        union_id_parser_.GenerateContinuousLid(nbr_.neighbor().GetValue()));
+        union_id_parser_->GenerateContinuousLid(nbr_.neighbor().GetValue()));
   }
 
   grape::Vertex<VID_T> get_neighbor() const {
     return grape::Vertex<VID_T>(
-        union_id_parser_.GenerateContinuousLid(nbr_.get_neighbor().GetValue()));
+        union_id_parser_->GenerateContinuousLid(
+            nbr_.get_neighbor().GetValue()));
   }
 
   grape::Vertex<VID_T> raw_neighbor() const { return nbr_.neighbor(); }
@@ -205,7 +219,7 @@ struct NbrDefault {
   }
 
   inline NbrDefault operator++(int) const {
-    NbrDefault ret(nbr_, default_prop_id_);
+    NbrDefault ret(nbr_, default_prop_id_, union_id_parser_);
     ++(*this);
     return ret;
   }
@@ -216,7 +230,7 @@ struct NbrDefault {
   }
 
   inline NbrDefault operator--(int) const {
-    NbrDefault ret(nbr_, default_prop_id_);
+    NbrDefault ret(nbr_, default_prop_id_, union_id_parser_);
     --(*this);
     return ret;
   }
@@ -238,7 +252,8 @@ struct NbrDefault {
  private:
   nbr_t nbr_;
   prop_id_t default_prop_id_;
-  UnionIdParser<VID_T> union_id_parser_;
+  // owned by the fragment, rather than copied into every neighbor
+  const UnionIdParser<VID_T>* union_id_parser_;
 };
 
 /**
@@ -266,7 +281,7 @@ class UnionAdjList {
                         const FRAGMENT_T* fragment)
       : adj_lists_(adj_lists),
         default_prop_id_(default_prop_id),
-        union_id_parser_(union_id_parser),
+        union_id_parser_(&union_id_parser),
         fragment_(fragment) {
     size_ = 0;
     for (auto& adj_list : adj_lists_) {
@@ -280,7 +295,7 @@ class UnionAdjList {
                         const FRAGMENT_T* fragment)
       : adj_lists_(std::move(adj_lists)),
         default_prop_id_(default_prop_id),
-        union_id_parser_(union_id_parser),
+        union_id_parser_(&union_id_parser),
         fragment_(fragment) {
     size_ = 0;
     for (auto& adj_list : adj_lists_) {
@@ -437,22 +452,22 @@ class UnionAdjList {
   iterator begin() {
     if (size_ == 0) {
       nbr_unit_t nbr;
-      return iterator(adj_lists_, nbr, default_prop_id_, 0, union_id_parser_,
+      return iterator(adj_lists_, nbr, default_prop_id_, 0, *union_id_parser_,
                       fragment_);
     } else {
       return iterator(adj_lists_, adj_lists_.front().begin(), default_prop_id_,
-                      0, union_id_parser_, fragment_);
+                      0, *union_id_parser_, fragment_);
     }
   }
 
   iterator end() {
     if (size_ == 0) {
       nbr_unit_t nbr;
-      return iterator(adj_lists_, nbr, default_prop_id_, 0, union_id_parser_,
+      return iterator(adj_lists_, nbr, default_prop_id_, 0, *union_id_parser_,
                       fragment_);
     } else {
       return iterator(adj_lists_, adj_lists_.back().end(), default_prop_id_,
-                      adj_lists_.size(), union_id_parser_, fragment_);
+                      adj_lists_.size(), *union_id_parser_, fragment_);
     }
   }
 
@@ -460,10 +475,10 @@ class UnionAdjList {
     if (size_ == 0) {
       nbr_unit_t nbr;
       return const_iterator(adj_lists_, nbr, default_prop_id_, 0,
-                            union_id_parser_, fragment_);
+                            *union_id_parser_, fragment_);
     } else {
       return const_iterator(adj_lists_, adj_lists_.front().begin(),
-                            default_prop_id_, 0, union_id_parser_, fragment_);
+                            default_prop_id_, 0, *union_id_parser_, fragment_);
     }
   }
 
@@ -471,11 +486,11 @@ class UnionAdjList {
     if (size_ == 0) {
       nbr_unit_t nbr;
       return const_iterator(adj_lists_, nbr, default_prop_id_, 0,
-                            union_id_parser_, fragment_);
+                            *union_id_parser_, fragment_);
     } else {
       return const_iterator(adj_lists_, adj_lists_.back().end(),
                             default_prop_id_, adj_lists_.size(),
-                            union_id_parser_, fragment_);
+                            *union_id_parser_, fragment_);
     }
   }
 
@@ -488,7 +503,7 @@ class UnionAdjList {
  private:
   std::vector<adj_list_t> adj_lists_;
   prop_id_t default_prop_id_;
-  UnionIdParser<VID_T> union_id_parser_;
+  const UnionIdParser<VID_T>* union_id_parser_;
   const FRAGMENT_T* fragment_;
   size_t size_;
 };
@@ -631,6 +646,14 @@ class ArrowFlattenedFragment {
     // init id parser
     union_id_parser_.Init(fragment_->fnum(), vertex_label_num,
                           union_vertex_range_offset_, ivnums_, ovnums_);
+
+    label_id_t edge_label_num =
+        static_cast<label_id_t>(schema_.AllEdgeEntries().size());
+    for (label_id_t e_label = 0; e_label < edge_label_num; e_label++) {
+      if (schema_.IsEdgeValid(e_label)) {
+        edge_labels_.push_back(e_label);
+      }
+    }
   }
 
   virtual ~ArrowFlattenedFragment() = default;
@@ -821,14 +844,8 @@ class ArrowFlattenedFragment {
     vertex_t v_(union_id_parser_.ParseContinuousLid(v.GetValue()));
     std::vector<vineyard::property_graph_utils::AdjList<vid_t, eid_t>>
         adj_lists;
-    adj_lists.reserve(fragment_->edge_label_num());
-    auto& schema = fragment_->schema();
-    label_id_t edge_label_num =
-        static_cast<label_id_t>(schema.AllEdgeEntries().size());
-    for (label_id_t e_label = 0; e_label < edge_label_num; e_label++) {
-      if (!schema.IsEdgeValid(e_label)) {
-        continue;
-      }
+    adj_lists.reserve(edge_labels_.size());
+    for (label_id_t e_label : edge_labels_) {
       auto adj_list = fragment_->GetOutgoingAdjList(v_, e_label);
       if (adj_list.NotEmpty()) {
         adj_lists.push_back(adj_list);
@@ -841,14 +858,8 @@ class ArrowFlattenedFragment {
     vertex_t v_(union_id_parser_.ParseContinuousLid(v.GetValue()));
     std::vector<vineyard::property_graph_utils::AdjList<vid_t, eid_t>>
         adj_lists;
-    adj_lists.reserve(fragment_->edge_label_num());
-    auto& schema = fragment_->schema();
-    label_id_t edge_label_num =
-        static_cast<label_id_t>(schema.AllEdgeEntries().size());
-    for (label_id_t e_label = 0; e_label < edge_label_num; e_label++) {
-      if (!schema.IsEdgeValid(e_label)) {
-        continue;
-      }
+    adj_lists.reserve(edge_labels_.size());
+    for (label_id_t e_label : edge_labels_) {
       auto adj_list = fragment_->GetIncomingAdjList(v_, e_label);
       if (adj_list.NotEmpty()) {
         adj_lists.push_back(adj_list);
@@ -860,13 +871,7 @@ class ArrowFlattenedFragment {
   inline int GetLocalOutDegree(const vertex_t& v) const {
     vertex_t v_(union_id_parser_.ParseContinuousLid(v.GetValue()));
     int local_out_degree = 0;
-    auto& schema = fragment_->schema();
-    label_id_t edge_label_num =
-        static_cast<label_id_t>(schema.AllEdgeEntries().size());
-    for (label_id_t e_label = 0; e_label < edge_label_num; e_label++) {
-      if (!schema.IsEdgeValid(e_label)) {
-        continue;
-      }
+    for (label_id_t e_label : edge_labels_) {
       local_out_degree += fragment_->GetLocalOutDegree(v_, e_label);
     }
     return local_out_degree;
@@ -875,13 +880,7 @@ class ArrowFlattenedFragment {
   inline int GetLocalInDegree(const vertex_t& v) const {
     vertex_t v_(union_id_parser_.ParseContinuousLid(v.GetValue()));
     int local_in_degree = 0;
-    auto& schema = fragment_->schema();
-    label_id_t edge_label_num =
-        static_cast<label_id_t>(schema.AllEdgeEntries().size());
-    for (label_id_t e_label = 0; e_label < edge_label_num; e_label++) {
-      if (!schema.IsEdgeValid(e_label)) {
-        continue;
-      }
+    for (label_id_t e_label : edge_labels_) {
       local_in_degree += fragment_->GetLocalInDegree(v_, e_label);
     }
     return local_in_degree;
@@ -890,14 +889,8 @@ class ArrowFlattenedFragment {
   inline dest_list_t IEDests(const vertex_t& v) const {
     vertex_t v_(union_id_parser_.ParseContinuousLid(v.GetValue()));
     std::vector<grape::DestList> dest_lists;
-    dest_lists.reserve(fragment_->edge_label_num());
-    auto& schema = fragment_->schema();
-    label_id_t edge_label_num =
-        static_cast<label_id_t>(schema.AllEdgeEntries().size());
-    for (label_id_t e_label = 0; e_label < edge_label_num; e_label++) {
-      if (!schema.IsEdgeValid(e_label)) {
-        continue;
-      }
+    dest_lists.reserve(edge_labels_.size());
+    for (label_id_t e_label : edge_labels_) {
       dest_lists.push_back(fragment_->IEDests(v_, e_label));
     }
     return dest_list_t(dest_lists);
@@ -906,14 +899,8 @@ class ArrowFlattenedFragment {
   inline dest_list_t OEDests(const vertex_t& v) const {
     vertex_t v_(union_id_parser_.ParseContinuousLid(v.GetValue()));
     std::vector<grape::DestList> dest_lists;
-    dest_lists.reserve(fragment_->edge_label_num());
-    auto& schema = fragment_->schema();
-    label_id_t edge_label_num =
-        static_cast<label_id_t>(schema.AllEdgeEntries().size());
-    for (label_id_t e_label = 0; e_label < edge_label_num; e_label++) {
-      if (!schema.IsEdgeValid(e_label)) {
-        continue;
-      }
+    dest_lists.reserve(edge_labels_.size());
+    for (label_id_t e_label : edge_labels_) {
       dest_lists.push_back(fragment_->OEDests(v_, e_label));
     }
     return dest_list_t(dest_lists);
@@ -922,14 +909,8 @@ class ArrowFlattenedFragment {
   inline dest_list_t IOEDests(const vertex_t& v) const {
     vertex_t v_(union_id_parser_.ParseContinuousLid(v.GetValue()));
     std::vector<grape::DestList> dest_lists;
-    dest_lists.reserve(fragment_->edge_label_num());
-    auto& schema = fragment_->schema();
-    label_id_t edge_label_num =
-        static_cast<label_id_t>(schema.AllEdgeEntries().size());
-    for (label_id_t e_label = 0; e_label < edge_label_num; e_label++) {
-      if (!schema.IsEdgeValid(e_label)) {
-        continue;
-      }
+    dest_lists.reserve(edge_labels_.size());
+    for (label_id_t e_label : edge_labels_) {
       dest_lists.push_back(fragment_->IOEDests(v_, e_label));
     }
     return dest_list_t(dest_lists);
@@ -948,6 +929,8 @@ class ArrowFlattenedFragment {
 
   arrow_flattened_fragment_impl::UnionIdParser<vid_t> union_id_parser_;
   std::vector<vid_t> union_vertex_range_offset_;
+  // valid edge labels, iterated by every adjacency accessor
+  std::vector<label_id_t> edge_labels_;
 };
 
 }  // namespace gs
@@ -241,9 +241,7 @@ class CompactNbr {
     decode();
 
     // move the pointer to the correct offset after first decode
-    for (size_t i = 0; i < offset % batch_size; ++i) {
-      ++(*this);
-    }
+    seek(offset % batch_size);
   }
 
   CompactNbr(const CompactNbr& rhs)
@@ -301,6 +299,24 @@ class CompactNbr {
   inline const CompactNbr* operator->() const { return this; }
 
  private:
+  /**
+   * @brief Skip the first `skip` neighbors of the first batch, as `skip`
+   * increments do, summing up their delta encoded ids in one pass.
+   */
+  inline void seek(size_t skip) const {
+    // the end has nothing decoded, only its position is compared
+    if (skip == 0 || size_ == 0) {
+      return;
+    }
+    for (size_t i = 1; i <= skip; ++i) {
+      data_[i].vid += data_[i - 1].vid;
+    }
+    current_ = skip;
+    if (current_ >= size_) {
+      nbr_ = next_;
+    }
+  }
+
   inline void decode() const {
     if (likely((current_ % batch_size != 0) || current_ >= size_)) {
       if (unlikely(current_ == size_)) {
@@ -404,9 +420,7 @@ class CompactNbr<VID_T, EID_T, grape::EmptyType> {
     decode();
 
     // move the pointer to the correct offset after first decode
-    for (size_t i = 0; i < offset % batch_size; ++i) {
-      ++(*this);
-    }
+    seek(offset % batch_size);
   }
 
   CompactNbr(const CompactNbr& rhs)
@@ -458,6 +472,24 @@ class CompactNbr<VID_T, EID_T, grape::EmptyType> {
   inline const CompactNbr* operator->() const { return this; }
 
  private:
+  /**
+   * @brief Skip the first `skip` neighbors of the first batch, as `skip`
+   * increments do, summing up their delta encoded ids in one pass.
+   */
+  inline void seek(size_t skip) const {
+    // the end has nothing decoded, only its position is compared
+    if (skip == 0 || size_ == 0) {
+      return;
+    }
+    for (size_t i = 1; i <= skip; ++i) {
+      data_[i].vid += data_[i - 1].vid;
+    }
+    current_ = skip;
+    if (current_ >= size_) {
+      nbr_ = next_;
+    }
+  }
+
   inline void decode() const {
     if (likely((current_ % batch_size != 0) || current_ >= size_)) {
       if (unlikely(current_ == size_)) {
@@ -522,6 +554,38 @@ class AdjList {
   TypedArray<EDATA_T> edata_array_;
 };
 
+/**
+ * @brief Decode the varint and delta encoded neighbors in [begin, end) batch
+ * by batch, and call func on each of the `size` ones starting at the
+ * `offset % batch_size`-th of the first batch.
+ */
+template <typename VID_T, typename EID_T, typename FUNC_T>
+inline void forEachBatch(const uint8_t* begin, const uint8_t* end,
+                         size_t offset, size_t size, const FUNC_T& func) {
+  using nbr_unit_t = vineyard::property_graph_utils::NbrUnit<VID_T, EID_T>;
+  static constexpr size_t element_size = sizeof(nbr_unit_t) / sizeof(uint32_t);
+  static constexpr size_t batch_size = VARINT_ENCODING_BATCH_SIZE;
+  nbr_unit_t data[batch_size];  // NOLINT(runtime/arrays)
+
+  const uint8_t* next = begin;
+  VID_T prev_vid = 0;
+  for (size_t current = 0; current < size && next != end;
+       current += batch_size) {
+    size_t n = (current + batch_size) < size ? batch_size : (size - current);
+    next = v8dec32(
+        const_cast<unsigned char*>(reinterpret_cast<const unsigned char*>(next)),
+        n * element_size, reinterpret_cast<uint32_t*>(data));
+    data[0].vid += prev_vid;
+    for (size_t i = 1; i < n; ++i) {
+      data[i].vid += data[i - 1].vid;
+    }
+    prev_vid = data[n - 1].vid;
+    for (size_t i = current == 0 ? offset % batch_size : 0; i < n; ++i) {
+      func(data[i]);
+    }
+  }
+}
+
 template <typename VID_T, typename EID_T, typename EDATA_T>
 class CompactAdjList {
   using vid_t = VID_T;
@@ -580,6 +644,19 @@ class CompactAdjList {
     return CompactNbr<VID_T, EID_T, EDATA_T>(end_, offset_, 0, edata_array_);
   }
 
+  /**
+   * @brief Visit the neighbors in the order of iterating from begin() to
+   * end(). Each batch is decoded and its delta encoded ids summed up in a
+   * single pass, rather than checked neighbor by neighbor as CompactNbr does.
+   */
+  template <typename FUNC_T>
+  inline void ForEach(const FUNC_T& func) const {
+    forEachBatch<VID_T, EID_T>(
+        begin_, end_, offset_, size_, [&](const nbr_unit_t& nbr) {
+          func(grape::Vertex<vid_t>(nbr.vid), edata_array_[nbr.eid]);
+        });
+  }
+
   size_t Size() const { return size_; }
 
   size_t Offset() const { return offset_; }
@@ -677,6 +754,18 @@ class CompactAdjList<VID_T, EID_T, grape::EmptyType> {
     return CompactNbr<VID_T, EID_T, grape::EmptyType>(end_, offset_, 0);
   }
 
+  /**
+   * @brief Visit the neighbors in the order of iterating from begin() to
+   * end(). Each batch is decoded and its delta encoded ids summed up in a
+   * single pass, rather than checked neighbor by neighbor as CompactNbr does.
+   */
+  template <typename FUNC_T>
+  inline void ForEach(const FUNC_T& func) const {
+    forEachBatch<VID_T, EID_T>(
+        begin_, end_, offset_, size_,
+        [&](const nbr_unit_t& nbr) { func(grape::Vertex<vid_t>(nbr.vid)); });
+  }
+
   size_t Size() const { return size_; }
 
   size_t Offset() const { return offset_; }
@@ -22,12 +22,14 @@
 
 #include <algorithm>
 #include <cassert>
+#include <deque>
 #include <limits>
 #include <map>
 #include <memory>
 #include <ostream>
 #include <set>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -39,6 +41,8 @@
 #include "vineyard/graph/fragment/property_graph_types.h"
 
 #include "core/config.h"
+#include "core/fragment/dynamic_fragment_delta.h"
+#include "core/fragment/dynamic_vertex_columns.h"
 #include "core/object/dynamic.h"
 #include "core/utils/convert_utils.h"
 #include "core/utils/partitioner.h"
@@ -90,6 +94,9 @@ class DynamicFragment
       grape::LoadStrategy::kOnlyOut;
 
   static constexpr double dense_threshold = 0.003;
+  // edges put by each thread at least when adding edges in parallel
+  static constexpr size_t kMinEdgesPerThread = 4096;
+  static constexpr vid_t kOwnerChunkSize = 64;
 
   using vertex_map_t = typename traits_t::vertex_map_t;
   using partitioner_t = typename vertex_map_t::partitioner_t;
@@ -183,6 +190,7 @@ class DynamicFragment
         }
       }
     }
+    vcolumns_.Clear();
 
     initSchema();
   }
@@ -248,6 +256,7 @@ class DynamicFragment
           },
           thread_num, 1);
     }
+    vcolumns_.Clear();
 
     initSchema();
   }
@@ -256,7 +265,12 @@ class DynamicFragment
   using base_t::ie_;
   using base_t::oe_;
   using base_t::vm_ptr_;
-  void Mutate(mutation_t& mutation) {
+  /**
+   * @brief Apply the mutation. Edges added in bulk are put by thread_num
+   * threads, each owning the adjacent lists of a disjoint set of vertices.
+   */
+  void Mutate(mutation_t& mutation, uint32_t thread_num = 1) {
+    vcolumns_.Clear();
     vertex_t v;
     if (!mutation.vertices_to_remove.empty() &&
         static_cast<double>(mutation.vertices_to_remove.size()) /
@@ -371,7 +385,7 @@ class DynamicFragment
         initOuterVerticesOfFragment();
       }
       if (!edges_to_add.empty()) {
-        addEdges(edges_to_add);
+        addEdges(edges_to_add, thread_num);
       }
 
       this->inner_vertices_.SetRange(0, new_ivnum);
@@ -446,8 +460,23 @@ class DynamicFragment
   inline void SetData(const vertex_t& v, const vdata_t& val) override {
     CHECK(IsInnerVertex(v));
     ivdata_[v.GetValue()] = val;
+    vcolumns_.Clear();
   }
 
+  /**
+   * @brief The typed column of a vertex property, indexed by the local id of
+   * inner vertices. Returns nullptr when some alive inner vertex lacks the key
+   * or holds a value not of type T, the dynamic values should be read then.
+   */
+  template <typename T>
+  std::shared_ptr<const std::vector<T>> GetVertexColumn(
+      const std::string& key) const {
+    return vcolumns_.template Get<T>(key, ivdata_, iv_alive_, ivnum_);
+  }
+
+  // The modifications since the results kept by incremental apps.
+  DynamicFragmentDelta<vid_t>& GetDelta() const { return delta_; }
+
   bool OuterVertexGid2Lid(vid_t gid, vid_t& lid) const override {
     auto iter = ovg2i_.find(gid);
     if (iter != ovg2i_.end()) {
@@ -973,7 +1002,7 @@ class DynamicFragment
     }
   }
 
-  void addEdges(std::vector<edge_t>& edges) {
+  void addEdges(std::vector<edge_t>& edges, uint32_t thread_num) {
     double rate = 0;
     if (directed_) {
       rate = static_cast<double>(edges.size()) /
@@ -986,108 +1015,127 @@ class DynamicFragment
     if (rate < dense_threshold) {
       addEdgesSparse(edges);
     } else {
-      addEdgesDense(edges);
+      thread_num = std::max<uint32_t>(
+          1, std::min<size_t>(thread_num, edges.size() / kMinEdgesPerThread));
+      addEdgesDense(edges, thread_num);
     }
   }
 
-  void addEdgesDense(std::vector<edge_t>& edges) {
+  // Vertices are assigned to threads by chunks, to keep the degree counters
+  // of different threads apart.
+  static inline uint32_t ownerThread(vid_t v, uint32_t thread_num) {
+    return (v / kOwnerChunkSize) % thread_num;
+  }
+
+  inline int& degreeToAdd(std::vector<int>& inner, std::vector<int>& outer,
+                          vid_t v) {
+    return v < ivnum_ ? inner[v] : outer[outerVertexLidToIndex(v)];
+  }
+
+  // Put the edge from u to v to csr, or update the data of the existing one.
+  // Return true if a new edge is put.
+  template <typename CSR_T>
+  static bool putOrUpdateEdge(CSR_T& csr, vid_t u, vid_t v,
+                              const edata_t& edata,
+                              dynamic::AllocatorT& allocator) {
+    auto iter = csr.find(u, v);
+    if (iter == csr.get_end(u)) {
+      edata_t data;
+      data.CopyFrom(edata, allocator);
+      csr.put_edge(u, nbr_t(v, std::move(data)));
+      return true;
+    }
+    iter->data.Update(edata, allocator);
+    return false;
+  }
+
+  /**
+   * Each edge is put to the outgoing list of its source, and to the incoming
+   * list (or the outgoing list when undirected) of its destination. These two
+   * halves are handled by the threads owning the source and the destination,
+   * in the order of the edges, so that updates of the same edge are applied
+   * as they are sequentially.
+   */
+  void addEdgesDense(std::vector<edge_t>& edges, uint32_t thread_num) {
     static constexpr vid_t invalid_vid = std::numeric_limits<vid_t>::max();
-    if (load_strategy_ == grape::LoadStrategy::kBothOutIn) {
-      std::vector<int> inner_oe_degree_to_add(ivnum_, 0),
-          inner_ie_degree_to_add(ivnum_, 0), outer_oe_degree_to_add(ovnum_, 0),
-          outer_ie_degree_to_add(ovnum_, 0);
-      // reserve edges
-      for (auto& e : edges) {
-        if (e.src == invalid_vid) {
-          continue;
-        }
-        if (e.src < ivnum_) {
-          ++inner_oe_degree_to_add[e.src];
-        } else {
-          ++outer_oe_degree_to_add[outerVertexLidToIndex(e.src)];
-        }
-        if (e.dst < ivnum_) {
-          ++inner_ie_degree_to_add[e.dst];
-        } else {
-          ++outer_ie_degree_to_add[outerVertexLidToIndex(e.dst)];
-        }
+    bool both = load_strategy_ == grape::LoadStrategy::kBothOutIn;
+    std::vector<int> inner_oe_degree_to_add(ivnum_, 0),
+        outer_oe_degree_to_add(ovnum_, 0), inner_ie_degree_to_add,
+        outer_ie_degree_to_add;
+    if (both) {
+      inner_ie_degree_to_add.resize(ivnum_, 0);
+      outer_ie_degree_to_add.resize(ovnum_, 0);
+    }
+    // the destination half goes to ie_ when directed, otherwise to oe_
+    auto& inner_dst_degree = both ? inner_ie_degree_to_add
+                                  : inner_oe_degree_to_add;
+    auto& outer_dst_degree = both ? outer_ie_degree_to_add
+                                  : outer_oe_degree_to_add;
+    auto& dst_csr = both ? ie_ : oe_;
+
+    // (edge index, whether it is the destination half) per thread
+    std::vector<std::vector<std::pair<size_t, bool>>> halves(thread_num);
+    for (size_t i = 0; i < edges.size(); ++i) {
+      const auto& e = edges[i];
+      if (e.src == invalid_vid) {
+        continue;
       }
-      oe_.reserve_edges_dense(inner_oe_degree_to_add, outer_oe_degree_to_add);
+      assert(!(e.src >= ivnum_ && e.dst >= ivnum_));
+      halves[ownerThread(e.src, thread_num)].emplace_back(i, false);
+      ++degreeToAdd(inner_oe_degree_to_add, outer_oe_degree_to_add, e.src);
+      if (both || e.src != e.dst) {
+        halves[ownerThread(e.dst, thread_num)].emplace_back(i, true);
+        ++degreeToAdd(inner_dst_degree, outer_dst_degree, e.dst);
+      }
+      if (e.src == e.dst) {
+        is_selfloops_.set_bit(e.src);
+      }
+    }
+    oe_.reserve_edges_dense(inner_oe_degree_to_add, outer_oe_degree_to_add);
+    if (both) {
       ie_.reserve_edges_dense(inner_ie_degree_to_add, outer_ie_degree_to_add);
+    }
 
-      // add edges
-      std::fill(inner_oe_degree_to_add.begin(), inner_oe_degree_to_add.end(),
-                0);
-      std::fill(outer_oe_degree_to_add.begin(), outer_oe_degree_to_add.end(),
-                0);
-      std::fill(inner_ie_degree_to_add.begin(), inner_ie_degree_to_add.end(),
-                0);
-      std::fill(outer_ie_degree_to_add.begin(), outer_ie_degree_to_add.end(),
-                0);
-      for (auto& e : edges) {
-        if (e.src == invalid_vid) {
-          continue;
-        }
-        if (updateOrAddEdgeOutIn(e)) {
-          if (e.src < ivnum_) {
-            ++inner_oe_degree_to_add[e.src];
-          } else {
-            ++outer_oe_degree_to_add[outerVertexLidToIndex(e.src)];
-          }
-          if (e.dst < ivnum_) {
-            ++inner_ie_degree_to_add[e.dst];
-          } else {
-            ++outer_ie_degree_to_add[outerVertexLidToIndex(e.dst)];
+    // add edges
+    std::fill(inner_oe_degree_to_add.begin(), inner_oe_degree_to_add.end(), 0);
+    std::fill(outer_oe_degree_to_add.begin(), outer_oe_degree_to_add.end(), 0);
+    std::fill(inner_ie_degree_to_add.begin(), inner_ie_degree_to_add.end(), 0);
+    std::fill(outer_ie_degree_to_add.begin(), outer_ie_degree_to_add.end(), 0);
+    while (mutation_allocators_.size() < thread_num) {
+      mutation_allocators_.emplace_back();
+    }
+    auto put_halves = [&](uint32_t tid) {
+      // a single thread keeps to the allocator of the other values
+      auto& allocator = thread_num == 1 ? dynamic::Value::allocator_
+                                        : mutation_allocators_[tid];
+      for (auto& half : halves[tid]) {
+        const auto& e = edges[half.first];
+        if (!half.second) {
+          if (putOrUpdateEdge(oe_, e.src, e.dst, e.edata, allocator)) {
+            ++degreeToAdd(inner_oe_degree_to_add, outer_oe_degree_to_add,
+                          e.src);
           }
+        } else if (putOrUpdateEdge(dst_csr, e.dst, e.src, e.edata,
+                                   allocator)) {
+          ++degreeToAdd(inner_dst_degree, outer_dst_degree, e.dst);
         }
       }
-      oe_.sort_neighbors_dense(inner_oe_degree_to_add, outer_oe_degree_to_add);
-      ie_.sort_neighbors_dense(inner_ie_degree_to_add, outer_ie_degree_to_add);
+    };
+    if (thread_num == 1) {
+      put_halves(0);
     } else {
-      std::vector<int> inner_oe_degree_to_add(ivnum_, 0),
-          outer_oe_degree_to_add(ovnum_, 0);
-      // reserve edges
-      for (auto& e : edges) {
-        if (e.src == invalid_vid) {
-          continue;
-        }
-        assert(!(e.src >= ivnum_ && e.dst >= ivnum_));
-        if (e.src < ivnum_) {
-          ++inner_oe_degree_to_add[e.src];
-        } else {
-          ++outer_oe_degree_to_add[outerVertexLidToIndex(e.src)];
-        }
-        if (e.dst < ivnum_) {
-          ++inner_oe_degree_to_add[e.dst];
-        } else {
-          ++outer_oe_degree_to_add[outerVertexLidToIndex(e.dst)];
-        }
+      std::vector<std::thread> threads;
+      for (uint32_t tid = 0; tid < thread_num; ++tid) {
+        threads.emplace_back(put_halves, tid);
       }
-      oe_.reserve_edges_dense(inner_oe_degree_to_add, outer_oe_degree_to_add);
-
-      // add edges
-      std::fill(inner_oe_degree_to_add.begin(), inner_oe_degree_to_add.end(),
-                0);
-      std::fill(outer_oe_degree_to_add.begin(), outer_oe_degree_to_add.end(),
-                0);
-      for (auto& e : edges) {
-        if (e.src == invalid_vid) {
-          continue;
-        }
-        if (updateOrAddEdgeOut(e)) {
-          if (e.src < ivnum_) {
-            ++inner_oe_degree_to_add[e.src];
-          } else {
-            ++outer_oe_degree_to_add[outerVertexLidToIndex(e.src)];
-          }
-          if (e.dst < ivnum_ && e.src != e.dst) {
-            ++inner_oe_degree_to_add[e.dst];
-          } else if (e.src != e.dst) {
-            ++outer_oe_degree_to_add[outerVertexLidToIndex(e.dst)];
-          }
-        }
+      for (auto& thrd : threads) {
+        thrd.join();
       }
-      oe_.sort_neighbors_dense(inner_oe_degree_to_add, outer_oe_degree_to_add);
+    }
+
+    oe_.sort_neighbors_dense(inner_oe_degree_to_add, outer_oe_degree_to_add);
+    if (both) {
+      ie_.sort_neighbors_dense(inner_ie_degree_to_add, outer_ie_degree_to_add);
     }
   }
 
@@ -1248,6 +1296,7 @@ class DynamicFragment
     ovgid_.resize(ovnum_);
     memcpy(&ovgid_[0], &(source->ovgid_[0]), ovnum_ * sizeof(vid_t));
 
+    vcolumns_.Clear();
     ivdata_.clear();
     ivdata_.resize(ivnum_);
     for (size_t i = 0; i < ivnum_; ++i) {
@@ -1472,6 +1521,9 @@ class DynamicFragment
   ska::flat_hash_map<vid_t, vid_t> ovg2i_;
   std::vector<vid_t> ovgid_;
   grape::Array<vdata_t, grape::Allocator<vdata_t>> ivdata_;
+  // typed columns inferred from ivdata_, dropped when it is modified
+  mutable DynamicVertexColumns<vid_t> vcolumns_;
+  mutable DynamicFragmentDelta<vid_t> delta_;
   grape::Bitset iv_alive_;
   grape::Bitset ov_alive_;
   grape::Bitset is_selfloops_;
@@ -1480,6 +1532,9 @@ class DynamicFragment
 
   // allocators for parallel convert
   std::shared_ptr<std::vector<dynamic::AllocatorT>> allocators_;
+  // allocators of the edge data put by parallel mutations, a deque keeps
+  // them in place as it grows
+  std::deque<dynamic::AllocatorT> mutation_allocators_;
 
   dynamic::Value schema_;
 
@@ -1564,6 +1619,7 @@ class DynamicFragmentMutator {
         mutation.vertices_to_remove.emplace_back(gid);
       }
     }
+    fragment_->delta_.Record(mutation);
     fragment_->Mutate(mutation);
   }
 
@@ -1648,7 +1704,12 @@ class DynamicFragmentMutator {
         }
       }
     }
-    fragment_->Mutate(mutation);
+    // workers on the same host share its cores
+    uint32_t thread_num =
+        (std::thread::hardware_concurrency() + comm_spec_.local_num() - 1) /
+        comm_spec_.local_num();
+    fragment_->delta_.Record(mutation);
+    fragment_->Mutate(mutation, std::max<uint32_t>(thread_num, 1));
   }
 
  private:
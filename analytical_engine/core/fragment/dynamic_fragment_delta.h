@@ -0,0 +1,162 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANALYTICAL_ENGINE_CORE_FRAGMENT_DYNAMIC_FRAGMENT_DELTA_H_
+#define ANALYTICAL_ENGINE_CORE_FRAGMENT_DYNAMIC_FRAGMENT_DELTA_H_
+
+#ifdef NETWORKX
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace gs {
+
+/**
+ * @brief The modifications of a DynamicFragment since the results kept by
+ * incremental apps, so that a later run repairs the kept result rather than
+ * computing from scratch.
+ *
+ * Every mutation bumps the version. The edges added by a mutation are logged
+ * only when some result is kept, and the log is truncated beyond
+ * kMaxLoggedEdges edges, after which the kept results cannot be repaired.
+ * Removals of edges or vertices are not logged, a result kept before a
+ * removal cannot be repaired either.
+ */
+template <typename VID_T>
+class DynamicFragmentDelta {
+ public:
+  using edge_t = std::pair<VID_T, VID_T>;
+  static constexpr size_t kMaxLoggedEdges = size_t(1) << 24;
+
+  DynamicFragmentDelta() = default;
+  DynamicFragmentDelta(const DynamicFragmentDelta&) = delete;
+  DynamicFragmentDelta& operator=(const DynamicFragmentDelta&) = delete;
+
+  uint64_t Version() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return version_;
+  }
+
+  /**
+   * @brief Record a mutation, whose edges are in global ids. Called before
+   * the mutation is applied.
+   */
+  template <typename MUTATION_T>
+  void Record(const MUTATION_T& mutation) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++version_;
+    if (!mutation.edges_to_remove.empty() ||
+        !mutation.vertices_to_remove.empty()) {
+      repairable_since_ = version_;
+    }
+    if (results_.empty() || mutation.edges_to_add.empty()) {
+      return;
+    }
+    if (logged_edges_ + mutation.edges_to_add.size() > kMaxLoggedEdges) {
+      log_.clear();
+      logged_edges_ = 0;
+      repairable_since_ = version_;
+      return;
+    }
+    log_.emplace_back();
+    log_.back().first = version_;
+    auto& edges = log_.back().second;
+    edges.reserve(mutation.edges_to_add.size());
+    for (auto& e : mutation.edges_to_add) {
+      edges.emplace_back(e.src, e.dst);
+    }
+    logged_edges_ += edges.size();
+  }
+
+  /**
+   * @brief The edges added after version, returns false if the fragment is
+   * modified otherwise since then.
+   */
+  bool AddedEdgesSince(uint64_t version, std::vector<edge_t>& edges) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (version < repairable_since_) {
+      return false;
+    }
+    for (auto& entry : log_) {
+      if (entry.first > version) {
+        edges.insert(edges.end(), entry.second.begin(), entry.second.end());
+      }
+    }
+    return true;
+  }
+
+  /**
+   * @brief Keep the result of an incremental app at the current version,
+   * indexed by the local id of inner vertices.
+   */
+  template <typename T>
+  void KeepResult(const std::string& key, std::vector<T>&& values) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& result = results_[key];
+    result.first = version_;
+    result.second = std::make_shared<const std::vector<T>>(std::move(values));
+    pruneLog();
+  }
+
+  /**
+   * @brief The kept result of key and its version, or nullptr if none.
+   */
+  template <typename T>
+  std::shared_ptr<const std::vector<T>> GetResult(const std::string& key,
+                                                  uint64_t& version) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto iter = results_.find(key);
+    if (iter == results_.end()) {
+      return nullptr;
+    }
+    version = iter->second.first;
+    return std::static_pointer_cast<const std::vector<T>>(iter->second.second);
+  }
+
+ private:
+  // drop the edges logged before all the kept results
+  void pruneLog() {
+    uint64_t oldest = std::numeric_limits<uint64_t>::max();
+    for (auto& pair : results_) {
+      oldest = std::min(oldest, pair.second.first);
+    }
+    while (!log_.empty() && log_.front().first <= oldest) {
+      logged_edges_ -= log_.front().second.size();
+      log_.pop_front();
+    }
+  }
+
+  mutable std::mutex mutex_;
+  uint64_t version_ = 0;
+  // results kept before this version cannot be repaired
+  uint64_t repairable_since_ = 0;
+  std::deque<std::pair<uint64_t, std::vector<edge_t>>> log_;
+  size_t logged_edges_ = 0;
+  std::map<std::string, std::pair<uint64_t, std::shared_ptr<const void>>>
+      results_;
+};
+
+}  // namespace gs
+
+#endif  // NETWORKX
+#endif  // ANALYTICAL_ENGINE_CORE_FRAGMENT_DYNAMIC_FRAGMENT_DELTA_H_
@@ -404,7 +404,11 @@ class DynamicProjectedFragment {
                            const std::string& e_prop_key)
       : fragment_(frag),
         v_prop_key_(std::move(v_prop_key)),
-        e_prop_key_(std::move(e_prop_key)) {}
+        e_prop_key_(std::move(e_prop_key)) {
+    if (!std::is_same<vdata_t, grape::EmptyType>::value) {
+      vcolumn_ = fragment_->GetVertexColumn<vdata_t>(v_prop_key_);
+    }
+  }
 
   static std::shared_ptr<DynamicProjectedFragment<VDATA_T, EDATA_T>> Project(
       const std::shared_ptr<DynamicFragment>& frag, const std::string& v_prop,
@@ -458,7 +462,10 @@ class DynamicProjectedFragment {
 
   inline vdata_t GetData(const vertex_t& v) const {
     assert(fragment_->IsInnerVertex(v));
-    auto data = fragment_->GetData(v);
+    if (vcolumn_) {
+      return (*vcolumn_)[v.GetValue()];
+    }
+    const auto& data = fragment_->GetData(v);
     return dynamic_projected_fragment_impl::unpack_dynamic<vdata_t>(
         data, v_prop_key_);
   }
@@ -659,10 +666,16 @@ class DynamicProjectedFragment {
     return fragment_->HasNode(node);
   }
 
+  DynamicFragmentDelta<vid_t>& GetDelta() const {
+    return fragment_->GetDelta();
+  }
+
  private:
   fragment_t* fragment_;
   std::string v_prop_key_;
   std::string e_prop_key_;
+  // the typed column of v_prop_key_, nullptr if the key is heterogeneous
+  std::shared_ptr<const std::vector<vdata_t>> vcolumn_;
 
   static_assert(std::is_same<int, VDATA_T>::value ||
                     std::is_same<int64_t, VDATA_T>::value ||
@@ -954,6 +967,10 @@ class DynamicProjectedFragment<grape::EmptyType, grape::EmptyType> {
     return fragment_->HasNode(node);
   }
 
+  DynamicFragmentDelta<vid_t>& GetDelta() const {
+    return fragment_->GetDelta();
+  }
+
  private:
   fragment_t* fragment_;
   std::string v_prop_key_;
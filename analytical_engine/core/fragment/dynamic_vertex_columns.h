@@ -0,0 +1,174 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANALYTICAL_ENGINE_CORE_FRAGMENT_DYNAMIC_VERTEX_COLUMNS_H_
+#define ANALYTICAL_ENGINE_CORE_FRAGMENT_DYNAMIC_VERTEX_COLUMNS_H_
+
+#ifdef NETWORKX
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <typeindex>
+#include <utility>
+#include <vector>
+
+#include "grape/types.h"
+
+#include "core/object/dynamic.h"
+
+namespace gs {
+
+namespace dynamic_vertex_columns_impl {
+
+template <typename T>
+typename std::enable_if<std::is_integral<T>::value &&
+                            !std::is_same<T, bool>::value,
+                        bool>::type
+unpack(const rapidjson::Value& value, T& out) {
+  if (!value.IsInt64()) {
+    return false;
+  }
+  out = static_cast<T>(value.GetInt64());
+  return true;
+}
+
+template <typename T>
+typename std::enable_if<std::is_floating_point<T>::value, bool>::type unpack(
+    const rapidjson::Value& value, T& out) {
+  if (!value.IsNumber()) {
+    return false;
+  }
+  out = static_cast<T>(value.GetDouble());
+  return true;
+}
+
+template <typename T>
+typename std::enable_if<std::is_same<T, bool>::value, bool>::type unpack(
+    const rapidjson::Value& value, T& out) {
+  if (!value.IsBool()) {
+    return false;
+  }
+  out = value.GetBool();
+  return true;
+}
+
+template <typename T>
+typename std::enable_if<std::is_same<T, std::string>::value, bool>::type
+unpack(const rapidjson::Value& value, T& out) {
+  if (!value.IsString()) {
+    return false;
+  }
+  out.assign(value.GetString(), value.GetStringLength());
+  return true;
+}
+
+// Empty data has nothing to store.
+template <typename T>
+typename std::enable_if<std::is_same<T, grape::EmptyType>::value, bool>::type
+unpack(const rapidjson::Value& value, T& out) {
+  return false;
+}
+
+}  // namespace dynamic_vertex_columns_impl
+
+/**
+ * @brief Typed columns of the properties of inner vertices of a
+ * DynamicFragment, indexed by the local id.
+ *
+ * A column is inferred from the vertex data on its first use, and kept until
+ * the vertex data is modified. A key is stored in a column of type T only
+ * when every alive inner vertex holds a value of T for it; heterogeneous
+ * keys have no column and are read from the dynamic values.
+ */
+template <typename VID_T>
+class DynamicVertexColumns {
+ public:
+  template <typename T>
+  using column_t = std::vector<T>;
+
+  DynamicVertexColumns() = default;
+  DynamicVertexColumns(const DynamicVertexColumns&) = delete;
+  DynamicVertexColumns& operator=(const DynamicVertexColumns&) = delete;
+
+  /**
+   * @brief The column of key, or nullptr if the key is not of type T for some
+   * alive vertex. The column stays valid after Clear() for the holders of the
+   * returned pointer, though it no longer reflects the fragment.
+   *
+   * @param data The data of inner vertices.
+   * @param alive Whether an inner vertex is alive, vertices not alive are left
+   * with the default value in the column.
+   */
+  template <typename T, typename ARRAY_T, typename ALIVE_T>
+  std::shared_ptr<const column_t<T>> Get(const std::string& key,
+                                         const ARRAY_T& data,
+                                         const ALIVE_T& alive, VID_T ivnum) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto index = std::make_pair(key, std::type_index(typeid(T)));
+    auto iter = columns_.find(index);
+    if (iter != columns_.end()) {
+      return std::static_pointer_cast<const column_t<T>>(iter->second);
+    }
+    auto column = build<T>(key, data, alive, ivnum);
+    columns_.emplace(std::move(index), column);
+    return column;
+  }
+
+  // Drop the columns, called whenever the vertex data is modified.
+  void Clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    columns_.clear();
+  }
+
+ private:
+  template <typename T, typename ARRAY_T, typename ALIVE_T>
+  static std::shared_ptr<const column_t<T>> build(const std::string& key,
+                                                  const ARRAY_T& data,
+                                                  const ALIVE_T& alive,
+                                                  VID_T ivnum) {
+    auto column = std::make_shared<column_t<T>>(ivnum);
+    for (VID_T lid = 0; lid < ivnum; ++lid) {
+      if (!alive.get_bit(lid)) {
+        continue;
+      }
+      const rapidjson::Value& vdata = data[lid];
+      if (!vdata.IsObject()) {
+        return nullptr;
+      }
+      auto member = vdata.FindMember(key.c_str());
+      T value;
+      if (member == vdata.MemberEnd() ||
+          !dynamic_vertex_columns_impl::unpack<T>(member->value, value)) {
+        return nullptr;
+      }
+      (*column)[lid] = std::move(value);
+    }
+    return column;
+  }
+
+  std::mutex mutex_;
+  // keyed by the property and the type of the column, nullptr for the keys
+  // that do not fit the type
+  std::map<std::pair<std::string, std::type_index>, std::shared_ptr<const void>>
+      columns_;
+};
+
+}  // namespace gs
+
+#endif  // NETWORKX
+#endif  // ANALYTICAL_ENGINE_CORE_FRAGMENT_DYNAMIC_VERTEX_COLUMNS_H_
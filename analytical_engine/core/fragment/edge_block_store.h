@@ -0,0 +1,349 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANALYTICAL_ENGINE_CORE_FRAGMENT_EDGE_BLOCK_STORE_H_
+#define ANALYTICAL_ENGINE_CORE_FRAGMENT_EDGE_BLOCK_STORE_H_
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "glog/logging.h"
+
+namespace gs {
+
+/**
+ * @brief An edge of an edge block, with the raw values of its endpoints.
+ */
+template <typename VID_T>
+struct BlockEdge {
+  VID_T src;
+  VID_T dst;
+};
+
+/**
+ * @brief Edges of a fragment kept on disk in a grid of blocks, the
+ * GridGraph layout, so that apps with a sequential access pattern over the
+ * edges, e.g. PageRank, WCC or BFS, only need their vertex states in memory.
+ *
+ * Destinations are inner vertices, split in chunks of chunk_size by their
+ * lids. Sources are split the same way if they are inner vertices, and by
+ * the fragment owning them otherwise. The edges of a destination chunk, a
+ * column of the grid, are stored together and ordered by source chunk, so
+ * a column is read with sequential IO and touches the states of a single
+ * source chunk at a time.
+ *
+ * Columns are streamed through a buffer pool of a bounded size, shared by
+ * the threads. If the whole store fits in the pool, it is read once and
+ * kept in memory.
+ */
+template <typename VID_T>
+class EdgeBlockStore {
+  static constexpr uint64_t kMagic = 0x4b4c424547444745;
+
+ public:
+  using edge_t = BlockEdge<VID_T>;
+
+  /**
+   * @brief Writes a store in two passes over the edges: the first one counts
+   * the edges of each block with Count, and the second one adds them with
+   * Add, in any order, after Prepare.
+   */
+  class Writer {
+   public:
+    static constexpr size_t kBufferEdges = 1024;
+
+    Writer(const std::string& dir, size_t src_chunk_num,
+           size_t dst_chunk_num, size_t chunk_size)
+        : dir_(dir),
+          src_chunk_num_(src_chunk_num),
+          dst_chunk_num_(dst_chunk_num),
+          chunk_size_(chunk_size),
+          counts_(src_chunk_num * dst_chunk_num, 0),
+          fd_(-1) {}
+
+    ~Writer() {
+      if (fd_ != -1) {
+        close(fd_);
+      }
+    }
+
+    void Count(size_t src_chunk, size_t dst_chunk) {
+      ++counts_[block_id(src_chunk, dst_chunk)];
+    }
+
+    void Prepare() {
+      size_t block_num = counts_.size();
+      offsets_.resize(block_num + 1);
+      offsets_[0] = 0;
+      for (size_t i = 0; i < block_num; ++i) {
+        offsets_[i + 1] = offsets_[i] + counts_[i];
+      }
+      cursors_.assign(offsets_.begin(), offsets_.end() - 1);
+      buffers_.resize(block_num);
+      fd_ = open(edges_path(dir_).c_str(), O_WRONLY | O_CREAT | O_TRUNC,
+                 0644);
+      PCHECK(fd_ != -1) << "Failed to create " << edges_path(dir_);
+      PCHECK(ftruncate(fd_, offsets_.back() * sizeof(edge_t)) == 0);
+    }
+
+    void Add(size_t src_chunk, size_t dst_chunk, VID_T src, VID_T dst) {
+      size_t id = block_id(src_chunk, dst_chunk);
+      auto& buffer = buffers_[id];
+      buffer.push_back(edge_t{src, dst});
+      if (buffer.size() == kBufferEdges) {
+        flush(id);
+      }
+    }
+
+    void Finish() {
+      for (size_t id = 0; id < buffers_.size(); ++id) {
+        flush(id);
+        CHECK_EQ(cursors_[id], offsets_[id + 1])
+            << "Edges of block " << id << " are not as many as counted";
+      }
+      PCHECK(fsync(fd_) == 0);
+      close(fd_);
+      fd_ = -1;
+
+      // the meta file is written last, so a store is complete once it exists
+      std::string tmp_path = meta_path(dir_) + ".tmp";
+      FILE* fout = fopen(tmp_path.c_str(), "wb");
+      PCHECK(fout != nullptr) << "Failed to create " << tmp_path;
+      uint64_t header[4] = {kMagic, src_chunk_num_, dst_chunk_num_,
+                            chunk_size_};
+      CHECK_EQ(fwrite(header, sizeof(header), 1, fout), 1);
+      CHECK_EQ(fwrite(offsets_.data(), sizeof(uint64_t), offsets_.size(),
+                      fout),
+               offsets_.size());
+      fclose(fout);
+      PCHECK(rename(tmp_path.c_str(), meta_path(dir_).c_str()) == 0);
+    }
+
+   private:
+    // blocks of a column are adjacent
+    size_t block_id(size_t src_chunk, size_t dst_chunk) const {
+      return dst_chunk * src_chunk_num_ + src_chunk;
+    }
+
+    void flush(size_t id) {
+      auto& buffer = buffers_[id];
+      if (buffer.empty()) {
+        return;
+      }
+      size_t bytes = buffer.size() * sizeof(edge_t);
+      PCHECK(pwrite(fd_, buffer.data(), bytes,
+                    cursors_[id] * sizeof(edge_t)) ==
+             static_cast<ssize_t>(bytes));
+      cursors_[id] += buffer.size();
+      buffer.clear();
+    }
+
+    std::string dir_;
+    size_t src_chunk_num_;
+    size_t dst_chunk_num_;
+    size_t chunk_size_;
+    std::vector<uint64_t> counts_;
+    std::vector<uint64_t> offsets_;
+    std::vector<uint64_t> cursors_;
+    std::vector<std::vector<edge_t>> buffers_;
+    int fd_;
+  };
+
+  EdgeBlockStore()
+      : src_chunk_num_(0), dst_chunk_num_(0), chunk_size_(0), fd_(-1) {}
+
+  ~EdgeBlockStore() {
+    if (fd_ != -1) {
+      close(fd_);
+    }
+  }
+
+  EdgeBlockStore(const EdgeBlockStore&) = delete;
+  EdgeBlockStore& operator=(const EdgeBlockStore&) = delete;
+
+  static bool Exists(const std::string& dir) {
+    struct stat st;
+    return stat(meta_path(dir).c_str(), &st) == 0;
+  }
+
+  /**
+   * @brief Open the store in dir, streaming it with at most pool_bytes of
+   * buffers.
+   */
+  void Open(const std::string& dir, size_t pool_bytes) {
+    FILE* fin = fopen(meta_path(dir).c_str(), "rb");
+    PCHECK(fin != nullptr) << "Failed to open " << meta_path(dir);
+    uint64_t header[4];
+    CHECK_EQ(fread(header, sizeof(header), 1, fin), 1);
+    CHECK_EQ(header[0], kMagic) << meta_path(dir) << " is not an edge store";
+    src_chunk_num_ = header[1];
+    dst_chunk_num_ = header[2];
+    chunk_size_ = header[3];
+    offsets_.resize(src_chunk_num_ * dst_chunk_num_ + 1);
+    CHECK_EQ(fread(offsets_.data(), sizeof(uint64_t), offsets_.size(), fin),
+             offsets_.size());
+    fclose(fin);
+
+    if (fd_ != -1) {
+      close(fd_);
+    }
+    fd_ = open(edges_path(dir).c_str(), O_RDONLY);
+    PCHECK(fd_ != -1) << "Failed to open " << edges_path(dir);
+    pool_bytes_ = pool_bytes;
+    resident_.clear();
+    if (EdgeNum() * sizeof(edge_t) <= pool_bytes_) {
+      resident_.resize(EdgeNum());
+      read_edges(0, EdgeNum(), resident_.data());
+    } else {
+      posix_fadvise(fd_, 0, 0, POSIX_FADV_SEQUENTIAL);
+    }
+    LOG(INFO) << "Opened " << EdgeNum() << " edges in "
+              << src_chunk_num_ << " x " << dst_chunk_num_ << " blocks from "
+              << dir << (resident_.empty() ? ", streamed" : ", in memory");
+  }
+
+  size_t EdgeNum() const { return offsets_.back(); }
+
+  size_t ChunkSize() const { return chunk_size_; }
+
+  size_t ColumnNum() const { return dst_chunk_num_; }
+
+  /**
+   * @brief Call func(tid, begin, end) with the edges of every column, in
+   * ranges ordered by source chunk. A column is visited by a single thread,
+   * so the states of its destinations can be updated without atomics.
+   */
+  template <typename FUNC_T>
+  void ForEachColumn(int thread_num, const FUNC_T& func) const {
+    std::atomic<size_t> next(0);
+    size_t slice_edges =
+        std::max<size_t>(pool_bytes_ / thread_num / sizeof(edge_t), 1);
+    auto worker = [&](int tid) {
+      std::vector<edge_t> buffer;
+      if (resident_.empty()) {
+        buffer.resize(slice_edges);
+      }
+      size_t col;
+      while ((col = next.fetch_add(1)) < dst_chunk_num_) {
+        size_t from = offsets_[col * src_chunk_num_];
+        size_t to = offsets_[(col + 1) * src_chunk_num_];
+        if (!resident_.empty()) {
+          func(tid, resident_.data() + from, resident_.data() + to);
+          continue;
+        }
+        while (from < to) {
+          size_t num = std::min(slice_edges, to - from);
+          read_edges(from, num, buffer.data());
+          func(tid, buffer.data(), buffer.data() + num);
+          from += num;
+        }
+      }
+    };
+    std::vector<std::thread> threads;
+    for (int tid = 1; tid < thread_num; ++tid) {
+      threads.emplace_back(worker, tid);
+    }
+    worker(0);
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+
+ private:
+  static std::string meta_path(const std::string& dir) {
+    return dir + "/blocks.meta";
+  }
+
+  static std::string edges_path(const std::string& dir) {
+    return dir + "/edges.bin";
+  }
+
+  void read_edges(size_t from, size_t num, edge_t* out) const {
+    char* ptr = reinterpret_cast<char*>(out);
+    size_t bytes = num * sizeof(edge_t);
+    off_t offset = from * sizeof(edge_t);
+    while (bytes != 0) {
+      ssize_t got = pread(fd_, ptr, bytes, offset);
+      PCHECK(got > 0) << "Failed to read edge blocks";
+      ptr += got;
+      bytes -= got;
+      offset += got;
+    }
+  }
+
+  size_t src_chunk_num_;
+  size_t dst_chunk_num_;
+  size_t chunk_size_;
+  size_t pool_bytes_ = 0;
+  std::vector<uint64_t> offsets_;
+  std::vector<edge_t> resident_;
+  int fd_;
+};
+
+/**
+ * @brief Spill the edges reaching the inner vertices of frag, i.e. the
+ * incoming edges if it is directed, to an edge block store in dir.
+ */
+template <typename FRAG_T>
+void SpillEdgeBlocks(const FRAG_T& frag, const std::string& dir,
+                     size_t chunk_size) {
+  using vid_t = typename FRAG_T::vid_t;
+  using vertex_t = typename FRAG_T::vertex_t;
+  using store_t = EdgeBlockStore<vid_t>;
+
+  auto inner_vertices = frag.InnerVertices();
+  size_t ivnum = inner_vertices.size();
+  size_t inner_chunk_num = std::max<size_t>(
+      (ivnum + chunk_size - 1) / chunk_size, 1);
+  auto src_chunk = [&](vertex_t v) -> size_t {
+    return frag.IsInnerVertex(v) ? v.GetValue() / chunk_size
+                                 : inner_chunk_num + frag.GetFragId(v);
+  };
+  auto for_each_edge = [&](const auto& func) {
+    for (auto u : inner_vertices) {
+      auto es = frag.directed() ? frag.GetIncomingAdjList(u)
+                                : frag.GetOutgoingAdjList(u);
+      for (auto& e : es) {
+        func(e.get_neighbor(), u);
+      }
+    }
+  };
+
+  mkdir(dir.c_str(), 0755);
+  typename store_t::Writer writer(dir, inner_chunk_num + frag.fnum(),
+                                  inner_chunk_num, chunk_size);
+  for_each_edge([&](vertex_t v, vertex_t u) {
+    writer.Count(src_chunk(v), u.GetValue() / chunk_size);
+  });
+  writer.Prepare();
+  for_each_edge([&](vertex_t v, vertex_t u) {
+    writer.Add(src_chunk(v), u.GetValue() / chunk_size, v.GetValue(),
+               u.GetValue());
+  });
+  writer.Finish();
+}
+
+}  // namespace gs
+
+#endif  // ANALYTICAL_ENGINE_CORE_FRAGMENT_EDGE_BLOCK_STORE_H_
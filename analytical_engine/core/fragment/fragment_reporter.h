@@ -18,12 +18,14 @@
 
 #ifdef NETWORKX
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 #include <memory>
 #include <ostream>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "boost/leaf/error.hpp"
 #include "boost/leaf/result.hpp"
@@ -194,6 +196,27 @@ class DynamicFragmentReporter : public grape::Communicator {
       }
       break;
     }
+    case rpc::BATCH_BY_NODES: {
+      BOOST_LEAF_AUTO(nodes_in_msgpack, params.Get<std::string>(rpc::NODES));
+      BOOST_LEAF_AUTO(fields, params.Get<int64_t>(rpc::REPORT_FIELDS));
+      dynamic::Value nodes;
+      dynamic::ParseMsgpack(nodes_in_msgpack, nodes);
+      getBatchByNodes(fragment, nodes, fields, *in_archive);
+      break;
+    }
+    case rpc::BATCH_BY_GID: {
+      BOOST_LEAF_AUTO(gid, params.Get<uint64_t>(rpc::GID));
+      BOOST_LEAF_AUTO(fields, params.Get<int64_t>(rpc::REPORT_FIELDS));
+      BOOST_LEAF_AUTO(batch_size, params.Get<int64_t>(rpc::BATCH_SIZE));
+      if (fragment->IsInnerVertexGid(gid)) {
+        getBatchByGid(fragment, gid, fields, batch_size, *in_archive);
+      }
+      break;
+    }
+    case rpc::PARTITION_STATS: {
+      getPartitionStats(fragment, *in_archive);
+      break;
+    }
     default:
       LOG(ERROR) << "Invalid report type";
     }
@@ -201,6 +224,234 @@ class DynamicFragmentReporter : public grape::Communicator {
   }
 
  private:
+  using packer_t = msgpack::packer<msgpack::sbuffer>;
+
+  // The requested fields of batched reports, in the order of rpc::ReportField.
+  static std::vector<rpc::ReportField> requestedFields(int64_t fields) {
+    std::vector<rpc::ReportField> ret;
+    for (int field = rpc::ReportField_MIN; field <= rpc::ReportField_MAX;
+         ++field) {
+      if (fields & (int64_t(1) << field)) {
+        ret.push_back(static_cast<rpc::ReportField>(field));
+      }
+    }
+    return ret;
+  }
+
+  static const char* fieldName(rpc::ReportField field) {
+    switch (field) {
+    case rpc::NODE_ID_FIELD:
+      return "id";
+    case rpc::NODE_DATA_FIELD:
+      return "data";
+    case rpc::SUCC_FIELD:
+      return "succ";
+    case rpc::SUCC_ATTR_FIELD:
+      return "succ_attr";
+    case rpc::PRED_FIELD:
+      return "pred";
+    case rpc::PRED_ATTR_FIELD:
+      return "pred_attr";
+    default:
+      return "";
+    }
+  }
+
+  void packField(std::shared_ptr<fragment_t>& fragment, const vertex_t& v,
+                 rpc::ReportField field, packer_t& packer) {
+    bool pred = field == rpc::PRED_FIELD || field == rpc::PRED_ATTR_FIELD;
+    bool attr = field == rpc::SUCC_ATTR_FIELD || field == rpc::PRED_ATTR_FIELD;
+    if (field == rpc::NODE_ID_FIELD) {
+      packer.pack(fragment->GetId(v));
+    } else if (field == rpc::NODE_DATA_FIELD) {
+      packer.pack(fragment->GetData(v));
+    } else {
+      adj_list_t edges = pred ? fragment->GetIncomingAdjList(v)
+                              : fragment->GetOutgoingAdjList(v);
+      packer.pack_array(edges.Size());
+      for (const auto& e : edges) {
+        if (attr) {
+          packer.pack(e.data);
+        } else {
+          packer.pack(fragment->GetId(e.neighbor));
+        }
+      }
+    }
+  }
+
+  /**
+   * @brief Report the fields of a list of nodes as a map from the field name
+   * to a column aligned with the nodes, where missing nodes are nil, and an
+   * "exists" column. Each fragment packs the columns of the nodes it holds,
+   * and the first fragment merges them.
+   */
+  void getBatchByNodes(std::shared_ptr<fragment_t>& fragment,
+                       const dynamic::Value& nodes, int64_t fields,
+                       grape::InArchive& arc) {
+    auto requested = requestedFields(fields);
+    std::vector<std::pair<uint32_t, vertex_t>> found;
+    vertex_t v;
+    for (uint32_t i = 0; i < nodes.Size(); ++i) {
+      oid_t node_id(nodes[i]);
+      if (fragment->GetInnerVertex(node_id, v) &&
+          fragment->IsAliveInnerVertex(v)) {
+        found.emplace_back(i, v);
+      }
+    }
+
+    // [indices, column of the first field, ...]
+    msgpack::sbuffer sbuf;
+    packer_t packer(&sbuf);
+    packer.pack_array(requested.size() + 1);
+    packer.pack_array(found.size());
+    for (auto& pair : found) {
+      packer.pack(pair.first);
+    }
+    for (auto field : requested) {
+      packer.pack_array(found.size());
+      for (auto& pair : found) {
+        packField(fragment, pair.second, field, packer);
+      }
+    }
+    std::vector<std::string> parts;
+    AllGather(std::string(sbuf.data(), sbuf.size()), parts);
+    if (comm_spec_.fid() != 0) {
+      return;
+    }
+
+    std::vector<msgpack::object_handle> handles(parts.size());
+    // the fragment and the row of each node
+    std::vector<std::pair<int, uint32_t>> rows(nodes.Size(),
+                                               std::make_pair(-1, 0));
+    for (size_t k = 0; k < parts.size(); ++k) {
+      handles[k] = msgpack::unpack(parts[k].data(), parts[k].size());
+      auto& indices = handles[k].get().via.array.ptr[0].via.array;
+      for (uint32_t row = 0; row < indices.size; ++row) {
+        rows[indices.ptr[row].as<uint32_t>()] = std::make_pair(k, row);
+      }
+    }
+    msgpack::sbuffer merged;
+    packer_t merged_packer(&merged);
+    merged_packer.pack_map(requested.size() + 1);
+    merged_packer.pack("exists");
+    merged_packer.pack_array(rows.size());
+    for (auto& row : rows) {
+      merged_packer.pack(row.first >= 0);
+    }
+    for (size_t j = 0; j < requested.size(); ++j) {
+      merged_packer.pack(fieldName(requested[j]));
+      merged_packer.pack_array(rows.size());
+      for (auto& row : rows) {
+        if (row.first < 0) {
+          merged_packer.pack_nil();
+        } else {
+          auto& column = handles[row.first].get().via.array.ptr[j + 1];
+          merged_packer.pack(column.via.array.ptr[row.second]);
+        }
+      }
+    }
+    arc << merged;
+  }
+
+  /**
+   * @brief Report the fields of at most batch_size alive inner vertices from
+   * gid, archived as the gid to continue with (0 once all fragments are
+   * done) and a map from the field name to a column.
+   */
+  void getBatchByGid(std::shared_ptr<fragment_t>& fragment, vid_t gid,
+                     int64_t fields, int64_t batch_size,
+                     grape::InArchive& arc) {
+    auto requested = requestedFields(fields);
+    auto vm_ptr = fragment->GetVertexMap();
+    auto fid = fragment->fid();
+    vid_t ivnum = vm_ptr->GetInnerVertexSize(fid);
+    vertex_t v;
+    fragment->InnerVertexGid2Vertex(gid, v);
+    std::vector<vertex_t> batch;
+    for (; v.GetValue() < ivnum &&
+           static_cast<int64_t>(batch.size()) < batch_size;
+         ++v) {
+      if (fragment->IsAliveInnerVertex(v)) {
+        batch.push_back(v);
+      }
+    }
+
+    if (v.GetValue() < ivnum) {
+      arc << vm_ptr->Lid2Gid(fid, v.GetValue());
+    } else if (fid == fragment->fnum() - 1) {
+      arc << uint64_t(0);
+    } else {
+      arc << vm_ptr->Lid2Gid(fid + 1, 0);
+    }
+    msgpack::sbuffer sbuf;
+    packer_t packer(&sbuf);
+    packer.pack_map(requested.size());
+    for (auto field : requested) {
+      packer.pack(fieldName(field));
+      packer.pack_array(batch.size());
+      for (auto& u : batch) {
+        packField(fragment, u, field, packer);
+      }
+    }
+    arc << sbuf;
+  }
+
+  /**
+   * @brief Report the number of alive inner vertices, outgoing edges and the
+   * outgoing edges to outer vertices (cut edges) of each fragment, with the
+   * edge cut ratio and the ratio of the largest fragment to the average.
+   */
+  void getPartitionStats(std::shared_ptr<fragment_t>& fragment,
+                         grape::InArchive& arc) {
+    size_t vnum = 0, enum_ = 0, cut_enum = 0;
+    for (auto& v : fragment->InnerVertices()) {
+      if (!fragment->IsAliveInnerVertex(v)) {
+        continue;
+      }
+      ++vnum;
+      for (auto& e : fragment->GetOutgoingAdjList(v)) {
+        ++enum_;
+        if (fragment->IsOuterVertex(e.neighbor)) {
+          ++cut_enum;
+        }
+      }
+    }
+    std::vector<size_t> vnums, enums, cut_enums;
+    AllGather(vnum, vnums);
+    AllGather(enum_, enums);
+    AllGather(cut_enum, cut_enums);
+    if (comm_spec_.fid() != 0) {
+      return;
+    }
+
+    size_t total_vnum = 0, max_vnum = 0, total_enum = 0, total_cut_enum = 0;
+    for (grape::fid_t i = 0; i < comm_spec_.fnum(); ++i) {
+      total_vnum += vnums[i];
+      max_vnum = std::max(max_vnum, vnums[i]);
+      total_enum += enums[i];
+      total_cut_enum += cut_enums[i];
+    }
+    msgpack::sbuffer sbuf;
+    packer_t packer(&sbuf);
+    packer.pack_map(5);
+    packer.pack("vertex_num");
+    packer.pack(vnums);
+    packer.pack("edge_num");
+    packer.pack(enums);
+    packer.pack("cut_edge_num");
+    packer.pack(cut_enums);
+    packer.pack("edge_cut_ratio");
+    packer.pack(total_enum == 0 ? 0.0
+                                : static_cast<double>(total_cut_enum) /
+                                      static_cast<double>(total_enum));
+    packer.pack("vertex_imbalance");
+    packer.pack(total_vnum == 0 ? 1.0
+                                : static_cast<double>(max_vnum) *
+                                      comm_spec_.fnum() /
+                                      static_cast<double>(total_vnum));
+    arc << sbuf;
+  }
+
   void getNeighborsList(std::shared_ptr<fragment_t>& fragment,
                         const vertex_t& v, const rpc::ReportType& report_type,
                         grape::InArchive& arc) {
@@ -0,0 +1,218 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANALYTICAL_ENGINE_CORE_FRAGMENT_VERTEX_CUT_FRAGMENT_H_
+#define ANALYTICAL_ENGINE_CORE_FRAGMENT_VERTEX_CUT_FRAGMENT_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "grape/grape.h"
+#include "grape/utils/iterator_pair.h"
+#include "vineyard/graph/fragment/property_graph_utils.h"
+
+namespace gs {
+
+enum class VertexCutKind : uint8_t {
+  // by hashes of both ends, in a grid of fragments, so a vertex has mirrors
+  // in at most one row and one column of the grid
+  kGrid,
+  // the in edges of a vertex of a low in degree stay with its master, those
+  // of a high in degree are spread by the hashes of their sources
+  kHybrid,
+};
+
+inline bool ParseVertexCutKind(const std::string& name, VertexCutKind& kind) {
+  if (name == "grid") {
+    kind = VertexCutKind::kGrid;
+  } else if (name == "hybrid") {
+    kind = VertexCutKind::kHybrid;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Decides the fragment each edge goes to in a vertex cut.
+ */
+template <typename VID_T>
+class VertexCutPlacement {
+ public:
+  void Init(grape::fid_t fnum, VertexCutKind kind, size_t hybrid_threshold,
+            const vineyard::IdParser<VID_T>& parser) {
+    fnum_ = fnum;
+    kind_ = kind;
+    hybrid_threshold_ = hybrid_threshold;
+    parser_ = &parser;
+    rows_ = static_cast<grape::fid_t>(std::sqrt(fnum));
+    while (fnum % rows_ != 0) {
+      --rows_;
+    }
+    cols_ = fnum / rows_;
+  }
+
+  /**
+   * @brief The fragment of the edge from src to dst, given the in degree of
+   * dst, where src and dst are gids.
+   */
+  grape::fid_t EdgeFid(VID_T src, VID_T dst, size_t dst_in_degree) const {
+    if (kind_ == VertexCutKind::kHybrid) {
+      return dst_in_degree <= hybrid_threshold_ ? parser_->GetFid(dst)
+                                                : hash(src) % fnum_;
+    }
+    return (hash(src) % rows_) * cols_ + hash(dst) % cols_;
+  }
+
+ private:
+  static uint64_t hash(uint64_t key) {
+    uint64_t z = key + 0x9e3779b97f4a7c15ULL;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+  }
+
+  grape::fid_t fnum_ = 1;
+  grape::fid_t rows_ = 1;
+  grape::fid_t cols_ = 1;
+  VertexCutKind kind_ = VertexCutKind::kGrid;
+  size_t hybrid_threshold_ = 0;
+  const vineyard::IdParser<VID_T>* parser_ = nullptr;
+};
+
+/**
+ * @brief The part of a vertex cut of a graph held by a fragment.
+ *
+ * Every edge is held by exactly one fragment, and a vertex is a master on
+ * the fragment owning it in the edge cut, and a mirror on every other
+ * fragment holding some of its edges. Masters and mirrors are numbered by
+ * slots, the masters first in the order they are given, so the edges are
+ * scanned without hashing. The edges are grouped by their destinations.
+ *
+ * Masters know the fragments of their mirrors, so the partial gathers of
+ * the mirrors are sent to masters, and the values applied by the masters
+ * are scattered back to the mirrors.
+ */
+template <typename VID_T>
+class VertexCutFragment {
+ public:
+  /**
+   * @brief Build the part from the gids of the masters and the edges held,
+   * as (src, dst) gids.
+   */
+  void Build(const std::vector<VID_T>& masters,
+             const std::vector<std::pair<VID_T, VID_T>>& edges) {
+    gids_ = masters;
+    master_num_ = masters.size();
+    slots_.clear();
+    slots_.reserve(master_num_);
+    for (size_t i = 0; i < master_num_; ++i) {
+      slots_.emplace(gids_[i], i);
+    }
+    std::vector<VID_T> mirrors;
+    for (auto& e : edges) {
+      for (auto gid : {e.first, e.second}) {
+        if (slots_.find(gid) == slots_.end()) {
+          mirrors.push_back(gid);
+        }
+      }
+    }
+    std::sort(mirrors.begin(), mirrors.end());
+    mirrors.erase(std::unique(mirrors.begin(), mirrors.end()),
+                  mirrors.end());
+    for (auto gid : mirrors) {
+      slots_.emplace(gid, gids_.size());
+      gids_.push_back(gid);
+    }
+
+    offsets_.assign(gids_.size() + 1, 0);
+    for (auto& e : edges) {
+      ++offsets_[slots_.at(e.second) + 1];
+    }
+    for (size_t i = 0; i < gids_.size(); ++i) {
+      offsets_[i + 1] += offsets_[i];
+    }
+    sources_.resize(edges.size());
+    std::vector<size_t> cursors(offsets_.begin(), offsets_.end() - 1);
+    for (auto& e : edges) {
+      sources_[cursors[slots_.at(e.second)]++] = slots_.at(e.first);
+    }
+    mirror_offsets_.assign(master_num_ + 1, 0);
+    mirror_fids_.clear();
+  }
+
+  /**
+   * @brief Set the fragments holding mirrors of the masters, from (gid, fid)
+   * pairs.
+   */
+  void SetMirrors(const std::vector<std::pair<VID_T, grape::fid_t>>& pairs) {
+    mirror_offsets_.assign(master_num_ + 1, 0);
+    for (auto& p : pairs) {
+      ++mirror_offsets_[slots_.at(p.first) + 1];
+    }
+    for (size_t i = 0; i < master_num_; ++i) {
+      mirror_offsets_[i + 1] += mirror_offsets_[i];
+    }
+    mirror_fids_.resize(pairs.size());
+    std::vector<size_t> cursors(mirror_offsets_.begin(),
+                                mirror_offsets_.end() - 1);
+    for (auto& p : pairs) {
+      mirror_fids_[cursors[slots_.at(p.first)]++] = p.second;
+    }
+  }
+
+  size_t VertexNum() const { return gids_.size(); }
+
+  size_t MasterNum() const { return master_num_; }
+
+  size_t EdgeNum() const { return sources_.size(); }
+
+  bool IsMaster(size_t slot) const { return slot < master_num_; }
+
+  VID_T Gid(size_t slot) const { return gids_[slot]; }
+
+  size_t Slot(VID_T gid) const { return slots_.at(gid); }
+
+  /** @brief Slots of the sources of the edges to the vertex in slot. */
+  grape::IteratorPair<const size_t*> Sources(size_t slot) const {
+    return grape::IteratorPair<const size_t*>(
+        sources_.data() + offsets_[slot], sources_.data() + offsets_[slot + 1]);
+  }
+
+  /** @brief Fragments holding mirrors of the master in slot. */
+  grape::IteratorPair<const grape::fid_t*> MirrorFids(size_t slot) const {
+    return grape::IteratorPair<const grape::fid_t*>(
+        mirror_fids_.data() + mirror_offsets_[slot],
+        mirror_fids_.data() + mirror_offsets_[slot + 1]);
+  }
+
+ private:
+  std::vector<VID_T> gids_;
+  size_t master_num_ = 0;
+  std::unordered_map<VID_T, size_t> slots_;
+  std::vector<size_t> offsets_;
+  std::vector<size_t> sources_;
+  std::vector<size_t> mirror_offsets_;
+  std::vector<grape::fid_t> mirror_fids_;
+};
+
+}  // namespace gs
+
+#endif  // ANALYTICAL_ENGINE_CORE_FRAGMENT_VERTEX_CUT_FRAGMENT_H_
@@ -45,6 +45,7 @@
 #include "core/server/analytical_server.h"
 #include "core/server/dispatcher.h"
 #include "core/server/rpc_utils.h"
+#include "core/utils/numa_utils.h"
 
 namespace bl = boost::leaf;
 
@@ -221,6 +222,11 @@ int main(int argc, char* argv[]) {
   RedirectLogSink redirect_log_sink;
   google::AddLogSink(&redirect_log_sink);
 
+  // before any fragment or context is allocated
+  if (FLAGS_numa_interleave) {
+    gs::InterleaveMemoryAcrossNodes();
+  }
+
   // Init MPI
   grape::InitMPIComm();
 
@@ -15,6 +15,7 @@
 
 #include "core/grape_instance.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <memory>
 #include <ostream>
@@ -46,6 +47,7 @@
 
 #ifdef NETWORKX
 #include "core/object/dynamic.h"
+#include "core/utils/msgpack_utils.h"
 #endif
 
 #include "core/context/i_context.h"
@@ -54,6 +56,7 @@
 #include "core/context/tensor_context.h"
 #include "core/context/vertex_data_context.h"
 #include "core/context/vertex_property_context.h"
+#include "core/flags.h"
 #include "core/fragment/dynamic_fragment.h"
 #include "core/io/property_parser.h"
 #include "core/launcher.h"
@@ -77,7 +80,8 @@ class QueryArgs;
 }  // namespace rpc
 
 GrapeInstance::GrapeInstance(const grape::CommSpec& comm_spec)
-    : comm_spec_(comm_spec) {}
+    : comm_spec_(comm_spec),
+      projection_cache_(std::max(FLAGS_projection_cache_size, 0)) {}
 
 void GrapeInstance::Init(const std::string& vineyard_socket) {
   // force link vineyard_io library for graph/app compilation
@@ -177,30 +181,60 @@ bl::result<rpc::graph::GraphDefPb> GrapeInstance::loadGraph(
 
 bl::result<void> GrapeInstance::unloadGraph(const rpc::GSParams& params) {
   BOOST_LEAF_AUTO(graph_name, params.Get<std::string>(rpc::GRAPH_NAME));
+  std::vector<std::shared_ptr<ProjectionCache::Entry>> evicted;
+  // the fragment of a cached projection is deleted once evicted
+  if (projection_cache_.Release(graph_name, evicted)) {
+    VLOG(1) << "Releasing projected graph " << graph_name;
+    BOOST_LEAF_CHECK(object_manager_.RemoveObject(graph_name));
+    return unloadProjections(evicted);
+  }
+  projection_cache_.ReleaseSource(graph_name, evicted);
   if (params.HasKey(rpc::VINEYARD_ID)) {
     BOOST_LEAF_AUTO(frag_group_id, params.Get<int64_t>(rpc::VINEYARD_ID));
-    bool exists = false;
-    VY_OK_OR_RAISE(client_->Exists(frag_group_id, exists));
-    if (exists) {
-      std::shared_ptr<vineyard::ArrowFragmentGroup> fg;
-      VY_OK_OR_RAISE(client_->GetObject(frag_group_id, fg));
-      auto fid = comm_spec_.WorkerToFrag(comm_spec_.worker_id());
-      auto frag_id = fg->Fragments().at(fid);
-
-      // ensure all workers obtain the expected information
-      MPI_Barrier(comm_spec_.comm());
-
-      // delete the fragment group first
-      if (comm_spec_.worker_id() == 0) {
-        VINEYARD_SUPPRESS(client_->DelData(frag_group_id, false, true));
-      }
-      // ensure all fragments get deleted
-      MPI_Barrier(comm_spec_.comm());
-      VINEYARD_SUPPRESS(client_->DelData(frag_id, false, true));
-    }
+    BOOST_LEAF_CHECK(deleteFragmentGroup(frag_group_id));
   }
   VLOG(1) << "Unloading Graph " << graph_name;
-  return object_manager_.RemoveObject(graph_name);
+  BOOST_LEAF_CHECK(object_manager_.RemoveObject(graph_name));
+  return unloadProjections(evicted);
+}
+
+bl::result<void> GrapeInstance::deleteFragmentGroup(int64_t frag_group_id) {
+  bool exists = false;
+  VY_OK_OR_RAISE(client_->Exists(frag_group_id, exists));
+  if (exists) {
+    std::shared_ptr<vineyard::ArrowFragmentGroup> fg;
+    VY_OK_OR_RAISE(client_->GetObject(frag_group_id, fg));
+    auto fid = comm_spec_.WorkerToFrag(comm_spec_.worker_id());
+    auto frag_id = fg->Fragments().at(fid);
+
+    // ensure all workers obtain the expected information
+    MPI_Barrier(comm_spec_.comm());
+
+    // delete the fragment group first
+    if (comm_spec_.worker_id() == 0) {
+      VINEYARD_SUPPRESS(client_->DelData(frag_group_id, false, true));
+    }
+    // ensure all fragments get deleted
+    MPI_Barrier(comm_spec_.comm());
+    VINEYARD_SUPPRESS(client_->DelData(frag_id, false, true));
+  }
+  return {};
+}
+
+bl::result<void> GrapeInstance::unloadProjections(
+    const std::vector<std::shared_ptr<ProjectionCache::Entry>>& evicted) {
+  for (auto& entry : evicted) {
+    VLOG(1) << "Unloading projected graph " << entry->graph_def.key();
+    if (!entry->graph_def.has_extension()) {
+      continue;
+    }
+    gs::rpc::graph::VineyardInfoPb vy_info;
+    entry->graph_def.extension().UnpackTo(&vy_info);
+    if (vy_info.vineyard_id() != 0) {
+      BOOST_LEAF_CHECK(deleteFragmentGroup(vy_info.vineyard_id()));
+    }
+  }
+  return {};
 }
 
 bl::result<void> GrapeInstance::archiveGraph(const rpc::GSParams& params) {
@@ -271,30 +305,48 @@ bl::result<rpc::graph::GraphDefPb> GrapeInstance::projectToSimple(
 
   BOOST_LEAF_AUTO(wrapper,
                   object_manager_.GetObject<IFragmentWrapper>(graph_name));
+
+  // property graphs are immutable, so that their projections are shared by
+  // the queries with the same source and parameters
+  std::string cache_key;
+  if (wrapper->graph_def().graph_type() == rpc::graph::ARROW_PROPERTY) {
+    cache_key = params.DebugString();
+    auto entry = projection_cache_.Acquire(cache_key, projected_graph_name);
+    if (entry != nullptr) {
+      BOOST_LEAF_CHECK(
+          object_manager_.PutObject(projected_graph_name, entry->wrapper));
+      auto graph_def = entry->graph_def;
+      graph_def.set_key(projected_graph_name);
+      return graph_def;
+    }
+  }
+
   BOOST_LEAF_AUTO(projector, object_manager_.GetObject<Projector>(type_sig));
   BOOST_LEAF_AUTO(projected_wrapper,
                   projector->Project(wrapper, projected_graph_name, params));
   BOOST_LEAF_CHECK(object_manager_.PutObject(projected_wrapper));
 
   auto graph_def = projected_wrapper->graph_def();
-  if (!graph_def.has_extension()) {
-    return graph_def;
-  }
   gs::rpc::graph::VineyardInfoPb vy_info;
-  // gather fragment id
-  graph_def.extension().UnpackTo(&vy_info);
-  if (vy_info.vineyard_id() == 0) {
-    return graph_def;
+  if (graph_def.has_extension()) {
+    // gather fragment id
+    graph_def.extension().UnpackTo(&vy_info);
+  }
+  if (vy_info.vineyard_id() != 0) {
+    VY_OK_OR_RAISE(client_->Persist(vy_info.vineyard_id()));
+    // construct fragment group
+    BOOST_LEAF_AUTO(frag_group_id,
+                    vineyard::ConstructFragmentGroup(
+                        *client_, vy_info.vineyard_id(), comm_spec_));
+    // return graph def with vineyard id attached
+    gs::rpc::graph::VineyardInfoPb new_vy_info = vy_info;
+    new_vy_info.set_vineyard_id(frag_group_id);
+    graph_def.mutable_extension()->PackFrom(new_vy_info);
+  }
+  if (!cache_key.empty()) {
+    projection_cache_.Insert(cache_key, graph_name, projected_graph_name,
+                             projected_wrapper, graph_def);
   }
-  VY_OK_OR_RAISE(client_->Persist(vy_info.vineyard_id()));
-  // construct fragment group
-  BOOST_LEAF_AUTO(frag_group_id,
-                  vineyard::ConstructFragmentGroup(
-                      *client_, vy_info.vineyard_id(), comm_spec_));
-  // return graph def with vineyard id attached
-  gs::rpc::graph::VineyardInfoPb new_vy_info = vy_info;
-  new_vy_info.set_vineyard_id(frag_group_id);
-  graph_def.mutable_extension()->PackFrom(new_vy_info);
   return graph_def;
 }
 
@@ -316,6 +368,7 @@ bl::result<std::string> GrapeInstance::query(const rpc::GSParams& params,
   BOOST_LEAF_AUTO(worker, app->CreateWorker(fragment, comm_spec_, spec));
   BOOST_LEAF_AUTO(ctx_wrapper,
                   app->Query(worker.get(), query_args, context_key, wrapper));
+  std::string profile = app->GetProfile(worker.get());
   std::string context_type;
   std::string context_schema;
   if (ctx_wrapper == nullptr) {
@@ -329,7 +382,8 @@ bl::result<std::string> GrapeInstance::query(const rpc::GSParams& params,
   }
   return toJson({{"context_type", context_type},
                  {"context_key", context_key},
-                 {"context_schema", context_schema}});
+                 {"context_schema", context_schema},
+                 {"profile", profile}});
 }
 
 bl::result<void> GrapeInstance::unloadContext(const rpc::GSParams& params) {
@@ -345,6 +399,32 @@ bl::result<std::shared_ptr<grape::InArchive>> GrapeInstance::reportGraph(
   return wrapper->ReportGraph(comm_spec_, params);
 }
 
+#ifdef NETWORKX
+bl::result<void> GrapeInstance::parseModifyPayload(const rpc::GSParams& params,
+                                                   const std::string& buf,
+                                                   dynamic::Value& value) {
+  std::string format = "json";
+  if (params.HasKey(rpc::PAYLOAD_FORMAT)) {
+    BOOST_LEAF_ASSIGN(format, params.Get<std::string>(rpc::PAYLOAD_FORMAT));
+  }
+  if (format == "json") {
+    dynamic::Parse(buf, value);
+  } else if (format == "msgpack") {
+    try {
+      dynamic::ParseMsgpack(buf, value);
+    } catch (const std::exception& e) {
+      RETURN_GS_ERROR(vineyard::ErrorCode::kInvalidValueError,
+                      "Failed to unpack the msgpack payload: " +
+                          std::string(e.what()));
+    }
+  } else {
+    RETURN_GS_ERROR(vineyard::ErrorCode::kInvalidValueError,
+                    "Unsupported payload format: " + format);
+  }
+  return {};
+}
+#endif  // NETWORKX
+
 bl::result<rpc::graph::GraphDefPb> GrapeInstance::modifyVertices(
     const rpc::GSParams& params) {
 #ifdef NETWORKX
@@ -367,9 +447,9 @@ bl::result<rpc::graph::GraphDefPb> GrapeInstance::modifyVertices(
   dynamic::Value common_attr, nodes;
   // the common attribute for all nodes to be modified
   dynamic::Parse(common_attr_json, common_attr);
-  std::string nodes_json =
+  const std::string& nodes_buf =
       params.GetLargeAttr().chunk_list().items()[0].buffer();
-  dynamic::Parse(nodes_json, nodes);
+  BOOST_LEAF_CHECK(parseModifyPayload(params, nodes_buf, nodes));
   auto fragment =
       std::static_pointer_cast<DynamicFragment>(wrapper->fragment());
   DynamicFragmentMutator mutator(comm_spec_, fragment);
@@ -414,9 +494,9 @@ bl::result<rpc::graph::GraphDefPb> GrapeInstance::modifyEdges(
   if (params.HasKey(rpc::EDGE_KEY)) {
     BOOST_LEAF_AUTO(weight, params.Get<std::string>(rpc::EDGE_KEY));
   }
-  std::string edges_json =
+  const std::string& edges_buf =
       params.GetLargeAttr().chunk_list().items()[0].buffer();
-  dynamic::Parse(edges_json, edges);
+  BOOST_LEAF_CHECK(parseModifyPayload(params, edges_buf, edges));
   auto fragment =
       std::static_pointer_cast<DynamicFragment>(wrapper->fragment());
   DynamicFragmentMutator mutator(comm_spec_, fragment);
@@ -24,6 +24,7 @@
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "boost/foreach.hpp"
 #include "boost/leaf/error.hpp"
@@ -36,6 +37,7 @@
 #include "vineyard/graph/utils/grape_utils.h"
 
 #include "core/object/object_manager.h"
+#include "core/object/projection_cache.h"
 #include "core/server/dispatcher.h"
 #include "core/server/rpc_utils.h"
 #include "proto/types.pb.h"
@@ -57,6 +59,11 @@ class GraphDefPb;
 }  // namespace graph
 }  // namespace rpc
 struct CommandDetail;
+#ifdef NETWORKX
+namespace dynamic {
+class Value;
+}  // namespace dynamic
+#endif  // NETWORKX
 
 /**
  * @brief EngineConfig contains configurations about the analytical engine, such
@@ -101,6 +108,11 @@ class GrapeInstance : public Subscriber {
 
   bl::result<void> unloadGraph(const rpc::GSParams& params);
 
+  bl::result<void> deleteFragmentGroup(int64_t frag_group_id);
+
+  bl::result<void> unloadProjections(
+      const std::vector<std::shared_ptr<ProjectionCache::Entry>>& evicted);
+
   bl::result<void> archiveGraph(const rpc::GSParams& params);
 
   bl::result<std::string> loadApp(const rpc::GSParams& params);
@@ -160,6 +172,11 @@ class GrapeInstance : public Subscriber {
 #ifdef NETWORKX
   bl::result<rpc::graph::GraphDefPb> induceSubGraph(
       const rpc::GSParams& params);
+
+  // Parse the nodes or edges to modify, packed as json or msgpack.
+  bl::result<void> parseModifyPayload(const rpc::GSParams& params,
+                                      const std::string& buf,
+                                      dynamic::Value& value);
 #endif  // NETWORKX
 
   bl::result<rpc::graph::GraphDefPb> addLabelsToGraph(
@@ -242,6 +259,7 @@ class GrapeInstance : public Subscriber {
 
   grape::CommSpec comm_spec_;
   ObjectManager object_manager_;
+  ProjectionCache projection_cache_;
   std::shared_ptr<vineyard::Client> client_;
 };
 }  // namespace gs
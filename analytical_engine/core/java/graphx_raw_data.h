@@ -22,7 +22,7 @@
 #include <vector>
 
 #include "arrow/array.h"
-#include "arrow/array/builder_binary.h"
+#include "arrow/buffer.h"
 
 #include "grape/grape.h"
 #include "grape/utils/vertex_array.h"
@@ -48,22 +48,22 @@ static inline std::shared_ptr<vineyard::Object> buildStringArray(
     vineyard::Client& client, std::vector<char>& buffer,
     std::vector<int32_t> offsets) {
   LOG(INFO) << "Building array of size: " << offsets.size();
-  using arrow_builder_t =
-      typename vineyard::ConvertToArrowType<std::string>::BuilderType;
-  arrow_builder_t builder;
-  // builder.AppendValues(raw_data);
-  ARROW_CHECK_OK(builder.Reserve(offsets.size()));
-  ARROW_CHECK_OK(builder.ReserveData(buffer.size()));
-  const char* ptr = buffer.data();
-  for (auto offset : offsets) {
-    builder.UnsafeAppend(ptr, offset);
-    ptr += offset;
-  }
-  LOG(INFO) << "Finish building arrow array";
   using arrow_array_t =
       typename vineyard::ConvertToArrowType<std::string>::ArrayType;
-  std::shared_ptr<arrow_array_t> arrow_array;
-  ARROW_CHECK_OK(builder.Finish(&arrow_array));
+  using offset_t = typename arrow_array_t::offset_type;
+  // offsets holds the length of each string, turn them into the offsets of
+  // arrow and wrap the buffer, rather than copying the strings one by one
+  // into an arrow builder before vineyard copies them again
+  std::vector<offset_t> value_offsets(offsets.size() + 1);
+  value_offsets[0] = 0;
+  for (size_t i = 0; i < offsets.size(); ++i) {
+    value_offsets[i + 1] = value_offsets[i] + offsets[i];
+  }
+  CHECK_LE(static_cast<size_t>(value_offsets.back()), buffer.size());
+  auto arrow_array = std::make_shared<arrow_array_t>(
+      static_cast<int64_t>(offsets.size()), arrow::Buffer::Wrap(value_offsets),
+      arrow::Buffer::Wrap(buffer.data(), value_offsets.back()));
+  LOG(INFO) << "Finish building arrow array";
   using vineyard_builder_t =
       typename vineyard::InternalType<std::string>::vineyard_builder_type;
   vineyard_builder_t v6d_builder(client, arrow_array);
@@ -18,8 +18,12 @@
 
 #ifdef ENABLE_JAVA_SDK
 
+#include <cstdint>
 #include <string>
+#include <type_traits>
+#include <vector>
 
+#include "grape/parallel/message_in_buffer.h"
 #include "grape/serialization/in_archive.h"
 #include "grape/serialization/out_archive.h"
 
@@ -97,6 +101,53 @@ inline PrimitiveMessage<T>& operator-=(PrimitiveMessage<T>& lhs,
   lhs.data -= rhs.data;
   return lhs;
 }
+
+/**
+ * @brief Messages drained from MessageInBuffers in a single call, with the
+ * local ids of their vertices. Java reads them through the addresses of the
+ * two arrays, instead of crossing FFI for each message.
+ *
+ * @tparam VID_T
+ * @tparam MSG_T Should be trivially copyable, e.g., DoubleMsg or LongMsg.
+ */
+template <typename VID_T, typename MSG_T>
+class MessageBatch {
+  static_assert(std::is_trivially_copyable<MSG_T>::value,
+                "Messages of a batch are read from Java as raw memory");
+
+ public:
+  /**
+   * @brief Append the messages of buffer to the batch.
+   */
+  template <typename FRAG_T>
+  void Drain(const FRAG_T& frag, grape::MessageInBuffer& buffer) {
+    typename FRAG_T::vertex_t v;
+    MSG_T msg;
+    while (buffer.GetMessage(frag, v, msg)) {
+      vertices_.push_back(v.GetValue());
+      messages_.push_back(msg);
+    }
+  }
+
+  void Clear() {
+    vertices_.clear();
+    messages_.clear();
+  }
+
+  int64_t Size() const { return static_cast<int64_t>(vertices_.size()); }
+
+  int64_t GetVerticesAddress() const {
+    return reinterpret_cast<int64_t>(vertices_.data());
+  }
+
+  int64_t GetMessagesAddress() const {
+    return reinterpret_cast<int64_t>(messages_.data());
+  }
+
+ private:
+  std::vector<VID_T> vertices_;
+  std::vector<MSG_T> messages_;
+};
 }  // namespace gs
 
 #endif
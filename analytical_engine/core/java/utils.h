@@ -137,13 +137,11 @@ struct TypeName<uint64_t> {
 template <typename T>
 std::shared_ptr<vineyard::Object> buildPrimitiveArray(
     vineyard::Client& client, std::vector<T>& raw_data) {
-  using arrow_builder_t = typename vineyard::ConvertToArrowType<T>::BuilderType;
-  arrow_builder_t builder;
-  ARROW_CHECK_OK(builder.AppendValues(raw_data));
-
+  // wraps raw_data rather than appending it to an arrow builder, so that it
+  // is copied only once, into the shared memory of vineyard
   using arrow_array_t = typename vineyard::ConvertToArrowType<T>::ArrayType;
-  std::shared_ptr<arrow_array_t> arrow_array;
-  ARROW_CHECK_OK(builder.Finish(&arrow_array));
+  auto arrow_array = std::make_shared<arrow_array_t>(
+      static_cast<int64_t>(raw_data.size()), arrow::Buffer::Wrap(raw_data));
 
   using vineyard_builder_t =
       typename vineyard::ConvertToArrowType<T>::VineyardBuilderType;
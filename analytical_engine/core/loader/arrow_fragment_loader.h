@@ -43,6 +43,7 @@
 
 #include "core/error.h"
 #include "core/io/property_parser.h"
+#include "core/loader/parallel_table_reader.h"
 #ifdef ENABLE_JAVA_SDK
 #include "core/java/java_loader_invoker.h"
 #endif
@@ -187,10 +188,23 @@ class ArrowFragmentLoader : public vineyard::ArrowFragmentLoader<OID_T, VID_T> {
       }
       LOG_IF(INFO, !comm_spec_.worker_id())
           << MARKER << "DESCRIPTION-" << labels.str();
+      // read the tables of all labels from locations ahead, vertices first
+      table_reader_ = std::make_shared<ParallelTableReader>(
+          locationsToRead(), comm_spec_.worker_id(), comm_spec_.worker_num(),
+          comm_spec_.local_num());
     }
-    BOOST_LEAF_AUTO(v_tables, LoadVertexTables());
-    BOOST_LEAF_AUTO(e_tables, LoadEdgeTables());
-    return std::make_pair(v_tables, e_tables);
+    auto v_tables = LoadVertexTables();
+    if (!v_tables) {
+      table_reader_.reset();
+      return v_tables.error();
+    }
+    auto e_tables = LoadEdgeTables();
+    table_reader_.reset();
+    if (!e_tables) {
+      return e_tables.error();
+    }
+    return std::make_pair(std::move(v_tables.value()),
+                          std::move(e_tables.value()));
   }
 
   bl::result<table_vec_t> LoadVertexTables() {
@@ -267,7 +281,13 @@ class ArrowFragmentLoader : public vineyard::ArrowFragmentLoader<OID_T, VID_T> {
 
   bl::result<vineyard::ObjectID> AddLabelsToFragment(
       vineyard::ObjectID frag_id) {
-    BOOST_LEAF_CHECK(initPartitioner());
+    // the new edges are routed by the gids of their ends in the vertex map of
+    // the fragment, the partitioner is only needed to place new vertices
+    bool adds_vertices =
+        graph_info_ ? !graph_info_->vertices.empty() : !vfiles_.empty();
+    if (adds_vertices) {
+      BOOST_LEAF_CHECK(initPartitioner());
+    }
     BOOST_LEAF_AUTO(raw_v_e_tables, LoadVertexEdgeTables());
     return Base::addVerticesAndEdges(frag_id, std::move(raw_v_e_tables));
   }
@@ -419,9 +439,9 @@ class ArrowFragmentLoader : public vineyard::ArrowFragmentLoader<OID_T, VID_T> {
 #endif
         } else {
           // Let the IOFactory to parse other protocols.
-          auto path = vertices[i]->values;
-          VY_OK_OR_RAISE(vineyard::ReadTableFromLocation(
-              vertices[i]->values, table, index, total_parts));
+          VY_OK_OR_RAISE(
+              readTableFromLocation(vertices[i]->values, table, index,
+                                    total_parts));
         }
         return table;
       };
@@ -537,8 +557,8 @@ class ArrowFragmentLoader : public vineyard::ArrowFragmentLoader<OID_T, VID_T> {
 #endif
           } else {
             // Let the IOFactory to parse other protocols.
-            VY_OK_OR_RAISE(vineyard::ReadTableFromLocation(
-                sub_labels[j].values, table, index, total_parts));
+            VY_OK_OR_RAISE(readTableFromLocation(sub_labels[j].values, table,
+                                                 index, total_parts));
           }
           return table;
         };
@@ -562,7 +582,46 @@ class ArrowFragmentLoader : public vineyard::ArrowFragmentLoader<OID_T, VID_T> {
     return tables;
   }
 
+  // The locations read by the IOFactory, in the order of reading.
+  std::vector<std::string> locationsToRead() const {
+    std::vector<std::string> locations;
+    for (auto& vertex : graph_info_->vertices) {
+      if (isLocation(vertex->protocol, vertex->vformat)) {
+        locations.push_back(vertex->values);
+      }
+    }
+    for (auto& edge : graph_info_->edges) {
+      for (auto& sub_label : edge->sub_labels) {
+        if (isLocation(sub_label.protocol, sub_label.eformat)) {
+          locations.push_back(sub_label.values);
+        }
+      }
+    }
+    return locations;
+  }
+
+  static bool isLocation(const std::string& protocol,
+                         const std::string& format) {
+    return protocol != "numpy" && protocol != "pandas" &&
+           protocol != "vineyard" &&
+           !(protocol == "file" && format.find("giraph") != std::string::npos);
+  }
+
+  vineyard::Status readTableFromLocation(const std::string& location,
+                                         std::shared_ptr<arrow::Table>& table,
+                                         int index, int total_parts) {
+    if (table_reader_ != nullptr && index == comm_spec_.worker_id() &&
+        total_parts == comm_spec_.worker_num() &&
+        table_reader_->Contains(location)) {
+      return table_reader_->Take(location, table);
+    }
+    return vineyard::ReadTableFromLocation(location, table, index,
+                                           total_parts);
+  }
+
   std::shared_ptr<detail::Graph> graph_info_;
+  // reads the tables of LoadVertexEdgeTables() in the background
+  std::shared_ptr<ParallelTableReader> table_reader_;
 
   bool giraph_enabled_;
 #ifdef ENABLE_JAVA_SDK
@@ -186,12 +186,19 @@ class ArrowToDynamicConverter {
     std::vector<int> inner_ie_degree(dst_vm->GetInnerVertexSize(fid), 0);
     std::vector<int> outer_oe_degree(ovnum, 0);
     std::vector<int> outer_ie_degree(ovnum, 0);
-    ska::flat_hash_map<vid_t, vid_t> ovg2i;
-    vid_t ov_index = 0, index = 0;
+
+    // resolve the property columns once, rather than per vertex or edge
+    std::vector<PropertyTableConverter> e_converters;
+    for (label_id_t e_label = 0; e_label < src_frag->edge_label_num();
+         e_label++) {
+      e_converters.emplace_back(src_frag->edge_data_table(e_label));
+    }
     for (label_id_t v_label = 0; v_label < src_frag->vertex_label_num();
          v_label++) {
       auto inner_vertices = src_frag->InnerVertices(v_label);
       auto v_data = src_frag->vertex_data_table(v_label);
+      // N.B: th last column is id, we ignore it.
+      PropertyTableConverter v_converter(v_data, v_data->num_columns() - 1);
 
       parallel_for(
           inner_vertices.begin(), inner_vertices.end(),
@@ -199,44 +206,22 @@ class ArrowToDynamicConverter {
             vid_t u_gid = gid2Gid(src_frag->GetInnerVertexGid(u));
             vid_t lid = dynamic_id_parser_.get_local_id(u_gid);
             // extract vertex properties
-            // N.B: th last column is id, we ignore it.
             dynamic::Value vertex_data(rapidjson::kObjectType);
-            for (auto col_id = 0; col_id < v_data->num_columns() - 1;
-                 col_id++) {
-              auto column = v_data->column(col_id);
-              auto& prop_key = v_data->field(col_id)->name();
-              auto type = column->type();
-              PropertyConverter<src_fragment_t>::NodeValue(
-                  src_frag, u, type, prop_key, col_id, vertex_data,
-                  (*allocators)[tid]);
-            }
+            v_converter.RowValue(arrow_id_parser_.GetOffset(u.GetValue()),
+                                 vertex_data, (*allocators)[tid]);
             vertices[tid].emplace_back(lid, std::move(vertex_data));
 
             // traverse edges and extract edge properties
             for (label_id_t e_label = 0; e_label < src_frag->edge_label_num();
                  e_label++) {
-              auto e_data = src_frag->edge_data_table(e_label);
+              auto& e_converter = e_converters[e_label];
               auto oe = src_frag->GetOutgoingAdjList(u, e_label);
               inner_oe_degree[lid] += oe.Size();
               for (auto& e : oe) {
-                auto v = e.get_neighbor();
-                auto e_id = e.edge_id();
-                vid_t v_gid = gid2Gid(src_frag->Vertex2Gid(v));
-                if (src_frag->IsOuterVertex(v)) {
-                  auto iter = ovg2i.find(v_gid);
-                  if (iter != ovg2i.end()) {
-                    index = iter->second;
-                  } else {
-                    ovg2i.emplace(v_gid, ov_index);
-                    index = ov_index;
-                    ++ov_index;
-                  }
-                  src_frag->directed() ? outer_ie_degree[index]++
-                                       : outer_oe_degree[index]++;
-                }
+                vid_t v_gid = gid2Gid(src_frag->Vertex2Gid(e.get_neighbor()));
                 dynamic::Value edge_data(rapidjson::kObjectType);
-                PropertyConverter<src_fragment_t>::EdgeValue(
-                    e_data, e_id, edge_data, (*allocators)[tid]);
+                e_converter.RowValue(e.edge_id(), edge_data,
+                                     (*allocators)[tid]);
                 edges[tid].emplace_back(u_gid, v_gid, std::move(edge_data));
               }
 
@@ -246,22 +231,10 @@ class ArrowToDynamicConverter {
                 for (auto& e : ie) {
                   auto v = e.get_neighbor();
                   if (src_frag->IsOuterVertex(v)) {
-                    auto e_id = e.edge_id();
                     vid_t v_gid = gid2Gid(src_frag->GetOuterVertexGid(v));
-                    if (src_frag->IsOuterVertex(v)) {
-                      auto iter = ovg2i.find(v_gid);
-                      if (iter != ovg2i.end()) {
-                        index = iter->second;
-                      } else {
-                        ovg2i.emplace(v_gid, ov_index);
-                        index = ov_index;
-                        ++ov_index;
-                      }
-                      outer_oe_degree[index]++;
-                    }
                     dynamic::Value edge_data(rapidjson::kObjectType);
-                    PropertyConverter<src_fragment_t>::EdgeValue(
-                        e_data, e_id, edge_data, (*allocators)[tid]);
+                    e_converter.RowValue(e.edge_id(), edge_data,
+                                         (*allocators)[tid]);
                     edges[tid].emplace_back(v_gid, u_gid, std::move(edge_data));
                   }
                 }
@@ -271,6 +244,27 @@ class ArrowToDynamicConverter {
           thread_num);
     }
 
+    // The degrees of outer vertices, indexed in the order DynamicFragment::Init
+    // numbers outer vertices, i.e., by the first edge that reaches them.
+    ska::flat_hash_map<vid_t, vid_t> ovg2i;
+    auto outer_index = [&ovg2i](vid_t gid) {
+      return ovg2i.emplace(gid, static_cast<vid_t>(ovg2i.size()))
+          .first->second;
+    };
+    for (auto& vec : edges) {
+      for (auto& e : vec) {
+        if (dynamic_id_parser_.get_fragment_id(e.src) == fid) {
+          if (dynamic_id_parser_.get_fragment_id(e.dst) != fid) {
+            auto index = outer_index(e.dst);
+            src_frag->directed() ? outer_ie_degree[index]++
+                                 : outer_oe_degree[index]++;
+          }
+        } else {
+          outer_oe_degree[outer_index(e.src)]++;
+        }
+      }
+    }
+
     dynamic_frag->Init(src_frag->fid(), src_frag->directed(), vertices, edges,
                        inner_oe_degree, outer_oe_degree, inner_ie_degree,
                        outer_ie_degree, thread_num);
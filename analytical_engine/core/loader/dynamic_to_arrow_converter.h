@@ -52,6 +52,7 @@ struct VertexArrayBuilder<arrow::Int64Builder> {
       const std::shared_ptr<DynamicFragment>& src_frag, std::string& prop_key) {
     arrow::Int64Builder builder;
     std::shared_ptr<arrow::Array> array;
+    ARROW_OK_OR_RAISE(builder.Reserve(src_frag->GetInnerVerticesNum()));
 
     for (const auto& u : src_frag->InnerVertices()) {
       if (!src_frag->IsAliveInnerVertex(u)) {
@@ -59,10 +60,11 @@ struct VertexArrayBuilder<arrow::Int64Builder> {
       }
       auto& data = src_frag->GetData(u);
 
-      if (data.HasMember(prop_key) == 0) {
+      auto member = data.FindMember(prop_key);
+      if (member == data.MemberEnd()) {
         ARROW_OK_OR_RAISE(builder.AppendNull());
       } else {
-        ARROW_OK_OR_RAISE(builder.Append(data[prop_key].GetInt64()));
+        ARROW_OK_OR_RAISE(builder.Append(member->value.GetInt64()));
       }
     }
 
@@ -80,6 +82,7 @@ struct VertexArrayBuilder<arrow::DoubleBuilder> {
       const std::shared_ptr<DynamicFragment>& src_frag, std::string& prop_key) {
     arrow::DoubleBuilder builder;
     std::shared_ptr<arrow::Array> array;
+    ARROW_OK_OR_RAISE(builder.Reserve(src_frag->GetInnerVerticesNum()));
 
     for (const auto& u : src_frag->InnerVertices()) {
       if (!src_frag->IsAliveInnerVertex(u)) {
@@ -88,10 +91,11 @@ struct VertexArrayBuilder<arrow::DoubleBuilder> {
 
       auto& data = src_frag->GetData(u);
 
-      if (data.HasMember(prop_key) == 0) {
+      auto member = data.FindMember(prop_key);
+      if (member == data.MemberEnd()) {
         ARROW_OK_OR_RAISE(builder.AppendNull());
       } else {
-        ARROW_OK_OR_RAISE(builder.Append(data[prop_key].GetDouble()));
+        ARROW_OK_OR_RAISE(builder.Append(member->value.GetDouble()));
       }
     }
 
@@ -109,6 +113,7 @@ struct VertexArrayBuilder<arrow::LargeStringBuilder> {
       const std::shared_ptr<DynamicFragment>& src_frag, std::string& prop_key) {
     arrow::LargeStringBuilder builder;
     std::shared_ptr<arrow::Array> array;
+    ARROW_OK_OR_RAISE(builder.Reserve(src_frag->GetInnerVerticesNum()));
 
     for (const auto& u : src_frag->InnerVertices()) {
       if (!src_frag->IsAliveInnerVertex(u)) {
@@ -116,10 +121,11 @@ struct VertexArrayBuilder<arrow::LargeStringBuilder> {
       }
 
       auto& data = src_frag->GetData(u);
-      if (data.HasMember(prop_key) == 0) {
+      auto member = data.FindMember(prop_key);
+      if (member == data.MemberEnd()) {
         ARROW_OK_OR_RAISE(builder.AppendNull());
       } else {
-        ARROW_OK_OR_RAISE(builder.Append(data[prop_key].GetString()));
+        ARROW_OK_OR_RAISE(builder.Append(member->value.GetString()));
       }
     }
 
@@ -157,10 +163,11 @@ struct EdgeArrayBuilder<arrow::Int64Builder> {
         }
 
         auto& data = e.data;
-        if (data.HasMember(prop_key) == 0) {
+        auto member = data.FindMember(prop_key);
+        if (member == data.MemberEnd()) {
           ARROW_OK_OR_RAISE(builder.AppendNull());
         } else {
-          ARROW_OK_OR_RAISE(builder.Append(data[prop_key].GetInt64()));
+          ARROW_OK_OR_RAISE(builder.Append(member->value.GetInt64()));
         }
       }
       if (src_frag->directed()) {
@@ -168,10 +175,11 @@ struct EdgeArrayBuilder<arrow::Int64Builder> {
           auto& v = e.neighbor;
           if (src_frag->IsOuterVertex(v)) {
             auto& data = e.data;
-            if (data.HasMember(prop_key) == 0) {
+            auto member = data.FindMember(prop_key);
+            if (member == data.MemberEnd()) {
               ARROW_OK_OR_RAISE(builder.AppendNull());
             } else {
-              ARROW_OK_OR_RAISE(builder.Append(data[prop_key].GetInt64()));
+              ARROW_OK_OR_RAISE(builder.Append(member->value.GetInt64()));
             }
           }
         }
@@ -203,10 +211,11 @@ struct EdgeArrayBuilder<arrow::DoubleBuilder> {
         }
 
         auto& data = e.data;
-        if (data.HasMember(prop_key) == 0) {
+        auto member = data.FindMember(prop_key);
+        if (member == data.MemberEnd()) {
           ARROW_OK_OR_RAISE(builder.AppendNull());
         } else {
-          ARROW_OK_OR_RAISE(builder.Append(data[prop_key].GetDouble()));
+          ARROW_OK_OR_RAISE(builder.Append(member->value.GetDouble()));
         }
       }
       if (src_frag->directed()) {
@@ -214,10 +223,11 @@ struct EdgeArrayBuilder<arrow::DoubleBuilder> {
           auto& v = e.neighbor;
           if (src_frag->IsOuterVertex(v)) {
             auto& data = e.data;
-            if (data.HasMember(prop_key) == 0) {
+            auto member = data.FindMember(prop_key);
+            if (member == data.MemberEnd()) {
               ARROW_OK_OR_RAISE(builder.AppendNull());
             } else {
-              ARROW_OK_OR_RAISE(builder.Append(data[prop_key].GetDouble()));
+              ARROW_OK_OR_RAISE(builder.Append(member->value.GetDouble()));
             }
           }
         }
@@ -250,10 +260,11 @@ struct EdgeArrayBuilder<arrow::LargeStringBuilder> {
         }
 
         auto& data = e.data;
-        if (data.HasMember(prop_key) == 0) {
+        auto member = data.FindMember(prop_key);
+        if (member == data.MemberEnd()) {
           ARROW_OK_OR_RAISE(builder.AppendNull());
         } else {
-          ARROW_OK_OR_RAISE(builder.Append(data[prop_key].GetString()));
+          ARROW_OK_OR_RAISE(builder.Append(member->value.GetString()));
         }
       }
       if (src_frag->directed()) {
@@ -261,10 +272,11 @@ struct EdgeArrayBuilder<arrow::LargeStringBuilder> {
           auto& v = e.neighbor;
           if (src_frag->IsOuterVertex(v)) {
             auto& data = e.data;
-            if (data.HasMember(prop_key) == 0) {
+            auto member = data.FindMember(prop_key);
+            if (member == data.MemberEnd()) {
               ARROW_OK_OR_RAISE(builder.AppendNull());
             } else {
-              ARROW_OK_OR_RAISE(builder.Append(data[prop_key].GetString()));
+              ARROW_OK_OR_RAISE(builder.Append(member->value.GetString()));
             }
           }
         }
@@ -0,0 +1,144 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef ANALYTICAL_ENGINE_CORE_LOADER_PARALLEL_TABLE_READER_H_
+#define ANALYTICAL_ENGINE_CORE_LOADER_PARALLEL_TABLE_READER_H_
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "vineyard/common/util/status.h"
+#include "vineyard/graph/loader/fragment_loader_utils.h"
+
+namespace gs {
+
+/**
+ * @brief Read the tables of a worker from locations in the background, with
+ * at most kMaxReads reads in flight, so that reading the tables of labels
+ * overlaps with each other and with the normalization of the tables already
+ * read.
+ *
+ * A location shared by several labels is read once. The tables are taken in
+ * any order, taking a table not read yet waits for it.
+ */
+class ParallelTableReader {
+ public:
+  static constexpr int kMaxReads = 4;
+
+  ParallelTableReader(const std::vector<std::string>& locations, int index,
+                      int total_parts, int local_num)
+      : index_(index), total_parts_(total_parts), next_(0), cancelled_(false) {
+    for (auto& location : locations) {
+      auto& read = reads_[location];
+      if (read.uses++ == 0) {
+        order_.push_back(location);
+      }
+    }
+    int thread_num = std::min<int>(
+        order_.size(),
+        std::max<int>(1, std::thread::hardware_concurrency() /
+                             std::max(local_num, 1)));
+    if (thread_num > kMaxReads) {
+      thread_num = kMaxReads;
+    }
+    for (int i = 0; i < thread_num; ++i) {
+      threads_.emplace_back([this]() { readLoop(); });
+    }
+  }
+
+  ~ParallelTableReader() {
+    cancelled_ = true;
+    for (auto& thread : threads_) {
+      thread.join();
+    }
+  }
+
+  ParallelTableReader(const ParallelTableReader&) = delete;
+  ParallelTableReader& operator=(const ParallelTableReader&) = delete;
+
+  /**
+   * @brief Whether location is read by this reader.
+   */
+  bool Contains(const std::string& location) const {
+    return reads_.find(location) != reads_.end();
+  }
+
+  /**
+   * @brief Wait for the table of location, the reader drops its reference
+   * once the table is taken by all the labels of the location.
+   */
+  vineyard::Status Take(const std::string& location,
+                        std::shared_ptr<arrow::Table>& table) {
+    auto& read = reads_.at(location);
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [&read]() { return read.done; });
+    table = read.table;
+    if (--read.uses == 0) {
+      read.table.reset();
+    }
+    return read.status;
+  }
+
+ private:
+  struct Read {
+    int uses = 0;
+    bool done = false;
+    vineyard::Status status;
+    std::shared_ptr<arrow::Table> table;
+  };
+
+  void readLoop() {
+    while (!cancelled_) {
+      size_t got = next_.fetch_add(1);
+      if (got >= order_.size()) {
+        break;
+      }
+      std::shared_ptr<arrow::Table> table;
+      auto status = vineyard::ReadTableFromLocation(order_[got], table, index_,
+                                                    total_parts_);
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto& read = reads_.at(order_[got]);
+        read.status = status;
+        read.table = table;
+        read.done = true;
+      }
+      cv_.notify_all();
+    }
+  }
+
+  int index_;
+  int total_parts_;
+  // locations in the order of reading
+  std::vector<std::string> order_;
+  std::map<std::string, Read> reads_;
+  std::atomic<size_t> next_;
+  std::atomic<bool> cancelled_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::vector<std::thread> threads_;
+};
+
+}  // namespace gs
+
+#endif  // ANALYTICAL_ENGINE_CORE_LOADER_PARALLEL_TABLE_READER_H_
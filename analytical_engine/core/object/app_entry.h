@@ -53,6 +53,8 @@ typedef void QueryT(void* worker_handler, const rpc::QueryArgs& query_args,
                     std::shared_ptr<IContextWrapper>& ctx_wrapper,
                     bl::result<std::nullptr_t>& wrapper_error);
 
+typedef void GetProfileT(void* worker_handler, std::string& profile);
+
 /**
  * @brief AppEntry is a class manages an application.
  *
@@ -68,7 +70,8 @@ class AppEntry : public GSObject {
         dl_handle_(nullptr),
         create_worker_(nullptr),
         delete_worker_(nullptr),
-        query_(nullptr) {}
+        query_(nullptr),
+        get_profile_(nullptr) {}
 
   bl::result<void> Init() {
     { BOOST_LEAF_ASSIGN(dl_handle_, open_lib(lib_path_.c_str())); }
@@ -86,6 +89,10 @@ class AppEntry : public GSObject {
       BOOST_LEAF_AUTO(p_fun, get_func_ptr(lib_path_, dl_handle_, "Query"));
       query_ = reinterpret_cast<QueryT*>(p_fun);
     }
+    // optional, apps built by other frames record no profile
+    get_profile_ = reinterpret_cast<GetProfileT*>(
+        dlsym(dl_handle_, "GetProfile"));
+    dlerror();
     return {};
   }
 
@@ -110,12 +117,25 @@ class AppEntry : public GSObject {
     return ctx_wrapper;
   }
 
+  /**
+   * @brief The JSON profile of the last query of the worker, or an empty
+   * string if the app does not record one.
+   */
+  std::string GetProfile(void* worker_handler) {
+    std::string profile;
+    if (get_profile_ != nullptr) {
+      get_profile_(worker_handler, profile);
+    }
+    return profile;
+  }
+
  private:
   std::string lib_path_;
   void* dl_handle_;
   CreateWorkerT* create_worker_;
   DeleteWorkerT* delete_worker_;
   QueryT* query_;
+  GetProfileT* get_profile_;
 };
 }  // namespace gs
 
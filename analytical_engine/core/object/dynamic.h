@@ -207,6 +207,25 @@ class Value : public rapidjson::Value {
     Update(std::move(value));
   }
 
+  // Update with copy semantics, the copies are made by allocator, for the
+  // callers that must not share allocator_ across threads.
+  void Update(const rapidjson::Value& rhs, AllocatorT& allocator) {
+    if (!rhs.IsObject() || rhs.ObjectEmpty()) {
+      return;
+    }
+    for (auto member = rhs.MemberBegin(); member != rhs.MemberEnd();
+         ++member) {
+      rapidjson::Value value(member->value, allocator);
+      auto dst_member = Base::FindMember(member->name);
+      if (dst_member == Base::MemberEnd()) {
+        rapidjson::Value name(member->name, allocator);
+        Base::AddMember(name, value, allocator);
+      } else {
+        dst_member->value = value;
+      }
+    }
+  }
+
   // PushBack for array
   template <typename T>
   Value& PushBack(T value) {
@@ -394,11 +394,11 @@ class FragmentWrapper<
           std::static_pointer_cast<const ArrowProjectedFragmentBase>(
               frag_wrapper->fragment())
               ->meta();
-      const auto& frag_meta = proj_meta.GetMemberMeta("arrow_fragment");
-
-      vm_id_from_ctx =
-          client->GetObject<vineyard::ArrowFragmentBase>(frag_meta.GetId())
-              ->vertex_map_id();
+      // read the id from the metadata rather than constructing the whole
+      // property fragment behind the projected one
+      vm_id_from_ctx = proj_meta.GetMemberMeta("arrow_projected_vertex_map")
+                           .GetMemberMeta("arrow_vertex_map")
+                           .GetId();
     }
 
     std::map<label_id_t,
@@ -20,7 +20,9 @@
 
 #include <map>
 #include <memory>
+#include <mutex>
 #include <ostream>
+#include <shared_mutex>
 #include <string>
 #include <utility>
 
@@ -35,51 +37,73 @@ namespace gs {
 /**
  * @brief ObjectManager manages GSObject like fragment wrapper, loaded app and
  * more.
+ *
+ * The manager is safe to use from multiple threads: lookups share the lock and
+ * hand out shared pointers, so that an object outlives its removal for the
+ * holders.
  */
 class ObjectManager {
  public:
   bl::result<void> PutObject(std::shared_ptr<GSObject> obj) {
-    auto& id = obj->id();
+    auto id = obj->id();
+    return PutObject(id, std::move(obj));
+  }
 
+  /**
+   * @brief Put an object under another id, e.g., a shared projected fragment.
+   */
+  bl::result<void> PutObject(const std::string& id,
+                             std::shared_ptr<GSObject> obj) {
     DLOG(INFO) << "[object manager] putting " << id;
 
-    if (objects.find(id) != objects.end()) {
-      auto existed_obj_type = objects[id]->type();
+    std::unique_lock<std::shared_timed_mutex> lock(mutex_);
+    auto iter = objects.find(id);
+    if (iter != objects.end()) {
+      auto existed_obj_type = iter->second->type();
       std::stringstream ss;
       ss << "Object " << id << "[" << ObjectTypeToString(existed_obj_type)
          << "]"
          << " already exists.";
       RETURN_GS_ERROR(vineyard::ErrorCode::kInvalidOperationError, ss.str());
     }
-    objects[id] = std::move(obj);
+    objects.emplace(id, std::move(obj));
     return {};
   }
 
   bl::result<void> RemoveObject(const std::string& id) {
     DLOG(INFO) << "[object manager] removing " << id;
-    if (objects.find(id) != objects.end()) {
-      objects.erase(id);
+    std::shared_ptr<GSObject> removed;
+    {
+      std::unique_lock<std::shared_timed_mutex> lock(mutex_);
+      auto iter = objects.find(id);
+      if (iter != objects.end()) {
+        removed = std::move(iter->second);
+        objects.erase(iter);
+      }
     }
+    // the object is released out of the lock
     return {};
   }
 
   bl::result<std::shared_ptr<GSObject>> GetObject(const std::string& id) {
     DLOG(INFO) << "[object manager] getting " << id;
-    if (objects.find(id) == objects.end()) {
+    auto obj = find(id);
+    if (obj == nullptr) {
       RETURN_GS_ERROR(vineyard::ErrorCode::kInvalidOperationError,
                       "Object " + id + " does not exist");
     }
-    return objects[id];
+    return obj;
   }
 
   template <typename T>
   bl::result<std::shared_ptr<T>> GetObject(const std::string& id) {
     DLOG(INFO) << "[object manager] getting typed " << id;
-    if (objects.find(id) == objects.end()) {
+    auto found = find(id);
+    if (found == nullptr) {
       RETURN_GS_ERROR(vineyard::ErrorCode::kInvalidOperationError,
                       "Object " + id + " does not exist");
     }
-    auto obj = std::dynamic_pointer_cast<T>(objects[id]);
+    auto obj = std::dynamic_pointer_cast<T>(found);
 
     if (obj == nullptr) {
       RETURN_GS_ERROR(vineyard::ErrorCode::kInvalidValueError,
@@ -90,10 +114,17 @@ class ObjectManager {
 
   bool HasObject(const std::string& id) {
     DLOG(INFO) << "[object manager] has " << id;
-    return objects.find(id) != objects.end();
+    return find(id) != nullptr;
   }
 
  private:
+  std::shared_ptr<GSObject> find(const std::string& id) {
+    std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+    auto iter = objects.find(id);
+    return iter == objects.end() ? nullptr : iter->second;
+  }
+
+  std::shared_timed_mutex mutex_;
   std::map<std::string, std::shared_ptr<GSObject>> objects;
 };
 }  // namespace gs
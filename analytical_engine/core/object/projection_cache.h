@@ -0,0 +1,153 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANALYTICAL_ENGINE_CORE_OBJECT_PROJECTION_CACHE_H_
+#define ANALYTICAL_ENGINE_CORE_OBJECT_PROJECTION_CACHE_H_
+
+#include <glog/logging.h>
+
+#include <list>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "core/object/gs_object.h"
+#include "proto/graph_def.pb.h"
+
+namespace gs {
+
+/**
+ * @brief ProjectionCache shares the projected fragments of a property graph
+ * among the queries that project it in the same way.
+ *
+ * A projection is named once per query, and lives as long as it has a name.
+ * Projections without names are kept idle for reuse, the least recently used
+ * ones are evicted when there are more than `capacity` of them. Projections of
+ * an unloaded source are no longer shared, and are evicted once unnamed.
+ *
+ * Commands are executed in the same order by all workers, so that the cache of
+ * every worker evicts the same projections.
+ */
+class ProjectionCache {
+ public:
+  struct Entry {
+    std::string key;
+    std::string source;
+    std::shared_ptr<GSObject> wrapper;
+    rpc::graph::GraphDefPb graph_def;
+    std::set<std::string> names;
+    bool shared = true;
+    std::list<std::string>::iterator idle_pos;
+  };
+
+  explicit ProjectionCache(size_t capacity) : capacity_(capacity) {}
+
+  /**
+   * @brief Name the cached projection of key, returns nullptr on a miss.
+   */
+  std::shared_ptr<Entry> Acquire(const std::string& key,
+                                 const std::string& name) {
+    auto iter = entries_.find(key);
+    if (iter == entries_.end()) {
+      return nullptr;
+    }
+    auto entry = iter->second;
+    if (entry->names.empty()) {
+      idle_.erase(entry->idle_pos);
+    }
+    entry->names.insert(name);
+    names_[name] = entry;
+    VLOG(1) << "[projection cache] reusing " << key << " as " << name;
+    return entry;
+  }
+
+  void Insert(const std::string& key, const std::string& source,
+              const std::string& name, std::shared_ptr<GSObject> wrapper,
+              const rpc::graph::GraphDefPb& graph_def) {
+    auto entry = std::make_shared<Entry>();
+    entry->key = key;
+    entry->source = source;
+    entry->wrapper = std::move(wrapper);
+    entry->graph_def = graph_def;
+    entry->names.insert(name);
+    entries_[key] = entry;
+    names_[name] = entry;
+  }
+
+  /**
+   * @brief Unname a projection. Returns false if name is not a projection in
+   * the cache, otherwise the projections to delete are appended to evicted.
+   */
+  bool Release(const std::string& name,
+               std::vector<std::shared_ptr<Entry>>& evicted) {
+    auto iter = names_.find(name);
+    if (iter == names_.end()) {
+      return false;
+    }
+    auto entry = iter->second;
+    names_.erase(iter);
+    entry->names.erase(name);
+    if (!entry->names.empty()) {
+      return true;
+    }
+    if (!entry->shared) {
+      evicted.push_back(entry);
+      return true;
+    }
+    entry->idle_pos = idle_.insert(idle_.end(), entry->key);
+    while (idle_.size() > capacity_) {
+      auto victim = entries_.at(idle_.front());
+      idle_.pop_front();
+      entries_.erase(victim->key);
+      VLOG(1) << "[projection cache] evicting " << victim->key;
+      evicted.push_back(victim);
+    }
+    return true;
+  }
+
+  /**
+   * @brief Stop sharing the projections of an unloaded source. The idle ones
+   * are appended to evicted, the named ones are evicted by Release().
+   */
+  void ReleaseSource(const std::string& source,
+                     std::vector<std::shared_ptr<Entry>>& evicted) {
+    for (auto iter = entries_.begin(); iter != entries_.end();) {
+      auto entry = iter->second;
+      if (entry->source != source) {
+        ++iter;
+        continue;
+      }
+      entry->shared = false;
+      if (entry->names.empty()) {
+        idle_.erase(entry->idle_pos);
+        evicted.push_back(entry);
+      }
+      iter = entries_.erase(iter);
+    }
+  }
+
+ private:
+  size_t capacity_;
+  std::map<std::string, std::shared_ptr<Entry>> entries_;
+  std::map<std::string, std::shared_ptr<Entry>> names_;
+  // keys of the unnamed projections, the least recently used first
+  std::list<std::string> idle_;
+};
+
+}  // namespace gs
+#endif  // ANALYTICAL_ENGINE_CORE_OBJECT_PROJECTION_CACHE_H_
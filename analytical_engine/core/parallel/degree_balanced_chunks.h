@@ -0,0 +1,99 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANALYTICAL_ENGINE_CORE_PARALLEL_DEGREE_BALANCED_CHUNKS_H_
+#define ANALYTICAL_ENGINE_CORE_PARALLEL_DEGREE_BALANCED_CHUNKS_H_
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "grape/utils/vertex_array.h"
+
+namespace gs {
+
+/**
+ * @brief A range of vertices split into chunks of about the same number of
+ * edges.
+ *
+ * ParallelEngine::ForEach hands out chunks of the same number of vertices, so
+ * the thread that gets the hubs of a power-law graph keeps running long after
+ * the others are idle. Threads claim these chunks one at a time instead, and a
+ * hub ends up in a chunk of its own. The chunks are built once, and reused by
+ * every round over the same range.
+ */
+template <typename VID_T>
+class DegreeBalancedChunks {
+ public:
+  using vertex_t = grape::Vertex<VID_T>;
+
+  /**
+   * @brief Split range by degree(v), the number of edges visited for v.
+   */
+  template <typename DEGREE_FUNC_T>
+  void Init(const grape::VertexRange<VID_T>& range, int thread_num,
+            const DEGREE_FUNC_T& degree) {
+    chunks_.clear();
+    // a vertex costs as much as an edge even without any edge
+    size_t total = 0;
+    for (auto v : range) {
+      total += degree(v) + 1;
+    }
+    size_t chunk_num = std::max(thread_num, 1) * kChunksPerThread;
+    size_t target = std::max(total / chunk_num, static_cast<size_t>(1));
+
+    VID_T begin = range.begin_value();
+    size_t weight = 0;
+    for (auto v : range) {
+      weight += degree(v) + 1;
+      if (weight >= target || v.GetValue() + 1 - begin >= kMaxChunkSize) {
+        chunks_.emplace_back(begin, v.GetValue() + 1);
+        begin = v.GetValue() + 1;
+        weight = 0;
+      }
+    }
+    if (begin < range.end_value()) {
+      chunks_.emplace_back(begin, range.end_value());
+    }
+  }
+
+  /**
+   * @brief Call func(tid, v) for each vertex of the range on the threads of
+   * engine.
+   */
+  template <typename ENGINE_T, typename FUNC_T>
+  void ForEach(ENGINE_T& engine, const FUNC_T& func) const {
+    engine.ForEach(
+        chunks_.begin(), chunks_.end(),
+        [&func](int tid, const std::pair<VID_T, VID_T>& chunk) {
+          for (VID_T i = chunk.first; i < chunk.second; ++i) {
+            func(tid, vertex_t(i));
+          }
+        },
+        1);
+  }
+
+  bool empty() const { return chunks_.empty(); }
+
+ private:
+  static constexpr size_t kChunksPerThread = 16;
+  static constexpr VID_T kMaxChunkSize = 4096;
+
+  std::vector<std::pair<VID_T, VID_T>> chunks_;
+};
+
+}  // namespace gs
+
+#endif  // ANALYTICAL_ENGINE_CORE_PARALLEL_DEGREE_BALANCED_CHUNKS_H_
@@ -31,6 +31,7 @@
 #include "grape/parallel/message_manager_base.h"
 #include "grape/serialization/in_archive.h"
 #include "grape/serialization/out_archive.h"
+#include "grape/util.h"
 #include "grape/utils/concurrent_queue.h"
 #include "grape/worker/comm_spec.h"
 
@@ -50,10 +51,16 @@ namespace gs {
  * After a round of evaluation, there is a global barrier to determine whether
  * the fixed point is reached.
  *
+ * Messages to the fragment itself skip the sending thread and go to the
+ * incoming queue of the next round directly. With a single fragment, i.e., a
+ * single process running many threads, there is neither a sending nor a
+ * receiving thread, and the termination is decided without MPI.
  */
 class ParallelPropertyMessageManager : public grape::MessageManagerBase {
   static constexpr size_t default_msg_send_block_size = 2 * 1023 * 1024;
   static constexpr size_t default_msg_send_block_capacity = 2 * 1023 * 1024;
+  // number of outstanding sends before the finished ones are released
+  static constexpr size_t pending_send_threshold = 64;
 
  public:
   ParallelPropertyMessageManager() : comm_(NULL_COMM) {}
@@ -71,6 +78,7 @@ class ParallelPropertyMessageManager : public grape::MessageManagerBase {
     comm_spec_.Init(comm_);
     fid_ = comm_spec_.fid();
     fnum_ = comm_spec_.fnum();
+    local_ = (fnum_ == 1);
 
     force_terminate_ = false;
     terminate_info_.Init(fnum_);
@@ -81,31 +89,34 @@ class ParallelPropertyMessageManager : public grape::MessageManagerBase {
     round_ = 0;
 
     sent_size_ = 0;
+    wait_time_ = 0;
   }
 
   /**
    * @brief Inherit
    */
-  void Start() override { startRecvThread(); }
+  void Start() override {
+    if (!local_) {
+      startRecvThread();
+    }
+  }
 
   /**
    * @brief Inherit
    */
   void StartARound() override {
     if (round_ != 0) {
+      double t = grape::GetCurrentTime();
       waitSend();
-      auto& rq = recv_queues_[round_ % 2];
-      if (!to_self_.empty()) {
-        for (auto& iarc : to_self_) {
-          grape::OutArchive oarc(std::move(iarc));
-          rq.Put(std::move(oarc));
-        }
-        to_self_.clear();
-      }
-      rq.DecProducerNum();
+      wait_time_ += grape::GetCurrentTime() - t;
+      // the messages to self of last round are all in the queue
+      recv_queues_[round_ % 2].DecProducerNum();
     }
     sent_size_ = 0;
-    startSendThread();
+    force_continue_ = false;
+    if (!local_) {
+      startSendThread();
+    }
   }
 
   /**
@@ -127,8 +138,17 @@ class ParallelPropertyMessageManager : public grape::MessageManagerBase {
       flag[0] = 0;
     }
     flag[1] = force_terminate_ ? 1 : 0;
+    if (local_) {
+      if (flag[1] > 0) {
+        terminate_info_.success = false;
+        return true;
+      }
+      return (flag[0] == 0);
+    }
     int ret[2];
+    double t = grape::GetCurrentTime();
     MPI_Allreduce(&flag[0], &ret[0], 2, MPI_INT, MPI_SUM, comm_);
+    wait_time_ += grape::GetCurrentTime() - t;
     if (ret[1] > 0) {
       terminate_info_.success = false;
       grape::sync_comm::AllGather(terminate_info_.info, comm_);
@@ -141,9 +161,11 @@ class ParallelPropertyMessageManager : public grape::MessageManagerBase {
    * @brief Inherit
    */
   void Finalize() override {
-    waitSend();
-    MPI_Barrier(comm_);
-    stopRecvThread();
+    if (!local_) {
+      waitSend();
+      MPI_Barrier(comm_);
+      stopRecvThread();
+    }
 
     MPI_Comm_free(&comm_);
     comm_ = NULL_COMM;
@@ -174,6 +196,12 @@ class ParallelPropertyMessageManager : public grape::MessageManagerBase {
    */
   size_t GetMsgSize() const override { return sent_size_; }
 
+  /**
+   * @brief Seconds spent waiting for the sends of the previous round and the
+   * termination check, accumulated since Init.
+   */
+  double GetWaitTime() const { return wait_time_; }
+
   /**
    * @brief Init a set of channels, each channel is a thread local message
    * buffer.
@@ -203,6 +231,13 @@ class ParallelPropertyMessageManager : public grape::MessageManagerBase {
    * @param arc Message buffer.
    */
   inline void SendRawMsgByFid(grape::fid_t fid, grape::InArchive&& arc) {
+    if (fid == fid_) {
+      if (arc.GetSize() != 0) {
+        grape::OutArchive oarc(std::move(arc));
+        recv_queues_[(round_ + 1) % 2].Put(std::move(oarc));
+      }
+      return;
+    }
     std::pair<grape::fid_t, grape::InArchive> item;
     item.first = fid;
     item.second = std::move(arc);
@@ -385,7 +420,6 @@ class ParallelPropertyMessageManager : public grape::MessageManagerBase {
 
  private:
   void startSendThread() {
-    force_continue_ = false;
     int round = round_;
 
     CHECK_EQ(sending_queue_.Size(), 0);
@@ -398,15 +432,14 @@ class ParallelPropertyMessageManager : public grape::MessageManagerBase {
             if (item.second.GetSize() == 0) {
               continue;
             }
-            if (item.first == fid_) {
-              to_self_.emplace_back(std::move(item.second));
-            } else {
-              MPI_Request req;
-              MPI_Isend(item.second.GetBuffer(), item.second.GetSize(),
-                        MPI_CHAR, comm_spec_.FragToWorker(item.first),
-                        msg_round, comm_, &req);
-              reqs.push_back(req);
-              to_others_.emplace_back(std::move(item.second));
+            MPI_Request req;
+            MPI_Isend(item.second.GetBuffer(), item.second.GetSize(), MPI_CHAR,
+                      comm_spec_.FragToWorker(item.first), msg_round, comm_,
+                      &req);
+            reqs.push_back(req);
+            to_others_.emplace_back(std::move(item.second));
+            if (reqs.size() >= pending_send_threshold) {
+              releaseCompletedSends(reqs);
             }
           }
           for (grape::fid_t i = 0; i < fnum_; ++i) {
@@ -424,6 +457,30 @@ class ParallelPropertyMessageManager : public grape::MessageManagerBase {
         round + 1);
   }
 
+  /**
+   * @brief Release the buffers of finished sends while the round is still
+   * filling messages, rather than holding all of them until MPI_Waitall.
+   */
+  void releaseCompletedSends(std::vector<MPI_Request>& reqs) {
+    int count = 0;
+    std::vector<int> indices(reqs.size());
+    MPI_Testsome(reqs.size(), &reqs[0], &count, &indices[0],
+                 MPI_STATUSES_IGNORE);
+    if (count <= 0) {
+      return;
+    }
+    size_t kept = 0;
+    for (size_t i = 0; i < reqs.size(); ++i) {
+      if (reqs[i] != MPI_REQUEST_NULL) {
+        reqs[kept] = reqs[i];
+        to_others_[kept] = std::move(to_others_[i]);
+        ++kept;
+      }
+    }
+    reqs.resize(kept);
+    to_others_.resize(kept);
+  }
+
   void probeAllIncomingMessages() {
     MPI_Status status;
     while (true) {
@@ -465,7 +522,9 @@ class ParallelPropertyMessageManager : public grape::MessageManagerBase {
       ret += channel.SentMsgSize();
       channel.Reset();
     }
-    sending_queue_.DecProducerNum();
+    if (!local_) {
+      sending_queue_.DecProducerNum();
+    }
     return ret;
   }
 
@@ -478,15 +537,19 @@ class ParallelPropertyMessageManager : public grape::MessageManagerBase {
     curr_recv_queue.SetProducerNum(fnum_);
   }
 
-  void waitSend() { send_thread_.join(); }
+  void waitSend() {
+    if (send_thread_.joinable()) {
+      send_thread_.join();
+    }
+  }
 
   grape::fid_t fid_;
   grape::fid_t fnum_;
+  bool local_;
   grape::CommSpec comm_spec_;
 
   MPI_Comm comm_;
 
-  std::vector<grape::InArchive> to_self_;
   std::vector<grape::InArchive> to_others_;
 
   std::vector<ThreadLocalPropertyMessageBuffer<ParallelPropertyMessageManager>>
@@ -502,6 +565,7 @@ class ParallelPropertyMessageManager : public grape::MessageManagerBase {
 
   bool force_continue_;
   size_t sent_size_;
+  double wait_time_;
 
   bool force_terminate_;
   grape::TerminateInfo terminate_info_;
@@ -0,0 +1,102 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANALYTICAL_ENGINE_CORE_PARALLEL_ROUND_REDUCER_H_
+#define ANALYTICAL_ENGINE_CORE_PARALLEL_ROUND_REDUCER_H_
+
+#include <algorithm>
+#include <vector>
+
+namespace gs {
+
+/**
+ * @brief A few values accumulated by the threads of a worker in a round, such
+ * as the delta and the norm of a convergence test, and reduced across
+ * fragments by a single all-reduce.
+ *
+ * Each thread adds to a row of its own, padded to a cache line, so the
+ * threads neither share a lock nor false-share a line. Reducing all the values
+ * at once costs one collective per round instead of one per value.
+ */
+class RoundReducer {
+ public:
+  void Init(int thread_num, size_t value_num) {
+    value_num_ = value_num;
+    stride_ = (value_num + kDoublesPerLine - 1) / kDoublesPerLine *
+              kDoublesPerLine;
+    partials_.assign(std::max(thread_num, 1) * stride_, 0.0);
+    values_.assign(value_num, 0.0);
+  }
+
+  void Add(int tid, size_t index, double value) {
+    partials_[tid * stride_ + index] += value;
+  }
+
+  void Max(int tid, size_t index, double value) {
+    double& partial = partials_[tid * stride_ + index];
+    partial = std::max(partial, value);
+  }
+
+  /**
+   * @brief Sum the values of all threads and fragments, must be called by all
+   * fragments. The partials are cleared for the next round.
+   */
+  template <typename COMM_T>
+  void Sum(COMM_T& comm) {
+    reduce(comm, [](double lhs, double rhs) { return lhs + rhs; }, 0.0);
+  }
+
+  /**
+   * @brief Like Sum, but takes the maximum of the values, which must not be
+   * below the initial value of a partial, i.e., 0.
+   */
+  template <typename COMM_T>
+  void Max(COMM_T& comm) {
+    reduce(
+        comm, [](double lhs, double rhs) { return std::max(lhs, rhs); }, 0.0);
+  }
+
+  double operator[](size_t index) const { return values_[index]; }
+
+ private:
+  static constexpr size_t kDoublesPerLine = 64 / sizeof(double);
+
+  template <typename COMM_T, typename OP_T>
+  void reduce(COMM_T& comm, const OP_T& op, double init) {
+    std::vector<double> local(value_num_, init);
+    for (size_t row = 0; row < partials_.size(); row += stride_) {
+      for (size_t i = 0; i < value_num_; ++i) {
+        local[i] = op(local[i], partials_[row + i]);
+      }
+    }
+    std::fill(partials_.begin(), partials_.end(), init);
+    comm.AllReduce(local, values_,
+                   [&op](std::vector<double>& lhs,
+                         const std::vector<double>& rhs) {
+                     for (size_t i = 0; i < lhs.size(); ++i) {
+                       lhs[i] = op(lhs[i], rhs[i]);
+                     }
+                   });
+  }
+
+  size_t value_num_ = 0;
+  size_t stride_ = 0;
+  std::vector<double> partials_;
+  std::vector<double> values_;
+};
+
+}  // namespace gs
+
+#endif  // ANALYTICAL_ENGINE_CORE_PARALLEL_ROUND_REDUCER_H_
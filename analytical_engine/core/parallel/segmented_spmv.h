@@ -0,0 +1,235 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANALYTICAL_ENGINE_CORE_PARALLEL_SEGMENTED_SPMV_H_
+#define ANALYTICAL_ENGINE_CORE_PARALLEL_SEGMENTED_SPMV_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "grape/grape.h"
+#include "vineyard/graph/fragment/property_graph_utils.h"
+
+namespace gs {
+
+enum class SpMVDirection {
+  kIncoming,
+  kOutgoing,
+};
+
+/**
+ * @brief The sparse matrix-vector product of the adjacency of the inner
+ * vertices of a fragment, i.e. y[v] = sum of w(e) * x[u] over the edges e
+ * between v and its neighbors u, shared by the iterative apps.
+ *
+ * The columns, i.e. all vertices of the fragment, are split into segments
+ * of kSegmentColumns, whose values fit in the L2 cache, and the edges of
+ * each segment are kept in a CSR of their own, with the columns relative to
+ * the segment. The product is taken segment by segment, so the random reads
+ * of x hit the cache instead of the memory. The rows of a segment are split
+ * into chunks of about the same number of edges, claimed by the threads.
+ *
+ * It is built once from the adjacency lists, and reused by every round.
+ */
+template <typename FRAG_T>
+class SegmentedSpMV {
+  using vertex_t = typename FRAG_T::vertex_t;
+  using vid_t = typename FRAG_T::vid_t;
+  using edata_t = typename FRAG_T::edata_t;
+
+ public:
+  static constexpr size_t kSegmentShift = 16;
+  static constexpr size_t kSegmentColumns = size_t(1) << kSegmentShift;
+
+  /**
+   * @brief Build from the incoming or outgoing edges of the inner vertices,
+   * weighted by their data if weighted, which is ignored by fragments
+   * without edge data.
+   */
+  void Init(const FRAG_T& frag, SpMVDirection direction, bool weighted,
+            int thread_num) {
+    auto inner_vertices = frag.InnerVertices();
+    vertices_ = frag.Vertices();
+    columns_.Init(vertices_);
+    size_t column_num = 0;
+    for (auto v : vertices_) {
+      columns_[v] = column_num++;
+    }
+    x_.resize(column_num);
+    y_.resize(inner_vertices.size());
+    row_begin_ = inner_vertices.begin_value();
+    weighted_ = weighted && !std::is_same<edata_t, grape::EmptyType>::value;
+    direction_ = direction;
+
+    size_t segment_num =
+        std::max<size_t>((column_num + kSegmentColumns - 1) >> kSegmentShift,
+                         1);
+    segments_.clear();
+    segments_.resize(segment_num);
+    for (auto v : inner_vertices) {
+      for (auto& e : adjList(frag, v)) {
+        ++segments_[columns_[e.get_neighbor()] >> kSegmentShift].edge_num;
+      }
+    }
+    for (auto& segment : segments_) {
+      segment.columns.reserve(segment.edge_num);
+      if (weighted_) {
+        segment.weights.reserve(segment.edge_num);
+      }
+      segment.offsets.push_back(0);
+    }
+    size_t row = 0;
+    for (auto v : inner_vertices) {
+      for (auto& e : adjList(frag, v)) {
+        size_t column = columns_[e.get_neighbor()];
+        auto& segment = segments_[column >> kSegmentShift];
+        if (segment.rows.empty() || segment.rows.back() != row) {
+          if (!segment.rows.empty()) {
+            segment.offsets.push_back(segment.columns.size());
+          }
+          segment.rows.push_back(row);
+        }
+        segment.columns.push_back(
+            static_cast<uint32_t>(column & (kSegmentColumns - 1)));
+        if (weighted_) {
+          double data = 1.0;
+          vineyard::static_if<!std::is_same<edata_t, grape::EmptyType>{}>(
+              [&](auto& e, auto& data) {
+                data = static_cast<double>(e.get_data());
+              })(e, data);
+          segment.weights.push_back(data);
+        }
+      }
+      ++row;
+    }
+    for (auto& segment : segments_) {
+      if (!segment.rows.empty()) {
+        segment.offsets.push_back(segment.columns.size());
+      }
+      segment.SplitChunks(thread_num);
+    }
+  }
+
+  /**
+   * @brief Call func(tid, v, y) for each inner vertex v, where y is the
+   * product at v of the matrix and x, an array over all vertices.
+   */
+  template <typename ENGINE_T, typename ARRAY_T, typename FUNC_T>
+  void Multiply(ENGINE_T& engine, const ARRAY_T& x, const FUNC_T& func) {
+    engine.ForEach(vertices_, [this, &x](int tid, vertex_t v) {
+      x_[columns_[v]] = x[v];
+    });
+    std::fill(y_.begin(), y_.end(), 0.0);
+
+    for (size_t s = 0; s < segments_.size(); ++s) {
+      const auto& segment = segments_[s];
+      const double* xs = x_.data() + (s << kSegmentShift);
+      engine.ForEach(
+          segment.chunks.begin(), segment.chunks.end(),
+          [this, &segment, xs](int tid, const std::pair<size_t, size_t>& c) {
+            if (weighted_) {
+              multiplyRows<true>(segment, xs, c.first, c.second);
+            } else {
+              multiplyRows<false>(segment, xs, c.first, c.second);
+            }
+          },
+          1);
+    }
+
+    engine.ForEach(rowRange(), [this, &func](int tid, vertex_t v) {
+      func(tid, v, y_[v.GetValue() - row_begin_]);
+    });
+  }
+
+ private:
+  struct Segment {
+    static constexpr size_t kChunksPerThread = 8;
+
+    // rows with edges in the segment, ascending
+    std::vector<size_t> rows;
+    std::vector<size_t> offsets;
+    std::vector<uint32_t> columns;
+    std::vector<double> weights;
+    size_t edge_num = 0;
+    // ranges of rows, by their positions in rows
+    std::vector<std::pair<size_t, size_t>> chunks;
+
+    void SplitChunks(int thread_num) {
+      chunks.clear();
+      size_t target = std::max<size_t>(
+          edge_num / (std::max(thread_num, 1) * kChunksPerThread), 1);
+      size_t begin = 0;
+      for (size_t i = 0; i < rows.size(); ++i) {
+        if (offsets[i + 1] - offsets[begin] >= target) {
+          chunks.emplace_back(begin, i + 1);
+          begin = i + 1;
+        }
+      }
+      if (begin < rows.size()) {
+        chunks.emplace_back(begin, rows.size());
+      }
+    }
+  };
+
+  decltype(auto) adjList(const FRAG_T& frag, vertex_t v) const {
+    return direction_ == SpMVDirection::kIncoming
+               ? frag.GetIncomingAdjList(v)
+               : frag.GetOutgoingAdjList(v);
+  }
+
+  grape::VertexRange<vid_t> rowRange() {
+    return grape::VertexRange<vid_t>(row_begin_, row_begin_ + y_.size());
+  }
+
+  // four independent sums, so the adds of the gathered values are not
+  // serialized on a single register and are vectorized
+  template <bool WEIGHTED>
+  void multiplyRows(const Segment& segment, const double* xs, size_t from,
+                    size_t to) {
+    const uint32_t* columns = segment.columns.data();
+    const double* weights = segment.weights.data();
+    for (size_t i = from; i < to; ++i) {
+      size_t k = segment.offsets[i], end = segment.offsets[i + 1];
+      double sum[4] = {0.0, 0.0, 0.0, 0.0};
+      for (; k + 4 <= end; k += 4) {
+        for (int j = 0; j < 4; ++j) {
+          sum[j] += WEIGHTED ? weights[k + j] * xs[columns[k + j]]
+                             : xs[columns[k + j]];
+        }
+      }
+      for (; k < end; ++k) {
+        sum[0] += WEIGHTED ? weights[k] * xs[columns[k]] : xs[columns[k]];
+      }
+      // a row is in a single chunk of the segment
+      y_[segment.rows[i]] += (sum[0] + sum[1]) + (sum[2] + sum[3]);
+    }
+  }
+
+  std::decay_t<decltype(std::declval<const FRAG_T&>().Vertices())> vertices_;
+  typename FRAG_T::template vertex_array_t<size_t> columns_;
+  std::vector<Segment> segments_;
+  std::vector<double> x_;
+  std::vector<double> y_;
+  vid_t row_begin_ = 0;
+  bool weighted_ = false;
+  SpMVDirection direction_ = SpMVDirection::kIncoming;
+};
+
+}  // namespace gs
+
+#endif  // ANALYTICAL_ENGINE_CORE_PARALLEL_SEGMENTED_SPMV_H_
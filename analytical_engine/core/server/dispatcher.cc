@@ -18,10 +18,13 @@
 #include <glog/logging.h>
 #include <mpi.h>
 
+#include <deque>
 #include <exception>
 #include <ostream>
+#include <string>
 #include <thread>
 #include <utility>
+#include <vector>
 
 #include "boost/leaf/capture.hpp"
 #include "boost/leaf/handle_errors.hpp"
@@ -44,6 +47,113 @@ namespace bl = boost::leaf;
 
 namespace gs {
 
+// The chunk buffers of a large attr, e.g., the edges of a modifyEdges or the
+// tables of a create_graph, are moved out of the command and sent apart from
+// it, in pieces and with non-blocking calls. Otherwise a multi-GB payload is
+// copied into the archive of the command on both ends, and sent as a single
+// message that a worker can't start to receive before it is fully packed.
+static constexpr int kChunkBufferTag = 1;
+static constexpr size_t kPieceSize = size_t(64) << 20;
+// the broadcasts in flight, the next piece is sent along the tree while the
+// last one is still on its way
+static constexpr size_t kMaxInflightPieces = 8;
+
+static int pieceAt(size_t size, size_t offset) {
+  return static_cast<int>(size - offset < kPieceSize ? size - offset
+                                                     : kPieceSize);
+}
+
+static std::vector<std::string> detachChunkBuffers(
+    rpc::LargeAttrValue& large_attr) {
+  std::vector<std::string> buffers;
+  if (large_attr.has_chunk_list()) {
+    auto* chunk_list = large_attr.mutable_chunk_list();
+    buffers.resize(chunk_list->items_size());
+    for (int i = 0; i < chunk_list->items_size(); ++i) {
+      chunk_list->mutable_items(i)->mutable_buffer()->swap(buffers[i]);
+    }
+  }
+  return buffers;
+}
+
+static void attachChunkBuffers(rpc::LargeAttrValue& large_attr,
+                               std::vector<std::string>& buffers) {
+  if (large_attr.has_chunk_list()) {
+    auto* chunk_list = large_attr.mutable_chunk_list();
+    CHECK_EQ(static_cast<size_t>(chunk_list->items_size()), buffers.size());
+    for (int i = 0; i < chunk_list->items_size(); ++i) {
+      chunk_list->mutable_items(i)->mutable_buffer()->swap(buffers[i]);
+    }
+  }
+}
+
+static std::vector<size_t> chunkBufferSizes(
+    const std::vector<std::string>& buffers) {
+  std::vector<size_t> sizes;
+  for (auto& buffer : buffers) {
+    sizes.push_back(buffer.size());
+  }
+  return sizes;
+}
+
+static void sendChunkBuffers(const std::vector<std::string>& buffers,
+                             int dst_worker_id,
+                             std::vector<MPI_Request>& requests) {
+  grape::sync_comm::Send(chunkBufferSizes(buffers), dst_worker_id,
+                         kChunkBufferTag, MPI_COMM_WORLD);
+  for (auto& buffer : buffers) {
+    for (size_t offset = 0; offset < buffer.size(); offset += kPieceSize) {
+      requests.emplace_back();
+      MPI_Isend(buffer.data() + offset, pieceAt(buffer.size(), offset),
+                MPI_CHAR, dst_worker_id, kChunkBufferTag, MPI_COMM_WORLD,
+                &requests.back());
+    }
+  }
+}
+
+static std::vector<std::string> recvChunkBuffers() {
+  std::vector<size_t> sizes;
+  grape::sync_comm::Recv(sizes, grape::kCoordinatorRank, kChunkBufferTag,
+                         MPI_COMM_WORLD);
+  std::vector<std::string> buffers(sizes.size());
+  std::vector<MPI_Request> requests;
+  for (size_t i = 0; i < sizes.size(); ++i) {
+    buffers[i].resize(sizes[i]);
+    for (size_t offset = 0; offset < sizes[i]; offset += kPieceSize) {
+      requests.emplace_back();
+      MPI_Irecv(&buffers[i][offset], pieceAt(sizes[i], offset), MPI_CHAR,
+                grape::kCoordinatorRank, kChunkBufferTag, MPI_COMM_WORLD,
+                &requests.back());
+    }
+  }
+  MPI_Waitall(static_cast<int>(requests.size()), requests.data(),
+              MPI_STATUSES_IGNORE);
+  return buffers;
+}
+
+// the buffers of the coordinator are broadcast to all the other workers
+static void bcastChunkBuffers(std::vector<std::string>& buffers) {
+  std::vector<size_t> sizes = chunkBufferSizes(buffers);
+  grape::sync_comm::Bcast(sizes, grape::kCoordinatorRank, MPI_COMM_WORLD);
+  buffers.resize(sizes.size());
+  std::deque<MPI_Request> requests;
+  for (size_t i = 0; i < sizes.size(); ++i) {
+    buffers[i].resize(sizes[i]);
+    for (size_t offset = 0; offset < sizes[i]; offset += kPieceSize) {
+      if (requests.size() == kMaxInflightPieces) {
+        MPI_Wait(&requests.front(), MPI_STATUS_IGNORE);
+        requests.pop_front();
+      }
+      requests.emplace_back();
+      MPI_Ibcast(&buffers[i][offset], pieceAt(sizes[i], offset), MPI_CHAR,
+                 grape::kCoordinatorRank, MPI_COMM_WORLD, &requests.back());
+    }
+  }
+  for (auto& request : requests) {
+    MPI_Wait(&request, MPI_STATUS_IGNORE);
+  }
+}
+
 Dispatcher::Dispatcher(const grape::CommSpec& comm_spec)
     : running_(false), comm_spec_(comm_spec) {
   // a naive implementation using MPI
@@ -162,16 +272,28 @@ void Dispatcher::publisherPreprocessCmd(std::shared_ptr<CommandDetail> cmd) {
     // Distribute raw bytes if there are some data from pandas
     auto params_vec = DistributeGraph(cmd->large_attr, comm_spec_.worker_num());
     CHECK_EQ(static_cast<int>(params_vec.size()), comm_spec_.worker_num());
+    // the slices of all workers are sent at the same time, and stay in
+    // params_vec until the sends are done
+    std::vector<std::vector<std::string>> buffers(comm_spec_.worker_num());
+    std::vector<MPI_Request> requests;
     for (int i = 1; i < comm_spec_.worker_num(); ++i) {
+      buffers[i] = detachChunkBuffers(params_vec[i]);
+      cmd->large_attr.Swap(&params_vec[i]);
       grape::InArchive ia;
-      cmd->large_attr = params_vec[i];
       ia << *(cmd.get());
       grape::sync_comm::Send(ia, i, 0, MPI_COMM_WORLD);
+      cmd->large_attr.Swap(&params_vec[i]);
+      sendChunkBuffers(buffers[i], i, requests);
     }
-    cmd->large_attr = params_vec[0];
+    cmd->large_attr.Swap(&params_vec[0]);
+    MPI_Waitall(static_cast<int>(requests.size()), requests.data(),
+                MPI_STATUSES_IGNORE);
   } else {
+    auto buffers = detachChunkBuffers(cmd->large_attr);
     grape::sync_comm::Bcast(*(cmd.get()), grape::kCoordinatorRank,
                             MPI_COMM_WORLD);
+    bcastChunkBuffers(buffers);
+    attachChunkBuffers(cmd->large_attr, buffers);
   }
 }
 
@@ -181,9 +303,14 @@ void Dispatcher::subscriberPreprocessCmd(rpc::OperationType type,
     grape::OutArchive oa;
     grape::sync_comm::Recv(oa, grape::kCoordinatorRank, 0, MPI_COMM_WORLD);
     oa >> *(cmd.get());
+    auto buffers = recvChunkBuffers();
+    attachChunkBuffers(cmd->large_attr, buffers);
   } else {
     grape::sync_comm::Bcast(*(cmd.get()), grape::kCoordinatorRank,
                             MPI_COMM_WORLD);
+    std::vector<std::string> buffers;
+    bcastChunkBuffers(buffers);
+    attachChunkBuffers(cmd->large_attr, buffers);
   }
 }
 
@@ -23,6 +23,7 @@
 #include <memory>
 #include <string>
 #include <thread>
+#include <utility>
 #include <vector>
 
 #include "vineyard/graph/fragment/arrow_fragment.h"
@@ -164,6 +165,120 @@ struct PropertyConverter {
   }
 };
 
+/**
+ * @brief Converts the rows of a property table to dynamic::Value. The columns
+ * are resolved once rather than per row, so that converting a row touches the
+ * typed buffers only.
+ */
+class PropertyTableConverter {
+ public:
+  PropertyTableConverter() = default;
+
+  /**
+   * @brief Resolve the first num_columns columns of table, all of them if
+   * num_columns is negative.
+   */
+  explicit PropertyTableConverter(const std::shared_ptr<arrow::Table>& table,
+                                  int num_columns = -1)
+      : table_(table) {
+    if (table == nullptr) {
+      return;
+    }
+    if (num_columns < 0 || num_columns > table->num_columns()) {
+      num_columns = table->num_columns();
+    }
+    for (int col_id = 0; col_id < num_columns; ++col_id) {
+      auto column = table->column(col_id);
+      if (column->num_chunks() == 0) {
+        continue;
+      }
+      columns_.push_back(Column{table->field(col_id)->name(),
+                                column->type()->id(), column->chunk(0).get()});
+    }
+  }
+
+  /**
+   * @brief Add the properties of row to the object ret.
+   */
+  void RowValue(int64_t row, rapidjson::Value& ret,
+                dynamic::AllocatorT& allocator) const {
+    for (auto& column : columns_) {
+      switch (column.type) {
+      case arrow::Type::type::INT32:
+        addMember(column, valueOf<arrow::Int32Array>(column, row), ret,
+                  allocator);
+        break;
+      case arrow::Type::type::INT64:
+        addMember(column, valueOf<arrow::Int64Array>(column, row), ret,
+                  allocator);
+        break;
+      case arrow::Type::type::UINT32:
+        addMember(column, valueOf<arrow::UInt32Array>(column, row), ret,
+                  allocator);
+        break;
+      case arrow::Type::type::UINT64:
+        addMember(column, valueOf<arrow::UInt64Array>(column, row), ret,
+                  allocator);
+        break;
+      case arrow::Type::type::FLOAT:
+        addMember(column, valueOf<arrow::FloatArray>(column, row), ret,
+                  allocator);
+        break;
+      case arrow::Type::type::DOUBLE:
+        addMember(column, valueOf<arrow::DoubleArray>(column, row), ret,
+                  allocator);
+        break;
+      case arrow::Type::type::STRING:
+        addString(column, valueOf<arrow::StringArray>(column, row), ret,
+                  allocator);
+        break;
+      case arrow::Type::type::LARGE_STRING:
+        addString(column, valueOf<arrow::LargeStringArray>(column, row), ret,
+                  allocator);
+        break;
+      default:
+        // unsupported types in dynamic, ignore
+        break;
+      }
+    }
+  }
+
+ private:
+  struct Column {
+    std::string name;
+    arrow::Type::type type;
+    const arrow::Array* array;
+  };
+
+  template <typename ARRAY_T>
+  static auto valueOf(const Column& column, int64_t row)
+      -> decltype(std::declval<const ARRAY_T&>().GetView(row)) {
+    return static_cast<const ARRAY_T*>(column.array)->GetView(row);
+  }
+
+  template <typename T>
+  static void addMember(const Column& column, T value, rapidjson::Value& ret,
+                        dynamic::AllocatorT& allocator) {
+    rapidjson::Value v(value);
+    ret.AddMember(rapidjson::Value(column.name, allocator).Move(), v,
+                  allocator);
+  }
+
+  template <typename VIEW_T>
+  static void addString(const Column& column, const VIEW_T& value,
+                        rapidjson::Value& ret, dynamic::AllocatorT& allocator) {
+    rapidjson::Value v(value.data(),
+                       static_cast<rapidjson::SizeType>(value.size()),
+                       allocator);
+    ret.AddMember(rapidjson::Value(column.name, allocator).Move(), v,
+                  allocator);
+  }
+
+  // holds the buffers of columns
+  std::shared_ptr<arrow::Table> table_;
+  std::vector<Column> columns_;
+};
+
 template <typename ITER_T, typename FUNC_T>
 void parallel_for(const ITER_T& begin, const ITER_T& end, const FUNC_T& func,
                   uint32_t thread_num, size_t chunk = 1024) {
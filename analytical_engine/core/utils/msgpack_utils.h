@@ -18,6 +18,8 @@
 
 #ifdef NETWORKX
 
+#include <string>
+
 #include "msgpack.hpp"  // IWYU pragma: export
 
 #include "grape/serialization/in_archive.h"
@@ -151,11 +153,93 @@ struct pack<gs::dynamic::Value> {
     }
   }
 };
+
+// Deserialize bytes packed by msgpack to rapidjson::Value, the strings are
+// copied with the allocator of dynamic::Value.
+template <>
+struct convert<rapidjson::Value> {
+  msgpack::object const& operator()(msgpack::object const& o,
+                                    rapidjson::Value& v) const {
+    auto& allocator = gs::dynamic::Value::allocator_;
+    switch (o.type) {
+    case msgpack::type::NIL:
+      v.SetNull();
+      break;
+    case msgpack::type::BOOLEAN:
+      v.SetBool(o.via.boolean);
+      break;
+    case msgpack::type::POSITIVE_INTEGER:
+      v.SetUint64(o.via.u64);
+      break;
+    case msgpack::type::NEGATIVE_INTEGER:
+      v.SetInt64(o.via.i64);
+      break;
+    case msgpack::type::FLOAT32:
+    case msgpack::type::FLOAT64:
+      v.SetDouble(o.via.f64);
+      break;
+    case msgpack::type::STR:
+      v.SetString(o.via.str.ptr, o.via.str.size, allocator);
+      break;
+    case msgpack::type::BIN:
+      v.SetString(o.via.bin.ptr, o.via.bin.size, allocator);
+      break;
+    case msgpack::type::ARRAY: {
+      v.SetArray();
+      v.Reserve(o.via.array.size, allocator);
+      for (uint32_t i = 0; i < o.via.array.size; ++i) {
+        rapidjson::Value element;
+        o.via.array.ptr[i].convert(element);
+        v.PushBack(element, allocator);
+      }
+      break;
+    }
+    case msgpack::type::MAP: {
+      v.SetObject();
+      for (uint32_t i = 0; i < o.via.map.size; ++i) {
+        const msgpack::object_kv& kv = o.via.map.ptr[i];
+        if (kv.key.type != msgpack::type::STR) {
+          throw msgpack::type_error();
+        }
+        rapidjson::Value name(kv.key.via.str.ptr, kv.key.via.str.size,
+                              allocator);
+        rapidjson::Value value;
+        kv.val.convert(value);
+        v.AddMember(name, value, allocator);
+      }
+      break;
+    }
+    default:
+      throw msgpack::type_error();
+    }
+    return o;
+  }
+};
+
+template <>
+struct convert<gs::dynamic::Value> {
+  msgpack::object const& operator()(msgpack::object const& o,
+                                    gs::dynamic::Value& v) const {
+    return convert<rapidjson::Value>()(o, static_cast<rapidjson::Value&>(v));
+  }
+};
 }  // namespace adaptor
 }  // MSGPACK_API_VERSION_NAMESPACE
 
 }  // namespace msgpack
 // clang-format on
 
+namespace gs {
+namespace dynamic {
+
+// Parse bytes packed by msgpack to Value, the counterpart of Parse for json.
+static inline void ParseMsgpack(const std::string& buf, rapidjson::Value& val) {
+  msgpack::object_handle handle = msgpack::unpack(buf.data(), buf.size());
+  handle.get().convert(val);
+}
+
+}  // namespace dynamic
+}  // namespace gs
+
 #endif  // NETWORKX
 #endif  // ANALYTICAL_ENGINE_CORE_UTILS_MSGPACK_UTILS_H_
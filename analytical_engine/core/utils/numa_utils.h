@@ -0,0 +1,115 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANALYTICAL_ENGINE_CORE_UTILS_NUMA_UTILS_H_
+#define ANALYTICAL_ENGINE_CORE_UTILS_NUMA_UTILS_H_
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <climits>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "glog/logging.h"
+
+namespace gs {
+
+namespace numa_utils_impl {
+
+// from <numaif.h>, to not depend on libnuma
+static constexpr int kMpolInterleave = 3;
+
+/**
+ * @brief The NUMA nodes in a list like "0-1,3" of
+ * /sys/devices/system/node/online, as a mask of maxnode bits.
+ */
+inline std::vector<unsigned long> parse_node_mask(const std::string& list,
+                                                  size_t& maxnode) {
+  constexpr size_t kBits = sizeof(unsigned long) * CHAR_BIT;
+  std::vector<unsigned long> mask;
+  std::stringstream ss(list);
+  std::string range;
+  while (std::getline(ss, range, ',')) {
+    if (range.empty()) {
+      continue;
+    }
+    size_t dash = range.find('-');
+    size_t first = std::stoul(range.substr(0, dash));
+    size_t last =
+        dash == std::string::npos ? first : std::stoul(range.substr(dash + 1));
+    for (size_t node = first; node <= last; ++node) {
+      if (mask.size() <= node / kBits) {
+        mask.resize(node / kBits + 1, 0);
+      }
+      mask[node / kBits] |= 1UL << (node % kBits);
+    }
+  }
+  maxnode = mask.size() * kBits;
+  return mask;
+}
+
+}  // namespace numa_utils_impl
+
+/**
+ * @brief Interleave the pages allocated by this process from now on across
+ * all online NUMA nodes.
+ *
+ * The per-vertex arrays of fragments and contexts are filled by a single
+ * thread, so by default all their pages land on the node of that thread, and
+ * the threads on the other sockets read remote memory in every round.
+ * Interleaving spreads the pages, and with them the bandwidth, over all the
+ * nodes. It is a no-op on a machine with a single node. It only pays off when
+ * a worker runs threads on more than one socket; a worker bound to a single
+ * socket is better served by the default local allocation.
+ *
+ * @return Whether the policy is in effect.
+ */
+inline bool InterleaveMemoryAcrossNodes() {
+#if defined(__linux__) && defined(SYS_set_mempolicy)
+  std::ifstream ifs("/sys/devices/system/node/online");
+  std::string list;
+  if (!ifs || !std::getline(ifs, list)) {
+    return false;
+  }
+  size_t maxnode = 0;
+  auto mask = numa_utils_impl::parse_node_mask(list, maxnode);
+  size_t node_num = 0;
+  for (auto word : mask) {
+    node_num += __builtin_popcountl(word);
+  }
+  if (node_num <= 1) {
+    return false;
+  }
+  // the kernel ignores the last bit of maxnode
+  if (syscall(SYS_set_mempolicy, numa_utils_impl::kMpolInterleave,
+              mask.data(), maxnode + 1) != 0) {
+    PLOG(WARNING) << "Failed to interleave memory across NUMA nodes " << list;
+    return false;
+  }
+  LOG(INFO) << "Interleaving memory across NUMA nodes " << list;
+  return true;
+#else
+  return false;
+#endif
+}
+
+}  // namespace gs
+
+#endif  // ANALYTICAL_ENGINE_CORE_UTILS_NUMA_UTILS_H_
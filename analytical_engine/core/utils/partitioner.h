@@ -22,6 +22,7 @@
 #include <functional>
 #include <memory>
 #include <string>
+#include <unordered_map>
 
 #include "core/config.h"
 #include "core/object/dynamic.h"
@@ -32,6 +33,11 @@ template <typename OID_T>
 class HashPartitioner;
 
 #if defined(NETWORKX)
+/**
+ * @brief The partitioner of dynamic fragments, which hashes a vertex unless
+ * it is placed to a fragment by SetPartitionId, e.g., by a locality-aware
+ * placement of new vertices.
+ */
 template <>
 class HashPartitioner<::gs::dynamic::Value> {
  public:
@@ -41,6 +47,12 @@ class HashPartitioner<::gs::dynamic::Value> {
   explicit HashPartitioner(size_t frag_num) : fnum_(frag_num) {}
 
   inline fid_t GetPartitionId(const oid_t& oid) const {
+    if (!placements_.empty()) {
+      auto iter = placements_.find(oid);
+      if (iter != placements_.end()) {
+        return iter->second;
+      }
+    }
     size_t hash_value;
     if (oid.IsArray() && oid.Size() == 2 && oid[0].IsString() &&
         (oid[1].IsInt64() || oid[1].IsString())) {
@@ -53,8 +65,13 @@ class HashPartitioner<::gs::dynamic::Value> {
     return static_cast<fid_t>(static_cast<uint64_t>(hash_value) % fnum_);
   }
 
+  /**
+   * @brief Place oid to fid, which takes effect for the vertices added later
+   * only.
+   */
   void SetPartitionId(const oid_t& oid, fid_t fid) {
-    LOG(FATAL) << "not support";
+    CHECK_LT(fid, fnum_);
+    placements_[oid] = fid;
   }
 
   HashPartitioner& operator=(const HashPartitioner& other) {
@@ -62,6 +79,7 @@ class HashPartitioner<::gs::dynamic::Value> {
       return *this;
     }
     fnum_ = other.fnum_;
+    placements_ = other.placements_;
     return *this;
   }
 
@@ -70,21 +88,46 @@ class HashPartitioner<::gs::dynamic::Value> {
       return *this;
     }
     fnum_ = other.fnum_;
+    placements_ = std::move(other.placements_);
     return *this;
   }
 
   template <typename IOADAPTOR_T>
   void serialize(std::unique_ptr<IOADAPTOR_T>& writer) {
     CHECK(writer->Write(&fnum_, sizeof(fid_t)));
+    size_t size = placements_.size();
+    CHECK(writer->Write(&size, sizeof(size_t)));
+    for (auto& pair : placements_) {
+      std::string json = ::gs::dynamic::Stringify(pair.first);
+      size_t length = json.size();
+      CHECK(writer->Write(&length, sizeof(size_t)));
+      CHECK(writer->Write(const_cast<char*>(json.data()), length));
+      CHECK(writer->Write(const_cast<fid_t*>(&pair.second), sizeof(fid_t)));
+    }
   }
 
   template <typename IOADAPTOR_T>
   void deserialize(std::unique_ptr<IOADAPTOR_T>& reader) {
     CHECK(reader->Read(&fnum_, sizeof(fid_t)));
+    size_t size = 0;
+    CHECK(reader->Read(&size, sizeof(size_t)));
+    placements_.clear();
+    for (size_t i = 0; i < size; ++i) {
+      size_t length = 0;
+      CHECK(reader->Read(&length, sizeof(size_t)));
+      std::string json(length, '\0');
+      CHECK(reader->Read(&json[0], length));
+      oid_t oid;
+      ::gs::dynamic::Parse(json, oid);
+      fid_t fid;
+      CHECK(reader->Read(&fid, sizeof(fid_t)));
+      placements_.emplace(std::move(oid), fid);
+    }
   }
 
  private:
   fid_t fnum_;
+  std::unordered_map<oid_t, fid_t> placements_;
 };
 #endif  // NETWORKX
 
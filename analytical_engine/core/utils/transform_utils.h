@@ -16,9 +16,13 @@ limitations under the License.
 #ifndef ANALYTICAL_ENGINE_CORE_UTILS_TRANSFORM_UTILS_H_
 #define ANALYTICAL_ENGINE_CORE_UTILS_TRANSFORM_UTILS_H_
 
+#include <algorithm>
+#include <cstring>
 #include <fstream>
 #include <memory>
 #include <string>
+#include <thread>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -140,6 +144,83 @@ typename std::enable_if<is_dynamic<OID_T>::value, OID_T>::type string_to_oid(
 }
 #endif
 
+namespace transform_utils_impl {
+
+constexpr size_t kParallelThreshold = 1 << 16;
+
+// the number of blocks parallel_for splits n items into
+inline size_t block_num(size_t n) {
+  if (n < kParallelThreshold) {
+    return 1;
+  }
+  return std::max(std::thread::hardware_concurrency(), 1u);
+}
+
+/**
+ * @brief Call func(block, begin, end) for each of the block_num(n) blocks
+ * covering [0, n), each on a thread of its own, or on the caller when there is
+ * a single block.
+ */
+template <typename FUNC_T>
+void parallel_for(size_t n, const FUNC_T& func) {
+  size_t blocks = block_num(n);
+  if (blocks == 1) {
+    func(0, 0, n);
+    return;
+  }
+  size_t chunk = (n + blocks - 1) / blocks;
+  std::vector<std::thread> threads;
+  for (size_t block = 0; block < blocks; ++block) {
+    size_t begin = std::min(n, block * chunk);
+    size_t end = std::min(n, begin + chunk);
+    threads.emplace_back([&func, block, begin, end]() {
+      func(block, begin, end);
+    });
+  }
+  for (auto& thrd : threads) {
+    thrd.join();
+  }
+}
+
+/**
+ * @brief The vertices of iv satisfying pred, in order. Each block of iv is
+ * filtered by a thread into a list of its own, and the lists are
+ * concatenated.
+ */
+template <typename FRAG_T, typename PRED_T>
+std::vector<typename FRAG_T::vertex_t> select_vertices(
+    const typename FRAG_T::vertex_range_t& iv, const PRED_T& pred) {
+  using vertex_t = typename FRAG_T::vertex_t;
+  size_t n = iv.size();
+  auto first = iv.begin_value();
+  std::vector<std::vector<vertex_t>> selected(block_num(n));
+  parallel_for(n, [&](size_t block, size_t begin, size_t end) {
+    auto& local = selected[block];
+    for (size_t i = begin; i < end; ++i) {
+      vertex_t v(first + i);
+      if (pred(v)) {
+        local.push_back(v);
+      }
+    }
+  });
+  if (selected.size() == 1) {
+    return std::move(selected[0]);
+  }
+  size_t total = 0;
+  for (auto& local : selected) {
+    total += local.size();
+  }
+  std::vector<vertex_t> vertices;
+  vertices.reserve(total);
+  for (auto& local : selected) {
+    vertices.insert(vertices.end(), local.begin(), local.end());
+    std::vector<vertex_t>().swap(local);
+  }
+  return vertices;
+}
+
+}  // namespace transform_utils_impl
+
 template <typename FRAG_T>
 typename std::enable_if<!oid_is_dynamic<FRAG_T>::value,
                         typename std::vector<typename FRAG_T::vertex_t>>::type
@@ -148,40 +229,35 @@ select_vertices_impl(const FRAG_T& frag,
                      const std::pair<std::string, std::string>& range) {
   using vertex_t = typename FRAG_T::vertex_t;
   using oid_t = typename FRAG_T::oid_t;
+  using transform_utils_impl::select_vertices;
 
-  std::vector<vertex_t> vertices;
   auto& begin = range.first;
   auto& end = range.second;
 
   if (begin.empty() && end.empty()) {
-    for (auto& v : iv) {
-      vertices.emplace_back(v);
-    }
+    std::vector<vertex_t> vertices(iv.size());
+    transform_utils_impl::parallel_for(
+        iv.size(), [&](size_t block, size_t from, size_t to) {
+          for (size_t i = from; i < to; ++i) {
+            vertices[i] = vertex_t(iv.begin_value() + i);
+          }
+        });
+    return vertices;
   } else if (begin.empty() && !end.empty()) {
     oid_t end_id = string_to_oid<oid_t>(end);
-    for (auto& v : iv) {
-      if (frag.GetId(v) < end_id) {
-        vertices.emplace_back(v);
-      }
-    }
+    return select_vertices<FRAG_T>(
+        iv, [&](vertex_t v) { return frag.GetId(v) < end_id; });
   } else if (!begin.empty() && end.empty()) {
     oid_t begin_id = string_to_oid<oid_t>(begin);
-    for (auto& v : iv) {
-      if (frag.GetId(v) >= begin_id) {
-        vertices.emplace_back(v);
-      }
-    }
-  } else if (!begin.empty() && !end.empty()) {
-    oid_t begin_id = string_to_oid<oid_t>(begin);
-    oid_t end_id = string_to_oid<oid_t>(end);
-    for (auto& v : iv) {
-      oid_t id = frag.GetId(v);
-      if (id >= begin_id && id < end_id) {
-        vertices.emplace_back(v);
-      }
-    }
+    return select_vertices<FRAG_T>(
+        iv, [&](vertex_t v) { return frag.GetId(v) >= begin_id; });
   }
-  return vertices;
+  oid_t begin_id = string_to_oid<oid_t>(begin);
+  oid_t end_id = string_to_oid<oid_t>(end);
+  return select_vertices<FRAG_T>(iv, [&](vertex_t v) {
+    oid_t id = frag.GetId(v);
+    return id >= begin_id && id < end_id;
+  });
 }
 
 template <typename FRAG_T>
@@ -192,42 +268,91 @@ select_vertices_impl(const FRAG_T& frag,
                      const std::pair<std::string, std::string>& range) {
   using vertex_t = typename FRAG_T::vertex_t;
   using oid_t = typename FRAG_T::oid_t;
+  using transform_utils_impl::select_vertices;
 
-  std::vector<vertex_t> vertices;
   auto& begin = range.first;
   auto& end = range.second;
 
   if (begin.empty() && end.empty()) {
-    for (auto& v : iv) {
-      if (frag.IsAliveInnerVertex(v)) {
-        vertices.emplace_back(v);
-      }
-    }
+    return select_vertices<FRAG_T>(
+        iv, [&](vertex_t v) { return frag.IsAliveInnerVertex(v); });
   } else if (begin.empty() && !end.empty()) {
     oid_t end_id = string_to_oid<oid_t>(end);
-    for (auto& v : iv) {
-      if (frag.GetId(v) < end_id && frag.IsAliveInnerVertex(v)) {
-        vertices.emplace_back(v);
-      }
-    }
+    return select_vertices<FRAG_T>(iv, [&](vertex_t v) {
+      return frag.IsAliveInnerVertex(v) && frag.GetId(v) < end_id;
+    });
   } else if (!begin.empty() && end.empty()) {
     oid_t begin_id = string_to_oid<oid_t>(begin);
-    for (auto& v : iv) {
-      if (frag.GetId(v) >= begin_id && frag.IsAliveInnerVertex(v)) {
-        vertices.emplace_back(v);
-      }
-    }
-  } else if (!begin.empty() && !end.empty()) {
-    oid_t begin_id = string_to_oid<oid_t>(begin);
-    oid_t end_id = string_to_oid<oid_t>(end);
-    for (auto& v : iv) {
-      oid_t id = frag.GetId(v);
-      if (id >= begin_id && id < end_id && frag.IsAliveInnerVertex(v)) {
-        vertices.emplace_back(v);
-      }
+    return select_vertices<FRAG_T>(iv, [&](vertex_t v) {
+      return frag.IsAliveInnerVertex(v) && frag.GetId(v) >= begin_id;
+    });
+  }
+  oid_t begin_id = string_to_oid<oid_t>(begin);
+  oid_t end_id = string_to_oid<oid_t>(end);
+  return select_vertices<FRAG_T>(iv, [&](vertex_t v) {
+    if (!frag.IsAliveInnerVertex(v)) {
+      return false;
     }
+    oid_t id = frag.GetId(v);
+    return id >= begin_id && id < end_id;
+  });
+}
+
+namespace transform_utils_impl {
+
+template <typename FUNC_T>
+void serialize_column(grape::InArchive& arc, size_t n, const FUNC_T& func,
+                      std::false_type) {
+  for (size_t i = 0; i < n; ++i) {
+    arc << func(i);
   }
-  return vertices;
+}
+
+template <typename FUNC_T>
+void serialize_column(grape::InArchive& arc, size_t n, const FUNC_T& func,
+                      std::true_type) {
+  using value_t = typename std::decay<decltype(func(0))>::type;
+  size_t old_size = arc.GetSize();
+  arc.Resize(old_size + n * sizeof(value_t));
+  char* buf = arc.GetBuffer() + old_size;
+  parallel_for(n, [&func, buf](size_t block, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      value_t value = func(i);
+      // the archive does not align its values
+      memcpy(buf + i * sizeof(value_t), &value, sizeof(value_t));
+    }
+  });
+}
+
+/**
+ * @brief Append n values of data to the archive, copied by blocks.
+ */
+template <typename T>
+void serialize_contiguous(grape::InArchive& arc, const T* data, size_t n) {
+  size_t old_size = arc.GetSize();
+  arc.Resize(old_size + n * sizeof(T));
+  char* buf = arc.GetBuffer() + old_size;
+  parallel_for(n, [data, buf](size_t block, size_t begin, size_t end) {
+    memcpy(buf + begin * sizeof(T), data + begin, (end - begin) * sizeof(T));
+  });
+}
+
+}  // namespace transform_utils_impl
+
+/**
+ * @brief Append func(0), ..., func(n - 1) to the archive, the same bytes as
+ * appending them one by one.
+ *
+ * Arithmetic values, being of a fixed width, are written to their slots of a
+ * buffer grown once, by a few threads when there are many of them. Other
+ * values, e.g., strings, are appended one by one.
+ */
+template <typename FUNC_T>
+void serialize_column(grape::InArchive& arc, size_t n, const FUNC_T& func) {
+  using value_t = typename std::decay<decltype(func(0))>::type;
+  transform_utils_impl::serialize_column(
+      arc, n, func,
+      std::integral_constant<bool, std::is_arithmetic<value_t>::value>());
 }
 
 inline void gather_archives(grape::InArchive& arc,
@@ -273,6 +398,7 @@ vertex_data_to_arrow_array_impl(const FRAG_T& frag) {
   typename vineyard::ConvertToArrowType<vdata_t>::BuilderType builder;
   auto iv = frag.InnerVertices();
 
+  ARROW_OK_OR_RAISE(builder.Reserve(iv.size()));
   for (auto& v : iv) {
     ARROW_OK_OR_RAISE(builder.Append(frag.GetData(v)));
   }
@@ -312,9 +438,13 @@ build_vy_tensor_builder(vineyard::Client& client, size_t size, FUNC_T&& func,
   std::vector<int64_t> part{part_idx};
   tensor_builder = std::make_shared<tensor_builder_t>(client, shape, part);
 
-  for (size_t i = 0; i < size; i++) {
-    tensor_builder->data()[i] = func(i);
-  }
+  auto* data = tensor_builder->data();
+  transform_utils_impl::parallel_for(
+      size, [data, &func](size_t block, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+          data[i] = func(i);
+        }
+      });
 
   return std::dynamic_pointer_cast<vineyard::ITensorBuilder>(tensor_builder);
 }
@@ -424,9 +554,13 @@ column_to_vy_tensor_builder_impl(
   auto tensor_builder =
       std::make_unique<vineyard::TensorBuilder<DATA_T>>(client, shape);
 
-  for (size_t i = 0; i < vertices.size(); i++) {
-    tensor_builder->data()[i] = col->at(vertices[i]);
-  }
+  auto* data = tensor_builder->data();
+  transform_utils_impl::parallel_for(
+      vertices.size(), [&](size_t block, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+          data[i] = col->at(vertices[i]);
+        }
+      });
   return tensor_builder;
 }
 
@@ -545,9 +679,9 @@ void serialize_context_property_impl(
     const std::shared_ptr<IColumn>& base_column) {
   auto column = std::dynamic_pointer_cast<Column<FRAG_T, DATA_T>>(base_column);
 
-  for (auto& v : range) {
-    arc << column->at(v);
-  }
+  serialize_column(arc, range.size(), [&](size_t i) -> decltype(auto) {
+    return column->at(range[i]);
+  });
 }
 
 template <typename FRAG_T>
@@ -633,16 +767,16 @@ class TransformUtils<FRAG_T,
 
   void SerializeVertexId(const std::vector<vertex_t>& range,
                          grape::InArchive& arc) {
-    for (auto& v : range) {
-      arc << frag_.GetId(v);
-    }
+    serialize_column(arc, range.size(), [&](size_t i) -> decltype(auto) {
+      return frag_.GetId(range[i]);
+    });
   }
 
   bl::result<void> SerializeVertexLabelId(const std::vector<vertex_t>& range,
                                           grape::InArchive& arc) {
-    for (auto& v : range) {
-      arc << frag_.vertex_label(v);
-    }
+    serialize_column(arc, range.size(), [&](size_t i) -> decltype(auto) {
+      return frag_.vertex_label(range[i]);
+    });
     return {};
   }
 
@@ -650,6 +784,7 @@ class TransformUtils<FRAG_T,
       label_id_t label_id) {
     typename vineyard::ConvertToArrowType<oid_t>::BuilderType builder;
     auto iv = frag_.InnerVertices(label_id);
+    ARROW_OK_OR_RAISE(builder.Reserve(iv.size()));
     for (auto& v : iv) {
       ARROW_OK_OR_RAISE(builder.Append(frag_.GetId(v)));
     }
@@ -670,9 +805,13 @@ class TransformUtils<FRAG_T,
     auto tensor_builder = std::make_shared<vineyard::TensorBuilder<oid_t>>(
         client, shape, part_idx);
 
-    for (size_t i = 0; i < vertices.size(); i++) {
-      tensor_builder->data()[i] = frag_.GetId(vertices[i]);
-    }
+    auto* data = tensor_builder->data();
+    transform_utils_impl::parallel_for(
+        vertices.size(), [&](size_t block, size_t begin, size_t end) {
+          for (size_t i = begin; i < end; ++i) {
+            data[i] = frag_.GetId(vertices[i]);
+          }
+        });
     return std::dynamic_pointer_cast<vineyard::ITensorBuilder>(tensor_builder);
   }
 
@@ -712,19 +851,19 @@ class TransformUtils<FRAG_T,
     auto type = frag_.vertex_property_type(label_id, prop_id);
 
     if (type->Equals(arrow::int32())) {
-      serializeVertexPropertyImpl<int32_t>(arc, range, prop_id);
+      serializeVertexPropertyImpl<int32_t>(arc, range, label_id, prop_id);
     } else if (type->Equals(arrow::int64())) {
-      serializeVertexPropertyImpl<int64_t>(arc, range, prop_id);
+      serializeVertexPropertyImpl<int64_t>(arc, range, label_id, prop_id);
     } else if (type->Equals(arrow::uint32())) {
-      serializeVertexPropertyImpl<uint32_t>(arc, range, prop_id);
+      serializeVertexPropertyImpl<uint32_t>(arc, range, label_id, prop_id);
     } else if (type->Equals(arrow::uint64())) {
-      serializeVertexPropertyImpl<int64_t>(arc, range, prop_id);
+      serializeVertexPropertyImpl<uint64_t>(arc, range, label_id, prop_id);
     } else if (type->Equals(arrow::float32())) {
-      serializeVertexPropertyImpl<float>(arc, range, prop_id);
+      serializeVertexPropertyImpl<float>(arc, range, label_id, prop_id);
     } else if (type->Equals(arrow::float64())) {
-      serializeVertexPropertyImpl<double>(arc, range, prop_id);
+      serializeVertexPropertyImpl<double>(arc, range, label_id, prop_id);
     } else if (type->Equals(arrow::large_utf8())) {
-      serializeVertexPropertyImpl<std::string>(arc, range, prop_id);
+      serializeVertexPropertyImpl<std::string>(arc, range, label_id, prop_id);
     } else {
       RETURN_GS_ERROR(vineyard::ErrorCode::kUnsupportedOperationError,
                       "property type not support - " + type->ToString());
@@ -811,10 +950,45 @@ class TransformUtils<FRAG_T,
   void serializeVertexPropertyImpl(
       grape::InArchive& arc,
       const std::vector<typename FRAG_T::vertex_t>& range,
-      typename FRAG_T::prop_id_t prop_id) {
-    for (auto& v : range) {
-      arc << frag_.template GetData<DATA_T>(v, prop_id);
+      label_id_t label_id, typename FRAG_T::prop_id_t prop_id) {
+    if (!copyVertexProperty<DATA_T>(arc, range, label_id, prop_id)) {
+      serialize_column(arc, range.size(), [&](size_t i) -> decltype(auto) {
+        return frag_.template GetData<DATA_T>(range[i], prop_id);
+      });
+    }
+  }
+
+  // A run of consecutive vertices, e.g., all inner vertices of a label, is
+  // copied straight from the values of the arrow column, which are in the
+  // order of the vertices.
+  template <typename DATA_T>
+  typename std::enable_if<std::is_arithmetic<DATA_T>::value, bool>::type
+  copyVertexProperty(grape::InArchive& arc, const std::vector<vertex_t>& range,
+                     label_id_t label_id, prop_id_t prop_id) {
+    using array_t = typename vineyard::ConvertToArrowType<DATA_T>::ArrayType;
+    if (range.empty() || range.back().GetValue() - range.front().GetValue() !=
+                             range.size() - 1) {
+      return false;
+    }
+    auto column = frag_.vertex_data_table(label_id)->column(prop_id);
+    if (column->num_chunks() != 1) {
+      return false;
     }
+    auto array = std::dynamic_pointer_cast<array_t>(column->chunk(0));
+    if (array == nullptr) {
+      return false;
+    }
+    transform_utils_impl::serialize_contiguous(
+        arc, array->raw_values() + frag_.vertex_offset(range.front()),
+        range.size());
+    return true;
+  }
+
+  template <typename DATA_T>
+  typename std::enable_if<!std::is_arithmetic<DATA_T>::value, bool>::type
+  copyVertexProperty(grape::InArchive& arc, const std::vector<vertex_t>& range,
+                     label_id_t label_id, prop_id_t prop_id) {
+    return false;
   }
 
   template <typename DATA_T,
@@ -828,10 +1002,13 @@ class TransformUtils<FRAG_T,
     auto tensor_builder =
         std::make_shared<vineyard::TensorBuilder<DATA_T>>(client, shape);
 
-    for (size_t i = 0; i < vertices.size(); i++) {
-      tensor_builder->data()[i] =
-          frag_.template GetData<DATA_T>(vertices[i], prop_id);
-    }
+    auto* data = tensor_builder->data();
+    transform_utils_impl::parallel_for(
+        vertices.size(), [&](size_t block, size_t begin, size_t end) {
+          for (size_t i = begin; i < end; ++i) {
+            data[i] = frag_.template GetData<DATA_T>(vertices[i], prop_id);
+          }
+        });
     return tensor_builder;
   }
 
@@ -905,9 +1082,9 @@ class TransformUtils<
 
   void SerializeVertexId(const std::vector<vertex_t>& range,
                          grape::InArchive& arc) {
-    for (auto& v : range) {
-      arc << frag_.GetId(v);
-    }
+    serialize_column(arc, range.size(), [&](size_t i) -> decltype(auto) {
+      return frag_.GetId(range[i]);
+    });
   }
 
   bl::result<void> SerializeVertexLabelId(const std::vector<vertex_t>& range,
@@ -927,6 +1104,7 @@ class TransformUtils<
     typename vineyard::ConvertToArrowType<oid_t>::BuilderType builder;
     auto inner_vertices = frag_.InnerVertices();
 
+    ARROW_OK_OR_RAISE(builder.Reserve(inner_vertices.size()));
     for (auto& v : inner_vertices) {
       ARROW_OK_OR_RAISE(builder.Append(frag_.GetId(v)));
     }
@@ -947,9 +1125,13 @@ class TransformUtils<
     auto tensor_builder = std::make_shared<vineyard::TensorBuilder<oid_t>>(
         client, shape, part_idx);
 
-    for (size_t i = 0; i < vertices.size(); i++) {
-      tensor_builder->data()[i] = frag_.GetId(vertices[i]);
-    }
+    auto* data = tensor_builder->data();
+    transform_utils_impl::parallel_for(
+        vertices.size(), [&](size_t block, size_t begin, size_t end) {
+          for (size_t i = begin; i < end; ++i) {
+            data[i] = frag_.GetId(vertices[i]);
+          }
+        });
     return std::dynamic_pointer_cast<vineyard::ITensorBuilder>(tensor_builder);
   }
 
@@ -984,9 +1166,9 @@ class TransformUtils<
 
   void SerializeVertexData(const std::vector<vertex_t>& range,
                            grape::InArchive& arc) {
-    for (auto& v : range) {
-      arc << frag_.GetData(v);
-    }
+    serialize_column(arc, range.size(), [&](size_t i) -> decltype(auto) {
+      return frag_.GetData(range[i]);
+    });
   }
 
   bl::result<std::shared_ptr<vineyard::ITensorBuilder>>
@@ -1085,9 +1267,9 @@ class TransformUtils<
 
   void SerializeVertexId(const std::vector<vertex_t>& range,
                          grape::InArchive& arc) {
-    for (auto& v : range) {
-      arc << frag_.GetId(v);
-    }
+    serialize_column(arc, range.size(), [&](size_t i) -> decltype(auto) {
+      return frag_.GetId(range[i]);
+    });
   }
 
   bl::result<void> SerializeVertexLabelId(const std::vector<vertex_t>& range,
@@ -1217,9 +1399,9 @@ class TransformUtils<
 
   void SerializeVertexData(const std::vector<vertex_t>& range,
                            grape::InArchive& arc) {
-    for (auto& v : range) {
-      arc << frag_.GetData(v);
-    }
+    serialize_column(arc, range.size(), [&](size_t i) -> decltype(auto) {
+      return frag_.GetData(range[i]);
+    });
   }
 
   bl::result<std::shared_ptr<vineyard::ITensorBuilder>>
@@ -30,6 +30,7 @@
 #include "grape/util.h"
 
 #include "core/parallel/property_message_manager.h"
+#include "core/worker/worker_profile.h"
 
 namespace gs {
 
@@ -98,12 +99,17 @@ class DefaultPropertyWorker {
     int round = 0;
 
     messages_.Start();
+    profile_.Clear();
+    StepTimer timer;
 
     messages_.StartARound();
 
+    timer.StartCompute();
     app_->PEval(graph, *context_, messages_);
+    timer.FinishCompute();
 
     messages_.FinishARound();
+    timer.Finish(profile_, messages_.GetMsgSize());
 
     if (comm_spec_.worker_id() == grape::kCoordinatorRank) {
       VLOG(1) << "[Coordinator]: Finished PEval, time: "
@@ -117,9 +123,12 @@ class DefaultPropertyWorker {
       round++;
       messages_.StartARound();
 
+      timer.StartCompute();
       app_->IncEval(graph, *context_, messages_);
+      timer.FinishCompute();
 
       messages_.FinishARound();
+      timer.Finish(profile_, messages_.GetMsgSize());
 
       if (comm_spec_.worker_id() == grape::kCoordinatorRank) {
         VLOG(1) << "[Coordinator]: Finished IncEval - " << step
@@ -131,16 +140,21 @@ class DefaultPropertyWorker {
     MPI_Barrier(comm_spec_.comm());
 
     messages_.Finalize();
+    profile_.Gather(comm_spec_);
   }
 
   std::shared_ptr<context_t> GetContext() { return context_; }
 
+  // the profile of the last query, gathered from all workers
+  const WorkerProfile& GetProfile() const { return profile_; }
+
   void Output(std::ostream& os) { context_->Output(os); }
 
  private:
   std::shared_ptr<APP_T> app_;
   std::shared_ptr<context_t> context_;
   message_manager_t messages_;
+  WorkerProfile profile_;
 
   grape::CommSpec comm_spec_;
 };
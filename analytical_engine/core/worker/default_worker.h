@@ -29,6 +29,8 @@
 #include "grape/parallel/parallel_engine.h"
 #include "grape/util.h"
 
+#include "core/worker/worker_profile.h"
+
 namespace gs {
 
 template <typename FRAG_T, typename CONTEXT_T>
@@ -98,12 +100,17 @@ class DefaultWorker {
     int round = 0;
 
     messages_.Start();
+    profile_.Clear();
+    StepTimer timer;
 
     messages_.StartARound();
 
+    timer.StartCompute();
     app_->PEval(graph, *context_, messages_);
+    timer.FinishCompute();
 
     messages_.FinishARound();
+    timer.Finish(profile_, messages_.GetMsgSize());
 
     if (comm_spec_.worker_id() == grape::kCoordinatorRank) {
       VLOG(1) << "[Coordinator]: Finished PEval, time: "
@@ -117,9 +124,12 @@ class DefaultWorker {
       round++;
       messages_.StartARound();
 
+      timer.StartCompute();
       app_->IncEval(graph, *context_, messages_);
+      timer.FinishCompute();
 
       messages_.FinishARound();
+      timer.Finish(profile_, messages_.GetMsgSize());
 
       if (comm_spec_.worker_id() == grape::kCoordinatorRank) {
         VLOG(1) << "[Coordinator]: Finished IncEval - " << step
@@ -131,11 +141,15 @@ class DefaultWorker {
     MPI_Barrier(comm_spec_.comm());
 
     messages_.Finalize();
+    profile_.Gather(comm_spec_);
     finishQuery();
   }
 
   std::shared_ptr<context_t> GetContext() { return context_; }
 
+  // the profile of the last query, gathered from all workers
+  const WorkerProfile& GetProfile() const { return profile_; }
+
   void Output(std::ostream& os) { context_->Output(os); }
 
  private:
@@ -160,6 +174,7 @@ class DefaultWorker {
   std::shared_ptr<APP_T> app_;
   std::shared_ptr<context_t> context_;
   message_manager_t messages_;
+  WorkerProfile profile_;
 
   grape::CommSpec comm_spec_;
 };
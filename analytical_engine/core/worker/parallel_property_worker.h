@@ -32,6 +32,7 @@
 #include "vineyard/graph/fragment/fragment_traits.h"
 
 #include "core/parallel/parallel_property_message_manager.h"
+#include "core/worker/worker_profile.h"
 
 namespace gs {
 
@@ -98,12 +99,17 @@ class ParallelPropertyWorker {
     int round = 0;
 
     messages_.Start();
+    profile_.Clear();
+    StepTimer timer;
 
     messages_.StartARound();
 
+    timer.StartCompute();
     app_->PEval(*graph_, *context_, messages_);
+    timer.FinishCompute();
 
     messages_.FinishARound();
+    timer.Finish(profile_, messages_.GetMsgSize());
 
     if (comm_spec_.worker_id() == grape::kCoordinatorRank) {
       VLOG(1) << "[Coordinator]: Finished PEval, time: "
@@ -112,27 +118,43 @@ class ParallelPropertyWorker {
 
     int step = 1;
 
+    // the time of a step includes its termination check, which is counted as
+    // waiting along with the sends of the previous round
+    double wait_time = messages_.GetWaitTime();
+    t = grape::GetCurrentTime();
     while (!messages_.ToTerminate()) {
-      t = grape::GetCurrentTime();
       round++;
       messages_.StartARound();
 
+      timer.StartCompute();
       app_->IncEval(*graph_, *context_, messages_);
+      timer.FinishCompute();
 
       messages_.FinishARound();
+      timer.Finish(profile_, messages_.GetMsgSize());
 
       if (comm_spec_.worker_id() == grape::kCoordinatorRank) {
+        double step_time = grape::GetCurrentTime() - t;
+        double step_wait = messages_.GetWaitTime() - wait_time;
         VLOG(1) << "[Coordinator]: Finished IncEval - " << step
-                << ", time: " << grape::GetCurrentTime() - t << " sec";
+                << ", time: " << step_time
+                << " sec, compute: " << step_time - step_wait
+                << " sec, wait: " << step_wait << " sec";
       }
+      wait_time = messages_.GetWaitTime();
+      t = grape::GetCurrentTime();
       ++step;
     }
     MPI_Barrier(comm_spec_.comm());
     messages_.Finalize();
+    profile_.Gather(comm_spec_);
   }
 
   std::shared_ptr<context_t> GetContext() { return context_; }
 
+  // the profile of the last query, gathered from all workers
+  const WorkerProfile& GetProfile() const { return profile_; }
+
   void Output(std::ostream& os) { context_->Output(os); }
 
  private:
@@ -140,6 +162,7 @@ class ParallelPropertyWorker {
   std::shared_ptr<fragment_t> graph_;
   std::shared_ptr<context_t> context_;
   message_manager_t messages_;
+  WorkerProfile profile_;
 
   grape::CommSpec comm_spec_;
 };
@@ -0,0 +1,158 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANALYTICAL_ENGINE_CORE_WORKER_WORKER_PROFILE_H_
+#define ANALYTICAL_ENGINE_CORE_WORKER_WORKER_PROFILE_H_
+
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "grape/communication/sync_comm.h"
+#include "grape/util.h"
+#include "grape/worker/comm_spec.h"
+#include "vineyard/common/util/json.h"
+
+namespace gs {
+
+/**
+ * @brief The cost of a superstep on a worker. Step 0 is PEval.
+ */
+struct StepProfile {
+  int32_t step;
+  // time spent in PEval or IncEval, in seconds
+  double compute_time;
+  // time spent in flushing, exchanging and waiting for messages, including
+  // the termination check, in seconds
+  double message_time;
+  uint64_t bytes_sent;
+};
+
+/**
+ * @brief The per-superstep profile of a query, recorded by each worker
+ * locally and gathered to all workers once the query finishes, so that
+ * stragglers and skewed fragments can be told from the timeline.
+ */
+class WorkerProfile {
+ public:
+  void Clear() {
+    steps_.clear();
+    json_.clear();
+  }
+
+  void AddStep(double compute_time, double message_time, size_t bytes_sent) {
+    StepProfile profile;
+    profile.step = static_cast<int32_t>(steps_.size());
+    profile.compute_time = compute_time;
+    profile.message_time = message_time;
+    profile.bytes_sent = bytes_sent;
+    steps_.push_back(profile);
+  }
+
+  /**
+   * @brief Gather the steps of all workers into a JSON timeline, must be
+   * called by all workers.
+   */
+  void Gather(const grape::CommSpec& comm_spec) {
+    std::vector<std::vector<StepProfile>> all_steps(comm_spec.worker_num());
+    all_steps[comm_spec.worker_id()] = steps_;
+    grape::sync_comm::AllGather(all_steps, comm_spec.comm());
+
+    vineyard::json workers = vineyard::json::array();
+    for (int i = 0; i < comm_spec.worker_num(); ++i) {
+      vineyard::json steps = vineyard::json::array();
+      for (auto& profile : all_steps[i]) {
+        steps.push_back({{"step", profile.step},
+                         {"compute_time", profile.compute_time},
+                         {"message_time", profile.message_time},
+                         {"bytes_sent", profile.bytes_sent}});
+      }
+      workers.push_back({{"worker_id", i},
+                         {"fid", comm_spec.WorkerToFrag(i)},
+                         {"steps", std::move(steps)}});
+    }
+    json_ = vineyard::json{{"workers", std::move(workers)}}.dump();
+  }
+
+  const std::string& ToJson() const { return json_; }
+
+ private:
+  std::vector<StepProfile> steps_;
+  std::string json_;
+};
+
+/**
+ * @brief Measures a superstep of a worker, message_time is all but the time
+ * spent in compute.
+ */
+class StepTimer {
+ public:
+  StepTimer()
+      : begin_(grape::GetCurrentTime()), compute_begin_(begin_), compute_(0) {}
+
+  void StartCompute() { compute_begin_ = grape::GetCurrentTime(); }
+
+  void FinishCompute() { compute_ += grape::GetCurrentTime() - compute_begin_; }
+
+  void Finish(WorkerProfile& profile, size_t bytes_sent) {
+    double total = grape::GetCurrentTime() - begin_;
+    profile.AddStep(compute_, total - compute_, bytes_sent);
+    begin_ = grape::GetCurrentTime();
+    compute_ = 0;
+  }
+
+ private:
+  double begin_;
+  double compute_begin_;
+  double compute_;
+};
+
+namespace worker_profile_impl {
+
+template <typename T, typename = void>
+struct has_profile : std::false_type {};
+
+template <typename T>
+struct has_profile<T, decltype(std::declval<const T&>().GetProfile(), void())>
+    : std::true_type {};
+
+template <typename WORKER_T>
+typename std::enable_if<has_profile<WORKER_T>::value, std::string>::type
+get_profile(const WORKER_T& worker) {
+  return worker.GetProfile().ToJson();
+}
+
+template <typename WORKER_T>
+typename std::enable_if<!has_profile<WORKER_T>::value, std::string>::type
+get_profile(const WORKER_T& worker) {
+  return std::string();
+}
+
+}  // namespace worker_profile_impl
+
+/**
+ * @brief The JSON profile of the last query of worker, or an empty string if
+ * the worker does not record one.
+ */
+template <typename WORKER_T>
+std::string GetWorkerProfile(const WORKER_T& worker) {
+  return worker_profile_impl::get_profile(worker);
+}
+
+}  // namespace gs
+
+#endif  // ANALYTICAL_ENGINE_CORE_WORKER_WORKER_PROFILE_H_
@@ -23,6 +23,7 @@
 #endif
 
 #include <memory>
+#include <string>
 #include <utility>
 
 #include "arrow/api.h"
@@ -37,6 +38,7 @@
 
 #include "core/app/app_invoker.h"
 #include "core/error.h"
+#include "core/worker/worker_profile.h"
 #include "frame/ctx_wrapper_builder.h"
 
 #if defined(_APP_TYPE) && defined(_APP_HEADER)
@@ -99,6 +101,12 @@ __attribute__((visibility("hidden"))) bl::result<std::nullptr_t> Query(
   return result;
 }
 
+__attribute__((visibility("hidden"))) std::string GetProfile(
+    void* worker_handler) {
+  auto worker = static_cast<worker_handler_t*>(worker_handler)->worker;
+  return gs::GetWorkerProfile(*worker);
+}
+
 }  // namespace detail
 
 extern "C" {
@@ -125,4 +133,8 @@ void Query(void* worker_handler, const gs::rpc::QueryArgs& query_args,
       wrapper_error, detail::Query(worker_handler, query_args, context_key,
                                    frag_wrapper, ctx_wrapper));
 }
+
+void GetProfile(void* worker_handler, std::string& profile) {
+  __FRAME_CATCH_AND_LOG_GS_ERROR(profile, detail::GetProfile(worker_handler));
+}
 }  // extern "C"
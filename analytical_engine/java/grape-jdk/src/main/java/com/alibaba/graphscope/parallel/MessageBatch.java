@@ -0,0 +1,136 @@
+/*
+ * Copyright 2021 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package com.alibaba.graphscope.parallel;
+
+import static com.alibaba.graphscope.utils.CppClassName.GS_MESSAGE_BATCH;
+import static com.alibaba.graphscope.utils.CppHeaderName.ARROW_PROJECTED_FRAGMENT_H;
+import static com.alibaba.graphscope.utils.CppHeaderName.CORE_JAVA_JAVA_MESSAGES_H;
+import static com.alibaba.graphscope.utils.CppHeaderName.CORE_JAVA_TYPE_ALIAS_H;
+import static com.alibaba.graphscope.utils.CppHeaderName.GRAPE_FRAGMENT_IMMUTABLE_EDGECUT_FRAGMENT_H;
+import static com.alibaba.graphscope.utils.CppHeaderName.GRAPE_PARALLEL_MESSAGE_IN_BUFFER_H;
+
+import com.alibaba.fastffi.CXXHead;
+import com.alibaba.fastffi.CXXReference;
+import com.alibaba.fastffi.FFIFactory;
+import com.alibaba.fastffi.FFIGen;
+import com.alibaba.fastffi.FFINameAlias;
+import com.alibaba.fastffi.FFIPointer;
+import com.alibaba.fastffi.FFISkip;
+import com.alibaba.fastffi.FFITypeAlias;
+import com.alibaba.fastffi.llvm4jni.runtime.JavaRuntime;
+import com.alibaba.graphscope.fragment.ArrowProjectedFragment;
+import com.alibaba.graphscope.fragment.FragmentType;
+import com.alibaba.graphscope.fragment.IFragment;
+import com.alibaba.graphscope.fragment.ImmutableEdgecutFragment;
+import com.alibaba.graphscope.fragment.adaptor.ArrowProjectedAdaptor;
+import com.alibaba.graphscope.fragment.adaptor.ImmutableEdgecutFragmentAdaptor;
+
+/**
+ * MessageBatch is a java wrapper for gs::MessageBatch, which drains all the messages of a
+ * MessageInBuffer in one FFI call. The local ids of the receiving vertices and the messages are
+ * then read from off-heap memory, without crossing JNI per message.
+ *
+ * <p>The addresses are valid until the batch is drained or cleared again.
+ *
+ * @param <VID_T> vertex id type.
+ * @param <MSG_T> message type, must be trivially copyable, e.g., DoubleMsg or LongMsg.
+ */
+@FFIGen
+@FFITypeAlias(GS_MESSAGE_BATCH)
+@CXXHead({
+    GRAPE_PARALLEL_MESSAGE_IN_BUFFER_H,
+    GRAPE_FRAGMENT_IMMUTABLE_EDGECUT_FRAGMENT_H,
+    ARROW_PROJECTED_FRAGMENT_H,
+    CORE_JAVA_TYPE_ALIAS_H,
+    CORE_JAVA_JAVA_MESSAGES_H
+})
+public interface MessageBatch<VID_T, MSG_T> extends FFIPointer {
+    /**
+     * Append the messages of buffer to this batch.
+     *
+     * @param frag fragment.
+     * @param buffer message buffer, consumed.
+     */
+    default <OID_T, VDATA_T, EDATA_T> void drain(
+            IFragment<OID_T, VID_T, VDATA_T, EDATA_T> frag, MessageInBuffer buffer) {
+        if (frag.fragmentType().equals(FragmentType.ArrowProjectedFragment)) {
+            drainArrowProjected(
+                    ((ArrowProjectedAdaptor<OID_T, VID_T, VDATA_T, EDATA_T>) frag)
+                            .getArrowProjectedFragment(),
+                    buffer);
+        } else if (frag.fragmentType().equals(FragmentType.ImmutableEdgecutFragment)) {
+            drainImmutable(
+                    ((ImmutableEdgecutFragmentAdaptor<OID_T, VID_T, VDATA_T, EDATA_T>) frag)
+                            .getImmutableFragment(),
+                    buffer);
+        } else {
+            throw new IllegalStateException(
+                    "Unsupported fragment type: " + frag.fragmentType().name());
+        }
+    }
+
+    @FFINameAlias("Drain")
+    <
+                    @FFISkip OID_T,
+                    @FFISkip VDATA_T,
+                    @FFISkip EDATA_T,
+                    FRAG_T extends ArrowProjectedFragment<OID_T, VID_T, VDATA_T, EDATA_T>>
+            void drainArrowProjected(
+                    @CXXReference FRAG_T frag, @CXXReference MessageInBuffer buffer);
+
+    @FFINameAlias("Drain")
+    <OID_T, VDATA_T, EDATA_T> void drainImmutable(
+            @CXXReference ImmutableEdgecutFragment<OID_T, VID_T, VDATA_T, EDATA_T> frag,
+            @CXXReference MessageInBuffer buffer);
+
+    @FFINameAlias("Clear")
+    void clear();
+
+    @FFINameAlias("Size")
+    long size();
+
+    @FFINameAlias("GetVerticesAddress")
+    long getVerticesAddress();
+
+    @FFINameAlias("GetMessagesAddress")
+    long getMessagesAddress();
+
+    /** The local id of the receiver of the index-th message, for 64-bit vids. */
+    default long getLongVertex(long index) {
+        return JavaRuntime.getLong(getVerticesAddress() + index * 8);
+    }
+
+    /** The local id of the receiver of the index-th message, for 32-bit vids. */
+    default int getIntVertex(long index) {
+        return JavaRuntime.getInt(getVerticesAddress() + index * 4);
+    }
+
+    /** The index-th message, for batches of DoubleMsg. */
+    default double getDoubleMessage(long index) {
+        return JavaRuntime.getDouble(getMessagesAddress() + index * 8);
+    }
+
+    /** The index-th message, for batches of LongMsg. */
+    default long getLongMessage(long index) {
+        return JavaRuntime.getLong(getMessagesAddress() + index * 8);
+    }
+
+    @FFIFactory
+    interface Factory<VID_T, MSG_T> {
+        MessageBatch<VID_T, MSG_T> create();
+    }
+}
@@ -43,6 +43,7 @@ import com.alibaba.graphscope.utils.FFITypeFactoryhelper;
 import java.util.concurrent.CountDownLatch;
 import java.util.concurrent.ExecutorService;
 import java.util.function.BiConsumer;
+import java.util.function.Consumer;
 import java.util.function.Supplier;
 
 /**
@@ -519,4 +520,50 @@ public interface ParallelMessageManager extends MessageManagerBase {
             executor.shutdown();
         }
     }
+
+    /**
+     * Parallel processing the messages received from last super step in batches. Each thread
+     * drains the buffers it fetches into a {@link MessageBatch} with one FFI call per buffer, and
+     * the consumer reads the batch from off-heap memory.
+     *
+     * @param <MSG_T>   message type, must be trivially copyable, e.g., DoubleMsg or LongMsg.
+     * @param frag      fragment.
+     * @param threadNum number of threads to use.
+     * @param executor  thread pool executor.
+     * @param msgClass  class of the messages.
+     * @param consumer  lambda function, called with each drained batch.
+     */
+    default <OID_T, VID_T, VDATA_T, EDATA_T, MSG_T> void parallelProcessBatch(
+            IFragment<OID_T, VID_T, VDATA_T, EDATA_T> frag,
+            int threadNum,
+            ExecutorService executor,
+            Class<? extends MSG_T> msgClass,
+            Consumer<MessageBatch<VID_T, MSG_T>> consumer) {
+        CountDownLatch countDownLatch = new CountDownLatch(threadNum);
+        MessageInBuffer.Factory bufferFactory = FFITypeFactoryhelper.newMessageInBuffer();
+        for (int tid = 0; tid < threadNum; ++tid) {
+            executor.execute(
+                    new Runnable() {
+                        @Override
+                        public void run() {
+                            MessageInBuffer messageInBuffer = bufferFactory.create();
+                            MessageBatch<VID_T, MSG_T> batch =
+                                    FFITypeFactoryhelper.newMessageBatch(
+                                            frag.getVidClass(), msgClass);
+                            while (getMessageInBuffer(messageInBuffer)) {
+                                batch.clear();
+                                batch.drain(frag, messageInBuffer);
+                                consumer.accept(batch);
+                            }
+                            countDownLatch.countDown();
+                        }
+                    });
+        }
+        try {
+            countDownLatch.await();
+        } catch (Exception e) {
+            e.printStackTrace();
+            executor.shutdown();
+        }
+    }
 }
@@ -59,6 +59,7 @@ public class CppClassName {
     public static final String GRAPE_IMMUTABLE_FRAGMENT = "grape::ImmutableEdgecutFragment";
     public static final String GRAPE_DEFAULT_MESSAGE_MANAGER = "grape::DefaultMessageManager";
     public static final String GRAPE_MESSAGE_IN_BUFFER = "grape::MessageInBuffer";
+    public static final String GS_MESSAGE_BATCH = "gs::MessageBatch";
     public static final String GRAPE_PARALLEL_MESSAGE_MANAGER = "grape::ParallelMessageManager";
     public static final String GRAPE_PARALLEL_THREAD_LOCAL_MESSAGE_BUFFER =
             "grape::ThreadLocalMessageBuffer";
@@ -19,6 +19,7 @@ package com.alibaba.graphscope.utils;
 import static com.alibaba.graphscope.utils.CppClassName.GRAPE_MESSAGE_IN_BUFFER;
 import static com.alibaba.graphscope.utils.CppClassName.GS_ARROW_PROJECTED_FRAGMENT_IMPL_STRING_TYPED_ARRAY;
 import static com.alibaba.graphscope.utils.CppClassName.GS_ARROW_PROJECTED_FRAGMENT_IMPL_TYPED_ARRAY;
+import static com.alibaba.graphscope.utils.CppClassName.GS_MESSAGE_BATCH;
 import static com.alibaba.graphscope.utils.CppClassName.GS_PRIMITIVE_MESSAGE;
 import static com.alibaba.graphscope.utils.CppClassName.GS_VERTEX_ARRAY;
 
@@ -36,6 +37,7 @@ import com.alibaba.graphscope.ds.StringTypedArray;
 import com.alibaba.graphscope.ds.Vertex;
 import com.alibaba.graphscope.ds.VertexArray;
 import com.alibaba.graphscope.ds.VertexRange;
+import com.alibaba.graphscope.parallel.MessageBatch;
 import com.alibaba.graphscope.parallel.MessageInBuffer;
 import com.alibaba.graphscope.parallel.message.DoubleMsg;
 import com.alibaba.graphscope.parallel.message.LongMsg;
@@ -69,6 +71,8 @@ public class FFITypeFactoryhelper {
             new HashMap<>();
     private static volatile HashMap<String, FFIVector.Factory> ffiVectorFactoryMap =
             new HashMap<>();
+    private static volatile HashMap<String, MessageBatch.Factory> messageBatchFactoryMap =
+            new HashMap<>();
     private static volatile HashMap<String, PrimitiveMessage.Factory> primitiveMsgFactoryMap =
             new HashMap<>();
 
@@ -383,6 +387,31 @@ public class FFITypeFactoryhelper {
         return javaMsgInBufFactory;
     }
 
+    /**
+     * Create a batch of messages of type msgClass, received by vertices with vid of type vidClass.
+     *
+     * @param vidClass Long or Integer.
+     * @param msgClass a trivially copyable message type, e.g., DoubleMsg or LongMsg.
+     * @return created MessageBatch.
+     */
+    public static <VID_T, MSG_T> MessageBatch<VID_T, MSG_T> newMessageBatch(
+            Class<? extends VID_T> vidClass, Class<? extends MSG_T> msgClass) {
+        String vidType = vidClass.equals(Long.class) ? "uint64_t" : "uint32_t";
+        String foreignTypeName =
+                makeParameterize(
+                        GS_MESSAGE_BATCH, vidType, FFITypeFactory.getFFITypeName(msgClass, true));
+        if (!messageBatchFactoryMap.containsKey(foreignTypeName)) {
+            synchronized (messageBatchFactoryMap) {
+                if (!messageBatchFactoryMap.containsKey(foreignTypeName)) {
+                    messageBatchFactoryMap.put(
+                            foreignTypeName,
+                            FFITypeFactory.getFactory(MessageBatch.class, foreignTypeName));
+                }
+            }
+        }
+        return messageBatchFactoryMap.get(foreignTypeName).create();
+    }
+
     public static String makeParameterize(String base, String... fields) {
         if (fields.length == 0) {
             return base;
@@ -42,10 +42,12 @@ from gscoordinator.utils import compile_app
 from gscoordinator.utils import compile_graph_frame
 from gscoordinator.utils import create_single_op_dag
 from gscoordinator.utils import dump_string
+from gscoordinator.utils import fetch_cached_library
 from gscoordinator.utils import get_app_sha256
 from gscoordinator.utils import get_graph_sha256
 from gscoordinator.utils import get_lib_path
 from gscoordinator.utils import op_pre_process
+from gscoordinator.utils import store_cached_library
 from gscoordinator.utils import to_interactive_engine_schema
 
 logger = logging.getLogger("graphscope")
@@ -253,16 +255,27 @@ class OperationExecutor:
             # try to get compiled file from workspace
             app_lib_path = get_lib_path(os.path.join(space, app_sig), app_sig)
             if not os.path.isfile(app_lib_path):
-                # compile and distribute
-                compiled_path = self._compile_lib_and_distribute(
-                    compile_app,
-                    app_sig,
-                    op,
-                    self._java_class_path,
+                # java apps come with jars besides the library, which are not
+                # cached
+                cacheable = not (
+                    algo_name.startswith("giraph:")
+                    or algo_name.startswith("java_pie:")
                 )
-                if app_lib_path != compiled_path:
-                    msg = f"Computed app library path != compiled path, {app_lib_path} versus {compiled_path}"
-                    raise RuntimeError(msg)
+                if cacheable and fetch_cached_library(app_sig, app_lib_path):
+                    self._launcher.distribute_file(app_lib_path)
+                else:
+                    # compile and distribute
+                    compiled_path = self._compile_lib_and_distribute(
+                        compile_app,
+                        app_sig,
+                        op,
+                        self._java_class_path,
+                    )
+                    if app_lib_path != compiled_path:
+                        msg = f"Computed app library path != compiled path, {app_lib_path} versus {compiled_path}"
+                        raise RuntimeError(msg)
+                    if cacheable:
+                        store_cached_library(app_sig, app_lib_path)
         op.attr[types_pb2.APP_LIBRARY_PATH].CopyFrom(
             attr_value_pb2.AttrValue(s=app_lib_path.encode("utf-8", errors="ignore"))
         )
@@ -279,16 +292,20 @@ class OperationExecutor:
             # try to get compiled file from workspace
             graph_lib_path = get_lib_path(os.path.join(space, graph_sig), graph_sig)
             if not os.path.isfile(graph_lib_path):
-                # compile and distribute
-                compiled_path = self._compile_lib_and_distribute(
-                    compile_graph_frame,
-                    graph_sig,
-                    op,
-                )
-                if graph_lib_path != compiled_path:
-                    raise RuntimeError(
-                        f"Computed graph library path not equal to compiled path, {graph_lib_path} versus {compiled_path}"
+                if fetch_cached_library(graph_sig, graph_lib_path):
+                    self._launcher.distribute_file(graph_lib_path)
+                else:
+                    # compile and distribute
+                    compiled_path = self._compile_lib_and_distribute(
+                        compile_graph_frame,
+                        graph_sig,
+                        op,
                     )
+                    if graph_lib_path != compiled_path:
+                        raise RuntimeError(
+                            f"Computed graph library path not equal to compiled path, {graph_lib_path} versus {compiled_path}"
+                        )
+                    store_cached_library(graph_sig, graph_lib_path)
         if graph_sig not in self._object_manager:
             dag_def = create_single_op_dag(
                 types_pb2.REGISTER_GRAPH_TYPE,
@@ -19,6 +19,7 @@
 
 import copy
 import datetime
+import functools
 import glob
 import hashlib
 import inspect
@@ -129,6 +130,10 @@ if not os.path.isfile(ANALYTICAL_ENGINE_PATH):
 
 ANALYTICAL_BUILTIN_SPACE = os.path.join(GRAPHSCOPE_HOME, "precompiled", "builtin")
 
+# A directory shared by the coordinators of a cluster, e.g., on a network file
+# system, keeping the compiled app and graph libraries across sessions.
+ANALYTICAL_LIBRARY_CACHE = os.environ.get("GRAPHSCOPE_LIBRARY_CACHE", None)
+
 # ANALYTICAL_ENGINE_JAVA_HOME
 ANALYTICAL_ENGINE_JAVA_HOME = ANALYTICAL_ENGINE_HOME
 
@@ -194,6 +199,77 @@ def get_lib_path(app_dir: str, app_name: str) -> str:
         raise RuntimeError(f"Unsupported platform {sys.platform}")
 
 
+@functools.lru_cache(maxsize=None)
+def get_engine_digest() -> str:
+    """Digest of the analytical engine the libraries are compiled against,
+    i.e., the version and the binary of the engine, so a library built from
+    other sources is never loaded.
+    """
+    s = hashlib.sha256(__version__.encode("utf-8", errors="ignore"))
+    if os.path.isfile(ANALYTICAL_ENGINE_PATH):
+        with open(ANALYTICAL_ENGINE_PATH, "rb") as f:
+            for chunk in iter(lambda: f.read(1 << 20), b""):
+                s.update(chunk)
+    return s.hexdigest()
+
+
+def get_cached_lib_path(lib_name: str) -> str:
+    """Path of a library in the shared cache, or None if there is no cache."""
+    if ANALYTICAL_LIBRARY_CACHE is None:
+        return None
+    return get_lib_path(
+        os.path.join(ANALYTICAL_LIBRARY_CACHE, get_engine_digest()[:16]), lib_name
+    )
+
+
+def fetch_cached_library(lib_name: str, lib_path: str) -> bool:
+    """Copy the library named lib_name from the shared cache to lib_path.
+
+    Returns:
+        bool: Whether the library was in the cache.
+    """
+    cached_path = get_cached_lib_path(lib_name)
+    if cached_path is None or not os.path.isfile(cached_path):
+        return False
+    try:
+        os.makedirs(os.path.dirname(lib_path), exist_ok=True)
+        _copy_atomically(cached_path, lib_path)
+    except OSError as e:
+        logger.warning("Failed to fetch %s from the library cache: %s", lib_name, e)
+        return False
+    logger.info("Fetched %s from the library cache", lib_name)
+    return True
+
+
+def store_cached_library(lib_name: str, lib_path: str):
+    """Publish a compiled library to the shared cache, if any.
+
+    Failures only lose the entry, the library is compiled again next time.
+    """
+    cached_path = get_cached_lib_path(lib_name)
+    if cached_path is None or os.path.isfile(cached_path):
+        return
+    try:
+        os.makedirs(os.path.dirname(cached_path), exist_ok=True)
+        _copy_atomically(lib_path, cached_path)
+    except OSError as e:
+        logger.warning("Failed to store %s to the library cache: %s", lib_name, e)
+        return
+    logger.info("Stored %s to the library cache", lib_name)
+
+
+def _copy_atomically(src: str, dst: str):
+    # readers never see a partial file, and concurrent writers of the same
+    # entry write the same content
+    tmp = f"{dst}.{uuid.uuid4().hex}.tmp"
+    try:
+        shutil.copyfile(src, tmp)
+        os.replace(tmp, dst)
+    finally:
+        if os.path.exists(tmp):
+            os.remove(tmp)
+
+
 def get_app_sha256(attr, java_class_path: str):
     (
         app_type,
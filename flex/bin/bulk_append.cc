@@ -0,0 +1,84 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Appends the vertex and edge files of a bulk-load config to the latest
+// snapshot of a work directory, and publishes the result as its new
+// checkpoint, see GraphDB::BulkAppend. The server of the work directory must
+// be stopped, and loads the new checkpoint when restarted.
+
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "grape/util.h"
+
+#include "flex/engines/graph_db/database/graph_db.h"
+
+#include <boost/program_options.hpp>
+
+#include <glog/logging.h>
+
+namespace bpo = boost::program_options;
+
+int main(int argc, char** argv) {
+  bpo::options_description desc("Usage:");
+  desc.add_options()("help", "Display help message")(
+      "graph-config,g", bpo::value<std::string>(), "graph schema config file")(
+      "bulk-load,l", bpo::value<std::string>(),
+      "bulk-load config file of the files to append")(
+      "data-path,d", bpo::value<std::string>(), "data directory path")(
+      "shard-num,s",
+      bpo::value<uint32_t>()->default_value(
+          std::thread::hardware_concurrency()),
+      "number of threads parsing the files")(
+      "partition-id", bpo::value<uint32_t>()->default_value(0),
+      "partition of the graph in the work directory")(
+      "partition-num", bpo::value<uint32_t>()->default_value(1),
+      "number of partitions the graph was bulk loaded into");
+  google::InitGoogleLogging(argv[0]);
+  FLAGS_logtostderr = true;
+
+  bpo::variables_map vm;
+  bpo::store(bpo::command_line_parser(argc, argv).options(desc).run(), vm);
+  bpo::notify(vm);
+
+  if (vm.count("help")) {
+    std::cout << desc << std::endl;
+    return 0;
+  }
+  if (!vm.count("graph-config") || !vm.count("bulk-load") ||
+      !vm.count("data-path")) {
+    LOG(ERROR) << "graph-config, bulk-load and data-path are required";
+    return -1;
+  }
+  uint32_t partition_id = vm["partition-id"].as<uint32_t>();
+  uint32_t partition_num = vm["partition-num"].as<uint32_t>();
+  if (partition_id >= partition_num) {
+    LOG(ERROR) << "partition-id must be less than partition-num";
+    return -1;
+  }
+
+  double t0 = -grape::GetCurrentTime();
+  auto ret = gs::Schema::LoadFromYaml(vm["graph-config"].as<std::string>(),
+                                      vm["bulk-load"].as<std::string>());
+  auto& db = gs::GraphDB::get();
+  db.SetPartition(partition_id, partition_num);
+  db.BulkAppend(std::get<0>(ret), std::get<1>(ret), std::get<2>(ret),
+                vm["data-path"].as<std::string>(),
+                vm["shard-num"].as<uint32_t>());
+  t0 += grape::GetCurrentTime();
+  LOG(INFO) << "Finished appending, elapsed " << t0 << " s";
+  return 0;
+}
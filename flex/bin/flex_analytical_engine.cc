@@ -19,6 +19,8 @@
 
 #include "flex/engines/bsp/apps.h"
 #include "flex/engines/bsp/bsp.h"
+#include "flex/engines/bsp/projected_fragment.h"
+#include "flex/engines/graph_db/database/graph_db.h"
 #include "flex/storages/immutable_graph/immutable_graph.h"
 
 #include "grape/fragment/basic_fragment_loader.h"
@@ -28,6 +30,13 @@ DEFINE_string(application, "", "application name");
 DEFINE_string(efile, "", "edge file");
 DEFINE_string(vfile, "", "vertex file");
 DEFINE_string(output_prefix, "", "output directory of results");
+DEFINE_string(graph_schema, "", "schema of the graph in data_path");
+DEFINE_string(data_path, "",
+              "data directory of a graph db to run on instead of "
+              "efile/vfile, with edges of edge_label between vertices of "
+              "vertex_label");
+DEFINE_string(vertex_label, "", "vertex label projected from data_path");
+DEFINE_string(edge_label, "", "edge label projected from data_path");
 
 DEFINE_int64(bfs_source, 0, "source vertex of bfs.");
 DEFINE_int32(cdlp_mr, 10, "max rounds of cdlp.");
@@ -68,6 +77,48 @@ void DoQuery(std::shared_ptr<FRAG_T> fragment, std::shared_ptr<APP_T> app,
   VLOG(1) << "Worker-" << comm_spec.worker_id() << " finished: " << output_path;
 }
 
+// Run on a snapshot of the graph db itself, the edges are read in place
+// from its csrs rather than from an exported copy.
+void RunOnGraphDB(const std::string& name, const grape::CommSpec& comm_spec,
+                  const std::string& out_prefix) {
+  auto& db = gs::GraphDB::get();
+  auto ret = gs::Schema::LoadFromYaml(FLAGS_graph_schema, "");
+  db.Init(std::get<0>(ret), {}, {}, {}, FLAGS_data_path);
+  const auto& schema = db.graph().schema();
+  auto vertex_label = schema.get_vertex_label_id(FLAGS_vertex_label);
+  auto edge_label = schema.get_edge_label_id(FLAGS_edge_label);
+  auto txn = db.GetReadTransaction();
+  if (name == "sssp") {
+    using GraphType = bsp::ProjectedFragment<double>;
+    auto fragment = std::make_shared<GraphType>(db.graph(), txn.timestamp(),
+                                                vertex_label, edge_label);
+    auto app = std::make_shared<bsp::SSSPApp<GraphType>>();
+    DoQuery(fragment, app, comm_spec, out_prefix, FLAGS_sssp_source);
+    return;
+  }
+  using GraphType = bsp::ProjectedFragment<grape::EmptyType>;
+  auto fragment = std::make_shared<GraphType>(db.graph(), txn.timestamp(),
+                                              vertex_label, edge_label);
+  if (name == "bfs") {
+    auto app = std::make_shared<bsp::BFSApp<GraphType>>();
+    DoQuery(fragment, app, comm_spec, out_prefix, FLAGS_bfs_source);
+  } else if (name == "lcc") {
+    auto app = std::make_shared<bsp::LCCApp<GraphType>>();
+    DoQuery(fragment, app, comm_spec, out_prefix);
+  } else if (name == "cdlp") {
+    auto app = std::make_shared<bsp::CDLPApp<GraphType>>();
+    DoQuery(fragment, app, comm_spec, out_prefix, FLAGS_cdlp_mr);
+  } else if (name == "pagerank") {
+    auto app = std::make_shared<bsp::PRApp<GraphType>>();
+    DoQuery(fragment, app, comm_spec, out_prefix, FLAGS_pr_d, FLAGS_pr_mr);
+  } else if (name == "wcc") {
+    auto app = std::make_shared<bsp::WCCApp<GraphType>>();
+    DoQuery(fragment, app, comm_spec, out_prefix);
+  } else {
+    LOG(FATAL) << "Invalid app: " << name;
+  }
+}
+
 int main(int argc, char** argv) {
   FLAGS_stderrthreshold = 0;
   grape::gflags::SetUsageMessage(
@@ -89,7 +140,9 @@ int main(int argc, char** argv) {
   std::string name = FLAGS_application;
   grape::LoadGraphSpec graph_spec = grape::DefaultLoadGraphSpec();
   auto out_prefix = FLAGS_output_prefix;
-  if (name == "sssp") {
+  if (!FLAGS_data_path.empty()) {
+    RunOnGraphDB(name, comm_spec, out_prefix);
+  } else if (name == "sssp") {
     auto fragment = grape::LoadGraph<WeightedGraph>(FLAGS_efile, FLAGS_vfile,
                                                     comm_spec, graph_spec);
     using AppType = bsp::SSSPApp<WeightedGraph>;
@@ -0,0 +1,473 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Mirrors a groot graph into a work directory, by applying the vertex and
+// edge inserts of the groot log as they are written. Labels and properties
+// are mapped by their names in the graph config, and the internal vertex ids
+// of groot are the _ID of the vertices. Every partition of the log is applied
+// by a thread of its own, through batch insert transactions which record the
+// offset they cover in the wal, so that a restarted replicator resumes each
+// partition where it stopped. Queries are served by read-only rt_servers
+// following the wal shipped on wal-ship-port, see GraphDB::StartReplication.
+//
+// Deletions and property updates of groot are not replicated: an update
+// overwrites the vertex with the properties it carries, others taking their
+// defaults. Edges of types with several properties are ignored.
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+#include "flex/engines/graph_db/database/graph_db.h"
+#include "flex/engines/graph_db/database/graph_db_session.h"
+
+#include "lgraph/client/graph_client.h"
+#include "lgraph/log_subscription/subscriber.h"
+
+#include <yaml-cpp/yaml.h>
+#include <boost/program_options.hpp>
+
+#include <glog/logging.h>
+
+namespace bpo = boost::program_options;
+namespace ls = lgraph::log_subscription;
+
+namespace gs {
+
+struct VertexMapping {
+  label_t label;
+  std::vector<PropertyType> types;
+  // groot property to flex column
+  std::unordered_map<lgraph::PropertyId, size_t> columns;
+};
+
+struct EdgeMapping {
+  label_t label;
+  // per flex src and dst label, the property and the groot property it is
+  // read from, -1 for none
+  std::map<std::pair<label_t, label_t>,
+           std::pair<PropertyType, lgraph::PropertyId>>
+      props;
+};
+
+// names of the properties of each label in the graph config, without _ID,
+// _SRC and _DST, which the schema does not keep
+static std::map<std::string, std::vector<std::string>> load_property_names(
+    const std::string& graph_config) {
+  std::map<std::string, std::vector<std::string>> names;
+  YAML::Node graph = YAML::LoadFile(graph_config)["graph"];
+  for (auto vertex : graph["vertex"]) {
+    auto& list = names["v:" + vertex["label_name"].as<std::string>()];
+    auto props = vertex["properties"];
+    for (size_t i = 1; i < props.size(); ++i) {
+      list.push_back(props[i]["name"].as<std::string>());
+    }
+  }
+  for (auto edge : graph["edge"]) {
+    auto& list = names["e:" + edge["src_label_name"].as<std::string>() + ":" +
+                       edge["dst_label_name"].as<std::string>() + ":" +
+                       edge["edge_label_name"].as<std::string>()];
+    auto props = edge["properties"];
+    for (size_t i = 2; i < props.size(); ++i) {
+      list.push_back(props[i]["name"].as<std::string>());
+    }
+  }
+  return names;
+}
+
+class LabelMapper {
+ public:
+  LabelMapper(const Schema& schema, const std::string& graph_config,
+              const lgraph::Schema& groot_schema) {
+    auto names = load_property_names(graph_config);
+    std::unordered_map<std::string, lgraph::PropertyId> groot_props;
+    for (auto& pair : groot_schema.GetPropDefMap()) {
+      groot_props.emplace(pair.second.GetPropName(), pair.first);
+    }
+    for (auto& pair : groot_schema.GetTypeDefMap()) {
+      const std::string& name = pair.second.GetLabelName();
+      if (pair.second.GetEntityType() == lgraph::VERTEX) {
+        if (!schema.contains_vertex_label(name)) {
+          LOG(WARNING) << "Vertex label " << name << " is not replicated";
+          continue;
+        }
+        VertexMapping mapping;
+        mapping.label = schema.get_vertex_label_id(name);
+        mapping.types = schema.get_vertex_properties(mapping.label);
+        auto& prop_names = names["v:" + name];
+        for (size_t i = 0; i < prop_names.size(); ++i) {
+          auto iter = groot_props.find(prop_names[i]);
+          if (iter != groot_props.end()) {
+            mapping.columns.emplace(iter->second, i);
+          } else {
+            LOG(WARNING) << "Property " << name << "." << prop_names[i]
+                         << " is not in groot, written as default";
+          }
+        }
+        vertices_.emplace(pair.first, std::move(mapping));
+      } else if (schema.contains_edge_label(name)) {
+        EdgeMapping mapping;
+        mapping.label = schema.get_edge_label_id(name);
+        for (label_t src = 0; src < schema.vertex_label_num(); ++src) {
+          for (label_t dst = 0; dst < schema.vertex_label_num(); ++dst) {
+            std::string src_name = schema.get_vertex_label_name(src);
+            std::string dst_name = schema.get_vertex_label_name(dst);
+            if (!schema.exist(src_name, dst_name, name)) {
+              continue;
+            }
+            if (schema.has_edge_table(src, dst, mapping.label)) {
+              LOG(WARNING) << "Edge " << name << " from " << src_name
+                           << " to " << dst_name
+                           << " has several properties, not replicated";
+              continue;
+            }
+            auto type = schema.get_edge_property(src, dst, mapping.label);
+            lgraph::PropertyId prop_id = -1;
+            auto& prop_names = names["e:" + src_name + ":" + dst_name + ":" +
+                                     name];
+            if (type != PropertyType::kEmpty && !prop_names.empty()) {
+              auto iter = groot_props.find(prop_names[0]);
+              if (iter != groot_props.end()) {
+                prop_id = iter->second;
+              }
+            }
+            mapping.props.emplace(std::make_pair(src, dst),
+                                  std::make_pair(type, prop_id));
+          }
+        }
+        edges_.emplace(pair.first, std::move(mapping));
+      } else {
+        LOG(WARNING) << "Edge label " << name << " is not replicated";
+      }
+    }
+  }
+
+  const VertexMapping* vertex(lgraph::LabelId label) const {
+    auto iter = vertices_.find(label);
+    return iter == vertices_.end() ? nullptr : &iter->second;
+  }
+
+  const EdgeMapping* edge(lgraph::LabelId label) const {
+    auto iter = edges_.find(label);
+    return iter == edges_.end() ? nullptr : &iter->second;
+  }
+
+ private:
+  std::unordered_map<lgraph::LabelId, VertexMapping> vertices_;
+  std::unordered_map<lgraph::LabelId, EdgeMapping> edges_;
+};
+
+static Any default_value(PropertyType type) {
+  Any value;
+  if (type == PropertyType::kInt32) {
+    value.set_integer(0);
+  } else if (type == PropertyType::kInt64) {
+    value.set_long(0);
+  } else if (type == PropertyType::kDate) {
+    value.set_date(0);
+  } else if (type == PropertyType::kDouble) {
+    value.set_double(0);
+  } else if (type == PropertyType::kString) {
+    value.set_string(std::string_view());
+  }
+  return value;
+}
+
+// The value points to the bytes of info for strings.
+static bool convert_value(const ls::PropertyInfo& info, PropertyType type,
+                          Any& value) {
+  auto data_type = info.GetDataType();
+  if (type == PropertyType::kInt32 && data_type == lgraph::INT) {
+    value.set_integer(info.GetAsInt32());
+  } else if (type == PropertyType::kInt64 && data_type == lgraph::INT) {
+    value.set_long(info.GetAsInt32());
+  } else if (type == PropertyType::kInt64 && data_type == lgraph::LONG) {
+    value.set_long(info.GetAsInt64());
+  } else if (type == PropertyType::kDate && data_type == lgraph::LONG) {
+    value.set_date(info.GetAsInt64());
+  } else if (type == PropertyType::kDouble && data_type == lgraph::FLOAT) {
+    value.set_double(info.GetAsFloat());
+  } else if (type == PropertyType::kDouble && data_type == lgraph::DOUBLE) {
+    value.set_double(info.GetAsDouble());
+  } else if (type == PropertyType::kString && data_type == lgraph::STRING) {
+    value.set_string(info.GetAsStr());
+  } else {
+    return false;
+  }
+  return true;
+}
+
+struct EdgeColumns {
+  std::vector<oid_t> srcs;
+  std::vector<oid_t> dsts;
+  std::vector<Any> props;
+};
+
+class PartitionReplicator {
+ public:
+  PartitionReplicator(GraphDB& db, const LabelMapper& mapper,
+                      int32_t partition, uint32_t missing_vertex_timeout_ms)
+      : db_(db),
+        session_(db.GetSession(partition)),
+        mapper_(mapper),
+        partition_(partition),
+        missing_vertex_timeout_ms_(missing_vertex_timeout_ms) {}
+
+  // Applies a batch of the log with the inserts it holds.
+  void Apply(const std::vector<ls::DecodedLogMessage>& batch) {
+    auto txn = session_.GetBatchInsertTransaction();
+    std::map<std::tuple<label_t, label_t, label_t>, EdgeColumns> edges;
+    int64_t offset = -1;
+    for (auto& msg : batch) {
+      if (msg.IsError()) {
+        LOG(ERROR) << "Partition " << partition_
+                   << " polled an error: " << msg.GetErrorMsg();
+        continue;
+      }
+      offset = msg.GetOffset();
+      for (auto& info : msg.GetVertexInserts()) {
+        addVertex(txn, info);
+      }
+      for (auto& info : msg.GetEdgeInserts()) {
+        addEdge(edges, info);
+      }
+    }
+    // Vertices are committed first and without the offset: an edge may end
+    // at a vertex of another partition not applied yet, whose replicator must
+    // not wait for the vertices of this one in turn. Applied twice after a
+    // restart, vertices are only overwritten with the same values.
+    txn.Commit();
+
+    auto start = std::chrono::steady_clock::now();
+    while (true) {
+      auto edge_txn = session_.GetBatchInsertTransaction();
+      bool added = true;
+      for (auto& pair : edges) {
+        auto& columns = pair.second;
+        if (!edge_txn.AddEdges(std::get<0>(pair.first),
+                               std::get<1>(pair.first),
+                               std::get<2>(pair.first), columns.srcs,
+                               columns.dsts, columns.props)) {
+          added = false;
+          break;
+        }
+      }
+      if (added) {
+        if (offset >= 0) {
+          edge_txn.SetSourceOffset(partition_, offset);
+        }
+        edge_txn.Commit();
+        return;
+      }
+      edge_txn.Abort();
+      auto waited = std::chrono::duration_cast<std::chrono::milliseconds>(
+          std::chrono::steady_clock::now() - start);
+      if (waited.count() >= missing_vertex_timeout_ms_) {
+        dropMissing(edges);
+      } else {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      }
+    }
+  }
+
+ private:
+  void addVertex(BatchInsertTransaction& txn,
+                 const ls::VertexInsertInfo& info) {
+    auto* mapping = mapper_.vertex(info.GetLabelId());
+    if (mapping == nullptr) {
+      return;
+    }
+    std::vector<Any> props;
+    props.reserve(mapping->types.size());
+    for (auto type : mapping->types) {
+      props.push_back(default_value(type));
+    }
+    for (auto& pair : info.GetPropMap()) {
+      auto iter = mapping->columns.find(pair.first);
+      if (iter != mapping->columns.end() &&
+          !convert_value(pair.second, mapping->types[iter->second],
+                         props[iter->second])) {
+        LOG(ERROR) << "Property " << pair.first << " of vertex "
+                   << info.GetVertexId() << " has an unexpected type";
+        return;
+      }
+    }
+    txn.AddVertex(mapping->label, info.GetVertexId(), props);
+  }
+
+  void addEdge(
+      std::map<std::tuple<label_t, label_t, label_t>, EdgeColumns>& edges,
+      const ls::EdgeInsertInfo& info) {
+    // groot logs each edge once more for the partition of its destination
+    if (!info.IsForward()) {
+      return;
+    }
+    auto& relation = info.GetEdgeRelation();
+    auto* mapping = mapper_.edge(relation.edge_label_id);
+    auto* src_mapping = mapper_.vertex(relation.src_vertex_label_id);
+    auto* dst_mapping = mapper_.vertex(relation.dst_vertex_label_id);
+    if (mapping == nullptr || src_mapping == nullptr ||
+        dst_mapping == nullptr) {
+      return;
+    }
+    auto iter =
+        mapping->props.find(std::make_pair(src_mapping->label,
+                                           dst_mapping->label));
+    if (iter == mapping->props.end()) {
+      return;
+    }
+    PropertyType type = iter->second.first;
+    Any prop = default_value(type);
+    auto prop_iter = info.GetPropMap().find(iter->second.second);
+    if (prop_iter != info.GetPropMap().end() &&
+        !convert_value(prop_iter->second, type, prop)) {
+      LOG(ERROR) << "Property of edge " << info.GetEdgeId().edge_inner_id
+                 << " has an unexpected type";
+      return;
+    }
+    auto& columns = edges[std::make_tuple(
+        src_mapping->label, dst_mapping->label, mapping->label)];
+    columns.srcs.push_back(info.GetEdgeId().src_vertex_id);
+    columns.dsts.push_back(info.GetEdgeId().dst_vertex_id);
+    columns.props.push_back(prop);
+  }
+
+  // Drops the edges still missing an endpoint, which groot never logged.
+  void dropMissing(
+      std::map<std::tuple<label_t, label_t, label_t>, EdgeColumns>& edges) {
+    const auto& graph = db_.graph();
+    for (auto& pair : edges) {
+      auto& columns = pair.second;
+      EdgeColumns kept;
+      for (size_t i = 0; i < columns.srcs.size(); ++i) {
+        vid_t lid;
+        if (graph.get_lid(std::get<0>(pair.first), columns.srcs[i], lid) &&
+            graph.get_lid(std::get<1>(pair.first), columns.dsts[i], lid)) {
+          kept.srcs.push_back(columns.srcs[i]);
+          kept.dsts.push_back(columns.dsts[i]);
+          kept.props.push_back(columns.props[i]);
+        } else {
+          LOG(ERROR) << "Dropped edge from " << columns.srcs[i] << " to "
+                     << columns.dsts[i] << " of partition " << partition_
+                     << ", an endpoint is missing";
+        }
+      }
+      columns = std::move(kept);
+    }
+  }
+
+  GraphDB& db_;
+  GraphDBSession& session_;
+  const LabelMapper& mapper_;
+  int32_t partition_;
+  int64_t missing_vertex_timeout_ms_;
+};
+
+}  // namespace gs
+
+static std::atomic<bool> running(true);
+
+int main(int argc, char** argv) {
+  bpo::options_description desc("Usage:");
+  desc.add_options()("help", "Display help message")(
+      "graph-config,g", bpo::value<std::string>(), "graph schema config file")(
+      "data-path,d", bpo::value<std::string>(), "data directory path")(
+      "groot-endpoint", bpo::value<std::string>(),
+      "host:port of the groot frontend to replicate")(
+      "max-batch-size", bpo::value<size_t>()->default_value(1024),
+      "max number of log entries applied by one transaction")(
+      "decode-thread-num", bpo::value<size_t>()->default_value(2),
+      "number of threads decoding the log of each partition")(
+      "missing-vertex-timeout-ms", bpo::value<uint32_t>()->default_value(60000),
+      "time an edge waits for its endpoints before being dropped")(
+      "wal-batch-size", bpo::value<size_t>()->default_value(1),
+      "max number of wal records per fsync, >1 enables group commit")(
+      "wal-batch-delay-us", bpo::value<uint32_t>()->default_value(200),
+      "max delay in microseconds of a group commit batch")(
+      "checkpoint-interval", bpo::value<uint32_t>()->default_value(0),
+      "interval in seconds of background checkpoints, 0 disables them")(
+      "wal-ship-port", bpo::value<uint16_t>()->default_value(0),
+      "port to stream the wal to read-only replicas on, 0 disables it");
+  google::InitGoogleLogging(argv[0]);
+  FLAGS_logtostderr = true;
+
+  bpo::variables_map vm;
+  bpo::store(bpo::command_line_parser(argc, argv).options(desc).run(), vm);
+  bpo::notify(vm);
+
+  if (vm.count("help")) {
+    std::cout << desc << std::endl;
+    return 0;
+  }
+  if (!vm.count("graph-config") || !vm.count("data-path") ||
+      !vm.count("groot-endpoint")) {
+    LOG(ERROR) << "graph-config, data-path and groot-endpoint are required";
+    return -1;
+  }
+  std::string graph_config = vm["graph-config"].as<std::string>();
+
+  lgraph::client::GraphClient client(vm["groot-endpoint"].as<std::string>());
+  lgraph::Schema groot_schema = client.GetGraphSchema();
+  lgraph::LoggerInfo logger_info = client.GetLoggerInfo();
+  LOG(INFO) << "Replicating topic " << logger_info.topic << " of "
+            << logger_info.kafka_servers << " with "
+            << logger_info.queue_number << " partitions";
+
+  auto ret = gs::Schema::LoadFromYaml(graph_config, "");
+  auto& db = gs::GraphDB::get();
+  db.Init(std::get<0>(ret), {}, {}, {}, vm["data-path"].as<std::string>(),
+          logger_info.queue_number, vm["wal-batch-size"].as<size_t>(),
+          vm["wal-batch-delay-us"].as<uint32_t>(),
+          vm["checkpoint-interval"].as<uint32_t>(), 0, 0,
+          vm["wal-ship-port"].as<uint16_t>());
+  gs::LabelMapper mapper(db.schema(), graph_config, groot_schema);
+
+  std::signal(SIGINT, [](int) { running.store(false); });
+  std::signal(SIGTERM, [](int) { running.store(false); });
+
+  size_t max_batch_size = vm["max-batch-size"].as<size_t>();
+  size_t decode_thread_num = vm["decode-thread-num"].as<size_t>();
+  uint32_t timeout_ms = vm["missing-vertex-timeout-ms"].as<uint32_t>();
+  std::vector<std::thread> threads;
+  for (int32_t partition = 0; partition < logger_info.queue_number;
+       ++partition) {
+    threads.emplace_back([&, partition]() {
+      int64_t offset = db.graph().source_offsets().get(partition) + 1;
+      LOG(INFO) << "Partition " << partition << " starts at offset " << offset;
+      ls::PipelinedSubscriber subscriber(
+          logger_info.kafka_servers, logger_info.topic, partition, offset,
+          decode_thread_num, max_batch_size);
+      gs::PartitionReplicator replicator(db, mapper, partition, timeout_ms);
+      while (running.load()) {
+        auto batch = subscriber.PollBatch(100);
+        if (!batch.empty()) {
+          replicator.Apply(batch);
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  LOG(INFO) << "Stopped replicating";
+  return 0;
+}
@@ -0,0 +1,307 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Replays a weighted mix of requests against a sync_server, or against the
+// sessions of a graph db loaded in process, and reports the latencies of each
+// kind of request.
+//
+// Each line of the workload file is "<name> <weight> <endpoint> <file>",
+// where file holds the raw body of one request, endpoint is "query" or
+// "adhoc", and lines of the same name, e.g. one per substitution parameter,
+// are reported together. Requests are picked by weight with a fixed seed, so
+// runs of the same workload replay the same sequence.
+//
+// With --qps, each of the --concurrency workers sends at a fixed rate and
+// latencies count from the time a request was due, so a stalled server is
+// not hidden by the workers waiting for it.
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "grape/util.h"
+
+#include "flex/engines/graph_db/database/graph_db.h"
+#include "flex/engines/graph_db/database/graph_db_session.h"
+#include "flex/third_party/httplib.h"
+
+#include <boost/program_options.hpp>
+
+#include <glog/logging.h>
+
+namespace bpo = boost::program_options;
+
+struct Request {
+  size_t kind;
+  double weight;
+  bool adhoc;
+  std::string body;
+};
+
+struct Sample {
+  size_t kind;
+  uint64_t latency_us;
+  bool ok;
+};
+
+static bool load_workload(const std::string& path,
+                          std::vector<std::string>& kinds,
+                          std::vector<Request>& requests) {
+  std::ifstream fin(path);
+  if (!fin.is_open()) {
+    LOG(ERROR) << "Failed to open workload file " << path;
+    return false;
+  }
+  std::map<std::string, size_t> kind_ids;
+  std::string line;
+  while (std::getline(fin, line)) {
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+    std::istringstream ss(line);
+    std::string name, endpoint, file;
+    Request req;
+    if (!(ss >> name >> req.weight >> endpoint >> file) ||
+        (endpoint != "query" && endpoint != "adhoc") || req.weight <= 0) {
+      LOG(ERROR) << "Bad workload line: " << line;
+      return false;
+    }
+    std::ifstream body(file, std::ios::binary);
+    if (!body.is_open()) {
+      LOG(ERROR) << "Failed to open request file " << file;
+      return false;
+    }
+    req.body.assign(std::istreambuf_iterator<char>(body),
+                    std::istreambuf_iterator<char>());
+    if (req.body.empty()) {
+      LOG(ERROR) << "Empty request file " << file;
+      return false;
+    }
+    auto iter = kind_ids.emplace(name, kinds.size()).first;
+    if (iter->second == kinds.size()) {
+      kinds.push_back(name);
+    }
+    req.kind = iter->second;
+    req.adhoc = (endpoint == "adhoc");
+    requests.emplace_back(std::move(req));
+  }
+  if (requests.empty()) {
+    LOG(ERROR) << "No request in workload file " << path;
+    return false;
+  }
+  return true;
+}
+
+static uint64_t percentile(const std::vector<uint64_t>& sorted, double p) {
+  size_t index = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+  return sorted[index];
+}
+
+static void report(const std::vector<std::string>& kinds,
+                   const std::vector<std::vector<Sample>>& samples,
+                   double elapsed) {
+  std::vector<std::vector<uint64_t>> latencies(kinds.size());
+  std::vector<size_t> errors(kinds.size(), 0);
+  size_t total = 0, total_errors = 0;
+  for (auto& worker : samples) {
+    for (auto& sample : worker) {
+      latencies[sample.kind].push_back(sample.latency_us);
+      errors[sample.kind] += !sample.ok;
+    }
+    total += worker.size();
+  }
+  printf("%-24s %10s %8s %10s %10s %10s %10s %10s\n", "request", "count",
+         "errors", "mean(us)", "p50(us)", "p99(us)", "p999(us)", "max(us)");
+  for (size_t i = 0; i < kinds.size(); ++i) {
+    auto& vec = latencies[i];
+    total_errors += errors[i];
+    if (vec.empty()) {
+      continue;
+    }
+    std::sort(vec.begin(), vec.end());
+    double sum = 0;
+    for (auto l : vec) {
+      sum += l;
+    }
+    printf("%-24s %10zu %8zu %10.1f %10lu %10lu %10lu %10lu\n",
+           kinds[i].c_str(), vec.size(), errors[i], sum / vec.size(),
+           percentile(vec, 0.5), percentile(vec, 0.99), percentile(vec, 0.999),
+           vec.back());
+  }
+  printf("total %zu requests, %zu errors in %.2f s, %.1f requests/s\n", total,
+         total_errors, elapsed, total / elapsed);
+}
+
+int main(int argc, char** argv) {
+  bpo::options_description desc("Usage:");
+  desc.add_options()("help", "Display help message")(
+      "workload,w", bpo::value<std::string>(), "workload file")(
+      "concurrency,c", bpo::value<uint32_t>()->default_value(1),
+      "number of concurrent workers")(
+      "qps,q", bpo::value<double>()->default_value(0),
+      "target requests per second of all workers, 0 sends as fast as "
+      "possible")("duration,t", bpo::value<double>()->default_value(60),
+                  "seconds to measure")(
+      "warmup", bpo::value<double>()->default_value(10),
+      "seconds to run before measuring")(
+      "seed", bpo::value<uint64_t>()->default_value(0),
+      "seed of the request sequence")(
+      "host", bpo::value<std::string>()->default_value("127.0.0.1"),
+      "host of the sync_server")(
+      "http-port,p", bpo::value<uint16_t>()->default_value(10000),
+      "http port of the sync_server")(
+      "graph-config,g", bpo::value<std::string>(),
+      "graph schema config file, runs the requests in process instead of "
+      "over http")("data-path,d", bpo::value<std::string>(),
+                   "data directory path of the in process graph db")(
+      "bulk-load,l", bpo::value<std::string>(),
+      "bulk-load config file of the in process graph db");
+  google::InitGoogleLogging(argv[0]);
+  FLAGS_logtostderr = true;
+
+  bpo::variables_map vm;
+  bpo::store(bpo::command_line_parser(argc, argv).options(desc).run(), vm);
+  bpo::notify(vm);
+
+  if (vm.count("help")) {
+    std::cout << desc << std::endl;
+    return 0;
+  }
+  if (!vm.count("workload")) {
+    LOG(ERROR) << "workload is required";
+    return -1;
+  }
+  std::vector<std::string> kinds;
+  std::vector<Request> requests;
+  if (!load_workload(vm["workload"].as<std::string>(), kinds, requests)) {
+    return -1;
+  }
+
+  uint32_t concurrency = vm["concurrency"].as<uint32_t>();
+  double qps = vm["qps"].as<double>();
+  bool embedded = vm.count("graph-config") != 0;
+  if (concurrency == 0) {
+    LOG(ERROR) << "concurrency must be positive";
+    return -1;
+  }
+  if (embedded) {
+    if (!vm.count("data-path")) {
+      LOG(ERROR) << "data-path is required";
+      return -1;
+    }
+    for (auto& req : requests) {
+      if (req.adhoc) {
+        LOG(ERROR) << "adhoc queries are only served over http";
+        return -1;
+      }
+    }
+    std::string bulk_load_config_path;
+    if (vm.count("bulk-load")) {
+      bulk_load_config_path = vm["bulk-load"].as<std::string>();
+    }
+    double t0 = -grape::GetCurrentTime();
+    auto ret = gs::Schema::LoadFromYaml(vm["graph-config"].as<std::string>(),
+                                        bulk_load_config_path);
+    gs::GraphDB::get().Init(std::get<0>(ret), std::get<1>(ret),
+                            std::get<2>(ret), std::get<3>(ret),
+                            vm["data-path"].as<std::string>(), concurrency);
+    t0 += grape::GetCurrentTime();
+    LOG(INFO) << "Finished loading graph, elapsed " << t0 << " s";
+  }
+
+  std::vector<double> weights;
+  for (auto& req : requests) {
+    weights.push_back(req.weight);
+  }
+
+  using clock = std::chrono::steady_clock;
+  auto start = clock::now();
+  auto measure_start =
+      start + std::chrono::duration_cast<clock::duration>(
+                  std::chrono::duration<double>(vm["warmup"].as<double>()));
+  auto end =
+      measure_start +
+      std::chrono::duration_cast<clock::duration>(
+          std::chrono::duration<double>(vm["duration"].as<double>()));
+  clock::duration interval = clock::duration::zero();
+  if (qps > 0) {
+    interval = std::chrono::duration_cast<clock::duration>(
+        std::chrono::duration<double>(concurrency / qps));
+  }
+
+  std::vector<std::vector<Sample>> samples(concurrency);
+  std::vector<std::thread> workers;
+  std::string host = vm["host"].as<std::string>();
+  uint16_t port = vm["http-port"].as<uint16_t>();
+  uint64_t seed = vm["seed"].as<uint64_t>();
+  for (uint32_t i = 0; i < concurrency; ++i) {
+    workers.emplace_back([&, i]() {
+      std::mt19937_64 gen(seed + i);
+      std::discrete_distribution<size_t> pick(weights.begin(), weights.end());
+      httplib::Client cli(host, port);
+      cli.set_read_timeout(60, 0);
+      cli.set_write_timeout(60, 0);
+      // workers start evenly spread over one interval
+      auto due = start + interval * i / concurrency;
+      while (true) {
+        if (interval != clock::duration::zero()) {
+          std::this_thread::sleep_until(due);
+        } else {
+          due = clock::now();
+        }
+        if (due >= end) {
+          break;
+        }
+        const auto& req = requests[pick(gen)];
+        bool ok = true;
+        if (embedded) {
+          gs::GraphDB::get().GetSession(i).Eval(req.body);
+        } else {
+          auto res = cli.Post(
+              req.adhoc ? "/interactive/adhoc_query" : "/interactive/query",
+              req.body, "text/plain");
+          ok = res && res->status == 200;
+        }
+        auto now = clock::now();
+        if (due >= measure_start) {
+          samples[i].push_back(Sample{
+              req.kind,
+              static_cast<uint64_t>(
+                  std::chrono::duration_cast<std::chrono::microseconds>(now -
+                                                                        due)
+                      .count()),
+              ok});
+        }
+        due += interval;
+      }
+    });
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  double elapsed = std::chrono::duration<double>(
+                       std::min(clock::now(), end) - measure_start)
+                       .count();
+  report(kinds, samples, elapsed);
+  return 0;
+}
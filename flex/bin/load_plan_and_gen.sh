@@ -228,6 +228,18 @@ compile_hqps_so() {
   if [ ! -z ${CMAKE_C_COMPILER} ]; then
     cmd="${cmd} -DCMAKE_C_COMPILER=${CMAKE_C_COMPILER}"
   fi
+  # if HQPS_PROFILE is set, compile in the operator profiling.
+  if [ ! -z ${HQPS_PROFILE} ]; then
+    cmd="${cmd} -DHQPS_PROFILE=ON"
+  fi
+  # if HQPS_USDT is set, compile in the static tracepoints of operators.
+  if [ ! -z ${HQPS_USDT} ]; then
+    cmd="${cmd} -DHQPS_USDT=ON"
+  fi
+  # the runtime headers are precompiled once into HQPS_PCH_DIR and reused by
+  # the next queries.
+  HQPS_PCH_DIR=${HQPS_PCH_DIR:-${HOME}/.cache/graphscope/hqps_pch}
+  cmd="${cmd} -DHQPS_PCH_DIR=${HQPS_PCH_DIR}"
   echo "Cmake command = ${cmd}"
   echo "---------------------------"
   eval ${cmd}
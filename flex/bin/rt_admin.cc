@@ -58,7 +58,7 @@ int main(int argc, char** argv) {
 
   std::vector<char> buf;
   gs::Encoder encoder(buf);
-  if (op == "SHOW_STORED_PROCEDURES") {
+  if (op == "SHOW_STORED_PROCEDURES" || op == "MEMORY_USAGE") {
     encoder.put_string(op);
     encoder.put_byte(0);
   } else if (op == "QUERY_VERTEX") {
@@ -124,6 +124,13 @@ int main(int argc, char** argv) {
         index++;
       }
     }
+  } else if (op == "MEMORY_USAGE") {
+    gs::Decoder decoder(ret.data(), ret.size());
+    if (decoder.empty()) {
+      std::cerr << "Query memory usage failed..." << std::endl;
+      return -1;
+    }
+    std::cout << decoder.get_string() << std::endl;
   } else if (op == "QUERY_VERTEX") {
     gs::Decoder decoder(ret.data(), ret.size());
     if (decoder.empty()) {
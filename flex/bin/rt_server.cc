@@ -37,7 +37,36 @@ int main(int argc, char** argv) {
       "http port of query handler")("graph-config,g", bpo::value<std::string>(),
                                     "graph schema config file")(
       "data-path,d", bpo::value<std::string>(), "data directory path")(
-      "bulk-load,l", bpo::value<std::string>(), "bulk-load config file");
+      "bulk-load,l", bpo::value<std::string>(), "bulk-load config file")(
+      "reorder-vertices",
+      "give vertices ids by descending degrees when bulk loading, so that "
+      "hubs are stored together")(
+      "wal-batch-size", bpo::value<size_t>()->default_value(1),
+      "max number of wal records per fsync, >1 enables group commit")(
+      "wal-batch-delay-us", bpo::value<uint32_t>()->default_value(200),
+      "max delay in microseconds of a group commit batch")(
+      "wal-compression", "compress the contents of wal records with LZ4")(
+      "checkpoint-interval", bpo::value<uint32_t>()->default_value(0),
+      "interval in seconds of background checkpoints, 0 disables them")(
+      "compaction-interval", bpo::value<uint32_t>()->default_value(0),
+      "interval in seconds of background adjacency list compactions, 0 "
+      "disables them")(
+      "history-retention", bpo::value<uint32_t>()->default_value(0),
+      "number of past timestamps served to reads with an as-of timestamp, 0 "
+      "disables them")(
+      "wal-ship-port", bpo::value<uint16_t>()->default_value(0),
+      "port to stream the wal to read-only replicas on, 0 disables it")(
+      "replica-of", bpo::value<std::string>(),
+      "host:port of the primary to follow as a read-only replica")(
+      "offload-threads", bpo::value<uint32_t>()->default_value(0),
+      "number of threads, each with a session of its own, to run long "
+      "queries on instead of the shards, 0 runs all of them on the shards")(
+      "result-cache-mb", bpo::value<size_t>()->default_value(0),
+      "megabytes of results of cacheable apps to keep until the next write, "
+      "0 disables the cache")(
+      "binary-port", bpo::value<uint16_t>()->default_value(0),
+      "port to serve queries over the length-prefixed binary protocol on, 0 "
+      "disables it");
   google::InitGoogleLogging(argv[0]);
   FLAGS_logtostderr = true;
 
@@ -56,6 +85,7 @@ int main(int argc, char** argv) {
 
   bool enable_dpdk = false;
   uint32_t shard_num = vm["shard-num"].as<uint32_t>();
+  uint32_t offload_threads = vm["offload-threads"].as<uint32_t>();
   uint16_t http_port = vm["http-port"].as<uint16_t>();
 
   std::string graph_schema_path = "";
@@ -75,6 +105,10 @@ int main(int argc, char** argv) {
   if (vm.count("bulk-load")) {
     bulk_load_config_path = vm["bulk-load"].as<std::string>();
   }
+  if (vm.count("replica-of") && vm["wal-ship-port"].as<uint16_t>() != 0) {
+    LOG(ERROR) << "A read-only replica can not ship wal";
+    return -1;
+  }
 
   setenv("TZ", "Asia/Shanghai", 1);
   tzset();
@@ -83,8 +117,20 @@ int main(int argc, char** argv) {
   auto& db = gs::GraphDB::get();
 
   auto ret = gs::Schema::LoadFromYaml(graph_schema_path, bulk_load_config_path);
+  db.SetWalCompression(vm.count("wal-compression") != 0);
+  db.SetVertexReordering(vm.count("reorder-vertices") != 0);
   db.Init(std::get<0>(ret), std::get<1>(ret), std::get<2>(ret),
-          std::get<3>(ret), data_path, shard_num);
+          std::get<3>(ret), data_path, shard_num + offload_threads,
+          vm["wal-batch-size"].as<size_t>(),
+          vm["wal-batch-delay-us"].as<uint32_t>(),
+          vm["checkpoint-interval"].as<uint32_t>(),
+          vm["compaction-interval"].as<uint32_t>(),
+          vm["history-retention"].as<uint32_t>(),
+          vm["wal-ship-port"].as<uint16_t>());
+  db.SetResultCacheCapacity(vm["result-cache-mb"].as<size_t>() << 20);
+  if (vm.count("replica-of")) {
+    db.StartReplication(vm["replica-of"].as<std::string>());
+  }
 
   t0 += grape::GetCurrentTime();
 
@@ -92,7 +138,13 @@ int main(int argc, char** argv) {
 
   // start service
   LOG(INFO) << "GraphScope http server start to listen on port " << http_port;
-  server::GraphDBService::get().init(shard_num, http_port, enable_dpdk);
+  uint16_t binary_port = vm["binary-port"].as<uint16_t>();
+  if (binary_port != 0) {
+    LOG(INFO) << "GraphScope binary server start to listen on port "
+              << binary_port;
+  }
+  server::GraphDBService::get().init(shard_num, http_port, enable_dpdk,
+                                     offload_threads, binary_port);
   server::GraphDBService::get().run_and_wait_for_exit();
 
   return 0;
@@ -21,7 +21,10 @@
 
 #include "flex/engines/hqps_db/database/mutable_csr_interface.h"
 #include "flex/engines/http_server/codegen_proxy.h"
+#include "flex/engines/http_server/result_cursors.h"
 #include "flex/engines/http_server/stored_procedure.h"
+#include "flex/utils/numa.h"
+#include "flex/utils/query_memory.h"
 
 #include <yaml-cpp/yaml.h>
 #include <boost/program_options.hpp>
@@ -88,10 +91,49 @@ int main(int argc, char** argv) {
       bpo::value<std::string>()->default_value("/tmp/codegen/"),
       "codegen working directory")("codegen-bin,b", bpo::value<std::string>(),
                                    "codegen binary path")(
+      "codegen-threads", bpo::value<size_t>()->default_value(2),
+      "number of adhoc queries compiled concurrently")(
+      "cursor-budget",
+      bpo::value<size_t>()->default_value(
+          server::ResultCursors::kDefaultBudget),
+      "max bytes of the results spooled for queries paged through")(
+      "cursor-ttl",
+      bpo::value<uint32_t>()->default_value(
+          server::ResultCursors::kDefaultTtlSeconds),
+      "seconds a cursor of paged results is kept unread")(
       "db-home", bpo::value<std::string>(), "db home path")(
       "graph-config,g", bpo::value<std::string>(), "graph schema config file")(
       "data-path,d", bpo::value<std::string>(), "data directory path")(
-      "bulk-load,l", bpo::value<std::string>(), "bulk-load config file");
+      "bulk-load,l", bpo::value<std::string>(), "bulk-load config file")(
+      "wal-batch-size", bpo::value<size_t>()->default_value(1),
+      "max number of wal records per fsync, >1 enables group commit")(
+      "wal-batch-delay-us", bpo::value<uint32_t>()->default_value(200),
+      "max delay in microseconds of a group commit batch")(
+      "checkpoint-interval", bpo::value<uint32_t>()->default_value(0),
+      "interval in seconds of background checkpoints, 0 disables them")(
+      "compaction-interval", bpo::value<uint32_t>()->default_value(0),
+      "interval in seconds of background adjacency list compactions, 0 "
+      "disables them")(
+      "history-retention", bpo::value<uint32_t>()->default_value(0),
+      "number of past timestamps served to reads with an as-of timestamp, 0 "
+      "disables them")(
+      "wal-ship-port", bpo::value<uint16_t>()->default_value(0),
+      "port to stream the wal to read-only replicas on, 0 disables it")(
+      "replica-of", bpo::value<std::string>(),
+      "host:port of the primary to follow as a read-only replica")(
+      "numa-interleave",
+      "interleave the memory of the graph across all numa nodes")(
+      "partition-id", bpo::value<uint32_t>()->default_value(0),
+      "partition of the edges to bulk load")(
+      "partition-num", bpo::value<uint32_t>()->default_value(1),
+      "number of servers the edges are partitioned across")(
+      "query-memory-mb", bpo::value<size_t>()->default_value(0),
+      "megabytes of memory a cypher query may take for sorts and group bys, "
+      "sorts beyond it spill to disk and group bys fail, 0 disables the "
+      "limit")(
+      "spill-dir", bpo::value<std::string>()->default_value(""),
+      "directory of the runs sorts spill to, e.g. on a local nvme, the "
+      "system temporary one if empty");
 
   setenv("TZ", "Asia/Shanghai", 1);
   tzset();
@@ -201,13 +243,35 @@ int main(int argc, char** argv) {
   if (vm.count("bulk-load")) {
     bulk_load_config_path = vm["bulk-load"].as<std::string>();
   }
+  if (vm.count("replica-of") && vm["wal-ship-port"].as<uint16_t>() != 0) {
+    LOG(ERROR) << "A read-only replica can not ship wal";
+    return -1;
+  }
+
+  gs::set_numa_interleave(vm.count("numa-interleave") != 0);
+  if (vm["partition-id"].as<uint32_t>() >=
+      vm["partition-num"].as<uint32_t>()) {
+    LOG(ERROR) << "partition-id must be less than partition-num";
+    return -1;
+  }
 
   double t0 = -grape::GetCurrentTime();
   auto& db = gs::GraphDB::get();
+  db.SetPartition(vm["partition-id"].as<uint32_t>(),
+                  vm["partition-num"].as<uint32_t>());
 
   auto ret = gs::Schema::LoadFromYaml(graph_schema_path, bulk_load_config_path);
   db.Init(std::get<0>(ret), std::get<1>(ret), std::get<2>(ret),
-          std::get<3>(ret), data_path, shard_num);
+          std::get<3>(ret), data_path, shard_num,
+          vm["wal-batch-size"].as<size_t>(),
+          vm["wal-batch-delay-us"].as<uint32_t>(),
+          vm["checkpoint-interval"].as<uint32_t>(),
+          vm["compaction-interval"].as<uint32_t>(),
+          vm["history-retention"].as<uint32_t>(),
+          vm["wal-ship-port"].as<uint16_t>());
+  if (vm.count("replica-of")) {
+    db.StartReplication(vm["replica-of"].as<std::string>());
+  }
 
   t0 += grape::GetCurrentTime();
 
@@ -228,8 +292,13 @@ int main(int argc, char** argv) {
     LOG(INFO) << "db-home: " << db_home;
   }
 
-  server::CodegenProxy::get().Init(codegen_dir, codegen_bin, db_home);
+  server::CodegenProxy::get().Init(codegen_dir, codegen_bin, db_home,
+                                   vm["codegen-threads"].as<size_t>());
 
+  server::ResultCursors::get().Init(vm["cursor-budget"].as<size_t>(),
+                                    vm["cursor-ttl"].as<uint32_t>());
+  gs::QueryMemory::Configure(vm["query-memory-mb"].as<size_t>() << 20,
+                             vm["spill-dir"].as<std::string>());
   server::HQPSService::get().init(shard_num, http_port, false);
   server::HQPSService::get().run_and_wait_for_exit();
 
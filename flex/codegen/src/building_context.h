@@ -133,6 +133,7 @@ class BuildingContext {
         mapper_var_id_(0),
         expr_id_(0),
         ctx_prefix_(ctx_prefix),
+        approximate_(false),
         alias_size_(0) {
     if (storage_type == StorageBackend::kGrape) {
       graph_header_ = GRAPE_INTERFACE_HEADER;
@@ -157,6 +158,7 @@ class BuildingContext {
         mapper_var_id_(0),
         expr_id_(0),
         ctx_prefix_(ctx_prefix),
+        approximate_(false),
         alias_size_(0) {}
 
   // int32_t GetCurrentCtxId() const { return ctx_id_; }
@@ -336,6 +338,12 @@ class BuildingContext {
 
   bool ContainHead() const { return contain_head_; }
 
+  // Whether the query asks for approximate results, e.g. by sampling an
+  // expand, so that aggregates may be estimated as well.
+  void SetApproximate(bool approximate) { approximate_ = approximate; }
+
+  bool Approximate() const { return approximate_; }
+
   void SetHeadType(int32_t data_type, std::vector<int32_t> label_list) {
     head_type_ = std::make_pair(data_type, label_list);
   };
@@ -438,6 +446,7 @@ class BuildingContext {
   TagIndMapping tag_ind_mapping_;
 
   bool contain_head_;
+  bool approximate_;
   std::pair<int32_t, std::vector<int32_t>> head_type_;
   int32_t alias_size_;
   std::vector<int32_t> tag_index_;
@@ -55,6 +55,19 @@ static constexpr const char* EDGE_EXPAND_E_OPT_NO_FILTER_TEMPLATE_STR =
 static constexpr const char* EDGE_EXPANDV_OP_TEMPLATE_STR =
     "auto %1% = Engine::template EdgeExpandV<%2%, %3%>(%4%, %5%, %6%);\n";
 
+static constexpr const char* SAMPLE_EDGE_EXPANDV_OP_TEMPLATE_STR =
+    "auto %1% = Engine::template SampleEdgeExpandV<%2%, %3%>(%4%, %5%, %6%, "
+    "gs::make_sample_opt(%7%, %8%));\n";
+
+// Keys in the extra of the query params of an expand to vertices, by which a
+// query asks for the neighbors of each vertex to be sampled.
+static constexpr const char* SAMPLE_FANOUT_KEY = "sample_fanout";
+static constexpr const char* SAMPLE_SEED_KEY = "sample_seed";
+
+static constexpr const char* EDGE_EXPANDV_FILTER_OP_TEMPLATE_STR =
+    "auto %1% = Engine::template EdgeExpandVFilter<%2%, %3%>(%4%, %5%, %6%, "
+    "%7%);\n";
+
 static constexpr const char* EDGE_EXPANDE_OP_TEMPLATE_STR =
     "auto %1% = Engine::template EdgeExpandE<%2%,%3%>(%4%, %5%, %6%);\n";
 
@@ -234,6 +247,13 @@ class EdgeExpandOpBuilder {
     return *this;
   }
 
+  // the opt of a filtering GetV fused into this expand, whose filter is
+  // applied on the expanded vertices.
+  EdgeExpandOpBuilder& getVOpt(const std::string& get_v_opt_name) {
+    get_v_opt_name_ = get_v_opt_name;
+    return *this;
+  }
+
   EdgeExpandOpBuilder& query_params(const algebra::QueryParams& query_params) {
     query_params_ = query_params;
     return *this;
@@ -332,10 +352,19 @@ class EdgeExpandOpBuilder {
 
     std::string prev_ctx_name, next_ctx_name;
     std::tie(prev_ctx_name, next_ctx_name) = ctx_.GetPrevAndNextCtxName();
+    auto& extra = query_params_.extra();
+    bool sample =
+        expand_opt_ ==
+            physical::EdgeExpand::ExpandOpt::EdgeExpand_ExpandOpt_VERTEX &&
+        get_v_opt_name_.empty() && extra.count(SAMPLE_FANOUT_KEY) > 0;
     boost::format formater("");
     if (expand_opt_ ==
         physical::EdgeExpand::ExpandOpt::EdgeExpand_ExpandOpt_EDGE) {
       formater = boost::format(EDGE_EXPANDE_OP_TEMPLATE_STR);
+    } else if (sample) {
+      formater = boost::format(SAMPLE_EDGE_EXPANDV_OP_TEMPLATE_STR);
+    } else if (!get_v_opt_name_.empty()) {
+      formater = boost::format(EDGE_EXPANDV_FILTER_OP_TEMPLATE_STR);
     } else {
       formater = boost::format(EDGE_EXPANDV_OP_TEMPLATE_STR);
     }
@@ -343,6 +372,17 @@ class EdgeExpandOpBuilder {
     auto append_opt = res_alias_to_append_opt(res_alias_);
     formater % next_ctx_name % append_opt % format_input_col(v_tag_) %
         ctx_.GraphVar() % make_move(prev_ctx_name) % make_move(opt_name);
+    if (!get_v_opt_name_.empty()) {
+      CHECK(expand_opt_ ==
+            physical::EdgeExpand::ExpandOpt::EdgeExpand_ExpandOpt_VERTEX);
+      formater % make_move(get_v_opt_name_);
+    }
+    if (sample) {
+      auto seed = extra.find(SAMPLE_SEED_KEY);
+      formater % std::stoul(extra.at(SAMPLE_FANOUT_KEY)) %
+          (seed == extra.end() ? 0ul : std::stoul(seed->second));
+      ctx_.SetApproximate(true);
+    }
 
     return opt_code + formater.str();
   }
@@ -355,6 +395,7 @@ class EdgeExpandOpBuilder {
   internal::Direction direction_;
   std::vector<LabelT> dst_vertex_labels_;
   std::vector<LabelT> get_v_vertex_labels_;
+  std::string get_v_opt_name_;
   int32_t v_tag_;
   physical::PhysicalOpr::MetaData meta_data_;
 };
@@ -385,11 +426,14 @@ static std::string BuildEdgeExpandOp(
 // build edge expand op with dst vertex labels.
 // the extra dst_vertex_labels are extracted from get_v, It can be a larger
 // collection or a smaller collection.
+// If get_v_opt_name is given, the filter of that GetV opt is applied on the
+// expanded vertices.
 template <typename LabelT>
 static std::string BuildEdgeExpandOp(
     BuildingContext& ctx, const physical::EdgeExpand& edge_expand,
     const physical::PhysicalOpr::MetaData& meta_data,
-    std::vector<LabelT> dst_vertex_labels) {
+    std::vector<LabelT> dst_vertex_labels,
+    const std::string& get_v_opt_name = "") {
   VLOG(10) << "Building Edge Expand Op: " << edge_expand.DebugString();
   EdgeExpandOpBuilder<LabelT> builder(ctx);
   if (edge_expand.has_alias()) {
@@ -398,6 +442,7 @@ static std::string BuildEdgeExpandOp(
     builder.resAlias(-1);
   }
   builder.dstVertexLabels(dst_vertex_labels)
+      .getVOpt(get_v_opt_name)
       .query_params(edge_expand.params())
       .expand_opt(edge_expand.expand_opt())
       .direction(edge_expand.direction());
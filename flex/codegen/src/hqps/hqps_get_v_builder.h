@@ -44,6 +44,9 @@ static constexpr const char* GET_V_FILTER_TEMPLATE_STR =
     "auto %5% = make_getv_opt(%6%, %7%, std::move(%1%));\n"
     "auto %8% = Engine::template GetV<%9%,%10%>(%11%, std::move(%12%), "
     "std::move(%5%));\n";
+static constexpr const char* GET_V_FILTER_OPT_TEMPLATE_STR =
+    "auto %1% = gs::make_filter(%2%(%3%), %4%);\n"
+    "auto %5% = make_getv_opt(%6%, %7%, std::move(%1%));\n";
 
 namespace internal {
 enum class GetVType {
@@ -172,29 +175,8 @@ class GetVOpBuilder {
       boost::format formater(GET_V_FILTER_TEMPLATE_STR);
       // with filter
       std::string expr_var_name = ctx_.GetNextExprVarName();
-      std::string expr_call_str;
-      std::string selectors_str;
-      {
-        std::stringstream ss;
-        for (int i = 0; i < expr_call_param_.size(); ++i) {
-          ss << expr_call_param_[i].var_name;
-          if (i != expr_call_param_.size() - 1) {
-            ss << ", ";
-          }
-        }
-        expr_call_str = ss.str();
-      }
-      {
-        std::stringstream ss;
-        for (int i = 0; i < tag_propertys_.size(); ++i) {
-          ss << tag_propertys_[i].second;
-          if (i != tag_propertys_.size() - 1) {
-            ss << ", ";
-          }
-        }
-        selectors_str = ss.str();
-      }
-      formater % expr_var_name % expr_name_ % expr_call_str % selectors_str %
+      formater % expr_var_name % expr_name_ % expr_call_str() %
+          selectors_str() %
           get_v_opt_var % internal::get_v_type_2_str(v_opt_) %
           label_ids_to_array_str(tmp) % next_ctx_name % append_opt %
           input_col_str % ctx_.GraphVar() % prev_ctx_name;
@@ -205,7 +187,44 @@ class GetVOpBuilder {
     return get_v_code;
   }
 
+  // Only the GetV opt with its filter, for the GetV to be fused into the edge
+  // expand before it, which then applies the filter on the expanded
+  // vertices. Returns the var name of the opt and the code.
+  std::pair<std::string, std::string> BuildFilterOpt() const {
+    CHECK(!expr_name_.empty()) << "GetV has no filter to fuse";
+    std::string get_v_opt_var = ctx_.GetNextGetVOptName();
+    std::string expr_var_name = ctx_.GetNextExprVarName();
+    std::vector<LabelT> tmp = remove_duplicate(vertex_labels_);
+    boost::format formater(GET_V_FILTER_OPT_TEMPLATE_STR);
+    formater % expr_var_name % expr_name_ % expr_call_str() %
+        selectors_str() % get_v_opt_var % internal::get_v_type_2_str(v_opt_) %
+        label_ids_to_array_str(tmp);
+    return std::make_pair(get_v_opt_var, formater.str());
+  }
+
  private:
+  std::string expr_call_str() const {
+    std::stringstream ss;
+    for (int i = 0; i < expr_call_param_.size(); ++i) {
+      ss << expr_call_param_[i].var_name;
+      if (i != expr_call_param_.size() - 1) {
+        ss << ", ";
+      }
+    }
+    return ss.str();
+  }
+
+  std::string selectors_str() const {
+    std::stringstream ss;
+    for (int i = 0; i < tag_propertys_.size(); ++i) {
+      ss << tag_propertys_[i].second;
+      if (i != tag_propertys_.size() - 1) {
+        ss << ", ";
+      }
+    }
+    return ss.str();
+  }
+
   BuildingContext& ctx_;
   internal::GetVType v_opt_;
   int32_t in_tag_id_, out_tag_id_;
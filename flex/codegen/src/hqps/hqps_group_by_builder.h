@@ -72,6 +72,13 @@ std::pair<std::string, std::string> gen_agg_var_and_code(
     BuildingContext& ctx, TagIndMapping& new_mapping,
     const physical::GroupBy::AggFunc& agg_func) {
   auto agg_func_name = agg_func_pb_2_str(agg_func.aggregate());
+  // distinct vertices are estimated when the query asks for approximation
+  if (ctx.Approximate() &&
+      agg_func.aggregate() == physical::GroupBy::AggFunc::Aggregate::
+                                  GroupBy_AggFunc_Aggregate_COUNT_DISTINCT &&
+      agg_func.vars_size() == 1 && !agg_func.vars(0).has_property()) {
+    agg_func_name = "gs::AggFunc::APPROX_COUNT_DISTINCT";
+  }
   auto cur_var_name = ctx.GetNextAggFuncName();
   std::vector<int32_t> in_tags;
   std::vector<std::string> in_prop_names;
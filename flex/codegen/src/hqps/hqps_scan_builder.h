@@ -23,6 +23,7 @@ limitations under the License.
 #include "flex/codegen/src/building_context.h"
 #include "flex/codegen/src/codegen_utils.h"
 #include "flex/codegen/src/graph_types.h"
+#include "flex/codegen/src/hqps/hqps_expr_builder.h"
 #include "flex/codegen/src/pb_parser/query_params_parser.h"
 #include "proto_generated_gie/algebra.pb.h"
 #include "proto_generated_gie/common.pb.h"
@@ -44,6 +45,16 @@ static constexpr const char* SCAN_OP_TEMPLATE_STR =
     "auto %1% = gs::make_filter(%2%(%3%), %4%);\n"
     "auto %5% = Engine::template ScanVertex<%6%>(%7%, %8%, std::move(%1%));\n";
 
+/// Args
+/// 1-8. as SCAN_OP_TEMPLATE_STR
+/// 9. property name
+/// 10. comparison, gs::IndexCmp
+/// 11. value compared with
+static constexpr const char* SCAN_OP_WITH_INDEX_TEMPLATE_STR =
+    "auto %1% = gs::make_filter(%2%(%3%), %4%);\n"
+    "auto %5% = Engine::template ScanVertexWithIndex<%6%>(%7%, %8%, \"%9%\", "
+    "gs::make_scan_range(%10%, %11%), std::move(%1%));\n";
+
 /// Args
 /// 1. res_ctx_name
 /// 2. AppendOpt,
@@ -158,6 +169,20 @@ class ScanOpBuilder {
           selectors_str = ss.str();
         }
 
+        // a comparison of one property may be served by its index, which
+        // the engine uses if the property has one
+        std::string prop_name;
+        common::Logical cmp;
+        common::ExprOpr value;
+        if (labels_ids.size() == 1 &&
+            try_to_get_index_cond_from_expr(predicate, prop_name, cmp,
+                                            value)) {
+          VLOG(10) << "Scan with index of " << prop_name;
+          return scan_with_index(labels_ids[0], expr_var_name, expr_func_name,
+                                 expr_construct_params, selectors_str,
+                                 prop_name, cmp, value);
+        }
+
         // use expression to filter.
         return scan_with_expr(labels_ids, expr_var_name, expr_func_name,
                               expr_construct_params, selectors_str);
@@ -220,6 +245,49 @@ class ScanOpBuilder {
         ctx_.GraphVar() % label_ids_str;
     return formater.str();
   }
+  std::string scan_with_index(int32_t label_id,
+                              const std::string& expr_var_name,
+                              const std::string& expr_func_name,
+                              const std::string& expr_construct_params,
+                              const std::string& selectors_str,
+                              const std::string& prop_name,
+                              common::Logical cmp,
+                              const common::ExprOpr& value) const {
+    std::string next_ctx_name = ctx_.GetCurCtxName();
+    std::string cmp_str;
+    switch (cmp) {
+    case common::Logical::EQ:
+      cmp_str = "gs::IndexCmp::kEq";
+      break;
+    case common::Logical::LT:
+      cmp_str = "gs::IndexCmp::kLt";
+      break;
+    case common::Logical::LE:
+      cmp_str = "gs::IndexCmp::kLe";
+      break;
+    case common::Logical::GT:
+      cmp_str = "gs::IndexCmp::kGt";
+      break;
+    default:
+      cmp_str = "gs::IndexCmp::kGe";
+      break;
+    }
+    std::string value_str;
+    if (value.item_case() == common::ExprOpr::kConst) {
+      value_str = value_pb_to_str(value.const_());
+    } else {
+      codegen::ParamConst param_const;
+      parse_param_const_from_pb(value.param(), value.node_type(), param_const);
+      value_str = param_const.var_name;
+    }
+
+    boost::format formater(SCAN_OP_WITH_INDEX_TEMPLATE_STR);
+    formater % expr_var_name % expr_func_name % expr_construct_params %
+        selectors_str % next_ctx_name % res_alias_to_append_opt(res_alias_) %
+        ctx_.GraphVar() % label_id % prop_name % cmp_str % value_str;
+    return formater.str();
+  }
+
   BuildingContext& ctx_;
   physical::Scan::ScanOpt scan_opt_;
   algebra::QueryParams query_params_;
@@ -41,8 +41,7 @@ static constexpr const char* QUERY_TEMPLATE_STR =
     "// This file is generated by codegen/query_generator.h\n"
     "// DO NOT EDIT\n"
     "\n"
-    "#include \"flex/engines/hqps_db/core/sync_engine.h\"\n"
-    "#include \"flex/engines/hqps_db/app/hqps_app_base.h\"\n"  // app_base_header.h
+    "#include \"flex/engines/hqps_db/hqps_runtime.h\"\n"
     "#include \"%1%\"\n"  // graph_interface_header.h
     "\n"
     "\n"
@@ -62,6 +61,9 @@ static constexpr const char* QUERY_TEMPLATE_STR =
     "  }\n"
     "// Wrapper query function for query class\n"
     "  %5% Query(const %4%& %6%, Decoder& decoder) const override {\n"
+    "    // intermediate results are freed at once when the query returns\n"
+    "    QueryArenaScope arena_scope;\n"
+    "    HQPS_PROFILE_QUERY(\"%3%\");\n"
     "    //decoding params from decoder, and call real query func\n"
     "    %9%\n"
     "    return Query(%6% %10%);\n"
@@ -122,6 +124,29 @@ bool intermeidate_edge_op(const physical::EdgeExpand& expand_op) {
   return false;
 }
 
+// Whether the predicate of get_v only reads properties of the vertex it gets,
+// by key, so that it can be evaluated on the expanded vertices before they are
+// added to the context.
+bool head_only_get_v_filter(const physical::GetV& get_v_op) {
+  if (!get_v_op.params().has_predicate() || get_v_op.has_tag()) {
+    return false;
+  }
+  for (auto& opr : get_v_op.params().predicate().operators()) {
+    if (opr.item_case() == common::ExprOpr::kVars ||
+        opr.item_case() == common::ExprOpr::kVarMap) {
+      return false;
+    }
+    if (opr.item_case() == common::ExprOpr::kVar) {
+      auto& var = opr.var();
+      if (var.has_tag() || !var.has_property() ||
+          var.property().item_case() != common::Property::kKey) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
 template <typename LabelT>
 void extract_vertex_labels(const physical::GetV& get_v_op,
                            std::vector<LabelT>& vertex_labels) {
@@ -152,6 +177,34 @@ void build_fused_edge_get_v(
      << std::endl;
 }
 
+// The edge expand is fused with a get_v with a filter, by expanding to the
+// vertices that pass the filter in one operator.
+template <typename LabelT>
+void build_fused_edge_get_v_filter(
+    BuildingContext& ctx, std::stringstream& ss,
+    physical::EdgeExpand& edge_expand_op,
+    const physical::PhysicalOpr::MetaData& edge_meta_data,
+    const physical::GetV& get_v_op, const std::vector<LabelT>& vertex_labels) {
+  CHECK(vertex_labels.size() == 1);
+  GetVOpBuilder<LabelT> get_v_builder(ctx);
+  get_v_builder.v_opt(get_v_op.opt());
+  for (auto vertex_label_pb : get_v_op.params().tables()) {
+    get_v_builder.add_vertex_label(vertex_label_pb);
+  }
+  std::string get_v_opt_name, get_v_opt_code;
+  std::tie(get_v_opt_name, get_v_opt_code) =
+      get_v_builder.filter(get_v_op.params().predicate()).BuildFilterOpt();
+
+  edge_expand_op.set_expand_opt(
+      physical::EdgeExpand::ExpandOpt::EdgeExpand_ExpandOpt_VERTEX);
+  edge_expand_op.mutable_alias()->set_value(get_v_op.alias().value());
+  ss << _4_SPACES << get_v_opt_code;
+  ss << _4_SPACES
+     << BuildEdgeExpandOp<LabelT>(ctx, edge_expand_op, edge_meta_data,
+                                  vertex_labels, get_v_opt_name)
+     << std::endl;
+}
+
 // Entrance for generating a parameterized query
 // The generated class will have two function
 // 1. Query(GraphInterface& graph, int64_t ts, Decoder& input) const override
@@ -290,6 +343,13 @@ class QueryGenerator {
       // meta_datas.size();
       // physical::PhysicalOpr::MetaData meta_data; //fake meta
       auto opr = op.opr();
+      // the sink returns, and repartitions generate no code
+      bool profiled =
+          opr.op_kind_case() != physical::PhysicalOpr::Operator::kSink &&
+          opr.op_kind_case() != physical::PhysicalOpr::Operator::kRepartition;
+      if (profiled) {
+        ss << "HQPS_PROFILE_OP_BEGIN();" << std::endl;
+      }
       switch (opr.op_kind_case()) {
       case physical::PhysicalOpr::Operator::kScan: {  // scan
         // TODO: meta_data is not found in scan
@@ -324,6 +384,16 @@ class QueryGenerator {
                 LOG(INFO) << "Fuse edge expand and get_v since get_v is simple";
                 i += 1;
                 break;
+              } else if (intermeidate_edge_op(real_edge_expand) &&
+                         !real_edge_expand.params().has_predicate() &&
+                         dst_vertex_labels.size() == 1 &&
+                         head_only_get_v_filter(get_v_op)) {
+                build_fused_edge_get_v_filter<LabelT>(
+                    ctx_, ss, real_edge_expand, meta_datas[0], get_v_op,
+                    dst_vertex_labels);
+                LOG(INFO) << "Fuse edge expand and get_v with its filter";
+                i += 1;
+                break;
               } else if (intermeidate_edge_op(real_edge_expand)) {
                 LOG(INFO) << "try to fuse edge expand with complex get_v, take "
                              "take the get_v' vertex label";
@@ -503,6 +573,13 @@ class QueryGenerator {
       default:
         LOG(FATAL) << "Unsupported operator type: " << opr.op_kind_case();
       }
+      if (profiled) {
+        auto op_name = physical::PhysicalOpr::Operator::descriptor()
+                           ->FindFieldByNumber(opr.op_kind_case())
+                           ->name();
+        ss << "HQPS_PROFILE_OP_END(\"" << op_name << "\", "
+           << ctx_.GetCurCtxName() << ");" << std::endl;
+      }
     }
     LOG(INFO) << "Finish adding query";
     return ss.str();
@@ -222,6 +222,69 @@ bool try_to_get_oid_param_from_expr(const common::Expression& expression,
   return try_to_get_oid_param_from_expr_impl(new_expr, param_const);
 }
 
+bool try_to_get_index_cond_from_expr_impl(const common::Expression& expression,
+                                          std::string& prop_name,
+                                          common::Logical& cmp,
+                                          common::ExprOpr& value) {
+  if (expression.operators_size() != 3) {
+    return false;
+  }
+  auto& left = expression.operators(0);
+  auto& mid = expression.operators(1);
+  auto& right = expression.operators(2);
+  if (!left.has_var() || left.var().has_tag() ||
+      !left.var().has_property() || !left.var().property().has_key() ||
+      left.var().property().key().item_case() != common::NameOrId::kName) {
+    VLOG(10) << "left item is not a property of the scanned vertex";
+    return false;
+  }
+  if (mid.item_case() != common::ExprOpr::kLogical) {
+    return false;
+  }
+  cmp = mid.logical();
+  if (cmp != common::Logical::EQ && cmp != common::Logical::LT &&
+      cmp != common::Logical::LE && cmp != common::Logical::GT &&
+      cmp != common::Logical::GE) {
+    VLOG(10) << "mid item is not a comparison";
+    return false;
+  }
+  if (right.item_case() == common::ExprOpr::kConst) {
+    auto item_case = right.const_().item_case();
+    if (item_case != common::Value::kI32 && item_case != common::Value::kI64 &&
+        item_case != common::Value::kF64 && item_case != common::Value::kStr) {
+      VLOG(10) << "right value can not be looked up in an index";
+      return false;
+    }
+  } else if (right.item_case() != common::ExprOpr::kParam) {
+    VLOG(10) << "right item is not const or param";
+    return false;
+  }
+  prop_name = left.var().property().key().name();
+  value = right;
+  return true;
+}
+
+// Parse `prop cmp value` from a predicate, for scans through the index of
+// prop. Like try_to_get_oid_from_expr, the predicate is of 3 ops, or of 11
+// ops with a condition on labels.
+bool try_to_get_index_cond_from_expr(const common::Expression& expression,
+                                     std::string& prop_name,
+                                     common::Logical& cmp,
+                                     common::ExprOpr& value) {
+  auto num_oprs = expression.operators_size();
+  if (num_oprs == 3) {
+    return try_to_get_index_cond_from_expr_impl(expression, prop_name, cmp,
+                                                value);
+  } else if (num_oprs != 11) {
+    return false;
+  }
+  common::Expression new_expr;
+  new_expr.add_operators()->CopyFrom(expression.operators(7));
+  new_expr.add_operators()->CopyFrom(expression.operators(8));
+  new_expr.add_operators()->CopyFrom(expression.operators(9));
+  return try_to_get_index_cond_from_expr_impl(new_expr, prop_name, cmp, value);
+}
+
 }  // namespace gs
 
 #endif  // CODEGEN_SRC_PB_PARSER_QUERY_PARAMS_PARSER_H_
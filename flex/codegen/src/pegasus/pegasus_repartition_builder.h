@@ -31,6 +31,76 @@ limitations under the License.
 
 namespace gs {
 namespace pegasus {
+
+// How the code of a repartition in the plan is generated.
+enum class RepartitionAction {
+  // Shuffle the records by the key, as planned.
+  kShuffle = 0,
+  // The records are already on the servers owning their keys, e.g. right
+  // after a scan, or a shuffle by the same key, so they stay in place.
+  kSkip = 1,
+  // Shuffle after the GetV that follows instead. The GetV keeps the id of
+  // the head and reads no property, so it needs no locality, and the records
+  // it filters out by label are not shuffled. The shuffle lands the records
+  // where the planned one would, and a later one by the head is skipped.
+  kDeferPastGetV = 2,
+};
+
+// Whether a repartition by the head may be deferred past the GetV.
+static bool can_defer_repartition_past(const physical::GetV& get_v_pb) {
+  auto opt = get_v_pb.opt();
+  return !get_v_pb.has_tag() &&
+         get_v_pb.params().predicate().operators().empty() &&
+         (opt == physical::GetV_VOpt_END || opt == physical::GetV_VOpt_OTHER ||
+          opt == physical::GetV_VOpt_ITSELF);
+}
+
+// Decide the action of each repartition of the plan, indexed by operator,
+// by tracking the key the records are partitioned by. Scans emit the
+// vertices of their own servers, selects keep the records in place, and any
+// other operator may change the key.
+static std::vector<RepartitionAction> PlanRepartitions(
+    const physical::PhysicalPlan& plan) {
+  // the tag of the partition key, the head being -1
+  static constexpr int32_t kUnknownKey = -2;
+  std::vector<RepartitionAction> actions(plan.plan_size(),
+                                         RepartitionAction::kShuffle);
+  int32_t key = kUnknownKey;
+  for (auto i = 0; i < plan.plan_size(); ++i) {
+    auto& opr = plan.plan(i).opr();
+    switch (opr.op_kind_case()) {
+    case physical::PhysicalOpr::Operator::kScan: {
+      key = -1;
+      break;
+    }
+    case physical::PhysicalOpr::Operator::kRepartition: {
+      auto& to_another = opr.repartition().to_another();
+      int32_t shuffle_key =
+          to_another.has_shuffle_key() ? to_another.shuffle_key().value() : -1;
+      if (shuffle_key == key) {
+        actions[i] = RepartitionAction::kSkip;
+      } else if (shuffle_key == -1 && i + 1 < plan.plan_size() &&
+                 plan.plan(i + 1).opr().has_vertex() &&
+                 can_defer_repartition_past(plan.plan(i + 1).opr().vertex())) {
+        actions[i] = RepartitionAction::kDeferPastGetV;
+        // the GetV keeps the head, which the deferred shuffle is by
+        ++i;
+        key = -1;
+      } else {
+        key = shuffle_key;
+      }
+      break;
+    }
+    case physical::PhysicalOpr::Operator::kSelect: {
+      break;
+    }
+    default:
+      key = kUnknownKey;
+    }
+  }
+  return actions;
+}
+
 class PepartitionOpBuilder {
  public:
   PepartitionOpBuilder(BuildingContext& ctx) : ctx_(ctx) {}
@@ -45,6 +115,13 @@ class PepartitionOpBuilder {
     return *this;
   }
 
+  // Shuffle the output stream of the operator itself, rather than that of
+  // the previous one.
+  PepartitionOpBuilder& rebind() {
+    rebind_ = true;
+    return *this;
+  }
+
   // return make_project code and call project code.
   std::string Build() const {
     boost::format repartition_fmter(
@@ -58,7 +135,8 @@ class PepartitionOpBuilder {
     } else {
       index = ctx_.GetAliasIndex(in_tag_);
     }
-    repartition_fmter % operator_index_ % (operator_index_ - 1) % index;
+    repartition_fmter % operator_index_ %
+        (rebind_ ? operator_index_ : operator_index_ - 1) % index;
     return repartition_fmter.str();
   }
 
@@ -66,6 +144,7 @@ class PepartitionOpBuilder {
   BuildingContext& ctx_;
   int32_t operator_index_;
   int32_t in_tag_ = -1;
+  bool rebind_ = false;
 };
 
 static std::string BuildRepartitionOp(
@@ -78,6 +157,20 @@ static std::string BuildRepartitionOp(
   }
   return builder.operator_index(operator_index).Build();
 }
+
+// A repartition which is skipped, or deferred, passes the stream on.
+static std::string BuildSkippedRepartitionOp(int32_t operator_index) {
+  boost::format skip_fmter("let stream_%1% = stream_%2%;\n");
+  skip_fmter % operator_index % (operator_index - 1);
+  return skip_fmter.str();
+}
+
+// The shuffle by the head of a repartition deferred to the operator.
+static std::string BuildDeferredRepartitionOp(BuildingContext& ctx,
+                                              int32_t operator_index) {
+  PepartitionOpBuilder builder(ctx);
+  return builder.operator_index(operator_index).rebind().Build();
+}
 }  // namespace pegasus
 }  // namespace gs
 
@@ -161,6 +161,7 @@ class PegasusGenerator {
     google::protobuf::util::JsonOptions option;
     option.always_print_primitive_fields = true;
     google::protobuf::util::MessageToJsonString(plan_, &plan_json, option);
+    auto repartition_actions = pegasus::PlanRepartitions(plan_);
     for (auto i = 0; i < size; ++i) {
       auto op = plan_.plan(i);
       LOG(INFO) << "Start codegen for operator " << i;
@@ -187,8 +188,14 @@ class PegasusGenerator {
 
         LOG(INFO) << "Found a repartition operator";
         auto& repartition_op = opr.repartition();
-        auto repartition_codegen =
-            pegasus::BuildRepartitionOp(ctx_, i + 1, repartition_op, meta_data);
+        std::string repartition_codegen;
+        if (repartition_actions[i] == pegasus::RepartitionAction::kShuffle) {
+          repartition_codegen = pegasus::BuildRepartitionOp(
+              ctx_, i + 1, repartition_op, meta_data);
+        } else {
+          LOG(INFO) << "Repartition " << i << " is skipped or deferred";
+          repartition_codegen = pegasus::BuildSkippedRepartitionOp(i + 1);
+        }
         LOG(INFO) << repartition_codegen;
         ss << repartition_codegen;
         break;
@@ -243,6 +250,10 @@ class PegasusGenerator {
         auto& vertex_op = opr.vertex();
         auto vertex_codegen =
             pegasus::BuildGetVOp<uint8_t>(ctx_, i + 1, vertex_op, meta_data);
+        if (i > 0 && repartition_actions[i - 1] ==
+                         pegasus::RepartitionAction::kDeferPastGetV) {
+          vertex_codegen += pegasus::BuildDeferredRepartitionOp(ctx_, i + 1);
+        }
         LOG(INFO) << vertex_codegen;
         ss << vertex_codegen;
 
@@ -0,0 +1,330 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ENGINES_BSP_PROJECTED_FRAGMENT_H_
+#define ENGINES_BSP_PROJECTED_FRAGMENT_H_
+
+#include <vector>
+
+#include <glog/logging.h>
+
+#include "flex/storages/rt_mutable_graph/mutable_property_fragment.h"
+#include "grape/fragment/fragment_base.h"
+#include "grape/types.h"
+#include "grape/utils/vertex_array.h"
+#include "grape/worker/comm_spec.h"
+
+namespace bsp {
+
+namespace projected_fragment_impl {
+
+/**
+ * @brief Edge of the csr visible at the timestamp of the fragment. As in
+ * ArrowProjectedFragment, a Nbr is its own iterator, so that the data is
+ * read straight from the MutableNbr buffers of the csr.
+ */
+template <typename EDATA_T>
+class Nbr {
+  using nbr_t = gs::MutableNbr<EDATA_T>;
+
+ public:
+  Nbr(const nbr_t* ptr, const nbr_t* end, gs::timestamp_t ts)
+      : ptr_(ptr), end_(end), ts_(ts) {
+    skip_invisible();
+  }
+
+  grape::Vertex<gs::vid_t> neighbor() const {
+    return grape::Vertex<gs::vid_t>(ptr_->neighbor);
+  }
+  grape::Vertex<gs::vid_t> get_neighbor() const { return neighbor(); }
+
+  const EDATA_T& data() const { return ptr_->data; }
+  const EDATA_T& get_data() const { return ptr_->data; }
+
+  inline const Nbr& operator++() const {
+    ++ptr_;
+    skip_invisible();
+    return *this;
+  }
+  inline Nbr operator++(int) const {
+    Nbr ret(*this);
+    ++(*this);
+    return ret;
+  }
+
+  inline bool operator==(const Nbr& rhs) const { return ptr_ == rhs.ptr_; }
+  inline bool operator!=(const Nbr& rhs) const { return ptr_ != rhs.ptr_; }
+
+  inline const Nbr& operator*() const { return *this; }
+  inline const Nbr* operator->() const { return this; }
+
+ private:
+  // deleted edges carry the largest timestamp, so they are skipped as well
+  inline void skip_invisible() const {
+    while (ptr_ != end_ && ptr_->timestamp.load() > ts_) {
+      ++ptr_;
+    }
+  }
+
+  mutable const nbr_t* ptr_;
+  const nbr_t* end_;
+  gs::timestamp_t ts_;
+};
+
+template <typename EDATA_T>
+class AdjList {
+  using nbr_t = gs::MutableNbr<EDATA_T>;
+
+ public:
+  AdjList() : begin_(nullptr), end_(nullptr), ts_(0), size_(0) {}
+  AdjList(const gs::MutableNbrSlice<EDATA_T>& slice, gs::timestamp_t ts,
+          size_t size)
+      : begin_(slice.size() == 0 ? nullptr : slice.begin()),
+        end_(slice.size() == 0 ? nullptr : slice.end()),
+        ts_(ts),
+        size_(size) {}
+
+  Nbr<EDATA_T> begin() const { return Nbr<EDATA_T>(begin_, end_, ts_); }
+  Nbr<EDATA_T> end() const { return Nbr<EDATA_T>(end_, end_, ts_); }
+
+  // number of visible edges
+  size_t Size() const { return size_; }
+
+  inline bool Empty() const { return size_ == 0; }
+  inline bool NotEmpty() const { return !Empty(); }
+
+ private:
+  const nbr_t* begin_;
+  const nbr_t* end_;
+  gs::timestamp_t ts_;
+  size_t size_;
+};
+
+}  // namespace projected_fragment_impl
+
+/**
+ * @brief A grape fragment over the edges of one label between vertices of
+ * one label of a MutablePropertyFragment, as visible at a timestamp, so that
+ * the apps in apps.h run on the serving graph without exporting a copy.
+ *
+ * Edges are read from the MutableCsr buffers in place, only the visible
+ * degrees are counted on construction. The fragment is the whole graph, with
+ * no outer vertices, so it can only run on a single worker. EDATA_T must be
+ * the data type of the edge label, and the edge type must not be static.
+ * The read transaction of the timestamp must outlive the fragment, so that
+ * the edges aren't compacted away.
+ */
+template <typename EDATA_T>
+class ProjectedFragment {
+ public:
+  using oid_t = gs::oid_t;
+  using vid_t = gs::vid_t;
+  using vdata_t = grape::EmptyType;
+  using edata_t = EDATA_T;
+  using vertex_t = grape::Vertex<vid_t>;
+  using vertex_range_t = grape::VertexRange<vid_t>;
+  using vertices_t = vertex_range_t;
+  using inner_vertices_t = vertex_range_t;
+  using outer_vertices_t = vertex_range_t;
+  using sub_vertices_t = vertex_range_t;
+  using nbr_t = projected_fragment_impl::Nbr<EDATA_T>;
+  using adj_list_t = projected_fragment_impl::AdjList<EDATA_T>;
+  using const_adj_list_t = adj_list_t;
+
+  template <typename DATA_T>
+  using vertex_array_t = grape::VertexArray<vertices_t, DATA_T>;
+  template <typename DATA_T>
+  using inner_vertex_array_t = grape::VertexArray<inner_vertices_t, DATA_T>;
+  template <typename DATA_T>
+  using outer_vertex_array_t = grape::VertexArray<outer_vertices_t, DATA_T>;
+
+  static constexpr grape::LoadStrategy load_strategy =
+      grape::LoadStrategy::kBothOutIn;
+
+  ProjectedFragment(const gs::MutablePropertyFragment& graph,
+                    gs::timestamp_t ts, gs::label_t vertex_label,
+                    gs::label_t edge_label)
+      : graph_(graph),
+        ts_(ts),
+        vertex_label_(vertex_label),
+        edge_label_(edge_label),
+        ivnum_(graph.vertex_num(vertex_label)),
+        enum_(0) {
+    const auto& schema = graph.schema();
+    CHECK(schema.get_edge_property(vertex_label, vertex_label, edge_label) ==
+          gs::AnyConverter<EDATA_T>::type)
+        << "Edge data type mismatches the projected fragment";
+    CHECK(!schema.is_static_edge(vertex_label, vertex_label, edge_label))
+        << "Static edge types can not be projected";
+    oe_csr_ = graph.get_oe_csr(vertex_label, vertex_label, edge_label);
+    ie_csr_ = graph.get_ie_csr(vertex_label, vertex_label, edge_label);
+    oe_degree_.resize(ivnum_, 0);
+    ie_degree_.resize(ivnum_, 0);
+    for (vid_t v = 0; v < ivnum_; ++v) {
+      oe_degree_[v] = count_visible(oe_csr_, v);
+      ie_degree_[v] = count_visible(ie_csr_, v);
+      enum_ += oe_degree_[v];
+    }
+    fid_ = 0;
+  }
+
+  void PrepareToRunApp(const grape::CommSpec& comm_spec,
+                       grape::PrepareConf conf) {
+    CHECK_EQ(comm_spec.fnum(), 1)
+        << "Projected fragments only run on a single worker";
+  }
+
+  inline grape::fid_t fid() const { return fid_; }
+  inline grape::fid_t fnum() const { return 1; }
+  inline bool directed() const { return true; }
+
+  inline vertex_range_t Vertices() const { return vertex_range_t(0, ivnum_); }
+  inline vertex_range_t InnerVertices() const { return Vertices(); }
+  inline vertex_range_t OuterVertices() const {
+    return vertex_range_t(ivnum_, ivnum_);
+  }
+  inline vertex_range_t OuterVertices(grape::fid_t fid) const {
+    return OuterVertices();
+  }
+  inline const std::vector<vertex_t>& MirrorVertices(grape::fid_t fid) const {
+    return mirrors_;
+  }
+
+  inline vid_t GetInnerVerticesNum() const { return ivnum_; }
+  inline vid_t GetOuterVerticesNum() const { return 0; }
+  inline vid_t GetVerticesNum() const { return ivnum_; }
+  inline size_t GetTotalVerticesNum() const { return ivnum_; }
+  inline size_t GetEdgeNum() const { return enum_; }
+  inline size_t GetOutgoingEdgeNum() const { return enum_; }
+  inline size_t GetIncomingEdgeNum() const { return enum_; }
+
+  inline bool IsInnerVertex(const vertex_t& v) const {
+    return v.GetValue() < ivnum_;
+  }
+  inline bool IsOuterVertex(const vertex_t& v) const { return false; }
+
+  inline bool GetVertex(const oid_t& oid, vertex_t& v) const {
+    vid_t lid;
+    if (!graph_.get_lid(vertex_label_, oid, lid)) {
+      return false;
+    }
+    v.SetValue(lid);
+    return true;
+  }
+  inline bool GetInnerVertex(const oid_t& oid, vertex_t& v) const {
+    return GetVertex(oid, v);
+  }
+  inline bool GetOuterVertex(const oid_t& oid, vertex_t& v) const {
+    return false;
+  }
+
+  inline oid_t GetId(const vertex_t& v) const {
+    return graph_.get_oid(vertex_label_, v.GetValue());
+  }
+  inline oid_t GetInnerVertexId(const vertex_t& v) const { return GetId(v); }
+
+  inline grape::fid_t GetFragId(const vertex_t& v) const { return fid_; }
+
+  inline vdata_t GetData(const vertex_t& v) const { return vdata_t(); }
+
+  // with a single fragment, gids are the vids of the vertex label
+  inline bool Gid2Vertex(const vid_t& gid, vertex_t& v) const {
+    v.SetValue(gid);
+    return gid < ivnum_;
+  }
+  inline bool InnerVertexGid2Vertex(const vid_t& gid, vertex_t& v) const {
+    return Gid2Vertex(gid, v);
+  }
+  inline vid_t Vertex2Gid(const vertex_t& v) const { return v.GetValue(); }
+  inline vid_t GetInnerVertexGid(const vertex_t& v) const {
+    return v.GetValue();
+  }
+  inline bool Oid2Gid(const oid_t& oid, vid_t& gid) const {
+    return graph_.get_lid(vertex_label_, oid, gid);
+  }
+  inline oid_t Gid2Oid(const vid_t& gid) const {
+    return graph_.get_oid(vertex_label_, gid);
+  }
+
+  inline adj_list_t GetOutgoingAdjList(const vertex_t& v) const {
+    return adj_list_t(get_slice(oe_csr_, v.GetValue()), ts_,
+                      oe_degree_[v.GetValue()]);
+  }
+  inline adj_list_t GetIncomingAdjList(const vertex_t& v) const {
+    return adj_list_t(get_slice(ie_csr_, v.GetValue()), ts_,
+                      ie_degree_[v.GetValue()]);
+  }
+  inline adj_list_t GetOutgoingInnerVertexAdjList(const vertex_t& v) const {
+    return GetOutgoingAdjList(v);
+  }
+  inline adj_list_t GetIncomingInnerVertexAdjList(const vertex_t& v) const {
+    return GetIncomingAdjList(v);
+  }
+  inline adj_list_t GetOutgoingOuterVertexAdjList(const vertex_t& v) const {
+    return adj_list_t();
+  }
+  inline adj_list_t GetIncomingOuterVertexAdjList(const vertex_t& v) const {
+    return adj_list_t();
+  }
+
+  inline int GetLocalOutDegree(const vertex_t& v) const {
+    return oe_degree_[v.GetValue()];
+  }
+  inline int GetLocalInDegree(const vertex_t& v) const {
+    return ie_degree_[v.GetValue()];
+  }
+
+  // no other fragment holds mirrors of the vertices
+  inline grape::DestList IEDests(const vertex_t& v) const {
+    return grape::DestList(nullptr, nullptr);
+  }
+  inline grape::DestList OEDests(const vertex_t& v) const {
+    return grape::DestList(nullptr, nullptr);
+  }
+  inline grape::DestList IOEDests(const vertex_t& v) const {
+    return grape::DestList(nullptr, nullptr);
+  }
+
+ private:
+  static gs::MutableNbrSlice<EDATA_T> get_slice(const gs::MutableCsrBase* csr,
+                                                vid_t v) {
+    return gs::MutablePropertyFragment::get_slice<EDATA_T>(csr, v);
+  }
+
+  int count_visible(const gs::MutableCsrBase* csr, vid_t v) const {
+    int ret = 0;
+    for (auto& nbr : get_slice(csr, v)) {
+      ret += (nbr.timestamp.load() <= ts_);
+    }
+    return ret;
+  }
+
+  const gs::MutablePropertyFragment& graph_;
+  gs::timestamp_t ts_;
+  gs::label_t vertex_label_;
+  gs::label_t edge_label_;
+  grape::fid_t fid_;
+  vid_t ivnum_;
+  size_t enum_;
+  const gs::MutableCsrBase* oe_csr_;
+  const gs::MutableCsrBase* ie_csr_;
+  std::vector<int> oe_degree_;
+  std::vector<int> ie_degree_;
+  std::vector<vertex_t> mirrors_;
+};
+
+}  // namespace bsp
+
+#endif  // ENGINES_BSP_PROJECTED_FRAGMENT_H_
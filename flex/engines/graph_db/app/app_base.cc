@@ -20,6 +20,20 @@
 
 namespace gs {
 
+bool AppBase::BatchQuery(std::vector<Decoder>& inputs, Encoder& output) {
+  std::vector<char> buffer;
+  for (auto& input : inputs) {
+    buffer.clear();
+    Encoder encoder(buffer);
+    bool success = Query(input, encoder);
+    output.put_byte(success ? 1 : 0);
+    output.put_string_view(success
+                               ? std::string_view(buffer.data(), buffer.size())
+                               : std::string_view());
+  }
+  return true;
+}
+
 SharedLibraryAppFactory::SharedLibraryAppFactory(const std::string& path)
     : app_path_(path) {
   app_handle_ = dlopen(app_path_.c_str(), RTLD_LAZY);
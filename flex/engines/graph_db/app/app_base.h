@@ -32,6 +32,16 @@ class AppBase {
   virtual ~AppBase() {}
 
   virtual bool Query(Decoder& input, Encoder& output) = 0;
+
+  // Run the parameter sets of a batch, writing for each of them, in order, a
+  // byte of whether it succeeded and the string of its result. They run one
+  // by one by default, apps able to share the reads of a batch, e.g., its
+  // scans and expansions, override it.
+  virtual bool BatchQuery(std::vector<Decoder>& inputs, Encoder& output);
+
+  // Whether the app only reads the graph and its output depends on nothing
+  // but its input, so that its results may be cached until the next write.
+  virtual bool Cacheable() const { return false; }
 };
 
 class AppWrapper {
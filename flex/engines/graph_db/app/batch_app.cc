@@ -0,0 +1,48 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "flex/engines/graph_db/app/batch_app.h"
+
+#include <vector>
+
+#include "flex/engines/graph_db/database/graph_db.h"
+
+namespace gs {
+
+bool BatchApp::Query(Decoder& input, Encoder& output) {
+  uint8_t type = input.get_byte();
+  int num = input.get_int();
+  if (type == GraphDB::kBatchAppIndex || num < 0) {
+    return false;
+  }
+  AppBase* app = graph_.GetApp(type);
+  if (app == nullptr) {
+    return false;
+  }
+  std::vector<Decoder> inputs;
+  inputs.reserve(num);
+  for (int i = 0; i < num; ++i) {
+    auto call = input.get_string();
+    inputs.emplace_back(call.data(), call.size());
+  }
+  return app->BatchQuery(inputs, output);
+}
+
+AppWrapper BatchAppFactory::CreateApp(GraphDBSession& graph) {
+  AppBase* app = new BatchApp(graph);
+  return AppWrapper(app, NULL);
+}
+
+}  // namespace gs
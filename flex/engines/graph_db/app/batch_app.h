@@ -0,0 +1,52 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GRAPHSCOPE_BATCH_APP_H_
+#define GRAPHSCOPE_BATCH_APP_H_
+
+#include "flex/engines/graph_db/app/app_base.h"
+#include "flex/engines/graph_db/database/graph_db_session.h"
+
+namespace gs {
+
+/**
+ * @brief Runs a batch of calls of the same app, with a single request and
+ * response for all of them, see AppBase::BatchQuery.
+ *
+ * The request is a byte of the type of the app, an int of the number of
+ * calls and a string of the input of each call. The response is the one of
+ * BatchQuery of the app.
+ */
+class BatchApp : public AppBase {
+ public:
+  BatchApp(GraphDBSession& graph) : graph_(graph) {}
+
+  bool Query(Decoder& input, Encoder& output) override;
+
+ private:
+  GraphDBSession& graph_;
+};
+
+class BatchAppFactory : public AppFactoryBase {
+ public:
+  BatchAppFactory() {}
+  ~BatchAppFactory() {}
+
+  AppWrapper CreateApp(GraphDBSession& graph) override;
+};
+
+}  // namespace gs
+
+#endif  // GRAPHSCOPE_BATCH_APP_H_
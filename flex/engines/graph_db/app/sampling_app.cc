@@ -0,0 +1,127 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "flex/engines/graph_db/app/sampling_app.h"
+
+#include <algorithm>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "flex/engines/graph_db/database/neighbor_sampler.h"
+
+namespace gs {
+
+namespace {
+
+template <typename T>
+void put_vector(Encoder& output, const std::vector<T>& vec) {
+  output.put_string_view(std::string_view(
+      reinterpret_cast<const char*>(vec.data()), vec.size() * sizeof(T)));
+}
+
+}  // namespace
+
+bool SamplingApp::Query(Decoder& input, Encoder& output) {
+  auto txn = graph_.GetReadTransaction();
+  const auto& schema = txn.schema();
+  uint64_t seed = input.get_long();
+  int thread_num = input.get_int();
+  int hw_thread_num = std::thread::hardware_concurrency();
+  thread_num = std::min(thread_num, std::max(hw_thread_num, 1));
+
+  int hop_num = input.get_int();
+  if (hop_num <= 0) {
+    return false;
+  }
+  std::vector<SamplingHop> hops(hop_num);
+  for (auto& hop : hops) {
+    std::string frontier_label(input.get_string());
+    std::string nbr_label(input.get_string());
+    std::string edge_label(input.get_string());
+    if (!schema.contains_vertex_label(frontier_label) ||
+        !schema.contains_vertex_label(nbr_label) ||
+        !schema.contains_edge_label(edge_label)) {
+      LOG(ERROR) << "Unknown labels of hop: " << frontier_label << ", "
+                 << nbr_label << ", " << edge_label;
+      return false;
+    }
+    hop.frontier_label = schema.get_vertex_label_id(frontier_label);
+    hop.nbr_label = schema.get_vertex_label_id(nbr_label);
+    hop.edge_label = schema.get_edge_label_id(edge_label);
+    hop.outgoing = input.get_byte() != 0;
+    hop.fanout = input.get_int();
+    hop.strategy = static_cast<SamplingStrategy>(input.get_byte());
+  }
+
+  int seed_num = input.get_int();
+  std::vector<vid_t> seeds(seed_num);
+  for (auto& v : seeds) {
+    int64_t id = input.get_long();
+    if (!txn.GetVertexIndex(hops[0].frontier_label, id, v)) {
+      LOG(ERROR) << "Seed " << id << " not found";
+      return false;
+    }
+  }
+
+  NeighborSampler sampler(txn, thread_num);
+  std::vector<SampledBlock> blocks;
+  if (!sampler.Sample(seeds, hops, seed, blocks)) {
+    LOG(ERROR) << "Failed to sample, invalid hops";
+    return false;
+  }
+
+  int feature_num = input.get_int();
+  std::vector<std::vector<char>> features(feature_num);
+  std::vector<vid_t> last;
+  for (auto& feature : features) {
+    int block = input.get_int();
+    std::string property(input.get_string());
+    if (block < 0 || block > hop_num) {
+      return false;
+    }
+    label_t label = block < hop_num ? hops[block].frontier_label
+                                    : hops[hop_num - 1].nbr_label;
+    if (block == hop_num && last.empty()) {
+      last = blocks.back().nbrs;
+      std::sort(last.begin(), last.end());
+      last.erase(std::unique(last.begin(), last.end()), last.end());
+    }
+    auto column = graph_.get_vertex_property_column(label, property);
+    if (column == nullptr ||
+        !sampler.Gather(*column, block < hop_num ? blocks[block].rows : last,
+                        feature)) {
+      LOG(ERROR) << "Property " << property << " can not be gathered";
+      return false;
+    }
+  }
+
+  for (auto& block : blocks) {
+    put_vector(output, block.rows);
+    put_vector(output, block.offsets);
+    put_vector(output, block.nbrs);
+  }
+  for (auto& feature : features) {
+    put_vector(output, feature);
+  }
+  return true;
+}
+
+AppWrapper SamplingAppFactory::CreateApp(GraphDBSession& graph) {
+  AppBase* app = new SamplingApp(graph);
+  return AppWrapper(app, NULL);
+}
+
+}  // namespace gs
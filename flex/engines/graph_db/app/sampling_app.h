@@ -0,0 +1,64 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GRAPHSCOPE_SAMPLING_APP_H_
+#define GRAPHSCOPE_SAMPLING_APP_H_
+
+#include "flex/engines/graph_db/app/app_base.h"
+#include "flex/engines/graph_db/database/graph_db_session.h"
+
+namespace gs {
+
+/**
+ * @brief Samples k-hop neighborhoods of a batch of seeds, with the features
+ * of the sampled vertices, for the training of GNNs.
+ *
+ * The request is:
+ * - long: the seed of the random generators;
+ * - int: the number of threads;
+ * - int: the number of hops, each with the strings of its frontier,
+ *   neighbor and edge labels, a byte of whether it is outgoing, an int of
+ *   its fanout and a byte of its SamplingStrategy;
+ * - int: the number of seeds, each the long of its id, of the frontier
+ *   label of the first hop;
+ * - int: the number of features, each with an int of the block of the
+ *   vertices, where the number of hops is for the distinct neighbors of the
+ *   last hop, and the string of the property.
+ *
+ * The response has a string for each of the rows, offsets and neighbors of
+ * every SampledBlock, as vid_t, uint64_t and vid_t, then a string for each
+ * feature, of its values in the order of the vertices.
+ */
+class SamplingApp : public AppBase {
+ public:
+  SamplingApp(GraphDBSession& graph) : graph_(graph) {}
+
+  bool Query(Decoder& input, Encoder& output) override;
+
+ private:
+  GraphDBSession& graph_;
+};
+
+class SamplingAppFactory : public AppFactoryBase {
+ public:
+  SamplingAppFactory() {}
+  ~SamplingAppFactory() {}
+
+  AppWrapper CreateApp(GraphDBSession& graph) override;
+};
+
+}  // namespace gs
+
+#endif  // GRAPHSCOPE_SAMPLING_APP_H_
@@ -91,6 +91,10 @@ bool ServerApp::Query(Decoder& input, Encoder& output) {
     CHECK(input.empty());
     graph_.GetAppInfo(output);
     return true;
+  } else if (op == "MEMORY_USAGE") {
+    CHECK(input.empty());
+    output.put_string(graph_.GetMemoryUsage().ToJson(graph_.graph()));
+    return true;
   } else if (op == "QUERY_VERTEX") {
     std::string vertex_label = std::string(input.get_string());
     int64_t vertex_id = input.get_long();
@@ -0,0 +1,259 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <algorithm>
+#include <numeric>
+
+#include "grape/serialization/out_archive.h"
+
+#include "flex/engines/graph_db/database/batch_insert_transaction.h"
+#include "flex/engines/graph_db/database/transaction_utils.h"
+#include "flex/engines/graph_db/database/version_manager.h"
+#include "flex/engines/graph_db/database/wal.h"
+#include "flex/storages/rt_mutable_graph/mutable_property_fragment.h"
+
+namespace gs {
+
+BatchInsertTransaction::BatchInsertTransaction(MutablePropertyFragment& graph,
+                                               ArenaAllocator& alloc,
+                                               WalWriter& logger,
+                                               VersionManager& vm,
+                                               timestamp_t timestamp)
+    : graph_(graph),
+      alloc_(alloc),
+      logger_(logger),
+      vm_(vm),
+      timestamp_(timestamp) {
+  arc_.Resize(sizeof(WalHeader));
+}
+
+BatchInsertTransaction::~BatchInsertTransaction() { Abort(); }
+
+bool BatchInsertTransaction::AddEdges(label_t src_label, label_t dst_label,
+                                      label_t edge_label,
+                                      const std::vector<oid_t>& srcs,
+                                      const std::vector<oid_t>& dsts,
+                                      const std::vector<Any>& props) {
+  size_t num = srcs.size();
+  if (dsts.size() != num || props.size() != num) {
+    LOG(ERROR) << "Edge batch sizes not match, " << num << " sources, "
+               << dsts.size() << " destinations and " << props.size()
+               << " properties";
+    return false;
+  }
+  if (num == 0) {
+    return true;
+  }
+  if (graph_.schema().is_static_edge(src_label, dst_label, edge_label)) {
+    std::string label_name = graph_.schema().get_edge_label_name(edge_label);
+    LOG(ERROR) << "Edge " << label_name << " is static, can not be inserted";
+    return false;
+  }
+  if (graph_.schema().has_edge_table(src_label, dst_label, edge_label)) {
+    std::string label_name = graph_.schema().get_edge_label_name(edge_label);
+    LOG(ERROR) << "Edge " << label_name
+               << " has several properties, only inserted by InsertTransaction";
+    return false;
+  }
+  const PropertyType& type =
+      graph_.schema().get_edge_property(src_label, dst_label, edge_label);
+  for (auto& prop : props) {
+    if (prop.type != type) {
+      std::string label_name = graph_.schema().get_edge_label_name(edge_label);
+      LOG(ERROR) << "Edge property " << label_name
+                 << " type not match, expected " << type << ", got "
+                 << prop.type;
+      return false;
+    }
+  }
+
+  std::vector<vid_t> src_vids(num), dst_vids(num);
+  if (!lookupEndpoints(src_label, srcs, src_vids, "Source") ||
+      !lookupEndpoints(dst_label, dsts, dst_vids, "Destination")) {
+    return false;
+  }
+
+  std::vector<size_t> order(num);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](size_t lhs, size_t rhs) {
+    return src_vids[lhs] < src_vids[rhs];
+  });
+
+  EdgeBatch batch;
+  batch.src_label = src_label;
+  batch.dst_label = dst_label;
+  batch.edge_label = edge_label;
+  batch.begin = src_vids_.size();
+  batch.num = num;
+
+  arc_ << static_cast<uint8_t>(2) << src_label << dst_label << edge_label
+       << num;
+  for (auto i : order) {
+    arc_ << srcs[i];
+    if (src_vids[i] == std::numeric_limits<vid_t>::max()) {
+      pending_endpoints_.push_back(
+          {src_vids_.size(), true, src_label, srcs[i]});
+    }
+    src_vids_.push_back(src_vids[i]);
+  }
+  for (auto i : order) {
+    arc_ << dsts[i];
+    if (dst_vids[i] == std::numeric_limits<vid_t>::max()) {
+      pending_endpoints_.push_back(
+          {dst_vids_.size(), false, dst_label, dsts[i]});
+    }
+    dst_vids_.push_back(dst_vids[i]);
+  }
+  batch.props_offset = arc_.GetSize();
+  for (auto i : order) {
+    serialize_field(arc_, props[i]);
+  }
+  batch.props_size = arc_.GetSize() - batch.props_offset;
+  batches_.push_back(batch);
+  return true;
+}
+
+bool BatchInsertTransaction::AddVertex(label_t label, oid_t id,
+                                       const std::vector<Any>& props) {
+  const std::vector<PropertyType>& types =
+      graph_.schema().get_vertex_properties(label);
+  if (types.size() != props.size()) {
+    std::string label_name = graph_.schema().get_vertex_label_name(label);
+    LOG(ERROR) << "Vertex [" << label_name
+               << "] properties size not match, expected " << types.size()
+               << ", but got " << props.size();
+    return false;
+  }
+  for (size_t col_i = 0; col_i != props.size(); ++col_i) {
+    if (props[col_i].type != types[col_i]) {
+      std::string label_name = graph_.schema().get_vertex_label_name(label);
+      LOG(ERROR) << "Vertex [" << label_name << "][" << col_i
+                 << "] property type not match, expected " << types[col_i]
+                 << ", but got " << props[col_i].type;
+      return false;
+    }
+  }
+  arc_ << static_cast<uint8_t>(0);
+  vertex_offsets_.push_back(arc_.GetSize());
+  arc_ << label << id;
+  for (auto& prop : props) {
+    serialize_field(arc_, prop);
+  }
+  added_vertices_.emplace(label, id);
+  return true;
+}
+
+void BatchInsertTransaction::SetSourceOffset(int32_t partition,
+                                             int64_t offset) {
+  source_offsets_.emplace_back(partition, offset);
+}
+
+void BatchInsertTransaction::Commit() {
+  if (timestamp_ == std::numeric_limits<timestamp_t>::max()) {
+    return;
+  }
+  if (batches_.empty() && vertex_offsets_.empty() && source_offsets_.empty()) {
+    vm_.release_insert_timestamp(timestamp_);
+    clear();
+    return;
+  }
+  for (auto& pair : source_offsets_) {
+    arc_ << static_cast<uint8_t>(3) << pair.first << pair.second;
+  }
+  auto* header = reinterpret_cast<WalHeader*>(arc_.GetBuffer());
+  header->length = arc_.GetSize() - sizeof(WalHeader);
+  header->type = 0;
+  header->codec = 0;
+  header->timestamp = timestamp_;
+  logger_.append(arc_.GetBuffer(), arc_.GetSize());
+
+  grape::OutArchive arc;
+  for (size_t offset : vertex_offsets_) {
+    arc.SetSlice(arc_.GetBuffer() + offset, arc_.GetSize() - offset);
+    label_t label;
+    oid_t id;
+    arc >> label >> id;
+    vid_t lid = graph_.add_vertex(label, id);
+    graph_.get_vertex_table(label).ingest(lid, arc);
+    graph_.IndexVertex(label, lid);
+  }
+  for (auto& endpoint : pending_endpoints_) {
+    auto& vids = endpoint.is_src ? src_vids_ : dst_vids_;
+    CHECK(graph_.get_lid(endpoint.label, endpoint.id, vids[endpoint.index]));
+  }
+  for (auto& batch : batches_) {
+    arc.SetSlice(arc_.GetBuffer() + batch.props_offset, batch.props_size);
+    for (size_t i = batch.begin; i != batch.begin + batch.num; ++i) {
+      graph_.IngestEdge(batch.src_label, src_vids_[i], batch.dst_label,
+                        dst_vids_[i], batch.edge_label, timestamp_, arc,
+                        alloc_);
+    }
+  }
+
+  for (auto& pair : source_offsets_) {
+    graph_.source_offsets().advance(pair.first, pair.second);
+  }
+
+  vm_.release_insert_timestamp(timestamp_);
+  clear();
+}
+
+void BatchInsertTransaction::Abort() {
+  if (timestamp_ != std::numeric_limits<timestamp_t>::max()) {
+    LOG(ERROR) << "aborting " << timestamp_ << "-th transaction (batch insert)";
+    vm_.release_insert_timestamp(timestamp_);
+    clear();
+  }
+}
+
+timestamp_t BatchInsertTransaction::timestamp() const { return timestamp_; }
+
+bool BatchInsertTransaction::lookupEndpoints(label_t label,
+                                             const std::vector<oid_t>& oids,
+                                             std::vector<vid_t>& vids,
+                                             const char* role) {
+  size_t num = oids.size();
+  if (graph_.get_lids(label, oids.data(), num, vids.data()) == num) {
+    return true;
+  }
+  for (size_t i = 0; i < num; ++i) {
+    if (vids[i] == std::numeric_limits<vid_t>::max() &&
+        added_vertices_.find(std::make_pair(label, oids[i])) ==
+            added_vertices_.end()) {
+      std::string label_name = graph_.schema().get_vertex_label_name(label);
+      LOG(ERROR) << role << " vertex " << label_name << "[" << oids[i]
+                 << "] not found...";
+      return false;
+    }
+  }
+  return true;
+}
+
+void BatchInsertTransaction::clear() {
+  arc_.Clear();
+  arc_.Resize(sizeof(WalHeader));
+  vertex_offsets_.clear();
+  added_vertices_.clear();
+  source_offsets_.clear();
+  batches_.clear();
+  src_vids_.clear();
+  dst_vids_.clear();
+  pending_endpoints_.clear();
+
+  timestamp_ = std::numeric_limits<timestamp_t>::max();
+}
+
+}  // namespace gs
@@ -0,0 +1,128 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef GRAPHSCOPE_DATABASE_BATCH_INSERT_TRANSACTION_H_
+#define GRAPHSCOPE_DATABASE_BATCH_INSERT_TRANSACTION_H_
+
+#include <limits>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "flex/storages/rt_mutable_graph/types.h"
+#include "flex/utils/property/types.h"
+#include "grape/serialization/in_archive.h"
+
+namespace gs {
+
+class MutablePropertyFragment;
+class ArenaAllocator;
+class WalWriter;
+class VersionManager;
+
+/**
+ * @brief Transaction inserting edges given as columns of sources,
+ * destinations and properties, for streaming ingest. All edges share one
+ * timestamp and one wal record, in which each batch keeps its labels once and
+ * its endpoints as arrays. Endpoints are resolved by batch lookups, and the
+ * edges of a batch are applied in the order of their sources, so that appends
+ * to the same adjacency list are adjacent.
+ *
+ * Vertices added to the transaction are applied before its edges, and the
+ * offsets of an external log the transaction covers are recorded in the same
+ * wal record, see SourceOffsets.
+ */
+class BatchInsertTransaction {
+ public:
+  BatchInsertTransaction(MutablePropertyFragment& graph, ArenaAllocator& alloc,
+                         WalWriter& logger, VersionManager& vm,
+                         timestamp_t timestamp);
+
+  ~BatchInsertTransaction();
+
+  /**
+   * @brief Add edges from srcs[i] to dsts[i] with data props[i]. All
+   * endpoints must exist, otherwise none of the edges is added.
+   */
+  bool AddEdges(label_t src_label, label_t dst_label, label_t edge_label,
+                const std::vector<oid_t>& srcs, const std::vector<oid_t>& dsts,
+                const std::vector<Any>& props);
+
+  /**
+   * @brief Add a vertex with props in the order of the schema, or overwrite
+   * the properties of an existing one. Edges added afterwards may end at it.
+   */
+  bool AddVertex(label_t label, oid_t id, const std::vector<Any>& props);
+
+  /**
+   * @brief Record that the partition of an external log is applied up to
+   * offset once the transaction is committed.
+   */
+  void SetSourceOffset(int32_t partition, int64_t offset);
+
+  void Commit();
+
+  void Abort();
+
+  timestamp_t timestamp() const;
+
+ private:
+  struct EdgeBatch {
+    label_t src_label;
+    label_t dst_label;
+    label_t edge_label;
+    size_t begin;
+    size_t num;
+    size_t props_offset;
+    size_t props_size;
+  };
+
+  // an endpoint of an edge added by this transaction, resolved on commit
+  struct PendingEndpoint {
+    size_t index;
+    bool is_src;
+    label_t label;
+    oid_t id;
+  };
+
+  // Lids of the endpoints, max for those added by this transaction.
+  bool lookupEndpoints(label_t label, const std::vector<oid_t>& oids,
+                       std::vector<vid_t>& vids, const char* role);
+
+  void clear();
+
+  grape::InArchive arc_;
+
+  // positions in arc_ of the vertices added, after their op types
+  std::vector<size_t> vertex_offsets_;
+  std::set<std::pair<label_t, oid_t>> added_vertices_;
+  std::vector<std::pair<int32_t, int64_t>> source_offsets_;
+
+  std::vector<EdgeBatch> batches_;
+  std::vector<vid_t> src_vids_;
+  std::vector<vid_t> dst_vids_;
+  std::vector<PendingEndpoint> pending_endpoints_;
+
+  MutablePropertyFragment& graph_;
+  ArenaAllocator& alloc_;
+  WalWriter& logger_;
+  VersionManager& vm_;
+  timestamp_t timestamp_;
+};
+
+}  // namespace gs
+
+#endif  // GRAPHSCOPE_DATABASE_BATCH_INSERT_TRANSACTION_H_
@@ -0,0 +1,257 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <cstring>
+
+#include "flex/engines/graph_db/database/edge_redo_buffer.h"
+#include "flex/engines/graph_db/database/transaction_utils.h"
+
+namespace gs {
+
+namespace {
+
+// Rows appended since the last lookup that are scanned instead of merged.
+constexpr size_t kScanLimit = 64;
+
+size_t field_width(PropertyType type) {
+  switch (type) {
+  case PropertyType::kInt32:
+    return sizeof(int);
+  case PropertyType::kDate:
+    return sizeof(int64_t);
+  case PropertyType::kInt64:
+    return sizeof(int64_t);
+  case PropertyType::kDouble:
+    return sizeof(double);
+  case PropertyType::kEmpty:
+  case PropertyType::kString:
+    return 0;
+  default:
+    LOG(FATAL) << "Unexpected property type";
+    return 0;
+  }
+}
+
+}  // namespace
+
+EdgeRedoBuffer::EdgeRedoBuffer()
+    : type_(PropertyType::kEmpty), width_(0), removed_num_(0), dense_(true) {
+  indexed_[0] = indexed_[1] = 0;
+}
+
+void EdgeRedoBuffer::clear() {
+  src_.clear();
+  dst_.clear();
+  removed_.clear();
+  removed_num_ = 0;
+  data_.Clear();
+  offsets_.clear();
+  dense_ = true;
+  invalidate();
+}
+
+void EdgeRedoBuffer::append(vid_t src, vid_t dst, const Any& value) {
+  if (src_.empty()) {
+    type_ = value.type;
+    width_ = field_width(type_);
+  }
+  src_.push_back(src);
+  dst_.push_back(dst);
+  removed_.push_back(0);
+  if (type_ == PropertyType::kString) {
+    offsets_.push_back(data_.GetSize());
+  }
+  serialize_field(data_, value);
+}
+
+size_t EdgeRedoBuffer::data_offset(size_t row) const {
+  return type_ == PropertyType::kString ? offsets_[row] : row * width_;
+}
+
+Any EdgeRedoBuffer::get(size_t row) const {
+  Any ret;
+  ret.type = type_;
+  grape::OutArchive arc;
+  size_t offset = data_offset(row);
+  arc.SetSlice(const_cast<char*>(data_.GetBuffer()) + offset,
+               data_.GetSize() - offset);
+  deserialize_field(arc, ret);
+  return ret;
+}
+
+size_t EdgeRedoBuffer::set(vid_t src, vid_t dst, const Any& value) {
+  size_t begin, end;
+  range(true, src, begin, end);
+  const Index& index = indices_[1];
+  auto first = std::lower_bound(index.neighbors.begin() + begin,
+                                index.neighbors.begin() + end, dst);
+  size_t num = 0;
+  for (size_t i = first - index.neighbors.begin();
+       i < end && index.neighbors[i] == dst; ++i) {
+    size_t row = index.rows[i];
+    if (type_ == PropertyType::kString) {
+      // strings of another length do not fit, the old ones are left behind
+      offsets_[row] = data_.GetSize();
+      serialize_field(data_, value);
+      dense_ = false;
+    } else if (width_ != 0) {
+      grape::InArchive arc;
+      serialize_field(arc, value);
+      memcpy(data_.GetBuffer() + row * width_, arc.GetBuffer(), width_);
+    }
+    ++num;
+  }
+  return num;
+}
+
+size_t EdgeRedoBuffer::remove(vid_t src, vid_t dst) {
+  size_t num = 0;
+  for (size_t row = 0; row < src_.size(); ++row) {
+    if (src_[row] == src && dst_[row] == dst && !removed_[row]) {
+      removed_[row] = 1;
+      ++num;
+    }
+  }
+  if (num != 0) {
+    removed_num_ += num;
+    invalidate();
+  }
+  return num;
+}
+
+void EdgeRedoBuffer::remove_vertex(bool out, vid_t v) {
+  const std::vector<vid_t>& column = out ? src_ : dst_;
+  size_t num = 0;
+  for (size_t row = 0; row < column.size(); ++row) {
+    if (column[row] == v && !removed_[row]) {
+      removed_[row] = 1;
+      ++num;
+    }
+  }
+  if (num != 0) {
+    removed_num_ += num;
+    invalidate();
+  }
+}
+
+bool EdgeRedoBuffer::find(vid_t src, vid_t dst, size_t& row) const {
+  size_t indexed = indexed_[1];
+  if (src_.size() - indexed > kScanLimit) {
+    build(true);
+    indexed = src_.size();
+  }
+  for (size_t i = src_.size(); i > indexed; --i) {
+    if (src_[i - 1] == src && dst_[i - 1] == dst && !removed_[i - 1]) {
+      row = i - 1;
+      return true;
+    }
+  }
+  size_t begin, end;
+  search(indices_[1], src, begin, end);
+  const Index& index = indices_[1];
+  auto last = std::upper_bound(index.neighbors.begin() + begin,
+                               index.neighbors.begin() + end, dst);
+  if (last == index.neighbors.begin() + begin || *(last - 1) != dst) {
+    return false;
+  }
+  row = index.rows[last - index.neighbors.begin() - 1];
+  return true;
+}
+
+const EdgeRedoBuffer::Index& EdgeRedoBuffer::index(bool out) const {
+  build(out);
+  return indices_[out ? 1 : 0];
+}
+
+void EdgeRedoBuffer::range(bool out, vid_t v, size_t& begin,
+                           size_t& end) const {
+  search(index(out), v, begin, end);
+}
+
+void EdgeRedoBuffer::serialize_data(grape::InArchive& arc) const {
+  if (removed_num_ == 0 && dense_) {
+    arc.AddBytes(data_.GetBuffer(), data_.GetSize());
+    return;
+  }
+  for (size_t row = 0; row < src_.size(); ++row) {
+    if (!removed_[row]) {
+      size_t offset = data_offset(row);
+      size_t length = type_ == PropertyType::kString
+                          ? sizeof(size_t) + get(row).value.s.size()
+                          : width_;
+      arc.AddBytes(data_.GetBuffer() + offset, length);
+    }
+  }
+}
+
+void EdgeRedoBuffer::search(const Index& index, vid_t v, size_t& begin,
+                            size_t& end) {
+  auto iter = std::equal_range(index.vertices.begin(), index.vertices.end(), v);
+  begin = iter.first - index.vertices.begin();
+  end = iter.second - index.vertices.begin();
+}
+
+void EdgeRedoBuffer::invalidate() {
+  for (int i = 0; i < 2; ++i) {
+    indices_[i].vertices.clear();
+    indices_[i].neighbors.clear();
+    indices_[i].rows.clear();
+    indexed_[i] = 0;
+  }
+}
+
+void EdgeRedoBuffer::build(bool out) const {
+  Index& index = indices_[out ? 1 : 0];
+  size_t& indexed = indexed_[out ? 1 : 0];
+  size_t size = src_.size();
+  if (indexed == size) {
+    return;
+  }
+  const std::vector<vid_t>& vertices = out ? src_ : dst_;
+  const std::vector<vid_t>& neighbors = out ? dst_ : src_;
+  auto less = [&](uint32_t lhs, uint32_t rhs) {
+    if (vertices[lhs] != vertices[rhs]) {
+      return vertices[lhs] < vertices[rhs];
+    }
+    if (neighbors[lhs] != neighbors[rhs]) {
+      return neighbors[lhs] < neighbors[rhs];
+    }
+    return lhs < rhs;
+  };
+
+  // only the rows appended since are sorted, then merged into the index
+  std::vector<uint32_t> rows;
+  rows.swap(index.rows);
+  size_t merged = rows.size();
+  for (size_t row = indexed; row < size; ++row) {
+    if (!removed_[row]) {
+      rows.push_back(row);
+    }
+  }
+  std::sort(rows.begin() + merged, rows.end(), less);
+  std::inplace_merge(rows.begin(), rows.begin() + merged, rows.end(), less);
+
+  index.vertices.resize(rows.size());
+  index.neighbors.resize(rows.size());
+  for (size_t i = 0; i < rows.size(); ++i) {
+    index.vertices[i] = vertices[rows[i]];
+    index.neighbors[i] = neighbors[rows[i]];
+  }
+  index.rows.swap(rows);
+  indexed = size;
+}
+
+}  // namespace gs
@@ -0,0 +1,131 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GRAPHSCOPE_DATABASE_EDGE_REDO_BUFFER_H_
+#define GRAPHSCOPE_DATABASE_EDGE_REDO_BUFFER_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "flex/storages/rt_mutable_graph/types.h"
+#include "flex/utils/property/types.h"
+#include "grape/serialization/in_archive.h"
+
+namespace gs {
+
+/**
+ * @brief Edges buffered by an update transaction for one edge triplet, kept
+ * as append-only columns of sources, destinations and data.
+ *
+ * The data column holds the values serialized as in the wal, so that a
+ * buffer without removed rows is written to the wal as is. Lookups by source
+ * or by destination go through indices sorted by (vertex, neighbor, row),
+ * which are built on the first lookup and extended by merging the rows
+ * appended since. Rows of the same endpoints are ordered as appended, the
+ * last one being the latest.
+ */
+class EdgeRedoBuffer {
+ public:
+  struct Index {
+    std::vector<vid_t> vertices;
+    std::vector<vid_t> neighbors;
+    std::vector<uint32_t> rows;
+  };
+
+  EdgeRedoBuffer();
+
+  // Rows appended, including the removed ones.
+  size_t size() const { return src_.size(); }
+
+  // Rows not removed.
+  size_t edge_num() const { return src_.size() - removed_num_; }
+
+  bool empty() const { return edge_num() == 0; }
+
+  void clear();
+
+  void append(vid_t src, vid_t dst, const Any& value);
+
+  vid_t src(size_t row) const { return src_[row]; }
+
+  vid_t dst(size_t row) const { return dst_[row]; }
+
+  bool removed(size_t row) const { return removed_[row] != 0; }
+
+  /**
+   * @brief The data of a row. Strings refer to the buffer, they are valid
+   * until the next append or set.
+   */
+  Any get(size_t row) const;
+
+  // Overwrite the data of all rows from src to dst, returns their number.
+  size_t set(vid_t src, vid_t dst, const Any& value);
+
+  // Remove all rows from src to dst, returns their number.
+  size_t remove(vid_t src, vid_t dst);
+
+  // Remove all rows with v as source (out) or as destination (in).
+  void remove_vertex(bool out, vid_t v);
+
+  /**
+   * @brief The latest row from src to dst, rows appended since the last
+   * lookup are scanned while they are few.
+   */
+  bool find(vid_t src, vid_t dst, size_t& row) const;
+
+  // The index by source (out) or by destination (in) of the rows not removed.
+  const Index& index(bool out) const;
+
+  // The range of v in index(out).
+  void range(bool out, vid_t v, size_t& begin, size_t& end) const;
+
+  /**
+   * @brief Append the data of the rows not removed to a wal record, in the
+   * order of the rows.
+   */
+  void serialize_data(grape::InArchive& arc) const;
+
+ private:
+  size_t data_offset(size_t row) const;
+
+  static void search(const Index& index, vid_t v, size_t& begin, size_t& end);
+
+  // Drop the indices, they are rebuilt without the removed rows.
+  void invalidate();
+
+  void build(bool out) const;
+
+  PropertyType type_;
+  size_t width_;
+
+  std::vector<vid_t> src_;
+  std::vector<vid_t> dst_;
+  std::vector<uint8_t> removed_;
+  size_t removed_num_;
+
+  grape::InArchive data_;
+  // offsets of strings in data_, values of other types have a fixed width
+  std::vector<size_t> offsets_;
+  // whether data_ is exactly the serialized values of the rows in order
+  bool dense_;
+
+  mutable Index indices_[2];
+  // rows merged into each index
+  mutable size_t indexed_[2];
+};
+
+}  // namespace gs
+
+#endif  // GRAPHSCOPE_DATABASE_EDGE_REDO_BUFFER_H_
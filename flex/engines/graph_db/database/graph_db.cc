@@ -16,8 +16,16 @@
 #include "flex/engines/graph_db/database/graph_db.h"
 #include "flex/engines/graph_db/database/graph_db_session.h"
 
+#include <malloc.h>
+
+#include "grape/util.h"
+
+#include "flex/engines/graph_db/app/batch_app.h"
+#include "flex/engines/graph_db/app/sampling_app.h"
 #include "flex/engines/graph_db/app/server_app.h"
+#include "flex/engines/graph_db/database/transaction_utils.h"
 #include "flex/engines/graph_db/database/wal.h"
+#include "flex/utils/metrics.h"
 
 namespace gs {
 
@@ -37,10 +45,21 @@ struct SessionLocalContext {
 
 GraphDB::GraphDB() = default;
 GraphDB::~GraphDB() {
+  wal_receiver_.close();
+  wal_shipper_.close();
+  {
+    std::lock_guard<std::mutex> guard(background_mutex_);
+    background_running_ = false;
+  }
+  background_cv_.notify_all();
+  for (auto& thrd : background_threads_) {
+    thrd.join();
+  }
   for (int i = 0; i < thread_num_; ++i) {
     contexts_[i].~SessionLocalContext();
   }
   free(contexts_);
+  wal_group_committer_.close();
 }
 
 GraphDB& GraphDB::get() {
@@ -48,25 +67,121 @@ GraphDB& GraphDB::get() {
   return db;
 }
 
+static constexpr const char* kCheckpointDir = "checkpoint";
+static constexpr const char* kCheckpointTmpDir = "checkpoint_tmp";
+static constexpr const char* kCheckpointOldDir = "checkpoint_old";
+static constexpr const char* kCheckpointMeta = "checkpoint.meta";
+
+static constexpr std::chrono::seconds kStatisticsInterval(10);
+
+// The meta file is written last, so a checkpoint directory without it is
+// incomplete.
+static bool read_checkpoint_ts(const std::filesystem::path& dir,
+                               uint32_t& ts) {
+  std::filesystem::path meta_path = dir / kCheckpointMeta;
+  if (!std::filesystem::exists(meta_path)) {
+    return false;
+  }
+  FILE* fin = fopen(meta_path.c_str(), "r");
+  bool ret = (fread(&ts, sizeof(uint32_t), 1, fin) == 1);
+  fclose(fin);
+  return ret;
+}
+
+static void write_checkpoint_ts(const std::filesystem::path& dir,
+                                uint32_t ts) {
+  // make the snapshot files durable before publishing it
+  int dir_fd = ::open(dir.c_str(), O_RDONLY);
+  if (dir_fd == -1 || syncfs(dir_fd) != 0) {
+    LOG(FATAL) << "Failed to sync checkpoint directory " << dir;
+  }
+  ::close(dir_fd);
+  std::filesystem::path meta_path = dir / kCheckpointMeta;
+  FILE* fout = fopen(meta_path.c_str(), "wb");
+  CHECK_EQ(fwrite(&ts, sizeof(uint32_t), 1, fout), 1);
+  fflush(fout);
+  CHECK_EQ(fsync(fileno(fout)), 0);
+  fclose(fout);
+}
+
+// Recover from a checkpoint interrupted while being published.
+static void recover_checkpoint(const std::filesystem::path& data_dir_path) {
+  std::filesystem::path checkpoint_path = data_dir_path / kCheckpointDir;
+  std::filesystem::path checkpoint_old_path = data_dir_path / kCheckpointOldDir;
+  std::filesystem::remove_all(data_dir_path / kCheckpointTmpDir);
+  if (!std::filesystem::exists(checkpoint_path) &&
+      std::filesystem::exists(checkpoint_old_path)) {
+    std::filesystem::rename(checkpoint_old_path, checkpoint_path);
+  }
+  std::filesystem::remove_all(checkpoint_old_path);
+}
+
+// Replace the checkpoint by the one written to the tmp directory, whose meta
+// file is written already. A crash meanwhile leaves the old or the new one,
+// see recover_checkpoint.
+static void publish_checkpoint(const std::filesystem::path& data_dir_path) {
+  std::filesystem::path tmp_path = data_dir_path / kCheckpointTmpDir;
+  std::filesystem::path checkpoint_path = data_dir_path / kCheckpointDir;
+  std::filesystem::path checkpoint_old_path = data_dir_path / kCheckpointOldDir;
+  if (std::filesystem::exists(checkpoint_path)) {
+    std::filesystem::rename(checkpoint_path, checkpoint_old_path);
+  }
+  std::filesystem::rename(tmp_path, checkpoint_path);
+  // files of the old checkpoint may still be mapped by the graph, which is
+  // fine since they were mapped privately
+  std::filesystem::remove_all(checkpoint_old_path);
+}
+
+void GraphDB::SetPartition(uint32_t partition_id, uint32_t partition_num) {
+  CHECK_LT(partition_id, partition_num);
+  partition_id_ = partition_id;
+  partition_num_ = partition_num;
+}
+
+void GraphDB::SetWalCompression(bool compress) { compress_wal_ = compress; }
+
+void GraphDB::SetVertexReordering(bool reorder) { reorder_vertices_ = reorder; }
+
 void GraphDB::Init(
     const Schema& schema,
     const std::vector<std::pair<std::string, std::string>>& vertex_files,
     const std::vector<std::tuple<std::string, std::string, std::string,
                                  std::string>>& edge_files,
     const std::vector<std::string>& plugins, const std::string& data_dir,
-    int thread_num) {
+    int thread_num, size_t wal_batch_size, uint32_t wal_batch_delay_us,
+    uint32_t checkpoint_interval_s, uint32_t compaction_interval_s,
+    uint32_t history_retention, uint16_t wal_ship_port) {
   std::filesystem::path data_dir_path(data_dir);
   if (!std::filesystem::exists(data_dir_path)) {
     std::filesystem::create_directory(data_dir_path);
   }
+  data_dir_ = data_dir_path.string();
 
+  recover_checkpoint(data_dir_path);
+  std::filesystem::path checkpoint_path = data_dir_path / kCheckpointDir;
+
+  uint32_t checkpoint_ts = 0;
   std::filesystem::path serial_path = data_dir_path / "init_snapshot.bin";
-  if (!std::filesystem::exists(serial_path)) {
+  // the snapshot loaded, the base of the next checkpoint: the one of the
+  // work directory is written at timestamp 0, by the bulk load or when
+  // initialized empty
+  snapshot_dir_ = data_dir_;
+  if (read_checkpoint_ts(checkpoint_path, checkpoint_ts)) {
+    LOG(INFO) << "Initializing graph db from checkpoint at timestamp "
+              << checkpoint_ts;
+    graph_.Deserialize(checkpoint_path.string());
+    if (!graph_.schema().Equals(schema)) {
+      LOG(FATAL)
+          << "Schema of checkpoint is not compatible with the given schema";
+    }
+    snapshot_dir_ = checkpoint_path.string();
+  } else if (!std::filesystem::exists(serial_path)) {
     if (!vertex_files.empty() || !edge_files.empty()) {
       LOG(INFO) << "Initializing graph db through bulk loading";
       {
         MutablePropertyFragment graph;
-        graph.Init(schema, vertex_files, edge_files, thread_num);
+        graph.Init(schema, vertex_files, edge_files, thread_num, partition_id_,
+                   partition_num_, reorder_vertices_);
         graph.Serialize(data_dir_path.string());
       }
       graph_.Deserialize(data_dir_path.string());
@@ -96,20 +211,299 @@ void GraphDB::Init(
   for (const auto& entry : std::filesystem::directory_iterator(wal_dir)) {
     wal_files.push_back(entry.path().string());
   }
+  // wal files of previous runs are never appended again
+  sealed_wals_ = wal_files;
 
   thread_num_ = thread_num;
   contexts_ = static_cast<SessionLocalContext*>(
       aligned_alloc(4096, sizeof(SessionLocalContext) * thread_num));
   for (int i = 0; i < thread_num_; ++i) {
     new (&contexts_[i]) SessionLocalContext(*this, i);
+    contexts_[i].allocator.set_epoch_manager(
+        &version_manager_.epoch_manager());
+  }
+  graph_.history().set_retention(history_retention);
+  if (wal_ship_port != 0) {
+    // records in the wal files are shipped while being replayed
+    wal_shipper_.trim(checkpoint_ts);
+    wal_shipper_.open(wal_ship_port, &version_manager_);
   }
-  ingestWals(wal_files, thread_num_);
+  snapshot_ts_ = checkpoint_ts;
+  ingestWals(wal_files, thread_num_, checkpoint_ts);
 
+  if (wal_batch_size > 1) {
+    LOG(INFO) << "Group commit of wal is enabled, max batch size: "
+              << wal_batch_size << ", max batch delay: " << wal_batch_delay_us
+              << " us";
+    wal_group_committer_.open(wal_dir.string(), wal_batch_size,
+                              wal_batch_delay_us);
+    for (int i = 0; i < thread_num_; ++i) {
+      contexts_[i].logger.open(&wal_group_committer_);
+    }
+  } else {
+    for (int i = 0; i < thread_num_; ++i) {
+      contexts_[i].logger.open(wal_dir.string(), i);
+    }
+  }
   for (int i = 0; i < thread_num_; ++i) {
-    contexts_[i].logger.open(wal_dir.string(), i);
+    contexts_[i].logger.set_compression(compress_wal_);
+  }
+  if (wal_shipper_.is_open()) {
+    for (int i = 0; i < thread_num_; ++i) {
+      contexts_[i].logger.set_shipper(&wal_shipper_);
+    }
   }
 
   initApps(plugins);
+
+  background_running_ = true;
+  if (checkpoint_interval_s > 0) {
+    LOG(INFO) << "Background checkpoint is enabled, interval: "
+              << checkpoint_interval_s << " s";
+    startBackgroundTask(checkpoint_interval_s, [this]() { Checkpoint(); });
+  }
+  if (compaction_interval_s > 0) {
+    LOG(INFO) << "Background compaction is enabled, interval: "
+              << compaction_interval_s << " s";
+    startBackgroundTask(compaction_interval_s, [this]() { CompactEdges(); });
+  }
+  registerMetrics();
+}
+
+void GraphDB::registerMetrics() {
+  auto& registry = MetricsRegistry::get();
+  registry.SetGauge("graph_db_timestamp_lag",
+                    "Write timestamps acquired but not readable yet", "",
+                    [this]() {
+                      return static_cast<double>(
+                          version_manager_.write_timestamp() - 1 -
+                          version_manager_.read_timestamp());
+                    });
+  for (int i = 0; i < thread_num_; ++i) {
+    // read while the session allocates, the value may be slightly stale
+    registry.SetGauge(
+        "graph_db_session_arena_bytes",
+        "Bytes held by the arena allocator of each session",
+        "session=\"" + std::to_string(i) + "\"", [this, i]() {
+          return static_cast<double>(contexts_[i].allocator.allocated_bytes());
+        });
+  }
+  registry.SetGauge(
+      "graph_db_csr_fragmentation",
+      "Share of the memory of grown adjacency lists wasted before the last "
+      "compaction",
+      "", [this]() { return GetCompactionStats().fragmentation; });
+  registry.SetGauge(
+      "graph_db_csr_reclaimed_bytes",
+      "Bytes freed by all compactions of adjacency lists so far", "",
+      [this]() {
+        return static_cast<double>(GetCompactionStats().total_reclaimed_bytes);
+      });
+}
+
+void GraphDB::Checkpoint() {
+  std::lock_guard<std::mutex> guard(checkpoint_mutex_);
+  // seal the wal files being written, so that they can be removed once
+  // covered by this checkpoint or a later one
+  for (int i = 0; i < thread_num_; ++i) {
+    std::string sealed = contexts_[i].logger.rotate();
+    if (!sealed.empty()) {
+      sealed_wals_.push_back(sealed);
+    }
+  }
+  {
+    std::string sealed = wal_group_committer_.rotate();
+    if (!sealed.empty()) {
+      sealed_wals_.push_back(sealed);
+    }
+  }
+
+  // Holding a read timestamp keeps in-place updates away, so data visible at
+  // ts stays untouched. Vertices are appended in lid order, and waiting for
+  // the inflight writes ensures every vertex under the recorded counts is
+  // completely written. Vertices inserted after ts are kept as well, and
+  // replaying their wals on recovery overwrites them with the same values.
+  uint32_t ts = version_manager_.acquire_read_timestamp();
+  std::vector<size_t> vertex_nums;
+  for (label_t i = 0; i < graph_.schema().vertex_label_num(); ++i) {
+    vertex_nums.push_back(graph_.vertex_num(i));
+  }
+  version_manager_.wait_for_writes();
+
+  std::filesystem::path data_dir_path(data_dir_);
+  std::filesystem::path tmp_path = data_dir_path / kCheckpointTmpDir;
+  std::filesystem::remove_all(tmp_path);
+  std::filesystem::create_directory(tmp_path);
+  graph_.Serialize(tmp_path.string(), vertex_nums, ts, thread_num_,
+                   snapshot_dir_, snapshot_ts_);
+  version_manager_.release_read_timestamp();
+  write_checkpoint_ts(tmp_path, ts);
+  publish_checkpoint(data_dir_path);
+  snapshot_dir_ = (data_dir_path / kCheckpointDir).string();
+  snapshot_ts_ = ts;
+
+  size_t removed = 0;
+  std::vector<std::string> remaining;
+  for (auto& path : sealed_wals_) {
+    if (get_wal_last_ts(path) <= ts) {
+      std::filesystem::remove(path);
+      ++removed;
+    } else {
+      remaining.push_back(path);
+    }
+  }
+  sealed_wals_.swap(remaining);
+  wal_shipper_.trim(ts);
+  LOG(INFO) << "Checkpoint at timestamp " << ts << " finished, removed "
+            << removed << " wal files";
+}
+
+void GraphDB::BulkAppend(
+    const Schema& schema,
+    const std::vector<std::pair<std::string, std::string>>& vertex_files,
+    const std::vector<std::tuple<std::string, std::string, std::string,
+                                 std::string>>& edge_files,
+    const std::string& data_dir, int thread_num) {
+  std::filesystem::path data_dir_path(data_dir);
+  recover_checkpoint(data_dir_path);
+  std::filesystem::path checkpoint_path = data_dir_path / kCheckpointDir;
+  uint32_t ts = 0;
+  MutablePropertyFragment graph;
+  if (read_checkpoint_ts(checkpoint_path, ts)) {
+    graph.Deserialize(checkpoint_path.string());
+  } else if (std::filesystem::exists(data_dir_path / "init_snapshot.bin")) {
+    graph.Deserialize(data_dir_path.string());
+  } else {
+    LOG(FATAL) << "No snapshot to append to in " << data_dir;
+  }
+  if (!graph.schema().Equals(schema)) {
+    LOG(FATAL) << "Schema of snapshot is not compatible with the given schema";
+  }
+  double t0 = -grape::GetCurrentTime();
+  graph.Append(vertex_files, edge_files, thread_num, partition_id_,
+               partition_num_);
+  t0 += grape::GetCurrentTime();
+  LOG(INFO) << "Appended to the snapshot at timestamp " << ts << ", elapsed "
+            << t0 << " s";
+
+  // Published as a checkpoint at the same timestamp, so the wals after it
+  // are still replayed on top of the appended data.
+  std::filesystem::path tmp_path = data_dir_path / kCheckpointTmpDir;
+  std::filesystem::create_directory(tmp_path);
+  std::vector<size_t> vertex_nums;
+  for (label_t i = 0; i < graph.schema().vertex_label_num(); ++i) {
+    vertex_nums.push_back(graph.vertex_num(i));
+  }
+  graph.Serialize(tmp_path.string(), vertex_nums, ts, thread_num);
+  write_checkpoint_ts(tmp_path, ts);
+  publish_checkpoint(data_dir_path);
+}
+
+CompactionStats GraphDB::CompactEdges() {
+  std::lock_guard<std::mutex> guard(compaction_mutex_);
+  // Lists are moved while no other transaction holds a timestamp. After that
+  // no list refers to memory of the session allocators, which is freed as a
+  // whole once update transactions still reading old lists have left. No
+  // timestamp is taken, which keeps those of replicas in step with the
+  // primary.
+  version_manager_.acquire_exclusive();
+  size_t arena_bytes = 0;
+  for (int i = 0; i < thread_num_; ++i) {
+    arena_bytes += contexts_[i].allocator.allocated_bytes();
+  }
+  size_t old_bytes, new_bytes;
+  graph_.CompactEdges(thread_num_, old_bytes, new_bytes);
+  std::vector<ArenaAllocator> garbage(thread_num_);
+  for (int i = 0; i < thread_num_; ++i) {
+    garbage[i].swap(contexts_[i].allocator);
+  }
+  version_manager_.release_exclusive();
+  version_manager_.epoch_manager().synchronize();
+  garbage.clear();
+  malloc_trim(0);
+
+  size_t held_bytes = arena_bytes + old_bytes;
+  compaction_stats_.reclaimed_bytes =
+      held_bytes > new_bytes ? held_bytes - new_bytes : 0;
+  compaction_stats_.total_reclaimed_bytes += compaction_stats_.reclaimed_bytes;
+  compaction_stats_.fragmentation =
+      held_bytes == 0 ? 0
+                      : static_cast<double>(compaction_stats_.reclaimed_bytes) /
+                            held_bytes;
+  LOG(INFO) << "Compacted adjacency lists, reclaimed "
+            << compaction_stats_.reclaimed_bytes << " bytes, fragmentation "
+            << compaction_stats_.fragmentation;
+  return compaction_stats_;
+}
+
+CompactionStats GraphDB::GetCompactionStats() const {
+  std::lock_guard<std::mutex> guard(compaction_mutex_);
+  return compaction_stats_;
+}
+
+GraphStatistics GraphDB::GetStatistics() {
+  std::lock_guard<std::mutex> guard(statistics_mutex_);
+  auto now = std::chrono::steady_clock::now();
+  if (!statistics_.empty() &&
+      (statistics_.timestamp() == version_manager_.read_timestamp() ||
+       now - statistics_time_ < kStatisticsInterval)) {
+    return statistics_;
+  }
+  // The vertices under the recorded counts are completely written, as in
+  // Checkpoint.
+  uint32_t ts = version_manager_.acquire_read_timestamp();
+  std::vector<size_t> vertex_nums;
+  for (label_t i = 0; i < graph_.schema().vertex_label_num(); ++i) {
+    vertex_nums.push_back(graph_.vertex_num(i));
+  }
+  version_manager_.wait_for_writes();
+  statistics_.Collect(graph_, vertex_nums, ts);
+  version_manager_.release_read_timestamp();
+  statistics_time_ = now;
+  return statistics_;
+}
+
+MemoryUsage GraphDB::GetMemoryUsage() {
+  MemoryUsage usage;
+  {
+    // lists are not moved by compactions meanwhile
+    std::lock_guard<std::mutex> guard(compaction_mutex_);
+    usage.Collect(graph_);
+  }
+  for (int i = 0; i < thread_num_; ++i) {
+    SessionMemoryUsage session;
+    session.arena_bytes = contexts_[i].allocator.allocated_bytes();
+    session.wal_bytes = contexts_[i].logger.used_bytes();
+    usage.AddSession(session);
+  }
+  size_t shared_wal_bytes = wal_group_committer_.used_bytes();
+  {
+    std::lock_guard<std::mutex> guard(checkpoint_mutex_);
+    for (auto& path : sealed_wals_) {
+      std::error_code ec;
+      size_t bytes = std::filesystem::file_size(path, ec);
+      shared_wal_bytes += ec ? 0 : bytes;
+    }
+  }
+  usage.SetSharedWalBytes(shared_wal_bytes);
+  return usage;
+}
+
+void GraphDB::startBackgroundTask(uint32_t interval_s,
+                                  const std::function<void()>& task) {
+  background_threads_.emplace_back([this, interval_s, task]() {
+    std::unique_lock<std::mutex> lock(background_mutex_);
+    while (true) {
+      background_cv_.wait_for(lock, std::chrono::seconds(interval_s),
+                              [this]() { return !background_running_; });
+      if (!background_running_) {
+        break;
+      }
+      lock.unlock();
+      task();
+      lock.lock();
+    }
+  });
 }
 
 ReadTransaction GraphDB::GetReadTransaction() {
@@ -117,6 +511,10 @@ ReadTransaction GraphDB::GetReadTransaction() {
   return {graph_, version_manager_, ts};
 }
 
+ReadTransaction GraphDB::GetReadTransaction(timestamp_t as_of) {
+  return contexts_[0].session.GetReadTransaction(as_of);
+}
+
 InsertTransaction GraphDB::GetInsertTransaction(int thread_id) {
   return contexts_[thread_id].session.GetInsertTransaction();
 }
@@ -141,6 +539,11 @@ GraphDBSession& GraphDB::GetSession(int thread_id) {
 
 int GraphDB::SessionNum() const { return thread_num_; }
 
+void GraphDB::SetResultCacheCapacity(size_t bytes) {
+  result_cache_.SetCapacity(bytes);
+  LOG(INFO) << "Result cache capacity: " << bytes << " bytes";
+}
+
 const MutablePropertyFragment& GraphDB::graph() const { return graph_; }
 MutablePropertyFragment& GraphDB::graph() { return graph_; }
 
@@ -185,26 +588,188 @@ void GraphDB::GetAppInfo(Encoder& output) {
   }
 }
 
+namespace {
+
+struct WalVertexOp {
+  oid_t oid;
+  char* data;
+  size_t size;
+};
+
+struct WalEdgeOp {
+  timestamp_t ts;
+  label_t src_label;
+  label_t dst_label;
+  oid_t src;
+  oid_t dst;
+  char* data;
+  size_t size;
+};
+
+// Operations decoded from a contiguous range of timestamps, bucketed by
+// vertex label and by edge triplet so that each bucket can be applied by a
+// single thread without contention.
+struct WalChunk {
+  std::vector<std::vector<WalVertexOp>> vertex_ops;
+  std::vector<std::vector<WalEdgeOp>> edge_ops;
+};
+
+void DecodeInsertWal(const Schema& schema, size_t vertex_label_num,
+                     size_t edge_label_num, timestamp_t ts, char* data,
+                     size_t length, WalChunk& chunk) {
+  grape::OutArchive arc;
+  arc.SetSlice(data, length);
+  Any prop;
+  while (!arc.Empty()) {
+    uint8_t op_type;
+    arc >> op_type;
+    if (op_type == 0) {
+      label_t label;
+      oid_t id;
+      arc >> label >> id;
+      char* begin = static_cast<char*>(arc.GetBytes(0));
+      for (auto type : schema.get_vertex_properties(label)) {
+        prop.type = type;
+        deserialize_field(arc, prop);
+      }
+      char* end = static_cast<char*>(arc.GetBytes(0));
+      chunk.vertex_ops[label].push_back(
+          {id, begin, static_cast<size_t>(end - begin)});
+    } else if (op_type == 1) {
+      label_t src_label, dst_label, edge_label;
+      oid_t src, dst;
+      arc >> src_label >> src >> dst_label >> dst >> edge_label;
+      char* begin = static_cast<char*>(arc.GetBytes(0));
+      for (auto type :
+           schema.get_edge_properties(src_label, dst_label, edge_label)) {
+        prop.type = type;
+        deserialize_field(arc, prop);
+      }
+      char* end = static_cast<char*>(arc.GetBytes(0));
+      size_t index = src_label * vertex_label_num * edge_label_num +
+                     dst_label * edge_label_num + edge_label;
+      chunk.edge_ops[index].push_back(
+          {ts, src_label, dst_label, src, dst, begin,
+           static_cast<size_t>(end - begin)});
+    } else if (op_type == 2) {
+      label_t src_label, dst_label, edge_label;
+      size_t num;
+      arc >> src_label >> dst_label >> edge_label >> num;
+      const oid_t* srcs =
+          static_cast<const oid_t*>(arc.GetBytes(sizeof(oid_t) * num));
+      const oid_t* dsts =
+          static_cast<const oid_t*>(arc.GetBytes(sizeof(oid_t) * num));
+      prop.type = schema.get_edge_property(src_label, dst_label, edge_label);
+      size_t index = src_label * vertex_label_num * edge_label_num +
+                     dst_label * edge_label_num + edge_label;
+      for (size_t i = 0; i < num; ++i) {
+        char* begin = static_cast<char*>(arc.GetBytes(0));
+        deserialize_field(arc, prop);
+        char* end = static_cast<char*>(arc.GetBytes(0));
+        chunk.edge_ops[index].push_back(
+            {ts, src_label, dst_label, srcs[i], dsts[i], begin,
+             static_cast<size_t>(end - begin)});
+      }
+    } else {
+      LOG(FATAL) << "Unexpected op-" << static_cast<int>(op_type);
+    }
+  }
+}
+
+}  // namespace
+
+// Replays the insert wals in [from, to) in three phases: the wals are decoded
+// in parallel into per-label / per-triplet buckets, then each vertex label is
+// applied by one thread, and at last each edge triplet is applied by one
+// thread. Applying a bucket in timestamp order keeps the result identical to
+// a sequential replay, while no thread ever waits for a vertex inserted by
+// another one.
 static void IngestWalRange(SessionLocalContext* contexts,
                            MutablePropertyFragment& graph,
                            const WalsParser& parser, uint32_t from, uint32_t to,
                            int thread_num) {
-  std::atomic<uint32_t> cur_ts(from);
+  const Schema& schema = graph.schema();
+  size_t vertex_label_num = schema.vertex_label_num();
+  size_t edge_label_num = schema.edge_label_num();
+  size_t csr_num = vertex_label_num * vertex_label_num * edge_label_num;
+
+  std::vector<WalChunk> chunks(thread_num);
+  uint32_t chunk_size = (to - from + thread_num - 1) / thread_num;
   std::vector<std::thread> threads(thread_num);
+  for (int i = 0; i < thread_num; ++i) {
+    threads[i] = std::thread(
+        [&](int tid) {
+          auto& chunk = chunks[tid];
+          chunk.vertex_ops.resize(vertex_label_num);
+          chunk.edge_ops.resize(csr_num);
+          uint32_t chunk_from = from + tid * chunk_size;
+          uint32_t chunk_to = std::min(to, chunk_from + chunk_size);
+          for (uint32_t ts = chunk_from; ts < chunk_to; ++ts) {
+            const auto& unit = parser.get_insert_wal(ts);
+            if (unit.ptr == nullptr) {
+              continue;
+            }
+            DecodeInsertWal(schema, vertex_label_num, edge_label_num, ts,
+                            unit.ptr, unit.size, chunk);
+          }
+        },
+        i);
+  }
+  for (auto& thrd : threads) {
+    thrd.join();
+  }
+
+  std::atomic<size_t> cur_label(0);
+  for (int i = 0; i < thread_num; ++i) {
+    threads[i] = std::thread([&]() {
+      while (true) {
+        size_t label = cur_label.fetch_add(1);
+        if (label >= vertex_label_num) {
+          break;
+        }
+        auto& table = graph.get_vertex_table(label);
+        grape::OutArchive arc;
+        for (auto& chunk : chunks) {
+          for (auto& op : chunk.vertex_ops[label]) {
+            // a vertex may already be in a checkpoint taken while it was
+            // being inserted
+            vid_t lid;
+            if (!graph.get_lid(label, op.oid, lid)) {
+              lid = graph.add_vertex(label, op.oid);
+            }
+            arc.SetSlice(op.data, op.size);
+            table.ingest(lid, arc);
+            graph.IndexVertex(label, lid);
+          }
+        }
+      }
+    });
+  }
+  for (auto& thrd : threads) {
+    thrd.join();
+  }
+
+  std::atomic<size_t> cur_csr(0);
   for (int i = 0; i < thread_num; ++i) {
     threads[i] = std::thread(
         [&](int tid) {
           auto& alloc = contexts[tid].allocator;
+          grape::OutArchive arc;
           while (true) {
-            uint32_t got_ts = cur_ts.fetch_add(1);
-            if (got_ts >= to) {
+            size_t index = cur_csr.fetch_add(1);
+            if (index >= csr_num) {
               break;
             }
-            const auto& unit = parser.get_insert_wal(got_ts);
-            InsertTransaction::IngestWal(graph, got_ts, unit.ptr, unit.size,
-                                         alloc);
-            if (got_ts % 1000000 == 0) {
-              LOG(INFO) << "Ingested " << got_ts << " WALs";
+            label_t edge_label = index % edge_label_num;
+            for (auto& chunk : chunks) {
+              for (auto& op : chunk.edge_ops[index]) {
+                vid_t src_lid, dst_lid;
+                CHECK(graph.get_lid(op.src_label, op.src, src_lid));
+                CHECK(graph.get_lid(op.dst_label, op.dst, dst_lid));
+                arc.SetSlice(op.data, op.size);
+                graph.IngestEdge(op.src_label, src_lid, op.dst_label, dst_lid,
+                                 edge_label, op.ts, arc, alloc);
+              }
             }
           }
         },
@@ -213,13 +778,34 @@ static void IngestWalRange(SessionLocalContext* contexts,
   for (auto& thrd : threads) {
     thrd.join();
   }
+  LOG(INFO) << "Ingested WALs in [" << from << ", " << to << ")";
 }
 
-void GraphDB::ingestWals(const std::vector<std::string>& wals, int thread_num) {
+void GraphDB::ingestWals(const std::vector<std::string>& wals, int thread_num,
+                         uint32_t checkpoint_ts) {
   WalsParser parser(wals);
-  uint32_t from_ts = 1;
+  if (wal_shipper_.is_open()) {
+    for (uint32_t ts = checkpoint_ts + 1; ts <= parser.last_ts(); ++ts) {
+      auto& unit = parser.get_insert_wal(ts);
+      if (unit.ptr != NULL) {
+        wal_shipper_.ship(unit.ptr - sizeof(WalHeader),
+                          unit.size + sizeof(WalHeader));
+      }
+    }
+    for (auto& unit : parser.update_wals()) {
+      if (unit.timestamp > checkpoint_ts) {
+        wal_shipper_.ship(unit.ptr - sizeof(WalHeader),
+                          unit.size + sizeof(WalHeader));
+      }
+    }
+  }
+  // wals up to checkpoint_ts are already reflected in the checkpoint
+  uint32_t from_ts = checkpoint_ts + 1;
   for (auto& update_wal : parser.update_wals()) {
     uint32_t to_ts = update_wal.timestamp;
+    if (to_ts <= checkpoint_ts) {
+      continue;
+    }
     if (from_ts < to_ts) {
       IngestWalRange(contexts_, graph_, parser, from_ts, to_ts, thread_num);
     }
@@ -231,7 +817,78 @@ void GraphDB::ingestWals(const std::vector<std::string>& wals, int thread_num) {
     IngestWalRange(contexts_, graph_, parser, from_ts, parser.last_ts() + 1,
                    thread_num);
   }
-  version_manager_.init_ts(parser.last_ts());
+  uint32_t last_ts = std::max(parser.last_ts(), checkpoint_ts);
+  version_manager_.init_ts(last_ts);
+  // values overwritten before the restart are not kept
+  graph_.history().reset(last_ts);
+}
+
+void GraphDB::StartReplication(const std::string& primary) {
+  LOG(INFO) << "Replicating primary " << primary << " from timestamp "
+            << version_manager_.read_timestamp();
+  primary_ts_.store(version_manager_.read_timestamp());
+  wal_receiver_.open(
+      primary,
+      [this]() {
+        // records of a lost connection are sent again
+        replicated_wals_.clear();
+        return version_manager_.read_timestamp();
+      },
+      [this](const WalHeader& header, char* data) {
+        applyReplicatedWal(header, data);
+      });
+}
+
+bool GraphDB::IsReplica() const { return wal_receiver_.is_open(); }
+
+uint32_t GraphDB::GetReplicationLag() const {
+  uint32_t primary_ts = primary_ts_.load();
+  uint32_t ts = version_manager_.read_timestamp();
+  return primary_ts > ts ? primary_ts - ts : 0;
+}
+
+void GraphDB::applyReplicatedWal(const WalHeader& header, char* data) {
+  uint32_t applied_ts = version_manager_.read_timestamp();
+  if (header.length != 0) {
+    if (header.timestamp > applied_ts) {
+      auto& record = replicated_wals_[header.timestamp];
+      const char* ptr = reinterpret_cast<const char*>(&header);
+      record.assign(ptr, ptr + sizeof(WalHeader));
+      record.insert(record.end(), data, data + header.length);
+    }
+    return;
+  }
+
+  // A heartbeat, all records up to its timestamp have been received, and the
+  // timestamps missing belong to aborted transactions. Records are applied
+  // through the version manager so that readers see them in order, as on the
+  // primary, while compactions wait for the allocator used.
+  std::lock_guard<std::mutex> guard(compaction_mutex_);
+  auto& alloc = contexts_[0].allocator;
+  for (uint32_t ts = applied_ts + 1; ts <= header.timestamp; ++ts) {
+    auto iter = replicated_wals_.begin();
+    if (iter == replicated_wals_.end() || iter->first != ts) {
+      CHECK_EQ(version_manager_.acquire_insert_timestamp(), ts);
+      version_manager_.release_insert_timestamp(ts);
+      continue;
+    }
+    auto* record = reinterpret_cast<WalHeader*>(iter->second.data());
+    char* content = iter->second.data() + sizeof(WalHeader);
+    if (record->type) {
+      CHECK_EQ(version_manager_.acquire_update_timestamp(), ts);
+      UpdateTransaction::IngestWal(graph_, ts, content, record->length, alloc);
+      version_manager_.release_update_timestamp(ts);
+    } else {
+      CHECK_EQ(version_manager_.acquire_insert_timestamp(), ts);
+      InsertTransaction::IngestWal(graph_, ts, content, record->length, alloc);
+      version_manager_.release_insert_timestamp(ts);
+    }
+    replicated_wals_.erase(iter);
+  }
+  uint32_t primary_ts = primary_ts_.load();
+  if (header.timestamp > primary_ts) {
+    primary_ts_.store(header.timestamp);
+  }
 }
 
 void GraphDB::initApps(const std::vector<std::string>& plugins) {
@@ -239,9 +896,15 @@ void GraphDB::initApps(const std::vector<std::string>& plugins) {
     app_factories_[i] = nullptr;
   }
   app_factories_[0] = std::make_shared<ServerAppFactory>();
+  app_factories_[kBatchAppIndex] = std::make_shared<BatchAppFactory>();
+  app_factories_[kSamplingAppIndex] = std::make_shared<SamplingAppFactory>();
 
   uint8_t sp_index = 1;
   for (auto path : plugins) {
+    if (sp_index == kBatchAppIndex) {
+      LOG(ERROR) << "too many stored procedures, skipping " << path;
+      continue;
+    }
     registerApp(path, sp_index++);
   }
 }
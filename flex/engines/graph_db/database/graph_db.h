@@ -18,6 +18,10 @@
 
 #include <dlfcn.h>
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
 #include <map>
 #include <mutex>
 #include <thread>
@@ -26,10 +30,15 @@
 #include "flex/engines/graph_db/app/app_base.h"
 #include "flex/engines/graph_db/database/insert_transaction.h"
 #include "flex/engines/graph_db/database/read_transaction.h"
+#include "flex/engines/graph_db/database/result_cache.h"
 #include "flex/engines/graph_db/database/single_edge_insert_transaction.h"
 #include "flex/engines/graph_db/database/single_vertex_insert_transaction.h"
 #include "flex/engines/graph_db/database/update_transaction.h"
 #include "flex/engines/graph_db/database/version_manager.h"
+#include "flex/engines/graph_db/database/wal.h"
+#include "flex/engines/graph_db/database/wal_stream.h"
+#include "flex/storages/rt_mutable_graph/graph_statistics.h"
+#include "flex/storages/rt_mutable_graph/memory_usage.h"
 #include "flex/storages/rt_mutable_graph/mutable_property_fragment.h"
 
 namespace gs {
@@ -38,20 +47,129 @@ class GraphDB;
 class GraphDBSession;
 class SessionLocalContext;
 
+struct CompactionStats {
+  // bytes freed by the last compaction
+  size_t reclaimed_bytes{0};
+  // bytes freed by all compactions so far
+  size_t total_reclaimed_bytes{0};
+  // share of the memory held by grown adjacency lists that was wasted before
+  // the last compaction
+  double fragmentation{0};
+};
+
 class GraphDB {
  public:
+  // the indices of the builtin apps running batches of queries and sampling
+  // neighborhoods, after the plugins
+  static constexpr uint8_t kBatchAppIndex = 254;
+  static constexpr uint8_t kSamplingAppIndex = 255;
+
   GraphDB();
   ~GraphDB();
 
   static GraphDB& get();
 
+  /** @brief Initialize the graph db.
+   *
+   * @param wal_batch_size Maximum number of WAL records flushed by one
+   * fdatasync. Values greater than 1 enable group commit across sessions.
+   * @param wal_batch_delay_us Maximum time in microseconds a record waits for
+   * other records to join its batch under group commit.
+   * @param checkpoint_interval_s Interval in seconds between two background
+   * checkpoints, 0 disables them.
+   * @param compaction_interval_s Interval in seconds between two background
+   * compactions of adjacency lists, 0 disables them.
+   * @param history_retention Number of timestamps before the latest one that
+   * reads at past timestamps are served for, 0 disables them.
+   * @param wal_ship_port Port to stream the wal to read-only replicas on, 0
+   * disables it.
+   */
   void Init(
       const Schema& schema,
       const std::vector<std::pair<std::string, std::string>>& vertex_files,
       const std::vector<std::tuple<std::string, std::string, std::string,
                                    std::string>>& edge_files,
       const std::vector<std::string>& plugins, const std::string& data_dir,
-      int thread_num = 1);
+      int thread_num = 1, size_t wal_batch_size = 1,
+      uint32_t wal_batch_delay_us = 0, uint32_t checkpoint_interval_s = 0,
+      uint32_t compaction_interval_s = 0, uint32_t history_retention = 0,
+      uint16_t wal_ship_port = 0);
+
+  /** @brief Bulk load only the edges of partition_id of partition_num
+   * graphs, see MutablePropertyFragment::get_partition. Must be called before
+   * Init, and has no effect on graphs initialized from the work directory.
+   */
+  void SetPartition(uint32_t partition_id, uint32_t partition_num);
+
+  /** @brief Compress the contents of the wal records written with LZ4, if
+   * built with it. Must be called before Init, compressed records are read
+   * back regardless.
+   */
+  void SetWalCompression(bool compress);
+
+  /** @brief Give vids by descending degrees when bulk loading, see
+   * MutablePropertyFragment::Init. Must be called before Init.
+   */
+  void SetVertexReordering(bool reorder);
+
+  /** @brief Append the vertices and edges of files to the latest snapshot of
+   * the work directory data_dir, see MutablePropertyFragment::Append, and
+   * publish the result as a new checkpoint, which replaces the old one
+   * atomically. Wals after the snapshot are kept and replayed by the next
+   * Init. Must be called before Init, no server may use the work directory
+   * meanwhile.
+   */
+  void BulkAppend(
+      const Schema& schema,
+      const std::vector<std::pair<std::string, std::string>>& vertex_files,
+      const std::vector<std::tuple<std::string, std::string, std::string,
+                                   std::string>>& edge_files,
+      const std::string& data_dir, int thread_num = 1);
+
+  /** @brief Take a checkpoint of the graph and remove the wal files it covers.
+   *
+   * Readers and inserts keep running during the checkpoint, while updates
+   * that modify data in place wait until it is written. Files are written
+   * by thread_num threads, and csrs unchanged since the previous snapshot
+   * are hard linked from it.
+   */
+  void Checkpoint();
+
+  /** @brief Rewrite the adjacency lists grown by insertions into contiguous
+   * buffers, and return the memory of session allocators to the OS.
+   *
+   * All transactions wait while the adjacency lists are moved.
+   */
+  CompactionStats CompactEdges();
+
+  /** @brief Statistics of the last compaction. */
+  CompactionStats GetCompactionStats() const;
+
+  /** @brief Statistics of the data for the query planner, see
+   * GraphStatistics.
+   *
+   * They are collected again once the graph has changed since the last
+   * collection, at most every kStatisticsInterval seconds.
+   */
+  GraphStatistics GetStatistics();
+
+  /** @brief Bytes of memory held by the graph by label, property and edge
+   * triple, and by the sessions, see MemoryUsage.
+   */
+  MemoryUsage GetMemoryUsage();
+
+  /** @brief Run as a read-only replica of the primary at host:port.
+   *
+   * The graph initialized from a checkpoint of the primary is kept up to date
+   * by applying the wal streamed by the primary, in timestamp order, and
+   * write transactions are not allowed.
+   */
+  void StartReplication(const std::string& primary);
+
+  bool IsReplica() const;
+
+  /** @brief Number of timestamps a replica is behind its primary. */
+  uint32_t GetReplicationLag() const;
 
   /** @brief Create a transaction to read vertices and edges.
    *
@@ -59,6 +177,13 @@ class GraphDB {
    */
   ReadTransaction GetReadTransaction();
 
+  /** @brief Create a transaction to read the graph as of a past timestamp.
+   *
+   * Timestamps older than the retention horizon are raised to it, and the
+   * timestamp actually read at is given by ReadTransaction::timestamp().
+   */
+  ReadTransaction GetReadTransaction(timestamp_t as_of);
+
   /** @brief Create a transaction to insert vertices and edges with a default
    * allocator.
    *
@@ -104,13 +229,25 @@ class GraphDB {
 
   int SessionNum() const;
 
+  /** @brief Cache results of cacheable apps in up to bytes, 0 disables it.
+   */
+  void SetResultCacheCapacity(size_t bytes);
+
  private:
   void registerApp(const std::string& path, uint8_t index = 0);
 
-  void ingestWals(const std::vector<std::string>& wals, int thread_num);
+  void ingestWals(const std::vector<std::string>& wals, int thread_num,
+                  uint32_t checkpoint_ts);
+
+  void applyReplicatedWal(const WalHeader& header, char* data);
+
+  void startBackgroundTask(uint32_t interval_s,
+                           const std::function<void()>& task);
 
   void initApps(const std::vector<std::string>& plugins);
 
+  void registerMetrics();
+
   friend class GraphDBSession;
 
   SessionLocalContext* contexts_;
@@ -119,6 +256,40 @@ class GraphDB {
 
   MutablePropertyFragment graph_;
   VersionManager version_manager_;
+  ResultCache result_cache_;
+  WalGroupCommitter wal_group_committer_;
+
+  std::string data_dir_;
+  // sealed wal files, waiting to be covered by a checkpoint
+  std::vector<std::string> sealed_wals_;
+  // the latest snapshot written or loaded and its timestamp, csrs unchanged
+  // since are linked from it by the next checkpoint
+  std::string snapshot_dir_;
+  uint32_t snapshot_ts_{0};
+  std::mutex checkpoint_mutex_;
+
+  mutable std::mutex compaction_mutex_;
+  CompactionStats compaction_stats_;
+
+  std::mutex statistics_mutex_;
+  GraphStatistics statistics_;
+  std::chrono::steady_clock::time_point statistics_time_;
+
+  WalShipper wal_shipper_;
+  WalReceiver wal_receiver_;
+  // records received by a replica, waiting for the heartbeat covering them
+  std::map<uint32_t, std::vector<char>> replicated_wals_;
+  std::atomic<uint32_t> primary_ts_{0};
+
+  std::mutex background_mutex_;
+  std::condition_variable background_cv_;
+  bool background_running_{false};
+
+  uint32_t partition_id_{0};
+  uint32_t partition_num_{1};
+  bool compress_wal_{false};
+  bool reorder_vertices_{false};
+  std::vector<std::thread> background_threads_;
 
   std::array<std::string, 256> app_paths_;
   std::array<std::shared_ptr<AppFactoryBase>, 256> app_factories_;
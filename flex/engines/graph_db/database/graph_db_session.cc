@@ -14,18 +14,47 @@
  */
 
 #include "flex/engines/graph_db/database/graph_db_session.h"
+
+#include <algorithm>
+#include <thread>
+
 #include "flex/engines/graph_db/app/app_base.h"
 #include "flex/engines/graph_db/database/graph_db.h"
+#include "flex/engines/graph_db/database/transaction_utils.h"
+#include "flex/engines/graph_db/database/wal.h"
 #include "flex/utils/app_utils.h"
+#include "flex/utils/metrics.h"
 
 namespace gs {
 
+// replicas only apply the wal of their primary
+static void check_writable(const GraphDB& db) {
+  if (db.IsReplica()) {
+    LOG(FATAL) << "Write transactions are not allowed on a read-only replica";
+  }
+}
+
 ReadTransaction GraphDBSession::GetReadTransaction() {
   uint32_t ts = db_.version_manager_.acquire_read_timestamp();
   return ReadTransaction(db_.graph_, db_.version_manager_, ts);
 }
 
+ReadTransaction GraphDBSession::GetReadTransaction(timestamp_t as_of) {
+  uint32_t ts = db_.version_manager_.acquire_read_timestamp();
+  // exclusive updates wait for this read, so the horizon stays valid
+  timestamp_t oldest = db_.graph_.history().horizon(ts);
+  if (as_of > ts) {
+    as_of = ts;
+  } else if (as_of < oldest) {
+    LOG(WARNING) << "Timestamp " << as_of << " is older than the retention "
+                 << "horizon, reading at " << oldest;
+    as_of = oldest;
+  }
+  return ReadTransaction(db_.graph_, db_.version_manager_, as_of);
+}
+
 InsertTransaction GraphDBSession::GetInsertTransaction() {
+  check_writable(db_);
   uint32_t ts = db_.version_manager_.acquire_insert_timestamp();
   return InsertTransaction(db_.graph_, alloc_, logger_, db_.version_manager_,
                            ts);
@@ -33,21 +62,76 @@ InsertTransaction GraphDBSession::GetInsertTransaction() {
 
 SingleVertexInsertTransaction
 GraphDBSession::GetSingleVertexInsertTransaction() {
+  check_writable(db_);
   uint32_t ts = db_.version_manager_.acquire_insert_timestamp();
   return SingleVertexInsertTransaction(db_.graph_, alloc_, logger_,
                                        db_.version_manager_, ts);
 }
 
 SingleEdgeInsertTransaction GraphDBSession::GetSingleEdgeInsertTransaction() {
+  check_writable(db_);
   uint32_t ts = db_.version_manager_.acquire_insert_timestamp();
   return SingleEdgeInsertTransaction(db_.graph_, alloc_, logger_,
                                      db_.version_manager_, ts);
 }
 
+BatchInsertTransaction GraphDBSession::GetBatchInsertTransaction() {
+  check_writable(db_);
+  uint32_t ts = db_.version_manager_.acquire_insert_timestamp();
+  return BatchInsertTransaction(db_.graph_, alloc_, logger_,
+                                db_.version_manager_, ts);
+}
+
 UpdateTransaction GraphDBSession::GetUpdateTransaction() {
-  uint32_t ts = db_.version_manager_.acquire_update_timestamp();
-  return UpdateTransaction(db_.graph_, alloc_, logger_, db_.version_manager_,
-                           ts);
+  check_writable(db_);
+  return UpdateTransaction(db_.graph_, alloc_, logger_, db_.version_manager_);
+}
+
+bool GraphDBSession::AddVertexProperty(label_t label, const std::string& name,
+                                       const Any& default_value) {
+  check_writable(db_);
+  auto& graph = db_.graph_;
+  auto type = default_value.type;
+  if (label >= graph.schema().vertex_label_num() ||
+      (type != PropertyType::kInt32 && type != PropertyType::kInt64 &&
+       type != PropertyType::kDate && type != PropertyType::kString) ||
+      graph.get_vertex_table(label).get_column_id_by_name(name) != -1) {
+    return false;
+  }
+  size_t max_vnum = graph.schema().get_max_vnum(
+      graph.schema().get_vertex_label_name(label));
+  int thread_num = std::max<int>(std::thread::hardware_concurrency(), 1);
+  auto column = CreateColumn(type);
+  column->init(max_vnum);
+  vid_t vnum = graph.vertex_num(label);
+  FillColumn(*column, 0, vnum, default_value, thread_num);
+
+  auto& vm = db_.version_manager_;
+  uint32_t ts = vm.acquire_update_timestamp();
+  if (graph.get_vertex_table(label).get_column_id_by_name(name) != -1) {
+    vm.release_update_timestamp(ts);
+    return false;
+  }
+  FillColumn(*column, vnum, graph.vertex_num(label), default_value,
+             thread_num);
+
+  grape::InArchive arc;
+  arc.Resize(sizeof(WalHeader));
+  arc << static_cast<uint8_t>(7) << label << name
+      << static_cast<uint8_t>(type);
+  serialize_field(arc, default_value);
+  auto* header = reinterpret_cast<WalHeader*>(arc.GetBuffer());
+  header->length = arc.GetSize() - sizeof(WalHeader);
+  header->type = 1;
+  header->codec = 0;
+  header->timestamp = ts;
+  logger_.append(arc.GetBuffer(), arc.GetSize());
+
+  graph.AddVertexProperty(label, name, std::move(column));
+  vm.release_update_timestamp(ts);
+  LOG(INFO) << "Added property " << name << " to vertex label "
+            << graph.schema().get_vertex_label_name(label);
+  return true;
 }
 
 const MutablePropertyFragment& GraphDBSession::graph() const {
@@ -71,75 +155,106 @@ std::shared_ptr<RefColumnBase> GraphDBSession::get_vertex_id_column(
 
 #define likely(x) __builtin_expect(!!(x), 1)
 
-std::vector<char> GraphDBSession::Eval(const std::string& input) {
+// A result buffer grown larger than this by one query is released after it
+// instead of being pinned by the session.
+static constexpr size_t kMaxRetainedResultSize = 16 << 20;
+
+std::string_view GraphDBSession::Eval(const std::string_view& input) {
   uint8_t type = input.back();
   const char* str_data = input.data();
   size_t str_len = input.size() - 1;
 
-  std::vector<char> result_buffer;
+  if (result_buffer_.capacity() > kMaxRetainedResultSize) {
+    std::vector<char>().swap(result_buffer_);
+  }
+  result_buffer_.clear();
+  result_buffer_.reserve(result_sizes_[type]);
 
   Decoder decoder(str_data, str_len);
-  Encoder encoder(result_buffer);
+  Encoder encoder(result_buffer_);
 
-  AppBase* app = nullptr;
-  if (likely(apps_[type] != nullptr)) {
-    app = apps_[type];
-  } else {
-    app_wrappers_[type] = db_.CreateApp(type, thread_id_);
-    if (app_wrappers_[type].app() == NULL) {
-      LOG(ERROR) << "[Query-" + std::to_string((int) type)
-                 << "] is not registered...";
-      return result_buffer;
-    } else {
-      apps_[type] = app_wrappers_[type].app();
-      app = apps_[type];
-    }
+  AppBase* app = GetApp(type);
+  if (app == nullptr) {
+    return std::string_view();
   }
 
-  if (app->Query(decoder, encoder)) {
-    return result_buffer;
+  if (query_latencies_[type] == nullptr) {
+    query_latencies_[type] = &MetricsRegistry::get().GetHistogram(
+        "graph_db_query_latency_us", "Microseconds of queries by app type",
+        "app=\"" + std::to_string(static_cast<int>(type)) + "\"");
   }
+  ScopedLatency timer(*query_latencies_[type]);
 
-  LOG(INFO) << "[Query-" << (int) type << "][Thread-" << thread_id_
-            << "] retry - 1 / 3";
-  std::this_thread::sleep_for(std::chrono::milliseconds(1));
-
-  decoder.reset(str_data, str_len);
-  result_buffer.clear();
-  if (app->Query(decoder, encoder)) {
-    return result_buffer;
-  }
-
-  LOG(INFO) << "[Query-" << (int) type << "][Thread-" << thread_id_
-            << "] retry - 2 / 3";
-  std::this_thread::sleep_for(std::chrono::milliseconds(1));
-
-  decoder.reset(str_data, str_len);
-  result_buffer.clear();
-  if (app->Query(decoder, encoder)) {
-    return result_buffer;
+  // results read at the latest timestamp are valid until the next write
+  bool cacheable = app->Cacheable() && db_.result_cache_.Enabled();
+  uint32_t read_ts = 0;
+  if (cacheable) {
+    read_ts = db_.version_manager_.read_timestamp();
+    bool hit = db_.result_cache_.Get(input, read_ts, result_buffer_);
+    MetricsRegistry::get()
+        .GetCounter(hit ? "graph_db_result_cache_hits_total"
+                        : "graph_db_result_cache_misses_total",
+                    hit ? "Queries served by the result cache by app type"
+                        : "Cacheable queries missing the result cache by "
+                          "app type",
+                    "app=\"" + std::to_string(static_cast<int>(type)) + "\"")
+        .Add();
+    if (hit) {
+      return std::string_view(result_buffer_.data(), result_buffer_.size());
+    }
   }
-
-  LOG(INFO) << "[Query-" << (int) type << "][Thread-" << thread_id_
-            << "] retry - 3 / 3";
-  std::this_thread::sleep_for(std::chrono::milliseconds(1));
-
-  decoder.reset(str_data, str_len);
-  result_buffer.clear();
-  if (app->Query(decoder, encoder)) {
-    return result_buffer;
+  for (int retry = 0; retry <= 3; ++retry) {
+    if (retry != 0) {
+      LOG(INFO) << "[Query-" << (int) type << "][Thread-" << thread_id_
+                << "] retry - " << retry << " / 3";
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      decoder.reset(str_data, str_len);
+      result_buffer_.clear();
+    }
+    if (app->Query(decoder, encoder)) {
+      result_sizes_[type] = std::min(
+          std::max(result_sizes_[type], result_buffer_.size()),
+          kMaxRetainedResultSize);
+      if (cacheable && db_.version_manager_.read_timestamp() == read_ts) {
+        db_.result_cache_.Put(
+            input, read_ts,
+            std::string_view(result_buffer_.data(), result_buffer_.size()));
+      }
+      return std::string_view(result_buffer_.data(), result_buffer_.size());
+    }
   }
   LOG(INFO) << "[Query-" << (int) type << "][Thread-" << thread_id_
             << "] failed after 3 retries";
+  MetricsRegistry::get()
+      .GetCounter("graph_db_query_failures_total",
+                  "Queries failed after all retries by app type",
+                  "app=\"" + std::to_string(static_cast<int>(type)) + "\"")
+      .Add();
+
+  result_buffer_.clear();
+  return std::string_view();
+}
 
-  result_buffer.clear();
-  return result_buffer;
+AppBase* GraphDBSession::GetApp(uint8_t type) {
+  if (likely(apps_[type] != nullptr)) {
+    return apps_[type];
+  }
+  app_wrappers_[type] = db_.CreateApp(type, thread_id_);
+  if (app_wrappers_[type].app() == NULL) {
+    LOG(ERROR) << "[Query-" + std::to_string((int) type)
+               << "] is not registered...";
+    return nullptr;
+  }
+  apps_[type] = app_wrappers_[type].app();
+  return apps_[type];
 }
 
 #undef likely
 
 void GraphDBSession::GetAppInfo(Encoder& result) { db_.GetAppInfo(result); }
 
+MemoryUsage GraphDBSession::GetMemoryUsage() { return db_.GetMemoryUsage(); }
+
 int GraphDBSession::SessionId() const { return thread_id_; }
 
 }  // namespace gs
@@ -17,11 +17,13 @@
 #define GRAPHSCOPE_DATABASE_GRAPH_DB_SESSION_H_
 
 #include "flex/engines/graph_db/app/app_base.h"
+#include "flex/engines/graph_db/database/batch_insert_transaction.h"
 #include "flex/engines/graph_db/database/insert_transaction.h"
 #include "flex/engines/graph_db/database/read_transaction.h"
 #include "flex/engines/graph_db/database/single_edge_insert_transaction.h"
 #include "flex/engines/graph_db/database/single_vertex_insert_transaction.h"
 #include "flex/engines/graph_db/database/update_transaction.h"
+#include "flex/storages/rt_mutable_graph/memory_usage.h"
 #include "flex/storages/rt_mutable_graph/mutable_property_fragment.h"
 #include "flex/utils/property/column.h"
 
@@ -30,6 +32,7 @@ namespace gs {
 class GraphDB;
 class WalWriter;
 class ArenaAllocator;
+class Histogram;
 
 class GraphDBSession {
  public:
@@ -39,19 +42,38 @@ class GraphDBSession {
     for (auto& app : apps_) {
       app = nullptr;
     }
+    result_sizes_.fill(0);
+    query_latencies_.fill(nullptr);
   }
   ~GraphDBSession() {}
 
   ReadTransaction GetReadTransaction();
 
+  ReadTransaction GetReadTransaction(timestamp_t as_of);
+
   InsertTransaction GetInsertTransaction();
 
   SingleVertexInsertTransaction GetSingleVertexInsertTransaction();
 
   SingleEdgeInsertTransaction GetSingleEdgeInsertTransaction();
 
+  BatchInsertTransaction GetBatchInsertTransaction();
+
   UpdateTransaction GetUpdateTransaction();
 
+  /**
+   * @brief Add a property named name to the vertices of label, without
+   * reloading the graph. The vertices in the graph get default_value, whose
+   * type is the one of the property, one of int32, int64, date and string.
+   *
+   * The column is filled before the sessions are paused, so they only wait
+   * for the vertices added meanwhile. Read transactions see the property
+   * once it returns, update transactions started before which add vertices
+   * of label are aborted. Returns false if the property exists.
+   */
+  bool AddVertexProperty(label_t label, const std::string& name,
+                         const Any& default_value);
+
   const MutablePropertyFragment& graph() const;
   MutablePropertyFragment& graph();
 
@@ -63,10 +85,18 @@ class GraphDBSession {
   // Get vertex id column.
   std::shared_ptr<RefColumnBase> get_vertex_id_column(uint8_t label) const;
 
-  std::vector<char> Eval(const std::string& input);
+  // Run the app of type input.back() on the rest of input. The result is
+  // written to a buffer kept by the session, and is valid until the next
+  // Eval.
+  std::string_view Eval(const std::string_view& input);
+
+  // The app of type created by this session, nullptr if none is registered.
+  AppBase* GetApp(uint8_t type);
 
   void GetAppInfo(Encoder& result);
 
+  MemoryUsage GetMemoryUsage();
+
   int SessionId() const;
 
  private:
@@ -77,6 +107,11 @@ class GraphDBSession {
 
   std::array<AppWrapper, 256> app_wrappers_;
   std::array<AppBase*, 256> apps_;
+
+  std::vector<char> result_buffer_;
+  // largest result of each app so far, reserved before running it
+  std::array<size_t, 256> result_sizes_;
+  std::array<Histogram*, 256> query_latencies_;
 };
 
 }  // namespace gs
@@ -18,6 +18,7 @@
 #include "flex/engines/graph_db/database/version_manager.h"
 #include "flex/engines/graph_db/database/wal.h"
 #include "flex/storages/rt_mutable_graph/mutable_property_fragment.h"
+#include "flex/utils/usdt.h"
 
 namespace gs {
 
@@ -30,6 +31,7 @@ InsertTransaction::InsertTransaction(MutablePropertyFragment& graph,
       vm_(vm),
       timestamp_(timestamp) {
   arc_.Resize(sizeof(WalHeader));
+  FLEX_PROBE1(insert_txn_begin, timestamp_);
 }
 
 InsertTransaction::~InsertTransaction() { Abort(); }
@@ -65,9 +67,9 @@ bool InsertTransaction::AddVertex(label_t label, oid_t id,
   return true;
 }
 
-bool InsertTransaction::AddEdge(label_t src_label, oid_t src, label_t dst_label,
-                                oid_t dst, label_t edge_label,
-                                const Any& prop) {
+bool InsertTransaction::checkEdge(label_t src_label, oid_t src,
+                                  label_t dst_label, oid_t dst,
+                                  label_t edge_label) {
   vid_t lid;
   if (!graph_.get_lid(src_label, src, lid)) {
     if (added_vertices_.find(std::make_pair(src_label, src)) ==
@@ -87,6 +89,26 @@ bool InsertTransaction::AddEdge(label_t src_label, oid_t src, label_t dst_label,
       return false;
     }
   }
+  if (graph_.schema().is_static_edge(src_label, dst_label, edge_label)) {
+    std::string label_name = graph_.schema().get_edge_label_name(edge_label);
+    LOG(ERROR) << "Edge " << label_name << " is static, can not be inserted";
+    return false;
+  }
+  return true;
+}
+
+bool InsertTransaction::AddEdge(label_t src_label, oid_t src, label_t dst_label,
+                                oid_t dst, label_t edge_label,
+                                const Any& prop) {
+  if (!checkEdge(src_label, src, dst_label, dst, edge_label)) {
+    return false;
+  }
+  if (graph_.schema().has_edge_table(src_label, dst_label, edge_label)) {
+    std::string label_name = graph_.schema().get_edge_label_name(edge_label);
+    LOG(ERROR) << "Edge " << label_name
+               << " has several properties, they are inserted as a vector";
+    return false;
+  }
   const PropertyType& type =
       graph_.schema().get_edge_property(src_label, dst_label, edge_label);
   if (prop.type != type) {
@@ -101,6 +123,37 @@ bool InsertTransaction::AddEdge(label_t src_label, oid_t src, label_t dst_label,
   return true;
 }
 
+bool InsertTransaction::AddEdge(label_t src_label, oid_t src, label_t dst_label,
+                                oid_t dst, label_t edge_label,
+                                const std::vector<Any>& props) {
+  if (!checkEdge(src_label, src, dst_label, dst, edge_label)) {
+    return false;
+  }
+  const auto& types =
+      graph_.schema().get_edge_properties(src_label, dst_label, edge_label);
+  if (types.size() != props.size()) {
+    std::string label_name = graph_.schema().get_edge_label_name(edge_label);
+    LOG(ERROR) << "Edge " << label_name << " has " << types.size()
+               << " properties, got " << props.size();
+    return false;
+  }
+  for (size_t i = 0; i < types.size(); ++i) {
+    if (props[i].type != types[i]) {
+      std::string label_name = graph_.schema().get_edge_label_name(edge_label);
+      LOG(ERROR) << "Edge property " << label_name << "[" << i
+                 << "] type not match, expected " << types[i] << ", got "
+                 << props[i].type;
+      return false;
+    }
+  }
+  arc_ << static_cast<uint8_t>(1) << src_label << src << dst_label << dst
+       << edge_label;
+  for (auto& prop : props) {
+    serialize_field(arc_, prop);
+  }
+  return true;
+}
+
 void InsertTransaction::Commit() {
   if (timestamp_ == std::numeric_limits<timestamp_t>::max()) {
     return;
@@ -113,13 +166,55 @@ void InsertTransaction::Commit() {
   auto* header = reinterpret_cast<WalHeader*>(arc_.GetBuffer());
   header->length = arc_.GetSize() - sizeof(WalHeader);
   header->type = 0;
+  header->codec = 0;
   header->timestamp = timestamp_;
 
+  FLEX_PROBE1(insert_txn_commit_begin, timestamp_);
   logger_.append(arc_.GetBuffer(), arc_.GetSize());
   IngestWal(graph_, timestamp_, arc_.GetBuffer() + sizeof(WalHeader),
             header->length, alloc_);
 
   vm_.release_insert_timestamp(timestamp_);
+  FLEX_PROBE1(insert_txn_commit_end, timestamp_);
+  clear();
+}
+
+void InsertTransaction::CommitAsync(std::function<void()> on_durable,
+                                    std::function<void()> on_visible) {
+  if (timestamp_ == std::numeric_limits<timestamp_t>::max()) {
+    return;
+  }
+  if (arc_.GetSize() == sizeof(WalHeader)) {
+    vm_.release_insert_timestamp(timestamp_);
+    clear();
+    if (on_durable) {
+      on_durable();
+    }
+    if (on_visible) {
+      on_visible();
+    }
+    return;
+  }
+  auto* header = reinterpret_cast<WalHeader*>(arc_.GetBuffer());
+  header->length = arc_.GetSize() - sizeof(WalHeader);
+  header->type = 0;
+  header->codec = 0;
+  header->timestamp = timestamp_;
+
+  FLEX_PROBE1(insert_txn_commit_begin, timestamp_);
+  auto commit = std::make_shared<AsyncInsertCommit>(vm_, timestamp_,
+                                                    std::move(on_visible));
+  logger_.append_async(arc_.GetBuffer(), arc_.GetSize(),
+                       [commit, on_durable = std::move(on_durable)]() {
+                         if (on_durable) {
+                           on_durable();
+                         }
+                         commit->Arrive();
+                       });
+  IngestWal(graph_, timestamp_, arc_.GetBuffer() + sizeof(WalHeader),
+            header->length, alloc_);
+  commit->Arrive();
+  FLEX_PROBE1(insert_txn_commit_end, timestamp_);
   clear();
 }
 
@@ -148,6 +243,7 @@ void InsertTransaction::IngestWal(MutablePropertyFragment& graph,
       arc >> label >> id;
       vid_t lid = graph.add_vertex(label, id);
       graph.get_vertex_table(label).ingest(lid, arc);
+      graph.IndexVertex(label, lid);
     } else if (op_type == 1) {
       label_t src_label, dst_label, edge_label;
       oid_t src, dst;
@@ -160,6 +256,28 @@ void InsertTransaction::IngestWal(MutablePropertyFragment& graph,
 
       graph.IngestEdge(src_label, src_lid, dst_label, dst_lid, edge_label,
                        timestamp, arc, alloc);
+    } else if (op_type == 2) {
+      // a batch of edges of one triplet, see BatchInsertTransaction
+      label_t src_label, dst_label, edge_label;
+      size_t num;
+      arc >> src_label >> dst_label >> edge_label >> num;
+      const oid_t* srcs =
+          static_cast<const oid_t*>(arc.GetBytes(sizeof(oid_t) * num));
+      const oid_t* dsts =
+          static_cast<const oid_t*>(arc.GetBytes(sizeof(oid_t) * num));
+      for (size_t i = 0; i < num; ++i) {
+        vid_t src_lid, dst_lid;
+        CHECK(get_vertex_with_retries(graph, src_label, srcs[i], src_lid));
+        CHECK(get_vertex_with_retries(graph, dst_label, dsts[i], dst_lid));
+        graph.IngestEdge(src_label, src_lid, dst_label, dst_lid, edge_label,
+                         timestamp, arc, alloc);
+      }
+    } else if (op_type == 3) {
+      // offset of an external log applied, see BatchInsertTransaction
+      int32_t partition;
+      int64_t offset;
+      arc >> partition >> offset;
+      graph.source_offsets().advance(partition, offset);
     } else {
       LOG(FATAL) << "Unexpected op-" << static_cast<int>(op_type);
     }
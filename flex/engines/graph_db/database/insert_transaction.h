@@ -16,6 +16,7 @@
 #ifndef GRAPHSCOPE_DATABASE_INSERT_TRANSACTION_H_
 #define GRAPHSCOPE_DATABASE_INSERT_TRANSACTION_H_
 
+#include <functional>
 #include <limits>
 
 #include "flex/storages/rt_mutable_graph/types.h"
@@ -42,8 +43,21 @@ class InsertTransaction {
   bool AddEdge(label_t src_label, oid_t src, label_t dst_label, oid_t dst,
                label_t edge_label, const Any& prop);
 
+  // Edges of types with several properties, given in the order of the schema.
+  bool AddEdge(label_t src_label, oid_t src, label_t dst_label, oid_t dst,
+               label_t edge_label, const std::vector<Any>& props);
+
   void Commit();
 
+  /**
+   * @brief Commit without waiting for the record to be durable, so that a
+   * session may pipeline its writes. on_durable is called once the record
+   * is durable, and on_visible once read transactions see the writes, both
+   * possibly from the flusher of the wal, see WalWriter::append_async.
+   */
+  void CommitAsync(std::function<void()> on_durable,
+                   std::function<void()> on_visible);
+
   void Abort();
 
   timestamp_t timestamp() const;
@@ -54,6 +68,9 @@ class InsertTransaction {
  private:
   void clear();
 
+  bool checkEdge(label_t src_label, oid_t src, label_t dst_label, oid_t dst,
+                 label_t edge_label);
+
   static bool get_vertex_with_retries(MutablePropertyFragment& graph,
                                       label_t label, oid_t oid, vid_t& lid);
 
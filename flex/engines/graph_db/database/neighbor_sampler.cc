@@ -0,0 +1,307 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "flex/engines/graph_db/database/neighbor_sampler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+namespace gs {
+
+namespace {
+
+// at least these many rows for a thread of its own
+constexpr size_t kMinRowsPerThread = 1024;
+
+uint64_t mix(uint64_t z) {
+  z += 0x9e3779b97f4a7c15ULL;
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+// splitmix64, cheap enough to be seeded for every vertex
+class VertexRng {
+ public:
+  VertexRng(uint64_t seed, vid_t v) : state_(mix(seed ^ mix(v))) {}
+
+  uint64_t Next() {
+    state_ += 0x9e3779b97f4a7c15ULL;
+    return mix(state_);
+  }
+
+  // in (0, 1]
+  double Uniform() { return ((Next() >> 11) + 1) * 0x1.0p-53; }
+
+ private:
+  uint64_t state_;
+};
+
+template <typename EDATA_T>
+double edge_weight(const EDATA_T& data) {
+  if constexpr (std::is_arithmetic<EDATA_T>::value) {
+    return static_cast<double>(data);
+  } else {
+    return 1.0;
+  }
+}
+
+}  // namespace
+
+NeighborSampler::NeighborSampler(const ReadTransaction& txn, int thread_num)
+    : txn_(txn), thread_num_(std::max(thread_num, 1)) {}
+
+bool NeighborSampler::Sample(const std::vector<vid_t>& seeds,
+                             const std::vector<SamplingHop>& hops,
+                             uint64_t seed,
+                             std::vector<SampledBlock>& blocks) const {
+  blocks.clear();
+  blocks.resize(hops.size());
+  for (size_t i = 0; i < hops.size(); ++i) {
+    auto& block = blocks[i];
+    if (i == 0) {
+      block.rows = seeds;
+    } else {
+      if (hops[i].frontier_label != hops[i - 1].nbr_label) {
+        blocks.clear();
+        return false;
+      }
+      block.rows = blocks[i - 1].nbrs;
+      std::sort(block.rows.begin(), block.rows.end());
+      block.rows.erase(std::unique(block.rows.begin(), block.rows.end()),
+                       block.rows.end());
+    }
+    if (!sampleHop(hops[i], mix(seed + i), block)) {
+      blocks.clear();
+      return false;
+    }
+  }
+  return true;
+}
+
+bool NeighborSampler::Gather(const ColumnBase& column,
+                             const std::vector<vid_t>& vids,
+                             std::vector<char>& out) const {
+  switch (column.type()) {
+  case PropertyType::kInt32:
+    return gatherColumn<int>(column, vids, out);
+  case PropertyType::kInt64:
+    return gatherColumn<int64_t>(column, vids, out);
+  case PropertyType::kDouble:
+    return gatherColumn<double>(column, vids, out);
+  case PropertyType::kDate:
+    return gatherColumn<Date>(column, vids, out);
+  default:
+    return false;
+  }
+}
+
+bool NeighborSampler::sampleHop(const SamplingHop& hop, uint64_t seed,
+                                SampledBlock& block) const {
+  const auto& schema = txn_.schema();
+  if (hop.fanout <= 0 || hop.frontier_label >= schema.vertex_label_num() ||
+      hop.nbr_label >= schema.vertex_label_num() ||
+      hop.edge_label >= schema.edge_label_num()) {
+    return false;
+  }
+  label_t src = hop.outgoing ? hop.frontier_label : hop.nbr_label;
+  label_t dst = hop.outgoing ? hop.nbr_label : hop.frontier_label;
+  if (!schema.exist(schema.get_vertex_label_name(src),
+                    schema.get_vertex_label_name(dst),
+                    schema.get_edge_label_name(hop.edge_label))) {
+    return false;
+  }
+  vid_t vnum = txn_.GetVertexNum(hop.frontier_label);
+  for (auto v : block.rows) {
+    if (v >= vnum) {
+      return false;
+    }
+  }
+
+  const auto& properties =
+      schema.get_edge_properties(src, dst, hop.edge_label);
+  bool weighted = hop.strategy == SamplingStrategy::kWeighted;
+  if (properties.empty()) {
+    if (weighted) {
+      return false;
+    }
+    sampleRows<grape::EmptyType>(hop, seed, block);
+  } else if (properties.size() > 1) {
+    // rows of the edge table
+    if (weighted) {
+      return false;
+    }
+    sampleRows<int64_t>(hop, seed, block);
+  } else {
+    switch (properties[0]) {
+    case PropertyType::kInt32:
+      sampleRows<int>(hop, seed, block);
+      break;
+    case PropertyType::kInt64:
+      sampleRows<int64_t>(hop, seed, block);
+      break;
+    case PropertyType::kDouble:
+      sampleRows<double>(hop, seed, block);
+      break;
+    case PropertyType::kDate:
+      if (weighted) {
+        return false;
+      }
+      sampleRows<Date>(hop, seed, block);
+      break;
+    case PropertyType::kString:
+      if (weighted) {
+        return false;
+      }
+      sampleRows<std::string>(hop, seed, block);
+      break;
+    default:
+      return false;
+    }
+  }
+  return true;
+}
+
+template <typename EDATA_T>
+void NeighborSampler::sampleRows(const SamplingHop& hop, uint64_t seed,
+                                 SampledBlock& block) const {
+  size_t row_num = block.rows.size();
+  size_t fanout = hop.fanout;
+  bool weighted = hop.strategy == SamplingStrategy::kWeighted;
+  // fanout slots per row, compacted after
+  std::vector<vid_t> slots(row_num * fanout);
+  std::vector<uint64_t> counts(row_num, 0);
+
+  parallelFor(row_num, [&](size_t begin, size_t end) {
+    // (key, neighbor), a min-heap of the largest keys
+    std::vector<std::pair<double, vid_t>> heap;
+    for (size_t i = begin; i < end; ++i) {
+      vid_t v = block.rows[i];
+      auto edges = hop.outgoing
+                       ? txn_.GetOutgoingEdges<EDATA_T>(
+                             hop.frontier_label, v, hop.nbr_label,
+                             hop.edge_label)
+                       : txn_.GetIncomingEdges<EDATA_T>(
+                             hop.frontier_label, v, hop.nbr_label,
+                             hop.edge_label);
+      VertexRng rng(seed, v);
+      vid_t* out = slots.data() + i * fanout;
+      size_t count = 0;
+      if (!weighted) {
+        // reservoir sampling
+        size_t seen = 0;
+        for (auto& e : edges) {
+          if (count < fanout) {
+            out[count++] = e.neighbor;
+          } else {
+            uint64_t j = rng.Next() % (seen + 1);
+            if (j < fanout) {
+              out[j] = e.neighbor;
+            }
+          }
+          ++seen;
+        }
+      } else {
+        // Efraimidis-Spirakis, keeping the edges of the largest keys
+        // u ^ (1 / w), compared by their logarithms
+        heap.clear();
+        auto greater = [](const std::pair<double, vid_t>& lhs,
+                          const std::pair<double, vid_t>& rhs) {
+          return lhs.first > rhs.first;
+        };
+        for (auto& e : edges) {
+          double w = edge_weight(e.data);
+          if (!(w > 0)) {
+            continue;
+          }
+          double key = std::log(rng.Uniform()) / w;
+          if (heap.size() < fanout) {
+            heap.emplace_back(key, e.neighbor);
+            std::push_heap(heap.begin(), heap.end(), greater);
+          } else if (key > heap.front().first) {
+            std::pop_heap(heap.begin(), heap.end(), greater);
+            heap.back() = std::make_pair(key, e.neighbor);
+            std::push_heap(heap.begin(), heap.end(), greater);
+          }
+        }
+        for (auto& pair : heap) {
+          out[count++] = pair.second;
+        }
+      }
+      counts[i] = count;
+    }
+  });
+
+  block.offsets.resize(row_num + 1);
+  block.offsets[0] = 0;
+  for (size_t i = 0; i < row_num; ++i) {
+    block.offsets[i + 1] = block.offsets[i] + counts[i];
+  }
+  block.nbrs.resize(block.offsets[row_num]);
+  parallelFor(row_num, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      std::copy(slots.begin() + i * fanout,
+                slots.begin() + i * fanout + counts[i],
+                block.nbrs.begin() + block.offsets[i]);
+    }
+  });
+}
+
+template <typename T>
+bool NeighborSampler::gatherColumn(const ColumnBase& column,
+                                   const std::vector<vid_t>& vids,
+                                   std::vector<char>& out) const {
+  auto typed = dynamic_cast<const TypedColumn<T>*>(&column);
+  if (typed == nullptr) {
+    return false;
+  }
+  size_t old_size = out.size();
+  out.resize(old_size + vids.size() * sizeof(T));
+  char* buf = out.data() + old_size;
+  parallelFor(vids.size(), [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      T value = typed->get_view(vids[i]);
+      memcpy(buf + i * sizeof(T), &value, sizeof(T));
+    }
+  });
+  return true;
+}
+
+template <typename FUNC_T>
+void NeighborSampler::parallelFor(size_t n, const FUNC_T& func) const {
+  size_t thread_num = std::min<size_t>(
+      thread_num_, std::max<size_t>(n / kMinRowsPerThread, 1));
+  if (thread_num == 1) {
+    func(0, n);
+    return;
+  }
+  size_t chunk = (n + thread_num - 1) / thread_num;
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < thread_num; ++i) {
+    size_t begin = std::min(n, i * chunk);
+    size_t end = std::min(n, begin + chunk);
+    threads.emplace_back([&func, begin, end]() { func(begin, end); });
+  }
+  for (auto& thrd : threads) {
+    thrd.join();
+  }
+}
+
+}  // namespace gs
@@ -0,0 +1,111 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GRAPHSCOPE_DATABASE_NEIGHBOR_SAMPLER_H_
+#define GRAPHSCOPE_DATABASE_NEIGHBOR_SAMPLER_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "flex/engines/graph_db/database/read_transaction.h"
+#include "flex/utils/property/column.h"
+
+namespace gs {
+
+enum class SamplingStrategy : uint8_t {
+  kUniform,   // every visible edge alike
+  kWeighted,  // in proportion to the property of the edge
+};
+
+/**
+ * @brief One hop of sampling, from the vertices of frontier_label along the
+ * edges of edge_label to or from the vertices of nbr_label.
+ */
+struct SamplingHop {
+  label_t frontier_label;
+  label_t nbr_label;
+  label_t edge_label;
+  bool outgoing;
+  // at most fanout neighbors of each vertex, without replacement
+  int fanout;
+  SamplingStrategy strategy;
+};
+
+/**
+ * @brief The neighbors sampled in a hop, in CSR: those of rows[i] are
+ * nbrs[offsets[i]] to nbrs[offsets[i + 1]]. The rows of the first hop are
+ * the seeds, the rows of a later hop are the distinct neighbors sampled in
+ * the hop before, in ascending order.
+ */
+struct SampledBlock {
+  std::vector<vid_t> rows;
+  std::vector<uint64_t> offsets;
+  std::vector<vid_t> nbrs;
+};
+
+/**
+ * @brief Samples k-hop neighborhoods of batches of seeds, e.g., for the
+ * training of GNNs, from the live graph as seen by a read transaction.
+ *
+ * The rows of a hop are split among threads. The neighbors of a vertex are
+ * drawn by a generator seeded by the seed of the batch, the hop and the
+ * vertex, so a batch samples the same blocks whatever the number of threads.
+ */
+class NeighborSampler {
+ public:
+  NeighborSampler(const ReadTransaction& txn, int thread_num);
+
+  /**
+   * @brief Sample hops from seeds into a block per hop.
+   *
+   * Returns false, with blocks cleared, if a hop is over an edge triplet not
+   * in the schema, does not start from the label of the neighbors of the hop
+   * before, or has a fanout not positive. Weighted hops need the edges to
+   * have a single property of int32, int64 or double, where edges of
+   * weights not positive are never drawn.
+   */
+  bool Sample(const std::vector<vid_t>& seeds,
+              const std::vector<SamplingHop>& hops, uint64_t seed,
+              std::vector<SampledBlock>& blocks) const;
+
+  /**
+   * @brief Append the values of column for vids to out, as the bytes of
+   * values of a fixed width. Returns false for columns of strings.
+   */
+  bool Gather(const ColumnBase& column, const std::vector<vid_t>& vids,
+              std::vector<char>& out) const;
+
+ private:
+  bool sampleHop(const SamplingHop& hop, uint64_t seed,
+                 SampledBlock& block) const;
+
+  template <typename EDATA_T>
+  void sampleRows(const SamplingHop& hop, uint64_t seed,
+                  SampledBlock& block) const;
+
+  template <typename T>
+  bool gatherColumn(const ColumnBase& column, const std::vector<vid_t>& vids,
+                    std::vector<char>& out) const;
+
+  template <typename FUNC_T>
+  void parallelFor(size_t n, const FUNC_T& func) const;
+
+  const ReadTransaction& txn_;
+  int thread_num_;
+};
+
+}  // namespace gs
+
+#endif  // GRAPHSCOPE_DATABASE_NEIGHBOR_SAMPLER_H_
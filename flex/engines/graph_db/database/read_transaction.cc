@@ -21,7 +21,10 @@ namespace gs {
 
 ReadTransaction::ReadTransaction(const MutablePropertyFragment& graph,
                                  VersionManager& vm, timestamp_t timestamp)
-    : graph_(graph), vm_(vm), timestamp_(timestamp) {}
+    : graph_(graph),
+      vm_(vm),
+      timestamp_(timestamp),
+      epoch_(vm.epoch_manager().enter()) {}
 ReadTransaction::~ReadTransaction() { release(); }
 
 timestamp_t ReadTransaction::timestamp() const { return timestamp_; }
@@ -31,14 +34,31 @@ void ReadTransaction::Commit() { release(); }
 void ReadTransaction::Abort() { release(); }
 
 ReadTransaction::vertex_iterator::vertex_iterator(
-    label_t label, vid_t cur, vid_t num, const MutablePropertyFragment& graph)
-    : label_(label), cur_(cur), num_(num), graph_(graph) {}
+    label_t label, vid_t cur, vid_t num, timestamp_t timestamp,
+    const MutablePropertyFragment& graph)
+    : label_(label),
+      cur_(cur),
+      num_(num),
+      timestamp_(timestamp),
+      graph_(graph) {
+  skip_deleted();
+}
 ReadTransaction::vertex_iterator::~vertex_iterator() = default;
 
 bool ReadTransaction::vertex_iterator::IsValid() const { return cur_ < num_; }
-void ReadTransaction::vertex_iterator::Next() { ++cur_; }
+void ReadTransaction::vertex_iterator::Next() {
+  ++cur_;
+  skip_deleted();
+}
 void ReadTransaction::vertex_iterator::Goto(vid_t target) {
   cur_ = std::min(target, num_);
+  skip_deleted();
+}
+
+void ReadTransaction::vertex_iterator::skip_deleted() {
+  while (cur_ < num_ && graph_.is_vertex_deleted(label_, cur_)) {
+    ++cur_;
+  }
 }
 
 oid_t ReadTransaction::vertex_iterator::GetId() const {
@@ -47,6 +67,10 @@ oid_t ReadTransaction::vertex_iterator::GetId() const {
 vid_t ReadTransaction::vertex_iterator::GetIndex() const { return cur_; }
 
 Any ReadTransaction::vertex_iterator::GetField(int col_id) const {
+  Any ret;
+  if (graph_.history().get_vertex(label_, cur_, col_id, timestamp_, ret)) {
+    return ret;
+  }
   return graph_.get_vertex_table(label_).get_column_by_id(col_id)->get(cur_);
 }
 
@@ -56,13 +80,25 @@ int ReadTransaction::vertex_iterator::FieldNum() const {
 
 ReadTransaction::edge_iterator::edge_iterator(
     label_t neighbor_label, label_t edge_label,
-    std::shared_ptr<MutableCsrConstEdgeIterBase> iter)
+    std::shared_ptr<MutableCsrConstEdgeIterBase> iter,
+    const MutableCsrBase* csr, vid_t v, timestamp_t timestamp,
+    const PropertyHistory& history)
     : neighbor_label_(neighbor_label),
       edge_label_(edge_label),
-      iter_(std::move(iter)) {}
+      iter_(std::move(iter)),
+      csr_(csr),
+      v_(v),
+      timestamp_(timestamp),
+      history_(history) {
+  skip_invisible();
+}
 ReadTransaction::edge_iterator::~edge_iterator() = default;
 
 Any ReadTransaction::edge_iterator::GetData() const {
+  Any ret;
+  if (history_.get_edge(csr_, v_, iter_->get_neighbor(), timestamp_, ret)) {
+    return ret;
+  }
   return iter_->get_data();
 }
 
@@ -70,7 +106,16 @@ bool ReadTransaction::edge_iterator::IsValid() const {
   return iter_->is_valid();
 }
 
-void ReadTransaction::edge_iterator::Next() { iter_->next(); }
+void ReadTransaction::edge_iterator::Next() {
+  iter_->next();
+  skip_invisible();
+}
+
+void ReadTransaction::edge_iterator::skip_invisible() {
+  while (iter_->is_valid() && iter_->get_timestamp() > timestamp_) {
+    iter_->next();
+  }
+}
 
 vid_t ReadTransaction::edge_iterator::GetNeighbor() const {
   return iter_->get_neighbor();
@@ -86,16 +131,17 @@ label_t ReadTransaction::edge_iterator::GetEdgeLabel() const {
 
 ReadTransaction::vertex_iterator ReadTransaction::GetVertexIterator(
     label_t label) const {
-  return {label, 0, graph_.vertex_num(label), graph_};
+  return {label, 0, graph_.vertex_num(label), timestamp_, graph_};
 }
 
 ReadTransaction::vertex_iterator ReadTransaction::FindVertex(label_t label,
                                                              oid_t id) const {
   vid_t lid;
   if (graph_.get_lid(label, id, lid)) {
-    return {label, lid, graph_.vertex_num(label), graph_};
+    return {label, lid, graph_.vertex_num(label), timestamp_, graph_};
   } else {
-    return {label, graph_.vertex_num(label), graph_.vertex_num(label), graph_};
+    return {label, graph_.vertex_num(label), graph_.vertex_num(label),
+            timestamp_, graph_};
   }
 }
 
@@ -114,20 +160,52 @@ oid_t ReadTransaction::GetVertexId(label_t label, vid_t index) const {
 
 ReadTransaction::edge_iterator ReadTransaction::GetOutEdgeIterator(
     label_t label, vid_t u, label_t neighnor_label, label_t edge_label) const {
-  return {neighnor_label, edge_label,
-          graph_.get_outgoing_edges(label, u, neighnor_label, edge_label)};
+  return {neighnor_label,
+          edge_label,
+          graph_.get_outgoing_edges(label, u, neighnor_label, edge_label),
+          graph_.get_oe_csr(label, neighnor_label, edge_label),
+          u,
+          timestamp_,
+          graph_.history()};
 }
 
 ReadTransaction::edge_iterator ReadTransaction::GetInEdgeIterator(
     label_t label, vid_t u, label_t neighnor_label, label_t edge_label) const {
-  return {neighnor_label, edge_label,
-          graph_.get_incoming_edges(label, u, neighnor_label, edge_label)};
+  return {neighnor_label,
+          edge_label,
+          graph_.get_incoming_edges(label, u, neighnor_label, edge_label),
+          graph_.get_ie_csr(label, neighnor_label, edge_label),
+          u,
+          timestamp_,
+          graph_.history()};
 }
 
 const Schema& ReadTransaction::schema() const { return graph_.schema(); }
 
+#ifdef FLEX_WITH_ARROW
+std::shared_ptr<arrow::RecordBatch> ReadTransaction::GetVertexTableArrow(
+    label_t label) const {
+  return graph_.get_vertex_table(label).ToArrow(graph_.vertex_num(label));
+}
+
+ArrowCsr ReadTransaction::GetOutgoingCsrArrow(label_t v_label,
+                                              label_t neighbor_label,
+                                              label_t edge_label) const {
+  return graph_.get_oe_csr(v_label, neighbor_label, edge_label)
+      ->ToArrowCSR(graph_.vertex_num(v_label), timestamp_);
+}
+
+ArrowCsr ReadTransaction::GetIncomingCsrArrow(label_t v_label,
+                                              label_t neighbor_label,
+                                              label_t edge_label) const {
+  return graph_.get_ie_csr(v_label, neighbor_label, edge_label)
+      ->ToArrowCSR(graph_.vertex_num(v_label), timestamp_);
+}
+#endif
+
 void ReadTransaction::release() {
   if (timestamp_ != std::numeric_limits<timestamp_t>::max()) {
+    vm_.epoch_manager().exit(epoch_);
     vm_.release_read_timestamp();
     timestamp_ = std::numeric_limits<timestamp_t>::max();
   }
@@ -34,11 +34,10 @@ class AdjListView {
     using nbr_t = MutableNbr<EDATA_T>;
 
    public:
-    nbr_iterator(const nbr_t* ptr, const nbr_t* end, timestamp_t timestamp)
-        : ptr_(ptr), end_(end), timestamp_(timestamp) {
-      while (ptr_->timestamp > timestamp_ && ptr_ != end_) {
-        ++ptr_;
-      }
+    nbr_iterator(const nbr_t* ptr, const nbr_t* end, timestamp_t timestamp,
+                 bool check)
+        : ptr_(ptr), end_(end), timestamp_(timestamp), check_(check) {
+      skip_invisible();
     }
 
     const nbr_t& operator*() const { return *ptr_; }
@@ -47,9 +46,7 @@ class AdjListView {
 
     nbr_iterator& operator++() {
       ++ptr_;
-      while (ptr_ != end_ && ptr_->timestamp > timestamp_) {
-        ++ptr_;
-      }
+      skip_invisible();
       return *this;
     }
 
@@ -62,22 +59,35 @@ class AdjListView {
     }
 
    private:
+    void skip_invisible() {
+      if (check_) {
+        while (ptr_ != end_ && ptr_->timestamp > timestamp_) {
+          ++ptr_;
+        }
+      }
+    }
+
     const nbr_t* ptr_;
     const nbr_t* end_;
     timestamp_t timestamp_;
+    bool check_;
   };
 
  public:
   using slice_t = MutableNbrSlice<EDATA_T>;
 
+  // Timestamps of the edges are checked only if some edge of the list is
+  // newer than the view.
   AdjListView(const slice_t& slice, timestamp_t timestamp)
-      : edges_(slice), timestamp_(timestamp) {}
+      : edges_(slice),
+        timestamp_(timestamp),
+        check_(slice.max_timestamp() > timestamp) {}
 
   nbr_iterator begin() const {
-    return nbr_iterator(edges_.begin(), edges_.end(), timestamp_);
+    return nbr_iterator(edges_.begin(), edges_.end(), timestamp_, check_);
   }
   nbr_iterator end() const {
-    return nbr_iterator(edges_.end(), edges_.end(), timestamp_);
+    return nbr_iterator(edges_.end(), edges_.end(), timestamp_, check_);
   }
 
   int estimated_degree() const { return edges_.size(); }
@@ -85,11 +95,40 @@ class AdjListView {
  private:
   slice_t edges_;
   timestamp_t timestamp_;
+  bool check_;
 };
 
+/**
+ * @brief Whether edges, as split by MutableCsr::get_sorted_edges, contain an
+ * edge to nbr visible at ts. The search of the sorted prefix starts at hint,
+ * which must not be past the lower bound of nbr, and hint is moved to that
+ * bound, so increasing lookups gallop over the prefix once.
+ */
+template <typename EDATA_T>
+bool sorted_edges_contain(const std::pair<MutableNbrSlice<EDATA_T>,
+                                          MutableNbrSlice<EDATA_T>>& edges,
+                          vid_t nbr, timestamp_t ts,
+                          const MutableNbr<EDATA_T>*& hint) {
+  const auto* end = edges.first.end();
+  hint = gallop_lower_bound(hint, end, nbr);
+  for (const auto* ptr = hint; ptr != end && ptr->neighbor == nbr; ++ptr) {
+    if (ptr->timestamp.load() <= ts) {
+      return true;
+    }
+  }
+  for (auto& e : edges.second) {
+    if (e.neighbor == nbr && e.timestamp.load() <= ts) {
+      return true;
+    }
+  }
+  return false;
+}
+
 template <typename EDATA_T>
 class GraphView {
  public:
+  using slice_t = MutableNbrSlice<EDATA_T>;
+
   GraphView(const MutableCsr<EDATA_T>& csr, timestamp_t timestamp)
       : csr_(csr), timestamp_(timestamp) {}
 
@@ -97,6 +136,49 @@ class GraphView {
     return AdjListView<EDATA_T>(csr_.get_edges(v), timestamp_);
   }
 
+  /**
+   * @brief Edges of v as a prefix sorted by neighbor and an unsorted tail, see
+   * MutableCsr::get_sorted_edges. Timestamps are not filtered.
+   */
+  std::pair<slice_t, slice_t> get_sorted_edges(vid_t v) const {
+    return csr_.get_sorted_edges(v);
+  }
+
+  timestamp_t timestamp() const { return timestamp_; }
+
+  /** @brief Whether an edge from v to nbr is visible. */
+  bool exist(vid_t v, vid_t nbr) const {
+    return csr_.exist(v, nbr, timestamp_);
+  }
+
+  /**
+   * @brief Append to out the neighbor of each visible edge of u whose
+   * neighbor is also adjacent to v in other. The sorted prefix of u is walked
+   * in order while galloping over the one of v, so u should be the vertex of
+   * the smaller degree.
+   */
+  template <typename OTHER_T>
+  void intersect(vid_t u, const GraphView<OTHER_T>& other, vid_t v,
+                 std::vector<vid_t>& out) const {
+    auto lhs = csr_.get_sorted_edges(u);
+    auto rhs = other.get_sorted_edges(v);
+    timestamp_t rhs_ts = other.timestamp();
+    const auto* hint = rhs.first.begin();
+    for (auto& e : lhs.first) {
+      if (e.timestamp.load() <= timestamp_ &&
+          sorted_edges_contain(rhs, e.neighbor, rhs_ts, hint)) {
+        out.push_back(e.neighbor);
+      }
+    }
+    for (auto& e : lhs.second) {
+      const auto* tail_hint = rhs.first.begin();
+      if (e.timestamp.load() <= timestamp_ &&
+          sorted_edges_contain(rhs, e.neighbor, rhs_ts, tail_hint)) {
+        out.push_back(e.neighbor);
+      }
+    }
+  }
+
  private:
   const MutableCsr<EDATA_T>& csr_;
   timestamp_t timestamp_;
@@ -135,7 +217,7 @@ class ReadTransaction {
 
   class vertex_iterator {
    public:
-    vertex_iterator(label_t label, vid_t cur, vid_t num,
+    vertex_iterator(label_t label, vid_t cur, vid_t num, timestamp_t timestamp,
                     const MutablePropertyFragment& graph);
     ~vertex_iterator();
 
@@ -150,16 +232,22 @@ class ReadTransaction {
     int FieldNum() const;
 
    private:
+    // deleted vertices keep their slots, they are skipped
+    void skip_deleted();
+
     label_t label_;
     vid_t cur_;
     vid_t num_;
+    timestamp_t timestamp_;
     const MutablePropertyFragment& graph_;
   };
 
   class edge_iterator {
    public:
     edge_iterator(label_t neighbor_label, label_t edge_label,
-                  std::shared_ptr<MutableCsrConstEdgeIterBase> iter);
+                  std::shared_ptr<MutableCsrConstEdgeIterBase> iter,
+                  const MutableCsrBase* csr, vid_t v, timestamp_t timestamp,
+                  const PropertyHistory& history);
     ~edge_iterator();
 
     Any GetData() const;
@@ -175,10 +263,19 @@ class ReadTransaction {
     label_t GetEdgeLabel() const;
 
    private:
+    // edges inserted after timestamp_ are skipped
+    void skip_invisible();
+
     label_t neighbor_label_;
     label_t edge_label_;
 
     std::shared_ptr<MutableCsrConstEdgeIterBase> iter_;
+
+    // to look up the data at timestamp_ of edges updated since
+    const MutableCsrBase* csr_;
+    vid_t v_;
+    timestamp_t timestamp_;
+    const PropertyHistory& history_;
   };
 
   vertex_iterator GetVertexIterator(label_t label) const;
@@ -203,18 +300,18 @@ class ReadTransaction {
   AdjListView<EDATA_T> GetOutgoingEdges(label_t v_label, vid_t v,
                                         label_t neighbor_label,
                                         label_t edge_label) const {
-    auto csr = dynamic_cast<const TypedMutableCsrBase<EDATA_T>*>(
-        graph_.get_oe_csr(v_label, neighbor_label, edge_label));
-    return AdjListView<EDATA_T>(csr->get_edges(v), timestamp_);
+    return AdjListView<EDATA_T>(
+        graph_.get_oe_slice<EDATA_T>(v_label, v, neighbor_label, edge_label),
+        timestamp_);
   }
 
   template <typename EDATA_T>
   AdjListView<EDATA_T> GetIncomingEdges(label_t v_label, vid_t v,
                                         label_t neighbor_label,
                                         label_t edge_label) const {
-    auto csr = dynamic_cast<const TypedMutableCsrBase<EDATA_T>*>(
-        graph_.get_ie_csr(v_label, neighbor_label, edge_label));
-    return AdjListView<EDATA_T>(csr->get_edges(v), timestamp_);
+    return AdjListView<EDATA_T>(
+        graph_.get_ie_slice<EDATA_T>(v_label, v, neighbor_label, edge_label),
+        timestamp_);
   }
 
   const Schema& schema() const;
@@ -237,6 +334,23 @@ class ReadTransaction {
     return GraphView<EDATA_T>(*csr, timestamp_);
   }
 
+#ifdef FLEX_WITH_ARROW
+  /**
+   * @brief The properties of the vertices of a label as a record batch, see
+   * Table::ToArrow. Rows of deleted vertices are kept, and properties updated
+   * in place after this transaction started are read as updated.
+   */
+  std::shared_ptr<arrow::RecordBatch> GetVertexTableArrow(label_t label) const;
+
+  /** @brief The outgoing edges of a triplet visible to this transaction. */
+  ArrowCsr GetOutgoingCsrArrow(label_t v_label, label_t neighbor_label,
+                               label_t edge_label) const;
+
+  /** @brief The incoming edges of a triplet visible to this transaction. */
+  ArrowCsr GetIncomingCsrArrow(label_t v_label, label_t neighbor_label,
+                               label_t edge_label) const;
+#endif
+
   template <typename EDATA_T>
   SingleGraphView<EDATA_T> GetOutgoingSingleGraphView(
       label_t v_label, label_t neighbor_label, label_t edge_label) const {
@@ -259,6 +373,7 @@ class ReadTransaction {
   const MutablePropertyFragment& graph_;
   VersionManager& vm_;
   timestamp_t timestamp_;
+  uint64_t epoch_;
 };
 
 }  // namespace gs
@@ -0,0 +1,71 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "flex/engines/graph_db/database/result_cache.h"
+
+namespace gs {
+
+void ResultCache::SetCapacity(size_t bytes) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  capacity_ = bytes;
+  while (size_ > capacity_) {
+    erase(std::prev(lru_.end()));
+  }
+}
+
+bool ResultCache::Get(std::string_view input, timestamp_t ts,
+                      std::vector<char>& output) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto iter = entries_.find(input);
+  if (iter == entries_.end()) {
+    return false;
+  }
+  auto entry = iter->second;
+  if (entry->ts != ts) {
+    // a write has been committed since
+    erase(entry);
+    return false;
+  }
+  lru_.splice(lru_.begin(), lru_, entry);
+  output.assign(entry->result.begin(), entry->result.end());
+  return true;
+}
+
+void ResultCache::Put(std::string_view input, timestamp_t ts,
+                      std::string_view result) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto iter = entries_.find(input);
+  if (iter != entries_.end()) {
+    erase(iter->second);
+  }
+  Entry entry{std::string(input), ts, std::string(result)};
+  if (entry.bytes() > capacity_) {
+    return;
+  }
+  size_ += entry.bytes();
+  lru_.emplace_front(std::move(entry));
+  entries_.emplace(lru_.front().input, lru_.begin());
+  while (size_ > capacity_) {
+    erase(std::prev(lru_.end()));
+  }
+}
+
+void ResultCache::erase(std::list<Entry>::iterator iter) {
+  size_ -= iter->bytes();
+  entries_.erase(iter->input);
+  lru_.erase(iter);
+}
+
+}  // namespace gs
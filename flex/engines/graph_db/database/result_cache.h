@@ -0,0 +1,73 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GRAPHSCOPE_DATABASE_RESULT_CACHE_H_
+#define GRAPHSCOPE_DATABASE_RESULT_CACHE_H_
+
+#include <list>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "flex/storages/rt_mutable_graph/types.h"
+
+namespace gs {
+
+/**
+ * @brief Results of cacheable apps, by their whole input, which ends with the
+ * app type, and tagged with the timestamp they were read at.
+ *
+ * An entry is served only while the latest read timestamp is still the one
+ * it was read at, i.e. no write has been committed since, so results are
+ * never stale. Entries are evicted in LRU order to keep their bytes within
+ * the capacity, 0 disables the cache.
+ */
+class ResultCache {
+ public:
+  ResultCache() : capacity_(0), size_(0) {}
+
+  void SetCapacity(size_t bytes);
+
+  bool Enabled() const { return capacity_ != 0; }
+
+  /** @brief Copy the result of input read at ts into output, if cached. */
+  bool Get(std::string_view input, timestamp_t ts, std::vector<char>& output);
+
+  void Put(std::string_view input, timestamp_t ts, std::string_view result);
+
+ private:
+  struct Entry {
+    std::string input;
+    timestamp_t ts;
+    std::string result;
+
+    size_t bytes() const { return input.size() + result.size() + 64; }
+  };
+
+  void erase(std::list<Entry>::iterator iter);
+
+  std::mutex mutex_;
+  size_t capacity_;
+  size_t size_;
+  std::list<Entry> lru_;
+  // keys are views of the inputs of the entries
+  std::unordered_map<std::string_view, std::list<Entry>::iterator> entries_;
+};
+
+}  // namespace gs
+
+#endif  // GRAPHSCOPE_DATABASE_RESULT_CACHE_H_
@@ -52,6 +52,17 @@ bool SingleEdgeInsertTransaction::AddEdge(label_t src_label, oid_t src,
                << "] not found...";
     return false;
   }
+  if (graph_.schema().is_static_edge(src_label, dst_label, edge_label)) {
+    std::string label_name = graph_.schema().get_edge_label_name(edge_label);
+    LOG(ERROR) << "Edge " << label_name << " is static, can not be inserted";
+    return false;
+  }
+  if (graph_.schema().has_edge_table(src_label, dst_label, edge_label)) {
+    std::string label_name = graph_.schema().get_edge_label_name(edge_label);
+    LOG(ERROR) << "Edge " << label_name
+               << " has several properties, only inserted by InsertTransaction";
+    return false;
+  }
   const PropertyType& type =
       graph_.schema().get_edge_property(src_label, dst_label, edge_label);
   if (prop.type != type) {
@@ -89,6 +100,7 @@ void SingleEdgeInsertTransaction::Commit() {
   auto* header = reinterpret_cast<WalHeader*>(arc_.GetBuffer());
   header->length = arc_.GetSize() - sizeof(WalHeader);
   header->type = 0;
+  header->codec = 0;
   header->timestamp = timestamp_;
   logger_.append(arc_.GetBuffer(), arc_.GetSize());
 
@@ -101,6 +113,35 @@ void SingleEdgeInsertTransaction::Commit() {
   clear();
 }
 
+void SingleEdgeInsertTransaction::CommitAsync(
+    std::function<void()> on_durable, std::function<void()> on_visible) {
+  if (timestamp_ == std::numeric_limits<timestamp_t>::max()) {
+    return;
+  }
+  auto* header = reinterpret_cast<WalHeader*>(arc_.GetBuffer());
+  header->length = arc_.GetSize() - sizeof(WalHeader);
+  header->type = 0;
+  header->codec = 0;
+  header->timestamp = timestamp_;
+  auto commit = std::make_shared<AsyncInsertCommit>(vm_, timestamp_,
+                                                    std::move(on_visible));
+  logger_.append_async(arc_.GetBuffer(), arc_.GetSize(),
+                       [commit, on_durable = std::move(on_durable)]() {
+                         if (on_durable) {
+                           on_durable();
+                         }
+                         commit->Arrive();
+                       });
+
+  grape::OutArchive arc;
+  arc.SetSlice(arc_.GetBuffer() + sizeof(WalHeader) + 20,
+               arc_.GetSize() - sizeof(WalHeader) - 20);
+  graph_.IngestEdge(src_label_, src_vid_, dst_label_, dst_vid_, edge_label_,
+                    timestamp_, arc, alloc_);
+  commit->Arrive();
+  clear();
+}
+
 void SingleEdgeInsertTransaction::clear() {
   arc_.Clear();
   arc_.Resize(sizeof(WalHeader));
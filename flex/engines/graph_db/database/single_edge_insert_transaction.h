@@ -16,6 +16,8 @@
 #ifndef GRAPHSCOPE_DATABASE_SINGLE_EDGE_INSERT_TRANSACTION_H_
 #define GRAPHSCOPE_DATABASE_SINGLE_EDGE_INSERT_TRANSACTION_H_
 
+#include <functional>
+
 #include "flex/storages/rt_mutable_graph/types.h"
 #include "grape/serialization/in_archive.h"
 
@@ -43,6 +45,15 @@ class SingleEdgeInsertTransaction {
 
   void Commit();
 
+  /**
+   * @brief Commit without waiting for the record to be durable, so that a
+   * session may pipeline its writes. on_durable is called once the record
+   * is durable, and on_visible once read transactions see the writes, both
+   * possibly from the flusher of the wal, see WalWriter::append_async.
+   */
+  void CommitAsync(std::function<void()> on_durable,
+                   std::function<void()> on_visible);
+
  private:
   void clear();
 
@@ -103,6 +103,17 @@ bool SingleVertexInsertTransaction::AddEdge(label_t src_label, oid_t src,
       return false;
     }
   }
+  if (graph_.schema().is_static_edge(src_label, dst_label, edge_label)) {
+    std::string label_name = graph_.schema().get_edge_label_name(edge_label);
+    LOG(ERROR) << "Edge " << label_name << " is static, can not be inserted";
+    return false;
+  }
+  if (graph_.schema().has_edge_table(src_label, dst_label, edge_label)) {
+    std::string label_name = graph_.schema().get_edge_label_name(edge_label);
+    LOG(ERROR) << "Edge " << label_name
+               << " has several properties, only inserted by InsertTransaction";
+    return false;
+  }
   const PropertyType& type =
       graph_.schema().get_edge_property(src_label, dst_label, edge_label);
   if (prop.type != type) {
@@ -131,6 +142,7 @@ void SingleVertexInsertTransaction::Commit() {
   auto* header = reinterpret_cast<WalHeader*>(arc_.GetBuffer());
   header->length = arc_.GetSize() - sizeof(WalHeader);
   header->type = 0;
+  header->codec = 0;
   header->timestamp = timestamp_;
 
   logger_.append(arc_.GetBuffer(), arc_.GetSize());
@@ -167,6 +179,7 @@ void SingleVertexInsertTransaction::ingestWal() {
           graph_.add_vertex(added_vertex_label_, added_vertex_id_);
       graph_.get_vertex_table(added_vertex_label_)
           .ingest(added_vertex_vid_, arc);
+      graph_.IndexVertex(added_vertex_label_, added_vertex_vid_);
     } else if (op_type == 1) {
       label_t src_label, dst_label, edge_label;
       arc >> src_label;
@@ -16,6 +16,12 @@
 #ifndef GRAPHSCOPE_DATABASE_TRANSACTION_UTILS_H_
 #define GRAPHSCOPE_DATABASE_TRANSACTION_UTILS_H_
 
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <utility>
+
+#include "flex/engines/graph_db/database/version_manager.h"
 #include "flex/utils/property/types.h"
 #include "glog/logging.h"
 #include "grape/serialization/in_archive.h"
@@ -71,6 +77,36 @@ inline void deserialize_field(grape::OutArchive& arc, Any& prop) {
   }
 }
 
+/**
+ * @brief Releases the timestamp of an insert committed asynchronously once
+ * both its record is durable and its writes are ingested, in whichever
+ * order they finish, then calls on_visible.
+ */
+class AsyncInsertCommit {
+ public:
+  AsyncInsertCommit(VersionManager& vm, uint32_t timestamp,
+                    std::function<void()> on_visible)
+      : vm_(vm),
+        timestamp_(timestamp),
+        on_visible_(std::move(on_visible)),
+        remaining_(2) {}
+
+  void Arrive() {
+    if (remaining_.fetch_sub(1) == 1) {
+      vm_.release_insert_timestamp(timestamp_);
+      if (on_visible_) {
+        on_visible_();
+      }
+    }
+  }
+
+ private:
+  VersionManager& vm_;
+  uint32_t timestamp_;
+  std::function<void()> on_visible_;
+  std::atomic<int> remaining_;
+};
+
 }  // namespace gs
 
 #endif  // GRAPHSCOPE_DATABASE_TRANSACTION_UTILS_H_
@@ -13,6 +13,9 @@
  * limitations under the License.
  */
 
+#include <algorithm>
+#include <thread>
+
 #include "grape/serialization/in_archive.h"
 #include "grape/serialization/out_archive.h"
 
@@ -21,18 +24,23 @@
 #include "flex/engines/graph_db/database/version_manager.h"
 #include "flex/engines/graph_db/database/wal.h"
 #include "flex/storages/rt_mutable_graph/mutable_property_fragment.h"
+#include "flex/utils/usdt.h"
 
 namespace gs {
 
 UpdateTransaction::UpdateTransaction(MutablePropertyFragment& graph,
                                      ArenaAllocator& alloc, WalWriter& logger,
-                                     VersionManager& vm, timestamp_t timestamp)
+                                     VersionManager& vm)
     : graph_(graph),
       alloc_(alloc),
       logger_(logger),
       vm_(vm),
-      timestamp_(timestamp),
-      op_num_(0) {
+      timestamp_(std::numeric_limits<timestamp_t>::max()),
+      valid_(true),
+      epoch_(vm.epoch_manager().enter()),
+      in_epoch_(true),
+      op_num_(0),
+      in_place_op_num_(0) {
   arc_.Resize(sizeof(WalHeader));
 
   vertex_label_num_ = graph_.schema().vertex_label_num();
@@ -44,6 +52,7 @@ UpdateTransaction::UpdateTransaction(MutablePropertyFragment& graph,
   for (size_t i = 0; i < vertex_label_num_; ++i) {
     added_vertices_base_[i] = vertex_nums_[i] = graph_.vertex_num(i);
   }
+  FLEX_PROBE0(update_txn_begin);
   vertex_offsets_.resize(vertex_label_num_);
   extra_vertex_properties_.resize(vertex_label_num_);
   for (size_t i = 0; i < vertex_label_num_; ++i) {
@@ -52,9 +61,10 @@ UpdateTransaction::UpdateTransaction(MutablePropertyFragment& graph,
                                      {}, 4096);
   }
 
-  size_t csr_num = 2 * vertex_label_num_ * vertex_label_num_ * edge_label_num_;
-  added_edges_.resize(csr_num);
-  updated_edge_data_.resize(csr_num);
+  size_t triplet_num = vertex_label_num_ * vertex_label_num_ * edge_label_num_;
+  added_edges_.resize(triplet_num);
+  updated_edge_data_.resize(2 * triplet_num);
+  deleted_vertices_.resize(vertex_label_num_);
 }
 
 UpdateTransaction::~UpdateTransaction() { release(); }
@@ -62,7 +72,7 @@ UpdateTransaction::~UpdateTransaction() { release(); }
 timestamp_t UpdateTransaction::timestamp() const { return timestamp_; }
 
 void UpdateTransaction::Commit() {
-  if (timestamp_ == std::numeric_limits<timestamp_t>::max()) {
+  if (!valid_) {
     return;
   }
   if (op_num_ == 0) {
@@ -70,14 +80,47 @@ void UpdateTransaction::Commit() {
     return;
   }
 
+  FLEX_PROBE1(update_txn_commit_begin, op_num_);
+  // from now on the reads of commit are protected by the timestamp
+  vm_.epoch_manager().exit(epoch_);
+  in_epoch_ = false;
+
+  // Appended vertices and edges are invisible to older snapshots, only
+  // in-place modifications need to exclude concurrent sessions.
+  bool exclusive = (in_place_op_num_ != 0);
+  timestamp_ = exclusive ? vm_.acquire_update_timestamp()
+                         : vm_.acquire_insert_timestamp();
+  if (vertexPropertiesAdded()) {
+    LOG(ERROR) << "Vertex properties were added since the transaction "
+                  "started, aborting "
+               << timestamp_ << "-th transaction (update)";
+    if (exclusive) {
+      vm_.release_update_timestamp(timestamp_);
+    } else {
+      vm_.release_insert_timestamp(timestamp_);
+    }
+    release();
+    return;
+  }
+
+  serializeEdges();
   auto* header = reinterpret_cast<WalHeader*>(arc_.GetBuffer());
   header->length = arc_.GetSize() - sizeof(WalHeader);
   header->type = 1;
+  header->codec = 0;
   header->timestamp = timestamp_;
   logger_.append(arc_.GetBuffer(), arc_.GetSize());
 
+  applyDeletes();
   applyVerticesUpdates();
   applyEdgesUpdates();
+
+  if (exclusive) {
+    vm_.release_update_timestamp(timestamp_);
+  } else {
+    vm_.release_insert_timestamp(timestamp_);
+  }
+  FLEX_PROBE1(update_txn_commit_end, timestamp_);
   release();
 }
 
@@ -100,6 +143,8 @@ bool UpdateTransaction::AddVertex(label_t label, oid_t oid,
   if (!oid_to_lid(label, oid, id)) {
     added_vertices_[label]._add(oid);
     id = vertex_nums_[label]++;
+  } else if (id < added_vertices_base_[label]) {
+    in_place_op_num_ += 1;
   }
 
   vid_t row_num = vertex_offsets_[label].size();
@@ -128,24 +173,79 @@ bool UpdateTransaction::AddEdge(label_t src_label, oid_t src, label_t dst_label,
   if (!oid_to_lid(dst_label, dst, dst_lid)) {
     return false;
   }
+  if (graph_.schema().is_static_edge(src_label, dst_label, edge_label) ||
+      graph_.schema().has_edge_table(src_label, dst_label, edge_label)) {
+    return false;
+  }
   PropertyType type =
       graph_.schema().get_edge_property(src_label, dst_label, edge_label);
   if (type != value.type) {
     return false;
   }
-  size_t in_csr_index = get_in_csr_index(src_label, dst_label, edge_label);
-  size_t out_csr_index = get_out_csr_index(src_label, dst_label, edge_label);
-  added_edges_[in_csr_index][dst_lid].push_back(src_lid);
-  updated_edge_data_[in_csr_index][dst_lid].emplace(src_lid, value);
+  // written to the wal at commit, with the other edges of the triplet
+  added_edges_[get_triplet_index(src_label, dst_label, edge_label)].append(
+      src_lid, dst_lid, value);
 
-  added_edges_[out_csr_index][src_lid].push_back(dst_lid);
-  updated_edge_data_[out_csr_index][src_lid].emplace(dst_lid, value);
+  op_num_ += 1;
+  return true;
+}
+
+bool UpdateTransaction::DeleteEdge(label_t src_label, oid_t src,
+                                   label_t dst_label, oid_t dst,
+                                   label_t edge_label) {
+  vid_t src_lid, dst_lid;
+  if (!oid_to_lid(src_label, src, src_lid)) {
+    return false;
+  }
+  if (!oid_to_lid(dst_label, dst, dst_lid)) {
+    return false;
+  }
+  if (graph_.get_oe_csr(src_label, dst_label, edge_label) == nullptr ||
+      graph_.schema().is_static_edge(src_label, dst_label, edge_label)) {
+    return false;
+  }
+  added_edges_[get_triplet_index(src_label, dst_label, edge_label)].remove(
+      src_lid, dst_lid);
+  // edges of new vertices only exist in this transaction
+  if (src_lid < added_vertices_base_[src_label] &&
+      dst_lid < added_vertices_base_[dst_label]) {
+    deleted_edges_.emplace_back(src_label, src_lid, dst_label, dst_lid,
+                                edge_label);
+    in_place_op_num_ += 1;
+  }
 
   op_num_ += 1;
-  arc_ << static_cast<uint8_t>(1) << src_label << src << dst_label << dst
+  arc_ << static_cast<uint8_t>(4) << src_label << src << dst_label << dst
        << edge_label;
-  serialize_field(arc_, value);
+  return true;
+}
+
+bool UpdateTransaction::DeleteVertex(label_t label, oid_t oid) {
+  vid_t lid;
+  if (!oid_to_lid(label, oid, lid) || lid >= added_vertices_base_[label]) {
+    return false;
+  }
+  const Schema& schema = graph_.schema();
+  for (label_t nbr_label = 0; nbr_label < vertex_label_num_; ++nbr_label) {
+    for (label_t edge_label = 0; edge_label < edge_label_num_; ++edge_label) {
+      if (graph_.get_oe_csr(label, nbr_label, edge_label) != nullptr &&
+          schema.is_static_edge(label, nbr_label, edge_label)) {
+        return false;
+      }
+      if (graph_.get_oe_csr(nbr_label, label, edge_label) != nullptr &&
+          schema.is_static_edge(nbr_label, label, edge_label)) {
+        return false;
+      }
+    }
+  }
 
+  drop_added_edges(label, lid);
+  vertex_offsets_[label].erase(lid);
+  deleted_vertices_[label].insert(lid);
+
+  op_num_ += 1;
+  in_place_op_num_ += 1;
+  arc_ << static_cast<uint8_t>(5) << label << oid;
   return true;
 }
 
@@ -194,18 +294,20 @@ UpdateTransaction::edge_iterator::~edge_iterator() = default;
 Any UpdateTransaction::edge_iterator::GetData() const {
   if (init_iter_->is_valid()) {
     vid_t cur = init_iter_->get_neighbor();
-    Any ret;
-    if (txn_->GetUpdatedEdgeData(dir_, label_, v_, neighbor_label_, cur,
-                                 edge_label_, ret)) {
-      return ret;
+    size_t csr_index =
+        dir_ ? txn_->get_out_csr_index(label_, neighbor_label_, edge_label_)
+             : txn_->get_in_csr_index(neighbor_label_, label_, edge_label_);
+    size_t row;
+    if (txn_->updated_edge_data_[csr_index].find(v_, cur, row)) {
+      return txn_->updated_edge_data_[csr_index].get(row);
     } else {
       return init_iter_->get_data();
     }
   } else {
     vid_t cur = *added_edges_cur_;
     Any ret;
-    CHECK(txn_->GetUpdatedEdgeData(dir_, label_, v_, neighbor_label_, cur,
-                                   edge_label_, ret));
+    CHECK(txn_->get_added_edge_data(dir_, label_, v_, neighbor_label_, cur,
+                                    edge_label_, ret));
     return ret;
   }
 }
@@ -257,13 +359,15 @@ UpdateTransaction::vertex_iterator UpdateTransaction::GetVertexIterator(
 
 UpdateTransaction::edge_iterator UpdateTransaction::GetOutEdgeIterator(
     label_t label, vid_t u, label_t neighnor_label, label_t edge_label) {
-  size_t csr_index = get_out_csr_index(label, neighnor_label, edge_label);
+  const auto& added =
+      added_edges_[get_triplet_index(label, neighnor_label, edge_label)];
   const vid_t* begin = nullptr;
   const vid_t* end = nullptr;
-  auto iter = added_edges_[csr_index].find(u);
-  if (iter != added_edges_[csr_index].end()) {
-    begin = iter->second.data();
-    end = begin + iter->second.size();
+  if (!added.empty()) {
+    size_t first, last;
+    added.range(true, u, first, last);
+    begin = added.index(true).neighbors.data() + first;
+    end = added.index(true).neighbors.data() + last;
   }
   return {true,
           label,
@@ -278,13 +382,15 @@ UpdateTransaction::edge_iterator UpdateTransaction::GetOutEdgeIterator(
 
 UpdateTransaction::edge_iterator UpdateTransaction::GetInEdgeIterator(
     label_t label, vid_t u, label_t neighnor_label, label_t edge_label) {
-  size_t csr_index = get_in_csr_index(label, neighnor_label, edge_label);
+  const auto& added =
+      added_edges_[get_triplet_index(neighnor_label, label, edge_label)];
   const vid_t* begin = nullptr;
   const vid_t* end = nullptr;
-  auto iter = added_edges_[csr_index].find(u);
-  if (iter != added_edges_[csr_index].end()) {
-    begin = iter->second.data();
-    end = begin + iter->second.size();
+  if (!added.empty()) {
+    size_t first, last;
+    added.range(false, u, first, last);
+    begin = added.index(false).neighbors.data() + first;
+    end = added.index(false).neighbors.data() + last;
   }
   return {false,
           label,
@@ -330,6 +436,7 @@ bool UpdateTransaction::SetVertexField(label_t label, vid_t lid, int col_id,
     if (graph_.vertex_num(label) <= lid) {
       return false;
     }
+    in_place_op_num_ += 1;
     vid_t new_offset = vertex_offset.size();
     vertex_offset.emplace(lid, new_offset);
     size_t col_num = table.col_num();
@@ -342,6 +449,9 @@ bool UpdateTransaction::SetVertexField(label_t label, vid_t lid, int col_id,
     if (extra_table.col_num() <= static_cast<size_t>(col_id)) {
       return false;
     }
+    if (lid < added_vertices_base_[label]) {
+      in_place_op_num_ += 1;
+    }
     extra_table.get_column_by_id(col_id)->set_any(iter->second, value);
   }
 
@@ -354,19 +464,31 @@ bool UpdateTransaction::SetVertexField(label_t label, vid_t lid, int col_id,
 void UpdateTransaction::SetEdgeData(bool dir, label_t label, vid_t v,
                                     label_t neighbor_label, vid_t nbr,
                                     label_t edge_label, const Any& value) {
-  size_t csr_index = dir ? get_out_csr_index(label, neighbor_label, edge_label)
-                         : get_in_csr_index(label, neighbor_label, edge_label);
-  if (value.type == PropertyType::kString) {
-    size_t loc = sv_vec_.size();
-    sv_vec_.emplace_back(std::string(value.value.s));
-    Any dup_value;
-    dup_value.set_string(sv_vec_[loc]);
-    updated_edge_data_[csr_index][v].emplace(nbr, dup_value);
-  } else {
-    updated_edge_data_[csr_index][v].emplace(nbr, value);
+  label_t src_label = dir ? label : neighbor_label;
+  label_t dst_label = dir ? neighbor_label : label;
+  // the data of edges with an edge table are their rows, not to be updated
+  if (graph_.schema().has_edge_table(src_label, dst_label, edge_label)) {
+    LOG(ERROR) << "Edge " << graph_.schema().get_edge_label_name(edge_label)
+               << " has several properties, they can not be updated";
+    return;
   }
-
   op_num_ += 1;
+  // edges added by this transaction are written to the wal with their last
+  // data
+  auto& added =
+      added_edges_[get_triplet_index(src_label, dst_label, edge_label)];
+  if (!added.empty()) {
+    added.set(dir ? v : nbr, dir ? nbr : v, value);
+  }
+  if (v >= added_vertices_base_[label] ||
+      nbr >= added_vertices_base_[neighbor_label]) {
+    return;
+  }
+  size_t csr_index = dir ? get_out_csr_index(src_label, dst_label, edge_label)
+                         : get_in_csr_index(src_label, dst_label, edge_label);
+  updated_edge_data_[csr_index].append(v, nbr, value);
+
+  in_place_op_num_ += 1;
   arc_ << static_cast<uint8_t>(3) << static_cast<uint8_t>(dir ? 1 : 0) << label
        << lid_to_oid(label, v) << neighbor_label
        << lid_to_oid(neighbor_label, nbr) << edge_label;
@@ -377,56 +499,34 @@ bool UpdateTransaction::GetUpdatedEdgeData(bool dir, label_t label, vid_t v,
                                            label_t neighbor_label, vid_t nbr,
                                            label_t edge_label, Any& ret) const {
   size_t csr_index = dir ? get_out_csr_index(label, neighbor_label, edge_label)
-                         : get_in_csr_index(label, neighbor_label, edge_label);
-  auto map_iter = updated_edge_data_[csr_index].find(v);
-  if (map_iter == updated_edge_data_[csr_index].end()) {
+                         : get_in_csr_index(neighbor_label, label, edge_label);
+  size_t row;
+  if (updated_edge_data_[csr_index].find(v, nbr, row)) {
+    ret = updated_edge_data_[csr_index].get(row);
+    return true;
+  }
+  return get_added_edge_data(dir, label, v, neighbor_label, nbr, edge_label,
+                             ret);
+}
+
+bool UpdateTransaction::get_added_edge_data(bool dir, label_t label, vid_t v,
+                                            label_t neighbor_label, vid_t nbr,
+                                            label_t edge_label,
+                                            Any& ret) const {
+  const auto& added =
+      dir ? added_edges_[get_triplet_index(label, neighbor_label, edge_label)]
+          : added_edges_[get_triplet_index(neighbor_label, label, edge_label)];
+  size_t row;
+  if (!added.find(dir ? v : nbr, dir ? nbr : v, row)) {
     return false;
-  } else {
-    auto& updates = map_iter->second;
-    auto iter = updates.find(nbr);
-    if (iter == updates.end()) {
-      return false;
-    } else {
-      ret = iter->second;
-      return true;
-    }
   }
+  ret = added.get(row);
+  return true;
 }
 
 void UpdateTransaction::IngestWal(MutablePropertyFragment& graph,
                                   uint32_t timestamp, char* data, size_t length,
                                   ArenaAllocator& alloc) {
-  std::vector<IdIndexer<oid_t, vid_t>> added_vertices;
-  std::vector<vid_t> added_vertices_base;
-  std::vector<vid_t> vertex_nums;
-  std::vector<ska::flat_hash_map<vid_t, vid_t>> vertex_offsets;
-  std::vector<Table> extra_vertex_properties;
-
-  std::vector<ska::flat_hash_map<vid_t, std::vector<vid_t>>> added_edges;
-  std::vector<ska::flat_hash_map<vid_t, ska::flat_hash_map<vid_t, Any>>>
-      updated_edge_data;
-
-  size_t vertex_label_num = graph.schema().vertex_label_num();
-  size_t edge_label_num = graph.schema().edge_label_num();
-
-  added_vertices.resize(vertex_label_num);
-  added_vertices_base.resize(vertex_label_num);
-  vertex_nums.resize(vertex_label_num);
-  for (size_t i = 0; i < vertex_label_num; ++i) {
-    added_vertices_base[i] = vertex_nums[i] = graph.vertex_num(i);
-  }
-  vertex_offsets.resize(vertex_label_num);
-  extra_vertex_properties.resize(vertex_label_num);
-  for (size_t i = 0; i < vertex_label_num; ++i) {
-    const Table& table = graph.get_vertex_table(i);
-    extra_vertex_properties[i].init(table.column_names(), table.column_types(),
-                                    {}, 4096);
-  }
-
-  size_t csr_num = 2 * vertex_label_num * vertex_label_num * edge_label_num;
-  added_edges.resize(csr_num);
-  updated_edge_data.resize(csr_num);
-
   grape::OutArchive arc;
   arc.SetSlice(data, length);
   while (!arc.Empty()) {
@@ -442,6 +542,7 @@ void UpdateTransaction::IngestWal(MutablePropertyFragment& graph,
         vid = graph.add_vertex(label, oid);
       }
       graph.get_vertex_table(label).ingest(vid, arc);
+      graph.IndexVertex(label, vid);
     } else if (op_type == 1) {
       label_t src_label, dst_label, edge_label;
       oid_t src, dst;
@@ -461,6 +562,7 @@ void UpdateTransaction::IngestWal(MutablePropertyFragment& graph,
       vid_t vid;
       CHECK(graph.get_lid(label, oid, vid));
       graph.get_vertex_table(label).get_column_by_id(col_id)->ingest(vid, arc);
+      graph.IndexVertexField(label, vid, col_id);
     } else if (op_type == 3) {
       uint8_t dir;
       label_t label, neighbor_label, edge_label;
@@ -470,6 +572,11 @@ void UpdateTransaction::IngestWal(MutablePropertyFragment& graph,
       arc >> dir >> label >> v >> neighbor_label >> nbr >> edge_label;
       CHECK(graph.get_lid(label, v, v_lid));
       CHECK(graph.get_lid(neighbor_label, nbr, nbr_lid));
+      Any value;
+      value.type = graph.schema().get_edge_property(
+          dir == 0 ? neighbor_label : label, dir == 0 ? label : neighbor_label,
+          edge_label);
+      deserialize_field(arc, value);
 
       std::shared_ptr<MutableCsrEdgeIterBase> edge_iter(nullptr);
       if (dir == 0) {
@@ -480,45 +587,105 @@ void UpdateTransaction::IngestWal(MutablePropertyFragment& graph,
         edge_iter = graph.get_outgoing_edges_mut(label, v_lid, neighbor_label,
                                                  edge_label);
       }
-      Any value;
-      value.type = graph.schema().get_edge_property(
-          dir == 0 ? neighbor_label : label, dir == 0 ? label : neighbor_label,
-          label);
       while (edge_iter->is_valid()) {
         if (edge_iter->get_neighbor() == nbr_lid) {
-          deserialize_field(arc, value);
           edge_iter->set_data(value, timestamp);
         }
         edge_iter->next();
       }
+    } else if (op_type == 4) {
+      label_t src_label, dst_label, edge_label;
+      oid_t src, dst;
+      vid_t src_vid, dst_vid;
+
+      arc >> src_label >> src >> dst_label >> dst >> edge_label;
+      CHECK(graph.get_lid(src_label, src, src_vid));
+      CHECK(graph.get_lid(dst_label, dst, dst_vid));
+      graph.DeleteEdge(src_label, src_vid, dst_label, dst_vid, edge_label);
+    } else if (op_type == 5) {
+      label_t label;
+      oid_t oid;
+      vid_t vid;
+
+      arc >> label >> oid;
+      CHECK(graph.get_lid(label, oid, vid));
+      graph.DeleteVertex(label, vid);
+    } else if (op_type == 6) {
+      label_t src_label, dst_label, edge_label;
+      size_t num;
+      arc >> src_label >> dst_label >> edge_label >> num;
+      const oid_t* srcs =
+          static_cast<const oid_t*>(arc.GetBytes(sizeof(oid_t) * num));
+      const oid_t* dsts =
+          static_cast<const oid_t*>(arc.GetBytes(sizeof(oid_t) * num));
+      for (size_t i = 0; i < num; ++i) {
+        vid_t src_vid, dst_vid;
+        CHECK(graph.get_lid(src_label, srcs[i], src_vid));
+        CHECK(graph.get_lid(dst_label, dsts[i], dst_vid));
+        graph.IngestEdge(src_label, src_vid, dst_label, dst_vid, edge_label,
+                         timestamp, arc, alloc);
+      }
+    } else if (op_type == 7) {
+      // a property added to the vertices of label, see
+      // GraphDBSession::AddVertexProperty
+      label_t label;
+      std::string name;
+      uint8_t type;
+      arc >> label >> name >> type;
+      Any default_value;
+      default_value.type = static_cast<PropertyType>(type);
+      deserialize_field(arc, default_value);
+      auto column = CreateColumn(default_value.type);
+      column->init(graph.schema().get_max_vnum(
+          graph.schema().get_vertex_label_name(label)));
+      FillColumn(*column, 0, graph.vertex_num(label), default_value,
+                 std::max<int>(std::thread::hardware_concurrency(), 1));
+      graph.AddVertexProperty(label, name, std::move(column));
     } else {
       LOG(FATAL) << "unexpected op_type";
     }
   }
 }
 
-size_t UpdateTransaction::get_in_csr_index(label_t src_label, label_t dst_label,
-                                           label_t edge_label) const {
+bool UpdateTransaction::vertexPropertiesAdded() const {
+  for (label_t label = 0; label < vertex_label_num_; ++label) {
+    if (!vertex_offsets_[label].empty() &&
+        extra_vertex_properties_[label].col_num() !=
+            graph_.get_vertex_table(label).col_num()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+size_t UpdateTransaction::get_triplet_index(label_t src_label,
+                                            label_t dst_label,
+                                            label_t edge_label) const {
   return src_label * vertex_label_num_ * edge_label_num_ +
          dst_label * edge_label_num_ + edge_label;
 }
 
+size_t UpdateTransaction::get_in_csr_index(label_t src_label, label_t dst_label,
+                                           label_t edge_label) const {
+  return get_triplet_index(src_label, dst_label, edge_label);
+}
+
 size_t UpdateTransaction::get_out_csr_index(label_t src_label,
                                             label_t dst_label,
                                             label_t edge_label) const {
-  return src_label * vertex_label_num_ * edge_label_num_ +
-         dst_label * edge_label_num_ + edge_label +
+  return get_triplet_index(src_label, dst_label, edge_label) +
          vertex_label_num_ * vertex_label_num_ * edge_label_num_;
 }
 
 bool UpdateTransaction::oid_to_lid(label_t label, oid_t oid, vid_t& lid) const {
-  if (graph_.get_lid(label, oid, lid)) {
+  if (graph_.get_lid(label, oid, lid) &&
+      deleted_vertices_[label].count(lid) == 0) {
+    return true;
+  }
+  // a deleted vertex may have been added again as a new one
+  if (added_vertices_[label].get_index(oid, lid)) {
+    lid += added_vertices_base_[label];
     return true;
-  } else {
-    if (added_vertices_[label].get_index(oid, lid)) {
-      lid += added_vertices_base_[label];
-      return true;
-    }
   }
   return false;
 }
@@ -534,24 +701,122 @@ oid_t UpdateTransaction::lid_to_oid(label_t label, vid_t lid) const {
   }
 }
 
+vid_t UpdateTransaction::resolve_lid(label_t label, vid_t lid) const {
+  if (lid < added_vertices_base_[label]) {
+    return lid;
+  }
+  return added_vertices_lid_[label][lid - added_vertices_base_[label]];
+}
+
 void UpdateTransaction::release() {
-  if (timestamp_ != std::numeric_limits<timestamp_t>::max()) {
+  if (in_epoch_) {
+    vm_.epoch_manager().exit(epoch_);
+    in_epoch_ = false;
+  }
+  if (valid_) {
     arc_.Clear();
-    vm_.release_update_timestamp(timestamp_);
+    valid_ = false;
     timestamp_ = std::numeric_limits<timestamp_t>::max();
 
     op_num_ = 0;
+    in_place_op_num_ = 0;
 
     added_vertices_.clear();
     added_vertices_base_.clear();
+    added_vertices_lid_.clear();
     vertex_offsets_.clear();
     extra_vertex_properties_.clear();
     added_edges_.clear();
     updated_edge_data_.clear();
+    deleted_vertices_.clear();
+    deleted_edges_.clear();
+  }
+}
+
+void UpdateTransaction::drop_added_edges(label_t label, vid_t v) {
+  for (label_t nbr_label = 0; nbr_label < vertex_label_num_; ++nbr_label) {
+    for (label_t edge_label = 0; edge_label < edge_label_num_; ++edge_label) {
+      auto& out_edges =
+          added_edges_[get_triplet_index(label, nbr_label, edge_label)];
+      if (!out_edges.empty()) {
+        out_edges.remove_vertex(true, v);
+      }
+      auto& in_edges =
+          added_edges_[get_triplet_index(nbr_label, label, edge_label)];
+      if (!in_edges.empty()) {
+        in_edges.remove_vertex(false, v);
+      }
+    }
+  }
+}
+
+void UpdateTransaction::set_edge_data(const MutableCsrBase* csr, vid_t v,
+                                      MutableCsrEdgeIterBase& edge_iter,
+                                      const Any& value) {
+  auto& history = graph_.history();
+  if (history.enabled()) {
+    // the edge keeps its timestamp to stay visible to older reads, which
+    // find its old data in the history
+    history.record_edge(csr, v, edge_iter.get_neighbor(), timestamp_,
+                        edge_iter.get_data());
+    edge_iter.set_data(value, edge_iter.get_timestamp());
+  } else {
+    edge_iter.set_data(value, timestamp_);
+  }
+}
+
+void UpdateTransaction::applyDeletes() {
+  bool deleted = !deleted_edges_.empty();
+  for (auto& vertices : deleted_vertices_) {
+    deleted = deleted || !vertices.empty();
+  }
+  if (deleted) {
+    // deleted edges and vertices are not kept for older reads
+    graph_.history().reset(timestamp_);
+  }
+  for (auto& edge : deleted_edges_) {
+    graph_.DeleteEdge(std::get<0>(edge), std::get<1>(edge), std::get<2>(edge),
+                      std::get<3>(edge), std::get<4>(edge));
+  }
+  for (label_t label = 0; label < vertex_label_num_; ++label) {
+    for (auto lid : deleted_vertices_[label]) {
+      graph_.DeleteVertex(label, lid);
+    }
+  }
+  deleted_edges_.clear();
+  deleted_vertices_.clear();
+}
+
+void UpdateTransaction::serializeEdges() {
+  for (label_t src_label = 0; src_label < vertex_label_num_; ++src_label) {
+    for (label_t dst_label = 0; dst_label < vertex_label_num_; ++dst_label) {
+      for (label_t edge_label = 0; edge_label < edge_label_num_; ++edge_label) {
+        const auto& added =
+            added_edges_[get_triplet_index(src_label, dst_label, edge_label)];
+        if (added.empty()) {
+          continue;
+        }
+        size_t num = added.edge_num();
+        arc_ << static_cast<uint8_t>(6) << src_label << dst_label << edge_label
+             << num;
+        for (size_t row = 0; row < added.size(); ++row) {
+          if (!added.removed(row)) {
+            arc_ << lid_to_oid(src_label, added.src(row));
+          }
+        }
+        for (size_t row = 0; row < added.size(); ++row) {
+          if (!added.removed(row)) {
+            arc_ << lid_to_oid(dst_label, added.dst(row));
+          }
+        }
+        added.serialize_data(arc_);
+      }
+    }
   }
 }
 
 void UpdateTransaction::applyVerticesUpdates() {
+  added_vertices_lid_.resize(vertex_label_num_);
   for (label_t label = 0; label < vertex_label_num_; ++label) {
     std::vector<std::pair<vid_t, oid_t>> added_vertices;
     vid_t added_vertices_num = added_vertices_[label].size();
@@ -569,21 +834,41 @@ void UpdateTransaction::applyVerticesUpdates() {
 
     auto& table = extra_vertex_properties_[label];
     auto& vertex_offset = vertex_offsets_[label];
+    // Concurrent sessions may have added vertices since this transaction
+    // started, so the vids assigned locally are remapped to the real ones.
+    auto& lid_map = added_vertices_lid_[label];
+    lid_map.resize(added_vertices.size());
     for (auto& pair : added_vertices) {
       vid_t offset = vertex_offset.at(pair.first);
-      vid_t lid = graph_.add_vertex(label, pair.second);
+      vid_t lid;
+      {
+        auto& lock = vm_.vertex_lock(label, pair.second);
+        lock.lock();
+        if (!graph_.get_lid(label, pair.second, lid)) {
+          lid = graph_.add_vertex(label, pair.second);
+        }
+        lock.unlock();
+      }
       graph_.get_vertex_table(label).insert(lid, table.get_row(offset));
-      CHECK_EQ(lid, pair.first);
+      graph_.IndexVertex(label, lid);
+      lid_map[pair.first - added_vertices_base_[label]] = lid;
       vertex_offset.erase(pair.first);
     }
 
+    auto& history = graph_.history();
+    auto& vertex_table = graph_.get_vertex_table(label);
     for (auto& pair : vertex_offset) {
       vid_t lid = pair.first;
       vid_t offset = pair.second;
-      graph_.get_vertex_table(label).insert(lid, table.get_row(offset));
+      if (history.enabled()) {
+        for (size_t i = 0; i < vertex_table.col_num(); ++i) {
+          history.record_vertex(label, lid, i, timestamp_,
+                                vertex_table.get_column_by_id(i)->get(lid));
+        }
+      }
+      vertex_table.insert(lid, table.get_row(offset));
+      graph_.IndexVertex(label, lid);
     }
-
-    CHECK_EQ(graph_.vertex_num(label), vertex_nums_[label]);
   }
 
   added_vertices_.clear();
@@ -592,84 +877,83 @@ void UpdateTransaction::applyVerticesUpdates() {
   extra_vertex_properties_.clear();
 }
 
-void UpdateTransaction::applyEdgesUpdates() {
-  for (label_t src_label = 0; src_label < vertex_label_num_; ++src_label) {
-    for (label_t dst_label = 0; dst_label < vertex_label_num_; ++dst_label) {
-      for (label_t edge_label = 0; edge_label < edge_label_num_; ++edge_label) {
-        size_t oe_csr_index =
-            get_out_csr_index(src_label, dst_label, edge_label);
-        for (auto& pair : updated_edge_data_[oe_csr_index]) {
-          auto& updates = pair.second;
-          if (updates.empty()) {
-            continue;
-          }
-          std::shared_ptr<MutableCsrEdgeIterBase> edge_iter =
-              graph_.get_outgoing_edges_mut(src_label, pair.first, dst_label,
+void UpdateTransaction::applyEdgeDataUpdates(bool dir, label_t src_label,
+                                             label_t dst_label,
+                                             label_t edge_label) {
+  const auto& updates =
+      updated_edge_data_[dir ? get_out_csr_index(src_label, dst_label,
+                                                 edge_label)
+                             : get_in_csr_index(src_label, dst_label,
+                                                edge_label)];
+  if (updates.empty() || in_place_op_num_ == 0) {
+    return;
+  }
+  label_t label = dir ? src_label : dst_label;
+  label_t neighbor_label = dir ? dst_label : src_label;
+  MutableCsrBase* csr = dir ? graph_.get_oe_csr(src_label, dst_label, edge_label)
+                            : graph_.get_ie_csr(dst_label, src_label, edge_label);
+  // the updates of a vertex are sorted by neighbor, each edge of its list
+  // takes the latest one of its neighbor
+  const auto& index = updates.index(true);
+  size_t num = index.rows.size();
+  for (size_t begin = 0; begin < num;) {
+    vid_t v = index.vertices[begin];
+    size_t end = begin;
+    while (end < num && index.vertices[end] == v) {
+      ++end;
+    }
+    std::shared_ptr<MutableCsrEdgeIterBase> edge_iter =
+        dir ? graph_.get_outgoing_edges_mut(label, v, neighbor_label,
+                                            edge_label)
+            : graph_.get_incoming_edges_mut(label, v, neighbor_label,
                                             edge_label);
-          while (edge_iter->is_valid()) {
-            auto iter = updates.find(edge_iter->get_neighbor());
-            if (iter != updates.end()) {
-              edge_iter->set_data(iter->second, timestamp_);
-            }
-            edge_iter->next();
-          }
-        }
-
-        MutableCsrBase* csr =
-            graph_.get_oe_csr(src_label, dst_label, edge_label);
-
-        for (auto& pair : added_edges_[oe_csr_index]) {
-          vid_t v = pair.first;
-          auto& add_list = pair.second;
-          if (add_list.empty()) {
-            continue;
-          }
-          auto& edge_data = updated_edge_data_[oe_csr_index].at(v);
-          for (auto u : add_list) {
-            auto value = edge_data.at(u);
-            csr->put_generic_edge(v, u, value, timestamp_, alloc_);
-          }
-        }
+    auto first = index.neighbors.begin() + begin;
+    auto last = index.neighbors.begin() + end;
+    while (edge_iter->is_valid()) {
+      auto iter = std::upper_bound(first, last, edge_iter->get_neighbor());
+      if (iter != first && *(iter - 1) == edge_iter->get_neighbor()) {
+        size_t row = index.rows[iter - index.neighbors.begin() - 1];
+        set_edge_data(csr, v, *edge_iter, updates.get(row));
       }
+      edge_iter->next();
     }
+    begin = end;
   }
+}
 
+void UpdateTransaction::applyEdgesUpdates() {
   for (label_t src_label = 0; src_label < vertex_label_num_; ++src_label) {
     for (label_t dst_label = 0; dst_label < vertex_label_num_; ++dst_label) {
       for (label_t edge_label = 0; edge_label < edge_label_num_; ++edge_label) {
-        size_t ie_csr_index =
-            get_in_csr_index(src_label, dst_label, edge_label);
-        for (auto& pair : updated_edge_data_[ie_csr_index]) {
-          auto& updates = pair.second;
-          if (updates.empty()) {
-            continue;
-          }
-          std::shared_ptr<MutableCsrEdgeIterBase> edge_iter =
-              graph_.get_incoming_edges_mut(dst_label, pair.first, src_label,
-                                            edge_label);
-          while (edge_iter->is_valid()) {
-            auto iter = updates.find(edge_iter->get_neighbor());
-            if (iter != updates.end()) {
-              edge_iter->set_data(iter->second, timestamp_);
-            }
-            edge_iter->next();
-          }
-        }
+        applyEdgeDataUpdates(true, src_label, dst_label, edge_label);
+        applyEdgeDataUpdates(false, src_label, dst_label, edge_label);
 
-        MutableCsrBase* csr =
+        const auto& added =
+            added_edges_[get_triplet_index(src_label, dst_label, edge_label)];
+        if (added.empty()) {
+          continue;
+        }
+        // put with a timestamp IngestEdge does not record
+        graph_.MarkEdgesUpdated(src_label, dst_label, edge_label);
+        // edges are put in the order of the vertices of each csr, so that
+        // appends to the same list are adjacent
+        MutableCsrBase* oe_csr =
+            graph_.get_oe_csr(src_label, dst_label, edge_label);
+        const auto& out_index = added.index(true);
+        for (size_t i = 0; i < out_index.rows.size(); ++i) {
+          oe_csr->put_generic_edge(
+              resolve_lid(src_label, out_index.vertices[i]),
+              resolve_lid(dst_label, out_index.neighbors[i]),
+              added.get(out_index.rows[i]), timestamp_, alloc_);
+        }
+        MutableCsrBase* ie_csr =
             graph_.get_ie_csr(dst_label, src_label, edge_label);
-
-        for (auto& pair : added_edges_[ie_csr_index]) {
-          vid_t v = pair.first;
-          auto& add_list = pair.second;
-          if (add_list.empty()) {
-            continue;
-          }
-          auto& edge_data = updated_edge_data_[ie_csr_index].at(v);
-          for (auto u : add_list) {
-            auto value = edge_data.at(u);
-            csr->put_generic_edge(v, u, value, timestamp_, alloc_);
-          }
+        const auto& in_index = added.index(false);
+        for (size_t i = 0; i < in_index.rows.size(); ++i) {
+          ie_csr->put_generic_edge(
+              resolve_lid(dst_label, in_index.vertices[i]),
+              resolve_lid(src_label, in_index.neighbors[i]),
+              added.get(in_index.rows[i]), timestamp_, alloc_);
         }
       }
     }
@@ -17,9 +17,11 @@
 #define GRAPHSCOPE_DATABASE_UPDATE_TRANSACTION_H_
 
 #include <limits>
+#include <tuple>
 #include <utility>
 
 #include "flat_hash_map/flat_hash_map.hpp"
+#include "flex/engines/graph_db/database/edge_redo_buffer.h"
 #include "flex/storages/rt_mutable_graph/mutable_csr.h"
 #include "flex/storages/rt_mutable_graph/types.h"
 #include "flex/utils/id_indexer.h"
@@ -34,14 +36,25 @@ class ArenaAllocator;
 class WalWriter;
 class VersionManager;
 
+/**
+ * @brief Transaction to update vertices and edges.
+ *
+ * Changes are buffered locally and a timestamp is only acquired in Commit(),
+ * so building an update never blocks other sessions. Added edges and updated
+ * edge data are kept in columnar redo buffers per edge triplet, which are
+ * sorted once at commit and written to the wal as edge batches. Updates that only add
+ * vertices and edges commit concurrently with readers and other writers;
+ * updates that overwrite existing properties or edge data take the version
+ * manager exclusively while the changes are applied.
+ */
 class UpdateTransaction {
  public:
   UpdateTransaction(MutablePropertyFragment& graph, ArenaAllocator& alloc,
-                    WalWriter& logger, VersionManager& vm,
-                    timestamp_t timestamp);
+                    WalWriter& logger, VersionManager& vm);
 
   ~UpdateTransaction();
 
+  // The commit timestamp, only valid during Commit().
   timestamp_t timestamp() const;
 
   void Commit();
@@ -53,6 +66,23 @@ class UpdateTransaction {
   bool AddEdge(label_t src_label, oid_t src, label_t dst_label, oid_t dst,
                label_t edge_label, const Any& value);
 
+  /**
+   * @brief Delete the edges from src to dst of an edge label, including
+   * those added by this transaction before. Edges of static edge types can
+   * not be deleted.
+   */
+  bool DeleteEdge(label_t src_label, oid_t src, label_t dst_label, oid_t dst,
+                  label_t edge_label);
+
+  /**
+   * @brief Delete a vertex of the graph with all its edges. Later operations
+   * of this transaction do not find it anymore, and adding its oid again
+   * creates a vertex without the old edges. Vertices added by this
+   * transaction, or with a label connected by static edge types, can not be
+   * deleted.
+   */
+  bool DeleteVertex(label_t label, oid_t oid);
+
   class vertex_iterator {
    public:
     vertex_iterator(label_t label, vid_t cur, vid_t& num,
@@ -140,20 +170,49 @@ class UpdateTransaction {
                         char* data, size_t length, ArenaAllocator& alloc);
 
  private:
+  size_t get_triplet_index(label_t src_label, label_t dst_label,
+                           label_t edge_label) const;
+
+  // The csrs of an edge triplet, given by the labels of the edge.
   size_t get_in_csr_index(label_t src_label, label_t dst_label,
                           label_t edge_label) const;
 
   size_t get_out_csr_index(label_t src_label, label_t dst_label,
                            label_t edge_label) const;
 
+  bool get_added_edge_data(bool dir, label_t label, vid_t v,
+                           label_t neighbor_label, vid_t nbr,
+                           label_t edge_label, Any& ret) const;
+
   bool oid_to_lid(label_t label, oid_t oid, vid_t& lid) const;
 
   oid_t lid_to_oid(label_t label, vid_t lid) const;
 
+  // Map a vid assigned inside this transaction to the one in the graph.
+  vid_t resolve_lid(label_t label, vid_t lid) const;
+
   void release();
 
+  // Remove the edges of v added by this transaction.
+  void drop_added_edges(label_t label, vid_t v);
+
+  void applyDeletes();
+
+  void set_edge_data(const MutableCsrBase* csr, vid_t v,
+                     MutableCsrEdgeIterBase& edge_iter, const Any& value);
+
+  // Append the added edges to the wal record, a batch per edge triplet.
+  void serializeEdges();
+
+  // Whether properties were added to the labels of the vertices added by
+  // this transaction since it started, whose rows would miss them.
+  bool vertexPropertiesAdded() const;
+
   void applyVerticesUpdates();
 
+  void applyEdgeDataUpdates(bool dir, label_t src_label, label_t dst_label,
+                            label_t edge_label);
+
   void applyEdgesUpdates();
 
   MutablePropertyFragment& graph_;
@@ -161,24 +220,35 @@ class UpdateTransaction {
   WalWriter& logger_;
   VersionManager& vm_;
   timestamp_t timestamp_;
+  bool valid_;
+  // epoch held while adjacency lists may be read before committing
+  uint64_t epoch_;
+  bool in_epoch_;
 
   grape::InArchive arc_;
   int op_num_;
+  int in_place_op_num_;
 
   size_t vertex_label_num_;
   size_t edge_label_num_;
 
   std::vector<IdIndexer<oid_t, vid_t>> added_vertices_;
   std::vector<vid_t> added_vertices_base_;
+  std::vector<std::vector<vid_t>> added_vertices_lid_;
   std::vector<vid_t> vertex_nums_;
   std::vector<ska::flat_hash_map<vid_t, vid_t>> vertex_offsets_;
   std::vector<Table> extra_vertex_properties_;
 
-  std::vector<ska::flat_hash_map<vid_t, std::vector<vid_t>>> added_edges_;
-  std::vector<ska::flat_hash_map<vid_t, ska::flat_hash_map<vid_t, Any>>>
-      updated_edge_data_;
+  // edges added by this transaction, by edge triplet
+  std::vector<EdgeRedoBuffer> added_edges_;
+  // data set to edges of the graph, by csr, from the vertex of the csr to
+  // the neighbor
+  std::vector<EdgeRedoBuffer> updated_edge_data_;
 
-  std::vector<std::string> sv_vec_;
+  // vertices and edges of the graph to delete, applied before the updates
+  std::vector<ska::flat_hash_set<vid_t>> deleted_vertices_;
+  std::vector<std::tuple<label_t, vid_t, label_t, vid_t, label_t>>
+      deleted_edges_;
 };
 
 }  // namespace gs
@@ -16,6 +16,8 @@
 #include "flex/engines/graph_db/database/version_manager.h"
 
 #include "flex/engines/graph_db/app/app_base.h"
+#include "flex/utils/metrics.h"
+#include "flex/utils/usdt.h"
 
 #define likely(x) __builtin_expect(!!(x), 1)
 
@@ -24,6 +26,17 @@ namespace gs {
 constexpr static uint32_t ring_buf_size = 1024 * 1024;
 constexpr static uint32_t ring_index_mask = ring_buf_size - 1;
 
+// Only transactions which had to wait are timed, the fast paths stay free of
+// clock reads. The waits also fire the probes flex:version_wait_begin and
+// flex:version_wait_end with their kind.
+static Histogram& wait_latency(const char* kind) {
+  return MetricsRegistry::get().GetHistogram(
+      "graph_db_version_wait_us",
+      "Microseconds transactions waited for exclusive updates to leave, or "
+      "exclusive updates for other transactions to drain",
+      std::string("kind=\"") + kind + "\"");
+}
+
 VersionManager::VersionManager() { buf_.init(ring_buf_size); }
 
 VersionManager::~VersionManager() {}
@@ -38,12 +51,16 @@ uint32_t VersionManager::acquire_read_timestamp() {
   if (likely(pr >= 0)) {
     return read_ts_.load();
   } else {
+    static Histogram& latency = wait_latency("read");
+    ScopedLatency timer(latency);
+    FLEX_PROBE1(version_wait_begin, "read");
     while (true) {
       while (pending_reqs_.load() < 0) {
         std::this_thread::sleep_for(std::chrono::microseconds(100));
       }
       pr = pending_reqs_.fetch_add(1);
       if (pr >= 0) {
+        FLEX_PROBE1(version_wait_end, "read");
         return read_ts_.load();
       }
     }
@@ -57,18 +74,22 @@ uint32_t VersionManager::acquire_insert_timestamp() {
   if (likely(pr >= 0)) {
     return write_ts_.fetch_add(1);
   } else {
+    static Histogram& latency = wait_latency("insert");
+    ScopedLatency timer(latency);
+    FLEX_PROBE1(version_wait_begin, "insert");
     while (true) {
       while (pending_reqs_.load() < 0) {
         std::this_thread::sleep_for(std::chrono::microseconds(100));
       }
       pr = pending_reqs_.fetch_add(1);
       if (pr >= 0) {
+        FLEX_PROBE1(version_wait_end, "insert");
         return write_ts_.fetch_add(1);
       }
     }
   }
 }
-void VersionManager::release_insert_timestamp(uint32_t ts) {
+void VersionManager::advance_read_ts(uint32_t ts) {
   lock_.lock();
   if (ts == read_ts_.load() + 1) {
     while (buf_.reset_bit_with_ret((ts + 1) & ring_index_mask)) {
@@ -79,22 +100,48 @@ void VersionManager::release_insert_timestamp(uint32_t ts) {
     buf_.set_bit(ts & ring_index_mask);
   }
   lock_.unlock();
+}
 
+void VersionManager::release_insert_timestamp(uint32_t ts) {
+  advance_read_ts(ts);
   pending_reqs_.fetch_sub(1);
 }
 
 uint32_t VersionManager::acquire_update_timestamp() {
+  acquire_exclusive();
+  return write_ts_.fetch_add(1);
+}
+void VersionManager::release_update_timestamp(uint32_t ts) {
+  advance_read_ts(ts);
+  release_exclusive();
+}
+
+void VersionManager::acquire_exclusive() {
+  static Histogram& latency = wait_latency("exclusive");
+  ScopedLatency timer(latency);
+  FLEX_PROBE1(version_wait_begin, "exclusive");
   int expected = 0;
   while (!pending_reqs_.compare_exchange_strong(
       expected, std::numeric_limits<int>::min())) {
     expected = 0;
     std::this_thread::sleep_for(std::chrono::microseconds(100));
   }
-  return write_ts_.fetch_add(1);
+  FLEX_PROBE1(version_wait_end, "exclusive");
 }
-void VersionManager::release_update_timestamp(uint32_t ts) {
-  buf_.set_bit(ts & ring_index_mask);
-  pending_reqs_.store(0);
+void VersionManager::release_exclusive() { pending_reqs_.store(0); }
+
+void VersionManager::wait_for_writes() {
+  uint32_t ts = write_ts_.load() - 1;
+  while (read_ts_.load() < ts) {
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+  }
+}
+
+grape::SpinLock& VersionManager::vertex_lock(uint8_t label, int64_t oid) {
+  uint64_t x = static_cast<uint64_t>(oid) ^ (static_cast<uint64_t>(label) << 56);
+  x = (x ^ (x >> 30)) * UINT64_C(0xbf58476d1ce4e5b9);
+  x = x ^ (x >> 31);
+  return vertex_locks_[x % vertex_lock_num];
 }
 
 }  // namespace gs
@@ -25,6 +25,7 @@
 #include <bitset>
 #include <thread>
 
+#include "flex/utils/allocators.h"
 #include "glog/logging.h"
 #include "grape/utils/bitset.h"
 #include "grape/utils/concurrent_queue.h"
@@ -40,15 +41,54 @@ class VersionManager {
 
   uint32_t acquire_read_timestamp();
 
+  /** @brief The latest timestamp readable, without acquiring it. */
+  uint32_t read_timestamp() const { return read_ts_.load(); }
+
+  /** @brief The next write timestamp to acquire. */
+  uint32_t write_timestamp() const { return write_ts_.load(); }
+
   void release_read_timestamp();
 
   uint32_t acquire_insert_timestamp();
   void release_insert_timestamp(uint32_t ts);
 
+  /**
+   * @brief Acquire a timestamp for an update that modifies existing data in
+   * place. It waits until all in-flight readers and writers drain, and blocks
+   * new ones until released. Updates that only append new vertices and edges
+   * should use acquire_insert_timestamp instead, since appended data is
+   * filtered by timestamp and never disturbs older snapshots.
+   */
   uint32_t acquire_update_timestamp();
   void release_update_timestamp(uint32_t ts);
 
+  /**
+   * @brief Exclude all other transactions like an update, without taking a
+   * timestamp, for maintenance that moves data but never changes it.
+   */
+  void acquire_exclusive();
+  void release_exclusive();
+
+  /**
+   * @brief Wait until every write timestamp acquired so far is released.
+   */
+  void wait_for_writes();
+
+  /**
+   * @brief Lock guarding the creation of vertex (label, oid), so that
+   * concurrent update transactions never add the same vertex twice.
+   */
+  grape::SpinLock& vertex_lock(uint8_t label, int64_t oid);
+
+  /**
+   * @brief Epochs of transactions reading adjacency lists, buffers outgrown
+   * by insertions are reused only after these readers have left.
+   */
+  EpochManager& epoch_manager() { return epoch_manager_; }
+
  private:
+  void advance_read_ts(uint32_t ts);
+
   std::atomic<uint32_t> write_ts_{1};
   std::atomic<uint32_t> read_ts_{0};
 
@@ -56,6 +96,11 @@ class VersionManager {
 
   grape::Bitset buf_;
   grape::SpinLock lock_;
+
+  static constexpr size_t vertex_lock_num = 1024;
+  std::array<grape::SpinLock, vertex_lock_num> vertex_locks_;
+
+  EpochManager epoch_manager_;
 };
 
 }  // namespace gs
@@ -14,13 +14,39 @@
  */
 
 #include "flex/engines/graph_db/database/wal.h"
+#include "flex/engines/graph_db/database/wal_stream.h"
+#include "flex/utils/metrics.h"
+#include "flex/utils/usdt.h"
 
+#include <sys/uio.h>
+
+#include <atomic>
 #include <chrono>
+#include <cstring>
 #include <filesystem>
+#include <memory>
+
+#ifdef FLEX_WITH_LZ4
+#include <lz4.h>
+#endif
 
 namespace gs {
 
+// Reserve the blocks of a wal file up front, so that appends neither
+// allocate them nor extend the file, and their syncs have less metadata to
+// write. Falls back to a sparse file where fallocate is not supported.
+static int preallocate(int fd, size_t size) {
+#ifdef __linux__
+  if (fallocate(fd, 0, 0, size) == 0) {
+    return 0;
+  }
+#endif
+  return ftruncate(fd, size);
+}
+
 void WalWriter::open(const std::string& prefix, int thread_id) {
+  prefix_ = prefix;
+  thread_id_ = thread_id;
   const int max_version = 65536;
   for (int version = 0; version != max_version; ++version) {
     std::string path = prefix + "/thread_" + std::to_string(thread_id) + "_" +
@@ -29,19 +55,35 @@ void WalWriter::open(const std::string& prefix, int thread_id) {
       continue;
     }
     fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    path_ = path;
     break;
   }
   if (fd_ == -1) {
     LOG(FATAL) << "Failed to open wal file";
   }
-  if (ftruncate(fd_, TRUNC_SIZE) != 0) {
+  if (preallocate(fd_, TRUNC_SIZE) != 0) {
     LOG(FATAL) << "Failed to truncate wal file";
   }
   file_size_ = TRUNC_SIZE;
   file_used_ = 0;
 }
 
+void WalWriter::open(WalGroupCommitter* group_committer) {
+  group_committer_ = group_committer;
+}
+
+void WalWriter::set_compression(bool compress) {
+#ifndef FLEX_WITH_LZ4
+  if (compress) {
+    LOG(WARNING) << "Wal compression is ignored, LZ4 is not built in";
+    compress = false;
+  }
+#endif
+  compress_ = compress;
+}
+
 void WalWriter::close() {
+  group_committer_ = nullptr;
   if (fd_ != -1) {
     ::close(fd_);
     fd_ = -1;
@@ -52,42 +94,370 @@ void WalWriter::close() {
 
 #define unlikely(x) __builtin_expect(!!(x), 0)
 
-void WalWriter::append(const char* data, size_t length) {
-  if (unlikely(fd_ == -1)) {
-    return;
-  }
-  size_t expected_size = file_used_ + length;
-  if (expected_size > file_size_) {
-    size_t new_file_size = (expected_size / TRUNC_SIZE + 1) * TRUNC_SIZE;
-    if (ftruncate(fd_, new_file_size) != 0) {
+static void write_and_sync(int fd, size_t& file_size, size_t& file_used,
+                           size_t trunc_size, const char* data,
+                           size_t length) {
+  size_t expected_size = file_used + length;
+  if (expected_size > file_size) {
+    size_t new_file_size = (expected_size / trunc_size + 1) * trunc_size;
+    if (preallocate(fd, new_file_size) != 0) {
       LOG(FATAL) << "Failed to truncate wal file";
     }
-    file_size_ = new_file_size;
+    file_size = new_file_size;
   }
 
-  file_used_ += length;
+  off_t offset = file_used;
+  file_used += length;
 
-  if (static_cast<size_t>(write(fd_, data, length)) != length) {
+#ifdef F_FULLFSYNC
+  if (static_cast<size_t>(pwrite(fd, data, length, offset)) != length) {
     LOG(FATAL) << "Failed to write wal file";
   }
-
-#if 1
-#ifdef F_FULLFSYNC
-  if (fcntl(fd_, F_FULLFSYNC) != 0) {
+  if (fcntl(fd, F_FULLFSYNC) != 0) {
     LOG(FATAL) << "Failed to fcntl sync wal file";
   }
 #else
-  // if (fsync(fd_) != 0) {
-  if (fdatasync(fd_) != 0) {
-    LOG(FATAL) << "Failed to fsync wal file";
+  static Histogram& fsync_latency = MetricsRegistry::get().GetHistogram(
+      "graph_db_wal_fsync_us",
+      "Microseconds of the synced writes of wal files");
+#ifdef RWF_DSYNC
+  // Write and sync the data in a single syscall, until the kernel or the
+  // file system turns out not to support it.
+  static std::atomic<bool> dsync_write_supported(true);
+  if (dsync_write_supported.load(std::memory_order_relaxed)) {
+    ScopedLatency timer(fsync_latency);
+    struct iovec iov = {const_cast<char*>(data), length};
+    ssize_t written = pwritev2(fd, &iov, 1, offset, RWF_DSYNC);
+    if (static_cast<size_t>(written) == length) {
+      return;
+    }
+    if (written >= 0 ||
+        (errno != EOPNOTSUPP && errno != ENOSYS && errno != EINVAL)) {
+      LOG(FATAL) << "Failed to write wal file";
+    }
+    LOG(WARNING) << "Synced writes are not supported, fall back to fdatasync";
+    dsync_write_supported.store(false, std::memory_order_relaxed);
   }
 #endif
+  if (static_cast<size_t>(pwrite(fd, data, length, offset)) != length) {
+    LOG(FATAL) << "Failed to write wal file";
+  }
+  ScopedLatency timer(fsync_latency);
+  if (fdatasync(fd) != 0) {
+    LOG(FATAL) << "Failed to fsync wal file";
+  }
 #endif
 }
 
+void WalWriter::append(const char* data, size_t length) {
+  static Histogram& append_latency = MetricsRegistry::get().GetHistogram(
+      "graph_db_wal_append_us",
+      "Microseconds until wal records are durable, including the wait for "
+      "their group commit");
+  // a length overflowing the header is silently truncated by it
+  CHECK_EQ(reinterpret_cast<const WalHeader*>(data)->length,
+           length - sizeof(WalHeader));
+  {
+    ScopedLatency timer(append_latency);
+    FLEX_PROBE1(wal_append_begin, length);
+    const char* record = data;
+    size_t record_length = length;
+    if (compress_ && compress_wal_record(data, length, compressed_)) {
+      record = compressed_.data();
+      record_length = compressed_.size();
+    }
+    if (group_committer_ != nullptr) {
+      group_committer_->append(record, record_length);
+    } else {
+      std::lock_guard<std::mutex> guard(lock_);
+      if (unlikely(fd_ == -1)) {
+        return;
+      }
+      write_and_sync(fd_, file_size_, file_used_, TRUNC_SIZE, record,
+                     record_length);
+    }
+    FLEX_PROBE1(wal_append_end, length);
+  }
+  if (shipper_ != nullptr) {
+    shipper_->ship(data, length);
+  }
+}
+
+void WalWriter::append_async(const char* data, size_t length,
+                             std::function<void()> on_durable) {
+  if (group_committer_ == nullptr) {
+    append(data, length);
+    if (on_durable) {
+      on_durable();
+    }
+    return;
+  }
+  CHECK_EQ(reinterpret_cast<const WalHeader*>(data)->length,
+           length - sizeof(WalHeader));
+  const char* record = data;
+  size_t record_length = length;
+  if (compress_ && compress_wal_record(data, length, compressed_)) {
+    record = compressed_.data();
+    record_length = compressed_.size();
+  }
+  if (shipper_ != nullptr) {
+    // replicas must not get records the primary may lose
+    auto shipper = shipper_;
+    auto raw = std::make_shared<std::string>(data, length);
+    group_committer_->append_async(
+        record, record_length,
+        [shipper, raw, on_durable = std::move(on_durable)]() {
+          shipper->ship(raw->data(), raw->size());
+          if (on_durable) {
+            on_durable();
+          }
+        });
+  } else {
+    group_committer_->append_async(record, record_length,
+                                   std::move(on_durable));
+  }
+}
+
+std::string WalWriter::rotate() {
+  if (group_committer_ != nullptr) {
+    return "";
+  }
+  std::lock_guard<std::mutex> guard(lock_);
+  if (fd_ == -1 || file_used_ == 0) {
+    return "";
+  }
+  std::string sealed = path_;
+  ::close(fd_);
+  fd_ = -1;
+  open(prefix_, thread_id_);
+  return sealed;
+}
+
+size_t WalWriter::used_bytes() {
+  std::lock_guard<std::mutex> guard(lock_);
+  return group_committer_ == nullptr ? file_used_ : 0;
+}
+
 #undef unlikely
 
-static constexpr size_t MAX_WALS_NUM = 134217728;
+WalGroupCommitter::WalGroupCommitter()
+    : fd_(-1),
+      file_size_(0),
+      file_used_(0),
+      max_batch_size_(1),
+      max_batch_delay_(0),
+      pending_num_(0),
+      pending_batch_id_(0),
+      durable_batch_id_(0),
+      running_(false) {}
+
+WalGroupCommitter::~WalGroupCommitter() { close(); }
+
+void WalGroupCommitter::openFile() {
+  const int max_version = 65536;
+  for (int version = 0; version != max_version; ++version) {
+    std::string path = prefix_ + "/group_" + std::to_string(version) + ".wal";
+    if (std::filesystem::exists(path)) {
+      continue;
+    }
+    fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    path_ = path;
+    break;
+  }
+  if (fd_ == -1) {
+    LOG(FATAL) << "Failed to open wal file";
+  }
+  if (preallocate(fd_, TRUNC_SIZE) != 0) {
+    LOG(FATAL) << "Failed to truncate wal file";
+  }
+  file_size_ = TRUNC_SIZE;
+  file_used_ = 0;
+}
+
+void WalGroupCommitter::open(const std::string& prefix, size_t max_batch_size,
+                             uint32_t max_batch_delay_us) {
+  prefix_ = prefix;
+  openFile();
+
+  max_batch_size_ = std::max<size_t>(max_batch_size, 1);
+  max_batch_delay_ = std::chrono::microseconds(max_batch_delay_us);
+  pending_num_ = 0;
+  pending_batch_id_ = 0;
+  durable_batch_id_ = 0;
+
+  running_ = true;
+  flusher_ = std::thread([this]() { flushLoop(); });
+}
+
+void WalGroupCommitter::close() {
+  if (flusher_.joinable()) {
+    {
+      std::lock_guard<std::mutex> guard(lock_);
+      running_ = false;
+    }
+    flush_cv_.notify_one();
+    flusher_.join();
+  }
+  if (fd_ != -1) {
+    ::close(fd_);
+    fd_ = -1;
+    file_size_ = 0;
+    file_used_ = 0;
+  }
+}
+
+void WalGroupCommitter::append(const char* data, size_t length) {
+  std::unique_lock<std::mutex> lock(lock_);
+  pending_.insert(pending_.end(), data, data + length);
+  uint64_t batch_id = pending_batch_id_;
+  ++pending_num_;
+  if (pending_num_ == 1 || pending_num_ >= max_batch_size_) {
+    flush_cv_.notify_one();
+  }
+  durable_cv_.wait(lock,
+                   [this, batch_id]() { return durable_batch_id_ > batch_id; });
+}
+
+void WalGroupCommitter::append_async(const char* data, size_t length,
+                                     std::function<void()> on_durable) {
+  std::lock_guard<std::mutex> lock(lock_);
+  pending_.insert(pending_.end(), data, data + length);
+  if (on_durable) {
+    pending_callbacks_.emplace_back(std::move(on_durable));
+  }
+  ++pending_num_;
+  if (pending_num_ == 1 || pending_num_ >= max_batch_size_) {
+    flush_cv_.notify_one();
+  }
+}
+
+void WalGroupCommitter::flushLoop() {
+  std::vector<char> buffer;
+  std::vector<std::function<void()>> callbacks;
+  std::unique_lock<std::mutex> lock(lock_);
+  while (true) {
+    flush_cv_.wait(lock, [this]() { return pending_num_ > 0 || !running_; });
+    if (pending_num_ == 0) {
+      break;
+    }
+    // wait for more records to join this batch, unless it is already full
+    flush_cv_.wait_for(lock, max_batch_delay_, [this]() {
+      return pending_num_ >= max_batch_size_ || !running_;
+    });
+
+    buffer.swap(pending_);
+    callbacks.swap(pending_callbacks_);
+    pending_num_ = 0;
+    uint64_t batch_id = pending_batch_id_++;
+    lock.unlock();
+
+    flush(buffer);
+    buffer.clear();
+    for (auto& callback : callbacks) {
+      callback();
+    }
+    callbacks.clear();
+
+    lock.lock();
+    durable_batch_id_ = batch_id + 1;
+    durable_cv_.notify_all();
+  }
+}
+
+void WalGroupCommitter::flush(const std::vector<char>& buffer) {
+  std::lock_guard<std::mutex> guard(file_lock_);
+  write_and_sync(fd_, file_size_, file_used_, TRUNC_SIZE, buffer.data(),
+                 buffer.size());
+}
+
+std::string WalGroupCommitter::rotate() {
+  std::lock_guard<std::mutex> guard(file_lock_);
+  if (fd_ == -1 || file_used_ == 0) {
+    return "";
+  }
+  std::string sealed = path_;
+  ::close(fd_);
+  fd_ = -1;
+  openFile();
+  return sealed;
+}
+
+size_t WalGroupCommitter::used_bytes() {
+  std::lock_guard<std::mutex> guard(file_lock_);
+  return file_used_;
+}
+
+// A compressed record is laid out as its header, the size of its raw
+// contents in 4 bytes, and the LZ4 block of the contents.
+bool compress_wal_record(const char* data, size_t length,
+                         std::vector<char>& output) {
+#ifdef FLEX_WITH_LZ4
+  const size_t prefix = sizeof(WalHeader) + sizeof(uint32_t);
+  uint32_t raw_size = length - sizeof(WalHeader);
+  int bound = LZ4_compressBound(raw_size);
+  output.resize(prefix + bound);
+  int compressed_size = LZ4_compress_default(
+      data + sizeof(WalHeader), output.data() + prefix, raw_size, bound);
+  if (compressed_size <= 0 ||
+      sizeof(uint32_t) + compressed_size >= static_cast<size_t>(raw_size)) {
+    return false;
+  }
+  output.resize(prefix + compressed_size);
+  auto* header = reinterpret_cast<WalHeader*>(output.data());
+  *header = *reinterpret_cast<const WalHeader*>(data);
+  header->codec = 1;
+  header->length = sizeof(uint32_t) + compressed_size;
+  memcpy(output.data() + sizeof(WalHeader), &raw_size, sizeof(uint32_t));
+  return true;
+#else
+  return false;
+#endif
+}
+
+// Decompress a record into a raw one, header included.
+static std::vector<char> decompress_wal_record(const WalHeader* header) {
+  const char* content = reinterpret_cast<const char*>(header + 1);
+  uint32_t raw_size;
+  memcpy(&raw_size, content, sizeof(uint32_t));
+  std::vector<char> record(sizeof(WalHeader) + raw_size);
+  auto* raw_header = reinterpret_cast<WalHeader*>(record.data());
+  *raw_header = *header;
+  raw_header->codec = 0;
+  raw_header->length = raw_size;
+#ifdef FLEX_WITH_LZ4
+  int ret = LZ4_decompress_safe(
+      content + sizeof(uint32_t), record.data() + sizeof(WalHeader),
+      header->length - sizeof(uint32_t), raw_size);
+  if (ret < 0 || static_cast<uint32_t>(ret) != raw_size) {
+    LOG(FATAL) << "Failed to decompress wal record at timestamp "
+               << header->timestamp;
+  }
+#else
+  LOG(FATAL) << "Wal record at timestamp " << header->timestamp
+             << " is compressed, but LZ4 is not built in";
+#endif
+  return record;
+}
+
+uint32_t get_wal_last_ts(const std::string& path) {
+  uint32_t last_ts = 0;
+  FILE* fin = fopen(path.c_str(), "r");
+  if (fin == NULL) {
+    return last_ts;
+  }
+  WalHeader header;
+  while (fread(&header, sizeof(WalHeader), 1, fin) == 1) {
+    if (header.timestamp == 0) {
+      break;
+    }
+    last_ts = std::max(last_ts, header.timestamp);
+    if (fseek(fin, header.length, SEEK_CUR) != 0) {
+      break;
+    }
+  }
+  fclose(fin);
+  return last_ts;
+}
 
 WalsParser::WalsParser(const std::vector<std::string>& paths) {
   for (auto path : paths) {
@@ -106,32 +476,72 @@ WalsParser::WalsParser(const std::vector<std::string>& paths) {
     mmapped_size_.push_back(file_size);
   }
 
-  insert_wal_list_.resize(MAX_WALS_NUM);
-  for (size_t i = 0; i < mmapped_ptrs_.size(); ++i) {
-    char* ptr = static_cast<char*>(mmapped_ptrs_[i]);
-    while (true) {
-      const WalHeader* header = reinterpret_cast<const WalHeader*>(ptr);
-      ptr += sizeof(WalHeader);
-      uint32_t ts = header->timestamp;
-      if (ts == 0) {
-        break;
-      }
-      int length = header->length;
-      if (header->type) {
-        UpdateWalUnit unit;
-        unit.timestamp = ts;
-        unit.ptr = ptr;
-        unit.size = length;
-        update_wal_list_.push_back(unit);
-      } else {
-        insert_wal_list_[ts].ptr = ptr;
-        insert_wal_list_[ts].size = length;
-      }
-      ptr += length;
-      last_ts_ = std::max(ts, last_ts_);
+  // Scan the files in parallel, each file is walked by a single thread since
+  // records are only delimited by their headers.
+  size_t file_num = mmapped_ptrs_.size();
+  std::vector<std::vector<UpdateWalUnit>> insert_units(file_num);
+  std::vector<std::vector<UpdateWalUnit>> update_units(file_num);
+  std::vector<std::vector<std::vector<char>>> decompressed(file_num);
+  std::vector<uint32_t> last_ts(file_num, 0);
+  {
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < file_num; ++i) {
+      threads.emplace_back([&, i]() {
+        char* ptr = static_cast<char*>(mmapped_ptrs_[i]);
+        char* end = ptr + mmapped_size_[i];
+        while (ptr + sizeof(WalHeader) <= end) {
+          const WalHeader* header = reinterpret_cast<const WalHeader*>(ptr);
+          ptr += sizeof(WalHeader);
+          uint32_t ts = header->timestamp;
+          if (ts == 0) {
+            break;
+          }
+          UpdateWalUnit unit;
+          unit.timestamp = ts;
+          unit.ptr = ptr;
+          unit.size = header->length;
+          if (header->codec) {
+            auto& record = decompressed[i].emplace_back(
+                decompress_wal_record(header));
+            unit.ptr = record.data() + sizeof(WalHeader);
+            unit.size = record.size() - sizeof(WalHeader);
+          }
+          if (header->type) {
+            update_units[i].push_back(unit);
+          } else {
+            insert_units[i].push_back(unit);
+          }
+          ptr += header->length;
+          last_ts[i] = std::max(ts, last_ts[i]);
+        }
+      });
+    }
+    for (auto& thrd : threads) {
+      thrd.join();
     }
   }
 
+  for (auto ts : last_ts) {
+    last_ts_ = std::max(ts, last_ts_);
+  }
+  // moving the buffers keeps the units pointing into them valid
+  for (auto& records : decompressed) {
+    for (auto& record : records) {
+      decompressed_.emplace_back(std::move(record));
+    }
+  }
+  insert_wal_list_.resize(last_ts_ + 1);
+  for (auto& units : insert_units) {
+    for (auto& unit : units) {
+      insert_wal_list_[unit.timestamp].ptr = unit.ptr;
+      insert_wal_list_[unit.timestamp].size = unit.size;
+    }
+  }
+  for (auto& units : update_units) {
+    update_wal_list_.insert(update_wal_list_.end(), units.begin(),
+                            units.end());
+  }
+
   if (!update_wal_list_.empty()) {
     std::sort(update_wal_list_.begin(), update_wal_list_.end(),
               [](const UpdateWalUnit& lhs, const UpdateWalUnit& rhs) {
@@ -21,10 +21,15 @@
 #include <unistd.h>
 
 #include <algorithm>
+#include <chrono>
+#include <condition_variable>
 #include <filesystem>
+#include <functional>
+#include <mutex>
 #include <queue>
 #include <string>
 #include <thread>
+#include <vector>
 
 #include "flex/utils/mmap_array.h"
 #include "glog/logging.h"
@@ -34,7 +39,9 @@ namespace gs {
 struct WalHeader {
   uint32_t timestamp;
   uint8_t type : 1;
-  int32_t length : 31;
+  uint32_t length : 30;
+  // 0 for raw contents, 1 for contents compressed by compress_wal_record
+  uint8_t codec : 1;
 };
 
 struct WalContentUnit {
@@ -48,25 +55,165 @@ struct UpdateWalUnit {
   size_t size{0};
 };
 
+/**
+ * @brief Shared WAL writer for group commit.
+ *
+ * Records appended by concurrent sessions are buffered, and a background
+ * flusher writes them out with a single fdatasync once max_batch_size
+ * records are pending or max_batch_delay_us has elapsed since the first one
+ * arrived. append() blocks until the record is durable, append_async()
+ * returns at once, and the flusher calls back once it is.
+ */
+class WalGroupCommitter {
+  static constexpr size_t TRUNC_SIZE = 1ul << 30;
+
+ public:
+  WalGroupCommitter();
+  ~WalGroupCommitter();
+
+  void open(const std::string& prefix, size_t max_batch_size,
+            uint32_t max_batch_delay_us);
+
+  void close();
+
+  void append(const char* data, size_t length);
+
+  /**
+   * @brief Append a record without waiting for it, on_durable is called by
+   * the flusher once it is durable, in the order of the records, and should
+   * return soon.
+   */
+  void append_async(const char* data, size_t length,
+                    std::function<void()> on_durable);
+
+  /**
+   * @brief Seal the current wal file and continue in a new one.
+   *
+   * @return The path of the sealed file, or an empty string if nothing has
+   * been written to it.
+   */
+  std::string rotate();
+
+  /** @brief Bytes written to the current wal file. */
+  size_t used_bytes();
+
+ private:
+  void openFile();
+
+  void flushLoop();
+
+  void flush(const std::vector<char>& buffer);
+
+  std::string prefix_;
+  std::string path_;
+  int fd_;
+  size_t file_size_;
+  size_t file_used_;
+  std::mutex file_lock_;
+
+  size_t max_batch_size_;
+  std::chrono::microseconds max_batch_delay_;
+
+  std::mutex lock_;
+  std::condition_variable flush_cv_;
+  std::condition_variable durable_cv_;
+
+  std::vector<char> pending_;
+  std::vector<std::function<void()>> pending_callbacks_;
+  size_t pending_num_;
+  uint64_t pending_batch_id_;
+  uint64_t durable_batch_id_;
+
+  bool running_;
+  std::thread flusher_;
+};
+
+class WalShipper;
+
 class WalWriter {
   static constexpr size_t TRUNC_SIZE = 1ul << 30;
 
  public:
-  WalWriter() : fd_(-1), file_size_(0), file_used_(0) {}
+  WalWriter()
+      : thread_id_(0),
+        fd_(-1),
+        file_size_(0),
+        file_used_(0),
+        group_committer_(nullptr),
+        shipper_(nullptr),
+        compress_(false) {}
   ~WalWriter() { close(); }
 
   void open(const std::string& prefix, int thread_id);
 
+  // Forward records to a shared group committer instead of a private file.
+  void open(WalGroupCommitter* group_committer);
+
+  // Also hand the records appended to a shipper of replicas.
+  void set_shipper(WalShipper* shipper) { shipper_ = shipper; }
+
+  // Compress the contents of the records appended with LZ4 before writing
+  // them, records are still shipped raw.
+  void set_compression(bool compress);
+
   void close();
 
   void append(const char* data, size_t length);
 
+  /**
+   * @brief Append a record without waiting for it to be durable when it is
+   * forwarded to a group committer, and call on_durable once it is, from
+   * the flusher. Records written to a private file are durable when it
+   * returns. Records are shipped to replicas once durable.
+   */
+  void append_async(const char* data, size_t length,
+                    std::function<void()> on_durable);
+
+  /**
+   * @brief Seal the current wal file and continue in a new one, so that the
+   * sealed file can be removed once a checkpoint covers it.
+   *
+   * @return The path of the sealed file, or an empty string if nothing has
+   * been written to it.
+   */
+  std::string rotate();
+
+  /**
+   * @brief Bytes written to the current wal file, 0 if records are forwarded
+   * to a group committer.
+   */
+  size_t used_bytes();
+
  private:
+  std::string prefix_;
+  int thread_id_;
+  std::string path_;
   int fd_;
   size_t file_size_;
   size_t file_used_;
+  std::mutex lock_;
+
+  WalGroupCommitter* group_committer_;
+  WalShipper* shipper_;
+
+  bool compress_;
+  std::vector<char> compressed_;
 };
 
+/**
+ * @brief Compress the contents of a record, header included, into output.
+ *
+ * @return Whether the record was compressed, records LZ4 does not shrink
+ * are left as they are.
+ */
+bool compress_wal_record(const char* data, size_t length,
+                         std::vector<char>& output);
+
+/**
+ * @brief Get the largest timestamp recorded in a wal file.
+ */
+uint32_t get_wal_last_ts(const std::string& path);
+
 class WalsParser {
  public:
   WalsParser(const std::vector<std::string>& paths);
@@ -80,6 +227,8 @@ class WalsParser {
   std::vector<int> fds_;
   std::vector<void*> mmapped_ptrs_;
   std::vector<size_t> mmapped_size_;
+  // records decompressed, headers included
+  std::vector<std::vector<char>> decompressed_;
 
   mmap_array<WalContentUnit> insert_wal_list_;
   uint32_t last_ts_{0};
@@ -0,0 +1,324 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "flex/engines/graph_db/database/wal_stream.h"
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+
+#include <limits>
+
+#include "flex/engines/graph_db/database/version_manager.h"
+
+namespace gs {
+
+static constexpr std::chrono::milliseconds kHeartbeatInterval(10);
+static constexpr std::chrono::seconds kReconnectInterval(1);
+
+static bool send_all(int fd, const char* data, size_t length) {
+  while (length > 0) {
+    ssize_t sent = ::send(fd, data, length, MSG_NOSIGNAL);
+    if (sent <= 0) {
+      if (sent < 0 && errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    data += sent;
+    length -= sent;
+  }
+  return true;
+}
+
+static bool recv_all(int fd, char* data, size_t length) {
+  while (length > 0) {
+    ssize_t received = ::recv(fd, data, length, 0);
+    if (received <= 0) {
+      if (received < 0 && errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    data += received;
+    length -= received;
+  }
+  return true;
+}
+
+WalShipper::WalShipper()
+    : listen_fd_(-1),
+      vm_(nullptr),
+      base_seq_(0),
+      trimmed_ts_(0),
+      conn_num_(0),
+      running_(false) {}
+
+WalShipper::~WalShipper() { close(); }
+
+void WalShipper::open(uint16_t port, VersionManager* vm) {
+  vm_ = vm;
+  listen_fd_ = ::socket(AF_INET6, SOCK_STREAM, 0);
+  if (listen_fd_ == -1) {
+    LOG(FATAL) << "Failed to create socket for wal shipping";
+  }
+  int on = 1;
+  setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+  sockaddr_in6 addr{};
+  addr.sin6_family = AF_INET6;
+  addr.sin6_addr = in6addr_any;
+  addr.sin6_port = htons(port);
+  if (::bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) !=
+          0 ||
+      ::listen(listen_fd_, 16) != 0) {
+    LOG(FATAL) << "Failed to listen on port " << port << " for wal shipping";
+  }
+  running_ = true;
+  acceptor_ = std::thread([this]() { acceptLoop(); });
+  LOG(INFO) << "Shipping wal to replicas on port " << port;
+}
+
+void WalShipper::close() {
+  if (!acceptor_.joinable()) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> guard(lock_);
+    running_ = false;
+    for (auto& pair : conn_fds_) {
+      ::shutdown(pair.second, SHUT_RDWR);
+    }
+  }
+  cv_.notify_all();
+  ::shutdown(listen_fd_, SHUT_RDWR);
+  acceptor_.join();
+  for (auto& thrd : servers_) {
+    thrd.join();
+  }
+  servers_.clear();
+  ::close(listen_fd_);
+  listen_fd_ = -1;
+}
+
+void WalShipper::ship(const char* data, size_t length) {
+  {
+    std::lock_guard<std::mutex> guard(lock_);
+    records_.emplace_back(data, data + length);
+  }
+  cv_.notify_all();
+}
+
+void WalShipper::trim(uint32_t ts) {
+  std::lock_guard<std::mutex> guard(lock_);
+  trimmed_ts_ = std::max(trimmed_ts_, ts);
+  // records not sent to a connected replica yet are kept
+  uint64_t min_pos = minPosition();
+  while (!records_.empty() && base_seq_ < min_pos &&
+         reinterpret_cast<const WalHeader*>(records_.front().data())
+                 ->timestamp <= ts) {
+    records_.pop_front();
+    ++base_seq_;
+  }
+}
+
+uint64_t WalShipper::minPosition() const {
+  uint64_t ret = std::numeric_limits<uint64_t>::max();
+  for (auto& pair : positions_) {
+    ret = std::min(ret, pair.second);
+  }
+  return ret;
+}
+
+void WalShipper::acceptLoop() {
+  while (true) {
+    int fd = ::accept(listen_fd_, nullptr, nullptr);
+    std::lock_guard<std::mutex> guard(lock_);
+    if (!running_) {
+      if (fd != -1) {
+        ::close(fd);
+      }
+      break;
+    }
+    if (fd == -1) {
+      continue;
+    }
+    int on = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+    size_t conn_id = conn_num_++;
+    conn_fds_[conn_id] = fd;
+    servers_.emplace_back([this, fd, conn_id]() { serve(fd, conn_id); });
+  }
+}
+
+void WalShipper::serve(int fd, size_t conn_id) {
+  uint32_t start_ts;
+  bool ok = recv_all(fd, reinterpret_cast<char*>(&start_ts), sizeof(start_ts));
+
+  std::unique_lock<std::mutex> lock(lock_);
+  if (ok && start_ts < trimmed_ts_) {
+    LOG(ERROR) << "Refused a replica at timestamp " << start_ts
+               << ", records up to " << trimmed_ts_
+               << " are only kept in checkpoints";
+    ok = false;
+  }
+  uint64_t pos = base_seq_;
+  positions_[conn_id] = pos;
+  if (ok) {
+    LOG(INFO) << "Replica connected at timestamp " << start_ts;
+  }
+
+  std::vector<char> buffer;
+  while (ok && running_) {
+    cv_.wait_for(lock, kHeartbeatInterval, [&]() {
+      return !running_ || base_seq_ + records_.size() > pos;
+    });
+    if (!running_) {
+      break;
+    }
+    // A record is shipped before its timestamp turns readable, so all the
+    // records up to the heartbeat are kept by now.
+    WalHeader heartbeat;
+    heartbeat.timestamp = vm_->read_timestamp();
+    heartbeat.type = 0;
+    heartbeat.length = 0;
+    heartbeat.codec = 0;
+
+    buffer.clear();
+    for (uint64_t seq = pos; seq < base_seq_ + records_.size(); ++seq) {
+      auto& record = records_[seq - base_seq_];
+      if (reinterpret_cast<const WalHeader*>(record.data())->timestamp >
+          start_ts) {
+        buffer.insert(buffer.end(), record.begin(), record.end());
+      }
+    }
+    pos = base_seq_ + records_.size();
+    positions_[conn_id] = pos;
+    lock.unlock();
+
+    const char* ptr = reinterpret_cast<const char*>(&heartbeat);
+    buffer.insert(buffer.end(), ptr, ptr + sizeof(WalHeader));
+    ok = send_all(fd, buffer.data(), buffer.size());
+
+    lock.lock();
+  }
+  positions_.erase(conn_id);
+  conn_fds_.erase(conn_id);
+  lock.unlock();
+  ::close(fd);
+}
+
+WalReceiver::WalReceiver() : fd_(-1), running_(false) {}
+
+WalReceiver::~WalReceiver() { close(); }
+
+void WalReceiver::open(const std::string& address,
+                       const std::function<uint32_t()>& start_ts,
+                       const handler_t& handler) {
+  size_t sep = address.rfind(':');
+  if (sep == std::string::npos) {
+    LOG(FATAL) << "Address of primary should be host:port, got " << address;
+  }
+  host_ = address.substr(0, sep);
+  port_ = address.substr(sep + 1);
+  start_ts_ = start_ts;
+  handler_ = handler;
+  running_ = true;
+  receiver_ = std::thread([this]() { receiveLoop(); });
+}
+
+void WalReceiver::close() {
+  if (!receiver_.joinable()) {
+    return;
+  }
+  running_ = false;
+  {
+    std::lock_guard<std::mutex> guard(lock_);
+    if (fd_ != -1) {
+      ::shutdown(fd_, SHUT_RDWR);
+    }
+  }
+  receiver_.join();
+}
+
+void WalReceiver::receiveLoop() {
+  while (running_) {
+    int fd = -1;
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* addrs = nullptr;
+    if (getaddrinfo(host_.c_str(), port_.c_str(), &hints, &addrs) == 0) {
+      for (addrinfo* addr = addrs; addr != nullptr; addr = addr->ai_next) {
+        fd = ::socket(addr->ai_family, addr->ai_socktype, addr->ai_protocol);
+        if (fd == -1) {
+          continue;
+        }
+        if (::connect(fd, addr->ai_addr, addr->ai_addrlen) == 0) {
+          break;
+        }
+        ::close(fd);
+        fd = -1;
+      }
+      freeaddrinfo(addrs);
+    }
+
+    if (fd != -1) {
+      {
+        std::lock_guard<std::mutex> guard(lock_);
+        fd_ = fd;
+      }
+      if (running_) {
+        receive(fd);
+      }
+      {
+        std::lock_guard<std::mutex> guard(lock_);
+        fd_ = -1;
+      }
+      ::close(fd);
+    }
+    if (running_) {
+      LOG(WARNING) << "Not connected to primary " << host_ << ":" << port_
+                   << ", retrying";
+      std::this_thread::sleep_for(kReconnectInterval);
+    }
+  }
+}
+
+void WalReceiver::receive(int fd) {
+  int on = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+  uint32_t start_ts = start_ts_();
+  if (!send_all(fd, reinterpret_cast<const char*>(&start_ts),
+                sizeof(start_ts))) {
+    return;
+  }
+  LOG(INFO) << "Receiving wal from primary " << host_ << ":" << port_
+            << " after timestamp " << start_ts;
+  std::vector<char> content;
+  WalHeader header;
+  while (running_) {
+    if (!recv_all(fd, reinterpret_cast<char*>(&header), sizeof(header))) {
+      return;
+    }
+    content.resize(header.length);
+    if (!recv_all(fd, content.data(), content.size())) {
+      return;
+    }
+    handler_(header, content.data());
+  }
+}
+
+}  // namespace gs
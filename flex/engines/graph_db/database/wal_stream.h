@@ -0,0 +1,136 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GRAPHSCOPE_DATABASE_WAL_STREAM_H_
+#define GRAPHSCOPE_DATABASE_WAL_STREAM_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "flex/engines/graph_db/database/wal.h"
+
+namespace gs {
+
+class VersionManager;
+
+/**
+ * @brief Streams the wal records of a primary to read-only replicas over tcp.
+ *
+ * A replica connects with the timestamp it has applied, and receives the
+ * records it misses followed by heartbeats, which are headers of length 0
+ * carrying the read timestamp of the primary. Every record up to the
+ * timestamp of a heartbeat is sent before it, and timestamps without records
+ * belong to aborted transactions.
+ *
+ * Records are kept in memory since the last checkpoint, so replicas started
+ * from a checkpoint not older than it can catch up.
+ */
+class WalShipper {
+ public:
+  WalShipper();
+  ~WalShipper();
+
+  void open(uint16_t port, VersionManager* vm);
+
+  void close();
+
+  bool is_open() const { return listen_fd_ != -1; }
+
+  /** @brief Keep a record, including its header, for the replicas. */
+  void ship(const char* data, size_t length);
+
+  /**
+   * @brief Drop the records covered by a checkpoint at ts, replicas older
+   * than it are refused.
+   */
+  void trim(uint32_t ts);
+
+ private:
+  void acceptLoop();
+
+  void serve(int fd, size_t conn_id);
+
+  uint64_t minPosition() const;
+
+  int listen_fd_;
+  VersionManager* vm_;
+
+  mutable std::mutex lock_;
+  std::condition_variable cv_;
+  std::deque<std::vector<char>> records_;
+  // sequence number of the first record kept
+  uint64_t base_seq_;
+  uint32_t trimmed_ts_;
+  // sequence numbers of the next records to send to each replica
+  std::map<size_t, uint64_t> positions_;
+  std::map<size_t, int> conn_fds_;
+  size_t conn_num_;
+
+  bool running_;
+  std::thread acceptor_;
+  std::vector<std::thread> servers_;
+};
+
+/**
+ * @brief Receives the wal stream of a primary, reconnecting when the
+ * connection is lost.
+ */
+class WalReceiver {
+ public:
+  // called with the header and content of each record, and with heartbeats
+  using handler_t = std::function<void(const WalHeader&, char*)>;
+
+  WalReceiver();
+  ~WalReceiver();
+
+  /**
+   * @brief Connect to the primary at address, as host:port.
+   *
+   * @param start_ts Timestamp applied so far, asked again on reconnecting.
+   */
+  void open(const std::string& address,
+            const std::function<uint32_t()>& start_ts,
+            const handler_t& handler);
+
+  void close();
+
+  bool is_open() const { return running_; }
+
+ private:
+  void receiveLoop();
+
+  void receive(int fd);
+
+  std::string host_;
+  std::string port_;
+  std::function<uint32_t()> start_ts_;
+  handler_t handler_;
+
+  std::mutex lock_;
+  int fd_;
+  std::atomic<bool> running_;
+  std::thread receiver_;
+};
+
+}  // namespace gs
+
+#endif  // GRAPHSCOPE_DATABASE_WAL_STREAM_H_
@@ -71,13 +71,13 @@ typedef enum {
 // #define GRIN_WITH_VERTEX_DATA
 #define GRIN_WITH_EDGE_DATA
 #define GRIN_ENABLE_VERTEX_LIST
-// #define GRIN_ENABLE_VERTEX_LIST_ARRAY
+#define GRIN_ENABLE_VERTEX_LIST_ARRAY
 #define GRIN_ENABLE_VERTEX_LIST_ITERATOR
 #define GRIN_ENABLE_EDGE_LIST
 // #define GRIN_ENABLE_EDGE_LIST_ARRAY
 #define GRIN_ENABLE_EDGE_LIST_ITERATOR
 #define GRIN_ENABLE_ADJACENT_LIST
-// #define GRIN_ENABLE_ADJACENT_LIST_ARRAY
+#define GRIN_ENABLE_ADJACENT_LIST_ARRAY
 #define GRIN_ENABLE_ADJACENT_LIST_ITERATOR
 
 // Partition
@@ -229,6 +229,16 @@ typedef struct GRIN_ADJACENT_LIST {
   GRIN_VERTEX v;
   GRIN_DIRECTION dir;
   GRIN_EDGE_TYPE edge_label;
+#ifdef GRIN_ENABLE_ADJACENT_LIST_ARRAY
+  // the gs::MutableNbr array of v in the csr, nbr_size bytes per edge
+  const void* nbrs;
+  // a copy of the edges, when they can't be read from the csr by index
+  void* nbr_copy;
+  size_t nbr_size;
+  size_t size;
+  // gs::PropertyType of the edge data
+  unsigned data_type;
+#endif
 } GRIN_ADJACENT_LIST;
 #endif
 
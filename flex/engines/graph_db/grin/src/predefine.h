@@ -35,4 +35,8 @@ typedef std::vector<unsigned> GRIN_EDGE_PROPERTY_LIST_T;
 #endif
 
 GRIN_DATATYPE _get_data_type(const gs::PropertyType& type);
-void init_cache(GRIN_GRAPH_T* g);
\ No newline at end of file
+void init_cache(GRIN_GRAPH_T* g);
+
+#ifdef GRIN_ENABLE_ADJACENT_LIST_ARRAY
+void init_adjacent_list_array(GRIN_GRAPH_T* g, GRIN_ADJACENT_LIST& adj_list);
+#endif
\ No newline at end of file
@@ -306,7 +306,7 @@ const void* grin_get_vertex_property_value(GRIN_GRAPH g, GRIN_VERTEX v,
   }
   case GRIN_DATATYPE::String: {
     auto _col = static_cast<const gs::StringColumn*>(col);
-    return _col->buffer()[vid].data();
+    return _col->get_view(vid).data();
   }
   case GRIN_DATATYPE::Timestamp64: {
     auto _col = static_cast<const gs::DateColumn*>(col);
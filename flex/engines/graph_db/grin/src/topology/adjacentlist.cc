@@ -27,8 +27,161 @@ GRIN_ADJACENT_LIST grin_get_adjacent_list(GRIN_GRAPH g, GRIN_DIRECTION dir,
 }
 #endif
 
+#ifdef GRIN_ENABLE_ADJACENT_LIST_ARRAY
+typedef std::vector<std::pair<gs::vid_t, gs::Any>> GRIN_NBR_COPY_T;
+
+// Edges are read from the csr by index only if none of them is deleted,
+// which holds for all the graphs bulk loaded for GRIN.
+template <typename EDATA_T>
+static bool init_nbr_slice(const gs::MutableCsrBase* csr, gs::vid_t vid,
+                           GRIN_ADJACENT_LIST& adj_list) {
+  auto slice = gs::MutablePropertyFragment::get_slice<EDATA_T>(csr, vid);
+  for (auto& nbr : slice) {
+    if (nbr.timestamp.load() == gs::kDeletedTimestamp) {
+      return false;
+    }
+  }
+  adj_list.nbrs = slice.size() == 0 ? nullptr : slice.begin();
+  adj_list.nbr_size = sizeof(gs::MutableNbr<EDATA_T>);
+  adj_list.size = slice.size();
+  return true;
+}
+
+template <typename EDATA_T>
+static gs::Any get_nbr_data(const GRIN_ADJACENT_LIST& adj_list, size_t idx) {
+  auto nbrs = static_cast<const gs::MutableNbr<EDATA_T>*>(adj_list.nbrs);
+  return gs::AnyConverter<EDATA_T>::to_any(nbrs[idx].data);
+}
+
+void init_adjacent_list_array(GRIN_GRAPH_T* g, GRIN_ADJACENT_LIST& adj_list) {
+  adj_list.nbrs = nullptr;
+  adj_list.nbr_copy = nullptr;
+  adj_list.nbr_size = 0;
+  adj_list.size = 0;
+  auto label = adj_list.edge_label;
+  auto src_label = label >> 16;
+  auto dst_label = (label >> 8) & 0xff;
+  auto edge_label = label & 0xff;
+  auto v_label = adj_list.v >> 32;
+  auto vid = adj_list.v & (0xffffffff);
+  auto type = g->g.schema().get_edge_property(src_label, dst_label, edge_label);
+  adj_list.data_type = static_cast<unsigned>(type);
+
+  const gs::MutableCsrBase* csr = nullptr;
+  if (adj_list.dir == GRIN_DIRECTION::OUT) {
+    if (src_label == v_label) {
+      csr = g->g.get_oe_csr(src_label, dst_label, edge_label);
+    }
+  } else if (dst_label == v_label) {
+    csr = g->g.get_ie_csr(dst_label, src_label, edge_label);
+  }
+  if (csr == nullptr) {
+    return;
+  }
+
+  // static edge types are encoded, and have no MutableNbr to point to
+  bool sliced = false;
+  if (!g->g.schema().is_static_edge(src_label, dst_label, edge_label)) {
+    switch (type) {
+    case gs::PropertyType::kEmpty:
+      sliced = init_nbr_slice<grape::EmptyType>(csr, vid, adj_list);
+      break;
+    case gs::PropertyType::kInt32:
+      sliced = init_nbr_slice<int>(csr, vid, adj_list);
+      break;
+    case gs::PropertyType::kInt64:
+      sliced = init_nbr_slice<int64_t>(csr, vid, adj_list);
+      break;
+    case gs::PropertyType::kDate:
+      sliced = init_nbr_slice<gs::Date>(csr, vid, adj_list);
+      break;
+    case gs::PropertyType::kDouble:
+      sliced = init_nbr_slice<double>(csr, vid, adj_list);
+      break;
+    default:
+      break;
+    }
+  }
+  if (!sliced) {
+    auto copy = new GRIN_NBR_COPY_T();
+    auto edge_iter = csr->edge_iter(vid);
+    for (; edge_iter->is_valid(); edge_iter->next()) {
+      copy->emplace_back(edge_iter->get_neighbor(), edge_iter->get_data());
+    }
+    adj_list.nbr_copy = copy;
+    adj_list.size = copy->size();
+  }
+}
+
+size_t grin_get_adjacent_list_size(GRIN_GRAPH g, GRIN_ADJACENT_LIST adj_list) {
+  return adj_list.size;
+}
+
+GRIN_VERTEX grin_get_neighbor_from_adjacent_list(GRIN_GRAPH g,
+                                                 GRIN_ADJACENT_LIST adj_list,
+                                                 size_t idx) {
+  gs::vid_t vid;
+  if (adj_list.nbr_copy != nullptr) {
+    vid = (*static_cast<GRIN_NBR_COPY_T*>(adj_list.nbr_copy))[idx].first;
+  } else {
+    // the neighbor is the first member of MutableNbr of any edge data
+    vid = *reinterpret_cast<const gs::vid_t*>(
+        static_cast<const char*>(adj_list.nbrs) + idx * adj_list.nbr_size);
+  }
+  auto label = adj_list.edge_label;
+  if (adj_list.dir == GRIN_DIRECTION::OUT) {
+    label = (label >> 8) & 0xff;
+  } else {
+    label = label >> 16;
+  }
+  return ((label * 1ull) << 32) + vid;
+}
+
+GRIN_EDGE grin_get_edge_from_adjacent_list(GRIN_GRAPH g,
+                                           GRIN_ADJACENT_LIST adj_list,
+                                           size_t idx) {
+  GRIN_EDGE_T* edge = new GRIN_EDGE_T();
+  auto nbr = grin_get_neighbor_from_adjacent_list(g, adj_list, idx);
+  if (adj_list.dir == GRIN_DIRECTION::IN) {
+    edge->src = nbr;
+    edge->dst = adj_list.v;
+  } else {
+    edge->src = adj_list.v;
+    edge->dst = nbr;
+  }
+  edge->dir = adj_list.dir;
+  if (adj_list.nbr_copy != nullptr) {
+    auto copy = static_cast<GRIN_NBR_COPY_T*>(adj_list.nbr_copy);
+    edge->data = (*copy)[idx].second;
+  } else {
+    switch (static_cast<gs::PropertyType>(adj_list.data_type)) {
+    case gs::PropertyType::kInt32:
+      edge->data = get_nbr_data<int>(adj_list, idx);
+      break;
+    case gs::PropertyType::kInt64:
+      edge->data = get_nbr_data<int64_t>(adj_list, idx);
+      break;
+    case gs::PropertyType::kDate:
+      edge->data = get_nbr_data<gs::Date>(adj_list, idx);
+      break;
+    case gs::PropertyType::kDouble:
+      edge->data = get_nbr_data<double>(adj_list, idx);
+      break;
+    default:
+      break;
+    }
+  }
+  edge->label = adj_list.edge_label & 0xff;
+  return edge;
+}
+#endif
+
 #ifdef GRIN_ENABLE_ADJACENT_LIST
-void grin_destroy_adjacent_list(GRIN_GRAPH g, GRIN_ADJACENT_LIST adj_list) {}
+void grin_destroy_adjacent_list(GRIN_GRAPH g, GRIN_ADJACENT_LIST adj_list) {
+#ifdef GRIN_ENABLE_ADJACENT_LIST_ARRAY
+  delete static_cast<GRIN_NBR_COPY_T*>(adj_list.nbr_copy);
+#endif
+}
 #endif
 
 #ifdef GRIN_ENABLE_ADJACENT_LIST_ITERATOR
@@ -29,6 +29,7 @@
 
 #include "flex/engines/hqps_db/core/params.h"
 #include "flex/engines/hqps_db/core/utils/hqps_utils.h"
+#include "flex/engines/hqps_db/core/utils/radix_join.h"
 
 #include "flex/engines/hqps_db/structures/multi_vertex_set/multi_label_vertex_set.h"
 #include "flex/storages/rt_mutable_graph/types.h"
@@ -221,55 +222,50 @@ class BaseEngine {
     auto builder_tuple = std::tuple_cat(x_builder_tuple_init, y_builder_tuple);
     static_assert(is_tuple<ctx_y_res_ele_t>::value);
     static_assert(is_tuple<ctx_y_res_data_t>::value);
-    std::unordered_map<
-        ctx_y_ele_t, std::vector<std::pair<ctx_y_res_ele_t, ctx_y_res_data_t>>,
-        boost::hash<ctx_y_ele_t>>
-        y_ele_to_ind;
-    {
-      // fillin ele_to_ind
-      for (auto iter : ctx_y) {
-        auto ele = iter.GetAllElement();
-        auto index_ele = iter.GetAllIndexElement();
-        auto data = iter.GetAllData();
-        auto y_ele = std::get<real_y_ind>(ele);
-        y_ele_to_ind[y_ele].emplace_back(
-            std::make_pair(remove_nth_element<real_y_ind>(index_ele),
-                           remove_nth_element<real_y_ind>(data)));
-      }
+    std::vector<ctx_y_ele_t> y_keys;
+    std::vector<std::pair<ctx_y_res_ele_t, ctx_y_res_data_t>> y_rests;
+    for (auto iter : ctx_y) {
+      auto ele = iter.GetAllElement();
+      auto index_ele = iter.GetAllIndexElement();
+      auto data = iter.GetAllData();
+      y_keys.emplace_back(std::get<real_y_ind>(ele));
+      y_rests.emplace_back(
+          std::make_pair(remove_nth_element<real_y_ind>(index_ele),
+                         remove_nth_element<real_y_ind>(data)));
+    }
+    std::vector<ctx_x_ele_t> x_keys;
+    for (auto iter_x : ctx_x) {
+      x_keys.emplace_back(std::get<real_x_ind>(iter_x.GetAllElement()));
     }
 
     {
       double t0 = -grape::GetCurrentTime();
+      RadixJoinTable<ctx_y_ele_t> table;
+      table.Build(y_keys);
+      auto ranges = table.Probe(x_keys);
+      auto& y_rows = table.rows();
+      size_t x_ind = 0;
       for (auto iter_x : ctx_x) {
-        auto ele = iter_x.GetAllElement();
         auto ind_ele = iter_x.GetAllIndexElement();
         auto data_tuple = iter_x.GetAllData();
-        auto x_ele = std::get<real_x_ind>(ele);
-        // auto x_ele_to_insert = remove_nth_element<real_x_ind>(ele);
-        auto iter = y_ele_to_ind.find(x_ele);
-        if (iter != y_ele_to_ind.end()) {
-          for (auto& y_ele_data : iter->second) {
-            auto copied_ele = y_ele_data.first;
-            auto new_ele =
-                std::tuple_cat(std::move(ind_ele), std::move(copied_ele));
-            auto new_data = std::tuple_cat(std::move(data_tuple),
-                                           std::move(y_ele_data.second));
+        auto range = ranges[x_ind++];
+        if (range.first != range.second) {
+          for (size_t i = range.first; i < range.second; ++i) {
+            auto& y_ele_data = y_rests[y_rows[i]];
+            auto new_ele = std::tuple_cat(ind_ele, y_ele_data.first);
+            auto new_data = std::tuple_cat(data_tuple, y_ele_data.second);
             insert_into_builder_v2(builder_tuple, new_ele, new_data);
           }
         } else {
-          LOG(INFO) << "no y ele found";
           auto new_ele =
               std::tuple_cat(std::move(ind_ele),
                              NullRecordCreator<ctx_y_res_ele_t>::GetNull());
-          LOG(INFO) << "new ele: " << gs::to_string(new_ele);
           auto new_data =
               std::tuple_cat(std::move(data_tuple),
                              NullRecordCreator<ctx_y_res_data_t>::GetNull());
-          LOG(INFO) << "new data: " << gs::to_string(new_data);
           insert_into_builder_v2(builder_tuple, new_ele, new_data);
         }
       }
-      LOG(INFO) << "here";
       t0 += grape::GetCurrentTime();
       LOG(INFO) << "Join cost: " << t0;
     }
@@ -349,10 +345,8 @@ class BaseEngine {
                                         std::move(y_builder_tuple));
     static_assert(is_tuple<ctx_y_res_ele_t>::value);
     static_assert(is_tuple<ctx_y_res_data_t>::value);
-    std::unordered_map<
-        ctx_y_ele_t, std::vector<std::pair<ctx_y_res_ele_t, ctx_y_res_data_t>>,
-        boost::hash<ctx_y_ele_t>>
-        y_ele_to_ind;
+    std::vector<ctx_y_ele_t> y_keys;
+    std::vector<std::pair<ctx_y_res_ele_t, ctx_y_res_data_t>> y_rests;
 
     LOG(INFO) << "ctx x: " << ctx_x.GetHead().Size()
               << ", ctx y:" << ctx_y.GetHead().Size();
@@ -363,33 +357,38 @@ class BaseEngine {
         auto ele = iter.GetAllElement();
         auto index_ele = iter.GetAllIndexElement();
         auto data = iter.GetAllData();
-        auto y_ele = std::make_pair(std::get<real_y_ind0>(ele),
-                                    std::get<real_y_ind1>(ele));
-        y_ele_to_ind[y_ele].emplace_back(std::make_pair(
+        y_keys.emplace_back(std::make_pair(std::get<real_y_ind0>(ele),
+                                           std::get<real_y_ind1>(ele)));
+        y_rests.emplace_back(std::make_pair(
             remove_ith_jth_element<real_y_ind0, real_y_ind1>(index_ele),
             remove_ith_jth_element<real_y_ind0, real_y_ind1>(data)));
       }
       t0 += grape::GetCurrentTime();
       LOG(INFO) << "fillin ele_to_ind takes " << t0 << "s";
     }
+    std::vector<ctx_x_ele_t> x_keys;
+    for (auto iter_x : ctx_x) {
+      auto ele = iter_x.GetAllElement();
+      x_keys.emplace_back(std::make_pair(std::get<real_x_ind0>(ele),
+                                         std::get<real_x_ind1>(ele)));
+    }
 
     {
       double t0 = -grape::GetCurrentTime();
+      RadixJoinTable<ctx_y_ele_t> table;
+      table.Build(y_keys);
+      auto ranges = table.Probe(x_keys);
+      auto& y_rows = table.rows();
+      size_t x_ind = 0;
       for (auto iter_x : ctx_x) {
-        auto ele = iter_x.GetAllElement();
         auto ind_ele = iter_x.GetAllIndexElement();
         auto data_tuple = iter_x.GetAllData();
-        auto x_ele = std::make_pair(std::get<real_x_ind0>(ele),
-                                    std::get<real_x_ind1>(ele));
-        // auto x_ele_to_insert = remove_nth_element<real_x_ind>(ele);
-        auto iter = y_ele_to_ind.find(x_ele);
-        if (iter != y_ele_to_ind.end()) {
-          for (auto& y_ele_data : iter->second) {
-            auto copied_ele = y_ele_data.first;
-            auto new_ele =
-                std::tuple_cat(std::move(ind_ele), std::move(copied_ele));
-            auto new_data = std::tuple_cat(std::move(data_tuple),
-                                           std::move(y_ele_data.second));
+        auto range = ranges[x_ind++];
+        if (range.first != range.second) {
+          for (size_t i = range.first; i < range.second; ++i) {
+            auto& y_ele_data = y_rests[y_rows[i]];
+            auto new_ele = std::tuple_cat(ind_ele, y_ele_data.first);
+            auto new_data = std::tuple_cat(data_tuple, y_ele_data.second);
             insert_into_builder_v2(builder_tuple, new_ele, new_data);
           }
         } else {
@@ -575,41 +574,43 @@ class BaseEngine {
     auto all_builder = std::tuple_cat(x_builder_tuple_init, y_builder_tuple);
 
     double t0 = -grape::GetCurrentTime();
-    std::unordered_map<
-        ctx_x_ele_t, std::vector<std::tuple<ctx_y_res_ele_t, ctx_y_res_data_t>>>
-        join_key_map;
-    {
-      for (auto iter : ctx_y) {
-        auto y_ele = iter.GetAllElement();
-        auto y_data = iter.GetAllData();
-        auto y_key = std::get<real_y_ind>(y_ele);
-        if (join_key_map.find(y_key) == join_key_map.end()) {
-          join_key_map[y_key] =
-              std::vector<std::tuple<ctx_y_res_ele_t, ctx_y_res_data_t>>();
-        }
-        auto y_res_ele = remove_nth_element<real_y_ind>(y_ele);
-        auto y_res_data = remove_nth_element<real_y_ind>(y_data);
-        join_key_map[y_key].emplace_back(
-            std::make_tuple(y_res_ele, y_res_data));
-      }
+    std::vector<ctx_y_ele_t> y_keys;
+    std::vector<std::tuple<ctx_y_res_ele_t, ctx_y_res_data_t>> y_rests;
+    for (auto iter : ctx_y) {
+      auto y_ele = iter.GetAllElement();
+      auto y_data = iter.GetAllData();
+      y_keys.emplace_back(std::get<real_y_ind>(y_ele));
+      y_rests.emplace_back(
+          std::make_tuple(remove_nth_element<real_y_ind>(y_ele),
+                          remove_nth_element<real_y_ind>(y_data)));
     }
-    LOG(INFO) << " key map valid num: " << join_key_map.size();
+    std::vector<ctx_x_ele_t> x_keys;
+    for (auto x_iter : ctx_x) {
+      x_keys.emplace_back(std::get<real_x_ind>(x_iter.GetAllElement()));
+    }
+    RadixJoinTable<ctx_y_ele_t, std::hash<ctx_y_ele_t>> table;
+    table.Build(y_keys);
+    auto ranges = table.Probe(x_keys);
+    auto& y_rows = table.rows();
 
+    size_t x_ind = 0;
     for (auto x_iter : ctx_x) {
+      auto range = ranges[x_ind++];
+      if (range.first == range.second) {
+        continue;
+      }
       auto ele = x_iter.GetAllElement();
       auto data = x_iter.GetAllData();
       // the sequence of x_tuple shall not change
-      auto x_key = std::get<real_x_ind>(ele);
-      if (join_key_map.find(x_key) != join_key_map.end()) {
-        for (auto y_res : join_key_map[x_key]) {
-          auto y_res_ele = std::get<0>(y_res);
-          auto y_res_data = std::get<1>(y_res);
-          auto res_ele = std::tuple_cat(ele, y_res_ele);
-          auto res_data = std::tuple_cat(data, y_res_data);
-          insert_into_builder_v2(all_builder, res_ele, res_data);
-        }
+      for (size_t i = range.first; i < range.second; ++i) {
+        auto& y_res = y_rests[y_rows[i]];
+        auto res_ele = std::tuple_cat(ele, std::get<0>(y_res));
+        auto res_data = std::tuple_cat(data, std::get<1>(y_res));
+        insert_into_builder_v2(all_builder, res_ele, res_data);
       }
     }
+    t0 += grape::GetCurrentTime();
+    LOG(INFO) << "Join cost: " << t0;
 
     auto built_tuple = builder_finish(
         all_builder, std::make_index_sequence<x_ele_num + y_ele_num - 1>{});
@@ -673,39 +674,28 @@ class BaseEngine {
                                                                      ctx_y);
 
     double t0 = -grape::GetCurrentTime();
-    std::unordered_map<ctx_x_ele_t, int, boost::hash<ctx_x_ele_t>> join_key_map;
-    {
-      for (auto iter : ctx_x) {
-        auto x_ele = iter.GetAllElement();
-        auto pair = std::make_pair(std::get<real_x_ind0>(x_ele),
-                                   std::get<real_x_ind1>(x_ele));
-        if (join_key_map.find(pair) == join_key_map.end()) {
-          join_key_map[pair] = 1;
-        }
-      }
+    // as ctx_y contains no additional ele, x records are kept if matched
+    std::vector<ctx_x_ele_t> x_keys;
+    for (auto iter : ctx_x) {
+      auto x_ele = iter.GetAllElement();
+      x_keys.emplace_back(std::make_pair(std::get<real_x_ind0>(x_ele),
+                                         std::get<real_x_ind1>(x_ele)));
     }
-    {
-      for (auto iter : ctx_y) {
-        auto y_ele = iter.GetAllElement();
-        auto pair = std::make_pair(std::get<real_y_ind0>(y_ele),
-                                   std::get<real_y_ind1>(y_ele));
-        if (join_key_map.find(pair) != join_key_map.end()) {
-          join_key_map[pair] += 1;
-        }
-      }
+    std::vector<ctx_y_ele_t> y_keys;
+    for (auto iter : ctx_y) {
+      auto y_ele = iter.GetAllElement();
+      y_keys.emplace_back(std::make_pair(std::get<real_y_ind0>(y_ele),
+                                         std::get<real_y_ind1>(y_ele)));
     }
-    LOG(INFO) << "total entry size in map: " << join_key_map.size();
+    auto matched = semi_join_keys(y_keys, x_keys);
 
     t0 += grape::GetCurrentTime();
 
+    size_t x_ind = 0;
     for (auto iter : ctx_x) {
-      auto eles = iter.GetAllElement();
-      auto datas = iter.GetAllData();
-      auto pair = std::make_pair(std::get<real_x_ind0>(eles),
-                                 std::get<real_x_ind1>(eles));
-      if (join_key_map.find(pair) != join_key_map.end() &&
-          join_key_map[pair] == 2) {
-        // join.
+      if (matched[x_ind++]) {
+        auto eles = iter.GetAllElement();
+        auto datas = iter.GetAllData();
         insert_into_builder_v2(builder_tuple, eles, datas);
       }
     }
@@ -832,11 +822,13 @@ class BaseEngine {
   }
 
   // We assume ctx_x and ctx_y doesn't contains duplicates.
-  // filter ctx_x with ctx_y;
-  template <
-      int alias_x, int alias_y, JoinKind join_kind, typename CTX_X,
-      typename CTX_Y,
-      typename std::enable_if<join_kind == JoinKind::AntiJoin>::type* = nullptr>
+  // filter ctx_x with ctx_y, keeping the records of ctx_x with a match for a
+  // semi join, and those without for an anti join;
+  template <int alias_x, int alias_y, JoinKind join_kind, typename CTX_X,
+            typename CTX_Y,
+            typename std::enable_if<join_kind == JoinKind::AntiJoin ||
+                                    join_kind == JoinKind::Semi>::type* =
+                nullptr>
   static auto Join(CTX_X&& ctx_x, CTX_Y&& ctx_y) {
     LOG(INFO) << "Join context with :" << gs::to_string(join_kind);
 
@@ -859,24 +851,30 @@ class BaseEngine {
         typename gs::tuple_element<real_y_ind, ctx_y_all_ele_t>::type;
     static_assert(std::is_same_v<ctx_x_join_key_t, ctx_y_join_key_t>);
 
-    std::unordered_set<ctx_y_join_key_t> key_set;
+    std::vector<ctx_y_join_key_t> y_keys;
     for (auto iter : ctx_y) {
       auto ele = iter.GetAllElement();
-      key_set.insert(gs::get_from_tuple<alias_y>(ele));
+      y_keys.emplace_back(gs::get_from_tuple<alias_y>(ele));
     }
+    std::vector<ctx_x_join_key_t> x_keys;
+    for (auto iter : ctx_x) {
+      auto ele = iter.GetAllElement();
+      x_keys.emplace_back(gs::get_from_tuple<real_x_ind>(ele));
+    }
+    // vids of a single label are looked up in a bitmap
+    auto matched =
+        semi_join_keys<ctx_y_join_key_t, std::hash<ctx_y_join_key_t>>(
+            y_keys, x_keys);
     std::vector<size_t> active_indices;
     std::vector<size_t> new_offsets;
     auto& x_head = ctx_x.GetHead();
     new_offsets.reserve(x_head.Size() + 1);
     new_offsets.emplace_back(0);
-    size_t cur_ind = 0;
-    for (auto iter : ctx_x) {
-      auto ele = iter.GetAllElement();
-      auto x_key = gs::get_from_tuple<real_x_ind>(ele);
-      if (key_set.find(x_key) == key_set.end()) {
+    static constexpr bool keep_matched = join_kind == JoinKind::Semi;
+    for (size_t cur_ind = 0; cur_ind < x_keys.size(); ++cur_ind) {
+      if (static_cast<bool>(matched[cur_ind]) == keep_matched) {
         active_indices.emplace_back(cur_ind);
       }
-      cur_ind += 1;
       new_offsets.emplace_back(active_indices.size());
     }
     x_head.SubSetWithIndices(active_indices);
@@ -979,12 +977,16 @@ class BaseEngine {
           }
           new_offsets.emplace_back(active_indices.size());
         }
-        bitset.clear();
+        // only unset the bits of this group, clearing the whole bitset costs
+        // the range of vids for every group.
+        for (auto i = y_start; i < y_end; ++i) {
+          bitset.reset_bit(y_vec[i]);
+        }
       }
     }
 
     t0 += grape::GetCurrentTime();
-    LOG(INFO) << "Intersect cost: " << t0;
+    VLOG(10) << "Intersect cost: " << t0;
     return std::make_pair(std::move(active_indices), std::move(new_offsets));
   }
 
@@ -1024,6 +1026,13 @@ class BaseEngine {
     } else {
       auto& vertices = head_y.GetVertices();
       auto& bitset = head_y.GetBitset();
+      VID_T max_vid = 0;
+      for (auto vid : head_x.GetVertices()) {
+        max_vid = std::max(max_vid, vid);
+      }
+      // marks the vertices of a group in head_y, with the label of head_x.
+      grape::Bitset y_set;
+      y_set.init(max_vid + 1);
       for (auto i = 0; i + 1 < left_repeat_array.size(); ++i) {
         auto left_min = left_repeat_array[i];
         auto left_max = left_repeat_array[i + 1];
@@ -1041,23 +1050,30 @@ class BaseEngine {
           }
         } else {
           // intersect
-          std::unordered_set<VID_T> set;
+          auto y_begin = y_iter;
           for (auto tmp = right_min; tmp < right_max; ++tmp) {
             auto ele = y_iter.GetElement();
-            if (ele.first == valid_label_ind) {
-              set.insert(ele.second);
+            if (ele.first == valid_label_ind && ele.second <= max_vid) {
+              y_set.set_bit(ele.second);
             }
             ++y_iter;
           }
           for (auto tmp = left_min; tmp < left_max; ++tmp) {
             auto ele = x_iter.GetElement();
-            if (set.find(ele) != set.end()) {
+            if (y_set.get_bit(ele)) {
               active_indices.emplace_back(ind_x);
             }
             ind_x += 1;
             ++x_iter;
             new_offsets.emplace_back(active_indices.size());
           }
+          for (auto tmp = right_min; tmp < right_max; ++tmp) {
+            auto ele = y_begin.GetElement();
+            if (ele.first == valid_label_ind && ele.second <= max_vid) {
+              y_set.reset_bit(ele.second);
+            }
+            ++y_begin;
+          }
         }
       }
       return std::make_pair(std::move(active_indices), std::move(new_offsets));
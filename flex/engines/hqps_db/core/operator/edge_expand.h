@@ -16,10 +16,13 @@ limitations under the License.
 #ifndef ENGINES_HQPS_ENGINE_OPERATOR_EDGE_EXPAND_H_
 #define ENGINES_HQPS_ENGINE_OPERATOR_EDGE_EXPAND_H_
 
+#include <algorithm>
 #include <string>
 #include <tuple>
 
 #include "flex/engines/hqps_db/core/utils/hqps_utils.h"
+#include "flex/engines/hqps_db/core/utils/morsel.h"
+#include "flex/engines/hqps_db/core/utils/sampling.h"
 
 #include "flex/engines/hqps_db/structures/multi_edge_set/adj_edge_set.h"
 #include "flex/engines/hqps_db/structures/multi_edge_set/flat_edge_set.h"
@@ -159,6 +162,140 @@ class EdgeExpand {
     return EdgeExpandVFromSingleLabel(state);
   }
 
+  /// @brief Expand to at most sample_opt.fanout_ neighbors of each vertex,
+  /// drawn uniformly from its neighbors by reservoir sampling, so that the
+  /// work of later hops is bounded by the fanout instead of the degrees.
+  /// Activation: RowVertexSet, TruePredicate.
+  template <typename... T, typename... SELECTOR,
+            typename RES_T = std::pair<vertex_set_t, std::vector<offset_t>>>
+  static RES_T SampleEdgeExpandV(
+      const GRAPH_INTERFACE& graph,
+      const RowVertexSet<label_id_t, vertex_id_t, T...>& cur_vertex_set,
+      Direction direction, label_id_t edge_label, label_id_t other_label,
+      Filter<TruePredicate, SELECTOR...>&& edge_filter,
+      const SampleOpt& sample_opt) {
+    label_id_t src_label, dst_label;
+    std::tie(src_label, dst_label) = get_graph_label_pair(
+        direction, cur_vertex_set.GetLabel(), other_label);
+    auto& src_vids = cur_vertex_set.GetVertices();
+    auto nbr_list_array =
+        graph.GetOtherVertices(src_label, dst_label, edge_label, src_vids,
+                               gs::to_string(direction), INT_MAX);
+    CHECK(nbr_list_array.size() == cur_vertex_set.Size());
+    size_t fanout = sample_opt.fanout_;
+    std::vector<offset_t> offset(nbr_list_array.size() + 1, 0);
+    for (size_t i = 0; i < nbr_list_array.size(); ++i) {
+      offset[i + 1] =
+          offset[i] + std::min(nbr_list_array.get(i).size(), fanout);
+    }
+    std::vector<vertex_id_t> vids(offset.back());
+    parallel_for_morsels(nbr_list_array.size(), [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        vertex_id_t* reservoir = vids.data() + offset[i];
+        SampleRng rng(sample_opt.seed_ ^ mix_hash(src_vids[i]));
+        size_t seen = 0;
+        for (auto nbr : nbr_list_array.get(i)) {
+          if (seen < fanout) {
+            reservoir[seen] = nbr.neighbor();
+          } else {
+            size_t j = rng.Below(seen + 1);
+            if (j < fanout) {
+              reservoir[j] = nbr.neighbor();
+            }
+          }
+          ++seen;
+        }
+      }
+    });
+    VLOG(10) << "[SampleEdgeExpandV]: " << vids.size() << " of "
+             << nbr_list_array.offsets().back() << " neighbors sampled";
+    vertex_set_t result_set(std::move(vids), other_label);
+    return std::make_pair(std::move(result_set), std::move(offset));
+  }
+
+  /// @brief Expand to the vertices of other_label on which the filter of the
+  /// GetV that follows holds, as one operator. The neighbors are filtered as
+  /// they are read from the adjacency lists, so the set of all neighbors is
+  /// never built.
+  /// Activation: RowVertexSet, TruePredicate on edges.
+  template <typename... T, typename... SELECTOR, typename LabelT,
+            size_t num_labels, typename EXPRESSION, typename... V_SELECTOR,
+            typename RES_T = std::pair<vertex_set_t, std::vector<offset_t>>>
+  static RES_T EdgeExpandVFilter(
+      const GRAPH_INTERFACE& graph,
+      const RowVertexSet<label_id_t, vertex_id_t, T...>& cur_vertex_set,
+      Direction direction, label_id_t edge_label, label_id_t other_label,
+      Filter<TruePredicate, SELECTOR...>&& edge_filter,
+      GetVOpt<LabelT, num_labels, Filter<EXPRESSION, V_SELECTOR...>>&&
+          get_v_opt,
+      size_t limit = INT_MAX) {
+    label_id_t src_label, dst_label;
+    std::tie(src_label, dst_label) = get_graph_label_pair(
+        direction, cur_vertex_set.GetLabel(), other_label);
+    auto nbr_list_array = graph.GetOtherVertices(
+        src_label, dst_label, edge_label, cur_vertex_set.GetVertices(),
+        gs::to_string(direction), limit);
+    CHECK(nbr_list_array.size() == cur_vertex_set.Size());
+
+    std::vector<offset_t> offset;
+    std::vector<vertex_id_t> vids;
+    offset.reserve(nbr_list_array.size() + 1);
+    offset.emplace_back(0);
+    if (takes_label(get_v_opt.v_labels_, other_label)) {
+      auto prop_getter = get_prop_getter_from_selectors(
+          graph, other_label, get_v_opt.filter_.selectors_);
+      auto& expr = get_v_opt.filter_.expr_;
+      for (size_t i = 0; i < nbr_list_array.size(); ++i) {
+        for (auto nbr : nbr_list_array.get(i)) {
+          auto vid = nbr.neighbor();
+          if (std::apply(expr, prop_getter.get_view(vid))) {
+            vids.emplace_back(vid);
+          }
+        }
+        offset.emplace_back(vids.size());
+      }
+    } else {
+      offset.resize(nbr_list_array.size() + 1, 0);
+    }
+    VLOG(10) << "[EdgeExpandVFilter]: " << vids.size() << " of "
+             << nbr_list_array.offsets().back() << " neighbors kept";
+    vertex_set_t result_set(std::move(vids), other_label);
+    return std::make_pair(std::move(result_set), std::move(offset));
+  }
+
+  /// @brief Expand to the vertices of other_label on which the filter of the
+  /// GetV that follows holds, for the other sets, by EdgeExpandV, and then
+  /// the filter on the expanded set, whose offsets are composed.
+  template <typename VERTEX_SET_T, typename EDGE_FILTER_T, typename LabelT,
+            size_t num_labels, typename EXPRESSION, typename... V_SELECTOR,
+            typename RES_T = std::pair<vertex_set_t, std::vector<offset_t>>>
+  static RES_T EdgeExpandVFilter(
+      const GRAPH_INTERFACE& graph, const VERTEX_SET_T& cur_vertex_set,
+      Direction direction, label_id_t edge_label, label_id_t other_label,
+      EDGE_FILTER_T&& edge_filter,
+      GetVOpt<LabelT, num_labels, Filter<EXPRESSION, V_SELECTOR...>>&&
+          get_v_opt,
+      size_t limit = INT_MAX) {
+    auto expanded =
+        EdgeExpandV(graph, cur_vertex_set, direction, edge_label, other_label,
+                    std::move(edge_filter), limit);
+    auto& offset = expanded.second;
+    if (!takes_label(get_v_opt.v_labels_, other_label)) {
+      std::fill(offset.begin(), offset.end(), 0);
+      return std::make_pair(vertex_set_t(std::vector<vertex_id_t>(),
+                                         other_label),
+                            std::move(offset));
+    }
+    auto prop_getters = std::array{get_prop_getter_from_selectors(
+        graph, other_label, get_v_opt.filter_.selectors_)};
+    auto filtered = expanded.first.project_vertices(
+        get_v_opt.v_labels_, get_v_opt.filter_.expr_, prop_getters);
+    for (auto& cur : offset) {
+      cur = filtered.second[cur];
+    }
+    return std::make_pair(std::move(filtered.first), std::move(offset));
+  }
+
   /// @brief Directly obtain vertices from edge, without property and apply from
   /// multi label set, Activation: MultiLabelVertexSet, TruePredicate.
   /// @tparam EDATA_T
@@ -200,19 +337,19 @@ class EdgeExpand {
       nbr_lists.emplace_back(std::move(nbr_list_array));
     }
 
+    size_t total_size = 0;
+    for (auto& nbr_list_array : nbr_lists) {
+      total_size += nbr_list_array.offsets().back();
+    }
+    vids.reserve(total_size);
     offset.reserve(state.cur_vertex_set_.Size() + 1);
-    // first gather size.
     offset.emplace_back(vids.size());
     for (auto iter : state.cur_vertex_set_) {
-      auto vid = iter.GetVertex();
       auto cur_set_ind = iter.GetCurInd();
       auto set_inner_ind = iter.GetCurSetInnerInd();
       CHECK(nbr_lists.size() > cur_set_ind);
       CHECK(nbr_lists[cur_set_ind].size() > set_inner_ind);
-      auto& cur_array = nbr_lists[cur_set_ind];
-      auto cur_nbr_list = cur_array.get(set_inner_ind);
-      // VLOG(10) << "vertex: " << vid << ", num nbrs: " << cur_nbr_list.size();
-
+      auto cur_nbr_list = nbr_lists[cur_set_ind].get(set_inner_ind);
       for (auto nbr : cur_nbr_list) {
         // TODO: use edge_filter to filter.
         vids.emplace_back(nbr.neighbor());
@@ -252,49 +389,7 @@ class EdgeExpand {
 
     std::vector<vertex_id_t> vids;
     std::vector<offset_t> offset;
-    static constexpr size_t num_src_labels = VERTEX_SET_T::num_labels;
-    using nbr_list_t = typename GRAPH_INTERFACE::nbr_list_t;
-    using nbr_list_array_t = typename GRAPH_INTERFACE::nbr_list_array_t;
-    nbr_list_array_t nbr_list_array;
-    nbr_list_array.resize(state.cur_vertex_set_.Size());
-
-    for (auto i = 0; i < num_src_labels; ++i) {
-      std::vector<vertex_id_t> cur_vids;
-      std::vector<int32_t> active_inds;
-      std::tie(cur_vids, active_inds) = state.cur_vertex_set_.GetVertices(i);
-      label_id_t cur_label = state.cur_vertex_set_.GetLabel(i);
-      label_id_t src_label, dst_label;
-      std::tie(src_label, dst_label) =
-          get_graph_label_pair(direction, cur_label, state.other_label_);
-
-      VLOG(10) << "[EdgeExpandV-TwoLabelSet]: from label: "
-               << ",edge label: " << state.edge_label_ << "src: " << src_label
-               << ",dst: " << dst_label << ",dire: " << state.direction_;
-      auto tmp_nbr_list_array = state.graph_.GetOtherVertices(
-          src_label, dst_label, state.edge_label_, cur_vids,
-          gs::to_string(state.direction_), state.limit_);
-      // nbr_lists.emplace_back(std::move(nbr_list_array));
-
-      CHECK(tmp_nbr_list_array.size() == active_inds.size());
-      for (auto i = 0; i < active_inds.size(); ++i) {
-        auto dst_ind = active_inds[i];
-        CHECK(nbr_list_array.get(dst_ind).size() == 0);
-        nbr_list_array.get_vector(dst_ind).swap(
-            tmp_nbr_list_array.get_vector(i));
-      }
-    }
-    CHECK(nbr_list_array.size() == state.cur_vertex_set_.Size());
-
-    offset.reserve(state.cur_vertex_set_.Size() + 1);
-    // first gather size.
-    offset.emplace_back(vids.size());
-    for (auto i = 0; i < nbr_list_array.size(); ++i) {
-      for (auto nbr : nbr_list_array.get(i)) {
-        // TODO: use edge_filter to filter.
-        vids.emplace_back(nbr.neighbor());
-      }
-      offset.emplace_back(vids.size());
-    }
+    std::tie(vids, offset) = expand_vertices_by_label(state);
     vertex_set_t result_set(std::move(vids), state.other_label_);
     auto pair = std::make_pair(std::move(result_set), std::move(offset));
     return pair;
@@ -326,51 +421,7 @@ class EdgeExpand {
 
     std::vector<vertex_id_t> vids;
     std::vector<offset_t> offset;
-    static constexpr size_t num_src_labels = VERTEX_SET_T::num_labels;
-    using nbr_list_t = typename GRAPH_INTERFACE::nbr_list_t;
-    using nbr_list_array_t = typename GRAPH_INTERFACE::nbr_list_array_t;
-    nbr_list_array_t nbr_list_array;
-    nbr_list_array.resize(state.cur_vertex_set_.Size());
-
-    for (auto i = 0; i < num_src_labels; ++i) {
-      std::vector<vertex_id_t> cur_vids;
-      std::vector<int32_t> active_inds;
-      std::tie(cur_vids, active_inds) = state.cur_vertex_set_.GetVertices(i);
-      label_id_t cur_label = state.cur_vertex_set_.GetLabel(i);
-      label_id_t src_label, dst_label;
-      std::tie(src_label, dst_label) =
-          get_graph_label_pair(direction, cur_label, state.other_label_);
-
-      VLOG(10) << "[EdgeExpandV]: from label: "
-               << ",edge label: " << state.edge_label_ << "src: " << src_label
-               << ",dst: " << dst_label << ",dire: " << state.direction_;
-      auto tmp_nbr_list_array = state.graph_.GetOtherVertices(
-          src_label, dst_label, state.edge_label_, cur_vids,
-          gs::to_string(state.direction_), state.limit_);
-      // nbr_lists.emplace_back(std::move(nbr_list_array));
-
-      CHECK(tmp_nbr_list_array.size() == active_inds.size());
-      for (auto i = 0; i < active_inds.size(); ++i) {
-        auto dst_ind = active_inds[i];
-        CHECK(nbr_list_array.get(dst_ind).size() == 0);
-        nbr_list_array.get_vector(dst_ind).swap(
-            tmp_nbr_list_array.get_vector(i));
-      }
-    }
-    CHECK(nbr_list_array.size() == state.cur_vertex_set_.Size());
-
-    offset.reserve(state.cur_vertex_set_.Size() + 1);
-    // first gather size.
-    offset.emplace_back(vids.size());
-    for (auto i = 0; i < nbr_list_array.size(); ++i) {
-      for (auto nbr : nbr_list_array.get(i)) {
-        // TODO: use edge_filter to filter.
-        vids.emplace_back(nbr.neighbor());
-      }
-      offset.emplace_back(vids.size());
-    }
-    VLOG(10) << "vids size: " << vids.size();
-    VLOG(10) << "offset: " << gs::to_string(offset);
+    std::tie(vids, offset) = expand_vertices_by_label(state);
     vertex_set_t result_set(std::move(vids), state.other_label_);
     auto pair = std::make_pair(std::move(result_set), std::move(offset));
     return pair;
@@ -393,6 +444,11 @@ class EdgeExpand {
       Direction direction, label_id_t edge_label, label_id_t other_label,
       Filter<EDGE_FILTER_T, SELECTOR...>&& edge_filter,
       size_t limit = INT_MAX) {
+    if constexpr (IsEdgeTimeRange<EDGE_FILTER_T>::value) {
+      return EdgeExpandVInTimeRange(graph, cur_vertex_set, direction,
+                                    edge_label, other_label,
+                                    edge_filter.expr_);
+    }
     auto state = EdgeExpandVState(graph, cur_vertex_set, direction, edge_label,
                                   other_label, std::move(edge_filter), limit);
     label_id_t src_label, dst_label;
@@ -434,6 +490,31 @@ class EdgeExpand {
     return pair;
   }
 
+  // The edges of a time range are found by binary search in time-ordered
+  // lists, see MutableCSRInterface::ForEachEdgeInTimeRange.
+  template <typename T, typename... SET_T,
+            typename RES_T = std::pair<vertex_set_t, std::vector<offset_t>>>
+  static RES_T EdgeExpandVInTimeRange(
+      const GRAPH_INTERFACE& graph,
+      const RowVertexSet<label_id_t, vertex_id_t, SET_T...>& cur_vertex_set,
+      Direction direction, label_id_t edge_label, label_id_t other_label,
+      const EdgeTimeRange<T>& range) {
+    label_id_t v_label = cur_vertex_set.GetLabel();
+    std::vector<vertex_id_t> vids;
+    std::vector<offset_t> offset;
+    offset.reserve(cur_vertex_set.Size() + 1);
+    offset.emplace_back(0);
+    for (auto v : cur_vertex_set.GetVertices()) {
+      graph.template ForEachEdgeInTimeRange<T>(
+          v_label, v, other_label, edge_label, direction, range.begin_,
+          range.end_,
+          [&vids](vertex_id_t nbr, const T&) { vids.emplace_back(nbr); });
+      offset.emplace_back(vids.size());
+    }
+    vertex_set_t result_set(std::move(vids), other_label);
+    return std::make_pair(std::move(result_set), std::move(offset));
+  }
+
   /// @brief Directly obtain multiple label vertices from edge.
   /// @tparam EDATA_T
   /// @tparam VERTEX_SET_T
@@ -851,6 +932,66 @@ class EdgeExpand {
   }
 
  private:
+  // Expand a set of vertices of several labels, whose vertices are split into
+  // one run per label in a single pass. The neighbor lists of all labels are
+  // sized before the neighbors are written, in set order, into one array.
+  template <typename VERTEX_SET_T, typename EDGE_FILTER_T>
+  static std::pair<std::vector<vertex_id_t>, std::vector<offset_t>>
+  expand_vertices_by_label(
+      EdgeExpandVState<GRAPH_INTERFACE, VERTEX_SET_T, EDGE_FILTER_T>& state) {
+    static constexpr size_t num_src_labels = VERTEX_SET_T::num_labels;
+    using nbr_list_array_t = typename GRAPH_INTERFACE::nbr_list_array_t;
+    std::array<nbr_list_array_t, num_src_labels> nbr_lists;
+    std::array<std::vector<int32_t>, num_src_labels> active_inds;
+    std::vector<offset_t> offset(state.cur_vertex_set_.Size() + 1, 0);
+    auto segments = state.cur_vertex_set_.GetLabelSegments();
+    for (size_t i = 0; i < num_src_labels; ++i) {
+      std::vector<vertex_id_t> cur_vids;
+      std::tie(cur_vids, active_inds[i]) = segments.Release(i);
+      label_id_t src_label, dst_label;
+      std::tie(src_label, dst_label) = get_graph_label_pair(
+          state.direction_, state.cur_vertex_set_.GetLabel(i),
+          state.other_label_);
+      VLOG(10) << "[EdgeExpandV]: from label: " << src_label
+               << ",edge label: " << state.edge_label_ << ",dst: " << dst_label
+               << ",dire: " << state.direction_;
+      nbr_lists[i] = state.graph_.GetOtherVertices(
+          src_label, dst_label, state.edge_label_, cur_vids,
+          gs::to_string(state.direction_), state.limit_);
+      CHECK(nbr_lists[i].size() == active_inds[i].size());
+      for (size_t j = 0; j < active_inds[i].size(); ++j) {
+        offset[active_inds[i][j] + 1] = nbr_lists[i].get(j).size();
+      }
+    }
+    for (size_t i = 1; i < offset.size(); ++i) {
+      offset[i] += offset[i - 1];
+    }
+
+    std::vector<vertex_id_t> vids(offset.back());
+    for (size_t i = 0; i < num_src_labels; ++i) {
+      for (size_t j = 0; j < active_inds[i].size(); ++j) {
+        size_t cur = offset[active_inds[i][j]];
+        for (auto nbr : nbr_lists[i].get(j)) {
+          vids[cur++] = nbr.neighbor();
+        }
+      }
+    }
+    VLOG(10) << "vids size: " << vids.size();
+    return std::make_pair(std::move(vids), std::move(offset));
+  }
+
+  // Whether a GetV with the labels takes the vertices of the label, where no
+  // labels means all of them.
+  template <typename LabelT, size_t num_labels>
+  static bool takes_label(const std::array<LabelT, num_labels>& labels,
+                          label_id_t label) {
+    if constexpr (num_labels == 0) {
+      return true;
+    } else {
+      return std::find(labels.begin(), labels.end(), label) != labels.end();
+    }
+  }
+
   template <typename VERTEX_SET_T, typename... SELECTOR>
   static auto EdgeExpandVFromSingleLabel(
       EdgeExpandVState<GRAPH_INTERFACE, VERTEX_SET_T,
@@ -871,19 +1012,20 @@ class EdgeExpand {
         src_label, dst_label, state.edge_label_,
         state.cur_vertex_set_.GetVertices(), gs::to_string(state.direction_),
         state.limit_);
-    std::vector<vertex_id_t> vids;
-    std::vector<offset_t> offset;
-    offset.reserve(state.cur_vertex_set_.Size() + 1);
     CHECK(nbr_list_array.size() == state.cur_vertex_set_.Size());
-    // first gather size.
-    offset.emplace_back(vids.size());
-    for (auto i = 0; i < nbr_list_array.size(); ++i) {
-      auto nbr_list = nbr_list_array.get(i);
-      for (auto nbr : nbr_list) {
-        vids.emplace_back(nbr.neighbor());
+    // the lists are already sized, morsels fill their disjoint ranges.
+    const auto& nbr_offsets = nbr_list_array.offsets();
+    std::vector<offset_t> offset(nbr_offsets.begin(), nbr_offsets.end());
+    std::vector<vertex_id_t> vids(offset.back());
+    parallel_for_morsels(nbr_list_array.size(), [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        auto nbr_list = nbr_list_array.get(i);
+        size_t cur = offset[i];
+        for (auto nbr : nbr_list) {
+          vids[cur++] = nbr.neighbor();
+        }
       }
-      offset.emplace_back(vids.size());
-    }
+    });
 
     vertex_set_t result_set(std::move(vids), state.other_label_);
     auto pair = std::make_pair(std::move(result_set), std::move(offset));
@@ -990,10 +1132,10 @@ class EdgeExpand {
     }
 
     auto direction_str = gs::to_string(state.direction_);
+    auto segments = general_set.GetLabelSegments();
     for (auto i = 0; i < num_labels; ++i) {
-      std::vector<vertex_id_t> cur_vids;
-      std::vector<int32_t> cur_active_inds;
-      std::tie(cur_vids, cur_active_inds) = general_set.GetVertices(i);
+      const auto& cur_vids = segments.GetVertices(i);
+      const auto& cur_active_inds = segments.GetIndices(i);
       auto tmp = state.graph_.template GetEdges<T...>(
           src_label, dst_label, state.edge_label_, cur_vids, direction_str,
           state.limit_, prop_names);
@@ -1051,6 +1193,7 @@ class EdgeExpand {
     label_id_t src_label, dst_label;
 
     auto direction_str = gs::to_string(state.direction_);
+    auto segments = general_set.GetLabelSegments();
     for (auto i = 0; i < num_labels; ++i) {
       if (state.direction_ == Direction::In) {
         src_label = state.other_label_;
@@ -1059,9 +1202,8 @@ class EdgeExpand {
         src_label = general_set.GetLabel(i);
         dst_label = state.other_label_;
       }
-      std::vector<vertex_id_t> cur_vids;
-      std::vector<int32_t> cur_active_inds;
-      std::tie(cur_vids, cur_active_inds) = general_set.GetVertices(i);
+      const auto& cur_vids = segments.GetVertices(i);
+      const auto& cur_active_inds = segments.GetIndices(i);
       auto tmp = state.graph_.template GetEdges<T...>(
           src_label, dst_label, state.edge_label_, cur_vids, direction_str,
           state.limit_, prop_names);
@@ -1141,9 +1283,8 @@ class EdgeExpand {
     size_t size = 0;
     offset.emplace_back(size);
     CHECK(cur_set.Size() == adj_list_array.size());
-    std::vector<std::tuple<vertex_id_t, vertex_id_t, std::tuple<T...>>>
-        prop_tuples;
-    prop_tuples.reserve(cur_set.Size() + 1);
+    FlatEdgeColumns<vertex_id_t, T...> columns;
+    columns.Reserve(cur_set.Size() + 1);
     // Construct offset from adj_list.
     auto cur_set_iter = cur_set.begin();
     auto end_iter = cur_set.end();
@@ -1156,20 +1297,19 @@ class EdgeExpand {
         // current hack impl for edge property
         // TODO: better performance
         if (run_expr_filter(state.edge_filter_.expr_, props)) {
-          prop_tuples.emplace_back(
-              std::make_tuple(src, edge.neighbor(), props));
+          columns.EmplaceBack(src, edge.neighbor(), props);
         }
       }
       ++cur_set_iter;
-      offset.emplace_back(prop_tuples.size());
+      offset.emplace_back(columns.Size());
     }
-    VLOG(10) << "num edges: " << prop_tuples.size();
+    VLOG(10) << "num edges: " << columns.Size();
     // VLOG(10) << "offset: array: " << gs::to_string(offset);
     // copy vids
     auto copied_vids(cur_set.GetVertices());
-    std::vector<label_id_t> label_vec(prop_tuples.size(), cur_set.GetLabel());
+    std::vector<label_id_t> label_vec(columns.Size(), cur_set.GetLabel());
     FlatEdgeSet<vertex_id_t, label_id_t, 1, T...> edge_set(
-        std::move(prop_tuples), state.edge_label_, {cur_set.GetLabel()},
+        std::move(columns), state.edge_label_, {cur_set.GetLabel()},
         state.other_label_, prop_names, std::move(label_vec), state.direction_);
 
     CHECK(offset.back() == edge_set.Size())
@@ -17,13 +17,14 @@ limitations under the License.
 #define ENGINES_HQPS_ENGINE_OPERATOR_GROUP_H_
 
 #include <tuple>
-#include <unordered_map>
 #include <vector>
 
 #include "flex/engines/hqps_db/core/context.h"
 #include "flex/engines/hqps_db/core/params.h"
+#include "flex/engines/hqps_db/core/utils/flat_index_map.h"
 #include "flex/engines/hqps_db/core/utils/keyed.h"
 #include "flex/engines/hqps_db/structures/collection.h"
+#include "flex/utils/query_memory.h"
 
 namespace gs {
 
@@ -81,6 +82,12 @@ struct GroupValueResTImpl<SET_T, AggFunc::COUNT_DISTINCT,
   using result_t = Collection<size_t>;
 };
 
+template <typename SET_T>
+struct GroupValueResTImpl<SET_T, AggFunc::APPROX_COUNT_DISTINCT,
+                          std::tuple<PropertySelector<grape::EmptyType>>> {
+  using result_t = Collection<size_t>;
+};
+
 template <typename T>
 struct GroupValueResTImpl<Collection<T>, AggFunc::SUM,
                           std::tuple<PropertySelector<grape::EmptyType>>> {
@@ -134,6 +141,19 @@ struct GroupValueResTImpl<RowVertexSet<LabelT, VID_T, SET_T...>, AggFunc::MAX,
   using result_t = Collection<T>;
 };
 
+// sum and min of a property of vertexset, aggregated inline as max.
+template <typename LabelT, typename VID_T, typename... SET_T, typename T>
+struct GroupValueResTImpl<RowVertexSet<LabelT, VID_T, SET_T...>, AggFunc::SUM,
+                          std::tuple<PropertySelector<T>>> {
+  using result_t = Collection<T>;
+};
+
+template <typename LabelT, typename VID_T, typename... SET_T, typename T>
+struct GroupValueResTImpl<RowVertexSet<LabelT, VID_T, SET_T...>, AggFunc::MIN,
+                          std::tuple<PropertySelector<T>>> {
+  using result_t = Collection<T>;
+};
+
 // support get first from vertexset
 template <typename LabelT, typename VID_T, typename... SET_T, typename T>
 struct GroupValueResTImpl<RowVertexSet<LabelT, VID_T, SET_T...>, AggFunc::FIRST,
@@ -337,6 +357,9 @@ class GroupByOp {
         graph, ctx.GetPrevCols(), ctx.GetHead(), agg_tuple,
         std::make_index_sequence<grouped_value_num>());
 
+    QueryMemoryCharge charge("GroupBy");
+    size_t group_num = 0;
+
     // if group_key use property, we need property getter
     // else we just insert into key_set
     if constexpr (group_key_on_property<key_alias_t>::value) {
@@ -352,6 +375,8 @@ class GroupByOp {
         auto data_ele = gs::get_from_tuple<GROUP_KEY::col_id>(data_tuple);
         size_t ind = insert_to_keyed_set_with_prop_getter(keyed_set_builder,
                                                           prop_getter, key_ele);
+        charge_groups<decltype(key_ele), grouped_value_num>(charge, group_num,
+                                                            ind);
 
         insert_to_value_set_builder(value_set_builder_tuple, ele_tuple,
                                     data_tuple, ind);
@@ -364,6 +389,8 @@ class GroupByOp {
         auto key_ele = gs::get_from_tuple<key_alias_t::tag_id>(ele_tuple);
         auto data_ele = gs::get_from_tuple<key_alias_t::tag_id>(data_tuple);
         size_t ind = insert_to_keyed_set(keyed_set_builder, key_ele, data_ele);
+        charge_groups<decltype(key_ele), grouped_value_num>(charge, group_num,
+                                                            ind);
         insert_to_value_set_builder(value_set_builder_tuple, ele_tuple,
                                     data_tuple, ind);
       }
@@ -448,9 +475,10 @@ class GroupByOp {
       auto keyed_set_builder0 = old_key_set0.CreateBuilder();
       auto keyed_set_builder1 = old_key_set1.CreateBuilder();
       using con_key_ele_t = std::pair<old_key_set_ele0_t, old_key_set_ele1_t>;
-      std::unordered_map<con_key_ele_t, int, boost::hash<con_key_ele_t>>
-          key_tuple_set;
-      size_t cur_ind = 0;
+      FlatIndexMap<con_key_ele_t> key_tuple_set;
+      key_tuple_set.reserve(ctx.GetHead().Size());
+      QueryMemoryCharge charge("GroupBy");
+      size_t group_num = 0;
       for (auto iter : ctx) {
         auto ele_tuple = iter.GetAllIndexElement();
         auto data_tuple = iter.GetAllData();
@@ -461,16 +489,13 @@ class GroupByOp {
 
         auto data_ele0 = gs::get_from_tuple<keyed_tag_id0>(data_tuple);
         auto data_ele1 = gs::get_from_tuple<keyed_tag_id1>(data_tuple);
-        size_t ind = 0;
-        if (key_tuple_set.find(tmp_ele) != key_tuple_set.end()) {
-          // already exist
-          auto ind = key_tuple_set[tmp_ele];
-        } else {
-          // not exist
-          ind = cur_ind++;
+        auto res = key_tuple_set.insert(tmp_ele);
+        size_t ind = res.first;
+        if (res.second) {
+          charge_groups<con_key_ele_t, grouped_value_num>(charge, group_num,
+                                                          ind);
           insert_into_builder_v2_impl(keyed_set_builder0, key_ele0, data_ele0);
           insert_into_builder_v2_impl(keyed_set_builder1, key_ele1, data_ele1);
-          key_tuple_set[tmp_ele] = ind;
         }
         // CHECK insert key.
         insert_to_value_set_builder(value_set_builder_tuple, ele_tuple,
@@ -505,6 +530,21 @@ class GroupByOp {
     }
   }
 
+  // Charge the groups up to ind to the query, as an estimate of the key in
+  // the index of the keys and in the keyed set, and an entry of each
+  // aggregate. A group by holding more groups than the query affords fails
+  // with QueryMemoryExceeded, as its aggregates are built in memory.
+  template <typename KEY_T, size_t agg_num>
+  static inline void charge_groups(QueryMemoryCharge& charge,
+                                   size_t& group_num, size_t ind) {
+    static constexpr size_t group_size =
+        2 * sizeof(KEY_T) + (agg_num + 1) * sizeof(size_t);
+    if (ind >= group_num) {
+      charge.Grow((ind + 1 - group_num) * group_size);
+      group_num = ind + 1;
+    }
+  }
+
   // ind is the index of the key in the key set
   template <size_t Is = 0, typename ele_tuple_t, typename data_tuple_t,
             typename... SET_T>
@@ -16,9 +16,11 @@ limitations under the License.
 #ifndef ENGINES_HQPS_ENGINE_OPERATOR_PATH_EXPAND_H_
 #define ENGINES_HQPS_ENGINE_OPERATOR_PATH_EXPAND_H_
 
+#include <algorithm>
 #include <string>
 
 #include "flex/engines/hqps_db/core/params.h"
+#include "flex/engines/hqps_db/core/utils/flat_index_map.h"
 #include "flex/engines/hqps_db/core/utils/hqps_utils.h"
 #include "flex/engines/hqps_db/structures/multi_vertex_set/row_vertex_set.h"
 
@@ -47,6 +49,9 @@ class PathExpand {
 
   template <typename... T>
   using vertex_set_t = RowVertexSet<label_id_t, vertex_id_t, T...>;
+
+  // Number of source vertices expanded together by PathExpandRawVMultiV.
+  static constexpr size_t kPathExpandBatchSize = 1024;
   // Path expand to vertices with columns.
 
   // PathExpand to vertices with vertex properties also retreived
@@ -95,10 +100,9 @@ class PathExpand {
     auto& edge_expand_opt = path_expand_opt.edge_expand_opt_;
     auto& get_v_opt = path_expand_opt.get_v_opt_;
 
-    std::vector<vertex_id_t> input_v_0, input_v_1;
-    std::vector<int32_t> active_ind0, active_ind1;
-    std::tie(input_v_0, active_ind0) = vertex_set.GetVertices(0);
-    std::tie(input_v_1, active_ind1) = vertex_set.GetVertices(1);
+    auto segments = vertex_set.GetLabelSegments();
+    const auto& input_v_0 = segments.GetVertices(0);
+    const auto& input_v_1 = segments.GetVertices(1);
 
     std::vector<vertex_id_t> vids_vec0, vids_vec1;
     std::vector<int32_t> dist_vec0, dist_vec1;
@@ -193,9 +197,7 @@ class PathExpand {
     std::vector<vertex_id_t> gids;
     std::vector<vertex_id_t> tmp_vec;
     std::vector<offset_t> offsets;
-    // std::vector<std::vector<vertex_id_t>> gids;
-    // std::vector<std::vector<offset_t>> offsets;
-    std::unordered_set<vertex_id_t> visited_vertices;
+    FlatIndexMap<vertex_id_t> visited_vertices;
     std::vector<Dist> dists;
 
     // init for index 0
@@ -206,42 +208,28 @@ class PathExpand {
       dists.emplace_back(0);
     }
 
-    double visit_array_time = 0.0;
-    for (auto cur_hop = 1; cur_hop < range.limit_; ++cur_hop) {
-      double t0 = -grape::GetCurrentTime();
+    std::string direction = gs::to_string(edge_expand_opt.dir_);
+    for (auto cur_hop = 1; cur_hop < range.limit_ && !tmp_vec.empty();
+         ++cur_hop) {
       std::vector<size_t> unused;
       std::tie(tmp_vec, unused) = graph.GetOtherVerticesV2(
           src_label, edge_expand_opt.other_label_, edge_expand_opt.edge_label_,
-          tmp_vec, gs::to_string(edge_expand_opt.dir_), INT_MAX);
-      // remove duplicate
+          tmp_vec, direction, INT_MAX);
+      // remove the vertices visited, in previous hops or in this one, so each
+      // vertex is expanded once.
       size_t limit = 0;
       for (auto i = 0; i < tmp_vec.size(); ++i) {
-        if (visited_vertices.find(tmp_vec[i]) == visited_vertices.end()) {
+        if (visited_vertices.insert(tmp_vec[i]).second) {
           tmp_vec[limit++] = tmp_vec[i];
         }
       }
       tmp_vec.resize(limit);
       if (cur_hop >= range.start_) {
-        // emplace tmp_vec to gids;
-        for (auto i = 0; i < tmp_vec.size(); ++i) {
-          auto nbr_gid = tmp_vec[i];
-          auto insert_res = visited_vertices.insert(nbr_gid);
-          if (insert_res.second) {
-            gids.emplace_back(nbr_gid);
-            dists.emplace_back(cur_hop);
-          }
-        }
-      } else {
-        // when cur_hop is not included, we also need to insert vertices into
-        // set, to avoid duplicated.
-        for (auto i = 0; i < tmp_vec.size(); ++i) {
-          auto nbr_gid = tmp_vec[i];
-          visited_vertices.insert(nbr_gid);
-        }
+        gids.insert(gids.end(), tmp_vec.begin(), tmp_vec.end());
+        dists.resize(gids.size(), cur_hop);
       }
     }
-    LOG(INFO) << "visit array time: " << visit_array_time
-              << ", gid size: " << gids.size();
+    VLOG(10) << "gid size: " << gids.size();
     // select vetices that are in range.
     offsets.emplace_back(0);
     offsets.emplace_back(gids.size());
@@ -253,6 +241,8 @@ class PathExpand {
   // TODO: dedup can be used to speed up the query when the input vertices
   // size if 1.
   // const VERTEX_SET_T& vertex_set,
+  // The source vertices are expanded in batches, so that the vertices of the
+  // hops are only kept for a batch, until they are flattened into the result.
   template <typename LabelT, typename EDGE_FILTER_T>
   static std::tuple<std::vector<vertex_id_t>, std::vector<Dist>,
                     std::vector<offset_t>>
@@ -264,85 +254,75 @@ class PathExpand {
     // auto src_vertices_vec = vertex_set.GetVertices();
     auto src_vertices_size = src_vertices_vec.size();
     if (src_vertices_size == 1) {
-      LOG(INFO)
+      VLOG(10)
           << "[NOTE:] PathExpandRawVMultiV is used for single vertex expand, "
              "dedup is enabled.";
       return PathExpandRawV2ForSingleV(graph, src_label, src_vertices_vec,
                                        range, edge_expand_opt);
     }
-    std::vector<std::vector<vertex_id_t>> gids;
-    std::vector<std::vector<offset_t>> offsets;
-    std::unordered_set<vertex_id_t> visited_vertices;
-
-    gids.resize(range.limit_);
-    offsets.resize(range.limit_);
-    for (auto i = 0; i < range.limit_; ++i) {
-      offsets.reserve(src_vertices_size + 1);
-    }
+    // vertices reached by each hop from the current batch, and the offsets of
+    // each source vertex in them.
+    std::vector<std::vector<vertex_id_t>> gids(range.limit_);
+    std::vector<std::vector<offset_t>> offsets(range.limit_);
+    std::string direction = gs::to_string(edge_expand_opt.dir_);
 
-    // init for index 0
-    gids[0].insert(gids[0].begin(), src_vertices_vec.begin(),
-                   src_vertices_vec.end());
-    // offsets[0] set with all 1s
-    for (auto i = 0; i < src_vertices_size; ++i) {
-      offsets[0].emplace_back(i);
-    }
-    offsets[0].emplace_back(src_vertices_size);
-    visited_vertices.insert(src_vertices_vec.begin(), src_vertices_vec.end());
+    std::vector<vertex_id_t> flat_gids;
+    std::vector<offset_t> flat_offsets;
+    std::vector<Dist> dists;
+    flat_offsets.reserve(src_vertices_size + 1);
+    flat_offsets.emplace_back(0);
 
     double visit_array_time = 0.0;
-    for (auto cur_hop = 1; cur_hop < range.limit_; ++cur_hop) {
-      double t0 = -grape::GetCurrentTime();
-      auto pair = graph.GetOtherVerticesV2(
-          src_label, edge_expand_opt.other_label_, edge_expand_opt.edge_label_,
-          gids[cur_hop - 1], gs::to_string(edge_expand_opt.dir_), INT_MAX);
+    for (size_t batch_begin = 0; batch_begin < src_vertices_size;
+         batch_begin += kPathExpandBatchSize) {
+      size_t batch_size =
+          std::min(kPathExpandBatchSize, src_vertices_size - batch_begin);
+      // init for index 0
+      gids[0].assign(src_vertices_vec.begin() + batch_begin,
+                     src_vertices_vec.begin() + batch_begin + batch_size);
+      offsets[0].resize(batch_size + 1);
+      for (size_t i = 0; i <= batch_size; ++i) {
+        offsets[0][i] = i;
+      }
 
-      gids[cur_hop].swap(pair.first);
-      CHECK(gids[cur_hop - 1].size() + 1 == pair.second.size());
-      // offsets[cur_hop].swap(pair.second);
-      for (auto j = 0; j < offsets[cur_hop - 1].size(); ++j) {
+      double t0 = -grape::GetCurrentTime();
+      for (auto cur_hop = 1; cur_hop < range.limit_; ++cur_hop) {
+        auto pair = graph.GetOtherVerticesV2(
+            src_label, edge_expand_opt.other_label_,
+            edge_expand_opt.edge_label_, gids[cur_hop - 1], direction,
+            INT_MAX);
+
+        gids[cur_hop].swap(pair.first);
+        CHECK(gids[cur_hop - 1].size() + 1 == pair.second.size());
         auto& new_off_vec = pair.second;
-        offsets[cur_hop].emplace_back(new_off_vec[offsets[cur_hop - 1][j]]);
+        offsets[cur_hop].clear();
+        for (auto off : offsets[cur_hop - 1]) {
+          offsets[cur_hop].emplace_back(new_off_vec[off]);
+        }
       }
       t0 += grape::GetCurrentTime();
       visit_array_time += t0;
-    }
-    LOG(INFO) << "visit array time: " << visit_array_time;
-    // select vetices that are in range.
-    std::vector<vertex_id_t> flat_gids;
-    std::vector<offset_t> flat_offsets;
-    std::vector<Dist> dists;
 
-    {
+      // select vetices that are in range.
       size_t flat_size = 0;
       for (auto i = range.start_; i < range.limit_; ++i) {
         flat_size += gids[i].size();
       }
-      VLOG(10) << "flat size: " << flat_size;
-      flat_gids.reserve(flat_size);
-      dists.reserve(flat_size);
-      flat_offsets.reserve(src_vertices_size + 1);
-
-      flat_offsets.emplace_back(0);
-      // for vertices already appears in [0, range.start_)
-      // we add vertices to vertex set, but we don't add them to flat_gids
-      // and dists.
-
-      for (auto i = 0; i < src_vertices_size; ++i) {
-        // size_t prev_size = flat_gids.size();
+      flat_gids.reserve(flat_gids.size() + flat_size);
+      dists.reserve(dists.size() + flat_size);
+      for (size_t i = 0; i < batch_size; ++i) {
         for (auto j = range.start_; j < range.limit_; ++j) {
           auto start = offsets[j][i];
           auto end = offsets[j][i + 1];
-          for (auto k = start; k < end; ++k) {
-            auto gid = gids[j][k];
-            flat_gids.emplace_back(gids[j][k]);
-            dists.emplace_back(j);
-            // }
-          }
+          flat_gids.insert(flat_gids.end(), gids[j].begin() + start,
+                           gids[j].begin() + end);
+          dists.resize(flat_gids.size(), j);
         }
         flat_offsets.emplace_back(flat_gids.size());
       }
     }
+    VLOG(10) << "visit array time: " << visit_array_time
+             << ", flat size: " << flat_gids.size();
 
     return std::make_tuple(std::move(flat_gids), std::move(dists),
                            std::move(flat_offsets));
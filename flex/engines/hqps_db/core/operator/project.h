@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef ENGINES_HQPS_ENGINE_OPERATOR_PROJECT_H_
 #define ENGINES_HQPS_ENGINE_OPERATOR_PROJECT_H_
 
+#include <numeric>
 #include <tuple>
 #include <unordered_map>
 #include <vector>
@@ -279,7 +280,7 @@ class ProjectOp {
         create_prop_descs_from_selectors<in_col_id...>(mapper.selectors_);
     auto prop_getters =
         create_prop_getters_from_prop_desc(graph, ctx, prop_desc);
-    LOG(INFO) << "In project with expression, successfully got prop getters";
+    VLOG(10) << "In project with expression, successfully got prop getters";
     for (auto iter : ctx) {
       auto ele_tuple = iter.GetAllElement();
       res_vec.emplace_back(evaluate_proj_expr(expr, ele_tuple, prop_getters));
@@ -289,6 +290,36 @@ class ProjectOp {
 
   ///////////////////Project implementation for all data structures.
 
+  // Properties of the vertices in node, indexed as node. Only the vertices
+  // still referenced by rows are fetched, since a select after the node was
+  // built may have dropped most of them.
+  template <typename T, typename NODE_T>
+  static std::vector<std::tuple<T>> get_referenced_props(
+      const GRAPH_INTERFACE& graph, const NODE_T& node,
+      const std::string& prop_name, const std::vector<size_t>& repeat_array) {
+    auto& vertices = node.GetVertices();
+    CHECK(repeat_array.size() == vertices.size());
+    std::vector<typename GRAPH_INTERFACE::vertex_id_t> referenced;
+    std::vector<size_t> inds;
+    for (size_t i = 0; i < repeat_array.size(); ++i) {
+      if (repeat_array[i] > 0) {
+        referenced.emplace_back(vertices[i]);
+        inds.emplace_back(i);
+      }
+    }
+    if (referenced.size() == vertices.size()) {
+      return graph.template GetVertexPropsFromVid<T>(node.GetLabel(), vertices,
+                                                     {prop_name});
+    }
+    auto props = graph.template GetVertexPropsFromVid<T>(
+        node.GetLabel(), referenced, {prop_name});
+    std::vector<std::tuple<T>> ret(vertices.size());
+    for (size_t i = 0; i < inds.size(); ++i) {
+      ret[inds[i]] = std::move(props[i]);
+    }
+    return ret;
+  }
+
   // single label vertex set.
   template <typename T, typename LabelT, typename VID_T, typename... SET_T>
   static auto apply_single_project_impl(
@@ -296,11 +327,13 @@ class ProjectOp {
       RowVertexSetImpl<LabelT, VID_T, SET_T...>& node,
       const std::string& prop_name, const std::vector<size_t>& repeat_array) {
     // Get property from storage.
-    auto prop_tuple_vec = graph.template GetVertexPropsFromVid<T>(
-        node.GetLabel(), node.GetVertices(), {prop_name});
+    auto prop_tuple_vec =
+        get_referenced_props<T>(graph, node, prop_name, repeat_array);
     // VLOG(10) << "Finish fetching properties";
-    node.fillBuiltinProps(prop_tuple_vec, {prop_name}, repeat_array);
+    node.fillBuiltinProps(prop_tuple_vec, {prop_name});
     std::vector<T> res_prop_vec;
+    res_prop_vec.reserve(
+        std::accumulate(repeat_array.begin(), repeat_array.end(), size_t(0)));
     for (auto i = 0; i < repeat_array.size(); ++i) {
       for (auto j = 0; j < repeat_array[i]; ++j) {
         res_prop_vec.push_back(std::get<0>(prop_tuple_vec[i]));
@@ -319,13 +352,15 @@ class ProjectOp {
       const GRAPH_INTERFACE& graph,
       KeyedRowVertexSetImpl<LabelT, KEY_T, VID_T, SET_T...>& node,
       const std::string& prop_name, const std::vector<size_t>& repeat_array) {
-    LOG(INFO) << "[Single project on KeyedRowVertexSet:]" << node.GetLabel();
+    VLOG(10) << "[Single project on KeyedRowVertexSet:]" << node.GetLabel();
     // Get property from storage.
-    auto prop_tuple_vec = graph.template GetVertexPropsFromVid<T>(
-        node.GetLabel(), node.GetVertices(), {prop_name});
+    auto prop_tuple_vec =
+        get_referenced_props<T>(graph, node, prop_name, repeat_array);
     // VLOG(10) << "Finish fetching properties";
-    node.fillBuiltinProps(prop_tuple_vec, {prop_name}, repeat_array);
+    node.fillBuiltinProps(prop_tuple_vec, {prop_name});
     std::vector<T> res_prop_vec;
+    res_prop_vec.reserve(
+        std::accumulate(repeat_array.begin(), repeat_array.end(), size_t(0)));
     for (auto i = 0; i < repeat_array.size(); ++i) {
       for (auto j = 0; j < repeat_array[i]; ++j) {
         res_prop_vec.push_back(std::get<0>(prop_tuple_vec[i]));
@@ -18,12 +18,42 @@ limitations under the License.
 
 #include <array>
 #include <string>
+#include <string_view>
+#include <type_traits>
 
 #include "flex/engines/hqps_db/structures/multi_vertex_set/row_vertex_set.h"
 #include "flex/engines/hqps_db/structures/multi_vertex_set/two_label_vertex_set.h"
+#include "flex/storages/rt_mutable_graph/vertex_index.h"
 
 namespace gs {
 
+// comparisons of a property with a value that index scans serve
+enum class IndexCmp { kEq, kLt, kLe, kGt, kGe };
+
+/// @brief The values v with v cmp value, e.g. for predicates like
+/// `prop > value`. String values are referred to, not copied.
+template <typename T>
+IndexRange make_scan_range(IndexCmp cmp, const T& value) {
+  Any any;
+  if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+    any.set_string(std::string_view(value));
+  } else {
+    any = AnyConverter<T>::to_any(value);
+  }
+  switch (cmp) {
+  case IndexCmp::kEq:
+    return IndexRange::Point(any);
+  case IndexCmp::kLt:
+    return IndexRange::Between(IndexBound(), IndexBound(any, false));
+  case IndexCmp::kLe:
+    return IndexRange::Between(IndexBound(), IndexBound(any, true));
+  case IndexCmp::kGt:
+    return IndexRange::Between(IndexBound(any, false), IndexBound());
+  default:
+    return IndexRange::Between(IndexBound(any, true), IndexBound());
+  }
+}
+
 // scan for a single vertex
 template <typename GRAPH_INTERFACE>
 class Scan {
@@ -46,6 +76,24 @@ class Scan {
                                                             v_label_id);
   }
 
+  /// @brief Scan vertex with expression, through the index of prop_name if
+  /// the property has one supporting range, see
+  /// MutableCSRInterface::ScanVerticesWithIndex. The filter has to imply
+  /// that prop_name is within range.
+  template <typename EXPR, typename... SELECTOR>
+  static vertex_set_t ScanVertexWithIndex(const GRAPH_INTERFACE& graph,
+                                          const label_id_t& v_label_id,
+                                          const std::string& prop_name,
+                                          const IndexRange& range,
+                                          Filter<EXPR, SELECTOR...>&& filter) {
+    auto expr = filter.expr_;
+    auto selectors = filter.selectors_;
+    auto gids = graph.ScanVerticesWithIndex(v_label_id, prop_name, range,
+                                            selectors, expr);
+    return MakeDefaultRowVertexSet<vertex_id_t, label_id_t>(std::move(gids),
+                                                            v_label_id);
+  }
+
   /// @brief Scan Vertex from two labels.
   /// @tparam FUNC
   /// @param graph
@@ -112,17 +160,7 @@ class Scan {
   static std::vector<vertex_id_t> scan_vertex_with_selector(
       const GRAPH_INTERFACE& graph, const label_id_t& v_label_id,
       const FUNC& func, const std::tuple<SELECTOR...>& selectors) {
-    std::vector<vertex_id_t> gids;
-    auto filter =
-        [&](vertex_id_t v,
-            const std::tuple<typename SELECTOR::prop_t...>& real_props) {
-          if (apply_on_tuple(func, real_props)) {
-            gids.push_back(v);
-          }
-        };
-
-    graph.template ScanVertices(v_label_id, selectors, filter);
-    return gids;
+    return graph.ScanVerticesBatched(v_label_id, selectors, func);
   }
 };
 
@@ -16,9 +16,18 @@ limitations under the License.
 #ifndef ENGINES_HQPS_ENGINE_OPERATOR_SHORTEST_PATH_H_
 #define ENGINES_HQPS_ENGINE_OPERATOR_SHORTEST_PATH_H_
 
+#include <algorithm>
 #include <array>
+#include <climits>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <set>
 #include <string>
+#include <tuple>
+#include <vector>
 
+#include "flex/engines/hqps_db/core/utils/flat_index_map.h"
 #include "flex/engines/hqps_db/structures/multi_vertex_set/row_vertex_set.h"
 #include "flex/engines/hqps_db/structures/path.h"
 
@@ -65,202 +74,406 @@ class ShortestPathOp {
     return std::make_pair(std::move(path_set), std::move(offsets));
   }
 
+  // The lightest paths by the sum of the weights of their edges, which are
+  // read from the edge data. Up to k simple paths are found, in order of
+  // weight. Only one-to-one and for only one label, as ShortestPath.
+  template <typename SET_T, typename WEIGHT_T, typename LabelT, typename EXPR,
+            typename EDGE_FILTER_T, typename UNTIL_CONDITION, typename... T,
+            typename std::enable_if<
+                (SET_T::is_vertex_set && sizeof...(T) == 0 &&
+                 IsTruePredicate<EDGE_FILTER_T>::value)>::type* = nullptr,
+            typename path_set_t = PathSet<vertex_id_t, LabelT>>
+  static std::pair<path_set_t, std::vector<size_t>> WeightedShortestPath(
+      const GRAPH_INTERFACE& graph, const SET_T& set,
+      const WeightedShortestPathOpt<WEIGHT_T, LabelT, EXPR, EDGE_FILTER_T,
+                                    UNTIL_CONDITION, T...>& weighted_opt) {
+    auto& opt = weighted_opt.path_opt_;
+    CHECK(set.Size() == 1);
+    auto src_label = set.GetLabel();
+    auto dst_vertices = find_vertices_satisfy_condition(
+        graph, opt.until_condition_.expr_, set.GetLabel(),
+        opt.until_condition_.selectors_);
+    CHECK(dst_vertices.size() == 1);
+    CHECK(opt.edge_expand_opt_.other_label_ == src_label);
+    CHECK(opt.get_v_opt_.v_labels_[0] == src_label);
+    vertex_id_t src_vid = set.GetVertices()[0];
+    vertex_id_t dst_vid = dst_vertices[0];
+    VLOG(10) << "[WeightedShortestPath]: src: " << src_vid
+             << ", dst:" << dst_vid << ", k: " << weighted_opt.k_;
+
+    auto path_set = PathSet<vertex_id_t, LabelT>({src_label});
+    auto paths = k_shortest_paths<WEIGHT_T>(
+        graph, src_label, opt.edge_expand_opt_.edge_label_,
+        opt.edge_expand_opt_.dir_, src_vid, dst_vid, weighted_opt.k_);
+    for (auto& path : paths) {
+      path_set.EmplacePath(path.vertices);
+    }
+    std::vector<offset_t> offsets{0, path_set.Size()};
+    return std::make_pair(std::move(path_set), std::move(offsets));
+  }
+
  private:
+  // A path with the weight of each of its prefixes, ordered by weight.
+  template <typename WEIGHT_T>
+  struct WeightedPath {
+    std::vector<vertex_id_t> vertices;
+    std::vector<WEIGHT_T> weights;
+
+    bool operator<(const WeightedPath& rhs) const {
+      return std::tie(weights.back(), vertices) <
+             std::tie(rhs.weights.back(), rhs.vertices);
+    }
+  };
+
+  // Weight of the lightest path found to each vertex and the vertex before
+  // it there, grown to the largest vid reached like DistArray.
+  template <typename WEIGHT_T>
+  class WeightArray {
+   public:
+    bool reached(vertex_id_t v) const {
+      return v < preds_.size() && preds_[v] != kNone;
+    }
+
+    WEIGHT_T weight(vertex_id_t v) const { return weights_[v]; }
+
+    vertex_id_t pred(vertex_id_t v) const { return preds_[v]; }
+
+    void set(vertex_id_t v, WEIGHT_T weight, vertex_id_t pred) {
+      if (v >= preds_.size()) {
+        size_t size = std::max<size_t>(v + 1, preds_.size() * 2);
+        preds_.resize(size, kNone);
+        weights_.resize(size);
+      }
+      weights_[v] = weight;
+      preds_[v] = pred;
+    }
+
+   private:
+    static constexpr vertex_id_t kNone =
+        std::numeric_limits<vertex_id_t>::max();
+
+    std::vector<WEIGHT_T> weights_;
+    std::vector<vertex_id_t> preds_;
+  };
+
+  // Dijkstra over a binary heap, skipping stale entries instead of
+  // decreasing keys. The path avoids the banned vertices, and the edges from
+  // src to the banned nexts. False if dst is not reachable so.
+  template <typename WEIGHT_T, typename LabelT>
+  static bool dijkstra(const GRAPH_INTERFACE& graph, LabelT v_label,
+                       LabelT edge_label, Direction direction,
+                       vertex_id_t src, vertex_id_t dst,
+                       const std::vector<vertex_id_t>& banned,
+                       const std::vector<vertex_id_t>& banned_nexts,
+                       WeightedPath<WEIGHT_T>& path) {
+    using entry_t = std::pair<WEIGHT_T, vertex_id_t>;
+    std::priority_queue<entry_t, std::vector<entry_t>, std::greater<entry_t>>
+        heap;
+    auto contains = [](const std::vector<vertex_id_t>& vec, vertex_id_t v) {
+      return std::find(vec.begin(), vec.end(), v) != vec.end();
+    };
+    WeightArray<WEIGHT_T> dist;
+    dist.set(src, WEIGHT_T(), src);
+    heap.emplace(WEIGHT_T(), src);
+    bool found = false;
+    while (!heap.empty()) {
+      WEIGHT_T weight = heap.top().first;
+      vertex_id_t v = heap.top().second;
+      heap.pop();
+      if (dist.weight(v) < weight) {
+        continue;
+      }
+      if (v == dst) {
+        found = true;
+        break;
+      }
+      graph.template ForEachEdge<WEIGHT_T>(
+          v_label, v, v_label, edge_label, direction,
+          [&](vertex_id_t u, const WEIGHT_T& edge_weight) {
+            CHECK(!(edge_weight < WEIGHT_T()))
+                << "Negative edge weight: " << edge_weight;
+            if (contains(banned, u) ||
+                (v == src && contains(banned_nexts, u))) {
+              return;
+            }
+            WEIGHT_T new_weight = weight + edge_weight;
+            if (!dist.reached(u) || new_weight < dist.weight(u)) {
+              dist.set(u, new_weight, v);
+              heap.emplace(new_weight, u);
+            }
+          });
+    }
+    if (!found) {
+      return false;
+    }
+    path.vertices.clear();
+    path.weights.clear();
+    for (vertex_id_t v = dst;; v = dist.pred(v)) {
+      path.vertices.push_back(v);
+      path.weights.push_back(dist.weight(v));
+      if (v == src) {
+        break;
+      }
+    }
+    std::reverse(path.vertices.begin(), path.vertices.end());
+    std::reverse(path.weights.begin(), path.weights.end());
+    return true;
+  }
+
+  // Yen's algorithm. Each next path leaves one found at some spur vertex,
+  // sharing the root before it, and avoiding the root and the edges taken at
+  // the spur by the paths found with the same root.
+  template <typename WEIGHT_T, typename LabelT>
+  static std::vector<WeightedPath<WEIGHT_T>> k_shortest_paths(
+      const GRAPH_INTERFACE& graph, LabelT v_label, LabelT edge_label,
+      Direction direction, vertex_id_t src, vertex_id_t dst, size_t k) {
+    std::vector<WeightedPath<WEIGHT_T>> found;
+    WeightedPath<WEIGHT_T> path;
+    if (k == 0) {
+      return found;
+    }
+    if (src == dst) {
+      path.vertices.push_back(src);
+      path.weights.push_back(WEIGHT_T());
+      found.emplace_back(std::move(path));
+      return found;
+    }
+    if (!dijkstra(graph, v_label, edge_label, direction, src, dst, {}, {},
+                  path)) {
+      return found;
+    }
+    found.emplace_back(std::move(path));
+
+    std::set<WeightedPath<WEIGHT_T>> candidates;
+    std::vector<vertex_id_t> banned, banned_nexts;
+    while (found.size() < k) {
+      const auto& prev = found.back();
+      for (size_t i = 0; i + 1 < prev.vertices.size(); ++i) {
+        banned.assign(prev.vertices.begin(), prev.vertices.begin() + i);
+        banned_nexts.clear();
+        for (auto& p : found) {
+          if (p.vertices.size() > i + 1 &&
+              std::equal(p.vertices.begin(), p.vertices.begin() + i + 1,
+                         prev.vertices.begin())) {
+            banned_nexts.push_back(p.vertices[i + 1]);
+          }
+        }
+        WeightedPath<WEIGHT_T> spur_path;
+        if (!dijkstra(graph, v_label, edge_label, direction, prev.vertices[i],
+                      dst, banned, banned_nexts, spur_path)) {
+          continue;
+        }
+        WeightedPath<WEIGHT_T> candidate;
+        candidate.vertices.assign(prev.vertices.begin(),
+                                  prev.vertices.begin() + i);
+        candidate.weights.assign(prev.weights.begin(),
+                                 prev.weights.begin() + i);
+        for (size_t j = 0; j < spur_path.vertices.size(); ++j) {
+          candidate.vertices.push_back(spur_path.vertices[j]);
+          candidate.weights.push_back(prev.weights[i] + spur_path.weights[j]);
+        }
+        candidates.insert(std::move(candidate));
+      }
+      if (candidates.empty()) {
+        break;
+      }
+      found.push_back(*candidates.begin());
+      candidates.erase(candidates.begin());
+    }
+    VLOG(10) << "Got " << found.size() << " weighted paths";
+    return found;
+  }
+
+  // Distance of each vertex from one end of the search, -1 for the vertices
+  // not reached yet. Vids are dense, so it's an array grown to the largest vid
+  // reached instead of a hash map.
+  class DistArray {
+   public:
+    int8_t get(vertex_id_t v) const {
+      return v < dist_.size() ? dist_[v] : -1;
+    }
+
+    void set(vertex_id_t v, int8_t dist) {
+      if (v >= dist_.size()) {
+        dist_.resize(std::max<size_t>(v + 1, dist_.size() * 2), -1);
+      }
+      dist_[v] = dist;
+    }
+
+   private:
+    std::vector<int8_t> dist_;
+  };
+
+  // The vertices on shortest paths, each with its neighbors one step closer
+  // to the end the distances are counted from.
+  struct PredGraph {
+    const std::vector<vertex_id_t>& of(vertex_id_t v) const {
+      return preds[ids.find(v)];
+    }
+
+    FlatIndexMap<vertex_id_t> ids;
+    std::vector<std::vector<vertex_id_t>> preds;
+  };
+
+  static Direction reverse_direction(Direction direction) {
+    if (direction == Direction::Out) {
+      return Direction::In;
+    } else if (direction == Direction::In) {
+      return Direction::Out;
+    }
+    return Direction::Both;
+  }
+
+  // Bidirectional bfs, expanding the smaller frontier a level at a time. The
+  // search from dst follows the edges backwards.
   template <typename LabelT>
   static PathSet<vertex_id_t, LabelT> shortest_path_impl(
       const GRAPH_INTERFACE& graph, vertex_id_t src_vid, vertex_id_t dst_vid,
       Direction direction, LabelT edge_label, LabelT vertex_label) {
-    std::unordered_map<vertex_id_t, int8_t> src_vid_dist;
-    std::unordered_map<vertex_id_t, int8_t> dst_vid_dist;
-    std::string direction_str = gs::to_string(direction);
+    auto path_set = PathSet<vertex_id_t, LabelT>({vertex_label});
+    if (src_vid == dst_vid) {
+      path_set.EmplacePath(std::vector<vertex_id_t>{src_vid});
+      return path_set;
+    }
+    std::string forward_str = gs::to_string(direction);
+    std::string backward_str = gs::to_string(reverse_direction(direction));
+    DistArray src_dist, dst_dist;
+    src_dist.set(src_vid, 0);
+    dst_dist.set(dst_vid, 0);
+    std::vector<vertex_id_t> src_frontier{src_vid}, dst_frontier{dst_vid};
+    std::vector<vertex_id_t> next_frontier;
+    std::vector<vertex_id_t> meet_vertices;
     int8_t src_dep = 0, dst_dep = 0;
-    std::queue<vertex_id_t> src_q, dst_q;
-    std::queue<vertex_id_t> tmp_q;
-    std::vector<vertex_id_t> meet_vertices;  // store the vertices meet.
-    src_vid_dist[src_vid] = 0;
-    dst_vid_dist[dst_vid] = 0;
-    src_q.push(src_vid);
-    dst_q.push(dst_vid);
-    while (true) {
-      if (!src_q.empty() && (src_q.size() <= dst_q.size())) {
-        // expand from src.
+    while (meet_vertices.empty() && !src_frontier.empty() &&
+           !dst_frontier.empty()) {
+      if (src_dep + dst_dep == std::numeric_limits<int8_t>::max()) {
+        LOG(WARNING) << "Shortest path is longer than "
+                     << static_cast<int>(src_dep + dst_dep);
+        break;
+      }
+      if (src_frontier.size() <= dst_frontier.size()) {
         ++src_dep;
-        VLOG(10) << "Expand From src, current depth: " << src_dep
-                 << " queue size: " << src_q.size();
-
-        expand_from_queue(graph, vertex_label, edge_label, direction_str,
-                          src_dep, src_q, tmp_q, src_vid_dist, dst_vid_dist,
-                          meet_vertices);
-        if (!meet_vertices.empty()) {
-          break;
-        }
-        std::swap(src_q, tmp_q);
+        expand_frontier(graph, vertex_label, edge_label, forward_str, src_dep,
+                        src_frontier, next_frontier, src_dist, dst_dist,
+                        meet_vertices);
+        std::swap(src_frontier, next_frontier);
       } else {
-        // expand from dst.
         ++dst_dep;
-        expand_from_queue(graph, vertex_label, edge_label, direction_str,
-                          dst_dep, dst_q, tmp_q, dst_vid_dist, src_vid_dist,
-                          meet_vertices);
-        if (!meet_vertices.empty()) {
-          break;
-        }
-        std::swap(dst_q, tmp_q);
-      }
-      if (src_q.empty() || dst_q.empty()) {
-        break;
+        expand_frontier(graph, vertex_label, edge_label, backward_str, dst_dep,
+                        dst_frontier, next_frontier, dst_dist, src_dist,
+                        meet_vertices);
+        std::swap(dst_frontier, next_frontier);
       }
     }
 
     if (meet_vertices.empty()) {
       VLOG(10) << "no meet vertices found";
-      return make_empty_path_set<vertex_id_t, LabelT>({vertex_label});
+      return path_set;
     }
 
-    // to find the path.
-    return find_paths(graph, vertex_label, edge_label, direction_str,
-                      meet_vertices, src_vid, dst_vid, src_vid_dist,
-                      dst_vid_dist);
+    // Every meet vertex is at src_dep from src and dst_dep from dst, so the
+    // paths are joined from the shortest paths of both halves.
+    PredGraph src_preds = collect_preds(graph, vertex_label, edge_label,
+                                        backward_str, src_dep, meet_vertices,
+                                        src_dist);
+    PredGraph dst_preds = collect_preds(graph, vertex_label, edge_label,
+                                        forward_str, dst_dep, meet_vertices,
+                                        dst_dist);
+    int total = src_dep + dst_dep;
+    std::vector<vertex_id_t> path(total + 1);
+    auto src_pos = [](int depth) { return depth; };
+    auto dst_pos = [total](int depth) { return total - depth; };
+    for (auto v : meet_vertices) {
+      walk_preds(src_preds, v, src_dep, src_pos, path, [&]() {
+        walk_preds(dst_preds, v, dst_dep, dst_pos, path, [&]() {
+          path_set.EmplacePath(path);
+        });
+      });
+    }
+    VLOG(10) << "Got path size: " << path_set.Size();
+    return path_set;
   }
 
   template <typename LabelT>
-  static void expand_from_queue(
-      const GRAPH_INTERFACE& graph, LabelT v_label, LabelT edge_label,
-      const std::string& direction, int8_t depth,
-      std::queue<vertex_id_t>& src_q, std::queue<vertex_id_t>& tmp_q,
-      std::unordered_map<vertex_id_t, int8_t>& cur_vid_dist,
-      std::unordered_map<vertex_id_t, int8_t>& other_vid_dist,
-      std::vector<vertex_id_t>& meeted_vertices) {
-    std::vector<vertex_id_t> ids_to_query;
-    ids_to_query.reserve(src_q.size());
-    while (!src_q.empty()) {
-      auto src_v = src_q.front();
-      src_q.pop();
-      ids_to_query.emplace_back(src_v);
-    }
+  static void expand_frontier(const GRAPH_INTERFACE& graph, LabelT v_label,
+                              LabelT edge_label, const std::string& direction,
+                              int8_t depth,
+                              const std::vector<vertex_id_t>& frontier,
+                              std::vector<vertex_id_t>& next_frontier,
+                              DistArray& cur_dist, const DistArray& other_dist,
+                              std::vector<vertex_id_t>& meet_vertices) {
+    next_frontier.clear();
     auto nbr_list_array = graph.GetOtherVertices(
-        v_label, v_label, edge_label, ids_to_query, direction, INT_MAX);
-    for (auto i = 0; i < nbr_list_array.size(); ++i) {
+        v_label, v_label, edge_label, frontier, direction, INT_MAX);
+    for (size_t i = 0; i < nbr_list_array.size(); ++i) {
       for (auto nbr : nbr_list_array.get(i)) {
         auto v = nbr.neighbor();
-        if (cur_vid_dist.find(v) == cur_vid_dist.end()) {
-          cur_vid_dist[v] = depth;
-          tmp_q.push(v);
-          if (other_vid_dist.find(v) != other_vid_dist.end()) {
-            meeted_vertices.push_back(v);
+        if (cur_dist.get(v) < 0) {
+          cur_dist.set(v, depth);
+          next_frontier.push_back(v);
+          if (other_dist.get(v) >= 0) {
+            meet_vertices.push_back(v);
           }
         }
       }
     }
-    VLOG(10) << "push " << tmp_q.size() << " ele to new queue"
-             << ", meeted vertices: " << meeted_vertices.size();
-  }
-
-  static void dfs(
-      vertex_id_t src_vid, vertex_id_t dst_vid,
-      std::vector<vertex_id_t>& cur_path,
-      std::unordered_map<vertex_id_t, int8_t> dist_from_src,
-      std::unordered_set<vertex_id_t> valid_vertex_set,
-      std::vector<std::vector<vertex_id_t>>& paths,
-      std::unordered_map<vertex_id_t,
-                         std::vector<typename GRAPH_INTERFACE::nbr_t>>&
-          vid_to_nbr_list) {
-    VLOG(10) << "cur: " << src_vid << ", cur_path: " << gs::to_string(cur_path);
-    cur_path.push_back(src_vid);
-
-    if (src_vid == dst_vid) {
-      VLOG(10) << "Reach dst : " << gs::to_string(cur_path);
-      paths.push_back(cur_path);
-      cur_path.pop_back();
-      return;
-    }
-    CHECK(vid_to_nbr_list.find(src_vid) != vid_to_nbr_list.end());
-    for (auto nbr : vid_to_nbr_list[src_vid]) {
-      CHECK(dist_from_src.count(src_vid) > 0);
-      auto v = nbr.neighbor();
-      if (valid_vertex_set.find(v) != valid_vertex_set.end()) {
-        CHECK(dist_from_src.count(v) > 0) << "check failed for : " << v;
-        if (dist_from_src[src_vid] + 1 == dist_from_src[v]) {
-          dfs(v, dst_vid, cur_path, dist_from_src, valid_vertex_set, paths,
-              vid_to_nbr_list);
-        }
-      }
-    }
-    cur_path.pop_back();
+    VLOG(10) << "Expand to depth " << static_cast<int>(depth) << ", "
+             << next_frontier.size() << " vertices in new frontier"
+             << ", meet vertices: " << meet_vertices.size();
   }
 
+  // From the meet vertices at depth, walk the neighbors one step closer a
+  // level at a time, keeping only the vertices on shortest paths.
   template <typename LabelT>
-  static PathSet<vertex_id_t, LabelT> find_paths(
-      const GRAPH_INTERFACE& graph, LabelT v_label, LabelT edge_label,
-      const std::string& direction, std::vector<vertex_id_t>& meet_vertices,
-      vertex_id_t src_vid, vertex_id_t dst_vid,
-      std::unordered_map<vertex_id_t, int8_t>& src_vid_dist,
-      std::unordered_map<vertex_id_t, int8_t>& dst_vid_dist) {
-    std::unordered_set<vertex_id_t> vertex_set;
-    std::unordered_map<vertex_id_t,
-                       std::vector<typename GRAPH_INTERFACE::nbr_t>>
-        vid_to_nbr_list;
-    std::queue<vertex_id_t> q;
+  static PredGraph collect_preds(const GRAPH_INTERFACE& graph, LabelT v_label,
+                                 LabelT edge_label,
+                                 const std::string& direction, int8_t depth,
+                                 const std::vector<vertex_id_t>& meet_vertices,
+                                 const DistArray& dist) {
+    PredGraph ret;
     for (auto v : meet_vertices) {
-      vertex_set.insert(v);
-      q.push(v);
+      ret.ids.insert(v);
+      ret.preds.emplace_back();
     }
-
-    std::vector<vertex_id_t> tmp_vec;
-    while (!q.empty()) {
-      tmp_vec.clear();
-      for (auto i = 0; i < q.size(); ++i) {
-        auto v = q.front();
-        q.pop();
-        tmp_vec.emplace_back(v);
-      }
-
-      auto nbr_list_array = graph.GetOtherVertices(v_label, v_label, edge_label,
-                                                   tmp_vec, direction, INT_MAX);
-      for (auto i = 0; i < nbr_list_array.size(); ++i) {
-        auto cur_v = tmp_vec[i];
+    std::vector<vertex_id_t> level(meet_vertices), next_level;
+    for (int8_t d = depth; d > 0; --d) {
+      next_level.clear();
+      auto nbr_list_array = graph.GetOtherVertices(
+          v_label, v_label, edge_label, level, direction, INT_MAX);
+      for (size_t i = 0; i < nbr_list_array.size(); ++i) {
+        size_t id = ret.ids.find(level[i]);
         for (auto nbr : nbr_list_array.get(i)) {
-          auto v = nbr.neighbor();
-          if (vertex_set.find(v) != vertex_set.end()) {
+          auto u = nbr.neighbor();
+          if (dist.get(u) != d - 1) {
             continue;
           }
-          if (src_vid_dist.find(v) != src_vid_dist.end() &&
-              src_vid_dist[v] + 1 == src_vid_dist[cur_v]) {
-            q.push(v);
-            vertex_set.insert(v);
+          ret.preds[id].push_back(u);
+          if (ret.ids.insert(u).second) {
+            ret.preds.emplace_back();
+            next_level.push_back(u);
           }
-          if (dst_vid_dist.find(v) != dst_vid_dist.end() &&
-              dst_vid_dist[v] + 1 == dst_vid_dist[cur_v]) {
-            q.push(v);
-            vertex_set.insert(v);
-            src_vid_dist[v] = src_vid_dist[cur_v] + 1;
-          }
-        }
-        if (vid_to_nbr_list.find(cur_v) == vid_to_nbr_list.end()) {
-          vid_to_nbr_list.insert({cur_v, nbr_list_array.get_vector(i)});
-          VLOG(10) << "cache nbr list for v: " << cur_v;
         }
       }
+      std::swap(level, next_level);
     }
+    return ret;
+  }
 
-    // dfs to find path.
-    std::vector<std::vector<vertex_id_t>> paths;
-    std::vector<vertex_id_t> cur_path;
-    dfs(src_vid, dst_vid, cur_path, src_vid_dist, vertex_set, paths,
-        vid_to_nbr_list);
-    VLOG(10) << "Got path size: " << paths.size();
-    for (auto path : paths) {
-      VLOG(10) << "path: " << gs::to_string(path);
+  // Write v and each chain of predecessors below it into path, at pos(depth),
+  // calling func whenever the end of the search is reached.
+  template <typename POS_FUNC, typename FUNC>
+  static void walk_preds(const PredGraph& preds, vertex_id_t v, int depth,
+                         const POS_FUNC& pos, std::vector<vertex_id_t>& path,
+                         const FUNC& func) {
+    path[pos(depth)] = v;
+    if (depth == 0) {
+      func();
+      return;
     }
-    auto path_set = PathSet<vertex_id_t, LabelT>({v_label});
-    for (auto path : paths) {
-      size_t s = path.size();
-      std::vector<int32_t> offset(s, 0);
-      Path<vertex_id_t> new_path(std::move(path), std::move(offset));
-      path_set.EmplacePath(std::move(new_path));
+    for (auto u : preds.of(v)) {
+      walk_preds(preds, u, depth - 1, pos, path, func);
     }
-    return path_set;
   }
-
   template <typename UNTIL_CONDITION, typename LabelT, typename T>
   static std::vector<vertex_id_t> find_vertices_satisfy_condition(
       const GRAPH_INTERFACE& graph, UNTIL_CONDITION& condition, LabelT v_label,
@@ -16,17 +16,21 @@ limitations under the License.
 #ifndef ENGINES_HQPS_ENGINE_OPERATOR_SORT_H_
 #define ENGINES_HQPS_ENGINE_OPERATOR_SORT_H_
 
+#include <algorithm>
 #include <queue>
 #include <string>
+#include <type_traits>
 
 #include "flex/engines/hqps_db/core/context.h"
 
 #include "flex/engines/hqps_db/core/params.h"
+#include "flex/engines/hqps_db/core/utils/external_sort.h"
 #include "flex/engines/hqps_db/core/utils/hqps_utils.h"
 #include "flex/engines/hqps_db/structures/multi_edge_set/flat_edge_set.h"
 #include "flex/engines/hqps_db/structures/multi_edge_set/general_edge_set.h"
 
 #include "flex/engines/hqps_db/core/utils/props.h"
+#include "flex/utils/query_memory.h"
 
 namespace gs {
 
@@ -60,7 +64,8 @@ struct TupleComparator {
     if constexpr (Is + 1 < num_pairs) {
       return compare_impl<Is + 1>(left, right);
     } else {
-      return true;
+      // equal keys, keep a strict weak ordering.
+      return false;
     }
   }
 
@@ -81,7 +86,8 @@ struct TupleComparator {
     if constexpr (Is + 1 < num_pairs) {
       return compare_impl<Is + 1>(left, right);
     } else {
-      return true;
+      // equal keys, keep a strict weak ordering.
+      return false;
     }
   }
 };  // namespace gs
@@ -153,7 +159,8 @@ struct GeneralComparator {
       if constexpr (Is + 1 < num_pairs) {
         return compare_impl<Is + 1>(ele_tuple, top_tuple, getters);
       } else {
-        return true;
+        // a row tied with the top doesn't beat it, the earlier one is kept.
+        return false;
       }
     } else {
       static constexpr int new_tag_id = tag_id - base_tag;
@@ -167,7 +174,8 @@ struct GeneralComparator {
       if constexpr (Is + 1 < num_pairs) {
         return compare_impl<Is + 1>(ele_tuple, top_tuple, getters);
       } else {
-        return true;
+        // a row tied with the top doesn't beat it, the earlier one is kept.
+        return false;
       }
     }
   }
@@ -195,7 +203,8 @@ struct GeneralComparator {
       if constexpr (Is + 1 < num_pairs) {
         return compare_impl<Is + 1>(ele_tuple, top_tuple, getters);
       } else {
-        return true;
+        // a row tied with the top doesn't beat it, the earlier one is kept.
+        return false;
       }
     } else {
       static constexpr int new_tag_id = tag_id - base_tag;
@@ -209,7 +218,8 @@ struct GeneralComparator {
       if constexpr (Is + 1 < num_pairs) {
         return compare_impl<Is + 1>(ele_tuple, top_tuple, getters);
       } else {
-        return true;
+        // a row tied with the top doesn't beat it, the earlier one is kept.
+        return false;
       }
     }
   }
@@ -240,6 +250,11 @@ struct ResultTOfContextOrderPair<
 template <typename GRAPH_INTERFACE>
 class SortOp {
  public:
+  // Upper bound of the buffer of an external sort, the rest of the budget
+  // of the query is left to the operators after it.
+  static constexpr size_t kMaxSortBufferSize = static_cast<size_t>(256) << 20;
+  static constexpr size_t kMinSortBufferSize = static_cast<size_t>(1) << 20;
+
   template <typename CTX_HEAD_T, int cur_alias, int base_tag,
             typename... CTX_PREV_T, typename... ORDER_PAIRS,
             typename index_ele_tuple_t =
@@ -253,7 +268,7 @@ class SortOp {
              << ", input size: " << ctx.GetHead().Size();
     std::apply(
         [](auto&... args) {
-          ((LOG(INFO) << "SortTopK: " << args.name << " "), ...);
+          ((VLOG(10) << "SortTopK: " << args.name << " "), ...);
         },
         tuples);
 
@@ -263,49 +278,72 @@ class SortOp {
     using sort_tuple_t = std::tuple<typename ORDER_PAIRS::prop_t..., size_t>;
 
     TupleComparator<ORDER_PAIRS...> tuple_sorter(tuples);
-    std::priority_queue<sort_tuple_t, std::vector<sort_tuple_t>,
-                        TupleComparator<ORDER_PAIRS...>>
-        pq(tuple_sorter);
-    sort_tuple_t empty_tuple;
-    sort_tuple_t& top_tuple = empty_tuple;
 
     size_t cnt = 0;
     auto sort_prop_getter_tuple = create_prop_getter_tuple(
         tuples, ctx, graph, std::make_index_sequence<sizeof...(ORDER_PAIRS)>());
-    LOG(INFO) << "Finish create prop getter tuple.";
     GeneralComparator<ctx_t::base_tag_id, ORDER_PAIRS...> comparator(tuples);
 
+    // (position in the order, position in ctx) of the rows kept
+    std::vector<std::pair<size_t, size_t>> inds;
+    QueryMemoryCharge charge("SortTopK");
+    size_t kept_size =
+        std::min(limit, ctx.GetHead().Size()) * sizeof(sort_tuple_t);
+    bool spilled = false;
     double t0 = -grape::GetCurrentTime();
-    for (auto iter : ctx) {
-      auto cur_tuple = iter.GetAllIndexElement();
-      if (pq.size() < limit) {
-        pq.emplace(
-            comparator.get_sort_tuple(cur_tuple, sort_prop_getter_tuple, cnt));
-        top_tuple = pq.top();
-      } else if (pq.size() == limit) {
-        // update prop getter with index_ele.
-        if (comparator(cur_tuple, top_tuple, sort_prop_getter_tuple)) {
+    if constexpr (std::is_trivially_copyable<sort_tuple_t>::value) {
+      if (kept_size > QueryMemory::Available()) {
+        // the keys of the rows kept don't fit, sort them on disk
+        size_t budget = std::clamp(QueryMemory::Available() / 2,
+                                   kMinSortBufferSize, kMaxSortBufferSize);
+        ExternalSorter<sort_tuple_t, TupleComparator<ORDER_PAIRS...>> sorter(
+            tuple_sorter, budget, limit);
+        charge.Grow(sorter.BufferSize());
+        for (auto iter : ctx) {
+          sorter.Add(comparator.get_sort_tuple(iter.GetAllIndexElement(),
+                                               sort_prop_getter_tuple, cnt));
+          cnt += 1;
+        }
+        VLOG(10) << "[SortTopK]: spilled " << sorter.RunNum() << " runs";
+        spilled = true;
+        sorter.Merge([&inds](const sort_tuple_t& tuple) {
+          inds.emplace_back(inds.size(), gs::get_from_tuple<-1>(tuple));
+        });
+      }
+    }
+    if (!spilled) {
+      charge.Grow(kept_size);
+      std::priority_queue<sort_tuple_t, std::vector<sort_tuple_t>,
+                          TupleComparator<ORDER_PAIRS...>>
+          pq(tuple_sorter);
+
+      // Once the heap holds limit rows, a row is compared against its top key
+      // by key, fetching the later keys only on ties, and all the keys are
+      // fetched only when it replaces the top.
+      for (auto iter : ctx) {
+        auto cur_tuple = iter.GetAllIndexElement();
+        if (pq.size() < limit) {
+          pq.emplace(comparator.get_sort_tuple(cur_tuple,
+                                               sort_prop_getter_tuple, cnt));
+        } else if (comparator(cur_tuple, pq.top(), sort_prop_getter_tuple)) {
           pq.pop();
           pq.emplace(comparator.get_sort_tuple(cur_tuple,
                                                sort_prop_getter_tuple, cnt));
-          top_tuple = pq.top();
         }
+        cnt += 1;
+      }
+
+      // pop out all ele in priority_queue, from the last in order to the
+      // first.
+      inds.resize(pq.size());
+      for (size_t i = inds.size(); i > 0; --i) {
+        inds[i - 1] = std::make_pair(i - 1, gs::get_from_tuple<-1>(pq.top()));
+        pq.pop();
       }
-      cnt += 1;
     }
 
     t0 += grape::GetCurrentTime();
-    LOG(INFO) << " sort tuple cost: " << t0;
-    // pop out all ele in priority_queue
     double t1 = -grape::GetCurrentTime();
-    std::vector<std::pair<size_t, size_t>> inds;
-    inds.reserve(pq.size());
-    cnt = 0;
-    while (!pq.empty()) {
-      inds.emplace_back(std::make_pair(cnt, gs::get_from_tuple<-1>(pq.top())));
-      pq.pop();
-      cnt += 1;
-    }
     sort(inds.begin(), inds.end(),
          [](const auto& a, const auto& b) { return a.second < b.second; });
     std::vector<index_ele_tuple_t> index_eles;
@@ -322,7 +360,6 @@ class SortOp {
       index_eles[pair.first] = (iter2.GetAllIndexElement());
       inds_ind += 1;
     }
-    std::reverse(index_eles.begin(), index_eles.end());
     t1 += grape::GetCurrentTime();
     VLOG(10) << "Finish extract top k result, sort tuple time: " << t0
              << ", prepare index ele: " << t1
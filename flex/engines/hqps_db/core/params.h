@@ -21,6 +21,7 @@
 // #include "grape/grape.h"
 #include "flex/engines/hqps_db/core/utils/hqps_type.h"
 #include "flex/storages/rt_mutable_graph/types.h"
+#include "flex/utils/property/types.h"
 
 #include "grape/types.h"
 namespace gs {
@@ -138,6 +139,8 @@ enum class AggFunc {
   TO_SET = 6,
   AVG = 7,
   FIRST = 8,
+  // estimated by a HyperLogLog sketch, when the query asks for approximation
+  APPROX_COUNT_DISTINCT = 9,
 };
 
 // Get the return type of this aggregation.
@@ -157,6 +160,11 @@ struct AggFuncReturnValue<AggFunc::COUNT_DISTINCT, T> {
   using return_t = size_t;
 };
 
+template <typename T>
+struct AggFuncReturnValue<AggFunc::APPROX_COUNT_DISTINCT, T> {
+  using return_t = size_t;
+};
+
 // for grouping values, for which key, and to which alias, applying which
 // agg_func.
 // col_ind: the index of property which we will use.
@@ -310,6 +318,31 @@ struct IsTruePredicate : std::false_type {};
 template <>
 struct IsTruePredicate<TruePredicate> : std::true_type {};
 
+/**
+ * @brief Predicate of the edges whose time, their single property of type T,
+ * is in [begin, end), see time_of, e.g. the edges created in the last days.
+ * Expansions with it binary search the lists of time-ordered edge types,
+ * see Schema::is_time_ordered, instead of testing every edge.
+ */
+template <typename T>
+struct EdgeTimeRange {
+  EdgeTimeRange(int64_t begin, int64_t end) : begin_(begin), end_(end) {}
+
+  bool operator()(const T& value) const {
+    int64_t t = time_of(value);
+    return t >= begin_ && t < end_;
+  }
+
+  int64_t begin_;
+  int64_t end_;
+};
+
+template <typename T>
+struct IsEdgeTimeRange : std::false_type {};
+
+template <typename T>
+struct IsEdgeTimeRange<EdgeTimeRange<T>> : std::true_type {};
+
 struct FalsePredicate {
   template <typename T>
   bool operator()(T& t) {
@@ -466,6 +499,17 @@ auto make_edge_expandv_opt(Direction dir, LabelT edge_label,
                                  std::move(func));
 }
 
+// Sampling of an edge expand, which keeps at most fanout_ neighbors of each
+// source vertex, drawn uniformly by reservoir sampling seeded by seed_.
+struct SampleOpt {
+  size_t fanout_;
+  uint64_t seed_;
+};
+
+inline SampleOpt make_sample_opt(size_t fanout, uint64_t seed = 0) {
+  return SampleOpt{fanout, seed};
+}
+
 template <typename LabelT>
 inline auto make_edge_expandv_opt(Direction dir, LabelT edge_label,
                                   LabelT other_label) {
@@ -617,6 +661,39 @@ auto make_shortest_path_opt(
       std::move(until_condition), path_opt, result_opt);
 }
 
+// opt for shortest paths by the sum of edge weights, which are the data of
+// the edges, of type WEIGHT_T. Up to k paths are found, in order of weight.
+template <typename WEIGHT_T, typename LabelT, typename EXPR,
+          typename EDGE_FILTER_T, typename UNTIL_CONDITION, typename... T>
+struct WeightedShortestPathOpt {
+  using weight_t = WEIGHT_T;
+
+  WeightedShortestPathOpt(
+      ShortestPathOpt<LabelT, EXPR, EDGE_FILTER_T, UNTIL_CONDITION, T...>&&
+          path_opt,
+      size_t k)
+      : path_opt_(std::move(path_opt)), k_(k) {}
+
+  ShortestPathOpt<LabelT, EXPR, EDGE_FILTER_T, UNTIL_CONDITION, T...>
+      path_opt_;
+  size_t k_;
+};
+
+template <typename WEIGHT_T, typename LabelT, typename EXPR,
+          typename EDGE_FILTER_T, typename UNTIL_CONDITION,
+          typename... SELECTOR, typename... T>
+auto make_weighted_shortest_path_opt(
+    EdgeExpandOpt<LabelT, EDGE_FILTER_T>&& edge_expand_opt,
+    SimpleGetVOpt<LabelT, EXPR, T...>&& get_v_opt,
+    Filter<UNTIL_CONDITION, SELECTOR...>&& until_condition, size_t k = 1) {
+  return WeightedShortestPathOpt<WEIGHT_T, LabelT, EXPR, EDGE_FILTER_T,
+                                 Filter<UNTIL_CONDITION, SELECTOR...>, T...>(
+      make_shortest_path_opt(std::move(edge_expand_opt), std::move(get_v_opt),
+                             Range(0, INT_MAX), std::move(until_condition),
+                             PathOpt::Simple, ResultOpt::AllV),
+      k);
+}
+
 // Just filter with v_labels.
 template <typename LabelT, size_t num_labels>
 auto make_getv_opt(VOpt v_opt, std::array<LabelT, num_labels>&& v_labels) {
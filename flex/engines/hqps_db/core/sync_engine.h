@@ -20,6 +20,8 @@
 #include "flex/engines/hqps_db/core/context.h"
 #include "flex/engines/hqps_db/core/params.h"
 #include "flex/engines/hqps_db/core/utils/hqps_utils.h"
+#include "flex/engines/hqps_db/core/utils/morsel.h"
+#include "flex/engines/hqps_db/core/utils/profile.h"
 #include "flex/engines/hqps_db/structures/multi_vertex_set/general_vertex_set.h"
 #include "flex/engines/hqps_db/structures/multi_vertex_set/multi_label_vertex_set.h"
 #include "flex/engines/hqps_db/structures/multi_vertex_set/row_vertex_set.h"
@@ -90,6 +92,36 @@ class SyncEngine : public BaseEngine {
     return Context<COL_T, -1, 0, grape::EmptyType>(std::move(v_set_tuple));
   }
 
+  /// @brief Scan vertices of a label with a filter implying that prop_name is
+  /// within range, through the index of the property if there is one.
+  template <AppendOpt append_opt, typename EXPR, typename... SELECTOR,
+            typename std::enable_if<(append_opt == AppendOpt::Persist)>::type* =
+                nullptr,
+            typename COL_T = default_vertex_set_t>
+  static Context<COL_T, 0, 0, grape::EmptyType> ScanVertexWithIndex(
+      const GRAPH_INTERFACE& graph, const label_id_t& v_label,
+      const std::string& prop_name, const IndexRange& range,
+      Filter<EXPR, SELECTOR...>&& filter) {
+    auto v_set_tuple = Scan<GRAPH_INTERFACE>::template ScanVertexWithIndex(
+        graph, v_label, prop_name, range, std::move(filter));
+
+    return Context<COL_T, 0, 0, grape::EmptyType>(std::move(v_set_tuple));
+  }
+
+  template <
+      AppendOpt append_opt, typename EXPR, typename... SELECTOR,
+      typename std::enable_if<(append_opt == AppendOpt::Temp)>::type* = nullptr,
+      typename COL_T = default_vertex_set_t>
+  static Context<COL_T, -1, 0, grape::EmptyType> ScanVertexWithIndex(
+      const GRAPH_INTERFACE& graph, const label_id_t& v_label,
+      const std::string& prop_name, const IndexRange& range,
+      Filter<EXPR, SELECTOR...>&& filter) {
+    auto v_set_tuple = Scan<GRAPH_INTERFACE>::template ScanVertexWithIndex(
+        graph, v_label, prop_name, range, std::move(filter));
+
+    return Context<COL_T, -1, 0, grape::EmptyType>(std::move(v_set_tuple));
+  }
+
   /// @brief Scan vertices with multiple labels
   /// @tparam FUNC
   /// @tparam COL_T
@@ -192,6 +224,51 @@ class SyncEngine : public BaseEngine {
         std::move(pair.first), std::move(pair.second), input_col_id);
   }
 
+  /// @brief Edge expand to at most sample_opt.fanout_ sampled neighbors of
+  /// each vertex. Generated when the query asks for approximate results.
+  template <AppendOpt append_opt, int input_col_id, typename CTX_HEAD_T,
+            int cur_alias, int base_tag, typename... CTX_PREV,
+            typename EDGE_FILTER_T, typename... SELECTOR>
+  static auto SampleEdgeExpandV(
+      const GRAPH_INTERFACE& graph,
+      Context<CTX_HEAD_T, cur_alias, base_tag, CTX_PREV...>&& ctx,
+      EdgeExpandOpt<label_id_t, EDGE_FILTER_T, SELECTOR...>&& edge_expand_opt,
+      SampleOpt&& sample_opt) {
+    auto& select_node = gs::Get<input_col_id>(ctx);
+
+    auto pair = EdgeExpand<GRAPH_INTERFACE>::SampleEdgeExpandV(
+        graph, select_node, edge_expand_opt.dir_, edge_expand_opt.edge_label_,
+        edge_expand_opt.other_label_, std::move(edge_expand_opt.edge_filter_),
+        sample_opt);
+    return ctx.template AddNode<append_opt>(
+        std::move(pair.first), std::move(pair.second), input_col_id);
+  }
+
+  /// @brief Edge expand to vertices, and filter them by the expression of the
+  /// GetV that follows, as one operator, whose result is that of the GetV.
+  /// Generated when a GetV with a predicate on the expanded vertices is fused
+  /// into the edge expand before it.
+  template <AppendOpt append_opt, int input_col_id, typename CTX_HEAD_T,
+            int cur_alias, int base_tag, typename... CTX_PREV,
+            typename EDGE_FILTER_T, typename... SELECTOR, typename LabelT,
+            size_t num_labels, typename EXPRESSION, typename... V_SELECTOR>
+  static auto EdgeExpandVFilter(
+      const GRAPH_INTERFACE& graph,
+      Context<CTX_HEAD_T, cur_alias, base_tag, CTX_PREV...>&& ctx,
+      EdgeExpandOpt<label_id_t, EDGE_FILTER_T, SELECTOR...>&& edge_expand_opt,
+      GetVOpt<LabelT, num_labels, Filter<EXPRESSION, V_SELECTOR...>>&&
+          get_v_opt,
+      size_t limit = INT_MAX) {
+    auto& select_node = gs::Get<input_col_id>(ctx);
+
+    auto pair = EdgeExpand<GRAPH_INTERFACE>::EdgeExpandVFilter(
+        graph, select_node, edge_expand_opt.dir_, edge_expand_opt.edge_label_,
+        edge_expand_opt.other_label_, std::move(edge_expand_opt.edge_filter_),
+        std::move(get_v_opt), limit);
+    return ctx.template AddNode<append_opt>(
+        std::move(pair.first), std::move(pair.second), input_col_id);
+  }
+
   /// @brief //////// Edge Expand to vertex, the output is vertices with out any
   /// property!
   /// @tparam EDATA_T
@@ -558,10 +635,18 @@ class SyncEngine : public BaseEngine {
     size_t cur = 0;
     auto& vertices = head.GetMutableVertices();
     auto& prop_getter = prop_getters[0];
+    // The predicate is evaluated by morsels, and the survivors are compacted
+    // in order afterwards.
+    std::vector<uint8_t> selected(vertices.size());
+    parallel_for_morsels(vertices.size(), [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        selected[i] = std::apply(expr, prop_getter.get_view(vertices[i]));
+      }
+    });
     if constexpr (CTX_T::prev_alias_num == 0) {
       for (auto i = 0; i < vertices.size(); ++i) {
         auto vid = vertices[i];
-        if (std::apply(expr, prop_getter.get_view(vid))) {
+        if (selected[i]) {
           if (cur < i) {
             vertices[cur++] = vid;
           } else {
@@ -577,7 +662,7 @@ class SyncEngine : public BaseEngine {
         auto limit = last_offset[i + 1];
         for (auto j = cur_begin; j < limit; ++j) {
           auto vid = vertices[j];
-          if (std::apply(expr, prop_getter.get_view(vid))) {
+          if (selected[j]) {
             if (cur < j) {
               vertices[cur++] = vid;
             } else {
@@ -719,6 +804,29 @@ class SyncEngine : public BaseEngine {
     return ctx.template AddNode<opt>(std::move(path_set_and_offset.first),
                                      std::move(path_set_and_offset.second));
   }
+
+  // Return up to k paths, by the sum of their edge weights.
+  template <AppendOpt opt, int alias_to_use, typename EXPR, typename CTX_HEAD_T,
+            int cur_alias, int base_tag, typename... CTX_PREV,
+            typename WEIGHT_T, typename LabelT, typename EDGE_FILTER_T,
+            typename UNTIL_CONDITION, typename... T,
+            typename RES_SET_T = PathSet<vertex_id_t, LabelT>,
+            typename RES_T =
+                typename ResultContextT<opt, RES_SET_T, cur_alias, CTX_HEAD_T,
+                                        base_tag, CTX_PREV...>::result_t>
+  static RES_T WeightedShortestPath(
+      const GRAPH_INTERFACE& graph,
+      Context<CTX_HEAD_T, cur_alias, base_tag, CTX_PREV...>&& ctx,
+      WeightedShortestPathOpt<WEIGHT_T, LabelT, EXPR, EDGE_FILTER_T,
+                              UNTIL_CONDITION, T...>&& weighted_opt) {
+    static_assert(alias_to_use == -1 || alias_to_use == cur_alias);
+    auto& set = ctx.template GetNode<alias_to_use>();
+    auto path_set_and_offset =
+        ShortestPathOp<GRAPH_INTERFACE>::WeightedShortestPath(
+            graph, set, std::move(weighted_opt));
+    return ctx.template AddNode<opt>(std::move(path_set_and_offset.first),
+                                     std::move(path_set_and_offset.second));
+  }
 };
 }  // namespace gs
 
@@ -0,0 +1,75 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef ENGINES_HQPS_ENGINE_UTILS_DEDUP_H_
+#define ENGINES_HQPS_ENGINE_UTILS_DEDUP_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace gs {
+
+// Keys spanning at most this many bitmap words per key are deduped with a
+// bitmap, others by sorting.
+static constexpr size_t kDenseDedupWordsPerKey = 2;
+
+/// @brief Mark the first occurrence of each key, in input order.
+///
+/// Vids only span the vertices of a label, so keys dense enough in
+/// [0, max key] are deduped with a bitmap. The bitmap is kept by the thread
+/// for later calls, and only the words touched are cleared afterwards, so no
+/// memory is allocated per key. Sparse keys are sorted instead.
+template <typename KEY_T>
+std::vector<uint8_t> mark_first_occurrences(const std::vector<KEY_T>& keys) {
+  std::vector<uint8_t> firsts(keys.size(), 0);
+  if (keys.empty()) {
+    return firsts;
+  }
+  uint64_t max_key = *std::max_element(keys.begin(), keys.end());
+  size_t word_num = max_key / 64 + 1;
+  if (word_num <= keys.size() * kDenseDedupWordsPerKey) {
+    thread_local std::vector<uint64_t> words;
+    if (words.size() < word_num) {
+      words.resize(word_num, 0);
+    }
+    for (size_t i = 0; i < keys.size(); ++i) {
+      uint64_t key = keys[i];
+      uint64_t mask = static_cast<uint64_t>(1) << (key % 64);
+      firsts[i] = (words[key / 64] & mask) == 0;
+      words[key / 64] |= mask;
+    }
+    for (auto key : keys) {
+      words[static_cast<uint64_t>(key) / 64] = 0;
+    }
+  } else {
+    std::vector<std::pair<KEY_T, size_t>> sorted;
+    sorted.reserve(keys.size());
+    for (size_t i = 0; i < keys.size(); ++i) {
+      sorted.emplace_back(keys[i], i);
+    }
+    std::sort(sorted.begin(), sorted.end());
+    for (size_t i = 0; i < sorted.size(); ++i) {
+      if (i == 0 || sorted[i].first != sorted[i - 1].first) {
+        firsts[sorted[i].second] = 1;
+      }
+    }
+  }
+  return firsts;
+}
+
+}  // namespace gs
+
+#endif  // ENGINES_HQPS_ENGINE_UTILS_DEDUP_H_
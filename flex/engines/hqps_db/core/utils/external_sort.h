@@ -0,0 +1,203 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef ENGINES_HQPS_ENGINE_UTILS_EXTERNAL_SORT_H_
+#define ENGINES_HQPS_ENGINE_UTILS_EXTERNAL_SORT_H_
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <queue>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "flex/utils/query_memory.h"
+
+namespace gs {
+
+/// @brief Sorts more values than the memory of a query affords, keeping the
+/// first limit of them in order.
+///
+/// Values are buffered up to a budget of bytes, then the buffer is sorted and
+/// its first limit values are written to a run file in the spill directory of
+/// QueryMemory. Merge reads the runs back a block at a time, and merges them
+/// with a heap. Runs are unlinked once created, so they are gone with the
+/// sorter, or with the process if it dies. Equal values come out in the order
+/// they are added.
+///
+/// Values are written as their bytes, so they must be trivially copyable, and
+/// the memory they point to, e.g. string views of properties, must outlive
+/// the sorter.
+template <typename T, typename CMP_T>
+class ExternalSorter {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "values are spilled as their bytes");
+
+ public:
+  static constexpr size_t kReadBlockSize = static_cast<size_t>(1) << 16;
+
+  ExternalSorter(const CMP_T& cmp, size_t budget, size_t limit)
+      : cmp_(cmp),
+        buffer_cap_(std::max<size_t>(budget / sizeof(T), 1024)),
+        limit_(limit) {
+    buffer_.reserve(buffer_cap_);
+  }
+
+  ~ExternalSorter() {
+    for (auto& run : runs_) {
+      fclose(run.file);
+    }
+  }
+
+  ExternalSorter(const ExternalSorter&) = delete;
+  ExternalSorter& operator=(const ExternalSorter&) = delete;
+
+  /// @brief Bytes of the buffer, to charge to the query.
+  size_t BufferSize() const { return buffer_cap_ * sizeof(T); }
+
+  size_t RunNum() const { return runs_.size(); }
+
+  void Add(const T& value) {
+    buffer_.push_back(value);
+    if (buffer_.size() == buffer_cap_) {
+      spill();
+    }
+  }
+
+  /// @brief Call func on the first limit values, in order. The sorter is
+  /// drained after it.
+  template <typename FUNC_T>
+  void Merge(const FUNC_T& func) {
+    if (runs_.empty()) {
+      sortBuffer();
+      for (auto& value : buffer_) {
+        func(value);
+      }
+      buffer_.clear();
+      return;
+    }
+    if (!buffer_.empty()) {
+      spill();
+    }
+    std::vector<T>().swap(buffer_);
+
+    size_t block_num = std::max<size_t>(kReadBlockSize / sizeof(T), 1);
+    for (auto& run : runs_) {
+      rewind(run.file);
+      run.block.reserve(block_num);
+      fill(run, block_num);
+    }
+    // the run of a lower index holds values added earlier, and wins ties
+    auto greater = [this](size_t lhs, size_t rhs) {
+      const T& l = runs_[lhs].block[runs_[lhs].pos];
+      const T& r = runs_[rhs].block[runs_[rhs].pos];
+      if (cmp_(r, l)) {
+        return true;
+      }
+      return !cmp_(l, r) && lhs > rhs;
+    };
+    std::priority_queue<size_t, std::vector<size_t>, decltype(greater)> heap(
+        greater);
+    for (size_t i = 0; i < runs_.size(); ++i) {
+      if (!runs_[i].block.empty()) {
+        heap.push(i);
+      }
+    }
+    size_t emitted = 0;
+    while (!heap.empty() && emitted < limit_) {
+      size_t i = heap.top();
+      heap.pop();
+      auto& run = runs_[i];
+      func(run.block[run.pos]);
+      ++emitted;
+      if (++run.pos == run.block.size()) {
+        fill(run, block_num);
+      }
+      if (run.pos < run.block.size()) {
+        heap.push(i);
+      }
+    }
+  }
+
+ private:
+  struct Run {
+    FILE* file;
+    size_t remaining;
+    std::vector<T> block;
+    size_t pos;
+  };
+
+  void sortBuffer() {
+    std::stable_sort(buffer_.begin(), buffer_.end(), cmp_);
+    if (buffer_.size() > limit_) {
+      buffer_.resize(limit_);
+    }
+  }
+
+  void spill() {
+    sortBuffer();
+    std::string dir = QueryMemory::SpillDir();
+    if (dir.empty()) {
+      const char* tmp = getenv("TMPDIR");
+      dir = tmp == nullptr ? "/tmp" : tmp;
+    }
+    std::string path = dir + "/hqps_sort_XXXXXX";
+    int fd = mkstemp(&path[0]);
+    if (fd < 0) {
+      throw std::runtime_error("Failed to create a sort run in " + dir +
+                               ": " + strerror(errno));
+    }
+    unlink(path.c_str());
+    FILE* file = fdopen(fd, "w+b");
+    if (file == nullptr) {
+      close(fd);
+      throw std::runtime_error(std::string("Failed to open a sort run: ") +
+                               strerror(errno));
+    }
+    runs_.push_back(Run{file, buffer_.size(), {}, 0});
+    if (fwrite(buffer_.data(), sizeof(T), buffer_.size(), file) !=
+        buffer_.size()) {
+      throw std::runtime_error(std::string("Failed to write a sort run: ") +
+                               strerror(errno));
+    }
+    buffer_.clear();
+  }
+
+  void fill(Run& run, size_t block_num) {
+    size_t num = std::min(block_num, run.remaining);
+    run.block.resize(num);
+    run.pos = 0;
+    if (num > 0 && fread(run.block.data(), sizeof(T), num, run.file) != num) {
+      throw std::runtime_error("Failed to read a sort run");
+    }
+    run.remaining -= num;
+  }
+
+  CMP_T cmp_;
+  size_t buffer_cap_;
+  size_t limit_;
+  std::vector<T> buffer_;
+  std::vector<Run> runs_;
+};
+
+}  // namespace gs
+
+#endif  // ENGINES_HQPS_ENGINE_UTILS_EXTERNAL_SORT_H_
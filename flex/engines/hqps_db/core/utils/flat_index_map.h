@@ -0,0 +1,131 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef ENGINES_HQPS_ENGINE_UTILS_FLAT_INDEX_MAP_H_
+#define ENGINES_HQPS_ENGINE_UTILS_FLAT_INDEX_MAP_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include <boost/functional/hash.hpp>
+
+namespace gs {
+
+/// @brief Maps keys to dense indices, assigned in the order the keys are first
+/// inserted, as the group ids of a group by. Keys are kept inline in a flat
+/// slot array probed linearly, so no node is allocated per key.
+template <typename KEY_T, typename HASH_T = boost::hash<KEY_T>>
+class FlatIndexMap {
+ public:
+  // Keys to expect at most when sizing from the input cardinality, so that a
+  // large input with few distinct keys doesn't allocate a huge table.
+  static constexpr size_t kMaxReserve = 1 << 16;
+
+  FlatIndexMap() : size_(0), shift_(64) {}
+
+  /// @brief Size the table for expected keys, capped by kMaxReserve.
+  void reserve(size_t expected) {
+    expected = std::min(expected, kMaxReserve);
+    if (expected * 2 > slots_.size()) {
+      rehash(expected * 2);
+    }
+  }
+
+  size_t size() const { return size_; }
+
+  /// @brief Find the index of key, or assign size() to it when it's new.
+  /// @return The index, and whether the key is inserted.
+  std::pair<size_t, bool> insert(const KEY_T& key) {
+    if ((size_ + 1) * 2 > slots_.size()) {
+      rehash((size_ + 1) * 2);
+    }
+    size_t mask = slots_.size() - 1;
+    for (size_t pos = slot_of(key);; pos = (pos + 1) & mask) {
+      auto& slot = slots_[pos];
+      if (slot.ind == kEmpty) {
+        slot.key = key;
+        slot.ind = size_++;
+        return std::make_pair(slot.ind, true);
+      }
+      if (slot.key == key) {
+        return std::make_pair(slot.ind, false);
+      }
+    }
+  }
+
+  /// @brief Index of key, or size_t max when it's absent.
+  size_t find(const KEY_T& key) const {
+    if (slots_.empty()) {
+      return kEmpty;
+    }
+    size_t mask = slots_.size() - 1;
+    for (size_t pos = slot_of(key);; pos = (pos + 1) & mask) {
+      auto& slot = slots_[pos];
+      if (slot.ind == kEmpty || slot.key == key) {
+        return slot.ind;
+      }
+    }
+  }
+
+ private:
+  static constexpr size_t kEmpty = std::numeric_limits<size_t>::max();
+  static constexpr size_t kMinSlots = 16;
+
+  struct Slot {
+    Slot() : ind(kEmpty) {}
+    KEY_T key;
+    size_t ind;
+  };
+
+  // Fibonacci hashing on the top bits, since std::hash and boost::hash of
+  // integers are identities, which cluster under a power of 2 mask.
+  size_t slot_of(const KEY_T& key) const {
+    uint64_t hash = static_cast<uint64_t>(HASH_T()(key));
+    return static_cast<size_t>((hash * 0x9E3779B97F4A7C15ull) >> shift_);
+  }
+
+  void rehash(size_t min_slots) {
+    size_t slot_num = kMinSlots;
+    int shift = 60;
+    while (slot_num < min_slots) {
+      slot_num <<= 1;
+      --shift;
+    }
+    std::vector<Slot> old_slots(slot_num);
+    old_slots.swap(slots_);
+    shift_ = shift;
+    size_t mask = slot_num - 1;
+    for (auto& old : old_slots) {
+      if (old.ind == kEmpty) {
+        continue;
+      }
+      size_t pos = slot_of(old.key);
+      while (slots_[pos].ind != kEmpty) {
+        pos = (pos + 1) & mask;
+      }
+      slots_[pos] = std::move(old);
+    }
+  }
+
+  std::vector<Slot> slots_;
+  size_t size_;
+  int shift_;
+};
+
+}  // namespace gs
+
+#endif  // ENGINES_HQPS_ENGINE_UTILS_FLAT_INDEX_MAP_H_
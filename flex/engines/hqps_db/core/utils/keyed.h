@@ -145,6 +145,22 @@ struct KeyedAggT<GI, RowVertexSet<LabelT, VID_T, T...>, AggFunc::COUNT_DISTINCT,
   }
 };
 
+// estimated count_dist
+template <typename GI, typename LabelT, typename VID_T, typename... T,
+          int tag_id>
+struct KeyedAggT<GI, RowVertexSet<LabelT, VID_T, T...>,
+                 AggFunc::APPROX_COUNT_DISTINCT, std::tuple<grape::EmptyType>,
+                 std::integer_sequence<int32_t, tag_id>> {
+  using agg_res_t = Collection<size_t>;
+  using aggregate_res_builder_t = ApproxDistinctCountBuilder<1, tag_id, VID_T>;
+
+  static aggregate_res_builder_t create_agg_builder(
+      const RowVertexSet<LabelT, VID_T, T...>& set, const GI& graph,
+      std::tuple<PropertySelector<grape::EmptyType>>& selectors) {
+    return aggregate_res_builder_t();
+  }
+};
+
 template <typename GI, typename VID_T, typename LabelT, typename... T,
           typename PropT, int tag_id>
 struct KeyedAggT<GI, TwoLabelVertexSet<VID_T, LabelT, T...>, AggFunc::COUNT,
@@ -177,6 +193,22 @@ struct KeyedAggT<GI, TwoLabelVertexSet<VID_T, LabelT, T...>,
   }
 };
 
+// estimated count_dist for two_label set.
+template <typename GI, typename VID_T, typename LabelT, typename... T,
+          int tag_id>
+struct KeyedAggT<GI, TwoLabelVertexSet<VID_T, LabelT, T...>,
+                 AggFunc::APPROX_COUNT_DISTINCT, std::tuple<grape::EmptyType>,
+                 std::integer_sequence<int32_t, tag_id>> {
+  using agg_res_t = Collection<size_t>;
+  using aggregate_res_builder_t = ApproxDistinctCountBuilder<2, tag_id, VID_T>;
+
+  static aggregate_res_builder_t create_agg_builder(
+      const TwoLabelVertexSet<VID_T, LabelT, T...>& set, const GI& graph,
+      std::tuple<PropertySelector<grape::EmptyType>>& selectors) {
+    return aggregate_res_builder_t();
+  }
+};
+
 // general vertex set to_count
 template <typename GI, typename VID_T, typename LabelT, size_t N,
           typename PropT, int tag_id>
@@ -260,6 +292,46 @@ struct KeyedAggT<GI, RowVertexSet<LabelT, VID_T, T...>, AggFunc::TO_LIST,
   }
 };
 
+// sum, min or max of a property of a vertex set, aggregated inline.
+template <typename GI, typename LabelT, typename VID_T, AggFunc agg_func,
+          typename PropT, int tag_id, typename... T>
+struct VertexPropAggT {
+  static_assert(!std::is_same_v<PropT, grape::EmptyType>,
+                "Aggregate a property of the vertex set");
+  using agg_res_t = Collection<PropT>;
+  using aggregate_res_builder_t =
+      VertexPropAggBuilder<agg_func, PropT, GI,
+                           RowVertexSet<LabelT, VID_T, T...>, tag_id>;
+
+  static aggregate_res_builder_t create_agg_builder(
+      const RowVertexSet<LabelT, VID_T, T...>& set, const GI& graph,
+      std::tuple<PropertySelector<PropT>>& selectors) {
+    return aggregate_res_builder_t(
+        set, graph, std::array{std::get<0>(selectors).prop_name_});
+  }
+};
+
+template <typename GI, typename LabelT, typename VID_T, typename... T,
+          typename PropT, int tag_id>
+struct KeyedAggT<GI, RowVertexSet<LabelT, VID_T, T...>, AggFunc::SUM,
+                 std::tuple<PropT>, std::integer_sequence<int32_t, tag_id>>
+    : VertexPropAggT<GI, LabelT, VID_T, AggFunc::SUM, PropT, tag_id, T...> {
+};
+
+template <typename GI, typename LabelT, typename VID_T, typename... T,
+          typename PropT, int tag_id>
+struct KeyedAggT<GI, RowVertexSet<LabelT, VID_T, T...>, AggFunc::MIN,
+                 std::tuple<PropT>, std::integer_sequence<int32_t, tag_id>>
+    : VertexPropAggT<GI, LabelT, VID_T, AggFunc::MIN, PropT, tag_id, T...> {
+};
+
+template <typename GI, typename LabelT, typename VID_T, typename... T,
+          typename PropT, int tag_id>
+struct KeyedAggT<GI, RowVertexSet<LabelT, VID_T, T...>, AggFunc::MAX,
+                 std::tuple<PropT>, std::integer_sequence<int32_t, tag_id>>
+    : VertexPropAggT<GI, LabelT, VID_T, AggFunc::MAX, PropT, tag_id, T...> {
+};
+
 // get min
 template <typename GI, typename T, typename PropT, int tag_id>
 struct KeyedAggT<GI, Collection<T>, AggFunc::MIN, std::tuple<PropT>,
@@ -0,0 +1,77 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef ENGINES_HQPS_ENGINE_UTILS_MORSEL_H_
+#define ENGINES_HQPS_ENGINE_UTILS_MORSEL_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+namespace gs {
+
+// Number of input elements processed by a worker at a time.
+static constexpr size_t kMorselSize = 4096;
+
+/// @brief Number of threads an operator may split its input across, 1 keeps
+/// operators single-threaded. It is read from HQPS_MORSEL_THREADS, so that
+/// queries loaded as separate libraries agree on it.
+inline std::atomic<size_t>& morsel_thread_num() {
+  static std::atomic<size_t> thread_num{[]() -> size_t {
+    const char* env = std::getenv("HQPS_MORSEL_THREADS");
+    long num = env == nullptr ? 1 : std::atol(env);
+    return num > 1 ? num : 1;
+  }()};
+  return thread_num;
+}
+
+/// @brief Split [0, size) into morsels, which are taken by the calling thread
+/// and up to morsel_thread_num() - 1 workers in turn, so that skewed morsels
+/// are balanced. Inputs of a single morsel run on the calling thread.
+/// @param func Called as func(begin, end) for each morsel.
+/// @param morsel_size Inputs per morsel, e.g. 1 if each input is a task.
+template <typename FUNC>
+void parallel_for_morsels(size_t size, const FUNC& func,
+                          size_t morsel_size = kMorselSize) {
+  size_t morsel_num = (size + morsel_size - 1) / morsel_size;
+  size_t thread_num = std::min(morsel_thread_num().load(), morsel_num);
+  if (thread_num <= 1) {
+    func(0, size);
+    return;
+  }
+  std::atomic<size_t> next(0);
+  auto worker = [&]() {
+    while (true) {
+      size_t begin = next.fetch_add(morsel_size);
+      if (begin >= size) {
+        break;
+      }
+      func(begin, std::min(size, begin + morsel_size));
+    }
+  };
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < thread_num; ++i) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (auto& thrd : threads) {
+    thrd.join();
+  }
+}
+
+}  // namespace gs
+
+#endif  // ENGINES_HQPS_ENGINE_UTILS_MORSEL_H_
@@ -0,0 +1,57 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef ENGINES_HQPS_ENGINE_UTILS_PROFILE_H_
+#define ENGINES_HQPS_ENGINE_UTILS_PROFILE_H_
+
+#include "flex/utils/query_profile.h"
+#include "flex/utils/usdt.h"
+
+// Instrumentation of generated queries, compiled in only with HQPS_PROFILE
+// defined, see QueryProfiler. The generated code wraps each operator in
+// HQPS_PROFILE_OP_BEGIN and HQPS_PROFILE_OP_END, which record its wall time
+// and the rows of the context it produced. The operators of subplans are
+// recorded inside the operator owning them.
+//
+// With FLEX_WITH_USDT, they also fire the probes flex:hqps_op_begin and
+// flex:hqps_op_end, the latter with the name of the operator and the rows.
+#ifdef HQPS_PROFILE
+#define HQPS_PROFILE_QUERY(name) gs::QueryProfiler hqps_query_profiler(name)
+#define HQPS_PROFILER_OP_BEGIN() gs::QueryProfiler::BeginOperator()
+#define HQPS_PROFILER_OP_END(name, rows) \
+  gs::QueryProfiler::EndOperator(name, rows)
+#else
+#define HQPS_PROFILE_QUERY(name)
+#define HQPS_PROFILER_OP_BEGIN()
+#define HQPS_PROFILER_OP_END(name, rows)
+#endif
+
+#if defined(HQPS_PROFILE) || defined(FLEX_WITH_USDT)
+#define HQPS_PROFILE_OP_BEGIN() \
+  do {                          \
+    FLEX_PROBE0(hqps_op_begin); \
+    HQPS_PROFILER_OP_BEGIN();   \
+  } while (0)
+#define HQPS_PROFILE_OP_END(name, ctx)            \
+  do {                                            \
+    size_t hqps_op_rows = (ctx).GetHead().Size(); \
+    FLEX_PROBE2(hqps_op_end, name, hqps_op_rows); \
+    HQPS_PROFILER_OP_END(name, hqps_op_rows);     \
+  } while (0)
+#else
+#define HQPS_PROFILE_OP_BEGIN()
+#define HQPS_PROFILE_OP_END(name, ctx)
+#endif
+
+#endif  // ENGINES_HQPS_ENGINE_UTILS_PROFILE_H_
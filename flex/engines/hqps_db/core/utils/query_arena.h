@@ -0,0 +1,171 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef ENGINES_HQPS_ENGINE_UTILS_QUERY_ARENA_H_
+#define ENGINES_HQPS_ENGINE_UTILS_QUERY_ARENA_H_
+
+#include <cstdlib>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+namespace gs {
+
+/// @brief Monotonic memory of the query running on a thread.
+///
+/// Memory is carved from fixed size chunks and never given back one by one,
+/// reset releases all of it at once and keeps a few chunks for the next
+/// query. Allocations larger than kMaxArenaSize go to the heap, so that the
+/// buffers dropped by growing containers don't pile up in the arena.
+class QueryArena {
+ public:
+  static constexpr size_t kChunkSize = static_cast<size_t>(1) << 20;
+  static constexpr size_t kMaxArenaSize = kChunkSize / 4;
+  static constexpr size_t kRetainedChunkNum = 4;
+
+  QueryArena() : cur_(0), loc_(0) {}
+  ~QueryArena() {
+    for (auto chunk : chunks_) {
+      free(chunk);
+    }
+  }
+
+  QueryArena(const QueryArena&) = delete;
+  QueryArena& operator=(const QueryArena&) = delete;
+
+  /// @brief The arena of the query running on this thread, nullptr out of
+  /// queries.
+  static QueryArena*& current() {
+    thread_local QueryArena* arena = nullptr;
+    return arena;
+  }
+
+  void* allocate(size_t size, size_t align) {
+    size_t loc = (loc_ + align - 1) & ~(align - 1);
+    if (chunks_.empty() || loc + size > kChunkSize) {
+      if (!chunks_.empty()) {
+        ++cur_;
+      }
+      if (cur_ == chunks_.size()) {
+        void* chunk = malloc(kChunkSize);
+        if (chunk == nullptr) {
+          throw std::bad_alloc();
+        }
+        chunks_.push_back(static_cast<char*>(chunk));
+      }
+      loc = 0;
+    }
+    loc_ = loc + size;
+    return chunks_[cur_] + loc;
+  }
+
+  /// @brief Release all memory given so far, nothing allocated from the
+  /// arena may be referenced anymore.
+  void reset() {
+    while (chunks_.size() > kRetainedChunkNum) {
+      free(chunks_.back());
+      chunks_.pop_back();
+    }
+    cur_ = 0;
+    loc_ = 0;
+  }
+
+ private:
+  std::vector<char*> chunks_;
+  size_t cur_;
+  size_t loc_;
+};
+
+/// @brief Makes the thread's arena current for the lifetime of the scope, and
+/// resets it at the end. Nested scopes share the outermost one's arena.
+class QueryArenaScope {
+ public:
+  QueryArenaScope() : owner_(QueryArena::current() == nullptr) {
+    if (owner_) {
+      thread_local QueryArena arena;
+      QueryArena::current() = &arena;
+    }
+  }
+
+  ~QueryArenaScope() {
+    if (owner_) {
+      QueryArena::current()->reset();
+      QueryArena::current() = nullptr;
+    }
+  }
+
+  QueryArenaScope(const QueryArenaScope&) = delete;
+  QueryArenaScope& operator=(const QueryArenaScope&) = delete;
+
+ private:
+  bool owner_;
+};
+
+/// @brief Allocator taking memory from the arena current when it is
+/// constructed, or from the heap out of queries.
+///
+/// The arena is not thread safe: containers using it may be read by morsel
+/// workers, but must only grow on the thread running the query, and must not
+/// outlive the query.
+template <typename T>
+class QueryArenaAllocator {
+ public:
+  using value_type = T;
+  using propagate_on_container_move_assignment = std::true_type;
+  using propagate_on_container_swap = std::true_type;
+
+  QueryArenaAllocator() : arena_(QueryArena::current()) {}
+
+  template <typename U>
+  QueryArenaAllocator(const QueryArenaAllocator<U>& rhs)
+      : arena_(rhs.arena()) {}
+
+  T* allocate(size_t n) {
+    size_t size = n * sizeof(T);
+    if (arena_ == nullptr || size > QueryArena::kMaxArenaSize) {
+      return static_cast<T*>(::operator new(size));
+    }
+    return static_cast<T*>(arena_->allocate(size, alignof(T)));
+  }
+
+  void deallocate(T* ptr, size_t n) {
+    if (arena_ == nullptr || n * sizeof(T) > QueryArena::kMaxArenaSize) {
+      ::operator delete(ptr);
+    }
+  }
+
+  QueryArena* arena() const { return arena_; }
+
+ private:
+  QueryArena* arena_;
+};
+
+template <typename T, typename U>
+bool operator==(const QueryArenaAllocator<T>& lhs,
+                const QueryArenaAllocator<U>& rhs) {
+  return lhs.arena() == rhs.arena();
+}
+
+template <typename T, typename U>
+bool operator!=(const QueryArenaAllocator<T>& lhs,
+                const QueryArenaAllocator<U>& rhs) {
+  return lhs.arena() != rhs.arena();
+}
+
+template <typename T>
+using arena_vector = std::vector<T, QueryArenaAllocator<T>>;
+
+}  // namespace gs
+
+#endif  // ENGINES_HQPS_ENGINE_UTILS_QUERY_ARENA_H_
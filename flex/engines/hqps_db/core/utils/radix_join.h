@@ -0,0 +1,240 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef ENGINES_HQPS_ENGINE_UTILS_RADIX_JOIN_H_
+#define ENGINES_HQPS_ENGINE_UTILS_RADIX_JOIN_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <boost/functional/hash.hpp>
+
+#include "flex/engines/hqps_db/core/utils/flat_index_map.h"
+#include "flex/engines/hqps_db/core/utils/morsel.h"
+#include "flex/engines/hqps_db/core/utils/sampling.h"
+
+namespace gs {
+
+// Build keys to aim at per partition, so that the table of a partition stays
+// in cache while it is built.
+static constexpr size_t kJoinPartitionKeys = 1 << 13;
+static constexpr int kMaxJoinRadixBits = 10;
+
+// Unsigned keys spanning at most this many bitmap words per key are semi
+// joined with a bitmap.
+static constexpr size_t kDenseSemiJoinWordsPerKey = 2;
+
+/// @brief The build side of a hash join, mapping keys to the build rows with
+/// them, in row order.
+///
+/// Rows are partitioned on the top bits of the hashes of their keys, so that
+/// the table of each partition fits in cache, and the tables are built one
+/// partition at a time. Partitioning, building and probing are all split
+/// across morsel_thread_num() threads.
+template <typename KEY_T, typename HASH_T = boost::hash<KEY_T>>
+class RadixJoinTable {
+ public:
+  // Build rows with a key, as [first, second) of rows().
+  using range_t = std::pair<size_t, size_t>;
+
+  RadixJoinTable() : bits_(0) {}
+
+  void Build(const std::vector<KEY_T>& keys) {
+    size_t num = keys.size();
+    bits_ = 0;
+    while (bits_ < kMaxJoinRadixBits && (kJoinPartitionKeys << bits_) < num) {
+      ++bits_;
+    }
+    size_t part_num = static_cast<size_t>(1) << bits_;
+    size_t morsel_num = (num + kMorselSize - 1) / kMorselSize;
+
+    // the rows of each partition in each morsel, then where they go
+    std::vector<size_t> offsets(morsel_num * part_num, 0);
+    parallel_for_morsels(num, [&](size_t begin, size_t end) {
+      for_each_morsel(begin, end, [&](size_t m, size_t b, size_t e) {
+        size_t* counts = offsets.data() + m * part_num;
+        for (size_t i = b; i < e; ++i) {
+          ++counts[partition_of(keys[i])];
+        }
+      });
+    });
+    part_begins_.resize(part_num + 1);
+    size_t total = 0;
+    for (size_t p = 0; p < part_num; ++p) {
+      part_begins_[p] = total;
+      for (size_t m = 0; m < morsel_num; ++m) {
+        size_t count = offsets[m * part_num + p];
+        offsets[m * part_num + p] = total;
+        total += count;
+      }
+    }
+    part_begins_[part_num] = total;
+
+    // rows in order within each partition
+    std::vector<size_t> scattered(num);
+    parallel_for_morsels(num, [&](size_t begin, size_t end) {
+      for_each_morsel(begin, end, [&](size_t m, size_t b, size_t e) {
+        size_t* poses = offsets.data() + m * part_num;
+        for (size_t i = b; i < e; ++i) {
+          scattered[poses[partition_of(keys[i])]++] = i;
+        }
+      });
+    });
+
+    maps_.clear();
+    maps_.resize(part_num);
+    group_begins_.clear();
+    group_begins_.resize(part_num);
+    rows_.resize(num);
+    parallel_for_morsels(
+        part_num,
+        [&](size_t begin, size_t end) {
+          for (size_t p = begin; p < end; ++p) {
+            build_partition(keys, scattered, p);
+          }
+        },
+        1);
+  }
+
+  /// @brief Build rows with the key.
+  range_t Find(const KEY_T& key) const {
+    size_t part = partition_of(key);
+    size_t ind = maps_[part].find(key);
+    if (ind >= group_begins_[part].size()) {
+      return range_t(0, 0);
+    }
+    const auto& group_begins = group_begins_[part];
+    return range_t(group_begins[ind], group_begins[ind + 1]);
+  }
+
+  /// @brief Build rows with each of the keys, found in parallel.
+  std::vector<range_t> Probe(const std::vector<KEY_T>& keys) const {
+    std::vector<range_t> ranges(keys.size());
+    parallel_for_morsels(keys.size(), [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        ranges[i] = Find(keys[i]);
+      }
+    });
+    return ranges;
+  }
+
+  const std::vector<size_t>& rows() const { return rows_; }
+
+ private:
+  size_t partition_of(const KEY_T& key) const {
+    if (bits_ == 0) {
+      return 0;
+    }
+    uint64_t hash = static_cast<uint64_t>(HASH_T()(key));
+    return static_cast<size_t>(mix_hash(hash) >> (64 - bits_));
+  }
+
+  // Split [begin, end) at the bounds of morsels, calling func(m, b, e) for
+  // the part in morsel m, so that counts and offsets are kept per morsel
+  // however inputs are split across threads.
+  template <typename FUNC>
+  static void for_each_morsel(size_t begin, size_t end, const FUNC& func) {
+    while (begin < end) {
+      size_t m = begin / kMorselSize;
+      size_t e = std::min(end, (m + 1) * kMorselSize);
+      func(m, begin, e);
+      begin = e;
+    }
+  }
+
+  void build_partition(const std::vector<KEY_T>& keys,
+                       const std::vector<size_t>& scattered, size_t part) {
+    size_t begin = part_begins_[part];
+    size_t end = part_begins_[part + 1];
+    auto& map = maps_[part];
+    map.reserve(end - begin);
+    std::vector<size_t> groups(end - begin);
+    std::vector<size_t> counts;
+    for (size_t i = begin; i < end; ++i) {
+      size_t ind = map.insert(keys[scattered[i]]).first;
+      if (ind == counts.size()) {
+        counts.push_back(0);
+      }
+      ++counts[ind];
+      groups[i - begin] = ind;
+    }
+    auto& group_begins = group_begins_[part];
+    group_begins.resize(counts.size() + 1);
+    size_t total = begin;
+    for (size_t g = 0; g < counts.size(); ++g) {
+      group_begins[g] = total;
+      total += counts[g];
+      counts[g] = group_begins[g];
+    }
+    group_begins[counts.size()] = total;
+    for (size_t i = begin; i < end; ++i) {
+      rows_[counts[groups[i - begin]]++] = scattered[i];
+    }
+  }
+
+  int bits_;
+  std::vector<size_t> part_begins_;
+  std::vector<FlatIndexMap<KEY_T, HASH_T>> maps_;
+  // per partition, where the rows of each key start in rows_, and the end
+  std::vector<std::vector<size_t>> group_begins_;
+  std::vector<size_t> rows_;
+};
+
+/// @brief Whether each probe key is among the build keys, found in parallel.
+///
+/// Unsigned keys dense enough in [0, max build key], as the vids of a single
+/// label, are looked up in a bitmap, others in a RadixJoinTable.
+template <typename KEY_T, typename HASH_T = boost::hash<KEY_T>>
+std::vector<uint8_t> semi_join_keys(const std::vector<KEY_T>& build,
+                                    const std::vector<KEY_T>& probe) {
+  std::vector<uint8_t> found(probe.size(), 0);
+  if (build.empty()) {
+    return found;
+  }
+  if constexpr (std::is_unsigned_v<KEY_T>) {
+    uint64_t max_key = *std::max_element(build.begin(), build.end());
+    size_t word_num = max_key / 64 + 1;
+    size_t key_num = std::max(build.size(), probe.size());
+    if (word_num <= key_num * kDenseSemiJoinWordsPerKey) {
+      std::vector<uint64_t> words(word_num, 0);
+      for (auto key : build) {
+        uint64_t k = key;
+        words[k / 64] |= static_cast<uint64_t>(1) << (k % 64);
+      }
+      parallel_for_morsels(probe.size(), [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+          uint64_t k = probe[i];
+          found[i] = k <= max_key && ((words[k / 64] >> (k % 64)) & 1);
+        }
+      });
+      return found;
+    }
+  }
+  RadixJoinTable<KEY_T, HASH_T> table;
+  table.Build(build);
+  parallel_for_morsels(probe.size(), [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      auto range = table.Find(probe[i]);
+      found[i] = range.first != range.second;
+    }
+  });
+  return found;
+}
+
+}  // namespace gs
+
+#endif  // ENGINES_HQPS_ENGINE_UTILS_RADIX_JOIN_H_
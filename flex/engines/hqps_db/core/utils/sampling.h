@@ -0,0 +1,95 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef ENGINES_HQPS_ENGINE_UTILS_SAMPLING_H_
+#define ENGINES_HQPS_ENGINE_UTILS_SAMPLING_H_
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace gs {
+
+// The finalizer of splitmix64, mixing all bits of the key.
+inline uint64_t mix_hash(uint64_t key) {
+  uint64_t z = key + 0x9e3779b97f4a7c15ULL;
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+// A cheap generator for sampling, seeded per source vertex so that samples
+// do not depend on how the input is split across threads.
+class SampleRng {
+ public:
+  explicit SampleRng(uint64_t seed) : state_(seed) {}
+
+  uint64_t Next() { return mix_hash(state_++); }
+
+  // in [0, n)
+  uint64_t Below(uint64_t n) {
+    return static_cast<uint64_t>(
+        (static_cast<unsigned __int128>(Next()) * n) >> 64);
+  }
+
+ private:
+  uint64_t state_;
+};
+
+/// @brief A HyperLogLog sketch of 2^kPrecision registers, estimating the
+/// number of distinct hashes inserted in constant space, with a relative
+/// standard error of RelativeError().
+class HyperLogLog {
+ public:
+  static constexpr int kPrecision = 12;
+  static constexpr size_t kRegisterNum = 1ul << kPrecision;
+
+  HyperLogLog() : registers_(kRegisterNum, 0) {}
+
+  static double RelativeError() { return 1.04 / std::sqrt(kRegisterNum); }
+
+  // hash must be well mixed, e.g. by mix_hash.
+  void Insert(uint64_t hash) {
+    size_t ind = hash >> (64 - kPrecision);
+    uint64_t rest = hash << kPrecision;
+    uint8_t rank =
+        rest == 0 ? 64 - kPrecision + 1 : __builtin_clzll(rest) + 1;
+    if (rank > registers_[ind]) {
+      registers_[ind] = rank;
+    }
+  }
+
+  size_t Estimate() const {
+    double sum = 0;
+    size_t zeros = 0;
+    for (auto reg : registers_) {
+      sum += std::ldexp(1.0, -reg);
+      zeros += reg == 0;
+    }
+    double m = kRegisterNum;
+    double estimate = 0.7213 / (1 + 1.079 / m) * m * m / sum;
+    // small ranges are counted better by the empty registers
+    if (estimate <= 2.5 * m && zeros != 0) {
+      estimate = m * std::log(m / zeros);
+    }
+    return static_cast<size_t>(estimate + 0.5);
+  }
+
+ private:
+  std::vector<uint8_t> registers_;
+};
+
+}  // namespace gs
+
+#endif  // ENGINES_HQPS_ENGINE_UTILS_SAMPLING_H_
@@ -21,6 +21,7 @@
 #include <vector>
 
 #include "flex/engines/hqps_db/core/null_record.h"
+#include "flex/engines/hqps_db/core/utils/query_arena.h"
 
 namespace gs {
 
@@ -438,7 +439,7 @@ class AdjListArray<T> {
   }
 
  private:
-  std::vector<std::pair<slice_t, slice_t>> slices_;
+  arena_vector<std::pair<slice_t, slice_t>> slices_;
   bool flag_;
 };
 
@@ -502,7 +503,7 @@ class AdjListArray<> {
   }
 
  private:
-  std::vector<std::pair<slice_t, slice_t>> slices_;
+  arena_vector<std::pair<slice_t, slice_t>> slices_;
   bool flag_;
 };
 
@@ -532,26 +533,38 @@ class NbrList {
   const Nbr* end_;
 };
 
+// Neighbor lists of a batch of vertices, laid out as a csr: the lists are
+// sized first with init, then written in place through data. They are only
+// kept during an operator, so the memory is taken from the query arena.
 class NbrListArray {
  public:
-  NbrListArray() {}
-  ~NbrListArray() = default;
+  NbrListArray() : offsets_(1, 0) {}
 
   NbrList get(size_t index) const {
-    auto& list = nbr_lists_[index];
-    return NbrList(list.data(), list.data() + list.size());
+    return NbrList(nbrs_.data() + offsets_[index],
+                   nbrs_.data() + offsets_[index + 1]);
   }
 
-  void put(std::vector<Nbr>&& list) { nbr_lists_.push_back(std::move(list)); }
+  size_t size() const { return offsets_.size() - 1; }
 
-  size_t size() const { return nbr_lists_.size(); }
+  // Lay out the lists of the given sizes contiguously.
+  void init(const std::vector<size_t>& sizes) {
+    offsets_.resize(sizes.size() + 1);
+    offsets_[0] = 0;
+    for (size_t i = 0; i < sizes.size(); ++i) {
+      offsets_[i + 1] = offsets_[i] + sizes[i];
+    }
+    nbrs_.resize(offsets_.back());
+  }
 
-  void resize(size_t size) { nbr_lists_.resize(size); }
+  Nbr* data(size_t index) { return nbrs_.data() + offsets_[index]; }
 
-  std::vector<Nbr>& get_vector(size_t index) { return nbr_lists_[index]; }
+  // offsets of the lists, with the total number of neighbors at the end.
+  const arena_vector<size_t>& offsets() const { return offsets_; }
 
  private:
-  std::vector<std::vector<Nbr>> nbr_lists_;
+  arena_vector<size_t> offsets_;
+  arena_vector<Nbr> nbrs_;
 };
 
 }  // namespace mutable_csr_graph_impl
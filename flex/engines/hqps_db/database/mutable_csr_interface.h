@@ -15,12 +15,20 @@
 #ifndef ENGINES_HQPS_DATABASE_MUTABLE_CSR_INTERFACE_H_
 #define ENGINES_HQPS_DATABASE_MUTABLE_CSR_INTERFACE_H_
 
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <string>
 #include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
 
 #include "flex/engines/graph_db/database/graph_db.h"
 #include "flex/engines/graph_db/database/graph_db_session.h"
 #include "flex/engines/hqps_db/core/null_record.h"
 #include "flex/engines/hqps_db/core/params.h"
+#include "flex/engines/hqps_db/core/utils/morsel.h"
 
 #include "flex/engines/hqps_db/database/adj_list.h"
 #include "grape/utils/bitset.h"
@@ -94,7 +102,8 @@ class MutableCSRInterface {
 
   static MutableCSRInterface& get();
 
-  MutableCSRInterface(const GraphDBSession& session) : db_session_(session) {}
+  MutableCSRInterface(const GraphDBSession& session)
+      : db_session_(session), columns_(std::make_shared<ColumnCache>()) {}
 
   /**
    * @brief Get the Vertex Label id
@@ -151,11 +160,79 @@ class MutableCSRInterface {
     auto vnum = db_session_.graph().vertex_num(label_id);
     std::tuple<typename SELECTOR::prop_t...> t;
     for (auto v = 0; v != vnum; ++v) {
+      if (db_session_.graph().is_vertex_deleted(label_id, v)) {
+        continue;
+      }
       get_tuple_from_column_tuple(v, t, columns);
       func(v, t);
     }
   }
 
+  /**
+   * @brief ScanVerticesBatched scans the vertices with the given label that
+   * satisfy pred. The properties of a batch of vertices are gathered into
+   * contiguous buffers, and pred is evaluated over them into a selection mask
+   * without branches, which lets the compiler vectorize simple comparisons.
+   * Batches are processed in morsels, see parallel_for_morsels.
+   * @tparam PRED_T
+   * @tparam SELECTOR
+   * @param label_id
+   * @param selectors
+   * @param pred
+   * @return The vertices selected, in ascending order.
+   */
+  template <typename PRED_T, typename... SELECTOR>
+  std::vector<vertex_id_t> ScanVerticesBatched(
+      const label_id_t& label_id, const std::tuple<SELECTOR...>& selectors,
+      const PRED_T& pred) const {
+    auto columns =
+        get_tuple_column_from_graph_with_property(label_id, selectors);
+    return scan_vertices_batched_impl(
+        label_id, columns, pred,
+        std::make_index_sequence<sizeof...(SELECTOR)>());
+  }
+
+  /**
+   * @brief ScanVerticesWithIndex scans the vertices with the given label
+   * whose property prop_name is within range, looked up in the
+   * secondary index of the property, and keeps those that satisfy pred like
+   * ScanVerticesBatched. Index entries are candidates, see VertexIndexBase, so
+   * pred has to imply range. Falls back to ScanVerticesBatched if the
+   * property has no index that supports range.
+   * @tparam PRED_T
+   * @tparam SELECTOR
+   * @param label_id
+   * @param prop_name
+   * @param range
+   * @param selectors
+   * @param pred
+   * @return The vertices selected, in ascending order.
+   */
+  template <typename PRED_T, typename... SELECTOR>
+  std::vector<vertex_id_t> ScanVerticesWithIndex(
+      const label_id_t& label_id, const std::string& prop_name,
+      const IndexRange& range, const std::tuple<SELECTOR...>& selectors,
+      const PRED_T& pred) const {
+    const auto& graph = db_session_.graph();
+    int col_id = graph.get_vertex_table(label_id).get_column_id_by_name(
+        prop_name);
+    const VertexIndexBase* index =
+        col_id < 0 ? nullptr : graph.get_vertex_index(label_id, col_id);
+    if (index == nullptr || !index->supports(range)) {
+      return ScanVerticesBatched(label_id, selectors, pred);
+    }
+    std::vector<vertex_id_t> candidates;
+    index->find(range, candidates);
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()),
+                     candidates.end());
+    auto columns =
+        get_tuple_column_from_graph_with_property(label_id, selectors);
+    return filter_candidates_impl(
+        label_id, candidates, columns, pred,
+        std::make_index_sequence<sizeof...(SELECTOR)>());
+  }
+
   /**
    * @brief ScanVertices scans all vertices with the given label with give
    * original id.
@@ -197,7 +274,9 @@ class MutableCSRInterface {
     auto label_id = db_session_.schema().get_vertex_label_id(label);
     auto vnum = db_session_.graph().vertex_num(label_id);
     for (auto v = 0; v != vnum; ++v) {
-      func(v);
+      if (!db_session_.graph().is_vertex_deleted(label_id, v)) {
+        func(v);
+      }
     }
   }
 
@@ -220,9 +299,12 @@ class MutableCSRInterface {
     std::vector<vertex_id_t> vids(oids.size());
     std::vector<std::tuple<T...>> props(oids.size());
 
+    db_session_.graph().get_lids(label_id, oids.data(), oids.size(),
+                                 vids.data());
     for (size_t i = 0; i < oids.size(); ++i) {
-      db_session_.graph().get_lid(label_id, oids[i], vids[i]);
-      get_tuple_from_column_tuple(vids[i], props[i], columns);
+      if (vids[i] != std::numeric_limits<vertex_id_t>::max()) {
+        get_tuple_from_column_tuple(vids[i], props[i], columns);
+      }
     }
 
     return std::make_pair(std::move(vids), std::move(props));
@@ -391,8 +473,17 @@ class MutableCSRInterface {
       auto& column_tuple1 = columns[1];
       auto ptr0 = std::get<Is>(column_tuple0);
       auto ptr1 = std::get<Is>(column_tuple1);
+      constexpr size_t dist = RefColumnBase::kPrefetchDistance;
+      size_t num = vids.size();
       if (ptr0 && ptr1) {
-        for (auto i = 0; i < vids.size(); ++i) {
+        for (size_t i = 0; i < num; ++i) {
+          if (i + dist < num) {
+            if (bitset.get_bit(i + dist)) {
+              ptr0->prefetch_row(vids[i + dist]);
+            } else {
+              ptr1->prefetch_row(vids[i + dist]);
+            }
+          }
           if (bitset.get_bit(i)) {
             std::get<Is>(props[i]) = ptr0->get_view(vids[i]);
           } else {
@@ -400,13 +491,19 @@ class MutableCSRInterface {
           }
         }
       } else if (ptr0) {
-        for (auto i = 0; i < vids.size(); ++i) {
+        for (size_t i = 0; i < num; ++i) {
+          if (i + dist < num && bitset.get_bit(i + dist)) {
+            ptr0->prefetch_row(vids[i + dist]);
+          }
           if (bitset.get_bit(i)) {
             std::get<Is>(props[i]) = ptr0->get_view(vids[i]);
           }
         }
       } else if (ptr1) {
-        for (auto i = 0; i < vids.size(); ++i) {
+        for (size_t i = 0; i < num; ++i) {
+          if (i + dist < num && !bitset.get_bit(i + dist)) {
+            ptr1->prefetch_row(vids[i + dist]);
+          }
           if (!bitset.get_bit(i)) {
             std::get<Is>(props[i]) = ptr1->get_view(vids[i]);
           }
@@ -426,9 +523,13 @@ class MutableCSRInterface {
 
     auto& cur_column = std::get<Is>(column);
     if (cur_column) {
-      for (auto i = 0; i < vids.size(); ++i) {
-        std::get<Is>(props[i]) = cur_column->get_view(vids[i]);
+      // page in the whole batch at once instead of faulting row by row
+      if (cur_column->storage_strategy() == StorageStrategy::kDisk) {
+        cur_column->prefetch(vids.data(), vids.size());
       }
+      cur_column->gather(
+          vids.size(), [&](size_t i) { return vids[i]; },
+          [&](size_t i, const auto& value) { std::get<Is>(props[i]) = value; });
     }
 
     if constexpr (Is + 1 < sizeof...(T)) {
@@ -457,11 +558,12 @@ class MutableCSRInterface {
       auto column_tuple = columns[i];
       auto ptr = std::get<Is>(column_tuple);
       if (ptr) {
-        for (auto j = 0; j < vid_inds[i].size(); ++j) {
-          auto vid_ind = vid_inds[i][j];
-          auto vid = vids[vid_ind];
-          std::get<Is>(props[vid_ind]) = ptr->get_view(vid);
-        }
+        auto& inds = vid_inds[i];
+        ptr->gather(
+            inds.size(), [&](size_t j) { return vids[inds[j]]; },
+            [&](size_t j, const auto& value) {
+              std::get<Is>(props[inds[j]]) = value;
+            });
       } else {
         VLOG(10) << "skip for column " << Is;
       }
@@ -564,6 +666,94 @@ class MutableCSRInterface {
                           direction_str, limit, prop_names);
   }
 
+  /**
+   * @brief Typed view of the outgoing edges of v visible at timestamp ts, e.g.
+   * the timestamp of a ReadTransaction. Iterating it reads the csr buffers
+   * directly, without allocations or virtual calls per edge. Edges of static
+   * edge types can only be read by GetEdges.
+   * @tparam EDATA_T the data type of the edge label
+   */
+  template <typename EDATA_T>
+  AdjListView<EDATA_T> GetOutgoingEdgeView(const label_id_t& v_label,
+                                           vertex_id_t v,
+                                           const label_id_t& nbr_label,
+                                           const label_id_t& edge_label,
+                                           timestamp_t ts) const {
+    return AdjListView<EDATA_T>(db_session_.graph().get_oe_slice<EDATA_T>(
+                                    v_label, v, nbr_label, edge_label),
+                                ts);
+  }
+
+  /** @brief Typed view of the incoming edges of v, see GetOutgoingEdgeView. */
+  template <typename EDATA_T>
+  AdjListView<EDATA_T> GetIncomingEdgeView(const label_id_t& v_label,
+                                           vertex_id_t v,
+                                           const label_id_t& nbr_label,
+                                           const label_id_t& edge_label,
+                                           timestamp_t ts) const {
+    return AdjListView<EDATA_T>(db_session_.graph().get_ie_slice<EDATA_T>(
+                                    v_label, v, nbr_label, edge_label),
+                                ts);
+  }
+
+  /**
+   * @brief Call func(nbr, data) for each edge of v in the direction, reading
+   * the nbrs straight from the csr. EDATA_T must be the data type of the edge
+   * label. As with GetEdges, timestamps are not filtered.
+   */
+  template <typename EDATA_T, typename FUNC_T>
+  void ForEachEdge(const label_id_t& v_label, vertex_id_t v,
+                   const label_id_t& nbr_label, const label_id_t& edge_label,
+                   Direction direction, const FUNC_T& func) const {
+    const auto& graph = db_session_.graph();
+    if (direction != Direction::In) {
+      for (auto& nbr : graph.get_oe_slice<EDATA_T>(v_label, v, nbr_label,
+                                                   edge_label)) {
+        func(nbr.neighbor, nbr.data);
+      }
+    }
+    if (direction != Direction::Out) {
+      for (auto& nbr : graph.get_ie_slice<EDATA_T>(v_label, v, nbr_label,
+                                                   edge_label)) {
+        func(nbr.neighbor, nbr.data);
+      }
+    }
+  }
+
+  /**
+   * @brief Call func(nbr, data) for each edge of v in the direction whose
+   * time, see time_of, is in [begin, end). Lists of time-ordered edge types
+   * are binary searched, others are scanned. As with ForEachEdge, EDATA_T
+   * must be the data type of the edge label, and timestamps are not filtered.
+   */
+  template <typename EDATA_T, typename FUNC_T>
+  void ForEachEdgeInTimeRange(const label_id_t& v_label, vertex_id_t v,
+                              const label_id_t& nbr_label,
+                              const label_id_t& edge_label,
+                              Direction direction, int64_t begin, int64_t end,
+                              const FUNC_T& func) const {
+    const auto& graph = db_session_.graph();
+    auto visit = [&](const auto& edges) {
+      for (auto& nbr : edges.first) {
+        func(nbr.neighbor, nbr.data);
+      }
+      for (auto& nbr : edges.second) {
+        int64_t t = time_of(nbr.data);
+        if (t >= begin && t < end) {
+          func(nbr.neighbor, nbr.data);
+        }
+      }
+    };
+    if (direction != Direction::In) {
+      visit(graph.get_oe_time_range<EDATA_T>(v_label, v, nbr_label,
+                                             edge_label, begin, end));
+    }
+    if (direction != Direction::Out) {
+      visit(graph.get_ie_time_range<EDATA_T>(v_label, v, nbr_label,
+                                             edge_label, begin, end));
+    }
+  }
+
   std::pair<std::vector<vertex_id_t>, std::vector<size_t>> GetOtherVerticesV2(
       const std::string& src_label, const std::string& dst_label,
       const std::string& edge_label, const std::vector<vertex_id_t>& vids,
@@ -682,60 +872,53 @@ class MutableCSRInterface {
       const label_id_t& src_label_id, const label_id_t& dst_label_id,
       const label_id_t& edge_label_id, const std::vector<vertex_id_t>& vids,
       const std::string& direction_str, size_t limit) const {
-    mutable_csr_graph_impl::NbrListArray ret;
-
+    std::vector<const MutableCsrBase*> csrs;
     if (direction_str == "out" || direction_str == "Out" ||
         direction_str == "OUT") {
-      auto csr = db_session_.graph().get_oe_csr(src_label_id, dst_label_id,
-                                                edge_label_id);
-      ret.resize(vids.size());
-      for (size_t i = 0; i < vids.size(); ++i) {
-        auto v = vids[i];
-        auto iter = csr->edge_iter(v);
-        auto& vec = ret.get_vector(i);
-        while (iter->is_valid()) {
-          vec.push_back(mutable_csr_graph_impl::Nbr(iter->get_neighbor()));
-          iter->next();
-        }
-      }
+      csrs.emplace_back(db_session_.graph().get_oe_csr(
+          src_label_id, dst_label_id, edge_label_id));
     } else if (direction_str == "in" || direction_str == "In" ||
                direction_str == "IN") {
-      auto csr = db_session_.graph().get_ie_csr(dst_label_id, src_label_id,
-                                                edge_label_id);
-      ret.resize(vids.size());
-      for (size_t i = 0; i < vids.size(); ++i) {
-        auto v = vids[i];
-        auto iter = csr->edge_iter(v);
-        auto& vec = ret.get_vector(i);
-        while (iter->is_valid()) {
-          vec.push_back(mutable_csr_graph_impl::Nbr(iter->get_neighbor()));
-          iter->next();
-        }
-      }
+      csrs.emplace_back(db_session_.graph().get_ie_csr(
+          dst_label_id, src_label_id, edge_label_id));
     } else if (direction_str == "both" || direction_str == "Both" ||
                direction_str == "BOTH") {
-      ret.resize(vids.size());
-      auto ocsr = db_session_.graph().get_oe_csr(src_label_id, dst_label_id,
-                                                 edge_label_id);
-      auto icsr = db_session_.graph().get_ie_csr(dst_label_id, src_label_id,
-                                                 edge_label_id);
-      for (size_t i = 0; i < vids.size(); ++i) {
-        auto v = vids[i];
-        auto& vec = ret.get_vector(i);
-        auto iter = ocsr->edge_iter(v);
-        while (iter->is_valid()) {
-          vec.push_back(mutable_csr_graph_impl::Nbr(iter->get_neighbor()));
-          iter->next();
-        }
-        iter = icsr->edge_iter(v);
-        while (iter->is_valid()) {
-          vec.push_back(mutable_csr_graph_impl::Nbr(iter->get_neighbor()));
-          iter->next();
-        }
-      }
+      csrs.emplace_back(db_session_.graph().get_oe_csr(
+          src_label_id, dst_label_id, edge_label_id));
+      csrs.emplace_back(db_session_.graph().get_ie_csr(
+          dst_label_id, src_label_id, edge_label_id));
     } else {
       LOG(FATAL) << "Not implemented - " << direction_str;
     }
+
+    // Size the lists first, so that they are filled in place in one buffer.
+    std::vector<std::shared_ptr<MutableCsrConstEdgeIterBase>> iters(
+        vids.size() * csrs.size());
+    std::vector<size_t> sizes(vids.size(), 0);
+    parallel_for_morsels(vids.size(), [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        for (size_t j = 0; j < csrs.size(); ++j) {
+          auto& iter = iters[i * csrs.size() + j];
+          iter = csrs[j]->edge_iter(vids[i]);
+          sizes[i] += iter->size();
+        }
+      }
+    });
+    mutable_csr_graph_impl::NbrListArray ret;
+    ret.init(sizes);
+    parallel_for_morsels(vids.size(), [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        auto ptr = ret.data(i);
+        for (size_t j = 0; j < csrs.size(); ++j) {
+          auto& iter = iters[i * csrs.size() + j];
+          while (iter->is_valid()) {
+            *ptr++ = mutable_csr_graph_impl::Nbr(iter->get_neighbor());
+            iter->next();
+          }
+          iter.reset();
+        }
+      }
+    });
     return ret;
   }
 
@@ -773,10 +956,38 @@ class MutableCSRInterface {
     return mutable_csr_graph_impl::SinglePropGetter<T>(std::move(column));
   }
 
-  // get the vertex property
+  // get the vertex property, bound once per label and name, see ColumnCache.
   template <typename T>
   std::shared_ptr<TypedRefColumn<T>> GetTypedRefColumn(
       const label_t& label_id, const std::string& prop_name) const {
+    std::lock_guard<std::mutex> guard(columns_->mutex);
+    auto& columns = columns_->columns;
+    if (columns.size() <= label_id) {
+      columns.resize(label_id + 1);
+    }
+    auto& column = columns[label_id][prop_name];
+    if (column == nullptr) {
+      column = bind_typed_ref_column<T>(label_id, prop_name);
+    }
+    return std::dynamic_pointer_cast<TypedRefColumn<T>>(column);
+  }
+
+ private:
+  static constexpr size_t kScanBatchSize = 1024;
+
+  // Typed columns of the vertex properties, by label and name. They are
+  // views of the columns of the graph, so a stored procedure, which keeps
+  // its interface across queries, resolves each of them by name once rather
+  // than in every query. Shared by the copies of an interface.
+  struct ColumnCache {
+    std::mutex mutex;
+    std::vector<std::unordered_map<std::string, std::shared_ptr<RefColumnBase>>>
+        columns;
+  };
+
+  template <typename T>
+  std::shared_ptr<RefColumnBase> bind_typed_ref_column(
+      const label_t& label_id, const std::string& prop_name) const {
     using column_t = std::shared_ptr<TypedRefColumn<T>>;
     column_t column;
     if (prop_name == "id" || prop_name == "ID" || prop_name == "Id") {
@@ -794,7 +1005,89 @@ class MutableCSRInterface {
     return column;
   }
 
- private:
+  // copy the values of rows [begin, begin + num) into out
+  template <typename T>
+  static void gather_batch(const std::shared_ptr<TypedRefColumn<T>>& column,
+                           size_t begin, size_t num, T* out) {
+    if (column == nullptr) {
+      std::fill_n(out, num, T());
+      return;
+    }
+    if constexpr (std::is_same_v<T, std::string_view>) {
+      for (size_t i = 0; i < num; ++i) {
+        out[i] = column->get_view(begin + i);
+      }
+    } else {
+      std::copy_n(column->data() + begin, num, out);
+    }
+  }
+
+  template <typename PRED_T, typename... T, size_t... Is>
+  std::vector<vertex_id_t> scan_vertices_batched_impl(
+      const label_id_t& label_id,
+      const std::tuple<std::shared_ptr<TypedRefColumn<T>>...>& columns,
+      const PRED_T& pred, std::index_sequence<Is...>) const {
+    const auto& graph = db_session_.graph();
+    size_t vnum = graph.vertex_num(label_id);
+    size_t morsel_num = (vnum + kMorselSize - 1) / kMorselSize;
+    std::vector<std::vector<vertex_id_t>> morsel_vids(morsel_num);
+    parallel_for_morsels(vnum, [&](size_t begin, size_t end) {
+      auto& vids = morsel_vids[begin / kMorselSize];
+      std::tuple<std::vector<T>...> buffers{
+          std::vector<T>(kScanBatchSize)...};
+      std::vector<uint8_t> mask(kScanBatchSize);
+      std::vector<vertex_id_t> selected(kScanBatchSize);
+      for (size_t batch = begin; batch < end; batch += kScanBatchSize) {
+        size_t num = std::min(kScanBatchSize, end - batch);
+        (gather_batch(std::get<Is>(columns), batch, num,
+                      std::get<Is>(buffers).data()),
+         ...);
+        for (size_t i = 0; i < num; ++i) {
+          mask[i] = pred(std::get<Is>(buffers)[i]...);
+        }
+        size_t selected_num = 0;
+        for (size_t i = 0; i < num; ++i) {
+          vertex_id_t v = batch + i;
+          selected[selected_num] = v;
+          selected_num += mask[i] & !graph.is_vertex_deleted(label_id, v);
+        }
+        vids.insert(vids.end(), selected.begin(),
+                    selected.begin() + selected_num);
+      }
+    });
+    std::vector<vertex_id_t> ret;
+    for (auto& vids : morsel_vids) {
+      ret.insert(ret.end(), vids.begin(), vids.end());
+    }
+    return ret;
+  }
+
+  // keep the candidates of an index lookup that are visible, not deleted and
+  // satisfy pred, in place
+  template <typename PRED_T, typename... T, size_t... Is>
+  std::vector<vertex_id_t> filter_candidates_impl(
+      const label_id_t& label_id, std::vector<vertex_id_t>& candidates,
+      const std::tuple<std::shared_ptr<TypedRefColumn<T>>...>& columns,
+      const PRED_T& pred, std::index_sequence<Is...>) const {
+    const auto& graph = db_session_.graph();
+    vertex_id_t vnum = graph.vertex_num(label_id);
+    size_t selected_num = 0;
+    for (auto v : candidates) {
+      if (v >= vnum) {
+        // candidates are sorted
+        break;
+      }
+      if (!graph.is_vertex_deleted(label_id, v) &&
+          pred((std::get<Is>(columns) == nullptr
+                    ? T()
+                    : std::get<Is>(columns)->get_view(v))...)) {
+        candidates[selected_num++] = v;
+      }
+    }
+    candidates.resize(selected_num);
+    return std::move(candidates);
+  }
+
   std::shared_ptr<RefColumnBase> create_ref_column(
       std::shared_ptr<ColumnBase> column) const {
     auto type = column->type();
@@ -854,6 +1147,7 @@ class MutableCSRInterface {
   }
 
   const GraphDBSession& db_session_;
+  std::shared_ptr<ColumnCache> columns_;
   bool initialized_ = false;
 };
 
@@ -0,0 +1,58 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef ENGINES_HQPS_RUNTIME_H_
+#define ENGINES_HQPS_RUNTIME_H_
+
+// Headers of the runtime of generated queries, included first by each of
+// them. The query build precompiles this header once and reuses it for the
+// next queries, see resources/hqps/CMakeLists.txt.template.
+
+#include "flex/engines/hqps_db/app/hqps_app_base.h"
+#include "flex/engines/hqps_db/core/sync_engine.h"
+#include "flex/engines/hqps_db/database/mutable_csr_interface.h"
+#include "flex/engines/hqps_db/structures/collection.h"
+#include "flex/engines/hqps_db/structures/multi_vertex_set/row_vertex_set.h"
+#include "flex/engines/hqps_db/structures/multi_vertex_set/two_label_vertex_set.h"
+
+// Sets and adjacency lists of the types most queries use, instantiated once
+// in libhqps_runtime, which queries link. The declarations below keep
+// queries from emitting their members again, while they still inline them.
+#define HQPS_RUNTIME_INSTANTIATE_PROPS(PREFIX, T)         \
+  PREFIX class Collection<T>;                             \
+  PREFIX class CollectionBuilder<T>;                      \
+  PREFIX class mutable_csr_graph_impl::AdjList<T>;        \
+  PREFIX class mutable_csr_graph_impl::AdjListArray<T>;
+
+#define HQPS_RUNTIME_INSTANTIATE(PREFIX)                                     \
+  PREFIX class RowVertexSetImpl<uint8_t, vid_t, grape::EmptyType>;          \
+  PREFIX class RowVertexSetImplBuilder<uint8_t, vid_t, grape::EmptyType>;   \
+  PREFIX class TwoLabelVertexSetImpl<vid_t, uint8_t, grape::EmptyType>;     \
+  PREFIX class TwoLabelVertexSetImplBuilder<vid_t, uint8_t,                 \
+                                            grape::EmptyType>;              \
+  PREFIX class mutable_csr_graph_impl::AdjList<>;                           \
+  PREFIX class mutable_csr_graph_impl::AdjListArray<>;                      \
+  HQPS_RUNTIME_INSTANTIATE_PROPS(PREFIX, int32_t)                           \
+  HQPS_RUNTIME_INSTANTIATE_PROPS(PREFIX, int64_t)                           \
+  HQPS_RUNTIME_INSTANTIATE_PROPS(PREFIX, double)                            \
+  HQPS_RUNTIME_INSTANTIATE_PROPS(PREFIX, Date)                              \
+  HQPS_RUNTIME_INSTANTIATE_PROPS(PREFIX, std::string_view)
+
+namespace gs {
+
+HQPS_RUNTIME_INSTANTIATE(extern template)
+
+}  // namespace gs
+
+#endif  // ENGINES_HQPS_RUNTIME_H_
@@ -19,8 +19,10 @@
 #include <vector>
 
 #include "flex/engines/hqps_db/core/null_record.h"
+#include "flex/engines/hqps_db/core/utils/flat_index_map.h"
 #include "flex/engines/hqps_db/core/utils/hqps_utils.h"
 #include "flex/engines/hqps_db/core/utils/props.h"
+#include "flex/engines/hqps_db/core/utils/sampling.h"
 #include "flex/storages/rt_mutable_graph/types.h"
 #include "grape/utils/bitset.h"
 
@@ -98,33 +100,33 @@ class KeyedCollectionBuilder {
   using result_t = Collection<T>;
   KeyedCollectionBuilder() {}
 
-  KeyedCollectionBuilder(const Collection<T>& old) { vec_.reserve(old.Size()); }
+  KeyedCollectionBuilder(const Collection<T>& old) {
+    vec_.reserve(old.Size());
+    map_.reserve(old.Size());
+  }
 
   template <typename LabelT, typename VID_T, typename... TS>
   KeyedCollectionBuilder(
       const RowVertexSetImpl<LabelT, VID_T, TS...>& row_vertex_set) {
     vec_.reserve(row_vertex_set.Size());
+    map_.reserve(row_vertex_set.Size());
   }
 
   // insert returning a unique index for the inserted element
   size_t insert(const T& t) {
-    if (map_.find(t) == map_.end()) {
-      map_[t] = vec_.size();
+    auto res = map_.insert(t);
+    if (res.second) {
       vec_.push_back(t);
-      return vec_.size() - 1;
-    } else {
-      return map_[t];
     }
+    return res.first;
   }
 
   size_t insert(T&& t) {
-    if (map_.find(t) == map_.end()) {
-      map_[t] = vec_.size();
+    auto res = map_.insert(t);
+    if (res.second) {
       vec_.emplace_back(std::move(t));
-      return vec_.size() - 1;
-    } else {
-      return map_[t];
     }
+    return res.first;
   }
 
   size_t Insert(const std::tuple<size_t, T>& t) {
@@ -137,7 +139,7 @@ class KeyedCollectionBuilder {
   }
 
  private:
-  std::unordered_map<T, size_t, boost::hash<T>> map_;
+  FlatIndexMap<T> map_;
   std::vector<T> vec_;
 };
 
@@ -516,6 +518,45 @@ class DistinctCountBuilder<2, tag_id, T> {
   std::array<T, 2> min_v, max_v, range_size;
 };
 
+// Estimate the distinct number of recieved vertices, of a set of num_labels
+// labels, by a HyperLogLog sketch per key. Unlike DistinctCountBuilder, the
+// space per key does not grow with the range of the vids.
+template <size_t num_labels, int tag_id, typename T>
+class ApproxDistinctCountBuilder {
+ public:
+  ApproxDistinctCountBuilder() = default;
+
+  template <typename ELE_TUPLE_T, typename DATA_TUPLE>
+  void insert(size_t ind, const ELE_TUPLE_T& tuple, const DATA_TUPLE& data) {
+    auto& cur_ind_ele = gs::get_from_tuple<tag_id>(tuple);
+    uint64_t key;
+    if constexpr (num_labels == 1) {
+      key = std::get<1>(cur_ind_ele);
+    } else {
+      key = (static_cast<uint64_t>(std::get<1>(cur_ind_ele)) << 32) |
+            std::get<2>(cur_ind_ele);
+    }
+    if (vec_.size() <= ind) {
+      vec_.resize(ind + 1);
+    }
+    vec_[ind].Insert(mix_hash(key));
+  }
+
+  Collection<size_t> Build() {
+    std::vector<size_t> res;
+    res.reserve(vec_.size());
+    for (auto& sketch : vec_) {
+      res.emplace_back(sketch.Estimate());
+    }
+    VLOG(10) << "estimated distinct counts of " << res.size()
+             << " keys, relative error: " << HyperLogLog::RelativeError();
+    return Collection<size_t>(std::move(res));
+  }
+
+ private:
+  std::vector<HyperLogLog> vec_;
+};
+
 template <typename T, int tag_id>
 class SumBuilder {
  public:
@@ -550,7 +591,7 @@ class MinBuilder {
     vec_.resize(set.Size(), std::numeric_limits<T>::max());
   }
   MinBuilder() {}
-  MinBuilder(size_t cap) { vec_.resize(cap, (T) 0); }
+  MinBuilder(size_t cap) { vec_.resize(cap, std::numeric_limits<T>::max()); }
 
   // insert tuple at index ind.
   template <typename IND_ELE_TUPLE, typename DATA_TUPLE>
@@ -577,10 +618,10 @@ class MaxBuilder {
  public:
   MaxBuilder(const Collection<T>& set, const GI& graph,
              PropNameArray<T> prop_names) {
-    vec_.resize(set.Size(), std::numeric_limits<T>::min());
+    vec_.resize(set.Size(), std::numeric_limits<T>::lowest());
   }
   MaxBuilder() {}
-  MaxBuilder(size_t cap) { vec_.resize(cap, (T) 0); }
+  MaxBuilder(size_t cap) { vec_.resize(cap, std::numeric_limits<T>::lowest()); }
 
   // insert tuple at index ind.
   template <typename IND_ELE_TUPLE, typename DATA_TUPLE_T>
@@ -589,7 +630,7 @@ class MaxBuilder {
     const auto& cur_ind_ele = gs::get_from_tuple<tag_id>(tuple);
     // just count times.
     while (vec_.size() <= ind) {
-      vec_.emplace_back(std::numeric_limits<T>::max());
+      vec_.emplace_back(std::numeric_limits<T>::lowest());
     }
     vec_[ind] = std::max(vec_[ind], std::get<1>(cur_ind_ele));
   }
@@ -903,6 +944,68 @@ class CollectionOfVecBuilder<PropT, GRAPH_INTERFACE,
   PROP_GETTER_T prop_getter_;
 };
 
+// Aggregate one property of the vertices of a vertex set by key, e.g.
+// max(v.prop), keeping only the running value of each key rather than the
+// list of the values, as MinBuilder and MaxBuilder do for collections. Null
+// vertices are skipped, and a key without values gets PropT().
+template <AggFunc agg_func, typename PropT, typename GRAPH_INTERFACE,
+          typename SET_T, int tag_id>
+class VertexPropAggBuilder;
+
+template <AggFunc agg_func, typename PropT, typename GRAPH_INTERFACE,
+          typename LabelT, typename VID_T, typename... VERTEX_SET_TT,
+          int tag_id>
+class VertexPropAggBuilder<agg_func, PropT, GRAPH_INTERFACE,
+                           RowVertexSetImpl<LabelT, VID_T, VERTEX_SET_TT...>,
+                           tag_id> {
+ public:
+  static_assert(agg_func == AggFunc::SUM || agg_func == AggFunc::MIN ||
+                    agg_func == AggFunc::MAX,
+                "Only sum, min and max are aggregated inline");
+  using set_t = RowVertexSetImpl<LabelT, VID_T, VERTEX_SET_TT...>;
+  using graph_prop_getter_t =
+      typename GRAPH_INTERFACE::template single_prop_getter_t<PropT>;
+  using PROP_GETTER_T =
+      RowVertexSetPropGetter<tag_id, graph_prop_getter_t,
+                             typename set_t::index_ele_tuple_t>;
+  VertexPropAggBuilder(const set_t& set, const GRAPH_INTERFACE& graph,
+                       PropNameArray<PropT> prop_names)
+      : prop_getter_(create_prop_getter_impl<tag_id, PropT>(set, graph,
+                                                            prop_names[0])) {}
+
+  template <typename IND_TUPLE, typename DATA_TUPLE>
+  void insert(size_t ind, const IND_TUPLE& tuple, const DATA_TUPLE& data) {
+    while (vec_.size() <= ind) {
+      vec_.emplace_back();
+      valid_.emplace_back(false);
+    }
+    auto cur = gs::get_from_tuple<tag_id>(tuple);
+    using input_ele_t = typename std::remove_reference<decltype(cur)>::type;
+    if (NullRecordCreator<input_ele_t>::GetNull() == cur) {
+      return;
+    }
+    PropT value = prop_getter_.get_view(cur);
+    auto& acc = vec_[ind];
+    if (!valid_[ind]) {
+      acc = value;
+      valid_[ind] = true;
+    } else if constexpr (agg_func == AggFunc::SUM) {
+      acc += value;
+    } else if constexpr (agg_func == AggFunc::MIN) {
+      acc = std::min(acc, value);
+    } else {
+      acc = std::max(acc, value);
+    }
+  }
+
+  Collection<PropT> Build() { return Collection<PropT>(std::move(vec_)); }
+
+ private:
+  std::vector<PropT> vec_;
+  std::vector<bool> valid_;
+  PROP_GETTER_T prop_getter_;
+};
+
 }  // namespace gs
 
 #endif  // ENGINES_HQPS_DS_COLLECTION_H_
@@ -39,6 +39,7 @@ class AdjEdgeSetBuilder {
   using index_ele_tuple_t =
       std::tuple<size_t, VID_T, VID_T, std::tuple<EDATA_T...>>;
   using res_ele_tuple_t = std::tuple<VID_T, VID_T, std::tuple<EDATA_T...>>;
+  using columns_t = FlatEdgeColumns<VID_T, EDATA_T...>;
   using res_t = FlatEdgeSet<VID_T, LabelT, 1, EDATA_T...>;
 
  public:
@@ -53,18 +54,19 @@ class AdjEdgeSetBuilder {
         direction_(direc) {}
 
   void Insert(const index_ele_tuple_t& tuple) {
-    vec_.emplace_back(gs::remove_nth_element<0>(tuple));
+    columns_.EmplaceBack(std::get<1>(tuple), std::get<2>(tuple),
+                         std::get<3>(tuple));
   }
 
   res_t Build() {
-    std::vector<LabelT> label_vec(vec_.size());
+    std::vector<LabelT> label_vec(columns_.Size());
     std::fill(label_vec.begin(), label_vec.end(), src_label_);
-    return res_t(std::move(vec_), edge_label_, {src_label_}, dst_label_,
+    return res_t(std::move(columns_), edge_label_, {src_label_}, dst_label_,
                  prop_names_, std::move(label_vec), direction_);
   }
 
  private:
-  std::vector<res_ele_tuple_t> vec_;
+  columns_t columns_;
   LabelT src_label_, dst_label_, edge_label_;
   std::array<std::string, sizeof...(EDATA_T)> prop_names_;
   Direction direction_;
@@ -16,6 +16,8 @@
 #define ENGINES_HQPS_ENGINE_DS_MULTI_EDGE_SET_FLAT_EDGE_SET_H_
 
 #include <string>
+#include <tuple>
+#include <utility>
 #include <vector>
 
 #include "flex/engines/hqps_db/core/params.h"
@@ -29,11 +31,113 @@ namespace gs {
 template <typename VID_T, typename LabelT, size_t N, typename... EDATA_T>
 class FlatEdgeSet;
 
+// The edges of a FlatEdgeSet, stored by column: the srcs, the dsts, and one
+// vector per property. Reading one property of all edges, e.g. to project or
+// sort on it, is then a contiguous scan rather than a strided one over the
+// edge tuples, and builders append to each column.
+template <typename VID_T, typename... EDATA_T>
+class FlatEdgeColumns {
+ public:
+  using ele_tuple_t = std::tuple<VID_T, VID_T, std::tuple<EDATA_T...>>;
+  using props_t = std::tuple<std::vector<EDATA_T>...>;
+
+  FlatEdgeColumns() = default;
+
+  explicit FlatEdgeColumns(const std::vector<ele_tuple_t>& vec) {
+    Reserve(vec.size());
+    for (auto& ele : vec) {
+      EmplaceBack(ele);
+    }
+  }
+
+  void Reserve(size_t size) {
+    srcs_.reserve(size);
+    dsts_.reserve(size);
+    std::apply([size](auto&... cols) { (cols.reserve(size), ...); }, props_);
+  }
+
+  void EmplaceBack(VID_T src, VID_T dst, const std::tuple<EDATA_T...>& props) {
+    srcs_.emplace_back(src);
+    dsts_.emplace_back(dst);
+    emplace_props(props, std::index_sequence_for<EDATA_T...>());
+  }
+
+  void EmplaceBack(const ele_tuple_t& ele) {
+    EmplaceBack(std::get<0>(ele), std::get<1>(ele), std::get<2>(ele));
+  }
+
+  // The edges at inds, in order, copied column by column.
+  FlatEdgeColumns Gather(const std::vector<size_t>& inds) const {
+    FlatEdgeColumns res;
+    gather(srcs_, inds, res.srcs_);
+    gather(dsts_, inds, res.dsts_);
+    gather_props(inds, res, std::index_sequence_for<EDATA_T...>());
+    return res;
+  }
+
+  size_t Size() const { return srcs_.size(); }
+
+  VID_T GetSrc(size_t ind) const { return srcs_[ind]; }
+
+  VID_T GetDst(size_t ind) const { return dsts_[ind]; }
+
+  std::tuple<EDATA_T...> GetData(size_t ind) const {
+    return get_data(ind, std::index_sequence_for<EDATA_T...>());
+  }
+
+  ele_tuple_t GetElement(size_t ind) const {
+    return ele_tuple_t(srcs_[ind], dsts_[ind], GetData(ind));
+  }
+
+  const std::vector<VID_T>& GetSrcs() const { return srcs_; }
+
+  const std::vector<VID_T>& GetDsts() const { return dsts_; }
+
+  // The I-th property of all edges.
+  template <size_t I>
+  const auto& GetProp() const {
+    return std::get<I>(props_);
+  }
+
+ private:
+  template <size_t... Is>
+  void emplace_props(const std::tuple<EDATA_T...>& props,
+                     std::index_sequence<Is...>) {
+    (std::get<Is>(props_).emplace_back(std::get<Is>(props)), ...);
+  }
+
+  template <size_t... Is>
+  std::tuple<EDATA_T...> get_data(size_t ind,
+                                  std::index_sequence<Is...>) const {
+    return std::tuple<EDATA_T...>(std::get<Is>(props_)[ind]...);
+  }
+
+  template <typename COL_T>
+  static void gather(const COL_T& col, const std::vector<size_t>& inds,
+                     COL_T& res) {
+    res.reserve(inds.size());
+    for (auto ind : inds) {
+      res.emplace_back(col[ind]);
+    }
+  }
+
+  template <size_t... Is>
+  void gather_props(const std::vector<size_t>& inds, FlatEdgeColumns& res,
+                    std::index_sequence<Is...>) const {
+    (gather(std::get<Is>(props_), inds, std::get<Is>(res.props_)), ...);
+  }
+
+  std::vector<VID_T> srcs_;
+  std::vector<VID_T> dsts_;
+  props_t props_;
+};
+
 template <typename VID_T, typename LabelT, size_t N, typename... EDATA_T>
 class FlatEdgeSetBuilder {
  public:
   using ele_tuple_t = std::tuple<VID_T, VID_T, std::tuple<EDATA_T...>>;
   using index_ele_tuple_t = std::tuple<size_t, ele_tuple_t>;
+  using columns_t = FlatEdgeColumns<VID_T, EDATA_T...>;
   using result_t = FlatEdgeSet<VID_T, LabelT, N, EDATA_T...>;
 
   static constexpr bool is_flat_edge_set_builder = true;
@@ -56,7 +160,7 @@ class FlatEdgeSetBuilder {
 
   // There could be null record.
   void Insert(const index_ele_tuple_t& tuple) {
-    vec_.push_back(std::get<1>(tuple));
+    columns_.EmplaceBack(std::get<1>(tuple));
     if (!IsNull(std::get<1>(tuple))) {
       label_vec_new_.push_back(label_vec_[std::get<0>(tuple)]);
     } else {
@@ -65,12 +169,12 @@ class FlatEdgeSetBuilder {
   }
 
   result_t Build() {
-    return result_t(std::move(vec_), edge_label_, src_labels_, dst_label_,
+    return result_t(std::move(columns_), edge_label_, src_labels_, dst_label_,
                     prop_names_, std::move(label_vec_new_), direction_);
   }
 
  private:
-  std::vector<ele_tuple_t> vec_;
+  columns_t columns_;
   std::array<LabelT, N> src_labels_;
   LabelT dst_label_;
   LabelT edge_label_;
@@ -87,22 +191,21 @@ class FlatEdgeSetIter {
   using self_type_t = FlatEdgeSetIter<VID_T, EDATA_T...>;
   using index_ele_tuple_t = std::tuple<size_t, ele_tuple_t>;
   using data_tuple_t = ele_tuple_t;
-  FlatEdgeSetIter(const std::vector<ele_tuple_t>& vec, size_t ind)
-      : vec_(vec), ind_(ind) {}
+  using columns_t = FlatEdgeColumns<VID_T, EDATA_T...>;
+  FlatEdgeSetIter(const columns_t& columns, size_t ind)
+      : columns_(columns), ind_(ind) {}
 
-  ele_tuple_t GetElement() const { return vec_[ind_]; }
+  ele_tuple_t GetElement() const { return columns_.GetElement(ind_); }
 
   index_ele_tuple_t GetIndexElement() const {
     return std::make_tuple(ind_, GetElement());
   }
 
-  VID_T GetSrc() const { return std::get<0>(vec_[ind_]); }
+  VID_T GetSrc() const { return columns_.GetSrc(ind_); }
 
-  VID_T GetDst() const { return std::get<1>(vec_[ind_]); }
+  VID_T GetDst() const { return columns_.GetDst(ind_); }
 
-  const std::tuple<EDATA_T...>& GetData() const {
-    return std::get<2>(vec_[ind_]);
-  }
+  std::tuple<EDATA_T...> GetData() const { return columns_.GetData(ind_); }
 
   size_t GetIndex() const { return ind_; }
 
@@ -128,7 +231,7 @@ class FlatEdgeSetIter {
   inline const self_type_t* operator->() const { return this; }
 
  private:
-  const std::vector<ele_tuple_t>& vec_;
+  const columns_t& columns_;
   size_t ind_;
 };
 template <typename VID_T>
@@ -188,6 +291,7 @@ class FlatEdgeSet {
  public:
   using ele_tuple_t = std::tuple<VID_T, VID_T, std::tuple<EDATA_T...>>;
   using index_ele_tuple_t = std::tuple<size_t, ele_tuple_t>;
+  using columns_t = FlatEdgeColumns<VID_T, EDATA_T...>;
   using iterator = FlatEdgeSetIter<VID_T, EDATA_T...>;
   using self_type_t = FlatEdgeSet<VID_T, LabelT, N, EDATA_T...>;
   using flat_t = self_type_t;
@@ -200,34 +304,41 @@ class FlatEdgeSet {
   static constexpr bool is_multi_src = false;
   static constexpr bool is_multi_dst_label = false;
 
-  FlatEdgeSet(std::vector<ele_tuple_t>&& vec, LabelT edge_label,
+  FlatEdgeSet(columns_t&& columns, LabelT edge_label,
               std::array<LabelT, N> src_labels, LabelT dst_label,
               std::array<std::string, sizeof...(EDATA_T)> prop_names,
               std::vector<LabelT>&& label_vec, Direction direction)
-      : vec_(std::move(vec)),
+      : columns_(std::move(columns)),
         edge_label_(edge_label),
         src_labels_(src_labels),
         dst_label_(dst_label),
         prop_names_(prop_names),
         label_vec_(std::move(label_vec)),
         direction_(direction) {
-    CHECK(label_vec_.size() == vec_.size());
+    CHECK(label_vec_.size() == columns_.Size());
   }
 
-  iterator begin() const { return iterator(vec_, 0); }
+  FlatEdgeSet(std::vector<ele_tuple_t>&& vec, LabelT edge_label,
+              std::array<LabelT, N> src_labels, LabelT dst_label,
+              std::array<std::string, sizeof...(EDATA_T)> prop_names,
+              std::vector<LabelT>&& label_vec, Direction direction)
+      : FlatEdgeSet(columns_t(vec), edge_label, src_labels, dst_label,
+                    prop_names, std::move(label_vec), direction) {}
 
-  iterator end() const { return iterator(vec_, vec_.size()); }
+  iterator begin() const { return iterator(columns_, 0); }
+
+  iterator end() const { return iterator(columns_, columns_.Size()); }
 
   template <size_t col_ind, typename... index_ele_tuple_t_>
   flat_t Flat(
       std::vector<std::tuple<index_ele_tuple_t_...>>& index_ele_tuple) const {
-    std::vector<std::tuple<VID_T, VID_T, std::tuple<EDATA_T...>>> res;
+    columns_t res;
     std::vector<LabelT> label_vec;
-    res.reserve(index_ele_tuple.size());
+    res.Reserve(index_ele_tuple.size());
     label_vec.reserve(index_ele_tuple.size());
     for (auto i = 0; i < index_ele_tuple.size(); ++i) {
       auto cur_ind_ele = std::get<col_ind>(index_ele_tuple[i]);
-      res.emplace_back(std::get<1>(cur_ind_ele));
+      res.EmplaceBack(std::get<1>(cur_ind_ele));
       label_vec.emplace_back(label_vec_[std::get<0>(cur_ind_ele)]);
     }
     return FlatEdgeSet(std::move(res), edge_label_, src_labels_, dst_label_,
@@ -254,13 +365,13 @@ class FlatEdgeSet {
       if (prop_name == prop_names_[InnerIs]) {
         VLOG(10) << "Found builin property" << prop_names_[InnerIs];
         CHECK(repeat_array.size() == Size());
+        auto& col = columns_.template GetProp<InnerIs>();
         size_t prop_ind = 0;
-        for (auto i = 0; i < vec_.size(); ++i) {
+        for (auto i = 0; i < col.size(); ++i) {
           auto repeat_times = repeat_array[i];
           for (auto j = 0; j < repeat_times; ++j) {
             CHECK(prop_ind < tuples.size());
-            std::get<Is>(tuples[prop_ind]) =
-                std::get<InnerIs>(std::get<2>(vec_[i]));
+            std::get<Is>(tuples[prop_ind]) = col[i];
             prop_ind += 1;
           }
         }
@@ -300,12 +411,12 @@ class FlatEdgeSet {
   template <typename... PropT>
   void fillBuiltinProps(std::vector<std::tuple<PropT...>>& tuples,
                         const PropNameArray<PropT...>& prop_names) {
-    std::vector<size_t> repeat_array(vec_.size(), 1);
+    std::vector<size_t> repeat_array(Size(), 1);
     fillBuiltinPropsImpl(tuples, prop_names, repeat_array,
                          std::make_index_sequence<sizeof...(PropT)>());
   }
 
-  size_t Size() const { return vec_.size(); }
+  size_t Size() const { return columns_.Size(); }
 
   template <typename EXPR, size_t num_labels>
   std::pair<RowVertexSet<LabelT, VID_T, grape::EmptyType>, std::vector<size_t>>
@@ -324,9 +435,9 @@ class FlatEdgeSet {
       }
     }
     if (flag) {
-      for (auto iter : *this) {
-        vids.emplace_back(iter.GetDst());
-        offsets.emplace_back(vids.size());
+      vids = columns_.GetDsts();
+      for (size_t i = 1; i <= vids.size(); ++i) {
+        offsets.emplace_back(i);
       }
     } else {
       size_t size = Size();
@@ -343,7 +454,7 @@ class FlatEdgeSet {
             typename std::enable_if<Fs == -1>::type* = nullptr>
   self_type_t ProjectWithRepeatArray(const std::vector<size_t>& repeat_array,
                                      KeyAlias<tag_id, Fs>& key_alias) const {
-    std::vector<ele_tuple_t> new_vec;
+    std::vector<size_t> inds;
     std::vector<LabelT> new_label_vec;
     size_t next_size = 0;
     for (auto i = 0; i < repeat_array.size(); ++i) {
@@ -352,37 +463,38 @@ class FlatEdgeSet {
     VLOG(10) << "[FlatEdgeSet] size: " << Size()
              << " Project self, next size: " << next_size;
 
-    new_vec.reserve(next_size);
+    inds.reserve(next_size);
     new_label_vec.reserve(next_size);
 
     for (auto i = 0; i < repeat_array.size(); ++i) {
       for (auto j = 0; j < repeat_array[i]; ++j) {
-        new_vec.emplace_back(vec_[i]);
+        inds.emplace_back(i);
         new_label_vec.emplace_back(label_vec_[i]);
       }
     }
 
-    return self_type_t(std::move(new_vec), edge_label_, src_labels_, dst_label_,
-                       prop_names_, std::move(new_label_vec), direction_);
+    return self_type_t(columns_.Gather(inds), edge_label_, src_labels_,
+                       dst_label_, prop_names_, std::move(new_label_vec),
+                       direction_);
   }
 
   void Repeat(std::vector<offset_t>& cur_offset,
               std::vector<offset_t>& repeat_vec) {
     CHECK(cur_offset.size() == repeat_vec.size());
-    std::vector<ele_tuple_t> res_vec;
+    std::vector<size_t> inds;
     std::vector<LabelT> res_label_vec;
-    res_vec.reserve(repeat_vec.back());
+    inds.reserve(repeat_vec.back());
     res_label_vec.reserve(repeat_vec.back());
     for (auto i = 0; i + 1 < cur_offset.size(); ++i) {
       auto times_to_repeat = repeat_vec[i + 1] - repeat_vec[i];
       for (auto j = 0; j < times_to_repeat; ++j) {
         for (auto k = cur_offset[i]; k < cur_offset[i + 1]; ++k) {
-          res_vec.emplace_back(vec_[k]);
+          inds.emplace_back(k);
           res_label_vec.emplace_back(label_vec_[k]);
         }
       }
     }
-    vec_.swap(res_vec);
+    columns_ = columns_.Gather(inds);
     label_vec_.swap(res_label_vec);
   }
 
@@ -391,8 +503,11 @@ class FlatEdgeSet {
                      label_vec_, direction_);
   }
 
+  // The edges by column, e.g. to read one property of all of them.
+  const columns_t& GetColumns() const { return columns_; }
+
  private:
-  std::vector<ele_tuple_t> vec_;
+  columns_t columns_;
   std::array<LabelT, N> src_labels_;
   LabelT dst_label_, edge_label_;
   std::array<std::string, sizeof...(EDATA_T)> prop_names_;
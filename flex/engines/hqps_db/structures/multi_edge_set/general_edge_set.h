@@ -35,6 +35,7 @@ class GeneralEdgeSetBuilder<2, GI, VID_T, LabelT, T...> {
   using adj_list_iterator = typename adj_list_t::iterator;
   using ele_tuple_t = std::tuple<VID_T, VID_T, std::tuple<T...>>;
   using index_ele_tuple_t = std::tuple<size_t, VID_T, adj_list_iterator>;
+  using columns_t = FlatEdgeColumns<VID_T, T...>;
   using res_t = FlatEdgeSet<VID_T, LabelT, 2, T...>;
 
   static constexpr bool is_row_vertex_set_builder = false;
@@ -53,17 +54,16 @@ class GeneralEdgeSetBuilder<2, GI, VID_T, LabelT, T...> {
         src_labels_(src_labels),
         dst_label_(dst_label),
         direction_(dir) {
-    vec_.reserve(edge_size);
+    columns_.Reserve(edge_size);
+    label_vec_.reserve(edge_size);
   }
 
   void Insert(const index_ele_tuple_t& tuple) {
     // TODO: support inserting null record.
     auto ind = std::get<0>(tuple);
     auto src = std::get<1>(tuple);
-    auto adj_iter = std::get<2>(tuple);
-    auto dst = adj_iter.neighbor();
-    auto props = adj_iter.properties();
-    vec_.emplace_back(src, dst, props);
+    auto& adj_iter = std::get<2>(tuple);
+    columns_.EmplaceBack(src, adj_iter.neighbor(), adj_iter.properties());
     if (bitset_.get_bit(ind)) {
       label_vec_.emplace_back(src_labels_[0]);
     } else {
@@ -72,12 +72,12 @@ class GeneralEdgeSetBuilder<2, GI, VID_T, LabelT, T...> {
   }
 
   res_t Build() {
-    return res_t(std::move(vec_), edge_label_, src_labels_, dst_label_,
+    return res_t(std::move(columns_), edge_label_, src_labels_, dst_label_,
                  prop_names_, std::move(label_vec_), direction_);
   }
 
  private:
-  std::vector<ele_tuple_t> vec_;
+  columns_t columns_;
   std::vector<LabelT> label_vec_;
   std::array<std::string, num_props> prop_names_;
   LabelT edge_label_;
@@ -442,15 +442,15 @@ class GeneralEdgeSet<2, GI, VID_T, LabelT, T...> {
   template <size_t col_ind, typename... index_ele_tuple_t_>
   flat_t Flat(
       std::vector<std::tuple<index_ele_tuple_t_...>>& index_ele_tuple) const {
-    std::vector<std::tuple<VID_T, VID_T, std::tuple<T...>>> res;
-    res.reserve(index_ele_tuple.size());
+    typename flat_t::columns_t res;
+    res.Reserve(index_ele_tuple.size());
     std::vector<LabelT> label_vec(index_ele_tuple.size(), (LabelT) 0);
     for (auto i = 0; i < index_ele_tuple.size(); ++i) {
       auto cur_ind_ele = std::get<col_ind>(index_ele_tuple[i]);
       auto ind = std::get<0>(cur_ind_ele);
       auto nbr = std::get<2>(cur_ind_ele);
-      res.emplace_back(std::make_tuple(std::get<1>(cur_ind_ele),
-                                       nbr->neighbor(), nbr->properties()));
+      res.EmplaceBack(std::get<1>(cur_ind_ele), nbr->neighbor(),
+                      nbr->properties());
       if (!bitsets_.get_bit(ind)) {
         // label_vec[i] = 1;
         label_vec[i] = src_labels_[1];
@@ -25,6 +25,7 @@
 
 #include "flex/engines/hqps_db/core/utils/hqps_type.h"
 #include "flex/engines/hqps_db/core/utils/hqps_utils.h"
+#include "flex/engines/hqps_db/structures/multi_vertex_set/label_segments.h"
 
 namespace gs {
 
@@ -286,6 +287,11 @@ class GeneralVertexSet {
 
   const std::vector<VID_T>& GetVertices() const { return vec_; }
 
+  // The vertices of all labels in one pass, to be processed label by label.
+  LabelSegments<VID_T, N> GetLabelSegments() const {
+    return LabelSegments<VID_T, N>::FromBitsets(vec_, bitsets_);
+  }
+
   std::pair<std::vector<VID_T>, std::vector<int32_t>> GetVertices(
       size_t ind) const {
     CHECK(ind < N);
@@ -415,16 +421,12 @@ template <size_t num_labels>
 static std::array<std::vector<int32_t>, num_labels> bitsets_to_vids_inds(
     const std::array<grape::Bitset, num_labels>& bitset) {
   std::array<std::vector<int32_t>, num_labels> res;
-  auto limit_size = bitset[0].size();
+  auto limit_size = bitset[0].cardinality();
   VLOG(10) << "old bitset limit size: " << limit_size;
   for (auto i = 0; i < num_labels; ++i) {
-    auto count = bitset[i].count();
-    res[i].reserve(count);
-    for (auto j = 0; j < limit_size; ++j) {
-      if (bitset[i].get_bit(j)) {
-        res[i].emplace_back(j);
-      }
-    }
+    res[i].reserve(bitset[i].count());
+    foreach_tagged(bitset[i], limit_size, false,
+                   [&res, i](size_t j) { res[i].emplace_back(j); });
   }
   {
     size_t cnt = 0;
@@ -19,10 +19,10 @@
 
 #include <memory>
 #include <string>
-#include <unordered_map>
 #include <vector>
 
 #include "flex/engines/hqps_db/core/params.h"
+#include "flex/engines/hqps_db/core/utils/flat_index_map.h"
 #include "flex/engines/hqps_db/core/utils/hqps_utils.h"
 #include "flex/engines/hqps_db/structures/multi_vertex_set/row_vertex_set.h"
 #include "flex/storages/rt_mutable_graph/types.h"
@@ -918,31 +918,31 @@ class KeyedRowVertexSetBuilderImpl {
   KeyedRowVertexSetBuilderImpl(const RowVertexSet<LabelT, VID_T, T...>& old_set)
       : label_(old_set.GetLabel()),
         prop_names_(old_set.GetPropNames()),
-        ind_(0) {}
+        ind_(0) {
+    prop2ind_.reserve(old_set.Size());
+  }
 
   size_t insert(std::tuple<size_t, VID_T> ele_tuple, data_tuple_t data_tuple) {
     auto key = std::get<1>(ele_tuple);
-    if (prop2ind_.find(key) != prop2ind_.end()) {
-      return prop2ind_[key];
-    } else {
-      prop2ind_[key] = ind_;
+    auto res = prop2ind_.insert(key);
+    if (res.second) {
       keys_.emplace_back(key);
       vids_.emplace_back(key);
       datas_.emplace_back(data_tuple);
-      return ind_++;
+      ++ind_;
     }
+    return res.first;
   }
 
   size_t insert(const VID_T& key, data_tuple_t data_tuple) {
-    if (prop2ind_.find(key) != prop2ind_.end()) {
-      return prop2ind_[key];
-    } else {
-      prop2ind_[key] = ind_;
+    auto res = prop2ind_.insert(key);
+    if (res.second) {
       keys_.emplace_back(key);
       vids_.emplace_back(key);
       datas_.emplace_back(data_tuple);
-      return ind_++;
+      ++ind_;
     }
+    return res.first;
   }
 
   size_t insert(const std::tuple<VID_T, data_tuple_t>& ele_tuple) {
@@ -958,7 +958,7 @@ class KeyedRowVertexSetBuilderImpl {
   LabelT label_;
   // Keep the mapping from lid to ind. So we can directly make the lids
   // array when building.
-  std::unordered_map<key_t, size_t> prop2ind_;
+  FlatIndexMap<key_t, std::hash<key_t>> prop2ind_;
   std::vector<key_t> keys_;
   std::vector<lid_t> vids_;
   std::vector<data_tuple_t> datas_;
@@ -978,29 +978,29 @@ class KeyedRowVertexSetBuilderImpl<LabelT, KEY_T, VID_T, grape::EmptyType> {
 
   KeyedRowVertexSetBuilderImpl(
       const RowVertexSet<LabelT, VID_T, grape::EmptyType>& old_set)
-      : label_(old_set.GetLabel()), ind_(0) {}
+      : label_(old_set.GetLabel()), ind_(0) {
+    prop2ind_.reserve(old_set.Size());
+  }
 
   size_t insert(std::tuple<size_t, VID_T> ele_tuple) {
     auto key = std::get<1>(ele_tuple);
-    if (prop2ind_.find(key) != prop2ind_.end()) {
-      return prop2ind_[key];
-    } else {
-      prop2ind_[key] = ind_;
+    auto res = prop2ind_.insert(key);
+    if (res.second) {
       keys_.emplace_back(key);
       vids_.emplace_back(key);
-      return ind_++;
+      ++ind_;
     }
+    return res.first;
   }
 
   size_t insert(const VID_T& key) {
-    if (prop2ind_.find(key) != prop2ind_.end()) {
-      return prop2ind_[key];
-    } else {
-      prop2ind_[key] = ind_;
+    auto res = prop2ind_.insert(key);
+    if (res.second) {
       keys_.emplace_back(key);
       vids_.emplace_back(key);
-      return ind_++;
+      ++ind_;
     }
+    return res.first;
   }
 
   build_res_t Build() {
@@ -1011,7 +1011,7 @@ class KeyedRowVertexSetBuilderImpl<LabelT, KEY_T, VID_T, grape::EmptyType> {
   LabelT label_;
   // Keep the mapping from lid to ind. So we can directly make the lids
   // array when building.
-  std::unordered_map<key_t, size_t> prop2ind_;
+  FlatIndexMap<key_t, std::hash<key_t>> prop2ind_;
   std::vector<key_t> keys_;
   std::vector<lid_t> vids_;
   size_t ind_;
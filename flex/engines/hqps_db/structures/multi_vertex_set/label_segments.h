@@ -0,0 +1,124 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef ENGINES_HQPS_DS_MULTI_VERTEX_SET_LABEL_SEGMENTS_H_
+#define ENGINES_HQPS_DS_MULTI_VERTEX_SET_LABEL_SEGMENTS_H_
+
+#include <array>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "glog/logging.h"
+#include "grape/utils/bitset.h"
+
+namespace gs {
+
+// Call f(i) for each i below size whose bit is set, or unset if flip, in
+// order, skipping the empty words.
+template <typename FUNC_T>
+void foreach_tagged(const grape::Bitset& bitset, size_t size, bool flip,
+                    const FUNC_T& f) {
+  for (size_t begin = 0; begin < size; begin += 64) {
+    uint64_t word = bitset.get_word(begin);
+    if (flip) {
+      word = ~word;
+    }
+    if (size - begin < 64) {
+      word &= (1ul << (size - begin)) - 1;
+    }
+    while (word != 0) {
+      f(begin + __builtin_ctzll(word));
+      word &= word - 1;
+    }
+  }
+}
+
+// The vertices of a set with N labels, regrouped into one run per label: the
+// i-th run has the vids of the i-th label, and the indices they have in the
+// set, both in set order. The set itself keeps its order, which the other
+// columns of a context are aligned to, so per-label work, e.g. fetching
+// neighbors or properties, is done on the runs as on single-label sets, and
+// scattered back by the indices.
+//
+// It is built by one scan of the label tags of the set, word by word, for all
+// labels, instead of a scan per label.
+template <typename VID_T, size_t N>
+class LabelSegments {
+ public:
+  // For GeneralVertexSet, whose i-th bitset tags the vertices of label i.
+  static LabelSegments FromBitsets(
+      const std::vector<VID_T>& vec,
+      const std::array<grape::Bitset, N>& bitsets) {
+    LabelSegments res;
+    for (size_t i = 0; i < N; ++i) {
+      res.collect(vec, bitsets[i], false, i);
+    }
+    return res;
+  }
+
+  // For TwoLabelVertexSet, whose set bits tag label 0, and the others label 1.
+  static LabelSegments FromBitset(const std::vector<VID_T>& vec,
+                                  const grape::Bitset& bitset) {
+    static_assert(N == 2, "a single bitset tags two labels");
+    LabelSegments res;
+    res.collect(vec, bitset, false, 0);
+    res.collect(vec, bitset, true, 1);
+    return res;
+  }
+
+  size_t Size(size_t label_ind) const { return vids_[label_ind].size(); }
+
+  // The vids of the label, in set order.
+  const std::vector<VID_T>& GetVertices(size_t label_ind) const {
+    return vids_[label_ind];
+  }
+
+  // The indices in the set of the vids of the label.
+  const std::vector<int32_t>& GetIndices(size_t label_ind) const {
+    return inds_[label_ind];
+  }
+
+  // Move the run of a label out, e.g. to be passed on as a vertex list.
+  std::pair<std::vector<VID_T>, std::vector<int32_t>> Release(
+      size_t label_ind) {
+    return std::make_pair(std::move(vids_[label_ind]),
+                          std::move(inds_[label_ind]));
+  }
+
+ private:
+  // Append the vertices whose bit is set, or unset if flip, to the run of
+  // label_ind.
+  void collect(const std::vector<VID_T>& vec, const grape::Bitset& bitset,
+               bool flip, size_t label_ind) {
+    size_t size = vec.size();
+    CHECK(bitset.cardinality() == size);
+    size_t cnt = flip ? size - bitset.count() : bitset.count();
+    auto& vids = vids_[label_ind];
+    auto& inds = inds_[label_ind];
+    vids.reserve(cnt);
+    inds.reserve(cnt);
+    foreach_tagged(bitset, size, flip, [&](size_t i) {
+      vids.emplace_back(vec[i]);
+      inds.emplace_back(static_cast<int32_t>(i));
+    });
+  }
+
+  std::array<std::vector<VID_T>, N> vids_;
+  std::array<std::vector<int32_t>, N> inds_;
+};
+
+}  // namespace gs
+
+#endif  // ENGINES_HQPS_DS_MULTI_VERTEX_SET_LABEL_SEGMENTS_H_
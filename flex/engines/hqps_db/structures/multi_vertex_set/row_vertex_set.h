@@ -19,6 +19,7 @@
 #include <tuple>
 #include <vector>
 
+#include "flex/engines/hqps_db/core/utils/dedup.h"
 #include "flex/engines/hqps_db/structures/collection.h"
 #include "grape/util.h"
 
@@ -361,49 +362,46 @@ std::vector<offset_t> RowSetDedupImpl(
     const std::vector<lid_t>& ori_lids,
     const std::vector<data_tuple_t>& ori_datas, std::vector<lid_t>& res_lids,
     std::vector<data_tuple_t>& res_datas) {
-  std::vector<offset_t> offsets;
   VLOG(10) << "lid size" << ori_lids.size();
-  offsets.reserve(ori_lids.size());
-
-  // TODO: replace with bitset.
-  std::unordered_map<lid_t, size_t> v2lid;
+  auto firsts = mark_first_occurrences(ori_lids);
+  std::vector<offset_t> offsets;
+  offsets.reserve(ori_lids.size() + 1);
   size_t cnt = 0;
   for (auto i = 0; i < ori_lids.size(); ++i) {
     offsets.emplace_back(cnt);
-    auto ret = v2lid.insert({ori_lids[i], i});
-    if (ret.second == true) {
-      cnt += 1;
+    cnt += firsts[i];
+  }
+  offsets.emplace_back(cnt);
+  res_lids.reserve(cnt);
+  res_datas.reserve(cnt);
+  for (auto i = 0; i < ori_lids.size(); ++i) {
+    if (firsts[i]) {
       res_lids.emplace_back(ori_lids[i]);
       res_datas.emplace_back(ori_datas[i]);
     }
   }
-  offsets.emplace_back(cnt);
-
-  // VLOG(10) << "in dedup: offsets: " << gs::to_string(offsets);
-  // VLOG(10) << "in dedup: vids : " << gs::to_string(res_lids);
   return offsets;
 }
 
 template <typename lid_t>
 std::vector<offset_t> RowSetDedupImpl(const std::vector<lid_t>& ori_lids,
                                       std::vector<lid_t>& res_lids) {
-  std::vector<offset_t> offsets;
   VLOG(10) << "lid size" << ori_lids.size();
-  offsets.reserve(ori_lids.size());
-
-  // TODO: replace with bitset.
-  std::unordered_map<lid_t, size_t> v2lid;
+  auto firsts = mark_first_occurrences(ori_lids);
+  std::vector<offset_t> offsets;
+  offsets.reserve(ori_lids.size() + 1);
   size_t cnt = 0;
   for (auto i = 0; i < ori_lids.size(); ++i) {
     offsets.emplace_back(cnt);
-    auto ret = v2lid.insert({ori_lids[i], i});
-    if (ret.second == true) {
-      cnt += 1;
+    cnt += firsts[i];
+  }
+  offsets.emplace_back(cnt);
+  res_lids.reserve(cnt);
+  for (auto i = 0; i < ori_lids.size(); ++i) {
+    if (firsts[i]) {
       res_lids.emplace_back(ori_lids[i]);
     }
   }
-  offsets.emplace_back(cnt);
-
   return offsets;
 }
 
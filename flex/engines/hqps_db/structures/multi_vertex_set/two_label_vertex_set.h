@@ -20,6 +20,8 @@
 #include <unordered_set>
 #include <vector>
 
+#include "flex/engines/hqps_db/core/utils/dedup.h"
+#include "flex/engines/hqps_db/structures/multi_vertex_set/label_segments.h"
 #include "grape/util.h"
 #include "grape/utils/bitset.h"
 
@@ -490,6 +492,29 @@ auto twoLabelSetFlatImpl(
                          std::move(res_bitset));
 }
 
+// Mark the first occurrence of each vertex, as a vid of either label, and
+// get the offsets of the old elements to the deduped ones.
+template <typename VID_T>
+std::pair<std::vector<uint8_t>, std::vector<offset_t>> twoLabelSetDedupImpl(
+    const std::vector<VID_T>& vec, const grape::Bitset& bitset) {
+  std::vector<uint64_t> keys;
+  keys.reserve(vec.size());
+  for (size_t i = 0; i < vec.size(); ++i) {
+    keys.emplace_back((static_cast<uint64_t>(vec[i]) << 1) |
+                      (bitset.get_bit(i) ? 0 : 1));
+  }
+  auto firsts = mark_first_occurrences(keys);
+  std::vector<offset_t> offsets;
+  offsets.reserve(vec.size() + 1);
+  size_t cnt = 0;
+  for (size_t i = 0; i < vec.size(); ++i) {
+    offsets.emplace_back(cnt);
+    cnt += firsts[i];
+  }
+  offsets.emplace_back(cnt);
+  return std::make_pair(std::move(firsts), std::move(offsets));
+}
+
 template <typename VID_T, typename... T>
 class TwoLabelVertexSetIter {
  public:
@@ -758,6 +783,11 @@ class TwoLabelVertexSetImpl {
     return named_property_;
   }
 
+  // The vertices of both labels in one pass, to be processed label by label.
+  LabelSegments<VID_T, 2> GetLabelSegments() const {
+    return LabelSegments<VID_T, 2>::FromBitset(vec_, bitset_);
+  }
+
   std::pair<std::vector<VID_T>, std::vector<int32_t>> GetVertices(
       size_t ind) const {
     CHECK(ind < 2);
@@ -900,6 +930,32 @@ class TwoLabelVertexSetImpl {
     LOG(FATAL) << "Not implemented";
   }
 
+  // all dedup are done inplace
+  std::vector<offset_t> Dedup() {
+    auto firsts_and_offsets = twoLabelSetDedupImpl(vec_, bitset_);
+    auto& firsts = firsts_and_offsets.first;
+    size_t cnt = firsts_and_offsets.second.back();
+    std::vector<VID_T> new_vec;
+    std::vector<std::tuple<T...>> new_data_tuple;
+    grape::Bitset new_bitset;
+    new_vec.reserve(cnt);
+    new_data_tuple.reserve(cnt);
+    new_bitset.init(cnt);
+    for (size_t i = 0; i < vec_.size(); ++i) {
+      if (firsts[i]) {
+        if (bitset_.get_bit(i)) {
+          new_bitset.set_bit(new_vec.size());
+        }
+        new_vec.emplace_back(vec_[i]);
+        new_data_tuple.emplace_back(data_tuple_[i]);
+      }
+    }
+    vec_.swap(new_vec);
+    data_tuple_.swap(new_data_tuple);
+    bitset_.swap(new_bitset);
+    return std::move(firsts_and_offsets.second);
+  }
+
   size_t Size() const { return vec_.size(); }
 
  private:
@@ -1016,6 +1072,11 @@ class TwoLabelVertexSetImpl<VID_T, LabelT, grape::EmptyType> {
 
   std::vector<VID_T>& GetMutableVertices() { return vec_; }
 
+  // The vertices of both labels in one pass, to be processed label by label.
+  LabelSegments<VID_T, 2> GetLabelSegments() const {
+    return LabelSegments<VID_T, 2>::FromBitset(vec_, bitset_);
+  }
+
   std::pair<std::vector<VID_T>, std::vector<int32_t>> GetVertices(
       size_t ind) const {
     CHECK(ind < 2);
@@ -1190,6 +1251,28 @@ class TwoLabelVertexSetImpl<VID_T, LabelT, grape::EmptyType> {
     VLOG(10) << "Finish repeat on two label set";
   }
 
+  // all dedup are done inplace
+  std::vector<offset_t> Dedup() {
+    auto firsts_and_offsets = twoLabelSetDedupImpl(vec_, bitset_);
+    auto& firsts = firsts_and_offsets.first;
+    size_t cnt = firsts_and_offsets.second.back();
+    std::vector<VID_T> new_vec;
+    grape::Bitset new_bitset;
+    new_vec.reserve(cnt);
+    new_bitset.init(cnt);
+    for (size_t i = 0; i < vec_.size(); ++i) {
+      if (firsts[i]) {
+        if (bitset_.get_bit(i)) {
+          new_bitset.set_bit(new_vec.size());
+        }
+        new_vec.emplace_back(vec_[i]);
+      }
+    }
+    vec_.swap(new_vec);
+    bitset_.swap(new_bitset);
+    return std::move(firsts_and_offsets.second);
+  }
+
   size_t Size() const { return vec_.size(); }
 
  private:
@@ -16,56 +16,80 @@ limitations under the License.
 #ifndef GRAPHSCOPE_DS_PATH_H_
 #define GRAPHSCOPE_DS_PATH_H_
 
+#include <algorithm>
 #include <memory>
+#include <sstream>
 #include <string>
+#include <tuple>
+#include <utility>
 #include <vector>
 
+#include "glog/logging.h"
+
 namespace gs {
 
 // Path Set contains all vertices and edges along each path.
 // Note that path doesn't have to be full length.
 // i.e. :[1], [1,2], [1,2,3]
 
-// Assumes all path share same label
+// A view of a path in a PathSet, valid until the set is modified or
+// destroyed. label_ids_ points to the label of each vertex, or is null when
+// all vertices are of label_id_.
 template <typename VID_T>
 struct Path {
-  std::vector<VID_T> vids_;
-  std::vector<int32_t> label_ids_;
+  const VID_T* vids_;
+  const int32_t* label_ids_;
+  size_t size_;
+  int32_t label_id_;
+
+  Path(const VID_T* vids, const int32_t* label_ids, size_t size,
+       int32_t label_id)
+      : vids_(vids), label_ids_(label_ids), size_(size), label_id_(label_id) {}
+
+  size_t length() const { return size_ - 1; }
+
+  size_t Size() const { return size_; }
+
+  VID_T GetVertex(size_t i) const { return vids_[i]; }
 
-  Path(std::vector<VID_T>&& vids, std::vector<int32_t>&& label_ids)
-      : vids_(std::move(vids)), label_ids_(std::move(label_ids)) {}
+  int32_t GetLabelId(size_t i) const {
+    return label_ids_ == nullptr ? label_id_ : label_ids_[i];
+  }
 
-  size_t length() const { return vids_.size() - 1; }
+  const VID_T* begin() const { return vids_; }
 
-  const std::vector<VID_T>& GetVertices() const { return vids_; }
+  const VID_T* end() const { return vids_ + size_; }
 
   std::string to_string() const {
     std::stringstream ss;
-    for (auto i = 0; i < vids_.size() - 1; ++i) {
+    for (size_t i = 0; i + 1 < size_; ++i) {
       ss << vids_[i] << "->";
     }
-    ss << vids_[vids_.size() - 1];
+    ss << vids_[size_ - 1];
     return ss.str();
   }
 };
 
+template <typename VID_T, typename LabelT>
+class PathSet;
+
 template <typename VID_T, typename LabelT>
 class PathSetIter {
  public:
   using self_type_t = PathSetIter<VID_T, LabelT>;
-  using index_ele_tuple_t = std::pair<size_t, const Path<VID_T>&>;
+  using index_ele_tuple_t = std::pair<size_t, Path<VID_T>>;
 
-  PathSetIter(const std::vector<Path<VID_T>>& paths, size_t ind)
+  PathSetIter(const PathSet<VID_T, LabelT>& paths, size_t ind)
       : paths_(paths), ind_(ind) {}
 
-  const Path<VID_T>& GetElement() const { return paths_[ind_]; }
+  Path<VID_T> GetElement() const { return paths_.get(ind_); }
 
   std::tuple<Path<VID_T>> GetData() const {
-    return std::make_tuple(paths_[ind_]);
+    return std::make_tuple(paths_.get(ind_));
   }
 
   index_ele_tuple_t GetIndexElement() const {
-    return std::make_tuple(ind_, paths_[ind_]);
+    return std::make_pair(ind_, paths_.get(ind_));
   }
 
   inline const self_type_t& operator++() {
@@ -91,10 +115,14 @@ class PathSetIter {
   inline const self_type_t* operator->() const { return this; }
 
  private:
-  const std::vector<Path<VID_T>>& paths_;
+  const PathSet<VID_T, LabelT>& paths_;
   size_t ind_;
 };
 
+// The vertices of all paths are kept in one buffer, the i-th path being
+// vids_[offsets_[i], offsets_[i + 1]), so that no path allocates on its own.
+// The label ids, i.e. indices into labels_, are kept per set while all
+// vertices share one, and then per path or per vertex once they do not.
 template <typename VID_T, typename LabelT>
 class PathSet {
  public:
@@ -102,28 +130,107 @@ class PathSet {
   using self_type_t = PathSet<VID_T, LabelT>;
   using iterator = PathSetIter<VID_T, LabelT>;
   using data_tuple_t = std::tuple<Path<VID_T>>;
-  using index_ele_tuple_t = std::pair<size_t, const Path<VID_T>&>;
-  PathSet(std::vector<LabelT>&& labels) : labels_(std::move(labels)){};
+  using index_ele_tuple_t = std::pair<size_t, Path<VID_T>>;
 
-  PathSet(std::vector<Path<VID_T>>&& paths, std::vector<LabelT>&& labels)
-      : paths_(std::move(paths)), labels_(std::move(labels)) {}
+  PathSet(std::vector<LabelT>&& labels)
+      : labels_(std::move(labels)),
+        offsets_{0},
+        encoding_(LabelEncoding::kPerSet),
+        label_id_(0) {}
 
-  void EmplacePath(Path<VID_T>&& path) { paths_.emplace_back(std::move(path)); }
+  void Reserve(size_t path_num, size_t vertex_num) {
+    offsets_.reserve(path_num + 1);
+    vids_.reserve(vertex_num);
+  }
 
-  const Path<VID_T>& get(size_t i) const {
-    CHECK(i < paths_.size());
-    return paths_[i];
+  // Append a path whose vertices are all of labels_[label_id].
+  void EmplacePath(const std::vector<VID_T>& vids, int32_t label_id = 0) {
+    CHECK(!vids.empty());
+    if (encoding_ == LabelEncoding::kPerSet && label_id != label_id_) {
+      if (Size() == 0) {
+        label_id_ = label_id;
+      } else {
+        path_label_ids_.assign(Size(), label_id_);
+        encoding_ = LabelEncoding::kPerPath;
+      }
+    }
+    if (encoding_ == LabelEncoding::kPerPath) {
+      path_label_ids_.push_back(label_id);
+    } else if (encoding_ == LabelEncoding::kPerHop) {
+      hop_label_ids_.insert(hop_label_ids_.end(), vids.size(), label_id);
+    }
+    vids_.insert(vids_.end(), vids.begin(), vids.end());
+    offsets_.push_back(vids_.size());
   }
 
-  size_t Size() const { return paths_.size(); }
+  // Append a path with the label of each vertex.
+  void EmplacePath(const std::vector<VID_T>& vids,
+                   const std::vector<int32_t>& label_ids) {
+    CHECK(!vids.empty());
+    CHECK(vids.size() == label_ids.size());
+    for (auto label_id : label_ids) {
+      if (label_id != label_ids[0]) {
+        if (encoding_ != LabelEncoding::kPerHop) {
+          to_per_hop();
+        }
+        hop_label_ids_.insert(hop_label_ids_.end(), label_ids.begin(),
+                              label_ids.end());
+        vids_.insert(vids_.end(), vids.begin(), vids.end());
+        offsets_.push_back(vids_.size());
+        return;
+      }
+    }
+    EmplacePath(vids, label_ids[0]);
+  }
+
+  Path<VID_T> get(size_t i) const {
+    CHECK(i < Size());
+    size_t begin = offsets_[i];
+    size_t size = offsets_[i + 1] - begin;
+    if (encoding_ == LabelEncoding::kPerHop) {
+      return Path<VID_T>(vids_.data() + begin, hop_label_ids_.data() + begin,
+                         size, 0);
+    } else if (encoding_ == LabelEncoding::kPerPath) {
+      return Path<VID_T>(vids_.data() + begin, nullptr, size,
+                         path_label_ids_[i]);
+    }
+    return Path<VID_T>(vids_.data() + begin, nullptr, size, label_id_);
+  }
+
+  const std::vector<LabelT>& GetLabels() const { return labels_; }
 
-  iterator begin() const { return iterator(paths_, 0); }
+  size_t Size() const { return offsets_.size() - 1; }
 
-  iterator end() const { return iterator(paths_, paths_.size()); }
+  iterator begin() const { return iterator(*this, 0); }
+
+  iterator end() const { return iterator(*this, Size()); }
 
  private:
+  enum class LabelEncoding : uint8_t { kPerSet, kPerPath, kPerHop };
+
+  void to_per_hop() {
+    hop_label_ids_.resize(vids_.size(), label_id_);
+    if (encoding_ == LabelEncoding::kPerPath) {
+      for (size_t i = 0; i < Size(); ++i) {
+        std::fill(hop_label_ids_.begin() + offsets_[i],
+                  hop_label_ids_.begin() + offsets_[i + 1],
+                  path_label_ids_[i]);
+      }
+      std::vector<int32_t>().swap(path_label_ids_);
+    }
+    encoding_ = LabelEncoding::kPerHop;
+  }
+
   std::vector<LabelT> labels_;
-  std::vector<Path<VID_T>> paths_;
+  std::vector<VID_T> vids_;
+  std::vector<size_t> offsets_;
+  LabelEncoding encoding_;
+  // the label id of all vertices, for kPerSet
+  int32_t label_id_;
+  // the label id of each path, for kPerPath
+  std::vector<int32_t> path_label_ids_;
+  // the label id of each vertex, for kPerHop
+  std::vector<int32_t> hop_label_ids_;
 };
 
 template <typename VID_T, typename LabelT>
@@ -15,11 +15,26 @@
 #ifndef ENGINES_HQPS_SERVER_CODEGEN_PROXY_H_
 #define ENGINES_HQPS_SERVER_CODEGEN_PROXY_H_
 
+#include <condition_variable>
+#include <deque>
 #include <filesystem>
 #include <fstream>
+#include <functional>
+#include <list>
+#include <mutex>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
+
+#include <seastar/core/alien.hh>
+#include <seastar/core/future.hh>
+#include <seastar/core/smp.hh>
+
 #include "glog/logging.h"
 
 #include "proto_generated_gie/job_service.pb.h"
@@ -32,44 +47,84 @@ namespace server {
 
 class CodegenProxy {
  public:
+  using gen_result_t = std::pair<int32_t, std::string>;
+
   static CodegenProxy& get();
-  CodegenProxy() : initialized_(false){};
+  CodegenProxy() : initialized_(false), stopped_(false){};
 
-  ~CodegenProxy() = default;
+  ~CodegenProxy() {
+    {
+      std::unique_lock<std::mutex> lock(cache_mutex_);
+      stopped_ = true;
+    }
+    tasks_cv_.notify_all();
+    for (auto& worker : workers_) {
+      worker.join();
+    }
+  }
 
   bool Initialized() { return initialized_; }
 
+  // Compiles run on compile_thread_num threads of their own, so that the
+  // shards keep serving other queries meanwhile.
   void Init(std::string working_dir, std::string codegen_bin,
-            std::string db_home) {
+            std::string db_home, size_t compile_thread_num = 1) {
     working_directory_ = working_dir;
     codegen_bin_ = codegen_bin;
     db_home_ = db_home;
+    for (size_t i = 0; i < std::max<size_t>(compile_thread_num, 1); ++i) {
+      workers_.emplace_back([this]() { compile_worker(); });
+    }
     initialized_ = true;
     LOG(INFO) << "CodegenProxy working dir: " << working_directory_
-              << ",codegen bin " << codegen_bin_ << ", db_home: " << db_home_;
+              << ",codegen bin " << codegen_bin_ << ", db_home: " << db_home_
+              << ", compile threads: " << workers_.size();
   }
 
-  // Do gen
-  std::optional<std::pair<int32_t, std::string>> do_gen(
-      const physical::PhysicalPlan& plan) {
-    LOG(INFO) << "Start generating for query: ";
-    auto next_job_id = getNextJobId();
-    auto work_dir = get_work_directory(next_job_id);
-    auto query_name = "query_" + std::to_string(next_job_id);
-    std::string plan_path = prepare_next_job_dir(work_dir, query_name, plan);
-    if (plan_path.empty()) {
-      return {};
+  // Do gen, or reuse the library compiled for the same plan before. Plans
+  // being compiled already are waited for instead of compiled twice. Must be
+  // called on a shard, the future is resolved on the same shard.
+  seastar::future<gen_result_t> do_gen(physical::PhysicalPlan&& plan) {
+    std::string key = serialize_plan(plan);
+    std::unique_lock<std::mutex> lock(cache_mutex_);
+    auto it = cache_.find(key);
+    if (it != cache_.end() && !it->second->second.compiling) {
+      auto entry = it->second;
+      lru_.splice(lru_.begin(), lru_, entry);
+      LOG(INFO) << "Reuse compiled query: " << entry->second.job_id;
+      return seastar::make_ready_future<gen_result_t>(entry->second.job_id,
+                                                      entry->second.lib_path);
     }
 
-    std::string res_lib_path =
-        call_codegen_cmd(plan_path, query_name, work_dir);
-
-    // check res_lib_path exists
-    if (!std::filesystem::exists(res_lib_path)) {
-      LOG(ERROR) << "res lib path " << res_lib_path << " not exists";
-      return {};
+    auto pr = new seastar::promise<gen_result_t>();
+    auto fut = pr->get_future();
+    auto shard = seastar::this_shard_id();
+    auto waiter = [pr, shard](int32_t job_id, const std::string& lib_path) {
+      seastar::alien::run_on(
+          *seastar::alien::internal::default_instance, shard,
+          [pr, job_id, lib_path]() noexcept {
+            if (lib_path.empty()) {
+              pr->set_exception(std::runtime_error("Fail to generate query"));
+            } else {
+              pr->set_value(std::make_pair(job_id, lib_path));
+            }
+            delete pr;
+          });
+    };
+    if (it != cache_.end()) {
+      it->second->second.waiters.emplace_back(std::move(waiter));
+      return fut;
     }
-    return std::make_pair(next_job_id, res_lib_path);
+
+    auto next_job_id = getNextJobId();
+    lru_.emplace_front(std::move(key), CachedQuery{next_job_id, "", true, {}});
+    auto entry = lru_.begin();
+    entry->second.waiters.emplace_back(std::move(waiter));
+    cache_.emplace(entry->first, entry);
+    tasks_.emplace_back(std::move(plan), entry);
+    lock.unlock();
+    tasks_cv_.notify_one();
+    return fut;
   }
 
   std::string call_codegen_cmd(const std::string& plan_path,
@@ -89,8 +144,99 @@ class CodegenProxy {
   }
 
  private:
+  // Number of compiled queries kept for reuse.
+  static constexpr size_t kMaxCachedQueryNum = 256;
+
+  struct CachedQuery {
+    int32_t job_id;
+    std::string lib_path;
+    bool compiling;
+    // called with the result once compiled, with an empty path on failure
+    std::vector<std::function<void(int32_t, const std::string&)>> waiters;
+  };
+
+  using cache_list_t = std::list<std::pair<std::string, CachedQuery>>;
+
+  void compile_worker() {
+    std::unique_lock<std::mutex> lock(cache_mutex_);
+    while (true) {
+      tasks_cv_.wait(lock, [this]() { return stopped_ || !tasks_.empty(); });
+      if (stopped_) {
+        return;
+      }
+      auto task = std::move(tasks_.front());
+      tasks_.pop_front();
+      auto entry = task.second;
+      int32_t job_id = entry->second.job_id;
+      lock.unlock();
+
+      std::string res_lib_path = gen_lib(job_id, task.first);
+
+      lock.lock();
+      auto waiters = std::move(entry->second.waiters);
+      if (res_lib_path.empty()) {
+        cache_.erase(entry->first);
+        lru_.erase(entry);
+      } else {
+        entry->second.lib_path = res_lib_path;
+        entry->second.compiling = false;
+        evict_queries();
+      }
+      lock.unlock();
+      for (auto& waiter : waiters) {
+        waiter(job_id, res_lib_path);
+      }
+      lock.lock();
+    }
+  }
+
   int32_t getNextJobId() { return next_job_id_.fetch_add(1); }
 
+  std::string gen_lib(int32_t job_id, const physical::PhysicalPlan& plan) {
+    LOG(INFO) << "Start generating for query: " << job_id;
+    auto work_dir = get_work_directory(job_id);
+    auto query_name = "query_" + std::to_string(job_id);
+    std::string plan_path = prepare_next_job_dir(work_dir, query_name, plan);
+    if (plan_path.empty()) {
+      return "";
+    }
+
+    std::string res_lib_path =
+        call_codegen_cmd(plan_path, query_name, work_dir);
+
+    // check res_lib_path exists
+    if (!std::filesystem::exists(res_lib_path)) {
+      LOG(ERROR) << "res lib path " << res_lib_path << " not exists";
+      return "";
+    }
+    return res_lib_path;
+  }
+
+  // Equal plans serialize to the same bytes, which are the key of the cache.
+  static std::string serialize_plan(const physical::PhysicalPlan& plan) {
+    std::string ret;
+    {
+      google::protobuf::io::StringOutputStream string_stream(&ret);
+      google::protobuf::io::CodedOutputStream coded_stream(&string_stream);
+      coded_stream.SetSerializationDeterministic(true);
+      plan.SerializeToCodedStream(&coded_stream);
+    }
+    return ret;
+  }
+
+  // Drop the least recently used queries over the limit, the libraries stay
+  // on disk as they may still be loaded.
+  void evict_queries() {
+    auto iter = lru_.end();
+    while (cache_.size() > kMaxCachedQueryNum && iter != lru_.begin()) {
+      --iter;
+      if (!iter->second.compiling) {
+        cache_.erase(iter->first);
+        iter = lru_.erase(iter);
+      }
+    }
+  }
+
   std::string get_work_directory(int32_t job_id) {
     std::string work_dir = working_directory_ + "/" + std::to_string(job_id);
     ensure_dir_exists(work_dir);
@@ -151,6 +297,16 @@ class CodegenProxy {
   std::string db_home_;
   std::atomic<int32_t> next_job_id_{0};
   bool initialized_;
+
+  // compiled queries by plan, most recently used first, and the plans waiting
+  // for a compile worker
+  std::mutex cache_mutex_;
+  cache_list_t lru_;
+  std::unordered_map<std::string_view, cache_list_t::iterator> cache_;
+  std::deque<std::pair<physical::PhysicalPlan, cache_list_t::iterator>> tasks_;
+  std::condition_variable tasks_cv_;
+  std::vector<std::thread> workers_;
+  bool stopped_;
 };
 
 }  // namespace server
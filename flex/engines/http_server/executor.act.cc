@@ -18,8 +18,13 @@
 #include "flex/engines/graph_db/database/graph_db.h"
 #include "flex/engines/graph_db/database/graph_db_session.h"
 #include "flex/engines/http_server/codegen_proxy.h"
+#include "flex/engines/http_server/literal_extractor.h"
+#include "flex/engines/http_server/plan_interpreter.h"
+#include "flex/engines/http_server/query_offloader.h"
 #include "flex/engines/http_server/stored_procedure.h"
 
+#include <chrono>
+
 #include <seastar/core/print.hh>
 
 namespace server {
@@ -38,9 +43,22 @@ executor::executor(hiactor::actor_base* exec_ctx, const hiactor::byte_t* addr)
 
 seastar::future<query_result> executor::run_graph_db_query(
     query_param&& param) {
-  auto ret = gs::GraphDB::get()
-                 .GetSession(hiactor::local_shard_id())
-                 .Eval(param.content);
+  std::string_view input(param.content.data(), param.content.size());
+  auto& offloader = QueryOffloader::get();
+  if (!input.empty() && offloader.IsLong(input.back())) {
+    return offloader.Submit(std::string(input));
+  }
+  // the request is decoded in place, and the result is copied once from the
+  // session's buffer into the reply
+  auto start = std::chrono::steady_clock::now();
+  auto ret =
+      gs::GraphDB::get().GetSession(hiactor::local_shard_id()).Eval(input);
+  if (!input.empty()) {
+    offloader.Record(input.back(),
+                     std::chrono::duration_cast<std::chrono::microseconds>(
+                         std::chrono::steady_clock::now() - start)
+                         .count());
+  }
   seastar::sstring content(ret.data(), ret.size());
   return seastar::make_ready_future<query_result>(std::move(content));
 }
@@ -51,77 +69,101 @@ seastar::future<query_result> executor::run_hqps_procedure_query(
   auto& str = param.content;
   const char* str_data = str.data();
   size_t str_length = str.size();
-  LOG(INFO) << "Receive pay load: " << str_length << " bytes";
+  VLOG(10) << "Receive pay load: " << str_length << " bytes";
 
   query::Query cur_query;
   {
     CHECK(cur_query.ParseFromArray(str.data(), str.size()));
-    LOG(INFO) << "Parse query: " << cur_query.DebugString();
+    VLOG(10) << "Parse query: " << cur_query.DebugString();
   }
   auto& store_procedure_manager = server::StoredProcedureManager::get();
   return store_procedure_manager.Query(cur_query).then(
       [&cur_query](results::CollectiveResults&& hqps_result) {
-        LOG(INFO) << "Finish running query: " << cur_query.DebugString();
-        LOG(INFO) << "Query results" << hqps_result.DebugString();
-
-        auto tem_str = hqps_result.SerializeAsString();
-
-        seastar::sstring content(tem_str.data(), tem_str.size());
-        return seastar::make_ready_future<query_result>(std::move(content));
+        VLOG(10) << "Finish running query: " << cur_query.DebugString();
+        VLOG(10) << "Query results" << hqps_result.DebugString();
+        return seastar::make_ready_future<query_result>(
+            serialize_results(hqps_result));
       });
 }
 
-seastar::future<query_result> executor::run_hqps_adhoc_query(
-    query_param&& param) {
-  LOG(INFO) << "Run adhoc query";
-  // The received query's pay load shoud be able to deserialze to physical plan
-  auto& str = param.content;
+// The received query's pay load shoud be able to deserialze to physical plan
+static seastar::future<physical::PhysicalPlan> parse_plan(
+    const seastar::sstring& str) {
   if (str.size() <= 0) {
     LOG(INFO) << "Empty query";
-    return seastar::make_exception_future<query_result>(
+    return seastar::make_exception_future<physical::PhysicalPlan>(
         std::runtime_error("Empty query string"));
   }
-
-  const char* str_data = str.data();
-  size_t str_length = str.size();
-  LOG(INFO) << "Deserialize physical job request" << str_length;
+  VLOG(10) << "Deserialize physical job request" << str.size();
 
   physical::PhysicalPlan plan;
-  bool ret = plan.ParseFromArray(str_data, str_length);
-  if (ret) {
-    LOG(INFO) << "Parse physical plan: " << plan.DebugString();
-  } else {
+  if (!plan.ParseFromArray(str.data(), str.size())) {
     LOG(ERROR) << "Fail to parse physical plan";
-    return seastar::make_exception_future<query_result>(
+    return seastar::make_exception_future<physical::PhysicalPlan>(
         std::runtime_error("Fail to parse physical plan"));
   }
+  VLOG(10) << "Parse physical plan: " << plan.DebugString();
+  return seastar::make_ready_future<physical::PhysicalPlan>(std::move(plan));
+}
 
-  // 0. do codegen gen.
-  std::string lib_path = "";
-  int32_t job_id = -1;
-  auto& codegen_proxy = server::CodegenProxy::get();
-  if (codegen_proxy.Initialized()) {
-    auto ret = codegen_proxy.do_gen(plan);
-    if (ret.has_value()) {
-      auto& v = ret.value();
-      job_id = v.first;
-      lib_path = v.second;
+seastar::future<query_result> executor::run_hqps_adhoc_query(
+    query_param&& param) {
+  VLOG(10) << "Run adhoc query";
+  return parse_plan(param.content).then([](physical::PhysicalPlan&& plan) {
+    if (can_interpret(plan)) {
+      LOG(INFO) << "Interpret the plan without codegen";
+      auto& session =
+          gs::GraphDB::get().GetSession(hiactor::local_shard_id());
+      return seastar::make_ready_future<query_result>(
+          serialize_results(interpret_plan(plan, session)));
     }
-  } else {
-    return seastar::make_exception_future<query_result>(
-        std::runtime_error("Codegen proxy not initialized"));
-  }
-  if (job_id == -1) {
-    return seastar::make_exception_future<query_result>(
-        std::runtime_error("Fail to parse job id from codegen proxy"));
-  }
-  // 1. load and run.
-  LOG(INFO) << "Okay, try to run the query of lib path: " << lib_path
-            << ", job id: " << job_id;
 
-  seastar::sstring content =
-      server::load_and_run(job_id, lib_path, hiactor::local_shard_id());
-  return seastar::make_ready_future<query_result>(std::move(content));
+    // 0. do codegen gen, on the compile workers, for the plan without its
+    // literals, which are passed as arguments instead.
+    auto& codegen_proxy = server::CodegenProxy::get();
+    if (!codegen_proxy.Initialized()) {
+      return seastar::make_exception_future<query_result>(
+          std::runtime_error("Codegen proxy not initialized"));
+    }
+    auto args = extract_literals(plan);
+    return codegen_proxy.do_gen(std::move(plan))
+        .then([args = std::move(args)](CodegenProxy::gen_result_t&& job) {
+          // 1. load and run.
+          LOG(INFO) << "Okay, try to run the query of lib path: "
+                    << job.second << ", job id: " << job.first;
+
+          seastar::sstring content = server::load_and_run(
+              job.first, job.second, hiactor::local_shard_id(), args);
+          return seastar::make_ready_future<query_result>(std::move(content));
+        });
+  });
+}
+
+// Compile a plan with dynamic params once, and load it as a stored procedure,
+// whose name is returned as the handle to run it by, with the params bound,
+// as other stored procedures.
+seastar::future<query_result> executor::prepare_hqps_adhoc_query(
+    query_param&& param) {
+  VLOG(10) << "Prepare adhoc query";
+  return parse_plan(param.content).then([](physical::PhysicalPlan&& plan) {
+    auto& codegen_proxy = server::CodegenProxy::get();
+    if (!codegen_proxy.Initialized()) {
+      return seastar::make_exception_future<query_result>(
+          std::runtime_error("Codegen proxy not initialized"));
+    }
+    return codegen_proxy.do_gen(std::move(plan))
+        .then([](CodegenProxy::gen_result_t&& job) {
+          std::string handle = "adhoc_" + std::to_string(job.first);
+          if (!StoredProcedureManager::get().LoadProcedure(
+                  handle, job.second, hiactor::local_shard_id())) {
+            return seastar::make_exception_future<query_result>(
+                std::runtime_error("Fail to load " + job.second));
+          }
+          LOG(INFO) << "Prepared query " << handle << ": " << job.second;
+          return seastar::make_ready_future<query_result>(
+              seastar::sstring(handle));
+        });
+  });
 }
 
 }  // namespace server
@@ -34,6 +34,8 @@ class ANNOTATION(actor:impl) executor : public hiactor::actor {
 
   seastar::future<query_result> ANNOTATION(actor:method) run_hqps_adhoc_query(query_param&& param);
 
+  seastar::future<query_result> ANNOTATION(actor:method) prepare_hqps_adhoc_query(query_param&& param);
+
   // DECLARE_RUN_QUERYS;
   /// Declare `do_work` func here, no need to implement.
   ACTOR_DO_WORK()
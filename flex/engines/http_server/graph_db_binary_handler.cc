@@ -0,0 +1,265 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "flex/engines/http_server/graph_db_binary_handler.h"
+
+#include <seastar/core/alien.hh>
+#include <seastar/core/gate.hh>
+#include <seastar/core/loop.hh>
+#include <seastar/core/print.hh>
+#include <seastar/core/seastar.hh>
+#include <seastar/core/semaphore.hh>
+#include <seastar/net/api.hh>
+
+#include <cstring>
+#include <unordered_set>
+#include <vector>
+
+#include "flex/engines/graph_db/database/graph_db.h"
+#include "flex/engines/http_server/executor_group.actg.h"
+#include "flex/engines/http_server/generated/executor_ref.act.autogen.h"
+#include "flex/engines/http_server/options.h"
+#include "flex/engines/http_server/types.h"
+
+namespace server {
+
+class graph_db_binary_server {
+ public:
+  static constexpr size_t kHeaderSize = 9;
+  static constexpr size_t kMaxInFlight = 128;
+  static constexpr uint32_t kMaxPayloadSize = 64u << 20;
+
+  explicit graph_db_binary_server(uint16_t port)
+      : port_(port), query_idx_(0), update_idx_(0) {
+    query_refs_ = build_refs(ic_query_group_id, shard_query_concurrency);
+    update_refs_ = build_refs(ic_update_group_id, shard_update_concurrency);
+  }
+
+  seastar::future<> listen() {
+    seastar::listen_options options;
+    options.reuse_address = true;
+    listener_ = seastar::listen(seastar::make_ipv4_address({port_}), options);
+    // runs until stop
+    (void) seastar::with_gate(gate_, [this] { return accept(); });
+    return seastar::make_ready_future<>();
+  }
+
+  seastar::future<> stop() {
+    listener_.abort_accept();
+    for (auto conn : connections_) {
+      conn->socket.shutdown_input();
+    }
+    return gate_.close();
+  }
+
+ private:
+  struct connection {
+    explicit connection(seastar::connected_socket&& s)
+        : socket(std::move(s)),
+          in(socket.input()),
+          out(socket.output()),
+          in_flight(kMaxInFlight),
+          writes(seastar::make_ready_future<>()) {}
+
+    seastar::connected_socket socket;
+    seastar::input_stream<char> in;
+    seastar::output_stream<char> out;
+    seastar::semaphore in_flight;
+    // the responses are written one after another
+    seastar::future<> writes;
+    seastar::gate requests;
+  };
+
+  static std::vector<executor_ref> build_refs(uint32_t group_id,
+                                              uint32_t concurrency) {
+    std::vector<executor_ref> refs;
+    hiactor::scope_builder builder;
+    builder.set_shard(hiactor::local_shard_id())
+        .enter_sub_scope(hiactor::scope<executor_group>(0))
+        .enter_sub_scope(hiactor::scope<hiactor::actor_group>(group_id));
+    for (unsigned i = 0; i < concurrency; ++i) {
+      refs.emplace_back(builder.build_ref<executor_ref>(i));
+    }
+    return refs;
+  }
+
+  seastar::future<> accept() {
+    return seastar::keep_doing([this] {
+             return listener_.accept().then(
+                 [this](seastar::accept_result result) {
+                   result.connection.set_nodelay(true);
+                   auto conn = seastar::make_lw_shared<connection>(
+                       std::move(result.connection));
+                   (void) seastar::with_gate(
+                       gate_, [this, conn] { return serve(conn); });
+                 });
+           })
+        .handle_exception([](std::exception_ptr) {
+          // the listener is aborted by stop
+        });
+  }
+
+  seastar::future<> serve(seastar::lw_shared_ptr<connection> conn) {
+    connections_.insert(conn.get());
+    return seastar::repeat([this, conn] { return serveOne(conn); })
+        .handle_exception([](std::exception_ptr ep) {
+          LOG(ERROR) << "Binary connection failed: " << ep;
+        })
+        .then([conn] { return conn->requests.close(); })
+        .then([conn] {
+          return std::move(conn->writes).handle_exception(
+              [](std::exception_ptr) {});
+        })
+        .then([conn] { return conn->out.close(); })
+        .handle_exception([](std::exception_ptr) {})
+        .finally([this, conn] { connections_.erase(conn.get()); });
+  }
+
+  // read a request and run it in the background
+  seastar::future<seastar::stop_iteration> serveOne(
+      seastar::lw_shared_ptr<connection> conn) {
+    return conn->in.read_exactly(kHeaderSize)
+        .then([this, conn](seastar::temporary_buffer<char> header) {
+          if (header.size() < kHeaderSize) {
+            return seastar::make_ready_future<seastar::stop_iteration>(
+                seastar::stop_iteration::yes);
+          }
+          uint32_t length, id;
+          memcpy(&length, header.get(), sizeof(uint32_t));
+          memcpy(&id, header.get() + 4, sizeof(uint32_t));
+          uint8_t kind = header[8];
+          if (length > kMaxPayloadSize) {
+            LOG(ERROR) << "Binary request of " << length << " bytes rejected";
+            return seastar::make_ready_future<seastar::stop_iteration>(
+                seastar::stop_iteration::yes);
+          }
+          return conn->in.read_exactly(length).then(
+              [this, conn, length, id,
+               kind](seastar::temporary_buffer<char> payload) {
+                if (payload.size() < length) {
+                  return seastar::make_ready_future<seastar::stop_iteration>(
+                      seastar::stop_iteration::yes);
+                }
+                return seastar::get_units(conn->in_flight, 1)
+                    .then([this, conn, id, kind,
+                           payload = std::move(payload)](auto units) mutable {
+                      (void) seastar::with_gate(
+                          conn->requests,
+                          [this, conn, id, kind, payload = std::move(payload),
+                           units = std::move(units)]() mutable {
+                            return run(conn, id, kind, std::move(payload))
+                                .finally([units = std::move(units)] {});
+                          });
+                      return seastar::stop_iteration::no;
+                    });
+              });
+        });
+  }
+
+  seastar::future<> run(seastar::lw_shared_ptr<connection> conn, uint32_t id,
+                        uint8_t kind, seastar::temporary_buffer<char> payload) {
+    if (kind == 1 && gs::GraphDB::get().IsReplica()) {
+      reply(conn, id, 1, "Writes are served by the primary");
+      return seastar::make_ready_future<>();
+    }
+    auto& refs = kind == 0 ? query_refs_ : update_refs_;
+    auto& idx = kind == 0 ? query_idx_ : update_idx_;
+    auto dst_executor = idx;
+    idx = (idx + 1) % refs.size();
+    return refs[dst_executor]
+        .run_graph_db_query(
+            query_param{seastar::sstring(payload.get(), payload.size())})
+        .then_wrapped(
+            [this, conn, id](seastar::future<query_result>&& fut) mutable {
+              if (__builtin_expect(fut.failed(), false)) {
+                auto ep = fut.get_exception();
+                seastar::sstring error = "Query failed";
+                try {
+                  std::rethrow_exception(ep);
+                } catch (const std::exception& e) {
+                  error = e.what();
+                } catch (...) {}
+                reply(conn, id, 1, std::move(error));
+              } else {
+                reply(conn, id, 0, std::move(fut.get0().content));
+              }
+            });
+  }
+
+  // the result is handed to the stream without a copy
+  void reply(seastar::lw_shared_ptr<connection> conn, uint32_t id,
+             uint8_t status, seastar::sstring content) {
+    seastar::temporary_buffer<char> header(kHeaderSize);
+    uint32_t length = content.size();
+    memcpy(header.get_write(), &length, sizeof(uint32_t));
+    memcpy(header.get_write() + 4, &id, sizeof(uint32_t));
+    header.get_write()[8] = static_cast<char>(status);
+    auto holder = std::make_unique<seastar::sstring>(std::move(content));
+    char* data = holder->data();
+    size_t size = holder->size();
+    seastar::temporary_buffer<char> body(
+        data, size, seastar::make_object_deleter(std::move(holder)));
+    conn->writes = std::move(conn->writes)
+                       .then([conn, header = std::move(header),
+                              body = std::move(body)]() mutable {
+                         return conn->out.write(std::move(header))
+                             .then([conn, body = std::move(body)]() mutable {
+                               return conn->out.write(std::move(body));
+                             })
+                             .then([conn] { return conn->out.flush(); });
+                       });
+  }
+
+  const uint16_t port_;
+  seastar::server_socket listener_;
+  seastar::gate gate_;
+  std::unordered_set<connection*> connections_;
+
+  std::vector<executor_ref> query_refs_;
+  std::vector<executor_ref> update_refs_;
+  uint32_t query_idx_;
+  uint32_t update_idx_;
+};
+
+graph_db_binary_handler::graph_db_binary_handler(uint16_t port)
+    : port_(port),
+      servers_(std::make_unique<seastar::sharded<graph_db_binary_server>>()) {
+}
+
+graph_db_binary_handler::~graph_db_binary_handler() = default;
+
+void graph_db_binary_handler::start() {
+  auto fut = seastar::alien::submit_to(
+      *seastar::alien::internal::default_instance, 0, [this] {
+        return servers_->start(port_)
+            .then([this] {
+              return servers_->invoke_on_all(&graph_db_binary_server::listen);
+            })
+            .then([this] {
+              fmt::print("Binary handler is listening on port {} ...\n",
+                         port_);
+            });
+      });
+  fut.wait();
+}
+
+void graph_db_binary_handler::stop() {
+  auto fut =
+      seastar::alien::submit_to(*seastar::alien::internal::default_instance, 0,
+                                [this] { return servers_->stop(); });
+  fut.wait();
+}
+
+}  // namespace server
@@ -0,0 +1,59 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ENGINES_HTTP_SERVER_GRAPH_DB_BINARY_HANDLER_H_
+#define ENGINES_HTTP_SERVER_GRAPH_DB_BINARY_HANDLER_H_
+
+#include <seastar/core/sharded.hh>
+
+#include <memory>
+
+namespace server {
+
+class graph_db_binary_server;
+
+/**
+ * @brief A length-prefixed binary endpoint for the queries of the http
+ * handler, which spares the parsing of http headers, listening on every
+ * shard.
+ *
+ * A request is a frame of a uint32 length of the payload, a uint32 id, a
+ * byte of its kind, 0 for queries and 1 for updates and apps, then the
+ * payload, the input of GraphDBSession::Eval. A response is a frame of a
+ * uint32 length of the payload, the id of the request, a byte of 0 on
+ * success or 1 on failure, then the payload, the result of Eval or the
+ * error. Integers are little-endian.
+ *
+ * Clients may send requests without waiting for their responses, up to
+ * 128 in flight per connection. Requests of a connection run concurrently
+ * on the executors of its shard, and their responses are sent as they
+ * finish, to be matched to the requests by their ids.
+ */
+class graph_db_binary_handler {
+ public:
+  graph_db_binary_handler(uint16_t port);
+  ~graph_db_binary_handler();
+
+  void start();
+  void stop();
+
+ private:
+  const uint16_t port_;
+  std::unique_ptr<seastar::sharded<graph_db_binary_server>> servers_;
+};
+
+}  // namespace server
+
+#endif  // ENGINES_HTTP_SERVER_GRAPH_DB_BINARY_HANDLER_H_
@@ -13,6 +13,7 @@
  * limitations under the License.
  */
 
+#include "flex/engines/graph_db/database/graph_db.h"
 #include "flex/engines/http_server/executor_group.actg.h"
 #include "flex/engines/http_server/graph_db_service.h"
 #include "flex/engines/http_server/options.h"
@@ -22,6 +23,7 @@
 #include <seastar/http/handlers.hh>
 #include "flex/engines/http_server/generated/executor_ref.act.autogen.h"
 #include "flex/engines/http_server/types.h"
+#include "flex/utils/metrics.h"
 
 namespace server {
 
@@ -83,6 +85,61 @@ class graph_db_exit_handler : public seastar::httpd::handler_base {
   }
 };
 
+class graph_db_replication_lag_handler : public seastar::httpd::handler_base {
+ public:
+  seastar::future<std::unique_ptr<seastar::httpd::reply>> handle(
+      const seastar::sstring& path,
+      std::unique_ptr<seastar::httpd::request> req,
+      std::unique_ptr<seastar::httpd::reply> rep) override {
+    rep->write_body("txt", seastar::to_sstring(
+                               gs::GraphDB::get().GetReplicationLag()));
+    return seastar::make_ready_future<std::unique_ptr<seastar::httpd::reply>>(
+        std::move(rep));
+  }
+};
+
+class graph_db_statistics_handler : public seastar::httpd::handler_base {
+ public:
+  seastar::future<std::unique_ptr<seastar::httpd::reply>> handle(
+      const seastar::sstring& path,
+      std::unique_ptr<seastar::httpd::request> req,
+      std::unique_ptr<seastar::httpd::reply> rep) override {
+    auto& db = gs::GraphDB::get();
+    rep->write_body("json", seastar::sstring{
+                                db.GetStatistics().ToJson(db.graph())});
+    return seastar::make_ready_future<std::unique_ptr<seastar::httpd::reply>>(
+        std::move(rep));
+  }
+};
+
+class graph_db_memory_usage_handler : public seastar::httpd::handler_base {
+ public:
+  seastar::future<std::unique_ptr<seastar::httpd::reply>> handle(
+      const seastar::sstring& path,
+      std::unique_ptr<seastar::httpd::request> req,
+      std::unique_ptr<seastar::httpd::reply> rep) override {
+    auto& db = gs::GraphDB::get();
+    rep->write_body("json", seastar::sstring{
+                                db.GetMemoryUsage().ToJson(db.graph())});
+    return seastar::make_ready_future<std::unique_ptr<seastar::httpd::reply>>(
+        std::move(rep));
+  }
+};
+
+// Metrics of the process in the prometheus text format.
+class graph_db_metrics_handler : public seastar::httpd::handler_base {
+ public:
+  seastar::future<std::unique_ptr<seastar::httpd::reply>> handle(
+      const seastar::sstring& path,
+      std::unique_ptr<seastar::httpd::request> req,
+      std::unique_ptr<seastar::httpd::reply> rep) override {
+    rep->write_body("txt",
+                    seastar::sstring{gs::MetricsRegistry::get().Dump()});
+    return seastar::make_ready_future<std::unique_ptr<seastar::httpd::reply>>(
+        std::move(rep));
+  }
+};
+
 graph_db_http_handler::graph_db_http_handler(uint16_t http_port)
     : http_port_(http_port) {}
 
@@ -112,6 +169,24 @@ seastar::future<> graph_db_http_handler::set_routes() {
     r.add(seastar::httpd::operation_type::POST,
           seastar::httpd::url("/interactive/query"),
           new graph_db_ic_handler(ic_query_group_id, shard_query_concurrency));
+    r.add(seastar::httpd::operation_type::GET,
+          seastar::httpd::url("/interactive/replication_lag"),
+          new graph_db_replication_lag_handler());
+    r.add(seastar::httpd::operation_type::GET,
+          seastar::httpd::url("/interactive/statistics"),
+          new graph_db_statistics_handler());
+    r.add(seastar::httpd::operation_type::GET,
+          seastar::httpd::url("/interactive/memory_usage"),
+          new graph_db_memory_usage_handler());
+    r.add(seastar::httpd::operation_type::GET, seastar::httpd::url("/metrics"),
+          new graph_db_metrics_handler());
+    if (gs::GraphDB::get().IsReplica()) {
+      // writes are served by the primary
+      r.add(seastar::httpd::operation_type::POST,
+            seastar::httpd::url("/interactive/exit"),
+            new graph_db_exit_handler());
+      return seastar::make_ready_future<>();
+    }
     r.add(
         seastar::httpd::operation_type::POST,
         seastar::httpd::url("/interactive/update"),
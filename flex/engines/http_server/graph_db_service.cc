@@ -15,12 +15,20 @@
 
 #include "flex/engines/http_server/graph_db_service.h"
 #include "flex/engines/http_server/options.h"
+#include "flex/engines/http_server/query_offloader.h"
 namespace server {
 
 void GraphDBService::init(uint32_t num_shards, uint16_t http_port,
-                          bool dpdk_mode) {
+                          bool dpdk_mode, uint32_t offload_threads,
+                          uint16_t binary_port) {
   actor_sys_ = std::make_unique<actor_system>(num_shards, dpdk_mode);
   http_hdl_ = std::make_unique<graph_db_http_handler>(http_port);
+  if (binary_port != 0) {
+    binary_hdl_ = std::make_unique<graph_db_binary_handler>(binary_port);
+  }
+  if (offload_threads > 0) {
+    QueryOffloader::get().Init(num_shards, offload_threads);
+  }
 }
 
 void GraphDBService::run_and_wait_for_exit() {
@@ -30,12 +38,19 @@ void GraphDBService::run_and_wait_for_exit() {
   }
   actor_sys_->launch();
   http_hdl_->start();
+  if (binary_hdl_) {
+    binary_hdl_->start();
+  }
   running_.store(true);
   while (running_.load(std::memory_order_relaxed)) {
     std::this_thread::sleep_for(std::chrono::milliseconds(100));
   }
+  if (binary_hdl_) {
+    binary_hdl_->stop();
+  }
   http_hdl_->stop();
   actor_sys_->terminate();
+  QueryOffloader::get().Stop();
 }
 
 void GraphDBService::set_exit_state() { running_.store(false); }
@@ -17,6 +17,7 @@
 #define ENGINES_HTTP_SERVER_GRAPH_DB_SERVICE_H_
 
 #include "flex/engines/http_server/actor_system.h"
+#include "flex/engines/http_server/graph_db_binary_handler.h"
 #include "flex/engines/http_server/graph_db_http_handler.h"
 
 namespace server {
@@ -29,7 +30,12 @@ class GraphDBService {
   }
   ~GraphDBService() = default;
 
-  void init(uint32_t num_shards, uint16_t http_port, bool dpdk_mode);
+  // Long queries are offloaded to offload_threads threads, with the sessions
+  // after those of the shards, see QueryOffloader. Queries are also served
+  // over the binary protocol of graph_db_binary_handler on binary_port,
+  // unless it is 0.
+  void init(uint32_t num_shards, uint16_t http_port, bool dpdk_mode,
+            uint32_t offload_threads = 0, uint16_t binary_port = 0);
   void run_and_wait_for_exit();
   void set_exit_state();
 
@@ -39,6 +45,7 @@ class GraphDBService {
  private:
   std::unique_ptr<actor_system> actor_sys_;
   std::unique_ptr<graph_db_http_handler> http_hdl_;
+  std::unique_ptr<graph_db_binary_handler> binary_hdl_;
   std::atomic<bool> running_{false};
 };
 
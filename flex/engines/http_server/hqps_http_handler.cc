@@ -12,22 +12,85 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+#include "flex/engines/graph_db/database/graph_db.h"
 #include "flex/engines/http_server/executor_group.actg.h"
 #include "flex/engines/http_server/hqps_service.h"
 #include "flex/engines/http_server/options.h"
+#include "flex/engines/http_server/result_cursors.h"
+#include "flex/engines/http_server/stored_procedure.h"
 
 #include <seastar/core/alien.hh>
 #include <seastar/core/print.hh>
 #include <seastar/http/handlers.hh>
 #include "flex/engines/http_server/generated/executor_ref.act.autogen.h"
 #include "flex/engines/http_server/types.h"
+#include "flex/utils/metrics.h"
+#include "flex/utils/query_profile.h"
 
 namespace server {
 
+// Reply to a query the shard has no room for, so that the client backs off
+// instead of piling up behind queries which are already late.
+static seastar::future<std::unique_ptr<seastar::httpd::reply>> reject_query(
+    std::unique_ptr<seastar::httpd::reply> rep) {
+  rep->set_status(seastar::httpd::reply::status_type::service_unavailable);
+  rep->write_body("bin", seastar::sstring{"Too many pending queries"});
+  rep->done();
+  return seastar::make_ready_future<std::unique_ptr<seastar::httpd::reply>>(
+      std::move(rep));
+}
+
+// The executor with the fewest pending queries, a long query then only
+// delays the ones queued behind it once all executors are busy.
+static uint32_t least_loaded(const std::vector<uint32_t>& pending,
+                             uint32_t start) {
+  uint32_t ret = start;
+  for (uint32_t i = 1; i < pending.size(); ++i) {
+    uint32_t idx = (start + i) % pending.size();
+    if (pending[idx] < pending[ret]) {
+      ret = idx;
+    }
+  }
+  return ret;
+}
+
+// 0 if the results are not asked for by pages.
+static size_t get_page_size(const seastar::httpd::request& req) {
+  auto param = req.get_query_param("page_size");
+  return param.empty() ? 0 : std::strtoull(param.c_str(), nullptr, 10);
+}
+
+// Queries with a page_size param reply with the first page of their results,
+// and with the id of a cursor to fetch the rest by in the Cursor-Id header,
+// see ResultCursors.
+static void write_results(seastar::httpd::reply& rep, seastar::sstring content,
+                          size_t page_size) {
+  if (page_size == 0) {
+    rep.write_body("bin", std::move(content));
+    return;
+  }
+  std::string page;
+  uint64_t cursor_id;
+  if (!ResultCursors::get().Open(
+          std::string_view(content.data(), content.size()), page_size, page,
+          cursor_id)) {
+    rep.set_status(seastar::httpd::reply::status_type::service_unavailable);
+    rep.write_body("bin", seastar::sstring{"Results exceed the cursor budget"});
+    return;
+  }
+  if (cursor_id != 0) {
+    rep.add_header("Cursor-Id", seastar::to_sstring(cursor_id));
+  }
+  rep.write_body("bin", seastar::sstring(page.data(), page.size()));
+}
+
 class hqps_ic_handler : public seastar::httpd::handler_base {
  public:
   hqps_ic_handler(uint32_t group_id, uint32_t shard_concurrency)
-      : shard_concurrency_(shard_concurrency), executor_idx_(0) {
+      : shard_concurrency_(shard_concurrency),
+        executor_idx_(0),
+        pending_num_(0),
+        executor_pending_(shard_concurrency, 0) {
     executor_refs_.reserve(shard_concurrency_);
     hiactor::scope_builder builder;
     builder.set_shard(hiactor::local_shard_id())
@@ -43,13 +106,21 @@ class hqps_ic_handler : public seastar::httpd::handler_base {
       const seastar::sstring& path,
       std::unique_ptr<seastar::httpd::request> req,
       std::unique_ptr<seastar::httpd::reply> rep) override {
-    auto dst_executor = executor_idx_;
+    if (pending_num_ >= shard_query_queue_limit) {
+      return reject_query(std::move(rep));
+    }
+    auto dst_executor = least_loaded(executor_pending_, executor_idx_);
     executor_idx_ = (executor_idx_ + 1) % shard_concurrency_;
+    ++pending_num_;
+    ++executor_pending_[dst_executor];
 
+    size_t page_size = get_page_size(*req);
     return executor_refs_[dst_executor]
         .run_hqps_procedure_query(query_param{std::move(req->content)})
-        .then_wrapped([rep = std::move(rep)](
+        .then_wrapped([this, dst_executor, page_size, rep = std::move(rep)](
                           seastar::future<query_result>&& fut) mutable {
+          --pending_num_;
+          --executor_pending_[dst_executor];
           if (__builtin_expect(fut.failed(), false)) {
             rep->set_status(
                 seastar::httpd::reply::status_type::internal_server_error);
@@ -63,7 +134,7 @@ class hqps_ic_handler : public seastar::httpd::handler_base {
                 std::unique_ptr<seastar::httpd::reply>>(std::move(rep));
           }
           auto result = fut.get0();
-          rep->write_body("bin", std::move(result.content));
+          write_results(*rep, std::move(result.content), page_size);
           rep->done();
           return seastar::make_ready_future<
               std::unique_ptr<seastar::httpd::reply>>(std::move(rep));
@@ -74,13 +145,23 @@ class hqps_ic_handler : public seastar::httpd::handler_base {
   const uint32_t shard_concurrency_;
   uint32_t executor_idx_;
   std::vector<executor_ref> executor_refs_;
+  // handlers are per shard, so the counters need no synchronization
+  uint32_t pending_num_;
+  std::vector<uint32_t> executor_pending_;
 };
 
-// a handler for handl adhoc query.
+// a handler for handl adhoc query, or for preparing one, whose reply is the
+// handle to run it by on /interactive/query, with its params bound, until it
+// is released by /interactive/procedure/unload.
 class hqps_adhoc_query_handler : public seastar::httpd::handler_base {
  public:
-  hqps_adhoc_query_handler(uint32_t group_id, uint32_t shard_concurrency)
-      : shard_concurrency_(shard_concurrency), executor_idx_(0) {
+  hqps_adhoc_query_handler(uint32_t group_id, uint32_t shard_concurrency,
+                           bool prepare = false)
+      : prepare_(prepare),
+        shard_concurrency_(shard_concurrency),
+        executor_idx_(0),
+        pending_num_(0),
+        executor_pending_(shard_concurrency, 0) {
     executor_refs_.reserve(shard_concurrency_);
     hiactor::scope_builder builder;
     builder.set_shard(hiactor::local_shard_id())
@@ -96,37 +177,52 @@ class hqps_adhoc_query_handler : public seastar::httpd::handler_base {
       const seastar::sstring& path,
       std::unique_ptr<seastar::httpd::request> req,
       std::unique_ptr<seastar::httpd::reply> rep) override {
-    auto dst_executor = executor_idx_;
+    if (pending_num_ >= shard_adhoc_queue_limit) {
+      return reject_query(std::move(rep));
+    }
+    auto dst_executor = least_loaded(executor_pending_, executor_idx_);
     executor_idx_ = (executor_idx_ + 1) % shard_concurrency_;
+    ++pending_num_;
+    ++executor_pending_[dst_executor];
 
-    return executor_refs_[dst_executor]
-        .run_hqps_adhoc_query(query_param{std::move(req->content)})
-        .then_wrapped([rep = std::move(rep)](
-                          seastar::future<query_result>&& fut) mutable {
-          if (__builtin_expect(fut.failed(), false)) {
-            rep->set_status(
-                seastar::httpd::reply::status_type::internal_server_error);
-            try {
-              std::rethrow_exception(fut.get_exception());
-            } catch (std::exception& e) {
-              rep->write_body("bin", seastar::sstring(e.what()));
-            }
-            rep->done();
-            return seastar::make_ready_future<
-                std::unique_ptr<seastar::httpd::reply>>(std::move(rep));
-          }
-          auto result = fut.get0();
-          rep->write_body("bin", std::move(result.content));
-          rep->done();
-          return seastar::make_ready_future<
-              std::unique_ptr<seastar::httpd::reply>>(std::move(rep));
-        });
+    auto& executor = executor_refs_[dst_executor];
+    // the handle of a prepared query is not paged
+    size_t page_size = prepare_ ? 0 : get_page_size(*req);
+    query_param param{std::move(req->content)};
+    auto fut = prepare_ ? executor.prepare_hqps_adhoc_query(std::move(param))
+                        : executor.run_hqps_adhoc_query(std::move(param));
+    return fut.then_wrapped([this, dst_executor, page_size,
+                             rep = std::move(rep)](
+                                seastar::future<query_result>&& fut) mutable {
+      --pending_num_;
+      --executor_pending_[dst_executor];
+      if (__builtin_expect(fut.failed(), false)) {
+        rep->set_status(
+            seastar::httpd::reply::status_type::internal_server_error);
+        try {
+          std::rethrow_exception(fut.get_exception());
+        } catch (std::exception& e) {
+          rep->write_body("bin", seastar::sstring(e.what()));
+        }
+        rep->done();
+        return seastar::make_ready_future<
+            std::unique_ptr<seastar::httpd::reply>>(std::move(rep));
+      }
+      auto result = fut.get0();
+      write_results(*rep, std::move(result.content), page_size);
+      rep->done();
+      return seastar::make_ready_future<
+          std::unique_ptr<seastar::httpd::reply>>(std::move(rep));
+    });
   }
 
  private:
+  const bool prepare_;
   const uint32_t shard_concurrency_;
   uint32_t executor_idx_;
   std::vector<executor_ref> executor_refs_;
+  uint32_t pending_num_;
+  std::vector<uint32_t> executor_pending_;
 };
 
 class hqps_exit_handler : public seastar::httpd::handler_base {
@@ -144,6 +240,144 @@ class hqps_exit_handler : public seastar::httpd::handler_base {
   }
 };
 
+class hqps_statistics_handler : public seastar::httpd::handler_base {
+ public:
+  seastar::future<std::unique_ptr<seastar::httpd::reply>> handle(
+      const seastar::sstring& path,
+      std::unique_ptr<seastar::httpd::request> req,
+      std::unique_ptr<seastar::httpd::reply> rep) override {
+    auto& db = gs::GraphDB::get();
+    rep->write_body("json", seastar::sstring{
+                                db.GetStatistics().ToJson(db.graph())});
+    return seastar::make_ready_future<std::unique_ptr<seastar::httpd::reply>>(
+        std::move(rep));
+  }
+};
+
+class hqps_memory_usage_handler : public seastar::httpd::handler_base {
+ public:
+  seastar::future<std::unique_ptr<seastar::httpd::reply>> handle(
+      const seastar::sstring& path,
+      std::unique_ptr<seastar::httpd::request> req,
+      std::unique_ptr<seastar::httpd::reply> rep) override {
+    auto& db = gs::GraphDB::get();
+    rep->write_body("json", seastar::sstring{
+                                db.GetMemoryUsage().ToJson(db.graph())});
+    return seastar::make_ready_future<std::unique_ptr<seastar::httpd::reply>>(
+        std::move(rep));
+  }
+};
+
+// Operator profiles of the latest queries compiled with HQPS_PROFILE.
+class hqps_profile_handler : public seastar::httpd::handler_base {
+ public:
+  seastar::future<std::unique_ptr<seastar::httpd::reply>> handle(
+      const seastar::sstring& path,
+      std::unique_ptr<seastar::httpd::request> req,
+      std::unique_ptr<seastar::httpd::reply> rep) override {
+    rep->write_body("json",
+                    seastar::sstring{gs::QueryProfiler::RecentToJson()});
+    return seastar::make_ready_future<std::unique_ptr<seastar::httpd::reply>>(
+        std::move(rep));
+  }
+};
+
+// Metrics of the process in the prometheus text format.
+class hqps_metrics_handler : public seastar::httpd::handler_base {
+ public:
+  seastar::future<std::unique_ptr<seastar::httpd::reply>> handle(
+      const seastar::sstring& path,
+      std::unique_ptr<seastar::httpd::request> req,
+      std::unique_ptr<seastar::httpd::reply> rep) override {
+    rep->write_body("txt",
+                    seastar::sstring{gs::MetricsRegistry::get().Dump()});
+    return seastar::make_ready_future<std::unique_ptr<seastar::httpd::reply>>(
+        std::move(rep));
+  }
+};
+
+// Load (or replace) and unload stored procedures at runtime, e.g.
+// /interactive/procedure/load?name=ic1&path=/path/to/libic1.so. Queries
+// already running keep the version they started on.
+class hqps_procedure_handler : public seastar::httpd::handler_base {
+ public:
+  explicit hqps_procedure_handler(bool load) : load_(load) {}
+
+  seastar::future<std::unique_ptr<seastar::httpd::reply>> handle(
+      const seastar::sstring& path,
+      std::unique_ptr<seastar::httpd::request> req,
+      std::unique_ptr<seastar::httpd::reply> rep) override {
+    auto name = req->get_query_param("name");
+    auto lib_path = req->get_query_param("path");
+    auto& manager = StoredProcedureManager::get();
+    bool ok = false;
+    if (name.empty() || (load_ && lib_path.empty())) {
+      rep->write_body("bin", seastar::sstring{"Expect name and path"});
+    } else if (load_) {
+      ok = manager.LoadProcedure(name, lib_path, hiactor::local_shard_id());
+      rep->write_body("bin", ok ? "Loaded " + name
+                                : "Fail to load " + lib_path);
+    } else {
+      ok = manager.UnloadProcedure(name);
+      rep->write_body("bin", ok ? "Unloaded " + name
+                                : "No stored procedure named " + name);
+    }
+    if (!ok) {
+      rep->set_status(seastar::httpd::reply::status_type::bad_request);
+    }
+    return seastar::make_ready_future<std::unique_ptr<seastar::httpd::reply>>(
+        std::move(rep));
+  }
+
+ private:
+  bool load_;
+};
+
+// Fetch the next page of a cursor opened by a query with a page_size param,
+// e.g. /interactive/cursor?id=1&page_size=1000, the Cursor-Id header of the
+// reply is set while results remain. /interactive/cursor/close?id=1 drops
+// the rest of the results.
+class hqps_cursor_handler : public seastar::httpd::handler_base {
+ public:
+  explicit hqps_cursor_handler(bool close) : close_(close) {}
+
+  seastar::future<std::unique_ptr<seastar::httpd::reply>> handle(
+      const seastar::sstring& path,
+      std::unique_ptr<seastar::httpd::request> req,
+      std::unique_ptr<seastar::httpd::reply> rep) override {
+    auto id_param = req->get_query_param("id");
+    uint64_t id = std::strtoull(id_param.c_str(), nullptr, 10);
+    auto& cursors = ResultCursors::get();
+    size_t page_size = get_page_size(*req);
+    std::string page;
+    bool drained;
+    if (close_) {
+      if (cursors.Close(id)) {
+        rep->write_body("bin", "Closed cursor " + id_param);
+      } else {
+        rep->set_status(seastar::httpd::reply::status_type::not_found);
+        rep->write_body("bin", "No cursor " + id_param);
+      }
+    } else if (page_size == 0) {
+      rep->set_status(seastar::httpd::reply::status_type::bad_request);
+      rep->write_body("bin", seastar::sstring{"Expect id and page_size"});
+    } else if (!cursors.Next(id, page_size, page, drained)) {
+      rep->set_status(seastar::httpd::reply::status_type::not_found);
+      rep->write_body("bin", "No cursor " + id_param + ", or it has expired");
+    } else {
+      if (!drained) {
+        rep->add_header("Cursor-Id", id_param);
+      }
+      rep->write_body("bin", seastar::sstring(page.data(), page.size()));
+    }
+    return seastar::make_ready_future<std::unique_ptr<seastar::httpd::reply>>(
+        std::move(rep));
+  }
+
+ private:
+  bool close_;
+};
+
 hqps_http_handler::hqps_http_handler(uint16_t http_port)
     : http_port_(http_port) {}
 
@@ -179,8 +413,35 @@ seastar::future<> hqps_http_handler::set_routes() {
           seastar::httpd::url("/interactive/adhoc_query"),
           new hqps_adhoc_query_handler(ic_adhoc_group_id,
                                        shard_adhoc_concurrency));
+    r.add(seastar::httpd::operation_type::POST,
+          seastar::httpd::url("/interactive/adhoc_query/prepare"),
+          new hqps_adhoc_query_handler(ic_adhoc_group_id,
+                                       shard_adhoc_concurrency, true));
+    r.add(seastar::httpd::operation_type::GET,
+          seastar::httpd::url("/interactive/cursor"),
+          new hqps_cursor_handler(false));
+    r.add(seastar::httpd::operation_type::POST,
+          seastar::httpd::url("/interactive/cursor/close"),
+          new hqps_cursor_handler(true));
     r.add(seastar::httpd::operation_type::POST,
           seastar::httpd::url("/interactive/exit"), new hqps_exit_handler());
+    r.add(seastar::httpd::operation_type::GET,
+          seastar::httpd::url("/interactive/statistics"),
+          new hqps_statistics_handler());
+    r.add(seastar::httpd::operation_type::GET,
+          seastar::httpd::url("/interactive/memory_usage"),
+          new hqps_memory_usage_handler());
+    r.add(seastar::httpd::operation_type::GET,
+          seastar::httpd::url("/interactive/profile"),
+          new hqps_profile_handler());
+    r.add(seastar::httpd::operation_type::GET, seastar::httpd::url("/metrics"),
+          new hqps_metrics_handler());
+    r.add(seastar::httpd::operation_type::POST,
+          seastar::httpd::url("/interactive/procedure/load"),
+          new hqps_procedure_handler(true));
+    r.add(seastar::httpd::operation_type::POST,
+          seastar::httpd::url("/interactive/procedure/unload"),
+          new hqps_procedure_handler(false));
     return seastar::make_ready_future<>();
   });
 }
@@ -0,0 +1,97 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "flex/engines/http_server/literal_extractor.h"
+
+#include <string>
+
+#include "glog/logging.h"
+
+namespace server {
+
+// The predicates literals are extracted from, of the top level operators.
+static std::vector<common::Expression*> get_predicates(
+    physical::PhysicalPlan& plan) {
+  std::vector<common::Expression*> ret;
+  for (auto& op : *plan.mutable_plan()) {
+    auto* opr = op.mutable_opr();
+    if (opr->has_select() && opr->select().has_predicate()) {
+      ret.emplace_back(opr->mutable_select()->mutable_predicate());
+    } else if (opr->has_edge() && opr->edge().params().has_predicate()) {
+      ret.emplace_back(
+          opr->mutable_edge()->mutable_params()->mutable_predicate());
+    } else if (opr->has_vertex() && opr->vertex().params().has_predicate()) {
+      ret.emplace_back(
+          opr->mutable_vertex()->mutable_params()->mutable_predicate());
+    }
+  }
+  return ret;
+}
+
+// Whether the literal can be passed as an argument, i.e. the generated code
+// decodes it as the type put_argment encodes it with.
+static bool is_extractable(const common::ExprOpr& opr) {
+  if (!opr.has_const_() ||
+      opr.node_type().type_case() != common::IrDataType::kDataType) {
+    return false;
+  }
+  auto data_type = opr.node_type().data_type();
+  switch (opr.const_().item_case()) {
+  case common::Value::kI32:
+    return data_type == common::DataType::INT32;
+  case common::Value::kI64:
+    return data_type == common::DataType::INT64;
+  case common::Value::kF64:
+    return data_type == common::DataType::DOUBLE;
+  case common::Value::kStr:
+    return data_type == common::DataType::STRING;
+  default:
+    return false;
+  }
+}
+
+std::vector<query::Argument> extract_literals(physical::PhysicalPlan& plan) {
+  std::vector<query::Argument> args;
+  auto predicates = get_predicates(plan);
+  for (auto* predicate : predicates) {
+    for (auto& opr : predicate->operators()) {
+      if (opr.has_param()) {
+        return args;
+      }
+    }
+  }
+  for (auto* predicate : predicates) {
+    for (auto& opr : *predicate->mutable_operators()) {
+      if (!is_extractable(opr)) {
+        continue;
+      }
+      int32_t ind = args.size();
+      std::string name = "adhoc_param_" + std::to_string(ind);
+      query::Argument arg;
+      arg.set_param_name(name);
+      arg.set_param_ind(ind);
+      *arg.mutable_value() = opr.const_();
+      args.emplace_back(std::move(arg));
+
+      auto* param = opr.mutable_param();
+      param->set_name(name);
+      param->set_index(ind);
+      *param->mutable_data_type() = opr.node_type();
+    }
+  }
+  VLOG(10) << "Extract " << args.size() << " literals from the plan";
+  return args;
+}
+
+}  // namespace server
@@ -0,0 +1,37 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef ENGINES_HQPS_SERVER_LITERAL_EXTRACTOR_H_
+#define ENGINES_HQPS_SERVER_LITERAL_EXTRACTOR_H_
+
+#include <vector>
+
+#include "proto_generated_gie/physical.pb.h"
+#include "proto_generated_gie/stored_procedure.pb.h"
+
+namespace server {
+
+// Replaces the literals of the predicates of the select, edge expand and get
+// v operators of an adhoc plan by dynamic params, numbered in the order they
+// are met, and returns them as the arguments to run the compiled plan with.
+// Plans which differ only in these literals then share one compiled library.
+//
+// Plans which have dynamic params already, e.g. prepared ones, whose params
+// are bound by the client, are left as they are.
+
+std::vector<query::Argument> extract_literals(physical::PhysicalPlan& plan);
+
+}  // namespace server
+
+#endif  // ENGINES_HQPS_SERVER_LITERAL_EXTRACTOR_H_
@@ -21,4 +21,7 @@ uint32_t shard_query_concurrency = 16;
 uint32_t shard_update_concurrency = 4;
 uint32_t shard_adhoc_concurrency = 4;
 
+uint32_t shard_query_queue_limit = 1024;
+uint32_t shard_adhoc_queue_limit = 16;
+
 }  // namespace server
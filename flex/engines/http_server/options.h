@@ -29,6 +29,12 @@ extern uint32_t shard_query_concurrency;
 extern uint32_t shard_update_concurrency;
 extern uint32_t shard_adhoc_concurrency;
 
+/// queries admitted per shard, running or waiting for an executor, beyond
+/// which new ones are rejected. Kept per kind, so that a burst of adhoc
+/// queries can't fill the queues of the interactive ones.
+extern uint32_t shard_query_queue_limit;
+extern uint32_t shard_adhoc_queue_limit;
+
 }  // namespace server
 
 #endif  // ENGINES_HTTP_SERVER_OPTIONS_H_
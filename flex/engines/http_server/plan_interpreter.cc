@@ -0,0 +1,154 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "flex/engines/http_server/plan_interpreter.h"
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include "flex/engines/graph_db/database/graph_db_session.h"
+
+namespace server {
+
+// Matches predicates of the form id == const, id being the original id.
+static bool get_oid_from_predicate(const common::Expression& predicate,
+                                   int64_t& oid) {
+  if (predicate.operators_size() != 3) {
+    return false;
+  }
+  auto& left = predicate.operators(0);
+  auto& mid = predicate.operators(1);
+  auto& right = predicate.operators(2);
+  if (!left.has_var()) {
+    return false;
+  }
+  auto& property = left.var().property();
+  bool is_id = property.has_id() ||
+               (property.has_key() &&
+                property.key().item_case() == common::NameOrId::kName &&
+                property.key().name() == "id");
+  if (!is_id || mid.item_case() != common::ExprOpr::kLogical ||
+      mid.logical() != common::Logical::EQ || !right.has_const_()) {
+    return false;
+  }
+  auto& value = right.const_();
+  if (value.item_case() == common::Value::kI64) {
+    oid = value.i64();
+    return true;
+  } else if (value.item_case() == common::Value::kI32) {
+    oid = value.i32();
+    return true;
+  }
+  return false;
+}
+
+static bool is_interpretable_scan(const physical::Scan& scan) {
+  if (scan.scan_opt() != physical::Scan::VERTEX || !scan.has_params() ||
+      scan.has_idx_predicate()) {
+    return false;
+  }
+  auto& params = scan.params();
+  if (params.tables_size() == 0) {
+    return false;
+  }
+  for (auto& table : params.tables()) {
+    if (table.item_case() != common::NameOrId::kId) {
+      return false;
+    }
+  }
+  int64_t oid;
+  return !params.has_predicate() ||
+         get_oid_from_predicate(params.predicate(), oid);
+}
+
+bool can_interpret(const physical::PhysicalPlan& plan) {
+  if (plan.plan_size() < 2 || !plan.plan(0).opr().has_scan() ||
+      !is_interpretable_scan(plan.plan(0).opr().scan()) ||
+      !plan.plan(plan.plan_size() - 1).opr().has_sink()) {
+    return false;
+  }
+  for (int i = 1; i + 1 < plan.plan_size(); ++i) {
+    auto& opr = plan.plan(i).opr();
+    if (!opr.has_limit() && !opr.has_repartition()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Keep the rows in [lower, upper) of the range, an upper bound of 0 being
+// unbounded.
+template <typename T>
+static void apply_range(const algebra::Range& range, std::vector<T>& rows) {
+  size_t upper = range.upper() > 0 ? range.upper() : rows.size();
+  size_t lower = std::max(range.lower(), 0);
+  upper = std::min(upper, rows.size());
+  lower = std::min(lower, upper);
+  rows.erase(rows.begin() + upper, rows.end());
+  rows.erase(rows.begin(), rows.begin() + lower);
+}
+
+results::CollectiveResults interpret_plan(const physical::PhysicalPlan& plan,
+                                          gs::GraphDBSession& session) {
+  CHECK(can_interpret(plan));
+  auto& scan = plan.plan(0).opr().scan();
+  auto& params = scan.params();
+  auto txn = session.GetReadTransaction();
+  auto label_num = session.schema().vertex_label_num();
+
+  std::vector<std::pair<gs::label_t, gs::vid_t>> vertices;
+  int64_t oid;
+  bool by_oid = params.has_predicate() &&
+                get_oid_from_predicate(params.predicate(), oid);
+  for (auto& table : params.tables()) {
+    if (table.id() < 0 || table.id() >= label_num) {
+      continue;
+    }
+    gs::label_t label = table.id();
+    if (by_oid) {
+      auto it = txn.FindVertex(label, oid);
+      if (it.IsValid()) {
+        vertices.emplace_back(label, it.GetIndex());
+      }
+      continue;
+    }
+    for (auto it = txn.GetVertexIterator(label); it.IsValid(); it.Next()) {
+      vertices.emplace_back(label, it.GetIndex());
+    }
+  }
+  if (params.has_limit()) {
+    apply_range(params.limit(), vertices);
+  }
+  for (int i = 1; i + 1 < plan.plan_size(); ++i) {
+    auto& opr = plan.plan(i).opr();
+    if (opr.has_limit()) {
+      apply_range(opr.limit().range(), vertices);
+    }
+  }
+
+  int32_t tag_id = scan.has_alias() ? scan.alias().value() : -1;
+  results::CollectiveResults ret;
+  for (auto& v : vertices) {
+    auto col = ret.add_results()->mutable_record()->add_columns();
+    col->mutable_name_or_id()->set_id(tag_id);
+    auto vertex = col->mutable_entry()->mutable_element()->mutable_vertex();
+    vertex->set_id(v.second);
+    vertex->mutable_label()->set_id(v.first);
+  }
+  txn.Commit();
+  return ret;
+}
+
+}  // namespace server
@@ -0,0 +1,41 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef ENGINES_HQPS_SERVER_PLAN_INTERPRETER_H_
+#define ENGINES_HQPS_SERVER_PLAN_INTERPRETER_H_
+
+#include <string>
+
+#include "proto_generated_gie/physical.pb.h"
+#include "proto_generated_gie/results.pb.h"
+
+namespace gs {
+class GraphDBSession;
+}
+
+namespace server {
+
+// Executes adhoc plans of the simplest shape directly, without generating
+// code: a vertex scan, by label and optionally by id, followed by limits and
+// a sink. These are answered in less time than the compile takes, so other
+// plans keep going to codegen.
+
+bool can_interpret(const physical::PhysicalPlan& plan);
+
+results::CollectiveResults interpret_plan(const physical::PhysicalPlan& plan,
+                                          gs::GraphDBSession& session);
+
+}  // namespace server
+
+#endif  // ENGINES_HQPS_SERVER_PLAN_INTERPRETER_H_
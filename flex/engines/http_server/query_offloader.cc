@@ -0,0 +1,94 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "flex/engines/http_server/query_offloader.h"
+
+#include <seastar/core/alien.hh>
+#include <seastar/core/smp.hh>
+
+#include "flex/engines/graph_db/database/graph_db.h"
+#include "flex/engines/graph_db/database/graph_db_session.h"
+
+namespace server {
+
+QueryOffloader& QueryOffloader::get() {
+  static QueryOffloader instance;
+  return instance;
+}
+
+void QueryOffloader::Init(int first_session, int thread_num) {
+  CHECK_LE(first_session + thread_num, gs::GraphDB::get().SessionNum());
+  for (int i = 0; i < thread_num; ++i) {
+    workers_.emplace_back([this, i, first_session]() {
+      worker(first_session + i);
+    });
+  }
+  LOG(INFO) << "Offload long queries to " << thread_num
+            << " threads, from session " << first_session;
+}
+
+void QueryOffloader::Stop() {
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    stopped_ = true;
+  }
+  cv_.notify_all();
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+  workers_.clear();
+}
+
+seastar::future<query_result> QueryOffloader::Submit(std::string&& input) {
+  auto pr = new seastar::promise<query_result>();
+  auto fut = pr->get_future();
+  auto shard = seastar::this_shard_id();
+  auto done = [pr, shard](std::string&& output) {
+    seastar::alien::run_on(
+        *seastar::alien::internal::default_instance, shard,
+        [pr, output = std::move(output)]() noexcept {
+          pr->set_value(
+              query_result{seastar::sstring(output.data(), output.size())});
+          delete pr;
+        });
+  };
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    tasks_.push_back(Task{std::move(input), std::move(done)});
+  }
+  cv_.notify_one();
+  return fut;
+}
+
+void QueryOffloader::worker(int session_id) {
+  auto& session = gs::GraphDB::get().GetSession(session_id);
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    cv_.wait(lock, [this]() { return stopped_ || !tasks_.empty(); });
+    if (stopped_) {
+      return;
+    }
+    auto task = std::move(tasks_.front());
+    tasks_.pop_front();
+    lock.unlock();
+
+    auto ret = session.Eval(task.input);
+    task.done(std::string(ret.data(), ret.size()));
+
+    lock.lock();
+  }
+}
+
+}  // namespace server
@@ -0,0 +1,102 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef ENGINES_HTTP_SERVER_QUERY_OFFLOADER_H_
+#define ENGINES_HTTP_SERVER_QUERY_OFFLOADER_H_
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <seastar/core/future.hh>
+
+#include "glog/logging.h"
+
+#include "flex/engines/http_server/types.h"
+
+namespace server {
+
+// Runs the queries of long procedures on threads of their own, each with a
+// GraphDB session of its own, so that they neither stall the reactor of the
+// shard receiving them nor hold up the short queries queued on it.
+//
+// A procedure is found long once one of its queries, run inline on a shard,
+// takes more than kLongQueryMicros. Its later queries are offloaded, and
+// those already short, e.g. IC queries, keep running inline.
+class QueryOffloader {
+ public:
+  static constexpr int64_t kLongQueryMicros = 20000;
+
+  static QueryOffloader& get();
+
+  QueryOffloader() : stopped_(false) {
+    for (auto& flag : long_apps_) {
+      flag.store(false, std::memory_order_relaxed);
+    }
+  }
+  ~QueryOffloader() { Stop(); }
+
+  // Offloaded queries run on thread_num threads with the sessions from
+  // first_session on, which must not be used by the shards.
+  void Init(int first_session, int thread_num);
+
+  void Stop();
+
+  bool Enabled() const { return !workers_.empty(); }
+
+  // Whether queries of the app, the last byte of their input, are offloaded.
+  bool IsLong(uint8_t app) const {
+    return long_apps_[app].load(std::memory_order_relaxed);
+  }
+
+  // Called with the time a query of the app took inline.
+  void Record(uint8_t app, int64_t micros) {
+    if (micros > kLongQueryMicros && Enabled() && !IsLong(app)) {
+      long_apps_[app].store(true, std::memory_order_relaxed);
+      LOG(INFO) << "Queries of app " << static_cast<int>(app)
+                << " are offloaded after one took " << micros << " us";
+    }
+  }
+
+  // Evaluate the input on an offloading thread. Must be called on a shard,
+  // the future is resolved on the same shard.
+  seastar::future<query_result> Submit(std::string&& input);
+
+ private:
+  struct Task {
+    std::string input;
+    std::function<void(std::string&&)> done;
+  };
+
+  void worker(int session_id);
+
+  std::array<std::atomic<bool>, 256> long_apps_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<Task> tasks_;
+  bool stopped_;
+  std::vector<std::thread> workers_;
+};
+
+}  // namespace server
+
+#endif  // ENGINES_HTTP_SERVER_QUERY_OFFLOADER_H_
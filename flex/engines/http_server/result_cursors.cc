@@ -0,0 +1,144 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "flex/engines/http_server/result_cursors.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "glog/logging.h"
+
+namespace server {
+
+static uint64_t read_varint(std::string_view buf, size_t& offset) {
+  uint64_t ret = 0;
+  for (int shift = 0; offset < buf.size() && shift < 64; shift += 7) {
+    uint8_t byte = static_cast<uint8_t>(buf[offset++]);
+    ret |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) {
+      return ret;
+    }
+  }
+  throw std::runtime_error("Malformed query results");
+}
+
+// The offset after num results from offset on, each a length-delimited
+// field of CollectiveResults.
+static size_t skip_results(std::string_view buf, size_t offset, size_t num) {
+  for (; num > 0 && offset < buf.size(); --num) {
+    uint64_t tag = read_varint(buf, offset);
+    if ((tag & 7) != 2) {
+      throw std::runtime_error("Unexpected field in query results");
+    }
+    uint64_t length = read_varint(buf, offset);
+    if (length > buf.size() - offset) {
+      throw std::runtime_error("Malformed query results");
+    }
+    offset += length;
+  }
+  return offset;
+}
+
+ResultCursors& ResultCursors::get() {
+  static ResultCursors instance;
+  return instance;
+}
+
+void ResultCursors::Init(size_t budget, uint32_t ttl_s) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  budget_ = budget;
+  ttl_ = std::chrono::seconds(ttl_s);
+  LOG(INFO) << "Result cursors are kept within " << budget << " bytes for "
+            << ttl_s << " s";
+}
+
+bool ResultCursors::Open(std::string_view results, size_t page_size,
+                         std::string& page, uint64_t& cursor_id) {
+  size_t end = skip_results(results, 0, page_size);
+  cursor_id = 0;
+  if (end < results.size()) {
+    size_t rest = results.size() - end;
+    auto now = clock_t::now();
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (rest > budget_) {
+      return false;
+    }
+    reserve(rest, now);
+    cursor_id = next_id_++;
+    cursors_.emplace(cursor_id,
+                     Cursor{std::string(results.substr(end)), 0, now});
+    size_ += rest;
+  }
+  page.assign(results.data(), end);
+  return true;
+}
+
+bool ResultCursors::Next(uint64_t cursor_id, size_t page_size,
+                         std::string& page, bool& drained) {
+  auto now = clock_t::now();
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto iter = cursors_.find(cursor_id);
+  if (iter == cursors_.end() || now - iter->second.last_read > ttl_) {
+    if (iter != cursors_.end()) {
+      erase(iter);
+    }
+    return false;
+  }
+  auto& cursor = iter->second;
+  size_t end = skip_results(cursor.results, cursor.offset, page_size);
+  page.assign(cursor.results.data() + cursor.offset, end - cursor.offset);
+  cursor.offset = end;
+  cursor.last_read = now;
+  drained = end == cursor.results.size();
+  if (drained) {
+    erase(iter);
+  }
+  return true;
+}
+
+bool ResultCursors::Close(uint64_t cursor_id) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto iter = cursors_.find(cursor_id);
+  if (iter == cursors_.end()) {
+    return false;
+  }
+  erase(iter);
+  return true;
+}
+
+void ResultCursors::reserve(size_t bytes, clock_t::time_point now) {
+  for (auto iter = cursors_.begin(); iter != cursors_.end();) {
+    auto cur = iter++;
+    if (now - cur->second.last_read > ttl_) {
+      erase(cur);
+    }
+  }
+  while (size_ + bytes > budget_ && !cursors_.empty()) {
+    auto oldest = std::min_element(
+        cursors_.begin(), cursors_.end(), [](const auto& lhs, const auto& rhs) {
+          return lhs.second.last_read < rhs.second.last_read;
+        });
+    LOG(WARNING) << "Close cursor " << oldest->first
+                 << " to keep result cursors within the budget";
+    erase(oldest);
+  }
+}
+
+void ResultCursors::erase(std::unordered_map<uint64_t, Cursor>::iterator iter) {
+  size_ -= iter->second.results.size();
+  cursors_.erase(iter);
+}
+
+}  // namespace server
@@ -0,0 +1,89 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef ENGINES_HTTP_SERVER_RESULT_CURSORS_H_
+#define ENGINES_HTTP_SERVER_RESULT_CURSORS_H_
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace server {
+
+// Results of queries paged through by clients. A query asked for pages
+// replies with the first page_size results, and the rest are spooled under
+// a cursor, from which later pages are fetched, so the client neither
+// receives nor holds the whole result at once.
+//
+// Results are kept serialized: each one is a length-delimited field of
+// results::CollectiveResults, so pages are cut from the spooled bytes
+// without parsing them, and each page is a CollectiveResults itself.
+//
+// Cursors not read for ttl expire, and the bytes of all cursors are kept
+// within a budget by closing those read least recently. Cursors are shared
+// by all shards, a page can be fetched on any connection.
+class ResultCursors {
+ public:
+  static constexpr size_t kDefaultBudget = 1ul << 30;
+  static constexpr uint32_t kDefaultTtlSeconds = 60;
+
+  static ResultCursors& get();
+
+  ResultCursors() : budget_(kDefaultBudget), ttl_(kDefaultTtlSeconds) {}
+
+  void Init(size_t budget, uint32_t ttl_s);
+
+  // Cut the first page off the serialized results into page. The rest is
+  // kept under the returned cursor id, 0 if the page holds all results.
+  //
+  // Returns false if the rest exceeds the whole budget.
+  bool Open(std::string_view results, size_t page_size, std::string& page,
+            uint64_t& cursor_id);
+
+  // Cut the next page of a cursor, which is closed once it is drained, see
+  // Open. Returns false if the cursor has expired or does not exist.
+  bool Next(uint64_t cursor_id, size_t page_size, std::string& page,
+            bool& drained);
+
+  bool Close(uint64_t cursor_id);
+
+ private:
+  using clock_t = std::chrono::steady_clock;
+
+  struct Cursor {
+    std::string results;
+    size_t offset;
+    clock_t::time_point last_read;
+  };
+
+  // drop the expired cursors, then the least recently read ones until bytes
+  // more fit
+  void reserve(size_t bytes, clock_t::time_point now);
+
+  void erase(std::unordered_map<uint64_t, Cursor>::iterator iter);
+
+  std::mutex mutex_;
+  size_t budget_;
+  std::chrono::seconds ttl_;
+  size_t size_{0};
+  uint64_t next_id_{1};
+  std::unordered_map<uint64_t, Cursor> cursors_;
+};
+
+}  // namespace server
+
+#endif  // ENGINES_HTTP_SERVER_RESULT_CURSORS_H_
@@ -154,19 +154,29 @@ std::shared_ptr<BaseStoredProcedure> create_stored_procedure_impl(
       procedure_id, procedure_path, graph_store, gs::GraphStoreType::Grape);
 }
 
-std::string load_and_run(int32_t job_id, const std::string& lib_path,
-                         int32_t shard_id) {
+seastar::sstring serialize_results(const results::CollectiveResults& results) {
+  seastar::sstring content(seastar::sstring::initialized_later(),
+                           results.ByteSizeLong());
+  CHECK(results.SerializeToArray(content.data(), content.size()));
+  return content;
+}
+
+seastar::sstring load_and_run(int32_t job_id, const std::string& lib_path,
+                              int32_t shard_id,
+                              const std::vector<query::Argument>& args) {
   auto temp_stored_procedure =
       server::create_stored_procedure_impl(job_id, lib_path, shard_id);
   LOG(INFO) << "Create stored procedure: " << temp_stored_procedure->ToString();
-  std::vector<char> empty;
-  gs::Decoder input_decoder(empty.data(), empty.size());
+  std::vector<char> input_buffer;
+  gs::Encoder input_encoder(input_buffer);
+  for (auto& arg : args) {
+    put_argment(input_encoder, arg);
+  }
+  gs::Decoder input_decoder(input_buffer.data(), input_buffer.size());
   auto res = temp_stored_procedure->Query(input_decoder);
   LOG(INFO) << "Finish running";
-  LOG(INFO) << res.DebugString();
-  std::string res_str;
-  res.SerializeToString(&res_str);
-  return res_str;
+  VLOG(10) << res.DebugString();
+  return serialize_results(res);
 }
 
 StoredProcedureManager& StoredProcedureManager::get() {
@@ -19,7 +19,10 @@
 #include <string>
 
 #include <yaml-cpp/yaml.h>
+#include <atomic>
 #include <climits>
+#include <filesystem>
+#include <mutex>
 #include <ostream>
 #include <string>
 #include <utility>
@@ -33,13 +36,22 @@
 #include "flex/engines/hqps_db/app/hqps_app_base.h"
 #include "flex/engines/hqps_db/database/mutable_csr_interface.h"
 #include "flex/utils/app_utils.h"
+#include "flex/utils/metrics.h"
+#include "flex/utils/query_memory.h"
 
 #include <seastar/core/print.hh>
 
 namespace server {
 
-std::string load_and_run(int32_t job_id, const std::string& lib_path,
-                         int32_t shard_id);
+// Run the library compiled for an adhoc plan once, with the literals
+// extracted from the plan as its arguments.
+seastar::sstring load_and_run(
+    int32_t job_id, const std::string& lib_path, int32_t shard_id,
+    const std::vector<query::Argument>& args = {});
+
+// Serialize the results into the buffer sent as the reply body, without the
+// intermediate std::string.
+seastar::sstring serialize_results(const results::CollectiveResults& results);
 
 // get the handle of the dynamic library, throw error if needed
 void* open_lib(const char* lib_path);
@@ -106,8 +118,10 @@ class BaseStoredProcedure {
     dl_handle_ = open_lib(procedure_path.c_str());
     CHECK(dl_handle_);
   }
+  // the apps are deleted by the subclasses before the library is closed
   virtual ~BaseStoredProcedure() {
     LOG(INFO) << "Destructing stored procedure" << ToString();
+    close_lib(dl_handle_, procedure_path_.c_str());
   }
   virtual StoredProcedureType GetType() const = 0;
 
@@ -144,10 +158,13 @@ std::shared_ptr<BaseStoredProcedure> create_stored_procedure_impl(
 
 std::vector<std::string> get_yaml_files(const std::string& plugin_dir);
 
+// Procedures can be loaded, replaced and unloaded while queries run. A query
+// holds the procedure it started on until it returns, so the library of a
+// replaced procedure is closed once its last query is done.
 class StoredProcedureManager {
  public:
   static StoredProcedureManager& get();
-  StoredProcedureManager() {}
+  StoredProcedureManager() : next_procedure_id_(0) {}
 
   // expect multiple query.yaml under this directory.
   void LoadFromPluginDir(const std::string& plugin_dir, int32_t shard_id) {
@@ -165,13 +182,54 @@ class StoredProcedureManager {
   void CreateStoredProcedures(
       const std::vector<StoredProcedureMeta>& stored_procedures,
       int32_t shard_id) {
-    for (auto i = 0; i < stored_procedures.size(); ++i) {
-      stored_procedures_.emplace(stored_procedures[i].name,
-                                 server::create_stored_procedure_impl(
-                                     i, stored_procedures[i].path, shard_id));
+    for (auto& meta : stored_procedures) {
+      LoadProcedure(meta.name, meta.path, shard_id);
     }
 
-    LOG(INFO) << "Load [" << stored_procedures_.size() << "] stored procedures";
+    LOG(INFO) << "Load [" << stored_procedures.size() << "] stored procedures";
+  }
+
+  // Load the library at path as the procedure name, replacing the procedure
+  // loaded under this name before. Return false if the library is missing.
+  bool LoadProcedure(const std::string& name, const std::string& path,
+                     int32_t shard_id) {
+    if (!std::filesystem::exists(path)) {
+      LOG(ERROR) << "Stored procedure library not exists: " << path;
+      return false;
+    }
+    auto procedure = server::create_stored_procedure_impl(
+        next_procedure_id_.fetch_add(1), path, shard_id);
+    auto& latency = gs::MetricsRegistry::get().GetHistogram(
+        "hqps_procedure_latency_us",
+        "Microseconds of stored procedure queries by procedure",
+        "procedure=\"" + name + "\"");
+    std::shared_ptr<BaseStoredProcedure> old_procedure;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      latencies_[name] = &latency;
+      auto& cur = stored_procedures_[name];
+      old_procedure = std::move(cur);
+      cur = std::move(procedure);
+    }
+    LOG(INFO) << (old_procedure ? "Replace" : "Load")
+              << " stored procedure: " << name << ", " << path;
+    return true;
+  }
+
+  // Return false if no procedure is loaded under name.
+  bool UnloadProcedure(const std::string& name) {
+    std::shared_ptr<BaseStoredProcedure> old_procedure;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto it = stored_procedures_.find(name);
+      if (it == stored_procedures_.end()) {
+        return false;
+      }
+      old_procedure = std::move(it->second);
+      stored_procedures_.erase(it);
+    }
+    LOG(INFO) << "Unload stored procedure: " << name;
+    return true;
   }
 
   seastar::future<results::CollectiveResults> Query(
@@ -182,20 +240,30 @@ class StoredProcedureManager {
       return seastar::make_exception_future<results::CollectiveResults>(
           std::runtime_error("Query name is empty"));
     }
-    auto it = stored_procedures_.find(query_name);
-    if (it != stored_procedures_.end()) {
+    std::shared_ptr<BaseStoredProcedure> procedure;
+    gs::Histogram* latency = nullptr;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto it = stored_procedures_.find(query_name);
+      if (it != stored_procedures_.end()) {
+        procedure = it->second;
+        latency = latencies_.at(query_name);
+      }
+    }
+    if (procedure) {
       // create a decoder to decode the query
       std::vector<char> input_buffer;
       gs::Encoder input_encoder(input_buffer);
       auto& args = query_pb.arguments();
       for (auto i = 0; i < args.size(); ++i) {
         auto& arg = args[i];
-        LOG(INFO) << "Putting " << i << "th arg" << arg.DebugString();
+        VLOG(10) << "Putting " << i << "th arg" << arg.DebugString();
         put_argment(input_encoder, arg);
       }
-      LOG(INFO) << "Before running " << query_name;
+      VLOG(10) << "Before running " << query_name;
       gs::Decoder input_decoder(input_buffer.data(), input_buffer.size());
-      auto result = it->second->Query(input_decoder);
+      gs::ScopedLatency timer(*latency);
+      auto result = procedure->Query(input_decoder);
       return seastar::make_ready_future<results::CollectiveResults>(
           std::move(result));
     } else {
@@ -206,8 +274,12 @@ class StoredProcedureManager {
   }
 
  private:
+  mutable std::mutex mutex_;
   std::unordered_map<std::string, std::shared_ptr<BaseStoredProcedure>>
       stored_procedures_;
+  // kept after unloading, for the histograms the registry still exposes
+  std::unordered_map<std::string, gs::Histogram*> latencies_;
+  std::atomic<int32_t> next_procedure_id_;
 };
 
 // one stored procedure contains one dynamic lib, two function pointer
@@ -222,11 +294,11 @@ class CypherStoredProcedure : public BaseStoredProcedure {
                         const GRAPH_TYPE& graph,
                         gs::GraphStoreType graph_store_type)
       : BaseStoredProcedure(procedure_id, procedure_path),
+        graph_(graph),
+        graph_store_type_(graph_store_type),
         app_ptr_(nullptr),
         create_app_ptr_(nullptr),
-        delete_app_ptr_(nullptr),
-        graph_(graph),
-        graph_store_type_(graph_store_type) {
+        delete_app_ptr_(nullptr) {
     // get the func_ptr we need for cypher query.
     create_app_ptr_ = reinterpret_cast<CreateAppT*>(get_func_ptr(
         procedure_path_.c_str(), dl_handle_, CREATOR_APP_FUNC_NAME));
@@ -253,7 +325,9 @@ class CypherStoredProcedure : public BaseStoredProcedure {
 
   results::CollectiveResults Query(gs::Decoder& decoder) const override {
     CHECK(app_ptr_);
-    LOG(INFO) << "Start to query with cypher stored procedure";
+    VLOG(10) << "Start to query with cypher stored procedure";
+    // the operators of the query charge their memory to it
+    gs::QueryMemory memory;
     return app_ptr_->Query(graph_, decoder);
   }
 
@@ -272,7 +346,8 @@ class CypherStoredProcedure : public BaseStoredProcedure {
   }
 
  private:
-  const GRAPH_TYPE& graph_;
+  // a copy, the graph the procedure was created with may be a temporary
+  const GRAPH_TYPE graph_;
   gs::GraphStoreType graph_store_type_;
   gs::HqpsAppBase<GRAPH_TYPE>* app_ptr_;
 
@@ -0,0 +1,225 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "flex/storages/rt_mutable_graph/graph_statistics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <sstream>
+#include <string_view>
+
+#include "flex/storages/rt_mutable_graph/mutable_property_fragment.h"
+
+namespace gs {
+
+// Registers of the hyperloglog sketches are indexed by the top bits of the
+// hashes, 2^12 of them estimate within about 2%.
+static constexpr int kSketchBits = 12;
+static constexpr size_t kSketchSize = static_cast<size_t>(1) << kSketchBits;
+
+static inline uint64_t mix_hash(uint64_t x) {
+  x ^= x >> 33;
+  x *= 0xff51afd7ed558ccdull;
+  x ^= x >> 33;
+  x *= 0xc4ceb9fe1a85ec53ull;
+  x ^= x >> 33;
+  return x;
+}
+
+static uint64_t hash_value(const Any& value) {
+  switch (value.type) {
+  case PropertyType::kInt32:
+    return mix_hash(static_cast<uint32_t>(value.value.i));
+  case PropertyType::kInt64:
+    return mix_hash(static_cast<uint64_t>(value.value.l));
+  case PropertyType::kDate:
+    return mix_hash(static_cast<uint64_t>(value.value.d.milli_second));
+  case PropertyType::kDouble: {
+    uint64_t bits;
+    memcpy(&bits, &value.value.db, sizeof(bits));
+    return mix_hash(bits);
+  }
+  case PropertyType::kString:
+    return mix_hash(std::hash<std::string_view>()(value.value.s));
+  default:
+    return 0;
+  }
+}
+
+class DistinctSketch {
+ public:
+  DistinctSketch() : registers_(kSketchSize, 0) {}
+
+  void add(uint64_t hash) {
+    size_t index = hash >> (64 - kSketchBits);
+    uint64_t rest = hash << kSketchBits;
+    uint8_t rank =
+        rest == 0 ? 64 - kSketchBits + 1 : __builtin_clzll(rest) + 1;
+    registers_[index] = std::max(registers_[index], rank);
+  }
+
+  size_t estimate() const {
+    double sum = 0;
+    size_t zeros = 0;
+    for (auto reg : registers_) {
+      sum += std::ldexp(1.0, -static_cast<int>(reg));
+      zeros += (reg == 0);
+    }
+    double m = kSketchSize;
+    double ret = 0.7213 / (1 + 1.079 / m) * m * m / sum;
+    if (ret <= 2.5 * m && zeros != 0) {
+      // linear counting is more accurate for small cardinalities
+      ret = m * std::log(m / zeros);
+    }
+    return static_cast<size_t>(ret + 0.5);
+  }
+
+ private:
+  std::vector<uint8_t> registers_;
+};
+
+static void collect_degrees(const MutablePropertyFragment& graph,
+                            const MutableCsrBase* csr, label_t label,
+                            size_t vertex_num, DegreeStatistics& stats) {
+  if (csr == nullptr) {
+    return;
+  }
+  for (vid_t v = 0; v < vertex_num; ++v) {
+    if (graph.is_vertex_deleted(label, v)) {
+      continue;
+    }
+    size_t degree = csr->edge_iter(v)->size();
+    size_t bucket = degree == 0 ? 0 : 64 - __builtin_clzll(degree);
+    if (bucket >= stats.histogram.size()) {
+      stats.histogram.resize(bucket + 1, 0);
+    }
+    ++stats.histogram[bucket];
+    stats.edge_num += degree;
+    stats.max_degree = std::max(stats.max_degree, degree);
+  }
+}
+
+GraphStatistics::GraphStatistics() : ts_(0) {}
+
+GraphStatistics::~GraphStatistics() {}
+
+void GraphStatistics::Collect(const MutablePropertyFragment& graph,
+                              const std::vector<size_t>& vertex_nums,
+                              timestamp_t ts) {
+  const auto& schema = graph.schema();
+  label_t vertex_label_num = schema.vertex_label_num();
+  label_t edge_label_num = schema.edge_label_num();
+  ts_ = ts;
+  vertex_nums_.assign(vertex_label_num, 0);
+  edges_.clear();
+  properties_.clear();
+
+  for (label_t label = 0; label < vertex_label_num; ++label) {
+    for (vid_t v = 0; v < vertex_nums[label]; ++v) {
+      vertex_nums_[label] += !graph.is_vertex_deleted(label, v);
+    }
+
+    const auto& table = graph.get_vertex_table(label);
+    auto col_names = table.column_names();
+    for (size_t i = 0; i < table.col_num(); ++i) {
+      auto column = table.get_column_by_id(i);
+      DistinctSketch sketch;
+      for (vid_t v = 0; v < vertex_nums[label]; ++v) {
+        if (!graph.is_vertex_deleted(label, v)) {
+          sketch.add(hash_value(column->get(v)));
+        }
+      }
+      PropertyStatistics stats;
+      stats.label = label;
+      stats.name = col_names[i];
+      stats.ndv = std::min(sketch.estimate(), vertex_nums_[label]);
+      properties_.emplace_back(std::move(stats));
+    }
+  }
+
+  for (label_t src = 0; src < vertex_label_num; ++src) {
+    auto src_name = schema.get_vertex_label_name(src);
+    for (label_t dst = 0; dst < vertex_label_num; ++dst) {
+      auto dst_name = schema.get_vertex_label_name(dst);
+      for (label_t edge = 0; edge < edge_label_num; ++edge) {
+        auto edge_name = schema.get_edge_label_name(edge);
+        if (!schema.exist(src_name, dst_name, edge_name)) {
+          continue;
+        }
+        EdgeStatistics stats;
+        stats.src_label = src;
+        stats.dst_label = dst;
+        stats.edge_label = edge;
+        collect_degrees(graph, graph.get_oe_csr(src, dst, edge), src,
+                        vertex_nums[src], stats.out_degree);
+        collect_degrees(graph, graph.get_ie_csr(dst, src, edge), dst,
+                        vertex_nums[dst], stats.in_degree);
+        edges_.emplace_back(std::move(stats));
+      }
+    }
+  }
+}
+
+static void degrees_to_json(const DegreeStatistics& stats,
+                            std::stringstream& ss) {
+  ss << "{\"edge_num\": " << stats.edge_num
+     << ", \"max_degree\": " << stats.max_degree << ", \"histogram\": [";
+  for (size_t i = 0; i < stats.histogram.size(); ++i) {
+    ss << (i == 0 ? "" : ", ") << stats.histogram[i];
+  }
+  ss << "]}";
+}
+
+std::string GraphStatistics::ToJson(
+    const MutablePropertyFragment& graph) const {
+  const auto& schema = graph.schema();
+  std::stringstream ss;
+  ss << "{\"timestamp\": " << ts_ << ", \"vertices\": [";
+  size_t prop_ind = 0;
+  for (label_t label = 0; label < vertex_nums_.size(); ++label) {
+    ss << (label == 0 ? "" : ", ") << "{\"label\": \""
+       << schema.get_vertex_label_name(label)
+       << "\", \"num\": " << vertex_nums_[label] << ", \"properties\": [";
+    bool first = true;
+    for (; prop_ind < properties_.size() &&
+           properties_[prop_ind].label == label;
+         ++prop_ind) {
+      ss << (first ? "" : ", ") << "{\"name\": \""
+         << properties_[prop_ind].name
+         << "\", \"ndv\": " << properties_[prop_ind].ndv << "}";
+      first = false;
+    }
+    ss << "]}";
+  }
+  ss << "], \"edges\": [";
+  for (size_t i = 0; i < edges_.size(); ++i) {
+    const auto& stats = edges_[i];
+    ss << (i == 0 ? "" : ", ") << "{\"src\": \""
+       << schema.get_vertex_label_name(stats.src_label) << "\", \"dst\": \""
+       << schema.get_vertex_label_name(stats.dst_label) << "\", \"edge\": \""
+       << schema.get_edge_label_name(stats.edge_label)
+       << "\", \"out_degree\": ";
+    degrees_to_json(stats.out_degree, ss);
+    ss << ", \"in_degree\": ";
+    degrees_to_json(stats.in_degree, ss);
+    ss << "}";
+  }
+  ss << "]}";
+  return ss.str();
+}
+
+}  // namespace gs
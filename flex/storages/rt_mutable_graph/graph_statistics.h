@@ -0,0 +1,99 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GRAPHSCOPE_GRAPH_GRAPH_STATISTICS_H_
+#define GRAPHSCOPE_GRAPH_GRAPH_STATISTICS_H_
+
+#include <string>
+#include <vector>
+
+#include "flex/storages/rt_mutable_graph/types.h"
+
+namespace gs {
+
+class MutablePropertyFragment;
+
+/**
+ * @brief Degree distribution of one direction of an edge triple. Bucket 0 of
+ * the histogram counts the vertices without edges, and bucket b the vertices
+ * of degree in [2^(b-1), 2^b).
+ */
+struct DegreeStatistics {
+  size_t edge_num{0};
+  size_t max_degree{0};
+  std::vector<size_t> histogram;
+};
+
+struct EdgeStatistics {
+  label_t src_label;
+  label_t dst_label;
+  label_t edge_label;
+  DegreeStatistics out_degree;
+  DegreeStatistics in_degree;
+};
+
+struct PropertyStatistics {
+  label_t label;
+  std::string name;
+  // estimated number of distinct values
+  size_t ndv{0};
+};
+
+/**
+ * @brief Statistics of a graph for the query planner, to order joins and to
+ * choose the direction of expansions.
+ *
+ * Vertex counts exclude deleted vertices. Degrees are the sizes of the
+ * adjacency lists, which may still hold edges newer than the collection or
+ * deleted but not compacted yet, so they are estimates as the distinct value
+ * counts are.
+ */
+class GraphStatistics {
+ public:
+  GraphStatistics();
+  ~GraphStatistics();
+
+  /**
+   * @brief Collect the statistics of the first vertex_nums[label] vertices of
+   * each label, see MutablePropertyFragment::Serialize.
+   */
+  void Collect(const MutablePropertyFragment& graph,
+               const std::vector<size_t>& vertex_nums, timestamp_t ts);
+
+  bool empty() const { return vertex_nums_.empty(); }
+
+  timestamp_t timestamp() const { return ts_; }
+
+  const std::vector<size_t>& vertex_nums() const { return vertex_nums_; }
+
+  const std::vector<EdgeStatistics>& edges() const { return edges_; }
+
+  const std::vector<PropertyStatistics>& properties() const {
+    return properties_;
+  }
+
+  /** @brief Dump as json, with labels by name. */
+  std::string ToJson(const MutablePropertyFragment& graph) const;
+
+ private:
+  timestamp_t ts_;
+  std::vector<size_t> vertex_nums_;
+  std::vector<EdgeStatistics> edges_;
+  std::vector<PropertyStatistics> properties_;
+};
+
+}  // namespace gs
+
+#endif  // GRAPHSCOPE_GRAPH_GRAPH_STATISTICS_H_
@@ -0,0 +1,132 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "flex/storages/rt_mutable_graph/memory_usage.h"
+
+#include <sstream>
+
+#include "flex/storages/rt_mutable_graph/mutable_property_fragment.h"
+
+namespace gs {
+
+static CsrMemoryUsage csr_memory_usage(const MutableCsrBase* csr) {
+  return csr == nullptr ? CsrMemoryUsage() : csr->memory_usage();
+}
+
+void MemoryUsage::Collect(const MutablePropertyFragment& graph) {
+  const auto& schema = graph.schema();
+  label_t vertex_label_num = schema.vertex_label_num();
+  label_t edge_label_num = schema.edge_label_num();
+  vertices_.clear();
+  edges_.clear();
+
+  for (label_t label = 0; label < vertex_label_num; ++label) {
+    VertexMemoryUsage usage;
+    usage.label = label;
+    usage.indexer_bytes = graph.indexer_memory_usage(label);
+    const auto& table = graph.get_vertex_table(label);
+    auto col_names = table.column_names();
+    for (size_t i = 0; i < table.col_num(); ++i) {
+      usage.columns.push_back(ColumnMemoryUsage{
+          col_names[i], table.get_column_by_id(i)->memory_usage()});
+    }
+    vertices_.emplace_back(std::move(usage));
+  }
+
+  for (label_t src = 0; src < vertex_label_num; ++src) {
+    auto src_name = schema.get_vertex_label_name(src);
+    for (label_t dst = 0; dst < vertex_label_num; ++dst) {
+      auto dst_name = schema.get_vertex_label_name(dst);
+      for (label_t edge = 0; edge < edge_label_num; ++edge) {
+        auto edge_name = schema.get_edge_label_name(edge);
+        if (!schema.exist(src_name, dst_name, edge_name)) {
+          continue;
+        }
+        EdgeMemoryUsage usage;
+        usage.src_label = src;
+        usage.dst_label = dst;
+        usage.edge_label = edge;
+        usage.out_csr = csr_memory_usage(graph.get_oe_csr(src, dst, edge));
+        usage.in_csr = csr_memory_usage(graph.get_ie_csr(dst, src, edge));
+        const Table* table = graph.get_edge_table(src, dst, edge);
+        if (table != nullptr) {
+          for (size_t i = 0; i < table->col_num(); ++i) {
+            usage.table_bytes += table->get_column_by_id(i)->memory_usage();
+          }
+        }
+        edges_.emplace_back(std::move(usage));
+      }
+    }
+  }
+}
+
+size_t MemoryUsage::graph_bytes() const {
+  size_t bytes = 0;
+  for (const auto& usage : vertices_) {
+    bytes += usage.indexer_bytes;
+    for (const auto& column : usage.columns) {
+      bytes += column.bytes;
+    }
+  }
+  for (const auto& usage : edges_) {
+    bytes += usage.out_csr.total() + usage.in_csr.total() + usage.table_bytes;
+  }
+  return bytes;
+}
+
+static void csr_to_json(const CsrMemoryUsage& usage, std::stringstream& ss) {
+  ss << "{\"live\": " << usage.live << ", \"slack\": " << usage.slack
+     << ", \"garbage\": " << usage.garbage << "}";
+}
+
+std::string MemoryUsage::ToJson(const MutablePropertyFragment& graph) const {
+  const auto& schema = graph.schema();
+  std::stringstream ss;
+  ss << "{\"graph_bytes\": " << graph_bytes() << ", \"vertices\": [";
+  for (size_t i = 0; i < vertices_.size(); ++i) {
+    const auto& usage = vertices_[i];
+    ss << (i == 0 ? "" : ", ") << "{\"label\": \""
+       << schema.get_vertex_label_name(usage.label)
+       << "\", \"indexer_bytes\": " << usage.indexer_bytes
+       << ", \"properties\": [";
+    for (size_t j = 0; j < usage.columns.size(); ++j) {
+      ss << (j == 0 ? "" : ", ") << "{\"name\": \"" << usage.columns[j].name
+         << "\", \"bytes\": " << usage.columns[j].bytes << "}";
+    }
+    ss << "]}";
+  }
+  ss << "], \"edges\": [";
+  for (size_t i = 0; i < edges_.size(); ++i) {
+    const auto& usage = edges_[i];
+    ss << (i == 0 ? "" : ", ") << "{\"src\": \""
+       << schema.get_vertex_label_name(usage.src_label) << "\", \"dst\": \""
+       << schema.get_vertex_label_name(usage.dst_label) << "\", \"edge\": \""
+       << schema.get_edge_label_name(usage.edge_label) << "\", \"out_csr\": ";
+    csr_to_json(usage.out_csr, ss);
+    ss << ", \"in_csr\": ";
+    csr_to_json(usage.in_csr, ss);
+    ss << ", \"table_bytes\": " << usage.table_bytes << "}";
+  }
+  ss << "], \"sessions\": [";
+  for (size_t i = 0; i < sessions_.size(); ++i) {
+    ss << (i == 0 ? "" : ", ") << "{\"id\": " << i
+       << ", \"arena_bytes\": " << sessions_[i].arena_bytes
+       << ", \"wal_bytes\": " << sessions_[i].wal_bytes << "}";
+  }
+  ss << "], \"shared_wal_bytes\": " << shared_wal_bytes_ << "}";
+  return ss.str();
+}
+
+}  // namespace gs
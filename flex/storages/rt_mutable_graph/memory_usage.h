@@ -0,0 +1,107 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GRAPHSCOPE_GRAPH_MEMORY_USAGE_H_
+#define GRAPHSCOPE_GRAPH_MEMORY_USAGE_H_
+
+#include <string>
+#include <vector>
+
+#include "flex/storages/rt_mutable_graph/mutable_csr.h"
+#include "flex/storages/rt_mutable_graph/types.h"
+
+namespace gs {
+
+class MutablePropertyFragment;
+
+struct ColumnMemoryUsage {
+  std::string name;
+  size_t bytes{0};
+};
+
+struct VertexMemoryUsage {
+  label_t label;
+  // the LFIndexer mapping oids to vids
+  size_t indexer_bytes{0};
+  std::vector<ColumnMemoryUsage> columns;
+};
+
+struct EdgeMemoryUsage {
+  label_t src_label;
+  label_t dst_label;
+  label_t edge_label;
+  CsrMemoryUsage out_csr;
+  CsrMemoryUsage in_csr;
+  // columns of the edge table, for edge types with several properties
+  size_t table_bytes{0};
+};
+
+struct SessionMemoryUsage {
+  // held by the arena allocator of the session
+  size_t arena_bytes{0};
+  // written to the wal file the session is appending to
+  size_t wal_bytes{0};
+};
+
+/**
+ * @brief Bytes of memory held by a graph, by vertex label, property and edge
+ * triple, and by the sessions writing to it, to plan capacity and to
+ * schedule compactions.
+ *
+ * Bytes of columns, indexers and csrs are those backed or mapped, which for
+ * disk based columns and snapshots mapped from files are page cache rather
+ * than anonymous memory. They are read while transactions go on, so they
+ * are approximate.
+ */
+class MemoryUsage {
+ public:
+  MemoryUsage() {}
+  ~MemoryUsage() {}
+
+  void Collect(const MutablePropertyFragment& graph);
+
+  /** @brief Record the usage of the next session, by session id. */
+  void AddSession(const SessionMemoryUsage& usage) {
+    sessions_.push_back(usage);
+  }
+
+  /**
+   * @brief Record the wal written outside of sessions: by the group
+   * committer, and the sealed files waiting for a checkpoint.
+   */
+  void SetSharedWalBytes(size_t bytes) { shared_wal_bytes_ = bytes; }
+
+  const std::vector<VertexMemoryUsage>& vertices() const { return vertices_; }
+
+  const std::vector<EdgeMemoryUsage>& edges() const { return edges_; }
+
+  const std::vector<SessionMemoryUsage>& sessions() const { return sessions_; }
+
+  /** @brief Bytes of the graph, excluding sessions and wals. */
+  size_t graph_bytes() const;
+
+  /** @brief Dump as json, with labels by name. */
+  std::string ToJson(const MutablePropertyFragment& graph) const;
+
+ private:
+  std::vector<VertexMemoryUsage> vertices_;
+  std::vector<EdgeMemoryUsage> edges_;
+  std::vector<SessionMemoryUsage> sessions_;
+  size_t shared_wal_bytes_{0};
+};
+
+}  // namespace gs
+
+#endif  // GRAPHSCOPE_GRAPH_MEMORY_USAGE_H_
@@ -15,23 +15,82 @@
 
 #include "flex/storages/rt_mutable_graph/mutable_csr.h"
 
-#include "grape/serialization/in_archive.h"
+#include <algorithm>
+#include <filesystem>
+#include <numeric>
+
 #include "grape/serialization/out_archive.h"
 
 namespace gs {
 
-grape::InArchive& operator<<(grape::InArchive& in_archive,
-                             const MutableNbr<std::string>& value) {
-  in_archive << value.neighbor << value.timestamp.load() << value.data;
-  return in_archive;
-}
+// Nbrs of string edges are archived with their strings inline, in the layout
+// of an archived std::vector, so snapshots written before strings were pooled
+// are still loadable. They are written as they are visited, the sizes in the
+// header are filled in by close.
+class StringNbrWriter {
+ public:
+  explicit StringNbrWriter(const std::string& path)
+      : fout_(fopen(path.c_str(), "wb")), num_(0), arc_size_(sizeof(size_t)) {
+    CHECK(fout_ != NULL) << "failed to open " << path;
+    write(&arc_size_, sizeof(size_t));
+    write(&num_, sizeof(size_t));
+  }
 
-grape::OutArchive& operator>>(grape::OutArchive& out_archive,
-                              MutableNbr<std::string>& value) {
-  timestamp_t ts;
-  out_archive >> value.neighbor >> ts >> value.data;
-  value.timestamp.store(ts);
-  return out_archive;
+  void append(vid_t neighbor, timestamp_t ts, const std::string_view& data) {
+    size_t len = data.size();
+    write(&neighbor, sizeof(vid_t));
+    write(&ts, sizeof(timestamp_t));
+    write(&len, sizeof(size_t));
+    write(data.data(), len);
+    arc_size_ += sizeof(vid_t) + sizeof(timestamp_t) + sizeof(size_t) + len;
+    ++num_;
+  }
+
+  void close() {
+    CHECK_EQ(fseek(fout_, 0, SEEK_SET), 0);
+    write(&arc_size_, sizeof(size_t));
+    write(&num_, sizeof(size_t));
+    fflush(fout_);
+    fclose(fout_);
+  }
+
+ private:
+  void write(const void* ptr, size_t size) {
+    if (size != 0) {
+      CHECK_EQ(fwrite(ptr, 1, size, fout_), size);
+    }
+  }
+
+  FILE* fout_;
+  size_t num_;
+  size_t arc_size_;
+};
+
+// Decodes a file written by StringNbrWriter from the mapped file directly,
+// the strings are copied into pool.
+template <typename ARRAY_T>
+static void load_string_nbrs(const std::string& path, StringPool& pool,
+                             ARRAY_T& nbrs) {
+  mmap_array<char> buffer;
+  buffer.open_for_read(path);
+  size_t arc_size;
+  CHECK_GE(buffer.size(), sizeof(size_t));
+  memcpy(&arc_size, buffer.data(), sizeof(size_t));
+  CHECK_EQ(buffer.size(), sizeof(size_t) + arc_size);
+  grape::OutArchive arc;
+  arc.SetSlice(buffer.data() + sizeof(size_t), arc_size);
+  size_t num;
+  arc >> num;
+  nbrs.resize(num);
+  for (size_t i = 0; i < num; ++i) {
+    auto& nbr = nbrs[i];
+    timestamp_t ts;
+    size_t len;
+    arc >> nbr.neighbor >> ts >> len;
+    nbr.timestamp.store(ts);
+    nbr.data = pool.append(
+        std::string_view(static_cast<const char*>(arc.GetBytes(len)), len));
+  }
 }
 
 template <typename EDATA_T>
@@ -54,30 +113,124 @@ void MutableCsr<EDATA_T>::Serialize(const std::string& path) {
   init_nbr_list_.dump_to_file(path + ".nbr_list", init_nbr_list_.size());
 }
 
+template <typename EDATA_T>
+void MutableCsr<EDATA_T>::Serialize(const std::string& path, timestamp_t ts) {
+  std::vector<int> size_list(capacity_, 0);
+  FILE* nbr_fout = fopen((path + ".nbr_list").c_str(), "wb");
+  std::vector<nbr_t> buffer;
+  for (vid_t i = 0; i < capacity_; ++i) {
+    // lock the list so that a concurrent put_edge never exposes a half
+    // written neighbor or a buffer being grown
+    locks_[i].lock();
+    auto edges = adj_lists_[i].get_edges();
+    buffer.clear();
+    for (auto& nbr : edges) {
+      timestamp_t nbr_ts = nbr.timestamp.load();
+      if (nbr_ts <= ts && nbr_ts != kDeletedTimestamp) {
+        buffer.emplace_back(nbr);
+      }
+    }
+    locks_[i].unlock();
+
+    // keep the slack layout expected by Deserialize
+    int degree = buffer.size();
+    buffer.resize(degree + (degree + 4) / 5);
+    if (!buffer.empty()) {
+      CHECK_EQ(fwrite(buffer.data(), sizeof(nbr_t), buffer.size(), nbr_fout),
+               buffer.size());
+    }
+    size_list[i] = degree;
+  }
+  fflush(nbr_fout);
+  fclose(nbr_fout);
+
+  size_t size_list_size = size_list.size();
+  std::string degree_file_path = path + ".degree";
+  FILE* fout = fopen(degree_file_path.c_str(), "wb");
+  CHECK_EQ(fwrite(&size_list_size, sizeof(size_t), 1, fout), 1);
+  CHECK_EQ(fwrite(size_list.data(), sizeof(int), size_list_size, fout),
+           size_list_size);
+  fflush(fout);
+  fclose(fout);
+}
+
+// Maps a degree file written by Serialize, the returned list is valid as long
+// as buffer is not released.
+static const int* map_degree_list(const std::string& path,
+                                  mmap_array<char>& buffer,
+                                  size_t& size_list_size) {
+  buffer.open_for_read(path + ".degree");
+  CHECK_GE(buffer.size(), sizeof(size_t));
+  memcpy(&size_list_size, buffer.data(), sizeof(size_t));
+  CHECK_EQ(buffer.size(), sizeof(size_t) + size_list_size * sizeof(int));
+  return reinterpret_cast<const int*>(buffer.data() + sizeof(size_t));
+}
+
 template <typename EDATA_T>
 void MutableCsr<EDATA_T>::Deserialize(const std::string& path) {
+  // nbr lists are mapped privately instead of being read, so loading costs no
+  // copy, clean pages are shared with other processes mapping the same
+  // snapshot, and only the pages of lists appended in place are copied
   size_t size_list_size;
-  std::vector<int> size_list;
-  {
-    std::string degree_file_path = path + ".degree";
-    FILE* fin = fopen(degree_file_path.c_str(), "r");
-    CHECK_EQ(fread(&size_list_size, sizeof(size_t), 1, fin), 1);
-    size_list.resize(size_list_size);
-    CHECK_EQ(fread(size_list.data(), sizeof(int), size_list_size, fin),
-             size_list_size);
-    fclose(fin);
-  }
+  mmap_array<char> degree_buffer;
+  const int* size_list = map_degree_list(path, degree_buffer, size_list_size);
 
   init_nbr_list_.open_for_read(path + ".nbr_list");
   capacity_ = size_list_size;
   adj_lists_ = static_cast<adjlist_t*>(malloc(sizeof(adjlist_t) * capacity_));
   locks_ = new grape::SpinLock[capacity_];
+  init_sorted_sizes();
+  nbr_positions_.resize(capacity_);
   nbr_t* ptr = init_nbr_list_.data();
   for (vid_t i = 0; i < capacity_; ++i) {
     size_t cur_cap = size_list[i] + (size_list[i] + 4) / 5;
     adj_lists_[i].init(ptr, cur_cap, size_list[i]);
     ptr += cur_cap;
   }
+  // snapshots keep the order of lists, so only their tails need sorting and
+  // the pages of lists already sorted stay clean
+  batch_sort_edges();
+}
+
+// Copies the size nbrs of list, of which the first sorted_size are sorted
+// already, into buffer in the order of less.
+template <typename NBR_T, typename LESS_T>
+static void copy_sorted(NBR_T* buffer, const NBR_T* list, int size,
+                        int sorted_size, const LESS_T& less) {
+  std::vector<int> order(size);
+  std::iota(order.begin(), order.end(), 0);
+  auto cmp = [list, &less](int lhs, int rhs) {
+    return less(list[lhs], list[rhs]);
+  };
+  std::sort(order.begin() + sorted_size, order.end(), cmp);
+  std::inplace_merge(order.begin(), order.begin() + sorted_size, order.end(),
+                     cmp);
+  for (int k = 0; k < size; ++k) {
+    UninitializedUtils<NBR_T>::copy(buffer + k,
+                                    const_cast<NBR_T*>(list + order[k]), 1);
+  }
+}
+
+template <typename EDATA_T>
+void MutableCsr<EDATA_T>::batch_sort_edges() {
+  if (order_ == NbrOrder::kInsertion) {
+    return;
+  }
+  auto less = [this](const nbr_t& lhs, const nbr_t& rhs) {
+    return nbr_less(lhs, rhs);
+  };
+  std::vector<nbr_t> buffer;
+  for (vid_t i = 0; i < capacity_; ++i) {
+    auto& list = adj_lists_[i];
+    int size = list.size();
+    nbr_t* begin = list.data();
+    if (!std::is_sorted(begin, begin + size, less)) {
+      buffer.resize(size);
+      copy_sorted(buffer.data(), begin, size, 0, less);
+      UninitializedUtils<nbr_t>::copy(begin, buffer.data(), size);
+    }
+    sorted_sizes_[i].store(size);
+  }
 }
 
 void MutableCsr<std::string>::Serialize(const std::string& path) {
@@ -96,14 +249,43 @@ void MutableCsr<std::string>::Serialize(const std::string& path) {
     fclose(fout);
   }
 
-  grape::InArchive arc;
-  arc << nbr_list_;
+  StringNbrWriter writer(path + ".nbr_list");
+  for (auto& nbr : nbr_list_) {
+    writer.append(nbr.neighbor, nbr.timestamp.load(), nbr.data);
+  }
+  writer.close();
+}
+
+void MutableCsr<std::string>::Serialize(const std::string& path,
+                                        timestamp_t ts) {
+  std::vector<int> size_list(capacity_, 0);
+  StringNbrWriter writer(path + ".nbr_list");
+  for (vid_t i = 0; i < capacity_; ++i) {
+    locks_[i].lock();
+    auto edges = adj_lists_[i].get_edges();
+    int degree = 0;
+    for (auto& nbr : edges) {
+      timestamp_t nbr_ts = nbr.timestamp.load();
+      if (nbr_ts <= ts && nbr_ts != kDeletedTimestamp) {
+        writer.append(nbr.neighbor, nbr_ts, nbr.data);
+        ++degree;
+      }
+    }
+    locks_[i].unlock();
+    // keep the slack layout expected by Deserialize
+    for (int k = 0; k < (degree + 4) / 5; ++k) {
+      writer.append(0, 0, std::string_view());
+    }
+    size_list[i] = degree;
+  }
+  writer.close();
   {
-    size_t arc_size = arc.GetSize();
-    std::string nbr_list_file_path = path + ".nbr_list";
-    FILE* fout = fopen(nbr_list_file_path.c_str(), "wb");
-    CHECK_EQ(fwrite(&arc_size, sizeof(size_t), 1, fout), 1);
-    CHECK_EQ(fwrite(arc.GetBuffer(), 1, arc_size, fout), arc_size);
+    size_t size_list_size = size_list.size();
+    std::string degree_file_path = path + ".degree";
+    FILE* fout = fopen(degree_file_path.c_str(), "wb");
+    CHECK_EQ(fwrite(&size_list_size, sizeof(size_t), 1, fout), 1);
+    CHECK_EQ(fwrite(size_list.data(), sizeof(int), size_list_size, fout),
+             size_list_size);
     fflush(fout);
     fclose(fout);
   }
@@ -111,32 +293,15 @@ void MutableCsr<std::string>::Serialize(const std::string& path) {
 
 void MutableCsr<std::string>::Deserialize(const std::string& path) {
   size_t size_list_size;
-  std::vector<int> size_list;
-  {
-    std::string degree_file_path = path + ".degree";
-    FILE* fin = fopen(degree_file_path.c_str(), "r");
-    CHECK_EQ(fread(&size_list_size, sizeof(size_t), 1, fin), 1);
-    size_list.resize(size_list_size);
-    CHECK_EQ(fread(size_list.data(), sizeof(int), size_list_size, fin),
-             size_list_size);
-    fclose(fin);
-  }
+  mmap_array<char> degree_buffer;
+  const int* size_list = map_degree_list(path, degree_buffer, size_list_size);
 
-  grape::OutArchive arc;
-  {
-    std::string nbr_list_file_path = path + ".nbr_list";
-    FILE* fin = fopen(nbr_list_file_path.c_str(), "r");
-    size_t arc_size;
-    CHECK_EQ(fread(&arc_size, sizeof(size_t), 1, fin), 1);
-    arc.Allocate(arc_size);
-    CHECK_EQ(fread(arc.GetBuffer(), 1, arc_size, fin), arc_size);
-    fclose(fin);
-  }
-  arc >> nbr_list_;
+  load_string_nbrs(path + ".nbr_list", pool_, nbr_list_);
 
   capacity_ = size_list_size;
   adj_lists_ = static_cast<adjlist_t*>(malloc(sizeof(adjlist_t) * capacity_));
   locks_ = new grape::SpinLock[capacity_];
+  nbr_positions_.resize(capacity_);
   nbr_t* ptr = nbr_list_.data();
   for (vid_t i = 0; i < capacity_; ++i) {
     size_t cur_cap = size_list[i] + (size_list[i] + 4) / 5;
@@ -145,32 +310,549 @@ void MutableCsr<std::string>::Deserialize(const std::string& path) {
   }
 }
 
+template <typename NBR_T>
+static bool scan_exist(const NBR_T* begin, const NBR_T* end, vid_t dst,
+                       timestamp_t ts) {
+  for (const NBR_T* ptr = begin; ptr != end; ++ptr) {
+    if (ptr->neighbor == dst && ptr->timestamp.load() <= ts) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Looks dst up in the positions of the list of src, created on first use,
+// with the lock of src held so that appends and compaction do not move the
+// list under the lookup.
+template <typename ADJLIST_T>
+static bool positions_exist(const ADJLIST_T& list, grape::SpinLock& lock,
+                            std::unique_ptr<NbrPositions>& positions,
+                            vid_t dst, timestamp_t ts) {
+  lock.lock();
+  if (positions == nullptr) {
+    positions = std::make_unique<NbrPositions>();
+  }
+  bool ret = positions->contains(list.data(), list.size(), dst, ts);
+  lock.unlock();
+  return ret;
+}
+
+template <typename EDATA_T>
+bool MutableCsr<EDATA_T>::exist(vid_t src, vid_t dst, timestamp_t ts) const {
+  if (src >= capacity_) {
+    return false;
+  }
+  if (order_ == NbrOrder::kNeighbor) {
+    auto edges = get_sorted_edges(src);
+    const nbr_t* end = edges.first.end();
+    for (const nbr_t* ptr = gallop_lower_bound(edges.first.begin(), end, dst);
+         ptr != end && ptr->neighbor == dst; ++ptr) {
+      if (ptr->timestamp.load() <= ts) {
+        return true;
+      }
+    }
+    return scan_exist(edges.second.begin(), edges.second.end(), dst, ts);
+  }
+  const auto& list = adj_lists_[src];
+  if (list.size() < NbrPositions::kMinDegree) {
+    auto edges = list.get_edges();
+    return scan_exist(edges.begin(), edges.end(), dst, ts);
+  }
+  return positions_exist(list, locks_[src], nbr_positions_[src], dst, ts);
+}
+
+bool MutableCsr<std::string>::exist(vid_t src, vid_t dst,
+                                    timestamp_t ts) const {
+  if (src >= capacity_) {
+    return false;
+  }
+  const auto& list = adj_lists_[src];
+  if (list.size() < NbrPositions::kMinDegree) {
+    auto edges = list.get_edges();
+    return scan_exist(edges.begin(), edges.end(), dst, ts);
+  }
+  return positions_exist(list, locks_[src], nbr_positions_[src], dst, ts);
+}
+
+// Marks the nbrs of list, whose neighbor is dst unless all is set, as
+// deleted. The max timestamp of the list is raised before the first one, so
+// that readers check the timestamps of the list again until it is compacted.
+template <typename EDATA_T>
+static size_t mark_deleted(MutableNbrSliceMut<EDATA_T> edges, vid_t dst,
+                           bool all) {
+  size_t num = 0;
+  for (auto* ptr = edges.begin(); ptr != edges.end(); ++ptr) {
+    if ((all || ptr->neighbor == dst) &&
+        ptr->timestamp.load() != kDeletedTimestamp) {
+      if (num == 0) {
+        raise_timestamp(*edges.max_timestamp(), kDeletedTimestamp);
+      }
+      ptr->timestamp.store(kDeletedTimestamp);
+      ++num;
+    }
+  }
+  return num;
+}
+
+// Copies the nbrs of list not deleted into buffer, keeping their order.
+template <typename NBR_T>
+static int copy_live(NBR_T* buffer, const NBR_T* list, int size) {
+  int num = 0;
+  for (int k = 0; k < size; ++k) {
+    if (list[k].timestamp.load() != kDeletedTimestamp) {
+      UninitializedUtils<NBR_T>::copy(buffer + num,
+                                      const_cast<NBR_T*>(list + k), 1);
+      ++num;
+    }
+  }
+  return num;
+}
+
+template <typename NBR_T>
+static int count_live(const NBR_T* list, int size) {
+  int num = 0;
+  for (int k = 0; k < size; ++k) {
+    if (list[k].timestamp.load() != kDeletedTimestamp) {
+      ++num;
+    }
+  }
+  return num;
+}
+
+template <typename EDATA_T>
+size_t MutableCsr<EDATA_T>::delete_edges(vid_t src, vid_t dst) {
+  if (src >= capacity_) {
+    return 0;
+  }
+  size_t num = mark_deleted(adj_lists_[src].get_edges_mut(), dst, false);
+  if (num != 0) {
+    deleted_lists_.push_back(src);
+  }
+  return num;
+}
+
+template <typename EDATA_T>
+size_t MutableCsr<EDATA_T>::delete_edges(vid_t src) {
+  if (src >= capacity_) {
+    return 0;
+  }
+  size_t num = mark_deleted(adj_lists_[src].get_edges_mut(), 0, true);
+  if (num != 0) {
+    deleted_lists_.push_back(src);
+  }
+  return num;
+}
+
+size_t MutableCsr<std::string>::delete_edges(vid_t src, vid_t dst) {
+  if (src >= capacity_) {
+    return 0;
+  }
+  size_t num = mark_deleted(adj_lists_[src].get_edges_mut(), dst, false);
+  if (num != 0) {
+    deleted_lists_.push_back(src);
+  }
+  return num;
+}
+
+size_t MutableCsr<std::string>::delete_edges(vid_t src) {
+  if (src >= capacity_) {
+    return 0;
+  }
+  size_t num = mark_deleted(adj_lists_[src].get_edges_mut(), 0, true);
+  if (num != 0) {
+    deleted_lists_.push_back(src);
+  }
+  return num;
+}
+
+template <typename EDATA_T>
+size_t MutableCsr<EDATA_T>::compact() {
+  const nbr_t* init_begin = init_nbr_list_.data();
+  const nbr_t* init_end = init_begin + init_nbr_list_.size();
+  std::sort(deleted_lists_.begin(), deleted_lists_.end());
+  deleted_lists_.erase(
+      std::unique(deleted_lists_.begin(), deleted_lists_.end()),
+      deleted_lists_.end());
+  // sizes of the lists after dropping deleted edges
+  std::vector<int> sizes(capacity_);
+  std::vector<vid_t> moved;
+  size_t total_cap = 0;
+  auto deleted_iter = deleted_lists_.begin();
+  for (vid_t i = 0; i < capacity_; ++i) {
+    const nbr_t* ptr = adj_lists_[i].data();
+    int size = adj_lists_[i].size();
+    // lists with deleted edges are moved to drop them, also the sorted lists
+    // with a tail, since the lists may still be read by update transactions
+    // and can not be rewritten in place
+    bool unsorted_tail =
+        order_ != NbrOrder::kInsertion && sorted_sizes_[i].load() < size;
+    bool has_deleted =
+        deleted_iter != deleted_lists_.end() && *deleted_iter == i;
+    if (has_deleted) {
+      ++deleted_iter;
+      size = count_live(ptr, size);
+    }
+    sizes[i] = size;
+    if (adj_lists_[i].capacity() == 0 ||
+        ((in_hubs(adj_lists_[i]) || (ptr >= init_begin && ptr < init_end)) &&
+         !unsorted_tail && !has_deleted)) {
+      continue;
+    }
+    moved.push_back(i);
+    total_cap += size + (size + 4) / 5;
+  }
+  std::sort(moved.begin(), moved.end(), [&sizes](vid_t lhs, vid_t rhs) {
+    return sizes[lhs] > sizes[rhs];
+  });
+
+  mmap_array<nbr_t> new_nbr_list;
+  new_nbr_list.resize(total_cap);
+  nbr_t* ptr = new_nbr_list.data();
+  std::vector<nbr_t> live;
+  auto less = [this](const nbr_t& lhs, const nbr_t& rhs) {
+    return nbr_less(lhs, rhs);
+  };
+  for (auto v : moved) {
+    auto& list = adj_lists_[v];
+    int size = sizes[v];
+    int cap = size + (size + 4) / 5;
+    if (order_ != NbrOrder::kInsertion) {
+      const nbr_t* begin = list.data();
+      int sorted_size = sorted_sizes_[v].load();
+      if (size != list.size()) {
+        // dropping deleted edges keeps the prefix sorted
+        live.resize(size);
+        sorted_size = copy_live(live.data(), begin, sorted_size);
+        copy_live(live.data() + sorted_size, begin + sorted_sizes_[v].load(),
+                  list.size() - sorted_sizes_[v].load());
+        begin = live.data();
+      }
+      copy_sorted(ptr, begin, size, sorted_size, less);
+      list.init(ptr, cap, size);
+      sorted_sizes_[v].store(size, std::memory_order_release);
+    } else {
+      copy_live(ptr, list.data(), list.size());
+      // positions of the list are dropped with its old layout
+      locks_[v].lock();
+      list.init(ptr, cap, size);
+      nbr_positions_[v].reset();
+      locks_[v].unlock();
+    }
+    ptr += cap;
+  }
+  deleted_lists_.clear();
+  // Lists of the previous compaction have been moved as well, but its buffer
+  // may still be read by transactions that entered their epoch before. It is
+  // kept until the next compaction, which drops the one retired before it.
+  retired_nbr_list_.swap(compacted_nbr_list_);
+  compacted_nbr_list_.swap(new_nbr_list);
+  return compacted_bytes();
+}
+
+size_t MutableCsr<std::string>::compact() {
+  const nbr_t* init_begin = nbr_list_.data();
+  const nbr_t* init_end = init_begin + nbr_list_.size();
+  std::sort(deleted_lists_.begin(), deleted_lists_.end());
+  deleted_lists_.erase(
+      std::unique(deleted_lists_.begin(), deleted_lists_.end()),
+      deleted_lists_.end());
+  std::vector<int> sizes(capacity_);
+  std::vector<vid_t> moved;
+  size_t total_cap = 0;
+  auto deleted_iter = deleted_lists_.begin();
+  for (vid_t i = 0; i < capacity_; ++i) {
+    const nbr_t* ptr = adj_lists_[i].data();
+    int size = adj_lists_[i].size();
+    bool has_deleted =
+        deleted_iter != deleted_lists_.end() && *deleted_iter == i;
+    if (has_deleted) {
+      ++deleted_iter;
+      size = count_live(ptr, size);
+    }
+    sizes[i] = size;
+    if (adj_lists_[i].capacity() == 0 ||
+        ((in_hubs(adj_lists_[i]) || (ptr >= init_begin && ptr < init_end)) &&
+         !has_deleted)) {
+      continue;
+    }
+    moved.push_back(i);
+    total_cap += size + (size + 4) / 5;
+  }
+  std::sort(moved.begin(), moved.end(), [&sizes](vid_t lhs, vid_t rhs) {
+    return sizes[lhs] > sizes[rhs];
+  });
+
+  std::vector<nbr_t> new_nbr_list(total_cap);
+  nbr_t* ptr = new_nbr_list.data();
+  for (auto v : moved) {
+    auto& list = adj_lists_[v];
+    int size = sizes[v];
+    int cap = size + (size + 4) / 5;
+    copy_live(ptr, list.data(), list.size());
+    locks_[v].lock();
+    list.init(ptr, cap, size);
+    nbr_positions_[v].reset();
+    locks_[v].unlock();
+    ptr += cap;
+  }
+  deleted_lists_.clear();
+  retired_nbr_list_.swap(compacted_nbr_list_);
+  compacted_nbr_list_.swap(new_nbr_list);
+  return compacted_bytes();
+}
+
+// Lists are counted by their sizes and capacities, and the parts of the
+// buffers of loading and compaction outside of any list are garbage. Sizes
+// and capacities may be read while lists grow, so they are clamped.
+template <typename ADJLIST_T, typename NBR_T>
+static CsrMemoryUsage lists_memory_usage(const ADJLIST_T* lists, vid_t num,
+                                         const NBR_T* init, size_t init_size,
+                                         const NBR_T* compacted,
+                                         size_t compacted_size) {
+  CsrMemoryUsage ret;
+  size_t in_init = 0, in_compacted = 0;
+  for (vid_t i = 0; i < num; ++i) {
+    const NBR_T* ptr = lists[i].data();
+    size_t cap = lists[i].capacity();
+    size_t size = std::min(cap, static_cast<size_t>(lists[i].size()));
+    ret.live += size * sizeof(NBR_T);
+    ret.slack += (cap - size) * sizeof(NBR_T);
+    if (ptr >= init && ptr < init + init_size) {
+      in_init += cap;
+    } else if (ptr >= compacted && ptr < compacted + compacted_size) {
+      in_compacted += cap;
+    }
+  }
+  ret.live += num * sizeof(ADJLIST_T);
+  ret.garbage = (init_size - std::min(init_size, in_init) + compacted_size -
+                 std::min(compacted_size, in_compacted)) *
+                sizeof(NBR_T);
+  return ret;
+}
+
+template <typename EDATA_T>
+CsrMemoryUsage MutableCsr<EDATA_T>::memory_usage() const {
+  CsrMemoryUsage ret = lists_memory_usage(
+      adj_lists_, capacity_, init_nbr_list_.data(), init_nbr_list_.size(),
+      compacted_nbr_list_.data(), compacted_nbr_list_.size());
+  // still read by transactions older than the last compaction
+  ret.garbage += retired_nbr_list_.size() * sizeof(nbr_t);
+  return ret;
+}
+
+CsrMemoryUsage MutableCsr<std::string>::memory_usage() const {
+  CsrMemoryUsage ret = lists_memory_usage(
+      adj_lists_, capacity_, nbr_list_.data(), nbr_list_.size(),
+      compacted_nbr_list_.data(), compacted_nbr_list_.size());
+  ret.garbage += retired_nbr_list_.size() * sizeof(nbr_t);
+  ret.live += pool_.size();
+  return ret;
+}
+
+// Slots without an edge, never put or deleted, are slack.
+template <typename NBR_T>
+static CsrMemoryUsage single_memory_usage(const NBR_T* nbrs, size_t num) {
+  CsrMemoryUsage ret;
+  for (size_t i = 0; i < num; ++i) {
+    if (nbrs[i].timestamp.load() == kDeletedTimestamp) {
+      ret.slack += sizeof(NBR_T);
+    } else {
+      ret.live += sizeof(NBR_T);
+    }
+  }
+  return ret;
+}
+
 template <typename EDATA_T>
 void SingleMutableCsr<EDATA_T>::Serialize(const std::string& path) {
   nbr_list_.dump_to_file(path, nbr_list_.size());
 }
 
+template <typename EDATA_T>
+void SingleMutableCsr<EDATA_T>::Serialize(const std::string& path,
+                                          timestamp_t ts) {
+  size_t size = nbr_list_.size();
+  FILE* fout = fopen(path.c_str(), "wb");
+  std::vector<nbr_t> buffer;
+  static constexpr size_t batch_size = 4096;
+  for (size_t begin = 0; begin < size; begin += batch_size) {
+    size_t end = std::min(size, begin + batch_size);
+    buffer.clear();
+    for (size_t i = begin; i != end; ++i) {
+      // put_edge publishes the timestamp after the neighbor and data
+      timestamp_t nbr_ts = nbr_list_[i].timestamp.load();
+      buffer.emplace_back(nbr_list_[i]);
+      if (nbr_ts > ts) {
+        buffer.back().timestamp.store(std::numeric_limits<timestamp_t>::max());
+      }
+    }
+    CHECK_EQ(fwrite(buffer.data(), sizeof(nbr_t), buffer.size(), fout),
+             buffer.size());
+  }
+  fflush(fout);
+  fclose(fout);
+}
+
 template <typename EDATA_T>
 void SingleMutableCsr<EDATA_T>::Deserialize(const std::string& path) {
   nbr_list_.open_for_read(path);
 }
 
+void SingleMutableCsr<std::string>::Serialize(const std::string& path) {
+  StringNbrWriter writer(path);
+  for (size_t i = 0; i < nbr_list_.size(); ++i) {
+    auto& nbr = nbr_list_[i];
+    writer.append(nbr.neighbor, nbr.timestamp.load(), nbr.data);
+  }
+  writer.close();
+}
+
+void SingleMutableCsr<std::string>::Serialize(const std::string& path,
+                                              timestamp_t ts) {
+  StringNbrWriter writer(path);
+  for (size_t i = 0; i < nbr_list_.size(); ++i) {
+    // put_edge publishes the timestamp after the neighbor and data
+    auto& nbr = nbr_list_[i];
+    timestamp_t nbr_ts = nbr.timestamp.load();
+    if (nbr_ts > ts) {
+      writer.append(nbr.neighbor, std::numeric_limits<timestamp_t>::max(),
+                    std::string_view());
+    } else {
+      writer.append(nbr.neighbor, nbr_ts, nbr.data);
+    }
+  }
+  writer.close();
+}
+
+void SingleMutableCsr<std::string>::Deserialize(const std::string& path) {
+  load_string_nbrs(path, pool_, nbr_list_);
+}
+
+template <typename EDATA_T>
+CsrMemoryUsage SingleMutableCsr<EDATA_T>::memory_usage() const {
+  return single_memory_usage(nbr_list_.data(), nbr_list_.size());
+}
+
+CsrMemoryUsage SingleMutableCsr<std::string>::memory_usage() const {
+  CsrMemoryUsage ret = single_memory_usage(nbr_list_.data(), nbr_list_.size());
+  ret.live += pool_.size();
+  return ret;
+}
+
+template <typename EDATA_T>
+void ImmutableCsr<EDATA_T>::batch_init(vid_t vnum,
+                                       const std::vector<int>& degree) {
+  edge_offsets_.resize(vnum + 1);
+  loading_offsets_.resize(vnum);
+  size_t edge_num = 0;
+  for (vid_t i = 0; i < vnum; ++i) {
+    edge_offsets_[i] = edge_num;
+    loading_offsets_[i] = edge_num;
+    edge_num += degree[i];
+  }
+  edge_offsets_[vnum] = edge_num;
+  loading_edges_.resize(edge_num);
+}
+
+static void encode_varint(vid_t value, std::vector<uint8_t>& out) {
+  while (value >= 0x80) {
+    out.push_back(static_cast<uint8_t>(value | 0x80));
+    value >>= 7;
+  }
+  out.push_back(static_cast<uint8_t>(value));
+}
+
+template <typename EDATA_T>
+void ImmutableCsr<EDATA_T>::batch_sort_edges() {
+  vid_t vnum = loading_offsets_.size();
+  if (!std::is_same<EDATA_T, grape::EmptyType>::value) {
+    data_.resize(loading_edges_.size());
+  }
+  nbr_offsets_.resize(vnum + 1);
+  std::vector<uint8_t> neighbors;
+  for (vid_t v = 0; v < vnum; ++v) {
+    auto begin = loading_edges_.begin() + edge_offsets_[v];
+    auto end = loading_edges_.begin() + edge_offsets_[v + 1];
+    std::sort(begin, end, [](const std::pair<vid_t, EDATA_T>& lhs,
+                             const std::pair<vid_t, EDATA_T>& rhs) {
+      return lhs.first < rhs.first;
+    });
+    nbr_offsets_[v] = neighbors.size();
+    vid_t prev = 0;
+    size_t loc = edge_offsets_[v];
+    for (auto iter = begin; iter != end; ++iter, ++loc) {
+      encode_varint(iter->first - prev, neighbors);
+      prev = iter->first;
+      if (data_.size() != 0) {
+        data_[loc] = iter->second;
+      }
+    }
+  }
+  nbr_offsets_[vnum] = neighbors.size();
+  neighbors_.resize(neighbors.size());
+  if (!neighbors.empty()) {
+    memcpy(neighbors_.data(), neighbors.data(), neighbors.size());
+  }
+  vnum_ = vnum;
+
+  std::vector<std::pair<vid_t, EDATA_T>>().swap(loading_edges_);
+  std::vector<size_t>().swap(loading_offsets_);
+}
+
+template <typename EDATA_T>
+void ImmutableCsr<EDATA_T>::Serialize(const std::string& path) {
+  nbr_offsets_.dump_to_file(path + ".nbr_offsets", nbr_offsets_.size());
+  edge_offsets_.dump_to_file(path + ".edge_offsets", edge_offsets_.size());
+  neighbors_.dump_to_file(path + ".nbr_list", neighbors_.size());
+  data_.dump_to_file(path + ".data", data_.size());
+}
+
+// empty arrays are not dumped by mmap_array
+template <typename T>
+static void open_if_exists(mmap_array<T>& array, const std::string& path) {
+  if (std::filesystem::exists(path)) {
+    array.open_for_read(path);
+  }
+}
+
+template <typename EDATA_T>
+void ImmutableCsr<EDATA_T>::Deserialize(const std::string& path) {
+  open_if_exists(nbr_offsets_, path + ".nbr_offsets");
+  open_if_exists(edge_offsets_, path + ".edge_offsets");
+  open_if_exists(neighbors_, path + ".nbr_list");
+  open_if_exists(data_, path + ".data");
+  vnum_ = nbr_offsets_.size() == 0 ? 0 : nbr_offsets_.size() - 1;
+}
+
+template <typename EDATA_T>
+CsrMemoryUsage ImmutableCsr<EDATA_T>::memory_usage() const {
+  CsrMemoryUsage ret;
+  ret.live = nbr_offsets_.memory_usage() + edge_offsets_.memory_usage() +
+             neighbors_.memory_usage() + data_.memory_usage();
+  return ret;
+}
+
 template class SingleMutableCsr<grape::EmptyType>;
 template class MutableCsr<grape::EmptyType>;
+template class ImmutableCsr<grape::EmptyType>;
 
 template class SingleMutableCsr<int>;
 template class MutableCsr<int>;
+template class ImmutableCsr<int>;
 
 template class SingleMutableCsr<Date>;
 template class MutableCsr<Date>;
+template class ImmutableCsr<Date>;
 
 template class SingleMutableCsr<std::string>;
 template class MutableCsr<std::string>;
 
 template class SingleMutableCsr<int64_t>;
 template class MutableCsr<int64_t>;
+template class ImmutableCsr<int64_t>;
 
 template class SingleMutableCsr<double>;
 template class MutableCsr<double>;
+template class ImmutableCsr<double>;
 
 }  // namespace gs
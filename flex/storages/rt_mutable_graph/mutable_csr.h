@@ -16,20 +16,149 @@
 #ifndef GRAPHSCOPE_GRAPH_MUTABLE_CSR_H_
 #define GRAPHSCOPE_GRAPH_MUTABLE_CSR_H_
 
+#include <sys/mman.h>
+
+#include <algorithm>
 #include <atomic>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <string>
+#include <string_view>
 #include <type_traits>
+#include <unordered_map>
 #include <vector>
 
 #include "flex/storages/rt_mutable_graph/types.h"
 #include "flex/utils/allocators.h"
 #include "flex/utils/mmap_array.h"
+#include "flex/utils/property/arrow_utils.h"
 #include "flex/utils/property/types.h"
+#include "flex/utils/usdt.h"
 #include "grape/serialization/in_archive.h"
 #include "grape/serialization/out_archive.h"
 #include "grape/utils/concurrent_queue.h"
 
 namespace gs {
 
+/**
+ * @brief Append-only storage of the strings of a csr, so that string edges
+ * refer to them by views and are copied as plain bytes. Strings are carved
+ * from chunks of chunk_size bytes, larger ones get a chunk of their own.
+ * Nothing is freed before the pool is destroyed.
+ */
+class StringPool {
+  static constexpr size_t chunk_size = 1 << 20;
+
+ public:
+  StringPool() : cur_(nullptr), cur_loc_(0), cur_size_(0), bytes_(0) {}
+  ~StringPool() {
+    for (auto ptr : chunks_) {
+      free(ptr);
+    }
+  }
+
+  StringPool(const StringPool&) = delete;
+  StringPool& operator=(const StringPool&) = delete;
+
+  /** @brief Copy str into the pool, may be called by several threads. */
+  std::string_view append(const std::string_view& str) {
+    size_t size = str.size();
+    if (size == 0) {
+      return std::string_view();
+    }
+    char* ptr;
+    lock_.lock();
+    if (size > chunk_size / 4) {
+      ptr = static_cast<char*>(malloc(size));
+      chunks_.push_back(ptr);
+    } else {
+      if (cur_loc_ + size > cur_size_) {
+        cur_ = static_cast<char*>(malloc(chunk_size));
+        chunks_.push_back(cur_);
+        cur_loc_ = 0;
+        cur_size_ = chunk_size;
+      }
+      ptr = cur_ + cur_loc_;
+      cur_loc_ += size;
+    }
+    bytes_ += size;
+    lock_.unlock();
+    // the bytes are reserved for this caller, no need to copy under the lock
+    memcpy(ptr, str.data(), size);
+    return std::string_view(ptr, size);
+  }
+
+  /** @brief Bytes of the strings appended so far. */
+  size_t size() const { return bytes_; }
+
+ private:
+  grape::SpinLock lock_;
+  std::vector<char*> chunks_;
+  char* cur_;
+  size_t cur_loc_;
+  size_t cur_size_;
+  size_t bytes_;
+};
+
+/**
+ * @brief Address space reserved for the adjacency lists of hub vertices, the
+ * few vertices holding a large share of the edges in power-law graphs.
+ *
+ * A list outgrowing kHubListBytes is copied once to a region reserving
+ * kGrowFactor times its capacity. Pages of a region are only backed when
+ * edges are written to them, so the list then grows in place for long,
+ * instead of being copied each time it grows by half, while it stays
+ * contiguous for readers. Outgrown regions may still be read and are kept
+ * until the csr is destroyed, they take at most 1 / kGrowFactor of the
+ * memory of the regions following them.
+ */
+class HubRegions {
+ public:
+  static constexpr size_t kHubListBytes = 1 << 20;
+  static constexpr size_t kGrowFactor = 64;
+
+  HubRegions() = default;
+  ~HubRegions() {
+    for (auto& region : regions_) {
+      munmap(region.first, region.second);
+    }
+  }
+
+  HubRegions(const HubRegions&) = delete;
+  HubRegions& operator=(const HubRegions&) = delete;
+
+  void* reserve(size_t size) {
+    void* ptr = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (ptr == MAP_FAILED) {
+      LOG(FATAL) << "Failed to reserve " << size << " bytes for a hub list";
+    }
+    lock_.lock();
+    regions_.emplace_back(static_cast<char*>(ptr), size);
+    lock_.unlock();
+    return ptr;
+  }
+
+  bool contains(const void* ptr) const {
+    const char* p = static_cast<const char*>(ptr);
+    bool ret = false;
+    lock_.lock();
+    for (auto& region : regions_) {
+      if (p >= region.first && p < region.first + region.second) {
+        ret = true;
+        break;
+      }
+    }
+    lock_.unlock();
+    return ret;
+  }
+
+ private:
+  mutable grape::SpinLock lock_;
+  std::vector<std::pair<char*, size_t>> regions_;
+};
+
 template <typename EDATA_T>
 struct MutableNbr {
   MutableNbr() = default;
@@ -58,10 +187,21 @@ struct MutableNbr<grape::EmptyType> {
   };
 };
 
-grape::InArchive& operator<<(grape::InArchive& in_archive,
-                             const MutableNbr<std::string>& value);
-grape::OutArchive& operator>>(grape::OutArchive& out_archive,
-                              MutableNbr<std::string>& value);
+// The data refers to a string in the StringPool of the csr holding the edge,
+// so nbrs of string edges are trivially copyable like the others.
+template <>
+struct MutableNbr<std::string> {
+  MutableNbr() = default;
+  MutableNbr(const MutableNbr& rhs)
+      : neighbor(rhs.neighbor),
+        timestamp(rhs.timestamp.load()),
+        data(rhs.data) {}
+  ~MutableNbr() = default;
+
+  vid_t neighbor;
+  std::atomic<timestamp_t> timestamp;
+  std::string_view data;
+};
 
 template <typename EDATA_T>
 class MutableNbrSlice {
@@ -78,16 +218,23 @@ class MutableNbrSlice {
   const nbr_t* begin() const { return ptr_; }
   const nbr_t* end() const { return ptr_ + size_; }
 
+  // No nbr of the slice has a newer timestamp, so readers at or after it
+  // see all of them without checking each. Unknown unless set.
+  void set_max_timestamp(timestamp_t ts) { max_ts_ = ts; }
+  timestamp_t max_timestamp() const { return max_ts_; }
+
   static MutableNbrSlice empty() {
     MutableNbrSlice ret;
     ret.set_begin(nullptr);
     ret.set_size(0);
+    ret.set_max_timestamp(0);
     return ret;
   }
 
  private:
   const nbr_t* ptr_;
   int size_;
+  timestamp_t max_ts_ = std::numeric_limits<timestamp_t>::max();
 };
 
 template <typename EDATA_T>
@@ -105,6 +252,13 @@ class MutableNbrSliceMut {
   nbr_t* begin() { return ptr_; }
   nbr_t* end() { return ptr_ + size_; }
 
+  // The max timestamp of the list the slice is of, to be raised before a
+  // timestamp of its nbrs is, if any.
+  void set_max_timestamp(std::atomic<timestamp_t>* max_ts) {
+    max_ts_ = max_ts;
+  }
+  std::atomic<timestamp_t>* max_timestamp() { return max_ts_; }
+
   static MutableNbrSliceMut empty() {
     MutableNbrSliceMut ret;
     ret.set_begin(nullptr);
@@ -115,6 +269,69 @@ class MutableNbrSliceMut {
  private:
   nbr_t* ptr_;
   int size_;
+  std::atomic<timestamp_t>* max_ts_ = nullptr;
+};
+
+inline void raise_timestamp(std::atomic<timestamp_t>& max_ts,
+                            timestamp_t ts) {
+  timestamp_t cur = max_ts.load(std::memory_order_relaxed);
+  while (cur < ts && !max_ts.compare_exchange_weak(cur, ts)) {}
+}
+
+/**
+ * @brief Find the first nbr in [begin, end), sorted by neighbor, whose
+ * neighbor is not less than v. The range is probed at exponentially growing
+ * distances before a binary search, so that increasing lookups from a moving
+ * begin cost about the logarithm of the distances skipped.
+ */
+template <typename NBR_T>
+inline const NBR_T* gallop_lower_bound(const NBR_T* begin, const NBR_T* end,
+                                       vid_t v) {
+  const NBR_T* lo = begin;
+  const NBR_T* hi = begin;
+  size_t step = 1;
+  while (hi != end && hi->neighbor < v) {
+    lo = hi + 1;
+    hi = static_cast<size_t>(end - hi) > step ? hi + step : end;
+    step <<= 1;
+  }
+  return std::lower_bound(
+      lo, hi, v, [](const NBR_T& nbr, vid_t v) { return nbr.neighbor < v; });
+}
+
+/**
+ * @brief Positions of the edges of each neighbor in the list of a hub
+ * vertex, so that edges to a vertex are found without scanning the list.
+ *
+ * Edges appended since the last lookup are indexed by the next one, and
+ * positions of a list moved by compaction are dropped with it. Only accessed
+ * with the lock of the vertex held.
+ */
+class NbrPositions {
+ public:
+  // lists of fewer edges are scanned
+  static constexpr int kMinDegree = 256;
+
+  NbrPositions() : indexed_(0) {}
+
+  /** @brief Whether nbrs of list, of size edges, hold a visible edge to v. */
+  template <typename NBR_T>
+  bool contains(const NBR_T* list, int size, vid_t v, timestamp_t ts) {
+    for (; indexed_ < size; ++indexed_) {
+      positions_.emplace(list[indexed_].neighbor, indexed_);
+    }
+    auto range = positions_.equal_range(v);
+    for (auto iter = range.first; iter != range.second; ++iter) {
+      if (list[iter->second].timestamp.load() <= ts) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+ private:
+  std::unordered_multimap<vid_t, int> positions_;
+  int indexed_;
 };
 
 template <typename T>
@@ -124,52 +341,97 @@ struct UninitializedUtils {
   }
 };
 
-template <>
-struct UninitializedUtils<MutableNbr<std::string>> {
-  using T = MutableNbr<std::string>;
-  static void copy(T* new_buffer, T* old_buffer, size_t len) {
-    while (len--) {
-      new_buffer->neighbor = old_buffer->neighbor;
-      new_buffer->data = old_buffer->data;
-      new_buffer->timestamp.store(old_buffer->timestamp);
-      ++new_buffer;
-      ++old_buffer;
-    }
+/**
+ * @brief Move a full list of capacity nbrs to a larger buffer and return it,
+ * capacity is updated. Lists reaching HubRegions::kHubListBytes go to a
+ * region of hubs if given, others to the allocator. If recycle is set, the
+ * outgrown buffer was given by the allocator, unless it is in a region, and
+ * is handed back to it.
+ */
+template <typename NBR_T>
+inline NBR_T* grow_adjlist(NBR_T* buffer, int& capacity, int size,
+                           ArenaAllocator& allocator, bool recycle,
+                           HubRegions* hubs) {
+  int old_capacity = capacity;
+  size_t new_capacity = old_capacity + (old_capacity >> 1) + 1;
+  NBR_T* new_buffer;
+  if (hubs != nullptr &&
+      new_capacity * sizeof(NBR_T) >= HubRegions::kHubListBytes) {
+    new_capacity = std::min<size_t>(
+        std::numeric_limits<int>::max(),
+        std::max(new_capacity, old_capacity * HubRegions::kGrowFactor));
+    new_buffer =
+        static_cast<NBR_T*>(hubs->reserve(new_capacity * sizeof(NBR_T)));
+  } else {
+    new_buffer =
+        static_cast<NBR_T*>(allocator.allocate(new_capacity * sizeof(NBR_T)));
   }
-};
+  UninitializedUtils<NBR_T>::copy(new_buffer, buffer, size);
+  if (recycle && old_capacity != 0 &&
+      (hubs == nullptr || !hubs->contains(buffer))) {
+    allocator.deallocate(buffer, old_capacity * sizeof(NBR_T));
+  }
+  capacity = new_capacity;
+  FLEX_PROBE2(adjlist_grow, old_capacity, new_capacity);
+  return new_buffer;
+}
+
+// Whether edges of EDATA_T may be ordered by time, see time_of.
+template <typename EDATA_T>
+struct is_time_data
+    : std::integral_constant<bool, std::is_integral<EDATA_T>::value ||
+                                       std::is_same<EDATA_T, Date>::value> {};
+
+template <typename NBR_T>
+inline timestamp_t max_timestamp_of(const NBR_T* list, int size) {
+  timestamp_t ret = 0;
+  for (int k = 0; k < size; ++k) {
+    ret = std::max(ret, list[k].timestamp.load());
+  }
+  return ret;
+}
 
+/**
+ * @brief The edges of a vertex, appended in place. The max timestamp of its
+ * edges is kept, so that readers no older than it skip the check of each
+ * edge's timestamp.
+ */
 template <typename EDATA_T>
 class MutableAdjlist {
  public:
   using nbr_t = MutableNbr<EDATA_T>;
   using slice_t = MutableNbrSlice<EDATA_T>;
   using mut_slice_t = MutableNbrSliceMut<EDATA_T>;
-  MutableAdjlist() : buffer_(nullptr), size_(0), capacity_(0) {}
+  MutableAdjlist() : buffer_(nullptr), size_(0), capacity_(0), max_ts_(0) {}
   ~MutableAdjlist() {}
 
   void init(nbr_t* ptr, int cap, int size) {
     buffer_ = ptr;
     capacity_ = cap;
+    max_ts_.store(max_timestamp_of(ptr, size));
     size_ = size;
   }
 
   void batch_put_edge(vid_t neighbor, const EDATA_T& data, timestamp_t ts = 0) {
-    CHECK_LT(size_, capacity_);
-    auto& nbr = buffer_[size_++];
+    raise_timestamp(max_ts_, ts);
+    int pos = size_.fetch_add(1);
+    CHECK_LT(pos, capacity_);
+    auto& nbr = buffer_[pos];
     nbr.neighbor = neighbor;
     nbr.data = data;
     nbr.timestamp.store(ts);
   }
 
+  // If recycle is set, the buffer being outgrown was given by an allocator
+  // and is handed back to it. Large lists grow in hubs if given.
   void put_edge(vid_t neighbor, const EDATA_T& data, timestamp_t ts,
-                ArenaAllocator& allocator) {
+                ArenaAllocator& allocator, bool recycle = false,
+                HubRegions* hubs = nullptr) {
     if (size_ == capacity_) {
-      capacity_ += (((capacity_) >> 1) + 1);
-      auto* new_buffer =
-          static_cast<nbr_t*>(allocator.allocate(capacity_ * sizeof(nbr_t)));
-      UninitializedUtils<nbr_t>::copy(new_buffer, buffer_, size_);
-      buffer_ = new_buffer;
+      buffer_ =
+          grow_adjlist(buffer_, capacity_, size_, allocator, recycle, hubs);
     }
+    raise_timestamp(max_ts_, ts);
     auto& nbr = buffer_[size_.fetch_add(1)];
     nbr.neighbor = neighbor;
     nbr.data = data;
@@ -180,6 +442,8 @@ class MutableAdjlist {
     slice_t ret;
     ret.set_size(size_.load(std::memory_order_acquire));
     ret.set_begin(buffer_);
+    // raised before the size, so it covers the edges of the slice
+    ret.set_max_timestamp(max_ts_.load(std::memory_order_acquire));
     return ret;
   }
 
@@ -187,6 +451,7 @@ class MutableAdjlist {
     mut_slice_t ret;
     ret.set_size(size_.load());
     ret.set_begin(buffer_);
+    ret.set_max_timestamp(&max_ts_);
     return ret;
   }
 
@@ -199,45 +464,45 @@ class MutableAdjlist {
   nbr_t* buffer_;
   std::atomic<int> size_;
   int capacity_;
+  std::atomic<timestamp_t> max_ts_;
 };
 
+// Takes strings already appended to the StringPool of the csr.
 template <>
 class MutableAdjlist<std::string> {
  public:
   using nbr_t = MutableNbr<std::string>;
   using slice_t = MutableNbrSlice<std::string>;
   using mut_slice_t = MutableNbrSliceMut<std::string>;
-  MutableAdjlist() : buffer_(nullptr), size_(0), capacity_(0) {}
+  MutableAdjlist() : buffer_(nullptr), size_(0), capacity_(0), max_ts_(0) {}
   ~MutableAdjlist() {}
 
   void init(nbr_t* ptr, int cap, int size) {
     buffer_ = ptr;
     capacity_ = cap;
+    max_ts_.store(max_timestamp_of(ptr, size));
     size_ = size;
   }
 
-  void batch_put_edge(vid_t neighbor, const std::string& data,
+  void batch_put_edge(vid_t neighbor, const std::string_view& data,
                       timestamp_t ts = 0) {
-    CHECK_LT(size_, capacity_);
-    auto& nbr = buffer_[size_++];
+    raise_timestamp(max_ts_, ts);
+    int pos = size_.fetch_add(1);
+    CHECK_LT(pos, capacity_);
+    auto& nbr = buffer_[pos];
     nbr.neighbor = neighbor;
     nbr.data = data;
     nbr.timestamp.store(ts);
   }
 
-  void put_edge(vid_t neighbor, const std::string& data, timestamp_t ts,
-                ArenaAllocator& allocator) {
+  void put_edge(vid_t neighbor, const std::string_view& data, timestamp_t ts,
+                ArenaAllocator& allocator, bool recycle = false,
+                HubRegions* hubs = nullptr) {
     if (size_ == capacity_) {
-      capacity_ += (((capacity_) >> 1) + 1);
-      auto* new_buffer = static_cast<nbr_t*>(allocator.allocate_typed(
-          sizeof(nbr_t), capacity_,
-          [](void* ptr) { static_cast<nbr_t*>(ptr)->~nbr_t(); }));
-      for (int i = 0; i < capacity_; ++i) {
-        new (&new_buffer[i]) nbr_t();
-      }
-      UninitializedUtils<nbr_t>::copy(new_buffer, buffer_, size_);
-      buffer_ = new_buffer;
+      buffer_ =
+          grow_adjlist(buffer_, capacity_, size_, allocator, recycle, hubs);
     }
+    raise_timestamp(max_ts_, ts);
     auto& nbr = buffer_[size_.fetch_add(1)];
     nbr.neighbor = neighbor;
     nbr.data = data;
@@ -246,8 +511,10 @@ class MutableAdjlist<std::string> {
 
   slice_t get_edges() const {
     slice_t ret;
-    ret.set_size(size_.load());
+    ret.set_size(size_.load(std::memory_order_acquire));
     ret.set_begin(buffer_);
+    // raised before the size, so it covers the edges of the slice
+    ret.set_max_timestamp(max_ts_.load(std::memory_order_acquire));
     return ret;
   }
 
@@ -255,6 +522,7 @@ class MutableAdjlist<std::string> {
     mut_slice_t ret;
     ret.set_size(size_.load());
     ret.set_begin(buffer_);
+    ret.set_max_timestamp(&max_ts_);
     return ret;
   }
 
@@ -267,6 +535,7 @@ class MutableAdjlist<std::string> {
   nbr_t* buffer_;
   std::atomic<int> size_;
   int capacity_;
+  std::atomic<timestamp_t> max_ts_;
 };
 
 class MutableCsrConstEdgeIterBase {
@@ -297,6 +566,35 @@ class MutableCsrEdgeIterBase {
   virtual bool is_valid() const = 0;
 };
 
+#ifdef FLEX_WITH_ARROW
+/**
+ * @brief Edges in compressed sparse row arrays, the edges of vertex v are at
+ * [offsets[v], offsets[v + 1]) of neighbors and data. Data is null for edges
+ * without properties.
+ */
+struct ArrowCsr {
+  std::shared_ptr<arrow::Int64Array> offsets;
+  std::shared_ptr<arrow::UInt32Array> neighbors;
+  std::shared_ptr<arrow::Array> data;
+};
+#endif
+
+/**
+ * @brief Bytes held by a csr. Live bytes hold edges, including those deleted
+ * but not compacted yet, and the index of the lists. Slack bytes are the
+ * capacity of lists not used yet, and garbage bytes are parts of the buffers
+ * of loading and compaction no longer referred to by any list, which the
+ * next compaction frees. Lists outgrown in session allocators are handed
+ * back to them and counted by the allocators instead.
+ */
+struct CsrMemoryUsage {
+  size_t live{0};
+  size_t slack{0};
+  size_t garbage{0};
+
+  size_t total() const { return live + slack + garbage; }
+};
+
 class MutableCsrBase {
  public:
   MutableCsrBase() {}
@@ -309,8 +607,33 @@ class MutableCsrBase {
 
   virtual void Serialize(const std::string& path) = 0;
 
+  /**
+   * @brief Serialize the edges visible at timestamp ts, while other threads
+   * may still be inserting edges. The output is loadable by Deserialize.
+   */
+  virtual void Serialize(const std::string& path, timestamp_t ts) = 0;
+
   virtual void Deserialize(const std::string& path) = 0;
 
+  /**
+   * @brief Move the adjacency lists grown out of their initial buffer into a
+   * new contiguous buffer, laid out by descending degree. Afterwards no
+   * memory given by allocators is referenced by this csr. No other thread
+   * may access the csr meanwhile.
+   *
+   * @return Bytes of the new buffer.
+   */
+  virtual size_t compact() = 0;
+
+  /** @brief Bytes of the buffer built by the last compaction. */
+  virtual size_t compacted_bytes() const = 0;
+
+  /**
+   * @brief Bytes held by the csr, see CsrMemoryUsage. May be called while
+   * edges are inserted, and is then approximate.
+   */
+  virtual CsrMemoryUsage memory_usage() const = 0;
+
   virtual void ingest_edge(vid_t src, vid_t dst, grape::OutArchive& arc,
                            timestamp_t ts, ArenaAllocator& alloc) = 0;
   virtual void peek_ingest_edge(vid_t src, vid_t dst, grape::OutArchive& arc,
@@ -322,6 +645,28 @@ class MutableCsrBase {
   virtual MutableCsrConstEdgeIterBase* edge_iter_raw(vid_t v) const = 0;
 
   virtual std::shared_ptr<MutableCsrEdgeIterBase> edge_iter_mut(vid_t v) = 0;
+
+  /**
+   * @brief Mark the edges from src to dst as deleted by setting their
+   * timestamps to kDeletedTimestamp. They are skipped by edge iterators,
+   * invisible to every transaction, and dropped by the next compaction. No
+   * other thread may access the csr meanwhile.
+   *
+   * @return The number of edges deleted.
+   */
+  virtual size_t delete_edges(vid_t src, vid_t dst) = 0;
+
+  /** @brief Mark all edges of src as deleted, see delete_edges. */
+  virtual size_t delete_edges(vid_t src) = 0;
+
+#ifdef FLEX_WITH_ARROW
+  /**
+   * @brief The edges of the first vnum vertices visible at ts. Adjacency
+   * lists are not contiguous and interleave timestamps, so the edges are
+   * copied.
+   */
+  virtual ArrowCsr ToArrowCSR(vid_t vnum, timestamp_t ts) const = 0;
+#endif
 };
 
 template <typename EDATA_T>
@@ -330,18 +675,30 @@ class TypedMutableCsrConstEdgeIter : public MutableCsrConstEdgeIterBase {
 
  public:
   explicit TypedMutableCsrConstEdgeIter(const MutableNbrSlice<EDATA_T>& slice)
-      : cur_(slice.begin()), end_(slice.end()) {}
+      : cur_(slice.begin()), end_(slice.end()) {
+    skip_deleted();
+  }
   ~TypedMutableCsrConstEdgeIter() = default;
 
   vid_t get_neighbor() const { return cur_->neighbor; }
   Any get_data() const { return AnyConverter<EDATA_T>::to_any(cur_->data); }
   timestamp_t get_timestamp() const { return cur_->timestamp.load(); }
 
-  void next() { ++cur_; }
+  void next() {
+    ++cur_;
+    skip_deleted();
+  }
   bool is_valid() const { return cur_ != end_; }
+  // deleted edges not compacted yet are counted as well
   size_t size() const { return end_ - cur_; }
 
  private:
+  void skip_deleted() {
+    while (cur_ != end_ && cur_->timestamp.load() == kDeletedTimestamp) {
+      ++cur_;
+    }
+  }
+
   const nbr_t* cur_;
   const nbr_t* end_;
 };
@@ -352,7 +709,11 @@ class TypedMutableCsrEdgeIter : public MutableCsrEdgeIterBase {
 
  public:
   explicit TypedMutableCsrEdgeIter(MutableNbrSliceMut<EDATA_T> slice)
-      : cur_(slice.begin()), end_(slice.end()) {}
+      : cur_(slice.begin()),
+        end_(slice.end()),
+        max_ts_(slice.max_timestamp()) {
+    skip_deleted();
+  }
   ~TypedMutableCsrEdgeIter() = default;
 
   vid_t get_neighbor() const { return cur_->neighbor; }
@@ -361,25 +722,136 @@ class TypedMutableCsrEdgeIter : public MutableCsrEdgeIterBase {
 
   void set_data(const Any& value, timestamp_t ts) {
     ConvertAny<EDATA_T>::to(value, cur_->data);
+    if (max_ts_ != nullptr) {
+      raise_timestamp(*max_ts_, ts);
+    }
     cur_->timestamp.store(ts);
   }
 
-  void next() { ++cur_; }
+  void next() {
+    ++cur_;
+    skip_deleted();
+  }
   bool is_valid() const { return cur_ != end_; }
 
  private:
+  // deleted edges must not be revived by set_data
+  void skip_deleted() {
+    while (cur_ != end_ && cur_->timestamp.load() == kDeletedTimestamp) {
+      ++cur_;
+    }
+  }
+
   nbr_t* cur_;
   nbr_t* end_;
+  std::atomic<timestamp_t>* max_ts_;
+};
+
+// Strings set are appended to the pool of the csr, views of edges without a
+// pool, i.e. of empty slices, are never set.
+template <>
+class TypedMutableCsrEdgeIter<std::string> : public MutableCsrEdgeIterBase {
+  using nbr_t = MutableNbr<std::string>;
+
+ public:
+  explicit TypedMutableCsrEdgeIter(MutableNbrSliceMut<std::string> slice,
+                                   StringPool* pool = nullptr)
+      : cur_(slice.begin()),
+        end_(slice.end()),
+        max_ts_(slice.max_timestamp()),
+        pool_(pool) {
+    skip_deleted();
+  }
+  ~TypedMutableCsrEdgeIter() = default;
+
+  vid_t get_neighbor() const { return cur_->neighbor; }
+  Any get_data() const {
+    return AnyConverter<std::string>::to_any(cur_->data);
+  }
+  timestamp_t get_timestamp() const { return cur_->timestamp.load(); }
+
+  void set_data(const Any& value, timestamp_t ts) {
+    CHECK(value.type == PropertyType::kString);
+    cur_->data = pool_->append(value.value.s);
+    if (max_ts_ != nullptr) {
+      raise_timestamp(*max_ts_, ts);
+    }
+    cur_->timestamp.store(ts);
+  }
+
+  void next() {
+    ++cur_;
+    skip_deleted();
+  }
+  bool is_valid() const { return cur_ != end_; }
+
+ private:
+  void skip_deleted() {
+    while (cur_ != end_ && cur_->timestamp.load() == kDeletedTimestamp) {
+      ++cur_;
+    }
+  }
+
+  nbr_t* cur_;
+  nbr_t* end_;
+  std::atomic<timestamp_t>* max_ts_;
+  StringPool* pool_;
 };
 
 template <typename EDATA_T>
 class TypedMutableCsrBase : public MutableCsrBase {
  public:
   using slice_t = MutableNbrSlice<EDATA_T>;
+  /**
+   * @brief Put an edge while loading, may be called by several threads at
+   * once after batch_init. Edges of a vertex are kept in no particular order.
+   */
   virtual void batch_put_edge(vid_t src, vid_t dst, const EDATA_T& data,
                               timestamp_t ts = 0) = 0;
 
   virtual slice_t get_edges(vid_t i) const = 0;
+
+  /** @brief Called once all edges of loading are put with batch_put_edge. */
+  virtual void batch_sort_edges() {}
+
+#ifdef FLEX_WITH_ARROW
+  ArrowCsr ToArrowCSR(vid_t vnum, timestamp_t ts) const override {
+    constexpr bool has_data = !std::is_same<EDATA_T, grape::EmptyType>::value;
+    arrow::Int64Builder offsets;
+    arrow::UInt32Builder neighbors;
+    using data_builder_t =
+        typename std::conditional<has_data,
+                                  typename ArrowTypeOf<EDATA_T>::builder_type,
+                                  arrow::NullBuilder>::type;
+    data_builder_t data;
+    FLEX_ARROW_OK_OR_FATAL(offsets.Reserve(vnum + 1));
+    int64_t num = 0;
+    for (vid_t v = 0; v < vnum; ++v) {
+      FLEX_ARROW_OK_OR_FATAL(offsets.Append(num));
+      for (auto& e : get_edges(v)) {
+        // deleted edges have the largest timestamp
+        if (e.timestamp.load() > ts) {
+          continue;
+        }
+        FLEX_ARROW_OK_OR_FATAL(neighbors.Append(e.neighbor));
+        if constexpr (has_data) {
+          FLEX_ARROW_OK_OR_FATAL(
+              data.Append(ArrowTypeOf<EDATA_T>::value(e.data)));
+        }
+        ++num;
+      }
+    }
+    FLEX_ARROW_OK_OR_FATAL(offsets.Append(num));
+
+    ArrowCsr ret;
+    FLEX_ARROW_OK_OR_FATAL(offsets.Finish(&ret.offsets));
+    FLEX_ARROW_OK_OR_FATAL(neighbors.Finish(&ret.neighbors));
+    if constexpr (has_data) {
+      FLEX_ARROW_OK_OR_FATAL(data.Finish(&ret.data));
+    }
+    return ret;
+  }
+#endif
 };
 
 template <typename EDATA_T>
@@ -390,7 +862,22 @@ class MutableCsr : public TypedMutableCsrBase<EDATA_T> {
   using slice_t = MutableNbrSlice<EDATA_T>;
   using mut_slice_t = MutableNbrSliceMut<EDATA_T>;
 
-  MutableCsr() : adj_lists_(nullptr), locks_(nullptr), capacity_(0) {}
+  /**
+   * @param order Order of the lists. Lists sorted by neighbor or by time are
+   * split into a sorted prefix and a tail of the edges put after loading,
+   * which compact merges into the prefix. Edges put in time order onto a
+   * time-ordered list without a tail extend its prefix instead, so lists of
+   * edges streamed in about time order stay mostly sorted.
+   */
+  explicit MutableCsr(NbrOrder order = NbrOrder::kInsertion)
+      : adj_lists_(nullptr),
+        locks_(nullptr),
+        sorted_sizes_(nullptr),
+        capacity_(0),
+        order_(order) {
+    CHECK(order != NbrOrder::kTime || is_time_data<EDATA_T>::value)
+        << "edges ordered by time must hold an int32, int64 or date";
+  }
   ~MutableCsr() {
     if (adj_lists_ != nullptr) {
       free(adj_lists_);
@@ -398,6 +885,9 @@ class MutableCsr : public TypedMutableCsrBase<EDATA_T> {
     if (locks_ != nullptr) {
       delete[] locks_;
     }
+    if (sorted_sizes_ != nullptr) {
+      delete[] sorted_sizes_;
+    }
   }
 
   void batch_init(vid_t vnum, const std::vector<int>& degree) override {
@@ -408,6 +898,8 @@ class MutableCsr : public TypedMutableCsrBase<EDATA_T> {
 
     adj_lists_ = static_cast<adjlist_t*>(malloc(sizeof(adjlist_t) * capacity_));
     locks_ = new grape::SpinLock[capacity_];
+    init_sorted_sizes();
+    nbr_positions_.resize(capacity_);
     size_t edge_capacity = 0;
     for (auto d : degree) {
       edge_capacity += (d + (d + 4) / 5);
@@ -441,7 +933,14 @@ class MutableCsr : public TypedMutableCsrBase<EDATA_T> {
                 ArenaAllocator& allocator) {
     CHECK_LT(src, capacity_);
     locks_[src].lock();
-    adj_lists_[src].put_edge(dst, data, ts, allocator);
+    auto& list = adj_lists_[src];
+    bool extend = order_ == NbrOrder::kTime && in_time_order(src, data);
+    list.put_edge(dst, data, ts, allocator, from_allocator(list.data()),
+                  &hubs_);
+    if (extend) {
+      // published after the size, as by compact
+      sorted_sizes_[src].store(list.size(), std::memory_order_release);
+    }
     locks_[src].unlock();
   }
 
@@ -452,10 +951,65 @@ class MutableCsr : public TypedMutableCsrBase<EDATA_T> {
   }
   mut_slice_t get_edges_mut(vid_t i) { return adj_lists_[i].get_edges_mut(); }
 
+  bool sorted() const { return order_ == NbrOrder::kNeighbor; }
+
+  NbrOrder order() const { return order_; }
+
+  /**
+   * @brief Whether an edge from src to dst is visible at ts. Sorted prefixes
+   * are searched, and lists of at least NbrPositions::kMinDegree edges of
+   * unsorted csrs are looked up in their positions, built on first use.
+   */
+  bool exist(vid_t src, vid_t dst, timestamp_t ts) const;
+
+  /**
+   * @brief Edges of i as a prefix sorted by neighbor and a tail of the edges
+   * appended after it, in insertion order. Without sorted lists the prefix
+   * is always empty.
+   */
+  std::pair<slice_t, slice_t> get_sorted_edges(vid_t i) const {
+    return split_edges(i, order_ == NbrOrder::kNeighbor);
+  }
+
+  /**
+   * @brief Edges of i whose time, see time_of, is in [begin, end), as the
+   * part of the prefix sorted by time holding them, found by binary search,
+   * and the tail of the edges appended after the prefix, which is not
+   * filtered. Without time-ordered lists the prefix is always empty.
+   */
+  std::pair<slice_t, slice_t> get_time_range_edges(vid_t i, int64_t begin,
+                                                   int64_t end) const {
+    auto edges = split_edges(i, order_ == NbrOrder::kTime);
+    if constexpr (is_time_data<EDATA_T>::value) {
+      auto less = [](const nbr_t& nbr, int64_t t) {
+        return time_of(nbr.data) < t;
+      };
+      const nbr_t* first = std::lower_bound(edges.first.begin(),
+                                            edges.first.end(), begin, less);
+      const nbr_t* last =
+          std::lower_bound(first, edges.first.end(), end, less);
+      edges.first.set_begin(first);
+      edges.first.set_size(last - first);
+    }
+    return edges;
+  }
+
+  void batch_sort_edges() override;
+
   void Serialize(const std::string& path) override;
 
+  void Serialize(const std::string& path, timestamp_t ts) override;
+
   void Deserialize(const std::string& path) override;
 
+  size_t compact() override;
+
+  size_t compacted_bytes() const override {
+    return compacted_nbr_list_.size() * sizeof(nbr_t);
+  }
+
+  CsrMemoryUsage memory_usage() const override;
+
   void ingest_edge(vid_t src, vid_t dst, grape::OutArchive& arc, timestamp_t ts,
                    ArenaAllocator& alloc) override {
     EDATA_T value;
@@ -480,14 +1034,96 @@ class MutableCsr : public TypedMutableCsrBase<EDATA_T> {
     return new TypedMutableCsrConstEdgeIter<EDATA_T>(get_edges(v));
   }
   std::shared_ptr<MutableCsrEdgeIterBase> edge_iter_mut(vid_t v) override {
+    if (order_ == NbrOrder::kTime) {
+      // the data set may break the order, the whole list is the tail until
+      // the next compaction
+      sorted_sizes_[v].store(0, std::memory_order_release);
+    }
     return std::make_shared<TypedMutableCsrEdgeIter<EDATA_T>>(get_edges_mut(v));
   }
 
+  size_t delete_edges(vid_t src, vid_t dst) override;
+
+  size_t delete_edges(vid_t src) override;
+
  private:
+  std::pair<slice_t, slice_t> split_edges(vid_t i, bool ordered) const {
+    // the sorted size is read first, compact publishes it after the list
+    int sorted_size =
+        ordered ? sorted_sizes_[i].load(std::memory_order_acquire) : 0;
+    slice_t edges = adj_lists_[i].get_edges();
+    slice_t prefix, tail;
+    prefix.set_begin(edges.begin());
+    prefix.set_size(sorted_size);
+    prefix.set_max_timestamp(edges.max_timestamp());
+    tail.set_begin(edges.begin() + sorted_size);
+    tail.set_size(edges.size() - sorted_size);
+    tail.set_max_timestamp(edges.max_timestamp());
+    return std::make_pair(prefix, tail);
+  }
+
+  // the order of the sorted prefixes
+  bool nbr_less(const nbr_t& lhs, const nbr_t& rhs) const {
+    if constexpr (is_time_data<EDATA_T>::value) {
+      if (order_ == NbrOrder::kTime) {
+        return time_of(lhs.data) < time_of(rhs.data);
+      }
+    }
+    return lhs.neighbor < rhs.neighbor;
+  }
+
+  // whether data is not earlier than the edges of the list of v, all of
+  // which are in its prefix
+  bool in_time_order(vid_t v, const EDATA_T& data) const {
+    if constexpr (is_time_data<EDATA_T>::value) {
+      const auto& list = adj_lists_[v];
+      int size = list.size();
+      return sorted_sizes_[v].load() == size &&
+             (size == 0 || time_of(list.data()[size - 1].data) <=
+                               time_of(data));
+    } else {
+      return false;
+    }
+  }
+
+  // lists in the buffers of loading and compaction are not from allocators
+  bool from_allocator(const nbr_t* ptr) const {
+    const nbr_t* init_begin = init_nbr_list_.data();
+    const nbr_t* compacted_begin = compacted_nbr_list_.data();
+    return !(ptr >= init_begin && ptr < init_begin + init_nbr_list_.size()) &&
+           !(ptr >= compacted_begin &&
+             ptr < compacted_begin + compacted_nbr_list_.size());
+  }
+
+  // hub lists already have room to grow and are left in their regions
+  bool in_hubs(const adjlist_t& list) const {
+    return static_cast<size_t>(list.capacity()) * sizeof(nbr_t) >=
+               HubRegions::kHubListBytes &&
+           hubs_.contains(list.data());
+  }
+
+  void init_sorted_sizes() {
+    if (order_ != NbrOrder::kInsertion) {
+      sorted_sizes_ = new std::atomic<int>[capacity_];
+      for (vid_t i = 0; i < capacity_; ++i) {
+        sorted_sizes_[i].store(0);
+      }
+    }
+  }
+
   adjlist_t* adj_lists_;
   grape::SpinLock* locks_;
+  std::atomic<int>* sorted_sizes_;
   vid_t capacity_;
+  NbrOrder order_;
   mmap_array<nbr_t> init_nbr_list_;
+  mmap_array<nbr_t> compacted_nbr_list_;
+  mmap_array<nbr_t> retired_nbr_list_;
+  // lists with deleted edges since the last compaction, maybe repeated
+  std::vector<vid_t> deleted_lists_;
+  HubRegions hubs_;
+  // positions of hub lists, guarded by the locks of their vertices
+  mutable std::vector<std::unique_ptr<NbrPositions>> nbr_positions_;
 };
 
 template <>
@@ -498,7 +1134,10 @@ class MutableCsr<std::string> : public TypedMutableCsrBase<std::string> {
   using slice_t = MutableNbrSlice<std::string>;
   using mut_slice_t = MutableNbrSliceMut<std::string>;
 
-  MutableCsr() : adj_lists_(nullptr), locks_(nullptr), capacity_(0) {}
+  explicit MutableCsr(bool sorted = false)
+      : adj_lists_(nullptr), locks_(nullptr), capacity_(0) {
+    CHECK(!sorted) << "sorted neighbors are not supported for string edges";
+  }
   ~MutableCsr() {
     if (adj_lists_ != nullptr) {
       free(adj_lists_);
@@ -516,6 +1155,7 @@ class MutableCsr<std::string> : public TypedMutableCsrBase<std::string> {
 
     adj_lists_ = static_cast<adjlist_t*>(malloc(sizeof(adjlist_t) * capacity_));
     locks_ = new grape::SpinLock[capacity_];
+    nbr_positions_.resize(capacity_);
     size_t edge_capacity = 0;
     for (auto d : degree) {
       edge_capacity += (d + (d + 4) / 5);
@@ -535,20 +1175,24 @@ class MutableCsr<std::string> : public TypedMutableCsrBase<std::string> {
 
   void batch_put_edge(vid_t src, vid_t dst, const std::string& data,
                       timestamp_t ts = 0) override {
-    adj_lists_[src].batch_put_edge(dst, data, ts);
+    adj_lists_[src].batch_put_edge(dst, pool_.append(data), ts);
   }
 
   void put_generic_edge(vid_t src, vid_t dst, const Any& data, timestamp_t ts,
                         ArenaAllocator& alloc) override {
-    std::string value(data.value.s);
-    put_edge(src, dst, value, ts, alloc);
+    CHECK(data.type == PropertyType::kString);
+    put_edge(src, dst, data.value.s, ts, alloc);
   }
 
-  void put_edge(vid_t src, vid_t dst, const std::string& data, timestamp_t ts,
-                ArenaAllocator& allocator) {
+  void put_edge(vid_t src, vid_t dst, const std::string_view& data,
+                timestamp_t ts, ArenaAllocator& allocator) {
     CHECK_LT(src, capacity_);
+    // appended before locking, the pool has a lock of its own
+    std::string_view value = pool_.append(data);
     locks_[src].lock();
-    adj_lists_[src].put_edge(dst, data, ts, allocator);
+    auto& list = adj_lists_[src];
+    list.put_edge(dst, value, ts, allocator, from_allocator(list.data()),
+                  &hubs_);
     locks_[src].unlock();
   }
 
@@ -559,22 +1203,39 @@ class MutableCsr<std::string> : public TypedMutableCsrBase<std::string> {
   }
   mut_slice_t get_edges_mut(vid_t i) { return adj_lists_[i].get_edges_mut(); }
 
+  /** @brief Whether an edge from src to dst is visible at ts. */
+  bool exist(vid_t src, vid_t dst, timestamp_t ts) const;
+
   void Serialize(const std::string& path) override;
 
+  void Serialize(const std::string& path, timestamp_t ts) override;
+
   void Deserialize(const std::string& path) override;
 
+  size_t compact() override;
+
+  size_t compacted_bytes() const override {
+    return compacted_nbr_list_.size() * sizeof(nbr_t);
+  }
+
+  CsrMemoryUsage memory_usage() const override;
+
+  // the string is read from the archive in place, put_edge copies it
   void ingest_edge(vid_t src, vid_t dst, grape::OutArchive& arc, timestamp_t ts,
                    ArenaAllocator& alloc) override {
-    std::string value;
-    arc >> value;
-    put_edge(src, dst, value, ts, alloc);
+    size_t len;
+    arc >> len;
+    put_edge(src, dst,
+             std::string_view(static_cast<const char*>(arc.GetBytes(len)), len),
+             ts, alloc);
   }
 
   void peek_ingest_edge(vid_t src, vid_t dst, grape::OutArchive& arc,
                         timestamp_t ts, ArenaAllocator& alloc) override {
-    std::string value;
-    arc.Peek<std::string>(value);
-    put_edge(src, dst, value, ts, alloc);
+    size_t len;
+    arc.Peek<size_t>(len);
+    const char* ptr = static_cast<const char*>(arc.GetBytes(0)) + sizeof(len);
+    put_edge(src, dst, std::string_view(ptr, len), ts, alloc);
   }
 
   std::shared_ptr<MutableCsrConstEdgeIterBase> edge_iter(
@@ -589,14 +1250,42 @@ class MutableCsr<std::string> : public TypedMutableCsrBase<std::string> {
 
   std::shared_ptr<MutableCsrEdgeIterBase> edge_iter_mut(vid_t v) override {
     return std::make_shared<TypedMutableCsrEdgeIter<std::string>>(
-        get_edges_mut(v));
+        get_edges_mut(v), &pool_);
   }
 
+  size_t delete_edges(vid_t src, vid_t dst) override;
+
+  size_t delete_edges(vid_t src) override;
+
+  /** @brief Bytes of the strings held, including those of deleted edges. */
+  size_t string_bytes() const { return pool_.size(); }
+
  private:
+  bool from_allocator(const nbr_t* ptr) const {
+    const nbr_t* init_begin = nbr_list_.data();
+    const nbr_t* compacted_begin = compacted_nbr_list_.data();
+    return !(ptr >= init_begin && ptr < init_begin + nbr_list_.size()) &&
+           !(ptr >= compacted_begin &&
+             ptr < compacted_begin + compacted_nbr_list_.size());
+  }
+
+  bool in_hubs(const adjlist_t& list) const {
+    return static_cast<size_t>(list.capacity()) * sizeof(nbr_t) >=
+               HubRegions::kHubListBytes &&
+           hubs_.contains(list.data());
+  }
+
   adjlist_t* adj_lists_;
   std::vector<nbr_t> nbr_list_;
+  std::vector<nbr_t> compacted_nbr_list_;
+  std::vector<nbr_t> retired_nbr_list_;
+  std::vector<vid_t> deleted_lists_;
   grape::SpinLock* locks_;
   vid_t capacity_;
+  // strings of deleted or updated edges are kept until the csr is reloaded
+  StringPool pool_;
+  HubRegions hubs_;
+  mutable std::vector<std::unique_ptr<NbrPositions>> nbr_positions_;
 };
 
 template <typename EDATA_T>
@@ -669,8 +1358,16 @@ class SingleMutableCsr : public TypedMutableCsrBase<EDATA_T> {
 
   void Serialize(const std::string& path) override;
 
+  void Serialize(const std::string& path, timestamp_t ts) override;
+
   void Deserialize(const std::string& path) override;
 
+  size_t compact() override { return 0; }
+
+  size_t compacted_bytes() const override { return 0; }
+
+  CsrMemoryUsage memory_usage() const override;
+
   void ingest_edge(vid_t src, vid_t dst, grape::OutArchive& arc, timestamp_t ts,
                    ArenaAllocator& alloc) override {
     EDATA_T value;
@@ -699,8 +1396,313 @@ class SingleMutableCsr : public TypedMutableCsrBase<EDATA_T> {
     return std::make_shared<TypedMutableCsrEdgeIter<EDATA_T>>(get_edges_mut(v));
   }
 
+  // the slot of a deleted edge is empty again, so nothing is left to compact
+  size_t delete_edges(vid_t src, vid_t dst) override {
+    if (src >= nbr_list_.size() || nbr_list_[src].neighbor != dst) {
+      return 0;
+    }
+    return delete_edges(src);
+  }
+
+  size_t delete_edges(vid_t src) override {
+    if (src >= nbr_list_.size() ||
+        nbr_list_[src].timestamp.load() == kDeletedTimestamp) {
+      return 0;
+    }
+    nbr_list_[src].timestamp.store(kDeletedTimestamp);
+    return 1;
+  }
+
+ private:
+  mmap_array<nbr_t> nbr_list_;
+};
+
+template <>
+class SingleMutableCsr<std::string> : public TypedMutableCsrBase<std::string> {
+ public:
+  using nbr_t = MutableNbr<std::string>;
+  using slice_t = MutableNbrSlice<std::string>;
+  using mut_slice_t = MutableNbrSliceMut<std::string>;
+
+  SingleMutableCsr() {}
+  ~SingleMutableCsr() {}
+
+  void batch_init(vid_t vnum, const std::vector<int>& degree) override {
+    vid_t capacity = vnum + (vnum + 3) / 4;
+    nbr_list_.resize(capacity);
+    for (vid_t i = 0; i < capacity; ++i) {
+      nbr_list_[i].timestamp.store(std::numeric_limits<timestamp_t>::max());
+    }
+  }
+
+  void batch_put_edge(vid_t src, vid_t dst, const std::string& data,
+                      timestamp_t ts = 0) override {
+    nbr_list_[src].neighbor = dst;
+    nbr_list_[src].data = pool_.append(data);
+    CHECK_EQ(nbr_list_[src].timestamp.load(),
+             std::numeric_limits<timestamp_t>::max());
+    nbr_list_[src].timestamp.store(ts);
+  }
+
+  void put_generic_edge(vid_t src, vid_t dst, const Any& data, timestamp_t ts,
+                        ArenaAllocator&) override {
+    CHECK(data.type == PropertyType::kString);
+    put_edge(src, dst, data.value.s, ts);
+  }
+
+  void put_edge(vid_t src, vid_t dst, const std::string_view& data,
+                timestamp_t ts) {
+    CHECK_LT(src, nbr_list_.size());
+    nbr_list_[src].neighbor = dst;
+    nbr_list_[src].data = pool_.append(data);
+    CHECK_EQ(nbr_list_[src].timestamp, std::numeric_limits<timestamp_t>::max());
+    nbr_list_[src].timestamp.store(ts);
+  }
+
+  slice_t get_edges(vid_t i) const override {
+    slice_t ret;
+    ret.set_size(nbr_list_[i].timestamp.load() ==
+                         std::numeric_limits<timestamp_t>::max()
+                     ? 0
+                     : 1);
+    if (ret.size() != 0) {
+      ret.set_begin(&nbr_list_[i]);
+    }
+    return ret;
+  }
+
+  mut_slice_t get_edges_mut(vid_t i) {
+    mut_slice_t ret;
+    ret.set_size(nbr_list_[i].timestamp.load() ==
+                         std::numeric_limits<timestamp_t>::max()
+                     ? 0
+                     : 1);
+    if (ret.size() != 0) {
+      ret.set_begin(&nbr_list_[i]);
+    }
+    return ret;
+  }
+
+  const nbr_t& get_edge(vid_t i) const { return nbr_list_[i]; }
+
+  void Serialize(const std::string& path) override;
+
+  void Serialize(const std::string& path, timestamp_t ts) override;
+
+  void Deserialize(const std::string& path) override;
+
+  size_t compact() override { return 0; }
+
+  size_t compacted_bytes() const override { return 0; }
+
+  CsrMemoryUsage memory_usage() const override;
+
+  void ingest_edge(vid_t src, vid_t dst, grape::OutArchive& arc, timestamp_t ts,
+                   ArenaAllocator& alloc) override {
+    size_t len;
+    arc >> len;
+    put_edge(src, dst,
+             std::string_view(static_cast<const char*>(arc.GetBytes(len)), len),
+             ts);
+  }
+
+  void peek_ingest_edge(vid_t src, vid_t dst, grape::OutArchive& arc,
+                        timestamp_t ts, ArenaAllocator& alloc) override {
+    size_t len;
+    arc.Peek<size_t>(len);
+    const char* ptr = static_cast<const char*>(arc.GetBytes(0)) + sizeof(len);
+    put_edge(src, dst, std::string_view(ptr, len), ts);
+  }
+
+  std::shared_ptr<MutableCsrConstEdgeIterBase> edge_iter(
+      vid_t v) const override {
+    return std::make_shared<TypedMutableCsrConstEdgeIter<std::string>>(
+        get_edges(v));
+  }
+
+  MutableCsrConstEdgeIterBase* edge_iter_raw(vid_t v) const override {
+    return new TypedMutableCsrConstEdgeIter<std::string>(get_edges(v));
+  }
+
+  std::shared_ptr<MutableCsrEdgeIterBase> edge_iter_mut(vid_t v) override {
+    return std::make_shared<TypedMutableCsrEdgeIter<std::string>>(
+        get_edges_mut(v), &pool_);
+  }
+
+  size_t delete_edges(vid_t src, vid_t dst) override {
+    if (src >= nbr_list_.size() || nbr_list_[src].neighbor != dst) {
+      return 0;
+    }
+    return delete_edges(src);
+  }
+
+  size_t delete_edges(vid_t src) override {
+    if (src >= nbr_list_.size() ||
+        nbr_list_[src].timestamp.load() == kDeletedTimestamp) {
+      return 0;
+    }
+    nbr_list_[src].timestamp.store(kDeletedTimestamp);
+    return 1;
+  }
+
  private:
   mmap_array<nbr_t> nbr_list_;
+  StringPool pool_;
+};
+
+template <typename EDATA_T>
+class ImmutableCsrConstEdgeIter : public MutableCsrConstEdgeIterBase {
+ public:
+  ImmutableCsrConstEdgeIter(const uint8_t* ptr, const EDATA_T* data,
+                            size_t size)
+      : ptr_(ptr), data_(data), size_(size), neighbor_(0) {
+    if (size_ != 0) {
+      neighbor_ = decode();
+    }
+  }
+  ~ImmutableCsrConstEdgeIter() = default;
+
+  vid_t get_neighbor() const override { return neighbor_; }
+  Any get_data() const override {
+    return AnyConverter<EDATA_T>::to_any(data_ == nullptr ? EDATA_T()
+                                                          : *data_);
+  }
+  timestamp_t get_timestamp() const override { return 0; }
+
+  void next() override {
+    if (--size_ != 0) {
+      neighbor_ += decode();
+    }
+    if (data_ != nullptr) {
+      ++data_;
+    }
+  }
+  bool is_valid() const override { return size_ != 0; }
+  size_t size() const override { return size_; }
+
+ private:
+  vid_t decode() {
+    vid_t value = 0;
+    int shift = 0;
+    while (*ptr_ & 0x80) {
+      value |= static_cast<vid_t>(*ptr_++ & 0x7f) << shift;
+      shift += 7;
+    }
+    value |= static_cast<vid_t>(*ptr_++) << shift;
+    return value;
+  }
+
+  const uint8_t* ptr_;
+  const EDATA_T* data_;
+  size_t size_;
+  vid_t neighbor_;
+};
+
+/**
+ * @brief Read-only csr of edge types marked static in the schema, built once
+ * by bulk loading. The neighbors of each vertex are sorted and stored as
+ * varint encoded deltas, and no timestamps are kept, so all edges are visible
+ * to every transaction. Edges can only be read with edge_iter, there are no
+ * slices of MutableNbr to return from get_edges.
+ */
+template <typename EDATA_T>
+class ImmutableCsr : public TypedMutableCsrBase<EDATA_T> {
+ public:
+  using slice_t = MutableNbrSlice<EDATA_T>;
+
+  ImmutableCsr() : vnum_(0) {}
+  ~ImmutableCsr() {}
+
+  void batch_init(vid_t vnum, const std::vector<int>& degree) override;
+
+  void batch_put_edge(vid_t src, vid_t dst, const EDATA_T& data,
+                      timestamp_t ts = 0) override {
+    size_t pos = __sync_fetch_and_add(&loading_offsets_[src], 1);
+    loading_edges_[pos] = std::make_pair(dst, data);
+  }
+
+  /** @brief Encode the edges put since batch_init. */
+  void batch_sort_edges() override;
+
+  slice_t get_edges(vid_t i) const override {
+    LOG(FATAL) << "edges of static edge types can only be read by edge_iter";
+    return slice_t::empty();
+  }
+
+  int degree(vid_t i) const {
+    return i < vnum_ ? edge_offsets_[i + 1] - edge_offsets_[i] : 0;
+  }
+
+  void put_generic_edge(vid_t src, vid_t dst, const Any& data, timestamp_t ts,
+                        ArenaAllocator& alloc) override {
+    LOG(FATAL) << "edges can not be inserted into static edge types";
+  }
+
+  void Serialize(const std::string& path) override;
+
+  void Serialize(const std::string& path, timestamp_t ts) override {
+    Serialize(path);
+  }
+
+  void Deserialize(const std::string& path) override;
+
+  size_t compact() override { return 0; }
+
+  size_t compacted_bytes() const override { return 0; }
+
+  CsrMemoryUsage memory_usage() const override;
+
+  void ingest_edge(vid_t src, vid_t dst, grape::OutArchive& arc, timestamp_t ts,
+                   ArenaAllocator& alloc) override {
+    LOG(FATAL) << "edges can not be inserted into static edge types";
+  }
+
+  void peek_ingest_edge(vid_t src, vid_t dst, grape::OutArchive& arc,
+                        timestamp_t ts, ArenaAllocator& alloc) override {
+    LOG(FATAL) << "edges can not be inserted into static edge types";
+  }
+
+  std::shared_ptr<MutableCsrConstEdgeIterBase> edge_iter(
+      vid_t v) const override {
+    return std::shared_ptr<MutableCsrConstEdgeIterBase>(edge_iter_raw(v));
+  }
+
+  MutableCsrConstEdgeIterBase* edge_iter_raw(vid_t v) const override {
+    if (v >= vnum_) {
+      return new ImmutableCsrConstEdgeIter<EDATA_T>(nullptr, nullptr, 0);
+    }
+    const EDATA_T* data =
+        data_.size() == 0 ? nullptr : data_.data() + edge_offsets_[v];
+    return new ImmutableCsrConstEdgeIter<EDATA_T>(
+        neighbors_.data() + nbr_offsets_[v], data, degree(v));
+  }
+
+  std::shared_ptr<MutableCsrEdgeIterBase> edge_iter_mut(vid_t v) override {
+    return std::make_shared<TypedMutableCsrEdgeIter<EDATA_T>>(
+        MutableNbrSliceMut<EDATA_T>::empty());
+  }
+
+  size_t delete_edges(vid_t src, vid_t dst) override {
+    LOG(FATAL) << "edges can not be deleted from static edge types";
+    return 0;
+  }
+
+  size_t delete_edges(vid_t src) override {
+    LOG(FATAL) << "edges can not be deleted from static edge types";
+    return 0;
+  }
+
+ private:
+  vid_t vnum_;
+  // offsets of the lists of each vertex in neighbors_ and in data_
+  mmap_array<size_t> nbr_offsets_;
+  mmap_array<size_t> edge_offsets_;
+  mmap_array<uint8_t> neighbors_;
+  // empty for edges without data
+  mmap_array<EDATA_T> data_;
+
+  std::vector<std::pair<vid_t, EDATA_T>> loading_edges_;
+  std::vector<size_t> loading_offsets_;
 };
 
 }  // namespace gs
@@ -15,9 +15,17 @@
 
 #include "flex/storages/rt_mutable_graph/mutable_property_fragment.h"
 
+#include <stdio.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <functional>
+#include <numeric>
+
 namespace gs {
 
-MutablePropertyFragment::MutablePropertyFragment() {}
+MutablePropertyFragment::MutablePropertyFragment()
+    : partition_id_(0), partition_num_(1) {}
 
 MutablePropertyFragment::~MutablePropertyFragment() {
   for (auto ptr : ie_) {
@@ -34,8 +42,8 @@ MutablePropertyFragment::~MutablePropertyFragment() {
 
 void MutablePropertyFragment::initVertices(
     label_t v_label_i,
-    const std::vector<std::pair<std::string, std::string>>& vertex_files) {
-  IdIndexer<oid_t, vid_t> indexer;
+    const std::vector<std::pair<std::string, std::string>>& vertex_files,
+    int thread_num) {
   std::string v_label_name = schema_.get_vertex_label_name(v_label_i);
   std::vector<std::string> filenames;
   for (auto& pair : vertex_files) {
@@ -54,11 +62,7 @@ void MutablePropertyFragment::initVertices(
   table.init(col_names, property_types,
              schema_.get_vertex_storage_strategies(v_label_name),
              schema_.get_max_vnum(v_label_name));
-  parseVertexFiles(v_label_name, filenames, indexer);
-  if (indexer.bucket_count() == 0) {
-    indexer._rehash(schema_.get_max_vnum(v_label_name));
-  }
-  build_lf_indexer(indexer, lf_indexers_[v_label_i]);
+  parseVertexFiles(v_label_name, filenames, thread_num);
 }
 
 template <typename EDATA_T>
@@ -77,9 +81,16 @@ class EmptyCsr : public TypedMutableCsrBase<EDATA_T> {
                         ArenaAllocator& alloc) override {}
 
   void Serialize(const std::string& path) override {}
+  void Serialize(const std::string& path, timestamp_t ts) override {}
 
   void Deserialize(const std::string& path) override {}
 
+  size_t compact() override { return 0; }
+
+  size_t compacted_bytes() const override { return 0; }
+
+  CsrMemoryUsage memory_usage() const override { return CsrMemoryUsage(); }
+
   void batch_put_edge(vid_t src, vid_t dst, const EDATA_T& data,
                       timestamp_t ts = 0) override {}
 
@@ -105,14 +116,26 @@ class EmptyCsr : public TypedMutableCsrBase<EDATA_T> {
     return std::make_shared<TypedMutableCsrEdgeIter<EDATA_T>>(
         MutableNbrSliceMut<EDATA_T>::empty());
   }
+
+  size_t delete_edges(vid_t src, vid_t dst) override { return 0; }
+
+  size_t delete_edges(vid_t src) override { return 0; }
 };
 
 template <typename EDATA_T>
-TypedMutableCsrBase<EDATA_T>* create_typed_csr(EdgeStrategy es) {
+TypedMutableCsrBase<EDATA_T>* create_typed_csr(EdgeStrategy es, NbrOrder order,
+                                               bool is_static) {
+  if (es == EdgeStrategy::kMultiple && is_static) {
+    if constexpr (std::is_same<EDATA_T, std::string>::value) {
+      LOG(FATAL) << "static edge types with string data are not supported";
+    } else {
+      return new ImmutableCsr<EDATA_T>();
+    }
+  }
   if (es == EdgeStrategy::kSingle) {
     return new SingleMutableCsr<EDATA_T>();
   } else if (es == EdgeStrategy::kMultiple) {
-    return new MutableCsr<EDATA_T>();
+    return new MutableCsr<EDATA_T>(order);
   } else if (es == EdgeStrategy::kNone) {
     return new EmptyCsr<EDATA_T>();
   }
@@ -121,9 +144,12 @@ TypedMutableCsrBase<EDATA_T>* create_typed_csr(EdgeStrategy es) {
 
 template <typename EDATA_T>
 std::pair<MutableCsrBase*, MutableCsrBase*> construct_empty_csr(
-    EdgeStrategy ie_strategy, EdgeStrategy oe_strategy) {
-  TypedMutableCsrBase<EDATA_T>* ie_csr = create_typed_csr<EDATA_T>(ie_strategy);
-  TypedMutableCsrBase<EDATA_T>* oe_csr = create_typed_csr<EDATA_T>(oe_strategy);
+    EdgeStrategy ie_strategy, EdgeStrategy oe_strategy, NbrOrder order,
+    bool is_static) {
+  TypedMutableCsrBase<EDATA_T>* ie_csr =
+      create_typed_csr<EDATA_T>(ie_strategy, order, is_static);
+  TypedMutableCsrBase<EDATA_T>* oe_csr =
+      create_typed_csr<EDATA_T>(oe_strategy, order, is_static);
   ie_csr->batch_init(0, {});
   oe_csr->batch_init(0, {});
   return std::make_pair(ie_csr, oe_csr);
@@ -142,74 +168,329 @@ void preprocess_line(char* line) {
   line[len + 1] = '\0';
 }
 
-template <typename EDATA_T>
-std::pair<MutableCsrBase*, MutableCsrBase*> construct_csr(
-    const std::vector<std::string>& filenames,
-    const std::vector<PropertyType>& property_types, EdgeStrategy ie_strategy,
-    EdgeStrategy oe_strategy, const LFIndexer<vid_t>& src_indexer,
-    const LFIndexer<vid_t>& dst_indexer) {
-  TypedMutableCsrBase<EDATA_T>* ie_csr = create_typed_csr<EDATA_T>(ie_strategy);
-  TypedMutableCsrBase<EDATA_T>* oe_csr = create_typed_csr<EDATA_T>(oe_strategy);
-
-  std::vector<int> odegree(src_indexer.size(), 0);
-  std::vector<int> idegree(dst_indexer.size(), 0);
+struct FileChunk {
+  std::string filename;
+  size_t begin;
+  size_t end;
+};
 
-  std::vector<std::tuple<vid_t, vid_t, EDATA_T>> parsed_edges;
-  vid_t src_index, dst_index;
-  char line_buf[4096];
-  oid_t src, dst;
-  EDATA_T data;
+// Split files into byte ranges, several times more than threads so that
+// threads stay busy with chunks of uneven parsing cost.
+std::vector<FileChunk> split_files(const std::vector<std::string>& filenames,
+                                   int thread_num) {
+  static constexpr size_t min_chunk_size = 64 * 1024 * 1024;
+  std::vector<size_t> file_sizes;
+  size_t total_size = 0;
+  for (auto& filename : filenames) {
+    file_sizes.push_back(std::filesystem::file_size(filename));
+    total_size += file_sizes.back();
+  }
+  size_t chunk_size = std::max(total_size / (thread_num * 8), min_chunk_size);
+  std::vector<FileChunk> chunks;
+  for (size_t i = 0; i < filenames.size(); ++i) {
+    for (size_t begin = 0; begin < file_sizes[i]; begin += chunk_size) {
+      chunks.push_back(
+          {filenames[i], begin, std::min(begin + chunk_size, file_sizes[i])});
+    }
+  }
+  return chunks;
+}
 
-  bool first_file = true;
-  size_t col_num = property_types.size();
-  std::vector<Any> header(col_num + 2);
-  for (auto& item : header) {
-    item.type = PropertyType::kString;
+// Call func with each preprocessed line starting in the chunk, the header
+// line of the file is skipped. Lines are not limited in length.
+template <typename FUNC_T>
+void foreach_line(const FileChunk& chunk, const FUNC_T& func) {
+  FILE* fin = fopen(chunk.filename.c_str(), "r");
+  CHECK(fin != NULL) << "failed to open " << chunk.filename;
+  char* line = NULL;
+  size_t cap = 0;
+  // the line across begin belongs to the chunk before, reading from begin - 1
+  // also skips a whole line if one starts right at begin
+  size_t pos = chunk.begin > 0 ? chunk.begin - 1 : 0;
+  fseek(fin, pos, SEEK_SET);
+  ssize_t len = getline(&line, &cap, fin);
+  if (len > 0) {
+    pos += len;
   }
-  for (auto filename : filenames) {
+  while (pos < chunk.end && (len = getline(&line, &cap, fin)) != -1) {
+    pos += len;
+    preprocess_line(line);
+    func(line);
+  }
+  free(line);
+  fclose(fin);
+}
+
+// Read the header line of the first file having one.
+bool read_header(const std::vector<std::string>& filenames,
+                 std::string& header) {
+  for (auto& filename : filenames) {
     FILE* fin = fopen(filename.c_str(), "r");
-    if (fgets(line_buf, 4096, fin) == NULL) {
-      continue;
+    CHECK(fin != NULL) << "failed to open " << filename;
+    char* line = NULL;
+    size_t cap = 0;
+    bool found = (getline(&line, &cap, fin) != -1);
+    if (found) {
+      preprocess_line(line);
+      header = line;
     }
-    preprocess_line(line_buf);
-    if (first_file) {
-      ParseRecord(line_buf, header);
-      std::vector<std::string> col_names(col_num);
-      for (size_t i = 0; i < col_num; ++i) {
-        col_names[i] = std::string(header[i + 2].value.s.data(),
-                                   header[i + 2].value.s.size());
+    free(line);
+    fclose(fin);
+    if (found) {
+      return true;
+    }
+  }
+  return false;
+}
+
+template <typename FUNC_T>
+void parallel_for_each(size_t num, int thread_num, const FUNC_T& func) {
+  std::atomic<size_t> index(0);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < thread_num; ++i) {
+    threads.emplace_back([&]() {
+      while (true) {
+        size_t cur = index.fetch_add(1);
+        if (cur >= num) {
+          break;
+        }
+        func(cur);
+      }
+    });
+  }
+  for (auto& thrd : threads) {
+    thrd.join();
+  }
+}
+
+// Vertices of csrs are visited by blocks of this many by threads.
+static constexpr size_t kVertexBlockSize = 4096;
+
+// Add the number of edges not deleted of the first num vertices of csr to
+// their degrees.
+template <typename EDATA_T>
+void add_csr_degrees(const TypedMutableCsrBase<EDATA_T>* csr, vid_t num,
+                     int thread_num, std::vector<int>& degree) {
+  size_t block_num = (num + kVertexBlockSize - 1) / kVertexBlockSize;
+  parallel_for_each(block_num, thread_num, [&](size_t block_i) {
+    vid_t end = std::min<size_t>(num, (block_i + 1) * kVertexBlockSize);
+    for (vid_t v = block_i * kVertexBlockSize; v < end; ++v) {
+      for (auto& nbr : csr->get_edges(v)) {
+        degree[v] += (nbr.timestamp.load() != kDeletedTimestamp);
       }
-      first_file = false;
     }
+  });
+}
 
-    while (fgets(line_buf, 4096, fin) != NULL) {
-      ParseRecordX(line_buf, src, dst, data);
-      src_index = src_indexer.get_index(src);
-      dst_index = dst_indexer.get_index(dst);
-      ++idegree[dst_index];
-      ++odegree[src_index];
-      parsed_edges.emplace_back(src_index, dst_index, data);
+// Put the edges not deleted of the first num vertices of old into csr, with
+// their timestamps.
+template <typename EDATA_T>
+void copy_csr_edges(const TypedMutableCsrBase<EDATA_T>* old, vid_t num,
+                    int thread_num, TypedMutableCsrBase<EDATA_T>* csr) {
+  size_t block_num = (num + kVertexBlockSize - 1) / kVertexBlockSize;
+  parallel_for_each(block_num, thread_num, [&](size_t block_i) {
+    vid_t end = std::min<size_t>(num, (block_i + 1) * kVertexBlockSize);
+    for (vid_t v = block_i * kVertexBlockSize; v < end; ++v) {
+      for (auto& nbr : old->get_edges(v)) {
+        timestamp_t ts = nbr.timestamp.load();
+        if (ts != kDeletedTimestamp) {
+          csr->batch_put_edge(v, nbr.neighbor, EDATA_T(nbr.data), ts);
+        }
+      }
     }
-    fclose(fin);
-  }
+  });
+}
 
+// Put the edges parsed by chunks into the csrs, whose lists are sized by the
+// degrees counted while parsing. The parsed edges are released meanwhile.
+// When appending, the edges of old csrs, of the first old_src_num sources
+// and old_dst_num destinations, are put first, their degrees must be
+// counted in as well.
+template <typename EDATA_T, typename OWNS_T>
+void fill_csrs(
+    std::vector<std::vector<std::tuple<vid_t, vid_t, EDATA_T>>>& parsed_edges,
+    const std::vector<int>& idegree, const std::vector<int>& odegree,
+    TypedMutableCsrBase<EDATA_T>* ie_csr, TypedMutableCsrBase<EDATA_T>* oe_csr,
+    const LFIndexer<vid_t>& src_indexer, const LFIndexer<vid_t>& dst_indexer,
+    int thread_num, const OWNS_T& owns,
+    const TypedMutableCsrBase<EDATA_T>* old_ie = nullptr,
+    const TypedMutableCsrBase<EDATA_T>* old_oe = nullptr,
+    vid_t old_src_num = 0, vid_t old_dst_num = 0) {
   ie_csr->batch_init(dst_indexer.size(), idegree);
   oe_csr->batch_init(src_indexer.size(), odegree);
+  if (old_ie != nullptr) {
+    copy_csr_edges(old_ie, old_dst_num, thread_num, ie_csr);
+  }
+  if (old_oe != nullptr) {
+    copy_csr_edges(old_oe, old_src_num, thread_num, oe_csr);
+  }
+
+  parallel_for_each(parsed_edges.size(), thread_num, [&](size_t chunk_i) {
+    for (auto& edge : parsed_edges[chunk_i]) {
+      if (owns(dst_indexer.get_key(std::get<1>(edge)))) {
+        ie_csr->batch_put_edge(std::get<1>(edge), std::get<0>(edge),
+                               std::get<2>(edge));
+      }
+      if (owns(src_indexer.get_key(std::get<0>(edge)))) {
+        oe_csr->batch_put_edge(std::get<0>(edge), std::get<1>(edge),
+                               std::get<2>(edge));
+      }
+    }
+    std::vector<std::tuple<vid_t, vid_t, EDATA_T>>().swap(
+        parsed_edges[chunk_i]);
+  });
+  ie_csr->batch_sort_edges();
+  oe_csr->batch_sort_edges();
+}
 
-  for (auto& edge : parsed_edges) {
-    ie_csr->batch_put_edge(std::get<1>(edge), std::get<0>(edge),
-                           std::get<2>(edge));
-    oe_csr->batch_put_edge(std::get<0>(edge), std::get<1>(edge),
-                           std::get<2>(edge));
+// Edges are kept by the partitions of their endpoints, outgoing ones by the
+// source's and incoming ones by the destination's.
+struct PartitionOwns {
+  bool operator()(oid_t oid) const {
+    return partition_num <= 1 ||
+           MutablePropertyFragment::get_partition(oid, partition_num) ==
+               partition_id;
   }
 
+  uint32_t partition_id;
+  uint32_t partition_num;
+};
+
+// Parse the edges of files by chunks, adding those kept to the degrees of
+// their endpoints.
+template <typename EDATA_T>
+std::vector<std::vector<std::tuple<vid_t, vid_t, EDATA_T>>> parse_edges(
+    const std::vector<std::string>& filenames,
+    const LFIndexer<vid_t>& src_indexer, const LFIndexer<vid_t>& dst_indexer,
+    int thread_num, const PartitionOwns& owns, std::vector<int>& idegree,
+    std::vector<int>& odegree) {
+  auto chunks = split_files(filenames, thread_num);
+  std::vector<std::vector<std::tuple<vid_t, vid_t, EDATA_T>>> parsed_edges(
+      chunks.size());
+  parallel_for_each(chunks.size(), thread_num, [&](size_t chunk_i) {
+    auto& edges = parsed_edges[chunk_i];
+    oid_t src, dst;
+    EDATA_T data;
+    foreach_line(chunks[chunk_i], [&](const char* line) {
+      ParseRecordX(line, src, dst, data);
+      bool keep_oe = owns(src);
+      bool keep_ie = owns(dst);
+      if (!keep_oe && !keep_ie) {
+        return;
+      }
+      vid_t src_index = src_indexer.get_index(src);
+      vid_t dst_index = dst_indexer.get_index(dst);
+      if (keep_ie) {
+        __sync_fetch_and_add(&idegree[dst_index], 1);
+      }
+      if (keep_oe) {
+        __sync_fetch_and_add(&odegree[src_index], 1);
+      }
+      edges.emplace_back(src_index, dst_index, data);
+    });
+  });
+  return parsed_edges;
+}
+
+template <typename EDATA_T>
+std::pair<MutableCsrBase*, MutableCsrBase*> construct_csr(
+    const std::vector<std::string>& filenames,
+    const std::vector<PropertyType>& property_types, EdgeStrategy ie_strategy,
+    EdgeStrategy oe_strategy, NbrOrder order, bool is_static,
+    const LFIndexer<vid_t>& src_indexer, const LFIndexer<vid_t>& dst_indexer,
+    int thread_num, uint32_t partition_id, uint32_t partition_num) {
+  PartitionOwns owns{partition_id, partition_num};
+  TypedMutableCsrBase<EDATA_T>* ie_csr =
+      create_typed_csr<EDATA_T>(ie_strategy, order, is_static);
+  TypedMutableCsrBase<EDATA_T>* oe_csr =
+      create_typed_csr<EDATA_T>(oe_strategy, order, is_static);
+
+  std::vector<int> odegree(src_indexer.size(), 0);
+  std::vector<int> idegree(dst_indexer.size(), 0);
+  auto parsed_edges = parse_edges<EDATA_T>(filenames, src_indexer, dst_indexer,
+                                           thread_num, owns, idegree, odegree);
+  fill_csrs(parsed_edges, idegree, odegree, ie_csr, oe_csr, src_indexer,
+            dst_indexer, thread_num, owns);
+  return std::make_pair(ie_csr, oe_csr);
+}
+
+// Edges of types with several properties: each edge kept gets the next row of
+// table, which is the data of the edge in both csrs.
+std::vector<std::vector<std::tuple<vid_t, vid_t, int64_t>>> parse_table_edges(
+    const std::vector<std::string>& filenames,
+    const std::vector<PropertyType>& property_types,
+    const LFIndexer<vid_t>& src_indexer, const LFIndexer<vid_t>& dst_indexer,
+    Table& table, std::atomic<size_t>& row_num, size_t max_row_num,
+    int thread_num, const PartitionOwns& owns, std::vector<int>& idegree,
+    std::vector<int>& odegree) {
+  size_t col_num = property_types.size();
+  auto chunks = split_files(filenames, thread_num);
+  std::vector<std::vector<std::tuple<vid_t, vid_t, int64_t>>> parsed_edges(
+      chunks.size());
+  parallel_for_each(chunks.size(), thread_num, [&](size_t chunk_i) {
+    auto& edges = parsed_edges[chunk_i];
+    std::vector<Any> rec(col_num + 2);
+    rec[0].type = PropertyType::kInt64;
+    rec[1].type = PropertyType::kInt64;
+    for (size_t i = 0; i < col_num; ++i) {
+      rec[i + 2].type = property_types[i];
+    }
+    foreach_line(chunks[chunk_i], [&](const char* line) {
+      ParseRecord(line, rec);
+      oid_t src = rec[0].value.l, dst = rec[1].value.l;
+      bool keep_oe = owns(src);
+      bool keep_ie = owns(dst);
+      if (!keep_oe && !keep_ie) {
+        return;
+      }
+      vid_t src_index = src_indexer.get_index(src);
+      vid_t dst_index = dst_indexer.get_index(dst);
+      if (keep_ie) {
+        __sync_fetch_and_add(&idegree[dst_index], 1);
+      }
+      if (keep_oe) {
+        __sync_fetch_and_add(&odegree[src_index], 1);
+      }
+      // strings of the line are copied by the columns
+      size_t row = row_num.fetch_add(1);
+      CHECK_LT(row, max_row_num) << "too many edges, see max_edge_num";
+      for (size_t i = 0; i < col_num; ++i) {
+        table.get_column_by_id(i)->set_any(row, rec[i + 2]);
+      }
+      edges.emplace_back(src_index, dst_index, static_cast<int64_t>(row));
+    });
+  });
+  return parsed_edges;
+}
+
+std::pair<MutableCsrBase*, MutableCsrBase*> construct_table_csr(
+    const std::vector<std::string>& filenames,
+    const std::vector<PropertyType>& property_types, EdgeStrategy ie_strategy,
+    EdgeStrategy oe_strategy, NbrOrder order, bool is_static,
+    const LFIndexer<vid_t>& src_indexer, const LFIndexer<vid_t>& dst_indexer,
+    Table& table, std::atomic<size_t>& row_num, size_t max_row_num,
+    int thread_num, uint32_t partition_id, uint32_t partition_num) {
+  PartitionOwns owns{partition_id, partition_num};
+  TypedMutableCsrBase<int64_t>* ie_csr =
+      create_typed_csr<int64_t>(ie_strategy, order, is_static);
+  TypedMutableCsrBase<int64_t>* oe_csr =
+      create_typed_csr<int64_t>(oe_strategy, order, is_static);
+
+  std::vector<int> odegree(src_indexer.size(), 0);
+  std::vector<int> idegree(dst_indexer.size(), 0);
+  auto parsed_edges = parse_table_edges(
+      filenames, property_types, src_indexer, dst_indexer, table, row_num,
+      max_row_num, thread_num, owns, idegree, odegree);
+  fill_csrs(parsed_edges, idegree, odegree, ie_csr, oe_csr, src_indexer,
+            dst_indexer, thread_num, owns);
   return std::make_pair(ie_csr, oe_csr);
 }
 
 void MutablePropertyFragment::initEdges(
     label_t src_label_i, label_t dst_label_i, label_t edge_label_i,
     const std::vector<std::tuple<std::string, std::string, std::string,
-                                 std::string>>& edge_files) {
+                                 std::string>>& edge_files,
+    int thread_num) {
   std::string src_label_name = schema_.get_vertex_label_name(src_label_i);
   std::string dst_label_name = schema_.get_vertex_label_name(dst_label_i);
   std::string edge_label_name = schema_.get_edge_label_name(edge_label_i);
@@ -224,7 +505,6 @@ void MutablePropertyFragment::initEdges(
   auto& property_types = schema_.get_edge_properties(
       src_label_name, dst_label_name, edge_label_name);
   size_t col_num = property_types.size();
-  CHECK_LE(col_num, 1) << "Only single or no property is supported for edge.";
 
   size_t index = src_label_i * vertex_label_num_ * edge_label_num_ +
                  dst_label_i * edge_label_num_ + edge_label_i;
@@ -232,58 +512,105 @@ void MutablePropertyFragment::initEdges(
       src_label_name, dst_label_name, edge_label_name);
   EdgeStrategy ie_strtagy = schema_.get_incoming_edge_strategy(
       src_label_name, dst_label_name, edge_label_name);
-
-  if (col_num == 0) {
+  NbrOrder nbr_order =
+      schema_.get_nbr_order(src_label_i, dst_label_i, edge_label_i);
+  bool is_static =
+      schema_.is_static_edge(src_label_i, dst_label_i, edge_label_i);
+
+  if (col_num > 1) {
+    auto& table = edge_data_[index];
+    std::vector<std::string> col_names;
+    for (size_t col_i = 0; col_i < col_num; ++col_i) {
+      col_names.push_back("col_" + std::to_string(col_i));
+    }
+    size_t max_enum =
+        schema_.get_max_enum(src_label_i, dst_label_i, edge_label_i);
+    table.init(col_names, property_types, {}, max_enum);
+    std::string header_line;
+    if (read_header(filenames, header_line)) {
+      std::vector<Any> header(col_num + 2);
+      for (auto& item : header) {
+        item.type = PropertyType::kString;
+      }
+      ParseRecord(header_line.c_str(), header);
+      for (size_t i = 0; i < col_num; ++i) {
+        col_names[i] = std::string(header[i + 2].value.s.data(),
+                                   header[i + 2].value.s.size());
+      }
+      table.reset_header(col_names);
+    }
+    if (filenames.empty()) {
+      std::tie(ie_[index], oe_[index]) = construct_empty_csr<int64_t>(
+          ie_strtagy, oe_strtagy, nbr_order, is_static);
+    } else {
+      std::tie(ie_[index], oe_[index]) = construct_table_csr(
+          filenames, property_types, ie_strtagy, oe_strtagy, nbr_order,
+          is_static, lf_indexers_[src_label_i], lf_indexers_[dst_label_i],
+          table, edge_row_nums_[index], max_enum, thread_num, partition_id_,
+          partition_num_);
+    }
+  } else if (col_num == 0) {
     if (filenames.empty()) {
       std::tie(ie_[index], oe_[index]) =
-          construct_empty_csr<grape::EmptyType>(ie_strtagy, oe_strtagy);
+          construct_empty_csr<grape::EmptyType>(ie_strtagy, oe_strtagy,
+                                                nbr_order, is_static);
     } else {
       std::tie(ie_[index], oe_[index]) = construct_csr<grape::EmptyType>(
-          filenames, property_types, ie_strtagy, oe_strtagy,
-          lf_indexers_[src_label_i], lf_indexers_[dst_label_i]);
+          filenames, property_types, ie_strtagy, oe_strtagy, nbr_order,
+          is_static, lf_indexers_[src_label_i], lf_indexers_[dst_label_i],
+          thread_num, partition_id_, partition_num_);
     }
   } else if (property_types[0] == PropertyType::kDate) {
     if (filenames.empty()) {
       std::tie(ie_[index], oe_[index]) =
-          construct_empty_csr<Date>(ie_strtagy, oe_strtagy);
+          construct_empty_csr<Date>(ie_strtagy, oe_strtagy, nbr_order,
+                                    is_static);
     } else {
       std::tie(ie_[index], oe_[index]) = construct_csr<Date>(
-          filenames, property_types, ie_strtagy, oe_strtagy,
-          lf_indexers_[src_label_i], lf_indexers_[dst_label_i]);
+          filenames, property_types, ie_strtagy, oe_strtagy, nbr_order,
+          is_static, lf_indexers_[src_label_i], lf_indexers_[dst_label_i],
+          thread_num, partition_id_, partition_num_);
     }
   } else if (property_types[0] == PropertyType::kInt32) {
     if (filenames.empty()) {
       std::tie(ie_[index], oe_[index]) =
-          construct_empty_csr<int>(ie_strtagy, oe_strtagy);
+          construct_empty_csr<int>(ie_strtagy, oe_strtagy, nbr_order,
+                                   is_static);
     } else {
       std::tie(ie_[index], oe_[index]) = construct_csr<int>(
-          filenames, property_types, ie_strtagy, oe_strtagy,
-          lf_indexers_[src_label_i], lf_indexers_[dst_label_i]);
+          filenames, property_types, ie_strtagy, oe_strtagy, nbr_order,
+          is_static, lf_indexers_[src_label_i], lf_indexers_[dst_label_i],
+          thread_num, partition_id_, partition_num_);
     }
   } else if (property_types[0] == PropertyType::kInt64) {
     if (filenames.empty()) {
       std::tie(ie_[index], oe_[index]) =
-          construct_empty_csr<int64_t>(ie_strtagy, oe_strtagy);
+          construct_empty_csr<int64_t>(ie_strtagy, oe_strtagy, nbr_order,
+                                       is_static);
     } else {
       std::tie(ie_[index], oe_[index]) = construct_csr<int64_t>(
-          filenames, property_types, ie_strtagy, oe_strtagy,
-          lf_indexers_[src_label_i], lf_indexers_[dst_label_i]);
+          filenames, property_types, ie_strtagy, oe_strtagy, nbr_order,
+          is_static, lf_indexers_[src_label_i], lf_indexers_[dst_label_i],
+          thread_num, partition_id_, partition_num_);
     }
   } else if (property_types[0] == PropertyType::kString) {
     if (filenames.empty()) {
       std::tie(ie_[index], oe_[index]) =
-          construct_empty_csr<std::string>(ie_strtagy, oe_strtagy);
+          construct_empty_csr<std::string>(ie_strtagy, oe_strtagy,
+                                           nbr_order, is_static);
     } else {
       LOG(FATAL) << "Unsupported edge property type.";
     }
   } else if (property_types[0] == PropertyType::kDouble) {
     if (filenames.empty()) {
       std::tie(ie_[index], oe_[index]) =
-          construct_empty_csr<double>(ie_strtagy, oe_strtagy);
+          construct_empty_csr<double>(ie_strtagy, oe_strtagy, nbr_order,
+                                      is_static);
     } else {
       std::tie(ie_[index], oe_[index]) = construct_csr<double>(
-          filenames, property_types, ie_strtagy, oe_strtagy,
-          lf_indexers_[src_label_i], lf_indexers_[dst_label_i]);
+          filenames, property_types, ie_strtagy, oe_strtagy, nbr_order,
+          is_static, lf_indexers_[src_label_i], lf_indexers_[dst_label_i],
+          thread_num, partition_id_, partition_num_);
 
       //      LOG(FATAL) << "Unsupported edge property type.";
     }
@@ -292,106 +619,180 @@ void MutablePropertyFragment::initEdges(
   }
 }
 
+// Vids are given by descending degrees, counted over the edge files of all
+// labels, so that hubs, which most expansions reach, share the pages of the
+// csrs and the columns instead of being scattered among vertices rarely
+// visited. Vertices of equal degrees keep the order of the files, and
+// vertices inserted later are appended after all of them.
+void MutablePropertyFragment::reorderVertices(
+    const std::vector<std::tuple<std::string, std::string, std::string,
+                                 std::string>>& edge_files,
+    int thread_num) {
+  std::vector<std::vector<int>> degrees(vertex_label_num_);
+  for (size_t label = 0; label < vertex_label_num_; ++label) {
+    degrees[label].resize(lf_indexers_[label].size(), 0);
+  }
+  for (auto& tuple : edge_files) {
+    label_t src_label = schema_.get_vertex_label_id(std::get<0>(tuple));
+    label_t dst_label = schema_.get_vertex_label_id(std::get<1>(tuple));
+    auto chunks = split_files({std::get<3>(tuple)}, thread_num);
+    parallel_for_each(chunks.size(), thread_num, [&](size_t chunk_i) {
+      oid_t src, dst;
+      grape::EmptyType data;
+      vid_t lid;
+      foreach_line(chunks[chunk_i], [&](const char* line) {
+        ParseRecordX(line, src, dst, data);
+        if (lf_indexers_[src_label].get_index(src, lid)) {
+          __sync_fetch_and_add(&degrees[src_label][lid], 1);
+        }
+        if (lf_indexers_[dst_label].get_index(dst, lid)) {
+          __sync_fetch_and_add(&degrees[dst_label][lid], 1);
+        }
+      });
+    });
+  }
+
+  for (size_t label = 0; label < vertex_label_num_; ++label) {
+    auto& degree = degrees[label];
+    std::vector<size_t> order(degree.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](size_t lhs, size_t rhs) {
+      return degree[lhs] > degree[rhs];
+    });
+    std::vector<int>().swap(degree);
+
+    auto& indexer = lf_indexers_[label];
+    std::vector<oid_t> keys(order.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+      keys[i] = indexer.get_key(order[i]);
+    }
+    size_t max_vnum =
+        schema_.get_max_vnum(schema_.get_vertex_label_name(label));
+    vertex_data_[label].reorder(order, max_vnum, thread_num);
+    build_lf_indexer(keys, indexer, max_vnum, thread_num);
+  }
+}
+
 void MutablePropertyFragment::Init(
     const Schema& schema,
     const std::vector<std::pair<std::string, std::string>>& vertex_files,
     const std::vector<std::tuple<std::string, std::string, std::string,
                                  std::string>>& edge_files,
-    int thread_num) {
+    int thread_num, uint32_t partition_id, uint32_t partition_num,
+    bool reorder_vertices) {
+  CHECK_LT(partition_id, partition_num);
+  partition_id_ = partition_id;
+  partition_num_ = partition_num;
   schema_ = schema;
   vertex_label_num_ = schema_.vertex_label_num();
   edge_label_num_ = schema_.edge_label_num();
   vertex_data_.resize(vertex_label_num_);
   ie_.resize(vertex_label_num_ * vertex_label_num_ * edge_label_num_, NULL);
   oe_.resize(vertex_label_num_ * vertex_label_num_ * edge_label_num_, NULL);
+  edge_data_.resize(vertex_label_num_ * vertex_label_num_ * edge_label_num_);
+  edge_row_nums_ = std::vector<std::atomic<size_t>>(
+      vertex_label_num_ * vertex_label_num_ * edge_label_num_);
+  edge_max_ts_ = std::vector<std::atomic<timestamp_t>>(
+      vertex_label_num_ * vertex_label_num_ * edge_label_num_);
+  edges_updated_ = std::vector<std::atomic<bool>>(
+      vertex_label_num_ * vertex_label_num_ * edge_label_num_);
   lf_indexers_.resize(vertex_label_num_);
+  vertex_tombstones_.resize(vertex_label_num_);
 
-  if (thread_num == 1) {
-    for (size_t v_label_i = 0; v_label_i != vertex_label_num_; ++v_label_i) {
-      initVertices(v_label_i, vertex_files);
-    }
-    if (!vertex_files.empty()) {
-      LOG(INFO) << "finished loading vertices";
-    }
-
-    for (size_t src_label_i = 0; src_label_i != vertex_label_num_;
-         ++src_label_i) {
-      std::string src_label_name = schema_.get_vertex_label_name(src_label_i);
-      for (size_t dst_label_i = 0; dst_label_i != vertex_label_num_;
-           ++dst_label_i) {
-        std::string dst_label_name = schema_.get_vertex_label_name(dst_label_i);
-        for (size_t e_label_i = 0; e_label_i != edge_label_num_; ++e_label_i) {
-          std::string e_label_name = schema_.get_edge_label_name(e_label_i);
-          if (schema_.valid_edge_property(src_label_name, dst_label_name,
-                                          e_label_name)) {
-            initEdges(src_label_i, dst_label_i, e_label_i, edge_files);
-          }
+  // labels are loaded one by one, each by all threads
+  for (size_t v_label_i = 0; v_label_i != vertex_label_num_; ++v_label_i) {
+    initVertices(v_label_i, vertex_files, thread_num);
+  }
+  if (!vertex_files.empty()) {
+    LOG(INFO) << "finished loading vertices";
+  }
+  if (reorder_vertices && !edge_files.empty()) {
+    reorderVertices(edge_files, thread_num);
+    LOG(INFO) << "finished reordering vertices";
+  }
+
+  for (size_t src_label_i = 0; src_label_i != vertex_label_num_;
+       ++src_label_i) {
+    std::string src_label_name = schema_.get_vertex_label_name(src_label_i);
+    for (size_t dst_label_i = 0; dst_label_i != vertex_label_num_;
+         ++dst_label_i) {
+      std::string dst_label_name = schema_.get_vertex_label_name(dst_label_i);
+      for (size_t e_label_i = 0; e_label_i != edge_label_num_; ++e_label_i) {
+        std::string e_label_name = schema_.get_edge_label_name(e_label_i);
+        if (schema_.valid_edge_property(src_label_name, dst_label_name,
+                                        e_label_name)) {
+          initEdges(src_label_i, dst_label_i, e_label_i, edge_files,
+                    thread_num);
         }
       }
     }
-    if (!edge_files.empty()) {
-      LOG(INFO) << "finished loading edges";
-    }
-  } else {
-    {
-      std::atomic<size_t> v_label_id(0);
-      std::vector<std::thread> threads(thread_num);
-      for (int i = 0; i < thread_num; ++i) {
-        threads[i] = std::thread([&]() {
-          while (true) {
-            size_t cur = v_label_id.fetch_add(1);
-            if (cur >= vertex_label_num_) {
-              break;
-            }
-            initVertices(cur, vertex_files);
-          }
-        });
-      }
-      for (auto& thrd : threads) {
-        thrd.join();
-      }
-      if (!vertex_files.empty()) {
-        LOG(INFO) << "finished loading vertices";
+  }
+  if (!edge_files.empty()) {
+    LOG(INFO) << "finished loading edges";
+  }
+  buildVertexIndexes(thread_num);
+}
+
+void MutablePropertyFragment::buildVertexIndexes(int thread_num) {
+  vertex_indexes_.clear();
+  vertex_indexes_.resize(vertex_label_num_);
+  std::vector<std::pair<label_t, int>> indexed;
+  for (size_t label = 0; label != vertex_label_num_; ++label) {
+    const auto& types = schema_.get_vertex_properties(label);
+    vertex_indexes_[label].resize(types.size());
+    for (size_t col_id = 0; col_id < types.size(); ++col_id) {
+      auto& index = vertex_indexes_[label][col_id];
+      index = CreateVertexIndex(schema_.get_vertex_index_type(label, col_id),
+                                types[col_id]);
+      if (index != nullptr) {
+        indexed.emplace_back(label, col_id);
+      } else if (schema_.get_vertex_index_type(label, col_id) !=
+                 IndexType::kNone) {
+        LOG(WARNING) << "Property " << col_id << " of vertex "
+                     << schema_.get_vertex_label_name(label)
+                     << " is not indexed, its type can not be";
       }
     }
-    {
-      std::atomic<size_t> e_label_index(0);
-      size_t e_label_num =
-          vertex_label_num_ * vertex_label_num_ * edge_label_num_;
-      std::vector<std::thread> threads(thread_num);
-      for (int i = 0; i < thread_num; ++i) {
-        threads[i] = std::thread([&]() {
-          while (true) {
-            size_t cur = e_label_index.fetch_add(1);
-            if (cur >= e_label_num) {
-              break;
-            }
-            size_t e_label_i = cur % edge_label_num_;
-            cur = cur / edge_label_num_;
-            size_t dst_label_i = cur % vertex_label_num_;
-            size_t src_label_i = cur / vertex_label_num_;
-            std::string src_label_name =
-                schema_.get_vertex_label_name(src_label_i);
-            std::string dst_label_name =
-                schema_.get_vertex_label_name(dst_label_i);
-            std::string e_label_name = schema_.get_edge_label_name(e_label_i);
-            if (schema_.valid_edge_property(src_label_name, dst_label_name,
-                                            e_label_name)) {
-              initEdges(src_label_i, dst_label_i, e_label_i, edge_files);
-            }
-          }
-        });
-      }
-      for (auto& thrd : threads) {
-        thrd.join();
-      }
-      if (!edge_files.empty()) {
-        LOG(INFO) << "finished loading edges";
-      }
+  }
+  parallel_for_each(indexed.size(), thread_num, [&](size_t i) {
+    label_t label = indexed[i].first;
+    int col_id = indexed[i].second;
+    BuildVertexIndex(*vertex_indexes_[label][col_id],
+                     *vertex_data_[label].get_column_by_id(col_id),
+                     vertex_num(label),
+                     [&](vid_t v) { return is_vertex_deleted(label, v); });
+  });
+  if (!indexed.empty()) {
+    LOG(INFO) << "finished building " << indexed.size() << " vertex indexes";
+  }
+}
+
+const VertexIndexBase* MutablePropertyFragment::get_vertex_index(
+    label_t label, int col_id) const {
+  const auto& indexes = vertex_indexes_[label];
+  return static_cast<size_t>(col_id) < indexes.size()
+             ? indexes[col_id].get()
+             : nullptr;
+}
+
+void MutablePropertyFragment::IndexVertex(label_t label, vid_t lid) {
+  auto& indexes = vertex_indexes_[label];
+  for (size_t col_id = 0; col_id < indexes.size(); ++col_id) {
+    if (indexes[col_id] != nullptr) {
+      indexes[col_id]->insert(
+          vertex_data_[label].get_column_by_id(col_id)->get(lid), lid);
     }
   }
 }
 
+void MutablePropertyFragment::IndexVertexField(label_t label, vid_t lid,
+                                               int col_id) {
+  auto& index = vertex_indexes_[label][col_id];
+  if (index != nullptr) {
+    index->insert(vertex_data_[label].get_column_by_id(col_id)->get(lid), lid);
+  }
+}
+
 void MutablePropertyFragment::IngestEdge(label_t src_label, vid_t src_lid,
                                          label_t dst_label, vid_t dst_lid,
                                          label_t edge_label, timestamp_t ts,
@@ -399,31 +800,236 @@ void MutablePropertyFragment::IngestEdge(label_t src_label, vid_t src_lid,
                                          ArenaAllocator& alloc) {
   size_t index = src_label * vertex_label_num_ * edge_label_num_ +
                  dst_label * edge_label_num_ + edge_label;
+  auto& max_ts = edge_max_ts_[index];
+  timestamp_t cur_max_ts = max_ts.load();
+  while (cur_max_ts < ts && !max_ts.compare_exchange_weak(cur_max_ts, ts)) {
+  }
+  if (schema_.has_edge_table(src_label, dst_label, edge_label)) {
+    // the row is written before the edges referring to it are published
+    size_t row = edge_row_nums_[index].fetch_add(1);
+    CHECK_LT(row, schema_.get_max_enum(src_label, dst_label, edge_label))
+        << "too many edges, see max_edge_num";
+    edge_data_[index].ingest(row, arc);
+    Any data;
+    data.set_long(row);
+    ie_[index]->put_generic_edge(dst_lid, src_lid, data, ts, alloc);
+    oe_[index]->put_generic_edge(src_lid, dst_lid, data, ts, alloc);
+    return;
+  }
   ie_[index]->peek_ingest_edge(dst_lid, src_lid, arc, ts, alloc);
   oe_[index]->ingest_edge(src_lid, dst_lid, arc, ts, alloc);
 }
 
+Table* MutablePropertyFragment::get_edge_table(label_t src_label,
+                                               label_t dst_label,
+                                               label_t edge_label) {
+  if (!schema_.has_edge_table(src_label, dst_label, edge_label)) {
+    return nullptr;
+  }
+  size_t index = src_label * vertex_label_num_ * edge_label_num_ +
+                 dst_label * edge_label_num_ + edge_label;
+  return &edge_data_[index];
+}
+
+const Table* MutablePropertyFragment::get_edge_table(
+    label_t src_label, label_t dst_label, label_t edge_label) const {
+  if (!schema_.has_edge_table(src_label, dst_label, edge_label)) {
+    return nullptr;
+  }
+  size_t index = src_label * vertex_label_num_ * edge_label_num_ +
+                 dst_label * edge_label_num_ + edge_label;
+  return &edge_data_[index];
+}
+
+void MutablePropertyFragment::DeleteEdge(label_t src_label, vid_t src_lid,
+                                         label_t dst_label, vid_t dst_lid,
+                                         label_t edge_label) {
+  size_t index = src_label * vertex_label_num_ * edge_label_num_ +
+                 dst_label * edge_label_num_ + edge_label;
+  edges_updated_[index].store(true);
+  if (oe_[index] != NULL) {
+    oe_[index]->delete_edges(src_lid, dst_lid);
+  }
+  if (ie_[index] != NULL) {
+    ie_[index]->delete_edges(dst_lid, src_lid);
+  }
+}
+
+void MutablePropertyFragment::DeleteVertex(label_t label, vid_t lid) {
+  for (label_t nbr_label = 0; nbr_label < vertex_label_num_; ++nbr_label) {
+    for (label_t edge_label = 0; edge_label < edge_label_num_; ++edge_label) {
+      // the reverse entries are deleted through the neighbors first
+      size_t out_index = label * vertex_label_num_ * edge_label_num_ +
+                         nbr_label * edge_label_num_ + edge_label;
+      if (oe_[out_index] != NULL) {
+        edges_updated_[out_index].store(true);
+        for (auto it = oe_[out_index]->edge_iter(lid); it->is_valid();
+             it->next()) {
+          ie_[out_index]->delete_edges(it->get_neighbor(), lid);
+        }
+        oe_[out_index]->delete_edges(lid);
+      }
+      size_t in_index = nbr_label * vertex_label_num_ * edge_label_num_ +
+                        label * edge_label_num_ + edge_label;
+      if (ie_[in_index] != NULL) {
+        edges_updated_[in_index].store(true);
+        for (auto it = ie_[in_index]->edge_iter(lid); it->is_valid();
+             it->next()) {
+          oe_[in_index]->delete_edges(it->get_neighbor(), lid);
+        }
+        ie_[in_index]->delete_edges(lid);
+      }
+    }
+  }
+
+  auto& tombstones = vertex_tombstones_[label];
+  if (lid >= tombstones.size()) {
+    size_t size = std::max<size_t>(lid + 1, tombstones.size() * 2);
+    tombstones.resize_fill(std::max<size_t>(size, vertex_num(label)), 0);
+  }
+  tombstones[lid] = 1;
+}
+
+void MutablePropertyFragment::MarkEdgesUpdated(label_t src_label,
+                                               label_t dst_label,
+                                               label_t edge_label) {
+  size_t index = src_label * vertex_label_num_ * edge_label_num_ +
+                 dst_label * edge_label_num_ + edge_label;
+  edges_updated_[index].store(true);
+}
+
+void MutablePropertyFragment::CompactEdges(int thread_num, size_t& old_bytes,
+                                           size_t& new_bytes) {
+  std::vector<MutableCsrBase*> csrs;
+  for (auto csr : ie_) {
+    if (csr != NULL) {
+      csrs.push_back(csr);
+    }
+  }
+  for (auto csr : oe_) {
+    if (csr != NULL) {
+      csrs.push_back(csr);
+    }
+  }
+  std::atomic<size_t> csr_index(0);
+  std::atomic<size_t> old_bytes_sum(0), new_bytes_sum(0);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < thread_num; ++i) {
+    threads.emplace_back([&]() {
+      while (true) {
+        size_t index = csr_index.fetch_add(1);
+        if (index >= csrs.size()) {
+          break;
+        }
+        old_bytes_sum.fetch_add(csrs[index]->compacted_bytes());
+        new_bytes_sum.fetch_add(csrs[index]->compact());
+      }
+    });
+  }
+  for (auto& thrd : threads) {
+    thrd.join();
+  }
+  old_bytes = old_bytes_sum.load();
+  new_bytes = new_bytes_sum.load();
+}
+
 const Schema& MutablePropertyFragment::schema() const { return schema_; }
 
 void MutablePropertyFragment::Serialize(const std::string& prefix) {
+  std::vector<size_t> vertex_nums;
+  for (size_t i = 0; i < vertex_label_num_; ++i) {
+    vertex_nums.push_back(vertex_num(i));
+  }
+  Serialize(prefix, vertex_nums, std::numeric_limits<timestamp_t>::max());
+}
+
+// Hard link the files of a csr dumped to base_dir as name, i.e. name itself
+// and name.*, into dir. base_files are the sorted file names of base_dir.
+// Returns false, leaving none linked, if there are none or one fails.
+static bool link_snapshot_files(const std::vector<std::string>& base_files,
+                                const std::string& base_dir,
+                                const std::string& dir,
+                                const std::string& name) {
+  std::vector<std::string> linked;
+  bool ok = true;
+  for (auto iter =
+           std::lower_bound(base_files.begin(), base_files.end(), name);
+       iter != base_files.end() && iter->compare(0, name.size(), name) == 0;
+       ++iter) {
+    if (iter->size() != name.size() && (*iter)[name.size()] != '.') {
+      continue;
+    }
+    std::error_code ec;
+    std::filesystem::create_hard_link(base_dir + "/" + *iter,
+                                      dir + "/" + *iter, ec);
+    if (ec) {
+      LOG(WARNING) << "Failed to link " << *iter << " from " << base_dir
+                   << ": " << ec.message();
+      ok = false;
+      break;
+    }
+    linked.push_back(*iter);
+  }
+  if (!ok || linked.empty()) {
+    // csrs write to their files in place, which must not be the base ones
+    for (auto& file : linked) {
+      std::filesystem::remove(dir + "/" + file);
+    }
+    return false;
+  }
+  return true;
+}
+
+void MutablePropertyFragment::Serialize(const std::string& prefix,
+                                        const std::vector<size_t>& vertex_nums,
+                                        timestamp_t ts, int thread_num,
+                                        const std::string& base,
+                                        timestamp_t base_ts) {
   std::string data_dir = prefix + "/data";
   if (!std::filesystem::exists(data_dir)) {
     std::filesystem::create_directory(data_dir);
   }
+  std::string base_data_dir = base + "/data";
+  std::vector<std::string> base_files;
+  if (!base.empty() && std::filesystem::exists(base_data_dir)) {
+    for (const auto& entry :
+         std::filesystem::directory_iterator(base_data_dir)) {
+      base_files.push_back(entry.path().filename().string());
+    }
+    std::sort(base_files.begin(), base_files.end());
+  }
+
+  // Read after ts is taken, the offsets cover all the data visible at ts, and
+  // those of later data are advanced again by replaying its wals.
+  source_offsets_.Serialize(data_dir + "/source_offsets");
+
+  // The meta is written here, while the files are written by the tasks,
+  // each to its own.
+  std::vector<std::function<void()>> tasks;
   auto io_adaptor = std::unique_ptr<grape::LocalIOAdaptor>(
       new grape::LocalIOAdaptor(prefix + "/init_snapshot.bin"));
   io_adaptor->Open("wb");
   schema_.Serialize(io_adaptor);
   for (size_t i = 0; i < vertex_label_num_; ++i) {
-    lf_indexers_[i].Serialize(data_dir + "/indexer_" + std::to_string(i));
+    tasks.emplace_back([this, i, &data_dir, &vertex_nums]() {
+      lf_indexers_[i].Serialize(data_dir + "/indexer_" + std::to_string(i),
+                                vertex_nums[i]);
+      // empty arrays are not dumped, so a file left by an older snapshot has
+      // to be removed
+      std::string tombstones_path =
+          data_dir + "/vertex_tombstones_" + std::to_string(i);
+      std::filesystem::remove(tombstones_path);
+      vertex_tombstones_[i].dump_to_file(tombstones_path, vertex_nums[i]);
+    });
   }
   label_t cur_index = 0;
   for (auto& table : vertex_data_) {
     table.Serialize(io_adaptor,
                     data_dir + "/vtable_" + std::to_string(cur_index),
-                    vertex_num(cur_index));
+                    vertex_nums[cur_index], tasks);
     ++cur_index;
   }
+  size_t linked_num = 0;
   for (size_t src_label_i = 0; src_label_i != vertex_label_num_;
        ++src_label_i) {
     std::string src_label =
@@ -440,51 +1046,64 @@ void MutablePropertyFragment::Serialize(const std::string& prefix) {
         }
         size_t index = src_label_i * vertex_label_num_ * edge_label_num_ +
                        dst_label_i * edge_label_num_ + e_label_i;
-        ie_[index]->Serialize(data_dir + "/ie_" + src_label + "_" + dst_label +
-                              "_" + edge_label);
-        oe_[index]->Serialize(data_dir + "/oe_" + src_label + "_" + dst_label +
-                              "_" + edge_label);
+        if (schema_.has_edge_table(src_label_i, dst_label_i, e_label_i)) {
+          // read before the csrs, so that it covers the rows of the edges
+          // visible at ts
+          size_t row_num = edge_row_nums_[index].load();
+          CHECK(io_adaptor->Write(&row_num, sizeof(size_t)));
+          edge_data_[index].Serialize(io_adaptor,
+                                      data_dir + "/etable_" + src_label + "_" +
+                                          dst_label + "_" + edge_label,
+                                      row_num, tasks);
+        }
+        // the flag is reset first, this snapshot being the base of the next
+        bool unchanged = !edges_updated_[index].exchange(false) &&
+                         !base_files.empty() &&
+                         edge_max_ts_[index].load() <= base_ts;
+        std::string suffix = src_label + "_" + dst_label + "_" + edge_label;
+        for (auto pair : {std::make_pair(ie_[index], "ie_" + suffix),
+                          std::make_pair(oe_[index], "oe_" + suffix)}) {
+          MutableCsrBase* csr = pair.first;
+          std::string name = pair.second;
+          if (unchanged && link_snapshot_files(base_files, base_data_dir,
+                                               data_dir, name)) {
+            ++linked_num;
+            continue;
+          }
+          tasks.emplace_back([csr, name, ts, &data_dir]() {
+            csr->Serialize(data_dir + "/" + name, ts);
+          });
+        }
       }
     }
   }
-
   io_adaptor->Close();
+
+  parallel_for_each(tasks.size(), std::max(thread_num, 1),
+                    [&](size_t i) { tasks[i](); });
+  if (linked_num != 0) {
+    LOG(INFO) << "Linked " << linked_num << " unchanged csrs from " << base;
+  }
 }
 
 inline MutableCsrBase* create_csr(EdgeStrategy es,
-                                  const std::vector<PropertyType>& properties) {
+                                  const std::vector<PropertyType>& properties,
+                                  NbrOrder order, bool is_static) {
   if (properties.empty()) {
-    if (es == EdgeStrategy::kSingle) {
-      return new SingleMutableCsr<grape::EmptyType>();
-    } else if (es == EdgeStrategy::kMultiple) {
-      return new MutableCsr<grape::EmptyType>();
-    } else if (es == EdgeStrategy::kNone) {
-      return new EmptyCsr<grape::EmptyType>();
-    }
+    return create_typed_csr<grape::EmptyType>(es, order, is_static);
+  } else if (properties.size() > 1) {
+    // rows of the edge table
+    return create_typed_csr<int64_t>(es, order, is_static);
   } else if (properties[0] == PropertyType::kInt32) {
-    if (es == EdgeStrategy::kSingle) {
-      return new SingleMutableCsr<int>();
-    } else if (es == EdgeStrategy::kMultiple) {
-      return new MutableCsr<int>();
-    } else if (es == EdgeStrategy::kNone) {
-      return new EmptyCsr<int>();
-    }
+    return create_typed_csr<int>(es, order, is_static);
   } else if (properties[0] == PropertyType::kDate) {
-    if (es == EdgeStrategy::kSingle) {
-      return new SingleMutableCsr<Date>();
-    } else if (es == EdgeStrategy::kMultiple) {
-      return new MutableCsr<Date>();
-    } else if (es == EdgeStrategy::kNone) {
-      return new EmptyCsr<Date>();
-    }
+    return create_typed_csr<Date>(es, order, is_static);
   } else if (properties[0] == PropertyType::kInt64) {
-    if (es == EdgeStrategy::kSingle) {
-      return new SingleMutableCsr<int64_t>();
-    } else if (es == EdgeStrategy::kMultiple) {
-      return new MutableCsr<int64_t>();
-    } else if (es == EdgeStrategy::kNone) {
-      return new EmptyCsr<int64_t>();
-    }
+    return create_typed_csr<int64_t>(es, order, is_static);
+  } else if (properties[0] == PropertyType::kString) {
+    return create_typed_csr<std::string>(es, order, is_static);
+  } else if (properties[0] == PropertyType::kDouble) {
+    return create_typed_csr<double>(es, order, is_static);
   }
   LOG(FATAL) << "not support edge strategy or edge data type";
   return nullptr;
@@ -503,14 +1122,29 @@ void MutablePropertyFragment::Deserialize(const std::string& prefix) {
   vertex_data_.resize(vertex_label_num_);
   ie_.resize(vertex_label_num_ * vertex_label_num_ * edge_label_num_, NULL);
   oe_.resize(vertex_label_num_ * vertex_label_num_ * edge_label_num_, NULL);
-
+  edge_data_.resize(vertex_label_num_ * vertex_label_num_ * edge_label_num_);
+  edge_row_nums_ = std::vector<std::atomic<size_t>>(
+      vertex_label_num_ * vertex_label_num_ * edge_label_num_);
+  edge_max_ts_ = std::vector<std::atomic<timestamp_t>>(
+      vertex_label_num_ * vertex_label_num_ * edge_label_num_);
+  edges_updated_ = std::vector<std::atomic<bool>>(
+      vertex_label_num_ * vertex_label_num_ * edge_label_num_);
+
+  vertex_tombstones_.clear();
+  vertex_tombstones_.resize(vertex_label_num_);
   for (size_t i = 0; i < vertex_label_num_; ++i) {
     lf_indexers_[i].Deserialize(data_dir + "/indexer_" + std::to_string(i));
+    std::string tombstones_path =
+        data_dir + "/vertex_tombstones_" + std::to_string(i);
+    if (std::filesystem::exists(tombstones_path)) {
+      vertex_tombstones_[i].open_for_read(tombstones_path);
+    }
   }
   label_t cur_index = 0;
   for (auto& table : vertex_data_) {
     table.Deserialize(io_adaptor,
-                      data_dir + "/vtable_" + std::to_string(cur_index));
+                      data_dir + "/vtable_" + std::to_string(cur_index),
+                      lf_indexers_[cur_index].size());
     cur_index += 1;
   }
   for (size_t src_label_i = 0; src_label_i != vertex_label_num_;
@@ -535,8 +1169,24 @@ void MutablePropertyFragment::Deserialize(const std::string& prefix) {
             src_label, dst_label, edge_label);
         EdgeStrategy ie_strategy = schema_.get_incoming_edge_strategy(
             src_label, dst_label, edge_label);
-        ie_[index] = create_csr(ie_strategy, properties);
-        oe_[index] = create_csr(oe_strategy, properties);
+        NbrOrder nbr_order =
+            schema_.get_nbr_order(src_label_i, dst_label_i, e_label_i);
+        bool is_static = schema_.is_static_edge(src_label_i, dst_label_i,
+                                                e_label_i);
+        if (schema_.has_edge_table(src_label_i, dst_label_i, e_label_i)) {
+          size_t row_num;
+          CHECK(io_adaptor->Read(&row_num, sizeof(size_t)));
+          edge_row_nums_[index].store(row_num);
+          edge_data_[index].Deserialize(io_adaptor,
+                                        data_dir + "/etable_" + src_label +
+                                            "_" + dst_label + "_" +
+                                            edge_label,
+                                        row_num);
+        }
+        ie_[index] =
+            create_csr(ie_strategy, properties, nbr_order, is_static);
+        oe_[index] =
+            create_csr(oe_strategy, properties, nbr_order, is_static);
         ie_[index]->Deserialize(data_dir + "/ie_" + src_label + "_" +
                                 dst_label + "_" + edge_label);
         oe_[index]->Deserialize(data_dir + "/oe_" + src_label + "_" +
@@ -544,6 +1194,8 @@ void MutablePropertyFragment::Deserialize(const std::string& prefix) {
       }
     }
   }
+  source_offsets_.Deserialize(data_dir + "/source_offsets");
+  buildVertexIndexes(std::thread::hardware_concurrency());
 }
 
 Table& MutablePropertyFragment::get_vertex_table(label_t vertex_label) {
@@ -555,13 +1207,43 @@ const Table& MutablePropertyFragment::get_vertex_table(
   return vertex_data_[vertex_label];
 }
 
+void MutablePropertyFragment::AddVertexProperty(
+    label_t label, const std::string& name,
+    std::shared_ptr<ColumnBase> column) {
+  auto types = schema_.get_vertex_properties(label);
+  auto strategies = schema_.get_vertex_storage_strategies(
+      schema_.get_vertex_label_name(label));
+  strategies.resize(types.size(), StorageStrategy::kMem);
+  types.push_back(column->type());
+  strategies.push_back(column->storage_strategy());
+  schema_.set_vertex_properties(label, types, strategies);
+  vertex_data_[label].add_column(name, std::move(column));
+  vertex_indexes_[label].resize(types.size());
+}
+
 vid_t MutablePropertyFragment::vertex_num(label_t vertex_label) const {
   return static_cast<vid_t>(lf_indexers_[vertex_label].size());
 }
 
 bool MutablePropertyFragment::get_lid(label_t label, oid_t oid,
                                       vid_t& lid) const {
-  return lf_indexers_[label].get_index(oid, lid);
+  return lf_indexers_[label].get_index(oid, lid) &&
+         !is_vertex_deleted(label, lid);
+}
+
+size_t MutablePropertyFragment::get_lids(label_t label, const oid_t* oids,
+                                         size_t num, vid_t* lids) const {
+  size_t found = lf_indexers_[label].get_index(oids, num, lids);
+  if (vertex_tombstones_[label].size() != 0) {
+    for (size_t i = 0; i < num; ++i) {
+      if (lids[i] != std::numeric_limits<vid_t>::max() &&
+          is_vertex_deleted(label, lids[i])) {
+        lids[i] = std::numeric_limits<vid_t>::max();
+        --found;
+      }
+    }
+  }
+  return found;
 }
 
 oid_t MutablePropertyFragment::get_oid(label_t label, vid_t lid) const {
@@ -569,6 +1251,13 @@ oid_t MutablePropertyFragment::get_oid(label_t label, vid_t lid) const {
 }
 
 vid_t MutablePropertyFragment::add_vertex(label_t label, oid_t id) {
+  auto& tombstones = vertex_tombstones_[label];
+  vid_t lid;
+  if (tombstones.size() != 0 && lf_indexers_[label].get_index(id, lid) &&
+      is_vertex_deleted(label, lid)) {
+    tombstones[lid] = 0;
+    return lid;
+  }
   return lf_indexers_[label].insert(id);
 }
 
@@ -610,6 +1299,7 @@ MutablePropertyFragment::get_outgoing_edges_mut(label_t label, vid_t u,
                                                 label_t edge_label) {
   size_t index = label * vertex_label_num_ * edge_label_num_ +
                  neighbor_label * edge_label_num_ + edge_label;
+  edges_updated_[index].store(true);
   return oe_[index]->edge_iter_mut(u);
 }
 
@@ -619,6 +1309,7 @@ MutablePropertyFragment::get_incoming_edges_mut(label_t label, vid_t u,
                                                 label_t edge_label) {
   size_t index = neighbor_label * vertex_label_num_ * edge_label_num_ +
                  label * edge_label_num_ + edge_label;
+  edges_updated_[index].store(true);
   return ie_[index]->edge_iter_mut(u);
 }
 
@@ -654,55 +1345,363 @@ const MutableCsrBase* MutablePropertyFragment::get_ie_csr(
 
 void MutablePropertyFragment::parseVertexFiles(
     const std::string& vertex_label, const std::vector<std::string>& filenames,
-    IdIndexer<oid_t, vid_t>& indexer) {
-  if (filenames.empty()) {
-    return;
-  }
-
+    int thread_num) {
   size_t label_index = schema_.get_vertex_label_id(vertex_label);
   auto& table = vertex_data_[label_index];
   auto& property_types = schema_.get_vertex_properties(vertex_label);
   size_t col_num = property_types.size();
-  std::vector<Any> properties(col_num);
-  for (size_t col_i = 0; col_i != col_num; ++col_i) {
-    properties[col_i].type = property_types[col_i];
+
+  std::string header_line;
+  if (read_header(filenames, header_line)) {
+    std::vector<Any> header(col_num + 1);
+    for (auto& item : header) {
+      item.type = PropertyType::kString;
+    }
+    ParseRecord(header_line.c_str(), header);
+    std::vector<std::string> col_names(col_num);
+    for (size_t i = 0; i < col_num; ++i) {
+      col_names[i] = std::string(header[i + 1].value.s.data(),
+                                 header[i + 1].value.s.size());
+    }
+    table.reset_header(col_names);
   }
 
-  char line_buf[4096];
-  oid_t oid;
-  vid_t v_index;
-  bool first_file = true;
-  std::vector<Any> header(col_num + 1);
-  for (auto& item : header) {
-    item.type = PropertyType::kString;
+  // Ids are parsed by chunks, and deduplicated by shards of their hash values.
+  // Vids are then given in the order of the files, and properties are parsed
+  // by chunks again, so that only the ids are kept in memory.
+  auto chunks = split_files(filenames, thread_num);
+  size_t shard_num = thread_num;
+  GHash<oid_t> hasher;
+  std::vector<std::vector<oid_t>> chunk_oids(chunks.size());
+  std::vector<std::vector<vid_t>> chunk_vids(chunks.size());
+  std::vector<std::vector<std::vector<vid_t>>> shard_rows(chunks.size());
+  parallel_for_each(chunks.size(), thread_num, [&](size_t chunk_i) {
+    auto& oids = chunk_oids[chunk_i];
+    auto& rows = shard_rows[chunk_i];
+    rows.resize(shard_num);
+    std::vector<Any> empty;
+    oid_t oid;
+    foreach_line(chunks[chunk_i], [&](const char* line) {
+      ParseRecord(line, oid, empty);
+      rows[(hasher(oid) >> 32) % shard_num].push_back(oids.size());
+      oids.push_back(oid);
+    });
+    chunk_vids[chunk_i].resize(oids.size(), 0);
+  });
+
+  static constexpr vid_t duplicated = std::numeric_limits<vid_t>::max();
+  parallel_for_each(shard_num, thread_num, [&](size_t shard_i) {
+    IdIndexer<oid_t, vid_t> indexer;
+    vid_t lid;
+    for (size_t chunk_i = 0; chunk_i < chunks.size(); ++chunk_i) {
+      for (auto row : shard_rows[chunk_i][shard_i]) {
+        if (!indexer.add(chunk_oids[chunk_i][row], lid)) {
+          chunk_vids[chunk_i][row] = duplicated;
+        }
+      }
+    }
+  });
+  std::vector<std::vector<std::vector<vid_t>>>().swap(shard_rows);
+
+  std::vector<size_t> chunk_offsets(chunks.size() + 1, 0);
+  parallel_for_each(chunks.size(), thread_num, [&](size_t chunk_i) {
+    auto& vids = chunk_vids[chunk_i];
+    chunk_offsets[chunk_i + 1] =
+        vids.size() - std::count(vids.begin(), vids.end(), duplicated);
+  });
+  for (size_t chunk_i = 0; chunk_i < chunks.size(); ++chunk_i) {
+    chunk_offsets[chunk_i + 1] += chunk_offsets[chunk_i];
   }
-  for (auto filename : filenames) {
-    FILE* fin = fopen(filename.c_str(), "r");
-    if (fgets(line_buf, 4096, fin) == NULL) {
-      continue;
+  std::vector<oid_t> keys(chunk_offsets.back());
+  parallel_for_each(chunks.size(), thread_num, [&](size_t chunk_i) {
+    auto& oids = chunk_oids[chunk_i];
+    auto& vids = chunk_vids[chunk_i];
+    vid_t vid = chunk_offsets[chunk_i];
+    for (size_t row = 0; row < vids.size(); ++row) {
+      if (vids[row] != duplicated) {
+        keys[vid] = oids[row];
+        vids[row] = vid++;
+      }
     }
-    preprocess_line(line_buf);
-    if (first_file) {
-      ParseRecord(line_buf, header);
-      std::vector<std::string> col_names(col_num);
-      for (size_t i = 0; i < col_num; ++i) {
-        col_names[i] = std::string(header[i + 1].value.s.data(),
-                                   header[i + 1].value.s.size());
+    std::vector<oid_t>().swap(oids);
+  });
+  build_lf_indexer(keys, lf_indexers_[label_index],
+                   schema_.get_max_vnum(vertex_label), thread_num);
+  std::vector<oid_t>().swap(keys);
+
+  parallel_for_each(chunks.size(), thread_num, [&](size_t chunk_i) {
+    std::vector<Any> properties(col_num);
+    for (size_t col_i = 0; col_i != col_num; ++col_i) {
+      properties[col_i].type = property_types[col_i];
+    }
+    auto& vids = chunk_vids[chunk_i];
+    size_t row = 0;
+    oid_t oid;
+    foreach_line(chunks[chunk_i], [&](const char* line) {
+      if (vids[row] != duplicated) {
+        ParseRecord(line, oid, properties);
+        table.insert(vids[row], properties);
       }
-      table.reset_header(col_names);
-      first_file = false;
+      ++row;
+    });
+  });
+}
+
+void MutablePropertyFragment::Append(
+    const std::vector<std::pair<std::string, std::string>>& vertex_files,
+    const std::vector<std::tuple<std::string, std::string, std::string,
+                                 std::string>>& edge_files,
+    int thread_num, uint32_t partition_id, uint32_t partition_num) {
+  CHECK_LT(partition_id, partition_num);
+  partition_id_ = partition_id;
+  partition_num_ = partition_num;
+  std::vector<vid_t> old_vnums(vertex_label_num_);
+  for (size_t v_label_i = 0; v_label_i != vertex_label_num_; ++v_label_i) {
+    old_vnums[v_label_i] = lf_indexers_[v_label_i].size();
+    std::string v_label_name = schema_.get_vertex_label_name(v_label_i);
+    std::vector<std::string> filenames;
+    for (auto& pair : vertex_files) {
+      if (pair.first == v_label_name) {
+        filenames.push_back(pair.second);
+      }
+    }
+    if (!filenames.empty()) {
+      appendVertexFiles(v_label_i, filenames, thread_num);
     }
+  }
+  if (!vertex_files.empty()) {
+    LOG(INFO) << "finished appending vertices";
+  }
 
-    while (fgets(line_buf, 4096, fin) != NULL) {
-      preprocess_line(line_buf);
-      ParseRecord(line_buf, oid, properties);
-      if (indexer.add(oid, v_index)) {
-        table.insert(v_index, properties);
+  for (size_t src_label_i = 0; src_label_i != vertex_label_num_;
+       ++src_label_i) {
+    std::string src_label_name = schema_.get_vertex_label_name(src_label_i);
+    for (size_t dst_label_i = 0; dst_label_i != vertex_label_num_;
+         ++dst_label_i) {
+      std::string dst_label_name = schema_.get_vertex_label_name(dst_label_i);
+      for (size_t e_label_i = 0; e_label_i != edge_label_num_; ++e_label_i) {
+        std::string e_label_name = schema_.get_edge_label_name(e_label_i);
+        if (schema_.exist(src_label_name, dst_label_name, e_label_name)) {
+          appendEdges(src_label_i, dst_label_i, e_label_i, edge_files,
+                      old_vnums, thread_num);
+        }
       }
     }
+  }
+  if (!edge_files.empty()) {
+    LOG(INFO) << "finished appending edges";
+  }
+  buildVertexIndexes(thread_num);
+}
 
-    fclose(fin);
+void MutablePropertyFragment::appendVertexFiles(
+    label_t label, const std::vector<std::string>& filenames,
+    int thread_num) {
+  auto& table = vertex_data_[label];
+  auto& indexer = lf_indexers_[label];
+  auto& tombstones = vertex_tombstones_[label];
+  const auto& property_types = schema_.get_vertex_properties(label);
+  size_t col_num = property_types.size();
+
+  // Ids of several lines are deduplicated by shards as in parseVertexFiles,
+  // the first line of an id wins. Ids already indexed keep their vids, with
+  // their properties overwritten and deleted vertices revived, and new ids
+  // are inserted into the indexer by all threads.
+  auto chunks = split_files(filenames, thread_num);
+  size_t shard_num = thread_num;
+  GHash<oid_t> hasher;
+  std::vector<std::vector<oid_t>> chunk_oids(chunks.size());
+  std::vector<std::vector<vid_t>> chunk_vids(chunks.size());
+  std::vector<std::vector<std::vector<vid_t>>> shard_rows(chunks.size());
+  parallel_for_each(chunks.size(), thread_num, [&](size_t chunk_i) {
+    auto& oids = chunk_oids[chunk_i];
+    auto& rows = shard_rows[chunk_i];
+    rows.resize(shard_num);
+    std::vector<Any> empty;
+    oid_t oid;
+    foreach_line(chunks[chunk_i], [&](const char* line) {
+      ParseRecord(line, oid, empty);
+      rows[(hasher(oid) >> 32) % shard_num].push_back(oids.size());
+      oids.push_back(oid);
+    });
+    chunk_vids[chunk_i].resize(oids.size(), 0);
+  });
+
+  static constexpr vid_t duplicated = std::numeric_limits<vid_t>::max();
+  parallel_for_each(shard_num, thread_num, [&](size_t shard_i) {
+    IdIndexer<oid_t, vid_t> ids;
+    vid_t lid;
+    for (size_t chunk_i = 0; chunk_i < chunks.size(); ++chunk_i) {
+      for (auto row : shard_rows[chunk_i][shard_i]) {
+        if (!ids.add(chunk_oids[chunk_i][row], lid)) {
+          chunk_vids[chunk_i][row] = duplicated;
+        }
+      }
+    }
+  });
+  std::vector<std::vector<std::vector<vid_t>>>().swap(shard_rows);
+
+  parallel_for_each(chunks.size(), thread_num, [&](size_t chunk_i) {
+    auto& oids = chunk_oids[chunk_i];
+    auto& vids = chunk_vids[chunk_i];
+    for (size_t row = 0; row < vids.size(); ++row) {
+      if (vids[row] == duplicated) {
+        continue;
+      }
+      vid_t lid;
+      if (indexer.get_index(oids[row], lid)) {
+        if (lid < tombstones.size()) {
+          tombstones[lid] = 0;
+        }
+      } else {
+        lid = indexer.insert(oids[row]);
+      }
+      vids[row] = lid;
+    }
+    std::vector<oid_t>().swap(oids);
+  });
+
+  parallel_for_each(chunks.size(), thread_num, [&](size_t chunk_i) {
+    std::vector<Any> properties(col_num);
+    for (size_t col_i = 0; col_i != col_num; ++col_i) {
+      properties[col_i].type = property_types[col_i];
+    }
+    auto& vids = chunk_vids[chunk_i];
+    size_t row = 0;
+    oid_t oid;
+    foreach_line(chunks[chunk_i], [&](const char* line) {
+      if (vids[row] != duplicated) {
+        ParseRecord(line, oid, properties);
+        table.insert(vids[row], properties);
+      }
+      ++row;
+    });
+  });
+}
+
+// Edges of files and of the old csrs are put into new csrs of the same kind,
+// lists are thus sized once by their final degrees. Edges of the old csrs
+// keep their timestamps, the appended ones are visible to all.
+template <typename EDATA_T, typename PARSE_T>
+std::pair<MutableCsrBase*, MutableCsrBase*> append_csr(
+    const MutableCsrBase* old_ie, const MutableCsrBase* old_oe,
+    EdgeStrategy ie_strategy, EdgeStrategy oe_strategy, NbrOrder order,
+    bool is_static, const LFIndexer<vid_t>& src_indexer,
+    const LFIndexer<vid_t>& dst_indexer, vid_t old_src_num,
+    vid_t old_dst_num, int thread_num, const PartitionOwns& owns,
+    const PARSE_T& parse) {
+  const auto* typed_old_ie =
+      dynamic_cast<const TypedMutableCsrBase<EDATA_T>*>(old_ie);
+  const auto* typed_old_oe =
+      dynamic_cast<const TypedMutableCsrBase<EDATA_T>*>(old_oe);
+  CHECK(typed_old_ie != nullptr && typed_old_oe != nullptr);
+  TypedMutableCsrBase<EDATA_T>* ie_csr =
+      create_typed_csr<EDATA_T>(ie_strategy, order, is_static);
+  TypedMutableCsrBase<EDATA_T>* oe_csr =
+      create_typed_csr<EDATA_T>(oe_strategy, order, is_static);
+
+  std::vector<int> odegree(src_indexer.size(), 0);
+  std::vector<int> idegree(dst_indexer.size(), 0);
+  auto parsed_edges = parse(idegree, odegree);
+  add_csr_degrees(typed_old_ie, old_dst_num, thread_num, idegree);
+  add_csr_degrees(typed_old_oe, old_src_num, thread_num, odegree);
+  fill_csrs(parsed_edges, idegree, odegree, ie_csr, oe_csr, src_indexer,
+            dst_indexer, thread_num, owns, typed_old_ie, typed_old_oe,
+            old_src_num, old_dst_num);
+  return std::make_pair(ie_csr, oe_csr);
+}
+
+void MutablePropertyFragment::appendEdges(
+    label_t src_label_i, label_t dst_label_i, label_t edge_label_i,
+    const std::vector<std::tuple<std::string, std::string, std::string,
+                                 std::string>>& edge_files,
+    const std::vector<vid_t>& old_vnums, int thread_num) {
+  std::string src_label_name = schema_.get_vertex_label_name(src_label_i);
+  std::string dst_label_name = schema_.get_vertex_label_name(dst_label_i);
+  std::string edge_label_name = schema_.get_edge_label_name(edge_label_i);
+  std::vector<std::string> filenames;
+  for (auto& tuple : edge_files) {
+    if (std::get<0>(tuple) == src_label_name &&
+        std::get<1>(tuple) == dst_label_name &&
+        std::get<2>(tuple) == edge_label_name) {
+      filenames.push_back(std::get<3>(tuple));
+    }
+  }
+  size_t index = src_label_i * vertex_label_num_ * edge_label_num_ +
+                 dst_label_i * edge_label_num_ + edge_label_i;
+  if (filenames.empty() &&
+      lf_indexers_[src_label_i].size() == old_vnums[src_label_i] &&
+      lf_indexers_[dst_label_i].size() == old_vnums[dst_label_i]) {
+    return;
+  }
+  edges_updated_[index].store(true);
+  // csrs are rebuilt for new vertices as well, the lists of csrs are only
+  // allocated for the vertices they were built with
+  const auto& property_types =
+      schema_.get_edge_properties(src_label_i, dst_label_i, edge_label_i);
+  EdgeStrategy oe_strategy = schema_.get_outgoing_edge_strategy(
+      src_label_name, dst_label_name, edge_label_name);
+  EdgeStrategy ie_strategy = schema_.get_incoming_edge_strategy(
+      src_label_name, dst_label_name, edge_label_name);
+  NbrOrder nbr_order =
+      schema_.get_nbr_order(src_label_i, dst_label_i, edge_label_i);
+  bool is_static =
+      schema_.is_static_edge(src_label_i, dst_label_i, edge_label_i);
+  const auto& src_indexer = lf_indexers_[src_label_i];
+  const auto& dst_indexer = lf_indexers_[dst_label_i];
+  PartitionOwns owns{partition_id_, partition_num_};
+
+  std::pair<MutableCsrBase*, MutableCsrBase*> csrs;
+  auto append = [&](auto tag) {
+    using EDATA_T = decltype(tag);
+    return append_csr<EDATA_T>(
+        ie_[index], oe_[index], ie_strategy, oe_strategy, nbr_order,
+        is_static, src_indexer, dst_indexer, old_vnums[src_label_i],
+        old_vnums[dst_label_i], thread_num, owns,
+        [&](std::vector<int>& idegree, std::vector<int>& odegree) {
+          return parse_edges<EDATA_T>(filenames, src_indexer, dst_indexer,
+                                      thread_num, owns, idegree, odegree);
+        });
+  };
+  if (property_types.size() > 1) {
+    size_t max_enum =
+        schema_.get_max_enum(src_label_i, dst_label_i, edge_label_i);
+    csrs = append_csr<int64_t>(
+        ie_[index], oe_[index], ie_strategy, oe_strategy, nbr_order,
+        is_static, src_indexer, dst_indexer, old_vnums[src_label_i],
+        old_vnums[dst_label_i], thread_num, owns,
+        [&](std::vector<int>& idegree, std::vector<int>& odegree) {
+          return parse_table_edges(filenames, property_types, src_indexer,
+                                   dst_indexer, edge_data_[index],
+                                   edge_row_nums_[index], max_enum,
+                                   thread_num, owns, idegree, odegree);
+        });
+  } else if (property_types.empty()) {
+    csrs = append(grape::EmptyType());
+  } else if (property_types[0] == PropertyType::kDate) {
+    csrs = append(Date());
+  } else if (property_types[0] == PropertyType::kInt32) {
+    csrs = append(int());
+  } else if (property_types[0] == PropertyType::kInt64) {
+    csrs = append(int64_t());
+  } else if (property_types[0] == PropertyType::kDouble) {
+    csrs = append(double());
+  } else if (property_types[0] == PropertyType::kString &&
+             filenames.empty()) {
+    csrs = append_csr<std::string>(
+        ie_[index], oe_[index], ie_strategy, oe_strategy, nbr_order,
+        is_static, src_indexer, dst_indexer, old_vnums[src_label_i],
+        old_vnums[dst_label_i], thread_num, owns,
+        [&](std::vector<int>&, std::vector<int>&) {
+          return std::vector<
+              std::vector<std::tuple<vid_t, vid_t, std::string>>>();
+        });
+  } else {
+    LOG(FATAL) << "Unsupported edge property type.";
   }
+  delete ie_[index];
+  delete oe_[index];
+  std::tie(ie_[index], oe_[index]) = csrs;
 }
 
 }  // namespace gs
@@ -23,7 +23,10 @@
 #include "flex/storages/rt_mutable_graph/schema.h"
 
 #include "flex/storages/rt_mutable_graph/mutable_csr.h"
+#include "flex/storages/rt_mutable_graph/property_history.h"
+#include "flex/storages/rt_mutable_graph/source_offsets.h"
 #include "flex/storages/rt_mutable_graph/types.h"
+#include "flex/storages/rt_mutable_graph/vertex_index.h"
 #include "flex/utils/id_indexer.h"
 #include "flex/utils/property/table.h"
 #include "grape/io/local_io_adaptor.h"
@@ -37,31 +40,175 @@ class MutablePropertyFragment {
 
   ~MutablePropertyFragment();
 
+  /**
+   * @brief Bulk load the graph from files. With reorder_vertices, the
+   * vertices of each label get vids by descending degrees instead of in the
+   * order of the files, see reorderVertices.
+   */
   void Init(
       const Schema& schema,
       const std::vector<std::pair<std::string, std::string>>& vertex_files,
       const std::vector<std::tuple<std::string, std::string, std::string,
                                    std::string>>& edge_files,
-      int thread_num = 1);
+      int thread_num = 1, uint32_t partition_id = 0,
+      uint32_t partition_num = 1, bool reorder_vertices = false);
+
+  /**
+   * @brief Append the vertices and edges of files to a graph already loaded,
+   * e.g. from a snapshot, parsing them with thread_num threads. Vertices of
+   * new ids get new vids, those of ids already present have their
+   * properties overwritten, and deleted ones are revived. Each csr with
+   * edges appended, or with new vertices, is rebuilt in one pass, with lists
+   * sized by their final degrees. Edges appended are visible to all
+   * transactions. No other thread may access the graph meanwhile.
+   */
+  void Append(
+      const std::vector<std::pair<std::string, std::string>>& vertex_files,
+      const std::vector<std::tuple<std::string, std::string, std::string,
+                                   std::string>>& edge_files,
+      int thread_num = 1, uint32_t partition_id = 0,
+      uint32_t partition_num = 1);
+
+  /**
+   * @brief Partition of the vertex of id oid among partition_num graphs
+   * bulk loaded from the same files, see Init.
+   *
+   * With partition_num > 1, Init loads all vertices and their properties, but
+   * only the outgoing edges of the vertices in partition_id and the incoming
+   * edges of those. Vertices of other partitions are kept as replicas, and
+   * each graph holds about 1 / partition_num of the edges, which usually
+   * dominate the memory. Expanding vertices of other partitions must be
+   * served by their graphs.
+   */
+  static uint32_t get_partition(oid_t oid, uint32_t partition_num) {
+    uint64_t x = static_cast<uint64_t>(oid);
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdull;
+    x ^= x >> 33;
+    return x % partition_num;
+  }
+
+  uint32_t partition_id() const { return partition_id_; }
+
+  uint32_t partition_num() const { return partition_num_; }
 
   void IngestEdge(label_t src_label, vid_t src_lid, label_t dst_label,
                   vid_t dst_lid, label_t edge_label, timestamp_t ts,
                   grape::OutArchive& arc, ArenaAllocator& alloc);
 
+  /**
+   * @brief Delete the edges from src_lid to dst_lid in both directions, see
+   * MutableCsrBase::delete_edges. No other thread may access the graph
+   * meanwhile.
+   */
+  void DeleteEdge(label_t src_label, vid_t src_lid, label_t dst_label,
+                  vid_t dst_lid, label_t edge_label);
+
+  /**
+   * @brief Delete a vertex with all its edges. The slot of the vertex is kept
+   * as a tombstone: get_lid does not find it anymore, and add_vertex reuses
+   * it when the oid is added again. No other thread may access the graph
+   * meanwhile.
+   */
+  void DeleteVertex(label_t label, vid_t lid);
+
+  /**
+   * @brief Record that edges of a triplet were changed other than by
+   * IngestEdge, e.g. updated in place, so that the next Serialize writes its
+   * csrs instead of linking them from the snapshot it is based on.
+   */
+  void MarkEdgesUpdated(label_t src_label, label_t dst_label,
+                        label_t edge_label);
+
+  /** @brief Old values of properties and edge data overwritten in place. */
+  PropertyHistory& history() { return history_; }
+
+  const PropertyHistory& history() const { return history_; }
+
+  /** @brief Offsets of the external log applied, kept by snapshots. */
+  SourceOffsets& source_offsets() { return source_offsets_; }
+
+  const SourceOffsets& source_offsets() const { return source_offsets_; }
+
+  bool is_vertex_deleted(label_t label, vid_t lid) const {
+    const auto& tombstones = vertex_tombstones_[label];
+    return lid < tombstones.size() && tombstones[lid] != 0;
+  }
+
   const Schema& schema() const;
 
   void Serialize(const std::string& prefix);
 
+  /**
+   * @brief Serialize a consistent snapshot while sessions keep inserting:
+   * the first vertex_nums[label] vertices of each label and the edges
+   * visible at timestamp ts. Indexers, columns and csrs are written to
+   * separate files by thread_num threads.
+   *
+   * @param base Prefix of a snapshot written at base_ts by the previous
+   * Serialize or loaded by Deserialize, empty if none. The csrs of triplets
+   * without edges ingested after base_ts, nor changed since, are hard linked
+   * from it instead of being written again.
+   */
+  void Serialize(const std::string& prefix,
+                 const std::vector<size_t>& vertex_nums, timestamp_t ts,
+                 int thread_num = 1, const std::string& base = "",
+                 timestamp_t base_ts = 0);
+
   void Deserialize(const std::string& prefix);
 
+  /**
+   * @brief Compact the adjacency lists of all csrs, see
+   * MutableCsrBase::compact.
+   *
+   * @param old_bytes Bytes held by the buffers of the previous compaction.
+   * @param new_bytes Bytes held by the buffers of this compaction.
+   */
+  void CompactEdges(int thread_num, size_t& old_bytes, size_t& new_bytes);
+
   Table& get_vertex_table(label_t vertex_label);
 
+  /**
+   * @brief Append a property named name to the vertices of label, stored in
+   * column, whose rows of the vertices in the graph must be set already.
+   * Nothing may access the vertices of label meanwhile.
+   */
+  void AddVertexProperty(label_t label, const std::string& name,
+                         std::shared_ptr<ColumnBase> column);
+
   const Table& get_vertex_table(label_t vertex_label) const;
 
+  /** @brief Bytes of the indexer of the oids of a label, see MemoryUsage. */
+  size_t indexer_memory_usage(label_t label) const {
+    return lf_indexers_[label].memory_usage();
+  }
+
+  /**
+   * @brief Secondary index of a vertex property declared in the schema,
+   * nullptr if there is none. Indexes are built when the fragment is loaded
+   * and kept up to date by IndexVertex and IndexVertexField.
+   */
+  const VertexIndexBase* get_vertex_index(label_t label, int col_id) const;
+
+  /** @brief Index the properties of a vertex once its row is written. */
+  void IndexVertex(label_t label, vid_t lid);
+
+  /** @brief Index a vertex property once it is overwritten. */
+  void IndexVertexField(label_t label, vid_t lid, int col_id);
+
   vid_t vertex_num(label_t vertex_label) const;
 
   bool get_lid(label_t label, oid_t oid, vid_t& lid) const;
 
+  /**
+   * @brief Get the lids of num oids of a label at once, a missing oid gets
+   * std::numeric_limits<vid_t>::max().
+   *
+   * @return The number of oids found.
+   */
+  size_t get_lids(label_t label, const oid_t* oids, size_t num,
+                  vid_t* lids) const;
+
   oid_t get_oid(label_t label, vid_t lid) const;
 
   vid_t add_vertex(label_t label, oid_t id);
@@ -85,6 +232,53 @@ class MutablePropertyFragment {
                                                       label_t neighbor_label,
                                                       label_t edge_label) const;
 
+  /**
+   * @brief Typed slice of the outgoing edges of u, read straight from the csr
+   * without allocations or virtual calls per edge. EDATA_T must be the data
+   * type of the edge label. Timestamps are not filtered, and edges of static
+   * edge types can only be read by edge iterators.
+   */
+  template <typename EDATA_T>
+  MutableNbrSlice<EDATA_T> get_oe_slice(label_t label, vid_t u,
+                                        label_t neighbor_label,
+                                        label_t edge_label) const {
+    return get_slice<EDATA_T>(get_oe_csr(label, neighbor_label, edge_label),
+                              u);
+  }
+
+  /** @brief Typed slice of the incoming edges of u, see get_oe_slice. */
+  template <typename EDATA_T>
+  MutableNbrSlice<EDATA_T> get_ie_slice(label_t label, vid_t u,
+                                        label_t neighbor_label,
+                                        label_t edge_label) const {
+    return get_slice<EDATA_T>(get_ie_csr(label, neighbor_label, edge_label),
+                              u);
+  }
+
+  /**
+   * @brief Outgoing edges of u whose time is in [begin, end), as the part of
+   * the time-ordered prefix of its list holding them and the tail, which is
+   * not filtered, see MutableCsr::get_time_range_edges. EDATA_T must be the
+   * data type of the edge label. Lists of edge types not time ordered, see
+   * Schema::is_time_ordered, are returned whole as the tail.
+   */
+  template <typename EDATA_T>
+  std::pair<MutableNbrSlice<EDATA_T>, MutableNbrSlice<EDATA_T>>
+  get_oe_time_range(label_t label, vid_t u, label_t neighbor_label,
+                    label_t edge_label, int64_t begin, int64_t end) const {
+    return get_time_range<EDATA_T>(
+        get_oe_csr(label, neighbor_label, edge_label), u, begin, end);
+  }
+
+  /** @brief Incoming edges of u of a time range, see get_oe_time_range. */
+  template <typename EDATA_T>
+  std::pair<MutableNbrSlice<EDATA_T>, MutableNbrSlice<EDATA_T>>
+  get_ie_time_range(label_t label, vid_t u, label_t neighbor_label,
+                    label_t edge_label, int64_t begin, int64_t end) const {
+    return get_time_range<EDATA_T>(
+        get_ie_csr(label, neighbor_label, edge_label), u, begin, end);
+  }
+
   MutableCsrBase* get_oe_csr(label_t label, label_t neighbor_label,
                              label_t edge_label);
 
@@ -97,25 +291,95 @@ class MutablePropertyFragment {
   const MutableCsrBase* get_ie_csr(label_t label, label_t neighbor_label,
                                    label_t edge_label) const;
 
+  /**
+   * @brief Table of the properties of an edge type with several, nullptr for
+   * other edge types. The data of its edges in both csrs are int64 rows of
+   * the table, see Schema::has_edge_table, so expansions not reading the
+   * properties only scan the neighbors, and properties are read by column.
+   */
+  Table* get_edge_table(label_t src_label, label_t dst_label,
+                        label_t edge_label);
+
+  const Table* get_edge_table(label_t src_label, label_t dst_label,
+                              label_t edge_label) const;
+
+  template <typename EDATA_T>
+  static MutableNbrSlice<EDATA_T> get_slice(const MutableCsrBase* csr,
+                                            vid_t u) {
+    if (csr == nullptr) {
+      return MutableNbrSlice<EDATA_T>::empty();
+    }
+    DCHECK(dynamic_cast<const TypedMutableCsrBase<EDATA_T>*>(csr) != nullptr);
+    return static_cast<const TypedMutableCsrBase<EDATA_T>*>(csr)->get_edges(u);
+  }
+
+  template <typename EDATA_T>
+  static std::pair<MutableNbrSlice<EDATA_T>, MutableNbrSlice<EDATA_T>>
+  get_time_range(const MutableCsrBase* csr, vid_t u, int64_t begin,
+                 int64_t end) {
+    // time-ordered edge types are kept in MutableCsr
+    auto typed = dynamic_cast<const MutableCsr<EDATA_T>*>(csr);
+    if (typed != nullptr) {
+      return typed->get_time_range_edges(u, begin, end);
+    }
+    return std::make_pair(MutableNbrSlice<EDATA_T>::empty(),
+                          get_slice<EDATA_T>(csr, u));
+  }
+
   void parseVertexFiles(const std::string& vertex_label,
                         const std::vector<std::string>& filenames,
-                        IdIndexer<oid_t, vid_t>& indexer);
+                        int thread_num);
 
   void initVertices(
       label_t v_label_i,
-      const std::vector<std::pair<std::string, std::string>>& vertex_files);
+      const std::vector<std::pair<std::string, std::string>>& vertex_files,
+      int thread_num);
 
   void initEdges(
       label_t src_label_i, label_t dst_label_i, label_t edge_label_i,
       const std::vector<std::tuple<std::string, std::string, std::string,
-                                   std::string>>& edge_files);
+                                   std::string>>& edge_files,
+      int thread_num);
+
+  void reorderVertices(
+      const std::vector<std::tuple<std::string, std::string, std::string,
+                                   std::string>>& edge_files,
+      int thread_num);
+
+  void appendVertexFiles(label_t label,
+                         const std::vector<std::string>& filenames,
+                         int thread_num);
+
+  void appendEdges(
+      label_t src_label_i, label_t dst_label_i, label_t edge_label_i,
+      const std::vector<std::tuple<std::string, std::string, std::string,
+                                   std::string>>& edge_files,
+      const std::vector<vid_t>& old_vnums, int thread_num);
+
+  void buildVertexIndexes(int thread_num);
 
   Schema schema_;
   std::vector<LFIndexer<vid_t>> lf_indexers_;
+  // nonzero for deleted vertices, empty for labels without deletions
+  std::vector<mmap_array<uint8_t>> vertex_tombstones_;
   std::vector<MutableCsrBase*> ie_, oe_;
   std::vector<Table> vertex_data_;
+  // by label and property, nullptr for properties not indexed
+  std::vector<std::vector<std::unique_ptr<VertexIndexBase>>> vertex_indexes_;
+  // by the index of the triplet like ie_ and oe_, empty for edge types
+  // without an edge table, and the number of rows used of each
+  std::vector<Table> edge_data_;
+  std::vector<std::atomic<size_t>> edge_row_nums_;
+  // by the index of the triplet, the latest timestamp of the edges ingested
+  // and whether edges were changed otherwise since the last Serialize
+  std::vector<std::atomic<timestamp_t>> edge_max_ts_;
+  std::vector<std::atomic<bool>> edges_updated_;
+  PropertyHistory history_;
+  SourceOffsets source_offsets_;
 
   size_t vertex_label_num_, edge_label_num_;
+  // of the bulk load, not kept by snapshots
+  uint32_t partition_id_, partition_num_;
 };
 
 }  // namespace gs
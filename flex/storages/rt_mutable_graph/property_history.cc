@@ -0,0 +1,150 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "flex/storages/rt_mutable_graph/property_history.h"
+
+#include <algorithm>
+
+namespace gs {
+
+static inline uint64_t vertex_key(label_t label, vid_t v, int col_id) {
+  return (static_cast<uint64_t>(label) << 56) |
+         (static_cast<uint64_t>(col_id) << 32) | v;
+}
+
+static inline uint64_t edge_key(vid_t v, vid_t nbr) {
+  return (static_cast<uint64_t>(v) << 32) | nbr;
+}
+
+static constexpr size_t kMinTruncateNum = 1024;
+
+PropertyHistory::PropertyHistory()
+    : retention_(0),
+      floor_(0),
+      newest_ts_(0),
+      version_num_(0),
+      truncated_num_(0) {}
+
+PropertyHistory::~PropertyHistory() = default;
+
+timestamp_t PropertyHistory::horizon(timestamp_t read_ts) const {
+  timestamp_t oldest = read_ts > retention_ ? read_ts - retention_ : 0;
+  return std::min(read_ts, std::max(oldest, floor_));
+}
+
+void PropertyHistory::reset(timestamp_t ts) { floor_ = std::max(floor_, ts); }
+
+void PropertyHistory::record_vertex(label_t label, vid_t v, int col_id,
+                                    timestamp_t ts, const Any& old_value) {
+  append(vertex_chains_[vertex_key(label, v, col_id)], ts, old_value);
+}
+
+bool PropertyHistory::get_vertex(label_t label, vid_t v, int col_id,
+                                 timestamp_t as_of, Any& value) const {
+  if (!has_versions_after(as_of)) {
+    return false;
+  }
+  auto iter = vertex_chains_.find(vertex_key(label, v, col_id));
+  return iter != vertex_chains_.end() && lookup(iter->second, as_of, value);
+}
+
+void PropertyHistory::record_edge(const MutableCsrBase* csr, vid_t v,
+                                  vid_t nbr, timestamp_t ts,
+                                  const Any& old_value) {
+  append(edge_chains_[csr][edge_key(v, nbr)], ts, old_value);
+}
+
+bool PropertyHistory::get_edge(const MutableCsrBase* csr, vid_t v, vid_t nbr,
+                               timestamp_t as_of, Any& value) const {
+  if (!has_versions_after(as_of)) {
+    return false;
+  }
+  auto csr_iter = edge_chains_.find(csr);
+  if (csr_iter == edge_chains_.end()) {
+    return false;
+  }
+  auto iter = csr_iter->second.find(edge_key(v, nbr));
+  return iter != csr_iter->second.end() && lookup(iter->second, as_of, value);
+}
+
+void PropertyHistory::truncate(timestamp_t read_ts) {
+  timestamp_t oldest = horizon(read_ts);
+  version_num_ -= prune(vertex_chains_, oldest);
+  for (auto iter = edge_chains_.begin(); iter != edge_chains_.end();) {
+    version_num_ -= prune(iter->second, oldest);
+    if (iter->second.empty()) {
+      iter = edge_chains_.erase(iter);
+    } else {
+      ++iter;
+    }
+  }
+  truncated_num_ = version_num_;
+}
+
+void PropertyHistory::append(chain_t& chain, timestamp_t ts,
+                             const Any& value) {
+  // parallel edges updated together keep the version of the first one
+  if (!chain.empty() && chain.back().ts == ts) {
+    return;
+  }
+  chain.emplace_back();
+  auto& version = chain.back();
+  version.ts = ts;
+  version.value = value;
+  if (value.type == PropertyType::kString) {
+    version.str = std::string(value.value.s);
+  }
+  newest_ts_ = std::max(newest_ts_, ts);
+  if (++version_num_ >= 2 * truncated_num_ + kMinTruncateNum) {
+    truncate(ts);
+  }
+}
+
+bool PropertyHistory::lookup(const chain_t& chain, timestamp_t as_of,
+                             Any& value) {
+  // the first overwrite after as_of holds the value at as_of
+  auto iter = std::upper_bound(
+      chain.begin(), chain.end(), as_of,
+      [](timestamp_t ts, const Version& version) { return ts < version.ts; });
+  if (iter == chain.end()) {
+    return false;
+  }
+  value = iter->value;
+  if (value.type == PropertyType::kString) {
+    value.set_string(iter->str);
+  }
+  return true;
+}
+
+size_t PropertyHistory::prune(chain_map_t& chains, timestamp_t horizon) {
+  // a version overwritten at or before the horizon serves no read anymore
+  size_t removed = 0;
+  for (auto iter = chains.begin(); iter != chains.end();) {
+    auto& chain = iter->second;
+    auto end = std::upper_bound(
+        chain.begin(), chain.end(), horizon,
+        [](timestamp_t ts, const Version& version) { return ts < version.ts; });
+    removed += end - chain.begin();
+    chain.erase(chain.begin(), end);
+    if (chain.empty()) {
+      iter = chains.erase(iter);
+    } else {
+      ++iter;
+    }
+  }
+  return removed;
+}
+
+}  // namespace gs
@@ -0,0 +1,127 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GRAPHSCOPE_GRAPH_PROPERTY_HISTORY_H_
+#define GRAPHSCOPE_GRAPH_PROPERTY_HISTORY_H_
+
+#include <string>
+#include <vector>
+
+#include "flat_hash_map/flat_hash_map.hpp"
+#include "flex/storages/rt_mutable_graph/types.h"
+#include "flex/utils/property/types.h"
+
+namespace gs {
+
+class MutableCsrBase;
+
+/**
+ * @brief Version chains of vertex properties and edge data overwritten in
+ * place, so that reads at timestamps before an overwrite still find the old
+ * values.
+ *
+ * Each chain keeps the old values of one property in the order of the
+ * overwrites, tagged with the timestamps of the overwrites. Versions only
+ * needed by reads older than the retention are dropped. Chains are written
+ * by exclusive updates only, so that readers need no synchronization.
+ */
+class PropertyHistory {
+ public:
+  PropertyHistory();
+  ~PropertyHistory();
+
+  /**
+   * @brief Keep old values for reads up to retention timestamps older than
+   * the latest one, 0 disables the history.
+   */
+  void set_retention(timestamp_t retention) { retention_ = retention; }
+
+  timestamp_t retention() const { return retention_; }
+
+  bool enabled() const { return retention_ != 0; }
+
+  /**
+   * @brief The oldest timestamp reads are consistent at, while read_ts is
+   * the latest one.
+   */
+  timestamp_t horizon(timestamp_t read_ts) const;
+
+  /**
+   * @brief Give up consistent reads before ts, for changes the history does
+   * not keep, such as deletions, or once it is lost by a restart.
+   */
+  void reset(timestamp_t ts);
+
+  /** @brief Whether values read at ts may differ from the current ones. */
+  bool has_versions_after(timestamp_t ts) const {
+    return version_num_ != 0 && ts < newest_ts_;
+  }
+
+  void record_vertex(label_t label, vid_t v, int col_id, timestamp_t ts,
+                     const Any& old_value);
+
+  /**
+   * @brief Get the value of a vertex property at timestamp as_of.
+   *
+   * @return false if the property was not overwritten after as_of, the
+   * current value applies then.
+   */
+  bool get_vertex(label_t label, vid_t v, int col_id, timestamp_t as_of,
+                  Any& value) const;
+
+  void record_edge(const MutableCsrBase* csr, vid_t v, vid_t nbr,
+                   timestamp_t ts, const Any& old_value);
+
+  /** @brief Get the data of the edge from v to nbr at as_of, see get_vertex. */
+  bool get_edge(const MutableCsrBase* csr, vid_t v, vid_t nbr,
+                timestamp_t as_of, Any& value) const;
+
+  /** @brief Drop the versions older than horizon(read_ts). */
+  void truncate(timestamp_t read_ts);
+
+ private:
+  struct Version {
+    timestamp_t ts;
+    Any value;
+    // owns the value of strings, which is pointed to again on lookups since
+    // versions are moved as chains grow
+    std::string str;
+  };
+  using chain_t = std::vector<Version>;
+  using chain_map_t = ska::flat_hash_map<uint64_t, chain_t>;
+
+  void append(chain_t& chain, timestamp_t ts, const Any& value);
+
+  static bool lookup(const chain_t& chain, timestamp_t as_of, Any& value);
+
+  size_t prune(chain_map_t& chains, timestamp_t horizon);
+
+  timestamp_t retention_;
+  timestamp_t floor_;
+  timestamp_t newest_ts_;
+  size_t version_num_;
+  // versions left by the last truncation, the next one runs when the number
+  // of versions has doubled, which amortizes its cost over the records
+  size_t truncated_num_;
+
+  // keyed by label, column and vertex
+  chain_map_t vertex_chains_;
+  // keyed by csr, then by vertex and neighbor
+  ska::flat_hash_map<const MutableCsrBase*, chain_map_t> edge_chains_;
+};
+
+}  // namespace gs
+
+#endif  // GRAPHSCOPE_GRAPH_PROPERTY_HISTORY_H_
@@ -31,6 +31,7 @@ void Schema::add_vertex_label(const std::string& label,
   vprop_storage_[v_label_id] = strategies;
   vprop_storage_[v_label_id].resize(vproperties_[v_label_id].size(),
                                     StorageStrategy::kMem);
+  vprop_index_[v_label_id].assign(properties.size(), IndexType::kNone);
   max_vnum_[v_label_id] = max_vnum;
 }
 
@@ -38,7 +39,9 @@ void Schema::add_edge_label(const std::string& src_label,
                             const std::string& dst_label,
                             const std::string& edge_label,
                             const std::vector<PropertyType>& properties,
-                            EdgeStrategy oe, EdgeStrategy ie) {
+                            EdgeStrategy oe, EdgeStrategy ie,
+                            bool sort_neighbors, bool is_static,
+                            size_t max_enum) {
   label_t src_label_id = vertex_label_to_index(src_label);
   label_t dst_label_id = vertex_label_to_index(dst_label);
   label_t edge_label_id = edge_label_to_index(edge_label);
@@ -48,6 +51,9 @@ void Schema::add_edge_label(const std::string& src_label,
   eproperties_[label_id] = properties;
   oe_strategy_[label_id] = oe;
   ie_strategy_[label_id] = ie;
+  sort_neighbors_[label_id] = sort_neighbors;
+  static_edges_[label_id] = is_static;
+  max_enum_[label_id] = max_enum;
 }
 
 label_t Schema::vertex_label_num() const {
@@ -76,6 +82,7 @@ void Schema::set_vertex_properties(
   vproperties_[label_id] = types;
   vprop_storage_[label_id] = strategies;
   vprop_storage_[label_id].resize(types.size(), StorageStrategy::kMem);
+  vprop_index_[label_id].resize(types.size(), IndexType::kNone);
 }
 
 const std::vector<PropertyType>& Schema::get_vertex_properties(
@@ -103,6 +110,15 @@ size_t Schema::get_max_vnum(const std::string& label) const {
   return max_vnum_[index];
 }
 
+void Schema::set_vertex_index(label_t label, int col_id, IndexType type) {
+  CHECK_LT(static_cast<size_t>(col_id), vprop_index_[label].size());
+  vprop_index_[label][col_id] = type;
+}
+
+IndexType Schema::get_vertex_index_type(label_t label, int col_id) const {
+  return vprop_index_[label][col_id];
+}
+
 bool Schema::exist(const std::string& src_label, const std::string& dst_label,
                    const std::string& edge_label) const {
   label_t src, dst, edge;
@@ -124,13 +140,31 @@ const std::vector<PropertyType>& Schema::get_edge_properties(
   return eproperties_.at(index);
 }
 
+const std::vector<PropertyType>& Schema::get_edge_properties(
+    label_t src, label_t dst, label_t edge) const {
+  uint32_t index = generate_edge_label(src, dst, edge);
+  return eproperties_.at(index);
+}
+
 PropertyType Schema::get_edge_property(label_t src, label_t dst,
                                        label_t edge) const {
   uint32_t index = generate_edge_label(src, dst, edge);
   auto& vec = eproperties_.at(index);
+  if (vec.size() > 1) {
+    return PropertyType::kInt64;
+  }
   return vec.empty() ? PropertyType::kEmpty : vec[0];
 }
 
+bool Schema::has_edge_table(label_t src, label_t dst, label_t edge) const {
+  return get_edge_properties(src, dst, edge).size() > 1;
+}
+
+size_t Schema::get_max_enum(label_t src, label_t dst, label_t edge) const {
+  uint32_t index = generate_edge_label(src, dst, edge);
+  return max_enum_.at(index);
+}
+
 bool Schema::valid_edge_property(const std::string& src_label,
                                  const std::string& dst_label,
                                  const std::string& label) const {
@@ -164,6 +198,49 @@ EdgeStrategy Schema::get_incoming_edge_strategy(
   return ie_strategy_.at(index);
 }
 
+bool Schema::get_sort_neighbors(const std::string& src_label,
+                                const std::string& dst_label,
+                                const std::string& label) const {
+  label_t src, dst, edge;
+  CHECK(vlabel_indexer_.get_index(src_label, src));
+  CHECK(vlabel_indexer_.get_index(dst_label, dst));
+  CHECK(elabel_indexer_.get_index(label, edge));
+  uint32_t index = generate_edge_label(src, dst, edge);
+  return sort_neighbors_.at(index);
+}
+
+bool Schema::is_static_edge(label_t src, label_t dst, label_t edge) const {
+  uint32_t index = generate_edge_label(src, dst, edge);
+  return static_edges_.at(index);
+}
+
+void Schema::set_time_ordered(label_t src, label_t dst, label_t edge) {
+  uint32_t index = generate_edge_label(src, dst, edge);
+  const auto& properties = eproperties_.at(index);
+  CHECK(properties.size() == 1 &&
+        (properties[0] == PropertyType::kInt32 ||
+         properties[0] == PropertyType::kInt64 ||
+         properties[0] == PropertyType::kDate))
+      << "time ordered edges must have a single int32, int64 or date";
+  CHECK(!sort_neighbors_.at(index) && !static_edges_.at(index))
+      << "time ordered edges can not be sorted by neighbor or static";
+  time_ordered_[index] = true;
+}
+
+bool Schema::is_time_ordered(label_t src, label_t dst, label_t edge) const {
+  auto iter = time_ordered_.find(generate_edge_label(src, dst, edge));
+  return iter != time_ordered_.end() && iter->second;
+}
+
+NbrOrder Schema::get_nbr_order(label_t src, label_t dst, label_t edge) const {
+  uint32_t index = generate_edge_label(src, dst, edge);
+  if (sort_neighbors_.at(index)) {
+    return NbrOrder::kNeighbor;
+  }
+  return is_time_ordered(src, dst, edge) ? NbrOrder::kTime
+                                         : NbrOrder::kInsertion;
+}
+
 label_t Schema::get_edge_label_id(const std::string& label) const {
   label_t ret;
   CHECK(elabel_indexer_.get_index(label, ret));
@@ -192,7 +269,8 @@ void Schema::Serialize(std::unique_ptr<grape::LocalIOAdaptor>& writer) {
   elabel_indexer_.Serialize(writer);
   grape::InArchive arc;
   arc << vproperties_ << vprop_storage_ << eproperties_ << ie_strategy_
-      << oe_strategy_ << max_vnum_;
+      << oe_strategy_ << max_vnum_ << sort_neighbors_ << static_edges_
+      << max_enum_ << vprop_index_ << time_ordered_;
   CHECK(writer->WriteArchive(arc));
 }
 
@@ -202,7 +280,8 @@ void Schema::Deserialize(std::unique_ptr<grape::LocalIOAdaptor>& reader) {
   grape::OutArchive arc;
   CHECK(reader->ReadArchive(arc));
   arc >> vproperties_ >> vprop_storage_ >> eproperties_ >> ie_strategy_ >>
-      oe_strategy_ >> max_vnum_;
+      oe_strategy_ >> max_vnum_ >> sort_neighbors_ >> static_edges_ >>
+      max_enum_ >> vprop_index_ >> time_ordered_;
 }
 
 label_t Schema::vertex_label_to_index(const std::string& label) {
@@ -211,6 +290,7 @@ label_t Schema::vertex_label_to_index(const std::string& label) {
   if (vproperties_.size() <= ret) {
     vproperties_.resize(ret + 1);
     vprop_storage_.resize(ret + 1);
+    vprop_index_.resize(ret + 1);
     max_vnum_.resize(ret + 1);
   }
   return ret;
@@ -257,6 +337,9 @@ bool Schema::Equals(const Schema& other) const {
     if (get_max_vnum(label_name) != other.get_max_vnum(label_name)) {
       return false;
     }
+    if (vprop_index_[i] != other.vprop_index_[i]) {
+      return false;
+    }
   }
   for (label_t src_label = 0; src_label < vertex_label_num(); ++src_label) {
     for (label_t dst_label = 0; dst_label < vertex_label_num(); ++dst_label) {
@@ -300,6 +383,27 @@ bool Schema::Equals(const Schema& other) const {
               return false;
             }
           }
+          {
+            auto lhs = get_sort_neighbors(src_label_name, dst_label_name,
+                                          edge_label_name);
+            auto rhs = other.get_sort_neighbors(
+                src_label_name, dst_label_name, edge_label_name);
+            if (lhs != rhs) {
+              return false;
+            }
+          }
+          if (is_static_edge(src_label, dst_label, edge_label) !=
+              other.is_static_edge(src_label, dst_label, edge_label)) {
+            return false;
+          }
+          if (is_time_ordered(src_label, dst_label, edge_label) !=
+              other.is_time_ordered(src_label, dst_label, edge_label)) {
+            return false;
+          }
+          if (get_max_enum(src_label, dst_label, edge_label) !=
+              other.get_max_enum(src_label, dst_label, edge_label)) {
+            return false;
+          }
         }
       }
     }
@@ -383,15 +487,30 @@ StorageStrategy StringToStorageStrategy(const std::string& str) {
     return StorageStrategy::kNone;
   } else if (str == "Mem") {
     return StorageStrategy::kMem;
+  } else if (str == "Dict") {
+    return StorageStrategy::kDict;
+  } else if (str == "Disk") {
+    return StorageStrategy::kDisk;
   } else {
     return StorageStrategy::kMem;
   }
 }
 
+IndexType StringToIndexType(const std::string& str) {
+  if (str == "Hash") {
+    return IndexType::kHash;
+  } else if (str == "Sorted") {
+    return IndexType::kSorted;
+  } else {
+    return IndexType::kNone;
+  }
+}
+
 static bool parse_vertex_properties(YAML::Node node,
                                     const std::string& label_name,
                                     std::vector<PropertyType>& types,
-                                    std::vector<StorageStrategy>& strategies) {
+                                    std::vector<StorageStrategy>& strategies,
+                                    std::vector<IndexType>& indexes) {
   if (!node || !node.IsSequence()) {
     LOG(ERROR) << "properties of vertex-" << label_name
                << " not set properly... ";
@@ -413,15 +532,17 @@ static bool parse_vertex_properties(YAML::Node node,
   }
 
   for (int i = 1; i < prop_num; ++i) {
-    std::string prop_type_str, strategy_str;
+    std::string prop_type_str, strategy_str, index_str;
     if (!get_scalar(node[i], "type", prop_type_str)) {
       LOG(ERROR) << "type of vertex-" << label_name << " prop-" << i - 1
                  << " is not specified...";
       return false;
     }
     get_scalar(node[i], "storage_strategy", strategy_str);
+    get_scalar(node[i], "index", index_str);
     types.push_back(StringToPropertyType(prop_type_str));
     strategies.push_back(StringToStorageStrategy(strategy_str));
+    indexes.push_back(StringToIndexType(index_str));
   }
 
   return true;
@@ -478,11 +599,16 @@ static bool parse_vertex_schema(YAML::Node node, Schema& schema) {
   get_scalar(node, "max_vertex_num", max_num);
   std::vector<PropertyType> property_types;
   std::vector<StorageStrategy> strategies;
+  std::vector<IndexType> indexes;
   if (!parse_vertex_properties(node["properties"], label_name, property_types,
-                               strategies)) {
+                               strategies, indexes)) {
     return false;
   }
   schema.add_vertex_label(label_name, property_types, strategies, max_num);
+  label_t label = schema.get_vertex_label_id(label_name);
+  for (size_t i = 0; i < indexes.size(); ++i) {
+    schema.set_vertex_index(label, i, indexes[i]);
+  }
   return true;
 }
 
@@ -525,8 +651,34 @@ static bool parse_edge_schema(YAML::Node node, Schema& schema) {
   if (get_scalar(node, "incoming_edge_strategy", ie_str)) {
     ie = StringToEdgeStrategy(ie_str);
   }
+  bool sort_neighbors = false;
+  get_scalar(node, "sort_neighbors", sort_neighbors);
+  bool is_static = false;
+  get_scalar(node, "static", is_static);
+  // only bounds the edges of types with several properties, see
+  // Schema::has_edge_table
+  size_t max_num = ((size_t) 1) << 32;
+  get_scalar(node, "max_edge_num", max_num);
+  bool time_ordered = false;
+  get_scalar(node, "time_ordered", time_ordered);
+  if (time_ordered &&
+      (sort_neighbors || is_static || property_types.size() != 1 ||
+       (property_types[0] != PropertyType::kInt32 &&
+        property_types[0] != PropertyType::kInt64 &&
+        property_types[0] != PropertyType::kDate))) {
+    LOG(ERROR) << "time ordered edge " << edge_label_name
+               << " must have a single int32, int64 or date property, and "
+                  "be neither static nor sorted by neighbor";
+    return false;
+  }
   schema.add_edge_label(src_label_name, dst_label_name, edge_label_name,
-                        property_types, oe, ie);
+                        property_types, oe, ie, sort_neighbors, is_static,
+                        max_num);
+  if (time_ordered) {
+    schema.set_time_ordered(schema.get_vertex_label_id(src_label_name),
+                            schema.get_vertex_label_id(dst_label_name),
+                            schema.get_edge_label_id(edge_label_name));
+  }
   return true;
 }
 
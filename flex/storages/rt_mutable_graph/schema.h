@@ -37,7 +37,9 @@ class Schema {
                       const std::string& edge_label,
                       const std::vector<PropertyType>& properties,
                       EdgeStrategy oe = EdgeStrategy::kMultiple,
-                      EdgeStrategy ie = EdgeStrategy::kMultiple);
+                      EdgeStrategy ie = EdgeStrategy::kMultiple,
+                      bool sort_neighbors = false, bool is_static = false,
+                      size_t max_enum = static_cast<size_t>(1) << 32);
 
   label_t vertex_label_num() const;
 
@@ -61,6 +63,14 @@ class Schema {
 
   size_t get_max_vnum(const std::string& label) const;
 
+  /**
+   * @brief Declare a secondary index on a vertex property, see VertexIndexBase.
+   * Properties are not indexed by default.
+   */
+  void set_vertex_index(label_t label, int col_id, IndexType type);
+
+  IndexType get_vertex_index_type(label_t label, int col_id) const;
+
   bool exist(const std::string& src_label, const std::string& dst_label,
              const std::string& edge_label) const;
 
@@ -68,8 +78,26 @@ class Schema {
       const std::string& src_label, const std::string& dst_label,
       const std::string& label) const;
 
+  const std::vector<PropertyType>& get_edge_properties(label_t src, label_t dst,
+                                                      label_t edge) const;
+
+  /**
+   * @brief Type of the data held by the csrs of an edge type: its property,
+   * kEmpty without one, or kInt64 with several properties, see
+   * has_edge_table.
+   */
   PropertyType get_edge_property(label_t src, label_t dst, label_t edge) const;
 
+  /**
+   * @brief Whether the edge type has several properties. They are kept as
+   * rows of a table, and the data of each edge in the csrs of both
+   * directions is the row of its properties.
+   */
+  bool has_edge_table(label_t src, label_t dst, label_t edge) const;
+
+  /** @brief Max number of rows of the table of an edge type. */
+  size_t get_max_enum(label_t src, label_t dst, label_t edge) const;
+
   bool valid_edge_property(const std::string& src_label,
                            const std::string& dst_label,
                            const std::string& label) const;
@@ -82,6 +110,34 @@ class Schema {
                                           const std::string& dst_label,
                                           const std::string& label) const;
 
+  /**
+   * @brief Whether the Multiple adjacency lists of this edge type are kept
+   * sorted by neighbor, in both directions.
+   */
+  bool get_sort_neighbors(const std::string& src_label,
+                          const std::string& dst_label,
+                          const std::string& label) const;
+
+  /**
+   * @brief Whether this edge type is static, i.e. only bulk loaded and never
+   * inserted into, so that its Multiple edges are kept in ImmutableCsr.
+   */
+  bool is_static_edge(label_t src, label_t dst, label_t edge) const;
+
+  /**
+   * @brief Keep the Multiple adjacency lists of an edge type ordered by the
+   * time held by its single property, an int32, int64 or date, see time_of.
+   * Expansions along the edges of a window of time then binary search the
+   * lists instead of testing every edge. The edge type must not be static or
+   * sorted by neighbor. Edge types are not time ordered by default.
+   */
+  void set_time_ordered(label_t src, label_t dst, label_t edge);
+
+  bool is_time_ordered(label_t src, label_t dst, label_t edge) const;
+
+  /** @brief Order of the Multiple adjacency lists of an edge type. */
+  NbrOrder get_nbr_order(label_t src, label_t dst, label_t edge) const;
+
   bool contains_edge_label(const std::string& label) const;
 
   label_t get_edge_label_id(const std::string& label) const;
@@ -114,9 +170,14 @@ class Schema {
   IdIndexer<std::string, label_t> elabel_indexer_;
   std::vector<std::vector<PropertyType>> vproperties_;
   std::vector<std::vector<StorageStrategy>> vprop_storage_;
+  std::vector<std::vector<IndexType>> vprop_index_;
   std::map<uint32_t, std::vector<PropertyType>> eproperties_;
   std::map<uint32_t, EdgeStrategy> oe_strategy_;
   std::map<uint32_t, EdgeStrategy> ie_strategy_;
+  std::map<uint32_t, bool> sort_neighbors_;
+  std::map<uint32_t, bool> static_edges_;
+  std::map<uint32_t, bool> time_ordered_;
+  std::map<uint32_t, size_t> max_enum_;
   std::vector<size_t> max_vnum_;
 };
 
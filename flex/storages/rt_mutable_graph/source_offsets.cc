@@ -0,0 +1,62 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "flex/storages/rt_mutable_graph/source_offsets.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+
+#include "glog/logging.h"
+
+namespace gs {
+
+void SourceOffsets::advance(int32_t partition, int64_t offset) {
+  std::lock_guard<std::mutex> guard(lock_);
+  auto iter = offsets_.emplace(partition, offset).first;
+  iter->second = std::max(iter->second, offset);
+}
+
+int64_t SourceOffsets::get(int32_t partition) const {
+  std::lock_guard<std::mutex> guard(lock_);
+  auto iter = offsets_.find(partition);
+  return iter == offsets_.end() ? -1 : iter->second;
+}
+
+void SourceOffsets::Serialize(const std::string& path) const {
+  std::lock_guard<std::mutex> guard(lock_);
+  std::ofstream out(path, std::ios::trunc);
+  for (auto& pair : offsets_) {
+    out << pair.first << " " << pair.second << "\n";
+  }
+  out.close();
+  CHECK(out) << "Failed to write source offsets to " << path;
+}
+
+void SourceOffsets::Deserialize(const std::string& path) {
+  std::lock_guard<std::mutex> guard(lock_);
+  offsets_.clear();
+  if (!std::filesystem::exists(path)) {
+    return;
+  }
+  std::ifstream in(path);
+  int32_t partition;
+  int64_t offset;
+  while (in >> partition >> offset) {
+    offsets_[partition] = offset;
+  }
+}
+
+}  // namespace gs
@@ -0,0 +1,60 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GRAPHSCOPE_GRAPH_SOURCE_OFFSETS_H_
+#define GRAPHSCOPE_GRAPH_SOURCE_OFFSETS_H_
+
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace gs {
+
+/**
+ * @brief Offsets in the partitions of an external log, such as the log of a
+ * groot instance, up to which the log has been applied to the graph.
+ *
+ * An offset is recorded in the wal together with the data it covers, so that
+ * both become durable at once, and advanced again when the wal is replayed.
+ * Snapshots keep the offsets of the data they hold, and a replicator resumes
+ * every partition after its offset, applying each entry exactly once.
+ */
+class SourceOffsets {
+ public:
+  SourceOffsets() = default;
+  ~SourceOffsets() = default;
+
+  /**
+   * @brief Record that the partition is applied up to offset, offsets of
+   * replayed wals may arrive out of order and only the largest is kept.
+   */
+  void advance(int32_t partition, int64_t offset);
+
+  /** @brief The offset applied up to, -1 if none of the partition is. */
+  int64_t get(int32_t partition) const;
+
+  void Serialize(const std::string& path) const;
+
+  /** @brief Load the offsets of a snapshot, none if it has no file. */
+  void Deserialize(const std::string& path);
+
+ private:
+  mutable std::mutex lock_;
+  std::map<int32_t, int64_t> offsets_;
+};
+
+}  // namespace gs
+
+#endif  // GRAPHSCOPE_GRAPH_SOURCE_OFFSETS_H_
@@ -18,6 +18,8 @@ limitations under the License.
 
 #include <stdint.h>
 
+#include <limits>
+
 namespace gs {
 
 enum class EdgeStrategy {
@@ -26,11 +28,23 @@ enum class EdgeStrategy {
   kMultiple,
 };
 
+// Order of the edges in the Multiple adjacency lists of an edge type.
+enum class NbrOrder {
+  kInsertion,
+  kNeighbor,  // see Schema::get_sort_neighbors
+  kTime,      // see Schema::is_time_ordered
+};
+
 using timestamp_t = uint32_t;
 using vid_t = uint32_t;
 using oid_t = int64_t;
 using label_t = uint8_t;
 
+// Timestamp of deleted edges, newer than that of any transaction so that
+// they are invisible to all of them.
+static constexpr timestamp_t kDeletedTimestamp =
+    std::numeric_limits<timestamp_t>::max();
+
 }  // namespace gs
 
 #endif  // STORAGES_RT_MUTABLE_GRAPH_TYPES_H_
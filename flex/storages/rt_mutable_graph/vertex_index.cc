@@ -0,0 +1,58 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "flex/storages/rt_mutable_graph/vertex_index.h"
+
+namespace gs {
+
+template <template <typename> class INDEX_T>
+static std::unique_ptr<VertexIndexBase> create_typed_index(
+    PropertyType property_type) {
+  switch (property_type) {
+  case PropertyType::kInt32:
+    return std::make_unique<INDEX_T<int>>();
+  case PropertyType::kInt64:
+  case PropertyType::kDate:
+    return std::make_unique<INDEX_T<int64_t>>();
+  case PropertyType::kDouble:
+    return std::make_unique<INDEX_T<double>>();
+  case PropertyType::kString:
+    return std::make_unique<INDEX_T<std::string>>();
+  default:
+    return nullptr;
+  }
+}
+
+std::unique_ptr<VertexIndexBase> CreateVertexIndex(IndexType index_type,
+                                                   PropertyType property_type) {
+  if (index_type == IndexType::kHash) {
+    return create_typed_index<HashVertexIndex>(property_type);
+  } else if (index_type == IndexType::kSorted) {
+    return create_typed_index<SortedVertexIndex>(property_type);
+  }
+  return nullptr;
+}
+
+void BuildVertexIndex(VertexIndexBase& index, const ColumnBase& column,
+                      vid_t vertex_num,
+                      const std::function<bool(vid_t)>& is_deleted) {
+  for (vid_t v = 0; v < vertex_num; ++v) {
+    if (!is_deleted(v)) {
+      index.insert(column.get(v), v);
+    }
+  }
+}
+
+}  // namespace gs
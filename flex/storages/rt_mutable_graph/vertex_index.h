@@ -0,0 +1,277 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GRAPHSCOPE_GRAPH_VERTEX_INDEX_H_
+#define GRAPHSCOPE_GRAPH_VERTEX_INDEX_H_
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "flex/storages/rt_mutable_graph/types.h"
+#include "flex/utils/property/column.h"
+#include "flex/utils/property/types.h"
+
+#include "glog/logging.h"
+
+namespace gs {
+
+/**
+ * @brief Bound of a range looked up in a sorted index, unbounded when its
+ * value is kEmpty.
+ */
+struct IndexBound {
+  IndexBound() = default;
+  IndexBound(const Any& value, bool inclusive)
+      : value(value), inclusive(inclusive) {}
+
+  bool bounded() const { return value.type != PropertyType::kEmpty; }
+
+  Any value;
+  bool inclusive = true;
+};
+
+/** @brief Values looked up in an index, one or those within bounds. */
+struct IndexRange {
+  static IndexRange Point(const Any& value) {
+    IndexRange ret;
+    ret.point = true;
+    ret.lower = IndexBound(value, true);
+    ret.upper = ret.lower;
+    return ret;
+  }
+
+  static IndexRange Between(const IndexBound& lower, const IndexBound& upper) {
+    IndexRange ret;
+    ret.point = false;
+    ret.lower = lower;
+    ret.upper = upper;
+    return ret;
+  }
+
+  bool point = false;
+  IndexBound lower, upper;
+};
+
+/**
+ * @brief Secondary index of a vertex property, mapping values to the
+ * vertices holding them.
+ *
+ * Entries are only added: when a property is updated, the vertex is indexed
+ * again with the new value and the old entry stays. Lookups thus return
+ * candidates, possibly repeated, that callers check against the current
+ * values, which they have to do anyway for the rest of their predicates.
+ * Stale entries are dropped when the index is rebuilt on load.
+ */
+class VertexIndexBase {
+ public:
+  virtual ~VertexIndexBase() = default;
+
+  virtual IndexType type() const = 0;
+
+  virtual void insert(const Any& value, vid_t v) = 0;
+
+  /** @brief Append the candidates of value to vids. */
+  virtual void lookup(const Any& value, std::vector<vid_t>& vids) const = 0;
+
+  /**
+   * @brief Append the candidates of values within the bounds to vids, only
+   * supported by sorted indexes.
+   */
+  virtual void range(const IndexBound& lower, const IndexBound& upper,
+                     std::vector<vid_t>& vids) const = 0;
+
+  bool supports(const IndexRange& range) const {
+    return range.point || type() == IndexType::kSorted;
+  }
+
+  void find(const IndexRange& range, std::vector<vid_t>& vids) const {
+    if (range.point) {
+      lookup(range.lower.value, vids);
+    } else {
+      this->range(range.lower, range.upper, vids);
+    }
+  }
+};
+
+// Keys of the index of a property type, numeric constants of other types
+// are converted, as queries may compare a property with literals of a wider
+// type.
+template <typename KEY_T>
+struct IndexKey {
+  static KEY_T from_any(const Any& value) {
+    switch (value.type) {
+    case PropertyType::kInt32:
+      return static_cast<KEY_T>(value.value.i);
+    case PropertyType::kInt64:
+      return static_cast<KEY_T>(value.value.l);
+    case PropertyType::kDate:
+      return static_cast<KEY_T>(value.value.d.milli_second);
+    case PropertyType::kDouble:
+      return static_cast<KEY_T>(value.value.db);
+    default:
+      LOG(FATAL) << "Unexpected key type: " << value.type;
+      return KEY_T();
+    }
+  }
+};
+
+template <>
+struct IndexKey<std::string> {
+  static std::string from_any(const Any& value) {
+    CHECK(value.type == PropertyType::kString);
+    return std::string(value.value.s);
+  }
+};
+
+template <typename KEY_T>
+class HashVertexIndex : public VertexIndexBase {
+ public:
+  IndexType type() const override { return IndexType::kHash; }
+
+  void insert(const Any& value, vid_t v) override {
+    KEY_T key = IndexKey<KEY_T>::from_any(value);
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    map_.emplace(std::move(key), v);
+  }
+
+  void lookup(const Any& value, std::vector<vid_t>& vids) const override {
+    KEY_T key = IndexKey<KEY_T>::from_any(value);
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto range = map_.equal_range(key);
+    for (auto iter = range.first; iter != range.second; ++iter) {
+      vids.push_back(iter->second);
+    }
+  }
+
+  void range(const IndexBound& lower, const IndexBound& upper,
+             std::vector<vid_t>& vids) const override {
+    LOG(FATAL) << "Range lookups are not supported by hash indexes";
+  }
+
+ private:
+  mutable std::shared_mutex mutex_;
+  std::unordered_multimap<KEY_T, vid_t> map_;
+};
+
+/**
+ * @brief Sorted array of (key, vertex) entries. Insertions go to a small
+ * unsorted delta, which lookups scan and which is merged into the array
+ * once it grows past a fraction of it, so that insertions are amortized
+ * O(log n) writes and the array stays compact to search.
+ */
+template <typename KEY_T>
+class SortedVertexIndex : public VertexIndexBase {
+  using entry_t = std::pair<KEY_T, vid_t>;
+
+ public:
+  static constexpr size_t kMinDeltaSize = 4096;
+
+  IndexType type() const override { return IndexType::kSorted; }
+
+  void insert(const Any& value, vid_t v) override {
+    KEY_T key = IndexKey<KEY_T>::from_any(value);
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    delta_.emplace_back(std::move(key), v);
+    if (delta_.size() >= std::max(kMinDeltaSize, sorted_.size() / 16)) {
+      merge();
+    }
+  }
+
+  void lookup(const Any& value, std::vector<vid_t>& vids) const override {
+    IndexBound bound(value, true);
+    range(bound, bound, vids);
+  }
+
+  void range(const IndexBound& lower, const IndexBound& upper,
+             std::vector<vid_t>& vids) const override {
+    bool has_lower = lower.bounded(), has_upper = upper.bounded();
+    KEY_T lower_key, upper_key;
+    if (has_lower) {
+      lower_key = IndexKey<KEY_T>::from_any(lower.value);
+    }
+    if (has_upper) {
+      upper_key = IndexKey<KEY_T>::from_any(upper.value);
+    }
+    auto above_lower = [&](const KEY_T& key) {
+      return !has_lower ||
+             (lower.inclusive ? !(key < lower_key) : lower_key < key);
+    };
+    auto below_upper = [&](const KEY_T& key) {
+      return !has_upper ||
+             (upper.inclusive ? !(upper_key < key) : key < upper_key);
+    };
+
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto iter = sorted_.begin();
+    if (has_lower) {
+      iter = std::lower_bound(
+          sorted_.begin(), sorted_.end(), lower_key,
+          [](const entry_t& entry, const KEY_T& key) {
+            return entry.first < key;
+          });
+    }
+    for (; iter != sorted_.end() && below_upper(iter->first); ++iter) {
+      if (above_lower(iter->first)) {
+        vids.push_back(iter->second);
+      }
+    }
+    for (auto& entry : delta_) {
+      if (above_lower(entry.first) && below_upper(entry.first)) {
+        vids.push_back(entry.second);
+      }
+    }
+  }
+
+ private:
+  // called with the lock held
+  void merge() {
+    size_t old_size = sorted_.size();
+    std::sort(delta_.begin(), delta_.end());
+    sorted_.insert(sorted_.end(), std::make_move_iterator(delta_.begin()),
+                   std::make_move_iterator(delta_.end()));
+    std::inplace_merge(sorted_.begin(), sorted_.begin() + old_size,
+                       sorted_.end());
+    delta_.clear();
+  }
+
+  mutable std::shared_mutex mutex_;
+  std::vector<entry_t> sorted_;
+  std::vector<entry_t> delta_;
+};
+
+/**
+ * @brief Create the index of a property type, nullptr for kNone or for
+ * types that can not be indexed.
+ */
+std::unique_ptr<VertexIndexBase> CreateVertexIndex(IndexType index_type,
+                                                   PropertyType property_type);
+
+/**
+ * @brief Index the values of a column for the vertices in [0, vertex_num)
+ * that are not deleted.
+ */
+void BuildVertexIndex(VertexIndexBase& index, const ColumnBase& column,
+                      vid_t vertex_num,
+                      const std::function<bool(vid_t)>& is_deleted);
+
+}  // namespace gs
+
+#endif  // GRAPHSCOPE_GRAPH_VERTEX_INDEX_H_
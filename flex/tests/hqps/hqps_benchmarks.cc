@@ -0,0 +1,460 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Micro benchmarks of the operators of the hqps engine, on a synthetic graph
+// of --scale persons, each knowing 16 of them on average and working at one
+// of scale / 16 companies, all along edges labeled link. Sources of the
+// knows edges are drawn as scale * u^skew for u uniform in [0, 1), so
+// --skew=1 gives uniform degrees and larger values concentrate the edges on
+// the first persons. The inputs of the operators are persons drawn as the
+// sources of the edges, so hubs are as frequent as in real queries.
+//
+// Each benchmark reports the input rows processed per second, and the heap
+// allocations per iteration as allocs. Other arguments go to google
+// benchmark.
+
+#include <benchmark/benchmark.h>
+
+#include <stdlib.h>
+#include <atomic>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "flex/engines/graph_db/database/graph_db.h"
+#include "flex/engines/graph_db/database/graph_db_session.h"
+#include "flex/engines/hqps_db/core/sync_engine.h"
+#include "flex/engines/hqps_db/database/mutable_csr_interface.h"
+
+#include "glog/logging.h"
+
+static std::atomic<size_t> allocation_num(0);
+
+// counts the allocations of all threads, including the morsel workers
+void* operator new(size_t size) {
+  allocation_num.fetch_add(1, std::memory_order_relaxed);
+  void* ptr = malloc(size == 0 ? 1 : size);
+  if (ptr == nullptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+void operator delete(void* ptr) noexcept { free(ptr); }
+
+void operator delete(void* ptr, size_t) noexcept { free(ptr); }
+
+namespace gs {
+
+using GI = MutableCSRInterface;
+using Engine = SyncEngine<GI>;
+using label_id_t = GI::label_id_t;
+using vertex_id_t = GI::vertex_id_t;
+
+static size_t scale = 1 << 18;
+static double skew = 2.0;
+static constexpr size_t kAvgDegree = 16;
+static constexpr size_t kCompanyRatio = 16;
+static constexpr size_t kInsertBatchSize = 4096;
+
+static constexpr label_id_t kPerson = 0;
+static constexpr label_id_t kCompany = 1;
+static constexpr label_id_t kLink = 0;
+
+static std::string make_work_dir(const std::string& name) {
+  std::string path =
+      (std::filesystem::temp_directory_path() / ("hqps_bench_XXXXXX"))
+          .string();
+  CHECK(mkdtemp(&path[0]) != nullptr) << "Failed to create " << path;
+  path += "/" + name;
+  std::filesystem::create_directory(path);
+  return path;
+}
+
+struct SyntheticGraph {
+  SyntheticGraph() {
+    std::mt19937_64 gen(0);
+    std::uniform_real_distribution<double> dist(0, 1);
+    std::uniform_int_distribution<vertex_id_t> dst_dist(0, scale - 1);
+    edges.resize(scale * kAvgDegree);
+    for (auto& edge : edges) {
+      edge.first = static_cast<vertex_id_t>(scale * std::pow(dist(gen), skew));
+      edge.second = dst_dist(gen);
+    }
+  }
+
+  static const SyntheticGraph& get() {
+    static SyntheticGraph graph;
+    return graph;
+  }
+
+  // persons are inserted in order, so lids and oids are their indices
+  std::vector<std::pair<vertex_id_t, vertex_id_t>> edges;
+};
+
+static const GI& get_graph() {
+  static GI* graph = []() {
+    auto& db = GraphDB::get();
+    Schema schema;
+    schema.add_vertex_label("person", {PropertyType::kInt64}, {}, scale);
+    schema.add_vertex_label("company", {PropertyType::kInt64}, {},
+                            scale / kCompanyRatio + 1);
+    schema.add_edge_label("person", "person", "link", {PropertyType::kInt64});
+    schema.add_edge_label("person", "company", "link",
+                          {PropertyType::kInt64});
+    db.Init(schema, {}, {}, {}, make_work_dir("db"), 1);
+
+    auto& session = db.GetSession(0);
+    size_t company_num = scale / kCompanyRatio + 1;
+    {
+      auto txn = session.GetInsertTransaction();
+      for (size_t i = 0; i < scale; ++i) {
+        txn.AddVertex(kPerson, i, {Any::From<int64_t>(i)});
+      }
+      for (size_t i = 0; i < company_num; ++i) {
+        txn.AddVertex(kCompany, i, {Any::From<int64_t>(i)});
+      }
+      txn.Commit();
+    }
+    const auto& edges = SyntheticGraph::get().edges;
+    for (size_t begin = 0; begin < edges.size(); begin += kInsertBatchSize) {
+      size_t end = std::min(edges.size(), begin + kInsertBatchSize);
+      auto txn = session.GetInsertTransaction();
+      for (size_t i = begin; i < end; ++i) {
+        txn.AddEdge(kPerson, edges[i].first, kPerson, edges[i].second, kLink,
+                    Any::From<int64_t>(i));
+      }
+      txn.Commit();
+    }
+    for (size_t begin = 0; begin < scale; begin += kInsertBatchSize) {
+      size_t end = std::min(scale, begin + kInsertBatchSize);
+      auto txn = session.GetInsertTransaction();
+      for (size_t i = begin; i < end; ++i) {
+        txn.AddEdge(kPerson, i, kCompany, i % company_num, kLink,
+                    Any::From<int64_t>(i));
+      }
+      txn.Commit();
+    }
+    return new GI(session);
+  }();
+  return *graph;
+}
+
+// persons drawn as the sources of edges
+static std::vector<vertex_id_t> draw_persons(size_t num, uint64_t seed) {
+  const auto& edges = SyntheticGraph::get().edges;
+  std::mt19937_64 gen(seed);
+  std::uniform_int_distribution<size_t> dist(0, edges.size() - 1);
+  std::vector<vertex_id_t> vids(num);
+  for (auto& vid : vids) {
+    vid = edges[dist(gen)].first;
+  }
+  return vids;
+}
+
+static auto make_persons(size_t num, uint64_t seed = 1) {
+  auto set = MakeDefaultRowVertexSet(draw_persons(num, seed), kPerson);
+  return Context<decltype(set), 0, 0, grape::EmptyType>(std::move(set));
+}
+
+// the persons and their neighbors
+static auto expand_persons(size_t num) {
+  return Engine::template EdgeExpandV<AppendOpt::Persist, 0>(
+      get_graph(), make_persons(num),
+      make_edge_expandv_opt(Direction::Out, kLink, kPerson));
+}
+
+static size_t allocations() {
+  return allocation_num.load(std::memory_order_relaxed);
+}
+
+static void report(benchmark::State& state, size_t rows, size_t allocs) {
+  state.SetItemsProcessed(state.iterations() * rows);
+  state.counters["allocs"] =
+      benchmark::Counter(allocs, benchmark::Counter::kAvgIterations);
+}
+
+struct ValueBelow {
+  explicit ValueBelow(int64_t bound) : bound_(bound) {}
+  inline bool operator()(int64_t value) const { return value < bound_; }
+  int64_t bound_;
+};
+
+struct ValueEquals {
+  explicit ValueEquals(int64_t value) : value_(value) {}
+  inline bool operator()(int64_t value) const { return value == value_; }
+  int64_t value_;
+};
+
+static void BM_EdgeExpandV(benchmark::State& state) {
+  const auto& graph = get_graph();
+  size_t allocs = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto ctx = make_persons(state.range(0));
+    state.ResumeTiming();
+    size_t before = allocations();
+    auto res = Engine::template EdgeExpandV<AppendOpt::Persist, 0>(
+        graph, std::move(ctx),
+        make_edge_expandv_opt(Direction::Out, kLink, kPerson));
+    allocs += allocations() - before;
+    benchmark::DoNotOptimize(res.GetHead().Size());
+  }
+  report(state, state.range(0), allocs);
+}
+BENCHMARK(BM_EdgeExpandV)->Range(1 << 8, 1 << 16);
+
+// expands into a TwoLabelVertexSet of persons and companies
+static void BM_EdgeExpandVTwoLabels(benchmark::State& state) {
+  const auto& graph = get_graph();
+  size_t allocs = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto ctx = make_persons(state.range(0));
+    state.ResumeTiming();
+    size_t before = allocations();
+    auto res = Engine::template EdgeExpandV<AppendOpt::Persist, 0>(
+        graph, std::move(ctx),
+        make_edge_expandv_opt(Direction::Out, kLink,
+                              std::array<label_id_t, 2>{kPerson, kCompany}));
+    allocs += allocations() - before;
+    benchmark::DoNotOptimize(res.GetHead().Size());
+  }
+  report(state, state.range(0), allocs);
+}
+BENCHMARK(BM_EdgeExpandVTwoLabels)->Range(1 << 8, 1 << 16);
+
+static void BM_GetV(benchmark::State& state) {
+  const auto& graph = get_graph();
+  size_t allocs = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto ctx = make_persons(state.range(0));
+    state.ResumeTiming();
+    size_t before = allocations();
+    auto res = Engine::template GetV<AppendOpt::Persist, 0>(
+        graph, std::move(ctx),
+        make_getv_opt(VOpt::Itself, std::array<label_id_t, 1>{kPerson},
+                      PropNameArray<int64_t>{"col_0"}));
+    allocs += allocations() - before;
+    benchmark::DoNotOptimize(res.GetHead().Size());
+  }
+  report(state, state.range(0), allocs);
+}
+BENCHMARK(BM_GetV)->Range(1 << 8, 1 << 18);
+
+static void BM_SelectRowVertexSet(benchmark::State& state) {
+  const auto& graph = get_graph();
+  size_t allocs = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto ctx = make_persons(state.range(0));
+    state.ResumeTiming();
+    size_t before = allocations();
+    auto res = Engine::template Select<0>(
+        graph, std::move(ctx),
+        make_filter(ValueBelow(scale / 2), PropertySelector<int64_t>("col_0")));
+    allocs += allocations() - before;
+    benchmark::DoNotOptimize(res.GetHead().Size());
+  }
+  report(state, state.range(0), allocs);
+}
+BENCHMARK(BM_SelectRowVertexSet)->Range(1 << 8, 1 << 18);
+
+static void BM_SelectTwoLabelVertexSet(benchmark::State& state) {
+  const auto& graph = get_graph();
+  size_t allocs = 0, rows = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto ctx = Engine::template EdgeExpandV<AppendOpt::Persist, 0>(
+        graph, make_persons(state.range(0)),
+        make_edge_expandv_opt(Direction::Out, kLink,
+                              std::array<label_id_t, 2>{kPerson, kCompany}));
+    rows += ctx.GetHead().Size();
+    state.ResumeTiming();
+    size_t before = allocations();
+    auto res = Engine::template Select<1>(
+        graph, std::move(ctx),
+        make_filter(ValueBelow(scale / 2), PropertySelector<int64_t>("col_0")));
+    allocs += allocations() - before;
+    benchmark::DoNotOptimize(res.GetHead().Size());
+  }
+  report(state, rows / std::max<size_t>(state.iterations(), 1), allocs);
+}
+BENCHMARK(BM_SelectTwoLabelVertexSet)->Range(1 << 8, 1 << 14);
+
+static void BM_Dedup(benchmark::State& state) {
+  size_t allocs = 0, rows = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto ctx = expand_persons(state.range(0));
+    rows += ctx.GetHead().Size();
+    state.ResumeTiming();
+    size_t before = allocations();
+    auto res = Engine::template Dedup<1>(std::move(ctx));
+    allocs += allocations() - before;
+    benchmark::DoNotOptimize(res.GetHead().Size());
+  }
+  report(state, rows / std::max<size_t>(state.iterations(), 1), allocs);
+}
+BENCHMARK(BM_Dedup)->Range(1 << 8, 1 << 14);
+
+// counts the persons knowing each neighbor, into a KeyedRowVertexSet
+static void BM_GroupByCount(benchmark::State& state) {
+  const auto& graph = get_graph();
+  size_t allocs = 0, rows = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto ctx = expand_persons(state.range(0));
+    rows += ctx.GetHead().Size();
+    state.ResumeTiming();
+    size_t before = allocations();
+    auto res = Engine::GroupBy(
+        graph, std::move(ctx),
+        std::tuple{GroupKey<1, grape::EmptyType>(
+            PropertySelector<grape::EmptyType>())},
+        std::tuple{make_aggregate_prop<AggFunc::COUNT>(
+            std::tuple{PropertySelector<grape::EmptyType>()},
+            std::integer_sequence<int32_t, 0>{})});
+    allocs += allocations() - before;
+    benchmark::DoNotOptimize(res.GetHead().Size());
+  }
+  report(state, rows / std::max<size_t>(state.iterations(), 1), allocs);
+}
+BENCHMARK(BM_GroupByCount)->Range(1 << 8, 1 << 14);
+
+// the neighbors of the largest values, the limit is the second argument
+static void BM_SortTopK(benchmark::State& state) {
+  const auto& graph = get_graph();
+  size_t allocs = 0, rows = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto ctx = expand_persons(state.range(0));
+    rows += ctx.GetHead().Size();
+    state.ResumeTiming();
+    size_t before = allocations();
+    auto res = Engine::Sort(
+        graph, std::move(ctx), Range(0, state.range(1)),
+        std::tuple{OrderingPropPair<SortOrder::DESC, 1, int64_t>("col_0")});
+    allocs += allocations() - before;
+    benchmark::DoNotOptimize(res.GetHead().Size());
+  }
+  report(state, rows / std::max<size_t>(state.iterations(), 1), allocs);
+}
+BENCHMARK(BM_SortTopK)->ArgsProduct({{1 << 8, 1 << 11, 1 << 14},
+                                     {10, 1000, INT_MAX}});
+
+// two hops from each person
+static void BM_PathExpandV(benchmark::State& state) {
+  const auto& graph = get_graph();
+  size_t allocs = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto ctx = make_persons(state.range(0));
+    state.ResumeTiming();
+    size_t before = allocations();
+    auto res = Engine::template PathExpandV<AppendOpt::Persist, 0>(
+        graph, std::move(ctx),
+        make_path_expand_opt(
+            make_edge_expandv_opt(Direction::Out, kLink, kPerson),
+            make_getv_opt(VOpt::Itself, std::array<label_id_t, 1>{kPerson}),
+            Range(1, 3)));
+    allocs += allocations() - before;
+    benchmark::DoNotOptimize(res.GetHead().Size());
+  }
+  report(state, state.range(0), allocs);
+}
+BENCHMARK(BM_PathExpandV)->Range(1 << 4, 1 << 10);
+
+// from the largest hub to persons drawn as the destinations of edges
+static void BM_ShortestPath(benchmark::State& state) {
+  const auto& graph = get_graph();
+  const auto& edges = SyntheticGraph::get().edges;
+  size_t allocs = 0, i = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto set = MakeDefaultRowVertexSet(std::vector<vertex_id_t>{0}, kPerson);
+    Context<decltype(set), 0, 0, grape::EmptyType> ctx(std::move(set));
+    int64_t dst = edges[(i++ * 7919) % edges.size()].second;
+    state.ResumeTiming();
+    size_t before = allocations();
+    auto res = Engine::template ShortestPath<AppendOpt::Persist, 0>(
+        graph, std::move(ctx),
+        make_shortest_path_opt(
+            make_edge_expandv_opt(Direction::Both, kLink, kPerson),
+            make_getv_opt(VOpt::Itself, std::array<label_id_t, 1>{kPerson}),
+            Range(0, INT_MAX),
+            make_filter(ValueEquals(dst), PropertySelector<int64_t>("col_0")),
+            PathOpt::Simple, ResultOpt::AllV));
+    allocs += allocations() - before;
+    benchmark::DoNotOptimize(res.GetHead().Size());
+  }
+  report(state, 1, allocs);
+}
+BENCHMARK(BM_ShortestPath)->Unit(benchmark::kMillisecond);
+
+static void BM_InnerJoin(benchmark::State& state) {
+  size_t allocs = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto set_x = MakeDefaultRowVertexSet(draw_persons(state.range(0), 1),
+                                         kPerson);
+    auto ctx_x = DefaultContext<decltype(set_x), -1, grape::EmptyType>(
+        std::move(set_x));
+    auto set_y = MakeDefaultRowVertexSet(draw_persons(state.range(0), 2),
+                                         kPerson);
+    auto ctx_y = DefaultContext<decltype(set_y), -1, grape::EmptyType>(
+        std::move(set_y));
+    state.ResumeTiming();
+    size_t before = allocations();
+    auto res = Engine::template Join<-1, -1, JoinKind::InnerJoin>(
+        std::move(ctx_x), std::move(ctx_y));
+    allocs += allocations() - before;
+    benchmark::DoNotOptimize(res.GetHead().Size());
+  }
+  report(state, 2 * state.range(0), allocs);
+}
+BENCHMARK(BM_InnerJoin)->Range(1 << 8, 1 << 16);
+
+}  // namespace gs
+
+int main(int argc, char** argv) {
+  int rest = 1;
+  for (int i = 1; i < argc; ++i) {
+    if (strncmp(argv[i], "--scale=", 8) == 0) {
+      gs::scale = std::stoull(argv[i] + 8);
+    } else if (strncmp(argv[i], "--skew=", 7) == 0) {
+      gs::skew = std::stod(argv[i] + 7);
+    } else {
+      argv[rest++] = argv[i];
+    }
+  }
+  argc = rest;
+  CHECK_GT(gs::scale, 0);
+  CHECK_GE(gs::skew, 1.0);
+
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
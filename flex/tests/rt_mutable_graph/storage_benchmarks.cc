@@ -0,0 +1,329 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Micro benchmarks of the storage and the transactions of graph_db, on a
+// synthetic graph of --scale vertices and 16 * --scale edges. Sources of the
+// edges are drawn as scale * u^skew for u uniform in [0, 1), so --skew=1
+// gives uniform degrees and larger values concentrate the edges on the first
+// vertices, as in power-law graphs. Other arguments go to google benchmark.
+
+#include <benchmark/benchmark.h>
+
+#include <stdlib.h>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "flex/engines/graph_db/database/graph_db.h"
+#include "flex/engines/graph_db/database/graph_db_session.h"
+#include "flex/engines/graph_db/database/wal.h"
+#include "flex/storages/rt_mutable_graph/mutable_csr.h"
+#include "flex/utils/allocators.h"
+#include "flex/utils/id_indexer.h"
+#include "flex/utils/property/column.h"
+
+#include "glog/logging.h"
+
+namespace gs {
+
+static size_t scale = 1 << 20;
+static double skew = 2.0;
+static constexpr size_t kAvgDegree = 16;
+static constexpr int kMaxThreadNum = 16;
+
+static std::string make_work_dir(const std::string& name) {
+  std::string path =
+      (std::filesystem::temp_directory_path() / ("flex_bench_XXXXXX"))
+          .string();
+  CHECK(mkdtemp(&path[0]) != nullptr) << "Failed to create " << path;
+  path += "/" + name;
+  std::filesystem::create_directory(path);
+  return path;
+}
+
+struct SyntheticGraph {
+  SyntheticGraph() {
+    std::mt19937_64 gen(0);
+    oids.resize(scale);
+    for (size_t i = 0; i < scale; ++i) {
+      // spread over the key space as real ids are
+      oids[i] = static_cast<int64_t>(i * 0x9e3779b97f4a7c15ull >> 1);
+    }
+    std::uniform_real_distribution<double> dist(0, 1);
+    std::uniform_int_distribution<vid_t> dst_dist(0, scale - 1);
+    edges.resize(scale * kAvgDegree);
+    for (auto& edge : edges) {
+      edge.first = static_cast<vid_t>(scale * std::pow(dist(gen), skew));
+      edge.second = dst_dist(gen);
+    }
+    degrees.resize(scale, 0);
+    for (auto& edge : edges) {
+      ++degrees[edge.first];
+    }
+  }
+
+  static const SyntheticGraph& get() {
+    static SyntheticGraph graph;
+    return graph;
+  }
+
+  std::vector<int64_t> oids;
+  std::vector<std::pair<vid_t, vid_t>> edges;
+  std::vector<int> degrees;
+};
+
+static const LFIndexer<vid_t>& get_indexer() {
+  static LFIndexer<vid_t>* indexer = []() {
+    auto ret = new LFIndexer<vid_t>();
+    build_lf_indexer<int64_t, vid_t>(SyntheticGraph::get().oids, *ret, scale,
+                                     1);
+    return ret;
+  }();
+  return *indexer;
+}
+
+static const MutableCsr<int64_t>& get_csr() {
+  static MutableCsr<int64_t>* csr = []() {
+    const auto& graph = SyntheticGraph::get();
+    auto ret = new MutableCsr<int64_t>();
+    ret->batch_init(scale, graph.degrees);
+    for (auto& edge : graph.edges) {
+      ret->batch_put_edge(edge.first, edge.second, edge.second);
+    }
+    return ret;
+  }();
+  return *csr;
+}
+
+static void BM_LFIndexerGetIndex(benchmark::State& state) {
+  const auto& graph = SyntheticGraph::get();
+  const auto& indexer = get_indexer();
+  size_t i = 0;
+  for (auto _ : state) {
+    // looked up by edge sources, so hot keys are hit as often as in queries
+    vid_t src = graph.edges[i++ % graph.edges.size()].first;
+    benchmark::DoNotOptimize(indexer.get_index(graph.oids[src]));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LFIndexerGetIndex);
+
+static void BM_MutableCsrPutEdge(benchmark::State& state) {
+  const auto& graph = SyntheticGraph::get();
+  ArenaAllocator alloc;
+  MutableCsr<int64_t> csr;
+  csr.batch_init(scale, std::vector<int>(scale, 0));
+  size_t i = 0;
+  for (auto _ : state) {
+    const auto& edge = graph.edges[i++ % graph.edges.size()];
+    csr.put_edge(edge.first, edge.second, edge.second, 1, alloc);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_MutableCsrPutEdge);
+
+static void BM_MutableCsrScan(benchmark::State& state) {
+  const auto& csr = get_csr();
+  for (auto _ : state) {
+    int64_t sum = 0;
+    for (vid_t v = 0; v < scale; ++v) {
+      for (auto& nbr : csr.get_edges(v)) {
+        sum += nbr.data;
+      }
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * scale * kAvgDegree);
+}
+BENCHMARK(BM_MutableCsrScan)->Unit(benchmark::kMillisecond);
+
+static void BM_MutableCsrExist(benchmark::State& state) {
+  const auto& graph = SyntheticGraph::get();
+  const auto& csr = get_csr();
+  std::mt19937_64 gen(1);
+  std::uniform_int_distribution<vid_t> dst_dist(0, scale - 1);
+  size_t i = 0;
+  for (auto _ : state) {
+    // sources of edges, so hubs are checked as often as they are expanded
+    vid_t src = graph.edges[i++ % graph.edges.size()].first;
+    benchmark::DoNotOptimize(csr.exist(src, dst_dist(gen), 0));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_MutableCsrExist);
+
+static void BM_TypedColumnSet(benchmark::State& state) {
+  TypedColumn<int64_t> column(StorageStrategy::kMem);
+  column.init(scale);
+  size_t i = 0;
+  for (auto _ : state) {
+    column.set_value(i % scale, i);
+    ++i;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_TypedColumnSet);
+
+static void BM_TypedColumnGet(benchmark::State& state) {
+  const auto& graph = SyntheticGraph::get();
+  TypedColumn<int64_t> column(StorageStrategy::kMem);
+  column.init(scale);
+  for (size_t i = 0; i < scale; ++i) {
+    column.set_value(i, i);
+  }
+  size_t i = 0;
+  for (auto _ : state) {
+    vid_t v = graph.edges[i++ % graph.edges.size()].second;
+    benchmark::DoNotOptimize(column.get_view(v));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_TypedColumnGet);
+
+static void BM_WalWriterAppend(benchmark::State& state) {
+  std::string dir = make_work_dir("wal");
+  std::vector<char> record(state.range(0), 'x');
+  {
+    WalWriter writer;
+    writer.open(dir, 0);
+    for (auto _ : state) {
+      writer.append(record.data(), record.size());
+    }
+    writer.close();
+  }
+  std::filesystem::remove_all(std::filesystem::path(dir).parent_path());
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_WalWriterAppend)->Range(64, 64 << 10);
+
+// A graph db of the synthetic vertices, with sessions for up to
+// kMaxThreadNum benchmark threads.
+static GraphDB& get_db() {
+  // benchmark threads start at once, the first one initializes
+  static GraphDB& db = []() -> GraphDB& {
+    auto& db = GraphDB::get();
+    Schema schema;
+    schema.add_vertex_label("person", {PropertyType::kInt64}, {},
+                            scale * 2);
+    schema.add_edge_label("person", "person", "knows",
+                          {PropertyType::kInt64});
+    db.Init(schema, {}, {}, {}, make_work_dir("db"), kMaxThreadNum);
+
+    const auto& graph = SyntheticGraph::get();
+    auto txn = db.GetSession(0).GetInsertTransaction();
+    for (size_t i = 0; i < scale; ++i) {
+      txn.AddVertex(0, graph.oids[i], {Any::From<int64_t>(i)});
+    }
+    txn.Commit();
+    return db;
+  }();
+  return db;
+}
+
+static void BM_InsertTransactionCommit(benchmark::State& state) {
+  const auto& graph = SyntheticGraph::get();
+  auto& session = get_db().GetSession(state.thread_index());
+  size_t i = state.thread_index();
+  for (auto _ : state) {
+    const auto& edge = graph.edges[i % graph.edges.size()];
+    i += state.threads();
+    auto txn = session.GetInsertTransaction();
+    txn.AddEdge(0, graph.oids[edge.first], 0, graph.oids[edge.second], 0,
+                Any::From<int64_t>(i));
+    txn.Commit();
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_InsertTransactionCommit)
+    ->ThreadRange(1, kMaxThreadNum)
+    ->UseRealTime();
+
+static void BM_UpdateTransactionCommit(benchmark::State& state) {
+  const auto& graph = SyntheticGraph::get();
+  auto& session = get_db().GetSession(state.thread_index());
+  size_t i = state.thread_index();
+  for (auto _ : state) {
+    // vertices were inserted in order, so lids are the indices of the oids
+    vid_t v = graph.edges[i % graph.edges.size()].first;
+    i += state.threads();
+    auto txn = session.GetUpdateTransaction();
+    txn.SetVertexField(0, v, 0, Any::From<int64_t>(i));
+    txn.Commit();
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_UpdateTransactionCommit)
+    ->ThreadRange(1, kMaxThreadNum)
+    ->UseRealTime();
+
+static void BM_UpdateTransactionAddEdges(benchmark::State& state) {
+  const auto& graph = SyntheticGraph::get();
+  auto& session = get_db().GetSession(0);
+  size_t i = 0;
+  for (auto _ : state) {
+    auto txn = session.GetUpdateTransaction();
+    for (int64_t k = 0; k < state.range(0); ++k) {
+      const auto& edge = graph.edges[i % graph.edges.size()];
+      ++i;
+      txn.AddEdge(0, graph.oids[edge.first], 0, graph.oids[edge.second], 0,
+                  Any::From<int64_t>(i));
+    }
+    txn.Commit();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_UpdateTransactionAddEdges)->Range(1, 1 << 16);
+
+static void BM_ReadTransactionAcquire(benchmark::State& state) {
+  auto& session = get_db().GetSession(state.thread_index());
+  for (auto _ : state) {
+    auto txn = session.GetReadTransaction();
+    benchmark::DoNotOptimize(txn.timestamp());
+    txn.Commit();
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ReadTransactionAcquire)
+    ->ThreadRange(1, kMaxThreadNum)
+    ->UseRealTime();
+
+}  // namespace gs
+
+int main(int argc, char** argv) {
+  int rest = 1;
+  for (int i = 1; i < argc; ++i) {
+    if (strncmp(argv[i], "--scale=", 8) == 0) {
+      gs::scale = std::stoull(argv[i] + 8);
+    } else if (strncmp(argv[i], "--skew=", 7) == 0) {
+      gs::skew = std::stod(argv[i] + 7);
+    } else {
+      argv[rest++] = argv[i];
+    }
+  }
+  argc = rest;
+  CHECK_GT(gs::scale, 0);
+  CHECK_GE(gs::skew, 1.0);
+
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
@@ -18,20 +18,119 @@
 
 #include <stdlib.h>
 
-#include <vector>
+#include <atomic>
+#include <chrono>
+#include <deque>
 #include <functional>
+#include <thread>
+#include <tuple>
+#include <vector>
 
 namespace gs {
 
+/**
+ * @brief Epoch based reclamation of shared buffers.
+ *
+ * Readers stay in an epoch while they may refer to shared buffers. The global
+ * epoch only advances when no reader is left in the epoch before the current
+ * one, so a buffer retired at epoch e is unreachable by any reader once the
+ * global epoch reaches e + 2.
+ */
+class EpochManager {
+ public:
+  EpochManager() : epoch_(0) {
+    for (auto& active : active_) {
+      active.store(0);
+    }
+  }
+
+  uint64_t enter() {
+    while (true) {
+      uint64_t epoch = epoch_.load();
+      active_[epoch % 3].fetch_add(1);
+      if (epoch_.load() == epoch) {
+        return epoch;
+      }
+      active_[epoch % 3].fetch_sub(1);
+    }
+  }
+
+  void exit(uint64_t epoch) { active_[epoch % 3].fetch_sub(1); }
+
+  uint64_t current() const { return epoch_.load(); }
+
+  bool try_advance() {
+    uint64_t epoch = epoch_.load();
+    if (active_[(epoch + 2) % 3].load() != 0) {
+      return false;
+    }
+    return epoch_.compare_exchange_strong(epoch, epoch + 1);
+  }
+
+  bool safe_to_reuse(uint64_t retired_epoch) const {
+    return epoch_.load() >= retired_epoch + 2;
+  }
+
+  /** @brief Wait until no reader can refer to buffers retired so far. */
+  void synchronize() {
+    uint64_t target = epoch_.load() + 2;
+    while (epoch_.load() < target) {
+      if (!try_advance()) {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+      }
+    }
+  }
+
+ private:
+  std::atomic<uint64_t> epoch_;
+  std::atomic<int64_t> active_[3];
+};
+
+/**
+ * @brief Per-session allocator for adjacency lists.
+ *
+ * Memory is carved from 4096-byte aligned batches in power-of-two size
+ * classes. With an epoch manager set, buffers given back by deallocate are
+ * reused for the same size class once no reader can refer to them anymore.
+ * Without one, deallocate is a no-op and memory is only freed by reset.
+ */
 class ArenaAllocator {
   static constexpr size_t batch_size = 4096;
+  static constexpr size_t min_size_class = 4;
+  static constexpr size_t size_class_num = 64;
+  static constexpr size_t reclaim_batch = 64;
+
+  struct RetiredBuffer {
+    void* ptr;
+    size_t size_class;
+    uint64_t epoch;
+  };
 
  public:
-  ArenaAllocator() : cur_buffer_(nullptr), cur_loc_(0), cur_size_(0) {}
-  ~ArenaAllocator() {
+  ArenaAllocator()
+      : cur_buffer_(nullptr),
+        cur_loc_(0),
+        cur_size_(0),
+        allocated_bytes_(0),
+        epoch_manager_(nullptr),
+        free_lists_(size_class_num) {}
+  ~ArenaAllocator() { reset(); }
+
+  void set_epoch_manager(EpochManager* epoch_manager) {
+    epoch_manager_ = epoch_manager;
+  }
+
+  /**
+   * @brief Free all memory given by this allocator at once, the caller must
+   * make sure none of it is referenced anymore.
+   */
+  void reset() {
     if (cur_buffer_ != nullptr) {
       free(cur_buffer_);
     }
+    cur_buffer_ = nullptr;
+    cur_loc_ = 0;
+    cur_size_ = 0;
     for (auto ptr : buffers_) {
       if (ptr != nullptr) {
         free(ptr);
@@ -51,38 +150,118 @@ class ArenaAllocator {
 
       free(data);
     }
+    buffers_.clear();
+    typed_allocations_.clear();
+    for (auto& list : free_lists_) {
+      list.clear();
+    }
+    retired_.clear();
+    allocated_bytes_ = 0;
   }
 
+  /**
+   * @brief Move the memory held by this allocator to rhs, leaving this one
+   * empty. The epoch managers are kept.
+   */
+  void swap(ArenaAllocator& rhs) {
+    std::swap(buffers_, rhs.buffers_);
+    std::swap(cur_buffer_, rhs.cur_buffer_);
+    std::swap(cur_loc_, rhs.cur_loc_);
+    std::swap(cur_size_, rhs.cur_size_);
+    std::swap(allocated_bytes_, rhs.allocated_bytes_);
+    std::swap(free_lists_, rhs.free_lists_);
+    std::swap(retired_, rhs.retired_);
+    std::swap(typed_allocations_, rhs.typed_allocations_);
+  }
+
+  /** @brief Bytes of memory held by this allocator. */
+  size_t allocated_bytes() const { return allocated_bytes_; }
+
   void reserve(size_t cap) {
     if (cur_size_ - cur_loc_ >= cap) {
       return;
     }
     buffers_.push_back(cur_buffer_);
-    cap = (cap + batch_size - 1) ^ (batch_size - 1);
+    cap = (cap + batch_size - 1) & ~(batch_size - 1);
     cur_buffer_ = malloc(cap);
     cur_loc_ = 0;
     cur_size_ = cap;
+    allocated_bytes_ += cap;
   }
 
   void* allocate(size_t size) {
+    size_t size_class = get_size_class(size);
+    auto& free_list = free_lists_[size_class];
+    if (free_list.empty() && !retired_.empty()) {
+      reclaim();
+    }
+    if (!free_list.empty()) {
+      void* ret = free_list.back();
+      free_list.pop_back();
+      return ret;
+    }
+    size = static_cast<size_t>(1) << size_class;
     reserve(size);
-    void* ret = (char*) cur_buffer_ + cur_loc_;
+    void* ret = static_cast<char*>(cur_buffer_) + cur_loc_;
     cur_loc_ += size;
     return ret;
   }
 
+  /**
+   * @brief Give back a buffer of size bytes got from allocate, possibly by
+   * another session sharing the same epoch manager. It is reused only after
+   * every reader that might refer to it has left its epoch.
+   */
+  void deallocate(void* ptr, size_t size) {
+    if (epoch_manager_ == nullptr) {
+      return;
+    }
+    retired_.push_back({ptr, get_size_class(size), epoch_manager_->current()});
+    if (retired_.size() >= reclaim_batch) {
+      reclaim();
+    }
+  }
+
   void* allocate_typed(size_t span, size_t num,
                        const std::function<void(void*)>& dtor) {
     void* data = malloc(span * num);
+    allocated_bytes_ += span * num;
     typed_allocations_.emplace_back(data, span, num, dtor);
     return data;
   }
 
  private:
+  static size_t get_size_class(size_t size) {
+    size_t size_class = min_size_class;
+    while ((static_cast<size_t>(1) << size_class) < size) {
+      ++size_class;
+    }
+    return size_class;
+  }
+
+  void reclaim() {
+    if (epoch_manager_ == nullptr) {
+      return;
+    }
+    epoch_manager_->try_advance();
+    // buffers are retired in epoch order
+    while (!retired_.empty() &&
+           epoch_manager_->safe_to_reuse(retired_.front().epoch)) {
+      auto& buffer = retired_.front();
+      free_lists_[buffer.size_class].push_back(buffer.ptr);
+      retired_.pop_front();
+    }
+  }
+
   std::vector<void*> buffers_;
   void* cur_buffer_;
   size_t cur_loc_;
   size_t cur_size_;
+  size_t allocated_bytes_;
+
+  EpochManager* epoch_manager_;
+  std::vector<std::vector<void*>> free_lists_;
+  std::deque<RetiredBuffer> retired_;
 
   std::vector<std::tuple<void*, size_t, size_t, std::function<void(void*)>>>
       typed_allocations_;
@@ -21,6 +21,7 @@ limitations under the License.
 #include <cmath>
 #include <memory>
 #include <string_view>
+#include <thread>
 #include <type_traits>
 #include <vector>
 
@@ -154,89 +155,245 @@ struct GHash<int64_t> {
   }
 };
 
+/**
+ * @brief Key made of N int64 parts, for composite primary keys.
+ */
+template <size_t N>
+struct CompositeKey {
+  int64_t parts[N];
+
+  bool operator==(const CompositeKey& rhs) const {
+    for (size_t i = 0; i < N; ++i) {
+      if (parts[i] != rhs.parts[i]) {
+        return false;
+      }
+    }
+    return true;
+  }
+  bool operator!=(const CompositeKey& rhs) const { return !(*this == rhs); }
+};
+
+template <size_t N>
+struct GHash<CompositeKey<N>> {
+  size_t operator()(const CompositeKey<N>& val) const {
+    size_t ret = 0;
+    for (size_t i = 0; i < N; ++i) {
+      ret = GHash<int64_t>()(ret ^ val.parts[i]);
+    }
+    return ret;
+  }
+};
+
 template <typename KEY_T, typename INDEX_T>
 class IdIndexer;
 
-template <typename INDEX_T>
+template <typename INDEX_T, typename KEY_T = int64_t>
 class LFIndexer;
 
-template <class INDEX_T>
-void build_lf_indexer(const IdIndexer<int64_t, INDEX_T>& input,
-                      LFIndexer<INDEX_T>& output, double rate = 0.8);
+template <typename KEY_T, typename INDEX_T>
+void build_lf_indexer(const IdIndexer<KEY_T, INDEX_T>& input,
+                      LFIndexer<INDEX_T, KEY_T>& output, double rate = 0.8);
 
-template <typename INDEX_T>
+template <typename KEY_T, typename INDEX_T>
+void build_lf_indexer(const std::vector<KEY_T>& keys,
+                      LFIndexer<INDEX_T, KEY_T>& output, size_t max_num,
+                      int thread_num);
+
+/**
+ * @brief Lock-free mapping from keys to consecutive indices.
+ *
+ * Keys are put into open-addressing slot tables. When the slots of the
+ * tables run out, a table holding as many keys as all tables before it is
+ * added and later keys go there, so lookups never wait for a table to be
+ * rehashed. The tables are merged into one when serialized.
+ *
+ * Keys are int64 by default. String keys are kept in the string pool of
+ * mmap_array<std::string_view> and looked up by std::string_view without
+ * copies, and small trivially copyable keys like CompositeKey are kept in
+ * place. Snapshots of all of them are mapped without copies.
+ */
+template <typename INDEX_T, typename KEY_T>
 class LFIndexer {
+  static constexpr INDEX_T sentinel = std::numeric_limits<INDEX_T>::max();
+  static constexpr size_t max_table_num = 48;
+
+  struct SlotTable {
+    explicit SlotTable(size_t cap) : capacity(cap), size(0) {
+      size_t num_slots = std::ceil(static_cast<double>(cap) /
+                                   id_indexer_impl::max_load_factor);
+      hash_policy.set_mod_function_by_index(
+          hash_policy.next_size_over(num_slots));
+      num_slots_minus_one = num_slots - 1;
+      indices.resize_fill(num_slots, sentinel);
+    }
+
+    mmap_array<INDEX_T> indices;
+    size_t num_slots_minus_one;
+    ska::ska::prime_number_hash_policy hash_policy;
+    size_t capacity;
+    std::atomic<size_t> size;
+  };
+
  public:
-  LFIndexer() : num_elements_(0), hasher_() {}
+  LFIndexer()
+      : num_elements_(0),
+        slot_num_(0),
+        slot_capacity_(0),
+        hasher_(),
+        table_num_(0) {
+    for (auto& table : tables_) {
+      table.store(nullptr);
+    }
+  }
+  /** @brief Only indexers without added slot tables can be copied. */
   LFIndexer(const LFIndexer& rhs)
       : keys_(rhs.keys_),
         indices_(rhs.indices_),
         num_elements_(rhs.num_elements_.load()),
         num_slots_minus_one_(rhs.num_slots_minus_one_),
-        hasher_(rhs.hasher_) {
+        slot_num_(rhs.slot_num_.load()),
+        slot_capacity_(rhs.slot_capacity_),
+        hasher_(rhs.hasher_),
+        table_num_(0) {
+    CHECK_EQ(rhs.table_num_.load(), 0);
     hash_policy_.set_mod_function_by_index(
         rhs.hash_policy_.get_mod_function_index());
+    for (auto& table : tables_) {
+      table.store(nullptr);
+    }
   }
+  ~LFIndexer() { clear_tables(); }
 
   size_t size() const { return num_elements_.load(); }
 
-  INDEX_T insert(int64_t oid) {
-    INDEX_T ind = static_cast<INDEX_T>(num_elements_.fetch_add(1));
-    keys_[ind] = oid;
-    size_t index =
-        hash_policy_.index_for_hash(hasher_(oid), num_slots_minus_one_);
-    static constexpr INDEX_T sentinel = std::numeric_limits<INDEX_T>::max();
-    while (true) {
-      if (__sync_bool_compare_and_swap(&indices_[index], sentinel, ind)) {
-        break;
+  /** @brief Bytes of the keys and of all slot tables. */
+  size_t memory_usage() const {
+    size_t bytes = keys_.memory_usage() + indices_.memory_usage();
+    size_t table_num = std::min(table_num_.load(), max_table_num);
+    for (size_t i = 0; i < table_num; ++i) {
+      const SlotTable* table = tables_[i].load();
+      if (table != nullptr) {
+        bytes += table->indices.memory_usage();
       }
-      index = (index + 1) % num_slots_minus_one_;
     }
-    return ind;
+    return bytes;
   }
 
-  INDEX_T get_index(int64_t oid) const {
-    size_t index =
-        hash_policy_.index_for_hash(hasher_(oid), num_slots_minus_one_);
-    static constexpr INDEX_T sentinel = std::numeric_limits<INDEX_T>::max();
+  INDEX_T insert(const KEY_T& oid) {
+    INDEX_T ind = static_cast<INDEX_T>(num_elements_.fetch_add(1));
+    CHECK_LT(ind, keys_.size()) << "vertex number exceeds max_vertex_num";
+    keys_.insert(ind, oid);
+    size_t hash = hasher_(oid);
+    if (slot_num_.load() < slot_capacity_ &&
+        slot_num_.fetch_add(1) < slot_capacity_) {
+      put_slot(indices_, hash_policy_, num_slots_minus_one_, hash, ind);
+      return ind;
+    }
     while (true) {
-      INDEX_T ind = indices_[index];
-      if (ind == sentinel) {
-        LOG(FATAL) << "cannot find " << oid << " in id_indexer";
-      } else if (keys_[ind] == oid) {
-        return ind;
-      } else {
-        index = (index + 1) % indices_size_;
+      size_t table_num = table_num_.load();
+      if (table_num > 0) {
+        SlotTable* table = tables_[table_num - 1].load();
+        if (table->size.load() < table->capacity &&
+            table->size.fetch_add(1) < table->capacity) {
+          put_slot(table->indices, table->hash_policy,
+                   table->num_slots_minus_one, hash, ind);
+          return ind;
+        }
       }
+      add_table(table_num);
     }
   }
 
-  bool get_index(int64_t oid, INDEX_T& ret) const {
-    size_t index =
-        hash_policy_.index_for_hash(hasher_(oid), num_slots_minus_one_);
-    static constexpr INDEX_T sentinel = std::numeric_limits<INDEX_T>::max();
-    while (true) {
-      INDEX_T ind = indices_[index];
-      if (ind == sentinel) {
-        return false;
-      } else if (keys_[ind] == oid) {
-        ret = ind;
-        return true;
-      } else {
-        index = (index + 1) % num_slots_minus_one_;
+  INDEX_T get_index(const KEY_T& oid) const {
+    INDEX_T ind;
+    if (!get_index(oid, ind)) {
+      LOG(FATAL) << "cannot find " << oid << " in id_indexer";
+    }
+    return ind;
+  }
+
+  bool get_index(const KEY_T& oid, INDEX_T& ret) const {
+    size_t hash = hasher_(oid);
+    size_t index = hash_policy_.index_for_hash(hash, num_slots_minus_one_);
+    return find_slot(indices_, num_slots_minus_one_, index, oid, ret) ||
+           find_in_tables(oid, hash, ret);
+  }
+
+  /**
+   * @brief Look up num keys at once, ret[i] is set to the max value of
+   * INDEX_T if oids[i] is not found. While probing a key, the slot of a key
+   * batch_distance later and the key referred to by the slot of a key
+   * batch_distance / 2 later are prefetched, so cache misses of consecutive
+   * lookups overlap.
+   *
+   * @return The number of keys found.
+   */
+  size_t get_index(const KEY_T* oids, size_t num, INDEX_T* ret) const {
+    static constexpr size_t batch_distance = 16;
+    static constexpr size_t half_distance = batch_distance / 2;
+    size_t indices[batch_distance];
+    size_t found = 0;
+    for (size_t i = 0; i < num + batch_distance; ++i) {
+      if (i >= batch_distance) {
+        size_t k = i - batch_distance;
+        if (find_slot(indices_, num_slots_minus_one_,
+                      indices[k % batch_distance], oids[k], ret[k]) ||
+            find_in_tables(oids[k], hasher_(oids[k]), ret[k])) {
+          ++found;
+        } else {
+          ret[k] = sentinel;
+        }
+      }
+      if (i < num) {
+        size_t index =
+            hash_policy_.index_for_hash(hasher_(oids[i]), num_slots_minus_one_);
+        indices[i % batch_distance] = index;
+        __builtin_prefetch(&indices_[index]);
+      }
+      if (i >= half_distance && i - half_distance < num) {
+        INDEX_T ind = indices_[indices[(i - half_distance) % batch_distance]];
+        if constexpr (!std::is_same<KEY_T, std::string_view>::value) {
+          if (ind != sentinel) {
+            __builtin_prefetch(keys_.data() + ind);
+          }
+        }
       }
     }
-    return false;
+    return found;
   }
 
-  int64_t get_key(const INDEX_T& index) const { return keys_[index]; }
+  KEY_T get_key(const INDEX_T& index) const { return keys_[index]; }
 
   void Serialize(const std::string& prefix) {
+    Serialize(prefix, num_elements_.load());
+  }
+
+  /**
+   * @brief Serialize the first num elements only, while other threads may
+   * still be inserting. The hash slots are rebuilt from the kept keys into a
+   * single table, so slots taken by later insertions never leak into the
+   * snapshot.
+   */
+  void Serialize(const std::string& prefix, size_t num) {
+    size_t indices_size = std::max(
+        indices_.size(),
+        static_cast<size_t>(std::ceil(num / id_indexer_impl::max_load_factor)));
+    ska::ska::prime_number_hash_policy hash_policy;
+    if (indices_size == indices_.size()) {
+      hash_policy.set_mod_function_by_index(
+          hash_policy_.get_mod_function_index());
+    } else {
+      hash_policy.set_mod_function_by_index(
+          hash_policy.next_size_over(indices_size));
+    }
+    size_t num_slots_minus_one =
+        indices_size == indices_.size() ? num_slots_minus_one_
+                                        : indices_size - 1;
     {
       grape::InArchive arc;
-      arc << keys_.size() << indices_.size();
-      arc << hash_policy_.get_mod_function_index() << num_elements_.load()
-          << num_slots_minus_one_ << indices_size_;
+      arc << keys_.size() << indices_size;
+      arc << hash_policy.get_mod_function_index() << num << num_slots_minus_one
+          << indices_size;
       std::string meta_file_path = prefix + ".meta";
       FILE* fout = fopen(meta_file_path.c_str(), "wb");
       fwrite(arc.GetBuffer(), sizeof(char), arc.GetSize(), fout);
@@ -245,10 +402,24 @@ class LFIndexer {
     }
 
     if (keys_.size() > 0) {
-      keys_.dump_to_file(prefix + ".keys");
+      keys_.dump_to_file(prefix + ".keys", num);
     }
-    if (indices_.size() > 0) {
-      indices_.dump_to_file(prefix + ".indices");
+    if (indices_size > 0) {
+      std::vector<INDEX_T> indices(indices_size, sentinel);
+      for (size_t i = 0; i < num; ++i) {
+        size_t index = hash_policy.index_for_hash(hasher_(keys_[i]),
+                                                  num_slots_minus_one);
+        while (indices[index] != sentinel) {
+          index = (index + 1) % num_slots_minus_one;
+        }
+        indices[index] = static_cast<INDEX_T>(i);
+      }
+      std::string indices_file_path = prefix + ".indices";
+      FILE* fout = fopen(indices_file_path.c_str(), "wb");
+      CHECK_EQ(fwrite(indices.data(), sizeof(INDEX_T), indices.size(), fout),
+               indices.size());
+      fflush(fout);
+      fclose(fout);
     }
   }
 
@@ -270,29 +441,111 @@ class LFIndexer {
       arc >> mod_function_index >> num_elements >> num_slots_minus_one_ >>
           indices_size_;
     }
+    clear_tables();
     keys_.open_for_read(prefix + ".keys");
     CHECK_EQ(keys_.size(), keys_size);
     indices_.open_for_read(prefix + ".indices");
     CHECK_EQ(indices_.size(), indices_size);
     hash_policy_.set_mod_function_by_index(mod_function_index);
     num_elements_.store(num_elements);
+    init_slot_capacity();
   }
 
   // get keys
-  const mmap_array<int64_t>& get_keys() const { return keys_; }
+  const mmap_array<KEY_T>& get_keys() const { return keys_; }
 
  private:
-  mmap_array<int64_t> keys_;
+  static void put_slot(mmap_array<INDEX_T>& indices,
+                       const ska::ska::prime_number_hash_policy& hash_policy,
+                       size_t num_slots_minus_one, size_t hash, INDEX_T ind) {
+    size_t index = hash_policy.index_for_hash(hash, num_slots_minus_one);
+    while (!__sync_bool_compare_and_swap(&indices[index], sentinel, ind)) {
+      index = (index + 1) % num_slots_minus_one;
+    }
+  }
+
+  bool find_slot(const mmap_array<INDEX_T>& indices,
+                 size_t num_slots_minus_one, size_t index, const KEY_T& oid,
+                 INDEX_T& ret) const {
+    while (true) {
+      INDEX_T ind = indices[index];
+      if (ind == sentinel) {
+        return false;
+      } else if (keys_[ind] == oid) {
+        ret = ind;
+        return true;
+      }
+      index = (index + 1) % num_slots_minus_one;
+    }
+  }
+
+  bool find_in_tables(const KEY_T& oid, size_t hash, INDEX_T& ret) const {
+    size_t table_num = table_num_.load();
+    for (size_t i = 0; i < table_num; ++i) {
+      const SlotTable* table = tables_[i].load();
+      size_t index =
+          table->hash_policy.index_for_hash(hash, table->num_slots_minus_one);
+      if (find_slot(table->indices, table->num_slots_minus_one, index, oid,
+                    ret)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Add the table_num-th added table, unless another thread did.
+  void add_table(size_t table_num) {
+    CHECK_LT(table_num, max_table_num);
+    if (tables_[table_num].load() == nullptr) {
+      size_t capacity = slot_capacity_;
+      for (size_t i = 0; i < table_num; ++i) {
+        capacity += tables_[i].load()->capacity;
+      }
+      SlotTable* table = new SlotTable(capacity);
+      SlotTable* expected = nullptr;
+      if (!tables_[table_num].compare_exchange_strong(expected, table)) {
+        delete table;
+      }
+    }
+    table_num_.compare_exchange_strong(table_num, table_num + 1);
+  }
+
+  void clear_tables() {
+    for (auto& table : tables_) {
+      delete table.load();
+      table.store(nullptr);
+    }
+    table_num_.store(0);
+  }
+
+  void init_slot_capacity() {
+    slot_num_.store(num_elements_.load());
+    size_t capacity = indices_.size() * id_indexer_impl::max_load_factor;
+    slot_capacity_ = std::max(num_elements_.load(), capacity);
+  }
+
+  mmap_array<KEY_T> keys_;
   mmap_array<INDEX_T> indices_;
   std::atomic<size_t> num_elements_;
   size_t num_slots_minus_one_;
   size_t indices_size_;
   ska::ska::prime_number_hash_policy hash_policy_;
-  GHash<int64_t> hasher_;
+  std::atomic<size_t> slot_num_;
+  size_t slot_capacity_;
+  GHash<KEY_T> hasher_;
+
+  std::atomic<SlotTable*> tables_[max_table_num];
+  std::atomic<size_t> table_num_;
 
-  template <typename _INDEX_T>
-  friend void build_lf_indexer(const IdIndexer<int64_t, _INDEX_T>& input,
-                               LFIndexer<_INDEX_T>& output, double rate);
+  template <typename _KEY_T, typename _INDEX_T>
+  friend void build_lf_indexer(const IdIndexer<_KEY_T, _INDEX_T>& input,
+                               LFIndexer<_INDEX_T, _KEY_T>& output,
+                               double rate);
+
+  template <typename _KEY_T, typename _INDEX_T>
+  friend void build_lf_indexer(const std::vector<_KEY_T>& keys,
+                               LFIndexer<_INDEX_T, _KEY_T>& output,
+                               size_t max_num, int thread_num);
 };
 
 template <typename KEY_T, typename INDEX_T>
@@ -663,14 +916,15 @@ class IdIndexer {
   // std::hash<KEY_T> hasher_;
   GHash<KEY_T> hasher_;
 
-  template <typename _INDEX_T>
-  friend void build_lf_indexer(const IdIndexer<int64_t, _INDEX_T>& input,
-                               LFIndexer<_INDEX_T>& output, double rate);
+  template <typename _KEY_T, typename _INDEX_T>
+  friend void build_lf_indexer(const IdIndexer<_KEY_T, _INDEX_T>& input,
+                               LFIndexer<_INDEX_T, _KEY_T>& output,
+                               double rate);
 };
 
-template <class INDEX_T>
-void build_lf_indexer(const IdIndexer<int64_t, INDEX_T>& input,
-                      LFIndexer<INDEX_T>& lf, double rate) {
+template <typename KEY_T, typename INDEX_T>
+void build_lf_indexer(const IdIndexer<KEY_T, INDEX_T>& input,
+                      LFIndexer<INDEX_T, KEY_T>& lf, double rate) {
   double indices_rate = static_cast<double>(input.keys_.size()) /
                         static_cast<double>(input.indices_.size());
   CHECK_LT(indices_rate, rate);
@@ -680,7 +934,9 @@ void build_lf_indexer(const IdIndexer<int64_t, INDEX_T>& input,
   lf_size = std::max(lf_size, static_cast<size_t>(1024));
 
   lf.keys_.resize(lf_size);
-  memcpy(lf.keys_.data(), input.keys_.data(), sizeof(int64_t) * size);
+  for (size_t i = 0; i < size; ++i) {
+    lf.keys_.insert(i, input.keys_[i]);
+  }
 
   lf.num_elements_.store(size);
 
@@ -692,8 +948,11 @@ void build_lf_indexer(const IdIndexer<int64_t, INDEX_T>& input,
   lf.hash_policy_.set_mod_function_by_index(
       input.hash_policy_.get_mod_function_index());
   lf.num_slots_minus_one_ = input.num_slots_minus_one_;
+  lf.clear_tables();
+  lf.init_slot_capacity();
 
-  for (auto oid : input.keys_) {
+  for (size_t i = 0; i < size; ++i) {
+    KEY_T oid = input.keys_[i];
     size_t index = input.hash_policy_.index_for_hash(
         input.hasher_(oid), input.num_slots_minus_one_);
     for (int8_t distance = 0; input.distances_[index] >= distance;
@@ -707,6 +966,58 @@ void build_lf_indexer(const IdIndexer<int64_t, INDEX_T>& input,
   }
 }
 
+/**
+ * @brief Build lf from distinct keys, the i-th key gets index i and up to
+ * max_num keys can be held. The hash slots are filled by thread_num threads.
+ */
+template <typename KEY_T, typename INDEX_T>
+void build_lf_indexer(const std::vector<KEY_T>& keys,
+                      LFIndexer<INDEX_T, KEY_T>& lf, size_t max_num,
+                      int thread_num) {
+  size_t size = keys.size();
+  // keys are mmap-ed without reserving memory, like the columns of vertex
+  // properties sized by max_vnum
+  lf.keys_.resize(std::max(size, max_num));
+  lf.num_elements_.store(size);
+  lf.clear_tables();
+
+  size_t num_slots = std::max(
+      static_cast<size_t>(std::ceil(size / id_indexer_impl::max_load_factor)),
+      static_cast<size_t>(1024));
+  lf.hash_policy_.set_mod_function_by_index(
+      lf.hash_policy_.next_size_over(num_slots));
+  lf.num_slots_minus_one_ = num_slots - 1;
+  lf.indices_.clear();
+  lf.indices_.resize_fill(num_slots, std::numeric_limits<INDEX_T>::max());
+  lf.indices_size_ = num_slots;
+  lf.init_slot_capacity();
+
+  static constexpr size_t batch = 4096;
+  std::atomic<size_t> offset(0);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < thread_num; ++i) {
+    threads.emplace_back([&]() {
+      while (true) {
+        size_t begin = offset.fetch_add(batch);
+        if (begin >= size) {
+          break;
+        }
+        size_t end = std::min(begin + batch, size);
+        for (size_t k = begin; k < end; ++k) {
+          INDEX_T ind = static_cast<INDEX_T>(k);
+          lf.keys_.insert(ind, keys[k]);
+          LFIndexer<INDEX_T, KEY_T>::put_slot(lf.indices_, lf.hash_policy_,
+                                              lf.num_slots_minus_one_,
+                                              lf.hasher_(keys[k]), ind);
+        }
+      }
+    });
+  }
+  for (auto& thrd : threads) {
+    thrd.join();
+  }
+}
+
 }  // namespace gs
 
 #endif  // GRAPHSCOPE_GRAPH_ID_INDEXER_H_
@@ -0,0 +1,147 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "flex/utils/metrics.h"
+
+#include <sstream>
+
+#include "glog/logging.h"
+
+namespace gs {
+
+size_t metrics_slot() {
+  static std::atomic<size_t> next_slot{0};
+  thread_local size_t slot = next_slot.fetch_add(1) % kMetricsSlotNum;
+  return slot;
+}
+
+uint64_t Counter::Value() const {
+  uint64_t ret = 0;
+  for (auto& slot : slots_) {
+    ret += slot.value.load(std::memory_order_relaxed);
+  }
+  return ret;
+}
+
+void Histogram::Collect(std::vector<uint64_t>& buckets, uint64_t& sum) const {
+  buckets.assign(kBucketNum + 1, 0);
+  sum = 0;
+  for (auto& slot : slots_) {
+    for (size_t i = 0; i <= kBucketNum; ++i) {
+      buckets[i] += slot.buckets[i].load(std::memory_order_relaxed);
+    }
+    sum += slot.sum.load(std::memory_order_relaxed);
+  }
+}
+
+MetricsRegistry& MetricsRegistry::get() {
+  static MetricsRegistry instance;
+  return instance;
+}
+
+MetricsRegistry::Family& MetricsRegistry::getFamily(const std::string& name,
+                                                    const std::string& help,
+                                                    const char* type) {
+  auto& family = families_[name];
+  if (family.type.empty()) {
+    family.help = help;
+    family.type = type;
+  } else if (family.type != type) {
+    LOG(FATAL) << "Metric " << name << " is a " << family.type << ", not a "
+               << type;
+  }
+  return family;
+}
+
+Counter& MetricsRegistry::GetCounter(const std::string& name,
+                                     const std::string& help,
+                                     const std::string& labels) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto& ptr = getFamily(name, help, "counter").counters[labels];
+  if (ptr == nullptr) {
+    ptr = std::make_unique<Counter>();
+  }
+  return *ptr;
+}
+
+Histogram& MetricsRegistry::GetHistogram(const std::string& name,
+                                         const std::string& help,
+                                         const std::string& labels) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto& ptr = getFamily(name, help, "histogram").histograms[labels];
+  if (ptr == nullptr) {
+    ptr = std::make_unique<Histogram>();
+  }
+  return *ptr;
+}
+
+void MetricsRegistry::SetGauge(const std::string& name, const std::string& help,
+                               const std::string& labels,
+                               std::function<double()> callback) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  getFamily(name, help, "gauge").gauges[labels] = std::move(callback);
+}
+
+static std::string with_labels(const std::string& name,
+                               const std::string& labels,
+                               const std::string& extra = "") {
+  if (labels.empty() && extra.empty()) {
+    return name;
+  }
+  std::string ret = name + "{" + labels;
+  if (!labels.empty() && !extra.empty()) {
+    ret += ",";
+  }
+  return ret + extra + "}";
+}
+
+std::string MetricsRegistry::Dump() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  std::stringstream ss;
+  std::vector<uint64_t> buckets;
+  for (auto& pair : families_) {
+    const auto& name = pair.first;
+    const auto& family = pair.second;
+    ss << "# HELP " << name << " " << family.help << "\n";
+    ss << "# TYPE " << name << " " << family.type << "\n";
+    for (auto& counter : family.counters) {
+      ss << with_labels(name, counter.first) << " " << counter.second->Value()
+         << "\n";
+    }
+    for (auto& gauge : family.gauges) {
+      ss << with_labels(name, gauge.first) << " " << gauge.second() << "\n";
+    }
+    for (auto& histogram : family.histograms) {
+      uint64_t sum;
+      histogram.second->Collect(buckets, sum);
+      uint64_t count = 0;
+      for (size_t i = 0; i < buckets.size(); ++i) {
+        count += buckets[i];
+        std::string le = i < Histogram::kBucketNum
+                             ? std::to_string(static_cast<uint64_t>(1) << i)
+                             : "+Inf";
+        ss << with_labels(name + "_bucket", histogram.first,
+                          "le=\"" + le + "\"")
+           << " " << count << "\n";
+      }
+      ss << with_labels(name + "_sum", histogram.first) << " " << sum << "\n";
+      ss << with_labels(name + "_count", histogram.first) << " " << count
+         << "\n";
+    }
+  }
+  return ss.str();
+}
+
+}  // namespace gs
@@ -0,0 +1,159 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GRAPHSCOPE_UTILS_METRICS_H_
+#define GRAPHSCOPE_UTILS_METRICS_H_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace gs {
+
+// Threads update counters and histograms in one of this many slots, which
+// are summed when the metrics are scraped.
+static constexpr size_t kMetricsSlotNum = 64;
+
+/** @brief Slot of the calling thread, assigned on its first update. */
+size_t metrics_slot();
+
+/** @brief Monotonic counter, updated without locks or shared cache lines. */
+class Counter {
+ public:
+  Counter() = default;
+
+  Counter(const Counter&) = delete;
+  Counter& operator=(const Counter&) = delete;
+
+  void Add(uint64_t value = 1) {
+    slots_[metrics_slot()].value.fetch_add(value, std::memory_order_relaxed);
+  }
+
+  uint64_t Value() const;
+
+ private:
+  struct alignas(64) Slot {
+    std::atomic<uint64_t> value{0};
+  };
+  std::array<Slot, kMetricsSlotNum> slots_;
+};
+
+/**
+ * @brief Histogram of values in microseconds, or of any other unit, with
+ * power of 2 buckets: bucket b counts the values at most 2^b.
+ */
+class Histogram {
+ public:
+  // the last bucket counts values up to 2^27 (over 2 minutes in us)
+  static constexpr size_t kBucketNum = 28;
+
+  Histogram() = default;
+
+  Histogram(const Histogram&) = delete;
+  Histogram& operator=(const Histogram&) = delete;
+
+  void Observe(uint64_t value) {
+    size_t bucket = value <= 1 ? 0 : 64 - __builtin_clzll(value - 1);
+    auto& slot = slots_[metrics_slot()];
+    slot.buckets[bucket < kBucketNum ? bucket : kBucketNum].fetch_add(
+        1, std::memory_order_relaxed);
+    slot.sum.fetch_add(value, std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Counts of the buckets, the last one counting values over all
+   * buckets, and the sum of the values.
+   */
+  void Collect(std::vector<uint64_t>& buckets, uint64_t& sum) const;
+
+ private:
+  struct alignas(64) Slot {
+    std::array<std::atomic<uint64_t>, kBucketNum + 1> buckets{};
+    std::atomic<uint64_t> sum{0};
+  };
+  std::array<Slot, kMetricsSlotNum> slots_;
+};
+
+/** @brief Observes the microseconds from construction to destruction. */
+class ScopedLatency {
+ public:
+  explicit ScopedLatency(Histogram& histogram)
+      : histogram_(histogram), start_(std::chrono::steady_clock::now()) {}
+  ~ScopedLatency() {
+    histogram_.Observe(std::chrono::duration_cast<std::chrono::microseconds>(
+                           std::chrono::steady_clock::now() - start_)
+                           .count());
+  }
+
+  ScopedLatency(const ScopedLatency&) = delete;
+  ScopedLatency& operator=(const ScopedLatency&) = delete;
+
+ private:
+  Histogram& histogram_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+/**
+ * @brief Metrics of the process, exposed in the prometheus text format.
+ *
+ * Counters and histograms are created on first use and live as long as the
+ * process, so references to them may be kept, e.g. in function local
+ * statics, to update them without looking them up. Labels are given
+ * formatted, like app="3". Gauges are computed by callbacks when scraped.
+ */
+class MetricsRegistry {
+ public:
+  static MetricsRegistry& get();
+
+  Counter& GetCounter(const std::string& name, const std::string& help,
+                      const std::string& labels = "");
+
+  Histogram& GetHistogram(const std::string& name, const std::string& help,
+                          const std::string& labels = "");
+
+  /** @brief Set the callback of a gauge, replacing the one set before. */
+  void SetGauge(const std::string& name, const std::string& help,
+                const std::string& labels, std::function<double()> callback);
+
+  std::string Dump() const;
+
+ private:
+  MetricsRegistry() = default;
+
+  struct Family {
+    std::string help;
+    std::string type;
+    std::map<std::string, std::unique_ptr<Counter>> counters;
+    std::map<std::string, std::unique_ptr<Histogram>> histograms;
+    std::map<std::string, std::function<double()>> gauges;
+  };
+
+  Family& getFamily(const std::string& name, const std::string& help,
+                    const char* type);
+
+  mutable std::mutex mutex_;
+  std::map<std::string, Family> families_;
+};
+
+}  // namespace gs
+
+#endif  // GRAPHSCOPE_UTILS_METRICS_H_
@@ -23,26 +23,37 @@
 #include <sys/types.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <atomic>
 #include <filesystem>
 #include <string>
 #include <string_view>
+#include <vector>
 
+#include "flex/utils/numa.h"
 #include "glog/logging.h"
 
 namespace gs {
 
 template <typename T>
 class mmap_array {
+  // granularity of the growth of growable arrays
+  static constexpr size_t kGrowBytes = 2ul << 20;
+
  public:
-  mmap_array() : fd_(-1), data_(NULL), size_(0) {}
+  mmap_array() : fd_(-1), data_(NULL), size_(0), committed_(0) {}
   ~mmap_array() { release(); }
 
   void open_for_read(const std::string& filename) {
     release();
 
     size_t filesize = std::filesystem::file_size(filename);
-    fd_ = ::open(filename.c_str(), O_RDWR, 0640);
+    // a private mapping is writable even if the file is not, which allows
+    // read-only snapshots to be shared by several processes
+    fd_ = ::open(filename.c_str(), O_RDONLY);
+    if (fd_ == -1) {
+      LOG(FATAL) << "Failed to open " << filename;
+    }
     size_ = filesize / sizeof(T);
     if (size_ != 0) {
       size_t size_in_bytes = size_ * sizeof(T);
@@ -51,6 +62,140 @@ class mmap_array {
       if (data_ == MAP_FAILED) {
         LOG(FATAL) << "mmap failed...";
       }
+      interleave();
+    }
+    committed_ = size_;
+  }
+
+  /**
+   * @brief Reserve the addresses of size elements without backing them, see
+   * grow. Elements not yet grown into cost neither memory nor commit charge,
+   * so capacity may be reserved generously.
+   */
+  void reserve_growable(size_t size) {
+    release();
+    size_ = size;
+    if (size_ != 0) {
+      data_ = static_cast<T*>(
+          mmap(NULL, size_ * sizeof(T), PROT_NONE,
+               MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0));
+      if (data_ == MAP_FAILED) {
+        LOG(FATAL) << "mmap failed...";
+      }
+      interleave();
+    }
+  }
+
+  /**
+   * @brief Like open_for_read, but only the first used elements are made
+   * accessible, the rest of the file are grown into as they are inserted.
+   */
+  void open_growable(const std::string& filename, size_t used) {
+    release();
+
+    size_t filesize = std::filesystem::file_size(filename);
+    fd_ = ::open(filename.c_str(), O_RDONLY);
+    if (fd_ == -1) {
+      LOG(FATAL) << "Failed to open " << filename;
+    }
+    size_ = filesize / sizeof(T);
+    if (size_ != 0) {
+      data_ = static_cast<T*>(mmap(NULL, size_ * sizeof(T), PROT_NONE,
+                                   MAP_PRIVATE | MAP_NORESERVE, fd_, 0));
+      if (data_ == MAP_FAILED) {
+        LOG(FATAL) << "mmap failed...";
+      }
+      interleave();
+    }
+    grow(used);
+  }
+
+  /**
+   * @brief Make the first size elements of a growable array accessible, in
+   * chunks of kGrowBytes. Elements keep their addresses, and growing is
+   * idempotent, so it may race with itself and with readers of the elements
+   * already accessible.
+   */
+  void grow(size_t size) {
+    size = std::min(size, size_);
+    size_t committed = __atomic_load_n(&committed_, __ATOMIC_ACQUIRE);
+    if (size <= committed) {
+      return;
+    }
+    static const size_t page_size = sysconf(_SC_PAGESIZE);
+    size_t limit = (size_ * sizeof(T) + page_size - 1) / page_size * page_size;
+    size_t begin = committed * sizeof(T) / page_size * page_size;
+    size_t end = std::min(
+        (size * sizeof(T) + kGrowBytes - 1) / kGrowBytes * kGrowBytes, limit);
+    if (mprotect(reinterpret_cast<char*>(data_) + begin, end - begin,
+                 PROT_READ | PROT_WRITE) != 0) {
+      LOG(FATAL) << "Failed to grow array to " << size << " elements";
+    }
+    size_t grown = std::min(end / sizeof(T), size_);
+    while (committed < grown &&
+           !__atomic_compare_exchange_n(&committed_, &committed, grown, true,
+                                        __ATOMIC_RELEASE, __ATOMIC_ACQUIRE)) {
+    }
+  }
+ under
+   * temp_directory_path() instead of anonymous memory, so that its pages can
+   * be written back and evicted under memory pressure.
+   */
+  void open_in_tmp_file(size_t size) {
+    release();
+
+    std::string path =
+        (std::filesystem::temp_directory_path() / "flex_column_XXXXXX")
+            .string();
+    fd_ = mkstemp(&path[0]);
+    if (fd_ == -1) {
+      LOG(FATAL) << "Failed to create " << path;
+    }
+    unlink(path.c_str());
+    size_ = size;
+    if (size_ != 0) {
+      size_t size_in_bytes = size_ * sizeof(T);
+      if (ftruncate(fd_, size_in_bytes) != 0) {
+        LOG(FATAL) << "ftruncate file failed...";
+      }
+      data_ = static_cast<T*>(mmap(NULL, size_in_bytes, PROT_READ | PROT_WRITE,
+                                   MAP_SHARED | MAP_NORESERVE, fd_, 0));
+      if (data_ == MAP_FAILED) {
+        LOG(FATAL) << "mmap failed...";
+      }
+      interleave();
+    }
+    committed_ = size_;
+  }
+
+  /** @brief Disable readahead, for arrays mostly read at random. */
+  void advise_random() const {
+    if (data_ != NULL) {
+      madvise(data_, size_ * sizeof(T), MADV_RANDOM);
+    }
+  }
+
+  /**
+   * @brief Ask the kernel to read in the pages of the given elements in the
+   * background, so that later accesses are less likely to block on faults.
+   */
+  template <typename INDEX_T>
+  void prefetch(const INDEX_T* indices, size_t num) const {
+    static const size_t page_size = sysconf(_SC_PAGESIZE);
+    uintptr_t last_page = 0;
+    for (size_t i = 0; i < num; ++i) {
+      if (static_cast<size_t>(indices[i]) >= size_) {
+        continue;
+      }
+      uintptr_t addr = reinterpret_cast<uintptr_t>(data_ + indices[i]);
+      uintptr_t page = addr & ~(page_size - 1);
+      if (page == last_page) {
+        continue;
+      }
+      last_page = page;
+      madvise(reinterpret_cast<void*>(page),
+              addr + sizeof(T) - page > page_size ? 2 * page_size : page_size,
+              MADV_WILLNEED);
     }
   }
 
@@ -59,7 +204,8 @@ class mmap_array {
     if (data_ == NULL || size_ == 0) {
       return;
     }
-    size_t size_in_bytes = std::min(size, size_) * sizeof(T);
+    // elements never grown into are zeros, left to the sparse file
+    size_t size_in_bytes = std::min({size, size_, committed_}) * sizeof(T);
     if (size_in_bytes == 0) {
       return;
     }
@@ -89,6 +235,7 @@ class mmap_array {
     }
     data_ = NULL;
     size_ = 0;
+    committed_ = 0;
 
     if (fd_ != -1) {
       ::close(fd_);
@@ -103,8 +250,11 @@ class mmap_array {
     T* new_data = static_cast<T*>(
         mmap(NULL, size * sizeof(T), PROT_READ | PROT_WRITE,
              MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0));
+    if (numa_interleave_enabled()) {
+      numa_interleave(new_data, size * sizeof(T));
+    }
     if (data_ != NULL) {
-      size_t copy_size = std::min(size_, size);
+      size_t copy_size = std::min(committed_, size);
       if (copy_size > 0) {
         memcpy(new_data, data_, copy_size * sizeof(T));
       }
@@ -112,6 +262,7 @@ class mmap_array {
     }
     data_ = new_data;
     size_ = size;
+    committed_ = size;
     if (fd_ != 0) {
       ::close(fd_);
       fd_ = -1;
@@ -134,20 +285,43 @@ class mmap_array {
   T& operator[](size_t index) { return data_[index]; }
   const T& operator[](size_t index) const { return data_[index]; }
 
-  void insert(size_t index, const T& value) { data_[index] = value; }
+  void insert(size_t index, const T& value) {
+    if (__builtin_expect(
+            index >= __atomic_load_n(&committed_, __ATOMIC_RELAXED), 0)) {
+      grow(index + 1);
+    }
+    data_[index] = value;
+  }
 
   size_t size() const { return size_; }
 
+  /**
+   * @brief Bytes of the elements accessible, those of growable arrays not
+   * grown into yet are not counted.
+   */
+  size_t memory_usage() const { return committed_ * sizeof(T); }
+
   void swap(mmap_array<T>& rhs) {
     std::swap(fd_, rhs.fd_);
     std::swap(data_, rhs.data_);
     std::swap(size_, rhs.size_);
+    std::swap(committed_, rhs.committed_);
   }
 
  private:
+  // before the pages are faulted in, see set_numa_interleave
+  void interleave() {
+    if (numa_interleave_enabled()) {
+      numa_interleave(data_, size_ * sizeof(T));
+    }
+  }
+
   int fd_;
   T* data_;
   size_t size_;
+  // the first committed_ elements are accessible, all of them unless the
+  // array is growable
+  size_t committed_;
 };
 
 struct string_item {
@@ -207,6 +381,45 @@ class mmap_array<std::string_view> {
     }
   }
 
+  /** @brief Like resize on an empty array, but backed by temporary files. */
+  void open_in_tmp_file(size_t size) {
+    release();
+    string_items_.open_in_tmp_file(size);
+    buffer_.open_in_tmp_file(size * 1024);
+    buffer_loc_.store(0);
+  }
+
+  void advise_random() const {
+    string_items_.advise_random();
+    buffer_.advise_random();
+  }
+
+  template <typename INDEX_T>
+  void prefetch(const INDEX_T* indices, size_t num) const {
+    string_items_.prefetch(indices, num);
+    std::vector<size_t> offsets;
+    offsets.reserve(num);
+    for (size_t i = 0; i < num; ++i) {
+      if (static_cast<size_t>(indices[i]) < string_items_.size()) {
+        offsets.push_back(string_items_[indices[i]].offset);
+      }
+    }
+    buffer_.prefetch(offsets.data(), offsets.size());
+  }
+
+  /** @brief Load the item of the element into cache, without waiting. */
+  void prefetch_item(size_t index) const {
+    __builtin_prefetch(string_items_.data() + index);
+  }
+
+  /**
+   * @brief Load the first bytes of the element into cache, without waiting,
+   * best after its item is, see prefetch_item.
+   */
+  void prefetch_bytes(size_t index) const {
+    __builtin_prefetch(buffer_.data() + string_items_[index].offset);
+  }
+
   void resize_fill(size_t new_size, const std::string_view& value) {
     size_t old_size = size();
     resize(new_size);
@@ -279,6 +492,10 @@ class mmap_array<std::string_view> {
 
   size_t size() const { return string_items_.size(); }
 
+  size_t memory_usage() const {
+    return string_items_.memory_usage() + buffer_.memory_usage();
+  }
+
   void release() {
     string_items_.release();
     buffer_.release();
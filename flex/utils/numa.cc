@@ -0,0 +1,96 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "flex/utils/numa.h"
+
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "glog/logging.h"
+
+namespace gs {
+
+// see linux/mempolicy.h, not all distributions ship libnuma headers
+static constexpr int kMpolInterleave = 3;
+
+static std::atomic<bool> numa_interleave_enabled_(false);
+
+// the mask of the online nodes, empty on hosts with a single node
+static const std::vector<unsigned long>& online_node_mask() {
+  static const std::vector<unsigned long> mask = [] {
+    std::vector<unsigned long> ret;
+    std::ifstream fin("/sys/devices/system/node/online");
+    std::string ranges;
+    if (!(fin >> ranges)) {
+      return ret;
+    }
+    // e.g. "0-1,3"
+    size_t node_num = 0;
+    std::stringstream ss(ranges);
+    std::string range;
+    while (std::getline(ss, range, ',')) {
+      auto dash = range.find('-');
+      size_t first = std::stoul(range.substr(0, dash));
+      size_t last = first;
+      if (dash != std::string::npos) {
+        last = std::stoul(range.substr(dash + 1));
+      }
+      for (size_t node = first; node <= last; ++node) {
+        size_t word = node / (8 * sizeof(unsigned long));
+        if (ret.size() <= word) {
+          ret.resize(word + 1, 0);
+        }
+        ret[word] |= 1ul << (node % (8 * sizeof(unsigned long)));
+        ++node_num;
+      }
+    }
+    if (node_num <= 1) {
+      ret.clear();
+    }
+    return ret;
+  }();
+  return mask;
+}
+
+void set_numa_interleave(bool enabled) {
+  if (enabled && online_node_mask().empty()) {
+    LOG(INFO) << "Single NUMA node, memory is not interleaved";
+  }
+  numa_interleave_enabled_.store(enabled);
+}
+
+bool numa_interleave_enabled() { return numa_interleave_enabled_.load(); }
+
+void numa_interleave(void* addr, size_t len) {
+  const auto& mask = online_node_mask();
+  if (mask.empty() || addr == nullptr || len == 0) {
+    return;
+  }
+  if (syscall(SYS_mbind, addr, len, kMpolInterleave, mask.data(),
+              mask.size() * 8 * sizeof(unsigned long) + 1, 0) != 0) {
+    LOG(WARNING) << "Failed to interleave " << len
+                 << " bytes: " << strerror(errno);
+  }
+}
+
+}  // namespace gs
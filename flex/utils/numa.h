@@ -0,0 +1,42 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GRAPHSCOPE_UTILS_NUMA_H_
+#define GRAPHSCOPE_UTILS_NUMA_H_
+
+#include <cstddef>
+
+namespace gs {
+
+/**
+ * @brief Interleave the pages of the graph's mmap arrays mapped from now on
+ * across all NUMA nodes, so that the reads of shards running on any socket
+ * are served by the memory bandwidth of all of them instead of the node
+ * which happened to load the graph.
+ */
+void set_numa_interleave(bool enabled);
+
+bool numa_interleave_enabled();
+
+/**
+ * @brief Set the policy of [addr, addr + len) to interleave across the online
+ * NUMA nodes, for the pages faulted in later. addr must be page aligned. A
+ * no-op on hosts with a single node.
+ */
+void numa_interleave(void* addr, size_t len);
+
+}  // namespace gs
+
+#endif  // GRAPHSCOPE_UTILS_NUMA_H_
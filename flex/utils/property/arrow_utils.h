@@ -0,0 +1,121 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GRAPHSCOPE_PROPERTY_ARROW_UTILS_H_
+#define GRAPHSCOPE_PROPERTY_ARROW_UTILS_H_
+
+#ifdef FLEX_WITH_ARROW
+
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "arrow/api.h"
+#include "glog/logging.h"
+
+#include "flex/utils/property/types.h"
+
+namespace gs {
+
+/**
+ * @brief The arrow type of property values of type T. Values of fixed width
+ * have the layout of the arrow type, so their buffers are wrapped as is.
+ */
+template <typename T>
+struct ArrowTypeOf {};
+
+template <>
+struct ArrowTypeOf<int> {
+  using type = arrow::Int32Type;
+  using builder_type = arrow::Int32Builder;
+  static std::shared_ptr<arrow::DataType> data_type() { return arrow::int32(); }
+  static int value(const int& v) { return v; }
+};
+
+template <>
+struct ArrowTypeOf<int64_t> {
+  using type = arrow::Int64Type;
+  using builder_type = arrow::Int64Builder;
+  static std::shared_ptr<arrow::DataType> data_type() { return arrow::int64(); }
+  static int64_t value(const int64_t& v) { return v; }
+};
+
+template <>
+struct ArrowTypeOf<double> {
+  using type = arrow::DoubleType;
+  using builder_type = arrow::DoubleBuilder;
+  static std::shared_ptr<arrow::DataType> data_type() {
+    return arrow::float64();
+  }
+  static double value(const double& v) { return v; }
+};
+
+// dates are milliseconds since the epoch, as date64
+template <>
+struct ArrowTypeOf<Date> {
+  using type = arrow::Date64Type;
+  using builder_type = arrow::Date64Builder;
+  static std::shared_ptr<arrow::DataType> data_type() {
+    return arrow::date64();
+  }
+  static int64_t value(const Date& v) { return v.milli_second; }
+};
+
+template <>
+struct ArrowTypeOf<std::string_view> {
+  using type = arrow::LargeStringType;
+  using builder_type = arrow::LargeStringBuilder;
+  static std::shared_ptr<arrow::DataType> data_type() {
+    return arrow::large_utf8();
+  }
+  static std::string_view value(const std::string_view& v) { return v; }
+};
+
+template <>
+struct ArrowTypeOf<std::string> : ArrowTypeOf<std::string_view> {};
+
+/**
+ * @brief A buffer referring to num values at data, which must outlive the
+ * buffer.
+ */
+template <typename T>
+std::shared_ptr<arrow::Buffer> wrap_arrow_buffer(const T* data, size_t num) {
+  return std::make_shared<arrow::Buffer>(reinterpret_cast<const uint8_t*>(data),
+                                         static_cast<int64_t>(num * sizeof(T)));
+}
+
+template <typename T>
+std::shared_ptr<arrow::Array> wrap_arrow_array(const T* data, size_t num) {
+  using array_type =
+      typename arrow::TypeTraits<typename ArrowTypeOf<T>::type>::ArrayType;
+  static_assert(sizeof(T) == sizeof(typename ArrowTypeOf<T>::type::c_type),
+                "values are wrapped only with the layout of the arrow type");
+  return std::make_shared<array_type>(ArrowTypeOf<T>::data_type(), num,
+                                      wrap_arrow_buffer(data, num));
+}
+
+#define FLEX_ARROW_OK_OR_FATAL(expr)                 \
+  do {                                               \
+    auto _status = (expr);                           \
+    if (!_status.ok()) {                             \
+      LOG(FATAL) << "Arrow: " << _status.ToString(); \
+    }                                                \
+  } while (0)
+
+}  // namespace gs
+
+#endif  // FLEX_WITH_ARROW
+
+#endif  // GRAPHSCOPE_PROPERTY_ARROW_UTILS_H_
@@ -16,6 +16,10 @@
 #include "flex/utils/property/column.h"
 #include "flex/utils/property/types.h"
 
+#include <algorithm>
+#include <thread>
+#include <vector>
+
 #include "grape/serialization/out_archive.h"
 
 namespace gs {
@@ -40,7 +44,7 @@ class TypedEmptyColumn : public ColumnBase {
 
   void Serialize(const std::string& path, size_t size) override {}
 
-  void Deserialize(const std::string& path) override {}
+  void Deserialize(const std::string& path, size_t row_num) override {}
 
   void ingest(uint32_t index, grape::OutArchive& arc) override {
     T val;
@@ -50,6 +54,14 @@ class TypedEmptyColumn : public ColumnBase {
   StorageStrategy storage_strategy() const override {
     return StorageStrategy::kNone;
   }
+
+  size_t memory_usage() const override { return 0; }
+
+#ifdef FLEX_WITH_ARROW
+  std::shared_ptr<arrow::Array> ToArrow(size_t row_num) const override {
+    return std::make_shared<arrow::NullArray>(row_num);
+  }
+#endif
 };
 
 using IntEmptyColumn = TypedEmptyColumn<int>;
@@ -89,4 +101,35 @@ std::shared_ptr<ColumnBase> CreateColumn(PropertyType type,
   }
 }
 
+void FillColumn(ColumnBase& column, size_t begin, size_t end,
+                const Any& value, int thread_num) {
+  if (begin >= end) {
+    return;
+  }
+  // the last row first, so the rows before it are backed once for all
+  // threads
+  column.set_any(end - 1, value);
+  --end;
+  if (column.type() == PropertyType::kString || thread_num <= 1) {
+    for (size_t i = begin; i < end; ++i) {
+      column.set_any(i, value);
+    }
+    return;
+  }
+  size_t chunk = (end - begin + thread_num - 1) / thread_num;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < thread_num; ++t) {
+    size_t from = std::min(end, begin + t * chunk);
+    size_t to = std::min(end, from + chunk);
+    threads.emplace_back([&column, &value, from, to]() {
+      for (size_t i = from; i < to; ++i) {
+        column.set_any(i, value);
+      }
+    });
+  }
+  for (auto& thrd : threads) {
+    thrd.join();
+  }
+}
+
 }  // namespace gs
@@ -16,10 +16,13 @@
 #ifndef GRAPHSCOPE_PROPERTY_COLUMN_H_
 #define GRAPHSCOPE_PROPERTY_COLUMN_H_
 
+#include <mutex>
 #include <string>
 #include <string_view>
 
+#include "flex/utils/id_indexer.h"
 #include "flex/utils/mmap_array.h"
+#include "flex/utils/property/arrow_utils.h"
 #include "flex/utils/property/types.h"
 #include "grape/serialization/out_archive.h"
 
@@ -41,9 +44,26 @@ class ColumnBase {
 
   virtual void Serialize(const std::string& filename, size_t size) = 0;
 
-  virtual void Deserialize(const std::string& filename) = 0;
+  /**
+   * @brief Load the column dumped to filename, with the capacity it had.
+   * Rows from row_num on are only backed once set, see init.
+   */
+  virtual void Deserialize(const std::string& filename, size_t row_num) = 0;
 
   virtual StorageStrategy storage_strategy() const = 0;
+
+  /** @brief Bytes of memory held by the column, see MemoryUsage. */
+  virtual size_t memory_usage() const = 0;
+
+#ifdef FLEX_WITH_ARROW
+  /**
+   * @brief The values of the first row_num rows as an arrow array. Values of
+   * fixed width refer to the column without copying, so the array is valid
+   * as long as the column is neither resized nor destroyed. Strings are
+   * copied, except the codes of dictionary encoded ones.
+   */
+  virtual std::shared_ptr<arrow::Array> ToArrow(size_t row_num) const = 0;
+#endif
 };
 
 template <typename T>
@@ -52,7 +72,16 @@ class TypedColumn : public ColumnBase {
   TypedColumn(StorageStrategy strategy) : strategy_(strategy) {}
   ~TypedColumn() {}
 
-  void init(size_t max_size) override { buffer_.resize(max_size); }
+  // In memory, only addresses are reserved for the max_size rows, and they
+  // are backed chunk by chunk as rows are set, so that the memory of a column
+  // follows the number of its rows rather than its capacity.
+  void init(size_t max_size) override {
+    if (strategy_ == StorageStrategy::kDisk) {
+      buffer_.open_in_tmp_file(max_size);
+    } else {
+      buffer_.reserve_growable(max_size);
+    }
+  }
 
   void set_value(size_t index, const T& val) { buffer_.insert(index, val); }
 
@@ -72,8 +101,13 @@ class TypedColumn : public ColumnBase {
     buffer_.dump_to_file(path, size);
   }
 
-  void Deserialize(const std::string& path) override {
-    buffer_.open_for_read(path);
+  void Deserialize(const std::string& path, size_t row_num) override {
+    if (strategy_ == StorageStrategy::kDisk) {
+      buffer_.open_for_read(path);
+      buffer_.advise_random();
+    } else {
+      buffer_.open_growable(path, row_num);
+    }
   }
 
   void ingest(uint32_t index, grape::OutArchive& arc) override {
@@ -84,6 +118,14 @@ class TypedColumn : public ColumnBase {
 
   StorageStrategy storage_strategy() const override { return strategy_; }
 
+  size_t memory_usage() const override { return buffer_.memory_usage(); }
+
+#ifdef FLEX_WITH_ARROW
+  std::shared_ptr<arrow::Array> ToArrow(size_t row_num) const override {
+    return wrap_arrow_array(buffer_.data(), row_num);
+  }
+#endif
+
   const mmap_array<T>& buffer() const { return buffer_; }
   mmap_array<T>& buffer() { return buffer_; }
 
@@ -92,6 +134,163 @@ class TypedColumn : public ColumnBase {
   StorageStrategy strategy_;
 };
 
+/**
+ * @brief Column of strings. With StorageStrategy::kDict, each distinct value
+ * is kept once in a dictionary and rows keep 4-byte codes of their values,
+ * which suits properties of few distinct values. Equal values have equal
+ * codes, so predicates can compare codes instead of strings.
+ */
+template <>
+class TypedColumn<std::string_view> : public ColumnBase {
+ public:
+  using code_t = uint32_t;
+
+  TypedColumn(StorageStrategy strategy) : strategy_(strategy) {}
+  ~TypedColumn() {}
+
+  void init(size_t max_size) override {
+    if (is_dict()) {
+      codes_.reserve_growable(max_size);
+      build_lf_indexer(std::vector<std::string_view>(), dict_, max_size, 1);
+    } else if (strategy_ == StorageStrategy::kDisk) {
+      buffer_.open_in_tmp_file(max_size);
+    } else {
+      buffer_.resize(max_size);
+    }
+  }
+
+  void set_value(size_t index, const std::string_view& val) {
+    if (is_dict()) {
+      codes_.insert(index, get_or_add_code(val));
+    } else {
+      buffer_.insert(index, val);
+    }
+  }
+
+  void set_any(size_t index, const Any& value) override {
+    set_value(index, AnyConverter<std::string_view>::from_any(value));
+  }
+
+  std::string_view get_view(size_t index) const {
+    return is_dict() ? dict_.get_key(codes_[index]) : buffer_[index];
+  }
+
+  PropertyType type() const override {
+    return AnyConverter<std::string_view>::type;
+  }
+
+  Any get(size_t index) const override {
+    return AnyConverter<std::string_view>::to_any(get_view(index));
+  }
+
+  void Serialize(const std::string& path, size_t size) override {
+    if (is_dict()) {
+      codes_.dump_to_file(path, size);
+      dict_.Serialize(path + ".dict");
+    } else {
+      buffer_.dump_to_file(path, size);
+    }
+  }
+
+  void Deserialize(const std::string& path, size_t row_num) override {
+    if (is_dict()) {
+      codes_.open_growable(path, row_num);
+      dict_.Deserialize(path + ".dict");
+    } else {
+      buffer_.open_for_read(path);
+      if (strategy_ == StorageStrategy::kDisk) {
+        buffer_.advise_random();
+      }
+    }
+  }
+
+  void ingest(uint32_t index, grape::OutArchive& arc) override {
+    std::string_view val;
+    arc >> val;
+    set_value(index, val);
+  }
+
+  StorageStrategy storage_strategy() const override { return strategy_; }
+
+  size_t memory_usage() const override {
+    return is_dict() ? codes_.memory_usage() + dict_.memory_usage()
+                     : buffer_.memory_usage();
+  }
+
+#ifdef FLEX_WITH_ARROW
+  // dictionary encoded strings keep their codes as indices of the dictionary
+  std::shared_ptr<arrow::Array> ToArrow(size_t row_num) const override {
+    arrow::LargeStringBuilder builder;
+    if (is_dict()) {
+      for (size_t code = 0; code < dict_.size(); ++code) {
+        auto val = dict_.get_key(code);
+        FLEX_ARROW_OK_OR_FATAL(builder.Append(val.data(), val.size()));
+      }
+    } else {
+      for (size_t i = 0; i < row_num; ++i) {
+        auto val = buffer_[i];
+        FLEX_ARROW_OK_OR_FATAL(builder.Append(val.data(), val.size()));
+      }
+    }
+    std::shared_ptr<arrow::Array> values;
+    FLEX_ARROW_OK_OR_FATAL(builder.Finish(&values));
+    if (!is_dict()) {
+      return values;
+    }
+    auto indices = std::make_shared<arrow::UInt32Array>(
+        row_num, wrap_arrow_buffer(codes_.data(), row_num));
+    return std::make_shared<arrow::DictionaryArray>(
+        arrow::dictionary(arrow::uint32(), values->type()), indices, values);
+  }
+#endif
+
+  bool is_dict() const { return strategy_ == StorageStrategy::kDict; }
+
+  /** @brief Values of rows, only if not dictionary encoded. */
+  const mmap_array<std::string_view>& buffer() const { return buffer_; }
+  mmap_array<std::string_view>& buffer() { return buffer_; }
+
+  /** @brief Codes of rows, only if dictionary encoded. */
+  const mmap_array<code_t>& codes() const { return codes_; }
+
+  /** @brief Get the code of a value, false if no row has the value. */
+  bool get_code(const std::string_view& val, code_t& code) const {
+    return dict_.get_index(val, code);
+  }
+
+  std::string_view get_value(code_t code) const { return dict_.get_key(code); }
+
+  size_t dict_size() const { return dict_.size(); }
+
+  /** @brief Start reading in the values of the given rows, see kDisk. */
+  template <typename INDEX_T>
+  void prefetch(const INDEX_T* indices, size_t num) const {
+    if (!is_dict()) {
+      buffer_.prefetch(indices, num);
+    }
+  }
+
+ private:
+  code_t get_or_add_code(const std::string_view& val) {
+    code_t code;
+    if (dict_.get_index(val, code)) {
+      return code;
+    }
+    // values are added under the lock, so that each gets a single code
+    std::lock_guard<std::mutex> lock(dict_mutex_);
+    if (!dict_.get_index(val, code)) {
+      code = dict_.insert(val);
+    }
+    return code;
+  }
+
+  mmap_array<std::string_view> buffer_;
+  mmap_array<code_t> codes_;
+  LFIndexer<code_t, std::string_view> dict_;
+  std::mutex dict_mutex_;
+  StorageStrategy strategy_;
+};
+
 using IntColumn = TypedColumn<int>;
 using LongColumn = TypedColumn<int64_t>;
 using DateColumn = TypedColumn<Date>;
@@ -101,9 +300,22 @@ using DoubleColumn = TypedColumn<double>;
 std::shared_ptr<ColumnBase> CreateColumn(
     PropertyType type, StorageStrategy strategy = StorageStrategy::kMem);
 
+/**
+ * @brief Set the rows from begin to end of column to value, splitting them
+ * among thread_num threads except for strings.
+ */
+void FillColumn(ColumnBase& column, size_t begin, size_t end,
+                const Any& value, int thread_num);
+
 /// Create RefColumn for ease of usage for hqps
 class RefColumnBase {
  public:
+  /**
+   * @brief Rows ahead of the current one to load into cache in gathers, far
+   * enough to cover the latency of a few misses in flight.
+   */
+  static constexpr size_t kPrefetchDistance = 16;
+
   virtual ~RefColumnBase() {}
 };
 
@@ -121,11 +333,115 @@ class TypedRefColumn : public RefColumnBase {
 
   inline T get_view(size_t index) const { return buffer_[index]; }
 
+  /** @brief Values of all rows, indexed by vid. */
+  const T* data() const { return buffer_.data(); }
+
+  StorageStrategy storage_strategy() const { return strategy_; }
+
+  /** @brief Start reading in the values of the given rows, see kDisk. */
+  template <typename INDEX_T>
+  void prefetch(const INDEX_T* indices, size_t num) const {
+    buffer_.prefetch(indices, num);
+  }
+
+  /** @brief Load the value of the row into cache, without waiting. */
+  inline void prefetch_row(size_t index) const {
+    __builtin_prefetch(buffer_.data() + index);
+  }
+
+  /**
+   * @brief Call func(i, value) with the value of row index_of(i), for i in
+   * [0, num), loading the rows kPrefetchDistance ahead into cache meanwhile.
+   * Rows reached by an expand are scattered over the column, so reading them
+   * one by one would wait on a cache miss for nearly each.
+   */
+  template <typename INDEX_FUNC_T, typename FUNC_T>
+  void gather(size_t num, const INDEX_FUNC_T& index_of,
+              const FUNC_T& func) const {
+    const T* values = buffer_.data();
+    size_t i = 0;
+    for (; i + kPrefetchDistance < num; ++i) {
+      __builtin_prefetch(values + index_of(i + kPrefetchDistance));
+      func(i, values[index_of(i)]);
+    }
+    for (; i < num; ++i) {
+      func(i, values[index_of(i)]);
+    }
+  }
+
  private:
   const mmap_array<T>& buffer_;
   StorageStrategy strategy_;
 };
 
+template <>
+class TypedRefColumn<std::string_view> : public RefColumnBase {
+ public:
+  using value_type = std::string_view;
+
+  TypedRefColumn(const TypedColumn<std::string_view>& column)
+      : column_(column), strategy_(column.storage_strategy()) {}
+  ~TypedRefColumn() {}
+
+  inline std::string_view get_view(size_t index) const {
+    return column_.get_view(index);
+  }
+
+  /** @brief The column, to compare codes if it is dictionary encoded. */
+  const TypedColumn<std::string_view>& column() const { return column_; }
+
+  StorageStrategy storage_strategy() const { return strategy_; }
+
+  template <typename INDEX_T>
+  void prefetch(const INDEX_T* indices, size_t num) const {
+    column_.prefetch(indices, num);
+  }
+
+  /** @brief Load the code or the item of the row into cache. */
+  inline void prefetch_row(size_t index) const {
+    if (column_.is_dict()) {
+      __builtin_prefetch(column_.codes().data() + index);
+    } else {
+      column_.buffer().prefetch_item(index);
+    }
+  }
+
+  /**
+   * @brief See TypedRefColumn::gather. Unless dictionary encoded, the bytes
+   * of a row are loaded half the distance ahead, once its item is likely in
+   * cache.
+   */
+  template <typename INDEX_FUNC_T, typename FUNC_T>
+  void gather(size_t num, const INDEX_FUNC_T& index_of,
+              const FUNC_T& func) const {
+    constexpr size_t half = kPrefetchDistance / 2;
+    if (column_.is_dict()) {
+      const auto* codes = column_.codes().data();
+      for (size_t i = 0; i < num; ++i) {
+        if (i + kPrefetchDistance < num) {
+          __builtin_prefetch(codes + index_of(i + kPrefetchDistance));
+        }
+        func(i, column_.get_value(codes[index_of(i)]));
+      }
+      return;
+    }
+    const auto& buffer = column_.buffer();
+    for (size_t i = 0; i < num; ++i) {
+      if (i + kPrefetchDistance < num) {
+        buffer.prefetch_item(index_of(i + kPrefetchDistance));
+      }
+      if (i + half < num) {
+        buffer.prefetch_bytes(index_of(i + half));
+      }
+      func(i, buffer[index_of(i)]);
+    }
+  }
+
+ private:
+  const TypedColumn<std::string_view>& column_;
+  StorageStrategy strategy_;
+};
+
 }  // namespace gs
 
 #endif  // GRAPHSCOPE_PROPERTY_COLUMN_H_
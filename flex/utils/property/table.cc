@@ -15,6 +15,9 @@
 
 #include "flex/utils/property/table.h"
 
+#include <atomic>
+#include <thread>
+
 namespace gs {
 
 Table::Table() {}
@@ -51,6 +54,15 @@ void Table::reset_header(const std::vector<std::string>& col_name) {
   col_id_indexer_.swap(new_col_id_indexer);
 }
 
+void Table::add_column(const std::string& name,
+                       std::shared_ptr<ColumnBase> column) {
+  int col_id;
+  CHECK(col_id_indexer_.add(name, col_id));
+  CHECK_EQ(static_cast<size_t>(col_id), columns_.size());
+  columns_.emplace_back(std::move(column));
+  buildColumnPtrs();
+}
+
 std::vector<std::string> Table::column_names() const {
   size_t col_num = col_id_indexer_.size();
   std::vector<std::string> names(col_num);
@@ -60,6 +72,19 @@ std::vector<std::string> Table::column_names() const {
   return names;
 }
 
+#ifdef FLEX_WITH_ARROW
+std::shared_ptr<arrow::RecordBatch> Table::ToArrow(size_t row_num) const {
+  std::vector<std::string> names = column_names();
+  std::vector<std::shared_ptr<arrow::Field>> fields;
+  std::vector<std::shared_ptr<arrow::Array>> arrays;
+  for (size_t col_i = 0; col_i < columns_.size(); ++col_i) {
+    arrays.push_back(columns_[col_i]->ToArrow(row_num));
+    fields.push_back(arrow::field(names[col_i], arrays.back()->type()));
+  }
+  return arrow::RecordBatch::Make(arrow::schema(fields), row_num, arrays);
+}
+#endif
+
 std::string Table::column_name(size_t index) const {
   size_t col_num = col_id_indexer_.size();
   CHECK(index < col_num);
@@ -144,8 +169,46 @@ void Table::insert(size_t index, const std::vector<Any>& values) {
   }
 }
 
+void Table::reorder(const std::vector<size_t>& order, size_t max_row_num,
+                    int thread_num) {
+  static constexpr size_t kBlockSize = 4096;
+  size_t block_num = (order.size() + kBlockSize - 1) / kBlockSize;
+  for (auto& col : columns_) {
+    auto new_col = CreateColumn(col->type(), col->storage_strategy());
+    new_col->init(max_row_num);
+    std::atomic<size_t> next_block(0);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < thread_num; ++i) {
+      threads.emplace_back([&]() {
+        size_t block;
+        while ((block = next_block.fetch_add(1)) < block_num) {
+          size_t end = std::min(order.size(), (block + 1) * kBlockSize);
+          for (size_t row = block * kBlockSize; row < end; ++row) {
+            new_col->set_any(row, col->get(order[row]));
+          }
+        }
+      });
+    }
+    for (auto& thrd : threads) {
+      thrd.join();
+    }
+    col = new_col;
+  }
+  buildColumnPtrs();
+}
+
 void Table::Serialize(std::unique_ptr<grape::LocalIOAdaptor>& writer,
                       const std::string& prefix, size_t row_num) {
+  std::vector<std::function<void()>> tasks;
+  Serialize(writer, prefix, row_num, tasks);
+  for (auto& task : tasks) {
+    task();
+  }
+}
+
+void Table::Serialize(std::unique_ptr<grape::LocalIOAdaptor>& writer,
+                      const std::string& prefix, size_t row_num,
+                      std::vector<std::function<void()>>& tasks) {
   col_id_indexer_.Serialize(writer);
   std::vector<PropertyType> types;
   std::vector<StorageStrategy> stategies;
@@ -162,13 +225,15 @@ void Table::Serialize(std::unique_ptr<grape::LocalIOAdaptor>& writer,
                       sizeof(StorageStrategy) * stategies.size()));
   size_t col_id = 0;
   for (auto col : columns_) {
-    col->Serialize(prefix + ".col_" + std::to_string(col_id), row_num);
+    std::string path = prefix + ".col_" + std::to_string(col_id);
+    tasks.emplace_back(
+        [col, path, row_num]() { col->Serialize(path, row_num); });
     ++col_id;
   }
 }
 
 void Table::Deserialize(std::unique_ptr<grape::LocalIOAdaptor>& reader,
-                        const std::string& prefix) {
+                        const std::string& prefix, size_t row_num) {
   col_id_indexer_.Deserialize(reader);
   std::vector<PropertyType> types(col_id_indexer_.size());
   std::vector<StorageStrategy> strategies(col_id_indexer_.size());
@@ -183,7 +248,7 @@ void Table::Deserialize(std::unique_ptr<grape::LocalIOAdaptor>& reader,
     auto type = types[i];
     auto strategy = strategies[i];
     auto ptr = CreateColumn(type, strategy);
-    ptr->Deserialize(prefix + ".col_" + std::to_string(i));
+    ptr->Deserialize(prefix + ".col_" + std::to_string(i), row_num);
     columns_[i] = ptr;
   }
 
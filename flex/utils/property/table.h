@@ -16,6 +16,8 @@
 #ifndef GRAPHSCOPE_PROPERTY_TABLE_H_
 #define GRAPHSCOPE_PROPERTY_TABLE_H_
 
+#include <functional>
+#include <limits>
 #include <map>
 #include <memory>
 #include <string_view>
@@ -39,6 +41,12 @@ class Table {
 
   void reset_header(const std::vector<std::string>& col_name);
 
+  /**
+   * @brief Append column as the last one, with the id col_num() before, its
+   * rows of the table must be set already.
+   */
+  void add_column(const std::string& name, std::shared_ptr<ColumnBase> column);
+
   std::vector<std::string> column_names() const;
 
   std::string column_name(size_t index) const;
@@ -62,11 +70,32 @@ class Table {
 
   void insert(size_t index, const std::vector<Any>& values);
 
+  /**
+   * @brief Rearrange the rows, so that the i-th one is the order[i]-th one
+   * before, into columns of max_row_num rows filled by thread_num threads.
+   */
+  void reorder(const std::vector<size_t>& order, size_t max_row_num,
+               int thread_num);
+
   void Serialize(std::unique_ptr<grape::LocalIOAdaptor>& writer,
                  const std::string& prefix, size_t row_num);
 
+  /**
+   * @brief Write the meta of the table to writer, and push to tasks the
+   * dumps of its columns, which are independent of each other and of
+   * writer, so that they may run concurrently.
+   */
+  void Serialize(std::unique_ptr<grape::LocalIOAdaptor>& writer,
+                 const std::string& prefix, size_t row_num,
+                 std::vector<std::function<void()>>& tasks);
+
+  /**
+   * @brief Load the table, with row_num rows in use, more may be inserted
+   * up to the capacity it was dumped with.
+   */
   void Deserialize(std::unique_ptr<grape::LocalIOAdaptor>& reader,
-                   const std::string& prefix);
+                   const std::string& prefix,
+                   size_t row_num = std::numeric_limits<size_t>::max());
 
   Any at(size_t row_id, size_t col_id);
 
@@ -74,6 +103,14 @@ class Table {
 
   void ingest(uint32_t index, grape::OutArchive& arc);
 
+#ifdef FLEX_WITH_ARROW
+  /**
+   * @brief The first row_num rows as a record batch of the columns, see
+   * ColumnBase::ToArrow for which of them are copied.
+   */
+  std::shared_ptr<arrow::RecordBatch> ToArrow(size_t row_num) const;
+#endif
+
  private:
   void buildColumnPtrs();
 
@@ -15,6 +15,8 @@
 
 #include "flex/utils/property/types.h"
 
+#include <string.h>
+
 #include "grape/serialization/in_archive.h"
 #include "grape/serialization/out_archive.h"
 
@@ -47,10 +49,8 @@ inline void ParseDouble(const std::string_view& str, double& val) {
 void ParseRecord(const char* line, std::vector<Any>& rec) {
   const char* cur = line;
   for (auto& item : rec) {
-    const char* ptr = cur;
-    while (*ptr != '\0' && *ptr != '|') {
-      ++ptr;
-    }
+    // strcspn with a single delimiter is vectorized by the libc
+    const char* ptr = cur + strcspn(cur, "|");
     std::string_view sv(cur, ptr - cur);
     if (item.type == PropertyType::kInt32) {
       ParseInt32(sv, item.value.i);
@@ -70,10 +70,7 @@ void ParseRecord(const char* line, std::vector<Any>& rec) {
 void ParseRecord(const char* line, int64_t& id, std::vector<Any>& rec) {
   const char* cur = line;
   {
-    const char* ptr = cur;
-    while (*ptr != '\0' && *ptr != '|') {
-      ++ptr;
-    }
+    const char* ptr = cur + strcspn(cur, "|");
     std::string_view sv(cur, ptr - cur);
     ParseInt64(sv, id);
     cur = ptr + 1;
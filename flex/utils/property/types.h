@@ -20,6 +20,7 @@ limitations under the License.
 
 #include <istream>
 #include <ostream>
+#include <type_traits>
 #include <vector>
 
 #include "grape/serialization/in_archive.h"
@@ -30,6 +31,18 @@ namespace gs {
 enum class StorageStrategy {
   kNone,
   kMem,
+  // distinct strings are kept once, rows keep their codes
+  kDict,
+  // backed by files and paged in on access, for large and cold properties
+  kDisk,
+};
+
+// secondary index of a vertex property
+enum class IndexType {
+  kNone,
+  kHash,
+  // also serves range lookups
+  kSorted,
 };
 
 enum class PropertyType {
@@ -53,6 +66,21 @@ struct Date {
   int64_t milli_second;
 };
 
+/**
+ * @brief The time held by a value of an int32 or int64 property, or of a
+ * date, in its milliseconds. Edges of time-ordered edge types are ordered by
+ * it, see Schema::is_time_ordered.
+ */
+template <typename T>
+inline int64_t time_of(const T& value) {
+  if constexpr (std::is_same<T, Date>::value) {
+    return value.milli_second;
+  } else {
+    static_assert(std::is_integral<T>::value, "not a time property");
+    return value;
+  }
+}
+
 union AnyValue {
   AnyValue() {}
   ~AnyValue() {}
@@ -320,13 +348,14 @@ template <>
 struct AnyConverter<std::string> {
   static constexpr PropertyType type = PropertyType::kString;
 
-  static Any to_any(const std::string& value) {
+  // views are taken as well, e.g. strings of edges held by csrs
+  static Any to_any(const std::string_view& value) {
     Any ret;
     ret.set_string(value);
     return ret;
   }
 
-  static AnyValue to_any_value(const std::string& value) {
+  static AnyValue to_any_value(const std::string_view& value) {
     AnyValue ret;
     ret.s = value;
     return ret;
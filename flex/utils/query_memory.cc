@@ -0,0 +1,82 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "flex/utils/query_memory.h"
+
+#include <algorithm>
+#include <limits>
+
+#include <glog/logging.h>
+
+namespace gs {
+
+static size_t query_memory_limit = 0;
+static std::string query_spill_dir;
+
+static thread_local QueryMemory* current_query_memory = nullptr;
+
+void QueryMemory::Configure(size_t limit, const std::string& spill_dir) {
+  query_memory_limit = limit;
+  query_spill_dir = spill_dir;
+}
+
+size_t QueryMemory::Limit() { return query_memory_limit; }
+
+const std::string& QueryMemory::SpillDir() { return query_spill_dir; }
+
+QueryMemory::QueryMemory()
+    : used_(0), peak_(0), prev_(current_query_memory) {
+  current_query_memory = this;
+}
+
+QueryMemory::~QueryMemory() {
+  current_query_memory = prev_;
+  VLOG(10) << "Query charged at most " << peak_ << " bytes";
+}
+
+size_t QueryMemory::Available() {
+  auto memory = current_query_memory;
+  if (memory == nullptr || query_memory_limit == 0) {
+    return std::numeric_limits<size_t>::max();
+  }
+  return memory->used_ < query_memory_limit
+             ? query_memory_limit - memory->used_
+             : 0;
+}
+
+void QueryMemory::Charge(size_t bytes, const char* what) {
+  auto memory = current_query_memory;
+  if (memory == nullptr) {
+    return;
+  }
+  if (query_memory_limit != 0 && bytes > Available()) {
+    throw QueryMemoryExceeded(std::string(what) + " needs " +
+                              std::to_string(bytes) +
+                              " more bytes, past the memory limit of " +
+                              std::to_string(query_memory_limit) +
+                              " bytes of a query");
+  }
+  memory->used_ += bytes;
+  memory->peak_ = std::max(memory->peak_, memory->used_);
+}
+
+void QueryMemory::Release(size_t bytes) {
+  auto memory = current_query_memory;
+  if (memory != nullptr) {
+    memory->used_ -= std::min(bytes, memory->used_);
+  }
+}
+
+}  // namespace gs
@@ -0,0 +1,106 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GRAPHSCOPE_UTILS_QUERY_MEMORY_H_
+#define GRAPHSCOPE_UTILS_QUERY_MEMORY_H_
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+
+namespace gs {
+
+/**
+ * @brief Thrown by an operator whose state would take the query past its
+ * memory limit, failing the query instead of the server.
+ */
+class QueryMemoryExceeded : public std::runtime_error {
+ public:
+  explicit QueryMemoryExceeded(const std::string& msg)
+      : std::runtime_error(msg) {}
+};
+
+/**
+ * @brief Accounts the memory taken by the operators of the query running on
+ * this thread, from its construction to its destruction, against a process
+ * wide limit per query.
+ *
+ * Operators charge the state they build, e.g. the groups of a group by, and
+ * the ones able to spill, e.g. sorts, check Available() first to go to disk
+ * instead. The charges are estimates of the large structures, not a count of
+ * every allocation. Kept in this library, so that queries loaded as separate
+ * libraries share the limit and the accounting of the thread.
+ */
+class QueryMemory {
+ public:
+  /**
+   * @brief Set the limit of every query, 0 for none, and the directory of
+   * the files operators spill to, the system temporary one if empty.
+   */
+  static void Configure(size_t limit, const std::string& spill_dir);
+
+  static size_t Limit();
+  static const std::string& SpillDir();
+
+  QueryMemory();
+  ~QueryMemory();
+
+  QueryMemory(const QueryMemory&) = delete;
+  QueryMemory& operator=(const QueryMemory&) = delete;
+
+  /**
+   * @brief Bytes the current query may still charge, unbounded without a
+   * limit or out of queries.
+   */
+  static size_t Available();
+
+  /**
+   * @brief Charge bytes to the current query, throwing QueryMemoryExceeded
+   * with what in the message if it goes past the limit.
+   */
+  static void Charge(size_t bytes, const char* what);
+
+  static void Release(size_t bytes);
+
+ private:
+  size_t used_;
+  size_t peak_;
+  QueryMemory* prev_;
+};
+
+/**
+ * @brief The charges of an operator, released when it's done.
+ */
+class QueryMemoryCharge {
+ public:
+  explicit QueryMemoryCharge(const char* what) : what_(what), bytes_(0) {}
+  ~QueryMemoryCharge() { QueryMemory::Release(bytes_); }
+
+  QueryMemoryCharge(const QueryMemoryCharge&) = delete;
+  QueryMemoryCharge& operator=(const QueryMemoryCharge&) = delete;
+
+  void Grow(size_t bytes) {
+    QueryMemory::Charge(bytes, what_);
+    bytes_ += bytes;
+  }
+
+ private:
+  const char* what_;
+  size_t bytes_;
+};
+
+}  // namespace gs
+
+#endif  // GRAPHSCOPE_UTILS_QUERY_MEMORY_H_
@@ -0,0 +1,97 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "flex/utils/query_profile.h"
+
+#include <deque>
+#include <mutex>
+#include <sstream>
+
+namespace gs {
+
+// Number of query profiles kept.
+static constexpr size_t kRecentProfileNum = 64;
+
+static thread_local QueryProfiler* current_profiler = nullptr;
+
+static std::mutex recent_mutex;
+static std::deque<QueryProfile> recent_profiles;
+
+static int64_t elapsed_us_since(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+QueryProfiler::QueryProfiler(const std::string& query_name)
+    : start_(std::chrono::steady_clock::now()), prev_(current_profiler) {
+  profile_.query_name = query_name;
+  profile_.elapsed_us = 0;
+  current_profiler = this;
+}
+
+QueryProfiler::~QueryProfiler() {
+  current_profiler = prev_;
+  profile_.elapsed_us = elapsed_us_since(start_);
+  std::lock_guard<std::mutex> lock(recent_mutex);
+  recent_profiles.emplace_back(std::move(profile_));
+  if (recent_profiles.size() > kRecentProfileNum) {
+    recent_profiles.pop_front();
+  }
+}
+
+void QueryProfiler::BeginOperator() {
+  if (current_profiler != nullptr) {
+    current_profiler->op_starts_.push_back(std::chrono::steady_clock::now());
+  }
+}
+
+void QueryProfiler::EndOperator(const char* name, size_t output_num) {
+  if (current_profiler == nullptr || current_profiler->op_starts_.empty()) {
+    return;
+  }
+  auto start = current_profiler->op_starts_.back();
+  current_profiler->op_starts_.pop_back();
+  current_profiler->profile_.operators.push_back(
+      {name, elapsed_us_since(start), output_num});
+}
+
+std::vector<QueryProfile> QueryProfiler::Recent() {
+  std::lock_guard<std::mutex> lock(recent_mutex);
+  return std::vector<QueryProfile>(recent_profiles.begin(),
+                                   recent_profiles.end());
+}
+
+std::string QueryProfiler::RecentToJson() {
+  auto profiles = Recent();
+  std::stringstream ss;
+  ss << "[";
+  for (size_t i = 0; i < profiles.size(); ++i) {
+    const auto& profile = profiles[i];
+    ss << (i == 0 ? "" : ", ") << "{\"query\": \"" << profile.query_name
+       << "\", \"elapsed_us\": " << profile.elapsed_us << ", \"operators\": [";
+    for (size_t j = 0; j < profile.operators.size(); ++j) {
+      const auto& op = profile.operators[j];
+      ss << (j == 0 ? "" : ", ") << "{\"name\": \"" << op.name
+         << "\", \"elapsed_us\": " << op.elapsed_us
+         << ", \"output_num\": " << op.output_num << "}";
+    }
+    ss << "]}";
+  }
+  ss << "]";
+  return ss.str();
+}
+
+}  // namespace gs
@@ -0,0 +1,76 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GRAPHSCOPE_UTILS_QUERY_PROFILE_H_
+#define GRAPHSCOPE_UTILS_QUERY_PROFILE_H_
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace gs {
+
+struct OperatorProfile {
+  std::string name;
+  int64_t elapsed_us;
+  // number of rows of the context after the operator
+  size_t output_num;
+};
+
+struct QueryProfile {
+  std::string query_name;
+  int64_t elapsed_us;
+  std::vector<OperatorProfile> operators;
+};
+
+/**
+ * @brief Collects the profile of the query running on this thread, from its
+ * construction to its destruction. Profiles are kept process wide, in this
+ * library so that queries loaded as separate libraries share them.
+ */
+class QueryProfiler {
+ public:
+  explicit QueryProfiler(const std::string& query_name);
+  ~QueryProfiler();
+
+  QueryProfiler(const QueryProfiler&) = delete;
+  QueryProfiler& operator=(const QueryProfiler&) = delete;
+
+  /**
+   * @brief Start timing an operator of the current query, operators begun
+   * before it ends are nested in it. Ignored out of profiled queries.
+   */
+  static void BeginOperator();
+
+  /** @brief Record the operator begun last, with its output size. */
+  static void EndOperator(const char* name, size_t output_num);
+
+  /** @brief The profiles of the latest queries, oldest first. */
+  static std::vector<QueryProfile> Recent();
+
+  /** @brief Dump the profiles of the latest queries as json. */
+  static std::string RecentToJson();
+
+ private:
+  QueryProfile profile_;
+  std::chrono::steady_clock::time_point start_;
+  std::vector<std::chrono::steady_clock::time_point> op_starts_;
+  QueryProfiler* prev_;
+};
+
+}  // namespace gs
+
+#endif  // GRAPHSCOPE_UTILS_QUERY_PROFILE_H_
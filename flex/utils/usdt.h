@@ -0,0 +1,37 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * 	http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GRAPHSCOPE_UTILS_USDT_H_
+#define GRAPHSCOPE_UTILS_USDT_H_
+
+// Static tracepoints of the provider "flex", for attaching bpftrace or
+// SystemTap to a live server, e.g.
+//   bpftrace -e 'usdt:./rt_server:flex:wal_append_end { ... }'
+// They are compiled in only with FLEX_WITH_USDT, see BUILD_WITH_USDT. Until a
+// tracer attaches, a probe costs a nop and the setup of its arguments, which
+// should be values already at hand.
+#ifdef FLEX_WITH_USDT
+#include <sys/sdt.h>
+
+#define FLEX_PROBE0(name) DTRACE_PROBE(flex, name)
+#define FLEX_PROBE1(name, a) DTRACE_PROBE1(flex, name, a)
+#define FLEX_PROBE2(name, a, b) DTRACE_PROBE2(flex, name, a, b)
+#else
+#define FLEX_PROBE0(name)
+#define FLEX_PROBE1(name, a)
+#define FLEX_PROBE2(name, a, b)
+#endif
+
+#endif  // GRAPHSCOPE_UTILS_USDT_H_
@@ -34,6 +34,7 @@ pub type PartitionSnapshotHandle = *const c_void;
 pub type ErrorHandle = *const c_void;
 pub type VertexHandle = *const c_void;
 pub type VertexIteratorHandle = *const c_void;
+pub type VertexBlockHandle = *const c_void;
 pub type EdgeHandle = *const c_void;
 pub type EdgeIteratorHandle = *const c_void;
 pub type PropertyHandle = *const c_void;
@@ -43,6 +44,7 @@ pub type FfiSnapshot = WrapperPartitionSnapshot<GraphStore>;
 pub type FfiVertex = RocksVertexImpl;
 pub type FfiEdge = RocksEdgeImpl;
 pub type FfiVertexIterator = Records<FfiVertex>;
+pub type FfiVertexBlock = Vec<FfiVertex>;
 pub type FfiEdgeIterator = Records<FfiEdge>;
 pub type FfiProperty = PropertyImpl;
 pub type FfiPropertyIterator = PropertiesIter<'static>;
@@ -333,6 +335,79 @@ pub extern "C" fn VertexIteratorNext(
     }
 }
 
+/// Take at most `max_size` vertices from the iterator at once, the block is empty when the iterator
+/// is exhausted.
+#[no_mangle]
+pub extern "C" fn VertexIteratorNextBatch(
+    vertex_iterator_handle: VertexIteratorHandle, max_size: usize, error: *mut ErrorHandle,
+) -> VertexBlockHandle {
+    trace!("Vertex iterator next batch");
+    unsafe {
+        let handler = &mut *(vertex_iterator_handle as *mut FfiVertexIterator);
+        let mut block = Box::new(FfiVertexBlock::new());
+        while block.len() < max_size {
+            match handler.next() {
+                Some(Ok(data)) => block.push(data),
+                Some(Err(e)) => {
+                    let error_hdl = Box::new(e);
+                    *error = Box::into_raw(error_hdl) as ErrorHandle;
+                    return ::std::ptr::null();
+                }
+                None => break,
+            }
+        }
+        Box::into_raw(block) as VertexBlockHandle
+    }
+}
+
+#[no_mangle]
+pub extern "C" fn GetVertexBlockSize(vertex_block_handle: VertexBlockHandle) -> usize {
+    trace!("Get vertex block size");
+    unsafe {
+        let handler = &*(vertex_block_handle as *const FfiVertexBlock);
+        handler.len()
+    }
+}
+
+/// Fill `ids_out`, which holds at least as many ids as the block, with the ids of the vertices.
+#[no_mangle]
+pub extern "C" fn GetVertexBlockIds(vertex_block_handle: VertexBlockHandle, ids_out: *mut VertexId) {
+    trace!("Get vertex block ids");
+    unsafe {
+        let handler = &*(vertex_block_handle as *const FfiVertexBlock);
+        for (i, v) in handler.iter().enumerate() {
+            *ids_out.add(i) = v.get_vertex_id();
+        }
+    }
+}
+
+/// Fill `label_ids_out`, which holds at least as many ids as the block, with the labels of the
+/// vertices.
+#[no_mangle]
+pub extern "C" fn GetVertexBlockLabelIds(
+    vertex_block_handle: VertexBlockHandle, label_ids_out: *mut LabelId,
+) {
+    trace!("Get vertex block label ids");
+    unsafe {
+        let handler = &*(vertex_block_handle as *const FfiVertexBlock);
+        for (i, v) in handler.iter().enumerate() {
+            *label_ids_out.add(i) = v.get_label_id();
+        }
+    }
+}
+
+/// The vertex at `index` of the block, owned by the block and must not be released.
+#[no_mangle]
+pub extern "C" fn GetVertexBlockVertex(
+    vertex_block_handle: VertexBlockHandle, index: usize,
+) -> VertexHandle {
+    trace!("Get vertex block vertex");
+    unsafe {
+        let handler = &*(vertex_block_handle as *const FfiVertexBlock);
+        &handler[index] as *const FfiVertex as VertexHandle
+    }
+}
+
 #[no_mangle]
 pub extern "C" fn GetVertexId(vertex_handle: VertexHandle) -> VertexId {
     trace!("Get vertex id");
@@ -646,6 +721,15 @@ pub extern "C" fn ReleaseVertexIteratorHandle(ptr: VertexIteratorHandle) {
     }
 }
 
+#[no_mangle]
+pub extern "C" fn ReleaseVertexBlockHandle(ptr: VertexBlockHandle) {
+    trace!("Release vertex block handle");
+    let handler = ptr as *mut FfiVertexBlock;
+    unsafe {
+        drop(Box::from_raw(handler));
+    }
+}
+
 #[no_mangle]
 pub extern "C" fn ReleaseEdgeHandle(ptr: EdgeHandle) {
     trace!("Release edge handle");
@@ -253,6 +253,59 @@ int v6d_out_edge_next(OutEdgeIterator iter, struct Edge* e_out) {
   return htap_impl::out_edge_next((htap_impl::EdgeIteratorImpl*)iter, e_out);
 }
 
+int v6d_out_edge_next_batch(OutEdgeIterator iter, struct Edge* e_out, int cap) {
+#ifndef NDEBUG
+  LOG(INFO) << "enter " << __FUNCTION__;
+#endif
+  return htap_impl::out_edge_next_batch((htap_impl::EdgeIteratorImpl*)iter,
+                                        e_out, cap);
+}
+
+OutEdgeBatch v6d_get_out_edges_batch(GraphHandle graph, PartitionId partition_id,
+                                     VertexId* src_ids, int src_count,
+                                     LabelId* labels, int labels_count,
+                                     int64_t limit) {
+#ifndef NDEBUG
+  LOG(INFO) << "enter " << __FUNCTION__;
+#endif
+  htap_impl::GraphHandleImpl* casted_graph =
+      static_cast<htap_impl::GraphHandleImpl*>(graph);
+  auto* ret = new htap_impl::OutEdgeBatchImpl();
+  std::vector<LabelId> transformed_labels(labels_count);
+  for (int i = 0; i < labels_count; ++i) {
+    transformed_labels[i] = labels[i] - casted_graph->vertex_label_num;
+  }
+  if (casted_graph->use_int64_oid) {
+    htap_impl::get_out_edges_batch(
+      &(casted_graph->fragments[partition_id / casted_graph->channel_num]),
+      &(casted_graph->eid_parser), src_ids, src_count,
+      transformed_labels.data(), labels_count, limit, ret);
+  } else {
+    htap_impl::get_out_edges_batch(
+      &(casted_graph->string_fragments[partition_id / casted_graph->channel_num]),
+      &(casted_graph->eid_parser), src_ids, src_count,
+      transformed_labels.data(), labels_count, limit, ret);
+  }
+#ifndef NDEBUG
+  LOG(INFO) << "finish " << __FUNCTION__;
+#endif
+  return ret;
+}
+
+void v6d_free_out_edge_batch(OutEdgeBatch batch) {
+  delete static_cast<htap_impl::OutEdgeBatchImpl*>(batch);
+}
+
+int64_t v6d_out_edge_batch_get(OutEdgeBatch batch, const int64_t** offsets,
+                               const VertexId** dst_ids,
+                               const int64_t** edge_offsets) {
+  auto* impl = static_cast<htap_impl::OutEdgeBatchImpl*>(batch);
+  *offsets = impl->offsets.data();
+  *dst_ids = impl->dst_ids.data();
+  *edge_offsets = impl->edge_ids.data();
+  return impl->dst_ids.size();
+}
+
 InEdgeIterator v6d_get_in_edges(GraphHandle graph, PartitionId partition_id,
                             VertexId dst_id, LabelId* labels, int labels_count,
                             int64_t limit) {
@@ -306,6 +359,14 @@ int v6d_in_edge_next(InEdgeIterator iter, struct Edge* e_out) {
   return htap_impl::in_edge_next((htap_impl::EdgeIteratorImpl*)iter, e_out);
 }
 
+int v6d_in_edge_next_batch(InEdgeIterator iter, struct Edge* e_out, int cap) {
+#ifndef NDEBUG
+  LOG(INFO) << "enter " << __FUNCTION__;
+#endif
+  return htap_impl::in_edge_next_batch((htap_impl::EdgeIteratorImpl*)iter,
+                                       e_out, cap);
+}
+
 GetAllEdgesIterator v6d_get_all_edges(GraphHandle graph, PartitionId partition_id,
                                   LabelId* labels, int labels_count,
                                   int64_t limit) {
@@ -359,6 +420,121 @@ int v6d_get_all_edges_next(GetAllEdgesIterator iter, struct Edge* e_out) {
       (htap_impl::GetAllEdgesIteratorImpl*)iter, e_out);
 }
 
+static ScanSplits get_partition_scan_splits(GraphHandle graph,
+                                            PartitionId partition_id,
+                                            LabelId* v_labels,
+                                            int v_labels_count,
+                                            LabelId* e_labels,
+                                            int e_labels_count,
+                                            bool weigh_by_edges,
+                                            int split_num) {
+#ifndef NDEBUG
+  LOG(INFO) << "enter " << __FUNCTION__ << ": partition_id = " << partition_id
+            << ", split_num = " << split_num;
+#endif
+  htap_impl::GraphHandleImpl* casted_graph =
+      static_cast<htap_impl::GraphHandleImpl*>(graph);
+  auto* ret = new htap_impl::ScanSplitsImpl();
+  PartitionId fid = partition_id / casted_graph->channel_num;
+  if (casted_graph->use_int64_oid) {
+    htap_impl::get_scan_splits(
+      &(casted_graph->fragments[fid]), partition_id % casted_graph->channel_num,
+      casted_graph->vertex_chunk_sizes[fid], v_labels, v_labels_count,
+      e_labels, e_labels_count, weigh_by_edges, split_num, ret);
+  } else {
+    htap_impl::get_scan_splits(
+      &(casted_graph->string_fragments[fid]), partition_id % casted_graph->channel_num,
+      casted_graph->vertex_chunk_sizes[fid], v_labels, v_labels_count,
+      e_labels, e_labels_count, weigh_by_edges, split_num, ret);
+  }
+  return ret;
+}
+
+ScanSplits v6d_get_vertex_scan_splits(GraphHandle graph,
+                                      PartitionId partition_id,
+                                      LabelId* labels, int labels_count,
+                                      int split_num) {
+  return get_partition_scan_splits(graph, partition_id, labels, labels_count,
+                                   NULL, 0, false, split_num);
+}
+
+ScanSplits v6d_get_edge_scan_splits(GraphHandle graph, PartitionId partition_id,
+                                    LabelId* labels, int labels_count,
+                                    int split_num) {
+  htap_impl::GraphHandleImpl* casted_graph =
+      static_cast<htap_impl::GraphHandleImpl*>(graph);
+  std::vector<LabelId> transformed_labels(labels_count);
+  for (int i = 0; i < labels_count; ++i) {
+    transformed_labels[i] = labels[i] - casted_graph->vertex_label_num;
+  }
+  return get_partition_scan_splits(graph, partition_id, NULL, 0,
+                                   transformed_labels.data(), labels_count,
+                                   true, split_num);
+}
+
+int v6d_scan_splits_count(ScanSplits splits) {
+  return static_cast<htap_impl::ScanSplitsImpl*>(splits)->splits.size();
+}
+
+int v6d_scan_split_get(ScanSplits splits, int index, LabelId* label,
+                       VertexId* begin, VertexId* end) {
+  auto* impl = static_cast<htap_impl::ScanSplitsImpl*>(splits);
+  if (index < 0 || index >= static_cast<int>(impl->splits.size())) {
+    return -1;
+  }
+  const htap_impl::ScanSplit& split = impl->splits[index];
+  *label = split.label;
+  *begin = split.begin;
+  *end = split.end;
+  return 0;
+}
+
+void v6d_free_scan_splits(ScanSplits splits) {
+  delete static_cast<htap_impl::ScanSplitsImpl*>(splits);
+}
+
+GetAllVerticesIterator v6d_get_vertices_in_range(GraphHandle graph,
+                                                 PartitionId partition_id,
+                                                 VertexId begin, VertexId end,
+                                                 int64_t limit) {
+  GetAllVerticesIterator ret =
+      malloc(sizeof(htap_impl::GetAllVerticesIteratorImpl));
+  htap_impl::get_vertices_in_range(
+      begin, end, limit, (htap_impl::GetAllVerticesIteratorImpl*)ret);
+  return ret;
+}
+
+GetAllEdgesIterator v6d_get_edges_in_range(GraphHandle graph,
+                                           PartitionId partition_id,
+                                           VertexId begin, VertexId end,
+                                           LabelId* labels, int labels_count,
+                                           int64_t limit) {
+#ifndef NDEBUG
+  LOG(INFO) << "enter " << __FUNCTION__ << ": partition_id = " << partition_id
+            << ", range = [" << begin << ", " << end << ")";
+#endif
+  htap_impl::GraphHandleImpl* casted_graph =
+      static_cast<htap_impl::GraphHandleImpl*>(graph);
+  GetAllEdgesIterator ret = malloc(sizeof(htap_impl::GetAllEdgesIteratorImpl));
+  std::vector<LabelId> transformed_labels(labels_count);
+  for (int i = 0; i < labels_count; ++i) {
+    transformed_labels[i] = labels[i] - casted_graph->vertex_label_num;
+  }
+  PartitionId fid = partition_id / casted_graph->channel_num;
+  if (casted_graph->use_int64_oid) {
+    htap_impl::get_edges_in_range(
+      &(casted_graph->fragments[fid]), &(casted_graph->eid_parser), begin, end,
+      transformed_labels.data(), labels_count, limit,
+      (htap_impl::GetAllEdgesIteratorImpl*)ret);
+  } else {
+    htap_impl::get_edges_in_range(
+      &(casted_graph->string_fragments[fid]), &(casted_graph->eid_parser),
+      begin, end, transformed_labels.data(), labels_count, limit,
+      (htap_impl::GetAllEdgesIteratorImpl*)ret);
+  }
+  return ret;
+}
+
 VertexId v6d_get_edge_src_id(GraphHandle graph, struct Edge* e) { return e->src; }
 
 VertexId v6d_get_edge_dst_id(GraphHandle graph, struct Edge* e) { return e->dst; }
@@ -460,6 +636,22 @@ int v6d_get_edge_property(GraphHandle graph, struct Edge* e, PropertyId id,
   return r;
 }
 
+int v6d_get_edges_property(GraphHandle graph, struct Edge* edges, int count,
+                           PropertyId id, Property* p_out) {
+#ifndef NDEBUG
+  LOG(INFO) << "enter " << __FUNCTION__;
+#endif
+  int found = 0;
+  for (int i = 0; i < count; ++i) {
+    if (v6d_get_edge_property(graph, &edges[i], id, &p_out[i]) == 0) {
+      ++found;
+    } else {
+      p_out[i].data = nullptr;
+    }
+  }
+  return found;
+}
+
 PropertiesIterator v6d_get_edge_properties(GraphHandle graph, struct Edge* e) {
 #ifndef NDEBUG
   LOG(INFO) << "enter " << __FUNCTION__;
@@ -35,6 +35,8 @@ typedef void* GetVertexIterator;
 typedef void* GetAllVerticesIterator;
 typedef void* GetAllEdgesIterator;
 typedef void* PropertiesIterator;
+typedef void* OutEdgeBatch;
+typedef void* ScanSplits;
 typedef void* Schema;
 
 typedef int64_t Vertex;
@@ -151,6 +153,27 @@ void v6d_free_out_edge_iterator(OutEdgeIterator iter);
 // 从迭代器取出下一个元素，返回值是一个Edge
 int v6d_out_edge_next(OutEdgeIterator iter, struct Edge* e_out);
 
+// 从迭代器取出至多cap个元素，填入e_out，返回值是取出的个数，为0表示迭代结束
+int v6d_out_edge_next_batch(OutEdgeIterator iter, struct Edge* e_out, int cap);
+
+// 批量查询某个partition内一组点的出边
+// src_ids是待查询的点id列表，src_count是其长度
+// labels和labels_count的含义同v6d_get_out_edges，limit表示每个点返回的最大结果数
+// 返回值是一个批量结果，用v6d_out_edge_batch_get读取
+OutEdgeBatch v6d_get_out_edges_batch(GraphHandle graph, PartitionId partition_id,
+                                     VertexId* src_ids, int src_count,
+                                     LabelId* labels, int labels_count,
+                                     int64_t limit);
+
+// 释放批量结果
+void v6d_free_out_edge_batch(OutEdgeBatch batch);
+
+// 读取批量结果，第i个点的出边是[offsets[i], offsets[i + 1])范围内的dst_ids和edge_offsets，
+// edge_offsets即Edge中的offset，offsets的长度是src_count + 1，返回值是总边数
+int64_t v6d_out_edge_batch_get(OutEdgeBatch batch, const int64_t** offsets,
+                               const VertexId** dst_ids,
+                               const int64_t** edge_offsets);
+
 // 查询某个partition内的点的入边
 // src_ids是待查询的点id列表
 // labels是label列表，表示查询这些点的这些label的出边
@@ -167,6 +190,9 @@ void v6d_free_in_edge_iterator(InEdgeIterator iter);
 // 从迭代器取出下一个元素，返回值是一个Edge
 int v6d_in_edge_next(InEdgeIterator iter, struct Edge* e_out);
 
+// 从迭代器取出至多cap个元素，填入e_out，返回值是取出的个数，为0表示迭代结束
+int v6d_in_edge_next_batch(InEdgeIterator iter, struct Edge* e_out, int cap);
+
 // 查询某个partition内某些label的边数据
 // labels是待查询的label列表
 // labels_count表示label列表的长度
@@ -183,6 +209,47 @@ void v6d_free_get_all_edges_iterator(GetAllEdgesIterator iter);
 // 从迭代器取出下一个元素，返回值是一个Edge
 int v6d_get_all_edges_next(GetAllEdgesIterator iter, struct Edge* e_out);
 
+// 把某个partition内的全量扫描切分成约split_num个分片，分片可以并行扫描
+// 每个分片是同一个点label下gid连续的一段点，按点数切分
+// labels是待扫描的点label列表，labels_count表示label列表的长度
+// 注意：如果label_count为0或者labels为null，则扫描所有label
+ScanSplits v6d_get_vertex_scan_splits(GraphHandle graph,
+                                      PartitionId partition_id,
+                                      LabelId* labels, int labels_count,
+                                      int split_num);
+
+// 同v6d_get_vertex_scan_splits，但是按这些点在labels下的出边数切分，用于边的全量扫描
+// labels是待扫描的边label列表，labels_count表示label列表的长度
+// 注意：如果label_count为0或者labels为null，则扫描所有label
+ScanSplits v6d_get_edge_scan_splits(GraphHandle graph, PartitionId partition_id,
+                                    LabelId* labels, int labels_count,
+                                    int split_num);
+
+// 返回分片的个数，可能比split_num略多，因为一个分片不会跨越点label
+int v6d_scan_splits_count(ScanSplits splits);
+
+// 读取第index个分片，分片包含label下gid在[begin, end)范围内的点，返回值为0表示成功
+int v6d_scan_split_get(ScanSplits splits, int index, LabelId* label,
+                       VertexId* begin, VertexId* end);
+
+// 释放分片
+void v6d_free_scan_splits(ScanSplits splits);
+
+// 查询一个分片内的点，返回值是一个迭代器，用v6d_get_all_vertices_next读取，
+// 用v6d_free_get_all_vertices_iterator释放
+GetAllVerticesIterator v6d_get_vertices_in_range(GraphHandle graph,
+                                                 PartitionId partition_id,
+                                                 VertexId begin, VertexId end,
+                                                 int64_t limit);
+
+// 查询一个分片内的点的出边，labels和labels_count的含义同v6d_get_all_edges
+// 返回值是一个迭代器，用v6d_get_all_edges_next读取，用v6d_free_get_all_edges_iterator释放
+GetAllEdgesIterator v6d_get_edges_in_range(GraphHandle graph,
+                                           PartitionId partition_id,
+                                           VertexId begin, VertexId end,
+                                           LabelId* labels, int labels_count,
+                                           int64_t limit);
+
 // 从edge对象获取起点id
 VertexId v6d_get_edge_src_id(GraphHandle graph, struct Edge* e);
 
@@ -205,6 +272,11 @@ LabelId v6d_get_edge_label(GraphHandle graph, struct Edge* e);
 int v6d_get_edge_property(GraphHandle graph, struct Edge*, PropertyId id,
                       struct Property* p_out);
 
+// 获取一批边的同一个属性，第i条边的属性填入p_out[i]，没有该属性的边对应的data置为nullptr
+// 返回值是取到属性的边数
+int v6d_get_edges_property(GraphHandle graph, struct Edge* edges, int count,
+                           PropertyId id, struct Property* p_out);
+
 // 获取边的属性列表，返回一个迭代器
 PropertiesIterator v6d_get_edge_properties(GraphHandle graph, struct Edge*);
 
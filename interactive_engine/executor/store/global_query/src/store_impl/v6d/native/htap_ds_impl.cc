@@ -15,6 +15,7 @@
  */
 #include "htap_ds_impl.h"
 
+#include <algorithm>
 #include <cstdlib>
 #include <memory>
 #include <string>
@@ -841,6 +842,84 @@ void get_out_edges(STRING_FRAGMENT_TYPE* frag,
                    LabelId* labels, int labels_count, int64_t limit,
                    EdgeIteratorImpl* iter);
 
+template <typename FRAGMENT_TYPE_T>
+void get_out_edges_batch(FRAGMENT_TYPE_T* frag,
+                         vineyard::IdParser<EID_TYPE>* eid_parser,
+                         const VertexId* src_ids, int src_count,
+                         LabelId* labels, int labels_count, int64_t limit,
+                         OutEdgeBatchImpl* out) {
+#ifndef NDEBUG
+  LOG(INFO) << "enter " << __FUNCTION__;
+#endif
+  // the label list is resolved once for the batch, rather than per source
+  std::vector<typename FRAGMENT_TYPE_T::label_id_t> e_labels;
+  if (labels == NULL || labels_count == 0) {
+    for (int i = 0; i < frag->edge_label_num(); ++i) {
+      e_labels.push_back(i);
+    }
+  } else {
+    for (int i = 0; i < labels_count; ++i) {
+      if (labels[i] >= 0) {
+        e_labels.push_back(labels[i]);
+      }
+    }
+  }
+  FRAG_ID_TYPE frag_id = frag->fid();
+
+  out->offsets.clear();
+  out->dst_ids.clear();
+  out->edge_ids.clear();
+  out->offsets.reserve(src_count + 1);
+  out->offsets.push_back(0);
+  for (int i = 0; i < src_count; ++i) {
+    VERTEX_TYPE vert;
+    if (frag->InnerVertexGid2Vertex((VID_TYPE)src_ids[i], vert) &&
+        limit != 0) {
+      size_t limit_remaining = limit;
+      for (auto label : e_labels) {
+        auto adj_list = frag->GetOutgoingAdjList(vert, label);
+        const NBR_TYPE* begin = adj_list.begin_unit();
+        size_t size = adj_list.end_unit() - begin;
+        if (size > limit_remaining) {
+          size = limit_remaining;
+        }
+        for (size_t j = 0; j < size; ++j) {
+          out->dst_ids.push_back(frag->Vertex2Gid(VERTEX_TYPE(begin[j].vid)));
+          out->edge_ids.push_back(
+              eid_parser->GenerateId(frag_id, label, begin[j].eid));
+        }
+        limit_remaining -= size;
+        if (limit_remaining == 0) {
+          break;
+        }
+      }
+    }
+    out->offsets.push_back(out->dst_ids.size());
+  }
+#ifndef NDEBUG
+  LOG(INFO) << "exit " << __FUNCTION__;
+#endif
+}
+
+template
+void get_out_edges_batch(FRAGMENT_TYPE* frag,
+                         vineyard::IdParser<EID_TYPE>* eid_parser,
+                         const VertexId* src_ids, int src_count,
+                         LabelId* labels, int labels_count, int64_t limit,
+                         OutEdgeBatchImpl* out);
+template
+void get_out_edges_batch(INT32_FRAGMENT_TYPE* frag,
+                         vineyard::IdParser<EID_TYPE>* eid_parser,
+                         const VertexId* src_ids, int src_count,
+                         LabelId* labels, int labels_count, int64_t limit,
+                         OutEdgeBatchImpl* out);
+template
+void get_out_edges_batch(STRING_FRAGMENT_TYPE* frag,
+                         vineyard::IdParser<EID_TYPE>* eid_parser,
+                         const VertexId* src_ids, int src_count,
+                         LabelId* labels, int labels_count, int64_t limit,
+                         OutEdgeBatchImpl* out);
+
 int out_edge_next(EdgeIteratorImpl* iter, Edge* e_out) {
 #ifndef NDEBUG
   LOG(INFO) << "enter " << __FUNCTION__;
@@ -1017,20 +1096,54 @@ int in_edge_next(EdgeIteratorImpl* iter, Edge* e_out) {
   return 0;
 }
 
-template <typename FRAGMENT_TYPE_T>
-void get_all_edges(FRAGMENT_TYPE_T* frag, PartitionId channel_id,
-                   const VID_TYPE* chunk_sizes,
-                   vineyard::IdParser<EID_TYPE>* eid_parser, LabelId* labels,
-                   int labels_count, int64_t limit,
-                   GetAllEdgesIteratorImpl* out) {
-#ifndef NDEBUG
-  LOG(INFO) << "enter " << __FUNCTION__;
-  LOG(INFO) << "edge label count " << labels_count;
-  for (int i = 0; i < labels_count; i++) {
-    LOG(INFO) << "index " << i << " label value " << labels[i];
+// fills at most cap edges by walking the adjacent lists directly, the
+// neighbor is the destination of out edges and the source of in edges
+static int edges_next_batch(EdgeIteratorImpl* iter, Edge* e_out, int cap,
+                            bool out) {
+  if (iter->list_id == iter->list_num) {
+    return 0;
   }
-#endif
+  FRAG_ID_TYPE frag_id = iter->fragment != nullptr
+                             ? iter->fragment->fid()
+                             : iter->string_fragment->fid();
+  int count = 0;
+  while (count < cap && iter->list_id != iter->list_num) {
+    const AdjListUnit& list = iter->lists[iter->list_id];
+    for (; iter->cur_edge != list.end && count < cap;
+         ++iter->cur_edge, ++count) {
+      VERTEX_TYPE nbr(iter->cur_edge->vid);
+      VertexId nbr_id = iter->fragment != nullptr
+                            ? iter->fragment->Vertex2Gid(nbr)
+                            : iter->string_fragment->Vertex2Gid(nbr);
+      Edge& e = e_out[count];
+      e.src = out ? iter->src : nbr_id;
+      e.dst = out ? nbr_id : iter->src;
+      e.offset =
+          iter->eid_parser->GenerateId(frag_id, list.label, iter->cur_edge->eid);
+    }
+    if (iter->cur_edge == list.end) {
+      ++iter->list_id;
+      if (iter->list_id != iter->list_num) {
+        iter->cur_edge = iter->lists[iter->list_id].begin;
+      }
+    }
+  }
+  return count;
+}
+
+int out_edge_next_batch(EdgeIteratorImpl* iter, Edge* e_out, int cap) {
+  return edges_next_batch(iter, e_out, cap, true);
+}
 
+int in_edge_next_batch(EdgeIteratorImpl* iter, Edge* e_out, int cap) {
+  return edges_next_batch(iter, e_out, cap, false);
+}
+
+template <typename FRAGMENT_TYPE_T>
+static void init_all_edges_iterator(FRAGMENT_TYPE_T* frag,
+                                    vineyard::IdParser<EID_TYPE>* eid_parser,
+                                    LabelId* labels, int labels_count,
+                                    GetAllEdgesIteratorImpl* out) {
   if (frag->oid_typename() == vineyard::type_name<OID_TYPE>()) {
     out->fragment = reinterpret_cast<FRAGMENT_TYPE *>(frag);
     out->int32_fragment = nullptr;
@@ -1048,7 +1161,24 @@ void get_all_edges(FRAGMENT_TYPE_T* frag, PartitionId channel_id,
   out->eid_parser = eid_parser;
   memcpy(out->e_labels, labels, sizeof(LabelId) * labels_count);
   out->e_labels_count = labels_count;
+}
 
+template <typename FRAGMENT_TYPE_T>
+void get_all_edges(FRAGMENT_TYPE_T* frag, PartitionId channel_id,
+                   const VID_TYPE* chunk_sizes,
+                   vineyard::IdParser<EID_TYPE>* eid_parser, LabelId* labels,
+                   int labels_count, int64_t limit,
+                   GetAllEdgesIteratorImpl* out) {
+#ifndef NDEBUG
+  LOG(INFO) << "enter " << __FUNCTION__;
+  LOG(INFO) << "edge label count " << labels_count;
+  for (int i = 0; i < labels_count; i++) {
+    LOG(INFO) << "index " << i << " label value " << labels[i];
+  }
+#endif
+
+  init_all_edges_iterator(frag, eid_parser, labels, labels_count, out);
+  out->single_range = false;
   out->chunk_sizes = chunk_sizes;
   out->channel_id = channel_id;
 
@@ -1130,6 +1260,9 @@ int get_all_edges_next(GetAllEdgesIteratorImpl* iter, Edge* e_out) {
 
     VID_TYPE cur_vid = iter->ei.src + 1;
     if (cur_vid == iter->cur_range.second) {
+      if (iter->single_range) {
+        return -1;
+      }
       ++iter->cur_v_label;
       typename FRAGMENT_TYPE::vertex_range_t super_range, range;
       while (iter->cur_v_label < vertex_label_num) {
@@ -1192,6 +1325,183 @@ void free_get_all_edges_iterator(GetAllEdgesIteratorImpl* iter) {
   free_edge_iterator(&iter->ei);
 }
 
+template <typename FRAGMENT_TYPE_T>
+void get_scan_splits(FRAGMENT_TYPE_T* frag, PartitionId channel_id,
+                     const VID_TYPE* chunk_sizes, LabelId* v_labels,
+                     int v_labels_count, LabelId* e_labels, int e_labels_count,
+                     bool weigh_by_edges, int split_num, ScanSplitsImpl* out) {
+#ifndef NDEBUG
+  LOG(INFO) << "enter " << __FUNCTION__ << ", split_num = " << split_num;
+#endif
+  using label_id_t = typename FRAGMENT_TYPE_T::label_id_t;
+  std::vector<label_id_t> vertex_labels, edge_labels;
+  if (v_labels == NULL || v_labels_count == 0) {
+    for (int i = 0; i < frag->vertex_label_num(); ++i) {
+      vertex_labels.push_back(i);
+    }
+  } else {
+    for (int i = 0; i < v_labels_count; ++i) {
+      if (v_labels[i] >= 0) {
+        vertex_labels.push_back(v_labels[i]);
+      }
+    }
+  }
+  if (weigh_by_edges) {
+    if (e_labels == NULL || e_labels_count == 0) {
+      for (int i = 0; i < frag->edge_label_num(); ++i) {
+        edge_labels.push_back(i);
+      }
+    } else {
+      for (int i = 0; i < e_labels_count; ++i) {
+        if (e_labels[i] >= 0) {
+          edge_labels.push_back(e_labels[i]);
+        }
+      }
+    }
+  }
+  // the out-degrees are differences of offsets, cheap enough to be computed
+  // twice rather than kept for each vertex
+  auto cost = [&](const VERTEX_TYPE& v) {
+    uint64_t ret = 1;
+    for (auto label : edge_labels) {
+      auto adj_list = frag->GetOutgoingAdjList(v, label);
+      ret += adj_list.end_unit() - adj_list.begin_unit();
+    }
+    return ret;
+  };
+
+  uint64_t total = 0;
+  for (auto label : vertex_labels) {
+    auto range = get_sub_range<FRAGMENT_TYPE_T>(
+        frag->InnerVertices(label), chunk_sizes[label], channel_id);
+    if (edge_labels.empty()) {
+      total += range.size();
+    } else {
+      for (auto v : range) {
+        total += cost(v);
+      }
+    }
+  }
+  uint64_t target = std::max<uint64_t>(
+      (total + std::max(split_num, 1) - 1) / std::max(split_num, 1), 1);
+
+  // a split never crosses labels, so there may be a few more than split_num
+  out->splits.clear();
+  for (auto label : vertex_labels) {
+    auto range = get_sub_range<FRAGMENT_TYPE_T>(
+        frag->InnerVertices(label), chunk_sizes[label], channel_id);
+    if (range.size() == 0) {
+      continue;
+    }
+    ScanSplit split;
+    split.label = label;
+    split.begin = frag->Vertex2Gid(*range.begin());
+    split.end = split.begin;
+    uint64_t acc = 0;
+    for (auto v : range) {
+      acc += cost(v);
+      ++split.end;
+      if (acc >= target) {
+        out->splits.push_back(split);
+        split.begin = split.end;
+        acc = 0;
+      }
+    }
+    if (split.begin != split.end) {
+      out->splits.push_back(split);
+    }
+  }
+#ifndef NDEBUG
+  LOG(INFO) << "finish " << __FUNCTION__ << ", " << out->splits.size()
+            << " splits";
+#endif
+}
+
+template
+void get_scan_splits(FRAGMENT_TYPE* frag, PartitionId channel_id,
+                     const VID_TYPE* chunk_sizes, LabelId* v_labels,
+                     int v_labels_count, LabelId* e_labels, int e_labels_count,
+                     bool weigh_by_edges, int split_num, ScanSplitsImpl* out);
+template
+void get_scan_splits(INT32_FRAGMENT_TYPE* frag, PartitionId channel_id,
+                     const VID_TYPE* chunk_sizes, LabelId* v_labels,
+                     int v_labels_count, LabelId* e_labels, int e_labels_count,
+                     bool weigh_by_edges, int split_num, ScanSplitsImpl* out);
+template
+void get_scan_splits(STRING_FRAGMENT_TYPE* frag, PartitionId channel_id,
+                     const VID_TYPE* chunk_sizes, LabelId* v_labels,
+                     int v_labels_count, LabelId* e_labels, int e_labels_count,
+                     bool weigh_by_edges, int split_num, ScanSplitsImpl* out);
+
+void get_vertices_in_range(VID_TYPE begin, VID_TYPE end, int64_t limit,
+                           GetAllVerticesIteratorImpl* out) {
+  out->range_id = 0;
+  if (begin >= end || limit == 0) {
+    out->ranges = NULL;
+    out->range_num = 0;
+    out->cur_vertex_id = 0;
+    return;
+  }
+  size_t size = end - begin;
+  if (size > static_cast<size_t>(limit)) {
+    size = limit;
+  }
+  out->ranges = static_cast<VERTEX_RANGE_TYPE*>(malloc(sizeof(VERTEX_RANGE_TYPE)));
+  out->ranges[0].first = begin;
+  out->ranges[0].second = begin + size;
+  out->range_num = 1;
+  out->cur_vertex_id = begin;
+}
+
+template <typename FRAGMENT_TYPE_T>
+void get_edges_in_range(FRAGMENT_TYPE_T* frag,
+                        vineyard::IdParser<EID_TYPE>* eid_parser,
+                        VID_TYPE begin, VID_TYPE end, LabelId* labels,
+                        int labels_count, int64_t limit,
+                        GetAllEdgesIteratorImpl* out) {
+#ifndef NDEBUG
+  LOG(INFO) << "enter " << __FUNCTION__ << ", range = [" << begin << ", "
+            << end << ")";
+#endif
+  init_all_edges_iterator(frag, eid_parser, labels, labels_count, out);
+  out->single_range = true;
+  out->chunk_sizes = NULL;
+  out->channel_id = 0;
+  out->index = 0;
+  out->limit = limit;
+
+  VERTEX_TYPE vert;
+  if (begin >= end || !frag->InnerVertexGid2Vertex(begin, vert)) {
+    out->cur_v_label = frag->vertex_label_num();
+    empty_edge_iterator(&out->ei);
+    return;
+  }
+  out->cur_v_label = frag->vertex_label(vert);
+  out->cur_range.first = begin;
+  out->cur_range.second = end;
+  get_out_edges(frag, eid_parser, begin, out->e_labels, out->e_labels_count,
+                limit, &out->ei);
+}
+
+template
+void get_edges_in_range(FRAGMENT_TYPE* frag,
+                        vineyard::IdParser<EID_TYPE>* eid_parser,
+                        VID_TYPE begin, VID_TYPE end, LabelId* labels,
+                        int labels_count, int64_t limit,
+                        GetAllEdgesIteratorImpl* out);
+template
+void get_edges_in_range(INT32_FRAGMENT_TYPE* frag,
+                        vineyard::IdParser<EID_TYPE>* eid_parser,
+                        VID_TYPE begin, VID_TYPE end, LabelId* labels,
+                        int labels_count, int64_t limit,
+                        GetAllEdgesIteratorImpl* out);
+template
+void get_edges_in_range(STRING_FRAGMENT_TYPE* frag,
+                        vineyard::IdParser<EID_TYPE>* eid_parser,
+                        VID_TYPE begin, VID_TYPE end, LabelId* labels,
+                        int labels_count, int64_t limit,
+                        GetAllEdgesIteratorImpl* out);
+
 int get_property_as_bool(Property* property, bool* out) {
   if (property->type != BOOL) {
     return -1;
@@ -17,6 +17,7 @@
 #define ANALYTICAL_ENGINE_HTAP_HTAP_DS_IMPL_H_
 
 #include <utility>
+#include <vector>
 
 #include "vineyard/client/client.h"
 #include "vineyard/graph/fragment/arrow_fragment.h"
@@ -176,6 +177,25 @@ void get_in_edges(FRAGMENT_TYPE* frag, vineyard::IdParser<EID_TYPE>* eid_parser,
 
 int in_edge_next(EdgeIteratorImpl* iter, Edge* e_out);
 
+int out_edge_next_batch(EdgeIteratorImpl* iter, Edge* e_out, int cap);
+
+// the out edges of a batch of sources, the edges of the i-th source are
+// [offsets[i], offsets[i + 1]) of dst_ids and edge_ids
+struct OutEdgeBatchImpl {
+  std::vector<int64_t> offsets;
+  std::vector<VertexId> dst_ids;
+  std::vector<int64_t> edge_ids;
+};
+
+template <typename FRAGMENT_TYPE>
+void get_out_edges_batch(FRAGMENT_TYPE* frag,
+                         vineyard::IdParser<EID_TYPE>* eid_parser,
+                         const VertexId* src_ids, int src_count,
+                         LabelId* labels, int labels_count, int64_t limit,
+                         OutEdgeBatchImpl* out);
+
+int in_edge_next_batch(EdgeIteratorImpl* iter, Edge* e_out, int cap);
+
 struct GetAllEdgesIteratorImpl {
   FRAGMENT_TYPE* fragment = nullptr;
   INT32_FRAGMENT_TYPE* int32_fragment = nullptr;
@@ -194,6 +214,9 @@ struct GetAllEdgesIteratorImpl {
 
   int64_t index;
   int64_t limit;
+
+  // scan [cur_range.first, cur_range.second) only, see get_edges_in_range
+  bool single_range;
 };
 
 template <typename FRAGMENT_TYPE>
@@ -209,6 +232,39 @@ void free_edge_iterator(EdgeIteratorImpl* iter);
 
 void free_get_all_edges_iterator(GetAllEdgesIteratorImpl* iter);
 
+// a split of the inner vertices of a channel, [begin, end) are gids of a
+// single vertex label, the splits of a channel can be scanned in parallel
+struct ScanSplit {
+  LabelId label;
+  VID_TYPE begin;
+  VID_TYPE end;
+};
+
+struct ScanSplitsImpl {
+  std::vector<ScanSplit> splits;
+};
+
+// splits the vertices of v_labels (all labels if empty) in a channel into
+// about split_num splits of balanced cost, a vertex costs 1 plus, when
+// weigh_by_edges, its out-degree over e_labels (all labels if empty)
+template <typename FRAGMENT_TYPE>
+void get_scan_splits(FRAGMENT_TYPE* frag, PartitionId channel_id,
+                     const VID_TYPE* chunk_sizes, LabelId* v_labels,
+                     int v_labels_count, LabelId* e_labels, int e_labels_count,
+                     bool weigh_by_edges, int split_num, ScanSplitsImpl* out);
+
+void get_vertices_in_range(VID_TYPE begin, VID_TYPE end, int64_t limit,
+                           GetAllVerticesIteratorImpl* out);
+
+// the out edges of the inner vertices with gid in [begin, end), which must be
+// of a single vertex label, e.g., a ScanSplit
+template <typename FRAGMENT_TYPE>
+void get_edges_in_range(FRAGMENT_TYPE* frag,
+                        vineyard::IdParser<EID_TYPE>* eid_parser,
+                        VID_TYPE begin, VID_TYPE end, LabelId* labels,
+                        int labels_count, int64_t limit,
+                        GetAllEdgesIteratorImpl* out);
+
 template <typename FRAGMENT_TYPE>
 EdgeId get_edge_id(FRAGMENT_TYPE* frag, LabelId label, int64_t offset);
 
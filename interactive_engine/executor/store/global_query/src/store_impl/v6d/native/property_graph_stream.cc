@@ -309,17 +309,7 @@ int PropertyGraphOutStream::AddEdge(VertexId src_id,
 #endif
   auto src_dst_key = std::make_pair(src_label, dst_label);
   if (edge_builders_[label][src_dst_key] == nullptr) {
-    std::shared_ptr<arrow::KeyValueMetadata> metadata;
-    if (edge_schemas_[label]->metadata() != nullptr) {
-      metadata = edge_schemas_[label]->metadata()->Copy();
-    } else {
-      metadata.reset(new arrow::KeyValueMetadata());
-    }
-    metadata->Append("src_label_id", std::to_string(src_label));
-    metadata->Append("src_label", graph_schema_->GetLabelName(src_label));
-    metadata->Append("dst_label_id", std::to_string(dst_label));
-    metadata->Append("dst_label", graph_schema_->GetLabelName(dst_label));
-    auto schema = edge_schemas_[label]->WithMetadata(metadata);
+    auto schema = edgeSchema(label, src_label, dst_label);
 
     std::unique_ptr<arrow::RecordBatchBuilder> builder = nullptr;
     CHECK_ARROW_ERROR(arrow::RecordBatchBuilder::Make(
@@ -368,6 +358,47 @@ int PropertyGraphOutStream::AddEdges(size_t edge_size,
   return 0;
 }
 
+int PropertyGraphOutStream::AddVertexBatch(
+    LabelId labelid, std::shared_ptr<arrow::RecordBatch> const& batch) {
+  auto iter = vertex_schemas_.find(labelid);
+  if (iter == vertex_schemas_.end() || !matchSchema(iter->second, batch)) {
+    LOG(ERROR) << "The vertex batch doesn't match the schema of label "
+               << labelid;
+    return -1;
+  }
+  auto chunk = arrow::RecordBatch::Make(iter->second, batch->num_rows(),
+                                        batch->columns());
+  size_t primary_key_column = vertex_primary_key_column_.at(labelid);
+  if (primary_key_column != kNoPrimaryKeyColumn) {
+#if defined(ARROW_VERSION) && ARROW_VERSION < 17000
+    ARROW_OK_OR_RAISE(chunk->RemoveColumn(primary_key_column, &chunk));
+#else
+    CHECK_ARROW_ERROR_AND_ASSIGN(chunk,
+      chunk->RemoveColumn(primary_key_column));
+#endif
+  }
+  this->buildTableChunk(chunk, vertex_stream_, 1,
+                        vertex_property_id_mapping_.at(labelid));
+  return 0;
+}
+
+int PropertyGraphOutStream::AddEdgeBatch(
+    LabelId label, LabelId src_label, LabelId dst_label,
+    std::shared_ptr<arrow::RecordBatch> const& batch) {
+  if (edge_schemas_.find(label) == edge_schemas_.end() ||
+      !matchSchema(edge_schemas_.at(label), batch)) {
+    LOG(ERROR) << "The edge batch doesn't match the schema of label "
+               << label;
+    return -1;
+  }
+  auto chunk =
+      arrow::RecordBatch::Make(edgeSchema(label, src_label, dst_label),
+                               batch->num_rows(), batch->columns());
+  this->buildTableChunk(chunk, edge_stream_, 2,
+                        edge_property_id_mapping_.at(label));
+  return 0;
+}
+
 Status PropertyGraphOutStream::Abort() {
   VINEYARD_CHECK_OK(vertex_stream_->Abort());
   VINEYARD_CHECK_OK(edge_stream_->Abort());
@@ -488,6 +519,36 @@ void PropertyGraphOutStream::initialTables() {
   }
 }
 
+std::shared_ptr<arrow::Schema> PropertyGraphOutStream::edgeSchema(
+    LabelId label, LabelId src_label, LabelId dst_label) {
+  auto const& schema = edge_schemas_.at(label);
+  std::shared_ptr<arrow::KeyValueMetadata> metadata;
+  if (schema->metadata() != nullptr) {
+    metadata = schema->metadata()->Copy();
+  } else {
+    metadata.reset(new arrow::KeyValueMetadata());
+  }
+  metadata->Append("src_label_id", std::to_string(src_label));
+  metadata->Append("src_label", graph_schema_->GetLabelName(src_label));
+  metadata->Append("dst_label_id", std::to_string(dst_label));
+  metadata->Append("dst_label", graph_schema_->GetLabelName(dst_label));
+  return schema->WithMetadata(metadata);
+}
+
+bool PropertyGraphOutStream::matchSchema(
+    std::shared_ptr<arrow::Schema> const& schema,
+    std::shared_ptr<arrow::RecordBatch> const& batch) {
+  if (batch == nullptr || batch->num_columns() != schema->num_fields()) {
+    return false;
+  }
+  for (int i = 0; i < schema->num_fields(); ++i) {
+    if (!batch->column(i)->type()->Equals(schema->field(i)->type())) {
+      return false;
+    }
+  }
+  return true;
+}
+
 void PropertyGraphOutStream::buildTableChunk(
     std::shared_ptr<arrow::RecordBatch> batch,
     std::shared_ptr<vineyard::RecordBatchStream> &output_stream,
@@ -500,6 +561,7 @@ void PropertyGraphOutStream::buildTableChunk(
     return;
   }
 
+  std::lock_guard<std::mutex> lock(stream_mutex_);
   if (!output_stream->IsOpen()) {
     VINEYARD_CHECK_OK(this->Open(output_stream));
   }
@@ -20,6 +20,7 @@
 #include <functional>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <tuple>
 #include <unordered_map>
@@ -288,6 +289,18 @@ class PropertyGraphOutStream : public Registered<PropertyGraphOutStream> {
                 LabelId* dst_labels, size_t* property_sizes,
                 Property* properties);
 
+  // append vertices of a label column by column, the columns of the batch are
+  // the vertex id followed by the properties of the label, in the order of
+  // the schema. The batch is written to the stream as a chunk directly,
+  // rather than row by row, and can be called by many threads at once.
+  int AddVertexBatch(LabelId labelid,
+                     std::shared_ptr<arrow::RecordBatch> const& batch);
+
+  // like AddVertexBatch, for edges whose columns are the source id, the
+  // destination id and the properties of the label.
+  int AddEdgeBatch(LabelId label, LabelId src_label, LabelId dst_label,
+                   std::shared_ptr<arrow::RecordBatch> const& batch);
+
   Status Abort();
 
   Status Finish();
@@ -298,6 +311,10 @@ class PropertyGraphOutStream : public Registered<PropertyGraphOutStream> {
 
  private:
   void initialTables();
+  std::shared_ptr<arrow::Schema> edgeSchema(LabelId label, LabelId src_label,
+                                            LabelId dst_label);
+  bool matchSchema(std::shared_ptr<arrow::Schema> const& schema,
+                   std::shared_ptr<arrow::RecordBatch> const& batch);
   void buildTableChunk(std::shared_ptr<arrow::RecordBatch> batch,
                        std::shared_ptr<vineyard::RecordBatchStream> &output_stream,
                        int const property_offset,
@@ -331,6 +348,8 @@ class PropertyGraphOutStream : public Registered<PropertyGraphOutStream> {
   int stream_index_;
   std::shared_ptr<vineyard::RecordBatchStream> vertex_stream_;
   std::shared_ptr<vineyard::RecordBatchStream> edge_stream_;
+  // serializes the writes of chunks to the streams
+  std::mutex stream_mutex_;
 
   friend class PropertyGraphInStream;
 };
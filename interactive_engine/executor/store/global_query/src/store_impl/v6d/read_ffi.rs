@@ -35,6 +35,9 @@ pub type FFIState = i32;
 pub const STATE_SUCCESS: i32 = 0;
 pub const STATE_FAILED: i32 = -1;
 
+/// number of edges fetched by a single call of the batched edge iterators
+const EDGE_BATCH_SIZE: usize = 64;
+
 #[repr(C)]
 #[derive(Debug)]
 pub struct EdgeHandle {
@@ -119,6 +122,7 @@ extern "C" {
     ) -> OutEdgeIterator;
     fn v6d_free_out_edge_iterator(iter: OutEdgeIterator);
     fn v6d_out_edge_next(iter: OutEdgeIterator, e_out: *mut EdgeHandle) -> FFIState;
+    fn v6d_out_edge_next_batch(iter: OutEdgeIterator, e_out: *mut EdgeHandle, cap: i32) -> i32;
 
     fn v6d_get_in_edges(
         graph: GraphHandle, partition_id: FFIPartitionId, dst_id: VertexId, labels: *const FfiLabelId,
@@ -126,6 +130,7 @@ extern "C" {
     ) -> InEdgeIterator;
     fn v6d_free_in_edge_iterator(iter: InEdgeIterator);
     fn v6d_in_edge_next(iter: InEdgeIterator, e_out: *mut EdgeHandle) -> FFIState;
+    fn v6d_in_edge_next_batch(iter: InEdgeIterator, e_out: *mut EdgeHandle, cap: i32) -> i32;
 
     fn v6d_get_all_edges(
         graph: GraphHandle, partition_id: FFIPartitionId, labels: *const FfiLabelId, label_count: i32,
@@ -1401,11 +1406,13 @@ unsafe impl Send for FFIEdge {}
 pub struct FFIOutEdgeIter {
     graph: GraphHandle,
     iter: OutEdgeIterator,
+    buffer: Vec<EdgeHandle>,
+    cursor: usize,
 }
 
 impl FFIOutEdgeIter {
     pub fn new(graph: GraphHandle, iter: OutEdgeIterator) -> Self {
-        FFIOutEdgeIter { graph, iter }
+        FFIOutEdgeIter { graph, iter, buffer: vec![], cursor: 0 }
     }
 }
 
@@ -1413,13 +1420,21 @@ impl Iterator for FFIOutEdgeIter {
     type Item = FFIEdge;
 
     fn next(&mut self) -> Option<Self::Item> {
-        let mut edge_handle = EdgeHandle::new();
-        let state = unsafe { v6d_out_edge_next(self.iter, &mut edge_handle as *mut EdgeHandle) };
-        if state == STATE_SUCCESS {
-            let e = FFIEdge::new(self.graph, edge_handle);
-            return Some(e);
+        if self.cursor == self.buffer.len() {
+            self.buffer
+                .resize_with(EDGE_BATCH_SIZE, EdgeHandle::new);
+            let count = unsafe {
+                v6d_out_edge_next_batch(self.iter, self.buffer.as_mut_ptr(), EDGE_BATCH_SIZE as i32)
+            };
+            self.buffer.truncate(count.max(0) as usize);
+            self.cursor = 0;
+            if self.buffer.is_empty() {
+                return None;
+            }
         }
-        None
+        let edge_handle = std::mem::replace(&mut self.buffer[self.cursor], EdgeHandle::new());
+        self.cursor += 1;
+        Some(FFIEdge::new(self.graph, edge_handle))
     }
 }
 
@@ -1434,11 +1449,13 @@ impl Drop for FFIOutEdgeIter {
 pub struct FFIInEdgeIter {
     graph: GraphHandle,
     iter: InEdgeIterator,
+    buffer: Vec<EdgeHandle>,
+    cursor: usize,
 }
 
 impl FFIInEdgeIter {
     pub fn new(graph: GraphHandle, iter: InEdgeIterator) -> Self {
-        FFIInEdgeIter { graph, iter }
+        FFIInEdgeIter { graph, iter, buffer: vec![], cursor: 0 }
     }
 }
 
@@ -1446,13 +1463,21 @@ impl Iterator for FFIInEdgeIter {
     type Item = FFIEdge;
 
     fn next(&mut self) -> Option<Self::Item> {
-        let mut edge_handle = EdgeHandle::new();
-        let state = unsafe { v6d_in_edge_next(self.iter, &mut edge_handle as *mut EdgeHandle) };
-        if state == STATE_SUCCESS {
-            let e = FFIEdge::new(self.graph, edge_handle);
-            return Some(e);
+        if self.cursor == self.buffer.len() {
+            self.buffer
+                .resize_with(EDGE_BATCH_SIZE, EdgeHandle::new);
+            let count = unsafe {
+                v6d_in_edge_next_batch(self.iter, self.buffer.as_mut_ptr(), EDGE_BATCH_SIZE as i32)
+            };
+            self.buffer.truncate(count.max(0) as usize);
+            self.cursor = 0;
+            if self.buffer.is_empty() {
+                return None;
+            }
         }
-        None
+        let edge_handle = std::mem::replace(&mut self.buffer[self.cursor], EdgeHandle::new());
+        self.cursor += 1;
+        Some(FFIEdge::new(self.graph, edge_handle))
     }
 }
 
@@ -119,6 +119,7 @@ typedef void *PartitionSnapshotHandle;
 typedef void *ErrorHandle;
 typedef void *VertexHandle;
 typedef void *VertexIterHandle;
+typedef void *VertexBlockHandle;
 typedef void *EdgeHandle;
 typedef void *EdgeIterHandle;
 typedef void *PropertyHandle;
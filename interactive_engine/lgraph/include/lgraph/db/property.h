@@ -54,6 +54,7 @@ private:
   explicit Property(PropertyHandle handle);
 
   friend class Vertex;
+  friend class VertexBlock;
   friend class Edge;
   friend class PropertyIterator;
 };
@@ -81,6 +82,7 @@ private:
   explicit PropertyIterator(PropertyIterHandle handle);
 
   friend class Vertex;
+  friend class VertexBlock;
   friend class Edge;
 };
 
@@ -16,6 +16,8 @@
 
 #pragma once
 
+#include <functional>
+#include <vector>
 #include "lgraph/db/vertex.h"
 #include "lgraph/db/edge.h"
 
@@ -77,6 +79,16 @@ private:
   Snapshot();
 };
 
+// Scan the vertices of several snapshots, e.g., of the partitions of a graph,
+// with a thread per snapshot. func(i, block) is called with each block of at
+// most batch_size vertices of the i-th snapshot, by the thread of the snapshot,
+// so it may run for different snapshots at the same time.
+// Returns the number of vertices scanned, or the error of a failed scan.
+Result<size_t, Error> ScanVertexInParallel(std::vector<Snapshot> &snapshots,
+                                           const std::function<void(size_t, VertexBlock &)> &func,
+                                           size_t batch_size = 1024,
+                                           LabelId label_id = none_label_id);
+
 inline Snapshot::Snapshot() : handle_(nullptr) {}
 
 inline Snapshot::Snapshot(Snapshot &&ss) noexcept: Snapshot() {
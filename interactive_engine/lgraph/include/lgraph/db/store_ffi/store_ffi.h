@@ -41,6 +41,11 @@ extern "C" {
 
   /// Vertex FFIs
   VertexHandle VertexIteratorNext(VertexIterHandle vertex_iter, ErrorHandle* error);
+  VertexBlockHandle VertexIteratorNextBatch(VertexIterHandle vertex_iter, size_t max_size, ErrorHandle* error);
+  size_t GetVertexBlockSize(VertexBlockHandle vertex_block);
+  void GetVertexBlockIds(VertexBlockHandle vertex_block, VertexId* ids_out);
+  void GetVertexBlockLabelIds(VertexBlockHandle vertex_block, LabelId* label_ids_out);
+  VertexHandle GetVertexBlockVertex(VertexBlockHandle vertex_block, size_t index);
   VertexId GetVertexId(VertexHandle vertex_hdl);
   LabelId GetVertexLabelId(VertexHandle vertex_hdl);
   PropertyHandle GetVertexProperty(VertexHandle vertex_hdl, PropertyId prop_id);
@@ -71,6 +76,7 @@ extern "C" {
   void ReleaseErrorHandle(ErrorHandle ptr);
   void ReleaseVertexHandle(VertexHandle ptr);
   void ReleaseVertexIteratorHandle(VertexIterHandle ptr);
+  void ReleaseVertexBlockHandle(VertexBlockHandle ptr);
   void ReleaseEdgeHandle(EdgeHandle ptr);
   void ReleaseEdgeIteratorHandle(EdgeIterHandle ptr);
   void ReleasePropertyHandle(PropertyHandle ptr);
@@ -16,6 +16,8 @@
 
 #pragma once
 
+#include <utility>
+#include <vector>
 #include "lgraph/db/property.h"
 
 namespace LGRAPH_NAMESPACE {
@@ -53,6 +55,41 @@ private:
   friend class VertexIterator;
 };
 
+// A block of vertices taken from a VertexIterator by a single FFI call, with
+// the ids and labels of all its vertices fetched as columns. The vertices are
+// owned by the block and are released together with it.
+class VertexBlock {
+public:
+  ~VertexBlock();
+
+  // Move Only!
+  // Avoid copy construction and assignment.
+  VertexBlock(const VertexBlock &) = delete;
+  VertexBlock &operator=(const VertexBlock &) = delete;
+  VertexBlock(VertexBlock &&vb) noexcept;
+  VertexBlock &operator=(VertexBlock &&vb) noexcept;
+
+  bool Valid() const { return handle_ != nullptr; }
+
+  // The block is empty once the iterator is exhausted.
+  size_t Size() const { return ids_.size(); }
+  const std::vector<VertexId> &GetVertexIds() const { return ids_; }
+  const std::vector<LabelId> &GetLabelIds() const { return label_ids_; }
+  Property GetPropertyBy(size_t index, PropertyId prop_id);
+  PropertyIterator GetPropertyIterator(size_t index);
+
+private:
+  VertexBlockHandle handle_;
+  std::vector<VertexId> ids_;
+  std::vector<LabelId> label_ids_;
+
+  // Hide constructors from users.
+  VertexBlock();
+  explicit VertexBlock(VertexBlockHandle handle);
+
+  friend class VertexIterator;
+};
+
 class VertexIterator {
 public:
   ~VertexIterator();
@@ -68,6 +105,10 @@ public:
 
   Result<Vertex, Error> Next();
 
+  // Take at most max_size vertices at once, which costs a few FFI calls
+  // rather than several per vertex.
+  Result<VertexBlock, Error> NextBatch(size_t max_size);
+
 private:
   VertexIterHandle handle_;
 
@@ -95,6 +136,22 @@ inline Vertex &Vertex::operator=(Vertex &&v) noexcept {
   return *this;
 }
 
+inline VertexBlock::VertexBlock() : handle_(nullptr) {}
+
+inline VertexBlock::VertexBlock(VertexBlock &&vb) noexcept: VertexBlock() {
+  *this = std::move(vb);
+}
+
+inline VertexBlock &VertexBlock::operator=(VertexBlock &&vb) noexcept {
+  if (this != &vb) {
+    // the block left in vb releases the handle of this one
+    std::swap(handle_, vb.handle_);
+    ids_.swap(vb.ids_);
+    label_ids_.swap(vb.label_ids_);
+  }
+  return *this;
+}
+
 inline VertexIterator::VertexIterator() : handle_(nullptr) {}
 
 inline VertexIterator::VertexIterator(VertexIterHandle handle) : handle_(handle) {}
@@ -95,6 +95,58 @@ private:
   cppkafka::Message kafka_msg_;
 };
 
+// A log message with all its operations parsed, so that the consumer of a
+// PipelinedSubscriber does no parsing itself. Vertex and edge inserts are
+// decoded into typed infos, each kind in log order.
+class DecodedLogMessage {
+public:
+  explicit DecodedLogMessage(const LogMessage &msg);
+  ~DecodedLogMessage() = default;
+
+  DecodedLogMessage(const DecodedLogMessage &) = delete;
+  DecodedLogMessage &operator=(const DecodedLogMessage &) = delete;
+  DecodedLogMessage(DecodedLogMessage &&) noexcept = default;
+  DecodedLogMessage &operator=(DecodedLogMessage &&) noexcept = default;
+
+  bool IsError() const {
+    return is_error_;
+  }
+
+  const std::string &GetErrorMsg() const {
+    return error_msg_;
+  }
+
+  int64_t GetOffset() const {
+    return offset_;
+  }
+
+  SnapshotId GetSnapshotId() const {
+    return snapshot_id_;
+  }
+
+  // All the operations of the message, including ddl and marker ones.
+  const std::vector<Operation> &GetOperations() const {
+    return operations_;
+  }
+
+  const std::vector<VertexInsertInfo> &GetVertexInserts() const {
+    return vertex_inserts_;
+  }
+
+  const std::vector<EdgeInsertInfo> &GetEdgeInserts() const {
+    return edge_inserts_;
+  }
+
+private:
+  bool is_error_;
+  std::string error_msg_;
+  int64_t offset_;
+  SnapshotId snapshot_id_;
+  std::vector<Operation> operations_;
+  std::vector<VertexInsertInfo> vertex_inserts_;
+  std::vector<EdgeInsertInfo> edge_inserts_;
+};
+
 inline MessageParser::MessageParser(const void* data, size_t size) : snapshot_id_(0), op_batch_proto_() {
   LogEntryPb log_entry_proto;
   Check(log_entry_proto.ParsePartialFromArray(data, static_cast<int>(size)), "Parse LogEntryPb Failed!");
@@ -115,5 +167,24 @@ inline std::vector<Operation> MessageParser::GetOperations() {
   return operations;
 }
 
+inline DecodedLogMessage::DecodedLogMessage(const LogMessage &msg)
+    : is_error_(msg.IsError()), error_msg_(), offset_(msg.GetOffset()), snapshot_id_(0) {
+  if (is_error_) {
+    error_msg_ = msg.GetErrorMsg();
+    return;
+  }
+  auto parser = msg.GetParser();
+  snapshot_id_ = parser.GetSnapshotId();
+  operations_ = parser.GetOperations();
+  for (auto &op : operations_) {
+    auto op_type = op.GetOpType();
+    if (op_type == OpType::OVERWRITE_VERTEX || op_type == OpType::UPDATE_VERTEX) {
+      vertex_inserts_.push_back(op.GetInfoAsVertexInsertOp());
+    } else if (op_type == OpType::OVERWRITE_EDGE || op_type == OpType::UPDATE_EDGE) {
+      edge_inserts_.push_back(op.GetInfoAsEdgeInsertOp());
+    }
+  }
+}
+
 }
 }
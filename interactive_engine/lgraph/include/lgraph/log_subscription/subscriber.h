@@ -16,6 +16,11 @@
 
 #pragma once
 
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
 #include <cppkafka/consumer.h>
 #include "lgraph/log_subscription/message.h"
 
@@ -39,6 +44,49 @@ private:
   cppkafka::Consumer consumer_;
 };
 
+// A subscriber of a partition that polls and parses ahead of its consumer.
+//
+// A fetcher thread keeps polling batches from kafka, and a pool of decode threads parses the batches into
+// DecodedLogMessages, so that polling, parsing and consuming overlap. Batches are delivered in the order they
+// were polled. At most max_prefetched_batches batches are held ahead of the consumer, after which the fetcher
+// waits for the consumer to catch up.
+class PipelinedSubscriber {
+public:
+  PipelinedSubscriber(const std::string &kafka_servers, const std::string &topic, int32_t partition_id,
+                      int64_t start_offset, size_t decode_thread_num = 2, size_t max_batch_size = 256,
+                      size_t max_prefetched_batches = 8);
+  ~PipelinedSubscriber();
+
+  PipelinedSubscriber(const PipelinedSubscriber &) = delete;
+  PipelinedSubscriber &operator=(const PipelinedSubscriber &) = delete;
+  PipelinedSubscriber(PipelinedSubscriber &&) = delete;
+  PipelinedSubscriber &operator=(PipelinedSubscriber &&) = delete;
+
+  // Get the next decoded batch, or an empty one if it is not ready within timeout_ms.
+  std::vector<DecodedLogMessage> PollBatch(size_t timeout_ms);
+
+private:
+  void fetchLoop();
+  void decodeLoop();
+
+  Subscriber subscriber_;
+  size_t max_batch_size_;
+  size_t max_prefetched_batches_;
+
+  std::mutex mutex_;
+  std::condition_variable fetch_cv_;
+  std::condition_variable decode_cv_;
+  std::condition_variable deliver_cv_;
+  bool stopped_;
+  uint64_t fetched_seq_;
+  uint64_t delivered_seq_;
+  std::deque<std::pair<uint64_t, std::vector<LogMessage>>> fetched_;
+  std::map<uint64_t, std::vector<DecodedLogMessage>> decoded_;
+
+  std::thread fetcher_;
+  std::vector<std::thread> decoders_;
+};
+
 }
 }
 
@@ -15,6 +15,9 @@
  */
 
 #include "lgraph/db/snapshot.h"
+
+#include <memory>
+#include <thread>
 #include "lgraph/db/store_ffi/store_ffi.h"
 
 namespace LGRAPH_NAMESPACE {
@@ -122,5 +125,48 @@ SnapshotId Snapshot::GetSnapshotId() {
   return ffi::GetSnapshotId(handle_);
 }
 
+Result<size_t, Error> ScanVertexInParallel(std::vector<Snapshot> &snapshots,
+                                           const std::function<void(size_t, VertexBlock &)> &func,
+                                           size_t batch_size, LabelId label_id) {
+  std::vector<size_t> counts(snapshots.size(), 0);
+  std::vector<std::unique_ptr<Error>> errors(snapshots.size());
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < snapshots.size(); ++i) {
+    threads.emplace_back([&, i]() {
+      auto iter = snapshots[i].ScanVertex(label_id);
+      if (iter.isErr()) {
+        errors[i].reset(new Error(iter.unwrapErr()));
+        return;
+      }
+      auto vertex_iter = iter.unwrap();
+      while (true) {
+        auto block = vertex_iter.NextBatch(batch_size);
+        if (block.isErr()) {
+          errors[i].reset(new Error(block.unwrapErr()));
+          return;
+        }
+        auto vertex_block = block.unwrap();
+        if (vertex_block.Size() == 0) {
+          break;
+        }
+        counts[i] += vertex_block.Size();
+        func(i, vertex_block);
+      }
+    });
+  }
+  for (auto &thrd : threads) {
+    thrd.join();
+  }
+
+  size_t total = 0;
+  for (size_t i = 0; i < snapshots.size(); ++i) {
+    if (errors[i] != nullptr) {
+      return Result<size_t, Error>(Err(std::move(*errors[i])));
+    }
+    total += counts[i];
+  }
+  return Result<size_t, Error>(Ok(total));
+}
+
 }
 }
@@ -42,6 +42,28 @@ PropertyIterator Vertex::GetPropertyIterator() {
   return PropertyIterator(ffi::GetVertexPropertyIterator(handle_));
 }
 
+VertexBlock::VertexBlock(VertexBlockHandle handle) : handle_(handle) {
+  size_t size = ffi::GetVertexBlockSize(handle_);
+  ids_.resize(size);
+  label_ids_.resize(size);
+  ffi::GetVertexBlockIds(handle_, ids_.data());
+  ffi::GetVertexBlockLabelIds(handle_, label_ids_.data());
+}
+
+VertexBlock::~VertexBlock() {
+  if (handle_ != nullptr) {
+    ffi::ReleaseVertexBlockHandle(handle_);
+  }
+}
+
+Property VertexBlock::GetPropertyBy(size_t index, PropertyId prop_id) {
+  return Property(ffi::GetVertexProperty(ffi::GetVertexBlockVertex(handle_, index), prop_id));
+}
+
+PropertyIterator VertexBlock::GetPropertyIterator(size_t index) {
+  return PropertyIterator(ffi::GetVertexPropertyIterator(ffi::GetVertexBlockVertex(handle_, index)));
+}
+
 VertexIterator::~VertexIterator() {
   if (handle_ != nullptr) {
     ffi::ReleaseVertexIteratorHandle(handle_);
@@ -57,5 +79,14 @@ Result<Vertex, Error> VertexIterator::Next() {
   return Result<Vertex, Error>(Err(Error(err_hdl)));
 }
 
+Result<VertexBlock, Error> VertexIterator::NextBatch(size_t max_size) {
+  ErrorHandle err_hdl = nullptr;
+  VertexBlockHandle block_hdl = ffi::VertexIteratorNextBatch(handle_, max_size, &err_hdl);
+  if (err_hdl == nullptr) {
+    return Result<VertexBlock, Error>(Ok(VertexBlock(block_hdl)));
+  }
+  return Result<VertexBlock, Error>(Err(Error(err_hdl)));
+}
+
 }
 }
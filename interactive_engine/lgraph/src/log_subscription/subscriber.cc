@@ -14,6 +14,7 @@
  * limitations under the License.
  */
 
+#include <algorithm>
 #include "lgraph/log_subscription/subscriber.h"
 
 namespace LGRAPH_NAMESPACE {
@@ -48,5 +49,97 @@ std::vector<LogMessage> Subscriber::PollBatch(size_t max_batch_size, size_t time
   return msg_batch;
 }
 
+PipelinedSubscriber::PipelinedSubscriber(const std::string &kafka_servers, const std::string &topic,
+                                         int32_t partition_id, int64_t start_offset, size_t decode_thread_num,
+                                         size_t max_batch_size, size_t max_prefetched_batches)
+    : subscriber_(kafka_servers, topic, partition_id, start_offset), max_batch_size_(max_batch_size)
+    , max_prefetched_batches_(std::max<size_t>(max_prefetched_batches, 1)), stopped_(false)
+    , fetched_seq_(0), delivered_seq_(0) {
+  fetcher_ = std::thread{&PipelinedSubscriber::fetchLoop, this};
+  decode_thread_num = std::max<size_t>(decode_thread_num, 1);
+  decoders_.reserve(decode_thread_num);
+  for (size_t i = 0; i < decode_thread_num; i++) {
+    decoders_.emplace_back(&PipelinedSubscriber::decodeLoop, this);
+  }
+}
+
+PipelinedSubscriber::~PipelinedSubscriber() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopped_ = true;
+  }
+  fetch_cv_.notify_all();
+  decode_cv_.notify_all();
+  fetcher_.join();
+  for (auto &t : decoders_) {
+    t.join();
+  }
+}
+
+std::vector<DecodedLogMessage> PipelinedSubscriber::PollBatch(size_t timeout_ms) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (!deliver_cv_.wait_for(lock, std::chrono::milliseconds(timeout_ms),
+                            [this] { return decoded_.count(delivered_seq_) > 0; })) {
+    return {};
+  }
+  auto iter = decoded_.find(delivered_seq_);
+  auto batch = std::move(iter->second);
+  decoded_.erase(iter);
+  delivered_seq_++;
+  lock.unlock();
+  fetch_cv_.notify_one();
+  return batch;
+}
+
+void PipelinedSubscriber::fetchLoop() {
+  // Bounds how long the destructor waits for a poll in flight.
+  constexpr size_t fetch_timeout_ms = 100;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      fetch_cv_.wait(lock, [this] {
+        return stopped_ || fetched_seq_ - delivered_seq_ < max_prefetched_batches_;
+      });
+      if (stopped_) {
+        return;
+      }
+    }
+    auto batch = subscriber_.PollBatch(max_batch_size_, fetch_timeout_ms);
+    if (batch.empty()) {
+      continue;
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      fetched_.emplace_back(fetched_seq_++, std::move(batch));
+    }
+    decode_cv_.notify_one();
+  }
+}
+
+void PipelinedSubscriber::decodeLoop() {
+  while (true) {
+    std::pair<uint64_t, std::vector<LogMessage>> task;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      decode_cv_.wait(lock, [this] { return stopped_ || !fetched_.empty(); });
+      if (stopped_) {
+        return;
+      }
+      task = std::move(fetched_.front());
+      fetched_.pop_front();
+    }
+    std::vector<DecodedLogMessage> decoded;
+    decoded.reserve(task.second.size());
+    for (auto &msg : task.second) {
+      decoded.emplace_back(msg);
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      decoded_.emplace(task.first, std::move(decoded));
+    }
+    deliver_cv_.notify_all();
+  }
+}
+
 }
 }
@@ -42,9 +42,11 @@ from graphscope.analytical.app.degree_assortativity_coefficient import \
 # fmt: on
 from graphscope.analytical.app.degree_centrality import degree_centrality
 from graphscope.analytical.app.eigenvector_centrality import eigenvector_centrality
+from graphscope.analytical.app.fused import fused_analytics
 from graphscope.analytical.app.hits import hits
 from graphscope.analytical.app.is_simple_path import is_simple_path
 from graphscope.analytical.app.java_app import JavaApp
+from graphscope.analytical.app.k_core import core_number
 from graphscope.analytical.app.k_core import k_core
 from graphscope.analytical.app.k_shell import k_shell
 from graphscope.analytical.app.katz_centrality import katz_centrality
@@ -54,12 +56,18 @@ from graphscope.analytical.app.lpa import lpa
 from graphscope.analytical.app.lpa import lpa_u2i
 from graphscope.analytical.app.pagerank import pagerank
 from graphscope.analytical.app.pagerank import pagerank_nx
+from graphscope.analytical.app.pagerank import pagerank_out_of_core
+from graphscope.analytical.app.pagerank import pagerank_vertex_cut
 from graphscope.analytical.app.pagerank import pagerank_push
 from graphscope.analytical.app.pagerank import pagerank_push_opt
+from graphscope.analytical.app.random_walk import random_walk
 from graphscope.analytical.app.sssp import sssp
+from graphscope.analytical.app.sssp import sssp_delta_stepping
+from graphscope.analytical.app.triangles import k_clique
 from graphscope.analytical.app.triangles import triangles
 from graphscope.analytical.app.voterank import voterank
 from graphscope.analytical.app.wcc import wcc
+from graphscope.analytical.app.wcc import wcc_afforest
 from graphscope.analytical.app.wcc import wcc_auto
 from graphscope.analytical.app.wcc import wcc_opt
 from graphscope.analytical.app.wcc import wcc_projected
@@ -63,6 +63,11 @@ from graphscope.analytical.app.flash.measurement import diameter_approximation_2
 from graphscope.analytical.app.flash.measurement import k_center
 from graphscope.analytical.app.flash.measurement import minimum_spanning_forest
 from graphscope.analytical.app.flash.measurement import minimum_spanning_forest_2
+
+# fmt: off
+from graphscope.analytical.app.flash.measurement import \
+    minimum_spanning_forest_boruvka
+# fmt: on
 from graphscope.analytical.app.flash.ranking import articlerank
 from graphscope.analytical.app.flash.ranking import hyperlink_induced_topic_search
 from graphscope.analytical.app.flash.ranking import pagerank
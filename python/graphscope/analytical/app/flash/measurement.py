@@ -24,6 +24,7 @@ from graphscope.framework.app import project_to_simple
 __all__ = [
     "minimum_spanning_forest",
     "minimum_spanning_forest_2",
+    "minimum_spanning_forest_boruvka",
     "diameter_approximation",
     "diameter_approximation_2",
     "k_center",
@@ -84,6 +85,34 @@ def minimum_spanning_forest_2(graph):
     return AppAssets(algo="flash_msf_block", context="tensor")(graph)
 
 
+@project_to_simple
+@not_compatible_for("arrow_property", "dynamic_property")
+def minimum_spanning_forest_boruvka(graph):
+    """Evaluate Minimum Spanning Forest on a graph with flash computation mode,
+    building the local forests by a parallel filter-Kruskal with Boruvka rounds.
+
+    Args:
+        graph (:class:`graphscope.Graph`): A simple graph.
+
+    Returns:
+        :class:`graphscope.framework.context.Context`:
+            A context with the value of minimum spanning forest.
+
+    Examples:
+
+    .. code:: python
+
+        >>> import graphscope
+        >>> from graphscope.dataset import load_p2p_network
+        >>> g = load_p2p_network()
+        >>> # project to a simple graph (if needed)
+        >>> pg = g.project(vertices={"host": []}, edges={"connect": ["dist"]})
+        >>> c = graphscope.flash.minimum_spanning_forest_boruvka(pg)
+        >>> c.to_numpy("r")[0]
+    """
+    return AppAssets(algo="flash_msf_boruvka", context="tensor")(graph)
+
+
 @project_to_simple
 @not_compatible_for("arrow_property", "dynamic_property")
 def diameter_approximation(graph):
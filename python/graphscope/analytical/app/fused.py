@@ -0,0 +1,75 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+#
+# Copyright 2020 Alibaba Group Holding Limited. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+
+from graphscope.framework.app import AppAssets
+from graphscope.framework.app import not_compatible_for
+from graphscope.framework.app import project_to_simple
+
+__all__ = ["fused_analytics"]
+
+_FUSABLE_APPS = ("degree", "pagerank", "wcc", "kcore")
+
+
+@project_to_simple
+@not_compatible_for("arrow_property", "dynamic_property")
+def fused_analytics(
+    graph, apps=("degree", "pagerank", "wcc", "kcore"), delta=0.85, max_round=10
+):
+    """Run several analytics on `graph` together, in the same rounds.
+
+    The edges are read once per round for all the apps, and the states of a
+    vertex in all of them are synchronized in a single message, rather than
+    each app walking the whole graph on its own.
+
+    Args:
+        graph (:class:`graphscope.Graph`): A simple graph.
+        apps (list of str, optional): Apps to run, of "degree" (degree
+            centrality), "pagerank", "wcc" and "kcore" (coreness). Defaults
+            to all of them.
+        delta (float, optional): Dumping factor of PageRank. Defaults to 0.85.
+        max_round (int, optional): Rounds of PageRank. Defaults to 10.
+
+    Returns:
+        :class:`graphscope.framework.context.VertexPropertyContextDAGNode`:
+            A context with a column per app, named after it, evaluated in eager mode.
+
+    Examples:
+
+    .. code:: python
+
+        >>> import graphscope
+        >>> from graphscope.dataset import load_p2p_network
+        >>> sess = graphscope.session(cluster_type="hosts", mode="eager")
+        >>> g = load_p2p_network(sess)
+        >>> pg = g.project(vertices={"host": ["id"]}, edges={"connect": ["dist"]})
+        >>> c = graphscope.fused_analytics(pg, apps=["pagerank", "wcc"])
+        >>> sess.close()
+    """
+    if isinstance(apps, str):
+        apps = [apps]
+    for app in apps:
+        if app not in _FUSABLE_APPS:
+            raise ValueError(
+                "apps must be of %s, got %s" % (", ".join(_FUSABLE_APPS), app)
+            )
+    delta = float(delta)
+    max_round = int(max_round)
+    return AppAssets(algo="fused_analytics", context="vertex_property")(
+        graph, ",".join(apps), delta, max_round
+    )
@@ -21,7 +21,7 @@ from graphscope.framework.app import AppAssets
 from graphscope.framework.app import not_compatible_for
 from graphscope.framework.app import project_to_simple
 
-__all__ = ["k_core"]
+__all__ = ["k_core", "core_number"]
 
 
 @project_to_simple
@@ -54,3 +54,39 @@ def k_core(graph, k: int):
         >>> sess.close()
     """
     return AppAssets(algo="kcore", context="vertex_data")(graph, k=k)
+
+
+@project_to_simple
+@not_compatible_for("arrow_property", "dynamic_property")
+def core_number(graph):
+    """Compute the core number of each vertex, i.e., the largest `k` such that
+    the vertex is in the k-core of the graph.
+
+    Vertices are peeled in buckets by their remaining degrees, and only the
+    vertices whose degrees change are moved across buckets, so that the
+    number of rounds follows the number of distinct core numbers. The degree
+    of a vertex in a directed graph is the sum of its in and out degrees, and
+    self-loops are ignored.
+
+    Args:
+        graph (:class:`graphscope.Graph`): A simple graph.
+
+    Returns:
+        :class:`graphscope.framework.context.VertexDataContextDAGNode`:
+            A context with each vertex assigned with its core number,
+            evaluated in eager mode.
+
+    Examples:
+
+    .. code:: python
+
+        >>> import graphscope
+        >>> from graphscope.dataset import load_p2p_network
+        >>> sess = graphscope.session(cluster_type="hosts", mode="eager")
+        >>> g = load_p2p_network(sess)
+        >>> # project to a simple graph (if needed)
+        >>> pg = g.project(vertices={"host": ["id"]}, edges={"connect": ["dist"]})
+        >>> c = graphscope.core_number(pg)
+        >>> sess.close()
+    """
+    return AppAssets(algo="core_decomposition", context="vertex_data")(graph)
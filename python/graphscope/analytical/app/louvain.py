@@ -55,6 +55,9 @@ def louvain(graph, min_progress=1000, progress_tries=1):
         louvain now only support undirected graph. If input graph is directed graph, louvain would raise
         an InvalidArgumentError.
 
+        Local moving runs in parallel on each fragment, and communities are coarsened into a
+        smaller graph between levels. Levels stop once the modularity no longer improves.
+
     Examples:
 
     .. code:: python
@@ -70,6 +73,6 @@ def louvain(graph, min_progress=1000, progress_tries=1):
     """
     if graph.is_directed():
         raise InvalidArgumentError("Louvain not support directed graph.")
-    return AppAssets(algo="louvain", context="vertex_data")(
+    return AppAssets(algo="louvain_pie", context="vertex_data")(
         graph, min_progress, progress_tries
     )
@@ -26,12 +26,20 @@ __all__ = ["lpa", "cdlp", "lpa_u2i"]
 
 @project_to_simple
 @not_compatible_for("arrow_property", "dynamic_property")
-def lpa(graph, max_round=10):
+def lpa(graph, max_round=10, frontier=False, stable_ratio=0.0):
     """Evaluate Community Detection with Label Propagation.
 
     Args:
         graph (:class:`graphscope.Graph`): A simple graph.
         max_round (int, optional): Maximum rounds. Defaults to 10.
+        frontier (bool, optional): Only re-evaluate the vertices with a neighbor
+            whose label changed in the last round, and only send the changed
+            labels. Ties are broken by the internal id of the label instead of
+            the original one, so communities may be named differently.
+            Defaults to False.
+        stable_ratio (float, optional): With `frontier`, stop once at most
+            this ratio of all vertices changed their labels in a round.
+            Defaults to 0.0, i.e., until no label changes.
 
     Returns:
         :class:`graphscope.framework.context.VertexDataContextDAGNode`:
@@ -51,6 +59,11 @@ def lpa(graph, max_round=10):
         >>> sess.close()
     """
     max_round = int(max_round)
+    if frontier:
+        stable_ratio = float(stable_ratio)
+        return AppAssets(algo="lpa_frontier", context="vertex_data")(
+            graph, max_round, stable_ratio
+        )
     return AppAssets(algo="cdlp", context="vertex_data")(graph, max_round)
 
 
@@ -22,7 +22,14 @@ from graphscope.framework.app import AppAssets
 from graphscope.framework.app import not_compatible_for
 from graphscope.framework.app import project_to_simple
 
-__all__ = ["pagerank", "pagerank_push", "pagerank_push_opt", "pagerank_nx"]
+__all__ = [
+    "pagerank",
+    "pagerank_push",
+    "pagerank_push_opt",
+    "pagerank_nx",
+    "pagerank_out_of_core",
+    "pagerank_vertex_cut",
+]
 
 logger = logging.getLogger("graphscope")
 
@@ -119,3 +126,70 @@ def pagerank_nx(graph, alpha=0.85, max_iter=100, tol=1e-06):
     return AppAssets(algo="pagerank_nx", context="vertex_data")(
         graph, alpha, max_iter, tol
     )
+
+
+@project_to_simple
+@not_compatible_for("arrow_property", "dynamic_property")
+def pagerank_out_of_core(
+    graph, spill_dir, delta=0.85, max_round=10, buffer_pool_mb=1024
+):
+    """Evaluate PageRank on a graph, streaming its edges from disk.
+
+    The edges of each fragment are spilled to blocks in `spill_dir`, which
+    should be on a fast local disk, and every round streams them through a
+    buffer pool of at most `buffer_pool_mb` MB per worker. Only the ranks of
+    the vertices are kept in memory.
+
+    Args:
+        graph (:class:`graphscope.Graph`): A simple graph.
+        spill_dir (str): Directory on the workers to store the edge blocks in.
+        delta (float, optional): Dumping factor. Defaults to 0.85.
+        max_round (int, optional): Maximum number of rounds. Defaults to 10.
+        buffer_pool_mb (int, optional): Size of the buffer pool in MB.
+            Defaults to 1024.
+
+    Returns:
+        :class:`graphscope.framework.context.VertexDataContextDAGNode`:
+            A context with each vertex assigned with the pagerank value, evaluated in eager mode.
+    """
+    delta = float(delta)
+    max_round = int(max_round)
+    buffer_pool_mb = int(buffer_pool_mb)
+    return AppAssets(algo="pagerank_out_of_core", context="vertex_data")(
+        graph, delta, max_round, str(spill_dir), buffer_pool_mb
+    )
+
+
+@project_to_simple
+@not_compatible_for("arrow_property", "dynamic_property")
+def pagerank_vertex_cut(
+    graph, delta=0.85, max_round=10, cut="hybrid", hybrid_threshold=100
+):
+    """Evaluate PageRank on a graph, over a vertex cut of its fragments.
+
+    The edges are redistributed so that the edges of a vertex of a huge
+    degree are spread over the workers, which balances the rounds on graphs
+    with skewed degrees. With the "grid" cut, an edge goes to a worker by the
+    hashes of both its ends. With the "hybrid" cut, the incoming edges of a
+    vertex stay with it unless it has more than `hybrid_threshold` of them.
+
+    Args:
+        graph (:class:`graphscope.Graph`): A simple graph.
+        delta (float, optional): Dumping factor. Defaults to 0.85.
+        max_round (int, optional): Maximum number of rounds. Defaults to 10.
+        cut (str, optional): "grid" or "hybrid". Defaults to "hybrid".
+        hybrid_threshold (int, optional): The in degree above which the edges
+            of a vertex are cut. Defaults to 100.
+
+    Returns:
+        :class:`graphscope.framework.context.VertexDataContextDAGNode`:
+            A context with each vertex assigned with the pagerank value, evaluated in eager mode.
+    """
+    if cut not in ("grid", "hybrid"):
+        raise ValueError("cut must be 'grid' or 'hybrid', got %s" % cut)
+    delta = float(delta)
+    max_round = int(max_round)
+    hybrid_threshold = int(hybrid_threshold)
+    return AppAssets(algo="pagerank_vertex_cut", context="vertex_data")(
+        graph, delta, max_round, cut, hybrid_threshold
+    )
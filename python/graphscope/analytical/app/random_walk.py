@@ -0,0 +1,77 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+#
+# Copyright 2020 Alibaba Group Holding Limited. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+
+from graphscope.framework.app import AppAssets
+from graphscope.framework.app import not_compatible_for
+from graphscope.framework.app import project_to_simple
+
+__all__ = ["random_walk"]
+
+
+@project_to_simple
+@not_compatible_for("arrow_property", "dynamic_property")
+def random_walk(
+    graph, walk_length=80, walks_per_vertex=1, p=1.0, q=1.0, weighted=False, seed=0
+):
+    """Generate random walks from every vertex of the graph, as the corpus of
+    DeepWalk or node2vec.
+
+    A walk of node2vec is biased by the return parameter `p` and the in-out
+    parameter `q`, and is a plain random walk of DeepWalk when both are 1.
+    A walk stopped by a vertex without out neighbors is padded with its last
+    vertex.
+
+    Args:
+        graph (:class:`graphscope.Graph`): A simple graph.
+        walk_length (int, optional): Steps of each walk. Defaults to 80.
+        walks_per_vertex (int, optional): Walks from each vertex. Defaults to 1.
+        p (float, optional): The return parameter. Defaults to 1.0.
+        q (float, optional): The in-out parameter. Defaults to 1.0.
+        weighted (bool, optional): Whether to pick the next vertex by the edge
+            weights. Defaults to False.
+        seed (int, optional): The random seed. Defaults to 0.
+
+    Returns:
+        :class:`graphscope.framework.context.TensorContextDAGNode`:
+            A context with a walk of `walk_length + 1` vertex ids in each row,
+            evaluated in eager mode.
+
+    Examples:
+
+    .. code:: python
+
+        >>> import graphscope
+        >>> from graphscope.dataset import load_p2p_network
+        >>> sess = graphscope.session(cluster_type="hosts", mode="eager")
+        >>> g = load_p2p_network(sess)
+        >>> # project to a simple graph (if needed)
+        >>> pg = g.project(vertices={"host": ["id"]}, edges={"connect": ["dist"]})
+        >>> c = graphscope.random_walk(pg, walk_length=10, p=0.5, q=2.0)
+        >>> sess.close()
+
+    """
+    walk_length = int(walk_length)
+    walks_per_vertex = int(walks_per_vertex)
+    p = float(p)
+    q = float(q)
+    weighted = bool(weighted)
+    seed = int(seed)
+    return AppAssets(algo="random_walk", context="tensor")(
+        graph, walk_length, walks_per_vertex, p, q, weighted, seed
+    )
@@ -24,6 +24,7 @@ from graphscope.proto import graph_def_pb2
 
 __all__ = [
     "sssp",
+    "sssp_delta_stepping",
 ]
 
 
@@ -61,6 +62,57 @@ def sssp(graph, src=0, weight=None):
         >>> c = graphscope.sssp(pg, src=6)
         >>> sess.close()
     """
+    _check_edata_type(graph)
+    return AppAssets(algo="sssp", context="vertex_data")(graph, src)
+
+
+@project_to_simple
+@not_compatible_for("arrow_property", "dynamic_property")
+def sssp_delta_stepping(graph, src=0, delta=0.0, weight=None):
+    """Compute single source shortest path length on the `graph` by
+    delta-stepping.
+
+    Vertices are settled in buckets of width `delta` by their distances, and
+    each bucket is processed in parallel, so that graphs with long diameters,
+    e.g., road networks, converge in much fewer rounds than `sssp`.
+
+    Args:
+        graph (:class:`graphscope.Graph`): A simple graph.
+        src (optional): The source vertex. The type should be consistent
+            with the id type of the `graph`, that is, it's `int` or `str` depending
+            on the `oid_type` is `int64_t` or `string` of the `graph`. Defaults to 0.
+        delta (float, optional): The width of buckets. Edges lighter than `delta`
+            are relaxed repeatedly within a bucket, and heavier ones once per bucket.
+            Defaults to 0, which picks twice the average edge weight.
+        weight (str, optional): The edge data key corresponding to the edge weight.
+            Note that property under multiple labels should have the consistent index.
+            Defaults to None.
+
+    Returns:
+        :class:`graphscope.framework.context.VertexDataContextDAGNode`:
+            A context with each vertex assigned with the shortest distance from the `src`,
+            evaluated in eager mode.
+
+    Examples:
+
+    .. code:: python
+
+        >>> import graphscope
+        >>> from graphscope.dataset import load_p2p_network
+        >>> sess = graphscope.session(cluster_type="hosts", mode="eager")
+        >>> g = load_p2p_network(sess)
+        >>> # project to a simple graph (if needed)
+        >>> pg = g.project(vertices={"host": ["id"]}, edges={"connect": ["dist"]})
+        >>> c = graphscope.sssp_delta_stepping(pg, src=6, delta=100)
+        >>> sess.close()
+    """
+    _check_edata_type(graph)
+    return AppAssets(algo="sssp_delta_stepping", context="vertex_data")(
+        graph, src, delta
+    )
+
+
+def _check_edata_type(graph):
     if not isinstance(graph, GraphDAGNode):
         if graph.schema.edata_type == graph_def_pb2.NULLVALUE:
             raise ValueError(
@@ -72,4 +124,3 @@ def sssp(graph, src=0, weight=None):
                 "The edge data type is string, and the edge data type should be "
                 "integers or floating point numbers to run SSSP."
             )
-    return AppAssets(algo="sssp", context="vertex_data")(graph, src)
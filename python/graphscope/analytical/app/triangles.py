@@ -21,7 +21,7 @@ from graphscope.framework.app import AppAssets
 from graphscope.framework.app import not_compatible_for
 from graphscope.framework.app import project_to_simple
 
-__all__ = ["triangles"]
+__all__ = ["triangles", "k_clique"]
 
 
 @project_to_simple
@@ -51,3 +51,38 @@ def triangles(graph):
 
     """
     return AppAssets(algo="triangles", context="vertex_data")(graph)
+
+
+@project_to_simple
+@not_compatible_for("arrow_property", "dynamic_property")
+def k_clique(graph, k=3):
+    """Count the k-cliques of the graph, i.e., the sets of `k` vertices that
+    are all adjacent to each other, taking directed edges as undirected ones.
+
+    Edges are oriented by an approximate degeneracy order, and each clique is
+    counted once, by its first vertex, among the neighbors after that vertex.
+
+    Args:
+        graph (:class:`graphscope.Graph`): A simple graph.
+        k (int, optional): The size of the cliques. Defaults to 3.
+
+    Returns:
+        :class:`graphscope.framework.context.TensorContextDAGNode`:
+            A context with the number of k-cliques, evaluated in eager mode.
+
+    Examples:
+
+    .. code:: python
+
+        >>> import graphscope
+        >>> from graphscope.dataset import load_p2p_network
+        >>> sess = graphscope.session(cluster_type="hosts", mode="eager")
+        >>> g = load_p2p_network(sess)
+        >>> # project to a simple graph (if needed)
+        >>> pg = g.project(vertices={"host": ["id"]}, edges={"connect": ["dist"]})
+        >>> c = graphscope.k_clique(pg, k=5)
+        >>> sess.close()
+
+    """
+    k = int(k)
+    return AppAssets(algo="k_clique", context="tensor")(graph, k)
@@ -22,7 +22,7 @@ from graphscope.framework.app import AppAssets
 from graphscope.framework.app import not_compatible_for
 from graphscope.framework.app import project_to_simple
 
-__all__ = ["wcc", "wcc_opt", "wcc_auto", "wcc_projected"]
+__all__ = ["wcc", "wcc_opt", "wcc_auto", "wcc_projected", "wcc_afforest"]
 
 logger = logging.getLogger("graphscope")
 
@@ -139,3 +139,22 @@ def wcc_projected(graph):
     This is a naive version of WCC that could work on dynamic, projected, flatten graph
     """
     return AppAssets(algo="wcc_projected", context="vertex_data")(graph)
+
+
+@project_to_simple
+@not_compatible_for("arrow_property", "dynamic_property")
+def wcc_afforest(graph):
+    """Evaluate weakly connected components on the `graph` in the way of
+    Afforest, which links a few sampled neighbors of every vertex, then skips
+    the edges inside the largest component. It takes two supersteps, whatever
+    the diameter of the graph, and gives the same labels as `wcc_projected`,
+    i.e., the smallest vertex id in each component.
+
+    Args:
+        graph (:class:`graphscope.Graph`): A simple graph.
+
+    Returns:
+        :class:`graphscope.framework.context.VertexDataContextDAGNode`:
+            A context with each vertex assigned with the component ID, evaluated in eager mode.
+    """
+    return AppAssets(algo="wcc_afforest", context="vertex_data")(graph)
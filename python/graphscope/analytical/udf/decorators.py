@@ -154,6 +154,16 @@ def pregel(vd_type, md_type):
       >>>     @staticmethod
       >>>     def Combine(messages):
       >>>         pass
+
+    The methods are compiled without the GIL, so the vertices of a fragment can
+    be computed by several threads, e.g. :code:`PageRank_Pregel()(g, thread_num=4)`.
+    Vertices then only set their own values and send messages through
+    :code:`v.send`.
+
+    A long running query can be checkpointed every few supersteps, e.g.
+    :code:`PageRank_Pregel()(g, checkpoint_dir="/mnt/ckpt", checkpoint_interval=10)`,
+    where the directory is shared by or local to each worker. Running the same
+    query on the same graph again resumes from the last checkpoint.
     """
 
     def _pregel_wrapper(vd_type, md_type, algo):
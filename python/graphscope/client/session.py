@@ -147,7 +147,12 @@ class _FetchHandler(object):
             from graphscope.framework.context import DynamicVertexDataContext
 
             return DynamicVertexDataContext(context_dag_node, ret["context_key"])
-        return Context(context_dag_node, ret["context_key"], ret["context_schema"])
+        return Context(
+            context_dag_node,
+            ret["context_key"],
+            ret["context_schema"],
+            ret.get("profile"),
+        )
 
     def wrap_results(self, response: message_pb2.RunStepResponse):  # noqa: C901
         rets = list()
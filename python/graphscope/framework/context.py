@@ -601,12 +601,13 @@ class Context(object):
     and can be referenced through a handle.
     """
 
-    def __init__(self, context_node, key, result_schema):
+    def __init__(self, context_node, key, result_schema, profile=None):
         self._context_node = context_node
         self._session = context_node.session
         self._graph = self._context_node._graph
         self._key = key
         self._result_schema = result_schema
+        self._profile = profile
         # copy and set op evaluated
         self._context_node.op = deepcopy(self._context_node.op)
         self._context_node.evaluated = True
@@ -630,6 +631,16 @@ class Context(object):
     def schema(self):
         return self._context_node._build_schema(self._result_schema)
 
+    @property
+    def profile(self):
+        """The per-superstep profile of the query, as a dict with the compute
+        time, message time and bytes sent of each superstep on each worker, or
+        None if the app does not record one.
+        """
+        if not self._profile:
+            return None
+        return json.loads(self._profile)
+
     @property
     def signature(self):
         """Compute digest by key and graph signatures.
@@ -302,13 +302,16 @@ def arrow_to_dynamic(graph):
     return op
 
 
-def modify_edges(graph, modify_type, edges, attr={}, weight=None):
+def modify_edges(
+    graph, modify_type, edges, attr={}, weight=None, payload_format="json"
+):
     """Create modify edges operation for nx graph.
 
     Args:
         graph (:class:`nx.Graph`): A nx graph.
         modify_type (`type_pb2.(NX_ADD_EDGES | NX_DEL_EDGES | NX_UPDATE_EDGES)`): The modify type
         edges (list): List of edges to be inserted into or delete from graph based on `modify_type`
+        payload_format (str): How `edges` is packed, "json" or "msgpack".
 
     Returns:
         An op to modify edges on the graph.
@@ -318,6 +321,7 @@ def modify_edges(graph, modify_type, edges, attr={}, weight=None):
     config[types_pb2.GRAPH_NAME] = utils.s_to_attr(graph.key)
     config[types_pb2.MODIFY_TYPE] = utils.modify_type_to_attr(modify_type)
     config[types_pb2.PROPERTIES] = utils.s_to_attr(json.dumps(attr))
+    config[types_pb2.PAYLOAD_FORMAT] = utils.s_to_attr(payload_format)
     if weight:
         config[types_pb2.EDGE_KEY] = utils.s_to_attr(weight)
     op = Operation(
@@ -330,13 +334,14 @@ def modify_edges(graph, modify_type, edges, attr={}, weight=None):
     return op
 
 
-def modify_vertices(graph, modify_type, vertices, attr={}):
+def modify_vertices(graph, modify_type, vertices, attr={}, payload_format="json"):
     """Create modify vertices operation for nx graph.
 
     Args:
         graph (:class:`nx.Graph`): A nx graph.
         modify_type (`type_pb2.(NX_ADD_NODES | NX_DEL_NODES | NX_UPDATE_NODES)`): The modify type
         vertices (list): node list.
+        payload_format (str): How `vertices` is packed, "json" or "msgpack".
 
     Returns:
         An op to modify vertices on the graph.
@@ -346,6 +351,7 @@ def modify_vertices(graph, modify_type, vertices, attr={}):
     config[types_pb2.GRAPH_NAME] = utils.s_to_attr(graph.key)
     config[types_pb2.MODIFY_TYPE] = utils.modify_type_to_attr(modify_type)
     config[types_pb2.PROPERTIES] = utils.s_to_attr(json.dumps(attr))
+    config[types_pb2.PAYLOAD_FORMAT] = utils.s_to_attr(payload_format)
     op = Operation(
         graph.session_id,
         types_pb2.MODIFY_VERTICES,
@@ -366,6 +372,9 @@ def report_graph(
     key=None,
     label_id=None,
     gid=None,
+    nodes=None,
+    fields=None,
+    batch_size=None,
 ):
     """Create report operation for nx graph.
 
@@ -399,6 +408,9 @@ def report_graph(
         fid (int): fragment id, with 'LOC' report types. (optional)
         lid (int): local id of node in grape_engine, with 'LOC; report types. (optional)
         key (str): edge key for MultiGraph or MultiDiGraph, with 'EDGE' report types. (optional)
+        nodes (bytes): msgpack packed list of nodes, with 'BATCH_BY_NODES'. (optional)
+        fields (int): bit mask of `ReportField` to report, with 'BATCH' report types. (optional)
+        batch_size (int): max number of nodes to report, with 'BATCH_BY_GID'. (optional)
 
     Returns:
         An op to do reporting job.
@@ -422,6 +434,12 @@ def report_graph(
         config[types_pb2.V_LABEL_ID] = utils.i_to_attr(label_id)
     if gid is not None:
         config[types_pb2.GID] = utils.u_to_attr(gid)
+    if nodes is not None:
+        config[types_pb2.NODES] = utils.bytes_to_attr(nodes)
+    if fields is not None:
+        config[types_pb2.REPORT_FIELDS] = utils.i_to_attr(fields)
+    if batch_size is not None:
+        config[types_pb2.BATCH_SIZE] = utils.i_to_attr(batch_size)
 
     config[types_pb2.EDGE_KEY] = utils.s_to_attr(str(key) if key is not None else "")
     op = Operation(
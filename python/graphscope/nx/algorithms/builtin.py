@@ -139,6 +139,51 @@ def pagerank(G, alpha=0.85, max_iter=100, tol=1.0e-6, weight="weight"):
     return graphscope.pagerank_nx(G, alpha, max_iter, tol)
 
 
+@context_to_dict
+@project_to_simple
+@not_implemented_for("multigraph")
+def pagerank_incremental(G, alpha=0.85, max_iter=100, tol=1.0e-6):
+    """Returns the PageRank of the nodes in the graph, repaired from the
+    result of the last run on the same graph.
+
+    The ranks start from those of the last `pagerank_incremental` on `G`,
+    and only the nodes around the edges modified since then keep being
+    updated, so that refreshing the ranks after small modifications takes
+    much fewer work than :func:`pagerank`. The first run on a graph computes
+    the ranks from scratch.
+
+    Parameters
+    ----------
+    G : graph
+      A networkx directed graph.
+
+    alpha : float, optional
+      Damping parameter for PageRank, default=0.85.
+
+    max_iter : integer, optional
+      Maximum number of iterations.
+
+    tol : float, optional
+      Error tolerance used to check convergence. A node propagates the change
+      of its rank only when it exceeds `tol`.
+
+    Returns
+    -------
+    pagerank : dictionary
+       Dictionary of nodes with PageRank as value.
+
+    Examples
+    --------
+    >>> G = nx.DiGraph(nx.path_graph(4))
+    >>> pr = nx.builtin.pagerank_incremental(G)
+    >>> G.add_edge(3, 0)
+    >>> pr = nx.builtin.pagerank_incremental(G)
+    """
+    return AppAssets(algo="pagerank_incremental", context="vertex_data")(
+        G, alpha, max_iter, tol
+    )
+
+
 @not_implemented_for("multigraph")
 @patch_docstring(nxa.hits)
 def hits(G, max_iter=100, tol=1.0e-8, nstart=None, normalized=True):
@@ -453,17 +498,77 @@ def all_pairs_shortest_path_length(G, weight=None):
 def closeness_centrality(G, u=None, distance=None, wf_improved=True):
     @context_to_dict
     @project_to_simple
-    def _closeness_centrality(G, weight=None, wf_improved=True):
+    def _closeness_centrality(G, weight=None, wf_improved=True, nbunch=""):
         return AppAssets(algo="closeness_centrality", context="vertex_data")(
-            G, wf_improved
+            G, wf_improved, nbunch
         )
 
     if u is not None:
-        # forward
-        return nxa.closeness_centrality(G, u, distance, wf_improved)
+        # only the shortest paths to u are searched
+        return _closeness_centrality(
+            G, weight=distance, wf_improved=wf_improved, nbunch=json.dumps([u])
+        )[u]
     return _closeness_centrality(G, weight=distance, wf_improved=wf_improved)
 
 
+@context_to_dict
+@project_to_simple
+def approximate_closeness_centrality(
+    G, epsilon=0.1, delta=0.1, weight=None, wf_improved=True
+):
+    """Approximate the closeness centrality of nodes by sampling pivots.
+
+    The distances to a node are averaged over the shortest paths from
+    ``ln(2n / delta) / (2 * epsilon^2)`` randomly chosen pivots instead of
+    from every node. With probability at least ``1 - delta`` the estimated
+    average distance to every node is within ``epsilon`` times the diameter
+    of the exact one. When the number of pivots reaches the number of nodes,
+    the result equals :func:`closeness_centrality`.
+
+    Parameters
+    ----------
+    G : graph
+      A graph
+
+    epsilon : float, optional (default=0.1)
+      The additive error bound, relative to the diameter of the graph.
+
+    delta : float, optional (default=0.1)
+      The probability that the error bound does not hold.
+
+    weight : edge attribute key, optional (default=None)
+      Use the specified edge attribute as the edge distance in shortest
+      path calculations
+
+    wf_improved : bool, optional (default=True)
+      If True, scale by the fraction of nodes reachable, as in
+      :func:`closeness_centrality`.
+
+    Returns
+    -------
+    nodes : dictionary
+      Dictionary of nodes with approximate closeness centrality as the value.
+
+    Examples
+    --------
+    >>> G = nx.path_graph(4)
+    >>> cc = nx.builtin.approximate_closeness_centrality(G, epsilon=0.05)
+
+    References
+    ----------
+    .. [1] D. Eppstein and J. Wang,
+       Fast Approximation of Centrality,
+       Journal of Graph Algorithms and Applications 8(1), 39-45, 2004.
+    """
+    if epsilon <= 0:
+        raise ValueError("epsilon must be positive")
+    if not 0 < delta < 1:
+        raise ValueError("delta must be in (0, 1)")
+    return AppAssets(
+        algo="approximate_closeness_centrality", context="vertex_data"
+    )(G, epsilon, delta, wf_improved)
+
+
 @patch_docstring(nxa.bfs_tree)
 def bfs_tree(G, source, reverse=False, depth_limit=None):
     """Returns an oriented tree constructed from of a breadth-first-search
@@ -530,6 +635,14 @@ def k_core(G, k=None, core_number=None):
     return graphscope.k_core(G, k)
 
 
+@context_to_dict
+@project_to_simple
+@not_implemented_for("multigraph")
+@patch_docstring(nxa.core_number)
+def core_number(G):
+    return AppAssets(algo="core_decomposition", context="vertex_data")(G)
+
+
 @patch_docstring(nxa.clustering)
 def clustering(G, nodes=None, weight=None):
     @context_to_dict
@@ -616,6 +729,30 @@ def weakly_connected_components(G):
     return AppAssets(algo="wcc_projected", context="vertex_data")(G)
 
 
+@context_to_dict
+@project_to_simple
+def weakly_connected_components_incremental(G):
+    """Generate weakly connected components of G, repaired from the result
+    of the last run on the same graph.
+
+    When only nodes and edges are added to `G` since the last run, the
+    components connected by the added edges are merged without traversing
+    the graph again. Otherwise the components are computed from scratch.
+
+    Parameters
+    ----------
+    G : networkx graph
+        A graph
+
+    Returns
+    -------
+    comp : dictionary
+       Dictionary of nodes with the component id as value, the component id
+       is the same for the nodes in a component.
+    """
+    return AppAssets(algo="wcc_incremental", context="vertex_data")(G)
+
+
 @project_to_simple
 def degree_assortativity_coefficient(G, x="out", y="in", weight=None):
     """Compute degree assortativity of graph.
@@ -864,12 +1001,12 @@ def is_simple_path(G, nodes):
     return _is_simple_path(G, nodes)
 
 
-def get_all_simple_paths(G, source, target_nodes, cutoff):
+def get_all_simple_paths(G, source, target_nodes, cutoff, limit=None):
     @project_to_simple
-    def _all_simple_paths(G, source, target_nodes, cutoff):
+    def _all_simple_paths(G, source, target_nodes, cutoff, limit):
         targets_json = json.dumps(target_nodes)
         return AppAssets(algo="all_simple_paths", context="tensor")(
-            G, source, targets_json, cutoff
+            G, source, targets_json, cutoff, limit
         )
 
     if not isinstance(target_nodes, list):
@@ -880,7 +1017,9 @@ def get_all_simple_paths(G, source, target_nodes, cutoff):
         cutoff = len(G) - 1
     if cutoff < 1 or source in target_nodes:
         return []
-    ctx = _all_simple_paths(G, source, list(set(target_nodes)), cutoff)
+    if limit is None:
+        limit = -1
+    ctx = _all_simple_paths(G, source, list(set(target_nodes)), cutoff, limit)
     paths = ctx.to_numpy("r", axis=0).tolist()
     if len(paths) == 1:
         if not isinstance(paths[0], list):
@@ -888,7 +1027,7 @@ def get_all_simple_paths(G, source, target_nodes, cutoff):
     return paths
 
 
-def all_simple_paths(G, source, target_nodes, cutoff=None):
+def all_simple_paths(G, source, target_nodes, cutoff=None, limit=None):
     """Generate all simple paths in the graph G from source to target.
     A simple path is a path with no repeated nodes.
     Parameters
@@ -900,6 +1039,9 @@ def all_simple_paths(G, source, target_nodes, cutoff=None):
        Single node or iterable of nodes at which to end path
     cutoff : integer, optional
         Depth to stop the search. Only paths of length <= cutoff are returned.
+    limit : integer, optional
+        Stop the search once limit paths are found, which paths are returned
+        is then arbitrary. No limit by default.
     Returns
     -------
     paths: list
@@ -919,7 +1061,7 @@ def all_simple_paths(G, source, target_nodes, cutoff=None):
 
     """
 
-    paths = get_all_simple_paths(G, source, target_nodes, cutoff)
+    paths = get_all_simple_paths(G, source, target_nodes, cutoff, limit)
     # delte path tail padding
     for path in paths:
         for i in range(len(path) - 1, -1, -1):
@@ -930,7 +1072,7 @@ def all_simple_paths(G, source, target_nodes, cutoff=None):
     return paths
 
 
-def all_simple_edge_paths(G, source, target_nodes, cutoff=None):
+def all_simple_edge_paths(G, source, target_nodes, cutoff=None, limit=None):
     """Generate lists of edges for all simple paths in G from source to target.
     A simple path is a path with no repeated nodes.
     Parameters
@@ -942,6 +1084,9 @@ def all_simple_edge_paths(G, source, target_nodes, cutoff=None):
        Single node or iterable of nodes at which to end path
     cutoff : integer, optional
         Depth to stop the search. Only paths of length <= cutoff are returned.
+    limit : integer, optional
+        Stop the search once limit paths are found, which paths are returned
+        is then arbitrary. No limit by default.
     Returns
     -------
     paths: list
@@ -958,7 +1103,7 @@ def all_simple_edge_paths(G, source, target_nodes, cutoff=None):
 
     """
 
-    paths = get_all_simple_paths(G, source, target_nodes, cutoff)
+    paths = get_all_simple_paths(G, source, target_nodes, cutoff, limit)
     for path in paths:
         a = ""
         b = ""
@@ -1090,6 +1235,69 @@ def betweenness_centrality(
     )
 
 
+@context_to_dict
+@project_to_simple
+def approximate_betweenness_centrality(
+    G, epsilon=0.01, delta=0.1, weight=None, normalized=True
+):
+    """Approximate the betweenness centrality of nodes by sampling shortest
+    paths with adaptive stopping.
+
+    Each sample is a uniformly random shortest path between a random pair of
+    nodes. Sampling stops as soon as the empirical Bernstein bound of every
+    node is within ``epsilon``, and at most after the Riondato-Kornaropoulos
+    bound on the number of samples. With probability at least ``1 - delta``,
+    the betweenness normalized by ``n(n-1)`` is estimated within ``epsilon``
+    for every node.
+
+    Parameters
+    ----------
+    G : graph
+      A graph
+
+    epsilon : float, optional (default=0.01)
+      The additive error bound of the betweenness normalized by ``n(n-1)``.
+
+    delta : float, optional (default=0.1)
+      The probability that the error bound does not hold.
+
+    weight : None or string, optional (default=None)
+      If None, all edge weights are considered equal.
+      Otherwise holds the name of the edge attribute used as weight.
+
+    normalized : bool, optional (default=True)
+      If True the betweenness values are normalized as in
+      :func:`betweenness_centrality`.
+
+    Returns
+    -------
+    nodes : dictionary
+       Dictionary of nodes with approximate betweenness centrality as the value.
+
+    Examples
+    --------
+    >>> G = nx.path_graph(4)
+    >>> bc = nx.builtin.approximate_betweenness_centrality(G, epsilon=0.05)
+
+    References
+    ----------
+    .. [1] M. Borassi and E. Natale:
+       KADABRA is an ADaptive Algorithm for Betweenness via Random
+       Approximation.
+       ACM Journal of Experimental Algorithmics 24, 2019.
+    .. [2] M. Riondato and E. M. Kornaropoulos:
+       Fast approximation of betweenness centrality through sampling.
+       Data Mining and Knowledge Discovery 30(2):438-475, 2016.
+    """
+    if epsilon <= 0:
+        raise ValueError("epsilon must be positive")
+    if not 0 < delta < 1:
+        raise ValueError("delta must be in (0, 1)")
+    return AppAssets(
+        algo="approximate_betweenness_centrality", context="vertex_data"
+    )(G, epsilon, delta, normalized)
+
+
 @project_to_simple
 @not_implemented_for("multigraph")
 def voterank(G, num_of_nodes=0):
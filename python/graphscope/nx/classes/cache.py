@@ -37,13 +37,30 @@ from graphscope.proto import types_pb2
 
 __all__ = ["Cache"]
 
+# columns of batched reports
+BATCH_FIELDS = {
+    "id": types_pb2.NODE_ID_FIELD,
+    "data": types_pb2.NODE_DATA_FIELD,
+    "succ": types_pb2.SUCC_FIELD,
+    "succ_attr": types_pb2.SUCC_ATTR_FIELD,
+    "pred": types_pb2.PRED_FIELD,
+    "pred_attr": types_pb2.PRED_ATTR_FIELD,
+}
+
 
 class Cache:
     """A adhoc cache for graphscope.nx Graph.
     The Cache is consists of two kind of cache: the iteration batch cache for
-    __iter__ and the LRU cache for cache miss.
+    __iter__ and the LRU cache for cache miss. The LRU cache is backed by
+    the prefetched columns of nodes, fetched in batches in the background,
+    e.g., the neighbors of the neighbors of a node just looked up.
     """
 
+    # max number of nodes of a batched report
+    prefetch_batch_size = 10000
+    # max number of nodes of a prefetch
+    prefetch_limit = 100000
+
     def __init__(self, graph):
         self._graph = graph
 
@@ -78,6 +95,11 @@ class Cache:
             "pred_attr": None,
         }
 
+        # prefetched columns and the pending fetches of nodes, by field
+        self.prefetch_executor = concurrent.futures.ThreadPoolExecutor(max_workers=1)
+        self.prefetch_cache = {field: {} for field in BATCH_FIELDS if field != "id"}
+        self.prefetch_futures = {field: {} for field in self.prefetch_cache}
+
     def warmup(self):
         """Warm up the iteration cache."""
         self._len = self._graph.number_of_nodes()
@@ -92,23 +114,89 @@ class Cache:
     # LRU Caches
     @lru_cache(1000000)
     def get_node_attr(self, n):
-        return get_node_data(self._graph, n)
+        data = self._take_prefetched("data", n)
+        if data is None:
+            data = get_node_data(self._graph, n)
+        return data
 
     @lru_cache(1000000)
     def get_successors(self, n):
-        return get_neighbors(self._graph, n)
+        succ = self._take_prefetched("succ", n)
+        if succ is None:
+            succ = get_neighbors(self._graph, n)
+            self.prefetch(succ, ("succ",))
+        return succ
 
     @lru_cache(1000000)
     def get_succ_attr(self, n):
-        return get_neighbors_attr(self._graph, n)
+        attr = self._take_prefetched("succ_attr", n)
+        if attr is None:
+            attr = get_neighbors_attr(self._graph, n)
+            self.prefetch(self.get_successors(n), ("succ_attr",))
+        return attr
 
     @lru_cache(1000000)
     def get_predecessors(self, n):
-        return get_neighbors(self._graph, n, pred=True)
+        pred = self._take_prefetched("pred", n)
+        if pred is None:
+            pred = get_neighbors(self._graph, n, pred=True)
+            self.prefetch(pred, ("pred",))
+        return pred
 
     @lru_cache(1000000)
     def get_pred_attr(self, n):
-        return get_neighbors_attr(self._graph, n, pred=True)
+        attr = self._take_prefetched("pred_attr", n)
+        if attr is None:
+            attr = get_neighbors_attr(self._graph, n, pred=True)
+            self.prefetch(self.get_predecessors(n), ("pred_attr",))
+        return attr
+
+    def prefetch(self, nodes, fields=("succ",)):
+        """Fetch the fields of nodes in batches in the background, so that
+        the later lookups of them are served without a round trip.
+
+        Parameters
+        ----------
+        nodes: iterable
+            the nodes to prefetch, the ones beyond `prefetch_limit` are ignored.
+        fields: tuple
+            the fields to prefetch, in "data", "succ", "succ_attr", "pred"
+            and "pred_attr".
+        """
+        if self._graph.graph_type == graph_def_pb2.ARROW_PROPERTY:
+            # the batched reports are served by dynamic fragments only
+            return
+        if any(len(self.prefetch_futures[f]) >= self.prefetch_limit for f in fields):
+            # too many prefetched nodes are not looked up yet
+            return
+        batch = []
+        for n in nodes:
+            if len(batch) >= self.prefetch_limit:
+                break
+            if any(
+                n not in self.prefetch_cache[f] and n not in self.prefetch_futures[f]
+                for f in fields
+            ):
+                batch.append(n)
+        for i in range(0, len(batch), self.prefetch_batch_size):
+            chunk = batch[i : i + self.prefetch_batch_size]
+            # the columns are stored in the dicts of now, which are dropped
+            # rather than filled by a stale fetch on clear
+            future = self.prefetch_executor.submit(
+                self._fetch_batch,
+                chunk,
+                fields,
+                [self.prefetch_cache[f] for f in fields],
+            )
+            for f in fields:
+                pending = self.prefetch_futures[f]
+                for n in chunk:
+                    pending[n] = future
+
+    def prefetched(self, n, field):
+        """Whether the field of node n is prefetched or being prefetched,
+        which implies n is in the graph."""
+        return n in self.prefetch_cache[field] or n in self.prefetch_futures[field]
 
     def align_node_attr_cache(self):
         """Check and align the node attr cache with node id cache"""
@@ -256,6 +344,7 @@ class Cache:
 
     def shutdown_executor(self):
         self.executor.shutdown(wait=True)
+        self.prefetch_executor.shutdown(wait=True)
 
     def clear(self):
         """Clear batch cache and lru cache, reset the status and warmup again"""
@@ -279,6 +368,7 @@ class Cache:
         self.get_succ_attr.cache_clear()
         self.get_predecessors.cache_clear()
         self.get_pred_attr.cache_clear()
+        self._clear_prefetched(self.prefetch_cache.keys())
         self.warmup()
 
     def clear_node_attr_cache(self):
@@ -293,6 +383,7 @@ class Cache:
         self.futures["node_attr"] = None
         self.node_attr_cache = ()
         self.get_node_attr.cache_clear()
+        self._clear_prefetched(("data",))
         self.node_attr_align = False
 
     def clear_neighbor_attr_cache(self):
@@ -317,9 +408,36 @@ class Cache:
         self.pred_attr_cache = ()
         self.get_succ_attr.cache_clear()
         self.get_pred_attr.cache_clear()
+        self._clear_prefetched(("succ_attr", "pred_attr"))
         self.succ_attr_align = False
         self.pred_attr_align = False
 
+    def _clear_prefetched(self, fields):
+        for field in fields:
+            for future in set(self.prefetch_futures[field].values()):
+                future.cancel()
+            self.prefetch_futures[field] = {}
+            self.prefetch_cache[field] = {}
+
+    def _take_prefetched(self, field, n):
+        """Pop the prefetched field of n, waiting for the pending fetch if
+        any, returns None if not prefetched."""
+        future = self.prefetch_futures[field].pop(n, None)
+        if future is not None:
+            try:
+                future.result()
+            except concurrent.futures.CancelledError:
+                pass
+        return self.prefetch_cache[field].pop(n, None)
+
+    def _fetch_batch(self, nodes, fields, caches):
+        columns = get_batch_by_nodes(self._graph, nodes, fields)
+        exists = columns["exists"]
+        for field, cache in zip(fields, caches):
+            for n, e, value in zip(nodes, exists, columns[field]):
+                if e:
+                    cache[n] = value
+
     def _async_fetch_node_id_cache(self, gid):
         self.futures["node_id"] = self.executor.submit(self._get_node_id_cache, gid)
 
@@ -392,6 +510,61 @@ class Cache:
         return gid, pred_attr_cache
 
 
+def get_batch_by_nodes(graph, nodes, fields):
+    """Get the fields of a list of nodes in graph in one round trip.
+
+    Parameters
+    ----------
+    graph:
+        the graph to query, a graph of dynamic fragments.
+    nodes: list
+        the nodes to query.
+    fields: tuple
+        the names of fields in `BATCH_FIELDS`.
+
+    Returns
+    -------
+    columns: dict
+        a column aligned with nodes of each field, in which the nodes not in
+        graph are None, and the "exists" column of whether nodes are in graph.
+    """
+    op = dag_utils.report_graph(
+        graph,
+        types_pb2.BATCH_BY_NODES,
+        nodes=msgpack.packb(list(nodes), use_bin_type=True),
+        fields=_fields_mask(fields),
+    )
+    archive = op.eval()
+    return msgpack.unpackb(archive.get_bytes(), use_list=False)
+
+
+def get_batch_by_gid(graph, gid, fields, batch_size):
+    """Get the fields of a batch of nodes in graph from gid, in one round trip.
+
+    Returns
+    -------
+    (gid, columns): the gid to continue with, 0 once all nodes are reported,
+        and a column of each field in `fields`.
+    """
+    op = dag_utils.report_graph(
+        graph,
+        types_pb2.BATCH_BY_GID,
+        gid=gid,
+        fields=_fields_mask(fields),
+        batch_size=batch_size,
+    )
+    archive = op.eval()
+    gid = archive.get_uint64()
+    return gid, msgpack.unpackb(archive.get_bytes(), use_list=False)
+
+
+def _fields_mask(fields):
+    mask = 0
+    for field in fields:
+        mask |= 1 << BATCH_FIELDS[field]
+    return mask
+
+
 def get_neighbors(graph, n, pred=False):
     """Get the neighbors of node in graph.
 
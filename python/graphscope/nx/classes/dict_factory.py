@@ -50,7 +50,7 @@ class NodeDict(Mapping):
         if key in self._cache and self._cache.align_node_attr_cache():
             index = self._cache.id2i[key]
             return NodeAttrDict(self._graph, key, self._cache.node_attr_cache[index])
-        if key in self._graph:
+        if self._cache.prefetched(key, "data") or key in self._graph:
             attr = self._cache.get_node_attr(key)
             return NodeAttrDict(self._graph, key, attr)
         raise KeyError(key)
@@ -147,8 +147,9 @@ class AdjListDict(Mapping):
                 else self._cache.succ_cache[index]
             )
             return NeighborDict(self._graph, key, neighbor, self._pred)
-        if key in self._graph:
-            # LRU cache
+        field = "pred" if self._pred else "succ"
+        if self._cache.prefetched(key, field) or key in self._graph:
+            # LRU cache, backed by prefetched neighbors
             nbr = (
                 self._cache.get_predecessors(key)
                 if self._pred
@@ -21,6 +21,7 @@
 
 import copy
 
+import msgpack
 import orjson as json
 from networkx import freeze
 from networkx.classes.graph import Graph as RefGraph
@@ -47,6 +48,7 @@ from graphscope.nx.convert import to_networkx_graph
 from graphscope.nx.utils.compat import patch_docstring
 from graphscope.nx.utils.misc import clear_mutation_cache
 from graphscope.nx.utils.misc import init_empty_graph_in_engine
+from graphscope.nx.utils.misc import pack_modification
 from graphscope.proto import graph_def_pb2
 from graphscope.proto import types_pb2
 
@@ -1229,6 +1231,25 @@ class Graph(_GraphBase):
         archive = op.eval()
         return archive.get_size()
 
+    @clear_mutation_cache
+    def partition_stats(self):
+        """Returns the quality of the partition of the graph over fragments.
+
+        Returns
+        -------
+        stats : dict
+            "vertex_num", "edge_num" and "cut_edge_num": the number of nodes,
+            out-edges and out-edges to nodes of other fragments of each
+            fragment, "edge_cut_ratio": the fraction of edges across
+            fragments, and "vertex_imbalance": the nodes of the largest
+            fragment over the average.
+        """
+        if self.graph_type != graph_def_pb2.DYNAMIC_PROPERTY:
+            raise NetworkXError("partition stats of arrow graph is not supported")
+        op = dag_utils.report_graph(self, types_pb2.PARTITION_STATS)
+        archive = op.eval()
+        return msgpack.unpackb(archive.get_bytes(), use_list=True)
+
     @clear_mutation_cache
     def has_edge(self, u, v):
         """Returns True if the edge (u, v) is in the graph.
@@ -1909,21 +1930,23 @@ class Graph(_GraphBase):
             len(self._add_node_cache) > 0 or len(self._add_edge_cache) > 0
         )
         if self._add_node_cache:
-            nodes_to_modify = json.dumps(
-                self._add_node_cache, option=json.OPT_SERIALIZE_NUMPY
-            )
+            nodes_to_modify = pack_modification(self._add_node_cache)
             self._op = dag_utils.modify_vertices(
-                self, types_pb2.NX_ADD_NODES, nodes_to_modify
+                self,
+                types_pb2.NX_ADD_NODES,
+                nodes_to_modify,
+                payload_format="msgpack",
             )
             self._op.eval(leaf=False)
             self._add_node_cache.clear()
 
         if self._add_edge_cache:
-            edges_to_modify = json.dumps(
-                self._add_edge_cache, option=json.OPT_SERIALIZE_NUMPY
-            )
+            edges_to_modify = pack_modification(self._add_edge_cache)
             self._op = dag_utils.modify_edges(
-                self, types_pb2.NX_ADD_EDGES, edges_to_modify
+                self,
+                types_pb2.NX_ADD_EDGES,
+                edges_to_modify,
+                payload_format="msgpack",
             )
             self._op.eval(leaf=False)
             self._add_edge_cache.clear()
@@ -1936,21 +1959,23 @@ class Graph(_GraphBase):
             len(self._remove_node_cache) > 0 or len(self._remove_edge_cache) > 0
         )
         if self._remove_node_cache:
-            nodes_to_modify = json.dumps(
-                self._remove_node_cache, option=json.OPT_SERIALIZE_NUMPY
-            )
+            nodes_to_modify = pack_modification(self._remove_node_cache)
             self._op = dag_utils.modify_vertices(
-                self, types_pb2.NX_DEL_NODES, nodes_to_modify
+                self,
+                types_pb2.NX_DEL_NODES,
+                nodes_to_modify,
+                payload_format="msgpack",
             )
             self._op.eval(leaf=False)
             self._remove_node_cache.clear()
 
         if self._remove_edge_cache:
-            edges_to_modify = json.dumps(
-                self._remove_edge_cache, option=json.OPT_SERIALIZE_NUMPY
-            )
+            edges_to_modify = pack_modification(self._remove_edge_cache)
             self._op = dag_utils.modify_edges(
-                self, types_pb2.NX_DEL_EDGES, edges_to_modify
+                self,
+                types_pb2.NX_DEL_EDGES,
+                edges_to_modify,
+                payload_format="msgpack",
             )
             self._op.eval(leaf=False)
             self._remove_edge_cache.clear()
@@ -19,7 +19,9 @@
 
 import functools
 
+import msgpack
 import networkx.utils.misc
+import numpy as np
 
 from graphscope.framework import dag_utils
 from graphscope.nx.utils.compat import import_as_graphscope_nx
@@ -85,3 +87,18 @@ def replace_with_inf(data):
         if v == 1.7976931348623157e308:
             data[k] = float("inf")
     return data
+
+
+def _msgpack_default(obj):
+    if isinstance(obj, np.generic):
+        return obj.item()
+    if isinstance(obj, np.ndarray):
+        return obj.tolist()
+    raise TypeError("Cannot serialize object of type %s" % type(obj))
+
+
+def pack_modification(data):
+    """Pack the nodes or edges to modify with msgpack, which the engine
+    unpacks without parsing json text.
+    """
+    return msgpack.packb(data, default=_msgpack_default, use_bin_type=True)